@@ -30,8 +30,11 @@
 #include <unistd.h>
 #include <zlib.h>
 
+#include <algorithm>
 #include <fstream>
 #include <memory>
+#include <thread>
+#include <vector>
 
 #include <binder/IBinder.h>
 #include <binder/IServiceManager.h>
@@ -50,6 +53,7 @@
 #include <android-base/properties.h>
 #include <android-base/strings.h>
 #include <android-base/stringprintf.h>
+#include <android-base/unique_fd.h>
 
 using namespace android;
 using hardware::hidl_vec;
@@ -293,6 +297,7 @@ static const char* g_categoriesFile = nullptr;
 static const char* g_kernelTraceFuncs = nullptr;
 static const char* g_debugAppCmdLine = "";
 static const char* g_outputFile = nullptr;
+static bool g_fastStart = false;
 
 /* Global state */
 static bool g_traceAborted = false;
@@ -345,6 +350,9 @@ static const char* k_traceStreamPath =
 static const char* k_traceMarkerPath =
     "trace_marker";
 
+static const char* k_setEventPath =
+    "set_event";
+
 // Check whether a file exists.
 static bool fileExists(const char* filename) {
     return access((g_traceFolder + filename).c_str(), F_OK) != -1;
@@ -531,6 +539,25 @@ static bool setTraceBufferSizeKB(int size)
     return writeStr(k_traceBufferSizePath, str);
 }
 
+// Set the size of the kernel's trace buffer in kilobytes, unless every CPU's
+// buffer already has that size.  Resizing reallocates the buffers, which is
+// the slowest part of setting up a trace.
+static bool setTraceBufferSizeKBIfChanged(int size)
+{
+    if (size < 1) {
+        size = 1;
+    }
+    // This reads "X" if the per-CPU sizes differ, and may be followed by
+    // " (expanded: N)" if the buffers have not been allocated yet.
+    std::string current;
+    if (android::base::ReadFileToString(g_traceFolder + k_traceBufferSizePath, &current) &&
+        !current.empty() && current.find('(') == std::string::npos &&
+        atoi(current.c_str()) == size) {
+        return true;
+    }
+    return setTraceBufferSizeKB(size);
+}
+
 // Set the clock to the best available option while tracing. Use 'boot' if it's
 // available; otherwise, use 'mono'. If neither are available use 'global'.
 // Any write to the trace_clock sysfs file will reset the buffer, so only
@@ -656,6 +683,100 @@ static bool disableKernelTraceEvents() {
     return ok;
 }
 
+// Convert the path of an enable file, e.g. "events/sched/sched_switch/enable"
+// or "events/irq/enable", into the form set_event takes, e.g.
+// "sched:sched_switch" or "irq:*".  Returns an empty string if the path is not
+// an event enable file.
+static std::string toSetEventEntry(const std::string& path)
+{
+    static const std::string prefix = "events/";
+    static const std::string suffix = "/enable";
+    if (!android::base::StartsWith(path, prefix) || !android::base::EndsWith(path, suffix) ||
+        path.size() <= prefix.size() + suffix.size()) {
+        return "";
+    }
+    std::string event = path.substr(prefix.size(), path.size() - prefix.size() - suffix.size());
+    size_t slash = event.find('/');
+    if (slash == std::string::npos) {
+        return event + ":*";
+    }
+    event[slash] = ':';
+    return event;
+}
+
+// Compute the enable files of the enabled categories, so that they can be
+// written at once.  Returns false if a required file is not writable.
+static bool getEnabledKernelTraceEvents(std::vector<std::string>* paths)
+{
+    bool ok = true;
+    auto addPath = [&](const std::string& path, bool required) {
+        if (fileIsWritable(path.c_str())) {
+            paths->push_back(path);
+        } else if (required) {
+            fprintf(stderr, "error writing file %s\n", path.c_str());
+            ok = false;
+        }
+    };
+
+    for (size_t i = 0; i < arraysize(k_categories); i++) {
+        if (g_categoryEnables[i]) {
+            const TracingCategory &c = k_categories[i];
+            for (int j = 0; j < MAX_SYS_FILES; j++) {
+                const char* path = c.sysfiles[j].path;
+                if (path != nullptr) {
+                    addPath(path, c.sysfiles[j].required == REQ);
+                }
+            }
+        }
+    }
+    for (const TracingVendorFileCategory& c : g_vendorFileCategories) {
+        if (c.enabled) {
+            for (const std::string& path : c.ftrace_enable_paths) {
+                addPath(path, false);
+            }
+        }
+    }
+
+    // The same enable file may be in several categories.
+    std::sort(paths->begin(), paths->end());
+    paths->erase(std::unique(paths->begin(), paths->end()), paths->end());
+    return ok;
+}
+
+// Replace the enabled kernel trace events with the ones of the given enable
+// files.  Opening set_event with O_TRUNC disables every event, and the kernel
+// takes the new events from one buffer, instead of an open and a write per
+// enable file.
+static bool setKernelTraceEvents(const std::vector<std::string>& paths)
+{
+    std::string buf;
+    for (const std::string& path : paths) {
+        std::string entry = toSetEventEntry(path);
+        if (entry.empty()) {
+            fprintf(stderr, "error: %s is not an event enable file\n", path.c_str());
+            return false;
+        }
+        buf += entry;
+        buf += '\n';
+    }
+
+    std::string fullFilename = g_traceFolder + k_setEventPath;
+    android::base::unique_fd fd(open(fullFilename.c_str(), O_WRONLY | O_TRUNC | O_CLOEXEC));
+    if (fd == -1) {
+        fprintf(stderr, "error opening %s: %s (%d)\n", fullFilename.c_str(),
+                strerror(errno), errno);
+        return false;
+    }
+    // The kernel takes one event per write call, so WriteStringToFd keeps
+    // writing what is left.
+    if (!android::base::WriteStringToFd(buf, fd)) {
+        fprintf(stderr, "error writing to %s: %s (%d)\n", fullFilename.c_str(),
+                strerror(errno), errno);
+        return false;
+    }
+    return true;
+}
+
 // Verify that the comma separated list of functions are being traced by the
 // kernel.
 static bool verifyKernelTraceFuncs(const char* funcs)
@@ -883,6 +1004,47 @@ static bool setUpKernelTracing()
     return ok;
 }
 
+// Same as setUpKernelTracing, but replaces the enabled events through set_event
+// in one go, and resizes the trace buffer, if needed, at the same time as it
+// sets up the rest.  The kernel resizes the buffers under a different lock
+// than the one it enables events under, so the two do not wait on each other.
+// Unlike setUpKernelTracing, this also disables events which are not in any
+// category.
+static bool setUpKernelTracingFast()
+{
+    bool ok = true;
+
+    ok &= setUserInitiatedTraceProperty(true);
+    ok &= setCategoriesEnableFromFile(g_categoriesFile);
+
+    // Compute the events to enable before touching the trace files.
+    std::vector<std::string> paths;
+    ok &= getEnabledKernelTraceEvents(&paths);
+
+    bool bufferOk = true;
+    std::thread bufferThread([&bufferOk]() {
+        bufferOk = setTraceBufferSizeKBIfChanged(g_traceBufferSizeKB);
+    });
+
+    ok &= setTraceOverwriteEnable(g_traceOverwrite);
+    ok &= setClock();
+    ok &= setPrintTgidEnableIfPresent(true);
+    ok &= setKernelTraceFuncs(g_kernelTraceFuncs);
+
+    if (!fileIsWritable(k_setEventPath) || !setKernelTraceEvents(paths)) {
+        fprintf(stderr, "falling back to writing each event enable file\n");
+        ok &= disableKernelTraceEvents();
+        for (const std::string& path : paths) {
+            ok &= setKernelOptionEnable(path.c_str(), true);
+        }
+    }
+
+    bufferThread.join();
+    ok &= bufferOk;
+
+    return ok;
+}
+
 // Reset all the kernel tracing settings to their default state.
 static void cleanUpKernelTracing()
 {
@@ -1108,6 +1270,10 @@ static void showHelp(const char *cmd)
                     "                    Note: this can take significant CPU time, and is best\n"
                     "                    used for measuring things that are not affected by\n"
                     "                    CPU performance, like pagecache usage.\n"
+                    "  --fast_start    set up kernel tracing with fewer, batched writes to\n"
+                    "                    the trace files, and report how long it took.\n"
+                    "                    This also disables events outside the selected\n"
+                    "                    categories.\n"
                     "  --list_categories\n"
                     "                  list the available tracing categories\n"
                     "  --prefer_sdk\n"
@@ -1283,6 +1449,7 @@ int main(int argc, char **argv)
             {"list_categories",   no_argument, nullptr,  0 },
             {"stream",            no_argument, nullptr,  0 },
             {"prefer_sdk",        no_argument, nullptr,  0 },
+            {"fast_start",        no_argument, nullptr,  0 },
             {nullptr,                       0, nullptr,  0 }
         };
 
@@ -1357,6 +1524,8 @@ int main(int argc, char **argv)
                     traceDump = false;
                 } else if (!strcmp(long_options[option_index].name, "prefer_sdk")) {
                     preferSdk = true;
+                } else if (!strcmp(long_options[option_index].name, "fast_start")) {
+                    g_fastStart = true;
                 } else if (!strcmp(long_options[option_index].name, "list_categories")) {
                     listSupportedCategories();
                     exit(0);
@@ -1397,9 +1566,14 @@ int main(int argc, char **argv)
     }
 
     if (ok && traceStart && !onlyUserspace) {
-        ok &= setUpKernelTracing();
+        nsecs_t setUpStart = systemTime(CLOCK_MONOTONIC);
+        ok &= g_fastStart ? setUpKernelTracingFast() : setUpKernelTracing();
         ok &= setUpVendorTracingWithHal();
         ok &= startTrace();
+        if (g_fastStart) {
+            fprintf(stderr, "kernel tracing set up in %.2f ms\n",
+                    ns2us(systemTime(CLOCK_MONOTONIC) - setUpStart) / 1000.0);
+        }
     }
 
     if (ok && traceStart) {
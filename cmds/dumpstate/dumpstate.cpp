@@ -82,16 +82,21 @@
 #include <utils/StrongPointer.h>
 #include <vintf/VintfObject.h>
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <cmath>
+#include <condition_variable>
 #include <fstream>
 #include <functional>
 #include <future>
 #include <memory>
+#include <mutex>
 #include <numeric>
 #include <regex>
 #include <set>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -235,10 +240,13 @@ static const std::string SHUTDOWN_CHECKPOINTS_FILE_PREFIX = "checkpoints-";
     RUN_SLOW_FUNCTION_AND_LOG(log_title, func_ptr, __VA_ARGS__);               \
     RETURN_IF_USER_DENIED_CONSENT();
 
+// Waits for a task in the pool, and then adds the zip entries that it has enqueued, so that
+// they are written out while the remaining tasks are still running.
 #define WAIT_TASK_WITH_CONSENT_CHECK(future) \
-    RETURN_IF_USER_DENIED_CONSENT();                      \
+    RETURN_IF_USER_DENIED_CONSENT();         \
     WaitForTask(future);                     \
-    RETURN_IF_USER_DENIED_CONSENT();
+    RETURN_IF_USER_DENIED_CONSENT();         \
+    ds.AddEnqueuedZipEntries();
 
 static const char* WAKE_LOCK_NAME = "dumpstate_wakelock";
 
@@ -1257,57 +1265,151 @@ static void DumpIpAddrAndRules() {
     RunCommand("IP RULES v6", {"ip", "-6", "rule", "show"});
 }
 
+// Dumps a service as text, with its header and footer, to out_fd.
+static void DumpsysTextService(Dumpsys& dumpsys, int out_fd, const String16& service,
+                               int priority, const Vector<String16>& args,
+                               std::chrono::milliseconds service_timeout) {
+    if (PropertiesHelper::IsDryRun()) {
+        dumpsys.writeDumpHeader(out_fd, service, priority);
+        dumpsys.writeDumpFooter(out_fd, service, std::chrono::milliseconds(1));
+        return;
+    }
+    status_t status = dumpsys.startDumpThread(Dumpsys::TYPE_DUMP | Dumpsys::TYPE_PID |
+                                              Dumpsys::TYPE_CLIENTS | Dumpsys::TYPE_THREAD,
+                                              service, args);
+    if (status != OK) {
+        MYLOGE("Failed to start dump thread for service: %s, status: %d",
+               String8(service).c_str(), status);
+        return;
+    }
+    dumpsys.writeDumpHeader(out_fd, service, priority);
+    std::chrono::duration<double> elapsed_seconds;
+    size_t bytes_written = 0;
+    status = dumpsys.writeDump(out_fd, service, service_timeout, /* as_proto = */ false,
+                               elapsed_seconds, bytes_written);
+    dumpsys.writeDumpFooter(out_fd, service, elapsed_seconds);
+    bool dump_complete = (status == OK);
+    dumpsys.stopDumpThread(dump_complete);
+}
+
+// Returns how long a service may take to dump, which is service_timeout unless the priority
+// group's deadline comes first. Returns 0ms if the deadline has passed.
+static std::chrono::milliseconds GetDumpsysServiceTimeout(
+        const String16& service, int priority, std::chrono::milliseconds service_timeout,
+        std::chrono::steady_clock::time_point deadline) {
+    if (priority == IServiceManager::DUMP_FLAG_PRIORITY_HIGH && service == String16("meminfo")) {
+        // Use a longer timeout for meminfo, since 30s is not always enough.
+        service_timeout = 60s;
+    }
+    auto time_left = std::chrono::duration_cast<std::chrono::milliseconds>(
+        deadline - std::chrono::steady_clock::now());
+    return std::clamp(time_left, 0ms, service_timeout);
+}
+
+// Dumps the services concurrently, each one into its own unnamed temporary file, and copies
+// the files to stdout in the order of the services as soon as they're done, so that the output
+// is the same as when dumping them one by one.
+static void RunDumpsysTextInParallel(const std::string& title, int priority,
+                                     const Vector<String16>& services,
+                                     const Vector<String16>& args,
+                                     std::chrono::milliseconds service_timeout,
+                                     std::chrono::steady_clock::time_point deadline) {
+    constexpr size_t kMaxDumpsysThreads = 4;
+
+    struct ServiceDump {
+        android::base::unique_fd fd;
+        bool done = false;
+    };
+    std::vector<ServiceDump> dumps(services.size());
+    std::mutex lock;
+    std::condition_variable dump_finished;
+    std::atomic<size_t> next = 0;
+    std::atomic<bool> timed_out = false;
+
+    // Services that are taken after the deadline or after user consent has been denied are
+    // marked as done without being dumped, so that stdout never waits for them.
+    auto dump_services = [&]() {
+        sp<android::IServiceManager> sm = defaultServiceManager();
+        Dumpsys dumpsys(sm.get());
+        for (size_t i = next++; i < dumps.size(); i = next++) {
+            android::base::unique_fd fd;
+            auto timeout = GetDumpsysServiceTimeout(services[i], priority, service_timeout,
+                                                    deadline);
+            if (timeout == 0ms) {
+                timed_out = true;
+            } else if (!ds.IsUserConsentDenied()) {
+                fd.reset(TEMP_FAILURE_RETRY(open(ds.bugreport_internal_dir_.c_str(),
+                                                 O_TMPFILE | O_RDWR | O_CLOEXEC, 0600)));
+                if (fd == -1) {
+                    MYLOGE("Failed to create temporary file for service %s: %s\n",
+                           String8(services[i]).c_str(), strerror(errno));
+                } else {
+                    DumpsysTextService(dumpsys, fd.get(), services[i], priority, args,
+                                       timeout);
+                }
+            }
+            std::lock_guard guard(lock);
+            dumps[i].fd = std::move(fd);
+            dumps[i].done = true;
+            dump_finished.notify_one();
+        }
+    };
+
+    size_t thread_count = std::min(services.size(), kMaxDumpsysThreads);
+    std::vector<std::thread> threads;
+    threads.reserve(thread_count);
+    for (size_t i = 0; i < thread_count; i++) {
+        threads.emplace_back(dump_services);
+    }
+
+    for (ServiceDump& dump : dumps) {
+        android::base::unique_fd fd;
+        {
+            std::unique_lock guard(lock);
+            dump_finished.wait(guard, [&dump] { return dump.done; });
+            fd = std::move(dump.fd);
+        }
+        if (fd != -1 && (lseek(fd.get(), 0, SEEK_SET) != 0 || !CopyFile(fd.get(), STDOUT_FILENO))) {
+            MYLOGE("Failed to copy the dump of '%s' to stdout: %s\n", title.c_str(),
+                   strerror(errno));
+        }
+    }
+
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    if (timed_out) {
+        MYLOGE("*** command '%s' timed out\n", title.c_str());
+    }
+}
+
 static Dumpstate::RunStatus RunDumpsysTextByPriority(const std::string& title, int priority,
                                                      std::chrono::milliseconds timeout,
                                                      std::chrono::milliseconds service_timeout) {
     auto start = std::chrono::steady_clock::now();
+    auto deadline = start + timeout;
     sp<android::IServiceManager> sm = defaultServiceManager();
     Dumpsys dumpsys(sm.get());
     Vector<String16> args;
     Dumpsys::setServiceArgs(args, /* asProto = */ false, priority);
     Vector<String16> services = dumpsys.listServices(priority, /* supports_proto = */ false);
+    if (PropertiesHelper::IsParallelRun() && services.size() > 1) {
+        RETURN_IF_USER_DENIED_CONSENT();
+        RunDumpsysTextInParallel(title, priority, services, args, service_timeout, deadline);
+        RETURN_IF_USER_DENIED_CONSENT();
+        return Dumpstate::RunStatus::OK;
+    }
     for (const String16& service : services) {
         RETURN_IF_USER_DENIED_CONSENT();
-        std::string path(title);
-        path.append(" - ").append(String8(service).c_str());
-        size_t bytes_written = 0;
-        if (PropertiesHelper::IsDryRun()) {
-             dumpsys.writeDumpHeader(STDOUT_FILENO, service, priority);
-             dumpsys.writeDumpFooter(STDOUT_FILENO, service, std::chrono::milliseconds(1));
-        } else {
-             status_t status = dumpsys.startDumpThread(Dumpsys::TYPE_DUMP | Dumpsys::TYPE_PID |
-                                                       Dumpsys::TYPE_CLIENTS | Dumpsys::TYPE_THREAD,
-                                                       service, args);
-             if (status == OK) {
-                dumpsys.writeDumpHeader(STDOUT_FILENO, service, priority);
-                std::chrono::duration<double> elapsed_seconds;
-                if (priority == IServiceManager::DUMP_FLAG_PRIORITY_HIGH &&
-                    service == String16("meminfo")) {
-                    // Use a longer timeout for meminfo, since 30s is not always enough.
-                    status = dumpsys.writeDump(STDOUT_FILENO, service, 60s,
-                                               /* as_proto = */ false, elapsed_seconds,
-                                                bytes_written);
-                } else {
-                    status = dumpsys.writeDump(STDOUT_FILENO, service, service_timeout,
-                                               /* as_proto = */ false, elapsed_seconds,
-                                                bytes_written);
-                }
-                dumpsys.writeDumpFooter(STDOUT_FILENO, service, elapsed_seconds);
-                bool dump_complete = (status == OK);
-                dumpsys.stopDumpThread(dump_complete);
-            } else {
-                MYLOGE("Failed to start dump thread for service: %s, status: %d",
-                       String8(service).c_str(), status);
-            }
-        }
-
-        auto elapsed_duration = std::chrono::duration_cast<std::chrono::milliseconds>(
-            std::chrono::steady_clock::now() - start);
-        if (elapsed_duration > timeout) {
+        auto timeout_left = GetDumpsysServiceTimeout(service, priority, service_timeout, deadline);
+        if (timeout_left == 0ms) {
+            auto elapsed_duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start);
             MYLOGE("*** command '%s' timed out after %llums\n", title.c_str(),
                    elapsed_duration.count());
             break;
         }
+        DumpsysTextService(dumpsys, STDOUT_FILENO, service, priority, args, timeout_left);
     }
     return Dumpstate::RunStatus::OK;
 }
@@ -2037,6 +2139,7 @@ static void DumpstateRadioCommon(bool include_sensitive_info = true) {
         // DumpHals contains unrelated hardware info (camera, NFC, biometrics, ...).
         if (ds.dump_pool_) {
             WaitForTask(std::move(dump_hals));
+            ds.AddEnqueuedZipEntries();
         } else {
             RUN_SLOW_FUNCTION_AND_LOG(DUMP_HALS_TASK, DumpHals);
         }
@@ -2165,6 +2268,7 @@ static void DumpstateTelephonyOnly(const std::string& calling_package) {
 
     if (ds.dump_pool_) {
         WaitForTask(std::move(dump_board));
+        ds.AddEnqueuedZipEntries();
     } else {
         RUN_SLOW_FUNCTION_AND_LOG(DUMP_BOARD_TASK, ds.DumpstateBoard);
     }
@@ -2730,9 +2834,7 @@ static void register_sig_handler() {
 
 bool Dumpstate::FinishZipFile() {
     // Runs all enqueued adding zip entry and cleanup tasks before finishing the zip file.
-    if (zip_entry_tasks_) {
-        zip_entry_tasks_->run(/* do_cancel = */false);
-    }
+    AddEnqueuedZipEntries();
 
     std::string entry_name = base_name_ + "-" + name_ + ".txt";
     MYLOGD("Adding main entry (%s) from %s to .zip bugreport\n", entry_name.c_str(),
@@ -3685,6 +3787,12 @@ void Dumpstate::EnqueueAddZipEntryAndCleanupIfNeeded(const std::string& entry_na
     }
 }
 
+void Dumpstate::AddEnqueuedZipEntries() {
+    if (zip_entry_tasks_) {
+        zip_entry_tasks_->run(/* do_cancel = */false);
+    }
+}
+
 Dumpstate::RunStatus Dumpstate::HandleUserConsentDenied() {
     MYLOGD("User denied consent; deleting files and returning\n");
     CleanupTmpFiles();
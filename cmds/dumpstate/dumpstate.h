@@ -393,13 +393,23 @@ class Dumpstate {
      * otherwise invokes it immediately. The task adds file at path entry_path
      * as a zip file entry with name entry_name. Unlinks entry_path when done.
      *
-     * All enqueued tasks will be executed in the dumpstate's FinishZipFile method
-     * before the zip file is finished. Tasks will be cancelled in dumpstate's
-     * ShutdownDumpPool method if they have never been called.
+     * Enqueued tasks are executed by AddEnqueuedZipEntries, at the latest in the
+     * dumpstate's FinishZipFile method before the zip file is finished. Tasks will
+     * be cancelled in dumpstate's ShutdownDumpPool method if they have never been
+     * called.
      */
     void EnqueueAddZipEntryAndCleanupIfNeeded(const std::string& entry_name,
             const std::string& entry_path);
 
+    /*
+     * Runs the tasks enqueued by EnqueueAddZipEntryAndCleanupIfNeeded so far. Must
+     * be called from the main thread, which is the only one that writes to the zip
+     * file. It's called whenever a task of the dump pool has finished, so that its
+     * entries are written while the other tasks are still running, rather than all
+     * at the end.
+     */
+    void AddEnqueuedZipEntries();
+
     /*
      * Structure to hold options that determine the behavior of dumpstate.
      */
@@ -18,6 +18,7 @@
 #include <chrono>
 #include <iomanip>
 #include <thread>
+#include <vector>
 
 #include <android-base/file.h>
 #include <android-base/stringprintf.h>
@@ -28,6 +29,7 @@
 #include <binder/ProcessState.h>
 #include <binder/Stability.h>
 #include <binder/TextOutput.h>
+#include <binder/TransactionStats.h>
 #include <binderdebug/BinderDebug.h>
 #include <serviceutils/PriorityDumper.h>
 #include <utils/Log.h>
@@ -66,13 +68,16 @@ static void usage() {
         "         To dump all services.\n"
         "or:\n"
         "       dumpsys [-t TIMEOUT] [--priority LEVEL] [--clients] [--dump] [--pid] [--thread] "
-        "[--help | "
+        "[--binder-stats] [--help | "
         "-l | --skip SERVICES "
         "| SERVICE [ARGS]]\n"
         "         --help: shows this help\n"
         "         -l: only list services, do not dump them\n"
         "         -t TIMEOUT_SEC: TIMEOUT to use in seconds instead of default 10 seconds\n"
         "         -T TIMEOUT_MS: TIMEOUT to use in milliseconds instead of default 10 seconds\n"
+        "         --binder-stats: dump binder transaction stats of the service's process instead\n"
+        "               of usual dump. With SERVICE, ARGS may be start, stop or reset to\n"
+        "               control recording\n"
         "         --clients: dump client PIDs instead of usual dump\n"
         "         --dump: ask the service to dump itself (this is the default)\n"
         "         --pid: dump PID instead of usual dump\n"
@@ -141,7 +146,8 @@ int Dumpsys::main(int argc, char* const argv[]) {
         {"dump", no_argument, 0, 0},           {"pid", no_argument, 0, 0},
         {"priority", required_argument, 0, 0}, {"proto", no_argument, 0, 0},
         {"skip", no_argument, 0, 0},           {"stability", no_argument, 0, 0},
-        {"thread", no_argument, 0, 0},         {0, 0, 0, 0}};
+        {"thread", no_argument, 0, 0},         {"binder-stats", no_argument, 0, 0},
+        {0, 0, 0, 0}};
 
     // Must reset optind, otherwise subsequent calls will fail (wouldn't happen on main.cpp, but
     // happens on test cases).
@@ -182,6 +188,8 @@ int Dumpsys::main(int argc, char* const argv[]) {
                 dumpTypeFlags |= TYPE_THREAD;
             } else if (!strcmp(longOptions[optionIndex].name, "clients")) {
                 dumpTypeFlags |= TYPE_CLIENTS;
+            } else if (!strcmp(longOptions[optionIndex].name, "binder-stats")) {
+                dumpTypeFlags |= TYPE_BINDER_STATS;
             }
             break;
 
@@ -253,12 +261,16 @@ int Dumpsys::main(int argc, char* const argv[]) {
     }
 
     const size_t N = services.size();
+    // The services found while printing the list, so that they aren't looked up again to be
+    // dumped.
+    std::vector<sp<IBinder>> binders(N);
     if (N > 1 || showListOnly) {
         // first print a list of the current services
         std::cout << "Currently running services:" << std::endl;
 
         for (size_t i=0; i<N; i++) {
             sp<IBinder> service = sm_->checkService(services[i]);
+            binders[i] = service;
 
             if (service != nullptr) {
                 bool skipped = IsSkipped(skippedServices, services[i]);
@@ -275,7 +287,10 @@ int Dumpsys::main(int argc, char* const argv[]) {
         const String16& serviceName = services[i];
         if (IsSkipped(skippedServices, serviceName)) continue;
 
-        if (startDumpThread(dumpTypeFlags, serviceName, args) == OK) {
+        status_t startStatus = binders[i] != nullptr
+                ? startDumpThread(dumpTypeFlags, serviceName, binders[i], args)
+                : startDumpThread(dumpTypeFlags, serviceName, args);
+        if (startStatus == OK) {
             bool addSeparator = (N > 1);
             if (addSeparator) {
                 writeDumpHeader(STDOUT_FILENO, serviceName, priorityFlags);
@@ -406,6 +421,40 @@ static status_t dumpClientsToFd(const sp<IBinder>& service, const unique_fd& fd)
     return OK;
 }
 
+static status_t dumpBinderStatsToFd(const sp<IBinder>& service, const Vector<String16>& args,
+                                    const unique_fd& fd) {
+    using binder::debug::TransactionStats;
+
+    // Other arguments, like the -a added when dumping all services, dump.
+    int32_t command = TransactionStats::DUMP;
+    if (!args.empty()) {
+        const String16& arg = args[0];
+        if (arg == String16("start")) {
+            command = TransactionStats::START;
+        } else if (arg == String16("stop")) {
+            command = TransactionStats::STOP;
+        } else if (arg == String16("reset")) {
+            command = TransactionStats::RESET;
+        }
+    }
+
+    Parcel data;
+    Parcel reply;
+    data.writeInt32(command);
+    status_t status = service->transact(IBinder::TRANSACTION_STATS_TRANSACTION, data, &reply);
+    if (status != OK || command != TransactionStats::DUMP) {
+        return status;
+    }
+
+    std::string stats;
+    status = reply.readUtf8FromUtf16(&stats);
+    if (status != OK) {
+        return status;
+    }
+    WriteStringToFd(stats, fd.get());
+    return OK;
+}
+
 static void reportDumpError(const String16& serviceName, status_t error, const char* context) {
     if (error == OK) return;
 
@@ -420,7 +469,11 @@ status_t Dumpsys::startDumpThread(int dumpTypeFlags, const String16& serviceName
         std::cerr << "Can't find service: " << serviceName << std::endl;
         return NAME_NOT_FOUND;
     }
+    return startDumpThread(dumpTypeFlags, serviceName, service, args);
+}
 
+status_t Dumpsys::startDumpThread(int dumpTypeFlags, const String16& serviceName,
+                                  const sp<IBinder>& service, const Vector<String16>& args) {
     int sfd[2];
     if (pipe(sfd) != 0) {
         std::cerr << "Failed to create pipe to dump service info for " << serviceName << ": "
@@ -450,6 +503,10 @@ status_t Dumpsys::startDumpThread(int dumpTypeFlags, const String16& serviceName
             status_t err = dumpClientsToFd(service, remote_end);
             reportDumpError(serviceName, err, "dumping clients info");
         }
+        if (dumpTypeFlags & TYPE_BINDER_STATS) {
+            status_t err = dumpBinderStatsToFd(service, args, remote_end);
+            reportDumpError(serviceName, err, "dumping binder transaction stats");
+        }
 
         // other types always act as a header, this is usually longer
         if (dumpTypeFlags & TYPE_DUMP) {
@@ -501,6 +558,11 @@ status_t Dumpsys::writeDump(int fd, const String16& serviceName, std::chrono::mi
 
     struct pollfd pfd = {.fd = serviceDumpFd, .events = POLLIN};
 
+    // The dump is moved from the pipe to fd without copying it through user space, unless fd
+    // doesn't support it.
+    constexpr size_t kSpliceSize = 64 * 1024;
+    bool useSplice = true;
+
     while (true) {
         // Wrap this in a lambda so that TEMP_FAILURE_RETRY recalculates the timeout.
         auto time_left_ms = [end]() {
@@ -520,6 +582,26 @@ status_t Dumpsys::writeDump(int fd, const String16& serviceName, std::chrono::mi
             break;
         }
 
+        if (useSplice) {
+            rc = TEMP_FAILURE_RETRY(splice(serviceDumpFd, nullptr, fd, nullptr, kSpliceSize,
+                                           SPLICE_F_MOVE | SPLICE_F_NONBLOCK));
+            if (rc < 0 && errno == EINVAL) {
+                // fd can't be spliced to, e.g. because it was opened with O_APPEND.
+                useSplice = false;
+            } else if (rc < 0) {
+                std::cerr << "Failed to splice while dumping service " << serviceName << ": "
+                     << strerror(errno) << std::endl;
+                status = -errno;
+                break;
+            } else if (rc == 0) {
+                // EOF.
+                break;
+            } else {
+                totalBytes += rc;
+                continue;
+            }
+        }
+
         char buf[4096];
         rc = TEMP_FAILURE_RETRY(read(redirectFd_.get(), buf, sizeof(buf)));
         if (rc < 0) {
@@ -57,6 +57,7 @@ class Dumpsys {
         TYPE_STABILITY = 0x4,  // dump stability information of server
         TYPE_THREAD = 0x8,     // dump thread usage of server only
         TYPE_CLIENTS = 0x10,   // dump pid of clients
+        TYPE_BINDER_STATS = 0x20,  // dump binder transaction stats of server
     };
 
     /**
@@ -126,6 +127,12 @@ class Dumpsys {
     }
 
   private:
+    /**
+     * Same as the public {@code startDumpThread}, for a service that has already been looked up.
+     */
+    status_t startDumpThread(int dumpTypeFlags, const String16& serviceName,
+                             const sp<IBinder>& service, const Vector<String16>& args);
+
     android::IServiceManager* sm_;
     std::thread activeThread_;
     mutable android::base::unique_fd redirectFd_;
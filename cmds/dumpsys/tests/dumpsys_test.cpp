@@ -657,6 +657,16 @@ TEST_F(DumpsysTest, ListServiceWithClients) {
     const std::string format("Client PIDs are not available for local binders.\n");
     AssertOutputFormat(format);
 }
+// Tests 'dumpsys --binder-stats service_name'
+TEST_F(DumpsysTest, ListServiceWithBinderStats) {
+    ExpectCheckService("Locksmith");
+
+    CallMain({"--binder-stats", "Locksmith"});
+    // returns an empty string when the caller is not allowed to see the stats
+    const std::string format("(^$|Binder transaction stats \\(not recording\\):\n)");
+    AssertOutputFormat(format);
+}
+
 // Tests 'dumpsys --thread --stability'
 TEST_F(DumpsysTest, ListAllServicesWithMultipleOptions) {
     ExpectListServices({"Locksmith", "Valet"});
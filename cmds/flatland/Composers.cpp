@@ -17,6 +17,8 @@
 #include <GLES2/gl2.h>
 #include <GLES2/gl2ext.h>
 
+#include <algorithm>
+
 #include "Flatland.h"
 #include "GLHelper.h"
 
@@ -25,13 +27,15 @@ namespace android {
 class Blitter {
 public:
 
-    bool setUp(GLHelper* helper) {
+    bool setUp(GLHelper* helper, const char* programName = "Blit",
+            GLenum texTarget = GL_TEXTURE_EXTERNAL_OES) {
         bool result;
 
-        result = helper->getShaderProgram("Blit", &mBlitPgm);
+        result = helper->getShaderProgram(programName, &mBlitPgm);
         if (!result) {
             return false;
         }
+        mTexTarget = texTarget;
 
         mPosAttribLoc = glGetAttribLocation(mBlitPgm, "position");
         mUVAttribLoc = glGetAttribLocation(mBlitPgm, "uv");
@@ -39,10 +43,15 @@ public:
         mObjToNdcUniformLoc = glGetUniformLocation(mBlitPgm, "objToNdc");
         mBlitSrcSamplerLoc = glGetUniformLocation(mBlitPgm, "blitSrc");
         mModColorUniformLoc = glGetUniformLocation(mBlitPgm, "modColor");
+        mLayerSizeUniformLoc = glGetUniformLocation(mBlitPgm, "layerSize");
 
         return true;
     }
 
+    GLuint program() const {
+        return mBlitPgm;
+    }
+
     bool blit(GLuint texName, const float* texMatrix,
             int32_t x, int32_t y, uint32_t w, uint32_t h) {
         float modColor[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
@@ -82,9 +91,12 @@ public:
         glUniformMatrix4fv(mObjToNdcUniformLoc, 1, GL_FALSE, screenToNdc);
         glUniformMatrix4fv(mUVToTexUniformLoc, 1, GL_FALSE, texMatrix);
         glUniform4fv(mModColorUniformLoc, 1, modColor);
+        if (mLayerSizeUniformLoc >= 0) {
+            glUniform2f(mLayerSizeUniformLoc, float(w), float(h));
+        }
 
         glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_EXTERNAL_OES, texName);
+        glBindTexture(mTexTarget, texName);
         glUniform1i(mBlitSrcSamplerLoc, 0);
 
         glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
@@ -101,12 +113,14 @@ public:
 
 private:
     GLuint mBlitPgm;
+    GLenum mTexTarget;
     GLint mPosAttribLoc;
     GLint mUVAttribLoc;
     GLint mUVToTexUniformLoc;
     GLint mObjToNdcUniformLoc;
     GLint mBlitSrcSamplerLoc;
     GLint mModColorUniformLoc;
+    GLint mLayerSizeUniformLoc;
 };
 
 class ComposerBase : public Composer {
@@ -282,4 +296,155 @@ Composer* blendShrink() {
     return new BlendShrinkComp();
 }
 
+// Blends the layer with rounded corners, as RenderEngine draws windows.
+Composer* roundedBlend() {
+    class RoundedBlendComp : public ComposerBase {
+        virtual bool setUp(GLHelper* helper) {
+            return mBlitter.setUp(helper, "RoundedBlit");
+        }
+
+        virtual bool compose(GLuint texName, const sp<GLConsumer>& glc) {
+            bool result;
+
+            float texMatrix[16];
+            glc->getTransformMatrix(texMatrix);
+
+            float modColor[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+
+            int32_t x = mLayerDesc.x;
+            int32_t y = mLayerDesc.y;
+            int32_t w = mLayerDesc.width;
+            int32_t h = mLayerDesc.height;
+
+            glUseProgram(mBlitter.program());
+            glUniform1f(glGetUniformLocation(mBlitter.program(), "cornerRadius"),
+                    float(std::min(w, h)) / 16.0f);
+
+            glEnable(GL_BLEND);
+            glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+            result = mBlitter.modBlit(texName, texMatrix, modColor,
+                    x, y, w, h);
+            if (!result) {
+                return false;
+            }
+
+            glDisable(GL_BLEND);
+
+            return true;
+        }
+
+        Blitter mBlitter;
+    };
+    return new RoundedBlendComp();
+}
+
+// Blurs what is behind the layer, then blends the layer over it, as RenderEngine draws
+// layers with a background blur.
+Composer* blurBehind() {
+    class BlurBehindComp : public ComposerBase {
+        virtual bool setUp(GLHelper* helper) {
+            bool result;
+
+            result = mBlurBlitter.setUp(helper, "BlurBlit", GL_TEXTURE_2D);
+            if (!result) {
+                return false;
+            }
+
+            result = mBlitter.setUp(helper);
+            if (!result) {
+                return false;
+            }
+
+            glGenTextures(1, &mBackgroundTexName);
+            glBindTexture(GL_TEXTURE_2D, mBackgroundTexName);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, mLayerDesc.width,
+                    mLayerDesc.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+            return true;
+        }
+
+        virtual void tearDown() {
+            glDeleteTextures(1, &mBackgroundTexName);
+        }
+
+        virtual bool compose(GLuint texName, const sp<GLConsumer>& glc) {
+            bool result;
+
+            int32_t x = mLayerDesc.x;
+            int32_t y = mLayerDesc.y;
+            int32_t w = mLayerDesc.width;
+            int32_t h = mLayerDesc.height;
+
+            // Copy what is behind the layer. GL's origin is the bottom left corner.
+            GLint vp[4];
+            glGetIntegerv(GL_VIEWPORT, vp);
+            glBindTexture(GL_TEXTURE_2D, mBackgroundTexName);
+            glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, x, vp[3] - y - h, w, h);
+
+            const float flipMatrix[16] = {
+                1.0f, 0.0f,  0.0f, 0.0f,
+                0.0f, -1.0f, 0.0f, 0.0f,
+                0.0f, 0.0f,  1.0f, 0.0f,
+                0.0f, 1.0f,  0.0f, 1.0f,
+            };
+            result = mBlurBlitter.blit(mBackgroundTexName, flipMatrix, x, y, w, h);
+            if (!result) {
+                return false;
+            }
+
+            float texMatrix[16];
+            glc->getTransformMatrix(texMatrix);
+
+            float modColor[4] = { .5f, .5f, .5f, .5f };
+
+            glEnable(GL_BLEND);
+            glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+            result = mBlitter.modBlit(texName, texMatrix, modColor,
+                    x, y, w, h);
+            if (!result) {
+                return false;
+            }
+
+            glDisable(GL_BLEND);
+
+            return true;
+        }
+
+        Blitter mBlurBlitter;
+        Blitter mBlitter;
+        GLuint mBackgroundTexName;
+    };
+    return new BlurBehindComp();
+}
+
+// Tone maps a PQ encoded layer to the display, as RenderEngine draws HDR layers.
+Composer* hdrToneMap() {
+    class HdrToneMapComp : public ComposerBase {
+        virtual bool setUp(GLHelper* helper) {
+            return mBlitter.setUp(helper, "HdrBlit");
+        }
+
+        virtual bool compose(GLuint texName, const sp<GLConsumer>& glc) {
+            float texMatrix[16];
+            glc->getTransformMatrix(texMatrix);
+
+            int32_t x = mLayerDesc.x;
+            int32_t y = mLayerDesc.y;
+            int32_t w = mLayerDesc.width;
+            int32_t h = mLayerDesc.height;
+
+            return mBlitter.blit(texName, texMatrix, x, y, w, h);
+        }
+
+        Blitter mBlitter;
+    };
+    return new HdrToneMapComp();
+}
+
 } // namespace android
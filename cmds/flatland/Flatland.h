@@ -57,6 +57,9 @@ Composer* opaque();
 Composer* opaqueShrink();
 Composer* blend();
 Composer* blendShrink();
+Composer* roundedBlend();
+Composer* blurBehind();
+Composer* hdrToneMap();
 
 class Renderer {
 public:
@@ -30,6 +30,8 @@
 #include <math.h>
 #include <getopt.h>
 
+#include <algorithm>
+
 #include "Flatland.h"
 #include "GLHelper.h"
 
@@ -203,8 +205,118 @@ static const BenchmarkDesc benchmarks[] = {
             },
         },
     },
+
+    { "20:9 Rounded Window Over Blur",
+        1080, 2400, { 2400, 3200 },
+        {
+            {   // Wallpaper
+                0, staticGradient, opaque,
+                0,    0,      1080,   2400,
+            },
+            {   // Launcher
+                0, staticGradient, blend,
+                0,    0,      1080,   2400,
+            },
+            {   // Blurred scrim
+                0, staticGradient, blurBehind,
+                0,    0,      1080,   2400,
+            },
+            {   // Dialog
+                0, staticGradient, roundedBlend,
+                90,   700,    900,    1000,
+            },
+            {   // Status bar
+                0, staticGradient, blend,
+                0,    0,      1080,   130,
+            },
+            {   // Navigation bar
+                0, staticGradient, blend,
+                0,    2270,   1080,   130,
+            },
+        },
+    },
+
+    { "20:9 HDR Video With Controls",
+        1080, 2400, { 2400, 3200 },
+        {
+            {   // Activity
+                0, staticGradient, opaque,
+                0,    0,      1080,   2400,
+            },
+            {   // HDR video
+                0, staticGradient, hdrToneMap,
+                0,    600,    1080,   608,
+            },
+            {   // Playback controls
+                0, staticGradient, roundedBlend,
+                40,   1250,   1000,   300,
+            },
+            {   // Status bar
+                0, staticGradient, blend,
+                0,    0,      1080,   130,
+            },
+            {   // Navigation bar
+                0, staticGradient, blend,
+                0,    2270,   1080,   130,
+            },
+        },
+    },
+
+    { "20:9 Many Small Layers",
+        1080, 2400, { 2400, 3200 },
+        {
+            {   // Wallpaper
+                0, staticGradient, opaque,
+                0,    0,      1080,   2400,
+            },
+            // Widgets and badges
+            { 0, staticGradient, roundedBlend,   60,  300, 280, 280 },
+            { 0, staticGradient, roundedBlend,  400,  300, 280, 280 },
+            { 0, staticGradient, roundedBlend,  740,  300, 280, 280 },
+            { 0, staticGradient, roundedBlend,   60,  640, 280, 280 },
+            { 0, staticGradient, roundedBlend,  400,  640, 280, 280 },
+            { 0, staticGradient, roundedBlend,  740,  640, 280, 280 },
+            { 0, staticGradient, roundedBlend,   60,  980, 280, 280 },
+            { 0, staticGradient, roundedBlend,  400,  980, 280, 280 },
+            { 0, staticGradient, roundedBlend,  740,  980, 280, 280 },
+            { 0, staticGradient, roundedBlend,   60, 1320, 960, 400 },
+            { 0, staticGradient, blend,         900, 1800, 120, 120 },
+            { 0, staticGradient, blend,          60, 1800, 120, 120 },
+            { 0, staticGradient, roundedBlend,   60, 2000, 960, 200 },
+            {   // Status bar
+                0, staticGradient, blend,
+                0,    0,      1080,   130,
+            },
+            {   // Navigation bar
+                0, staticGradient, blend,
+                0,    2270,   1080,   130,
+            },
+        },
+    },
 };
 
+// The kinds of layers for which the capacity mode finds how many full screen layers can be
+// composed within a frame at each refresh rate.
+struct CapacityLayerDesc {
+    const char* name;
+    Composer* (*composerFactory)();
+};
+
+static const CapacityLayerDesc capacityLayers[] = {
+    { "Blend",         blend },
+    { "Rounded blend", roundedBlend },
+    { "Blur behind",   blurBehind },
+    { "HDR",           hdrToneMap },
+};
+
+static const uint32_t capacityResolutions[][2] = {
+    { 1080, 2400 },
+    { 1440, 3200 },
+    { 2560, 1600 },
+};
+
+static const uint32_t capacityRefreshRates[] = { 60, 90, 120 };
+
 static const ShaderDesc shaders[] = {
     {
         .name="Blit",
@@ -240,6 +352,136 @@ static const ShaderDesc shaders[] = {
         },
     },
 
+    {
+        .name="RoundedBlit",
+        .vertexShader={
+            "precision mediump float;",
+            "",
+            "attribute vec4 position;",
+            "attribute vec4 uv;",
+            "",
+            "varying vec4 texCoords;",
+            "varying vec2 layerCoords;",
+            "",
+            "uniform mat4 objToNdc;",
+            "uniform mat4 uvToTex;",
+            "uniform vec2 layerSize;",
+            "",
+            "void main() {",
+            "    gl_Position = objToNdc * position;",
+            "    texCoords = uvToTex * uv;",
+            "    layerCoords = uv.xy * layerSize;",
+            "}",
+        },
+        .fragmentShader={
+            "#extension GL_OES_EGL_image_external : require",
+            "precision mediump float;",
+            "",
+            "varying vec4 texCoords;",
+            "varying vec2 layerCoords;",
+            "",
+            "uniform samplerExternalOES blitSrc;",
+            "uniform vec4 modColor;",
+            "uniform vec2 layerSize;",
+            "uniform float cornerRadius;",
+            "",
+            "void main() {",
+            "    vec2 halfSize = layerSize * 0.5;",
+            "    vec2 q = abs(layerCoords - halfSize) - (halfSize - vec2(cornerRadius));",
+            "    float dist = length(max(q, 0.0)) - cornerRadius;",
+            "    float coverage = clamp(0.5 - dist, 0.0, 1.0);",
+            "    gl_FragColor = texture2D(blitSrc, texCoords.xy) * modColor * coverage;",
+            "}",
+        },
+    },
+
+    {
+        .name="BlurBlit",
+        .vertexShader={
+            "precision mediump float;",
+            "",
+            "attribute vec4 position;",
+            "attribute vec4 uv;",
+            "",
+            "varying vec4 texCoords;",
+            "",
+            "uniform mat4 objToNdc;",
+            "uniform mat4 uvToTex;",
+            "",
+            "void main() {",
+            "    gl_Position = objToNdc * position;",
+            "    texCoords = uvToTex * uv;",
+            "}",
+        },
+        .fragmentShader={
+            "precision mediump float;",
+            "",
+            "varying vec4 texCoords;",
+            "",
+            "uniform sampler2D blitSrc;",
+            "uniform vec4 modColor;",
+            "uniform vec2 layerSize;",
+            "",
+            "void main() {",
+            "    vec2 step = 4.0 / layerSize;",
+            "    vec4 sum = vec4(0.0);",
+            "    for (int i = -1; i <= 1; i++) {",
+            "        for (int j = -1; j <= 1; j++) {",
+            "            sum += texture2D(blitSrc,",
+            "                    texCoords.xy + vec2(float(i), float(j)) * step);",
+            "        }",
+            "    }",
+            "    gl_FragColor = sum / 9.0 * modColor;",
+            "}",
+        },
+    },
+
+    {
+        .name="HdrBlit",
+        .vertexShader={
+            "precision mediump float;",
+            "",
+            "attribute vec4 position;",
+            "attribute vec4 uv;",
+            "",
+            "varying vec4 texCoords;",
+            "",
+            "uniform mat4 objToNdc;",
+            "uniform mat4 uvToTex;",
+            "",
+            "void main() {",
+            "    gl_Position = objToNdc * position;",
+            "    texCoords = uvToTex * uv;",
+            "}",
+        },
+        .fragmentShader={
+            "#extension GL_OES_EGL_image_external : require",
+            "precision highp float;",
+            "",
+            "varying vec4 texCoords;",
+            "",
+            "uniform samplerExternalOES blitSrc;",
+            "uniform vec4 modColor;",
+            "",
+            "vec3 pqToNits(vec3 e) {",
+            "    const float m1 = 0.1593017578125;",
+            "    const float m2 = 78.84375;",
+            "    const float c1 = 0.8359375;",
+            "    const float c2 = 18.8515625;",
+            "    const float c3 = 18.6875;",
+            "    vec3 p = pow(max(e, 0.0), vec3(1.0 / m2));",
+            "    return pow(max(p - c1, 0.0) / (c2 - c3 * p), vec3(1.0 / m1)) * 10000.0;",
+            "}",
+            "",
+            "void main() {",
+            "    vec4 color = texture2D(blitSrc, texCoords.xy);",
+            "    vec3 nits = pqToNits(color.rgb);",
+            "    vec3 mapped = nits / (nits + vec3(1000.0));",
+            "    gl_FragColor = vec4(pow(mapped, vec3(1.0 / 2.2)), color.a) * modColor;",
+            "}",
+        },
+    },
+
     {
         .name="Gradient",
         .vertexShader={
@@ -579,6 +821,104 @@ private:
     Layer mLayers[MAX_NUM_LAYERS];
 };
 
+// Returns the median time in ns of a frame over a few samples that each run for at least 50 ms,
+// or a negative value on error.
+static double measureFrameTime(BenchmarkRunner& r) {
+    uint32_t warmUpFrames = 1;
+    uint32_t totalFrames = 5;
+
+    double runTime = 0.0;
+    while (true) {
+        runTime = double(r.run(warmUpFrames, totalFrames));
+        if (runTime < 0.0) {
+            return -1.0;
+        }
+        if (runTime >= 50e6) {
+            break;
+        }
+        warmUpFrames *= 2;
+        totalFrames *= 2;
+    }
+
+    double samples[5];
+    for (size_t i = 0; i < NELEMS(samples); i++) {
+        samples[i] = double(r.run(warmUpFrames, totalFrames));
+        if (g_SleepBetweenSamplesMs > 0) {
+            usleep(g_SleepBetweenSamplesMs * 1000);
+        }
+        if (samples[i] < 0.0) {
+            return -1.0;
+        }
+    }
+    std::sort(samples, samples + NELEMS(samples));
+    return samples[NELEMS(samples) / 2] / double(totalFrames - warmUpFrames);
+}
+
+// Finds, for each kind of layer and resolution, the maximum number of full screen layers of that
+// kind over an opaque background that can be composed at each refresh rate.
+static bool runCapacityTests() {
+    printf(" Layer kind    | Resolution  |");
+    for (size_t i = 0; i < NELEMS(capacityRefreshRates); i++) {
+        printf(" %3u Hz |", capacityRefreshRates[i]);
+    }
+    printf("\n");
+
+    for (size_t i = 0; i < NELEMS(capacityLayers); i++) {
+        for (size_t j = 0; j < NELEMS(capacityResolutions); j++) {
+            const uint32_t w = capacityResolutions[j][0];
+            const uint32_t h = capacityResolutions[j][1];
+            printf(" %-13s | %4u x %4u |", capacityLayers[i].name, w, h);
+            fflush(stdout);
+
+            int maxLayers[NELEMS(capacityRefreshRates)] = {};
+            const double longestBudget = 1e9 / double(capacityRefreshRates[0]);
+            for (size_t numLayers = 1; numLayers < MAX_NUM_LAYERS; numLayers++) {
+                BenchmarkDesc desc = {};
+                desc.name = capacityLayers[i].name;
+                desc.width = w;
+                desc.height = h;
+                desc.runHeights[0] = h;
+                desc.layers[0] = { 0, staticGradient, opaque, 0, 0, w, h };
+                for (size_t k = 1; k <= numLayers; k++) {
+                    desc.layers[k] = { 0, staticGradient, capacityLayers[i].composerFactory,
+                            0, 0, w, h };
+                }
+
+                BenchmarkRunner r(desc, 0);
+                if (!r.setUp()) {
+                    fprintf(stderr, "error initializing runner.\n");
+                    return false;
+                }
+                const double frameTime = measureFrameTime(r);
+                r.tearDown();
+                if (frameTime < 0.0) {
+                    return false;
+                }
+
+                for (size_t k = 0; k < NELEMS(capacityRefreshRates); k++) {
+                    if (frameTime <= 1e9 / double(capacityRefreshRates[k])) {
+                        maxLayers[k] = int(numLayers);
+                    }
+                }
+                if (frameTime > longestBudget) {
+                    break;
+                }
+            }
+
+            for (size_t k = 0; k < NELEMS(capacityRefreshRates); k++) {
+                if (maxLayers[k] == MAX_NUM_LAYERS - 1) {
+                    printf("   %2d+ |", maxLayers[k]);
+                } else {
+                    printf("   %3d |", maxLayers[k]);
+                }
+            }
+            printf("\n");
+            fflush(stdout);
+        }
+    }
+    return true;
+}
+
 static int cmpDouble(const double* lhs, const double* rhs) {
     if (*lhs < *rhs) {
         return -1;
@@ -727,6 +1067,9 @@ static void showHelp(const char* cmd) {
       "options include:\n"
       "  -s N            sleep for N ms between samples\n"
       "  -d              display the test frame to a window\n"
+      "  -c              find the maximum number of layers of each kind that can be\n"
+      "                  composed at each refresh rate, instead of running the\n"
+      "                  scenarios\n"
       "  -i display-id   specify a display ID to use for multi-display device\n"
       "                  see \"dumpsys SurfaceFlinger --display-id\" for valid "
       "display IDs\n"
@@ -746,6 +1089,7 @@ int main(int argc, char** argv) {
     }
 
     std::optional<PhysicalDisplayId> displayId;
+    bool capacity = false;
 
     for (;;) {
         int ret;
@@ -755,7 +1099,7 @@ int main(int argc, char** argv) {
             {     0,               0, 0,  0 }
         };
 
-        ret = getopt_long(argc, argv, "ds:i:",
+        ret = getopt_long(argc, argv, "cds:i:",
                           long_options, &option_index);
 
         if (ret < 0) {
@@ -763,6 +1107,10 @@ int main(int argc, char** argv) {
         }
 
         switch(ret) {
+            case 'c':
+                capacity = true;
+            break;
+
             case 'd':
                 g_PresentToWindow = true;
             break;
@@ -816,7 +1164,7 @@ int main(int argc, char** argv) {
     }
     printf("\n");
 
-    if (!runTests()) {
+    if (!(capacity ? runCapacityTests() : runTests())) {
         fprintf(stderr, "exiting due to error.\n");
         return 1;
     }
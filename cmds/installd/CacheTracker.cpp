@@ -58,6 +58,7 @@ void CacheTracker::loadStats() {
     ATRACE_BEGIN("loadStats quota");
     cacheUsed = 0;
     if (loadQuotaStats()) {
+        ATRACE_END();
         return;
     }
     ATRACE_END();
@@ -36,9 +36,12 @@
 #include <sys/xattr.h>
 #include <unistd.h>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <filesystem>
 #include <fstream>
 #include <functional>
+#include <map>
 #include <regex>
 #include <thread>
 #include <unordered_set>
@@ -58,7 +61,6 @@
 #include <cutils/sched_policy.h>
 #include <linux/quota.h>
 #include <log/log.h>               // TODO: Move everything to base/logging.
-#include <logwrap/logwrap.h>
 #include <private/android_filesystem_config.h>
 #include <private/android_projectid_config.h>
 #include <selinux/android.h>
@@ -98,7 +100,6 @@ static constexpr const char* kTestUuid = "TEST";
 
 static constexpr const mode_t kRollbackFolderMode = 0700;
 
-static constexpr const char* kCpPath = "/system/bin/cp";
 static constexpr const char* kXattrDefault = "user.default";
 
 static constexpr const char* kDataMirrorCePath = "/data_mirror/data_ce";
@@ -996,13 +997,39 @@ binder::Status InstalldNativeService::createAppDataBatched(
 
     // Locking is performed depeer in the callstack.
 
-    std::vector<android::os::CreateAppDataResult> results;
-    for (const auto &arg : args) {
-        android::os::CreateAppDataResult result;
-        createAppData(arg, &result);
-        results.push_back(result);
+    // The packages of different volumes and users don't share any directory, so each group of
+    // them is created on its own thread, in the order of the batch. The helper threads aren't
+    // binder threads, so the permission checks of createAppData() see installd itself.
+    std::map<std::pair<std::optional<std::string>, int32_t>, std::vector<size_t>> groups;
+    for (size_t i = 0; i < args.size(); i++) {
+        groups[{args[i].uuid, args[i].userId}].push_back(i);
+    }
+    std::vector<const std::vector<size_t>*> groupList;
+    for (const auto& [volumeAndUser, indices] : groups) {
+        groupList.push_back(&indices);
+    }
+
+    std::vector<android::os::CreateAppDataResult> results(args.size());
+    constexpr unsigned kMaxThreads = 4;
+    const size_t threadCount = std::min<size_t>(
+            groupList.size(), std::clamp(std::thread::hardware_concurrency(), 1u, kMaxThreads));
+    std::atomic<size_t> next = 0;
+    auto createGroups = [&]() {
+        for (size_t i = next++; i < groupList.size(); i = next++) {
+            for (size_t index : *groupList[i]) {
+                createAppData(args[index], &results[index]);
+            }
+        }
+    };
+    std::vector<std::thread> helpers;
+    for (size_t i = 1; i < threadCount; i++) {
+        helpers.emplace_back(createGroups);
     }
-    *_aidl_return = results;
+    createGroups();
+    for (std::thread& helper : helpers) {
+        helper.join();
+    }
+    *_aidl_return = std::move(results);
     return ok();
 }
 
@@ -1563,21 +1590,6 @@ binder::Status InstalldNativeService::fixupAppData(const std::optional<std::stri
     return ok();
 }
 
-static int32_t copy_directory_recursive(const char* from, const char* to) {
-    char* argv[] =
-            {(char*)kCpPath,
-             (char*)"-F", /* delete any existing destination file first (--remove-destination) */
-             (char*)"--preserve=mode,ownership,timestamps,xattr", /* preserve properties */
-             (char*)"-R", /* recurse into subdirectories (DEST must be a directory) */
-             (char*)"-P", /* Do not follow symlinks [default] */
-             (char*)"-d", /* don't dereference symlinks */
-             (char*)from,
-             (char*)to};
-
-    LOG(DEBUG) << "Copying " << from << " to " << to;
-    return logwrap_fork_execvp(ARRAY_SIZE(argv), argv, nullptr, false, LOG_ALOG, false, nullptr);
-}
-
 binder::Status InstalldNativeService::snapshotAppData(const std::optional<std::string>& volumeUuid,
                                                       const std::string& packageName,
                                                       int32_t userId, int32_t snapshotId,
@@ -2086,6 +2098,28 @@ binder::Status InstalldNativeService::destroyUserData(const std::optional<std::s
     return res;
 }
 
+// Loads the stats of the trackers on a few threads. Each tracker only measures the cache of its own
+// UID, through quotas or by walking its cache directories, so they don't share any state.
+static void loadCacheTrackerStats(const std::vector<std::shared_ptr<CacheTracker>>& trackers) {
+    constexpr unsigned kMaxThreads = 4;
+    const size_t threadCount = std::min<size_t>(
+            trackers.size(), std::clamp(std::thread::hardware_concurrency(), 1u, kMaxThreads));
+    std::atomic<size_t> next = 0;
+    auto loadStats = [&trackers, &next]() {
+        for (size_t i = next++; i < trackers.size(); i = next++) {
+            trackers[i]->loadStats();
+        }
+    };
+    std::vector<std::thread> helpers;
+    for (size_t i = 1; i < threadCount; i++) {
+        helpers.emplace_back(loadStats);
+    }
+    loadStats();
+    for (std::thread& helper : helpers) {
+        helper.join();
+    }
+}
+
 binder::Status InstalldNativeService::freeCache(const std::optional<std::string>& uuid,
         int64_t targetFreeBytes, int32_t flags) {
     ENFORCE_UID(AID_SYSTEM);
@@ -2208,17 +2242,23 @@ binder::Status InstalldNativeService::freeCache(const std::optional<std::string>
         auto cmp = [](std::shared_ptr<CacheTracker> left, std::shared_ptr<CacheTracker> right) {
             return (left->getCacheRatio() < right->getCacheRatio());
         };
-        std::priority_queue<std::shared_ptr<CacheTracker>,
-                std::vector<std::shared_ptr<CacheTracker>>, decltype(cmp)> queue(cmp);
+        std::vector<std::shared_ptr<CacheTracker>> trackerList;
+        trackerList.reserve(trackers.size());
         for (const auto& it : trackers) {
-            it.second->loadStats();
-            queue.push(it.second);
+            trackerList.push_back(it.second);
         }
+        loadCacheTrackerStats(trackerList);
+        std::priority_queue<std::shared_ptr<CacheTracker>,
+                std::vector<std::shared_ptr<CacheTracker>>, decltype(cmp)>
+                queue(cmp, std::move(trackerList));
         atrace_pm_end();
 
         // 3. Bounce across the queue, freeing items from whichever tracker is
         // the most over their assigned quota
         atrace_pm_begin("bounce");
+        const auto purgeStart = std::chrono::steady_clock::now();
+        int64_t purgedBytes = 0;
+        size_t purgedItems = 0;
         std::shared_ptr<CacheTracker> active;
         while (active || !queue.empty()) {
             // Only look at apps under quota when explicitly requested
@@ -2258,6 +2298,8 @@ binder::Status InstalldNativeService::freeCache(const std::optional<std::string>
                 }
                 active->cacheUsed -= item->size;
                 needed -= item->size;
+                purgedBytes += item->size;
+                purgedItems++;
             }
 
             if (!defy_target) {
@@ -2275,6 +2317,12 @@ binder::Status InstalldNativeService::freeCache(const std::optional<std::string>
             }
         }
         atrace_pm_end();
+        LOG(INFO) << "Purged " << purgedItems << " cache items of " << purgedBytes << " bytes from "
+                  << trackers.size() << " UIDs in "
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(
+                             std::chrono::steady_clock::now() - purgeStart)
+                             .count()
+                  << "ms" << (noop ? " (noop)" : "");
 
     } else {
         return error("Legacy cache logic no longer supported");
@@ -2581,6 +2629,39 @@ binder::Status InstalldNativeService::getAppSize(const std::optional<std::string
         int32_t appId, const std::vector<int64_t>& ceDataInodes,
         const std::vector<std::string>& codePaths, std::vector<int64_t>* _aidl_return) {
     ENFORCE_UID(AID_SYSTEM);
+    std::unordered_map<std::string, bool> quotaSupportedByUuid;
+    return measureAppSize(uuid, packageNames, userId, flags, appId, ceDataInodes, codePaths,
+                          &quotaSupportedByUuid, _aidl_return);
+}
+
+binder::Status InstalldNativeService::getAppSizeBatched(
+        const std::vector<android::os::GetAppSizeArgs>& args,
+        std::vector<android::os::GetAppSizeResult>* _aidl_return) {
+    ENFORCE_UID(AID_SYSTEM);
+    // Locking is relaxed, as in getAppSize.
+
+    std::unordered_map<std::string, bool> quotaSupportedByUuid;
+    std::vector<android::os::GetAppSizeResult> results;
+    results.reserve(args.size());
+    for (const auto& arg : args) {
+        android::os::GetAppSizeResult result;
+        auto status = measureAppSize(arg.uuid, arg.packageNames, arg.userId, arg.flags, arg.appId,
+                                     arg.ceDataInodes, arg.codePaths, &quotaSupportedByUuid,
+                                     &result.sizes);
+        result.exceptionCode = status.exceptionCode();
+        result.exceptionMessage = status.exceptionMessage();
+        results.push_back(std::move(result));
+    }
+    *_aidl_return = std::move(results);
+    return ok();
+}
+
+binder::Status InstalldNativeService::measureAppSize(const std::optional<std::string>& uuid,
+        const std::vector<std::string>& packageNames, int32_t userId, int32_t flags,
+        int32_t appId, const std::vector<int64_t>& ceDataInodes,
+        const std::vector<std::string>& codePaths,
+        std::unordered_map<std::string, bool>* quotaSupportedByUuid,
+        std::vector<int64_t>* _aidl_return) {
     CHECK_ARGUMENT_UUID(uuid);
     if (packageNames.size() != ceDataInodes.size()) {
         return exception(binder::Status::EX_ILLEGAL_ARGUMENT,
@@ -2623,7 +2704,12 @@ binder::Status InstalldNativeService::getAppSize(const std::optional<std::string
     auto uuidString = uuid.value_or("");
     const char* uuid_ = uuid ? uuid->c_str() : nullptr;
 
-    if (!IsQuotaSupported(uuidString)) {
+    auto quotaSupported = quotaSupportedByUuid->find(uuidString);
+    if (quotaSupported == quotaSupportedByUuid->end()) {
+        quotaSupported =
+                quotaSupportedByUuid->emplace(uuidString, IsQuotaSupported(uuidString)).first;
+    }
+    if (!quotaSupported->second) {
         flags &= ~FLAG_USE_QUOTA;
     }
 
@@ -3417,6 +3503,40 @@ binder::Status InstalldNativeService::restoreconAppData(const std::optional<std:
     return restoreconAppDataLocked(uuid, packageName, userId, flags, appId, seInfo);
 }
 
+// Runs a recursive restorecon of the trees on up to four threads, since they don't overlap.
+// Returns the trees that couldn't be relabeled.
+static std::vector<std::string> restorecon_pkgdirs(const std::vector<std::string>& paths,
+                                                   const char* seinfo, uid_t uid,
+                                                   unsigned int seflags) {
+    constexpr unsigned kMaxThreads = 4;
+    const size_t threadCount = std::min<size_t>(
+            paths.size(), std::clamp(std::thread::hardware_concurrency(), 1u, kMaxThreads));
+    // Not a vector<bool>, whose elements share bytes and can't be written by several threads.
+    std::vector<char> failed(paths.size(), false);
+    std::atomic<size_t> next = 0;
+    auto restorecon = [&]() {
+        for (size_t i = next++; i < paths.size(); i = next++) {
+            failed[i] = selinux_android_restorecon_pkgdir(paths[i].c_str(), seinfo, uid,
+                                                          seflags) < 0;
+        }
+    };
+    std::vector<std::thread> helpers;
+    for (size_t i = 1; i < threadCount; i++) {
+        helpers.emplace_back(restorecon);
+    }
+    restorecon();
+    for (std::thread& helper : helpers) {
+        helper.join();
+    }
+    std::vector<std::string> failedPaths;
+    for (size_t i = 0; i < paths.size(); i++) {
+        if (failed[i]) {
+            failedPaths.push_back(paths[i]);
+        }
+    }
+    return failedPaths;
+}
+
 binder::Status InstalldNativeService::restoreconAppDataLocked(
         const std::optional<std::string>& uuid, const std::string& packageName, int32_t userId,
         int32_t flags, int32_t appId, const std::string& seInfo) {
@@ -3434,17 +3554,15 @@ binder::Status InstalldNativeService::restoreconAppDataLocked(
     const char* seinfo = seInfo.c_str();
 
     uid_t uid = multiuser_get_uid(userId, appId);
+    std::vector<std::string> paths;
     if (flags & FLAG_STORAGE_CE) {
-        auto path = create_data_user_ce_package_path(uuid_, userId, pkgName);
-        if (selinux_android_restorecon_pkgdir(path.c_str(), seinfo, uid, seflags) < 0) {
-            res = error("restorecon failed for " + path);
-        }
+        paths.push_back(create_data_user_ce_package_path(uuid_, userId, pkgName));
     }
     if (flags & FLAG_STORAGE_DE) {
-        auto path = create_data_user_de_package_path(uuid_, userId, pkgName);
-        if (selinux_android_restorecon_pkgdir(path.c_str(), seinfo, uid, seflags) < 0) {
-            res = error("restorecon failed for " + path);
-        }
+        paths.push_back(create_data_user_de_package_path(uuid_, userId, pkgName));
+    }
+    for (const auto& path : restorecon_pkgdirs(paths, seinfo, uid, seflags)) {
+        res = error("restorecon failed for " + path);
     }
     return res;
 }
@@ -3466,6 +3584,8 @@ binder::Status InstalldNativeService::restoreconSdkDataLocked(
     const char* seinfo = seInfo.c_str();
 
     uid_t uid = multiuser_get_sdk_sandbox_uid(userId, appId);
+    // The subdirectories of both storages are relabeled together, once they have all been found.
+    std::vector<std::string> paths;
     constexpr int storageFlags[2] = {FLAG_STORAGE_CE, FLAG_STORAGE_DE};
     for (int currentFlag : storageFlags) {
         if ((flags & currentFlag) == 0) {
@@ -3478,18 +3598,17 @@ binder::Status InstalldNativeService::restoreconSdkDataLocked(
             LOG(INFO) << "Missing source " << packagePath;
             continue;
         }
-        const auto subDirHandler = [&packagePath, &seinfo, &uid, &seflags,
-                                    &res](const std::string& subDir) {
-            const auto& fullpath = packagePath + "/" + subDir;
-            if (selinux_android_restorecon_pkgdir(fullpath.c_str(), seinfo, uid, seflags) < 0) {
-                res = error("restorecon failed for " + fullpath);
-            }
+        const auto subDirHandler = [&packagePath, &paths](const std::string& subDir) {
+            paths.push_back(packagePath + "/" + subDir);
         };
         const auto ec = foreach_subdir(packagePath, subDirHandler);
         if (ec != 0) {
             res = error("Failed to restorecon for subdirs of " + packagePath);
         }
     }
+    for (const auto& path : restorecon_pkgdirs(paths, seinfo, uid, seflags)) {
+        res = error("restorecon failed for " + path);
+    }
     return res;
 }
 
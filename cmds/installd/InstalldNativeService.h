@@ -108,6 +108,8 @@ public:
             const std::vector<std::string>& packageNames, int32_t userId, int32_t flags,
             int32_t appId, const std::vector<int64_t>& ceDataInodes,
             const std::vector<std::string>& codePaths, std::vector<int64_t>* _aidl_return);
+    binder::Status getAppSizeBatched(const std::vector<android::os::GetAppSizeArgs>& args,
+            std::vector<android::os::GetAppSizeResult>* _aidl_return);
     binder::Status getUserSize(const std::optional<std::string>& uuid,
             int32_t userId, int32_t flags, const std::vector<int32_t>& appIds,
             std::vector<int64_t>* _aidl_return);
@@ -231,6 +233,15 @@ private:
 
     std::string findDataMediaPath(const std::optional<std::string>& uuid, userid_t userid);
 
+    // Measures the apps of one uid for getAppSize and getAppSizeBatched. Whether the volumes
+    // support quotas is cached in quotaSupportedByUuid, so that a batch only looks it up once.
+    binder::Status measureAppSize(const std::optional<std::string>& uuid,
+            const std::vector<std::string>& packageNames, int32_t userId, int32_t flags,
+            int32_t appId, const std::vector<int64_t>& ceDataInodes,
+            const std::vector<std::string>& codePaths,
+            std::unordered_map<std::string, bool>* quotaSupportedByUuid,
+            std::vector<int64_t>* _aidl_return);
+
     binder::Status createAppDataLocked(const std::optional<std::string>& uuid,
                                        const std::string& packageName, int32_t userId,
                                        int32_t flags, int32_t appId, int32_t previousAppId,
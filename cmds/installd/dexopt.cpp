@@ -29,6 +29,8 @@
 #include <unistd.h>
 
 #include <array>
+#include <chrono>
+#include <condition_variable>
 #include <iomanip>
 #include <mutex>
 #include <unordered_set>
@@ -69,6 +71,7 @@
 using android::base::Basename;
 using android::base::EndsWith;
 using android::base::GetBoolProperty;
+using android::base::GetIntProperty;
 using android::base::GetProperty;
 using android::base::ReadFdToString;
 using android::base::ReadFully;
@@ -95,14 +98,25 @@ class DexOptStatus {
     // If cancelled, fork will not happen and it will return -1.
     pid_t check_cancellation_and_fork(/* out */ bool *cancelled) {
         std::lock_guard<std::mutex> lock(dexopt_lock_);
-        if (dexopt_blocked_) {
-            *cancelled = true;
-            return -1;
-        }
-        pid_t pid = fork();
-        *cancelled = false;
+        return check_cancellation_and_fork_locked(cancelled);
+    }
+
+    // Same as check_cancellation_and_fork(), for a dex2oat compilation. If max_compilations is
+    // positive, first waits until fewer compilations than that are running, so that the callers
+    // can issue several dexopt calls at once without overcommitting the CPUs and the memory.
+    // Blocking dexopt cancels the waiting compilations.
+    pid_t check_cancellation_and_fork_compilation(int max_compilations,
+                                                  /* out */ bool* cancelled) {
+        std::unique_lock<std::mutex> lock(dexopt_lock_);
+        if (max_compilations > 0) {
+            compilation_finished_.wait(lock, [&]() REQUIRES(dexopt_lock_) {
+                return dexopt_blocked_ ||
+                        compilation_pids_.size() < static_cast<size_t>(max_compilations);
+            });
+        }
+        pid_t pid = check_cancellation_and_fork_locked(cancelled);
         if (pid > 0) { // parent
-            dexopt_pids_.insert(pid);
+            compilation_pids_.insert(pid);
         }
         return pid;
     }
@@ -112,6 +126,9 @@ class DexOptStatus {
     bool check_if_killed_and_remove_dexopt_pid(pid_t pid) {
         std::lock_guard<std::mutex> lock(dexopt_lock_);
         dexopt_pids_.erase(pid);
+        if (compilation_pids_.erase(pid) == 1) {
+            compilation_finished_.notify_one();
+        }
         if (dexopt_killed_pids_.erase(pid) == 1) {
             return true;
         }
@@ -131,6 +148,7 @@ class DexOptStatus {
         if (!block) {
             return;
         }
+        compilation_finished_.notify_all();
         // Blocked, also kill currently running tasks
         for (auto pid : dexopt_pids_) {
             LOG(INFO) << "control_dexopt_blocking kill pid:" << pid;
@@ -141,6 +159,19 @@ class DexOptStatus {
     }
 
  private:
+    pid_t check_cancellation_and_fork_locked(/* out */ bool* cancelled) REQUIRES(dexopt_lock_) {
+        if (dexopt_blocked_) {
+            *cancelled = true;
+            return -1;
+        }
+        pid_t pid = fork();
+        *cancelled = false;
+        if (pid > 0) { // parent
+            dexopt_pids_.insert(pid);
+        }
+        return pid;
+    }
+
     std::mutex dexopt_lock_;
     // when true, dexopt is blocked and will not run.
     bool dexopt_blocked_ GUARDED_BY(dexopt_lock_) = false;
@@ -149,6 +180,11 @@ class DexOptStatus {
     std::unordered_set<pid_t> dexopt_pids_ GUARDED_BY(dexopt_lock_);
     // PIDs of child processes killed by cancellation.
     std::unordered_set<pid_t> dexopt_killed_pids_ GUARDED_BY(dexopt_lock_);
+    // PIDs of the dex2oat compilations that haven't been waited for yet, including the killed
+    // ones, since they still use resources until they exit.
+    std::unordered_set<pid_t> compilation_pids_ GUARDED_BY(dexopt_lock_);
+    // Notified when a compilation has been waited for, or when dexopt is blocked.
+    std::condition_variable compilation_finished_;
 };
 
 android::base::NoDestructor<DexOptStatus> dexopt_status_;
@@ -1969,7 +2005,8 @@ int dexopt(const char* dex_path, uid_t uid, const char* pkgname, const char* ins
                       background_job_compile, compilation_reason);
 
     bool cancelled = false;
-    pid_t pid = dexopt_status_->check_cancellation_and_fork(&cancelled);
+    pid_t pid = dexopt_status_->check_cancellation_and_fork_compilation(
+            GetIntProperty("dalvik.vm.dex2oat-max-concurrent-jobs", 0), &cancelled);
     if (cancelled) {
         *completed = false;
         reference_profile.DisableCleanup();
@@ -1991,20 +2028,26 @@ int dexopt(const char* dex_path, uid_t uid, const char* pkgname, const char* ins
 
         runner.Exec(DexoptReturnCodes::kDex2oatExec);
     } else {
+        const auto start = std::chrono::steady_clock::now();
         int res = wait_child_with_timeout(pid, kLongTimeoutMs);
         bool cancelled = dexopt_status_->check_if_killed_and_remove_dexopt_pid(pid);
+        const int64_t duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start).count();
         if (res == 0) {
-            LOG(VERBOSE) << "DexInv: --- END '" << dex_path << "' (success) ---";
+            LOG(VERBOSE) << "DexInv: --- END '" << dex_path << "' (success) --- " << duration_ms
+                         << "ms";
         } else {
             if ((WTERMSIG(res) == SIGKILL) && cancelled) {
-                LOG(VERBOSE) << "DexInv: --- END '" << dex_path << "' --- cancelled";
+                LOG(VERBOSE) << "DexInv: --- END '" << dex_path << "' --- cancelled after "
+                             << duration_ms << "ms";
                 // cancelled, not an error
                 *completed = false;
                 reference_profile.DisableCleanup();
                 return 0;
             }
             LOG(VERBOSE) << "DexInv: --- END '" << dex_path << "' --- status=0x"
-                         << std::hex << std::setw(4) << res << ", process failed";
+                         << std::hex << std::setw(4) << res << std::dec << ", process failed after "
+                         << duration_ms << "ms";
             *error_msg = format_dexopt_error(res, dex_path);
             return res;
         }
@@ -23,13 +23,18 @@
 
 #include <algorithm>
 #include <array>
+#include <chrono>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <map>
 #include <sstream>
 
 #include <android-base/file.h>
 #include <android-base/logging.h>
 #include <android-base/macros.h>
+#include <android-base/parseint.h>
+#include <android-base/properties.h>
 #include <android-base/scopeguard.h>
 #include <android-base/stringprintf.h>
 #include <android-base/strings.h>
@@ -134,32 +139,162 @@ static void TryExtraMount(const char* name, const char* slot, const char* target
     (void)TryMountWithFstypes(block_device.c_str(), target);
 }
 
+// Memory that a dex2oat invocation is assumed to need when deciding how many otapreopt commands
+// to run at once. Large apps can take more, but compiling them concurrently with small ones
+// rarely exceeds this on average.
+static constexpr uint64_t kMemoryPerCommandKb = 768 * 1024;
+
+// Returns how many otapreopt commands may run at once on this device when no limit is given:
+// enough to keep the CPUs busy, given that each dex2oat runs its own background threads.
+static size_t GetDefaultMaxCommands() {
+    const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    const int threads_per_command = std::max(
+            1,
+            android::base::GetIntProperty("dalvik.vm.background-dex2oat-threads",
+                                          android::base::GetIntProperty("dalvik.vm.dex2oat-threads",
+                                                                        2)));
+    return std::max<size_t>(1, cpus / threads_per_command);
+}
+
+// Returns MemAvailable from /proc/meminfo, or 0 if it cannot be read.
+static uint64_t GetAvailableMemoryKb() {
+    std::ifstream meminfo("/proc/meminfo");
+    std::string key;
+    uint64_t value;
+    std::string unit;
+    while (meminfo >> key >> value >> unit) {
+        if (key == "MemAvailable:") {
+            return value;
+        }
+    }
+    return 0;
+}
+
+static bool ReadInt(const std::filesystem::path& path, int64_t* value) {
+    std::string content;
+    return android::base::ReadFileToString(path, &content) &&
+            android::base::ParseInt(android::base::Trim(content), value);
+}
+
+// Returns whether any thermal zone has reached a passive trip point, i.e. the kernel has started
+// throttling the CPUs. Zones that cannot be read are ignored.
+static bool IsThermalThrottling() {
+    std::error_code ec;
+    for (const auto& zone : std::filesystem::directory_iterator("/sys/class/thermal", ec)) {
+        if (!zone.path().filename().string().starts_with("thermal_zone")) {
+            continue;
+        }
+        int64_t temp;
+        if (!ReadInt(zone.path() / "temp", &temp)) {
+            continue;
+        }
+        for (int trip = 0;; ++trip) {
+            std::string type;
+            if (!android::base::ReadFileToString(
+                        zone.path() / StringPrintf("trip_point_%d_type", trip), &type)) {
+                break;
+            }
+            int64_t trip_temp;
+            if (android::base::Trim(type) == "passive" &&
+                ReadInt(zone.path() / StringPrintf("trip_point_%d_temp", trip), &trip_temp) &&
+                trip_temp > 0 && temp >= trip_temp) {
+                LOG(INFO) << zone.path().filename().string() << " at " << temp << " reached trip point "
+                          << trip << " at " << trip_temp;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Returns how many otapreopt commands may run at once right now, given the memory that is
+// available and the thermal state. Always allows at least one, so that progress is made.
+static size_t GetAllowedCommands(size_t max_commands) {
+    if (max_commands <= 1 || IsThermalThrottling()) {
+        return 1;
+    }
+    const uint64_t available_kb = GetAvailableMemoryKb();
+    if (available_kb == 0) {
+        return max_commands;
+    }
+    return std::clamp<size_t>(available_kb / kMemoryPerCommandKb, 1, max_commands);
+}
+
+struct RunningCommand {
+    int count;
+    std::chrono::steady_clock::time_point start;
+};
+
+// Waits for one of the running otapreopt commands to finish, logs how long it took, and prints
+// the number of finished commands to stdout to indicate progress.
+static void WaitForCommand(std::map<pid_t, RunningCommand>* running, int* finished) {
+    while (!running->empty()) {
+        int status;
+        pid_t pid = TEMP_FAILURE_RETRY(waitpid(-1, &status, 0));
+        if (pid == -1) {
+            PLOG(ERROR) << "Failed to wait for otapreopt";
+            running->clear();
+            return;
+        }
+        auto it = running->find(pid);
+        if (it == running->end()) {
+            continue;
+        }
+        const auto duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - it->second.start);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            LOG(ERROR) << "Command " << it->second.count << " failed after "
+                       << duration_ms.count() << " ms";
+        } else {
+            LOG(INFO) << "Command " << it->second.count << " finished in "
+                      << duration_ms.count() << " ms";
+        }
+        running->erase(it);
+        std::cout << ++*finished << std::endl;
+        return;
+    }
+}
+
 // Entry for otapreopt_chroot. Expected parameters are:
 //
-//   [cmd] [status-fd] [target-slot-suffix]
+//   [cmd] [status-fd] [target-slot-suffix] [--max-commands=<n>]
 //
 // The file descriptor denoted by status-fd will be closed. Dexopt commands on
 // the form
 //
 //   "dexopt" [dexopt-params]
 //
-// are then read from stdin until EOF and passed on to /system/bin/otapreopt one
-// by one. After each call a line with the current command count is written to
-// stdout and flushed.
+// are then read from stdin until EOF and passed on to /system/bin/otapreopt.
+// Up to n commands run at once, fewer when memory is short or the device is
+// thermally throttled; n defaults to what the CPUs can keep busy, and 1 runs
+// the commands one by one. After each command finishes a line with the number
+// of finished commands is written to stdout and flushed.
 static int otapreopt_chroot(const int argc, char **arg) {
     // Validate arguments
     if (argc == 2 && std::string_view(arg[1]) == "--version") {
         // Accept a single --version flag, to allow the script to tell this binary
         // from the earlier one.
-        std::cout << "2" << std::endl;
+        std::cout << "3" << std::endl;
         return 0;
     }
-    if (argc != 3) {
+    if (argc != 3 && argc != 4) {
         LOG(ERROR) << "Wrong number of arguments: " << argc;
         exit(208);
     }
     const char* status_fd = arg[1];
     const char* slot_suffix = arg[2];
+    size_t max_commands = 0;
+    if (argc == 4) {
+        std::string_view max_commands_arg(arg[3]);
+        if (!android::base::ConsumePrefix(&max_commands_arg, "--max-commands=") ||
+            !android::base::ParseUint(std::string(max_commands_arg), &max_commands)) {
+            LOG(ERROR) << "Bad argument: " << arg[3];
+            exit(208);
+        }
+    }
+    if (max_commands == 0) {
+        max_commands = GetDefaultMaxCommands();
+    }
 
     // Set O_CLOEXEC on standard fds. They are coming from the caller, we do not
     // want to pass them on across our fork/exec into a different domain.
@@ -352,6 +487,10 @@ static int otapreopt_chroot(const int argc, char **arg) {
 
     // Now go on and read dexopt lines from stdin and pass them on to otapreopt.
 
+    LOG(INFO) << "Running up to " << max_commands << " otapreopt commands at once";
+    const auto start = std::chrono::steady_clock::now();
+    std::map<pid_t, RunningCommand> running;
+    int finished = 0;
     int count = 1;
     for (std::array<char, 10000> linebuf;
          std::cin.clear(), std::cin.getline(&linebuf[0], linebuf.size()); ++count) {
@@ -367,19 +506,33 @@ static int otapreopt_chroot(const int argc, char **arg) {
         std::vector<std::string> cmd{"/system/bin/otapreopt", slot_suffix};
         std::move(tokenized_line.begin(), tokenized_line.end(), std::back_inserter(cmd));
 
+        // Wait for a slot before starting the command, re-checking memory and thermal state
+        // each time one frees up.
+        while (!running.empty() && running.size() >= GetAllowedCommands(max_commands)) {
+            WaitForCommand(&running, &finished);
+        }
+
         LOG(INFO) << "Command " << count << ": " << android::base::Join(cmd, " ");
 
         // Fork and execute otapreopt in its own process.
         std::string error_msg;
-        bool exec_result = Exec(cmd, &error_msg);
-        if (!exec_result) {
+        pid_t pid = ExecAsync(cmd, &error_msg);
+        if (pid == -1) {
             LOG(ERROR) << "Running otapreopt failed: " << error_msg;
+            std::cout << ++finished << std::endl;
+            continue;
         }
-
-        // Print the count to stdout and flush to indicate progress.
-        std::cout << count << std::endl;
+        running.emplace(pid, RunningCommand{count, std::chrono::steady_clock::now()});
+    }
+    while (!running.empty()) {
+        WaitForCommand(&running, &finished);
     }
 
+    LOG(INFO) << "Finished " << finished << " otapreopt commands in "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(
+                         std::chrono::steady_clock::now() - start)
+                         .count()
+              << " ms";
     LOG(INFO) << "No more dexopt commands";
     return 0;
 }
@@ -81,7 +81,8 @@ else
   echo "Pre-reboot Dexopt is too old. Fall back to otapreopt."
 fi
 
-if [ "$(/system/bin/otapreopt_chroot --version)" != 2 ]; then
+OTAPREOPT_CHROOT_VERSION="$(/system/bin/otapreopt_chroot --version)"
+if [ "$OTAPREOPT_CHROOT_VERSION" != 2 ] && [ "$OTAPREOPT_CHROOT_VERSION" != 3 ]; then
   # We require an updated chroot wrapper that reads dexopt commands from stdin.
   # Even if we kept compat with the old binary, the OTA preopt wouldn't work due
   # to missing sepolicy rules, so there's no use spending time trying to dexopt
@@ -110,6 +111,14 @@ cmd otadexopt cleanup
 
 echo "$0: Using streaming otapreopt_chroot on ${#otadexopt_cmds[@]} packages"
 
+# Version 3 of the chroot wrapper compiles several packages at once. Let it pick
+# how many from the device's CPUs unless dalvik.vm.otapreopt-max-commands says
+# otherwise; 1 compiles them one by one.
+otapreopt_chroot_args=()
+if [ "$OTAPREOPT_CHROOT_VERSION" = 3 ]; then
+  otapreopt_chroot_args+=("--max-commands=$(getprop dalvik.vm.otapreopt-max-commands 0)")
+fi
+
 function print_otadexopt_cmds {
   for cmd in "${otadexopt_cmds[@]}" ; do
     print "$cmd"
@@ -125,7 +134,7 @@ function report_progress {
 }
 
 print_otadexopt_cmds | \
-  /system/bin/otapreopt_chroot $STATUS_FD $TARGET_SLOT_SUFFIX | \
+  /system/bin/otapreopt_chroot $STATUS_FD $TARGET_SLOT_SUFFIX "${otapreopt_chroot_args[@]}" | \
   report_progress
 
 if [ "$DONE" = "OTA incomplete." ] ; then
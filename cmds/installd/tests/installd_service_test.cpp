@@ -547,6 +547,31 @@ TEST_F(ServiceTest, GetAppSizeWrongSizes) {
                                            &externalStorageSize));
 }
 
+TEST_F(ServiceTest, GetAppSizeBatched) {
+    android::os::GetAppSizeArgs valid;
+    valid.packageNames = {"package1"};
+    valid.ceDataInodes = {0};
+    valid.appId = -1;
+    android::os::GetAppSizeArgs wrongSizes;
+    wrongSizes.packageNames = {"package1", "package2"};
+    wrongSizes.ceDataInodes = {0};
+    wrongSizes.appId = -1;
+
+    std::vector<int64_t> expectedSizes;
+    ASSERT_BINDER_SUCCESS(service->getAppSize(std::nullopt, valid.packageNames, 0, 0, -1,
+                                              valid.ceDataInodes, {}, &expectedSizes));
+
+    // An invalid entry fails on its own, without failing the whole batch.
+    std::vector<android::os::GetAppSizeResult> results;
+    ASSERT_BINDER_SUCCESS(service->getAppSizeBatched({valid, wrongSizes, valid}, &results));
+    ASSERT_EQ(3u, results.size());
+    EXPECT_EQ(binder::Status::EX_NONE, results[0].exceptionCode);
+    EXPECT_EQ(expectedSizes, results[0].sizes);
+    EXPECT_EQ(binder::Status::EX_ILLEGAL_ARGUMENT, results[1].exceptionCode);
+    EXPECT_EQ(binder::Status::EX_NONE, results[2].exceptionCode);
+    EXPECT_EQ(expectedSizes, results[2].sizes);
+}
+
 class FsverityTest : public ServiceTest {
 protected:
     binder::Status createFsveritySetupAuthToken(const std::string& path, int open_mode,
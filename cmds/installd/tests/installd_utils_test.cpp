@@ -15,12 +15,14 @@
  */
 
 #include <errno.h>
+#include <ftw.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 
 #include <android-base/logging.h>
 #include <android-base/scopeguard.h>
+#include <android-base/stringprintf.h>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
@@ -48,6 +50,7 @@
 namespace android {
 namespace installd {
 
+using android::base::StringPrintf;
 using ::testing::UnorderedElementsAre;
 
 class UtilsTest : public testing::Test {
@@ -681,6 +684,43 @@ TEST_F(UtilsTest, TestForEachSubdir) {
     EXPECT_THAT(result, UnorderedElementsAre("com.foo", "com.bar"));
 }
 
+static int64_t gNftwSize;
+
+TEST_F(UtilsTest, CalculateTreeSize) {
+    auto deleter = [&]() {
+        delete_dir_contents_and_dir("/data/local/tmp/user/0", true /* ignore_if_missing */);
+    };
+    auto scope_guard = android::base::make_scope_guard(deleter);
+
+    // Enough directories for the walk to be shared between threads.
+    for (int i = 0; i < 100; i++) {
+        system(StringPrintf("mkdir -p /data/local/tmp/user/0/dir%d/sub", i).c_str());
+        system(StringPrintf("echo %d > /data/local/tmp/user/0/dir%d/sub/file", i, i).c_str());
+    }
+    system("ln -s /data/local/tmp /data/local/tmp/user/0/link");
+
+    gNftwSize = 0;
+    ASSERT_EQ(0,
+              nftw("/data/local/tmp/user/0",
+                   [](const char*, const struct stat* st, int, struct FTW*) {
+                       gNftwSize += st->st_blocks * 512;
+                       return 0;
+                   },
+                   /*nopenfd=*/16, FTW_PHYS | FTW_MOUNT));
+
+    int64_t size = 0;
+    ASSERT_EQ(0, calculate_tree_size("/data/local/tmp/user/0", &size));
+    EXPECT_EQ(gNftwSize, size);
+
+    // The size is added to the given one.
+    ASSERT_EQ(0, calculate_tree_size("/data/local/tmp/user/0", &size));
+    EXPECT_EQ(2 * gNftwSize, size);
+
+    size = 0;
+    ASSERT_EQ(0, calculate_tree_size("/data/local/tmp/user/0/missing", &size));
+    EXPECT_EQ(0, size);
+}
+
 TEST_F(UtilsTest, TestSdkSandboxDataPaths) {
     // Ce data paths
     EXPECT_EQ("/data/misc_ce/0/sdksandbox",
@@ -22,6 +22,7 @@
 #include <poll.h>
 #include <stdlib.h>
 #include <sys/capability.h>
+#include <sys/ioctl.h>
 #include <sys/pidfd.h>
 #include <sys/stat.h>
 #include <sys/statvfs.h>
@@ -30,6 +31,13 @@
 #include <unistd.h>
 #include <uuid/uuid.h>
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <iterator>
+#include <mutex>
+#include <thread>
+
 #include <android-base/file.h>
 #include <android-base/logging.h>
 #include <android-base/stringprintf.h>
@@ -464,47 +472,182 @@ int set_quota_project_id(const std::string& path, long project_id, bool set_inhe
     return 0;
 }
 
-int calculate_tree_size(const std::string& path, int64_t* size,
-        int32_t include_gid, int32_t exclude_gid, bool exclude_apps) {
-    FTS *fts;
-    FTSENT *p;
-    int64_t matchedSize = 0;
-    char *argv[] = { (char*) path.c_str(), nullptr };
-    if (!(fts = fts_open(argv, FTS_PHYSICAL | FTS_NOCHDIR | FTS_XDEV, nullptr))) {
-        if (errno != ENOENT) {
-            PLOG(ERROR) << "Failed to fts_open " << path;
+namespace {
+
+// Measures a tree like fts with FTS_PHYSICAL | FTS_XDEV would: symbolic links aren't followed, and
+// other file systems mounted in the tree are counted but not entered. The caller walks the tree
+// alone until it finds enough directories to share with helper threads, because most of the trees
+// that are measured, like the cache of an app, are small and wouldn't gain from them.
+class TreeSizeWalker {
+public:
+    TreeSizeWalker(dev_t dev, int32_t include_gid, int32_t exclude_gid, bool exclude_apps)
+          : mDev(dev),
+            mIncludeGid(include_gid),
+            mExcludeGid(exclude_gid),
+            mExcludeApps(exclude_apps) {}
+
+    // Returns the size of the entries below the given directory.
+    int64_t walk(const std::string& root) {
+        std::vector<std::string> pending{root};
+        int64_t size = 0;
+        while (!pending.empty()) {
+            if (pending.size() >= kParallelThreshold) {
+                return size + walkInParallel(std::move(pending));
+            }
+            std::string path = std::move(pending.back());
+            pending.pop_back();
+            size += readDirectory(path, &pending);
         }
-        return -1;
+        return size;
     }
-    while ((p = fts_read(fts)) != nullptr) {
-        switch (p->fts_info) {
-        case FTS_D:
-        case FTS_DEFAULT:
-        case FTS_F:
-        case FTS_SL:
-        case FTS_SLNONE:
-            int32_t uid = p->fts_statp->st_uid;
-            int32_t gid = p->fts_statp->st_gid;
-            int32_t user_uid = multiuser_get_app_id(uid);
-            int32_t user_gid = multiuser_get_app_id(gid);
-            if (exclude_apps && ((user_uid >= AID_APP_START && user_uid <= AID_APP_END)
-                    || (user_gid >= AID_CACHE_GID_START && user_gid <= AID_CACHE_GID_END)
-                    || (user_gid >= AID_SHARED_GID_START && user_gid <= AID_SHARED_GID_END))) {
-                // Don't traverse inside or measure
-                fts_set(fts, p, FTS_SKIP);
-                break;
+
+    // Whether the entry, and everything below it, is left out of the measure.
+    bool isSkipped(const struct stat& st) const {
+        if (!mExcludeApps) {
+            return false;
+        }
+        int32_t user_uid = multiuser_get_app_id(st.st_uid);
+        int32_t user_gid = multiuser_get_app_id(st.st_gid);
+        return (user_uid >= AID_APP_START && user_uid <= AID_APP_END)
+                || (user_gid >= AID_CACHE_GID_START && user_gid <= AID_CACHE_GID_END)
+                || (user_gid >= AID_SHARED_GID_START && user_gid <= AID_SHARED_GID_END);
+    }
+
+    // The size that the entry adds to the measure.
+    int64_t sizeOf(const struct stat& st) const {
+        int32_t gid = st.st_gid;
+        if (mIncludeGid != -1 && gid != mIncludeGid) {
+            return 0;
+        }
+        if (mExcludeGid != -1 && gid == mExcludeGid) {
+            return 0;
+        }
+        return st.st_blocks * 512;
+    }
+
+private:
+    // The number of directories waiting to be read above which the walk is shared with helper
+    // threads, and the largest number of threads that walk a tree, including the caller.
+    static constexpr size_t kParallelThreshold = 32;
+    static constexpr unsigned kMaxThreads = 4;
+
+    // Returns the size of the entries of the directory, and adds its subdirectories to pending.
+    int64_t readDirectory(const std::string& path, std::vector<std::string>* pending) const {
+        unique_fd fd(open(path.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC));
+        if (fd == -1) {
+            return 0;
+        }
+        int dfd = fd.get();
+        DIR* d = Fdopendir(std::move(fd));
+        if (d == nullptr) {
+            return 0;
+        }
+        int64_t size = 0;
+        struct dirent* de;
+        struct stat st;
+        while ((de = readdir(d)) != nullptr) {
+            const char* name = de->d_name;
+            if (!strcmp(name, ".") || !strcmp(name, "..")) {
+                continue;
             }
-            if (include_gid != -1 && gid != include_gid) {
-                break;
+            if (fstatat(dfd, name, &st, AT_SYMLINK_NOFOLLOW) != 0 || isSkipped(st)) {
+                continue;
             }
-            if (exclude_gid != -1 && gid == exclude_gid) {
-                break;
+            size += sizeOf(st);
+            if (S_ISDIR(st.st_mode) && st.st_dev == mDev) {
+                pending->push_back(path + "/" + name);
+            }
+        }
+        closedir(d);
+        return size;
+    }
+
+    int64_t walkInParallel(std::vector<std::string> pending) {
+        mQueue = std::move(pending);
+        mWorkerCount = std::clamp(std::thread::hardware_concurrency(), 1u, kMaxThreads);
+        std::vector<std::thread> helpers;
+        for (unsigned i = 1; i < mWorkerCount; i++) {
+            helpers.emplace_back([this]() { runWorker(); });
+        }
+        runWorker();
+        for (std::thread& helper : helpers) {
+            helper.join();
+        }
+        return mSize;
+    }
+
+    // Every worker walks the directories it finds depth first, and hands the oldest ones, which
+    // are the closest to the root and so likely the largest, to the workers that ran out of work.
+    void runWorker() {
+        std::vector<std::string> local;
+        int64_t size = 0;
+        while (true) {
+            std::string path;
+            if (!local.empty()) {
+                path = std::move(local.back());
+                local.pop_back();
+            } else {
+                std::unique_lock lock(mLock);
+                mIdleWorkers++;
+                mCondition.wait(lock, [this]() {
+                    return !mQueue.empty() || mIdleWorkers == mWorkerCount;
+                });
+                if (mQueue.empty()) {
+                    // Every worker is idle, so no directory is left to read.
+                    mCondition.notify_all();
+                    break;
+                }
+                mIdleWorkers--;
+                path = std::move(mQueue.back());
+                mQueue.pop_back();
+            }
+            size += readDirectory(path, &local);
+            if (local.size() > 1 && mIdleWorkers.load(std::memory_order_relaxed) > 0) {
+                std::lock_guard lock(mLock);
+                const size_t shared = local.size() / 2;
+                std::move(local.begin(), local.begin() + shared, std::back_inserter(mQueue));
+                local.erase(local.begin(), local.begin() + shared);
+                mCondition.notify_all();
+            }
+        }
+        std::lock_guard lock(mLock);
+        mSize += size;
+    }
+
+    const dev_t mDev;
+    const int32_t mIncludeGid;
+    const int32_t mExcludeGid;
+    const bool mExcludeApps;
+
+    std::mutex mLock;
+    std::condition_variable mCondition;
+    // The directories that any worker can read.
+    std::vector<std::string> mQueue;
+    unsigned mWorkerCount = 1;
+    // Only changed with mLock held, but read without it to decide whether to share work.
+    std::atomic<unsigned> mIdleWorkers = 0;
+    int64_t mSize = 0;
+};
+
+}  // namespace
+
+int calculate_tree_size(const std::string& path, int64_t* size,
+        int32_t include_gid, int32_t exclude_gid, bool exclude_apps) {
+    if (path.empty()) {
+        errno = ENOENT;
+        return -1;
+    }
+    int64_t matchedSize = 0;
+    struct stat st;
+    if (lstat(path.c_str(), &st) == 0) {
+        TreeSizeWalker walker(st.st_dev, include_gid, exclude_gid, exclude_apps);
+        if (!walker.isSkipped(st)) {
+            matchedSize += walker.sizeOf(st);
+            if (S_ISDIR(st.st_mode)) {
+                matchedSize += walker.walk(path);
             }
-            matchedSize += (p->fts_statp->st_blocks * 512);
-            break;
         }
     }
-    fts_close(fts);
 #if MEASURE_DEBUG
     if ((include_gid == -1) && (exclude_gid == -1)) {
         LOG(DEBUG) << "Measured " << path << " size " << matchedSize;
@@ -919,6 +1062,297 @@ int copy_dir_files(const char *srcname,
     return res;
 }
 
+namespace {
+
+// Copies a tree the way `cp -F -R -P -d --preserve=mode,ownership,timestamps,xattr` does, without
+// forking. The directories are created first, the regular files are then copied on a few threads,
+// and the attributes of the directories are set last, since copying their children changes them.
+class TreeCopier {
+public:
+    // Copies from into to_dir, as to_dir/<last component of from>.
+    int copy(const std::string& from, const std::string& to_dir) {
+        std::string name = from.substr(from.find_last_of('/') + 1);
+        struct stat st;
+        if (lstat(from.c_str(), &st) != 0) {
+            PLOG(ERROR) << "Failed to stat " << from;
+            return -1;
+        }
+        copyEntry(from, to_dir + "/" + name, st);
+        copyFiles();
+        // Children first, so that setting the times of a directory is its last change.
+        for (auto it = mDirectories.rbegin(); it != mDirectories.rend(); ++it) {
+            const Entry& dir = *it;
+            unique_fd dst(open(dir.to.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC));
+            if (dst == -1) {
+                PLOG(ERROR) << "Failed to open " << dir.to;
+                mFailed = true;
+                continue;
+            }
+            unique_fd src(open(dir.from.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC));
+            copyAttributes(src.get(), dst.get(), dir);
+        }
+        return mFailed ? -1 : 0;
+    }
+
+private:
+    struct Entry {
+        std::string from;
+        std::string to;
+        struct stat st;
+    };
+
+    static constexpr unsigned kMaxThreads = 4;
+
+    void copyEntry(const std::string& from, const std::string& to, const struct stat& st) {
+        if (S_ISDIR(st.st_mode)) {
+            // Like cp, an existing directory is merged into. The final mode is set at the end.
+            if (mkdir(to.c_str(), 0700) != 0 && errno != EEXIST) {
+                PLOG(ERROR) << "Failed to mkdir " << to;
+                mFailed = true;
+                return;
+            }
+            mDirectories.push_back({from, to, st});
+            copyChildren(from, to);
+        } else if (S_ISREG(st.st_mode)) {
+            mFiles.push_back({from, to, st});
+        } else {
+            copySpecial({from, to, st});
+        }
+    }
+
+    void copyChildren(const std::string& from, const std::string& to) {
+        unique_fd fd(open(from.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC));
+        if (fd == -1) {
+            PLOG(ERROR) << "Failed to open " << from;
+            mFailed = true;
+            return;
+        }
+        int dfd = fd.get();
+        DIR* d = Fdopendir(std::move(fd));
+        if (d == nullptr) {
+            PLOG(ERROR) << "Failed to opendir " << from;
+            mFailed = true;
+            return;
+        }
+        struct dirent* de;
+        struct stat st;
+        while ((de = readdir(d)) != nullptr) {
+            const char* name = de->d_name;
+            if (!strcmp(name, ".") || !strcmp(name, "..")) {
+                continue;
+            }
+            if (fstatat(dfd, name, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+                PLOG(ERROR) << "Failed to stat " << from << "/" << name;
+                mFailed = true;
+                continue;
+            }
+            copyEntry(from + "/" + name, to + "/" + name, st);
+        }
+        closedir(d);
+    }
+
+    // Symbolic links, fifos, sockets and devices, which are recreated rather than copied.
+    void copySpecial(const Entry& entry) {
+        const char* to = entry.to.c_str();
+        if (unlink(to) != 0 && errno != ENOENT) {
+            PLOG(ERROR) << "Failed to remove " << entry.to;
+            mFailed = true;
+            return;
+        }
+        if (S_ISLNK(entry.st.st_mode)) {
+            std::string target;
+            if (!android::base::Readlink(entry.from, &target) || symlink(target.c_str(), to) != 0) {
+                PLOG(ERROR) << "Failed to copy symlink " << entry.from;
+                mFailed = true;
+                return;
+            }
+        } else if (mknod(to, entry.st.st_mode, entry.st.st_rdev) != 0) {
+            PLOG(ERROR) << "Failed to mknod " << entry.to;
+            mFailed = true;
+            return;
+        }
+        if (lchown(to, entry.st.st_uid, entry.st.st_gid) != 0) {
+            PLOG(ERROR) << "Failed to chown " << entry.to;
+            mFailed = true;
+        }
+        if (!S_ISLNK(entry.st.st_mode) && chmod(to, entry.st.st_mode & ALLPERMS) != 0) {
+            PLOG(ERROR) << "Failed to chmod " << entry.to;
+            mFailed = true;
+        }
+        copyXattrs(entry.from.c_str(), to);
+        const struct timespec times[2] = {entry.st.st_atim, entry.st.st_mtim};
+        if (utimensat(AT_FDCWD, to, times, AT_SYMLINK_NOFOLLOW) != 0) {
+            PLOG(ERROR) << "Failed to set times of " << entry.to;
+            mFailed = true;
+        }
+    }
+
+    void copyFiles() {
+        const size_t threadCount = std::min<size_t>(
+                mFiles.size(), std::clamp(std::thread::hardware_concurrency(), 1u, kMaxThreads));
+        std::atomic<size_t> next = 0;
+        auto copyNextFiles = [this, &next]() {
+            for (size_t i = next++; i < mFiles.size(); i = next++) {
+                if (!copyFile(mFiles[i])) {
+                    mFailed = true;
+                }
+            }
+        };
+        std::vector<std::thread> helpers;
+        for (size_t i = 1; i < threadCount; i++) {
+            helpers.emplace_back(copyNextFiles);
+        }
+        copyNextFiles();
+        for (std::thread& helper : helpers) {
+            helper.join();
+        }
+    }
+
+    bool copyFile(const Entry& file) {
+        unique_fd src(open(file.from.c_str(), O_RDONLY | O_NOFOLLOW | O_CLOEXEC));
+        if (src == -1) {
+            PLOG(ERROR) << "Failed to open " << file.from;
+            return false;
+        }
+        // Like cp -F, the destination is removed rather than written over.
+        if (unlink(file.to.c_str()) != 0 && errno != ENOENT) {
+            PLOG(ERROR) << "Failed to remove " << file.to;
+            return false;
+        }
+        unique_fd dst(open(file.to.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC,
+                           0600));
+        if (dst == -1) {
+            PLOG(ERROR) << "Failed to create " << file.to;
+            return false;
+        }
+        if (!copyData(src.get(), dst.get(), file.st.st_size)) {
+            PLOG(ERROR) << "Failed to copy " << file.from << " to " << file.to;
+            return false;
+        }
+        return copyAttributes(src.get(), dst.get(), file);
+    }
+
+    // Shares the blocks of the file when the file system supports it, and otherwise lets the
+    // kernel copy them, falling back to read and write only when neither is possible.
+    static bool copyData(int src, int dst, off_t size) {
+        if (ioctl(dst, FICLONE, src) == 0) {
+            return true;
+        }
+        off_t copied = 0;
+        while (copied < size) {
+            ssize_t n = copy_file_range(src, nullptr, dst, nullptr, size - copied, 0);
+            if (n <= 0) {
+                if (n < 0 && (errno == EXDEV || errno == ENOSYS || errno == EINVAL ||
+                              errno == EOPNOTSUPP)) {
+                    break;
+                }
+                // The file shrank while it was copied, or the copy failed.
+                return n == 0;
+            }
+            copied += n;
+        }
+        if (copied == size) {
+            // The file may have grown since it was stat()ed, in which case the rest is read below.
+            char c;
+            if (pread(src, &c, 1, copied) == 0) {
+                return true;
+            }
+        }
+        if (lseek(src, copied, SEEK_SET) != copied || lseek(dst, copied, SEEK_SET) != copied) {
+            return false;
+        }
+        char buf[64 * 1024];
+        ssize_t n;
+        while ((n = TEMP_FAILURE_RETRY(read(src, buf, sizeof(buf)))) > 0) {
+            if (!android::base::WriteFully(dst, buf, n)) {
+                return false;
+            }
+        }
+        return n == 0;
+    }
+
+    // The owner is set before the mode, since changing it clears the set-user-ID bits.
+    bool copyAttributes(int src, int dst, const Entry& entry) {
+        bool ok = true;
+        if (fchown(dst, entry.st.st_uid, entry.st.st_gid) != 0) {
+            PLOG(ERROR) << "Failed to chown " << entry.to;
+            ok = false;
+        }
+        if (fchmod(dst, entry.st.st_mode & ALLPERMS) != 0) {
+            PLOG(ERROR) << "Failed to chmod " << entry.to;
+            ok = false;
+        }
+        if (src != -1) {
+            copyXattrs(src, dst, entry.to);
+        }
+        const struct timespec times[2] = {entry.st.st_atim, entry.st.st_mtim};
+        if (futimens(dst, times) != 0) {
+            PLOG(ERROR) << "Failed to set times of " << entry.to;
+            ok = false;
+        }
+        if (!ok) {
+            mFailed = true;
+        }
+        return ok;
+    }
+
+    // Like cp, the extended attributes are copied on a best effort basis.
+    static void copyXattrs(int src, int dst, const std::string& to) {
+        ssize_t listSize = flistxattr(src, nullptr, 0);
+        if (listSize <= 0) {
+            return;
+        }
+        std::vector<char> names(listSize);
+        ssize_t namesSize = flistxattr(src, names.data(), names.size());
+        std::vector<char> value;
+        for (ssize_t i = 0; i < namesSize; i += strlen(&names[i]) + 1) {
+            const char* name = &names[i];
+            ssize_t valueSize = fgetxattr(src, name, nullptr, 0);
+            if (valueSize < 0) {
+                continue;
+            }
+            value.resize(valueSize);
+            valueSize = fgetxattr(src, name, value.data(), value.size());
+            if (valueSize < 0 || fsetxattr(dst, name, value.data(), valueSize, 0) != 0) {
+                PLOG(WARNING) << "Failed to copy xattr " << name << " to " << to;
+            }
+        }
+    }
+
+    static void copyXattrs(const char* from, const char* to) {
+        ssize_t listSize = llistxattr(from, nullptr, 0);
+        if (listSize <= 0) {
+            return;
+        }
+        std::vector<char> names(listSize);
+        ssize_t namesSize = llistxattr(from, names.data(), names.size());
+        std::vector<char> value;
+        for (ssize_t i = 0; i < namesSize; i += strlen(&names[i]) + 1) {
+            const char* name = &names[i];
+            ssize_t valueSize = lgetxattr(from, name, nullptr, 0);
+            if (valueSize < 0) {
+                continue;
+            }
+            value.resize(valueSize);
+            valueSize = lgetxattr(from, name, value.data(), value.size());
+            if (valueSize < 0 || lsetxattr(to, name, value.data(), valueSize, 0) != 0) {
+                PLOG(WARNING) << "Failed to copy xattr " << name << " to " << to;
+            }
+        }
+    }
+
+    std::vector<Entry> mDirectories;
+    std::vector<Entry> mFiles;
+    std::atomic<bool> mFailed = false;
+};
+
+}  // namespace
+
+int copy_directory_recursive(const std::string& from, const std::string& to_dir) {
+    LOG(DEBUG) << "Copying " << from << " to " << to_dir;
+    return TreeCopier().copy(from, to_dir);
+}
+
 int64_t data_disk_free(const std::string& data_path) {
     struct statvfs sfs;
     if (statvfs(data_path.c_str(), &sfs) == 0) {
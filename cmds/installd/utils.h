@@ -148,6 +148,11 @@ int rm_package_dir(const std::string& package_dir);
 
 int copy_dir_files(const char *srcname, const char *dstname, uid_t owner, gid_t group);
 
+// Copies the tree at from into the directory to_dir, preserving the mode, owner, times and
+// extended attributes of every entry, and replacing the entries that already exist there.
+// Returns 0 on success, or -1 if any entry could not be fully copied.
+int copy_directory_recursive(const std::string& from, const std::string& to_dir);
+
 int64_t data_disk_free(const std::string& data_path);
 
 int get_path_inode(const std::string& path, ino_t *inode);
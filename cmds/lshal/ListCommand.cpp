@@ -19,6 +19,7 @@
 #include <getopt.h>
 
 #include <algorithm>
+#include <atomic>
 #include <fstream>
 #include <functional>
 #include <iomanip>
@@ -26,6 +27,7 @@
 #include <map>
 #include <regex>
 #include <sstream>
+#include <thread>
 
 #include <android-base/file.h>
 #include <android-base/hex.h>
@@ -54,6 +56,9 @@ using ::android::hidl::manager::V1_0::IServiceManager;
 namespace android {
 namespace lshal {
 
+// Maximum number of binderized HALs fetched at the same time.
+static constexpr size_t kMaxFetchThreads = 8;
+
 vintf::SchemaType toSchemaType(Partition p) {
     return (p == Partition::SYSTEM) ? vintf::SchemaType::FRAMEWORK : vintf::SchemaType::DEVICE;
 }
@@ -198,10 +203,24 @@ VintfInfo ListCommand::getVintfInfo(const std::string& fqInstanceName,
         return VINTF_INFO_EMPTY;
     }
 
-    return lshal::getVintfInfo(getDeviceManifest(), fqInstance, ta, DEVICE_MANIFEST) |
-            lshal::getVintfInfo(getFrameworkManifest(), fqInstance, ta, FRAMEWORK_MANIFEST) |
-            lshal::getVintfInfo(getDeviceMatrix(), fqInstance, ta, DEVICE_MATRIX) |
-            lshal::getVintfInfo(getFrameworkMatrix(), fqInstance, ta, FRAMEWORK_MATRIX);
+    const VintfObjects& vintfObjects = getVintfObjectsCached();
+    return lshal::getVintfInfo(vintfObjects.deviceManifest, fqInstance, ta, DEVICE_MANIFEST) |
+            lshal::getVintfInfo(vintfObjects.frameworkManifest, fqInstance, ta,
+                                FRAMEWORK_MANIFEST) |
+            lshal::getVintfInfo(vintfObjects.deviceMatrix, fqInstance, ta, DEVICE_MATRIX) |
+            lshal::getVintfInfo(vintfObjects.frameworkMatrix, fqInstance, ta, FRAMEWORK_MATRIX);
+}
+
+const ListCommand::VintfObjects& ListCommand::getVintfObjectsCached() const {
+    if (!mVintfObjects.has_value()) {
+        mVintfObjects = VintfObjects{
+                .deviceManifest = getDeviceManifest(),
+                .frameworkManifest = getFrameworkManifest(),
+                .deviceMatrix = getDeviceMatrix(),
+                .frameworkMatrix = getFrameworkMatrix(),
+        };
+    }
+    return *mVintfObjects;
 }
 
 bool ListCommand::getPidInfo(
@@ -211,6 +230,8 @@ bool ListCommand::getPidInfo(
 }
 
 const BinderPidInfo* ListCommand::getPidInfoCached(pid_t serverPid) {
+    // Hold the lock while reading, so that other threads do not see a partially read entry.
+    std::lock_guard<std::mutex> lock(mCachedPidInfosLock);
     auto pair = mCachedPidInfos.insert({serverPid, BinderPidInfo{}});
     if (pair.second /* did insertion take place? */) {
         if (!getPidInfo(serverPid, &pair.first->second)) {
@@ -619,16 +640,42 @@ Status ListCommand::fetchBinderized(const sp<IServiceManager> &manager) {
         return DUMP_BINDERIZED_ERROR;
     }
 
-    Status status = OK;
     std::map<std::string, TableEntry> allTableEntries;
+    std::vector<TableEntry*> entries;
     for (const auto& fqInstanceName : *fqInstanceNames) {
         // create entry and default assign all fields.
         TableEntry& entry = allTableEntries[fqInstanceName];
         entry.interfaceName = fqInstanceName;
         entry.transport = mode;
         entry.serviceStatus = ServiceStatus::NON_RESPONSIVE;
+        entries.push_back(&entry);
+    }
+
+    // Fetch the entries in parallel, since each entry takes several IPC calls, any of which
+    // may time out. All calls share one deadline, so that a large number of non-responsive
+    // HALs does not add up to a long wait.
+    const auto deadline = std::chrono::steady_clock::now() + mLshal.getFetchWait();
+    std::vector<Status> statuses(entries.size(), OK);
+    std::vector<std::stringstream> warnings(entries.size());
+    std::atomic<size_t> next = 0;
+    const auto fetchEntries = [&] {
+        for (size_t i = next++; i < entries.size(); i = next++) {
+            statuses[i] = fetchBinderizedEntry(manager, entries[i], deadline, warnings[i]);
+        }
+    };
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < std::min(entries.size(), kMaxFetchThreads); ++i) {
+        threads.emplace_back(fetchEntries);
+    }
+    fetchEntries();
+    for (auto& thread : threads) {
+        thread.join();
+    }
 
-        status |= fetchBinderizedEntry(manager, &entry);
+    Status status = OK;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        status |= statuses[i];
+        err() << warnings[i].str();
     }
 
     for (auto& pair : allTableEntries) {
@@ -638,18 +685,20 @@ Status ListCommand::fetchBinderized(const sp<IServiceManager> &manager) {
 }
 
 Status ListCommand::fetchBinderizedEntry(const sp<IServiceManager> &manager,
-                                         TableEntry *entry) {
+                                         TableEntry *entry,
+                                         std::chrono::steady_clock::time_point deadline,
+                                         std::ostream &warnings) {
     Status status = OK;
     const auto handleError = [&](Status additionalError, const std::string& msg) {
-        err() << "Warning: Skipping \"" << entry->interfaceName << "\": " << msg << std::endl;
+        warnings << "Warning: Skipping \"" << entry->interfaceName << "\": " << msg << std::endl;
         status |= DUMP_BINDERIZED_ERROR | additionalError;
     };
 
     const auto pair = splitFirst(entry->interfaceName, '/');
     const auto &serviceName = pair.first;
     const auto &instanceName = pair.second;
-    auto getRet = timeoutIPC(mLshal.getIpcCallWait(), manager, &IServiceManager::get, serviceName,
-                             instanceName);
+    auto getRet = timeoutIPCBefore(deadline, mLshal.getIpcCallWait(), manager,
+                                   &IServiceManager::get, serviceName, instanceName);
     if (!getRet.isOk()) {
         handleError(TRANSACTION_ERROR,
                     "cannot be fetched from service manager:" + getRet.description());
@@ -668,8 +717,10 @@ Status ListCommand::fetchBinderizedEntry(const sp<IServiceManager> &manager,
         // However, there's no need to lock because if debugRet.isOk(), the background thread has
         // already ended, so it is safe to dereference debugInfo.
         auto debugInfo = std::make_shared<DebugInfo>();
-        auto debugRet = timeoutIPC(mLshal.getIpcCallWait(), service, &IBase::getDebugInfo,
-                                   [debugInfo](const auto& received) { *debugInfo = received; });
+        auto debugRet = timeoutIPCBefore(deadline, mLshal.getIpcCallWait(), service,
+                                         &IBase::getDebugInfo, [debugInfo](const auto& received) {
+                                             *debugInfo = received;
+                                         });
         if (!debugRet.isOk()) {
             handleError(TRANSACTION_ERROR,
                         "debugging information cannot be retrieved: " + debugRet.description());
@@ -704,15 +755,17 @@ Status ListCommand::fetchBinderizedEntry(const sp<IServiceManager> &manager,
         // The lambda function may be executed asynchrounously because it is passed to timeoutIPC,
         // even though the interface function call is synchronous.
         auto hashIndexStore = std::make_shared<ssize_t>(-1);
-        auto ifaceChainRet = timeoutIPC(mLshal.getIpcCallWait(), service, &IBase::interfaceChain,
-                                        [hashIndexStore, serviceName](const auto& c) {
-                                            for (size_t i = 0; i < c.size(); ++i) {
-                                                if (serviceName == c[i]) {
-                                                    *hashIndexStore = static_cast<ssize_t>(i);
-                                                    break;
-                                                }
-                                            }
-                                        });
+        auto ifaceChainRet = timeoutIPCBefore(deadline, mLshal.getIpcCallWait(), service,
+                                              &IBase::interfaceChain,
+                                              [hashIndexStore, serviceName](const auto& c) {
+                                                  for (size_t i = 0; i < c.size(); ++i) {
+                                                      if (serviceName == c[i]) {
+                                                          *hashIndexStore =
+                                                                  static_cast<ssize_t>(i);
+                                                          break;
+                                                      }
+                                                  }
+                                              });
         if (!ifaceChainRet.isOk()) {
             handleError(TRANSACTION_ERROR,
                         "interfaceChain fails: " + ifaceChainRet.description());
@@ -727,8 +780,10 @@ Status ListCommand::fetchBinderizedEntry(const sp<IServiceManager> &manager,
         }
         // See comments about hashIndex above.
         auto hashChain = std::make_shared<hidl_vec<hidl_array<uint8_t, 32>>>();
-        auto hashRet = timeoutIPC(mLshal.getIpcCallWait(), service, &IBase::getHashChain,
-                                  [hashChain](const auto& ret) { *hashChain = std::move(ret); });
+        auto hashRet = timeoutIPCBefore(deadline, mLshal.getIpcCallWait(), service,
+                                        &IBase::getHashChain, [hashChain](const auto& ret) {
+                                            *hashChain = std::move(ret);
+                                        });
         if (!hashRet.isOk()) {
             handleError(TRANSACTION_ERROR, "getHashChain failed: " + hashRet.description());
             break; // skip getHashChain
@@ -753,7 +808,8 @@ Status ListCommand::fetchManifestHals() {
     if (!shouldFetchHalType(HalType::VINTF_MANIFEST)) { return OK; }
     Status status = OK;
 
-    for (auto manifest : {getDeviceManifest(), getFrameworkManifest()}) {
+    const VintfObjects& vintfObjects = getVintfObjectsCached();
+    for (auto manifest : {vintfObjects.deviceManifest, vintfObjects.frameworkManifest}) {
         if (manifest == nullptr) {
             status |= VINTF_ERROR;
             continue;
@@ -839,6 +895,7 @@ bool ListCommand::hasPassthroughEntry(const TableEntry& entry) const {
 
 Status ListCommand::fetch() {
     Status status = OK;
+    mVintfObjects.reset();
     auto bManager = mLshal.serviceManager();
     if (bManager == nullptr) {
         err() << "Failed to get defaultServiceManager()!" << std::endl;
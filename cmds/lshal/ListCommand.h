@@ -19,7 +19,11 @@
 #include <getopt.h>
 #include <stdint.h>
 
+#include <chrono>
 #include <fstream>
+#include <mutex>
+#include <optional>
+#include <ostream>
 #include <string>
 #include <vector>
 
@@ -99,14 +103,17 @@ protected:
     Status fetchManifestHals();
     Status fetchLazyHals();
 
+    // May be called from several threads at once. Warnings are written to warnings rather
+    // than err(), so that the caller can emit them in order.
     Status fetchBinderizedEntry(const sp<::android::hidl::manager::V1_0::IServiceManager> &manager,
-                                TableEntry *entry);
+                                TableEntry *entry, std::chrono::steady_clock::time_point deadline,
+                                std::ostream &warnings);
 
     // Get relevant information for a PID by parsing files under
     // /dev/binderfs/binder_logs or /d/binder.
     // It is a virtual member function so that it can be mocked.
     virtual bool getPidInfo(pid_t serverPid, BinderPidInfo *info) const;
-    // Retrieve from mCachedPidInfos and call getPidInfo if necessary.
+    // Retrieve from mCachedPidInfos and call getPidInfo if necessary. Thread-safe.
     const BinderPidInfo* getPidInfoCached(pid_t serverPid);
 
     void dumpTable(const NullableOStream<std::ostream>& out) const;
@@ -128,6 +135,14 @@ protected:
     Partition resolvePartition(Partition processPartition, const FqInstance &fqInstance) const;
 
     VintfInfo getVintfInfo(const std::string &fqInstanceName, vintf::TransportArch ta) const;
+    struct VintfObjects {
+        std::shared_ptr<const vintf::HalManifest> deviceManifest;
+        std::shared_ptr<const vintf::HalManifest> frameworkManifest;
+        std::shared_ptr<const vintf::CompatibilityMatrix> deviceMatrix;
+        std::shared_ptr<const vintf::CompatibilityMatrix> frameworkMatrix;
+    };
+    // Retrieve from mVintfObjects and call the getters below if necessary.
+    const VintfObjects& getVintfObjectsCached() const;
     // Allow to mock these functions for testing.
     virtual std::shared_ptr<const vintf::HalManifest> getDeviceManifest() const;
     virtual std::shared_ptr<const vintf::CompatibilityMatrix> getDeviceMatrix() const;
@@ -187,6 +202,11 @@ protected:
 
     // Cache for getPidInfo.
     std::map<pid_t, BinderPidInfo> mCachedPidInfos;
+    std::mutex mCachedPidInfosLock;
+
+    // Cache for the VINTF manifests and matrices, which are looked up for every entry.
+    // Cleared by fetch().
+    mutable std::optional<VintfObjects> mVintfObjects;
 
     // Cache for getPartition.
     std::map<pid_t, Partition> mPartitions;
@@ -260,12 +260,18 @@ void Lshal::setWaitTimeForTest(std::chrono::milliseconds ipcCallWait,
     mIpcCallWait = ipcCallWait;
     mDebugDumpWait = debugDumpWait;
 }
+void Lshal::setFetchWaitForTest(std::chrono::milliseconds fetchWait) {
+    mFetchWait = fetchWait;
+}
 std::chrono::milliseconds Lshal::getIpcCallWait() const {
     return mIpcCallWait;
 }
 std::chrono::milliseconds Lshal::getDebugDumpWait() const {
     return mDebugDumpWait;
 }
+std::chrono::milliseconds Lshal::getFetchWait() const {
+    return mFetchWait;
+}
 
 }  // namespace lshal
 }  // namespace android
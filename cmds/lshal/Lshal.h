@@ -61,8 +61,11 @@ public:
 
     void setWaitTimeForTest(std::chrono::milliseconds ipcCallWait,
                             std::chrono::milliseconds debugDumpWait);
+    void setFetchWaitForTest(std::chrono::milliseconds fetchWait);
     std::chrono::milliseconds getIpcCallWait() const;
     std::chrono::milliseconds getDebugDumpWait() const;
+    // Time budget shared by all IPC calls that fetch binderized HALs.
+    std::chrono::milliseconds getFetchWait() const;
 
 private:
     Status parseArgs(const Arg &arg);
@@ -78,6 +81,7 @@ private:
 
     std::chrono::milliseconds mIpcCallWait{500};
     std::chrono::milliseconds mDebugDumpWait{10000};
+    std::chrono::milliseconds mFetchWait{5000};
 
     DISALLOW_COPY_AND_ASSIGN(Lshal);
 };
@@ -18,6 +18,8 @@
 
 #include <chrono>
 #include <future>
+#include <mutex>
+#include <vector>
 
 #include <hidl/Status.h>
 #include <utils/Errors.h>
@@ -47,13 +49,38 @@ timeoutIPC(std::chrono::duration<R, P> wait, const sp<I> &interfaceObject, Funct
     // Putting this in the global list avoids std::future::~future() that may wait for the
     // result to come back.
     // This leaks memory, but lshal is a debugging tool, so this is fine.
+    static std::mutex gDeadPoolLock;
     static std::vector<decltype(future)> gDeadPool{};
-    gDeadPool.emplace_back(std::move(future));
+    {
+        std::lock_guard<std::mutex> lock(gDeadPoolLock);
+        gDeadPool.emplace_back(std::move(future));
+    }
 
     if (status == std::future_status::timeout) {
         return Status::fromStatusT(TIMED_OUT);
     }
     return Status::fromExceptionCode(Status::Exception::EX_ILLEGAL_STATE, "Illegal future_status");
 }
+
+// Same as timeoutIPC, but also gives up when the deadline is reached, so that a series of calls
+// shares one time budget. Returns TIMED_OUT without making the call if the deadline has already
+// passed.
+template<class R, class P, class Function, class I, class... Args>
+typename std::invoke_result<Function, I *, Args...>::type
+timeoutIPCBefore(std::chrono::steady_clock::time_point deadline, std::chrono::duration<R, P> wait,
+                 const sp<I> &interfaceObject, Function &&func, Args &&... args) {
+    using ::android::hardware::Status;
+
+    auto left = deadline - std::chrono::steady_clock::now();
+    if (left <= left.zero()) {
+        return Status::fromStatusT(TIMED_OUT);
+    }
+    if (left < wait) {
+        return timeoutIPC(left, interfaceObject, std::forward<Function>(func),
+                          std::forward<Args>(args)...);
+    }
+    return timeoutIPC(wait, interfaceObject, std::forward<Function>(func),
+                      std::forward<Args>(args)...);
+}
 } // namespace lshal
 } // namespace android
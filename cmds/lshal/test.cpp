@@ -1064,6 +1064,62 @@ TEST_F(TimeoutTest, BackgroundThreadDoesNotBlockMainThread) {
             << "The main thread should not be blocked by the background task";
 }
 
+class ConcurrentTimeoutTest : public ListTest {
+public:
+    void setMockServiceManager(sp<IBase> service, size_t numServices) {
+        EXPECT_CALL(*serviceManager, list(_))
+                .WillRepeatedly(Invoke([numServices](IServiceManager::list_cb cb) {
+                    std::vector<hidl_string> ret;
+                    for (size_t i = 0; i < numServices; ++i) {
+                        ret.push_back(getInterfaceName(1) + "/" + std::to_string(i));
+                    }
+                    cb(ret);
+                    return hardware::Void();
+                }));
+        EXPECT_CALL(*serviceManager, get(_, _))
+                .WillRepeatedly(Invoke([service](const hidl_string&, const hidl_string&) -> sp<IBase> {
+                    return service;
+                }));
+    }
+};
+
+TEST_F(ConcurrentTimeoutTest, ServicesAreFetchedConcurrently) {
+    auto lshalIpcTimeout = 100ms;
+    auto serviceIpcTimeout = 2000ms;
+    const size_t numServices = 8;
+    lshal->setWaitTimeForTest(lshalIpcTimeout, lshalIpcTimeout);
+    sp<SlowService> service = new SlowService(serviceIpcTimeout);
+    setMockServiceManager(service, numServices);
+
+    auto start = std::chrono::steady_clock::now();
+    optind = 1; // mimic Lshal::parseArg()
+    EXPECT_NE(0u, mockList->main(createArg({"lshal", "--types=b", "-i", "--neat"})));
+    EXPECT_LE(std::chrono::steady_clock::now(), start + 4 * lshalIpcTimeout)
+            << "Non-responsive services should time out at the same time";
+    for (size_t i = 0; i < numServices; ++i) {
+        EXPECT_THAT(err.str(),
+                    HasSubstr("Skipping \"a.h.foo1@1.0::IFoo/" + std::to_string(i) + "\""));
+    }
+}
+
+TEST_F(ConcurrentTimeoutTest, ServicesShareDeadline) {
+    auto lshalIpcTimeout = 500ms;
+    auto lshalFetchTimeout = 100ms;
+    auto serviceIpcTimeout = 2000ms;
+    const size_t numServices = 64;
+    lshal->setWaitTimeForTest(lshalIpcTimeout, lshalIpcTimeout);
+    lshal->setFetchWaitForTest(lshalFetchTimeout);
+    sp<SlowService> service = new SlowService(serviceIpcTimeout);
+    setMockServiceManager(service, numServices);
+
+    auto start = std::chrono::steady_clock::now();
+    optind = 1; // mimic Lshal::parseArg()
+    EXPECT_NE(0u, mockList->main(createArg({"lshal", "--types=b", "-i", "--neat"})));
+    EXPECT_LE(std::chrono::steady_clock::now(), start + 2 * lshalIpcTimeout)
+            << "Fetching should stop at the deadline";
+    EXPECT_THAT(err.str(), HasSubstr("Skipping \"a.h.foo1@1.0::IFoo/63\""));
+}
+
 class ListVintfTest : public ListTest {
 public:
     virtual void SetUp() override {
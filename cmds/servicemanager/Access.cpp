@@ -33,6 +33,9 @@ constexpr bool kIsVendor = false;
 #endif
 
 #ifdef __ANDROID__
+// Bounds the decision cache in case callers keep producing new contexts.
+constexpr size_t kMaxCachedDecisions = 4096;
+
 static std::string getPidcon(pid_t pid) {
     android_errorWriteLog(0x534e4554, "121035042");
 
@@ -46,9 +49,9 @@ static std::string getPidcon(pid_t pid) {
     return result;
 }
 
-static struct selabel_handle* getSehandle() {
+static struct selabel_handle* getSehandle(bool policyUpdated) {
     static struct selabel_handle* gSehandle = nullptr;
-    if (gSehandle != nullptr && selinux_status_updated()) {
+    if (gSehandle != nullptr && policyUpdated) {
         selabel_close(gSehandle);
         gSehandle = nullptr;
     }
@@ -134,21 +137,52 @@ bool Access::canAdd(const CallingContext& ctx, const std::string& name) {
 }
 
 bool Access::canList(const CallingContext& ctx) {
+    checkPolicyUpdated();
     return actionAllowed(ctx, mThisProcessContext, "list", "service_manager");
 }
 
+bool Access::checkPolicyUpdated() {
+#ifdef __ANDROID__
+    if (selinux_status_updated() <= 0) {
+        return false;
+    }
+    if (!mAllowedDecisions.empty()) {
+        mAllowedDecisions.clear();
+        mDecisionCacheStats.invalidations++;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
 bool Access::actionAllowed(const CallingContext& sctx, const char* tctx, const char* perm,
         const std::string& tname) {
 #ifdef __ANDROID__
     const char* tclass = "service_manager";
 
+    Decision decision(sctx.sid, tctx, perm);
+    if (mAllowedDecisions.count(decision) != 0) {
+        mDecisionCacheStats.hits++;
+        return true;
+    }
+    mDecisionCacheStats.misses++;
+
     AuditCallbackData data = {
         .context = &sctx,
         .tname = &tname,
     };
 
-    return 0 == selinux_check_access(sctx.sid.c_str(), tctx, tclass, perm,
+    bool allowed = 0 == selinux_check_access(sctx.sid.c_str(), tctx, tclass, perm,
         reinterpret_cast<void*>(&data));
+    // An empty sid means getpidcon failed, don't remember anything about it.
+    if (allowed && !sctx.sid.empty()) {
+        if (mAllowedDecisions.size() >= kMaxCachedDecisions) {
+            mAllowedDecisions.clear();
+        }
+        mAllowedDecisions.insert(std::move(decision));
+    }
+    return allowed;
 #else
     (void)sctx;
     (void)tctx;
@@ -161,8 +195,10 @@ bool Access::actionAllowed(const CallingContext& sctx, const char* tctx, const c
 
 bool Access::actionAllowedFromLookup(const CallingContext& sctx, const std::string& name, const char *perm) {
 #ifdef __ANDROID__
+    const bool policyUpdated = checkPolicyUpdated();
+
     char *tctx = nullptr;
-    if (selabel_lookup(getSehandle(), &tctx, name.c_str(), SELABEL_CTX_ANDROID_SERVICE) != 0) {
+    if (selabel_lookup(getSehandle(policyUpdated), &tctx, name.c_str(), SELABEL_CTX_ANDROID_SERVICE) != 0) {
         LOG(ERROR) << "SELinux: No match for " << name << " in service_contexts.\n";
         return false;
     }
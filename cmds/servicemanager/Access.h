@@ -16,8 +16,11 @@
 
 #pragma once
 
+#include <cstdint>
+#include <set>
 #include <string>
 #include <sys/types.h>
+#include <tuple>
 
 namespace android {
 
@@ -46,13 +49,31 @@ public:
     virtual bool canAdd(const CallingContext& ctx, const std::string& name);
     virtual bool canList(const CallingContext& ctx);
 
+    // Counters for the cache of allowed decisions kept in front of
+    // selinux_check_access.
+    struct DecisionCacheStats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t invalidations = 0;
+    };
+    DecisionCacheStats getDecisionCacheStats() const { return mDecisionCacheStats; }
+
 private:
     bool actionAllowed(const CallingContext& sctx, const char* tctx, const char* perm,
             const std::string& tname);
     bool actionAllowedFromLookup(const CallingContext& sctx, const std::string& name,
             const char *perm);
+    // Returns whether the policy was reloaded or the enforcing mode changed
+    // since the last call, dropping all cached decisions if so.
+    bool checkPolicyUpdated();
 
     char* mThisProcessContext = nullptr;
+
+    // Allowed (source context, target context, permission) triples. Denials
+    // are not cached so that each one is still audited.
+    using Decision = std::tuple<std::string, std::string, std::string>;
+    std::set<Decision> mAllowedDecisions;
+    DecisionCacheStats mDecisionCacheStats;
 };
 
 };
@@ -396,7 +396,7 @@ Status ServiceManager::getService(const std::string& name, sp<IBinder>* outBinde
     SM_PERFETTO_TRACE_FUNC(PERFETTO_TE_PROTO_FIELDS(
             PERFETTO_TE_PROTO_FIELD_CSTR(kProtoServiceName, name.c_str())));
 
-    *outBinder = tryGetBinder(name, true);
+    *outBinder = tryGetBinder(mAccess->getCallingContext(), name, true);
     // returns ok regardless of result for legacy reasons
     return Status::ok();
 }
@@ -405,7 +405,7 @@ Status ServiceManager::getService2(const std::string& name, os::Service* outServ
     SM_PERFETTO_TRACE_FUNC(PERFETTO_TE_PROTO_FIELDS(
             PERFETTO_TE_PROTO_FIELD_CSTR(kProtoServiceName, name.c_str())));
 
-    *outService = tryGetService(name, true);
+    *outService = tryGetService(mAccess->getCallingContext(), name, true);
     // returns ok regardless of result for legacy reasons
     return Status::ok();
 }
@@ -414,34 +414,59 @@ Status ServiceManager::checkService(const std::string& name, os::Service* outSer
     SM_PERFETTO_TRACE_FUNC(PERFETTO_TE_PROTO_FIELDS(
             PERFETTO_TE_PROTO_FIELD_CSTR(kProtoServiceName, name.c_str())));
 
-    *outService = tryGetService(name, false);
+    *outService = tryGetService(mAccess->getCallingContext(), name, false);
     // returns ok regardless of result for legacy reasons
     return Status::ok();
 }
 
-os::Service ServiceManager::tryGetService(const std::string& name, bool startIfNotFound) {
+Status ServiceManager::checkServices(const std::vector<std::string>& names,
+                                     std::vector<os::ServiceLookupResult>* outReturn) {
+    SM_PERFETTO_TRACE_FUNC();
+
+    // The calling context is the same for every name, so only look it up once.
+    auto ctx = mAccess->getCallingContext();
+
+    outReturn->clear();
+    outReturn->reserve(names.size());
+    for (const auto& name : names) {
+        os::ServiceLookupResult& result = outReturn->emplace_back();
+        result.service = tryGetService(ctx, name, false);
+        result.isDeclared = false;
+#ifndef VENDORSERVICEMANAGER
+        // Same as isDeclared, except that a denied name is reported as not
+        // declared instead of failing the whole batch.
+        std::optional<std::string> accessorName;
+        if (canFindService(ctx, name, &accessorName).isOk()) {
+            result.isDeclared = isVintfDeclared(ctx, name);
+        }
+#endif
+    }
+    return Status::ok();
+}
+
+os::Service ServiceManager::tryGetService(const Access::CallingContext& ctx,
+                                          const std::string& name, bool startIfNotFound) {
     std::optional<std::string> accessorName;
 #ifndef VENDORSERVICEMANAGER
     accessorName = getVintfAccessorName(name);
 #endif
     if (accessorName.has_value()) {
-        auto ctx = mAccess->getCallingContext();
         if (!mAccess->canFind(ctx, name)) {
             return os::Service::make<os::Service::Tag::accessor>(nullptr);
         }
         return os::Service::make<os::Service::Tag::accessor>(
-                tryGetBinder(*accessorName, startIfNotFound));
+                tryGetBinder(ctx, *accessorName, startIfNotFound));
     } else {
-        return os::Service::make<os::Service::Tag::binder>(tryGetBinder(name, startIfNotFound));
+        return os::Service::make<os::Service::Tag::binder>(
+                tryGetBinder(ctx, name, startIfNotFound));
     }
 }
 
-sp<IBinder> ServiceManager::tryGetBinder(const std::string& name, bool startIfNotFound) {
+sp<IBinder> ServiceManager::tryGetBinder(const Access::CallingContext& ctx,
+                                         const std::string& name, bool startIfNotFound) {
     SM_PERFETTO_TRACE_FUNC(PERFETTO_TE_PROTO_FIELDS(
             PERFETTO_TE_PROTO_FIELD_CSTR(kProtoServiceName, name.c_str())));
 
-    auto ctx = mAccess->getCallingContext();
-
     sp<IBinder> out;
     Service* service = nullptr;
     if (auto it = mNameToService.find(name); it != mNameToService.end()) {
@@ -1162,6 +1187,10 @@ Status ServiceManager::getServiceDebugInfo(std::vector<ServiceDebugInfo>* outRet
         outReturn->push_back(std::move(info));
     }
 
+    const Access::DecisionCacheStats stats = mAccess->getDecisionCacheStats();
+    LOG(INFO) << "SELinux decision cache: hits=" << stats.hits << " misses=" << stats.misses
+              << " invalidations=" << stats.invalidations;
+
     return Status::ok();
 }
 
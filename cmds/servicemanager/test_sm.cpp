@@ -39,6 +39,7 @@ using android::binder::Status;
 using android::os::BnServiceCallback;
 using android::os::IServiceManager;
 using android::os::Service;
+using android::os::ServiceLookupResult;
 using testing::_;
 using testing::ElementsAre;
 using testing::NiceMock;
@@ -295,6 +296,81 @@ TEST(GetService, NotAllowedFromIsolated) {
     EXPECT_EQ(nullptr, outBinder);
 }
 
+TEST(CheckServices, HappyHappy) {
+    auto sm = getPermissiveServiceManager();
+    sp<IBinder> foo = getBinder();
+    sp<IBinder> bar = getBinder();
+
+    EXPECT_TRUE(sm->addService("foo", foo, false /*allowIsolated*/,
+        IServiceManager::DUMP_FLAG_PRIORITY_DEFAULT).isOk());
+    EXPECT_TRUE(sm->addService("bar", bar, false /*allowIsolated*/,
+        IServiceManager::DUMP_FLAG_PRIORITY_DEFAULT).isOk());
+
+    std::vector<ServiceLookupResult> out;
+    EXPECT_TRUE(sm->checkServices({"bar", "baz", "foo"}, &out).isOk());
+    ASSERT_EQ(3u, out.size());
+    EXPECT_EQ(bar, out[0].service.get<Service::Tag::binder>());
+    EXPECT_EQ(nullptr, out[1].service.get<Service::Tag::binder>());
+    EXPECT_EQ(foo, out[2].service.get<Service::Tag::binder>());
+    EXPECT_FALSE(out[1].isDeclared);
+}
+
+TEST(CheckServices, NoPermissionsForOneService) {
+    std::unique_ptr<MockAccess> access = std::make_unique<NiceMock<MockAccess>>();
+
+    EXPECT_CALL(*access, getCallingContext()).WillRepeatedly(Return(Access::CallingContext{}));
+    EXPECT_CALL(*access, canAdd(_, _)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*access, canFind(_, "foo")).WillRepeatedly(Return(false));
+    EXPECT_CALL(*access, canFind(_, "bar")).WillRepeatedly(Return(true));
+
+    sp<ServiceManager> sm = sp<NiceMock<MockServiceManager>>::make(std::move(access));
+
+    sp<IBinder> bar = getBinder();
+    EXPECT_TRUE(sm->addService("foo", getBinder(), false /*allowIsolated*/,
+        IServiceManager::DUMP_FLAG_PRIORITY_DEFAULT).isOk());
+    EXPECT_TRUE(sm->addService("bar", bar, false /*allowIsolated*/,
+        IServiceManager::DUMP_FLAG_PRIORITY_DEFAULT).isOk());
+
+    // a denied name doesn't fail the rest of the batch
+    std::vector<ServiceLookupResult> out;
+    EXPECT_TRUE(sm->checkServices({"foo", "bar"}, &out).isOk());
+    ASSERT_EQ(2u, out.size());
+    EXPECT_EQ(nullptr, out[0].service.get<Service::Tag::binder>());
+    EXPECT_FALSE(out[0].isDeclared);
+    EXPECT_EQ(bar, out[1].service.get<Service::Tag::binder>());
+}
+
+TEST(CheckServices, LooksUpCallingContextOnce) {
+    std::unique_ptr<MockAccess> access = std::make_unique<NiceMock<MockAccess>>();
+
+    EXPECT_CALL(*access, getCallingContext())
+            // something adds it
+            .WillOnce(Return(Access::CallingContext{}))
+            // the whole batch is checked with one context
+            .WillOnce(Return(Access::CallingContext{}));
+    EXPECT_CALL(*access, canAdd(_, _)).WillOnce(Return(true));
+    EXPECT_CALL(*access, canFind(_, _)).WillRepeatedly(Return(true));
+
+    sp<ServiceManager> sm = sp<NiceMock<MockServiceManager>>::make(std::move(access));
+
+    EXPECT_TRUE(sm->addService("foo", getBinder(), false /*allowIsolated*/,
+        IServiceManager::DUMP_FLAG_PRIORITY_DEFAULT).isOk());
+
+    std::vector<ServiceLookupResult> out;
+    EXPECT_TRUE(sm->checkServices({"foo", "bar", "baz"}, &out).isOk());
+    EXPECT_EQ(3u, out.size());
+}
+
+TEST(Vintf, CheckServicesReportsDeclared_native) {
+    if (!isCuttlefishPhone()) GTEST_SKIP() << "Skipping non-Cuttlefish-phone devices";
+
+    auto sm = getPermissiveServiceManager();
+    std::vector<ServiceLookupResult> out;
+    EXPECT_TRUE(sm->checkServices({"mapper/minigbm"}, &out).isOk());
+    ASSERT_EQ(1u, out.size());
+    EXPECT_TRUE(out[0].isDeclared);
+}
+
 TEST(ListServices, NoPermissions) {
     std::unique_ptr<MockAccess> access = std::make_unique<NiceMock<MockAccess>>();
 
@@ -0,0 +1,165 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace android::ftl {
+
+// Monotonic allocator for data whose lifetime is bounded by a known point, e.g. the end of a frame.
+// Allocation bumps a pointer through a list of chunks, and deallocation is a no-op. reset() frees
+// everything at once, but keeps the chunks, so that an arena reset per frame stops allocating from
+// the heap once it has grown to the size of a frame's worth of data.
+//
+// Arena is not thread-safe.
+//
+// Example usage:
+//
+//   ftl::Arena arena;
+//
+//   ftl::SmallVector<int, 2, ftl::ArenaAllocator<int>> vector(arena);
+//   vector.push_back(1);
+//   vector.push_back(2);
+//   assert(!vector.dynamic());
+//   assert(arena.bytes_allocated() == 0);
+//
+//   vector.push_back(3);
+//   assert(vector.dynamic());
+//   assert(arena.bytes_allocated() > 0);
+//
+//   vector.clear();
+//   arena.reset();
+//   assert(arena.bytes_allocated() == 0);
+//
+class Arena final {
+ public:
+  static constexpr std::size_t kDefaultChunkSize = 16 * 1024;
+
+  explicit Arena(std::size_t chunk_size = kDefaultChunkSize) : chunk_size_(chunk_size) {}
+
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  // Returns storage for size bytes aligned to the given power of two. The storage remains valid
+  // until the next reset() or the destruction of the arena.
+  void* allocate(std::size_t size, std::size_t alignment) {
+    if (void* const ptr = bump(size, alignment)) return ptr;
+
+    // Move on to the next chunk kept by reset(), or grow if it is too small.
+    while (current_ + 1 < chunks_.size()) {
+      ++current_;
+      offset_ = 0;
+      if (void* const ptr = bump(size, alignment)) return ptr;
+    }
+
+    const std::size_t chunk_size = std::max(chunk_size_, size + alignment);
+    chunks_.push_back({std::make_unique<std::byte[]>(chunk_size), chunk_size});
+    current_ = chunks_.size() - 1;
+    offset_ = 0;
+    return bump(size, alignment);
+  }
+
+  // Frees all allocations at once. Containers using the arena must be destroyed or cleared first.
+  void reset() {
+    current_ = 0;
+    offset_ = 0;
+    allocated_ = 0;
+  }
+
+  // Returns the number of bytes handed out since the last reset, excluding alignment padding.
+  std::size_t bytes_allocated() const { return allocated_; }
+
+  // Returns the number of bytes held in chunks, which is only released on destruction.
+  std::size_t bytes_reserved() const {
+    std::size_t size = 0;
+    for (const auto& chunk : chunks_) size += chunk.size;
+    return size;
+  }
+
+ private:
+  struct Chunk {
+    std::unique_ptr<std::byte[]> data;
+    std::size_t size;
+  };
+
+  void* bump(std::size_t size, std::size_t alignment) {
+    if (current_ >= chunks_.size()) return nullptr;
+
+    const Chunk& chunk = chunks_[current_];
+    void* ptr = chunk.data.get() + offset_;
+    std::size_t space = chunk.size - offset_;
+    if (!std::align(alignment, size, ptr, space)) return nullptr;
+
+    offset_ = chunk.size - space + size;
+    allocated_ += size;
+    return ptr;
+  }
+
+  const std::size_t chunk_size_;
+  std::vector<Chunk> chunks_;
+
+  std::size_t current_ = 0;
+  std::size_t offset_ = 0;
+  std::size_t allocated_ = 0;
+};
+
+// Standard allocator that draws from an Arena, e.g. for the dynamic storage of ftl::SmallVector or
+// ftl::SmallMap. The allocator propagates on move and swap, so that containers are moved and swapped
+// without copying elements. The arena must outlive the containers.
+template <typename T>
+class ArenaAllocator {
+ public:
+  using value_type = T;
+
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+
+  ArenaAllocator(Arena& arena) : arena_(&arena) {}
+
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U>& other) : arena_(other.arena_) {}
+
+  T* allocate(std::size_t n) {
+    return static_cast<T*>(arena_->allocate(n * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T*, std::size_t) {}
+
+  Arena& arena() const { return *arena_; }
+
+  template <typename U>
+  bool operator==(const ArenaAllocator<U>& other) const {
+    return arena_ == other.arena_;
+  }
+
+  template <typename U>
+  bool operator!=(const ArenaAllocator<U>& other) const {
+    return !(*this == other);
+  }
+
+ private:
+  template <typename>
+  friend class ArenaAllocator;
+
+  Arena* arena_;
+};
+
+}  // namespace android::ftl
@@ -133,37 +133,38 @@ class ArrayIterators {
   const_reference operator[](size_type i) const { return self()[i]; }
 };
 
-// Mixin to define comparison operators for an array-like template.
+// Mixin to define comparison operators for an array-like template. Trailing template parameters,
+// e.g. an allocator, do not take part in the comparison.
 // TODO: Replace with operator<=> in C++20.
-template <template <typename, std::size_t> class Array>
+template <template <typename, std::size_t, typename...> class Array>
 struct ArrayComparators {
-  template <typename T, typename U, std::size_t N, std::size_t M>
-  friend bool operator==(const Array<T, N>& lhs, const Array<U, M>& rhs) {
+  template <typename T, typename U, std::size_t N, std::size_t M, typename... As, typename... Bs>
+  friend bool operator==(const Array<T, N, As...>& lhs, const Array<U, M, Bs...>& rhs) {
     return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
   }
 
-  template <typename T, typename U, std::size_t N, std::size_t M>
-  friend bool operator<(const Array<T, N>& lhs, const Array<U, M>& rhs) {
+  template <typename T, typename U, std::size_t N, std::size_t M, typename... As, typename... Bs>
+  friend bool operator<(const Array<T, N, As...>& lhs, const Array<U, M, Bs...>& rhs) {
     return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
   }
 
-  template <typename T, typename U, std::size_t N, std::size_t M>
-  friend bool operator>(const Array<T, N>& lhs, const Array<U, M>& rhs) {
+  template <typename T, typename U, std::size_t N, std::size_t M, typename... As, typename... Bs>
+  friend bool operator>(const Array<T, N, As...>& lhs, const Array<U, M, Bs...>& rhs) {
     return rhs < lhs;
   }
 
-  template <typename T, typename U, std::size_t N, std::size_t M>
-  friend bool operator!=(const Array<T, N>& lhs, const Array<U, M>& rhs) {
+  template <typename T, typename U, std::size_t N, std::size_t M, typename... As, typename... Bs>
+  friend bool operator!=(const Array<T, N, As...>& lhs, const Array<U, M, Bs...>& rhs) {
     return !(lhs == rhs);
   }
 
-  template <typename T, typename U, std::size_t N, std::size_t M>
-  friend bool operator>=(const Array<T, N>& lhs, const Array<U, M>& rhs) {
+  template <typename T, typename U, std::size_t N, std::size_t M, typename... As, typename... Bs>
+  friend bool operator>=(const Array<T, N, As...>& lhs, const Array<U, M, Bs...>& rhs) {
     return !(lhs < rhs);
   }
 
-  template <typename T, typename U, std::size_t N, std::size_t M>
-  friend bool operator<=(const Array<T, N>& lhs, const Array<U, M>& rhs) {
+  template <typename T, typename U, std::size_t N, std::size_t M, typename... As, typename... Bs>
+  friend bool operator<=(const Array<T, N, As...>& lhs, const Array<U, M, Bs...>& rhs) {
     return !(lhs > rhs);
   }
 };
@@ -0,0 +1,88 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace android::ftl {
+
+// Whether a queue supports the blocking push and pop operations. Blocking costs a fence on every
+// push and pop, so queues that are only polled should not opt in.
+enum class QueuePolicy { kNonBlocking, kBlocking };
+
+}  // namespace android::ftl
+
+namespace android::ftl::details {
+
+// Cache lines are 64 bytes on every supported ABI. Android's libc++ does not yet provide
+// std::hardware_destructive_interference_size.
+inline constexpr std::size_t kCacheLineSize = 64;
+
+constexpr bool is_power_of_two(std::size_t n) {
+  return n > 0 && (n & (n - 1)) == 0;
+}
+
+// Uninitialized storage for one queued element.
+template <typename T>
+class QueueSlot {
+ public:
+  template <typename... Args>
+  void construct(Args&&... args) {
+    new (storage_) T(std::forward<Args>(args)...);
+  }
+
+  // Moves the element out, and destroys it.
+  T take() {
+    T& element = get();
+    T value = std::move(element);
+    std::destroy_at(&element);
+    return value;
+  }
+
+  void destroy() { std::destroy_at(&get()); }
+
+ private:
+  T& get() { return *std::launder(reinterpret_cast<T*>(storage_)); }
+
+  alignas(T) std::byte storage_[sizeof(T)];
+};
+
+// Blocks while the atomic holds the old value. Registering as a waiter lets the other side skip
+// the notify call, which enters libc++, while nobody is blocked. The fence pairs with the one in
+// notify_waiters, so that either the waiter sees the new value or the notifier sees the waiter.
+template <typename T>
+void wait_while_equal(const std::atomic<T>& atomic, T old, std::atomic<std::uint32_t>& waiters) {
+  waiters.fetch_add(1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  atomic.wait(old, std::memory_order_acquire);
+  waiters.fetch_sub(1, std::memory_order_relaxed);
+}
+
+template <typename T>
+void notify_waiters(std::atomic<T>& atomic, const std::atomic<std::uint32_t>& waiters) {
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (waiters.load(std::memory_order_relaxed) > 0) {
+    atomic.notify_all();
+  }
+}
+
+}  // namespace android::ftl::details
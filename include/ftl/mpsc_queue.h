@@ -0,0 +1,212 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <ftl/details/queue.h>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+
+namespace android::ftl {
+
+// Bounded multi-producer single-consumer queue. Elements are stored in place in a ring of N slots,
+// so the queue never allocates, unlike linked queues that allocate a node per element.
+//
+// Each slot carries a sequence number that tells whether it is ready to be written or read (see
+// Dmitry Vyukov's bounded MPMC queue). try_pop is wait-free. try_push is lock-free: producers claim
+// slots by incrementing a shared index, so a producer only retries if another one claimed the slot
+// first. Elements are popped in the order in which their slots were claimed.
+//
+// With QueuePolicy::kBlocking, push and pop additionally wait for space or for an element.
+//
+// Any number of threads may push, but exactly one thread may pop at a time. N must be a power of
+// two.
+//
+// Example usage:
+//
+//   ftl::MpscQueue<std::string, 8> queue;
+//
+//   std::thread producer([&queue] { queue.try_emplace("abc"); });
+//   queue.try_push("def");
+//   producer.join();
+//
+//   assert(queue.size() == 2u);
+//   assert(queue.try_pop());
+//   assert(queue.try_pop());
+//   assert(queue.empty());
+//
+template <typename T, std::size_t N, QueuePolicy Policy = QueuePolicy::kNonBlocking>
+class MpscQueue final {
+  static_assert(details::is_power_of_two(N), "Capacity must be a power of two");
+
+  static constexpr std::size_t kMask = N - 1;
+  static constexpr bool kBlocking = Policy == QueuePolicy::kBlocking;
+
+ public:
+  using value_type = T;
+  using size_type = std::size_t;
+
+  MpscQueue() {
+    for (size_type i = 0; i < N; ++i) {
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  MpscQueue(const MpscQueue&) = delete;
+  MpscQueue& operator=(const MpscQueue&) = delete;
+
+  ~MpscQueue() {
+    for (size_type head = head_.load(std::memory_order_relaxed);; ++head) {
+      Cell& cell = cells_[head & kMask];
+      if (cell.sequence.load(std::memory_order_relaxed) != head + 1) break;
+      cell.slot.destroy();
+    }
+  }
+
+  static constexpr size_type capacity() { return N; }
+
+  // The size is exact only if no thread is running concurrently. Slots being written count.
+  size_type size() const {
+    const size_type head = head_.load(std::memory_order_acquire);
+    return tail_.load(std::memory_order_acquire) - head;
+  }
+
+  bool empty() const { return size() == 0; }
+
+  // Producer side. Constructs an element in place unless the queue is full, and returns whether it
+  // did. The arguments are not consumed on failure.
+  template <typename... Args>
+  bool try_emplace(Args&&... args) {
+    size_type tail = tail_.load(std::memory_order_relaxed);
+    while (true) {
+      Cell& cell = cells_[tail & kMask];
+      const auto lag = distance(cell.sequence.load(std::memory_order_acquire), tail);
+
+      if (lag == 0) {
+        if (tail_.compare_exchange_weak(tail, tail + 1, std::memory_order_relaxed)) {
+          publish(cell, tail, std::forward<Args>(args)...);
+          return true;
+        }
+      } else if (lag < 0) {
+        // The slot still holds the element from the previous lap.
+        return false;
+      } else {
+        // Another producer claimed the slot.
+        tail = tail_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  bool try_push(const T& value) { return try_emplace(value); }
+  bool try_push(T&& value) { return try_emplace(std::move(value)); }
+
+  // Producer side. Constructs an element in place, waiting for space if the queue is full.
+  template <typename... Args>
+  void emplace(Args&&... args) {
+    static_assert(kBlocking, "Blocking requires QueuePolicy::kBlocking");
+
+    size_type tail = tail_.load(std::memory_order_relaxed);
+    while (true) {
+      Cell& cell = cells_[tail & kMask];
+      const size_type sequence = cell.sequence.load(std::memory_order_acquire);
+      const auto lag = distance(sequence, tail);
+
+      if (lag == 0) {
+        if (tail_.compare_exchange_weak(tail, tail + 1, std::memory_order_relaxed)) {
+          publish(cell, tail, std::forward<Args>(args)...);
+          return;
+        }
+      } else {
+        // Wait for the consumer to free the slot, which is the oldest one if the queue is full.
+        if (lag < 0) details::wait_while_equal(cell.sequence, sequence, producer_waiters_);
+        tail = tail_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  void push(const T& value) { emplace(value); }
+  void push(T&& value) { emplace(std::move(value)); }
+
+  // Consumer side. Removes the oldest element, or returns std::nullopt if the queue is empty or the
+  // oldest element is still being written.
+  std::optional<T> try_pop() {
+    const size_type head = head_.load(std::memory_order_relaxed);
+    Cell& cell = cells_[head & kMask];
+    if (cell.sequence.load(std::memory_order_acquire) != head + 1) return std::nullopt;
+
+    return consume(cell, head);
+  }
+
+  // Consumer side. Removes the oldest element, waiting for one if the queue is empty.
+  T pop() {
+    static_assert(kBlocking, "Blocking requires QueuePolicy::kBlocking");
+
+    const size_type head = head_.load(std::memory_order_relaxed);
+    Cell& cell = cells_[head & kMask];
+    for (size_type sequence; (sequence = cell.sequence.load(std::memory_order_acquire)) != head + 1;) {
+      details::wait_while_equal(cell.sequence, sequence, consumer_waiters_);
+    }
+
+    return consume(cell, head);
+  }
+
+ private:
+  struct Cell {
+    std::atomic<size_type> sequence;
+    details::QueueSlot<T> slot;
+  };
+
+  static std::ptrdiff_t distance(size_type sequence, size_type tail) {
+    return static_cast<std::ptrdiff_t>(sequence - tail);
+  }
+
+  template <typename... Args>
+  void publish(Cell& cell, size_type tail, Args&&... args) {
+    cell.slot.construct(std::forward<Args>(args)...);
+    cell.sequence.store(tail + 1, std::memory_order_release);
+
+    if constexpr (kBlocking) {
+      details::notify_waiters(cell.sequence, consumer_waiters_);
+    }
+  }
+
+  T consume(Cell& cell, size_type head) {
+    T value = cell.slot.take();
+    cell.sequence.store(head + N, std::memory_order_release);
+    head_.store(head + 1, std::memory_order_release);
+
+    if constexpr (kBlocking) {
+      details::notify_waiters(cell.sequence, producer_waiters_);
+    }
+    return value;
+  }
+
+  // Producers contend on the tail, so keep it away from the consumer's head.
+  alignas(details::kCacheLineSize) std::atomic<size_type> tail_ = 0;
+  std::atomic<std::uint32_t> producer_waiters_ = 0;
+
+  alignas(details::kCacheLineSize) std::atomic<size_type> head_ = 0;
+  std::atomic<std::uint32_t> consumer_waiters_ = 0;
+
+  alignas(details::kCacheLineSize) std::array<Cell, N> cells_;
+};
+
+}  // namespace android::ftl
@@ -29,6 +29,9 @@ class [[clang::capability("shared_mutex")]] SharedMutex final {
   [[clang::acquire_capability()]] void lock() {
     mutex_.lock();
   }
+  [[clang::try_acquire_capability(true)]] bool try_lock() {
+    return mutex_.try_lock();
+  }
   [[clang::release_capability()]] void unlock() {
     mutex_.unlock();
   }
@@ -36,6 +39,9 @@ class [[clang::capability("shared_mutex")]] SharedMutex final {
   [[clang::acquire_shared_capability()]] void lock_shared() {
     mutex_.lock_shared();
   }
+  [[clang::try_acquire_shared_capability(true)]] bool try_lock_shared() {
+    return mutex_.try_lock_shared();
+  }
   [[clang::release_shared_capability()]] void unlock_shared() {
     mutex_.unlock_shared();
   }
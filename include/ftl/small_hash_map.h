@@ -0,0 +1,341 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <ftl/initializer_list.h>
+#include <ftl/optional.h>
+#include <ftl/small_vector.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace android::ftl {
+
+// Variant of ftl::SmallMap for maps that may outgrow a linear search. Mappings are stored exactly
+// like in SmallMap, i.e. contiguously and statically until the size exceeds N, so iteration order,
+// iterator invalidation, and the API are the same. Once the map holds more than kLinearSearchMax
+// mappings, it additionally builds an open-addressed index from key hash to position, so lookups
+// stop scaling with the size. The index is kept until the map is cleared.
+//
+// Example usage:
+//
+//   ftl::SmallHashMap<int, std::string, 4> map;
+//   assert(map.empty());
+//   assert(!map.dynamic());
+//   assert(!map.indexed());
+//
+//   for (int i = 0; i < 64; ++i) map.try_emplace(i, std::to_string(i));
+//   assert(map.dynamic());
+//   assert(map.indexed());
+//
+//   assert(map.get(42)->get() == "42");
+//   assert(map.erase(42));
+//   assert(!map.contains(42));
+//
+template <typename K, typename V, std::size_t N, typename Hash = std::hash<K>,
+          typename KeyEqual = std::equal_to<K>>
+class SmallHashMap final {
+  using Map = SmallVector<std::pair<const K, V>, N>;
+  using Index = std::vector<std::uint32_t>;
+
+  template <typename, typename, std::size_t, typename, typename>
+  friend class SmallHashMap;
+
+ public:
+  using key_type = K;
+  using mapped_type = V;
+
+  using value_type = typename Map::value_type;
+  using size_type = typename Map::size_type;
+  using difference_type = typename Map::difference_type;
+
+  using reference = typename Map::reference;
+  using iterator = typename Map::iterator;
+
+  using const_reference = typename Map::const_reference;
+  using const_iterator = typename Map::const_iterator;
+
+  // Up to this many mappings, lookup is a linear search as in SmallMap.
+  static constexpr size_type kLinearSearchMax = 8;
+
+  // Creates an empty map.
+  SmallHashMap() = default;
+
+  // Constructs at most N key-value pairs in place by forwarding per-pair constructor arguments.
+  // See SmallMap for the syntax.
+  template <typename U, std::size_t... Sizes, typename... Types>
+  SmallHashMap(InitializerList<U, std::index_sequence<Sizes...>, Types...>&& list)
+      : map_(std::move(list)) {
+    deduplicate();
+    reindex();
+  }
+
+  // Copies or moves key-value pairs from a convertible map.
+  template <typename Q, typename W, std::size_t M, typename H, typename E>
+  SmallHashMap(SmallHashMap<Q, W, M, H, E> other) : map_(std::move(other.map_)) {
+    reindex();
+  }
+
+  static constexpr size_type static_capacity() { return N; }
+
+  size_type max_size() const { return map_.max_size(); }
+  size_type size() const { return map_.size(); }
+  bool empty() const { return map_.empty(); }
+
+  // Returns whether the map is backed by static or dynamic storage.
+  bool dynamic() const {
+    if constexpr (static_capacity() > 0) {
+      return map_.dynamic();
+    } else {
+      return true;
+    }
+  }
+
+  // Returns whether lookups go through the hash index rather than a linear search.
+  bool indexed() const { return !index_.empty(); }
+
+  iterator begin() { return map_.begin(); }
+  const_iterator begin() const { return cbegin(); }
+  const_iterator cbegin() const { return map_.cbegin(); }
+
+  iterator end() { return map_.end(); }
+  const_iterator end() const { return cend(); }
+  const_iterator cend() const { return map_.cend(); }
+
+  // Returns whether a mapping exists for the given key.
+  bool contains(const key_type& key) const { return find(key) != end(); }
+
+  // Returns a reference to the value for the given key, or std::nullopt if the key was not found.
+  auto get(const key_type& key) const -> Optional<std::reference_wrapper<const mapped_type>> {
+    if (const auto it = find(key); it != end()) {
+      return std::cref(it->second);
+    }
+    return {};
+  }
+
+  auto get(const key_type& key) -> Optional<std::reference_wrapper<mapped_type>> {
+    if (const auto it = find(key); it != end()) {
+      return std::ref(it->second);
+    }
+    return {};
+  }
+
+  // Returns an iterator to an existing mapping for the given key, or the end() iterator otherwise.
+  const_iterator find(const key_type& key) const {
+    return const_cast<SmallHashMap&>(*this).find(key);
+  }
+
+  iterator find(const key_type& key) {
+    if (!indexed()) {
+      return std::find_if(begin(), end(),
+                          [&key](const auto& pair) { return KeyEqual{}(pair.first, key); });
+    }
+
+    for (size_type slot = home(key);; slot = next(slot)) {
+      const std::uint32_t position = index_[slot];
+      if (position == kEmpty) return end();
+      if (KeyEqual{}(map_[position].first, key)) return begin() + position;
+    }
+  }
+
+  // Inserts a mapping unless it exists. Returns an iterator to the inserted or existing mapping,
+  // and whether the mapping was inserted.
+  //
+  // On emplace, if the map reaches its static or dynamic capacity, then all iterators are
+  // invalidated. Otherwise, only the end() iterator is invalidated.
+  //
+  template <typename... Args>
+  std::pair<iterator, bool> try_emplace(const key_type& key, Args&&... args) {
+    if (const auto it = find(key); it != end()) {
+      return {it, false};
+    }
+
+    map_.emplace_back(std::piecewise_construct, std::forward_as_tuple(key),
+                      std::forward_as_tuple(std::forward<Args>(args)...));
+
+    const size_type position = size() - 1;
+    if (indexed() && 2 * size() <= index_.size()) {
+      insert(position);
+    } else if (indexed() || size() > kLinearSearchMax) {
+      reindex();
+    }
+
+    return {begin() + position, true};
+  }
+
+  // Replaces a mapping if it exists, and returns an iterator to it. Returns the end() iterator
+  // otherwise. See SmallMap::try_replace.
+  template <typename... Args>
+  iterator try_replace(const key_type& key, Args&&... args) {
+    const auto it = find(key);
+    if (it == end()) return it;
+    map_.replace(it, std::piecewise_construct, std::forward_as_tuple(key),
+                 std::forward_as_tuple(std::forward<Args>(args)...));
+    return it;
+  }
+
+  // In-place counterpart of std::unordered_map's insert_or_assign. Returns true on emplace, or
+  // false on replace. See SmallMap::emplace_or_replace.
+  template <typename... Args>
+  std::pair<iterator, bool> emplace_or_replace(const key_type& key, Args&&... args) {
+    const auto [it, ok] = try_emplace(key, std::forward<Args>(args)...);
+    if (ok) return {it, ok};
+    map_.replace(it, std::piecewise_construct, std::forward_as_tuple(key),
+                 std::forward_as_tuple(std::forward<Args>(args)...));
+    return {it, ok};
+  }
+
+  // Removes a mapping if it exists, and returns whether it did.
+  //
+  // The last() and end() iterators, as well as those to the erased mapping, are invalidated.
+  //
+  bool erase(const key_type& key) {
+    const auto it = find(key);
+    if (it == end()) return false;
+
+    if (indexed()) {
+      // The last mapping is moved into the hole, so its index entry has to follow.
+      const auto position = static_cast<std::uint32_t>(it - begin());
+      const auto last = static_cast<std::uint32_t>(size() - 1);
+      unindex(slot_of(position));
+      if (position != last) {
+        index_[slot_of(last)] = position;
+      }
+    }
+
+    map_.unstable_erase(it);
+    return true;
+  }
+
+  // Removes all mappings.
+  //
+  // All iterators are invalidated.
+  //
+  void clear() {
+    map_.clear();
+    index_.clear();
+  }
+
+ private:
+  static constexpr std::uint32_t kEmpty = UINT32_MAX;
+
+  // Fibonacci hashing, so that sequential keys with an identity std::hash still spread out.
+  size_type home(const key_type& key) const {
+    const auto hash = static_cast<std::uint64_t>(Hash{}(key)) * 0x9e3779b97f4a7c15ull;
+    return static_cast<size_type>(hash >> (64 - index_bits_));
+  }
+
+  size_type next(size_type slot) const { return (slot + 1) & (index_.size() - 1); }
+
+  // Returns the index slot that refers to the mapping at the given position.
+  size_type slot_of(std::uint32_t position) const {
+    size_type slot = home(map_[position].first);
+    while (index_[slot] != position) slot = next(slot);
+    return slot;
+  }
+
+  void insert(size_type position) {
+    size_type slot = home(map_[position].first);
+    while (index_[slot] != kEmpty) slot = next(slot);
+    index_[slot] = static_cast<std::uint32_t>(position);
+  }
+
+  // Empties a slot, shifting back later entries of its probe sequence so lookups need no
+  // tombstones.
+  void unindex(size_type hole) {
+    for (size_type slot = next(hole); index_[slot] != kEmpty; slot = next(slot)) {
+      const size_type target = home(map_[index_[slot]].first);
+      // Leave the entry if its home lies cyclically in (hole, slot].
+      const bool stays = hole <= slot ? (hole < target && target <= slot)
+                                      : (hole < target || target <= slot);
+      if (!stays) {
+        index_[hole] = index_[slot];
+        hole = slot;
+      }
+    }
+    index_[hole] = kEmpty;
+  }
+
+  // Rebuilds the index with a load factor of at most one half, or drops it for small maps.
+  void reindex() {
+    index_.clear();
+    if (size() <= kLinearSearchMax) return;
+
+    index_bits_ = 1;
+    while ((size_type{1} << index_bits_) < 2 * size()) ++index_bits_;
+    index_.assign(size_type{1} << index_bits_, kEmpty);
+
+    for (size_type position = 0; position < size(); ++position) {
+      insert(position);
+    }
+  }
+
+  void deduplicate() {
+    for (auto it = begin(); it != end();) {
+      if (const auto key = it->first; ++it != end()) {
+        while (erase_after(key, it));
+      }
+    }
+  }
+
+  bool erase_after(const key_type& key, iterator first) {
+    const auto it = std::find_if(first, end(),
+                                 [&key](const auto& pair) { return KeyEqual{}(pair.first, key); });
+    if (it == end()) return false;
+    map_.unstable_erase(it);
+    return true;
+  }
+
+  Map map_;
+  Index index_;
+  size_type index_bits_ = 0;
+};
+
+// Deduction guide for in-place constructor.
+template <typename K, typename V, typename E, std::size_t... Sizes, typename... Types>
+SmallHashMap(InitializerList<KeyValue<K, V, E>, std::index_sequence<Sizes...>, Types...>&&)
+    -> SmallHashMap<K, V, sizeof...(Sizes), std::hash<K>, E>;
+
+// Returns whether the key-value pairs of two maps are equal.
+template <typename K, typename V, std::size_t N, typename Q, typename W, std::size_t M, typename H,
+          typename E>
+bool operator==(const SmallHashMap<K, V, N, H, E>& lhs, const SmallHashMap<Q, W, M, H, E>& rhs) {
+  if (lhs.size() != rhs.size()) return false;
+
+  for (const auto& [k, v] : lhs) {
+    const auto& lv = v;
+    if (!rhs.get(k).transform([&lv](const W& rv) { return lv == rv; }).value_or(false)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// TODO: Remove in C++20.
+template <typename K, typename V, std::size_t N, typename Q, typename W, std::size_t M, typename H,
+          typename E>
+inline bool operator!=(const SmallHashMap<K, V, N, H, E>& lhs,
+                       const SmallHashMap<Q, W, M, H, E>& rhs) {
+  return !(lhs == rhs);
+}
+
+}  // namespace android::ftl
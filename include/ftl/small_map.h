@@ -22,6 +22,7 @@
 
 #include <algorithm>
 #include <functional>
+#include <memory>
 #include <type_traits>
 #include <utility>
 
@@ -36,6 +37,8 @@ namespace android::ftl {
 //
 // SmallMap<K, V, 0> unconditionally allocates on the heap.
 //
+// The Allocator is used for dynamic storage. See SmallVector.
+//
 // Example usage:
 //
 //   ftl::SmallMap<int, std::string, 3> map;
@@ -61,11 +64,12 @@ namespace android::ftl {
 //
 //   assert(map == SmallMap(ftl::init::map(-1, "xyz"sv)(0, "nil"sv)(42, "???"sv)(123, "abc"sv)));
 //
-template <typename K, typename V, std::size_t N, typename KeyEqual = std::equal_to<K>>
+template <typename K, typename V, std::size_t N, typename KeyEqual = std::equal_to<K>,
+          typename Allocator = std::allocator<std::pair<const K, V>>>
 class SmallMap final {
-  using Map = SmallVector<std::pair<const K, V>, N>;
+  using Map = SmallVector<std::pair<const K, V>, N, Allocator>;
 
-  template <typename, typename, std::size_t, typename>
+  template <typename, typename, std::size_t, typename, typename>
   friend class SmallMap;
 
  public:
@@ -82,9 +86,14 @@ class SmallMap final {
   using const_reference = typename Map::const_reference;
   using const_iterator = typename Map::const_iterator;
 
+  using allocator_type = Allocator;
+
   // Creates an empty map.
   SmallMap() = default;
 
+  // Creates an empty map that allocates dynamic storage using the given allocator.
+  explicit SmallMap(const Allocator& allocator) : map_(allocator) {}
+
   // Constructs at most N key-value pairs in place by forwarding per-pair constructor arguments.
   // The template arguments K, V, and N are inferred using the deduction guide defined below.
   // The syntax for listing pairs is as follows:
@@ -104,11 +113,13 @@ class SmallMap final {
   }
 
   // Copies or moves key-value pairs from a convertible map.
-  template <typename Q, typename W, std::size_t M, typename E>
-  SmallMap(SmallMap<Q, W, M, E> other) : map_(std::move(other.map_)) {}
+  template <typename Q, typename W, std::size_t M, typename E, typename A>
+  SmallMap(SmallMap<Q, W, M, E, A> other) : map_(std::move(other.map_)) {}
 
   static constexpr size_type static_capacity() { return N; }
 
+  Allocator get_allocator() const { return map_.get_allocator(); }
+
   size_type max_size() const { return map_.max_size(); }
   size_type size() const { return map_.size(); }
   bool empty() const { return map_.empty(); }
@@ -270,8 +281,9 @@ SmallMap(InitializerList<KeyValue<K, V, E>, std::index_sequence<Sizes...>, Types
     -> SmallMap<K, V, sizeof...(Sizes), E>;
 
 // Returns whether the key-value pairs of two maps are equal.
-template <typename K, typename V, std::size_t N, typename Q, typename W, std::size_t M, typename E>
-bool operator==(const SmallMap<K, V, N, E>& lhs, const SmallMap<Q, W, M, E>& rhs) {
+template <typename K, typename V, std::size_t N, typename Q, typename W, std::size_t M, typename E,
+          typename A, typename B>
+bool operator==(const SmallMap<K, V, N, E, A>& lhs, const SmallMap<Q, W, M, E, B>& rhs) {
   if (lhs.size() != rhs.size()) return false;
 
   for (const auto& [k, v] : lhs) {
@@ -285,8 +297,9 @@ bool operator==(const SmallMap<K, V, N, E>& lhs, const SmallMap<Q, W, M, E>& rhs
 }
 
 // TODO: Remove in C++20.
-template <typename K, typename V, std::size_t N, typename Q, typename W, std::size_t M, typename E>
-inline bool operator!=(const SmallMap<K, V, N, E>& lhs, const SmallMap<Q, W, M, E>& rhs) {
+template <typename K, typename V, std::size_t N, typename Q, typename W, std::size_t M, typename E,
+          typename A, typename B>
+inline bool operator!=(const SmallMap<K, V, N, E, A>& lhs, const SmallMap<Q, W, M, E, B>& rhs) {
   return !(lhs == rhs);
 }
 
@@ -21,6 +21,7 @@
 
 #include <algorithm>
 #include <iterator>
+#include <memory>
 #include <utility>
 #include <variant>
 #include <vector>
@@ -32,6 +33,9 @@ namespace android::ftl {
 template <typename>
 struct is_small_vector;
 
+template <typename T>
+using DefaultAllocator = std::allocator<std::remove_const_t<T>>;
+
 // ftl::StaticVector that promotes to std::vector when full. SmallVector is a drop-in replacement
 // for std::vector with statically allocated storage for N elements, whose goal is to improve run
 // time by avoiding heap allocation and increasing probability of cache hits. The standard API is
@@ -43,6 +47,10 @@ struct is_small_vector;
 //
 // SmallVector<T, 0> is a specialization that thinly wraps std::vector.
 //
+// The Allocator is used for dynamic storage, e.g. ftl::ArenaAllocator to spill per-frame data into
+// an ftl::Arena rather than the heap. A stateful allocator is passed to the constructor, and kept
+// while the vector is static.
+//
 // Example usage:
 //
 //   ftl::SmallVector<char, 3> vector;
@@ -76,10 +84,10 @@ struct is_small_vector;
 //   assert(strings[1] == "123");
 //   assert(strings[2] == "???");
 //
-template <typename T, std::size_t N>
+template <typename T, std::size_t N, typename Allocator = DefaultAllocator<T>>
 class SmallVector final : details::ArrayTraits<T>, details::ArrayComparators<SmallVector> {
   using Static = StaticVector<T, N>;
-  using Dynamic = SmallVector<T, 0>;
+  using Dynamic = SmallVector<T, 0, Allocator>;
 
  public:
   FTL_ARRAY_TRAIT(T, value_type);
@@ -96,20 +104,33 @@ class SmallVector final : details::ArrayTraits<T>, details::ArrayComparators<Sma
   FTL_ARRAY_TRAIT(T, const_iterator);
   FTL_ARRAY_TRAIT(T, const_reverse_iterator);
 
+  using allocator_type = Allocator;
+
   // Creates an empty vector.
   SmallVector() = default;
 
+  // Creates an empty vector that allocates dynamic storage using the given allocator.
+  explicit SmallVector(const Allocator& allocator) : allocator_(allocator) {}
+
   // Constructs at most N elements. See StaticVector for underlying constructors.
   template <typename Arg, typename... Args,
-            typename = std::enable_if_t<!is_small_vector<details::remove_cvref_t<Arg>>{}>>
+            typename = std::enable_if_t<!is_small_vector<details::remove_cvref_t<Arg>>{} &&
+                                        !std::is_convertible_v<Arg, Allocator>>>
   SmallVector(Arg&& arg, Args&&... args)
       : vector_(std::in_place_type<Static>, std::forward<Arg>(arg), std::forward<Args>(args)...) {}
 
   // Copies or moves elements from a smaller convertible vector.
-  template <typename U, std::size_t M, typename = std::enable_if_t<(M > 0)>>
-  SmallVector(SmallVector<U, M> other) : vector_(convert(std::move(other))) {}
+  template <typename U, std::size_t M, typename A, typename = std::enable_if_t<(M > 0)>>
+  SmallVector(SmallVector<U, M, A> other)
+      : vector_(convert(std::move(other))), allocator_(other.get_allocator()) {}
+
+  void swap(SmallVector& other) {
+    using std::swap;
+    vector_.swap(other.vector_);
+    swap(allocator_, other.allocator_);
+  }
 
-  void swap(SmallVector& other) { vector_.swap(other.vector_); }
+  Allocator get_allocator() const { return allocator_; }
 
   // Returns whether the vector is backed by static or dynamic storage.
   bool dynamic() const { return std::holds_alternative<Dynamic>(vector_); }
@@ -234,21 +255,21 @@ class SmallVector final : details::ArrayTraits<T>, details::ArrayComparators<Sma
   }
 
   // Extracts the elements as std::vector.
-  std::vector<std::remove_const_t<T>> promote() && {
+  std::vector<std::remove_const_t<T>, Allocator> promote() && {
     if (dynamic()) {
       return std::get<Dynamic>(std::move(vector_)).promote();
     } else {
-      return {std::make_move_iterator(begin()), std::make_move_iterator(end())};
+      return {std::make_move_iterator(begin()), std::make_move_iterator(end()), allocator_};
     }
   }
 
  private:
-  template <typename, std::size_t>
+  template <typename, std::size_t, typename>
   friend class SmallVector;
 
-  template <typename U, std::size_t M>
-  static std::variant<Static, Dynamic> convert(SmallVector<U, M>&& other) {
-    using Other = SmallVector<U, M>;
+  template <typename U, std::size_t M, typename A>
+  static std::variant<Static, Dynamic> convert(SmallVector<U, M, A>&& other) {
+    using Other = SmallVector<U, M, A>;
 
     if (other.dynamic()) {
       return std::get<typename Other::Dynamic>(std::move(other.vector_));
@@ -275,7 +296,7 @@ class SmallVector final : details::ArrayTraits<T>, details::ArrayComparators<Sma
     assert(static_vector.full());
 
     // Allocate double capacity to reduce probability of reallocation.
-    Dynamic vector;
+    Dynamic vector(allocator_);
     vector.reserve(Static::max_size() * 2);
     std::move(static_vector.begin(), static_vector.end(), std::back_inserter(vector));
 
@@ -283,18 +304,20 @@ class SmallVector final : details::ArrayTraits<T>, details::ArrayComparators<Sma
   }
 
   std::variant<Static, Dynamic> vector_;
+  [[no_unique_address]] Allocator allocator_;
 };
 
 // Partial specialization without static storage.
-template <typename T>
-class SmallVector<T, 0> final : details::ArrayTraits<T>,
-                                details::ArrayComparators<SmallVector>,
-                                details::ArrayIterators<SmallVector<T, 0>, T>,
-                                std::vector<std::remove_const_t<T>> {
+template <typename T, typename Allocator>
+class SmallVector<T, 0, Allocator> final
+    : details::ArrayTraits<T>,
+      details::ArrayComparators<SmallVector>,
+      details::ArrayIterators<SmallVector<T, 0, Allocator>, T>,
+      std::vector<std::remove_const_t<T>, Allocator> {
   using details::ArrayTraits<T>::replace_at;
 
   using Iter = details::ArrayIterators<SmallVector, T>;
-  using Impl = std::vector<std::remove_const_t<T>>;
+  using Impl = std::vector<std::remove_const_t<T>, Allocator>;
 
   friend Iter;
 
@@ -326,8 +349,8 @@ class SmallVector<T, 0> final : details::ArrayTraits<T>,
       : SmallVector(SmallVector<T, sizeof...(Sizes)>(std::move(list))) {}
 
   // Copies or moves elements from a convertible vector.
-  template <typename U, std::size_t M>
-  SmallVector(SmallVector<U, M> other) : Impl(convert(std::move(other))) {}
+  template <typename U, std::size_t M, typename A>
+  SmallVector(SmallVector<U, M, A> other) : Impl(convert(std::move(other))) {}
 
   SmallVector& operator=(SmallVector other) {
     // Define copy/move assignment in terms of copy/move construction.
@@ -337,6 +360,9 @@ class SmallVector<T, 0> final : details::ArrayTraits<T>,
 
   void swap(SmallVector& other) { Impl::swap(other); }
 
+  using typename Impl::allocator_type;
+  using Impl::get_allocator;
+
   using Impl::empty;
   using Impl::max_size;
   using Impl::size;
@@ -394,15 +420,15 @@ class SmallVector<T, 0> final : details::ArrayTraits<T>,
     pop_back();
   }
 
-  std::vector<std::remove_const_t<T>> promote() && { return std::move(*this); }
+  Impl promote() && { return std::move(*this); }
 
  private:
-  template <typename U, std::size_t M>
-  static Impl convert(SmallVector<U, M>&& other) {
-    if constexpr (std::is_constructible_v<Impl, std::vector<std::remove_const_t<U>>&&>) {
+  template <typename U, std::size_t M, typename A>
+  static Impl convert(SmallVector<U, M, A>&& other) {
+    if constexpr (std::is_constructible_v<Impl, std::vector<std::remove_const_t<U>, A>&&>) {
       return std::move(other).promote();
     } else {
-      SmallVector vector(other.size());
+      SmallVector vector(other.size(), Allocator(other.get_allocator()));
 
       // Consistently with StaticVector, T only requires copy/move construction from U, rather than
       // copy/move assignment.
@@ -419,8 +445,8 @@ class SmallVector<T, 0> final : details::ArrayTraits<T>,
 template <typename>
 struct is_small_vector : std::false_type {};
 
-template <typename T, std::size_t N>
-struct is_small_vector<SmallVector<T, N>> : std::true_type {};
+template <typename T, std::size_t N, typename Allocator>
+struct is_small_vector<SmallVector<T, N, Allocator>> : std::true_type {};
 
 // Deduction guide for array constructor.
 template <typename T, std::size_t N>
@@ -440,8 +466,8 @@ SmallVector(InitializerList<T, std::index_sequence<Sizes...>, Types...>&&)
 template <typename T, std::size_t N>
 SmallVector(StaticVector<T, N>&&) -> SmallVector<T, N>;
 
-template <typename T, std::size_t N>
-inline void swap(SmallVector<T, N>& lhs, SmallVector<T, N>& rhs) {
+template <typename T, std::size_t N, typename Allocator>
+inline void swap(SmallVector<T, N, Allocator>& lhs, SmallVector<T, N, Allocator>& rhs) {
   lhs.swap(rhs);
 }
 
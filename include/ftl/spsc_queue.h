@@ -0,0 +1,190 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <ftl/details/queue.h>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+
+namespace android::ftl {
+
+// Bounded single-producer single-consumer queue. Elements are stored in place in a ring of N slots,
+// so the queue never allocates. try_push and try_pop are wait-free: each side owns one index, and
+// caches the other side's index so that it only touches the other side's cache line when the queue
+// looks full or empty.
+//
+// With QueuePolicy::kBlocking, push and pop additionally wait for space or for an element.
+//
+// Exactly one thread may push, and exactly one thread may pop, at a time. N must be a power of two.
+//
+// Example usage:
+//
+//   ftl::SpscQueue<int, 4> queue;
+//   assert(queue.empty());
+//
+//   assert(queue.try_push(1));
+//   assert(queue.try_emplace(2));
+//   assert(queue.size() == 2u);
+//
+//   assert(queue.try_pop() == 1);
+//   assert(queue.try_pop() == 2);
+//   assert(!queue.try_pop());
+//
+template <typename T, std::size_t N, QueuePolicy Policy = QueuePolicy::kNonBlocking>
+class SpscQueue final {
+  static_assert(details::is_power_of_two(N), "Capacity must be a power of two");
+
+  static constexpr std::size_t kMask = N - 1;
+  static constexpr bool kBlocking = Policy == QueuePolicy::kBlocking;
+
+ public:
+  using value_type = T;
+  using size_type = std::size_t;
+
+  SpscQueue() = default;
+
+  SpscQueue(const SpscQueue&) = delete;
+  SpscQueue& operator=(const SpscQueue&) = delete;
+
+  ~SpscQueue() {
+    const size_type tail = producer_.tail.load(std::memory_order_relaxed);
+    for (size_type head = consumer_.head.load(std::memory_order_relaxed); head != tail; ++head) {
+      slots_[head & kMask].destroy();
+    }
+  }
+
+  static constexpr size_type capacity() { return N; }
+
+  // The size is exact only if neither side is running concurrently.
+  size_type size() const {
+    const size_type head = consumer_.head.load(std::memory_order_acquire);
+    return producer_.tail.load(std::memory_order_acquire) - head;
+  }
+
+  bool empty() const { return size() == 0; }
+
+  // Producer side. Constructs an element in place unless the queue is full, and returns whether it
+  // did. The arguments are not consumed on failure.
+  template <typename... Args>
+  bool try_emplace(Args&&... args) {
+    const size_type tail = producer_.tail.load(std::memory_order_relaxed);
+    if (tail - producer_.head_cache == N) {
+      producer_.head_cache = consumer_.head.load(std::memory_order_acquire);
+      if (tail - producer_.head_cache == N) return false;
+    }
+
+    publish(tail, std::forward<Args>(args)...);
+    return true;
+  }
+
+  bool try_push(const T& value) { return try_emplace(value); }
+  bool try_push(T&& value) { return try_emplace(std::move(value)); }
+
+  // Producer side. Constructs an element in place, waiting for space if the queue is full.
+  template <typename... Args>
+  void emplace(Args&&... args) {
+    static_assert(kBlocking, "Blocking requires QueuePolicy::kBlocking");
+
+    const size_type tail = producer_.tail.load(std::memory_order_relaxed);
+    while (tail - producer_.head_cache == N) {
+      const size_type head = consumer_.head.load(std::memory_order_acquire);
+      if (tail - head == N) {
+        details::wait_while_equal(consumer_.head, head, producer_waiters_);
+      }
+      producer_.head_cache = consumer_.head.load(std::memory_order_acquire);
+    }
+
+    publish(tail, std::forward<Args>(args)...);
+  }
+
+  void push(const T& value) { emplace(value); }
+  void push(T&& value) { emplace(std::move(value)); }
+
+  // Consumer side. Removes the oldest element, or returns std::nullopt if the queue is empty.
+  std::optional<T> try_pop() {
+    const size_type head = consumer_.head.load(std::memory_order_relaxed);
+    if (head == consumer_.tail_cache) {
+      consumer_.tail_cache = producer_.tail.load(std::memory_order_acquire);
+      if (head == consumer_.tail_cache) return std::nullopt;
+    }
+
+    return consume(head);
+  }
+
+  // Consumer side. Removes the oldest element, waiting for one if the queue is empty.
+  T pop() {
+    static_assert(kBlocking, "Blocking requires QueuePolicy::kBlocking");
+
+    const size_type head = consumer_.head.load(std::memory_order_relaxed);
+    while (head == consumer_.tail_cache) {
+      const size_type tail = producer_.tail.load(std::memory_order_acquire);
+      if (head == tail) {
+        details::wait_while_equal(producer_.tail, tail, consumer_waiters_);
+      }
+      consumer_.tail_cache = producer_.tail.load(std::memory_order_acquire);
+    }
+
+    return consume(head);
+  }
+
+ private:
+  template <typename... Args>
+  void publish(size_type tail, Args&&... args) {
+    slots_[tail & kMask].construct(std::forward<Args>(args)...);
+    producer_.tail.store(tail + 1, std::memory_order_release);
+
+    if constexpr (kBlocking) {
+      details::notify_waiters(producer_.tail, consumer_waiters_);
+    }
+  }
+
+  T consume(size_type head) {
+    T value = slots_[head & kMask].take();
+    consumer_.head.store(head + 1, std::memory_order_release);
+
+    if constexpr (kBlocking) {
+      details::notify_waiters(consumer_.head, producer_waiters_);
+    }
+    return value;
+  }
+
+  // Each side writes only to its own cache line, except to register as a waiter.
+  struct alignas(details::kCacheLineSize) Producer {
+    std::atomic<size_type> tail = 0;
+    size_type head_cache = 0;
+  };
+
+  struct alignas(details::kCacheLineSize) Consumer {
+    std::atomic<size_type> head = 0;
+    size_type tail_cache = 0;
+  };
+
+  Producer producer_;
+  std::atomic<std::uint32_t> producer_waiters_ = 0;
+
+  Consumer consumer_;
+  std::atomic<std::uint32_t> consumer_waiters_ = 0;
+
+  alignas(details::kCacheLineSize) std::array<details::QueueSlot<T>, N> slots_;
+};
+
+}  // namespace android::ftl
@@ -0,0 +1,117 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include <android-base/result.h>
+#include <android-base/unique_fd.h>
+#include <input/InputTransport.h>
+#include <utils/Errors.h>
+
+namespace android {
+
+/**
+ * A single producer, single consumer ring of InputMessages in shared memory, used to move events
+ * from an InputPublisher to an InputConsumer without a system call per message.
+ *
+ * The ring complements an InputChannel rather than replacing it: the channel's socket stays in
+ * place for control messages, such as the consumer's finished signals, and for the initial
+ * handshake that hands the ring's file descriptors to the consumer.
+ *
+ * Messages keep the InputMessage layout. The producer writes a sanitized copy of every message,
+ * and the consumer copies each message out of shared memory before validating it with
+ * InputMessage::isValid, so a misbehaving peer can't change a message after it was validated.
+ * Neither side trusts the indices owned by the other side.
+ *
+ * The consumer is woken up through an eventfd, which the producer signals only when the consumer
+ * has reported that it found the ring empty.
+ */
+class InputMessageRing {
+public:
+    /**
+     * Creates a ring that holds up to capacity messages. The creator of the ring is the producer.
+     */
+    static base::Result<std::unique_ptr<InputMessageRing>> create(const std::string& name,
+                                                                  size_t capacity);
+
+    /**
+     * Maps a ring that was created by the producer in another process, using the file
+     * descriptors returned by its dupMemoryFd() and dupEventFd(). The caller is the consumer.
+     */
+    static base::Result<std::unique_ptr<InputMessageRing>> open(const std::string& name,
+                                                                base::unique_fd memoryFd,
+                                                                base::unique_fd eventFd);
+
+    ~InputMessageRing();
+
+    InputMessageRing(const InputMessageRing&) = delete;
+    InputMessageRing& operator=(const InputMessageRing&) = delete;
+
+    inline const std::string& getName() const { return mName; }
+    inline size_t getCapacity() const { return mCapacity; }
+
+    /* The file descriptor the consumer polls for new messages. */
+    inline int getEventFd() const { return mEventFd.get(); }
+
+    base::unique_fd dupMemoryFd() const;
+    base::unique_fd dupEventFd() const;
+
+    /* Writes a message to the ring. Must only be called by the producer.
+     *
+     * Return OK on success.
+     * Return WOULD_BLOCK if the ring is full.
+     * Return DEAD_OBJECT if the consumer corrupted the ring.
+     */
+    status_t sendMessage(const InputMessage& msg);
+
+    /* Reads the oldest message from the ring. Must only be called by the consumer.
+     *
+     * Return WOULD_BLOCK if there is no message present. Poll getEventFd() before trying again.
+     * Return BAD_VALUE if the message is not valid.
+     * Return DEAD_OBJECT if the producer corrupted the ring.
+     */
+    base::Result<InputMessage> receiveMessage();
+
+private:
+    struct Header;
+    struct Slot;
+
+    InputMessageRing(std::string name, base::unique_fd memoryFd, base::unique_fd eventFd,
+                     void* memory, size_t memorySize, size_t capacity);
+
+    Header& header() const;
+    Slot& slotAt(uint64_t index) const;
+
+    static size_t getSlotsOffset();
+    static size_t getMemorySize(size_t capacity);
+
+    const std::string mName;
+    const base::unique_fd mMemoryFd;
+    const base::unique_fd mEventFd;
+    void* const mMemory;
+    const size_t mMemorySize;
+    const size_t mCapacity;
+
+    // The index owned by this side of the ring, which is only ever published to the peer.
+    uint64_t mLocalIndex = 0;
+};
+
+} // namespace android
@@ -30,6 +30,7 @@
 
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include <android-base/chrono_utils.h>
 #include <android-base/result.h>
@@ -265,6 +266,17 @@ public:
      */
     virtual status_t sendMessage(const InputMessage* msg);
 
+    /* Send several messages to the other endpoint, in order, using as few system calls as
+     * possible. Each message is still delivered as its own packet.
+     *
+     * On return, outSentCount holds the number of leading messages that were sent. It is less than
+     * count only if an error is returned, in which case the error applies to the first message that
+     * was not sent, and none of the following messages were sent either.
+     *
+     * Returns the same errors as sendMessage.
+     */
+    status_t sendMessages(const InputMessage* msgs, size_t count, size_t* outSentCount);
+
     /* Receive a message sent by the other endpoint.
      *
      * If there is no message present, try again after poll() indicates that the fd
@@ -415,6 +427,26 @@ public:
      */
     status_t publishTouchModeEvent(uint32_t seq, int32_t eventId, bool isInTouchMode);
 
+    /* Starts deferring the events published to the input channel until endBatch() is called, so
+     * that they can be written with a single system call.
+     *
+     * While a batch is open, the publish methods return OK once the event is queued, and only
+     * return the errors caused by invalid arguments, such as BAD_VALUE.
+     */
+    void beginBatch();
+
+    /* Writes the events published since beginBatch() to the input channel, in order.
+     *
+     * On return, outPublishedCount holds the number of leading events that were written. The
+     * remaining events are discarded and must be published again.
+     *
+     * Returns OK on success.
+     * Returns WOULD_BLOCK if the channel became full.
+     * Returns DEAD_OBJECT if the channel's peer has been closed.
+     * Other errors probably indicate that the channel is broken.
+     */
+    status_t endBatch(size_t* outPublishedCount);
+
     struct Finished {
         uint32_t seq;
         bool handled;
@@ -450,8 +482,12 @@ public:
     android::base::Result<ConsumerResponse> receiveConsumerResponse();
 
 private:
+    status_t sendOrQueueMessage(const InputMessage& msg);
+
     std::shared_ptr<InputChannel> mChannel;
     InputVerifier mInputVerifier;
+    bool mBatching = false;
+    std::vector<InputMessage> mBatch;
 };
 
 } // namespace android
@@ -269,6 +269,11 @@ private:
 
     /* Reloads the data from mLoadFileName and unapplies any overlay. */
     status_t reloadBaseFromFile();
+
+    /* Returns the map parsed from a file, which is shared with other loads of the same file while
+     * its contents don't change, and must be copied before it is modified. */
+    static base::Result<std::shared_ptr<const KeyCharacterMap>> loadParsed(
+            const std::string& filename, Format format);
 };
 
 } // namespace android
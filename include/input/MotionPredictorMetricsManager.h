@@ -72,6 +72,10 @@ public:
     // MotionEvent that will be returned by MotionPredictor::predict.
     void onPredict(const MotionEvent& predictionEvent);
 
+    // This method should be called once for each model inference made by MotionPredictor::predict,
+    // receiving the time that the inference took, whether or not it produced a prediction.
+    void onInference(nsecs_t inferenceLatency);
+
     // Simple structs to hold relevant touch input information. Public so they can be used in tests.
 
     struct TouchPoint {
@@ -155,6 +159,11 @@ public:
         // Scale-invariant errors
         int scaleInvariantAlongTrajectoryRmse = NO_DATA_SENTINEL; // millipixels
         int scaleInvariantOffTrajectoryRmse = NO_DATA_SENTINEL;   // millipixels
+
+        // Inference latency of the stroke. Identical across time buckets, since a single inference
+        // generates the predictions of all time buckets.
+        int inferenceLatencyMeanMicros = NO_DATA_SENTINEL;
+        int inferenceLatencyMaxMicros = NO_DATA_SENTINEL;
     };
 
 private:
@@ -180,6 +189,11 @@ private:
     std::vector<AggregatedStrokeMetrics> mAggregatedMetrics;
     std::vector<AtomFields> mAtomFields;
 
+    // Inference latencies of the current stroke.
+    nsecs_t mInferenceLatencySum = 0;
+    nsecs_t mInferenceLatencyMax = 0;
+    size_t mInferenceCount = 0;
+
     const ReportAtomFunction mReportAtomFunction;
 
     // Helper methods for the implementation of onRecord and onPredict.
@@ -151,4 +151,55 @@ private:
 
     inline static void addSampleToMotionEvent(const Sample& sample, MotionEvent& motionEvent);
 };
+
+/**
+ * Resamples MotionEvents at the frame time, which LegacyResampler only approaches by
+ * RESAMPLE_LATENCY, by fitting a quadratic polynomial to the latest samples of every pointer with
+ * least squares, and extrapolating it.
+ *
+ * The curvature of the fit is only ever used to slow the prediction down: the predicted motion
+ * never goes further than the fitted velocity would take the pointer, and never goes backwards.
+ * When the pointer decelerates to a stop, this overshoots less than the linear extrapolation of
+ * LegacyResampler. If `futureSample` is available, LeastSquaresResampler interpolates linearly
+ * between the latest sample and `futureSample`, like LegacyResampler.
+ */
+class LeastSquaresResampler final : public Resampler {
+public:
+    void resampleMotionEvent(std::chrono::nanoseconds frameTime, MotionEvent& motionEvent,
+                             const InputMessage* futureSample) override;
+
+    std::chrono::nanoseconds getResampleLatency() const override;
+
+private:
+    struct Sample {
+        std::chrono::nanoseconds eventTime;
+        std::vector<PointerProperties> properties;
+        std::vector<PointerCoords> coords;
+    };
+
+    /**
+     * Keeps track of the previous MotionEvent deviceId, so that the samples of another device are
+     * not used for the fit.
+     */
+    std::optional<DeviceId> mPreviousDeviceId;
+
+    /**
+     * The latest samples from MotionEvent, across several calls to resampleMotionEvent. More
+     * samples reduce the noise of the fit, but make it slower to follow changes of direction.
+     */
+    RingBuffer<Sample> mLatestSamples{/*capacity=*/4};
+
+    void updateLatestSamples(const MotionEvent& motionEvent);
+
+    /**
+     * Returns the number of latest samples that can be fit together. These samples have the same
+     * pointers as the latest sample, and are spaced far enough apart in time and not too far apart.
+     */
+    size_t countFittableSamples() const;
+
+    std::optional<Sample> attemptInterpolation(std::chrono::nanoseconds resampleTime,
+                                               const InputMessage& futureSample) const;
+
+    std::optional<Sample> attemptExtrapolation(std::chrono::nanoseconds resampleTime) const;
+};
 } // namespace android
@@ -233,6 +233,61 @@ private:
     const Weighting mWeighting;
 };
 
+/*
+ * Velocity tracker algorithm that produces the same fit as a LeastSquaresVelocityTrackerStrategy of
+ * degree 2 without weights, but that maintains the sums needed by the fit as movements are added
+ * and evicted, instead of computing them over all of the movements whenever the velocity is
+ * requested. Getting the velocity takes constant time.
+ */
+class IncrementalLeastSquaresVelocityTrackerStrategy : public VelocityTrackerStrategy {
+public:
+    IncrementalLeastSquaresVelocityTrackerStrategy();
+    ~IncrementalLeastSquaresVelocityTrackerStrategy() override;
+
+    void clearPointer(int32_t pointerId) override;
+    void addMovement(nsecs_t eventTime, int32_t pointerId, float position) override;
+    std::optional<float> getVelocity(int32_t pointerId) const override;
+
+private:
+    // Same history and horizon as LeastSquaresVelocityTrackerStrategy.
+    static constexpr uint32_t HISTORY_SIZE = 20;
+    static const nsecs_t HORIZON = 100 * 1000000; // 100 ms
+
+    struct Movement {
+        nsecs_t eventTime;
+        float position;
+    };
+
+    /**
+     * Sums over the movements of a pointer, where "x" is the time of a movement in seconds
+     * relative to the origin of the pointer, and "y" is its position.
+     */
+    struct Sums {
+        double sx = 0;
+        double sx2 = 0;
+        double sx3 = 0;
+        double sx4 = 0;
+        double sy = 0;
+        double sxy = 0;
+        double sx2y = 0;
+    };
+
+    struct PointerState {
+        RingBuffer<Movement> movements{HISTORY_SIZE};
+        // Kept close to the movements, so that the powers of x remain small enough for the sums
+        // to stay precise.
+        nsecs_t originTime = 0;
+        Sums sums;
+    };
+
+    static void accumulate(PointerState& state, const Movement& movement, double sign);
+    // Moves the origin to the latest movement and computes the sums again. This also discards
+    // the rounding errors collected by removing movements from the sums.
+    static void rebase(PointerState& state);
+
+    std::map<int32_t /*pointerId*/, PointerState> mPointerStates;
+};
+
 /*
  * Velocity tracker algorithm that uses an IIR filter.
  */
@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *            http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <aidl/android/hardware/common/fmq/SynchronizedReadWrite.h>
+#include <aidl/android/hardware/power/ChannelConfig.h>
+#include <aidl/android/hardware/power/ChannelMessage.h>
+#include <aidl/android/hardware/power/SessionHint.h>
+#include <aidl/android/hardware/power/WorkDuration.h>
+#include <fmq/AidlMessageQueue.h>
+#include <fmq/EventFlag.h>
+
+#include <atomic>
+#include <memory>
+
+namespace android::power {
+
+// Writes hint session messages to the FMQ channel that the Power HAL shares
+// with a process, as returned by IPower::getSessionChannel, instead of making
+// a binder call per message.
+//
+// The channel is shared by all sessions of the process, and any thread may
+// write to it. Writes never block: a write that finds another write in
+// progress, or not enough space in the queue, returns false without writing
+// anything, and the caller falls back to the binder call.
+class PowerHintSessionChannel {
+public:
+    // Returns nullptr if the channel config is not usable.
+    static std::unique_ptr<PowerHintSessionChannel> create(
+            aidl::android::hardware::power::ChannelConfig&& config);
+    virtual ~PowerHintSessionChannel();
+
+    // Writes one message per duration in a single queue transaction, and wakes
+    // the reader once.
+    virtual bool reportActualWorkDuration(
+            int32_t sessionId, const aidl::android::hardware::power::WorkDuration* durations,
+            size_t count);
+    virtual bool updateTargetWorkDuration(int32_t sessionId, int64_t targetDurationNanos);
+    virtual bool sendHint(int32_t sessionId, aidl::android::hardware::power::SessionHint hint);
+
+protected:
+    PowerHintSessionChannel() = default;
+
+private:
+    using MsgQueue =
+            AidlMessageQueue<aidl::android::hardware::power::ChannelMessage,
+                             aidl::android::hardware::common::fmq::SynchronizedReadWrite>;
+    using FlagQueue =
+            AidlMessageQueue<int8_t, aidl::android::hardware::common::fmq::SynchronizedReadWrite>;
+
+    template <aidl::android::hardware::power::ChannelMessage::ChannelMessageContents::Tag T,
+              class In>
+    bool write(int32_t sessionId, const In* contents, size_t count);
+
+    std::unique_ptr<MsgQueue> mMsgQueue;
+    std::unique_ptr<FlagQueue> mFlagQueue;
+    hardware::EventFlag* mEventFlag = nullptr;
+    uint32_t mWriteMask = 0;
+    // Set while a thread writes to the queue, which only supports one writer
+    // at a time.
+    std::atomic_flag mWriting = ATOMIC_FLAG_INIT;
+};
+
+} // namespace android::power
@@ -24,6 +24,7 @@
 #include <aidl/android/hardware/power/SessionConfig.h>
 #include <android-base/thread_annotations.h>
 #include "HalResult.h"
+#include "PowerHintSessionChannel.h"
 
 namespace android::power {
 
@@ -46,9 +47,16 @@ public:
                                     bool in_enabled);
     virtual HalResult<aidl::android::hardware::power::SessionConfig> getSessionConfig();
 
+    // Sends work durations, targets and hints through the FMQ channel of the
+    // process first, with the binder calls as the fallback when the channel is
+    // busy or full. Must be called before the session is used concurrently.
+    virtual void setChannel(std::shared_ptr<PowerHintSessionChannel> channel, int32_t sessionId);
+
 private:
     std::shared_ptr<aidl::android::hardware::power::IPowerHintSession> mSession;
     int32_t mInterfaceVersion;
+    std::shared_ptr<PowerHintSessionChannel> mChannel;
+    int32_t mSessionId = 0;
 };
 
 } // namespace android::power
\ No newline at end of file
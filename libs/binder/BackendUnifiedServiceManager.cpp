@@ -118,7 +118,23 @@ binder::Status BackendUnifiedServiceManager::updateCache(const std::string& serv
         sp<IBinder> binder = service.get<os::Service::Tag::binder>();
         if (binder && mCacheForGetService->isClientSideCachingEnabled(serviceName) &&
             binder->isBinderAlive()) {
-            return mCacheForGetService->setItem(serviceName, binder);
+            binder::Status status = mCacheForGetService->setItem(serviceName, binder);
+            if (!status.isOk()) {
+                return status;
+            }
+            // Ask servicemanager to tell us when the name is re-registered, so
+            // that the entry doesn't outlive the registration it came from.
+            // Best effort: the death notification still evicts it otherwise.
+            if (sp<os::IServiceCallback> callback =
+                        mCacheForGetService->takeRegistrationCallback(serviceName)) {
+                binder::Status registered =
+                        mTheRealServiceManager->registerForNotifications(serviceName, callback);
+                if (!registered.isOk()) {
+                    ALOGV("Cannot watch re-registration of %s: %s", serviceName.c_str(),
+                          registered.toString8().c_str());
+                }
+            }
+            return status;
         }
     }
     return binder::Status::ok();
@@ -189,6 +205,33 @@ binder::Status BackendUnifiedServiceManager::checkService(const ::std::string& n
     return status;
 }
 
+binder::Status BackendUnifiedServiceManager::checkServices(
+        const ::std::vector<::std::string>& names,
+        ::std::vector<os::ServiceLookupResult>* _aidl_return) {
+    // Declared status isn't cached, so every name goes to servicemanager, but
+    // all of them share one transaction.
+    binder::Status status = mTheRealServiceManager->checkServices(names, _aidl_return);
+    if (!status.isOk()) {
+        return status;
+    }
+    if (_aidl_return->size() != names.size()) {
+        return binder::Status::fromStatusT(BAD_VALUE);
+    }
+    for (size_t i = 0; i < names.size(); i++) {
+        os::Service service = std::move((*_aidl_return)[i].service);
+        status = toBinderService(names[i], service, &(*_aidl_return)[i].service);
+        if (!status.isOk()) {
+            // One unreachable service shouldn't fail the lookups of the others.
+            ALOGW("checkServices: failed to get %s: %s", names[i].c_str(),
+                  status.toString8().c_str());
+            (*_aidl_return)[i].service = os::Service::make<os::Service::Tag::binder>(nullptr);
+            continue;
+        }
+        updateCache(names[i], service);
+    }
+    return binder::Status::ok();
+}
+
 binder::Status BackendUnifiedServiceManager::toBinderService(const ::std::string& name,
                                                              const os::Service& in,
                                                              os::Service* _out) {
@@ -15,11 +15,15 @@
  */
 #pragma once
 
+#include <android/os/BnServiceCallback.h>
 #include <android/os/BnServiceManager.h>
 #include <android/os/IServiceManager.h>
 #include <binder/IPCThreadState.h>
+#include <atomic>
 #include <map>
 #include <memory>
+#include <set>
+#include <vector>
 
 namespace android {
 
@@ -43,36 +47,80 @@ class BinderCacheWithInvalidation
         std::weak_ptr<BinderCacheWithInvalidation> mCache;
         std::string mKey;
     };
+    // Registered with servicemanager for every cached name, so that a service
+    // re-registering under that name evicts the stale binder right away
+    // instead of only once the old one dies.
+    class RegistrationInvalidation : public os::BnServiceCallback {
+    public:
+        explicit RegistrationInvalidation(std::weak_ptr<BinderCacheWithInvalidation> cache)
+              : mCache(cache) {}
+
+        binder::Status onRegistration(const std::string& name,
+                                      const sp<IBinder>& binder) override {
+            if (std::shared_ptr<BinderCacheWithInvalidation> cache = mCache.lock()) {
+                cache->removeItemUnless(name, binder);
+            }
+            return binder::Status::ok();
+        }
+
+    private:
+        std::weak_ptr<BinderCacheWithInvalidation> mCache;
+    };
     struct Entry {
         sp<IBinder> service;
         sp<BinderInvalidation> deathRecipient;
     };
+    // Entries are never modified in place. Writers publish a modified copy
+    // and retire the old one, so readers need no lock.
+    using Snapshot = std::map<std::string, Entry>;
 
 public:
-    sp<IBinder> getItem(const std::string& key) const {
-        std::lock_guard<std::mutex> lock(mCacheMutex);
+    BinderCacheWithInvalidation() : mSnapshot(new Snapshot()) {}
+    ~BinderCacheWithInvalidation() { delete mSnapshot.load(); }
 
-        if (auto it = mCache.find(key); it != mCache.end()) {
-            return it->second.service;
+    sp<IBinder> getItem(const std::string& key) const {
+        // Announce the read before loading the snapshot, see publishLocked.
+        mActiveReaders.fetch_add(1);
+        const Snapshot* snapshot = mSnapshot.load();
+        sp<IBinder> service;
+        if (auto it = snapshot->find(key); it != snapshot->end()) {
+            service = it->second.service;
         }
-        return nullptr;
+        mActiveReaders.fetch_sub(1);
+        return service;
     }
 
     bool removeItem(const std::string& key, const sp<IBinder>& who) {
         std::lock_guard<std::mutex> lock(mCacheMutex);
-        if (auto it = mCache.find(key); it != mCache.end()) {
+        const Snapshot* snapshot = mSnapshot.load();
+        if (auto it = snapshot->find(key); it != snapshot->end()) {
             if (it->second.service == who) {
                 status_t result = who->unlinkToDeath(it->second.deathRecipient);
                 if (result != DEAD_OBJECT) {
                     ALOGW("Unlinking to dead binder resulted in: %d", result);
                 }
-                mCache.erase(key);
+                auto next = std::make_unique<Snapshot>(*snapshot);
+                next->erase(key);
+                publishLocked(std::move(next));
                 return true;
             }
         }
         return false;
     }
 
+    // Evicts key unless it is cached as who, which servicemanager now returns
+    // for it.
+    void removeItemUnless(const std::string& key, const sp<IBinder>& who) {
+        std::lock_guard<std::mutex> lock(mCacheMutex);
+        const Snapshot* snapshot = mSnapshot.load();
+        if (auto it = snapshot->find(key); it != snapshot->end() && it->second.service != who) {
+            it->second.service->unlinkToDeath(it->second.deathRecipient);
+            auto next = std::make_unique<Snapshot>(*snapshot);
+            next->erase(key);
+            publishLocked(std::move(next));
+        }
+    }
+
     binder::Status setItem(const std::string& key, const sp<IBinder>& item) {
         sp<BinderInvalidation> deathRecipient =
                 sp<BinderInvalidation>::make(shared_from_this(), key);
@@ -88,15 +136,47 @@ public:
         }
         std::lock_guard<std::mutex> lock(mCacheMutex);
         Entry entry = {.service = item, .deathRecipient = deathRecipient};
-        mCache[key] = entry;
+        auto next = std::make_unique<Snapshot>(*mSnapshot.load());
+        (*next)[key] = entry;
+        publishLocked(std::move(next));
         return binder::Status::ok();
     }
 
+    // Returns a callback to register with servicemanager for key, or null if
+    // one was already handed out for it.
+    sp<os::IServiceCallback> takeRegistrationCallback(const std::string& key) {
+        std::lock_guard<std::mutex> lock(mCacheMutex);
+        if (!mRegisteredKeys.insert(key).second) {
+            return nullptr;
+        }
+        if (mRegistrationCallback == nullptr) {
+            mRegistrationCallback = sp<RegistrationInvalidation>::make(weak_from_this());
+        }
+        return mRegistrationCallback;
+    }
+
     bool isClientSideCachingEnabled(const std::string& serviceName);
 
 private:
-    std::map<std::string, Entry> mCache;
-    mutable std::mutex mCacheMutex;
+    // Replaces the current snapshot with next. The old one is freed once no
+    // reader can still be using it: a reader that has not yet announced
+    // itself in mActiveReaders is guaranteed to load next, so when the count
+    // reads zero after the store every retired snapshot is unreachable.
+    void publishLocked(std::unique_ptr<Snapshot> next) {
+        mRetired.emplace_back(mSnapshot.exchange(next.release()));
+        if (mActiveReaders.load() == 0) {
+            mRetired.clear();
+        }
+    }
+
+    std::atomic<const Snapshot*> mSnapshot;
+    mutable std::atomic<uint32_t> mActiveReaders = 0;
+
+    // Guards writers, mRetired and the registration state.
+    std::mutex mCacheMutex;
+    std::vector<std::unique_ptr<const Snapshot>> mRetired;
+    std::set<std::string> mRegisteredKeys;
+    sp<RegistrationInvalidation> mRegistrationCallback;
 };
 
 class BackendUnifiedServiceManager : public android::os::BnServiceManager {
@@ -107,6 +187,8 @@ public:
     binder::Status getService(const ::std::string& name, sp<IBinder>* _aidl_return) override;
     binder::Status getService2(const ::std::string& name, os::Service* out) override;
     binder::Status checkService(const ::std::string& name, os::Service* out) override;
+    binder::Status checkServices(const ::std::vector<::std::string>& names,
+                                 ::std::vector<os::ServiceLookupResult>* _aidl_return) override;
     binder::Status addService(const ::std::string& name, const sp<IBinder>& service,
                               bool allowIsolated, int32_t dumpPriority) override;
     binder::Status listServices(int32_t dumpPriority,
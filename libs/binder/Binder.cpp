@@ -17,6 +17,7 @@
 #include <binder/Binder.h>
 
 #include <atomic>
+#include <chrono>
 #include <set>
 
 #include <binder/BpBinder.h>
@@ -27,6 +28,7 @@
 #include <binder/Parcel.h>
 #include <binder/RecordedTransaction.h>
 #include <binder/RpcServer.h>
+#include <binder/TransactionStats.h>
 #include <binder/unique_fd.h>
 #include <pthread.h>
 
@@ -46,6 +48,8 @@ namespace android {
 using android::binder::unique_fd;
 
 constexpr uid_t kUidRoot = 0;
+constexpr uid_t kUidSystem = 1000;
+constexpr uid_t kUidShell = 2000;
 
 // Service implementations inherit from BBinder and IBinder, and this is frozen
 // in prebuilts.
@@ -290,7 +294,9 @@ public:
     std::set<sp<RpcServerLink>> mRpcServerLinks;
     BpBinder::ObjectManager mObjects;
 
-    unique_fd mRecordingFd;
+    // Not a unique_ptr, so that builds without kernel binder, which leave out
+    // RecordedTransaction.cpp, do not need the destructor.
+    std::shared_ptr<binder::debug::TransactionRecorder> mRecorder;
 };
 
 // ---------------------------------------------------------------------------
@@ -327,16 +333,29 @@ status_t BBinder::startRecordingTransactions(const Parcel& data) {
         ALOGI("Could not start Binder recording. Another is already in progress.");
         return INVALID_OPERATION;
     } else {
-        status_t readStatus = data.readUniqueFileDescriptor(&(e->mRecordingFd));
+        unique_fd fd;
+        status_t readStatus = data.readUniqueFileDescriptor(&fd);
         if (readStatus != OK) {
             return readStatus;
         }
+        e->mRecorder = std::make_shared<binder::debug::TransactionRecorder>(std::move(fd));
         mRecordingOn = true;
         ALOGI("Started Binder recording.");
         return NO_ERROR;
     }
 }
 
+static status_t handleTransactionStats(const Parcel& data, Parcel* reply) {
+    if (kEnableKernelIpc) {
+        uid_t uid = IPCThreadState::self()->getCallingUid();
+        if (uid != kUidRoot && uid != kUidSystem && uid != kUidShell) {
+            ALOGE("Binder transaction stats not allowed for client %" PRIu32, uid);
+            return PERMISSION_DENIED;
+        }
+    }
+    return binder::debug::TransactionStats::handleTransaction(data, reply);
+}
+
 status_t BBinder::stopRecordingTransactions() {
     if (!kEnableRecording) {
         ALOGW("Binder recording disallowed because recording is not enabled");
@@ -352,16 +371,25 @@ status_t BBinder::stopRecordingTransactions() {
         return PERMISSION_DENIED;
     }
     Extras* e = getOrCreateExtras();
-    RpcMutexUniqueLock lock(e->mLock);
-    if (mRecordingOn) {
-        e->mRecordingFd.reset();
+    std::shared_ptr<binder::debug::TransactionRecorder> recorder;
+    {
+        RpcMutexUniqueLock lock(e->mLock);
+        if (!mRecordingOn) {
+            ALOGI("Could not stop Binder recording. One is not in progress.");
+            return INVALID_OPERATION;
+        }
+        recorder = std::move(e->mRecorder);
         mRecordingOn = false;
-        ALOGI("Stopped Binder recording.");
-        return NO_ERROR;
-    } else {
-        ALOGI("Could not stop Binder recording. One is not in progress.");
-        return INVALID_OPERATION;
     }
+    // Transactions are not blocked while the recording is written out.
+    if (status_t err = recorder->finish(); err != NO_ERROR) {
+        ALOGI("Failed to finish Binder recording with error %d", err);
+    }
+    if (size_t dropped = recorder->getDroppedCount(); dropped > 0) {
+        ALOGI("Binder recording dropped %zu transactions", dropped);
+    }
+    ALOGI("Stopped Binder recording.");
+    return NO_ERROR;
 }
 
 const String16& BBinder::getInterfaceDescriptor() const
@@ -381,11 +409,19 @@ status_t BBinder::transact(
         reply->markSensitive();
     }
 
+    using binder::debug::TransactionStats;
+    const bool recordStats = TransactionStats::isEnabled();
+    const auto startTime =
+            recordStats ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+
     status_t err = NO_ERROR;
     switch (code) {
         case PING_TRANSACTION:
             err = pingBinder();
             break;
+        case TRANSACTION_STATS_TRANSACTION:
+            err = handleTransactionStats(data, reply);
+            break;
         case START_RECORDING_TRANSACTION:
             err = startRecordingTransactions(data);
             break;
@@ -418,6 +454,11 @@ status_t BBinder::transact(
         }
     }
 
+    if (recordStats) [[unlikely]] {
+        TransactionStats::record(TransactionStats::Direction::INCOMING, code, data, reply,
+                                 std::chrono::steady_clock::now() - startTime);
+    }
+
     if (kEnableKernelIpc && mRecordingOn && code != START_RECORDING_TRANSACTION) [[unlikely]] {
         Extras* e = mExtras.load(std::memory_order_acquire);
         RpcMutexUniqueLock lock(e->mLock);
@@ -425,16 +466,9 @@ status_t BBinder::transact(
             Parcel emptyReply;
             timespec ts;
             timespec_get(&ts, TIME_UTC);
-            auto transaction = android::binder::debug::RecordedTransaction::
-                    fromDetails(getInterfaceDescriptor(), code, flags, ts, data,
-                                reply ? *reply : emptyReply, err);
-            if (transaction) {
-                if (status_t err = transaction->dumpToFile(e->mRecordingFd); err != NO_ERROR) {
-                    ALOGI("Failed to dump RecordedTransaction to file with error %d", err);
-                }
-            } else {
-                ALOGI("Failed to create RecordedTransaction object.");
-            }
+            // Only copies the transaction; it is written by the recorder's thread.
+            e->mRecorder->record(getInterfaceDescriptor(), code, flags, ts, data,
+                                 reply ? *reply : emptyReply, err);
         }
     }
 
@@ -24,8 +24,10 @@
 #include <binder/RpcSession.h>
 #include <binder/Stability.h>
 #include <binder/Trace.h>
+#include <binder/TransactionStats.h>
 
 #include <stdio.h>
+#include <chrono>
 
 #include "BuildFlags.h"
 #include "file.h"
@@ -394,6 +396,11 @@ status_t BpBinder::transact(
             }
         }
 
+        using binder::debug::TransactionStats;
+        const bool recordStats = TransactionStats::isEnabled();
+        const auto startTime = recordStats ? std::chrono::steady_clock::now()
+                                           : std::chrono::steady_clock::time_point();
+
         status_t status;
         if (isRpcBinder()) [[unlikely]] {
             status = rpcSession()->transact(sp<IBinder>::fromExisting(this), code, data, reply,
@@ -406,6 +413,10 @@ status_t BpBinder::transact(
 
             status = IPCThreadState::self()->transact(binderHandle(), code, data, reply, flags);
         }
+        if (recordStats) [[unlikely]] {
+            TransactionStats::record(TransactionStats::Direction::OUTGOING, code, data, reply,
+                                     std::chrono::steady_clock::now() - startTime);
+        }
         if (data.dataSize() > LOG_TRANSACTIONS_OVER_SIZE) {
             RpcMutexUniqueLock _l(mLock);
             ALOGW("Large outgoing transaction of %zu bytes, interface descriptor %s, code %d",
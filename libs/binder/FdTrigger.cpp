@@ -20,6 +20,9 @@
 #include "FdTrigger.h"
 
 #include <poll.h>
+#if defined(__linux__) && !defined(BINDER_RPC_SINGLE_THREADED)
+#include <sys/eventfd.h>
+#endif
 
 #include <binder/Functional.h>
 
@@ -34,24 +37,37 @@ using namespace android::binder::impl;
 std::unique_ptr<FdTrigger> FdTrigger::make() {
     auto ret = std::make_unique<FdTrigger>();
 #ifndef BINDER_RPC_SINGLE_THREADED
+#ifdef __linux__
+    ret->mEvent.reset(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK));
+    if (!ret->mEvent.ok()) {
+        ALOGE("Could not create eventfd %s", strerror(errno));
+        return nullptr;
+    }
+#else
     if (!binder::Pipe(&ret->mRead, &ret->mWrite)) {
         ALOGE("Could not create pipe %s", strerror(errno));
         return nullptr;
     }
+#endif
 #endif
     return ret;
 }
 
 void FdTrigger::trigger() {
-#ifdef BINDER_RPC_SINGLE_THREADED
+#if defined(BINDER_RPC_SINGLE_THREADED)
     mTriggered = true;
+#elif defined(__linux__)
+    if (mTriggered.exchange(true)) return;
+    if (eventfd_write(mEvent.get(), 1) != 0) {
+        ALOGE("Could not signal eventfd %s", strerror(errno));
+    }
 #else
     mWrite.reset();
 #endif
 }
 
 bool FdTrigger::isTriggered() {
-#ifdef BINDER_RPC_SINGLE_THREADED
+#if defined(BINDER_RPC_SINGLE_THREADED) || defined(__linux__)
     return mTriggered;
 #else
     return !mWrite.ok();
@@ -70,7 +86,11 @@ status_t FdTrigger::triggerablePoll(const android::RpcTransportFd& transportFd,
     pollfd pfd[]{
             {.fd = transportFd.fd.get(), .events = static_cast<int16_t>(event), .revents = 0},
 #ifndef BINDER_RPC_SINGLE_THREADED
+#ifdef __linux__
+            {.fd = mEvent.get(), .events = POLLIN, .revents = 0},
+#else
             {.fd = mRead.get(), .events = 0, .revents = 0},
+#endif
 #endif
     };
 
@@ -92,9 +112,15 @@ status_t FdTrigger::triggerablePoll(const android::RpcTransportFd& transportFd,
 
 #ifndef BINDER_RPC_SINGLE_THREADED
     // Detect explicit trigger(): DEAD_OBJECT
+#ifdef __linux__
+    if (pfd[1].revents & POLLIN) {
+        return DEAD_OBJECT;
+    }
+#else
     if (pfd[1].revents & POLLHUP) {
         return DEAD_OBJECT;
     }
+#endif
     // See unknown flags in trigger FD's revents (POLLERR / POLLNVAL).
     // Treat this error condition as UNKNOWN_ERROR.
     if (pfd[1].revents != 0) {
@@ -15,6 +15,7 @@
  */
 #pragma once
 
+#include <atomic>
 #include <memory>
 
 #include <utils/Errors.h>
@@ -31,8 +32,8 @@ public:
     static std::unique_ptr<FdTrigger> make();
 
     /**
-     * Close the write end of the pipe so that the read end receives POLLHUP.
-     * Not threadsafe.
+     * Close the write end of the pipe so that the read end receives POLLHUP
+     * (or signal the eventfd on Linux). Not threadsafe.
      */
     void trigger();
 
@@ -60,6 +61,12 @@ public:
 private:
 #ifdef BINDER_RPC_SINGLE_THREADED
     bool mTriggered = false;
+#elif defined(__linux__)
+    // Every session and server owns a trigger, so on Linux a single eventfd is
+    // used instead of a pipe to halve the number of fds held per session. Once
+    // triggered, it stays readable.
+    binder::unique_fd mEvent;
+    std::atomic<bool> mTriggered = false;
 #else
     binder::unique_fd mWrite;
     binder::unique_fd mRead;
@@ -24,9 +24,12 @@
 
 #include <utils/CallStack.h>
 
+#include <algorithm>
 #include <atomic>
 #include <errno.h>
 #include <inttypes.h>
+#include <limits>
+#include <poll.h>
 #include <pthread.h>
 #include <sched.h>
 #include <signal.h>
@@ -65,6 +68,12 @@ namespace android {
 
 using namespace std::chrono_literals;
 
+static void updateMax(std::atomic_size_t& max, size_t value) {
+    size_t current = max.load(std::memory_order_relaxed);
+    while (value > current && !max.compare_exchange_weak(current, value)) {
+    }
+}
+
 // Static const and functions will be optimized out if not used,
 // when LOG_NDEBUG and references in IF_LOG_COMMANDS() are optimized out.
 static const char* kReturnStrings[] = {
@@ -640,7 +649,8 @@ void IPCThreadState::flushCommands()
 
 bool IPCThreadState::flushIfNeeded()
 {
-    if (mIsLooper || mServingStackPointer != nullptr || mIsFlushing) {
+    if (mIsLooper || mServingStackPointer != nullptr || mIsFlushing ||
+        mTransactionBatchDepth > 0) {
         return false;
     }
     mIsFlushing = true;
@@ -653,6 +663,82 @@ bool IPCThreadState::flushIfNeeded()
     return true;
 }
 
+void IPCThreadState::beginTransactionBatch() {
+    mTransactionBatchDepth++;
+}
+
+status_t IPCThreadState::endTransactionBatch() {
+    LOG_ALWAYS_FATAL_IF(mTransactionBatchDepth == 0,
+                        "endTransactionBatch() without matching beginTransactionBatch()");
+    if (--mTransactionBatchDepth > 0) {
+        return NO_ERROR;
+    }
+    status_t err = submitTransactionBatch();
+    // Refcount commands queued during the batch still need to be written even
+    // if no transaction was batched.
+    flushIfNeeded();
+    return err;
+}
+
+status_t IPCThreadState::queueBatchedTransaction(int32_t handle, uint32_t code,
+                                                 const Parcel& data, uint32_t flags) {
+    // The driver only reads the payload when the batch is submitted, so keep
+    // a copy which outlives the caller's Parcel.
+    const uint8_t* begin = reinterpret_cast<const uint8_t*>(data.ipcData());
+    std::vector<uint8_t>& payload =
+            mBatchedTransactionData.emplace_back(begin, begin + data.ipcDataSize());
+
+    binder_transaction_data tr;
+    tr.target.ptr = 0; /* Don't pass uninitialized stack data to a remote process */
+    tr.target.handle = handle;
+    tr.code = code;
+    tr.flags = flags;
+    tr.cookie = 0;
+    tr.sender_pid = 0;
+    tr.sender_euid = 0;
+    tr.data_size = payload.size();
+    tr.data.ptr.buffer = reinterpret_cast<uintptr_t>(payload.data());
+    tr.offsets_size = 0;
+    tr.data.ptr.offsets = 0;
+
+    mOut.writeInt32(BC_TRANSACTION);
+    mOut.write(&tr, sizeof(tr));
+
+    // Bound how much is copied before the driver sees any of it.
+    constexpr size_t kMaxBatchedTransactions = 64;
+    constexpr size_t kMaxBatchedTransactionBytes = 64 * 1024;
+    mBatchedTransactionBytes += payload.size();
+    if (mBatchedTransactionData.size() >= kMaxBatchedTransactions ||
+        mBatchedTransactionBytes >= kMaxBatchedTransactionBytes) {
+        return submitTransactionBatch();
+    }
+    return NO_ERROR;
+}
+
+status_t IPCThreadState::submitTransactionBatch() {
+    status_t err = mTransactionBatchError;
+    mTransactionBatchError = NO_ERROR;
+    // Each batched transaction ends with exactly one BR_TRANSACTION_COMPLETE
+    // or error return. If the driver fails one of them, it stops consuming
+    // the out buffer there and the remainder is written by the next read.
+    for (size_t i = 0; i < mBatchedTransactionData.size(); i++) {
+        status_t transactionErr = waitForResponse(nullptr, nullptr);
+        if (err == NO_ERROR) err = transactionErr;
+        if (transactionErr != NO_ERROR && transactionErr != DEAD_OBJECT &&
+            transactionErr != FAILED_TRANSACTION) {
+            // The driver could not be talked to at all. What is left in mOut
+            // may point into the payloads freed below, so it can't be kept.
+            ALOGE("Dropping %zu batched transactions after error %s",
+                  mBatchedTransactionData.size() - i, statusToString(transactionErr).c_str());
+            mOut.setDataSize(0);
+            break;
+        }
+    }
+    mBatchedTransactionData.clear();
+    mBatchedTransactionBytes = 0;
+    return err;
+}
+
 void IPCThreadState::blockUntilThreadAvailable()
 {
     std::unique_lock lock_guard_(mProcess->mOnThreadAvailableLock);
@@ -693,6 +779,10 @@ status_t IPCThreadState::getAndExecuteCommand()
             mProcess->mStarvationStartTime
                     .compare_exchange_strong(expected, std::chrono::steady_clock::now());
         }
+        updateMax(mProcess->mMaxExecutingThreads, newThreadsCount);
+        if (newThreadsCount >= mProcess->mCurrentThreads) {
+            mProcess->spawnPooledThreadAheadOfDemand();
+        }
 
         result = executeCommand(cmd);
 
@@ -772,16 +862,33 @@ void IPCThreadState::processPostWriteDerefs()
 }
 
 void IPCThreadState::joinThreadPool(bool isMain)
+{
+    joinThreadPoolImpl(isMain, !isMain /*registerLooper*/, false /*exitWhenIdle*/);
+}
+
+void IPCThreadState::joinPooledThread(bool kernelRequested)
+{
+    // Threads the kernel did not ask for must not register with it.
+    joinThreadPoolImpl(false /*isMain*/, kernelRequested, true /*exitWhenIdle*/);
+}
+
+void IPCThreadState::joinThreadPoolImpl(bool isMain, bool registerLooper, bool exitWhenIdle)
 {
     LOG_THREADPOOL("**** THREAD %p (PID %d) IS JOINING THE THREAD POOL\n", (void*)pthread_self(),
                    getpid());
-    mProcess->mCurrentThreads++;
-    mOut.writeInt32(isMain ? BC_ENTER_LOOPER : BC_REGISTER_LOOPER);
+    updateMax(mProcess->mMaxCurrentThreads, mProcess->mCurrentThreads.fetch_add(1) + 1);
+    mOut.writeInt32(registerLooper ? BC_REGISTER_LOOPER : BC_ENTER_LOOPER);
 
     mIsLooper = true;
+    bool retired = false;
     status_t result;
     do {
         processPendingDerefs();
+        if (exitWhenIdle && waitForCommandOrRetire()) {
+            retired = true;
+            result = TIMED_OUT;
+            break;
+        }
         // now get the next command to be processed, waiting if necessary
         result = getAndExecuteCommand();
 
@@ -803,11 +910,39 @@ void IPCThreadState::joinThreadPool(bool isMain)
     mOut.writeInt32(BC_EXIT_LOOPER);
     mIsLooper = false;
     talkWithDriver(false);
-    size_t oldCount = mProcess->mCurrentThreads.fetch_sub(1);
-    LOG_ALWAYS_FATAL_IF(oldCount == 0,
-                        "Threadpool thread count underflowed. Thread cannot exist and exit in "
-                        "empty threadpool\n"
-                        "Misconfiguration. Increase threadpool max threads configuration\n");
+    if (!retired) {
+        size_t oldCount = mProcess->mCurrentThreads.fetch_sub(1);
+        LOG_ALWAYS_FATAL_IF(oldCount == 0,
+                            "Threadpool thread count underflowed. Thread cannot exist and exit in "
+                            "empty threadpool\n"
+                            "Misconfiguration. Increase threadpool max threads configuration\n");
+    }
+    if (exitWhenIdle) {
+        mProcess->mPooledThreads--;
+        mProcess->mExitedThreads++;
+    }
+}
+
+bool IPCThreadState::waitForCommandOrRetire()
+{
+    const std::chrono::milliseconds timeout = mProcess->mThreadPoolIdleTimeout;
+    if (timeout == 0ms || mIn.dataPosition() < mIn.dataSize() ||
+        mProcess->mCurrentThreads <= mProcess->mThreadPoolMinThreads) {
+        return false;
+    }
+
+    // Send BC_FREE_BUFFER and the like now rather than holding on to them
+    // while idle. This also registers the looper before the first poll.
+    if (mOut.dataSize() > 0 && talkWithDriver(false) < NO_ERROR) return false;
+
+    // This makes the driver treat the thread as a polling thread, which it
+    // wakes up along with the others when no thread is blocked reading. Any
+    // failure is left for the read in getAndExecuteCommand to report.
+    pollfd pfd = {.fd = mProcess->mDriverFD, .events = POLLIN};
+    const int64_t timeoutMs = std::min<int64_t>(timeout.count(), std::numeric_limits<int>::max());
+    if (TEMP_FAILURE_RETRY(poll(&pfd, 1, static_cast<int>(timeoutMs))) != 0) return false;
+
+    return mProcess->retireIdleThread();
 }
 
 status_t IPCThreadState::setupPolling(int* fd)
@@ -866,6 +1001,21 @@ status_t IPCThreadState::transact(int32_t handle,
 
     LOG_ONEWAY(">>>> SEND from pid %d uid %d %s", getpid(), getuid(),
         (flags & TF_ONE_WAY) == 0 ? "READ REPLY" : "ONE WAY");
+
+    if (mTransactionBatchDepth > 0) {
+        if ((flags & TF_ONE_WAY) != 0 && data.ipcObjectsCount() == 0 &&
+            data.errorCheck() == NO_ERROR) {
+            err = queueBatchedTransaction(handle, code, data, flags);
+            if (err != NO_ERROR) mTransactionBatchError = err;
+            return NO_ERROR;
+        }
+        // Everything queued so far must reach the driver before this
+        // transaction does.
+        if (status_t batchErr = submitTransactionBatch(); batchErr != NO_ERROR) {
+            mTransactionBatchError = batchErr;
+        }
+    }
+
     err = writeTransactionData(BC_TRANSACTION, flags, handle, code, data, nullptr);
 
     if (err != NO_ERROR) {
@@ -1030,7 +1180,10 @@ IPCThreadState::IPCThreadState()
         mIsFlushing(false),
         mStrictModePolicy(0),
         mLastTransactionBinderFlags(0),
-        mCallRestriction(mProcess->mCallRestriction) {
+        mCallRestriction(mProcess->mCallRestriction),
+        mTransactionBatchDepth(0),
+        mBatchedTransactionBytes(0),
+        mTransactionBatchError(NO_ERROR) {
     pthread_setspecific(gTLS, this);
     clearCaller();
     mHasExplicitIdentity = false;
@@ -111,6 +111,90 @@ static_assert(sizeof(Parcel) == 60);
 static std::atomic<size_t> gParcelGlobalAllocCount;
 static std::atomic<size_t> gParcelGlobalAllocSize;
 
+#ifndef BINDER_RPC_SINGLE_THREADED
+namespace {
+// Recently freed Parcel data buffers, kept per thread so that threads that
+// repeatedly build similar transactions don't need to malloc for each of them.
+// See Parcel::setThreadBufferCacheEnabled.
+class ParcelBufferCache {
+public:
+    ~ParcelBufferCache() {
+        // Parcels owned by other thread-local state may still be freed later.
+        mEnabled = false;
+        clear();
+    }
+
+    bool enabled() const { return mEnabled; }
+    void setEnabled(bool enabled) {
+        mEnabled = enabled;
+        if (!enabled) clear();
+    }
+
+    // Returns the smallest cached buffer of at least |desired| bytes, or nullptr.
+    uint8_t* take(size_t desired, size_t* outCapacity) {
+        size_t best = kMaxBuffers;
+        for (size_t i = 0; i < mCount; i++) {
+            if (mBuffers[i].capacity >= desired &&
+                (best == kMaxBuffers || mBuffers[i].capacity < mBuffers[best].capacity)) {
+                best = i;
+            }
+        }
+        if (best == kMaxBuffers) return nullptr;
+
+        uint8_t* data = mBuffers[best].data;
+        *outCapacity = mBuffers[best].capacity;
+        mBuffers[best] = mBuffers[--mCount];
+        return data;
+    }
+
+    // Takes ownership of |data| if it is worth keeping.
+    bool give(uint8_t* data, size_t capacity) {
+        if (!mEnabled || mCount == kMaxBuffers || capacity > kMaxBufferCapacity) return false;
+        mBuffers[mCount++] = {data, capacity};
+        return true;
+    }
+
+private:
+    static constexpr size_t kMaxBuffers = 4;
+    static constexpr size_t kMaxBufferCapacity = 16 * 1024;
+
+    void clear() {
+        for (size_t i = 0; i < mCount; i++) free(mBuffers[i].data);
+        mCount = 0;
+    }
+
+    struct Buffer {
+        uint8_t* data;
+        size_t capacity;
+    };
+    bool mEnabled = false;
+    size_t mCount = 0;
+    Buffer mBuffers[kMaxBuffers];
+};
+thread_local ParcelBufferCache tParcelBufferCache;
+} // namespace
+#endif // BINDER_RPC_SINGLE_THREADED
+
+// Allocates a new data buffer of at least |desired| bytes.
+static uint8_t* allocParcelData(size_t desired, size_t* outCapacity) {
+#ifndef BINDER_RPC_SINGLE_THREADED
+    if (tParcelBufferCache.enabled()) {
+        if (uint8_t* data = tParcelBufferCache.take(desired, outCapacity)) return data;
+    }
+#endif
+    *outCapacity = desired;
+    return static_cast<uint8_t*>(malloc(desired));
+}
+
+static void freeParcelData(uint8_t* data, size_t capacity) {
+#ifndef BINDER_RPC_SINGLE_THREADED
+    if (tParcelBufferCache.give(data, capacity)) return;
+#else
+    (void)capacity;
+#endif
+    free(data);
+}
+
 // Maximum number of file descriptors per Parcel.
 constexpr size_t kMaxFds = 1024;
 
@@ -409,6 +493,14 @@ size_t Parcel::getGlobalAllocCount() {
     return gParcelGlobalAllocCount.load();
 }
 
+void Parcel::setThreadBufferCacheEnabled(bool enabled) {
+#ifndef BINDER_RPC_SINGLE_THREADED
+    tParcelBufferCache.setEnabled(enabled);
+#else
+    (void)enabled;
+#endif
+}
+
 const uint8_t* Parcel::data() const
 {
     return mData;
@@ -1343,6 +1435,61 @@ status_t Parcel::readByteVector(std::unique_ptr<std::vector<uint8_t>>* val) cons
 status_t Parcel::readInt32Vector(std::optional<std::vector<int32_t>>* val) const { return readData(val); }
 status_t Parcel::readInt32Vector(std::unique_ptr<std::vector<int32_t>>* val) const { return readData(val); }
 status_t Parcel::readInt32Vector(std::vector<int32_t>* val) const { return readData(val); }
+
+#if __cplusplus >= 202002L
+template <typename T>
+status_t Parcel::readSpan(std::optional<std::span<const T>>* val) const {
+    static_assert(is_pointer_equivalent_array_v<T>);
+    int32_t size;
+    status_t status = readInt32(&size);
+    if (status != OK) return status;
+    if (size == kNullVectorSize) {
+        val->reset();
+        return OK;
+    }
+    if (size < 0) return UNEXPECTED_NULL;
+    if (static_cast<size_t>(size) > dataAvail()) return BAD_VALUE;
+    size_t dataLen;
+    if (__builtin_mul_overflow(size, sizeof(T), &dataLen)) {
+        return -EOVERFLOW;
+    }
+    auto data = reinterpret_cast<const T*>(readInplace(dataLen));
+    if (data == nullptr) return BAD_VALUE;
+    val->emplace(data, size);
+    return OK;
+}
+
+template <typename T>
+static status_t readNonNullSpan(const Parcel* parcel, std::span<const T>* val,
+                                status_t (Parcel::*read)(std::optional<std::span<const T>>*)
+                                        const) {
+    std::optional<std::span<const T>> span;
+    status_t status = (parcel->*read)(&span);
+    if (status != OK) return status;
+    if (!span) return UNEXPECTED_NULL;
+    *val = *span;
+    return OK;
+}
+
+status_t Parcel::readByteSpan(std::optional<std::span<const int8_t>>* val) const {
+    return readSpan(val);
+}
+status_t Parcel::readByteSpan(std::span<const int8_t>* val) const {
+    return readNonNullSpan<int8_t>(this, val, &Parcel::readByteSpan);
+}
+status_t Parcel::readByteSpan(std::optional<std::span<const uint8_t>>* val) const {
+    return readSpan(val);
+}
+status_t Parcel::readByteSpan(std::span<const uint8_t>* val) const {
+    return readNonNullSpan<uint8_t>(this, val, &Parcel::readByteSpan);
+}
+status_t Parcel::readInt32Span(std::optional<std::span<const int32_t>>* val) const {
+    return readSpan(val);
+}
+status_t Parcel::readInt32Span(std::span<const int32_t>* val) const {
+    return readNonNullSpan<int32_t>(this, val, &Parcel::readInt32Span);
+}
+#endif
 status_t Parcel::readInt64Vector(std::optional<std::vector<int64_t>>* val) const { return readData(val); }
 status_t Parcel::readInt64Vector(std::unique_ptr<std::vector<int64_t>>* val) const { return readData(val); }
 status_t Parcel::readInt64Vector(std::vector<int64_t>* val) const { return readData(val); }
@@ -2323,6 +2470,34 @@ status_t Parcel::readString16(String16* pArg) const
     }
 }
 
+status_t Parcel::readString16View(std::u16string_view* val) const {
+    size_t len;
+    const char16_t* str = readString16Inplace(&len);
+    if (str == nullptr) {
+        *val = std::u16string_view();
+        return UNEXPECTED_NULL;
+    }
+    *val = std::u16string_view(str, len);
+    return OK;
+}
+
+status_t Parcel::readString16View(std::optional<std::u16string_view>* val) const {
+    const size_t startPos = dataPosition();
+    int32_t size;
+    status_t status = readInt32(&size);
+    if (status != OK) return status;
+    if (size == kNullVectorSize) {
+        val->reset();
+        return OK;
+    }
+    setDataPosition(startPos);
+    std::u16string_view view;
+    status = readString16View(&view);
+    if (status != OK) return status;
+    val->emplace(view);
+    return OK;
+}
+
 const char16_t* Parcel::readString16Inplace(size_t* outLen) const
 {
     int32_t size = readInt32();
@@ -2944,9 +3119,12 @@ void Parcel::freeDataNoInit()
             gParcelGlobalAllocSize -= mDataCapacity;
             gParcelGlobalAllocCount--;
             if (mDeallocZero) {
+                // never reuse buffers which held sensitive data
                 zeroMemory(mData, mDataSize);
+                free(mData);
+            } else {
+                freeParcelData(mData, mDataCapacity);
             }
-            free(mData);
         }
         auto* kernelFields = maybeKernelFields();
         if (kernelFields && kernelFields->mObjects) free(kernelFields->mObjects);
@@ -3255,7 +3433,8 @@ status_t Parcel::continueWrite(size_t desired)
 
     } else {
         // This is the first data.  Easy!
-        uint8_t* data = (uint8_t*)malloc(desired);
+        size_t capacity;
+        uint8_t* data = allocParcelData(desired, &capacity);
         if (!data) {
             mError = NO_MEMORY;
             return NO_MEMORY;
@@ -3269,15 +3448,15 @@ status_t Parcel::continueWrite(size_t desired)
                   kernelFields ? kernelFields->mObjectsCapacity : 0, desired);
         }
 
-        LOG_ALLOC("Parcel %p: allocating with %zu capacity", this, desired);
-        gParcelGlobalAllocSize += desired;
+        LOG_ALLOC("Parcel %p: allocating with %zu capacity", this, capacity);
+        gParcelGlobalAllocSize += capacity;
         gParcelGlobalAllocCount++;
 
         mData = data;
         mDataSize = mDataPos = 0;
         ALOGV("continueWrite Setting data size of %p to %zu", this, mDataSize);
         ALOGV("continueWrite Setting data pos of %p to %zu", this, mDataPos);
-        mDataCapacity = desired;
+        mDataCapacity = capacity;
     }
 
     return NO_ERROR;
@@ -18,6 +18,7 @@
 
 #include <binder/PersistableBundle.h>
 
+#include <atomic>
 #include <limits>
 
 #include <binder/IBinder.h>
@@ -82,6 +83,104 @@ namespace os {
          }                                                               \
     }
 
+static std::atomic<bool> sReadLazily = false;
+
+namespace {
+
+status_t skipString16(const Parcel* parcel) {
+    size_t len;
+    return parcel->readString16Inplace(&len) != nullptr ? NO_ERROR : BAD_VALUE;
+}
+
+status_t skipArray(const Parcel* parcel, size_t elementSize) {
+    int32_t count;
+    RETURN_IF_FAILED(parcel->readInt32(&count));
+    if (count < 0) return UNEXPECTED_NULL;
+    size_t size;
+    if (__builtin_mul_overflow(static_cast<size_t>(count), elementSize, &size)) return BAD_VALUE;
+    return size == 0 || parcel->readInplace(size) != nullptr ? NO_ERROR : BAD_VALUE;
+}
+
+// Advances the parcel past a value of the type, without decoding it.
+status_t skipValue(const Parcel* parcel, int32_t type) {
+    switch (type) {
+        case VAL_STRING:
+            return skipString16(parcel);
+        case VAL_INTEGER:
+        case VAL_BOOLEAN:
+            return parcel->readInplace(sizeof(int32_t)) != nullptr ? NO_ERROR : NOT_ENOUGH_DATA;
+        case VAL_LONG:
+        case VAL_DOUBLE:
+            return parcel->readInplace(sizeof(int64_t)) != nullptr ? NO_ERROR : NOT_ENOUGH_DATA;
+        case VAL_STRINGARRAY: {
+            int32_t count;
+            RETURN_IF_FAILED(parcel->readInt32(&count));
+            if (count < 0) return UNEXPECTED_NULL;
+            for (; count > 0; --count) {
+                RETURN_IF_FAILED(skipString16(parcel));
+            }
+            return NO_ERROR;
+        }
+        case VAL_INTARRAY:
+        case VAL_BOOLEANARRAY:
+            // Parcel writes each bool as an int32.
+            return skipArray(parcel, sizeof(int32_t));
+        case VAL_LONGARRAY:
+        case VAL_DOUBLEARRAY:
+            return skipArray(parcel, sizeof(int64_t));
+        case VAL_PERSISTABLEBUNDLE: {
+            int32_t length;
+            RETURN_IF_FAILED(parcel->readInt32(&length));
+            if (length < 0) return UNEXPECTED_NULL;
+            if (length == 0) return NO_ERROR;
+            int32_t magic;
+            RETURN_IF_FAILED(parcel->readInt32(&magic));
+            if (magic != BUNDLE_MAGIC && magic != BUNDLE_MAGIC_NATIVE) return BAD_VALUE;
+            // The length covers the entries after the magic.
+            return parcel->readInplace(length) != nullptr ? NO_ERROR : NOT_ENOUGH_DATA;
+        }
+        default:
+            ALOGE("Unrecognized type: %d", type);
+            return BAD_TYPE;
+    }
+}
+
+status_t readValue(const Parcel* parcel, bool* out) {
+    return parcel->readBool(out);
+}
+status_t readValue(const Parcel* parcel, int32_t* out) {
+    return parcel->readInt32(out);
+}
+status_t readValue(const Parcel* parcel, int64_t* out) {
+    return parcel->readInt64(out);
+}
+status_t readValue(const Parcel* parcel, double* out) {
+    return parcel->readDouble(out);
+}
+status_t readValue(const Parcel* parcel, String16* out) {
+    return parcel->readString16(out);
+}
+status_t readValue(const Parcel* parcel, vector<bool>* out) {
+    return parcel->readBoolVector(out);
+}
+status_t readValue(const Parcel* parcel, vector<int32_t>* out) {
+    return parcel->readInt32Vector(out);
+}
+status_t readValue(const Parcel* parcel, vector<int64_t>* out) {
+    return parcel->readInt64Vector(out);
+}
+status_t readValue(const Parcel* parcel, vector<double>* out) {
+    return parcel->readDoubleVector(out);
+}
+status_t readValue(const Parcel* parcel, vector<String16>* out) {
+    return parcel->readString16Vector(out);
+}
+status_t readValue(const Parcel* parcel, PersistableBundle* out) {
+    return out->readFromParcel(parcel);
+}
+
+}  // namespace
+
 #define RETURN_IF_ENTRY_ERASED(map, key)      \
     {                                         \
         size_t num_erased = (map).erase(key); \
@@ -123,6 +222,10 @@ status_t PersistableBundle::writeToParcel(Parcel* parcel) const {
 }
 
 status_t PersistableBundle::readFromParcel(const Parcel* parcel) {
+    if (sReadLazily.load(std::memory_order_relaxed)) {
+        return readFromParcelLazily(parcel);
+    }
+
     /*
      * Keep implementation in sync with readFromParcelInner() in
      * frameworks/base/core/java/android/os/BaseBundle.java.
@@ -136,6 +239,51 @@ status_t PersistableBundle::readFromParcel(const Parcel* parcel) {
     return readFromParcelInner(parcel, static_cast<size_t>(length));
 }
 
+status_t PersistableBundle::readFromParcelLazily(const Parcel* parcel) {
+    int32_t length = parcel->readInt32();
+    if (length < 0) {
+        ALOGE("Bad length in parcel: %d", length);
+        return UNEXPECTED_NULL;
+    }
+    mLazyEntries.reset();
+    mErasedLazyKeys.clear();
+    if (length == 0) {
+        return NO_ERROR;
+    }
+
+    int32_t magic;
+    RETURN_IF_FAILED(parcel->readInt32(&magic));
+    if (magic != BUNDLE_MAGIC && magic != BUNDLE_MAGIC_NATIVE) {
+        ALOGE("Bad magic number for PersistableBundle: 0x%08x", magic);
+        return BAD_VALUE;
+    }
+    int32_t num_entries;
+    RETURN_IF_FAILED(parcel->readInt32(&num_entries));
+
+    // Index the entries, then copy them all at once.
+    const size_t start_pos = parcel->dataPosition();
+    auto entries = std::make_shared<LazyEntries>();
+    for (; num_entries > 0; --num_entries) {
+        LazyEntry entry;
+        entry.entryOffset = parcel->dataPosition() - start_pos;
+        String16 key;
+        RETURN_IF_FAILED(parcel->readString16(&key));
+        RETURN_IF_FAILED(parcel->readInt32(&entry.type));
+        entry.valueOffset = parcel->dataPosition() - start_pos;
+        RETURN_IF_FAILED(skipValue(parcel, entry.type));
+        entry.entrySize = parcel->dataPosition() - start_pos - entry.entryOffset;
+        entries->index[key] = entry;
+    }
+    const uint8_t* data = parcel->data();
+    entries->data.assign(data + start_pos, data + parcel->dataPosition());
+    mLazyEntries = std::move(entries);
+    return NO_ERROR;
+}
+
+void PersistableBundle::setReadLazily(bool lazy) {
+    sReadLazily.store(lazy, std::memory_order_relaxed);
+}
+
 bool PersistableBundle::empty() const {
     return size() == 0u;
 }
@@ -151,10 +299,15 @@ size_t PersistableBundle::size() const {
             mLongVectorMap.size() +
             mDoubleVectorMap.size() +
             mStringVectorMap.size() +
-            mPersistableBundleMap.size());
+            mPersistableBundleMap.size() +
+            (mLazyEntries ? mLazyEntries->index.size() - mErasedLazyKeys.size() : 0));
 }
 
 size_t PersistableBundle::erase(const String16& key) {
+    if (findLazyEntry(key) != nullptr) {
+        mErasedLazyKeys.insert(key);
+        return 1;
+    }
     RETURN_IF_ENTRY_ERASED(mBoolMap, key);
     RETURN_IF_ENTRY_ERASED(mIntMap, key);
     RETURN_IF_ENTRY_ERASED(mLongMap, key);
@@ -224,91 +377,113 @@ void PersistableBundle::putPersistableBundle(const String16& key, const Persista
 }
 
 bool PersistableBundle::getBoolean(const String16& key, bool* out) const {
-    return getValue(key, out, mBoolMap);
+    return getValue(key, out, mBoolMap) || getLazyValue(key, VAL_BOOLEAN, out);
 }
 
 bool PersistableBundle::getInt(const String16& key, int32_t* out) const {
-    return getValue(key, out, mIntMap);
+    return getValue(key, out, mIntMap) || getLazyValue(key, VAL_INTEGER, out);
 }
 
 bool PersistableBundle::getLong(const String16& key, int64_t* out) const {
-    return getValue(key, out, mLongMap);
+    return getValue(key, out, mLongMap) || getLazyValue(key, VAL_LONG, out);
 }
 
 bool PersistableBundle::getDouble(const String16& key, double* out) const {
-    return getValue(key, out, mDoubleMap);
+    return getValue(key, out, mDoubleMap) || getLazyValue(key, VAL_DOUBLE, out);
 }
 
 bool PersistableBundle::getString(const String16& key, String16* out) const {
-    return getValue(key, out, mStringMap);
+    return getValue(key, out, mStringMap) || getLazyValue(key, VAL_STRING, out);
 }
 
 bool PersistableBundle::getBooleanVector(const String16& key, vector<bool>* out) const {
-    return getValue(key, out, mBoolVectorMap);
+    return getValue(key, out, mBoolVectorMap) || getLazyValue(key, VAL_BOOLEANARRAY, out);
 }
 
 bool PersistableBundle::getIntVector(const String16& key, vector<int32_t>* out) const {
-    return getValue(key, out, mIntVectorMap);
+    return getValue(key, out, mIntVectorMap) || getLazyValue(key, VAL_INTARRAY, out);
 }
 
 bool PersistableBundle::getLongVector(const String16& key, vector<int64_t>* out) const {
-    return getValue(key, out, mLongVectorMap);
+    return getValue(key, out, mLongVectorMap) || getLazyValue(key, VAL_LONGARRAY, out);
 }
 
 bool PersistableBundle::getDoubleVector(const String16& key, vector<double>* out) const {
-    return getValue(key, out, mDoubleVectorMap);
+    return getValue(key, out, mDoubleVectorMap) || getLazyValue(key, VAL_DOUBLEARRAY, out);
 }
 
 bool PersistableBundle::getStringVector(const String16& key, vector<String16>* out) const {
-    return getValue(key, out, mStringVectorMap);
+    return getValue(key, out, mStringVectorMap) || getLazyValue(key, VAL_STRINGARRAY, out);
 }
 
 bool PersistableBundle::getPersistableBundle(const String16& key, PersistableBundle* out) const {
-    return getValue(key, out, mPersistableBundleMap);
+    return getValue(key, out, mPersistableBundleMap) || getLazyValue(key, VAL_PERSISTABLEBUNDLE, out);
 }
 
 set<String16> PersistableBundle::getBooleanKeys() const {
-    return getKeys(mBoolMap);
+    set<String16> keys = getKeys(mBoolMap);
+    addLazyKeys(VAL_BOOLEAN, &keys);
+    return keys;
 }
 
 set<String16> PersistableBundle::getIntKeys() const {
-    return getKeys(mIntMap);
+    set<String16> keys = getKeys(mIntMap);
+    addLazyKeys(VAL_INTEGER, &keys);
+    return keys;
 }
 
 set<String16> PersistableBundle::getLongKeys() const {
-    return getKeys(mLongMap);
+    set<String16> keys = getKeys(mLongMap);
+    addLazyKeys(VAL_LONG, &keys);
+    return keys;
 }
 
 set<String16> PersistableBundle::getDoubleKeys() const {
-    return getKeys(mDoubleMap);
+    set<String16> keys = getKeys(mDoubleMap);
+    addLazyKeys(VAL_DOUBLE, &keys);
+    return keys;
 }
 
 set<String16> PersistableBundle::getStringKeys() const {
-    return getKeys(mStringMap);
+    set<String16> keys = getKeys(mStringMap);
+    addLazyKeys(VAL_STRING, &keys);
+    return keys;
 }
 
 set<String16> PersistableBundle::getBooleanVectorKeys() const {
-    return getKeys(mBoolVectorMap);
+    set<String16> keys = getKeys(mBoolVectorMap);
+    addLazyKeys(VAL_BOOLEANARRAY, &keys);
+    return keys;
 }
 
 set<String16> PersistableBundle::getIntVectorKeys() const {
-    return getKeys(mIntVectorMap);
+    set<String16> keys = getKeys(mIntVectorMap);
+    addLazyKeys(VAL_INTARRAY, &keys);
+    return keys;
 }
 
 set<String16> PersistableBundle::getLongVectorKeys() const {
-    return getKeys(mLongVectorMap);
+    set<String16> keys = getKeys(mLongVectorMap);
+    addLazyKeys(VAL_LONGARRAY, &keys);
+    return keys;
 }
 
 set<String16> PersistableBundle::getDoubleVectorKeys() const {
-    return getKeys(mDoubleVectorMap);
+    set<String16> keys = getKeys(mDoubleVectorMap);
+    addLazyKeys(VAL_DOUBLEARRAY, &keys);
+    return keys;
 }
 
 set<String16> PersistableBundle::getStringVectorKeys() const {
-    return getKeys(mStringVectorMap);
+    set<String16> keys = getKeys(mStringVectorMap);
+    addLazyKeys(VAL_STRINGARRAY, &keys);
+    return keys;
 }
 
 set<String16> PersistableBundle::getPersistableBundleKeys() const {
-    return getKeys(mPersistableBundleMap);
+    set<String16> keys = getKeys(mPersistableBundleMap);
+    addLazyKeys(VAL_PERSISTABLEBUNDLE, &keys);
+    return keys;
 }
 
 status_t PersistableBundle::writeToParcelInner(Parcel* parcel) const {
@@ -381,6 +556,13 @@ status_t PersistableBundle::writeToParcelInner(Parcel* parcel) const {
         RETURN_IF_FAILED(parcel->writeInt32(VAL_PERSISTABLEBUNDLE));
         RETURN_IF_FAILED(key_val_pair.second.writeToParcel(parcel));
     }
+    if (mLazyEntries) {
+        for (const auto& [key, entry] : mLazyEntries->index) {
+            if (mErasedLazyKeys.count(key)) continue;
+            RETURN_IF_FAILED(
+                    parcel->write(mLazyEntries->data.data() + entry.entryOffset, entry.entrySize));
+        }
+    }
     return NO_ERROR;
 }
 
@@ -477,6 +659,87 @@ status_t PersistableBundle::readFromParcelInner(const Parcel* parcel, size_t len
     return NO_ERROR;
 }
 
+bool PersistableBundle::equals(const PersistableBundle& other) const {
+    if (mLazyEntries || other.mLazyEntries) {
+        return decoded().equals(other.decoded());
+    }
+    return (mBoolMap == other.mBoolMap && mIntMap == other.mIntMap &&
+            mLongMap == other.mLongMap && mDoubleMap == other.mDoubleMap &&
+            mStringMap == other.mStringMap && mBoolVectorMap == other.mBoolVectorMap &&
+            mIntVectorMap == other.mIntVectorMap && mLongVectorMap == other.mLongVectorMap &&
+            mDoubleVectorMap == other.mDoubleVectorMap &&
+            mStringVectorMap == other.mStringVectorMap &&
+            mPersistableBundleMap == other.mPersistableBundleMap);
+}
+
+PersistableBundle PersistableBundle::decoded() const {
+    PersistableBundle bundle = *this;
+    bundle.mLazyEntries.reset();
+    bundle.mErasedLazyKeys.clear();
+    if (!mLazyEntries) return bundle;
+
+#define DECODE_LAZY_ENTRY(val, map)                                       \
+    case val:                                                             \
+        getLazyValue(key, val, &bundle.map[key]);                         \
+        break;
+
+    for (const auto& [key, entry] : mLazyEntries->index) {
+        if (mErasedLazyKeys.count(key)) continue;
+        switch (entry.type) {
+            DECODE_LAZY_ENTRY(VAL_BOOLEAN, mBoolMap)
+            DECODE_LAZY_ENTRY(VAL_INTEGER, mIntMap)
+            DECODE_LAZY_ENTRY(VAL_LONG, mLongMap)
+            DECODE_LAZY_ENTRY(VAL_DOUBLE, mDoubleMap)
+            DECODE_LAZY_ENTRY(VAL_STRING, mStringMap)
+            DECODE_LAZY_ENTRY(VAL_BOOLEANARRAY, mBoolVectorMap)
+            DECODE_LAZY_ENTRY(VAL_INTARRAY, mIntVectorMap)
+            DECODE_LAZY_ENTRY(VAL_LONGARRAY, mLongVectorMap)
+            DECODE_LAZY_ENTRY(VAL_DOUBLEARRAY, mDoubleVectorMap)
+            DECODE_LAZY_ENTRY(VAL_STRINGARRAY, mStringVectorMap)
+            DECODE_LAZY_ENTRY(VAL_PERSISTABLEBUNDLE, mPersistableBundleMap)
+        }
+    }
+
+#undef DECODE_LAZY_ENTRY
+
+    return bundle;
+}
+
+const PersistableBundle::LazyEntry* PersistableBundle::findLazyEntry(const String16& key) const {
+    if (!mLazyEntries || mErasedLazyKeys.count(key)) return nullptr;
+    const auto it = mLazyEntries->index.find(key);
+    return it == mLazyEntries->index.end() ? nullptr : &it->second;
+}
+
+template <typename T>
+bool PersistableBundle::getLazyValue(const String16& key, int32_t type, T* out) const {
+    const LazyEntry* entry = findLazyEntry(key);
+    if (entry == nullptr || entry->type != type) return false;
+
+    // Decode from a parcel of the value alone, so that reads of copies of this bundle, which
+    // share the entries, need no synchronization.
+    Parcel parcel;
+    status_t status = parcel.setData(mLazyEntries->data.data() + entry->valueOffset,
+                                     entry->entryOffset + entry->entrySize - entry->valueOffset);
+    T value;
+    if (status == NO_ERROR) status = readValue(&parcel, &value);
+    if (status != NO_ERROR) {
+        ALOGE("Failed to decode value of type %d: %s", type, statusToString(status).c_str());
+        return false;
+    }
+    *out = std::move(value);
+    return true;
+}
+
+void PersistableBundle::addLazyKeys(int32_t type, set<String16>* keys) const {
+    if (!mLazyEntries) return;
+    for (const auto& [key, entry] : mLazyEntries->index) {
+        if (entry.type == type && !mErasedLazyKeys.count(key)) {
+            keys->insert(key);
+        }
+    }
+}
+
 }  // namespace os
 
 }  // namespace android
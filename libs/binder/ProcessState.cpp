@@ -42,6 +42,7 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
+#include <algorithm>
 #include <mutex>
 
 #define BINDER_VM_SIZE ((1 * 1024 * 1024) - sysconf(_SC_PAGE_SIZE) * 2)
@@ -83,19 +84,32 @@ using android::binder::unique_fd;
 class PoolThread : public Thread
 {
 public:
-    explicit PoolThread(bool isMain)
-        : mIsMain(isMain)
+    enum class Kind {
+        // Started by startThreadPool, never exits.
+        MAIN,
+        // Started because of BR_SPAWN_LOOPER.
+        KERNEL_REQUESTED,
+        // Started by ProcessState::spawnPooledThreadAheadOfDemand.
+        AHEAD_OF_DEMAND,
+    };
+
+    explicit PoolThread(Kind kind)
+        : mKind(kind)
     {
     }
 
 protected:
     virtual bool threadLoop()
     {
-        IPCThreadState::self()->joinThreadPool(mIsMain);
+        if (mKind == Kind::MAIN) {
+            IPCThreadState::self()->joinThreadPool(true);
+        } else {
+            IPCThreadState::self()->joinPooledThread(mKind == Kind::KERNEL_REQUESTED);
+        }
         return false;
     }
 
-    const bool mIsMain;
+    const Kind mKind;
 };
 
 sp<ProcessState> ProcessState::self()
@@ -427,7 +441,13 @@ void ProcessState::spawnPooledThread(bool isMain)
     if (mThreadPoolStarted) {
         String8 name = makeBinderThreadName();
         ALOGV("Spawning new pooled thread, name=%s\n", name.c_str());
-        sp<Thread> t = sp<PoolThread>::make(isMain);
+        sp<Thread> t = sp<PoolThread>::make(isMain ? PoolThread::Kind::MAIN
+                                                   : PoolThread::Kind::KERNEL_REQUESTED);
+        if (!isMain) {
+            mKernelRequestedThreads++;
+            mPooledThreads++;
+        }
+        mSpawnedThreads++;
         t->run(name.c_str());
         mKernelStartedThreads++;
     }
@@ -451,6 +471,52 @@ status_t ProcessState::setThreadPoolMaxThreadCount(size_t maxThreads) {
     return result;
 }
 
+void ProcessState::setThreadPoolIdleTimeout(size_t minThreads,
+                                            std::chrono::milliseconds idleTimeout) {
+    mThreadPoolMinThreads = minThreads;
+    mThreadPoolIdleTimeout = std::max(idleTimeout, std::chrono::milliseconds::zero());
+}
+
+ProcessState::ThreadPoolStats ProcessState::getThreadPoolStats() const {
+    return {
+            .spawnedThreads = mSpawnedThreads,
+            .exitedThreads = mExitedThreads,
+            .maxCurrentThreads = mMaxCurrentThreads,
+            .maxExecutingThreads = mMaxExecutingThreads,
+    };
+}
+
+void ProcessState::spawnPooledThreadAheadOfDemand() {
+    if (mThreadPoolIdleTimeout.load() == std::chrono::milliseconds::zero() || !mThreadPoolStarted) {
+        return;
+    }
+
+    // Until it has started mMaxThreads, the kernel asks for a thread itself
+    // when the last idle one picks up a command.
+    const size_t maxThreads = mMaxThreads;
+    if (mKernelRequestedThreads < maxThreads) return;
+
+    size_t pooled = mPooledThreads;
+    do {
+        if (pooled >= maxThreads) return;
+    } while (!mPooledThreads.compare_exchange_weak(pooled, pooled + 1));
+
+    String8 name = makeBinderThreadName();
+    ALOGV("Spawning new pooled thread ahead of demand, name=%s\n", name.c_str());
+    sp<Thread> t = sp<PoolThread>::make(PoolThread::Kind::AHEAD_OF_DEMAND);
+    mSpawnedThreads++;
+    t->run(name.c_str());
+}
+
+bool ProcessState::retireIdleThread() {
+    const size_t minThreads = mThreadPoolMinThreads;
+    size_t current = mCurrentThreads;
+    do {
+        if (current <= minThreads) return false;
+    } while (!mCurrentThreads.compare_exchange_weak(current, current - 1));
+    return true;
+}
+
 size_t ProcessState::getThreadPoolMaxTotalThreadCount() const {
     // Need to read `mKernelStartedThreads` before `mThreadPoolStarted` (with
     // non-relaxed memory ordering) to avoid a race like the following:
@@ -579,6 +645,14 @@ ProcessState::ProcessState(const char* driver)
         mCurrentThreads(0),
         mKernelStartedThreads(0),
         mStarvationStartTime(never()),
+        mThreadPoolIdleTimeout(std::chrono::milliseconds::zero()),
+        mThreadPoolMinThreads(0),
+        mKernelRequestedThreads(0),
+        mPooledThreads(0),
+        mSpawnedThreads(0),
+        mExitedThreads(0),
+        mMaxCurrentThreads(0),
+        mMaxExecutingThreads(0),
         mForked(false),
         mThreadPoolStarted(false),
         mThreadPoolSeq(1),
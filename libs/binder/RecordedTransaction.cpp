@@ -24,6 +24,7 @@
 #include <sys/mman.h>
 #include <sys/stat.h>
 #include <algorithm>
+#include <cstring>
 
 using namespace android::binder::impl;
 using android::Parcel;
@@ -32,6 +33,8 @@ using android::binder::ReadFully;
 using android::binder::unique_fd;
 using android::binder::WriteFully;
 using android::binder::debug::RecordedTransaction;
+using android::binder::debug::RecordingIndex;
+using android::binder::debug::TransactionRecorder;
 
 #define PADDING8(s) ((8 - (s) % 8) % 8)
 
@@ -111,6 +114,27 @@ static_assert(PADDING8(8) == 0);
 //
 // No effort is made to ensure the expected chunks are present. A single
 // End Chunk may therefore produce an empty, meaningless RecordedTransaction.
+//
+// A recording written by TransactionRecorder ends with an index of its
+// transactions, for random access:
+// ┌──────────────────────────────┐
+// │ Transaction                  │
+// ├──────────────────────────────┤
+// │ ...                          │
+// ├──────────────────────────────┤
+// │ Index Interface Names Chunk  │
+// ├──────────────────────────────┤
+// │ Index Entries Chunk          │
+// ├──────────────────────────────┤
+// ║ Index Footer Chunk           ║
+// ╚══════════════════════════════╝
+//
+// The Interface Names Chunk holds the interface names, each terminated by a
+// zero byte. The Entries Chunk holds a RecordingIndex::Entry for each
+// transaction. The Footer Chunk holds a magic number and the file offset of
+// the Interface Names Chunk, and since it has a fixed size, it is found at the
+// end of the file. Readers which reach the index, including older ones, stop
+// reading transactions there.
 
 RecordedTransaction::RecordedTransaction(RecordedTransaction&& t) noexcept {
     mData = t.mData;
@@ -164,6 +188,9 @@ enum {
     REPLY_PARCEL_CHUNK = 3,
     INTERFACE_NAME_CHUNK = 4,
     DATA_PARCEL_OBJECT_CHUNK = 5,
+    INDEX_INTERFACE_NAMES_CHUNK = 6,
+    INDEX_ENTRIES_CHUNK = 7,
+    INDEX_FOOTER_CHUNK = 8,
     END_CHUNK = 0x00ffffff,
 };
 
@@ -176,6 +203,54 @@ static_assert(sizeof(ChunkDescriptor) % 8 == 0);
 constexpr uint32_t kMaxChunkDataSize = 0xfffffff0;
 typedef uint64_t transaction_checksum_t;
 
+struct IndexFooter {
+    uint64_t magic = 0;
+    uint64_t indexOffset = 0;
+};
+static_assert(sizeof(IndexFooter) % 8 == 0);
+
+constexpr uint64_t kIndexMagic = 0x5844'4e49'4452'4342; // "BCRDINDX"
+constexpr size_t kIndexFooterChunkSize =
+        sizeof(ChunkDescriptor) + sizeof(IndexFooter) + sizeof(transaction_checksum_t);
+
+// Appends a Chunk with a zero checksum to buffer; see sealChunks. Returns
+// where its data is, which is left for the caller to fill if data is null.
+static uint8_t* appendChunk(std::vector<uint8_t>* buffer, uint32_t chunkType, size_t byteCount,
+                            const void* data) {
+    const ChunkDescriptor descriptor = {.chunkType = chunkType,
+                                        .dataSize = static_cast<uint32_t>(byteCount)};
+    const size_t start = buffer->size();
+    buffer->resize(start + sizeof(ChunkDescriptor) + byteCount + PADDING8(byteCount) +
+                   sizeof(transaction_checksum_t));
+    uint8_t* chunk = buffer->data() + start;
+    memcpy(chunk, &descriptor, sizeof(ChunkDescriptor));
+    if (data != nullptr && byteCount > 0) {
+        memcpy(chunk + sizeof(ChunkDescriptor), data, byteCount);
+    }
+    memset(chunk + sizeof(ChunkDescriptor) + byteCount, 0,
+           PADDING8(byteCount) + sizeof(transaction_checksum_t));
+    return chunk + sizeof(ChunkDescriptor);
+}
+
+// Fills in the checksums of the Chunks written by appendChunk.
+static void sealChunks(std::vector<uint8_t>* buffer) {
+    size_t offset = 0;
+    while (offset < buffer->size()) {
+        ChunkDescriptor descriptor;
+        memcpy(&descriptor, buffer->data() + offset, sizeof(ChunkDescriptor));
+        const size_t checksumOffset = offset + sizeof(ChunkDescriptor) + descriptor.dataSize +
+                PADDING8(descriptor.dataSize);
+        transaction_checksum_t checksum = 0;
+        for (size_t i = offset; i < checksumOffset; i += sizeof(transaction_checksum_t)) {
+            transaction_checksum_t word;
+            memcpy(&word, buffer->data() + i, sizeof(word));
+            checksum ^= word;
+        }
+        memcpy(buffer->data() + checksumOffset, &checksum, sizeof(checksum));
+        offset = checksumOffset + sizeof(transaction_checksum_t);
+    }
+}
+
 std::optional<RecordedTransaction> RecordedTransaction::fromFile(const unique_fd& fd) {
     RecordedTransaction t;
     ChunkDescriptor chunk;
@@ -299,6 +374,11 @@ std::optional<RecordedTransaction> RecordedTransaction::fromFile(const unique_fd
                 }
                 break;
             }
+            case INDEX_INTERFACE_NAMES_CHUNK:
+            case INDEX_ENTRIES_CHUNK:
+            case INDEX_FOOTER_CHUNK:
+                // The index follows the last transaction.
+                return std::nullopt;
             case END_CHUNK:
                 break;
             default:
@@ -316,29 +396,9 @@ android::status_t RecordedTransaction::writeChunk(borrowed_fd fd, uint32_t chunk
         ALOGE("Chunk data exceeds maximum size");
         return BAD_VALUE;
     }
-    ChunkDescriptor descriptor = {.chunkType = chunkType,
-                                  .dataSize = static_cast<uint32_t>(byteCount)};
-    // Prepare Chunk content as byte *
-    const std::byte* descriptorBytes = reinterpret_cast<const std::byte*>(&descriptor);
-    const std::byte* dataBytes = reinterpret_cast<const std::byte*>(data);
-
-    // Add Chunk to intermediate buffer, except checksum
-    std::vector<std::byte> buffer;
-    buffer.insert(buffer.end(), descriptorBytes, descriptorBytes + sizeof(ChunkDescriptor));
-    buffer.insert(buffer.end(), dataBytes, dataBytes + byteCount);
-    std::byte zero{0};
-    buffer.insert(buffer.end(), PADDING8(byteCount), zero);
-
-    // Calculate checksum from buffer
-    transaction_checksum_t* checksumData = reinterpret_cast<transaction_checksum_t*>(buffer.data());
-    transaction_checksum_t checksumValue = 0;
-    for (size_t idx = 0; idx < (buffer.size() / sizeof(transaction_checksum_t)); idx++) {
-        checksumValue ^= checksumData[idx];
-    }
-
-    // Write checksum to buffer
-    std::byte* checksumBytes = reinterpret_cast<std::byte*>(&checksumValue);
-    buffer.insert(buffer.end(), checksumBytes, checksumBytes + sizeof(transaction_checksum_t));
+    std::vector<uint8_t> buffer;
+    appendChunk(&buffer, chunkType, byteCount, data);
+    sealChunks(&buffer);
 
     // Write buffer to file
     if (!WriteFully(fd, buffer.data(), buffer.size())) {
@@ -426,3 +486,379 @@ const Parcel& RecordedTransaction::getDataParcel() const {
 const Parcel& RecordedTransaction::getReplyParcel() const {
     return mReplyDataOnly;
 }
+
+android::status_t RecordedTransaction::appendChunks(std::vector<uint8_t>* buffer,
+                                                    std::string_view interfaceName, uint32_t code,
+                                                    uint32_t flags, timespec timestamp,
+                                                    const Parcel& data, const Parcel& reply,
+                                                    status_t err) {
+    if (data.dataBufferSize() > kMaxChunkDataSize || reply.dataBufferSize() > kMaxChunkDataSize) {
+        ALOGE("Chunk data exceeds maximum size");
+        return BAD_VALUE;
+    }
+    const TransactionHeader header = {code,
+                                      flags,
+                                      static_cast<int32_t>(err),
+                                      data.isForRpc() ? static_cast<uint32_t>(1)
+                                                      : static_cast<uint32_t>(0),
+                                      static_cast<int64_t>(timestamp.tv_sec),
+                                      static_cast<int32_t>(timestamp.tv_nsec),
+                                      0};
+    appendChunk(buffer, HEADER_CHUNK, sizeof(TransactionHeader), &header);
+    appendChunk(buffer, INTERFACE_NAME_CHUNK, interfaceName.size(), interfaceName.data());
+    appendChunk(buffer, DATA_PARCEL_CHUNK, data.dataBufferSize(), data.data());
+    appendChunk(buffer, REPLY_PARCEL_CHUNK, reply.dataBufferSize(), reply.data());
+    if (const auto* kernelFields = data.maybeKernelFields()) {
+        // Offsets are recorded as uint64_t whatever the size of binder_size_t.
+        uint8_t* objects = appendChunk(buffer, DATA_PARCEL_OBJECT_CHUNK,
+                                       kernelFields->mObjectsSize * sizeof(uint64_t), nullptr);
+        for (size_t i = 0; i < kernelFields->mObjectsSize; i++) {
+            const uint64_t offset = kernelFields->mObjects[i];
+            memcpy(objects + i * sizeof(uint64_t), &offset, sizeof(uint64_t));
+        }
+    } else {
+        appendChunk(buffer, DATA_PARCEL_OBJECT_CHUNK, 0, nullptr);
+    }
+    appendChunk(buffer, END_CHUNK, 0, nullptr);
+    return NO_ERROR;
+}
+
+// Reads the Chunk at the offset of fd, which must end before fileSize.
+static bool readChunk(const unique_fd& fd, off_t fileSize, uint32_t expectedType,
+                      std::vector<uint8_t>* data) {
+    off_t offset = lseek(fd.get(), 0, SEEK_CUR);
+    ChunkDescriptor descriptor;
+    if (offset == -1 || fileSize - offset < static_cast<off_t>(sizeof(ChunkDescriptor)) ||
+        !ReadFully(fd, &descriptor, sizeof(ChunkDescriptor))) {
+        ALOGE("Failed to read index ChunkDescriptor");
+        return false;
+    }
+    if (descriptor.chunkType != expectedType || descriptor.dataSize > kMaxChunkDataSize) {
+        ALOGE("Unexpected index chunk %" PRIu32 " of size %" PRIu32, descriptor.chunkType,
+              descriptor.dataSize);
+        return false;
+    }
+    const size_t payloadSize = descriptor.dataSize + PADDING8(descriptor.dataSize);
+    if (static_cast<uint64_t>(fileSize - offset) <
+        sizeof(ChunkDescriptor) + payloadSize + sizeof(transaction_checksum_t)) {
+        ALOGE("Index chunk exceeds remaining file size.");
+        return false;
+    }
+    std::vector<uint8_t> chunk(sizeof(ChunkDescriptor) + payloadSize +
+                               sizeof(transaction_checksum_t));
+    memcpy(chunk.data(), &descriptor, sizeof(ChunkDescriptor));
+    if (!ReadFully(fd, chunk.data() + sizeof(ChunkDescriptor),
+                   chunk.size() - sizeof(ChunkDescriptor))) {
+        ALOGE("Failed to read index chunk. %s", strerror(errno));
+        return false;
+    }
+    transaction_checksum_t checksum = 0;
+    for (size_t i = 0; i < chunk.size(); i += sizeof(transaction_checksum_t)) {
+        transaction_checksum_t word;
+        memcpy(&word, chunk.data() + i, sizeof(word));
+        checksum ^= word;
+    }
+    if (checksum != 0) {
+        ALOGE("Checksum failed.");
+        return false;
+    }
+    data->assign(chunk.begin() + sizeof(ChunkDescriptor),
+                 chunk.begin() + sizeof(ChunkDescriptor) + descriptor.dataSize);
+    return true;
+}
+
+std::optional<RecordingIndex> RecordingIndex::fromFile(const unique_fd& fd) {
+    struct stat fileStat;
+    if (fstat(fd.get(), &fileStat) != 0) {
+        ALOGE("Unable to get file information");
+        return std::nullopt;
+    }
+    const off_t fileSize = fileStat.st_size;
+    if (fileSize < static_cast<off_t>(kIndexFooterChunkSize)) {
+        return std::nullopt;
+    }
+    const off_t originalOffset = lseek(fd.get(), 0, SEEK_CUR);
+    if (originalOffset == -1) {
+        ALOGE("Invalid offset in file descriptor.");
+        return std::nullopt;
+    }
+    auto restoreOffset =
+            make_scope_guard([&fd, originalOffset] { lseek(fd.get(), originalOffset, SEEK_SET); });
+
+    // Recordings without an index are expected, so they are not an error.
+    ChunkDescriptor descriptor;
+    if (lseek(fd.get(), fileSize - kIndexFooterChunkSize, SEEK_SET) == -1 ||
+        !ReadFully(fd, &descriptor, sizeof(ChunkDescriptor)) ||
+        descriptor.chunkType != INDEX_FOOTER_CHUNK) {
+        return std::nullopt;
+    }
+    std::vector<uint8_t> data;
+    if (lseek(fd.get(), fileSize - kIndexFooterChunkSize, SEEK_SET) == -1 ||
+        !readChunk(fd, fileSize, INDEX_FOOTER_CHUNK, &data) || data.size() != sizeof(IndexFooter)) {
+        return std::nullopt;
+    }
+    IndexFooter footer;
+    memcpy(&footer, data.data(), sizeof(IndexFooter));
+    if (footer.magic != kIndexMagic ||
+        footer.indexOffset > static_cast<uint64_t>(fileSize - kIndexFooterChunkSize)) {
+        ALOGE("Invalid index footer.");
+        return std::nullopt;
+    }
+    const off_t indexEnd = fileSize - kIndexFooterChunkSize;
+
+    RecordingIndex index;
+    if (lseek(fd.get(), footer.indexOffset, SEEK_SET) == -1 ||
+        !readChunk(fd, indexEnd, INDEX_INTERFACE_NAMES_CHUNK, &data)) {
+        return std::nullopt;
+    }
+    for (auto it = data.begin(); it != data.end();) {
+        auto end = std::find(it, data.end(), 0);
+        if (end == data.end()) {
+            ALOGE("Interface name is not terminated.");
+            return std::nullopt;
+        }
+        index.mInterfaceNames.emplace_back(it, end);
+        it = end + 1;
+    }
+
+    if (!readChunk(fd, indexEnd, INDEX_ENTRIES_CHUNK, &data) || data.size() % sizeof(Entry) != 0) {
+        return std::nullopt;
+    }
+    index.mEntries.resize(data.size() / sizeof(Entry));
+    memcpy(index.mEntries.data(), data.data(), data.size());
+    for (const Entry& entry : index.mEntries) {
+        if (entry.interfaceIndex >= index.mInterfaceNames.size() ||
+            entry.offset >= footer.indexOffset) {
+            ALOGE("Invalid index entry.");
+            return std::nullopt;
+        }
+    }
+    return index;
+}
+
+std::optional<RecordedTransaction> RecordingIndex::readTransaction(const unique_fd& fd,
+                                                                   const Entry& entry) {
+    if (lseek(fd.get(), entry.offset, SEEK_SET) == -1) {
+        ALOGE("Invalid offset in file descriptor.");
+        return std::nullopt;
+    }
+    return RecordedTransaction::fromFile(fd);
+}
+
+const std::vector<std::string>& RecordingIndex::getInterfaceNames() const {
+    return mInterfaceNames;
+}
+
+const std::vector<RecordingIndex::Entry>& RecordingIndex::getEntries() const {
+    return mEntries;
+}
+
+static int64_t toNanoseconds(timespec ts) {
+    return static_cast<int64_t>(ts.tv_sec) * 1'000'000'000 + ts.tv_nsec;
+}
+
+std::vector<RecordingIndex::Entry> RecordingIndex::findByTime(timespec begin, timespec end) const {
+    auto byTime = [](const Entry& entry, int64_t ns) { return entry.timestampNs < ns; };
+    auto first = std::lower_bound(mEntries.begin(), mEntries.end(), toNanoseconds(begin), byTime);
+    auto last = std::lower_bound(first, mEntries.end(), toNanoseconds(end), byTime);
+    return std::vector<Entry>(first, last);
+}
+
+std::vector<RecordingIndex::Entry> RecordingIndex::findByInterface(
+        std::string_view interfaceName, std::optional<uint32_t> code) const {
+    std::vector<Entry> entries;
+    auto name = std::find(mInterfaceNames.begin(), mInterfaceNames.end(), interfaceName);
+    if (name == mInterfaceNames.end()) {
+        return entries;
+    }
+    const auto interfaceIndex = static_cast<uint32_t>(name - mInterfaceNames.begin());
+    for (const Entry& entry : mEntries) {
+        if (entry.interfaceIndex == interfaceIndex && (!code || entry.code == *code)) {
+            entries.push_back(entry);
+        }
+    }
+    return entries;
+}
+
+TransactionRecorder::TransactionRecorder(unique_fd fd) : TransactionRecorder(std::move(fd), {}) {}
+
+TransactionRecorder::TransactionRecorder(unique_fd fd, const Options& options)
+      : mFd(std::move(fd)), mOptions(options) {
+    // Without an offset, e.g. for a pipe, there can be no index.
+    mOffset = lseek(mFd.get(), 0, SEEK_CUR);
+#ifndef BINDER_RPC_SINGLE_THREADED
+    mThread = RpcMaybeThread(&TransactionRecorder::threadLoop, this);
+#endif
+}
+
+TransactionRecorder::~TransactionRecorder() {
+    (void)finish();
+}
+
+bool TransactionRecorder::record(const String16& interfaceName, uint32_t code, uint32_t flags,
+                                 timespec timestamp, const Parcel& data, const Parcel& reply,
+                                 status_t err) {
+    Pending pending;
+    {
+        RpcMutexLockGuard _l(mLock);
+        if (mStopping) {
+            return false;
+        }
+        if (mPendingBytes >= mOptions.maxPendingBytes) {
+            mDropped++;
+            return false;
+        }
+        if (!mFree.empty()) {
+            pending = std::move(mFree.back());
+            mFree.pop_back();
+        }
+    }
+
+    // Reuses the capacity of a recycled buffer, so that steady recording
+    // does not allocate.
+    pending.interfaceName.clear();
+    for (char16_t c : std::u16string_view(interfaceName.c_str(), interfaceName.size())) {
+        if (c > 0x7f) {
+            ALOGE("Interface Name is not valid. Contains characters that aren't single byte "
+                  "utf-8.");
+            return false;
+        }
+        pending.interfaceName.push_back(static_cast<char>(c));
+    }
+    pending.timestampNs = toNanoseconds(timestamp);
+    pending.code = code;
+    pending.buffer.clear();
+    if (RecordedTransaction::appendChunks(&pending.buffer, pending.interfaceName, code, flags,
+                                          timestamp, data, reply, err) != NO_ERROR) {
+        return false;
+    }
+
+    {
+        RpcMutexLockGuard _l(mLock);
+        if (mStopping) {
+            return false;
+        }
+        mPendingBytes += pending.buffer.size();
+        mPending.push_back(std::move(pending));
+    }
+#ifdef BINDER_RPC_SINGLE_THREADED
+    writePending();
+#else
+    mCondition.notify_one();
+#endif
+    return true;
+}
+
+void TransactionRecorder::threadLoop() {
+    while (true) {
+        {
+            RpcMutexUniqueLock lock(mLock);
+            mCondition.wait(lock, [this] { return !mPending.empty() || mStopping; });
+            if (mPending.empty()) {
+                return;
+            }
+        }
+        writePending();
+    }
+}
+
+void TransactionRecorder::writePending() {
+    {
+        RpcMutexLockGuard _l(mLock);
+        std::swap(mPending, mWriting);
+    }
+
+    size_t writtenBytes = 0;
+    for (Pending& pending : mWriting) {
+        writtenBytes += pending.buffer.size();
+        if (mStatus != OK) {
+            continue;
+        }
+        sealChunks(&pending.buffer);
+        if (!WriteFully(mFd, pending.buffer.data(), pending.buffer.size())) {
+            ALOGE("Failed to write transaction to fd %d", mFd.get());
+            mStatus = UNKNOWN_ERROR;
+            continue;
+        }
+        if (mOffset == -1 || !mOptions.writeIndex) {
+            continue;
+        }
+
+        auto [it, inserted] = mInterfaceIndices.try_emplace(pending.interfaceName,
+                                                            mIndex.mInterfaceNames.size());
+        if (inserted) {
+            mIndex.mInterfaceNames.push_back(pending.interfaceName);
+        }
+        RecordingIndex::Entry& entry = mIndex.mEntries.emplace_back();
+        entry.offset = static_cast<uint64_t>(mOffset);
+        entry.timestampNs = pending.timestampNs;
+        entry.code = pending.code;
+        entry.interfaceIndex = it->second;
+        mOffset += static_cast<off_t>(pending.buffer.size());
+    }
+
+    RpcMutexLockGuard _l(mLock);
+    mPendingBytes -= writtenBytes;
+    for (Pending& pending : mWriting) {
+        if (mFree.size() < mOptions.maxFreeBuffers) {
+            mFree.push_back(std::move(pending));
+        }
+    }
+    mWriting.clear();
+}
+
+android::status_t TransactionRecorder::writeIndex() {
+    // Timestamps are wall clock time, so they may go backwards.
+    std::stable_sort(mIndex.mEntries.begin(), mIndex.mEntries.end(),
+                     [](const RecordingIndex::Entry& a, const RecordingIndex::Entry& b) {
+                         return a.timestampNs < b.timestampNs;
+                     });
+
+    std::vector<uint8_t> names;
+    for (const std::string& name : mIndex.mInterfaceNames) {
+        names.insert(names.end(), name.begin(), name.end());
+        names.push_back(0);
+    }
+    const size_t entriesSize = mIndex.mEntries.size() * sizeof(RecordingIndex::Entry);
+    if (names.size() > kMaxChunkDataSize || entriesSize > kMaxChunkDataSize) {
+        ALOGE("Index exceeds maximum chunk size");
+        return BAD_VALUE;
+    }
+    const IndexFooter footer = {.magic = kIndexMagic,
+                                .indexOffset = static_cast<uint64_t>(mOffset)};
+
+    std::vector<uint8_t> buffer;
+    appendChunk(&buffer, INDEX_INTERFACE_NAMES_CHUNK, names.size(), names.data());
+    appendChunk(&buffer, INDEX_ENTRIES_CHUNK, entriesSize, mIndex.mEntries.data());
+    appendChunk(&buffer, INDEX_FOOTER_CHUNK, sizeof(IndexFooter), &footer);
+    sealChunks(&buffer);
+    if (!WriteFully(mFd, buffer.data(), buffer.size())) {
+        ALOGE("Failed to write index to fd %d", mFd.get());
+        return UNKNOWN_ERROR;
+    }
+    return NO_ERROR;
+}
+
+android::status_t TransactionRecorder::finish() {
+    {
+        RpcMutexLockGuard _l(mLock);
+        if (mStopping) {
+            return mStatus;
+        }
+        mStopping = true;
+    }
+#ifndef BINDER_RPC_SINGLE_THREADED
+    mCondition.notify_one();
+    mThread.join();
+#endif
+
+    if (mStatus == OK && mOffset != -1 && mOptions.writeIndex) {
+        mStatus = writeIndex();
+    }
+    return mStatus;
+}
+
+size_t TransactionRecorder::getDroppedCount() const {
+    RpcMutexLockGuard _l(mLock);
+    return mDropped;
+}
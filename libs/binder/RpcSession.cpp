@@ -140,6 +140,33 @@ RpcSession::FileDescriptorTransportMode RpcSession::getFileDescriptorTransportMo
     return mFileDescriptorTransportMode;
 }
 
+void RpcSession::setOutgoingConnectionPolicy(OutgoingConnectionPolicy policy) {
+    RpcMutexLockGuard _l(mMutex);
+    LOG_ALWAYS_FATAL_IF(mStartedSetup,
+                        "Must set outgoing connection policy before setting up connections");
+    mOutgoingConnectionPolicy = policy;
+}
+
+RpcSession::OutgoingConnectionPolicy RpcSession::getOutgoingConnectionPolicy() {
+    return mOutgoingConnectionPolicy;
+}
+
+RpcSession::OutgoingConnectionStats RpcSession::getOutgoingConnectionStats() {
+    RpcMutexLockGuard _l(mMutex);
+    return mConnections.mOutgoingStats;
+}
+
+void RpcSession::setOnewayBatchDeadline(std::chrono::nanoseconds deadline) {
+    RpcMutexLockGuard _l(mMutex);
+    LOG_ALWAYS_FATAL_IF(mStartedSetup,
+                        "Must set oneway batch deadline before setting up connections");
+    mOnewayBatchDeadline = deadline;
+}
+
+std::chrono::nanoseconds RpcSession::getOnewayBatchDeadline() {
+    return mOnewayBatchDeadline;
+}
+
 status_t RpcSession::setupUnixDomainClient(const char* path) {
     return setupSocketClient(UnixSocketAddress(path));
 }
@@ -277,6 +304,14 @@ status_t RpcSession::transact(const sp<IBinder>& binder, uint32_t code, const Pa
                              sp<RpcSession>::fromExisting(this), reply, flags);
 }
 
+status_t RpcSession::flushOnewayTransactions() {
+    ExclusiveConnection connection;
+    status_t status = ExclusiveConnection::find(sp<RpcSession>::fromExisting(this),
+                                                ConnectionUse::CLIENT_ASYNC, &connection);
+    if (status != OK) return status;
+    return state()->flushOnewayBatch(connection.get(), sp<RpcSession>::fromExisting(this));
+}
+
 status_t RpcSession::sendDecStrong(const BpBinder* binder) {
     // target is 0 because this is used to free BpBinder objects
     return sendDecStrongToTarget(binder->getPrivateAccessor().rpcAddress(), 0 /*target*/);
@@ -893,16 +928,26 @@ status_t RpcSession::ExclusiveConnection::find(const sp<RpcSession>& session, Co
     uint64_t tid = binder::os::GetThreadId();
     RpcMutexUniqueLock _l(session->mMutex);
 
+    auto& outgoing = session->mConnections.mOutgoing;
+
     session->mConnections.mWaitingThreads++;
     while (true) {
         sp<RpcConnection> exclusive;
         sp<RpcConnection> available;
 
+        size_t outgoingHint = session->mConnections.mOutgoingOffset;
+        if (session->mOutgoingConnectionPolicy == OutgoingConnectionPolicy::THREAD_AFFINITY &&
+            outgoing.size() > 0) {
+            outgoingHint = tid % outgoing.size();
+        }
+
         // CHECK FOR DEDICATED CLIENT SOCKET
         //
         // A server/looper should always use a dedicated connection if available
-        findConnection(tid, &exclusive, &available, session->mConnections.mOutgoing,
-                       session->mConnections.mOutgoingOffset);
+        findConnection(tid, &exclusive, &available, outgoing, outgoingHint);
+        if (exclusive == nullptr && available != nullptr && available != outgoing[outgoingHint]) {
+            session->mConnections.mOutgoingStats.missedPreferred++;
+        }
 
         // WARNING: this assumes a server cannot request its client to send
         // a transaction, as mIncoming is excluded below.
@@ -971,6 +1016,7 @@ status_t RpcSession::ExclusiveConnection::find(const sp<RpcSession>& session, Co
         LOG_RPC_DETAIL("No available connections (have %zu clients and %zu servers). Waiting...",
                        session->mConnections.mOutgoing.size(),
                        session->mConnections.mIncoming.size());
+        session->mConnections.mOutgoingStats.waits++;
         session->mAvailableConnectionCv.wait(_l);
     }
     session->mConnections.mWaitingThreads--;
@@ -301,6 +301,10 @@ void RpcState::clear(RpcMutexUniqueLock nodeLock) {
 
     nodeLock.unlock();
     temp.clear(); // explicit
+
+    // the session is going away, so queued oneway transactions can't be sent
+    RpcMutexLockGuard _l(mOnewayBatchMutex);
+    mOnewayBatch.data.clear();
 }
 
 void RpcState::dumpLocked() {
@@ -588,6 +592,48 @@ status_t RpcState::transactAddress(const sp<RpcSession::RpcConnection>& connecti
             .parcelDataSize = static_cast<uint32_t>(data.dataSize()),
     };
 
+    iovec iovs[]{
+            {&command, sizeof(RpcWireHeader)},
+            {&transaction, sizeof(RpcWireTransaction)},
+            {const_cast<uint8_t*>(data.data()), data.dataSize()},
+            objectTableSpan.toIovec(),
+    };
+
+    bool hasFds = rpcFields->mFds != nullptr && !rpcFields->mFds->empty();
+    if ((flags & IBinder::FLAG_ONEWAY) && !hasFds &&
+        session->getOnewayBatchDeadline() > std::chrono::nanoseconds::zero()) {
+        return queueOnewayTransaction(connection, session, iovs, countof(iovs));
+    }
+
+    // Anything queued before this transaction must reach the other side first.
+    if (status_t status = flushOnewayBatch(connection, session); status != OK) return status;
+
+    if (status_t status = rpcSendDraining(connection, session, "transaction", iovs, countof(iovs),
+                                          rpcFields->mFds.get());
+        status != OK) {
+        // rpcSend calls shutdownAndWait, so all refcounts should be reset. If we ever tolerate
+        // errors here, then we may need to undo the binder-sent counts for the transaction as
+        // well as for the binder objects in the Parcel
+        return status;
+    }
+
+    if (flags & IBinder::FLAG_ONEWAY) {
+        LOG_RPC_DETAIL("Oneway command, so no longer waiting on RpcTransport %p",
+                       connection->rpcTransport.get());
+
+        // Do not wait on result.
+        return OK;
+    }
+
+    LOG_ALWAYS_FATAL_IF(reply == nullptr, "Reply parcel must be used for synchronous transaction.");
+
+    return waitForReply(connection, session, reply);
+}
+
+status_t RpcState::rpcSendDraining(
+        const sp<RpcSession::RpcConnection>& connection, const sp<RpcSession>& session,
+        const char* what, iovec* iovs, int niovs,
+        const std::vector<std::variant<unique_fd, borrowed_fd>>* ancillaryFds) {
     // Oneway calls have no sync point, so if many are sent before, whether this
     // is a twoway or oneway transaction, they may have filled up the socket.
     // So, make sure we drain them before polling
@@ -595,12 +641,6 @@ status_t RpcState::transactAddress(const sp<RpcSession::RpcConnection>& connecti
     constexpr size_t kWaitLogUs = 10000;
     size_t waitUs = 0;
 
-    iovec iovs[]{
-            {&command, sizeof(RpcWireHeader)},
-            {&transaction, sizeof(RpcWireTransaction)},
-            {const_cast<uint8_t*>(data.data()), data.dataSize()},
-            objectTableSpan.toIovec(),
-    };
     auto altPoll = [&] {
         if (waitUs > kWaitLogUs) {
             ALOGE("Cannot send command, trying to process pending refcounts. Waiting "
@@ -617,26 +657,74 @@ status_t RpcState::transactAddress(const sp<RpcSession::RpcConnection>& connecti
 
         return drainCommands(connection, session, CommandType::CONTROL_ONLY);
     };
-    if (status_t status = rpcSend(connection, session, "transaction", iovs, countof(iovs),
-                                  std::ref(altPoll), rpcFields->mFds.get());
-        status != OK) {
-        // rpcSend calls shutdownAndWait, so all refcounts should be reset. If we ever tolerate
-        // errors here, then we may need to undo the binder-sent counts for the transaction as
-        // well as for the binder objects in the Parcel
-        return status;
+    return rpcSend(connection, session, what, iovs, niovs, std::ref(altPoll), ancillaryFds);
+}
+
+status_t RpcState::queueOnewayTransaction(const sp<RpcSession::RpcConnection>& connection,
+                                          const sp<RpcSession>& session, iovec* iovs,
+                                          int niovs) {
+    // Keep batches well below the socket buffer size, so that writing one
+    // doesn't need to wait for the other side to start reading.
+    constexpr size_t kMaxOnewayBatchBytes = 32 * 1024;
+
+    bool shouldFlush;
+    {
+        RpcMutexLockGuard _l(mOnewayBatchMutex);
+        if (mOnewayBatch.data.empty()) {
+            mOnewayBatch.firstQueuedTime = std::chrono::steady_clock::now();
+        }
+        for (int i = 0; i < niovs; i++) {
+            const uint8_t* base = reinterpret_cast<const uint8_t*>(iovs[i].iov_base);
+            mOnewayBatch.data.insert(mOnewayBatch.data.end(), base, base + iovs[i].iov_len);
+        }
+        shouldFlush = mOnewayBatch.data.size() >= kMaxOnewayBatchBytes ||
+                std::chrono::steady_clock::now() - mOnewayBatch.firstQueuedTime >=
+                        session->getOnewayBatchDeadline();
     }
 
-    if (flags & IBinder::FLAG_ONEWAY) {
-        LOG_RPC_DETAIL("Oneway command, so no longer waiting on RpcTransport %p",
-                       connection->rpcTransport.get());
+    LOG_RPC_DETAIL("Queued oneway command on RpcTransport %p (flush: %d)",
+                   connection->rpcTransport.get(), shouldFlush);
 
-        // Do not wait on result.
-        return OK;
+    if (!shouldFlush) return OK;
+    return flushOnewayBatch(connection, session);
+}
+
+status_t RpcState::flushOnewayBatch(const sp<RpcSession::RpcConnection>& connection,
+                                    const sp<RpcSession>& session) {
+    // batching is disabled, so nothing is ever queued
+    if (session->getOnewayBatchDeadline() <= std::chrono::nanoseconds::zero()) return OK;
+
+    std::vector<uint8_t> data;
+    {
+        RpcMutexUniqueLock _l(mOnewayBatchMutex);
+        // This thread is already writing the batch, and is now sending a command
+        // while draining refcounts from the other side.
+        if (mOnewayBatch.flushingThread == rpc_this_thread::get_id()) return OK;
+
+        // Wait for an earlier batch to be completely written, so that callers can
+        // rely on everything queued before them having been sent.
+        mOnewayBatchCv.wait(_l, [&] { return !mOnewayBatch.flushingThread.has_value(); });
+        if (mOnewayBatch.data.empty()) return OK;
+
+        data = std::move(mOnewayBatch.data);
+        mOnewayBatch.data = {};
+        mOnewayBatch.flushingThread = rpc_this_thread::get_id();
     }
 
-    LOG_ALWAYS_FATAL_IF(reply == nullptr, "Reply parcel must be used for synchronous transaction.");
+    iovec iov{data.data(), data.size()};
+    status_t status = rpcSendDraining(connection, session, "oneway batch", &iov, 1, nullptr);
 
-    return waitForReply(connection, session, reply);
+    {
+        RpcMutexLockGuard _l(mOnewayBatchMutex);
+        mOnewayBatch.flushingThread.reset();
+        if (mOnewayBatch.data.empty()) {
+            // reuse the allocation for the next batch
+            data.clear();
+            mOnewayBatch.data = std::move(data);
+        }
+    }
+    mOnewayBatchCv.notify_all();
+    return status;
 }
 
 static void cleanup_reply_data(const uint8_t* data, size_t dataSize, const binder_size_t* objects,
@@ -755,6 +843,10 @@ status_t RpcState::sendDecStrongToTarget(const sp<RpcSession::RpcConnection>& co
         // LOCK ALREADY RELEASED
     }
 
+    // Queued oneway transactions may be to this binder, so they must be sent
+    // before the other side is allowed to drop it.
+    if (status_t status = flushOnewayBatch(connection, session); status != OK) return status;
+
     RpcWireHeader cmd = {
             .command = RPC_COMMAND_DEC_STRONG,
             .bodySize = sizeof(RpcDecStrong),
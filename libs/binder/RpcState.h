@@ -22,6 +22,7 @@
 #include <binder/RpcThreads.h>
 #include <binder/unique_fd.h>
 
+#include <chrono>
 #include <map>
 #include <optional>
 #include <queue>
@@ -113,6 +114,14 @@ public:
                                                  const sp<RpcSession>& session, uint64_t address,
                                                  size_t target);
 
+    /**
+     * Writes any oneway transactions queued by transactAddress when the
+     * session batches them (see RpcSession::setOnewayBatchDeadline). Returns
+     * once everything queued before the call has been sent.
+     */
+    [[nodiscard]] status_t flushOnewayBatch(const sp<RpcSession::RpcConnection>& connection,
+                                            const sp<RpcSession>& session);
+
     enum class CommandType {
         ANY,
         CONTROL_ONLY,
@@ -199,6 +208,14 @@ private:
                                   int niovs,
                                   std::vector<std::variant<binder::unique_fd, binder::borrowed_fd>>*
                                           ancillaryFds = nullptr);
+    // rpcSend, processing incoming refcounts while the socket is full.
+    [[nodiscard]] status_t rpcSendDraining(
+            const sp<RpcSession::RpcConnection>& connection, const sp<RpcSession>& session,
+            const char* what, iovec* iovs, int niovs,
+            const std::vector<std::variant<binder::unique_fd, binder::borrowed_fd>>* ancillaryFds);
+    [[nodiscard]] status_t queueOnewayTransaction(const sp<RpcSession::RpcConnection>& connection,
+                                                  const sp<RpcSession>& session, iovec* iovs,
+                                                  int niovs);
 
     [[nodiscard]] status_t waitForReply(const sp<RpcSession::RpcConnection>& connection,
                                         const sp<RpcSession>& session, Parcel* reply);
@@ -296,6 +313,18 @@ private:
     uint32_t mNextId = 0;
     // binders known by both sides of a session
     std::map<uint64_t, BinderNode> mNodeForAddress;
+
+    // Outgoing oneway transactions, already serialized as wire frames, which
+    // are written to the socket together.
+    struct OnewayBatch {
+        std::vector<uint8_t> data;
+        std::chrono::steady_clock::time_point firstQueuedTime;
+        // set while a thread is writing a batch (with the lock released)
+        std::optional<RpcMaybeThread::id> flushingThread;
+    };
+    RpcMutex mOnewayBatchMutex; // for mOnewayBatch
+    RpcConditionVariable mOnewayBatchCv;
+    OnewayBatch mOnewayBatch;
 };
 
 } // namespace android
@@ -30,7 +30,10 @@
 #include "RpcState.h"
 #include "Utils.h"
 
+#include <cstring>
+#include <mutex>
 #include <sstream>
+#include <vector>
 
 #define SHOULD_LOG_TLS_DETAIL false
 
@@ -301,8 +304,16 @@ public:
     bool isWaiting() override { return mSocket.isInPollingState(); };
 
 private:
+    // Every SSL_write() seals its data into at least one record, so iovs smaller than a record,
+    // such as the header and the body of a command, are copied together up to this size.
+    static constexpr size_t kMaxWriteBatchSize = SSL3_RT_MAX_PLAIN_LENGTH;
+
+    status_t writeFully(FdTrigger* fdTrigger, const uint8_t* buffer, size_t size,
+                        const std::optional<SmallFunction<status_t()>>& altPoll);
+
     android::RpcTransportFd mSocket;
     Ssl mSsl;
+    std::vector<uint8_t> mWriteBatch;
 };
 
 // Error code is errno.
@@ -339,6 +350,7 @@ status_t RpcTransportTls::interruptableWriteFully(
     if (fdTrigger->isTriggered()) return DEAD_OBJECT;
 
     size_t size = 0;
+    size_t batched = 0;
     for (int i = 0; i < niovs; i++) {
         const iovec& iov = iovs[i];
         if (iov.iov_len == 0) {
@@ -347,29 +359,64 @@ status_t RpcTransportTls::interruptableWriteFully(
         size += iov.iov_len;
 
         auto buffer = reinterpret_cast<const uint8_t*>(iov.iov_base);
-        const uint8_t* end = buffer + iov.iov_len;
-        while (buffer < end) {
-            size_t todo = std::min<size_t>(end - buffer, std::numeric_limits<int>::max());
-            auto [writeSize, errorQueue] = mSsl.call(SSL_write, buffer, todo);
-            if (writeSize > 0) {
-                buffer += writeSize;
-                errorQueue.clear();
-                continue;
+        if (niovs == 1 || iov.iov_len >= kMaxWriteBatchSize) {
+            if (batched > 0) {
+                if (status_t status = writeFully(fdTrigger, mWriteBatch.data(), batched, altPoll);
+                    status != OK) {
+                    return status;
+                }
+                batched = 0;
             }
-            // SSL_write() should never return 0 unless BIO_write were to return 0.
-            int sslError = mSsl.getError(writeSize);
-            // TODO(b/195788248): BIO should contain the FdTrigger, and send(2) / recv(2) should be
-            //   triggerablePoll()-ed. Then additionalEvent is no longer necessary.
-            status_t pollStatus = errorQueue.pollForSslError(mSocket, sslError, fdTrigger,
-                                                             "SSL_write", POLLIN, altPoll);
-            if (pollStatus != OK) return pollStatus;
-            // Do not advance buffer. Try SSL_write() again.
+            if (status_t status = writeFully(fdTrigger, buffer, iov.iov_len, altPoll);
+                status != OK) {
+                return status;
+            }
+            continue;
+        }
+        if (batched + iov.iov_len > kMaxWriteBatchSize) {
+            if (status_t status = writeFully(fdTrigger, mWriteBatch.data(), batched, altPoll);
+                status != OK) {
+                return status;
+            }
+            batched = 0;
+        }
+        mWriteBatch.resize(kMaxWriteBatchSize);
+        memcpy(mWriteBatch.data() + batched, buffer, iov.iov_len);
+        batched += iov.iov_len;
+    }
+    if (batched > 0) {
+        if (status_t status = writeFully(fdTrigger, mWriteBatch.data(), batched, altPoll);
+            status != OK) {
+            return status;
         }
     }
     LOG_TLS_DETAIL("TLS: Sent %zu bytes!", size);
     return OK;
 }
 
+status_t RpcTransportTls::writeFully(FdTrigger* fdTrigger, const uint8_t* buffer, size_t size,
+                                     const std::optional<SmallFunction<status_t()>>& altPoll) {
+    const uint8_t* end = buffer + size;
+    while (buffer < end) {
+        size_t todo = std::min<size_t>(end - buffer, std::numeric_limits<int>::max());
+        auto [writeSize, errorQueue] = mSsl.call(SSL_write, buffer, todo);
+        if (writeSize > 0) {
+            buffer += writeSize;
+            errorQueue.clear();
+            continue;
+        }
+        // SSL_write() should never return 0 unless BIO_write were to return 0.
+        int sslError = mSsl.getError(writeSize);
+        // TODO(b/195788248): BIO should contain the FdTrigger, and send(2) / recv(2) should be
+        //   triggerablePoll()-ed. Then additionalEvent is no longer necessary.
+        status_t pollStatus = errorQueue.pollForSslError(mSocket, sslError, fdTrigger,
+                                                         "SSL_write", POLLIN, altPoll);
+        if (pollStatus != OK) return pollStatus;
+        // Do not advance buffer. Try SSL_write() again.
+    }
+    return OK;
+}
+
 status_t RpcTransportTls::interruptableReadFully(
         FdTrigger* fdTrigger, iovec* iovs, int niovs,
         const std::optional<SmallFunction<status_t()>>& altPoll,
@@ -458,7 +505,13 @@ public:
     std::vector<uint8_t> getCertificate(RpcCertificateFormat) const override;
 
 protected:
+    // How long a session may be resumed for. Connections of a session are usually set up together,
+    // and the peer certificate is not verified again when a session is resumed.
+    static constexpr uint32_t kSessionTimeoutSeconds = 300;
+
     static ssl_verify_result_t sslCustomVerify(SSL* ssl, uint8_t* outAlert);
+    static RpcTransportCtxTls* fromSsl(const SSL* ssl);
+    virtual void configure(SSL_CTX* ctx) = 0;
     virtual void preHandshake(Ssl* ssl) const = 0;
     bssl::UniquePtr<SSL_CTX> mCtx;
     std::shared_ptr<RpcCertificateVerifier> mCertVerifier;
@@ -475,12 +528,7 @@ ssl_verify_result_t RpcTransportCtxTls::sslCustomVerify(SSL* ssl, uint8_t* outAl
     LOG_ALWAYS_FATAL_IF(outAlert == nullptr);
     const char* logPrefix = SSL_is_server(ssl) ? "Server" : "Client";
 
-    auto ctx = SSL_get_SSL_CTX(ssl); // Does not set error queue
-    LOG_ALWAYS_FATAL_IF(ctx == nullptr);
-    // void* -> RpcTransportCtxTls*
-    auto rpcTransportCtxTls = reinterpret_cast<RpcTransportCtxTls*>(SSL_CTX_get_app_data(ctx));
-    LOG_ALWAYS_FATAL_IF(rpcTransportCtxTls == nullptr);
-
+    auto rpcTransportCtxTls = fromSsl(ssl);
     status_t verifyStatus = rpcTransportCtxTls->mCertVerifier->verify(ssl, outAlert);
     if (verifyStatus == OK) {
         return ssl_verify_ok;
@@ -490,6 +538,15 @@ ssl_verify_result_t RpcTransportCtxTls::sslCustomVerify(SSL* ssl, uint8_t* outAl
     return ssl_verify_invalid;
 }
 
+RpcTransportCtxTls* RpcTransportCtxTls::fromSsl(const SSL* ssl) {
+    auto ctx = SSL_get_SSL_CTX(ssl); // Does not set error queue
+    LOG_ALWAYS_FATAL_IF(ctx == nullptr);
+    // void* -> RpcTransportCtxTls*
+    auto rpcTransportCtxTls = reinterpret_cast<RpcTransportCtxTls*>(SSL_CTX_get_app_data(ctx));
+    LOG_ALWAYS_FATAL_IF(rpcTransportCtxTls == nullptr);
+    return rpcTransportCtxTls;
+}
+
 // Common implementation for creating server and client contexts. The child class, |Impl|, is
 // provided as a template argument so that this function can initialize an |Impl| object.
 template <typename Impl, typename>
@@ -516,9 +573,14 @@ std::unique_ptr<RpcTransportCtxTls> RpcTransportCtxTls::create(
         SSL_CTX_set_info_callback(ctx.get(), sslDebugLog);
     }
 
+    // Let the connections of a session resume the TLS session of the first one with a ticket,
+    // rather than each doing a full handshake.
+    SSL_CTX_set_timeout(ctx.get(), kSessionTimeoutSeconds);
+
     auto ret = std::make_unique<Impl>();
     // RpcTransportCtxTls* -> void*
     TEST_AND_RETURN(nullptr, SSL_CTX_set_app_data(ctx.get(), reinterpret_cast<void*>(ret.get())));
+    ret->configure(ctx.get());
     ret->mCtx = std::move(ctx);
     ret->mCertVerifier = std::move(verifier);
     return ret;
@@ -537,16 +599,47 @@ std::unique_ptr<RpcTransport> RpcTransportCtxTls::newTransport(android::RpcTrans
 
 class RpcTransportCtxTlsServer : public RpcTransportCtxTls {
 protected:
+    void configure(SSL_CTX* ctx) override {
+        // Sessions of a client whose certificate was verified can only be resumed with a session
+        // ID context. Tickets are encrypted with keys of this context, so they are only accepted
+        // by the server that issued them.
+        static constexpr uint8_t kSessionIdContext[] = "binder";
+        LOG_ALWAYS_FATAL_IF(!SSL_CTX_set_session_id_context(ctx, kSessionIdContext,
+                                                            sizeof(kSessionIdContext)));
+    }
     void preHandshake(Ssl* ssl) const override {
         ssl->call(SSL_set_accept_state).errorQueue.clear();
     }
 };
 
+// A client context is only used by one RpcSession, so the connections of the session share the
+// last session ticket that the server sent.
 class RpcTransportCtxTlsClient : public RpcTransportCtxTls {
 protected:
+    void configure(SSL_CTX* ctx) override {
+        SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_CLIENT);
+        SSL_CTX_sess_set_new_cb(ctx, onNewSession);
+    }
     void preHandshake(Ssl* ssl) const override {
         ssl->call(SSL_set_connect_state).errorQueue.clear();
+        std::lock_guard lock(mSessionMutex);
+        if (mSession != nullptr) {
+            ssl->call(SSL_set_session, mSession.get()).errorQueue.clear();
+        }
     }
+
+private:
+    // Takes ownership of the session.
+    static int onNewSession(SSL* ssl, SSL_SESSION* session) {
+        auto client = static_cast<RpcTransportCtxTlsClient*>(fromSsl(ssl));
+        std::lock_guard lock(client->mSessionMutex);
+        client->mSession.reset(session);
+        LOG_TLS_DETAIL("Client: Received session ticket");
+        return 1;
+    }
+
+    mutable std::mutex mSessionMutex; // for below
+    bssl::UniquePtr<SSL_SESSION> mSession;
 };
 
 std::unique_ptr<RpcTransportCtx> RpcTransportCtxFactoryTls::newServerCtx() const {
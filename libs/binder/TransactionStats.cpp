@@ -0,0 +1,369 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "TransactionStats"
+
+#include <binder/IBinder.h>
+#include <binder/RpcThreads.h>
+#include <binder/TransactionStats.h>
+#include <utils/String8.h>
+
+#include <inttypes.h>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <unordered_map>
+
+namespace android::binder::debug {
+
+namespace {
+
+using std::chrono::nanoseconds;
+
+// Counters for one interface and code on one thread. Only the owning thread
+// increments them, but snapshot() and reset() access them from other
+// threads.
+struct Bucket {
+    Bucket(TransactionStats::Direction direction, std::u16string_view descriptor, uint32_t code)
+          : direction(direction), descriptor(descriptor), code(code) {}
+
+    bool matches(TransactionStats::Direction d, std::u16string_view desc, uint32_t c) const {
+        return direction == d && code == c && descriptor == desc;
+    }
+
+    const TransactionStats::Direction direction;
+    const std::u16string descriptor;
+    const uint32_t code;
+
+    std::atomic_uint64_t count = 0;
+    std::atomic_uint64_t totalLatencyNs = 0;
+    std::atomic_uint64_t maxLatencyNs = 0;
+    std::array<std::atomic_uint64_t, TransactionStats::kLatencyBuckets> latency = {};
+    std::array<std::atomic_uint64_t, TransactionStats::kSizeBuckets> dataSize = {};
+    std::array<std::atomic_uint64_t, TransactionStats::kSizeBuckets> replySize = {};
+};
+
+// The buckets of one thread, by hash of direction, descriptor, and code.
+struct ThreadBuckets {
+    Bucket& get(TransactionStats::Direction direction, std::u16string_view descriptor,
+                uint32_t code);
+
+    // Guards changes to `buckets` against other threads reading it. The owning
+    // thread reads without it.
+    RpcMutex lock;
+    std::unordered_map<size_t, std::vector<std::unique_ptr<Bucket>>> buckets;
+};
+
+struct Registry {
+    RpcMutex lock;
+    std::vector<ThreadBuckets*> threads;
+    // Buckets of threads which have exited, merged here so they are not lost.
+    ThreadBuckets exited;
+};
+
+// Registers the buckets of a thread for as long as it runs.
+struct ThreadRegistration {
+    ThreadRegistration();
+    ~ThreadRegistration();
+
+    ThreadBuckets buckets;
+};
+
+std::atomic_bool gEnabled = false;
+
+Registry& registry() {
+    [[clang::no_destroy]] static Registry sRegistry;
+    return sRegistry;
+}
+
+size_t hashKey(TransactionStats::Direction direction, std::u16string_view descriptor,
+               uint32_t code) {
+    size_t hash = std::hash<std::u16string_view>{}(descriptor);
+    hash ^= (static_cast<size_t>(code) << 1 | static_cast<size_t>(direction)) +
+            0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+    return hash;
+}
+
+// Only called by the owning thread, or with the registry lock held for
+// `Registry::exited`.
+Bucket& ThreadBuckets::get(TransactionStats::Direction direction, std::u16string_view descriptor,
+                           uint32_t code) {
+    const size_t hash = hashKey(direction, descriptor, code);
+    if (auto it = buckets.find(hash); it != buckets.end()) {
+        for (const auto& bucket : it->second) {
+            if (bucket->matches(direction, descriptor, code)) return *bucket;
+        }
+    }
+
+    auto bucket = std::make_unique<Bucket>(direction, descriptor, code);
+    Bucket& ref = *bucket;
+    RpcMutexLockGuard _l(lock);
+    buckets[hash].push_back(std::move(bucket));
+    return ref;
+}
+
+void add(std::atomic_uint64_t& counter, uint64_t value) {
+    counter.fetch_add(value, std::memory_order_relaxed);
+}
+
+void merge(Bucket& to, const Bucket& from) {
+    add(to.count, from.count.load(std::memory_order_relaxed));
+    add(to.totalLatencyNs, from.totalLatencyNs.load(std::memory_order_relaxed));
+    to.maxLatencyNs.store(std::max(to.maxLatencyNs.load(std::memory_order_relaxed),
+                                   from.maxLatencyNs.load(std::memory_order_relaxed)),
+                          std::memory_order_relaxed);
+    for (size_t i = 0; i < to.latency.size(); i++) {
+        add(to.latency[i], from.latency[i].load(std::memory_order_relaxed));
+    }
+    for (size_t i = 0; i < to.dataSize.size(); i++) {
+        add(to.dataSize[i], from.dataSize[i].load(std::memory_order_relaxed));
+        add(to.replySize[i], from.replySize[i].load(std::memory_order_relaxed));
+    }
+}
+
+ThreadRegistration::ThreadRegistration() {
+    Registry& r = registry();
+    RpcMutexLockGuard _l(r.lock);
+    r.threads.push_back(&buckets);
+}
+
+ThreadRegistration::~ThreadRegistration() {
+    Registry& r = registry();
+    RpcMutexLockGuard _l(r.lock);
+    r.threads.erase(std::find(r.threads.begin(), r.threads.end(), &buckets));
+    for (const auto& [hash, list] : buckets.buckets) {
+        for (const auto& bucket : list) {
+            merge(r.exited.get(bucket->direction, bucket->descriptor, bucket->code), *bucket);
+        }
+    }
+}
+
+ThreadBuckets& threadBuckets() {
+#ifndef BINDER_RPC_SINGLE_THREADED
+    thread_local ThreadRegistration tRegistration;
+#else
+    static ThreadRegistration tRegistration;
+#endif
+    return tRegistration.buckets;
+}
+
+size_t latencyBucket(nanoseconds latency) {
+    const uint64_t us = std::max<int64_t>(latency.count(), 0) / 1000;
+    return std::min<size_t>(std::bit_width(us), TransactionStats::kLatencyBuckets - 1);
+}
+
+size_t sizeBucket(size_t size) {
+    return std::min<size_t>(std::bit_width(size >> 6), TransactionStats::kSizeBuckets - 1);
+}
+
+std::u16string_view interfaceToken(uint32_t code, const Parcel& data) {
+    if (code < IBinder::FIRST_CALL_TRANSACTION || code > IBinder::LAST_CALL_TRANSACTION) {
+        return {};
+    }
+
+    // Kernel binder transactions start with the strict mode policy, the work
+    // source, and the header, see Parcel::writeInterfaceToken.
+    const size_t position = data.dataPosition();
+    data.setDataPosition(data.isForRpc() ? 0 : 3 * sizeof(int32_t));
+    size_t length = 0;
+    const char16_t* token = data.readString16Inplace(&length);
+    data.setDataPosition(position);
+    return token ? std::u16string_view(token, length) : std::u16string_view();
+}
+
+// Returns the index of the bucket holding the given percentile.
+template <size_t N>
+size_t percentileBucket(const std::array<uint64_t, N>& histogram, uint64_t count, int percentile) {
+    const uint64_t rank = (count * percentile + 99) / 100;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < N; i++) {
+        seen += histogram[i];
+        if (seen >= rank) return i;
+    }
+    return N - 1;
+}
+
+void appendSizePercentiles(String8* out, const char* name,
+                           const std::array<uint64_t, TransactionStats::kSizeBuckets>& histogram,
+                           uint64_t count) {
+    out->appendFormat(" %s", name);
+    for (int percentile : {50, 99}) {
+        const size_t bucket = percentileBucket(histogram, count, percentile);
+        if (bucket == TransactionStats::kSizeBuckets - 1) {
+            out->appendFormat(" p%d>=%zu", percentile, size_t{1} << (bucket + 5));
+        } else {
+            out->appendFormat(" p%d<%zu", percentile, size_t{1} << (bucket + 6));
+        }
+    }
+}
+
+} // namespace
+
+void TransactionStats::setEnabled(bool enabled) {
+    gEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool TransactionStats::isEnabled() {
+    return gEnabled.load(std::memory_order_relaxed);
+}
+
+void TransactionStats::record(Direction direction, uint32_t code, const Parcel& data,
+                              const Parcel* reply, nanoseconds latency) {
+    record(direction, interfaceToken(code, data), code, data.dataSize(),
+           reply ? reply->dataSize() : 0, latency);
+}
+
+void TransactionStats::record(Direction direction, std::u16string_view descriptor, uint32_t code,
+                              size_t dataSize, size_t replySize, nanoseconds latency) {
+    Bucket& bucket = threadBuckets().get(direction, descriptor, code);
+    const uint64_t latencyNs = std::max<int64_t>(latency.count(), 0);
+
+    add(bucket.count, 1);
+    add(bucket.totalLatencyNs, latencyNs);
+    if (latencyNs > bucket.maxLatencyNs.load(std::memory_order_relaxed)) {
+        bucket.maxLatencyNs.store(latencyNs, std::memory_order_relaxed);
+    }
+    add(bucket.latency[latencyBucket(latency)], 1);
+    add(bucket.dataSize[sizeBucket(dataSize)], 1);
+    add(bucket.replySize[sizeBucket(replySize)], 1);
+}
+
+void TransactionStats::reset() {
+    auto clear = [](ThreadBuckets& thread) {
+        RpcMutexLockGuard _l(thread.lock);
+        for (const auto& [hash, list] : thread.buckets) {
+            for (const auto& bucket : list) {
+                bucket->count = 0;
+                bucket->totalLatencyNs = 0;
+                bucket->maxLatencyNs = 0;
+                for (auto& counter : bucket->latency) counter = 0;
+                for (auto& counter : bucket->dataSize) counter = 0;
+                for (auto& counter : bucket->replySize) counter = 0;
+            }
+        }
+    };
+
+    Registry& r = registry();
+    RpcMutexLockGuard _l(r.lock);
+    for (ThreadBuckets* thread : r.threads) clear(*thread);
+    clear(r.exited);
+}
+
+std::vector<TransactionStats::Entry> TransactionStats::snapshot() {
+    using Key = std::tuple<Direction, std::u16string, uint32_t>;
+    std::map<Key, Entry> merged;
+
+    auto collect = [&merged](ThreadBuckets& thread) {
+        RpcMutexLockGuard _l(thread.lock);
+        for (const auto& [hash, list] : thread.buckets) {
+            for (const auto& bucket : list) {
+                const uint64_t count = bucket->count.load(std::memory_order_relaxed);
+                if (count == 0) continue;
+
+                auto [it, inserted] =
+                        merged.try_emplace(Key{bucket->direction, bucket->descriptor, bucket->code});
+                Entry& entry = it->second;
+                if (inserted) {
+                    entry.direction = bucket->direction;
+                    entry.descriptor = bucket->descriptor;
+                    entry.code = bucket->code;
+                }
+                entry.count += count;
+                entry.totalLatency += nanoseconds(bucket->totalLatencyNs.load());
+                entry.maxLatency =
+                        std::max(entry.maxLatency, nanoseconds(bucket->maxLatencyNs.load()));
+                for (size_t i = 0; i < kLatencyBuckets; i++) {
+                    entry.latency[i] += bucket->latency[i].load(std::memory_order_relaxed);
+                }
+                for (size_t i = 0; i < kSizeBuckets; i++) {
+                    entry.dataSize[i] += bucket->dataSize[i].load(std::memory_order_relaxed);
+                    entry.replySize[i] += bucket->replySize[i].load(std::memory_order_relaxed);
+                }
+            }
+        }
+    };
+
+    {
+        Registry& r = registry();
+        RpcMutexLockGuard _l(r.lock);
+        for (ThreadBuckets* thread : r.threads) collect(*thread);
+        collect(r.exited);
+    }
+
+    std::vector<Entry> entries;
+    entries.reserve(merged.size());
+    for (auto& [key, entry] : merged) entries.push_back(std::move(entry));
+    return entries;
+}
+
+std::string TransactionStats::dump() {
+    String8 out;
+    out.appendFormat("Binder transaction stats (%s):\n",
+                     isEnabled() ? "recording" : "not recording");
+    for (const Entry& entry : snapshot()) {
+        const String8 descriptor(entry.descriptor.data(), entry.descriptor.size());
+        out.appendFormat("  %s %s code %" PRIu32 ": count=%" PRIu64,
+                         entry.direction == Direction::INCOMING ? "incoming" : "outgoing",
+                         descriptor.empty() ? "<no interface>" : descriptor.c_str(), entry.code,
+                         entry.count);
+
+        using std::chrono::microseconds;
+        out.appendFormat(" latency(us) mean=%" PRId64 " max=%" PRId64,
+                         std::chrono::duration_cast<microseconds>(entry.totalLatency).count() /
+                                 static_cast<int64_t>(entry.count),
+                         std::chrono::duration_cast<microseconds>(entry.maxLatency).count());
+        for (int percentile : {50, 90, 99}) {
+            const size_t bucket = percentileBucket(entry.latency, entry.count, percentile);
+            if (bucket == kLatencyBuckets - 1) {
+                out.appendFormat(" p%d>=%zu", percentile, size_t{1} << (bucket - 1));
+            } else {
+                out.appendFormat(" p%d<%zu", percentile, size_t{1} << bucket);
+            }
+        }
+
+        appendSizePercentiles(&out, "data(bytes)", entry.dataSize, entry.count);
+        appendSizePercentiles(&out, "reply(bytes)", entry.replySize, entry.count);
+        out.append("\n");
+    }
+    return std::string(out.c_str(), out.size());
+}
+
+status_t TransactionStats::handleTransaction(const Parcel& data, Parcel* reply) {
+    int32_t command;
+    if (status_t status = data.readInt32(&command); status != OK) return status;
+
+    switch (command) {
+        case DUMP:
+            if (reply == nullptr) return BAD_VALUE;
+            return reply->writeUtf8AsUtf16(dump());
+        case START:
+            setEnabled(true);
+            return OK;
+        case STOP:
+            setEnabled(false);
+            return OK;
+        case RESET:
+            reset();
+            return OK;
+        default:
+            return BAD_VALUE;
+    }
+}
+
+} // namespace android::binder::debug
@@ -152,6 +152,37 @@ public:
     LIBBINDER_EXPORTED void flushCommands();
     LIBBINDER_EXPORTED bool flushIfNeeded();
 
+    // Opens a transaction batch on this thread. Until the matching
+    // endTransactionBatch(), oneway transactions which carry no binder objects
+    // or file descriptors, along with refcount and BC_FREE_BUFFER commands, are
+    // only queued in this thread's out buffer instead of each being written to
+    // the driver with its own ioctl. Any other transaction made while a batch
+    // is open first submits what has been queued so far, so ordering is
+    // preserved. Batches may be nested; only the outermost one submits.
+    LIBBINDER_EXPORTED void beginTransactionBatch();
+    // Closes a transaction batch. When this closes the outermost batch, all
+    // queued commands are submitted to the driver. Returns the first error
+    // the driver reported for a batched transaction, or NO_ERROR.
+    LIBBINDER_EXPORTED status_t endTransactionBatch();
+
+    // Usage:
+    //     {
+    //         IPCThreadState::ScopedTransactionBatch batch;
+    //         for (...) binder->transact(code, data, nullptr, IBinder::FLAG_ONEWAY);
+    //     }
+    class ScopedTransactionBatch {
+    public:
+        ScopedTransactionBatch() : mState(IPCThreadState::self()) {
+            mState->beginTransactionBatch();
+        }
+        ~ScopedTransactionBatch() { (void)mState->endTransactionBatch(); }
+        ScopedTransactionBatch(const ScopedTransactionBatch&) = delete;
+        ScopedTransactionBatch& operator=(const ScopedTransactionBatch&) = delete;
+
+    private:
+        IPCThreadState* const mState;
+    };
+
     // Adds the current thread into the binder threadpool.
     //
     // This is in addition to any threads which are started
@@ -209,15 +240,28 @@ public:
     LIBBINDER_EXPORTED static const int32_t kUnsetWorkSource = -1;
 
 private:
+    friend class PoolThread;
+
     IPCThreadState();
     ~IPCThreadState();
 
+    // Like joinThreadPool, for threads which ProcessState started and which
+    // exit when idle, see ProcessState::setThreadPoolIdleTimeout.
+    void joinPooledThread(bool kernelRequested);
+    void joinThreadPoolImpl(bool isMain, bool registerLooper, bool exitWhenIdle);
+    // Waits for a command for up to the idle timeout. Returns whether none came
+    // and the thread was retired from the threadpool.
+    bool waitForCommandOrRetire();
+
     [[nodiscard]] status_t sendReply(const Parcel& reply, uint32_t flags);
     [[nodiscard]] status_t waitForResponse(Parcel* reply, status_t* acquireResult = nullptr);
     [[nodiscard]] status_t talkWithDriver(bool doReceive = true);
     [[nodiscard]] status_t writeTransactionData(int32_t cmd, uint32_t binderFlags, int32_t handle,
                                                 uint32_t code, const Parcel& data,
                                                 status_t* statusBuffer);
+    [[nodiscard]] status_t queueBatchedTransaction(int32_t handle, uint32_t code,
+                                                   const Parcel& data, uint32_t flags);
+    [[nodiscard]] status_t submitTransactionBatch();
     [[nodiscard]] status_t getAndExecuteCommand();
     [[nodiscard]] status_t executeCommand(int32_t command);
     void processPendingDerefs();
@@ -254,6 +298,13 @@ private:
             int32_t             mStrictModePolicy;
             int32_t             mLastTransactionBinderFlags;
             CallRestriction     mCallRestriction;
+            // Nesting depth of open transaction batches on this thread.
+            size_t mTransactionBatchDepth;
+            // Copies of the payloads of the oneway transactions queued in
+            // mOut, which the driver reads when the batch is submitted.
+            std::vector<std::vector<uint8_t>> mBatchedTransactionData;
+            size_t mBatchedTransactionBytes;
+            status_t mTransactionBatchError;
 };
 
 } // namespace android
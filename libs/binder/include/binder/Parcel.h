@@ -21,9 +21,13 @@
 #include <map> // for legacy reasons
 #include <optional>
 #include <string>
+#include <string_view>
 #include <type_traits>
 #include <variant>
 #include <vector>
+#if __cplusplus >= 202002L
+#include <span>
+#endif
 
 #include <binder/unique_fd.h>
 #ifndef BINDER_DISABLE_NATIVE_HANDLE
@@ -445,6 +449,10 @@ public:
     LIBBINDER_EXPORTED status_t readString16(std::unique_ptr<String16>* pArg) const
             __attribute__((deprecated("use std::optional version instead")));
     LIBBINDER_EXPORTED const char16_t* readString16Inplace(size_t* outLen) const;
+    // Like readString16, but returns a view into the Parcel's data rather than a copy. The view is
+    // only valid until the Parcel is modified or destroyed.
+    LIBBINDER_EXPORTED status_t readString16View(std::u16string_view* val) const;
+    LIBBINDER_EXPORTED status_t readString16View(std::optional<std::u16string_view>* val) const;
     LIBBINDER_EXPORTED sp<IBinder> readStrongBinder() const;
     LIBBINDER_EXPORTED status_t readStrongBinder(sp<IBinder>* val) const;
     LIBBINDER_EXPORTED status_t readNullableStrongBinder(sp<IBinder>* val) const;
@@ -533,6 +541,16 @@ public:
     LIBBINDER_EXPORTED status_t readInt32Vector(std::unique_ptr<std::vector<int32_t>>* val) const
             __attribute__((deprecated("use std::optional version instead")));
     LIBBINDER_EXPORTED status_t readInt32Vector(std::vector<int32_t>* val) const;
+#if __cplusplus >= 202002L
+    // Like readByteVector and readInt32Vector, but return a span of the Parcel's data rather than
+    // a copy. The span is only valid until the Parcel is modified or destroyed.
+    LIBBINDER_EXPORTED status_t readByteSpan(std::span<const int8_t>* val) const;
+    LIBBINDER_EXPORTED status_t readByteSpan(std::optional<std::span<const int8_t>>* val) const;
+    LIBBINDER_EXPORTED status_t readByteSpan(std::span<const uint8_t>* val) const;
+    LIBBINDER_EXPORTED status_t readByteSpan(std::optional<std::span<const uint8_t>>* val) const;
+    LIBBINDER_EXPORTED status_t readInt32Span(std::span<const int32_t>* val) const;
+    LIBBINDER_EXPORTED status_t readInt32Span(std::optional<std::span<const int32_t>>* val) const;
+#endif
     LIBBINDER_EXPORTED status_t readInt64Vector(std::optional<std::vector<int64_t>>* val) const;
     LIBBINDER_EXPORTED status_t readInt64Vector(std::unique_ptr<std::vector<int64_t>>* val) const
             __attribute__((deprecated("use std::optional version instead")));
@@ -641,6 +659,12 @@ public:
     LIBBINDER_EXPORTED static size_t getGlobalAllocSize();
     LIBBINDER_EXPORTED static size_t getGlobalAllocCount();
 
+    // Opt in to keeping a few recently freed data buffers on the calling
+    // thread, and reusing them for new Parcels created on it. This avoids
+    // allocations for threads which repeatedly make transactions of similar
+    // sizes. Disabling this frees any cached buffers.
+    LIBBINDER_EXPORTED static void setThreadBufferCacheEnabled(bool enabled);
+
     LIBBINDER_EXPORTED bool replaceCallingWorkSourceUid(uid_t uid);
     // Returns the work source provided by the caller. This can only be trusted for trusted calling
     // uid.
@@ -940,6 +964,11 @@ private:
     // This fixed as -1 by contract, do not change.
     static constexpr int32_t kNullVectorSize = -1;
 
+#if __cplusplus >= 202002L
+    template <typename T>
+    status_t readSpan(std::optional<std::span<const T>>* val) const;
+#endif
+
     // --- readData and writeData methods.
     // We choose a mixture of function and template overloads to improve code readability.
     // TODO: Consider C++20 concepts when they become available.
@@ -17,6 +17,7 @@
 #pragma once
 
 #include <map>
+#include <memory>
 #include <set>
 #include <vector>
 
@@ -42,6 +43,20 @@ public:
     status_t writeToParcel(Parcel* parcel) const override;
     status_t readFromParcel(const Parcel* parcel) override;
 
+    /*
+     * Like readFromParcel, but only reads the keys, and keeps the encoded values to decode each
+     * of them when it is read. This saves decoding and allocating the values of large bundles of
+     * which the receiver only reads a few keys. A value is decoded again each time it is read,
+     * and written back to a parcel as is, without being decoded.
+     */
+    status_t readFromParcelLazily(const Parcel* parcel);
+
+    /*
+     * Makes readFromParcel read lazily in this process, e.g. for the bundles that AIDL interfaces
+     * read. Off by default.
+     */
+    static void setReadLazily(bool lazy);
+
     bool empty() const;
     size_t size() const;
     size_t erase(const String16& key);
@@ -94,14 +109,7 @@ public:
     std::set<String16> getPersistableBundleKeys() const;
 
     friend bool operator==(const PersistableBundle& lhs, const PersistableBundle& rhs) {
-        return (lhs.mBoolMap == rhs.mBoolMap && lhs.mIntMap == rhs.mIntMap &&
-                lhs.mLongMap == rhs.mLongMap && lhs.mDoubleMap == rhs.mDoubleMap &&
-                lhs.mStringMap == rhs.mStringMap && lhs.mBoolVectorMap == rhs.mBoolVectorMap &&
-                lhs.mIntVectorMap == rhs.mIntVectorMap &&
-                lhs.mLongVectorMap == rhs.mLongVectorMap &&
-                lhs.mDoubleVectorMap == rhs.mDoubleVectorMap &&
-                lhs.mStringVectorMap == rhs.mStringVectorMap &&
-                lhs.mPersistableBundleMap == rhs.mPersistableBundleMap);
+        return lhs.equals(rhs);
     }
 
     friend bool operator!=(const PersistableBundle& lhs, const PersistableBundle& rhs) {
@@ -112,6 +120,28 @@ private:
     status_t writeToParcelInner(Parcel* parcel) const;
     status_t readFromParcelInner(const Parcel* parcel, size_t length);
 
+    // An entry read by readFromParcelLazily, at offsets into LazyEntries::data.
+    struct LazyEntry {
+        int32_t type;
+        // The encoded key, type and value.
+        size_t entryOffset;
+        size_t entrySize;
+        // The encoded value alone.
+        size_t valueOffset;
+    };
+    struct LazyEntries {
+        std::vector<uint8_t> data;
+        std::map<String16, LazyEntry> index;
+    };
+
+    bool equals(const PersistableBundle& other) const;
+    // Returns a copy of this bundle with all lazy entries decoded.
+    PersistableBundle decoded() const;
+    const LazyEntry* findLazyEntry(const String16& key) const;
+    template <typename T>
+    bool getLazyValue(const String16& key, int32_t type, T* out) const;
+    void addLazyKeys(int32_t type, std::set<String16>* keys) const;
+
     std::map<String16, bool> mBoolMap;
     std::map<String16, int32_t> mIntMap;
     std::map<String16, int64_t> mLongMap;
@@ -123,6 +153,11 @@ private:
     std::map<String16, std::vector<double>> mDoubleVectorMap;
     std::map<String16, std::vector<String16>> mStringVectorMap;
     std::map<String16, PersistableBundle> mPersistableBundleMap;
+
+    // Entries read by readFromParcelLazily, which copies share as they are never modified.
+    std::shared_ptr<const LazyEntries> mLazyEntries;
+    // Keys of lazy entries which were since erased or replaced.
+    std::set<String16> mErasedLazyKeys;
 };
 
 }  // namespace os
@@ -66,6 +66,34 @@ public:
     // threads started by 'startThreadPool' or 'joinRpcThreadpool'.
     LIBBINDER_EXPORTED status_t setThreadPoolMaxThreadCount(size_t maxThreads);
 
+    // Lets the threadpool shrink and grow with demand. By default, threads
+    // started for the threadpool never exit.
+    //
+    // Once set, threads started for the threadpool exit after being idle for
+    // 'idleTimeout', as long as more than 'minThreads' threads remain in the
+    // threadpool. Threads started by 'startThreadPool' or joining through
+    // 'joinThreadPool' never exit. When every thread in the threadpool is
+    // busy and the kernel will not start any more (it does not replace the
+    // threads which exited), a thread is started ahead of the next command,
+    // up to 'maxThreads' from setThreadPoolMaxThreadCount.
+    //
+    // A zero 'idleTimeout' restores the default.
+    LIBBINDER_EXPORTED void setThreadPoolIdleTimeout(size_t minThreads,
+                                                     std::chrono::milliseconds idleTimeout);
+
+    struct ThreadPoolStats {
+        // Threads started for the threadpool, by the kernel or ahead of demand.
+        size_t spawnedThreads;
+        // Threads started for the threadpool which have since exited.
+        size_t exitedThreads;
+        // Most threads in the threadpool at once.
+        size_t maxCurrentThreads;
+        // Most threads executing commands at once.
+        size_t maxExecutingThreads;
+    };
+    // Returns counters for sizing the threadpool.
+    LIBBINDER_EXPORTED ThreadPoolStats getThreadPoolStats() const;
+
     // Libraries should not call this, as processes should configure
     // threadpools themselves. Should be called in the main function
     // directly before any code executes or joins the threadpool.
@@ -155,6 +183,13 @@ private:
     ProcessState& operator=(const ProcessState& o);
     String8 makeBinderThreadName();
 
+    // Starts a thread when none in the threadpool are idle, if allowed by
+    // setThreadPoolIdleTimeout.
+    void spawnPooledThreadAheadOfDemand();
+    // Removes an idle thread from mCurrentThreads unless that would take it
+    // to the setThreadPoolIdleTimeout floor. Returns whether it was removed.
+    bool retireIdleThread();
+
     struct handle_entry {
         IBinder* binder;
         RefBase::weakref_type* refs;
@@ -182,6 +217,20 @@ private:
     // Time when thread pool was emptied
     std::atomic<std::chrono::steady_clock::time_point> mStarvationStartTime;
 
+    // Idle threads exit when this is non-zero, see setThreadPoolIdleTimeout.
+    std::atomic<std::chrono::milliseconds> mThreadPoolIdleTimeout;
+    std::atomic_size_t mThreadPoolMinThreads;
+    // Number of threads started because of BR_SPAWN_LOOPER.
+    std::atomic_size_t mKernelRequestedThreads;
+    // Current number of threads which may exit when idle.
+    std::atomic_size_t mPooledThreads;
+
+    // See ThreadPoolStats.
+    std::atomic_size_t mSpawnedThreads;
+    std::atomic_size_t mExitedThreads;
+    std::atomic_size_t mMaxCurrentThreads;
+    std::atomic_size_t mMaxExecutingThreads;
+
     static constexpr auto never = &std::chrono::steady_clock::time_point::min;
 
     mutable std::mutex mLock; // protects everything below.
@@ -18,8 +18,12 @@
 
 #include <binder/Common.h>
 #include <binder/Parcel.h>
+#include <binder/RpcThreads.h>
 #include <binder/unique_fd.h>
 #include <mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 
 namespace android {
 
@@ -31,7 +35,8 @@ namespace binder::debug {
 
 class RecordedTransaction {
 public:
-    // Filled with the first transaction from fd.
+    // Filled with the first transaction from fd. Returns std::nullopt at the
+    // index written by TransactionRecorder, which follows the last transaction.
 
     LIBBINDER_EXPORTED static std::optional<RecordedTransaction> fromFile(
             const binder::unique_fd& fd);
@@ -54,8 +59,15 @@ public:
     LIBBINDER_EXPORTED const std::vector<uint64_t>& getObjectOffsets() const;
 
 private:
+    friend class TransactionRecorder;
+
     RecordedTransaction() = default;
 
+    // Appends the chunks of a transaction to buffer, with zeroed checksums.
+    static status_t appendChunks(std::vector<uint8_t>* buffer, std::string_view interfaceName,
+                                 uint32_t code, uint32_t flags, timespec timestamp,
+                                 const Parcel& data, const Parcel& reply, status_t err);
+
     android::status_t writeChunk(const binder::borrowed_fd, uint32_t chunkType, size_t byteCount,
                                  const uint8_t* data) const;
 
@@ -84,6 +96,120 @@ private:
     Parcel mReplyDataOnly;
 };
 
+// Index of the transactions in a recording, which TransactionRecorder writes
+// after the last transaction, so that tools can find transactions by time,
+// interface, or code without reading the whole recording.
+class RecordingIndex {
+public:
+#pragma clang diagnostic push
+#pragma clang diagnostic error "-Wpadded"
+    struct Entry {
+        uint64_t offset = 0; // of the transaction in the file
+        int64_t timestampNs = 0;
+        uint32_t code = 0;
+        uint32_t interfaceIndex = 0; // into getInterfaceNames()
+    };
+#pragma clang diagnostic pop
+    static_assert(sizeof(Entry) == 24);
+
+    // Reads the index at the end of fd. Returns std::nullopt if the recording
+    // has no index, e.g. because it was not finished. The offset of fd is
+    // left unchanged.
+    LIBBINDER_EXPORTED static std::optional<RecordingIndex> fromFile(const binder::unique_fd& fd);
+
+    // Reads the transaction of entry from fd, leaving the offset of fd at the
+    // end of the transaction.
+    LIBBINDER_EXPORTED static std::optional<RecordedTransaction> readTransaction(
+            const binder::unique_fd& fd, const Entry& entry);
+
+    LIBBINDER_EXPORTED const std::vector<std::string>& getInterfaceNames() const;
+    // Sorted by timestamp, then by offset.
+    LIBBINDER_EXPORTED const std::vector<Entry>& getEntries() const;
+
+    // Returns the entries with timestamps in [begin, end).
+    LIBBINDER_EXPORTED std::vector<Entry> findByTime(timespec begin, timespec end) const;
+    // Returns the entries for interfaceName, and code if given.
+    LIBBINDER_EXPORTED std::vector<Entry> findByInterface(std::string_view interfaceName,
+                                                          std::optional<uint32_t> code) const;
+
+private:
+    friend class TransactionRecorder;
+
+    std::vector<std::string> mInterfaceNames;
+    std::vector<Entry> mEntries;
+};
+
+// Records transactions to a file descriptor in the format of
+// RecordedTransaction::dumpToFile, followed by a RecordingIndex.
+//
+// record() only copies the transaction into a recycled buffer; checksums and
+// writes happen on a background thread, which is started by the constructor.
+// In single-threaded builds, record() writes the transaction itself.
+class TransactionRecorder {
+public:
+    struct Options {
+        // Transactions are dropped, rather than blocking the recording
+        // thread, while this many bytes are waiting to be written.
+        size_t maxPendingBytes = 16 * 1024 * 1024;
+        // Number of transaction buffers kept for reuse once written.
+        size_t maxFreeBuffers = 16;
+        // Whether finish() writes a RecordingIndex. The index also requires
+        // a seekable fd.
+        bool writeIndex = true;
+    };
+
+    LIBBINDER_EXPORTED explicit TransactionRecorder(binder::unique_fd fd);
+    LIBBINDER_EXPORTED TransactionRecorder(binder::unique_fd fd, const Options& options);
+    LIBBINDER_EXPORTED ~TransactionRecorder();
+
+    TransactionRecorder(const TransactionRecorder&) = delete;
+    TransactionRecorder& operator=(const TransactionRecorder&) = delete;
+
+    // Queues the transaction to be written. Returns false if it was dropped.
+    LIBBINDER_EXPORTED bool record(const String16& interfaceName, uint32_t code, uint32_t flags,
+                                   timespec timestamp, const Parcel& data, const Parcel& reply,
+                                   status_t err);
+
+    // Writes the queued transactions and the index, and stops the background
+    // thread. Later transactions are dropped. Called by the destructor.
+    [[nodiscard]] LIBBINDER_EXPORTED status_t finish();
+
+    // Returns the number of transactions dropped because too many bytes were
+    // waiting to be written.
+    LIBBINDER_EXPORTED size_t getDroppedCount() const;
+
+private:
+    struct Pending {
+        std::vector<uint8_t> buffer;
+        std::string interfaceName;
+        int64_t timestampNs = 0;
+        uint32_t code = 0;
+    };
+
+    void threadLoop();
+    void writePending();
+    status_t writeIndex();
+
+    const binder::unique_fd mFd;
+    const Options mOptions;
+
+    mutable RpcMutex mLock;
+    RpcConditionVariable mCondition;
+    std::vector<Pending> mPending;
+    std::vector<Pending> mFree;
+    size_t mPendingBytes = 0;
+    size_t mDropped = 0;
+    bool mStopping = false;
+    RpcMaybeThread mThread;
+
+    // Only used by the writer.
+    std::vector<Pending> mWriting;
+    off_t mOffset = -1;
+    status_t mStatus = OK;
+    RecordingIndex mIndex;
+    std::unordered_map<std::string, uint32_t> mInterfaceIndices;
+};
+
 } // namespace binder::debug
 
 } // namespace android
@@ -23,6 +23,7 @@
 #include <utils/Errors.h>
 #include <utils/RefBase.h>
 
+#include <chrono>
 #include <map>
 #include <optional>
 #include <vector>
@@ -116,6 +117,59 @@ public:
     LIBBINDER_EXPORTED void setFileDescriptorTransportMode(FileDescriptorTransportMode mode);
     LIBBINDER_EXPORTED FileDescriptorTransportMode getFileDescriptorTransportMode();
 
+    enum class OutgoingConnectionPolicy : uint8_t {
+        // Start looking for an available connection after the one last used
+        // for a oneway transaction.
+        ROUND_ROBIN = 0,
+        // Start looking for an available connection at one picked by the
+        // calling thread, so that each thread keeps using the same connection
+        // when there are enough of them.
+        THREAD_AFFINITY = 1,
+    };
+
+    /**
+     * Set how outgoing connections are picked for non-nested transactions. By
+     * default, this is |OutgoingConnectionPolicy::ROUND_ROBIN|. This must be
+     * called before setting up this connection as a client.
+     */
+    LIBBINDER_EXPORTED void setOutgoingConnectionPolicy(OutgoingConnectionPolicy policy);
+    LIBBINDER_EXPORTED OutgoingConnectionPolicy getOutgoingConnectionPolicy();
+
+    struct OutgoingConnectionStats {
+        // number of times a thread found all outgoing connections in use and
+        // had to wait for one
+        uint64_t waits = 0;
+        // number of times a thread couldn't use the connection it started
+        // looking at, and took another one
+        uint64_t missedPreferred = 0;
+    };
+
+    /**
+     * Statistics about contention on outgoing connections, for benchmarking.
+     */
+    LIBBINDER_EXPORTED OutgoingConnectionStats getOutgoingConnectionStats();
+
+    /**
+     * Opt in to batching outgoing oneway transactions. By default, this is 0
+     * and every oneway transaction is written to the socket as soon as it is
+     * made. This must be called before setting up this connection as a client.
+     *
+     * When this is set, oneway transactions without file descriptors are
+     * queued and written together once |deadline| has passed since the first
+     * queued one (checked when another one is queued), once enough data is
+     * queued, before any other command is sent on this session, or when
+     * flushOnewayTransactions is called. The order of oneway transactions to
+     * the same binder is preserved. Transactions still queued when the session
+     * shuts down are dropped.
+     */
+    LIBBINDER_EXPORTED void setOnewayBatchDeadline(std::chrono::nanoseconds deadline);
+    LIBBINDER_EXPORTED std::chrono::nanoseconds getOnewayBatchDeadline();
+
+    /**
+     * Writes any oneway transactions queued because of setOnewayBatchDeadline.
+     */
+    [[nodiscard]] LIBBINDER_EXPORTED status_t flushOnewayTransactions();
+
     /**
      * This should be called once per thread, matching 'join' in the remote
      * process.
@@ -387,6 +441,8 @@ private:
     size_t mMaxOutgoingConnections = kDefaultMaxOutgoingConnections;
     std::optional<uint32_t> mProtocolVersion;
     FileDescriptorTransportMode mFileDescriptorTransportMode = FileDescriptorTransportMode::NONE;
+    std::chrono::nanoseconds mOnewayBatchDeadline = std::chrono::nanoseconds::zero();
+    OutgoingConnectionPolicy mOutgoingConnectionPolicy = OutgoingConnectionPolicy::ROUND_ROBIN;
 
     RpcConditionVariable mAvailableConnectionCv; // for mWaitingThreads
 
@@ -397,6 +453,7 @@ private:
         // hint index into clients, ++ when sending an async transaction
         size_t mOutgoingOffset = 0;
         std::vector<sp<RpcConnection>> mOutgoing;
+        OutgoingConnectionStats mOutgoingStats;
         // max size of mIncoming. Once any thread starts down, no more can be started.
         size_t mMaxIncoming = 0;
         std::vector<sp<RpcConnection>> mIncoming;
@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <binder/Common.h>
+#include <binder/Parcel.h>
+
+#include <array>
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace android {
+
+namespace binder::debug {
+
+// Process-wide latency and payload size histograms of binder transactions,
+// for each interface descriptor and transaction code, to find the calls which
+// are slow or large in production.
+//
+// Disabled by default. When enabled, BBinder::transact records incoming
+// transactions and BpBinder::transact records outgoing ones. Each thread
+// counts into its own buckets, so recording does not contend with other
+// threads; the lock is only taken the first time a thread sees a given
+// interface and code, and while taking a snapshot.
+//
+// A process can enable this itself, or it can be controlled through
+// IBinder::TRANSACTION_STATS_TRANSACTION, e.g. with
+// `dumpsys --binder-stats SERVICE [start|stop|reset]`.
+class TransactionStats {
+public:
+    enum class Direction : uint8_t {
+        INCOMING,
+        OUTGOING,
+    };
+
+    // Latency bucket i counts transactions which took less than 2^i us, and
+    // the last bucket counts the rest.
+    static constexpr size_t kLatencyBuckets = 24;
+    // Size bucket i counts payloads of less than 2^(i + 6) bytes, and the
+    // last bucket counts the rest.
+    static constexpr size_t kSizeBuckets = 16;
+
+    struct Entry {
+        Direction direction;
+        std::u16string descriptor;
+        uint32_t code;
+        uint64_t count;
+        std::chrono::nanoseconds totalLatency;
+        std::chrono::nanoseconds maxLatency;
+        std::array<uint64_t, kLatencyBuckets> latency;
+        std::array<uint64_t, kSizeBuckets> dataSize;
+        std::array<uint64_t, kSizeBuckets> replySize;
+    };
+
+    LIBBINDER_EXPORTED static void setEnabled(bool enabled);
+    LIBBINDER_EXPORTED static bool isEnabled();
+
+    // Records a transaction whose data starts with the interface token, as
+    // written by Parcel::writeInterfaceToken. Only user transactions carry
+    // one, so other transactions are recorded with an empty descriptor.
+    LIBBINDER_EXPORTED static void record(Direction direction, uint32_t code, const Parcel& data,
+                                          const Parcel* reply, std::chrono::nanoseconds latency);
+
+    // Records a transaction for the given descriptor.
+    LIBBINDER_EXPORTED static void record(Direction direction, std::u16string_view descriptor,
+                                          uint32_t code, size_t dataSize, size_t replySize,
+                                          std::chrono::nanoseconds latency);
+
+    // Clears the recorded transactions. Transactions which are being recorded
+    // at the same time may or may not be cleared.
+    LIBBINDER_EXPORTED static void reset();
+
+    // Returns the transactions recorded so far, merged across threads and
+    // sorted by direction, descriptor, and code.
+    LIBBINDER_EXPORTED static std::vector<Entry> snapshot();
+
+    // Writes the snapshot as text, one line per interface and code.
+    LIBBINDER_EXPORTED static std::string dump();
+
+    // Handles IBinder::TRANSACTION_STATS_TRANSACTION.
+    [[nodiscard]] LIBBINDER_EXPORTED static status_t handleTransaction(const Parcel& data,
+                                                                       Parcel* reply);
+
+    // Commands for IBinder::TRANSACTION_STATS_TRANSACTION, which takes an
+    // int32 command. DUMP replies with the output of dump() as a String16.
+    enum Command : int32_t {
+        DUMP = 0,
+        START = 1,
+        STOP = 2,
+        RESET = 3,
+    };
+
+private:
+    TransactionStats() = delete;
+};
+
+} // namespace binder::debug
+
+} // namespace android
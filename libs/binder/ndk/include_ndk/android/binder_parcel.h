@@ -1207,6 +1207,42 @@ binder_status_t AParcel_marshal(const AParcel* parcel, uint8_t* buffer, size_t s
 binder_status_t AParcel_unmarshal(AParcel* parcel, const uint8_t* buffer, size_t len)
         __INTRODUCED_IN(33);
 
+/**
+ * Reads an array of int8_t from the next location in a non-null parcel without copying it, unlike
+ * AParcel_readByteArray.
+ *
+ * The returned data points into the parcel, and is only valid until the parcel is modified, reset
+ * or deleted.
+ *
+ * Available since API level 36.
+ *
+ * \param parcel the parcel to read from.
+ * \param outData set to the data of the array, or to null if the array is null or empty.
+ * \param outLength set to the length of the array, or to -1 if the array is null.
+ *
+ * eturn STATUS_OK on successful read.
+ */
+binder_status_t AParcel_readByteArrayInplace(const AParcel* parcel, const int8_t** outData,
+                                             int32_t* outLength) __INTRODUCED_IN(36);
+
+/**
+ * Reads an array of int32_t from the next location in a non-null parcel without copying it, unlike
+ * AParcel_readInt32Array.
+ *
+ * The returned data points into the parcel, and is only valid until the parcel is modified, reset
+ * or deleted.
+ *
+ * Available since API level 36.
+ *
+ * \param parcel the parcel to read from.
+ * \param outData set to the data of the array, or to null if the array is null or empty.
+ * \param outLength set to the length of the array, or to -1 if the array is null.
+ *
+ * eturn STATUS_OK on successful read.
+ */
+binder_status_t AParcel_readInt32ArrayInplace(const AParcel* parcel, const int32_t** outData,
+                                              int32_t* outLength) __INTRODUCED_IN(36);
+
 __END_DECLS
 
 /** @} */
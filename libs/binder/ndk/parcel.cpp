@@ -150,6 +150,27 @@ binder_status_t ReadArray(const AParcel* parcel, void* arrayData,
     return STATUS_OK;
 }
 
+template <typename T>
+binder_status_t ReadArrayInplace(const AParcel* parcel, const T** outData, int32_t* outLength) {
+    int32_t length;
+    if (binder_status_t status = ReadAndValidateArraySize(parcel, &length); status != STATUS_OK) {
+        return status;
+    }
+
+    *outData = nullptr;
+    *outLength = length;
+    if (length <= 0) return STATUS_OK;
+
+    int32_t size = 0;
+    if (__builtin_smul_overflow(sizeof(T), length, &size)) return STATUS_NO_MEMORY;
+
+    const void* data = parcel->get()->readInplace(size);
+    if (data == nullptr) return STATUS_NO_MEMORY;
+
+    *outData = static_cast<const T*>(data);
+    return STATUS_OK;
+}
+
 // Each element in a char16_t array is converted to an int32_t (not packed)
 template <>
 binder_status_t ReadArray<char16_t>(const AParcel* parcel, void* arrayData,
@@ -675,6 +696,16 @@ binder_status_t AParcel_readByteArray(const AParcel* parcel, void* arrayData,
     return ReadArray<int8_t>(parcel, arrayData, allocator);
 }
 
+binder_status_t AParcel_readByteArrayInplace(const AParcel* parcel, const int8_t** outData,
+                                             int32_t* outLength) {
+    return ReadArrayInplace<int8_t>(parcel, outData, outLength);
+}
+
+binder_status_t AParcel_readInt32ArrayInplace(const AParcel* parcel, const int32_t** outData,
+                                              int32_t* outLength) {
+    return ReadArrayInplace<int32_t>(parcel, outData, outLength);
+}
+
 bool AParcel_getAllowFds(const AParcel* parcel) {
     return parcel->get()->allowFds();
 }
@@ -965,6 +965,31 @@ TEST(NdkBinder, ConvertToPlatformParcel) {
     EXPECT_EQ(42, pparcel->readInt32());
 }
 
+TEST(NdkBinder, ReadArrayInplace) {
+    ndk::ScopedAParcel parcel = ndk::ScopedAParcel(AParcel_create());
+    const int8_t bytes[] = {1, 2, 3};
+    const int32_t ints[] = {-1, 0, 1, 2};
+    EXPECT_EQ(OK, AParcel_writeByteArray(parcel.get(), bytes, std::size(bytes)));
+    EXPECT_EQ(OK, AParcel_writeInt32Array(parcel.get(), ints, std::size(ints)));
+    EXPECT_EQ(OK, AParcel_writeByteArray(parcel.get(), nullptr, -1));
+    EXPECT_EQ(OK, AParcel_setDataPosition(parcel.get(), 0));
+
+    const int8_t* outBytes;
+    int32_t length;
+    EXPECT_EQ(OK, AParcel_readByteArrayInplace(parcel.get(), &outBytes, &length));
+    ASSERT_EQ(static_cast<int32_t>(std::size(bytes)), length);
+    EXPECT_EQ(0, memcmp(bytes, outBytes, sizeof(bytes)));
+
+    const int32_t* outInts;
+    EXPECT_EQ(OK, AParcel_readInt32ArrayInplace(parcel.get(), &outInts, &length));
+    ASSERT_EQ(static_cast<int32_t>(std::size(ints)), length);
+    EXPECT_EQ(0, memcmp(ints, outInts, sizeof(ints)));
+
+    EXPECT_EQ(OK, AParcel_readByteArrayInplace(parcel.get(), &outBytes, &length));
+    EXPECT_EQ(-1, length);
+    EXPECT_EQ(nullptr, outBytes);
+}
+
 TEST(NdkBinder, GetAndVerifyScopedAIBinder_Weak) {
     LIBBINDER_IGNORE("-Wdeprecated-declarations")
     ndk::SpAIBinder remoteBinder(AServiceManager_getService(kBinderNdkUnitTestService));
@@ -224,6 +224,24 @@ TEST(BinderAllocation, SmallTransaction) {
     EXPECT_EQ(mallocs, 1u);
 }
 
+TEST(BinderAllocation, SmallTransactionWithBufferCache) {
+    String16 empty_descriptor = String16("");
+    sp<IServiceManager> manager = defaultServiceManager();
+
+    Parcel::setThreadBufferCacheEnabled(true);
+    manager->checkService(empty_descriptor); // fills the cache
+
+    size_t mallocs = 0;
+    {
+        const auto on_malloc = OnMalloc([&](size_t) { mallocs++; });
+        manager->checkService(empty_descriptor);
+        manager->checkService(empty_descriptor);
+    }
+    Parcel::setThreadBufferCacheEnabled(false);
+
+    EXPECT_EQ(mallocs, 0u);
+}
+
 TEST(RpcBinderAllocation, SetupRpcServer) {
     std::string tmp = getenv("TMPDIR") ?: "/tmp";
     std::string addr = tmp + "/binderRpcBenchmark";
@@ -24,7 +24,9 @@
 #include "fakeservicemanager/FakeServiceManager.h"
 
 #include <sys/prctl.h>
+#include <map>
 #include <thread>
+#include <vector>
 
 using namespace android;
 
@@ -77,6 +79,30 @@ public:
     FakeServiceManager innerSm;
 };
 
+// Pushes re-registrations to callbacks the way servicemanager does.
+class NotifyingAidlServiceManager : public MockAidlServiceManager {
+public:
+    binder::Status addService(const std::string& name, const sp<IBinder>& service,
+                              bool allowIsolated, int32_t dumpPriority) override {
+        binder::Status status =
+                MockAidlServiceManager::addService(name, service, allowIsolated, dumpPriority);
+        if (status.isOk()) {
+            for (const auto& callback : mCallbacks[name]) {
+                callback->onRegistration(name, service);
+            }
+        }
+        return status;
+    }
+
+    binder::Status registerForNotifications(
+            const std::string& name, const sp<os::IServiceCallback>& callback) override {
+        mCallbacks[name].push_back(callback);
+        return binder::Status::ok();
+    }
+
+    std::map<std::string, std::vector<sp<os::IServiceCallback>>> mCallbacks;
+};
+
 class LibbinderCacheTest : public ::testing::Test {
 protected:
     void SetUp() override {
@@ -189,6 +215,34 @@ TEST_F(LibbinderCacheTest, DoNotCacheServiceNotInList) {
     EXPECT_EQ(binder2, result);
 }
 
+TEST_F(LibbinderCacheTest, RemoveFromCacheOnReRegistration) {
+    sp<NotifyingAidlServiceManager> sm = sp<NotifyingAidlServiceManager>::make();
+    sp<android::IServiceManager> serviceManager =
+            getServiceManagerShimFromAidlServiceManagerForTests(sm);
+    sp<IBinder> binder1 = sp<BBinder>::make();
+    sp<IBinder> binder2 = sp<BBinder>::make();
+
+    EXPECT_EQ(OK, serviceManager->addService(kCachedServiceName, binder1));
+    // Get the service. This caches it and watches for re-registration.
+    sp<IBinder> result = serviceManager->checkService(kCachedServiceName);
+    ASSERT_EQ(binder1, result);
+    if (kUseLibbinderCache) {
+        EXPECT_EQ(1u, sm->mCallbacks[String8(kCachedServiceName).c_str()].size());
+    }
+
+    // Replacing the service is pushed to the cache, which drops binder1.
+    EXPECT_EQ(OK, serviceManager->addService(kCachedServiceName, binder2));
+    result = serviceManager->checkService(kCachedServiceName);
+    EXPECT_EQ(binder2, result);
+
+    // Looking it up again doesn't register another callback.
+    result = serviceManager->checkService(kCachedServiceName);
+    EXPECT_EQ(binder2, result);
+    if (kUseLibbinderCache) {
+        EXPECT_EQ(1u, sm->mCallbacks[String8(kCachedServiceName).c_str()].size());
+    }
+}
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
 
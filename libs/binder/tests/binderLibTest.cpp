@@ -134,7 +134,8 @@ enum BinderLibTestTranscationCode {
     BINDER_LIB_TEST_LOCK_UNLOCK,
     BINDER_LIB_TEST_PROCESS_LOCK,
     BINDER_LIB_TEST_UNLOCK_AFTER_MS,
-    BINDER_LIB_TEST_PROCESS_TEMPORARY_LOCK
+    BINDER_LIB_TEST_PROCESS_TEMPORARY_LOCK,
+    BINDER_LIB_TEST_GET_THREAD_POOL_STATS
 };
 
 pid_t start_server_process(int arg2, bool usePoll = false)
@@ -623,6 +624,26 @@ TEST_F(BinderLibTest, NopTransactionOneway) {
                 StatusEq(NO_ERROR));
 }
 
+TEST_F(BinderLibTest, NopTransactionOnewayBatched) {
+    IPCThreadState::self()->beginTransactionBatch();
+    for (int i = 0; i < 100; i++) {
+        Parcel data;
+        data.writeInt32(i);
+        EXPECT_THAT(m_server->transact(BINDER_LIB_TEST_NOP_TRANSACTION, data, nullptr, TF_ONE_WAY),
+                    StatusEq(NO_ERROR));
+    }
+    // A synchronous call submits the batch first and still gets its own reply.
+    Parcel data, reply;
+    EXPECT_THAT(m_server->transact(BINDER_LIB_TEST_NOP_TRANSACTION, data, &reply),
+                StatusEq(NO_ERROR));
+    {
+        IPCThreadState::ScopedTransactionBatch nested;
+        EXPECT_THAT(m_server->transact(BINDER_LIB_TEST_NOP_TRANSACTION, data, nullptr, TF_ONE_WAY),
+                    StatusEq(NO_ERROR));
+    }
+    EXPECT_THAT(IPCThreadState::self()->endTransactionBatch(), StatusEq(NO_ERROR));
+}
+
 TEST_F(BinderLibTest, NopTransactionClear) {
     Parcel data, reply;
     // make sure it accepts the transaction flag
@@ -1831,6 +1852,25 @@ TEST_F(BinderLibTest, ThreadPoolStarted) {
     EXPECT_TRUE(reply.readBool());
 }
 
+TEST_F(BinderLibTest, ThreadPoolStats) {
+    Parcel data, reply;
+    sp<IBinder> server = addServer();
+    ASSERT_TRUE(server != nullptr);
+    EXPECT_THAT(server->transact(BINDER_LIB_TEST_GET_THREAD_POOL_STATS, data, &reply),
+                StatusEq(NO_ERROR));
+    uint64_t spawned = reply.readUint64();
+    uint64_t exited = reply.readUint64();
+    uint64_t maxCurrent = reply.readUint64();
+    uint64_t maxExecuting = reply.readUint64();
+
+    // The server started its threadpool, and is executing this command. Its
+    // threads never exit, since it does not set an idle timeout.
+    EXPECT_GE(spawned, 1u);
+    EXPECT_EQ(exited, 0u);
+    EXPECT_GE(maxExecuting, 1u);
+    EXPECT_GE(maxCurrent, maxExecuting);
+}
+
 size_t epochMillis() {
     using std::chrono::duration_cast;
     using std::chrono::milliseconds;
@@ -2469,6 +2509,14 @@ public:
                 reply->writeBool(ProcessState::self()->isThreadPoolStarted());
                 return NO_ERROR;
             }
+            case BINDER_LIB_TEST_GET_THREAD_POOL_STATS: {
+                ProcessState::ThreadPoolStats stats = ProcessState::self()->getThreadPoolStats();
+                reply->writeUint64(stats.spawnedThreads);
+                reply->writeUint64(stats.exitedThreads);
+                reply->writeUint64(stats.maxCurrentThreads);
+                reply->writeUint64(stats.maxExecutingThreads);
+                return NO_ERROR;
+            }
             case BINDER_LIB_TEST_PROCESS_LOCK: {
                 m_blockMutex.lock();
                 return NO_ERROR;
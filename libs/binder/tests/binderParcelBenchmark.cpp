@@ -169,4 +169,19 @@ BENCHMARK(BM_CharVector)->Apply(VectorArgs);
 BENCHMARK(BM_Int32Vector)->Apply(VectorArgs);
 BENCHMARK(BM_Int64Vector)->Apply(VectorArgs);
 
+// Build a new Parcel for each iteration, like an AIDL proxy does for each
+// call. The argument enables (1) or disables (0) the thread buffer cache.
+static void BM_NewParcelWrite(benchmark::State& state) {
+    android::Parcel::setThreadBufferCacheEnabled(state.range(0) != 0);
+    while (state.KeepRunning()) {
+        android::Parcel p;
+        for (int32_t i = 0; i < 64; i++) {
+            p.writeInt32(i);
+        }
+        benchmark::DoNotOptimize(p.data());
+    }
+    android::Parcel::setThreadBufferCacheEnabled(false);
+}
+BENCHMARK(BM_NewParcelWrite)->Arg(0)->Arg(1);
+
 BENCHMARK_MAIN();
@@ -14,6 +14,8 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+
 #include <binder/IPCThreadState.h>
 #include <binder/Parcel.h>
 #include <binder/Status.h>
@@ -30,6 +32,7 @@ using android::sp;
 using android::status_t;
 using android::String16;
 using android::String8;
+using android::UNEXPECTED_NULL;
 using android::binder::Status;
 using android::binder::unique_fd;
 
@@ -344,6 +347,42 @@ TEST(Parcel, Utf8FromUtf16Read) {
     });
 }
 
+TEST(Parcel, ReadSpans) {
+    const std::vector<uint8_t> bytes = {1, 2, 3};
+    const std::vector<int32_t> ints = {-1, 0, 1, 2};
+    Parcel p;
+    ASSERT_EQ(OK, p.writeByteVector(bytes));
+    ASSERT_EQ(OK, p.writeInt32Vector(ints));
+    ASSERT_EQ(OK, p.writeByteVector(std::optional<std::vector<uint8_t>>()));
+    ASSERT_EQ(OK, p.writeByteVector(std::optional<std::vector<uint8_t>>()));
+    p.setDataPosition(0);
+
+    std::span<const uint8_t> byteSpan;
+    EXPECT_EQ(OK, p.readByteSpan(&byteSpan));
+    EXPECT_TRUE(std::ranges::equal(bytes, byteSpan));
+    std::span<const int32_t> intSpan;
+    EXPECT_EQ(OK, p.readInt32Span(&intSpan));
+    EXPECT_TRUE(std::ranges::equal(ints, intSpan));
+    std::optional<std::span<const uint8_t>> nullSpan = byteSpan;
+    EXPECT_EQ(OK, p.readByteSpan(&nullSpan));
+    EXPECT_FALSE(nullSpan.has_value());
+    EXPECT_EQ(UNEXPECTED_NULL, p.readByteSpan(&byteSpan));
+}
+
+TEST(Parcel, ReadString16View) {
+    Parcel p;
+    ASSERT_EQ(OK, p.writeString16(String16("asdf")));
+    ASSERT_EQ(OK, p.writeString16(std::optional<String16>()));
+    p.setDataPosition(0);
+
+    std::u16string_view view;
+    EXPECT_EQ(OK, p.readString16View(&view));
+    EXPECT_EQ(u"asdf", view);
+    std::optional<std::u16string_view> nullView = view;
+    EXPECT_EQ(OK, p.readString16View(&nullView));
+    EXPECT_FALSE(nullView.has_value());
+}
+
 TEST(Parcel, Utf8AsUtf16Write) {
     std::string token = "asdf";
     parcelOpSameLength([&] (Parcel* p) {
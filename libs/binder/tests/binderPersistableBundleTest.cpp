@@ -132,3 +132,42 @@ TEST(PersistableBundle, OverwriteKey) {
     EXPECT_TRUE(pb.getDouble(kKey, &out));
     EXPECT_EQ(out, 0.5);
 }
+
+TEST(PersistableBundle, ReadLazily) {
+    PersistableBundle expected = createSimplePersistableBundle();
+    expected.putString(String16{"string"}, String16{"foo"});
+    expected.putLongVector(String16{"longs"}, {1, 2, 3});
+    expected.putStringVector(String16{"strings"}, {String16{"foo"}, String16{"bar"}});
+    expected.putPersistableBundle(String16{"bundle"}, createSimplePersistableBundle());
+    PersistableBundle out{};
+
+    Parcel p{};
+    EXPECT_EQ(expected.writeToParcel(&p), OK);
+    p.setDataPosition(0);
+    EXPECT_EQ(out.readFromParcelLazily(&p), OK);
+    EXPECT_EQ(p.dataPosition(), p.dataSize());
+
+    EXPECT_EQ(out.size(), expected.size());
+    EXPECT_EQ(out.getStringVectorKeys(), expected.getStringVectorKeys());
+    std::vector<int64_t> longs;
+    EXPECT_TRUE(out.getLongVector(String16{"longs"}, &longs));
+    EXPECT_EQ(longs, std::vector<int64_t>({1, 2, 3}));
+    String16 str;
+    EXPECT_FALSE(out.getString(String16{"longs"}, &str));
+    EXPECT_EQ(expected, out);
+
+    // Entries which were read lazily can be replaced, erased and written back.
+    out.putInt(String16{"string"}, 1);
+    EXPECT_EQ(out.erase(String16{"bundle"}), 1u);
+    EXPECT_EQ(out.erase(String16{"bundle"}), 0u);
+    expected.putInt(String16{"string"}, 1);
+    expected.erase(String16{"bundle"});
+    EXPECT_EQ(expected, out);
+
+    Parcel p2{};
+    EXPECT_EQ(out.writeToParcel(&p2), OK);
+    p2.setDataPosition(0);
+    PersistableBundle reread{};
+    EXPECT_EQ(reread.readFromParcel(&p2), OK);
+    EXPECT_EQ(expected, reread);
+}
@@ -22,6 +22,8 @@ using android::Parcel;
 using android::status_t;
 using android::binder::unique_fd;
 using android::binder::debug::RecordedTransaction;
+using android::binder::debug::RecordingIndex;
+using android::binder::debug::TransactionRecorder;
 
 TEST(BinderRecordedTransaction, RoundTripEncoding) {
     android::String16 interfaceName("SampleInterface");
@@ -138,3 +140,100 @@ TEST(BinderRecordedTransaction, PayloadsExceedPageBoundaries) {
         EXPECT_EQ(retrievedTransaction->getReplyParcel().readInt32(), 99);
     }
 }
+
+TEST(BinderRecordedTransaction, RecorderWritesIndex) {
+    auto file = std::tmpfile();
+    auto fd = unique_fd(fcntl(fileno(file), F_DUPFD, 1));
+
+    Parcel d;
+    d.writeInt32(12);
+    Parcel r;
+    r.writeInt32(99);
+    {
+        TransactionRecorder recorder(unique_fd(dup(fd.get())));
+        // Wall clock timestamps may go backwards.
+        EXPECT_TRUE(recorder.record(android::String16("First"), 1, 0, {20, 0}, d, r, 0));
+        EXPECT_TRUE(recorder.record(android::String16("Second"), 2, 0, {10, 0}, d, r, 0));
+        EXPECT_TRUE(recorder.record(android::String16("First"), 3, 0, {30, 0}, d, r, 0));
+        ASSERT_EQ(android::NO_ERROR, recorder.finish());
+        EXPECT_EQ(recorder.getDroppedCount(), 0);
+        EXPECT_FALSE(recorder.record(android::String16("First"), 4, 0, {40, 0}, d, r, 0));
+    }
+
+    // Transactions can still be read sequentially, up to the index.
+    std::rewind(file);
+    for (uint32_t code = 1; code <= 3; code++) {
+        auto transaction = RecordedTransaction::fromFile(fd);
+        ASSERT_TRUE(transaction.has_value());
+        EXPECT_EQ(transaction->getCode(), code);
+        EXPECT_EQ(transaction->getDataParcel().readInt32(), 12);
+        EXPECT_EQ(transaction->getReplyParcel().readInt32(), 99);
+    }
+    EXPECT_FALSE(RecordedTransaction::fromFile(fd).has_value());
+
+    auto index = RecordingIndex::fromFile(fd);
+    ASSERT_TRUE(index.has_value());
+    EXPECT_EQ(index->getInterfaceNames(), (std::vector<std::string>{"First", "Second"}));
+    ASSERT_EQ(index->getEntries().size(), 3);
+    EXPECT_EQ(index->getEntries()[0].code, 2);
+    EXPECT_EQ(index->getEntries()[1].code, 1);
+    EXPECT_EQ(index->getEntries()[2].code, 3);
+
+    auto entries = index->findByTime({15, 0}, {30, 0});
+    ASSERT_EQ(entries.size(), 1);
+    EXPECT_EQ(entries[0].code, 1);
+
+    entries = index->findByInterface("First", std::nullopt);
+    ASSERT_EQ(entries.size(), 2);
+    EXPECT_EQ(entries[0].code, 1);
+    EXPECT_EQ(entries[1].code, 3);
+    EXPECT_EQ(index->findByInterface("First", 3).size(), 1);
+    EXPECT_TRUE(index->findByInterface("Third", std::nullopt).empty());
+
+    auto transaction = RecordingIndex::readTransaction(fd, entries[1]);
+    ASSERT_TRUE(transaction.has_value());
+    EXPECT_EQ(transaction->getInterfaceName(), "First");
+    EXPECT_EQ(transaction->getCode(), 3);
+    EXPECT_EQ(transaction->getTimestamp().tv_sec, 30);
+    EXPECT_EQ(transaction->getDataParcel().readInt32(), 12);
+}
+
+TEST(BinderRecordedTransaction, RecorderWithoutIndex) {
+    auto file = std::tmpfile();
+    auto fd = unique_fd(fcntl(fileno(file), F_DUPFD, 1));
+
+    Parcel d;
+    d.writeInt32(12);
+    Parcel r;
+    {
+        TransactionRecorder::Options options;
+        options.writeIndex = false;
+        TransactionRecorder recorder(unique_fd(dup(fd.get())), options);
+        EXPECT_TRUE(recorder.record(android::String16("First"), 1, 0, {20, 0}, d, r, 0));
+    }
+
+    std::rewind(file);
+    EXPECT_FALSE(RecordingIndex::fromFile(fd).has_value());
+    auto transaction = RecordedTransaction::fromFile(fd);
+    ASSERT_TRUE(transaction.has_value());
+    EXPECT_EQ(transaction->getCode(), 1);
+}
+
+TEST(BinderRecordedTransaction, RecorderDropsWhenBehind) {
+    auto file = std::tmpfile();
+    auto fd = unique_fd(fcntl(fileno(file), F_DUPFD, 1));
+
+    Parcel d;
+    Parcel r;
+    TransactionRecorder::Options options;
+    options.maxPendingBytes = 0;
+    TransactionRecorder recorder(unique_fd(dup(fd.get())), options);
+    EXPECT_FALSE(recorder.record(android::String16("First"), 1, 0, {20, 0}, d, r, 0));
+    EXPECT_FALSE(recorder.record(android::String16("First"), 2, 0, {20, 0}, d, r, 0));
+    ASSERT_EQ(android::NO_ERROR, recorder.finish());
+    EXPECT_EQ(recorder.getDroppedCount(), 2);
+
+    auto index = RecordingIndex::fromFile(fd);
+    ASSERT_TRUE(index.has_value());
+    EXPECT_TRUE(index->getEntries().empty());
+}
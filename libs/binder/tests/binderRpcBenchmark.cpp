@@ -145,6 +145,11 @@ static sp<IBinder> gRpcBinder;
 // Skip certificate validation to simplify the setup process.
 static sp<RpcSession> gSessionTls = RpcSession::make(makeFactoryTls());
 static sp<IBinder> gRpcTlsBinder;
+// Sessions to a server with multiple threads, indexed by
+// RpcSession::OutgoingConnectionPolicy.
+static constexpr size_t kMultiThreadServerThreads = 16;
+static sp<RpcSession> gMultiThreadSessions[] = {RpcSession::make(), RpcSession::make()};
+static sp<IBinder> gMultiThreadBinders[std::size(gMultiThreadSessions)];
 #ifdef __BIONIC__
 static const String16 kKernelBinderInstance = String16(u"binderRpcBenchmark-control");
 static sp<IBinder> gKernelBinder;
@@ -197,6 +202,35 @@ void BM_pingTransaction(benchmark::State& state) {
 }
 BENCHMARK(BM_pingTransaction)->ArgsProduct({kTransportList});
 
+void BM_pingTransactionThreads(benchmark::State& state) {
+    const sp<RpcSession>& session = gMultiThreadSessions[state.range(0)];
+    sp<IBinder> binder = gMultiThreadBinders[state.range(0)];
+
+    RpcSession::OutgoingConnectionStats before;
+    if (state.thread_index() == 0) before = session->getOutgoingConnectionStats();
+
+    while (state.KeepRunning()) {
+        CHECK_EQ(OK, binder->pingBinder());
+    }
+
+    if (state.thread_index() == 0) {
+        RpcSession::OutgoingConnectionStats after = session->getOutgoingConnectionStats();
+        state.counters["waits"] = static_cast<double>(after.waits - before.waits);
+        state.counters["missedPreferred"] =
+                static_cast<double>(after.missedPreferred - before.missedPreferred);
+    }
+
+    switch (session->getOutgoingConnectionPolicy()) {
+        case RpcSession::OutgoingConnectionPolicy::ROUND_ROBIN:
+            state.SetLabel("round_robin");
+            break;
+        case RpcSession::OutgoingConnectionPolicy::THREAD_AFFINITY:
+            state.SetLabel("thread_affinity");
+            break;
+    }
+}
+BENCHMARK(BM_pingTransactionThreads)->DenseRange(0, 1)->ThreadRange(1, 64)->UseRealTime();
+
 void BM_repeatTwoPageString(benchmark::State& state) {
     sp<IBinder> binder = getBinderForOptions(state);
 
@@ -246,9 +280,11 @@ void BM_throughputForTransportAndBytes(benchmark::State& state) {
 
     SetLabel(state);
 }
+// The largest size stays below the RpcState::CommandData allocation limit (100KB), so that it
+// measures the biggest parcels RPC binder will accept in a single transaction.
 BENCHMARK(BM_throughputForTransportAndBytes)
         ->ArgsProduct({kTransportList,
-                       {64, 1024, 2048, 4096, 8182, 16364, 32728, 65535, 65536, 65537}});
+                       {64, 1024, 2048, 4096, 8182, 16364, 32728, 65535, 65536, 65537, 98304}});
 
 void BM_collectProxies(benchmark::State& state) {
     sp<IBinder> binder = getBinderForOptions(state);
@@ -301,9 +337,10 @@ void BM_repeatBinder(benchmark::State& state) {
 }
 BENCHMARK(BM_repeatBinder)->ArgsProduct({kTransportList});
 
-void forkRpcServer(const char* addr, const sp<RpcServer>& server) {
+void forkRpcServer(const char* addr, const sp<RpcServer>& server, size_t maxThreads = 1) {
     if (0 == fork()) {
         prctl(PR_SET_PDEATHSIG, SIGHUP); // racey, okay
+        server->setMaxThreads(maxThreads);
         server->setRootObject(sp<MyBinderRpcBenchmark>::make());
         CHECK_EQ(OK, server->setupUnixDomainServer(addr));
         server->join();
@@ -356,6 +393,18 @@ int main(int argc, char** argv) {
     setupClient(gSessionTls, tlsAddr.c_str());
     gRpcTlsBinder = gSessionTls->getRootObject();
 
+    std::string multiThreadAddr = tmp + "/binderRpcMultiThreadBenchmark";
+    (void)unlink(multiThreadAddr.c_str());
+    forkRpcServer(multiThreadAddr.c_str(), RpcServer::make(RpcTransportCtxFactoryRaw::make()),
+                  kMultiThreadServerThreads);
+    gMultiThreadSessions[1]->setOutgoingConnectionPolicy(
+            RpcSession::OutgoingConnectionPolicy::THREAD_AFFINITY);
+    for (size_t i = 0; i < std::size(gMultiThreadSessions); i++) {
+        gMultiThreadSessions[i]->setMaxOutgoingConnections(kMultiThreadServerThreads);
+        setupClient(gMultiThreadSessions[i], multiThreadAddr.c_str());
+        gMultiThreadBinders[i] = gMultiThreadSessions[i]->getRootObject();
+    }
+
     ::benchmark::RunSpecifiedBenchmarks();
     return 0;
 }
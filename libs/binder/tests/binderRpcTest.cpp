@@ -364,6 +364,8 @@ std::unique_ptr<ProcessSession> BinderRpc::createRpcTestSocketServerProcessEtc(
         session->setMaxIncomingThreads(numIncoming);
         session->setMaxOutgoingConnections(options.numOutgoingConnections);
         session->setFileDescriptorTransportMode(options.clientFileDescriptorTransportMode);
+        session->setOnewayBatchDeadline(options.clientOnewayBatchDeadline);
+        session->setOutgoingConnectionPolicy(options.clientOutgoingConnectionPolicy);
 
         sockaddr_storage addr{};
         socklen_t addrLen = 0;
@@ -532,6 +534,24 @@ TEST_P(BinderRpc, ThreadPoolLimitOutgoing) {
     testThreadPoolOverSaturated(proc.rootIface, kNumCalls, 200 /*ms*/);
 }
 
+TEST_P(BinderRpc, ThreadPoolOverSaturatedWithThreadAffinity) {
+    if (clientOrServerSingleThreaded()) {
+        GTEST_SKIP() << "This test requires multiple threads";
+    }
+
+    constexpr size_t kNumThreads = 10;
+    constexpr size_t kNumCalls = kNumThreads + 3;
+    auto proc = createRpcTestSocketServerProcess({
+            .numThreads = kNumThreads,
+            .clientOutgoingConnectionPolicy = RpcSession::OutgoingConnectionPolicy::THREAD_AFFINITY,
+    });
+
+    testThreadPoolOverSaturated(proc.rootIface, kNumCalls, 200 /*ms*/);
+
+    // more calls than connections, so some threads must have waited
+    EXPECT_GT(proc.proc->sessions.at(0).session->getOutgoingConnectionStats().waits, 0u);
+}
+
 TEST_P(BinderRpc, ThreadingStressTest) {
     if (clientOrServerSingleThreaded()) {
         GTEST_SKIP() << "This test requires multiple threads";
@@ -658,6 +678,39 @@ TEST_P(BinderRpc, OnewayCallQueueing) {
     saturateThreadPool(1 + kNumExtraServerThreads, proc.rootIface);
 }
 
+TEST_P(BinderRpc, OnewayCallQueueingBatched) {
+    if (clientOrServerSingleThreaded()) {
+        GTEST_SKIP() << "This test requires multiple threads";
+    }
+
+    constexpr size_t kNumQueued = 10;
+    constexpr size_t kNumExtraServerThreads = 4;
+
+    auto proc = createRpcTestSocketServerProcess({
+            .numThreads = 1 + kNumExtraServerThreads,
+            .clientOnewayBatchDeadline = std::chrono::seconds(10),
+    });
+
+    // these are queued on the client, and the first synchronous call below
+    // must send them, in order, before it is sent itself
+    for (size_t i = 0; i + 1 < kNumQueued; i++) {
+        EXPECT_OK(proc.rootIface->blockingSendIntOneway(i));
+    }
+    for (size_t i = 0; i + 1 < kNumQueued; i++) {
+        int n;
+        EXPECT_OK(proc.rootIface->blockingRecvInt(&n));
+        EXPECT_EQ(n, static_cast<ssize_t>(i));
+    }
+
+    EXPECT_OK(proc.rootIface->blockingSendIntOneway(42));
+    EXPECT_EQ(OK, proc.proc->sessions.at(0).session->flushOnewayTransactions());
+    int n;
+    EXPECT_OK(proc.rootIface->blockingRecvInt(&n));
+    EXPECT_EQ(n, 42);
+
+    saturateThreadPool(1 + kNumExtraServerThreads, proc.rootIface);
+}
+
 TEST_P(BinderRpc, OnewayCallExhaustion) {
     if (clientOrServerSingleThreaded()) {
         GTEST_SKIP() << "This test requires multiple threads";
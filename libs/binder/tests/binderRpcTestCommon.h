@@ -169,6 +169,9 @@ struct BinderRpcOptions {
     std::vector<RpcSession::FileDescriptorTransportMode>
             serverSupportedFileDescriptorTransportModes = {
                     RpcSession::FileDescriptorTransportMode::NONE};
+    std::chrono::nanoseconds clientOnewayBatchDeadline = std::chrono::nanoseconds::zero();
+    RpcSession::OutgoingConnectionPolicy clientOutgoingConnectionPolicy =
+            RpcSession::OutgoingConnectionPolicy::ROUND_ROBIN;
 
     // If true, connection failures will result in `ProcessSession::sessions` being empty
     // instead of a fatal error.
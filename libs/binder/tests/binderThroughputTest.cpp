@@ -51,6 +51,9 @@ public:
 };
 
 static uint64_t warn_latency = std::numeric_limits<uint64_t>::max();
+// When non-zero, transactions are oneway and submitted to the driver in
+// batches of this many (1 means unbatched oneway).
+static int oneway_batch_size = 0;
 
 struct ProcResults {
     vector<uint64_t> data;
@@ -251,7 +254,21 @@ void worker_fx(int num,
                 sz -= sizeof(uint32_t);
             }
             start = chrono::high_resolution_clock::now();
-            status_t ret = workers[target]->transact(BINDER_NOP, data, &reply);
+            status_t ret;
+            if (oneway_batch_size == 0) {
+                ret = workers[target]->transact(BINDER_NOP, data, &reply);
+            } else {
+                IPCThreadState* ipc = IPCThreadState::self();
+                if (oneway_batch_size > 1 && i % oneway_batch_size == 0) {
+                    ipc->beginTransactionBatch();
+                }
+                ret = workers[target]->transact(BINDER_NOP, data, nullptr, IBinder::FLAG_ONEWAY);
+                if (oneway_batch_size > 1 &&
+                    (i % oneway_batch_size == oneway_batch_size - 1 || i == iterations - 1)) {
+                    status_t batchRet = ipc->endTransactionBatch();
+                    if (ret == NO_ERROR) ret = batchRet;
+                }
+            }
             end = chrono::high_resolution_clock::now();
 
             uint64_t cur_time = uint64_t(chrono::duration_cast<chrono::nanoseconds>(end - start).count());
@@ -387,6 +404,7 @@ int main(int argc, char *argv[])
             cout << "\t-t      : Run training round." << endl;
             cout << "\t-w N    : Specify total number of workers." << endl;
             cout << "\t-d FILE : Dump raw data to file." << endl;
+            cout << "\t-o N    : Send oneway transactions, submitting N per ioctl." << endl;
             return 0;
         }
         if (string(argv[i]) == "-w") {
@@ -445,6 +463,19 @@ int main(int argc, char *argv[])
             i++;
             continue;
         }
+        if (string(argv[i]) == "-o") {
+            if (i + 1 == argc) {
+                cout << "-o requires an argument\n" << endl;
+                exit(EXIT_FAILURE);
+            }
+            oneway_batch_size = atoi(argv[i+1]);
+            if (oneway_batch_size <= 0) {
+                cout << "Batch size -o must be positive." << endl;
+                exit(EXIT_FAILURE);
+            }
+            i++;
+            continue;
+        }
         if (string(argv[i]) == "-d") {
             if (i + 1 == argc) {
                 cout << "-d requires an argument\n" << endl;
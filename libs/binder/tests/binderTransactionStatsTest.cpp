@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <binder/IBinder.h>
+#include <binder/Parcel.h>
+#include <binder/TransactionStats.h>
+#include <gtest/gtest.h>
+
+#include <thread>
+
+using android::IBinder;
+using android::OK;
+using android::Parcel;
+using android::String16;
+using android::binder::debug::TransactionStats;
+using Direction = TransactionStats::Direction;
+using std::chrono::microseconds;
+
+class TransactionStatsTest : public testing::Test {
+protected:
+    void SetUp() override { TransactionStats::reset(); }
+    void TearDown() override {
+        TransactionStats::setEnabled(false);
+        TransactionStats::reset();
+    }
+};
+
+TEST_F(TransactionStatsTest, RecordsInterfaceToken) {
+    Parcel data;
+    data.writeInterfaceToken(String16("android.binder.ITest"));
+    data.writeInt32(42);
+
+    TransactionStats::record(Direction::INCOMING, IBinder::FIRST_CALL_TRANSACTION, data, nullptr,
+                             microseconds(10));
+    // The interface token is only read for user transactions.
+    TransactionStats::record(Direction::INCOMING, IBinder::PING_TRANSACTION, data, nullptr,
+                             microseconds(10));
+
+    auto entries = TransactionStats::snapshot();
+    ASSERT_EQ(entries.size(), 2u);
+    EXPECT_EQ(entries[0].descriptor, u"");
+    EXPECT_EQ(entries[0].code, IBinder::PING_TRANSACTION);
+    EXPECT_EQ(entries[1].descriptor, u"android.binder.ITest");
+    EXPECT_EQ(entries[1].code, IBinder::FIRST_CALL_TRANSACTION);
+
+    // Recording does not move the data position.
+    EXPECT_EQ(data.dataPosition(), data.dataSize());
+}
+
+TEST_F(TransactionStatsTest, Histograms) {
+    for (int i = 0; i < 100; i++) {
+        TransactionStats::record(Direction::OUTGOING, u"ITest", 1, 100, 5000,
+                                 microseconds(i < 90 ? 3 : 1000));
+    }
+
+    auto entries = TransactionStats::snapshot();
+    ASSERT_EQ(entries.size(), 1u);
+    const auto& entry = entries[0];
+    EXPECT_EQ(entry.direction, Direction::OUTGOING);
+    EXPECT_EQ(entry.count, 100u);
+    EXPECT_EQ(entry.maxLatency, microseconds(1000));
+    EXPECT_EQ(entry.totalLatency, microseconds(90 * 3 + 10 * 1000));
+
+    // 3us is in [2, 4), and 1000us is in [512, 1024).
+    EXPECT_EQ(entry.latency[2], 90u);
+    EXPECT_EQ(entry.latency[10], 10u);
+    // 100 bytes is in [64, 128), and 5000 bytes is in [4096, 8192).
+    EXPECT_EQ(entry.dataSize[1], 100u);
+    EXPECT_EQ(entry.replySize[7], 100u);
+}
+
+TEST_F(TransactionStatsTest, MergesThreads) {
+    constexpr int kThreads = 4;
+    constexpr int kCount = 1000;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; t++) {
+        threads.emplace_back([] {
+            for (int i = 0; i < kCount; i++) {
+                TransactionStats::record(Direction::INCOMING, u"ITest", 1, 0, 0,
+                                         microseconds(1));
+            }
+        });
+    }
+    // Snapshots are taken while threads are running and after they exit.
+    TransactionStats::snapshot();
+    for (auto& thread : threads) thread.join();
+
+    auto entries = TransactionStats::snapshot();
+    ASSERT_EQ(entries.size(), 1u);
+    EXPECT_EQ(entries[0].count, static_cast<uint64_t>(kThreads * kCount));
+}
+
+TEST_F(TransactionStatsTest, Reset) {
+    TransactionStats::record(Direction::INCOMING, u"ITest", 1, 0, 0, microseconds(1));
+    ASSERT_EQ(TransactionStats::snapshot().size(), 1u);
+
+    TransactionStats::reset();
+    EXPECT_TRUE(TransactionStats::snapshot().empty());
+}
+
+TEST_F(TransactionStatsTest, HandleTransaction) {
+    Parcel start;
+    start.writeInt32(TransactionStats::START);
+    ASSERT_EQ(TransactionStats::handleTransaction(start, nullptr), OK);
+    EXPECT_TRUE(TransactionStats::isEnabled());
+
+    TransactionStats::record(Direction::INCOMING, u"android.binder.ITest", 7, 0, 0,
+                             microseconds(1));
+
+    Parcel dump;
+    dump.writeInt32(TransactionStats::DUMP);
+    Parcel reply;
+    ASSERT_EQ(TransactionStats::handleTransaction(dump, &reply), OK);
+    reply.setDataPosition(0);
+    std::string text;
+    ASSERT_EQ(reply.readUtf8FromUtf16(&text), OK);
+    EXPECT_NE(text.find("incoming android.binder.ITest code 7: count=1"), std::string::npos)
+            << text;
+
+    Parcel stop;
+    stop.writeInt32(TransactionStats::STOP);
+    ASSERT_EQ(TransactionStats::handleTransaction(stop, nullptr), OK);
+    EXPECT_FALSE(TransactionStats::isEnabled());
+
+    Parcel unknown;
+    unknown.writeInt32(-1);
+    EXPECT_NE(TransactionStats::handleTransaction(unknown, nullptr), OK);
+}
@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <cputimeinstate.h>
+
+namespace android {
+namespace bpf {
+
+// Reads of every uid, as BatteryStats polls them. Run as root, with time in state tracking
+// supported by the kernel.
+
+static void BM_getUidsCpuFreqTimes(benchmark::State &state) {
+    if (!isTrackingUidTimesSupported()) {
+        state.SkipWithError("Time in state tracking is not supported");
+        return;
+    }
+    for (auto _ : state) {
+        auto times = getUidsCpuFreqTimes();
+        if (!times) {
+            state.SkipWithError("getUidsCpuFreqTimes failed");
+            return;
+        }
+        state.counters["uids"] = times->size();
+    }
+}
+BENCHMARK(BM_getUidsCpuFreqTimes);
+
+static void BM_getUidsUpdatedCpuFreqTimes(benchmark::State &state) {
+    if (!isTrackingUidTimesSupported()) {
+        state.SkipWithError("Time in state tracking is not supported");
+        return;
+    }
+    uint64_t lastUpdate = 0;
+    for (auto _ : state) {
+        if (!getUidsUpdatedCpuFreqTimes(&lastUpdate)) {
+            state.SkipWithError("getUidsUpdatedCpuFreqTimes failed");
+            return;
+        }
+    }
+}
+BENCHMARK(BM_getUidsUpdatedCpuFreqTimes);
+
+static void BM_getUidsCpuFreqTimeDeltas(benchmark::State &state) {
+    if (!isTrackingUidTimesSupported()) {
+        state.SkipWithError("Time in state tracking is not supported");
+        return;
+    }
+    uid_cpu_freq_times_snapshot_t snapshot;
+    std::vector<uid_cpu_freq_time_delta_t> deltas;
+    for (auto _ : state) {
+        if (!getUidsCpuFreqTimeDeltas(&snapshot, &deltas)) {
+            state.SkipWithError("getUidsCpuFreqTimeDeltas failed");
+            return;
+        }
+    }
+}
+BENCHMARK(BM_getUidsCpuFreqTimeDeltas);
+
+static void BM_getUidsConcurrentTimes(benchmark::State &state) {
+    if (!isTrackingUidTimesSupported()) {
+        state.SkipWithError("Time in state tracking is not supported");
+        return;
+    }
+    for (auto _ : state) {
+        auto times = getUidsConcurrentTimes();
+        if (!times) {
+            state.SkipWithError("getUidsConcurrentTimes failed");
+            return;
+        }
+        state.counters["uids"] = times->size();
+    }
+}
+BENCHMARK(BM_getUidsConcurrentTimes);
+
+static void BM_getUidsUpdatedConcurrentTimes(benchmark::State &state) {
+    if (!isTrackingUidTimesSupported()) {
+        state.SkipWithError("Time in state tracking is not supported");
+        return;
+    }
+    uint64_t lastUpdate = 0;
+    for (auto _ : state) {
+        if (!getUidsUpdatedConcurrentTimes(&lastUpdate)) {
+            state.SkipWithError("getUidsUpdatedConcurrentTimes failed");
+            return;
+        }
+    }
+}
+BENCHMARK(BM_getUidsUpdatedConcurrentTimes);
+
+} // namespace bpf
+} // namespace android
+
+BENCHMARK_MAIN();
@@ -22,8 +22,12 @@
 #include <dirent.h>
 #include <errno.h>
 #include <inttypes.h>
+#include <linux/bpf.h>
+#include <sys/syscall.h>
 #include <sys/sysinfo.h>
+#include <unistd.h>
 
+#include <atomic>
 #include <mutex>
 #include <numeric>
 #include <optional>
@@ -62,6 +66,7 @@ static unique_fd gTisMapFd;
 static unique_fd gConcurrentMapFd;
 static unique_fd gUidLastUpdateMapFd;
 static unique_fd gPidTisMapFd;
+static std::atomic<bool> gBatchLookupSupported = true;
 
 static std::optional<std::vector<uint32_t>> readNumbersFromFile(const std::string &path) {
     std::string data;
@@ -337,10 +342,7 @@ std::optional<std::vector<std::vector<uint64_t>>> getUidCpuFreqTimes(uint32_t ui
     return out;
 }
 
-static std::optional<bool> uidUpdatedSince(uint32_t uid, uint64_t lastUpdate,
-                                           uint64_t *newLastUpdate) {
-    uint64_t uidLastUpdate;
-    if (findMapEntry(gUidLastUpdateMapFd, &uid, &uidLastUpdate)) return {};
+static bool updatedSince(uint64_t uidLastUpdate, uint64_t lastUpdate, uint64_t *newLastUpdate) {
     // Updates that occurred during the previous read may have been missed. To mitigate
     // this, don't ignore entries updated up to 1s before *lastUpdate
     constexpr uint64_t NSEC_PER_SEC = 1000000000;
@@ -349,6 +351,100 @@ static std::optional<bool> uidUpdatedSince(uint32_t uid, uint64_t lastUpdate,
     return true;
 }
 
+static std::optional<bool> uidUpdatedSince(uint32_t uid, uint64_t lastUpdate,
+                                           uint64_t *newLastUpdate) {
+    uint64_t uidLastUpdate;
+    if (findMapEntry(gUidLastUpdateMapFd, &uid, &uidLastUpdate)) return {};
+    return updatedSince(uidLastUpdate, lastUpdate, newLastUpdate);
+}
+
+// Number of entries read per BPF_MAP_LOOKUP_BATCH call.
+static constexpr uint32_t kBatchSize = 256;
+
+static uint64_t ptrToU64(const void *ptr) {
+    return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(ptr));
+}
+
+// Calls fn(key, vals) for each entry of mapFd, where vals points at valsPerKey values: gNCpus for
+// per-CPU maps, and 1 otherwise. The map is read with BPF_MAP_LOOKUP_BATCH into keys and vals,
+// which callers keep across calls so that polling does not reallocate them, rather than with two
+// syscalls per entry. Like key by key iteration, this is not atomic with respect to concurrent
+// updates of the map.
+// Returns no value if the kernel does not support batch lookups, in which case fn has not been
+// called. Otherwise returns false on error or if fn returned false, and true on success.
+template <typename Key, typename Val, typename Fn>
+static std::optional<bool> forEachMapEntryBatched(const unique_fd &mapFd, uint32_t valsPerKey,
+                                                  std::vector<Key> *keys, std::vector<Val> *vals,
+                                                  Fn fn) {
+    static_assert(sizeof(Val) % 8 == 0, "the kernel pads per-CPU values to 8 bytes");
+    if (!gBatchLookupSupported.load(std::memory_order_relaxed)) return {};
+
+    uint32_t batchSize = kBatchSize;
+    // Opaque position in the map; the kernel only needs it to be as large as a key.
+    uint64_t batch[(sizeof(Key) + 7) / 8 + 1] = {};
+    bool first = true;
+    while (true) {
+        if (keys->size() < batchSize) {
+            keys->resize(batchSize);
+            vals->resize(batchSize * valsPerKey);
+        }
+        union bpf_attr attr = {};
+        attr.batch.in_batch = first ? 0 : ptrToU64(batch);
+        attr.batch.out_batch = ptrToU64(batch);
+        attr.batch.keys = ptrToU64(keys->data());
+        attr.batch.values = ptrToU64(vals->data());
+        attr.batch.count = batchSize;
+        attr.batch.map_fd = mapFd.get();
+        const int ret = syscall(__NR_bpf, BPF_MAP_LOOKUP_BATCH, &attr, sizeof(attr));
+        const int err = errno;
+        if (ret && err != ENOENT) {
+            if (err == ENOSPC) {
+                // A hash bucket holds more entries than fit in the buffers.
+                batchSize *= 2;
+                continue;
+            }
+            if (first && (err == EINVAL || err == ENOTSUP || err == 524 /* ENOTSUPP */)) {
+                gBatchLookupSupported.store(false, std::memory_order_relaxed);
+                return {};
+            }
+            return false;
+        }
+        // On ENOENT, count holds the last entries of the map.
+        for (uint32_t i = 0; i < attr.batch.count; ++i) {
+            if (!fn((*keys)[i], vals->data() + i * valsPerKey)) return false;
+        }
+        if (ret) break;
+        first = false;
+    }
+    return true;
+}
+
+// Reads the last update time of every uid, to check uidUpdatedSince without a syscall per uid.
+// Returns no value if the kernel does not support batch lookups or on error.
+static std::optional<std::unordered_map<uint32_t, uint64_t>> getUidLastUpdates() {
+    thread_local std::vector<uint32_t> keys;
+    thread_local std::vector<uint64_t> vals;
+    std::unordered_map<uint32_t, uint64_t> lastUpdates;
+    auto ret = forEachMapEntryBatched(gUidLastUpdateMapFd, 1, &keys, &vals,
+                                      [&](uint32_t uid, const uint64_t *lastUpdate) {
+                                          lastUpdates.emplace(uid, *lastUpdate);
+                                          return true;
+                                      });
+    if (!ret.value_or(false)) return {};
+    return lastUpdates;
+}
+
+// Like uidUpdatedSince, but with the last update times read by getUidLastUpdates if available.
+// Uids which started running after those were read are looked up in the map.
+static std::optional<bool> uidUpdatedSince(
+        const std::optional<std::unordered_map<uint32_t, uint64_t>> &lastUpdates, uint32_t uid,
+        uint64_t lastUpdate, uint64_t *newLastUpdate) {
+    if (!lastUpdates) return uidUpdatedSince(uid, lastUpdate, newLastUpdate);
+    auto it = lastUpdates->find(uid);
+    if (it == lastUpdates->end()) return uidUpdatedSince(uid, lastUpdate, newLastUpdate);
+    return updatedSince(it->second, lastUpdate, newLastUpdate);
+}
+
 // Retrieve the times in ns that each uid spent running at each CPU freq.
 // Return contains no value on error, otherwise it contains a map from uids to vectors of vectors
 // using the format:
@@ -360,31 +456,61 @@ getUidsCpuFreqTimes() {
     return getUidsUpdatedCpuFreqTimes(nullptr);
 }
 
+// Calls fn(key, vals) for each entry of the uid time in state map, where vals holds the values of
+// each CPU, skipping uids that have not run since before *lastUpdate if lastUpdate is not null.
+// Returns false on error. Otherwise advances *lastUpdate to the latest update seen.
+template <typename Fn>
+static bool forEachUpdatedUidTimeInState(uint64_t *lastUpdate, Fn fn) {
+    time_key_t key, prevKey;
+    if (getFirstMapKey(gTisMapFd, &key)) return errno == ENOENT;
+
+    uint64_t newLastUpdate = lastUpdate ? *lastUpdate : 0;
+    std::optional<std::unordered_map<uint32_t, uint64_t>> lastUpdates;
+    if (lastUpdate) lastUpdates = getUidLastUpdates();
+
+    auto uidUpdated = [&](uint32_t uid) -> std::optional<bool> {
+        if (!lastUpdate) return true;
+        return uidUpdatedSince(lastUpdates, uid, *lastUpdate, &newLastUpdate);
+    };
+
+    thread_local std::vector<time_key_t> batchKeys;
+    thread_local std::vector<tis_val_t> batchVals;
+    auto batched = forEachMapEntryBatched(gTisMapFd, gNCpus, &batchKeys, &batchVals,
+                                          [&](const time_key_t &key, const tis_val_t *vals) {
+                                              auto updated = uidUpdated(key.uid);
+                                              if (!updated.has_value()) return false;
+                                              if (*updated) fn(key, vals);
+                                              return true;
+                                          });
+    if (batched.has_value()) {
+        if (!*batched) return false;
+    } else {
+        std::vector<tis_val_t> vals(gNCpus);
+        do {
+            auto updated = uidUpdated(key.uid);
+            if (!updated.has_value()) return false;
+            if (!*updated) continue;
+            if (findMapEntry(gTisMapFd, &key, vals.data())) return false;
+            fn(key, vals.data());
+        } while (prevKey = key, !getNextMapKey(gTisMapFd, &prevKey, &key));
+        if (errno != ENOENT) return false;
+    }
+    if (lastUpdate && newLastUpdate > *lastUpdate) *lastUpdate = newLastUpdate;
+    return true;
+}
+
 // Retrieve the times in ns that each uid spent running at each CPU freq, excluding UIDs that have
 // not run since before lastUpdate.
 // Return format is the same as getUidsCpuFreqTimes()
 std::optional<std::unordered_map<uint32_t, std::vector<std::vector<uint64_t>>>>
 getUidsUpdatedCpuFreqTimes(uint64_t *lastUpdate) {
     if (!gInitialized && !initGlobals()) return {};
-    time_key_t key, prevKey;
     std::unordered_map<uint32_t, std::vector<std::vector<uint64_t>>> map;
-    if (getFirstMapKey(gTisMapFd, &key)) {
-        if (errno == ENOENT) return map;
-        return std::nullopt;
-    }
 
     std::vector<std::vector<uint64_t>> mapFormat;
     for (const auto &freqList : gPolicyFreqs) mapFormat.emplace_back(freqList.size(), 0);
 
-    uint64_t newLastUpdate = lastUpdate ? *lastUpdate : 0;
-    std::vector<tis_val_t> vals(gNCpus);
-    do {
-        if (lastUpdate) {
-            auto uidUpdated = uidUpdatedSince(key.uid, *lastUpdate, &newLastUpdate);
-            if (!uidUpdated.has_value()) return {};
-            if (!*uidUpdated) continue;
-        }
-        if (findMapEntry(gTisMapFd, &key, vals.data())) return {};
+    auto addEntry = [&](const time_key_t &key, const tis_val_t *vals) {
         if (map.find(key.uid) == map.end()) map.emplace(key.uid, mapFormat);
 
         auto offset = key.bucket * FREQS_PER_ENTRY;
@@ -399,13 +525,82 @@ getUidsUpdatedCpuFreqTimes(uint64_t *lastUpdate) {
                                std::plus<uint64_t>());
             }
         }
-        prevKey = key;
-    } while (prevKey = key, !getNextMapKey(gTisMapFd, &prevKey, &key));
-    if (errno != ENOENT) return {};
-    if (lastUpdate && newLastUpdate > *lastUpdate) *lastUpdate = newLastUpdate;
+    };
+    if (!forEachUpdatedUidTimeInState(lastUpdate, addEntry)) return {};
     return map;
 }
 
+// Replace the contents of deltas with the ns that each uid spent running at each CPU freq since the
+// previous call with the same snapshot, or since tracking started on the first call. Only nonzero
+// deltas are reported, and uids that have not run since the previous call are not read.
+// Returns false on error, in which case the snapshot is left unchanged.
+bool getUidsCpuFreqTimeDeltas(uid_cpu_freq_times_snapshot_t *snapshot,
+                              std::vector<uid_cpu_freq_time_delta_t> *deltas) {
+    deltas->clear();
+    if (!gInitialized && !initGlobals()) return false;
+
+    // Snapshots hold the times of each uid as one vector, indexed by policyOffsets[policy] + freq.
+    std::vector<uint32_t> policyOffsets;
+    uint32_t nFreqs = 0;
+    for (const auto &freqList : gPolicyFreqs) {
+        policyOffsets.push_back(nFreqs);
+        nFreqs += freqList.size();
+    }
+
+    // The new totals are only stored once the whole map was read successfully.
+    struct total_t {
+        uint32_t uid;
+        uint32_t index;
+        uint64_t time;
+    };
+    thread_local std::vector<total_t> totals;
+    totals.clear();
+
+    uint64_t lastUpdate = snapshot->lastUpdate;
+    auto addEntry = [&](const time_key_t &key, const tis_val_t *vals) {
+        auto it = snapshot->times.find(key.uid);
+        const uint64_t *previous = it == snapshot->times.end() ? nullptr : it->second.data();
+
+        auto offset = key.bucket * FREQS_PER_ENTRY;
+        for (uint32_t i = 0; i < gNPolicies; ++i) {
+            if (offset >= gPolicyFreqs[i].size()) continue;
+            auto end = std::min<size_t>(offset + FREQS_PER_ENTRY, gPolicyFreqs[i].size());
+            for (uint32_t freqIdx = offset; freqIdx < end; ++freqIdx) {
+                uint64_t time = 0;
+                for (const auto &cpu : gPolicyCpus[i]) {
+                    time += vals[gCpuIndexMap[cpu]].ar[freqIdx - offset];
+                }
+                const uint32_t index = policyOffsets[i] + freqIdx;
+                const uint64_t previousTime = previous ? previous[index] : 0;
+                if (time == previousTime) continue;
+                // Times only go backwards if the uid was cleared and then reused.
+                const uint64_t delta = time > previousTime ? time - previousTime : time;
+                deltas->push_back({.uid = key.uid,
+                                   .policy = static_cast<uint16_t>(i),
+                                   .freqIdx = static_cast<uint16_t>(freqIdx),
+                                   .delta = delta});
+                totals.push_back({.uid = key.uid, .index = index, .time = time});
+            }
+        }
+    };
+    if (!forEachUpdatedUidTimeInState(&lastUpdate, addEntry)) {
+        deltas->clear();
+        return false;
+    }
+
+    std::vector<uint64_t> *times = nullptr;
+    uint32_t timesUid = 0;
+    for (const auto &total : totals) {
+        if (!times || total.uid != timesUid) {
+            times = &snapshot->times.try_emplace(total.uid, nFreqs, 0).first->second;
+            timesUid = total.uid;
+        }
+        (*times)[total.index] = total.time;
+    }
+    snapshot->lastUpdate = lastUpdate;
+    return true;
+}
+
 static bool verifyConcurrentTimes(const concurrent_time_t &ct) {
     uint64_t activeSum = std::accumulate(ct.active.begin(), ct.active.end(), (uint64_t)0);
     uint64_t policySum = 0;
@@ -488,18 +683,18 @@ std::optional<std::unordered_map<uint32_t, concurrent_time_t>> getUidsUpdatedCon
     concurrent_time_t retFormat = {.active = std::vector<uint64_t>(gNCpus, 0)};
     for (const auto &cpuList : gPolicyCpus) retFormat.policy.emplace_back(cpuList.size(), 0);
 
-    std::vector<concurrent_val_t> vals(gNCpus);
     std::vector<uint64_t>::iterator activeBegin, activeEnd, policyBegin, policyEnd;
+    const uint32_t maxBucket = (gNCpus - 1) / CPUS_PER_ENTRY;
 
     uint64_t newLastUpdate = lastUpdate ? *lastUpdate : 0;
-    do {
-        if (key.bucket > (gNCpus - 1) / CPUS_PER_ENTRY) return {};
-        if (lastUpdate) {
-            auto uidUpdated = uidUpdatedSince(key.uid, *lastUpdate, &newLastUpdate);
-            if (!uidUpdated.has_value()) return {};
-            if (!*uidUpdated) continue;
-        }
-        if (findMapEntry(gConcurrentMapFd, &key, vals.data())) return {};
+    std::optional<std::unordered_map<uint32_t, uint64_t>> lastUpdates;
+    if (lastUpdate) lastUpdates = getUidLastUpdates();
+
+    auto uidUpdated = [&](uint32_t uid) -> std::optional<bool> {
+        if (!lastUpdate) return true;
+        return uidUpdatedSince(lastUpdates, uid, *lastUpdate, &newLastUpdate);
+    };
+    auto addEntry = [&](const time_key_t &key, const concurrent_val_t *vals) {
         if (ret.find(key.uid) == ret.end()) ret.emplace(key.uid, retFormat);
 
         auto offset = key.bucket * CPUS_PER_ENTRY;
@@ -524,8 +719,32 @@ std::optional<std::unordered_map<uint32_t, concurrent_time_t>> getUidsUpdatedCon
                                policyBegin, std::plus<uint64_t>());
             }
         }
-    } while (prevKey = key, !getNextMapKey(gConcurrentMapFd, &prevKey, &key));
-    if (errno != ENOENT) return {};
+    };
+
+    thread_local std::vector<time_key_t> batchKeys;
+    thread_local std::vector<concurrent_val_t> batchVals;
+    auto batched = forEachMapEntryBatched(gConcurrentMapFd, gNCpus, &batchKeys, &batchVals,
+                                          [&](const time_key_t &key, const concurrent_val_t *vals) {
+                                              if (key.bucket > maxBucket) return false;
+                                              auto updated = uidUpdated(key.uid);
+                                              if (!updated.has_value()) return false;
+                                              if (*updated) addEntry(key, vals);
+                                              return true;
+                                          });
+    if (batched.has_value()) {
+        if (!*batched) return {};
+    } else {
+        std::vector<concurrent_val_t> vals(gNCpus);
+        do {
+            if (key.bucket > maxBucket) return {};
+            auto updated = uidUpdated(key.uid);
+            if (!updated.has_value()) return {};
+            if (!*updated) continue;
+            if (findMapEntry(gConcurrentMapFd, &key, vals.data())) return {};
+            addEntry(key, vals.data());
+        } while (prevKey = key, !getNextMapKey(gConcurrentMapFd, &prevKey, &key));
+        if (errno != ENOENT) return {};
+    }
     for (const auto &[key, value] : ret) {
         if (!verifyConcurrentTimes(value)) {
             auto val = getUidConcurrentTimes(key, false);
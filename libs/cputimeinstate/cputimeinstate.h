@@ -16,6 +16,10 @@
 
 #pragma once
 
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <optional>
 #include <unordered_map>
 #include <vector>
 
@@ -32,6 +36,24 @@ std::optional<std::unordered_map<uint32_t, std::vector<std::vector<uint64_t>>>>
     getUidsUpdatedCpuFreqTimes(uint64_t *lastUpdate);
 std::optional<std::vector<std::vector<uint32_t>>> getCpuFreqs();
 
+// The ns that uid spent running on the policy'th cluster at its freqIdx'th lowest freq.
+struct uid_cpu_freq_time_delta_t {
+    uint32_t uid;
+    uint16_t policy;
+    uint16_t freqIdx;
+    uint64_t delta;
+};
+
+// Per-uid CPU freq times as of the last call to getUidsCpuFreqTimeDeltas, to compute the next
+// deltas from. Starts empty.
+struct uid_cpu_freq_times_snapshot_t {
+    uint64_t lastUpdate = 0;
+    std::unordered_map<uint32_t, std::vector<uint64_t>> times;
+};
+
+bool getUidsCpuFreqTimeDeltas(uid_cpu_freq_times_snapshot_t *snapshot,
+                              std::vector<uid_cpu_freq_time_delta_t> *deltas);
+
 struct concurrent_time_t {
     std::vector<uint64_t> active;
     std::vector<std::vector<uint64_t>> policy;
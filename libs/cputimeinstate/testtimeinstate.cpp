@@ -209,6 +209,58 @@ TEST_F(TimeInStateTest, AllUidUpdatedTimeInState) {
     }
 }
 
+TEST_F(TimeInStateTest, AllUidTimeInStateDeltas) {
+    uid_cpu_freq_times_snapshot_t snapshot;
+    std::vector<uid_cpu_freq_time_delta_t> deltas;
+    ASSERT_TRUE(getUidsCpuFreqTimeDeltas(&snapshot, &deltas));
+    ASSERT_FALSE(deltas.empty());
+    ASSERT_NE(snapshot.lastUpdate, (uint64_t)0);
+
+    // The first deltas are the totals so far, which can only have grown since.
+    auto map = getUidsCpuFreqTimes();
+    ASSERT_TRUE(map.has_value());
+    for (const auto &delta : deltas) {
+        ASSERT_NE(map->find(delta.uid), map->end());
+        const auto &times = (*map)[delta.uid];
+        ASSERT_LT(delta.policy, times.size());
+        ASSERT_LT(delta.freqIdx, times[delta.policy].size());
+        ASSERT_GT(delta.delta, (uint64_t)0);
+        ASSERT_LE(delta.delta, times[delta.policy][delta.freqIdx]);
+    }
+
+    // Sleep briefly to trigger a context switch, ensuring we see at least one update.
+    struct timespec ts;
+    ts.tv_sec = 0;
+    ts.tv_nsec = 1000000;
+    nanosleep(&ts, NULL);
+
+    auto freqs = getCpuFreqs();
+    ASSERT_TRUE(freqs.has_value());
+    std::vector<uint32_t> policyOffsets;
+    uint32_t nFreqs = 0;
+    for (const auto &freqList : *freqs) {
+        policyOffsets.push_back(nFreqs);
+        nFreqs += freqList.size();
+    }
+
+    // Adding the new deltas to the old snapshot gives the new snapshot.
+    auto times = snapshot.times;
+    ASSERT_TRUE(getUidsCpuFreqTimeDeltas(&snapshot, &deltas));
+    ASSERT_FALSE(deltas.empty());
+    for (const auto &delta : deltas) {
+        ASSERT_GT(delta.delta, (uint64_t)0);
+        ASSERT_LE(delta.delta, NSEC_PER_YEAR);
+        auto &uidTimes = times[delta.uid];
+        uidTimes.resize(nFreqs);
+        uidTimes[policyOffsets[delta.policy] + delta.freqIdx] += delta.delta;
+    }
+    for (const auto &delta : deltas) {
+        ASSERT_NE(snapshot.times.find(delta.uid), snapshot.times.end());
+        const uint32_t index = policyOffsets[delta.policy] + delta.freqIdx;
+        ASSERT_EQ(times[delta.uid][index], snapshot.times[delta.uid][index]);
+    }
+}
+
 TEST_F(TimeInStateTest, TotalAndAllUidTimeInStateConsistent) {
     auto allUid = getUidsCpuFreqTimes();
     auto total = getTotalCpuFreqTimes();
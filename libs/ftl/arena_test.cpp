@@ -0,0 +1,113 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <ftl/arena.h>
+#include <ftl/small_map.h>
+#include <ftl/small_vector.h>
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+
+using namespace std::string_literals;
+
+namespace android::test {
+
+using ftl::Arena;
+using ftl::ArenaAllocator;
+
+// Keep in sync with example usage in header file.
+TEST(Arena, Example) {
+  ftl::Arena arena;
+
+  ftl::SmallVector<int, 2, ftl::ArenaAllocator<int>> vector(arena);
+  vector.push_back(1);
+  vector.push_back(2);
+  EXPECT_FALSE(vector.dynamic());
+  EXPECT_EQ(arena.bytes_allocated(), 0u);
+
+  vector.push_back(3);
+  EXPECT_TRUE(vector.dynamic());
+  EXPECT_GT(arena.bytes_allocated(), 0u);
+
+  vector.clear();
+  arena.reset();
+  EXPECT_EQ(arena.bytes_allocated(), 0u);
+}
+
+TEST(Arena, Alignment) {
+  Arena arena(64);
+
+  void* const byte = arena.allocate(1, 1);
+  void* const word = arena.allocate(8, 8);
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(word) % 8, 0u);
+  EXPECT_NE(byte, word);
+
+  // Allocations larger than a chunk get a chunk of their own.
+  void* const large = arena.allocate(100, 16);
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(large) % 16, 0u);
+  EXPECT_EQ(arena.bytes_allocated(), 109u);
+}
+
+TEST(Arena, ResetReusesChunks) {
+  Arena arena(128);
+
+  void* const first = arena.allocate(100, 8);
+  arena.allocate(100, 8);
+  const std::size_t reserved = arena.bytes_reserved();
+  EXPECT_GE(reserved, 200u);
+
+  arena.reset();
+  EXPECT_EQ(arena.allocate(100, 8), first);
+  arena.allocate(100, 8);
+  EXPECT_EQ(arena.bytes_reserved(), reserved);
+}
+
+TEST(Arena, SmallVector) {
+  Arena arena;
+  using Vector = ftl::SmallVector<std::string, 1, ArenaAllocator<std::string>>;
+
+  Vector vector(arena);
+  for (int i = 0; i < 10; ++i) vector.emplace_back(std::to_string(i));
+  EXPECT_TRUE(vector.dynamic());
+  EXPECT_EQ(&vector.get_allocator().arena(), &arena);
+
+  // The allocator propagates on move, so the elements stay in the arena.
+  const std::string* const data = &vector.front();
+  Vector moved = std::move(vector);
+  EXPECT_EQ(&moved.front(), data);
+  EXPECT_EQ(moved.size(), 10u);
+
+  // Comparison ignores the allocator.
+  EXPECT_EQ(moved, (ftl::SmallVector{"0"s, "1"s, "2"s, "3"s, "4"s, "5"s, "6"s, "7"s, "8"s, "9"s}));
+
+  const auto vector2 = std::move(moved).promote();
+  EXPECT_EQ(vector2.get_allocator(), ArenaAllocator<std::string>(arena));
+}
+
+TEST(Arena, SmallMap) {
+  Arena arena;
+  ftl::SmallMap<int, char, 2, std::equal_to<int>, ArenaAllocator<std::pair<const int, char>>> map(
+      arena);
+
+  for (int i = 0; i < 5; ++i) map.try_emplace(i, static_cast<char>('a' + i));
+  EXPECT_TRUE(map.dynamic());
+  EXPECT_GT(arena.bytes_allocated(), 0u);
+
+  EXPECT_EQ(map, ftl::SmallMap(ftl::init::map(4, 'e')(3, 'd')(2, 'c')(1, 'b')(0, 'a')));
+}
+
+}  // namespace android::test
@@ -0,0 +1,123 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <ftl/mpsc_queue.h>
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace android::test {
+
+using ftl::MpscQueue;
+using ftl::QueuePolicy;
+
+// Keep in sync with example usage in header file.
+TEST(MpscQueue, Example) {
+  ftl::MpscQueue<std::string, 8> queue;
+
+  std::thread producer([&queue] { queue.try_emplace("abc"); });
+  queue.try_push("def");
+  producer.join();
+
+  EXPECT_EQ(queue.size(), 2u);
+  EXPECT_TRUE(queue.try_pop());
+  EXPECT_TRUE(queue.try_pop());
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST(MpscQueue, Full) {
+  MpscQueue<std::unique_ptr<int>, 2> queue;
+  EXPECT_TRUE(queue.try_push(std::make_unique<int>(1)));
+  EXPECT_TRUE(queue.try_emplace(new int(2)));
+
+  // The argument is not consumed on failure.
+  auto ptr = std::make_unique<int>(3);
+  EXPECT_FALSE(queue.try_push(std::move(ptr)));
+  ASSERT_TRUE(ptr);
+  EXPECT_EQ(queue.size(), 2u);
+
+  EXPECT_EQ(**queue.try_pop(), 1);
+  EXPECT_TRUE(queue.try_push(std::move(ptr)));
+  EXPECT_EQ(**queue.try_pop(), 2);
+  EXPECT_EQ(**queue.try_pop(), 3);
+  EXPECT_FALSE(queue.try_pop());
+}
+
+TEST(MpscQueue, DestroysElements) {
+  const auto shared = std::make_shared<int>(0);
+  {
+    MpscQueue<std::shared_ptr<int>, 4> queue;
+    for (int i = 0; i < 3; ++i) {
+      queue.try_push(shared);
+      queue.try_push(shared);
+      queue.try_pop();
+    }
+    EXPECT_EQ(shared.use_count(), 4);
+  }
+  EXPECT_EQ(shared.use_count(), 1);
+}
+
+// Each producer pushes increasing values tagged with its index, so the consumer can check that
+// nothing is lost or reordered within a producer.
+template <QueuePolicy Policy>
+void testConcurrent() {
+  constexpr int kProducers = 4;
+  constexpr int kCount = 50'000;
+  MpscQueue<std::pair<int, int>, 16, Policy> queue;
+
+  std::vector<std::thread> producers;
+  for (int p = 0; p < kProducers; ++p) {
+    producers.emplace_back([&queue, p] {
+      for (int i = 0; i < kCount; ++i) {
+        if constexpr (Policy == QueuePolicy::kBlocking) {
+          queue.emplace(p, i);
+        } else {
+          while (!queue.try_emplace(p, i)) std::this_thread::yield();
+        }
+      }
+    });
+  }
+
+  std::vector<int> expected(kProducers, 0);
+  for (int n = 0; n < kProducers * kCount; ++n) {
+    std::pair<int, int> value;
+    if constexpr (Policy == QueuePolicy::kBlocking) {
+      value = queue.pop();
+    } else {
+      std::optional<std::pair<int, int>> opt;
+      while (!(opt = queue.try_pop())) std::this_thread::yield();
+      value = *opt;
+    }
+    const auto [p, i] = value;
+    ASSERT_EQ(i, expected[p]++);
+  }
+
+  for (auto& producer : producers) producer.join();
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST(MpscQueue, Concurrent) {
+  testConcurrent<QueuePolicy::kNonBlocking>();
+}
+
+TEST(MpscQueue, Blocking) {
+  testConcurrent<QueuePolicy::kBlocking>();
+}
+
+}  // namespace android::test
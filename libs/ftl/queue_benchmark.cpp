@@ -0,0 +1,130 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <ftl/mpsc_queue.h>
+#include <ftl/spsc_queue.h>
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+namespace android {
+namespace {
+
+constexpr size_t kCapacity = 256;
+
+// The locked deque that the ftl queues replace.
+class LockedQueue {
+public:
+    bool try_push(int64_t value) {
+        std::lock_guard lock(mMutex);
+        mQueue.push_back(value);
+        return true;
+    }
+
+    std::optional<int64_t> try_pop() {
+        std::lock_guard lock(mMutex);
+        if (mQueue.empty()) return std::nullopt;
+        const int64_t value = mQueue.front();
+        mQueue.pop_front();
+        return value;
+    }
+
+private:
+    std::mutex mMutex;
+    std::deque<int64_t> mQueue;
+};
+
+// Pushes and pops a burst on one thread, which measures the cost of the operations themselves.
+template <typename Queue>
+void roundTrip(benchmark::State& state) {
+    const int64_t burst = state.range(0);
+    Queue queue;
+
+    for (auto _ : state) {
+        for (int64_t i = 0; i < burst; i++) {
+            queue.try_push(i);
+        }
+        for (int64_t i = 0; i < burst; i++) {
+            benchmark::DoNotOptimize(queue.try_pop());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * burst);
+}
+
+void BM_LockedQueueRoundTrip(benchmark::State& state) {
+    roundTrip<LockedQueue>(state);
+}
+BENCHMARK(BM_LockedQueueRoundTrip)->Arg(1)->Arg(64);
+
+void BM_SpscQueueRoundTrip(benchmark::State& state) {
+    roundTrip<ftl::SpscQueue<int64_t, kCapacity>>(state);
+}
+BENCHMARK(BM_SpscQueueRoundTrip)->Arg(1)->Arg(64);
+
+void BM_MpscQueueRoundTrip(benchmark::State& state) {
+    roundTrip<ftl::MpscQueue<int64_t, kCapacity>>(state);
+}
+BENCHMARK(BM_MpscQueueRoundTrip)->Arg(1)->Arg(64);
+
+void BM_BlockingSpscQueueRoundTrip(benchmark::State& state) {
+    roundTrip<ftl::SpscQueue<int64_t, kCapacity, ftl::QueuePolicy::kBlocking>>(state);
+}
+BENCHMARK(BM_BlockingSpscQueueRoundTrip)->Arg(1)->Arg(64);
+
+// Streams values from a producer thread to the benchmark thread, which blocks while the queue is
+// empty.
+template <typename Queue>
+void stream(benchmark::State& state) {
+    Queue queue;
+    std::atomic<bool> stop = false;
+
+    std::thread producer([&] {
+        for (int64_t i = 0; !stop.load(std::memory_order_relaxed);) {
+            if (queue.try_push(i)) {
+                i++;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(queue.pop());
+    }
+
+    stop = true;
+    producer.join();
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_SpscQueueStream(benchmark::State& state) {
+    stream<ftl::SpscQueue<int64_t, kCapacity, ftl::QueuePolicy::kBlocking>>(state);
+}
+BENCHMARK(BM_SpscQueueStream);
+
+void BM_MpscQueueStream(benchmark::State& state) {
+    stream<ftl::MpscQueue<int64_t, kCapacity, ftl::QueuePolicy::kBlocking>>(state);
+}
+BENCHMARK(BM_MpscQueueStream);
+
+} // namespace
+} // namespace android
@@ -32,6 +32,17 @@ TEST(SharedMutex, ExclusiveLock) {
   std::unique_lock unique_lock(mutex);
 }
 
+TEST(SharedMutex, TryLock) {
+  ftl::SharedMutex mutex;
+  ASSERT_TRUE(mutex.try_lock_shared());
+  EXPECT_FALSE(mutex.try_lock());
+  mutex.unlock_shared();
+
+  ASSERT_TRUE(mutex.try_lock());
+  EXPECT_FALSE(mutex.try_lock_shared());
+  mutex.unlock();
+}
+
 TEST(SharedMutex, Annotations) {
   struct {
     void foo() FTL_ATTRIBUTE(requires_shared_capability(mutex)) { num++; }
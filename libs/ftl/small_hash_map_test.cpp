@@ -0,0 +1,153 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <ftl/small_hash_map.h>
+#include <gtest/gtest.h>
+
+#include <string>
+#include <unordered_map>
+
+using namespace std::string_literals;
+
+namespace android::test {
+
+using ftl::SmallHashMap;
+
+// Keep in sync with example usage in header file.
+TEST(SmallHashMap, Example) {
+  ftl::SmallHashMap<int, std::string, 4> map;
+  EXPECT_TRUE(map.empty());
+  EXPECT_FALSE(map.dynamic());
+  EXPECT_FALSE(map.indexed());
+
+  for (int i = 0; i < 64; ++i) map.try_emplace(i, std::to_string(i));
+  EXPECT_TRUE(map.dynamic());
+  EXPECT_TRUE(map.indexed());
+
+  EXPECT_EQ(map.get(42)->get(), "42");
+  EXPECT_TRUE(map.erase(42));
+  EXPECT_FALSE(map.contains(42));
+}
+
+TEST(SmallHashMap, Construct) {
+  SmallHashMap map = ftl::init::map(123, "abc"s)(456, "def"s)(123, "ghi"s);
+  static_assert(std::is_same_v<decltype(map), SmallHashMap<int, std::string, 3>>);
+
+  // Duplicate keys are dropped, as in SmallMap.
+  EXPECT_EQ(map.size(), 2u);
+  EXPECT_EQ(map.get(123)->get(), "abc");
+  EXPECT_EQ(map.get(456)->get(), "def");
+  EXPECT_FALSE(map.indexed());
+}
+
+TEST(SmallHashMap, IndexedOnlyPastThreshold) {
+  SmallHashMap<int, int, 4> map;
+  for (int i = 0; i < static_cast<int>(decltype(map)::kLinearSearchMax); ++i) {
+    map.try_emplace(i, i);
+  }
+  EXPECT_FALSE(map.indexed());
+
+  map.try_emplace(-1, -1);
+  EXPECT_TRUE(map.indexed());
+
+  map.clear();
+  EXPECT_TRUE(map.empty());
+  EXPECT_FALSE(map.indexed());
+}
+
+TEST(SmallHashMap, TryEmplace) {
+  SmallHashMap<int, std::string, 2> map;
+  for (int i = 0; i < 32; ++i) {
+    const auto [it, ok] = map.try_emplace(i * 7, std::to_string(i));
+    EXPECT_TRUE(ok);
+    EXPECT_EQ(it->first, i * 7);
+  }
+
+  const auto [it, ok] = map.try_emplace(7, "other");
+  EXPECT_FALSE(ok);
+  EXPECT_EQ(it->second, "1");
+
+  for (int i = 0; i < 32; ++i) {
+    EXPECT_EQ(map.get(i * 7)->get(), std::to_string(i));
+    EXPECT_FALSE(map.contains(i * 7 + 1));
+  }
+}
+
+TEST(SmallHashMap, Replace) {
+  SmallHashMap<int, std::string, 2> map;
+  for (int i = 0; i < 16; ++i) map.try_emplace(i, "x");
+
+  EXPECT_NE(map.try_replace(3, "three"), map.end());
+  EXPECT_EQ(map.try_replace(16, "sixteen"), map.end());
+  EXPECT_EQ(map.get(3)->get(), "three");
+
+  EXPECT_FALSE(map.emplace_or_replace(4, "four").second);
+  EXPECT_TRUE(map.emplace_or_replace(16, "sixteen").second);
+  EXPECT_EQ(map.get(4)->get(), "four");
+  EXPECT_EQ(map.get(16)->get(), "sixteen");
+}
+
+// Erases keys in an order that exercises moving the last mapping and shifting back probe chains,
+// checking against std::unordered_map after every step.
+TEST(SmallHashMap, EraseMatchesReference) {
+  SmallHashMap<int, int, 4> map;
+  std::unordered_map<int, int> reference;
+
+  for (int i = 0; i < 200; ++i) {
+    const int key = (i * 37) % 101 + (i % 3) * 1024;
+    map.emplace_or_replace(key, i);
+    reference[key] = i;
+
+    if (i % 5 == 4) {
+      const int victim = (i * 13) % 101 + ((i + 1) % 3) * 1024;
+      EXPECT_EQ(map.erase(victim), reference.erase(victim) == 1u);
+    }
+
+    ASSERT_EQ(map.size(), reference.size());
+    for (const auto& [k, v] : reference) {
+      ASSERT_EQ(map.get(k), v) << k;
+    }
+  }
+
+  while (!reference.empty()) {
+    const int key = reference.begin()->first;
+    reference.erase(reference.begin());
+    EXPECT_TRUE(map.erase(key));
+    EXPECT_FALSE(map.erase(key));
+    for (const auto& [k, v] : reference) {
+      ASSERT_EQ(map.get(k), v) << k;
+    }
+  }
+  EXPECT_TRUE(map.empty());
+}
+
+TEST(SmallHashMap, CopyKeepsIndex) {
+  SmallHashMap<int, int, 4> map;
+  for (int i = 0; i < 32; ++i) map.try_emplace(i, -i);
+
+  SmallHashMap<int, int, 4> copy = map;
+  EXPECT_TRUE(copy.indexed());
+  EXPECT_EQ(copy, map);
+
+  const SmallHashMap<int, int, 64> converted = map;
+  EXPECT_TRUE(converted.indexed());
+  EXPECT_EQ(converted, map);
+
+  map.erase(0);
+  EXPECT_NE(copy, map);
+}
+
+}  // namespace android::test
@@ -0,0 +1,97 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <ftl/small_hash_map.h>
+#include <ftl/small_map.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace android {
+namespace {
+
+// Keys spread like display IDs, i.e. sparse 64-bit values rather than small integers.
+std::vector<uint64_t> makeKeys(size_t count) {
+    std::vector<uint64_t> keys;
+    keys.reserve(count);
+    for (uint64_t i = 0; i < count; i++) {
+        keys.push_back((i + 1) * 0x4f1bbcdcbfa53e0bull);
+    }
+    return keys;
+}
+
+// Looks up every key once per iteration. Half of the lookups miss, as when probing for a display
+// that was just hotplugged.
+template <typename Map>
+void lookup(benchmark::State& state) {
+    const size_t count = static_cast<size_t>(state.range(0));
+    const std::vector<uint64_t> keys = makeKeys(2 * count);
+
+    Map map;
+    for (size_t i = 0; i < count; i++) {
+        map.try_emplace(keys[2 * i], static_cast<int>(i));
+    }
+
+    for (auto _ : state) {
+        for (uint64_t key : keys) {
+            benchmark::DoNotOptimize(map.contains(key));
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * keys.size()));
+}
+
+void BM_SmallMapLookup(benchmark::State& state) {
+    lookup<ftl::SmallMap<uint64_t, int, 4>>(state);
+}
+BENCHMARK(BM_SmallMapLookup)->Arg(4)->Arg(16)->Arg(64);
+
+void BM_SmallHashMapLookup(benchmark::State& state) {
+    lookup<ftl::SmallHashMap<uint64_t, int, 4>>(state);
+}
+BENCHMARK(BM_SmallHashMapLookup)->Arg(4)->Arg(16)->Arg(64);
+
+// Builds the map from scratch, which is what a display-keyed map in SurfaceFlinger mostly does on
+// each commit.
+template <typename Map>
+void build(benchmark::State& state) {
+    const size_t count = static_cast<size_t>(state.range(0));
+    const std::vector<uint64_t> keys = makeKeys(count);
+
+    for (auto _ : state) {
+        Map map;
+        for (size_t i = 0; i < count; i++) {
+            map.try_emplace(keys[i], static_cast<int>(i));
+        }
+        benchmark::DoNotOptimize(map);
+    }
+}
+
+void BM_SmallMapBuild(benchmark::State& state) {
+    build<ftl::SmallMap<uint64_t, int, 4>>(state);
+}
+BENCHMARK(BM_SmallMapBuild)->Arg(4)->Arg(16)->Arg(64);
+
+void BM_SmallHashMapBuild(benchmark::State& state) {
+    build<ftl::SmallHashMap<uint64_t, int, 4>>(state);
+}
+BENCHMARK(BM_SmallHashMapBuild)->Arg(4)->Arg(16)->Arg(64);
+
+} // namespace
+} // namespace android
+
+BENCHMARK_MAIN();
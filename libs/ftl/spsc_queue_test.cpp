@@ -0,0 +1,125 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <ftl/spsc_queue.h>
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace android::test {
+
+using ftl::QueuePolicy;
+using ftl::SpscQueue;
+
+// Keep in sync with example usage in header file.
+TEST(SpscQueue, Example) {
+  ftl::SpscQueue<int, 4> queue;
+  EXPECT_TRUE(queue.empty());
+
+  EXPECT_TRUE(queue.try_push(1));
+  EXPECT_TRUE(queue.try_emplace(2));
+  EXPECT_EQ(queue.size(), 2u);
+
+  EXPECT_EQ(queue.try_pop(), 1);
+  EXPECT_EQ(queue.try_pop(), 2);
+  EXPECT_FALSE(queue.try_pop());
+}
+
+TEST(SpscQueue, Full) {
+  SpscQueue<std::unique_ptr<int>, 2> queue;
+  EXPECT_TRUE(queue.try_push(std::make_unique<int>(1)));
+  EXPECT_TRUE(queue.try_emplace(new int(2)));
+
+  // The argument is not consumed on failure.
+  auto ptr = std::make_unique<int>(3);
+  EXPECT_FALSE(queue.try_push(std::move(ptr)));
+  ASSERT_TRUE(ptr);
+  EXPECT_EQ(queue.size(), 2u);
+
+  EXPECT_EQ(**queue.try_pop(), 1);
+  EXPECT_TRUE(queue.try_push(std::move(ptr)));
+  EXPECT_EQ(**queue.try_pop(), 2);
+  EXPECT_EQ(**queue.try_pop(), 3);
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST(SpscQueue, WrapAround) {
+  SpscQueue<std::string, 4> queue;
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_TRUE(queue.try_emplace(3u, static_cast<char>('a' + i % 26)));
+    EXPECT_TRUE(queue.try_push(std::to_string(i)));
+    EXPECT_EQ(queue.try_pop(), std::string(3u, static_cast<char>('a' + i % 26)));
+    EXPECT_EQ(queue.try_pop(), std::to_string(i));
+  }
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST(SpscQueue, DestroysElements) {
+  const auto shared = std::make_shared<int>(0);
+  {
+    SpscQueue<std::shared_ptr<int>, 8> queue;
+    for (int i = 0; i < 5; ++i) queue.try_push(shared);
+    queue.try_pop();
+    EXPECT_EQ(shared.use_count(), 5);
+  }
+  EXPECT_EQ(shared.use_count(), 1);
+}
+
+TEST(SpscQueue, Concurrent) {
+  constexpr int kCount = 100'000;
+  SpscQueue<int, 64> queue;
+
+  std::thread producer([&queue] {
+    for (int i = 0; i < kCount;) {
+      if (queue.try_push(i)) {
+        ++i;
+      } else {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  for (int expected = 0; expected < kCount;) {
+    if (const auto value = queue.try_pop()) {
+      ASSERT_EQ(*value, expected++);
+    } else {
+      std::this_thread::yield();
+    }
+  }
+
+  producer.join();
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST(SpscQueue, Blocking) {
+  constexpr int kCount = 100'000;
+  SpscQueue<int, 4, QueuePolicy::kBlocking> queue;
+
+  std::thread producer([&queue] {
+    for (int i = 0; i < kCount; ++i) queue.push(i);
+  });
+
+  for (int expected = 0; expected < kCount; ++expected) {
+    ASSERT_EQ(queue.pop(), expected);
+  }
+
+  producer.join();
+  EXPECT_TRUE(queue.empty());
+}
+
+}  // namespace android::test
@@ -248,8 +248,7 @@ BLASTBufferQueue::~BLASTBufferQueue() {
              static_cast<uint32_t>(mPendingTransactions.size()));
     SurfaceComposerClient::Transaction t;
     mergePendingTransactions(&t, std::numeric_limits<uint64_t>::max() /* frameNumber */);
-    // All transactions on our apply token are one-way. See comment on mAppliedLastTransaction
-    t.setApplyToken(mApplyToken).apply(false, true);
+    applyTransactionLocked(&t);
 
     if (mTransactionReadyCallback) {
         mTransactionReadyCallback(mSyncTransaction);
@@ -312,8 +311,7 @@ void BLASTBufferQueue::update(const sp<SurfaceControl>& surface, uint32_t width,
         }
     }
     if (applyTransaction) {
-        // All transactions on our apply token are one-way. See comment on mAppliedLastTransaction
-        t.setApplyToken(mApplyToken).apply(false, true);
+        applyTransactionLocked(&t);
     }
 }
 
@@ -699,8 +697,13 @@ status_t BLASTBufferQueue::acquireNextBufferLocked(
 
     mergePendingTransactions(t, bufferItem.mFrameNumber);
     if (applyTransaction) {
-        // All transactions on our apply token are one-way. See comment on mAppliedLastTransaction
-        t->setApplyToken(mApplyToken).apply(false, true);
+        if (mTransactionBatcher) {
+            mTransactionBatcher->addFrameTransaction(this, t);
+        } else {
+            // All transactions on our apply token are one-way. See comment on
+            // mAppliedLastTransaction
+            t->setApplyToken(mApplyToken).apply(false, true);
+        }
         mAppliedLastTransaction = true;
         mLastAppliedFrameNumber = bufferItem.mFrameNumber;
     } else {
@@ -1027,8 +1030,18 @@ void BLASTBufferQueue::applyPendingTransactions(uint64_t frameNumber) {
 
     SurfaceComposerClient::Transaction t;
     mergePendingTransactions(&t, frameNumber);
+    applyTransactionLocked(&t);
+}
+
+void BLASTBufferQueue::applyTransactionLocked(SurfaceComposerClient::Transaction* t) {
+    if (mTransactionBatcher) {
+        // Frames of ours may still be pending in the batcher, so apply through it to keep this
+        // transaction after them.
+        mTransactionBatcher->applyNow(t);
+        return;
+    }
     // All transactions on our apply token are one-way. See comment on mAppliedLastTransaction
-    t.setApplyToken(mApplyToken).apply(false, true);
+    t->setApplyToken(mApplyToken).apply(false, true);
 }
 
 void BLASTBufferQueue::mergePendingTransactions(SurfaceComposerClient::Transaction* t,
@@ -1260,6 +1273,57 @@ void BLASTBufferQueue::setApplyToken(sp<IBinder> applyToken) {
     mApplyToken = std::move(applyToken);
 }
 
+void BLASTBufferQueue::setTransactionBatcher(sp<BLASTTransactionBatcher> batcher) {
+    std::lock_guard _lock{mMutex};
+    if (mTransactionBatcher == batcher) {
+        return;
+    }
+    if (mTransactionBatcher) {
+        // Flush our pending frames on the old token before anything is applied on the new one.
+        mTransactionBatcher->apply();
+    }
+    mTransactionBatcher = std::move(batcher);
+    // When detaching, keep the batcher's token so later applies stay ordered after the batch.
+    if (mTransactionBatcher) {
+        mApplyToken = mTransactionBatcher->getApplyToken();
+    }
+}
+
+void BLASTTransactionBatcher::apply() {
+    std::lock_guard _lock{mMutex};
+    applyLocked();
+}
+
+void BLASTTransactionBatcher::addFrameTransaction(const BLASTBufferQueue* queue,
+                                                  SurfaceComposerClient::Transaction* t) {
+    std::lock_guard _lock{mMutex};
+    if (!mPendingQueues.insert(queue).second) {
+        applyLocked();
+        mPendingQueues.insert(queue);
+    }
+    mTransaction.merge(std::move(*t));
+    mHasPendingTransaction = true;
+}
+
+void BLASTTransactionBatcher::applyNow(SurfaceComposerClient::Transaction* t) {
+    std::lock_guard _lock{mMutex};
+    mTransaction.merge(std::move(*t));
+    mHasPendingTransaction = true;
+    applyLocked();
+}
+
+void BLASTTransactionBatcher::applyLocked() {
+    mPendingQueues.clear();
+    if (!mHasPendingTransaction) {
+        return;
+    }
+    mHasPendingTransaction = false;
+    ATRACE_CALL();
+    // Like the per-queue applies this replaces, the batch is sent one-way on a token that only
+    // batched queues use.
+    mTransaction.setApplyToken(mApplyToken).apply(false, true);
+}
+
 #if COM_ANDROID_GRAPHICS_LIBGUI_FLAGS(BUFFER_RELEASE_CHANNEL)
 
 BLASTBufferQueue::BufferReleaseReader::BufferReleaseReader(
@@ -1312,6 +1376,14 @@ BLASTBufferQueue::BufferReleaseReader& BLASTBufferQueue::BufferReleaseReader::op
 status_t BLASTBufferQueue::BufferReleaseReader::readBlocking(ReleaseCallbackId& outId,
                                                              sp<Fence>& outFence,
                                                              uint32_t& outMaxAcquiredBufferCount) {
+    {
+        // Release fences received along with the last one are not signaled by epoll.
+        std::lock_guard lock{mMutex};
+        if (mEndpoint->hasPendingReleaseFences()) {
+            return mEndpoint->readReleaseFence(outId, outFence, outMaxAcquiredBufferCount);
+        }
+    }
+
     epoll_event event{};
     while (true) {
         int eventCount = epoll_wait(mEpollFd.get(), &event, 1 /* maxevents */, -1 /* timeout */);
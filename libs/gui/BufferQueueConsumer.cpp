@@ -82,7 +82,8 @@ status_t BufferQueueConsumer::acquireBuffer(BufferItem* outBuffer,
     int numDroppedBuffers = 0;
     sp<IProducerListener> listener;
     {
-        std::unique_lock<std::mutex> lock(mCore->mMutex);
+        std::unique_lock<std::mutex> lock = mCore->lockTracked(mCore->mAcquireLockContention);
+        BufferQueueCore::LockHoldTimer holdTimer(mCore->mAcquireLockHoldLatency);
 
         // Check that the consumer doesn't currently have the maximum number of
         // buffers acquired. We allow the max buffer count to be exceeded by one
@@ -270,6 +271,15 @@ status_t BufferQueueConsumer::acquireBuffer(BufferItem* outBuffer,
         BQ_LOGV("acquireBuffer: acquiring { slot=%d/%" PRIu64 " buffer=%p }",
                 slot, outBuffer->mFrameNumber, outBuffer->mGraphicBuffer->handle);
 
+        if (outBuffer->mQueuedBuffer) {
+            const nsecs_t queueToAcquire =
+                    systemTime(SYSTEM_TIME_MONOTONIC) - mSlots[slot].mQueueTime;
+            mCore->mQueueToAcquireLatency.record(queueToAcquire);
+            if (ATRACE_ENABLED()) {
+                ATRACE_INT64((mCore->mConsumerName + " queueToAcquire").c_str(), queueToAcquire);
+            }
+        }
+
         if (!outBuffer->mIsStale) {
             mSlots[slot].mAcquireCalled = true;
             // Don't decrease the queue count if the BufferItem wasn't
@@ -159,6 +159,19 @@ void BufferQueueCore::dumpState(const String8& prefix, String8* outResult) const
                             mTransformHint, mFrameCounter);
     outResult->appendFormat("%s  mTransformHintInUse=%02x mAutoPrerotation=%d\n", prefix.c_str(),
                             mTransformHintInUse, mAutoPrerotation);
+    const auto dumpContention = [&](const char* name, const LockContention& contention) {
+        outResult->appendFormat("%s  %s lock contended=%" PRIu64 "/%" PRIu64 " waited=%.3fms\n",
+                                prefix.c_str(), name,
+                                contention.contended.load(std::memory_order_relaxed),
+                                contention.acquisitions.load(std::memory_order_relaxed),
+                                contention.waitTime.load(std::memory_order_relaxed) / 1e6);
+    };
+    dumpContention("queue", mQueueLockContention);
+    dumpContention("acquire", mAcquireLockContention);
+    mDequeueWaitLatency.dump(outResult, prefix, "dequeue wait");
+    mQueueToAcquireLatency.dump(outResult, prefix, "queue-to-acquire");
+    mQueueLockHoldLatency.dump(outResult, prefix, "queue lock held");
+    mAcquireLockHoldLatency.dump(outResult, prefix, "acquire lock held");
 
     outResult->appendFormat("%sFIFO(%zu):\n", prefix.c_str(), mQueue.size());
 
@@ -370,6 +383,56 @@ void BufferQueueCore::waitWhileAllocatingLocked(std::unique_lock<std::mutex>& lo
     }
 }
 
+std::unique_lock<std::mutex> BufferQueueCore::lockTracked(LockContention& contention) const {
+    contention.acquisitions.fetch_add(1, std::memory_order_relaxed);
+    std::unique_lock<std::mutex> lock(mMutex, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        ATRACE_NAME("BufferQueueCore lock contended");
+        const nsecs_t start = systemTime(SYSTEM_TIME_MONOTONIC);
+        lock.lock();
+        contention.contended.fetch_add(1, std::memory_order_relaxed);
+        contention.waitTime.fetch_add(systemTime(SYSTEM_TIME_MONOTONIC) - start,
+                                      std::memory_order_relaxed);
+    }
+    return lock;
+}
+
+void BufferQueueCore::LatencyHistogram::record(nsecs_t latency) {
+    latency = std::max<nsecs_t>(latency, 0);
+    // Bucket 0 holds latencies under 1us, bucket i those in [2^(i-1), 2^i)us.
+    const uint64_t us = static_cast<uint64_t>(latency / 1000);
+    const size_t bucket = us == 0 ? 0 : static_cast<size_t>(64 - __builtin_clzll(us));
+    ++buckets[std::min(bucket, NUM_BUCKETS - 1)];
+    ++count;
+    total += latency;
+    max = std::max(max, latency);
+}
+
+void BufferQueueCore::LatencyHistogram::dump(String8* outResult, const std::string& prefix,
+                                             const char* name) const {
+    outResult->appendFormat("%s  %s latency count=%" PRIu64, prefix.c_str(), name, count);
+    if (count == 0) {
+        outResult->append("\n");
+        return;
+    }
+    outResult->appendFormat(" avg=%.3fms max=%.3fms [", total / 1e6 / count, max / 1e6);
+    // Only print the populated range of buckets, labelled by upper bound.
+    size_t first = 0;
+    while (buckets[first] == 0) ++first;
+    size_t last = NUM_BUCKETS - 1;
+    while (buckets[last] == 0) --last;
+    for (size_t i = first; i <= last; ++i) {
+        if (i == NUM_BUCKETS - 1) {
+            outResult->appendFormat("%s>=%" PRIu64 "us:%" PRIu64, i == first ? "" : " ",
+                                    uint64_t(1) << (i - 1), buckets[i]);
+        } else {
+            outResult->appendFormat("%s<%" PRIu64 "us:%" PRIu64, i == first ? "" : " ",
+                                    uint64_t(1) << i, buckets[i]);
+        }
+    }
+    outResult->append("]\n");
+}
+
 #if DEBUG_ONLY_CODE
 void BufferQueueCore::validateConsistencyLocked() const {
     static const useconds_t PAUSE_TIME = 0;
@@ -97,7 +97,23 @@ status_t BufferQueueProducer::requestBuffer(int slot, sp<GraphicBuffer>* buf) {
     ATRACE_CALL();
     BQ_LOGV("requestBuffer: slot %d", slot);
     std::lock_guard<std::mutex> lock(mCore->mMutex);
+    return requestBufferLocked(slot, buf);
+}
+
+status_t BufferQueueProducer::requestBuffers(const std::vector<int32_t>& slots,
+                                             std::vector<RequestBufferOutput>* outputs) {
+    ATRACE_CALL();
+    outputs->clear();
+    outputs->reserve(slots.size());
+    std::lock_guard<std::mutex> lock(mCore->mMutex);
+    for (int32_t slot : slots) {
+        RequestBufferOutput& output = outputs->emplace_back();
+        output.result = requestBufferLocked(static_cast<int>(slot), &output.buffer);
+    }
+    return NO_ERROR;
+}
 
+status_t BufferQueueProducer::requestBufferLocked(int slot, sp<GraphicBuffer>* buf) {
     if (mCore->mIsAbandoned) {
         BQ_LOGE("requestBuffer: BufferQueue has been abandoned");
         return NO_INIT;
@@ -463,7 +479,13 @@ status_t BufferQueueProducer::dequeueBuffer(int* outSlot, sp<android::Fence>* ou
 
         int found = BufferItem::INVALID_BUFFER_SLOT;
         while (found == BufferItem::INVALID_BUFFER_SLOT) {
+            const nsecs_t waitStart = systemTime(SYSTEM_TIME_MONOTONIC);
             status_t status = waitForFreeSlotThenRelock(FreeSlotCaller::Dequeue, lock, &found);
+            const nsecs_t waitTime = systemTime(SYSTEM_TIME_MONOTONIC) - waitStart;
+            mCore->mDequeueWaitLatency.record(waitTime);
+            if (ATRACE_ENABLED()) {
+                ATRACE_INT64((mCore->mConsumerName + " dequeueWait").c_str(), waitTime);
+            }
             if (status != NO_ERROR) {
                 return status;
             }
@@ -884,11 +906,8 @@ status_t BufferQueueProducer::attachBuffer(int* outSlot,
     return returnFlags;
 }
 
-status_t BufferQueueProducer::queueBuffer(int slot,
-        const QueueBufferInput &input, QueueBufferOutput *output) {
-    ATRACE_CALL();
-    ATRACE_BUFFER_INDEX(slot);
-
+status_t BufferQueueProducer::queueBufferLocked(int slot, const QueueBufferInput& input,
+                                                QueueBufferOutput* output, QueuedFrame* frame) {
     int64_t requestedPresentTimestamp;
     bool isAutoTimestamp;
     android_dataspace dataSpace;
@@ -897,10 +916,9 @@ status_t BufferQueueProducer::queueBuffer(int slot,
     uint32_t transform;
     uint32_t stickyTransform;
     sp<Fence> acquireFence;
-    bool getFrameTimestamps = false;
     input.deflate(&requestedPresentTimestamp, &isAutoTimestamp, &dataSpace,
             &crop, &scalingMode, &transform, &acquireFence, &stickyTransform,
-            &getFrameTimestamps);
+            &frame->getFrameTimestamps);
     const Region& surfaceDamage = input.getSurfaceDamage();
     const HdrMetadata& hdrMetadata = input.getHdrMetadata();
 
@@ -909,8 +927,6 @@ status_t BufferQueueProducer::queueBuffer(int slot,
         return BAD_VALUE;
     }
 
-    auto acquireFenceTime = std::make_shared<FenceTime>(acquireFence);
-
     switch (scalingMode) {
         case NATIVE_WINDOW_SCALING_MODE_FREEZE:
         case NATIVE_WINDOW_SCALING_MODE_SCALE_TO_WINDOW:
@@ -922,213 +938,246 @@ status_t BufferQueueProducer::queueBuffer(int slot,
             return BAD_VALUE;
     }
 
-    sp<IConsumerListener> frameAvailableListener;
-    sp<IConsumerListener> frameReplacedListener;
-    int callbackTicket = 0;
-    uint64_t currentFrameNumber = 0;
-    BufferItem item;
-    int connectedApi;
-    bool enableEglCpuThrottling = true;
-    sp<Fence> lastQueuedFence;
-
-    { // Autolock scope
-        std::lock_guard<std::mutex> lock(mCore->mMutex);
-
-        if (mCore->mIsAbandoned) {
-            BQ_LOGE("queueBuffer: BufferQueue has been abandoned");
-            return NO_INIT;
-        }
+    if (mCore->mIsAbandoned) {
+        BQ_LOGE("queueBuffer: BufferQueue has been abandoned");
+        return NO_INIT;
+    }
 
-        if (mCore->mConnectedApi == BufferQueueCore::NO_CONNECTED_API) {
-            BQ_LOGE("queueBuffer: BufferQueue has no connected producer");
-            return NO_INIT;
-        }
+    if (mCore->mConnectedApi == BufferQueueCore::NO_CONNECTED_API) {
+        BQ_LOGE("queueBuffer: BufferQueue has no connected producer");
+        return NO_INIT;
+    }
 
-        if (slot < 0 || slot >= BufferQueueDefs::NUM_BUFFER_SLOTS) {
-            BQ_LOGE("queueBuffer: slot index %d out of range [0, %d)",
-                    slot, BufferQueueDefs::NUM_BUFFER_SLOTS);
-            return BAD_VALUE;
-        } else if (!mSlots[slot].mBufferState.isDequeued()) {
-            BQ_LOGE("queueBuffer: slot %d is not owned by the producer "
-                    "(state = %s)", slot, mSlots[slot].mBufferState.string());
-            return BAD_VALUE;
-        } else if (!mSlots[slot].mRequestBufferCalled) {
-            BQ_LOGE("queueBuffer: slot %d was queued without requesting "
-                    "a buffer", slot);
-            return BAD_VALUE;
-        }
+    if (slot < 0 || slot >= BufferQueueDefs::NUM_BUFFER_SLOTS) {
+        BQ_LOGE("queueBuffer: slot index %d out of range [0, %d)",
+                slot, BufferQueueDefs::NUM_BUFFER_SLOTS);
+        return BAD_VALUE;
+    } else if (!mSlots[slot].mBufferState.isDequeued()) {
+        BQ_LOGE("queueBuffer: slot %d is not owned by the producer "
+                "(state = %s)", slot, mSlots[slot].mBufferState.string());
+        return BAD_VALUE;
+    } else if (!mSlots[slot].mRequestBufferCalled) {
+        BQ_LOGE("queueBuffer: slot %d was queued without requesting "
+                "a buffer", slot);
+        return BAD_VALUE;
+    }
 
-        // If shared buffer mode has just been enabled, cache the slot of the
-        // first buffer that is queued and mark it as the shared buffer.
-        if (mCore->mSharedBufferMode && mCore->mSharedBufferSlot ==
-                BufferQueueCore::INVALID_BUFFER_SLOT) {
-            mCore->mSharedBufferSlot = slot;
-            mSlots[slot].mBufferState.mShared = true;
-        }
+    // If shared buffer mode has just been enabled, cache the slot of the
+    // first buffer that is queued and mark it as the shared buffer.
+    if (mCore->mSharedBufferMode && mCore->mSharedBufferSlot ==
+            BufferQueueCore::INVALID_BUFFER_SLOT) {
+        mCore->mSharedBufferSlot = slot;
+        mSlots[slot].mBufferState.mShared = true;
+    }
 
-        BQ_LOGV("queueBuffer: slot=%d/%" PRIu64 " time=%" PRIu64 " dataSpace=%d"
-                " validHdrMetadataTypes=0x%x crop=[%d,%d,%d,%d] transform=%#x scale=%s",
-                slot, mCore->mFrameCounter + 1, requestedPresentTimestamp, dataSpace,
-                hdrMetadata.validTypes, crop.left, crop.top, crop.right, crop.bottom,
-                transform,
-                BufferItem::scalingModeName(static_cast<uint32_t>(scalingMode)));
-
-        const sp<GraphicBuffer>& graphicBuffer(mSlots[slot].mGraphicBuffer);
-        Rect bufferRect(graphicBuffer->getWidth(), graphicBuffer->getHeight());
-        Rect croppedRect(Rect::EMPTY_RECT);
-        crop.intersect(bufferRect, &croppedRect);
-        if (croppedRect != crop) {
-            BQ_LOGE("queueBuffer: crop rect is not contained within the "
-                    "buffer in slot %d", slot);
-            return BAD_VALUE;
-        }
+    BQ_LOGV("queueBuffer: slot=%d/%" PRIu64 " time=%" PRIu64 " dataSpace=%d"
+            " validHdrMetadataTypes=0x%x crop=[%d,%d,%d,%d] transform=%#x scale=%s",
+            slot, mCore->mFrameCounter + 1, requestedPresentTimestamp, dataSpace,
+            hdrMetadata.validTypes, crop.left, crop.top, crop.right, crop.bottom,
+            transform,
+            BufferItem::scalingModeName(static_cast<uint32_t>(scalingMode)));
+
+    const sp<GraphicBuffer>& graphicBuffer(mSlots[slot].mGraphicBuffer);
+    Rect bufferRect(graphicBuffer->getWidth(), graphicBuffer->getHeight());
+    Rect croppedRect(Rect::EMPTY_RECT);
+    crop.intersect(bufferRect, &croppedRect);
+    if (croppedRect != crop) {
+        BQ_LOGE("queueBuffer: crop rect is not contained within the "
+                "buffer in slot %d", slot);
+        return BAD_VALUE;
+    }
 
-        // Override UNKNOWN dataspace with consumer default
-        if (dataSpace == HAL_DATASPACE_UNKNOWN) {
-            dataSpace = mCore->mDefaultBufferDataSpace;
-        }
+    // Override UNKNOWN dataspace with consumer default
+    if (dataSpace == HAL_DATASPACE_UNKNOWN) {
+        dataSpace = mCore->mDefaultBufferDataSpace;
+    }
 
-        mSlots[slot].mFence = acquireFence;
-        mSlots[slot].mBufferState.queue();
-
-        // Increment the frame counter and store a local version of it
-        // for use outside the lock on mCore->mMutex.
-        ++mCore->mFrameCounter;
-        currentFrameNumber = mCore->mFrameCounter;
-        mSlots[slot].mFrameNumber = currentFrameNumber;
-
-        item.mAcquireCalled = mSlots[slot].mAcquireCalled;
-        item.mGraphicBuffer = mSlots[slot].mGraphicBuffer;
-        item.mCrop = crop;
-        item.mTransform = transform &
-                ~static_cast<uint32_t>(NATIVE_WINDOW_TRANSFORM_INVERSE_DISPLAY);
-        item.mTransformToDisplayInverse =
-                (transform & NATIVE_WINDOW_TRANSFORM_INVERSE_DISPLAY) != 0;
-        item.mScalingMode = static_cast<uint32_t>(scalingMode);
-        item.mTimestamp = requestedPresentTimestamp;
-        item.mIsAutoTimestamp = isAutoTimestamp;
-        item.mDataSpace = dataSpace;
-        item.mHdrMetadata = hdrMetadata;
-        item.mFrameNumber = currentFrameNumber;
-        item.mSlot = slot;
-        item.mFence = acquireFence;
-        item.mFenceTime = acquireFenceTime;
-        item.mIsDroppable = mCore->mAsyncMode ||
-                (mConsumerIsSurfaceFlinger && mCore->mQueueBufferCanDrop) ||
-                (mCore->mLegacyBufferDrop && mCore->mQueueBufferCanDrop) ||
-                (mCore->mSharedBufferMode && mCore->mSharedBufferSlot == slot);
-        item.mSurfaceDamage = surfaceDamage;
-        item.mQueuedBuffer = true;
-        item.mAutoRefresh = mCore->mSharedBufferMode && mCore->mAutoRefresh;
-        item.mApi = mCore->mConnectedApi;
-
-        mStickyTransform = stickyTransform;
-
-        // Cache the shared buffer data so that the BufferItem can be recreated.
-        if (mCore->mSharedBufferMode) {
-            mCore->mSharedBufferCache.crop = crop;
-            mCore->mSharedBufferCache.transform = transform;
-            mCore->mSharedBufferCache.scalingMode = static_cast<uint32_t>(
-                    scalingMode);
-            mCore->mSharedBufferCache.dataspace = dataSpace;
-        }
+    frame->acquireFenceTime = std::make_shared<FenceTime>(acquireFence);
+    frame->requestedPresentTimestamp = requestedPresentTimestamp;
+
+    mSlots[slot].mFence = acquireFence;
+    mSlots[slot].mBufferState.queue();
+
+    // Increment the frame counter and store a local version of it
+    // for use outside the lock on mCore->mMutex.
+    ++mCore->mFrameCounter;
+    const uint64_t currentFrameNumber = mCore->mFrameCounter;
+    mSlots[slot].mFrameNumber = currentFrameNumber;
+    mSlots[slot].mQueueTime = systemTime(SYSTEM_TIME_MONOTONIC);
+
+    BufferItem& item = frame->item;
+    item.mAcquireCalled = mSlots[slot].mAcquireCalled;
+    item.mGraphicBuffer = mSlots[slot].mGraphicBuffer;
+    item.mCrop = crop;
+    item.mTransform = transform &
+            ~static_cast<uint32_t>(NATIVE_WINDOW_TRANSFORM_INVERSE_DISPLAY);
+    item.mTransformToDisplayInverse =
+            (transform & NATIVE_WINDOW_TRANSFORM_INVERSE_DISPLAY) != 0;
+    item.mScalingMode = static_cast<uint32_t>(scalingMode);
+    item.mTimestamp = requestedPresentTimestamp;
+    item.mIsAutoTimestamp = isAutoTimestamp;
+    item.mDataSpace = dataSpace;
+    item.mHdrMetadata = hdrMetadata;
+    item.mFrameNumber = currentFrameNumber;
+    item.mSlot = slot;
+    item.mFence = acquireFence;
+    item.mFenceTime = frame->acquireFenceTime;
+    item.mIsDroppable = mCore->mAsyncMode ||
+            (mConsumerIsSurfaceFlinger && mCore->mQueueBufferCanDrop) ||
+            (mCore->mLegacyBufferDrop && mCore->mQueueBufferCanDrop) ||
+            (mCore->mSharedBufferMode && mCore->mSharedBufferSlot == slot);
+    item.mSurfaceDamage = surfaceDamage;
+    item.mQueuedBuffer = true;
+    item.mAutoRefresh = mCore->mSharedBufferMode && mCore->mAutoRefresh;
+    item.mApi = mCore->mConnectedApi;
+
+    mStickyTransform = stickyTransform;
+
+    // Cache the shared buffer data so that the BufferItem can be recreated.
+    if (mCore->mSharedBufferMode) {
+        mCore->mSharedBufferCache.crop = crop;
+        mCore->mSharedBufferCache.transform = transform;
+        mCore->mSharedBufferCache.scalingMode = static_cast<uint32_t>(
+                scalingMode);
+        mCore->mSharedBufferCache.dataspace = dataSpace;
+    }
 
-        output->bufferReplaced = false;
-        if (mCore->mQueue.empty()) {
-            // When the queue is empty, we can ignore mDequeueBufferCannotBlock
-            // and simply queue this buffer
-            mCore->mQueue.push_back(item);
-            frameAvailableListener = mCore->mConsumerListener;
-        } else {
-            // When the queue is not empty, we need to look at the last buffer
-            // in the queue to see if we need to replace it
-            const BufferItem& last = mCore->mQueue.itemAt(
-                    mCore->mQueue.size() - 1);
-            if (last.mIsDroppable) {
-
-                if (!last.mIsStale) {
-                    mSlots[last.mSlot].mBufferState.freeQueued();
-
-                    // After leaving shared buffer mode, the shared buffer will
-                    // still be around. Mark it as no longer shared if this
-                    // operation causes it to be free.
-                    if (!mCore->mSharedBufferMode &&
-                            mSlots[last.mSlot].mBufferState.isFree()) {
-                        mSlots[last.mSlot].mBufferState.mShared = false;
-                    }
-                    // Don't put the shared buffer on the free list.
-                    if (!mSlots[last.mSlot].mBufferState.isShared()) {
-                        mCore->mActiveBuffers.erase(last.mSlot);
-                        mCore->mFreeBuffers.push_back(last.mSlot);
-                        output->bufferReplaced = true;
-                    }
+    output->bufferReplaced = false;
+    if (mCore->mQueue.empty()) {
+        // When the queue is empty, we can ignore mDequeueBufferCannotBlock
+        // and simply queue this buffer
+        mCore->mQueue.push_back(item);
+        frame->frameAvailableListener = mCore->mConsumerListener;
+    } else {
+        // When the queue is not empty, we need to look at the last buffer
+        // in the queue to see if we need to replace it
+        const BufferItem& last = mCore->mQueue.itemAt(
+                mCore->mQueue.size() - 1);
+        if (last.mIsDroppable) {
+
+            if (!last.mIsStale) {
+                mSlots[last.mSlot].mBufferState.freeQueued();
+
+                // After leaving shared buffer mode, the shared buffer will
+                // still be around. Mark it as no longer shared if this
+                // operation causes it to be free.
+                if (!mCore->mSharedBufferMode &&
+                        mSlots[last.mSlot].mBufferState.isFree()) {
+                    mSlots[last.mSlot].mBufferState.mShared = false;
                 }
-
-                // Make sure to merge the damage rect from the frame we're about
-                // to drop into the new frame's damage rect.
-                if (last.mSurfaceDamage.bounds() == Rect::INVALID_RECT ||
-                    item.mSurfaceDamage.bounds() == Rect::INVALID_RECT) {
-                    item.mSurfaceDamage = Region::INVALID_REGION;
-                } else {
-                    item.mSurfaceDamage |= last.mSurfaceDamage;
+                // Don't put the shared buffer on the free list.
+                if (!mSlots[last.mSlot].mBufferState.isShared()) {
+                    mCore->mActiveBuffers.erase(last.mSlot);
+                    mCore->mFreeBuffers.push_back(last.mSlot);
+                    output->bufferReplaced = true;
                 }
+            }
 
-                // Overwrite the droppable buffer with the incoming one
-                mCore->mQueue.editItemAt(mCore->mQueue.size() - 1) = item;
-                frameReplacedListener = mCore->mConsumerListener;
+            // Make sure to merge the damage rect from the frame we're about
+            // to drop into the new frame's damage rect.
+            if (last.mSurfaceDamage.bounds() == Rect::INVALID_RECT ||
+                item.mSurfaceDamage.bounds() == Rect::INVALID_RECT) {
+                item.mSurfaceDamage = Region::INVALID_REGION;
             } else {
-                mCore->mQueue.push_back(item);
-                frameAvailableListener = mCore->mConsumerListener;
+                item.mSurfaceDamage |= last.mSurfaceDamage;
             }
+
+            // Overwrite the droppable buffer with the incoming one
+            mCore->mQueue.editItemAt(mCore->mQueue.size() - 1) = item;
+            frame->frameReplacedListener = mCore->mConsumerListener;
+        } else {
+            mCore->mQueue.push_back(item);
+            frame->frameAvailableListener = mCore->mConsumerListener;
         }
+    }
 
-        mCore->mBufferHasBeenQueued = true;
-        mCore->mDequeueCondition.notify_all();
-        mCore->mLastQueuedSlot = slot;
+    mCore->mBufferHasBeenQueued = true;
+    mCore->mDequeueCondition.notify_all();
+    mCore->mLastQueuedSlot = slot;
 
-        output->width = mCore->mDefaultWidth;
-        output->height = mCore->mDefaultHeight;
-        output->transformHint = mCore->mTransformHintInUse = mCore->mTransformHint;
-        output->numPendingBuffers = static_cast<uint32_t>(mCore->mQueue.size());
-        output->nextFrameNumber = mCore->mFrameCounter + 1;
+    output->width = mCore->mDefaultWidth;
+    output->height = mCore->mDefaultHeight;
+    output->transformHint = mCore->mTransformHintInUse = mCore->mTransformHint;
+    output->numPendingBuffers = static_cast<uint32_t>(mCore->mQueue.size());
+    output->nextFrameNumber = mCore->mFrameCounter + 1;
 
-        ATRACE_INT(mCore->mConsumerName.c_str(), static_cast<int32_t>(mCore->mQueue.size()));
+    ATRACE_INT(mCore->mConsumerName.c_str(), static_cast<int32_t>(mCore->mQueue.size()));
 #ifndef NO_BINDER
-        mCore->mOccupancyTracker.registerOccupancyChange(mCore->mQueue.size());
+    mCore->mOccupancyTracker.registerOccupancyChange(mCore->mQueue.size());
 #endif
-        // Take a ticket for the callback functions
-        callbackTicket = mNextCallbackTicket++;
+    VALIDATE_CONSISTENCY();
 
-        VALIDATE_CONSISTENCY();
+    frame->connectedApi = mCore->mConnectedApi;
+    if (flags::bq_producer_throttles_only_async_mode()) {
+        frame->enableEglCpuThrottling = mCore->mAsyncMode || mCore->mDequeueBufferCannotBlock;
+    }
+    frame->lastQueuedFence = std::move(mLastQueueBufferFence);
 
-        connectedApi = mCore->mConnectedApi;
-        if (flags::bq_producer_throttles_only_async_mode()) {
-            enableEglCpuThrottling = mCore->mAsyncMode || mCore->mDequeueBufferCannotBlock;
-        }
-        lastQueuedFence = std::move(mLastQueueBufferFence);
+    mLastQueueBufferFence = std::move(acquireFence);
+    mLastQueuedCrop = item.mCrop;
+    mLastQueuedTransform = item.mTransform;
 
-        mLastQueueBufferFence = std::move(acquireFence);
-        mLastQueuedCrop = item.mCrop;
-        mLastQueuedTransform = item.mTransform;
-    } // Autolock scope
+    return NO_ERROR;
+}
 
+void BufferQueueProducer::addQueuedFrameTimestamps(QueuedFrame* frame,
+                                                   QueueBufferOutput* output) {
     // It is okay not to clear the GraphicBuffer when the consumer is SurfaceFlinger because
     // it is guaranteed that the BufferQueue is inside SurfaceFlinger's process and
     // there will be no Binder call
     if (!mConsumerIsSurfaceFlinger) {
-        item.mGraphicBuffer.clear();
+        frame->item.mGraphicBuffer.clear();
     }
 
     // Update and get FrameEventHistory.
     nsecs_t postedTime = systemTime(SYSTEM_TIME_MONOTONIC);
     NewFrameEventsEntry newFrameEventsEntry = {
-        currentFrameNumber,
+        frame->item.mFrameNumber,
         postedTime,
-        requestedPresentTimestamp,
-        std::move(acquireFenceTime)
+        frame->requestedPresentTimestamp,
+        std::move(frame->acquireFenceTime)
     };
     addAndGetFrameTimestamps(&newFrameEventsEntry,
-            getFrameTimestamps ? &output->frameTimestamps : nullptr);
+            frame->getFrameTimestamps ? &output->frameTimestamps : nullptr);
+}
+
+void BufferQueueProducer::callQueuedFrameListener(const QueuedFrame& frame) {
+    if (frame.frameAvailableListener != nullptr) {
+        frame.frameAvailableListener->onFrameAvailable(frame.item);
+    } else if (frame.frameReplacedListener != nullptr) {
+        frame.frameReplacedListener->onFrameReplaced(frame.item);
+    }
+}
+
+void BufferQueueProducer::throttleQueuedFrame(const QueuedFrame& frame) {
+    if (frame.connectedApi == NATIVE_WINDOW_API_EGL && frame.enableEglCpuThrottling) {
+        // Waiting here allows for two full buffers to be queued but not a
+        // third. In the event that frames take varying time, this makes a
+        // small trade-off in favor of latency rather than throughput.
+        frame.lastQueuedFence->waitForever("Throttling EGL Production");
+    }
+}
+
+status_t BufferQueueProducer::queueBuffer(int slot,
+        const QueueBufferInput &input, QueueBufferOutput *output) {
+    ATRACE_CALL();
+    ATRACE_BUFFER_INDEX(slot);
+
+    QueuedFrame frame;
+    int callbackTicket = 0;
+
+    { // Autolock scope
+        std::unique_lock<std::mutex> lock = mCore->lockTracked(mCore->mQueueLockContention);
+        BufferQueueCore::LockHoldTimer holdTimer(mCore->mQueueLockHoldLatency);
+        status_t result = queueBufferLocked(slot, input, output, &frame);
+        if (result != NO_ERROR) {
+            return result;
+        }
+        // Take a ticket for the callback functions
+        callbackTicket = mNextCallbackTicket++;
+    } // Autolock scope
+
+    addQueuedFrameTimestamps(&frame, output);
 
     // Call back without the main BufferQueue lock held, but with the callback
     // lock held so we can ensure that callbacks occur in order
@@ -1139,10 +1188,56 @@ status_t BufferQueueProducer::queueBuffer(int slot,
             mCallbackCondition.wait(lock);
         }
 
-        if (frameAvailableListener != nullptr) {
-            frameAvailableListener->onFrameAvailable(item);
-        } else if (frameReplacedListener != nullptr) {
-            frameReplacedListener->onFrameReplaced(item);
+        callQueuedFrameListener(frame);
+
+        ++mCurrentCallbackTicket;
+        mCallbackCondition.notify_all();
+    }
+
+    // Wait without lock held
+    throttleQueuedFrame(frame);
+
+    return NO_ERROR;
+}
+
+status_t BufferQueueProducer::queueBuffers(const std::vector<QueueBufferInput>& inputs,
+                                           std::vector<QueueBufferOutput>* outputs) {
+    ATRACE_CALL();
+
+    outputs->clear();
+    outputs->resize(inputs.size());
+    std::vector<QueuedFrame> frames(inputs.size());
+    int callbackTicket = 0;
+
+    // Queue every buffer under one acquisition of the BufferQueue lock and
+    // one callback ticket, instead of taking each once per buffer.
+    { // Autolock scope
+        std::unique_lock<std::mutex> lock = mCore->lockTracked(mCore->mQueueLockContention);
+        BufferQueueCore::LockHoldTimer holdTimer(mCore->mQueueLockHoldLatency);
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            ATRACE_BUFFER_INDEX(inputs[i].slot);
+            (*outputs)[i].result =
+                    queueBufferLocked(inputs[i].slot, inputs[i], &(*outputs)[i], &frames[i]);
+        }
+        callbackTicket = mNextCallbackTicket++;
+    } // Autolock scope
+
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        if ((*outputs)[i].result == NO_ERROR) {
+            addQueuedFrameTimestamps(&frames[i], &(*outputs)[i]);
+        }
+    }
+
+    { // scope for the lock
+        std::unique_lock<std::mutex> lock(mCallbackMutex);
+        while (callbackTicket != mCurrentCallbackTicket) {
+            mCallbackCondition.wait(lock);
+        }
+
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            if ((*outputs)[i].result == NO_ERROR) {
+                callQueuedFrameListener(frames[i]);
+            }
         }
 
         ++mCurrentCallbackTicket;
@@ -1150,11 +1245,10 @@ status_t BufferQueueProducer::queueBuffer(int slot,
     }
 
     // Wait without lock held
-    if (connectedApi == NATIVE_WINDOW_API_EGL && enableEglCpuThrottling) {
-        // Waiting here allows for two full buffers to be queued but not a
-        // third. In the event that frames take varying time, this makes a
-        // small trade-off in favor of latency rather than throughput.
-        lastQueuedFence->waitForever("Throttling EGL Production");
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        if ((*outputs)[i].result == NO_ERROR) {
+            throttleQueuedFrame(frames[i]);
+        }
     }
 
     return NO_ERROR;
@@ -1165,69 +1259,104 @@ status_t BufferQueueProducer::cancelBuffer(int slot, const sp<Fence>& fence) {
     BQ_LOGV("cancelBuffer: slot %d", slot);
 
     sp<IConsumerListener> listener;
-    bool callOnFrameCancelled = false;
-    uint64_t bufferId = 0; // Only used if callOnFrameCancelled == true
+    std::optional<uint64_t> cancelledBufferId;
     {
         std::lock_guard<std::mutex> lock(mCore->mMutex);
-
-        if (mCore->mIsAbandoned) {
-            BQ_LOGE("cancelBuffer: BufferQueue has been abandoned");
-            return NO_INIT;
+        status_t result = cancelBufferLocked(slot, fence, &cancelledBufferId);
+        if (result != NO_ERROR) {
+            return result;
         }
+        listener = mCore->mConsumerListener;
+    }
 
-        if (mCore->mConnectedApi == BufferQueueCore::NO_CONNECTED_API) {
-            BQ_LOGE("cancelBuffer: BufferQueue has no connected producer");
-            return NO_INIT;
-        }
+    if (listener != nullptr && cancelledBufferId) {
+        listener->onFrameCancelled(*cancelledBufferId);
+    }
 
-        if (mCore->mSharedBufferMode) {
-            BQ_LOGE("cancelBuffer: cannot cancel a buffer in shared buffer mode");
-            return BAD_VALUE;
+    return NO_ERROR;
+}
+
+status_t BufferQueueProducer::cancelBuffers(const std::vector<CancelBufferInput>& inputs,
+                                            std::vector<status_t>* results) {
+    ATRACE_CALL();
+
+    results->clear();
+    results->reserve(inputs.size());
+    sp<IConsumerListener> listener;
+    std::vector<uint64_t> cancelledBufferIds;
+    {
+        std::lock_guard<std::mutex> lock(mCore->mMutex);
+        for (const CancelBufferInput& input : inputs) {
+            std::optional<uint64_t> cancelledBufferId;
+            results->emplace_back(cancelBufferLocked(input.slot, input.fence, &cancelledBufferId));
+            if (cancelledBufferId) {
+                cancelledBufferIds.push_back(*cancelledBufferId);
+            }
         }
+        listener = mCore->mConsumerListener;
+    }
 
-        if (slot < 0 || slot >= BufferQueueDefs::NUM_BUFFER_SLOTS) {
-            BQ_LOGE("cancelBuffer: slot index %d out of range [0, %d)", slot,
-                    BufferQueueDefs::NUM_BUFFER_SLOTS);
-            return BAD_VALUE;
-        } else if (!mSlots[slot].mBufferState.isDequeued()) {
-            BQ_LOGE("cancelBuffer: slot %d is not owned by the producer "
-                    "(state = %s)",
-                    slot, mSlots[slot].mBufferState.string());
-            return BAD_VALUE;
-        } else if (fence == nullptr) {
-            BQ_LOGE("cancelBuffer: fence is NULL");
-            return BAD_VALUE;
+    if (listener != nullptr) {
+        for (uint64_t bufferId : cancelledBufferIds) {
+            listener->onFrameCancelled(bufferId);
         }
+    }
 
-        mSlots[slot].mBufferState.cancel();
+    return NO_ERROR;
+}
 
-        // After leaving shared buffer mode, the shared buffer will still be around.
-        // Mark it as no longer shared if this operation causes it to be free.
-        if (!mCore->mSharedBufferMode && mSlots[slot].mBufferState.isFree()) {
-            mSlots[slot].mBufferState.mShared = false;
-        }
+status_t BufferQueueProducer::cancelBufferLocked(int slot, const sp<Fence>& fence,
+                                                 std::optional<uint64_t>* outCancelledBufferId) {
+    if (mCore->mIsAbandoned) {
+        BQ_LOGE("cancelBuffer: BufferQueue has been abandoned");
+        return NO_INIT;
+    }
 
-        // Don't put the shared buffer on the free list.
-        if (!mSlots[slot].mBufferState.isShared()) {
-            mCore->mActiveBuffers.erase(slot);
-            mCore->mFreeBuffers.push_back(slot);
-        }
+    if (mCore->mConnectedApi == BufferQueueCore::NO_CONNECTED_API) {
+        BQ_LOGE("cancelBuffer: BufferQueue has no connected producer");
+        return NO_INIT;
+    }
 
-        auto gb = mSlots[slot].mGraphicBuffer;
-        if (gb != nullptr) {
-            callOnFrameCancelled = true;
-            bufferId = gb->getId();
-        }
-        mSlots[slot].mFence = fence;
-        mCore->mDequeueCondition.notify_all();
-        listener = mCore->mConsumerListener;
-        VALIDATE_CONSISTENCY();
+    if (mCore->mSharedBufferMode) {
+        BQ_LOGE("cancelBuffer: cannot cancel a buffer in shared buffer mode");
+        return BAD_VALUE;
     }
 
-    if (listener != nullptr && callOnFrameCancelled) {
-        listener->onFrameCancelled(bufferId);
+    if (slot < 0 || slot >= BufferQueueDefs::NUM_BUFFER_SLOTS) {
+        BQ_LOGE("cancelBuffer: slot index %d out of range [0, %d)", slot,
+                BufferQueueDefs::NUM_BUFFER_SLOTS);
+        return BAD_VALUE;
+    } else if (!mSlots[slot].mBufferState.isDequeued()) {
+        BQ_LOGE("cancelBuffer: slot %d is not owned by the producer "
+                "(state = %s)",
+                slot, mSlots[slot].mBufferState.string());
+        return BAD_VALUE;
+    } else if (fence == nullptr) {
+        BQ_LOGE("cancelBuffer: fence is NULL");
+        return BAD_VALUE;
+    }
+
+    mSlots[slot].mBufferState.cancel();
+
+    // After leaving shared buffer mode, the shared buffer will still be around.
+    // Mark it as no longer shared if this operation causes it to be free.
+    if (!mCore->mSharedBufferMode && mSlots[slot].mBufferState.isFree()) {
+        mSlots[slot].mBufferState.mShared = false;
+    }
+
+    // Don't put the shared buffer on the free list.
+    if (!mSlots[slot].mBufferState.isShared()) {
+        mCore->mActiveBuffers.erase(slot);
+        mCore->mFreeBuffers.push_back(slot);
     }
 
+    auto gb = mSlots[slot].mGraphicBuffer;
+    if (gb != nullptr) {
+        *outCancelledBufferId = gb->getId();
+    }
+    mSlots[slot].mFence = fence;
+    mCore->mDequeueCondition.notify_all();
+    VALIDATE_CONSISTENCY();
     return NO_ERROR;
 }
 
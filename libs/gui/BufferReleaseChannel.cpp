@@ -19,6 +19,9 @@
 #include <fcntl.h>
 #include <sys/socket.h>
 #include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
 
 #include <android-base/result.h>
 #include <android/binder_status.h>
@@ -136,9 +139,26 @@ status_t BufferReleaseChannel::Message::unflatten(void const*& buffer, size_t& s
 status_t BufferReleaseChannel::ConsumerEndpoint::readReleaseFence(
         ReleaseCallbackId& outReleaseCallbackId, sp<Fence>& outReleaseFence,
         uint32_t& outMaxAcquiredBufferCount) {
-    Message message;
-    mFlattenedBuffer.resize(message.getFlattenedSize());
-    std::array<uint8_t, CMSG_SPACE(sizeof(int))> controlMessageBuffer;
+    if (!hasPendingReleaseFences()) {
+        if (status_t err = readMessages(); err != OK) {
+            return err;
+        }
+    }
+
+    Message& message = mPendingMessages[mNextPendingMessage++];
+    outReleaseCallbackId = message.releaseCallbackId;
+    outReleaseFence = std::move(message.releaseFence);
+    outMaxAcquiredBufferCount = message.maxAcquiredBufferCount;
+    return OK;
+}
+
+status_t BufferReleaseChannel::ConsumerEndpoint::readMessages() {
+    mPendingMessages.clear();
+    mNextPendingMessage = 0;
+
+    const size_t messageSize = Message().getFlattenedSize();
+    mFlattenedBuffer.resize(messageSize * kMaxBatchedMessages);
+    std::array<uint8_t, CMSG_SPACE(sizeof(int) * kMaxBatchedMessages)> controlMessageBuffer;
 
     iovec iov{
             .iov_base = mFlattenedBuffer.data(),
@@ -152,7 +172,7 @@ status_t BufferReleaseChannel::ConsumerEndpoint::readReleaseFence(
             .msg_controllen = controlMessageBuffer.size(),
     };
 
-    int result;
+    ssize_t result;
     do {
         result = recvmsg(mFd, &msg, 0);
     } while (result == -1 && errno == EINTR);
@@ -164,60 +184,93 @@ status_t BufferReleaseChannel::ConsumerEndpoint::readReleaseFence(
         return UNKNOWN_ERROR;
     }
 
-    if (msg.msg_iovlen != 1) {
-        ALOGE("Error reading release fence from socket: bad data length");
-        return UNKNOWN_ERROR;
+    size_t fdCount = 0;
+    const int* fdData = nullptr;
+    if (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg)) {
+        fdData = reinterpret_cast<const int*>(CMSG_DATA(cmsg));
+        fdCount = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
     }
+    // Closes the file descriptors that no message took ownership of.
+    const auto closeRemainingFds = [&fdData, &fdCount] {
+        for (size_t i = 0; i < fdCount; i++) {
+            close(fdData[i]);
+        }
+    };
 
-    if (msg.msg_controllen % sizeof(int) != 0) {
-        ALOGE("Error reading release fence from socket: bad fd length");
+    if (msg.msg_flags & (MSG_TRUNC | MSG_CTRUNC)) {
+        ALOGE("Error reading release fence from socket: message truncated");
+        closeRemainingFds();
         return UNKNOWN_ERROR;
     }
 
-    size_t dataLen = msg.msg_iov->iov_len;
-    const void* data = static_cast<const void*>(msg.msg_iov->iov_base);
-    if (!data) {
-        ALOGE("Error reading release fence from socket: no buffer data");
+    size_t dataLen = static_cast<size_t>(result);
+    if (dataLen == 0 || dataLen % messageSize != 0) {
+        ALOGE("Error reading release fence from socket: bad data length");
+        closeRemainingFds();
         return UNKNOWN_ERROR;
     }
 
-    size_t fdCount = 0;
-    const int* fdData = nullptr;
-    if (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg)) {
-        fdData = reinterpret_cast<const int*>(CMSG_DATA(cmsg));
-        fdCount = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+    const void* data = static_cast<const void*>(mFlattenedBuffer.data());
+    mPendingMessages.reserve(dataLen / messageSize);
+    while (dataLen >= messageSize) {
+        Message message;
+        if (status_t err = message.unflatten(data, dataLen, fdData, fdCount); err != OK) {
+            closeRemainingFds();
+            mPendingMessages.clear();
+            return err;
+        }
+        mPendingMessages.push_back(std::move(message));
     }
+    closeRemainingFds();
 
-    if (status_t err = message.unflatten(data, dataLen, fdData, fdCount); err != OK) {
-        return err;
-    }
+    return OK;
+}
 
-    outReleaseCallbackId = message.releaseCallbackId;
-    outReleaseFence = std::move(message.releaseFence);
-    outMaxAcquiredBufferCount = message.maxAcquiredBufferCount;
+status_t BufferReleaseChannel::ProducerEndpoint::writeReleaseFence(
+        const ReleaseCallbackId& callbackId, const sp<Fence>& fence,
+        uint32_t maxAcquiredBufferCount) {
+    const Message message{callbackId, fence ? fence : Fence::NO_FENCE, maxAcquiredBufferCount};
+    return writeMessages({&message, 1});
+}
 
+status_t BufferReleaseChannel::ProducerEndpoint::writeReleaseFences(
+        std::span<const Message> messages) {
+    while (!messages.empty()) {
+        const auto batch = messages.first(std::min(messages.size(), kMaxBatchedMessages));
+        if (status_t err = writeMessages(batch); err != OK) {
+            return err;
+        }
+        messages = messages.subspan(batch.size());
+    }
     return OK;
 }
 
-int BufferReleaseChannel::ProducerEndpoint::writeReleaseFence(const ReleaseCallbackId& callbackId,
-                                                              const sp<Fence>& fence,
-                                                              uint32_t maxAcquiredBufferCount) {
-    Message message{callbackId, fence ? fence : Fence::NO_FENCE, maxAcquiredBufferCount};
-    mFlattenedBuffer.resize(message.getFlattenedSize());
-    int flattenedFd;
+status_t BufferReleaseChannel::ProducerEndpoint::writeMessages(
+        std::span<const Message> messages) {
+    size_t flattenedSize = 0;
+    for (const Message& message : messages) {
+        flattenedSize += message.getFlattenedSize();
+    }
+    mFlattenedBuffer.resize(flattenedSize);
+
+    std::array<int, kMaxBatchedMessages> flattenedFds;
+    size_t flattenedFdCount = 0;
     {
         // Make copies of needed items since flatten modifies them, and we don't
         // want to send anything if there's an error during flatten.
         void* flattenedBufferPtr = mFlattenedBuffer.data();
         size_t flattenedBufferSize = mFlattenedBuffer.size();
-        int* flattenedFdPtr = &flattenedFd;
-        size_t flattenedFdCount = 1;
-        if (status_t err = message.flatten(flattenedBufferPtr, flattenedBufferSize, flattenedFdPtr,
-                                           flattenedFdCount);
-            err != OK) {
-            ALOGE("Failed to flatten BufferReleaseChannel message.");
-            return err;
+        int* flattenedFdPtr = flattenedFds.data();
+        size_t flattenedFdSpace = flattenedFds.size();
+        for (const Message& message : messages) {
+            if (status_t err = message.flatten(flattenedBufferPtr, flattenedBufferSize,
+                                               flattenedFdPtr, flattenedFdSpace);
+                err != OK) {
+                ALOGE("Failed to flatten BufferReleaseChannel message.");
+                return err;
+            }
         }
+        flattenedFdCount = flattenedFds.size() - flattenedFdSpace;
     }
 
     iovec iov{
@@ -230,16 +283,16 @@ int BufferReleaseChannel::ProducerEndpoint::writeReleaseFence(const ReleaseCallb
             .msg_iovlen = 1,
     };
 
-    std::array<uint8_t, CMSG_SPACE(sizeof(int))> controlMessageBuffer;
-    if (fence && fence->isValid()) {
+    std::array<uint8_t, CMSG_SPACE(sizeof(int) * kMaxBatchedMessages)> controlMessageBuffer;
+    if (flattenedFdCount > 0) {
         msg.msg_control = controlMessageBuffer.data();
-        msg.msg_controllen = controlMessageBuffer.size();
+        msg.msg_controllen = CMSG_SPACE(sizeof(int) * flattenedFdCount);
 
         cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
         cmsg->cmsg_level = SOL_SOCKET;
         cmsg->cmsg_type = SCM_RIGHTS;
-        cmsg->cmsg_len = CMSG_LEN(sizeof(int));
-        memcpy(CMSG_DATA(cmsg), &flattenedFd, sizeof(int));
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int) * flattenedFdCount);
+        memcpy(CMSG_DATA(cmsg), flattenedFds.data(), sizeof(int) * flattenedFdCount);
     }
 
     int result;
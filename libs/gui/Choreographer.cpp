@@ -148,7 +148,11 @@ void Choreographer::postFrameCallbackDelayed(AChoreographer_frameCallback cb,
     FrameCallback callback{cb, cb64, vsyncCallback, data, now + delay, callbackType};
     {
         std::lock_guard<std::mutex> _l{mLock};
-        mFrameCallbacks.push(callback);
+        if (delay <= 0) {
+            mPendingCallbacks.push_back(callback);
+        } else {
+            mDelayedCallbacks.push(callback);
+        }
     }
     if (callback.dueTime <= now) {
         if (std::this_thread::get_id() != mThreadId) {
@@ -226,6 +230,10 @@ void Choreographer::unregisterRefreshRateCallback(AChoreographer_refreshRateCall
 }
 
 void Choreographer::scheduleLatestConfigRequest() {
+    if (mRefreshRateUpdatePending.exchange(true)) {
+        // The queued update will pick up the latest period.
+        return;
+    }
     if (mLooper != nullptr) {
         Message m{MSG_HANDLE_REFRESH_RATE_UPDATES};
         mLooper->sendMessage(this, m);
@@ -250,10 +258,13 @@ void Choreographer::scheduleCallbacks() {
     {
         std::lock_guard<std::mutex> _l{mLock};
         // If there are no pending callbacks then don't schedule a vsync
-        if (mFrameCallbacks.empty()) {
+        if (!mPendingCallbacks.empty()) {
+            dueTime = mPendingCallbacks.front().dueTime;
+        } else if (!mDelayedCallbacks.empty()) {
+            dueTime = mDelayedCallbacks.top().dueTime;
+        } else {
             return;
         }
-        dueTime = mFrameCallbacks.top().dueTime;
     }
 
     if (dueTime <= now) {
@@ -264,6 +275,9 @@ void Choreographer::scheduleCallbacks() {
 }
 
 void Choreographer::handleRefreshRateUpdates() {
+    // Clear before reading the period so that a change signalled from here on queues another
+    // update.
+    mRefreshRateUpdatePending = false;
     std::vector<RefreshRateCallback> callbacks{};
     const nsecs_t pendingPeriod = gChoreographers.mLastKnownVsync.load();
     const nsecs_t lastPeriod = mLatestVsyncPeriod;
@@ -286,8 +300,12 @@ void Choreographer::handleRefreshRateUpdates() {
 }
 
 void Choreographer::dispatchCallbacks(const std::vector<FrameCallback>& callbacks,
-                                      VsyncEventData vsyncEventData, nsecs_t timestamp) {
+                                      CallbackType callbackType, VsyncEventData vsyncEventData,
+                                      nsecs_t timestamp) {
     for (const auto& cb : callbacks) {
+        if (cb.callbackType != callbackType) {
+            continue;
+        }
         if (cb.vsyncCallback != nullptr) {
             ATRACE_FORMAT("AChoreographer_vsyncCallback %" PRId64,
                           vsyncEventData.preferredVsyncId());
@@ -311,30 +329,42 @@ void Choreographer::dispatchCallbacks(const std::vector<FrameCallback>& callback
 
 void Choreographer::dispatchVsync(nsecs_t timestamp, PhysicalDisplayId, uint32_t,
                                   VsyncEventData vsyncEventData) {
-    std::vector<FrameCallback> animationCallbacks{};
-    std::vector<FrameCallback> inputCallbacks{};
+    // Swap out every undelayed callback at once, handing the storage of the previous dispatch
+    // back to mPendingCallbacks. Callbacks posted from within a callback land there and run at
+    // the next vsync, as before. The storage is borrowed into a local rather than used in place
+    // so that a callback dispatching events re-entrantly can't clear the list being iterated.
+    std::vector<FrameCallback> callbacks;
+    callbacks.swap(mDispatchingCallbacks);
     {
         std::lock_guard<std::mutex> _l{mLock};
-        nsecs_t now = systemTime(SYSTEM_TIME_MONOTONIC);
-        while (!mFrameCallbacks.empty() && mFrameCallbacks.top().dueTime < now) {
-            if (mFrameCallbacks.top().callbackType == CALLBACK_INPUT) {
-                inputCallbacks.push_back(mFrameCallbacks.top());
-            } else {
-                animationCallbacks.push_back(mFrameCallbacks.top());
-            }
-            mFrameCallbacks.pop();
+        callbacks.swap(mPendingCallbacks);
+        const nsecs_t now = systemTime(SYSTEM_TIME_MONOTONIC);
+        const size_t undelayedCount = callbacks.size();
+        while (!mDelayedCallbacks.empty() && mDelayedCallbacks.top().dueTime < now) {
+            callbacks.push_back(mDelayedCallbacks.top());
+            mDelayedCallbacks.pop();
+        }
+        if (callbacks.size() != undelayedCount && undelayedCount != 0) {
+            // Delayed callbacks became due alongside undelayed ones; keep running them all in due
+            // time order.
+            std::stable_sort(callbacks.begin(), callbacks.end(),
+                             [](const FrameCallback& lhs, const FrameCallback& rhs) {
+                                 return lhs.dueTime < rhs.dueTime;
+                             });
         }
     }
     mLastVsyncEventData = vsyncEventData;
     // Callbacks with type CALLBACK_INPUT should always run first
     {
         ATRACE_FORMAT("CALLBACK_INPUT");
-        dispatchCallbacks(inputCallbacks, vsyncEventData, timestamp);
+        dispatchCallbacks(callbacks, CALLBACK_INPUT, vsyncEventData, timestamp);
     }
     {
         ATRACE_FORMAT("CALLBACK_ANIMATION");
-        dispatchCallbacks(animationCallbacks, vsyncEventData, timestamp);
+        dispatchCallbacks(callbacks, CALLBACK_ANIMATION, vsyncEventData, timestamp);
     }
+    callbacks.clear();
+    mDispatchingCallbacks.swap(callbacks);
 }
 
 void Choreographer::dispatchHotplug(nsecs_t, PhysicalDisplayId displayId, bool connected) {
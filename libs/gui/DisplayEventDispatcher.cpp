@@ -193,6 +193,8 @@ bool DisplayEventDispatcher::processPendingEvents(nsecs_t* outTimestamp,
                     }
                     break;
                 case DisplayEventReceiver::DISPLAY_EVENT_MODE_CHANGE:
+                    // The frame timelines of earlier vsyncs are for the previous mode.
+                    clearLastVsyncEventData();
                     dispatchModeChanged(ev.header.timestamp, ev.header.displayId,
                                         ev.modeChange.modeId, ev.modeChange.vsyncPeriod);
                     break;
@@ -203,6 +205,7 @@ bool DisplayEventDispatcher::processPendingEvents(nsecs_t* outTimestamp,
                     mFrameRateOverrides.emplace_back(ev.frameRateOverride);
                     break;
                 case DisplayEventReceiver::DISPLAY_EVENT_FRAME_RATE_OVERRIDE_FLUSH:
+                    clearLastVsyncEventData();
                     dispatchFrameRateOverrides(ev.header.timestamp, ev.header.displayId,
                                                std::move(mFrameRateOverrides));
                     break;
@@ -220,11 +223,30 @@ bool DisplayEventDispatcher::processPendingEvents(nsecs_t* outTimestamp,
     if (n < 0) {
         ALOGW("Failed to get events from display event dispatcher, status=%d", status_t(n));
     }
+    if (gotVsync) {
+        std::lock_guard lock(mLastVsyncEventDataMutex);
+        mLastVsyncEventData = *outVsyncEventData;
+    }
     return gotVsync;
 }
 
+void DisplayEventDispatcher::clearLastVsyncEventData() {
+    std::lock_guard lock(mLastVsyncEventDataMutex);
+    mLastVsyncEventData.reset();
+}
+
 status_t DisplayEventDispatcher::getLatestVsyncEventData(
         ParcelableVsyncEventData* outVsyncEventData) const {
+    {
+        // The vsync events carry the same frame timelines as EventThread would return, so avoid
+        // the binder call until the app has missed the preferred deadline.
+        std::lock_guard lock(mLastVsyncEventDataMutex);
+        if (mLastVsyncEventData &&
+            mLastVsyncEventData->preferredDeadlineTimestamp() > systemTime(SYSTEM_TIME_MONOTONIC)) {
+            outVsyncEventData->vsync = *mLastVsyncEventData;
+            return OK;
+        }
+    }
     return mReceiver.getLatestVsyncEventData(outVsyncEventData);
 }
 
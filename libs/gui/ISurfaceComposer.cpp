@@ -137,12 +137,12 @@ status_t BnSurfaceComposer::onTransact(
 
             uint32_t count = 0;
             SAFE_PARCEL_READ_SIZE(data.readUint32, &count, data.dataSize());
+            // Read each state in place rather than into a temporary that is then copied into the
+            // vector; layer_state_t is large and holds several strong references.
             Vector<ComposerState> state;
             state.setCapacity(count);
             for (size_t i = 0; i < count; i++) {
-                ComposerState s;
-                SAFE_PARCEL(s.read, data);
-                state.add(s);
+                SAFE_PARCEL(state.editItemAt(state.add()).read, data);
             }
 
             SAFE_PARCEL_READ_SIZE(data.readUint32, &count, data.dataSize());
@@ -177,6 +177,32 @@ status_t SurfaceStats::readFromParcel(const Parcel* input) {
     return NO_ERROR;
 }
 
+status_t ReleasedBufferStats::writeToParcel(Parcel* output) const {
+    SAFE_PARCEL(output->writeParcelable, callbackId);
+    if (releaseFence) {
+        SAFE_PARCEL(output->writeBool, true);
+        SAFE_PARCEL(output->write, *releaseFence);
+    } else {
+        SAFE_PARCEL(output->writeBool, false);
+    }
+    SAFE_PARCEL(output->writeUint32, currentMaxAcquiredBufferCount);
+    return NO_ERROR;
+}
+
+status_t ReleasedBufferStats::readFromParcel(const Parcel* input) {
+    SAFE_PARCEL(input->readParcelable, &callbackId);
+    bool hasFence = false;
+    SAFE_PARCEL(input->readBool, &hasFence);
+    if (hasFence) {
+        releaseFence = sp<Fence>::make();
+        SAFE_PARCEL(input->read, *releaseFence);
+    } else {
+        releaseFence = Fence::NO_FENCE;
+    }
+    SAFE_PARCEL(input->readUint32, &currentMaxAcquiredBufferCount);
+    return NO_ERROR;
+}
+
 status_t TransactionStats::writeToParcel(Parcel* output) const {
     status_t err = output->writeParcelableVector(callbackIds);
     if (err != NO_ERROR) {
@@ -236,7 +262,7 @@ status_t ListenerStats::writeToParcel(Parcel* output) const {
             return err;
         }
     }
-    return NO_ERROR;
+    return output->writeParcelableVector(releasedBuffers);
 }
 
 status_t ListenerStats::readFromParcel(const Parcel* input) {
@@ -250,7 +276,7 @@ status_t ListenerStats::readFromParcel(const Parcel* input) {
         }
         transactionStats.push_back(stats);
     }
-    return NO_ERROR;
+    return input->readParcelableVector(&releasedBuffers);
 }
 
 ListenerStats ListenerStats::createEmpty(
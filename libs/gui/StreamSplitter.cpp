@@ -25,14 +25,18 @@
 #include <gui/IGraphicBufferProducer.h>
 #include <gui/StreamSplitter.h>
 
+#include <ui/Fence.h>
 #include <ui/GraphicBuffer.h>
 
 #include <binder/ProcessState.h>
 
+#include <utils/String8.h>
 #include <utils/Trace.h>
 
 #include <system/window.h>
 
+#include <algorithm>
+
 namespace android {
 
 status_t StreamSplitter::createSplitter(
@@ -62,9 +66,8 @@ StreamSplitter::StreamSplitter(const sp<IGraphicBufferConsumer>& inputQueue)
 
 StreamSplitter::~StreamSplitter() {
     mInput->consumerDisconnect();
-    Vector<sp<IGraphicBufferProducer> >::iterator output = mOutputs.begin();
-    for (; output != mOutputs.end(); ++output) {
-        (*output)->disconnect(NATIVE_WINDOW_API_CPU);
+    for (OutputState& output : mOutputs) {
+        output.producer->disconnect(NATIVE_WINDOW_API_CPU);
     }
 
     if (mBuffers.size() > 0) {
@@ -91,7 +94,22 @@ status_t StreamSplitter::addOutput(
         return status;
     }
 
-    mOutputs.push_back(outputQueue);
+    // Released buffers are kept dequeued in the output's slots, so the output
+    // must allow enough dequeued buffers, must never replace them with newly
+    // allocated ones, and must not block the splitter when it has no buffer to
+    // return.
+    OutputState output(outputQueue);
+    if (outputQueue->getConsumerUsage(&output.consumerUsage) == NO_ERROR &&
+            outputQueue->allowAllocation(false) == NO_ERROR &&
+            outputQueue->setDequeueTimeout(0) == NO_ERROR &&
+            outputQueue->setMaxDequeuedBufferCount(MAX_CACHED_BUFFERS_PER_OUTPUT + 1) ==
+                    NO_ERROR) {
+        output.maxCachedBuffers = MAX_CACHED_BUFFERS_PER_OUTPUT;
+    } else {
+        ALOGW("addOutput: buffers will be attached to output %p on every frame",
+                outputQueue.get());
+    }
+    mOutputs.push_back(std::move(output));
 
     return NO_ERROR;
 }
@@ -101,6 +119,22 @@ void StreamSplitter::setName(const String8 &name) {
     mInput->setConsumerName(name);
 }
 
+void StreamSplitter::dump(String8& result) const {
+    Mutex::Autolock lock(mMutex);
+    result.appendFormat("StreamSplitter: %zu outputs, %d outstanding buffers%s\n",
+            mOutputs.size(), mOutstandingBuffers, mIsAbandoned ? ", abandoned" : "");
+    for (size_t i = 0; i < mOutputs.size(); ++i) {
+        const OutputState& output = mOutputs[i];
+        const nsecs_t meanLatency = output.releaseCount > 0
+                ? output.totalReleaseLatency / static_cast<nsecs_t>(output.releaseCount)
+                : 0;
+        result.appendFormat("  output %zu: %zu buffers attached, %zu queued from cached slots "
+                "(%zu cached), %zu released after %.3f ms on average (max %.3f ms)\n",
+                i, output.attachCount, output.cachedQueueCount, output.cachedBuffers.size(),
+                output.releaseCount, meanLatency / 1e6, output.maxReleaseLatency / 1e6);
+    }
+}
+
 void StreamSplitter::onFrameAvailable(const BufferItem& /* item */) {
     ATRACE_CALL();
     Mutex::Autolock lock(mMutex);
@@ -148,26 +182,9 @@ void StreamSplitter::onFrameAvailable(const BufferItem& /* item */) {
             static_cast<int32_t>(bufferItem.mScalingMode),
             bufferItem.mTransform, bufferItem.mFence);
 
-    // Attach and queue the buffer to each of the outputs
-    Vector<sp<IGraphicBufferProducer> >::iterator output = mOutputs.begin();
-    for (; output != mOutputs.end(); ++output) {
-        int slot;
-        status = (*output)->attachBuffer(&slot, bufferItem.mGraphicBuffer);
-        if (status == NO_INIT) {
-            // If we just discovered that this output has been abandoned, note
-            // that, increment the release count so that we still release this
-            // buffer eventually, and move on to the next output
-            onAbandonedLocked();
-            mBuffers.editValueFor(bufferItem.mGraphicBuffer->getId())->
-                    incrementReleaseCountLocked();
-            continue;
-        } else {
-            LOG_ALWAYS_FATAL_IF(status != NO_ERROR,
-                    "attaching buffer to output failed (%d)", status);
-        }
-
-        IGraphicBufferProducer::QueueBufferOutput queueOutput;
-        status = (*output)->queueBuffer(slot, queueInput, &queueOutput);
+    // Queue the buffer to each of the outputs
+    for (OutputState& output : mOutputs) {
+        status = queueToOutputLocked(output, bufferItem.mGraphicBuffer, queueInput);
         if (status == NO_INIT) {
             // If we just discovered that this output has been abandoned, note
             // that, increment the release count so that we still release this
@@ -182,8 +199,123 @@ void StreamSplitter::onFrameAvailable(const BufferItem& /* item */) {
         }
 
         ALOGV("queued buffer %#" PRIx64 " to output %p",
-                bufferItem.mGraphicBuffer->getId(), output->get());
+                bufferItem.mGraphicBuffer->getId(), output.producer.get());
+    }
+}
+
+status_t StreamSplitter::queueToOutputLocked(OutputState& output,
+        const sp<GraphicBuffer>& buffer,
+        const IGraphicBufferProducer::QueueBufferInput& input) {
+    const uint64_t bufferId = buffer->getId();
+    const BufferAttributes attributes = {buffer->getWidth(), buffer->getHeight(),
+            buffer->getPixelFormat(), buffer->getUsage()};
+
+    int slot = BufferQueueDefs::INVALID_BUFFER_SLOT;
+    const auto cached = std::find_if(output.cachedBuffers.begin(), output.cachedBuffers.end(),
+            [bufferId](const auto& entry) { return entry.first == bufferId; });
+    if (cached != output.cachedBuffers.end()) {
+        // The output still has the buffer in a slot, so its consumer need not
+        // import the buffer again
+        slot = cached->second;
+        output.cachedBuffers.erase(cached);
+        ++output.cachedQueueCount;
+    } else {
+        if (!isCacheable(output, attributes)) {
+            // The input moved on to buffers with other attributes, so the
+            // cached buffers will not come back. Once no cached buffer is left
+            // with the consumer, buffers with the new attributes can be cached.
+            for (const auto& [cachedId, cachedSlot] : output.cachedBuffers) {
+                output.producer->detachBuffer(cachedSlot);
+            }
+            output.cachedBuffers.clear();
+            if (output.maxCachedBuffers > 0 &&
+                    output.queuedUncachedCount == output.queuedBuffers.size()) {
+                output.cachedAttributes = attributes;
+            }
+        } else if (output.cachedBuffers.size() >= output.maxCachedBuffers &&
+                !output.cachedBuffers.empty()) {
+            // Make room to cache this buffer once it is released by evicting
+            // the buffer that was released the longest time ago
+            output.producer->detachBuffer(output.cachedBuffers.front().second);
+            output.cachedBuffers.erase(output.cachedBuffers.begin());
+        }
+
+        status_t status = output.producer->attachBuffer(&slot, buffer);
+        if (status != NO_ERROR) {
+            ALOGE_IF(status != NO_INIT, "attaching buffer to output failed (%d)", status);
+            return status;
+        }
+        output.slotBufferIds[slot] = bufferId;
+        ++output.attachCount;
+    }
+
+    IGraphicBufferProducer::QueueBufferOutput queueOutput;
+    status_t status = output.producer->queueBuffer(slot, input, &queueOutput);
+    if (status != NO_ERROR) {
+        ALOGE_IF(status != NO_INIT, "queueing buffer to output failed (%d)", status);
+        return status;
+    }
+
+    const bool cacheable = isCacheable(output, attributes);
+    output.queuedBuffers[bufferId] = cacheable;
+    if (!cacheable) {
+        ++output.queuedUncachedCount;
+    }
+    return NO_ERROR;
+}
+
+bool StreamSplitter::isCacheable(const OutputState& output,
+        const BufferAttributes& attributes) {
+    // dequeueBuffer adds the consumer's usage to the requested one, and would
+    // reallocate a buffer that lacks any of it
+    return output.maxCachedBuffers > 0 && output.cachedAttributes == attributes &&
+            (output.consumerUsage & ~attributes.usage) == 0;
+}
+
+status_t StreamSplitter::takeReleasedBufferLocked(OutputState& output,
+        uint64_t* outBufferId, sp<Fence>* outFence) {
+    if (output.queuedUncachedCount == 0 && output.cachedAttributes &&
+            output.cachedBuffers.size() < output.maxCachedBuffers) {
+        // Every buffer that the output can release has the cached attributes,
+        // so dequeueing returns the released buffer without reallocating it
+        const BufferAttributes& attributes = *output.cachedAttributes;
+        int slot = BufferQueueDefs::INVALID_BUFFER_SLOT;
+        status_t status = output.producer->dequeueBuffer(&slot, outFence, attributes.width,
+                attributes.height, attributes.format, attributes.usage, nullptr, nullptr);
+        if (status < 0) {
+            return status;
+        }
+        LOG_ALWAYS_FATAL_IF(status & IGraphicBufferProducer::BUFFER_NEEDS_REALLOCATION,
+                "output reallocated a cached buffer");
+        *outBufferId = output.slotBufferIds[slot];
+        output.cachedBuffers.emplace_back(*outBufferId, slot);
+    } else {
+        sp<GraphicBuffer> buffer;
+        status_t status = output.producer->detachNextBuffer(&buffer, outFence);
+        if (status != NO_ERROR) {
+            return status;
+        }
+        *outBufferId = buffer->getId();
+    }
+
+    const auto queued = output.queuedBuffers.find(*outBufferId);
+    if (queued != output.queuedBuffers.end()) {
+        if (!queued->second) {
+            --output.queuedUncachedCount;
+        }
+        output.queuedBuffers.erase(queued);
+    }
+    return NO_ERROR;
+}
+
+StreamSplitter::OutputState* StreamSplitter::findOutputLocked(
+        const sp<IGraphicBufferProducer>& producer) {
+    for (OutputState& output : mOutputs) {
+        if (output.producer == producer) {
+            return &output;
+        }
     }
+    return nullptr;
 }
 
 void StreamSplitter::onBufferReleasedByOutput(
@@ -191,31 +323,42 @@ void StreamSplitter::onBufferReleasedByOutput(
     ATRACE_CALL();
     Mutex::Autolock lock(mMutex);
 
-    sp<GraphicBuffer> buffer;
+    OutputState* output = findOutputLocked(from);
+    LOG_ALWAYS_FATAL_IF(output == nullptr, "buffer released by unknown output %p", from.get());
+
+    uint64_t bufferId = 0;
     sp<Fence> fence;
-    status_t status = from->detachNextBuffer(&buffer, &fence);
+    status_t status = takeReleasedBufferLocked(*output, &bufferId, &fence);
     if (status == NO_INIT) {
         // If we just discovered that this output has been abandoned, note that,
         // but we can't do anything else, since buffer is invalid
         onAbandonedLocked();
         return;
+    } else if (status == TIMED_OUT) {
+        // The output had no released buffer to return after all
+        ALOGW("no released buffer in output %p", from.get());
+        return;
     } else {
         LOG_ALWAYS_FATAL_IF(status != NO_ERROR,
-                "detaching buffer from output failed (%d)", status);
+                "taking buffer from output failed (%d)", status);
     }
 
-    ALOGV("detached buffer %#" PRIx64 " from output %p",
-          buffer->getId(), from.get());
+    ALOGV("took buffer %#" PRIx64 " from output %p", bufferId, from.get());
 
-    const sp<BufferTracker>& tracker = mBuffers.editValueFor(buffer->getId());
+    const sp<BufferTracker>& tracker = mBuffers.editValueFor(bufferId);
 
-    // Merge the release fence of the incoming buffer so that the fence we send
+    const nsecs_t latency = systemTime() - tracker->getQueueTime();
+    ++output->releaseCount;
+    output->totalReleaseLatency += latency;
+    output->maxReleaseLatency = std::max(output->maxReleaseLatency, latency);
+
+    // Keep the release fence of the incoming buffer so that the fence we send
     // back to the input includes all of the outputs' fences
-    tracker->mergeFence(fence);
+    tracker->addReleaseFence(fence);
 
     // Check to see if this is the last outstanding reference to this buffer
     size_t releaseCount = tracker->incrementReleaseCountLocked();
-    ALOGV("buffer %#" PRIx64 " reference count %zu (of %zu)", buffer->getId(),
+    ALOGV("buffer %#" PRIx64 " reference count %zu (of %zu)", bufferId,
             releaseCount, mOutputs.size());
     if (releaseCount < mOutputs.size()) {
         return;
@@ -224,7 +367,7 @@ void StreamSplitter::onBufferReleasedByOutput(
     // If we've been abandoned, we can't return the buffer to the input, so just
     // stop tracking it and move on
     if (mIsAbandoned) {
-        mBuffers.removeItem(buffer->getId());
+        mBuffers.removeItem(bufferId);
         return;
     }
 
@@ -235,15 +378,15 @@ void StreamSplitter::onBufferReleasedByOutput(
             "attaching buffer to input failed (%d)", status);
 
     status = mInput->releaseBuffer(consumerSlot, /* frameNumber */ 0,
-            EGL_NO_DISPLAY, EGL_NO_SYNC_KHR, tracker->getMergedFence());
+            EGL_NO_DISPLAY, EGL_NO_SYNC_KHR, tracker->mergeReleaseFences());
     LOG_ALWAYS_FATAL_IF(status != NO_ERROR,
             "releasing buffer to input failed (%d)", status);
 
-    ALOGV("released buffer %#" PRIx64 " to input", buffer->getId());
+    ALOGV("released buffer %#" PRIx64 " to input", bufferId);
 
     // We no longer need to track the buffer once it has been returned to the
     // input
-    mBuffers.removeItem(buffer->getId());
+    mBuffers.removeItem(bufferId);
 
     // Notify any waiting onFrameAvailable calls
     --mOutstandingBuffers;
@@ -276,12 +419,25 @@ void StreamSplitter::OutputListener::binderDied(const wp<IBinder>& /* who */) {
 }
 
 StreamSplitter::BufferTracker::BufferTracker(const sp<GraphicBuffer>& buffer)
-      : mBuffer(buffer), mMergedFence(Fence::NO_FENCE), mReleaseCount(0) {}
+      : mBuffer(buffer), mQueueTime(systemTime()), mReleaseCount(0) {}
 
 StreamSplitter::BufferTracker::~BufferTracker() {}
 
-void StreamSplitter::BufferTracker::mergeFence(const sp<Fence>& with) {
-    mMergedFence = Fence::merge(String8("StreamSplitter"), mMergedFence, with);
+void StreamSplitter::BufferTracker::addReleaseFence(const sp<Fence>& fence) {
+    // Fences that have already signaled need not be merged
+    if (fence != nullptr && fence->isValid() &&
+            fence->getStatus() != Fence::Status::Signaled) {
+        mReleaseFences.push_back(fence);
+    }
+}
+
+sp<Fence> StreamSplitter::BufferTracker::mergeReleaseFences() const {
+    sp<Fence> merged = Fence::NO_FENCE;
+    for (const sp<Fence>& fence : mReleaseFences) {
+        merged = merged->isValid() ? Fence::merge(String8("StreamSplitter"), merged, fence)
+                                   : fence;
+    }
+    return merged;
 }
 
 } // namespace android
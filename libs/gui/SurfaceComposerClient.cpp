@@ -471,6 +471,11 @@ void TransactionCompletedListener::addSurfaceControlToCallbacks(
 }
 
 void TransactionCompletedListener::onTransactionCompleted(ListenerStats listenerStats) {
+    for (const auto& releasedBuffer : listenerStats.releasedBuffers) {
+        onReleaseBuffer(releasedBuffer.callbackId, releasedBuffer.releaseFence,
+                        releasedBuffer.currentMaxAcquiredBufferCount);
+    }
+
     std::unordered_map<CallbackId, CallbackTranslation, CallbackIdHash> callbacksMap;
     {
         std::lock_guard<std::mutex> lock(mMutex);
@@ -3323,6 +3328,18 @@ status_t ScreenshotClient::captureLayers(const LayerCaptureArgs& captureArgs,
     return statusTFromBinderStatus(status);
 }
 
+status_t ScreenshotClient::captureLayersBatch(
+        const std::vector<LayerCaptureArgs>& captureArgs,
+        const std::vector<sp<IScreenCaptureListener>>& captureListeners) {
+    if (captureArgs.size() != captureListeners.size()) return BAD_VALUE;
+
+    sp<gui::ISurfaceComposer> s(ComposerServiceAIDL::getComposerService());
+    if (s == nullptr) return NO_INIT;
+
+    binder::Status status = s->captureLayersBatch(captureArgs, captureListeners);
+    return statusTFromBinderStatus(status);
+}
+
 // ---------------------------------------------------------------------------------
 
 void ReleaseCallbackThread::addReleaseCallback(const ReleaseCallbackId callbackId,
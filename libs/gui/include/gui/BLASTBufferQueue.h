@@ -30,6 +30,7 @@
 
 #include <system/window.h>
 #include <queue>
+#include <unordered_set>
 
 #include <com_android_graphics_libgui_flags.h>
 
@@ -86,6 +87,45 @@ private:
     bool mPreviouslyConnected GUARDED_BY(mMutex);
 };
 
+// Coalesces the per-frame transactions of several BLASTBufferQueues into a single
+// Transaction::apply. Each queue attached with BLASTBufferQueue::setTransactionBatcher merges
+// its frame transactions into a shared pending transaction instead of applying it, and the owner
+// calls apply() once per vsync after all of its surfaces have queued their frames. This turns N
+// setTransactionState calls per frame into one for apps that draw several BLAST surfaces in
+// lockstep, such as a video surface with UI overlays.
+//
+// All queues attached to a batcher use its apply token, so their transactions stay ordered with
+// respect to each other and to the batched frames.
+class BLASTTransactionBatcher : public RefBase {
+public:
+    BLASTTransactionBatcher() = default;
+
+    // Applies the pending transaction, if any.
+    void apply() EXCLUDES(mMutex);
+
+    const sp<IBinder>& getApplyToken() const { return mApplyToken; }
+
+private:
+    friend class BLASTBufferQueue;
+
+    // Merges the frame transaction of queue into the pending transaction. If queue already has a
+    // frame pending, that frame is applied first so two frames of one surface are never merged.
+    void addFrameTransaction(const BLASTBufferQueue* queue, SurfaceComposerClient::Transaction* t)
+            EXCLUDES(mMutex);
+
+    // Merges t into the pending transaction and applies it right away. Used for transactions
+    // that must not be delayed but have to stay ordered after the pending frames.
+    void applyNow(SurfaceComposerClient::Transaction* t) EXCLUDES(mMutex);
+
+    void applyLocked() REQUIRES(mMutex);
+
+    std::mutex mMutex;
+    const sp<IBinder> mApplyToken = sp<BBinder>::make();
+    SurfaceComposerClient::Transaction mTransaction GUARDED_BY(mMutex);
+    bool mHasPendingTransaction GUARDED_BY(mMutex) = false;
+    std::unordered_set<const BLASTBufferQueue*> mPendingQueues GUARDED_BY(mMutex);
+};
+
 class BLASTBufferQueue : public ConsumerBase::FrameAvailableListener {
 public:
     BLASTBufferQueue(const std::string& name, bool updateDestinationFrame = true);
@@ -143,6 +183,14 @@ public:
      */
     void setTransactionHangCallback(std::function<void(const std::string&)> callback);
     void setApplyToken(sp<IBinder>);
+
+    /**
+     * Routes the per-frame transactions of this queue through batcher, which applies them
+     * together with the frames of the other queues sharing it. This replaces the apply token of
+     * the queue with the one of the batcher. Passing nullptr applies anything still pending in
+     * the previous batcher and restores immediate per-frame applies on the batcher's token.
+     */
+    void setTransactionBatcher(sp<BLASTTransactionBatcher> batcher);
     virtual ~BLASTBufferQueue();
 
     void onFirstRef() override;
@@ -168,6 +216,9 @@ private:
     void mergePendingTransactions(SurfaceComposerClient::Transaction* t, uint64_t frameNumber)
             REQUIRES(mMutex);
 
+    // Applies t on our apply token, or through the batcher when one is set.
+    void applyTransactionLocked(SurfaceComposerClient::Transaction* t) REQUIRES(mMutex);
+
     void flushShadowQueue() REQUIRES(mMutex);
     void acquireAndReleaseBuffer() REQUIRES(mMutex);
     void releaseBuffer(const ReleaseCallbackId& callbackId, const sp<Fence>& releaseFence)
@@ -273,6 +324,10 @@ private:
     // transactions from other parts of the client from blocking this transaction.
     sp<IBinder> mApplyToken GUARDED_BY(mMutex) = sp<BBinder>::make();
 
+    // When set, frame transactions are merged into the batcher instead of applied. See
+    // BLASTTransactionBatcher.
+    sp<BLASTTransactionBatcher> mTransactionBatcher GUARDED_BY(mMutex);
+
     // Guards access to mDequeueTimestamps since we cannot hold to mMutex in onFrameDequeued or
     // we will deadlock.
     std::mutex mTimestampMutex;
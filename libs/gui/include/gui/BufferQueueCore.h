@@ -32,6 +32,7 @@
 #include <utils/Trace.h>
 #include <utils/Vector.h>
 
+#include <atomic>
 #include <list>
 #include <set>
 #include <mutex>
@@ -133,6 +134,46 @@ private:
     // waitWhileAllocatingLocked blocks until mIsAllocating is false.
     void waitWhileAllocatingLocked(std::unique_lock<std::mutex>& lock) const;
 
+    // Counts how often a caller found mMutex already held. Updated without
+    // holding mMutex so that it can be bumped before the lock is acquired.
+    struct LockContention {
+        std::atomic<uint64_t> acquisitions = 0;
+        std::atomic<uint64_t> contended = 0;
+        std::atomic<nsecs_t> waitTime = 0;
+    };
+
+    // lockTracked locks mMutex and records in contention whether and for how
+    // long it had to block. The uncontended case costs one try_lock.
+    std::unique_lock<std::mutex> lockTracked(LockContention& contention) const;
+
+    // Distribution of a latency in power-of-two microsecond buckets, from
+    // <1us up to >=8.4s in the last bucket. Guarded by mMutex.
+    struct LatencyHistogram {
+        static constexpr size_t NUM_BUCKETS = 25;
+
+        void record(nsecs_t latency);
+        void dump(String8* outResult, const std::string& prefix, const char* name) const;
+
+        uint64_t buckets[NUM_BUCKETS] = {};
+        uint64_t count = 0;
+        nsecs_t total = 0;
+        nsecs_t max = 0;
+    };
+
+    // Records into histogram how long mMutex stays held, from construction
+    // until destruction. Must be declared after the lock it measures so that
+    // it is destroyed, and records, while mMutex is still held.
+    class LockHoldTimer {
+    public:
+        explicit LockHoldTimer(LatencyHistogram& histogram)
+              : mHistogram(histogram), mStart(systemTime(SYSTEM_TIME_MONOTONIC)) {}
+        ~LockHoldTimer() { mHistogram.record(systemTime(SYSTEM_TIME_MONOTONIC) - mStart); }
+
+    private:
+        LatencyHistogram& mHistogram;
+        const nsecs_t mStart;
+    };
+
 #if DEBUG_ONLY_CODE
     // validateConsistencyLocked ensures that the free lists are in sync with
     // the information stored in mSlots
@@ -347,6 +388,21 @@ private:
 
     OccupancyTracker mOccupancyTracker;
 
+    // Contention on mMutex seen by queueBuffer(s) on the producer side and by
+    // acquireBuffer on the consumer side, which are the two calls made once
+    // per frame. Reported by dumpState.
+    mutable LockContention mQueueLockContention;
+    mutable LockContention mAcquireLockContention;
+
+    // Per-frame latencies reported by dumpState. mDequeueWaitLatency is the
+    // time dequeueBuffer spent waiting for a free slot, mQueueToAcquireLatency
+    // the time a buffer spent in mQueue, and the hold latencies are how long
+    // queueBuffer(s) and acquireBuffer kept mMutex.
+    LatencyHistogram mDequeueWaitLatency;
+    LatencyHistogram mQueueToAcquireLatency;
+    LatencyHistogram mQueueLockHoldLatency;
+    LatencyHistogram mAcquireLockHoldLatency;
+
     const uint64_t mUniqueId;
 
     // When buffer size is driven by the consumer and mTransformHint specifies
@@ -18,10 +18,14 @@
 #define ANDROID_GUI_BUFFERQUEUEPRODUCER_H
 
 #include <gui/AdditionalOptions.h>
+#include <gui/BufferItem.h>
 #include <gui/BufferQueueDefs.h>
 
+#include <gui/IConsumerListener.h>
 #include <gui/IGraphicBufferProducer.h>
 
+#include <optional>
+
 namespace android {
 
 class IBinder;
@@ -47,6 +51,11 @@ public:
     // flags indicating that previously-returned buffers are no longer valid.
     virtual status_t requestBuffer(int slot, sp<GraphicBuffer>* buf);
 
+    // see IGraphicBufferProducer::requestBuffers. All slots are looked up
+    // under a single acquisition of the BufferQueue lock.
+    status_t requestBuffers(const std::vector<int32_t>& slots,
+                            std::vector<RequestBufferOutput>* outputs) override;
+
     // see IGraphicsBufferProducer::setMaxDequeuedBufferCount
     virtual status_t setMaxDequeuedBufferCount(int maxDequeuedBuffers);
 
@@ -121,6 +130,13 @@ public:
     virtual status_t queueBuffer(int slot,
             const QueueBufferInput& input, QueueBufferOutput* output);
 
+    // see IGraphicBufferProducer::queueBuffers. All buffers are queued under
+    // a single acquisition of the BufferQueue lock, and their onFrameAvailable
+    // / onFrameReplaced callbacks are delivered back to back under a single
+    // callback ticket.
+    status_t queueBuffers(const std::vector<QueueBufferInput>& inputs,
+                          std::vector<QueueBufferOutput>* outputs) override;
+
     // cancelBuffer returns a dequeued buffer to the BufferQueue, but doesn't
     // queue it for use by the consumer.
     //
@@ -128,6 +144,11 @@ public:
     // will usually be the one obtained from dequeueBuffer.
     virtual status_t cancelBuffer(int slot, const sp<Fence>& fence);
 
+    // see IGraphicBufferProducer::cancelBuffers. All buffers are cancelled
+    // under a single acquisition of the BufferQueue lock.
+    status_t cancelBuffers(const std::vector<CancelBufferInput>& inputs,
+                           std::vector<status_t>* results) override;
+
     // Query native window attributes.  The "what" values are enumerated in
     // window.h (e.g. NATIVE_WINDOW_FORMAT).
     virtual int query(int what, int* outValue);
@@ -233,6 +254,34 @@ private:
     void addAndGetFrameTimestamps(const NewFrameEventsEntry* newTimestamps,
             FrameEventHistoryDelta* outDelta);
 
+    // The parts of requestBuffer and cancelBuffer which run with
+    // mCore->mMutex held, shared with their batched versions.
+    status_t requestBufferLocked(int slot, sp<GraphicBuffer>* buf);
+    status_t cancelBufferLocked(int slot, const sp<Fence>& fence,
+                                std::optional<uint64_t>* outCancelledBufferId);
+
+    // What queueBufferLocked hands over to the rest of queueBuffer, which
+    // runs after mCore->mMutex has been released.
+    struct QueuedFrame {
+        BufferItem item;
+        sp<IConsumerListener> frameAvailableListener;
+        sp<IConsumerListener> frameReplacedListener;
+        std::shared_ptr<FenceTime> acquireFenceTime;
+        sp<Fence> lastQueuedFence;
+        int64_t requestedPresentTimestamp = 0;
+        bool getFrameTimestamps = false;
+        int connectedApi = 0;
+        bool enableEglCpuThrottling = true;
+    };
+    // Validates the input and queues the buffer in slot. mCore->mMutex must
+    // be held. Does not take a callback ticket.
+    status_t queueBufferLocked(int slot, const QueueBufferInput& input,
+                               QueueBufferOutput* output, QueuedFrame* frame);
+    void addQueuedFrameTimestamps(QueuedFrame* frame, QueueBufferOutput* output);
+    // Must be called with mCallbackMutex held and the frame's ticket current.
+    void callQueuedFrameListener(const QueuedFrame& frame);
+    void throttleQueuedFrame(const QueuedFrame& frame);
+
     // waitForFreeSlotThenRelock finds the oldest slot in the FREE state. It may
     // block if there are no available slots and we are not in non-blocking
     // mode (producer and consumer controlled by the application). If it blocks,
@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <span>
 #include <string>
 #include <vector>
 
@@ -32,6 +33,12 @@ namespace android::gui {
  * IPC wrapper to pass release fences from SurfaceFlinger to apps via a local unix domain socket.
  */
 class BufferReleaseChannel {
+public:
+    struct Message;
+
+    // The maximum number of messages, and so of release fences, sent in a single socket message.
+    static constexpr size_t kMaxBatchedMessages = 16;
+
 private:
     class Endpoint {
     public:
@@ -59,7 +66,10 @@ public:
               : Endpoint(std::move(name), std::move(fd)) {}
 
         /**
-         * Reads a release fence from the BufferReleaseChannel.
+         * Reads a release fence from the BufferReleaseChannel. Release fences that were written
+         * together are received together, and the following ones are returned by the next calls
+         * without reading from the socket, so callers that wait for the socket to be readable
+         * must first check hasPendingReleaseFences.
          *
          * Returns OK on success.
          * Returns WOULD_BLOCK if there is no fence present.
@@ -68,8 +78,18 @@ public:
         status_t readReleaseFence(ReleaseCallbackId& outReleaseCallbackId,
                                   sp<Fence>& outReleaseFence, uint32_t& maxAcquiredBufferCount);
 
+        // Returns whether readReleaseFence has release fences to return without reading from the
+        // socket.
+        bool hasPendingReleaseFences() const {
+            return mNextPendingMessage < mPendingMessages.size();
+        }
+
     private:
+        status_t readMessages();
+
         std::vector<uint8_t> mFlattenedBuffer;
+        std::vector<Message> mPendingMessages;
+        size_t mNextPendingMessage = 0;
     };
 
     class ProducerEndpoint : public Endpoint, public Parcelable {
@@ -84,7 +104,13 @@ public:
         status_t writeReleaseFence(const ReleaseCallbackId&, const sp<Fence>& releaseFence,
                                    uint32_t maxAcquiredBufferCount);
 
+        // Writes the release fences with as few socket messages as possible. The messages must
+        // have non-null release fences.
+        status_t writeReleaseFences(std::span<const Message> messages);
+
     private:
+        status_t writeMessages(std::span<const Message> messages);
+
         std::vector<uint8_t> mFlattenedBuffer;
     };
 
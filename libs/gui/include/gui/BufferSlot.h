@@ -181,6 +181,7 @@ struct BufferSlot {
       mBufferState(),
       mRequestBufferCalled(false),
       mFrameNumber(0),
+      mQueueTime(0),
       mEglFence(EGL_NO_SYNC_KHR),
       mFence(Fence::NO_FENCE),
       mAcquireCalled(false),
@@ -207,6 +208,10 @@ struct BufferSlot {
     // may be released before their release fence is signaled).
     uint64_t mFrameNumber;
 
+    // mQueueTime is the monotonic time at which the buffer in this slot was
+    // last queued. Used to measure queue-to-acquire latency.
+    nsecs_t mQueueTime;
+
     // mEglFence is the EGL sync object that must signal before the buffer
     // associated with this buffer slot may be dequeued. It is initialized
     // to EGL_NO_SYNC_KHR when the buffer is created and may be set to a
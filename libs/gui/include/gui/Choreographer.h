@@ -21,6 +21,7 @@
 #include <jni.h>
 #include <utils/Looper.h>
 
+#include <atomic>
 #include <mutex>
 #include <queue>
 #include <thread>
@@ -116,8 +117,8 @@ private:
 
     void dispatchVsync(nsecs_t timestamp, PhysicalDisplayId displayId, uint32_t count,
                        VsyncEventData vsyncEventData) override;
-    void dispatchCallbacks(const std::vector<FrameCallback>&, VsyncEventData vsyncEventData,
-                           nsecs_t timestamp);
+    void dispatchCallbacks(const std::vector<FrameCallback>&, CallbackType callbackType,
+                           VsyncEventData vsyncEventData, nsecs_t timestamp);
     void dispatchHotplug(nsecs_t timestamp, PhysicalDisplayId displayId, bool connected) override;
     void dispatchHotplugConnectionError(nsecs_t timestamp, int32_t connectionError) override;
     void dispatchModeChanged(nsecs_t timestamp, PhysicalDisplayId displayId, int32_t modeId,
@@ -135,9 +136,21 @@ private:
 
     std::mutex mLock;
     // Protected by mLock
-    std::priority_queue<FrameCallback> mFrameCallbacks;
+    // Callbacks posted without a delay, in posting order. They are all due at the next vsync, so
+    // they are kept in a plain list that dispatchVsync swaps out in one go.
+    std::vector<FrameCallback> mPendingCallbacks;
+    // Callbacks posted with a delay, ordered by due time.
+    std::priority_queue<FrameCallback> mDelayedCallbacks;
     std::vector<RefreshRateCallback> mRefreshRateCallbacks;
 
+    // The other half of mPendingCallbacks. Only touched by dispatchVsync on the looper thread,
+    // and kept around so that its storage is reused from one vsync to the next.
+    std::vector<FrameCallback> mDispatchingCallbacks;
+
+    // Set while a refresh rate update is queued, so that several period changes signalled before
+    // the looper gets to it are handled once, with the latest period.
+    std::atomic<bool> mRefreshRateUpdatePending = false;
+
     nsecs_t mLatestVsyncPeriod = -1;
     VsyncEventData mLastVsyncEventData;
     bool mInCallback = false;
@@ -18,6 +18,9 @@
 #include <utils/Log.h>
 #include <utils/Looper.h>
 
+#include <mutex>
+#include <optional>
+
 namespace android {
 using FrameRateOverride = DisplayEventReceiver::Event::FrameRateOverride;
 
@@ -35,6 +38,8 @@ public:
     void injectEvent(const DisplayEventReceiver::Event& event);
     int getFd() const;
     virtual int handleEvent(int receiveFd, int events, void* data);
+    // Returns the frame timelines of the last vsync event while its preferred deadline has not
+    // passed, and otherwise asks the EventThread for new ones.
     status_t getLatestVsyncEventData(ParcelableVsyncEventData* outVsyncEventData) const;
 
 protected:
@@ -49,6 +54,11 @@ private:
 
     std::vector<FrameRateOverride> mFrameRateOverrides;
 
+    // The frame timelines of the last vsync event, which getLatestVsyncEventData may be called
+    // for from other threads than the looper's.
+    mutable std::mutex mLastVsyncEventDataMutex;
+    std::optional<VsyncEventData> mLastVsyncEventData;
+
     virtual void dispatchVsync(nsecs_t timestamp, PhysicalDisplayId displayId, uint32_t count,
                                VsyncEventData vsyncEventData) = 0;
     virtual void dispatchHotplug(nsecs_t timestamp, PhysicalDisplayId displayId,
@@ -70,6 +80,7 @@ private:
 
     bool processPendingEvents(nsecs_t* outTimestamp, PhysicalDisplayId* outDisplayId,
                               uint32_t* outCount, VsyncEventData* outVsyncEventData);
+    void clearLastVsyncEventData();
 
     void populateFrameTimelines(const DisplayEventReceiver::Event& event,
                                 VsyncEventData* outVsyncEventData) const;
@@ -19,6 +19,7 @@
 
 #include <android/gui/FrameEvent.h>
 
+#include <ftl/small_vector.h>
 #include <gui/CompositorTiming.h>
 #include <ui/FenceTime.h>
 #include <utils/Flattenable.h>
@@ -320,14 +321,24 @@ public:
     status_t unflatten(void const*& buffer, size_t& size, int const*& fds,
             size_t& count);
 
-    std::vector<FrameEventsDelta>::const_iterator begin() const;
-    std::vector<FrameEventsDelta>::const_iterator end() const;
+    // Deltas for up to this many frames are stored inline, so that sending
+    // the usual handful of updates with every queueBuffer does not allocate.
+    static constexpr size_t INLINE_DELTA_COUNT = 8;
+    using Deltas = ftl::SmallVector<FrameEventsDelta, INLINE_DELTA_COUNT>;
+
+    Deltas::const_iterator begin() const;
+    Deltas::const_iterator end() const;
 
 private:
     static constexpr size_t minFlattenedSize();
 
-    std::vector<FrameEventsDelta> mDeltas;
+    Deltas mDeltas;
     CompositorTiming mCompositorTiming;
+
+    // The size of the consumer's history when the delta was taken, so the
+    // producer can grow its own history to keep frame indices in sync. Not
+    // flattened; an unflattened delta reports its delta count instead.
+    size_t mHistorySize{0};
 };
 
 
@@ -133,6 +133,25 @@ public:
     ReleaseCallbackId previousReleaseCallbackId;
 };
 
+// A buffer that SurfaceFlinger released without presenting it, for example because a newer buffer
+// replaced it before it was latched.
+class ReleasedBufferStats : public Parcelable {
+public:
+    status_t writeToParcel(Parcel* output) const override;
+    status_t readFromParcel(const Parcel* input) override;
+
+    ReleasedBufferStats() = default;
+    ReleasedBufferStats(ReleaseCallbackId callbackId, const sp<Fence>& releaseFence,
+                        uint32_t currentMaxAcquiredBufferCount)
+          : callbackId(callbackId),
+            releaseFence(releaseFence),
+            currentMaxAcquiredBufferCount(currentMaxAcquiredBufferCount) {}
+
+    ReleaseCallbackId callbackId;
+    sp<Fence> releaseFence;
+    uint32_t currentMaxAcquiredBufferCount = 0;
+};
+
 class TransactionStats : public Parcelable {
 public:
     status_t writeToParcel(Parcel* output) const override;
@@ -163,6 +182,9 @@ public:
 
     sp<IBinder> listener;
     std::vector<TransactionStats> transactionStats;
+    // Buffers released since the last callback, delivered with it instead of through separate
+    // onReleaseBuffer calls. These are released before the transaction callbacks run.
+    std::vector<ReleasedBufferStats> releasedBuffers;
 };
 
 class ITransactionCompletedListener : public IInterface {
@@ -0,0 +1,46 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <binder/Parcel.h>
+#include <binder/Parcelable.h>
+#include <ui/GraphicBuffer.h>
+
+namespace android::gui {
+
+// A buffer provided by the caller of a screen capture, which SurfaceFlinger renders the capture
+// into instead of allocating one. See CaptureArgs::outputBuffer.
+struct ScreenCaptureBuffer : public Parcelable {
+public:
+    ScreenCaptureBuffer() = default;
+    explicit ScreenCaptureBuffer(sp<GraphicBuffer> buffer) : buffer(std::move(buffer)) {}
+    virtual ~ScreenCaptureBuffer() = default;
+    status_t writeToParcel(android::Parcel* parcel) const override;
+    status_t readFromParcel(const android::Parcel* parcel) override;
+
+    // Comparisons are by buffer identity, as required for fields of AIDL parcelables.
+    bool operator==(const ScreenCaptureBuffer& other) const { return buffer == other.buffer; }
+    bool operator!=(const ScreenCaptureBuffer& other) const { return buffer != other.buffer; }
+    bool operator<(const ScreenCaptureBuffer& other) const { return buffer < other.buffer; }
+    bool operator>(const ScreenCaptureBuffer& other) const { return other < *this; }
+    bool operator<=(const ScreenCaptureBuffer& other) const { return !(other < *this); }
+    bool operator>=(const ScreenCaptureBuffer& other) const { return !(*this < other); }
+
+    sp<GraphicBuffer> buffer;
+};
+
+} // namespace android::gui
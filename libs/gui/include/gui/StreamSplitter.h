@@ -17,19 +17,27 @@
 #ifndef ANDROID_GUI_STREAMSPLITTER_H
 #define ANDROID_GUI_STREAMSPLITTER_H
 
+#include <gui/BufferQueueDefs.h>
 #include <gui/IConsumerListener.h>
+#include <gui/IGraphicBufferProducer.h>
 #include <gui/IProducerListener.h>
 
 #include <utils/Condition.h>
 #include <utils/KeyedVector.h>
 #include <utils/Mutex.h>
 #include <utils/StrongPointer.h>
+#include <utils/Timers.h>
+
+#include <optional>
+#include <unordered_map>
+#include <vector>
 
 namespace android {
 
+class Fence;
 class GraphicBuffer;
 class IGraphicBufferConsumer;
-class IGraphicBufferProducer;
+class String8;
 
 // StreamSplitter is an autonomous class that manages one input BufferQueue
 // and multiple output BufferQueues. By using the buffer attach and detach logic
@@ -37,6 +45,11 @@ class IGraphicBufferProducer;
 // BufferQueue, where each buffer queued to the input is available to be
 // acquired by each of the outputs, and is able to be dequeued by the input
 // again only once all of the outputs have released it.
+//
+// Attaching a buffer to an output makes its consumer import the buffer again
+// when it acquires it. To avoid that, the splitter keeps the buffers that an
+// output releases dequeued in the output's slots, and queues them again from
+// those slots the next time they come from the input.
 class StreamSplitter : public BnConsumerListener {
 public:
     // createSplitter creates a new splitter, outSplitter, using inputQueue as
@@ -66,6 +79,10 @@ public:
     // setName sets the consumer name of the input queue
     void setName(const String8& name);
 
+    // dump appends, for each output, how many buffers were queued from its
+    // slots rather than attached, and how long its consumer held buffers.
+    void dump(String8& result) const;
+
 private:
     // From IConsumerListener
     //
@@ -104,6 +121,69 @@ private:
     // acquire. This must be called with mMutex locked.
     void onAbandonedLocked();
 
+    // The attributes of a buffer that must match for an output to return it
+    // from dequeueBuffer without reallocating it.
+    struct BufferAttributes {
+        uint32_t width;
+        uint32_t height;
+        int32_t format;
+        uint64_t usage;
+
+        bool operator==(const BufferAttributes& other) const {
+            return width == other.width && height == other.height &&
+                    format == other.format && usage == other.usage;
+        }
+    };
+
+    struct OutputState {
+        explicit OutputState(const sp<IGraphicBufferProducer>& producer)
+              : producer(producer) {}
+
+        sp<IGraphicBufferProducer> producer;
+        uint64_t consumerUsage = 0;
+        size_t maxCachedBuffers = 0;
+
+        // The attributes of the buffers that may be cached in this output.
+        // All of the buffers that the output may release while
+        // queuedUncachedCount is zero have these attributes, which lets the
+        // splitter dequeue them without knowing in advance which one it gets.
+        std::optional<BufferAttributes> cachedAttributes;
+
+        // IDs of the buffers dequeued from this output after it released
+        // them, along with their slots, from least to most recently released.
+        std::vector<std::pair<uint64_t, int>> cachedBuffers;
+
+        // IDs of the buffers queued to this output and not yet released, and
+        // whether they may be cached when they are.
+        std::unordered_map<uint64_t, bool> queuedBuffers;
+        size_t queuedUncachedCount = 0;
+
+        // ID of the buffer last attached to each slot of this output.
+        uint64_t slotBufferIds[BufferQueueDefs::NUM_BUFFER_SLOTS] = {};
+
+        size_t attachCount = 0;
+        size_t cachedQueueCount = 0;
+        size_t releaseCount = 0;
+        nsecs_t totalReleaseLatency = 0;
+        nsecs_t maxReleaseLatency = 0;
+    };
+
+    OutputState* findOutputLocked(const sp<IGraphicBufferProducer>& producer);
+
+    // Whether the buffer may be kept in the output's slots once released.
+    static bool isCacheable(const OutputState& output, const BufferAttributes& attributes);
+
+    // Queues the buffer to the output, from its slot if the output has it
+    // cached, and attaching it otherwise. Returns the status of the failed
+    // call to the output, if any.
+    status_t queueToOutputLocked(OutputState& output, const sp<GraphicBuffer>& buffer,
+            const IGraphicBufferProducer::QueueBufferInput& input);
+
+    // Takes the next buffer that the output released back from it, keeping it
+    // dequeued in the output's slots if possible and detaching it otherwise.
+    status_t takeReleasedBufferLocked(OutputState& output, uint64_t* outBufferId,
+            sp<Fence>* outFence);
+
     // This is a thin wrapper class that lets us determine which BufferQueue
     // the IProducerListener::onBufferReleased callback is associated with. We
     // create one of these per output BufferQueue, and then pass the producer
@@ -131,9 +211,14 @@ private:
         explicit BufferTracker(const sp<GraphicBuffer>& buffer);
 
         const sp<GraphicBuffer>& getBuffer() const { return mBuffer; }
-        const sp<Fence>& getMergedFence() const { return mMergedFence; }
+        nsecs_t getQueueTime() const { return mQueueTime; }
+
+        // Keeps the release fence of an output, to be merged with the others
+        // once all of the outputs have released the buffer.
+        void addReleaseFence(const sp<Fence>& fence);
 
-        void mergeFence(const sp<Fence>& with);
+        // Merges the release fences that had not signaled yet.
+        sp<Fence> mergeReleaseFences() const;
 
         // Returns the new value
         // Only called while mMutex is held
@@ -149,7 +234,8 @@ private:
         BufferTracker& operator=(const BufferTracker& other);
 
         sp<GraphicBuffer> mBuffer; // One instance that holds this native handle
-        sp<Fence> mMergedFence;
+        const nsecs_t mQueueTime;
+        std::vector<sp<Fence>> mReleaseFences;
         size_t mReleaseCount;
     };
 
@@ -161,21 +247,24 @@ private:
 
     static const int MAX_OUTSTANDING_BUFFERS = 2;
 
+    // The maximum number of released buffers kept in the slots of each output.
+    static const int MAX_CACHED_BUFFERS_PER_OUTPUT = 8;
+
     // mIsAbandoned is set to true when an output dies. Once the StreamSplitter
     // has been abandoned, it will continue to detach buffers from other
     // outputs, but it will disconnect from the input and not attempt to
     // communicate with it further.
     bool mIsAbandoned;
 
-    Mutex mMutex;
+    mutable Mutex mMutex;
     Condition mReleaseCondition;
     int mOutstandingBuffers;
     sp<IGraphicBufferConsumer> mInput;
-    Vector<sp<IGraphicBufferProducer> > mOutputs;
+    std::vector<OutputState> mOutputs;
 
     // Map of GraphicBuffer IDs (GraphicBuffer::getId()) to buffer tracking
     // objects (which are mostly for counting how many outputs have released the
-    // buffer, but also contain merged release fences).
+    // buffer, but also contain the outputs' release fences).
     KeyedVector<uint64_t, sp<BufferTracker> > mBuffers;
 };
 
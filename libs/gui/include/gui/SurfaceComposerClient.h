@@ -879,6 +879,10 @@ public:
                                    const sp<IScreenCaptureListener>&);
     static status_t captureLayers(const LayerCaptureArgs&, const sp<IScreenCaptureListener>&,
                                   bool sync);
+    // Captures each of captureArgs, reporting the result of captureArgs[i] to captureListeners[i].
+    static status_t captureLayersBatch(const std::vector<LayerCaptureArgs>& captureArgs,
+                                       const std::vector<sp<IScreenCaptureListener>>&
+                                               captureListeners);
 
     [[deprecated]] static status_t captureDisplay(DisplayId id,
                                                   const sp<IScreenCaptureListener>& listener) {
@@ -46,6 +46,7 @@ stub_unstructured_parcelable!(DisplayInfo);
 stub_unstructured_parcelable!(LayerDebugInfo);
 stub_unstructured_parcelable!(LayerMetadata);
 stub_unstructured_parcelable!(ParcelableVsyncEventData);
+stub_unstructured_parcelable!(ScreenCaptureBuffer);
 stub_unstructured_parcelable!(ScreenCaptureResults);
 stub_unstructured_parcelable!(VsyncEventData);
 stub_unstructured_parcelable!(WindowInfo);
@@ -190,6 +190,10 @@ public:
         mBlastBufferQueueAdapter->setApplyToken(std::move(applyToken));
     }
 
+    void setTransactionBatcher(sp<BLASTTransactionBatcher> batcher) {
+        mBlastBufferQueueAdapter->setTransactionBatcher(std::move(batcher));
+    }
+
 private:
     sp<TestBLASTBufferQueue> mBlastBufferQueueAdapter;
 };
@@ -544,6 +548,33 @@ private:
     bool mCallbackReceived = false;
 };
 
+TEST_F(BLASTBufferQueueTest, TransactionBatcher) {
+    sp<BLASTTransactionBatcher> batcher = sp<BLASTTransactionBatcher>::make();
+    BLASTBufferQueueHelper adapter(mSurfaceControl, mDisplayWidth, mDisplayHeight);
+    adapter.setTransactionBatcher(batcher);
+    sp<IGraphicBufferProducer> igbProducer;
+    setUpProducer(adapter, igbProducer);
+
+    // The frame is held by the batcher until it is applied.
+    queueBuffer(igbProducer, 255, 0, 0, 0);
+    batcher->apply();
+    Transaction().apply(true /* synchronous */);
+    ASSERT_EQ(NO_ERROR, ScreenCapture::captureLayers(mCaptureArgs, mCaptureResults));
+    ASSERT_NO_FATAL_FAILURE(checkScreenCapture(255, 0, 0,
+                                               {0, 0, (int32_t)mDisplayWidth,
+                                                (int32_t)mDisplayHeight / 2}));
+
+    // A second frame from the same queue flushes the first one, and the batch stays in order.
+    queueBuffer(igbProducer, 0, 0, 255, 0);
+    queueBuffer(igbProducer, 0, 255, 0, 0);
+    batcher->apply();
+    Transaction().apply(true /* synchronous */);
+    ASSERT_EQ(NO_ERROR, ScreenCapture::captureLayers(mCaptureArgs, mCaptureResults));
+    ASSERT_NO_FATAL_FAILURE(checkScreenCapture(0, 255, 0,
+                                               {0, 0, (int32_t)mDisplayWidth,
+                                                (int32_t)mDisplayHeight / 2}));
+}
+
 TEST_F(BLASTBufferQueueTest, setApplyToken) {
     sp<IBinder> applyToken = sp<BBinder>::make();
     WaitForCommittedCallback firstTransaction;
@@ -43,6 +43,7 @@
 #include <gtest/gtest.h>
 
 #include <future>
+#include <mutex>
 #include <thread>
 
 #include <com_android_graphics_libgui_flags.h>
@@ -1147,6 +1148,38 @@ TEST_F(BufferQueueTest, TestDiscardFreeBuffers) {
     }
 }
 
+TEST_F(BufferQueueTest, DumpStateReportsFrameLatencies) {
+    createBufferQueue();
+    sp<MockConsumer> mc(new MockConsumer);
+    ASSERT_EQ(OK, mConsumer->consumerConnect(mc, false));
+    IGraphicBufferProducer::QueueBufferOutput output;
+    ASSERT_EQ(OK,
+              mProducer->connect(new StubProducerListener, NATIVE_WINDOW_API_CPU, false, &output));
+
+    int slot = BufferQueue::INVALID_BUFFER_SLOT;
+    sp<Fence> fence = Fence::NO_FENCE;
+    sp<GraphicBuffer> buffer = nullptr;
+    IGraphicBufferProducer::QueueBufferInput input(0ull, true, HAL_DATASPACE_UNKNOWN,
+                                                   Rect::INVALID_RECT,
+                                                   NATIVE_WINDOW_SCALING_MODE_FREEZE, 0,
+                                                   Fence::NO_FENCE);
+    BufferItem item{};
+
+    ASSERT_EQ(IGraphicBufferProducer::BUFFER_NEEDS_REALLOCATION,
+              mProducer->dequeueBuffer(&slot, &fence, 0, 0, 0, TEST_PRODUCER_USAGE_BITS, nullptr,
+                                       nullptr));
+    ASSERT_EQ(OK, mProducer->requestBuffer(slot, &buffer));
+    ASSERT_EQ(OK, mProducer->queueBuffer(slot, input, &output));
+    ASSERT_EQ(OK, mConsumer->acquireBuffer(&item, 0));
+
+    String8 dumpString;
+    mConsumer->dumpState(String8{}, &dumpString);
+    EXPECT_NE(-1, dumpString.find("dequeue wait latency count=1 "));
+    EXPECT_NE(-1, dumpString.find("queue-to-acquire latency count=1 "));
+    EXPECT_NE(-1, dumpString.find("queue lock held latency count=1 "));
+    EXPECT_NE(-1, dumpString.find("acquire lock held latency count=1 "));
+}
+
 TEST_F(BufferQueueTest, TestBufferReplacedInQueueBuffer) {
     createBufferQueue();
     sp<MockConsumer> mc(new MockConsumer);
@@ -1192,6 +1225,76 @@ TEST_F(BufferQueueTest, TestBufferReplacedInQueueBuffer) {
     ASSERT_EQ(true, output.bufferReplaced);
 }
 
+struct FrameCountingConsumer : public BnConsumerListener {
+    void onFrameAvailable(const BufferItem& item) override {
+        std::lock_guard lock(mutex);
+        frameNumbers.push_back(item.mFrameNumber);
+    }
+    void onBuffersReleased() override {}
+    void onSidebandStreamChanged() override {}
+
+    std::mutex mutex;
+    std::vector<uint64_t> frameNumbers;
+};
+
+TEST_F(BufferQueueTest, TestBatchedQueueBuffersDeliverEveryFrameInOrder) {
+    createBufferQueue();
+    sp<FrameCountingConsumer> consumer = sp<FrameCountingConsumer>::make();
+    ASSERT_EQ(OK, mConsumer->consumerConnect(consumer, false));
+    IGraphicBufferProducer::QueueBufferOutput output;
+    ASSERT_EQ(OK,
+              mProducer->connect(new StubProducerListener, NATIVE_WINDOW_API_CPU, false, &output));
+    constexpr size_t kBatchSize = 3;
+    ASSERT_EQ(OK, mProducer->setMaxDequeuedBufferCount(kBatchSize));
+    ASSERT_EQ(OK, mConsumer->setMaxAcquiredBufferCount(kBatchSize));
+
+    std::vector<int32_t> slots;
+    for (size_t i = 0; i < kBatchSize; ++i) {
+        int slot = BufferQueue::INVALID_BUFFER_SLOT;
+        sp<Fence> fence;
+        ASSERT_EQ(IGraphicBufferProducer::BUFFER_NEEDS_REALLOCATION,
+                  mProducer->dequeueBuffer(&slot, &fence, 0, 0, 0, TEST_PRODUCER_USAGE_BITS,
+                                           nullptr, nullptr));
+        slots.push_back(slot);
+    }
+
+    std::vector<IGraphicBufferProducer::RequestBufferOutput> requestOutputs;
+    ASSERT_EQ(OK, mProducer->requestBuffers(slots, &requestOutputs));
+    ASSERT_EQ(kBatchSize, requestOutputs.size());
+    for (const auto& requestOutput : requestOutputs) {
+        ASSERT_EQ(OK, requestOutput.result);
+        ASSERT_NE(nullptr, requestOutput.buffer);
+    }
+
+    // The invalid entry fails on its own without affecting the others.
+    std::vector<IGraphicBufferProducer::QueueBufferInput> queueInputs;
+    for (int32_t slot : slots) {
+        queueInputs.emplace_back(0ull, true, HAL_DATASPACE_UNKNOWN, Rect::INVALID_RECT,
+                                 NATIVE_WINDOW_SCALING_MODE_FREEZE, 0, Fence::NO_FENCE)
+                .slot = slot;
+    }
+    queueInputs.insert(queueInputs.begin() + 1, queueInputs.front());
+    queueInputs[1].slot = -1;
+    std::vector<IGraphicBufferProducer::QueueBufferOutput> queueOutputs;
+    ASSERT_EQ(OK, mProducer->queueBuffers(queueInputs, &queueOutputs));
+    ASSERT_EQ(queueInputs.size(), queueOutputs.size());
+    EXPECT_EQ(OK, queueOutputs[0].result);
+    EXPECT_EQ(BAD_VALUE, queueOutputs[1].result);
+    EXPECT_EQ(OK, queueOutputs[2].result);
+    EXPECT_EQ(OK, queueOutputs[3].result);
+
+    {
+        std::lock_guard lock(consumer->mutex);
+        EXPECT_THAT(consumer->frameNumbers, ::testing::ElementsAre(1u, 2u, 3u));
+    }
+    for (size_t i = 0; i < kBatchSize; ++i) {
+        BufferItem item;
+        ASSERT_EQ(OK, mConsumer->acquireBuffer(&item, 0));
+        EXPECT_EQ(slots[i], item.mSlot);
+        EXPECT_EQ(i + 1, item.mFrameNumber);
+    }
+}
+
 TEST_F(BufferQueueTest, TestStaleBufferHandleSentAfterDisconnect) {
     createBufferQueue();
     sp<MockConsumer> mc(new MockConsumer);
@@ -135,4 +135,46 @@ TEST(BufferReleaseChannelTest, ProduceAndConsume) {
     }
 }
 
+// Verify that release fences written together are read back in order, whether or not they have a
+// file descriptor, including when there are more than fit in a single socket message.
+TEST(BufferReleaseChannelTest, ProduceAndConsumeBatch) {
+    std::unique_ptr<BufferReleaseChannel::ConsumerEndpoint> consumer;
+    std::shared_ptr<BufferReleaseChannel::ProducerEndpoint> producer;
+    ASSERT_EQ(OK, BufferReleaseChannel::open("test-channel"s, consumer, producer));
+
+    sp<Fence> fence = sp<Fence>::make(memfd_create("fake-fence-fd", 0));
+
+    const uint64_t count = BufferReleaseChannel::kMaxBatchedMessages + 4;
+    std::vector<BufferReleaseChannel::Message> messages;
+    for (uint64_t i = 0; i < count; i++) {
+        messages.emplace_back(ReleaseCallbackId{i, i + 1}, i % 2 ? fence : Fence::NO_FENCE,
+                              static_cast<uint32_t>(i + 2));
+    }
+    ASSERT_EQ(OK, producer->writeReleaseFences(messages));
+
+    for (uint64_t i = 0; i < count; i++) {
+        ReleaseCallbackId consumerId;
+        sp<Fence> consumerFence;
+        uint32_t maxAcquiredBufferCount;
+        ASSERT_EQ(OK,
+                  consumer->readReleaseFence(consumerId, consumerFence, maxAcquiredBufferCount));
+
+        ASSERT_EQ((ReleaseCallbackId{i, i + 1}), consumerId);
+        if (i % 2) {
+            ASSERT_TRUE(is_same_file(fence->get(), consumerFence->get()));
+        } else {
+            ASSERT_FALSE(consumerFence->isValid());
+        }
+        ASSERT_EQ(i + 2, maxAcquiredBufferCount);
+        ASSERT_EQ(i != BufferReleaseChannel::kMaxBatchedMessages - 1 && i != count - 1,
+                  consumer->hasPendingReleaseFences());
+    }
+
+    ReleaseCallbackId releaseCallbackId;
+    sp<Fence> releaseFence;
+    uint32_t maxAcquiredBufferCount;
+    ASSERT_EQ(WOULD_BLOCK,
+              consumer->readReleaseFence(releaseCallbackId, releaseFence, maxAcquiredBufferCount));
+}
+
 } // namespace android
\ No newline at end of file
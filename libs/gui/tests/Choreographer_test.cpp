@@ -21,6 +21,8 @@
 #include <gtest/gtest.h>
 #include <gui/Choreographer.h>
 #include <utils/Looper.h>
+#include <algorithm>
+#include <array>
 #include <chrono>
 #include <future>
 #include <string>
@@ -83,4 +85,35 @@ TEST_F(ChoreographerTest, InputCallbackBeforeAnimation) {
                                            animationCb.frameTime.count());
 }
 
+TEST_F(ChoreographerTest, CallbacksPostedTogetherRunOnSameVsyncInOrder) {
+    sp<Looper> looper = Looper::prepare(0);
+    Choreographer* choreographer = Choreographer::getForThread();
+    static constexpr size_t kCallbackCount = 32;
+    std::array<VsyncCallback, kCallbackCount> callbacks;
+    for (auto& cb : callbacks) {
+        choreographer->postFrameCallbackDelayed(nullptr, nullptr, vsyncCallback, &cb, 0,
+                                                CALLBACK_ANIMATION);
+    }
+    auto allReceived = [&] {
+        return std::all_of(callbacks.begin(), callbacks.end(),
+                           [](VsyncCallback& cb) { return cb.callbackReceived(); });
+    };
+    auto startTime = std::chrono::system_clock::now();
+    do {
+        static constexpr int32_t timeoutMs = 1000;
+        int pollResult = looper->pollOnce(timeoutMs);
+        ASSERT_TRUE((pollResult != Looper::POLL_TIMEOUT) && (pollResult != Looper::POLL_ERROR))
+                << "Failed to poll looper. Poll result = " << pollResult;
+        auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::system_clock::now() - startTime);
+        ASSERT_LE(elapsedMs.count(), timeoutMs) << "Timed out waiting for callbacks";
+    } while (!allReceived());
+
+    for (size_t i = 1; i < kCallbackCount; i++) {
+        EXPECT_EQ(callbacks[0].frameTime, callbacks[i].frameTime) << "callback " << i;
+        EXPECT_LE(callbacks[i - 1].receivedCallbackTime, callbacks[i].receivedCallbackTime)
+                << "callback " << i;
+    }
+}
+
 } // namespace android
\ No newline at end of file
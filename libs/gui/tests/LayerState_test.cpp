@@ -0,0 +1,107 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <binder/Binder.h>
+#include <binder/Parcel.h>
+
+#include <gui/LayerState.h>
+
+namespace android {
+namespace test {
+
+layer_state_t roundTrip(const layer_state_t& in, size_t* outSize = nullptr) {
+    Parcel p;
+    EXPECT_EQ(OK, in.write(p));
+    if (outSize) {
+        *outSize = p.dataSize();
+    }
+    p.setDataPosition(0);
+    layer_state_t out;
+    EXPECT_EQ(OK, out.read(p));
+    EXPECT_EQ(p.dataSize(), p.dataPosition());
+    return out;
+}
+
+TEST(LayerState, ParcellingSelectedFields) {
+    layer_state_t in;
+    in.surface = sp<BBinder>::make();
+    in.layerId = 42;
+    in.what = layer_state_t::ePositionChanged | layer_state_t::eAlphaChanged |
+            layer_state_t::eFlagsChanged | layer_state_t::eCornerRadiusChanged |
+            layer_state_t::eBlurRegionsChanged | layer_state_t::eFrameRateChanged |
+            layer_state_t::eDesiredHdrHeadroomChanged;
+    in.x = 10.5f;
+    in.y = -3.f;
+    in.color.a = 0.25f;
+    in.flags = layer_state_t::eLayerHidden;
+    in.mask = layer_state_t::eLayerHidden | layer_state_t::eLayerOpaque;
+    in.cornerRadius = 8.f;
+    BlurRegion region;
+    region.blurRadius = 5;
+    region.alpha = 0.5f;
+    region.right = 100;
+    region.bottom = 50;
+    in.blurRegions.push_back(region);
+    in.frameRate = 60.f;
+    in.frameRateCompatibility = ANATIVEWINDOW_FRAME_RATE_COMPATIBILITY_FIXED_SOURCE;
+    in.desiredHdrSdrRatio = 2.f;
+
+    const layer_state_t out = roundTrip(in);
+    EXPECT_EQ(in.surface, out.surface);
+    EXPECT_EQ(in.layerId, out.layerId);
+    EXPECT_EQ(in.what, out.what);
+    EXPECT_EQ(in.x, out.x);
+    EXPECT_EQ(in.y, out.y);
+    EXPECT_EQ(in.color.a, out.color.a);
+    EXPECT_EQ(in.flags, out.flags);
+    EXPECT_EQ(in.mask, out.mask);
+    EXPECT_EQ(in.cornerRadius, out.cornerRadius);
+    ASSERT_EQ(1u, out.blurRegions.size());
+    EXPECT_EQ(region.blurRadius, out.blurRegions[0].blurRadius);
+    EXPECT_EQ(region.alpha, out.blurRegions[0].alpha);
+    EXPECT_EQ(region.right, out.blurRegions[0].right);
+    EXPECT_EQ(region.bottom, out.blurRegions[0].bottom);
+    EXPECT_EQ(in.frameRate, out.frameRate);
+    EXPECT_EQ(in.frameRateCompatibility, out.frameRateCompatibility);
+    EXPECT_EQ(in.desiredHdrSdrRatio, out.desiredHdrSdrRatio);
+}
+
+TEST(LayerState, UnselectedFieldsAreNotSent) {
+    layer_state_t in;
+    in.what = layer_state_t::ePositionChanged;
+    in.x = 1.f;
+    in.y = 2.f;
+    // Not selected by what, so the reader keeps its defaults.
+    in.z = 7;
+    in.cornerRadius = 4.f;
+
+    size_t positionOnlySize = 0;
+    const layer_state_t out = roundTrip(in, &positionOnlySize);
+    EXPECT_EQ(1.f, out.x);
+    EXPECT_EQ(2.f, out.y);
+    EXPECT_EQ(0, out.z);
+    EXPECT_EQ(0.f, out.cornerRadius);
+
+    in.what |= layer_state_t::eLayerChanged | layer_state_t::eCornerRadiusChanged;
+    size_t largerSize = 0;
+    roundTrip(in, &largerSize);
+    EXPECT_LT(positionOnlySize, largerSize);
+}
+
+} // namespace test
+} // namespace android
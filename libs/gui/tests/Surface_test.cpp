@@ -816,6 +816,11 @@ public:
         return binder::Status::ok();
     }
 
+    binder::Status captureLayersBatch(const std::vector<LayerCaptureArgs>&,
+                                      const std::vector<sp<IScreenCaptureListener>>&) override {
+        return binder::Status::ok();
+    }
+
     binder::Status clearAnimationFrameStats() override { return binder::Status::ok(); }
 
     binder::Status getAnimationFrameStats(gui::FrameStats* /*outStats*/) override {
@@ -0,0 +1,260 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "InputMessageRing"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <android-base/logging.h>
+#include <input/InputMessageRing.h>
+
+using android::base::Error;
+using android::base::ErrnoError;
+using android::base::Result;
+using android::base::unique_fd;
+
+namespace android {
+
+namespace {
+
+constexpr uint32_t RING_MAGIC = 0x49524e47; // 'IRNG'
+
+// Bounds the size of the shared memory, and keeps the size computation from overflowing.
+constexpr size_t MAX_RING_CAPACITY = 1024;
+
+// Keeps the indices of the producer and of the consumer on separate cache lines.
+constexpr size_t CACHE_LINE_SIZE = 64;
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free);
+static_assert(std::atomic<uint32_t>::is_always_lock_free);
+
+void signalEventFd(int fd) {
+    const uint64_t value = 1;
+    ssize_t nWrite;
+    do {
+        nWrite = ::write(fd, &value, sizeof(value));
+    } while (nWrite == -1 && errno == EINTR);
+}
+
+void drainEventFd(int fd) {
+    uint64_t value;
+    ssize_t nRead;
+    do {
+        nRead = ::read(fd, &value, sizeof(value));
+    } while (nRead == -1 && errno == EINTR);
+}
+
+} // namespace
+
+struct InputMessageRing::Header {
+    uint32_t magic;
+    uint32_t capacity;
+    // Written by the producer only.
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> writeIndex;
+    // Written by the consumer only.
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> readIndex;
+    // Set by the consumer when it found the ring empty, cleared by the producer once it has
+    // signaled the eventfd.
+    std::atomic<uint32_t> consumerWaiting;
+};
+
+struct InputMessageRing::Slot {
+    std::atomic<uint32_t> size;
+    InputMessage message;
+};
+
+size_t InputMessageRing::getSlotsOffset() {
+    return (sizeof(Header) + alignof(Slot) - 1) / alignof(Slot) * alignof(Slot);
+}
+
+size_t InputMessageRing::getMemorySize(size_t capacity) {
+    const size_t size = getSlotsOffset() + capacity * sizeof(Slot);
+    const size_t pageSize = static_cast<size_t>(getpagesize());
+    return (size + pageSize - 1) / pageSize * pageSize;
+}
+
+Result<std::unique_ptr<InputMessageRing>> InputMessageRing::create(const std::string& name,
+                                                                   size_t capacity) {
+    if (capacity == 0 || capacity > MAX_RING_CAPACITY) {
+        return Error(BAD_VALUE) << "Invalid ring capacity " << capacity;
+    }
+    const size_t memorySize = getMemorySize(capacity);
+
+    unique_fd memoryFd(memfd_create(name.c_str(), MFD_CLOEXEC | MFD_ALLOW_SEALING));
+    if (!memoryFd.ok()) {
+        return ErrnoError() << "memfd_create failed for '" << name << "'";
+    }
+    if (ftruncate(memoryFd.get(), memorySize) == -1) {
+        return ErrnoError() << "ftruncate failed for '" << name << "'";
+    }
+    // The consumer must not be able to shrink the memory from under the producer.
+    if (fcntl(memoryFd.get(), F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) == -1) {
+        return ErrnoError() << "Failed to seal the ring memory for '" << name << "'";
+    }
+
+    unique_fd eventFd(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK));
+    if (!eventFd.ok()) {
+        return ErrnoError() << "eventfd failed for '" << name << "'";
+    }
+
+    void* memory =
+            mmap(nullptr, memorySize, PROT_READ | PROT_WRITE, MAP_SHARED, memoryFd.get(), 0);
+    if (memory == MAP_FAILED) {
+        return ErrnoError() << "mmap failed for '" << name << "'";
+    }
+
+    Header* header = new (memory) Header{};
+    header->magic = RING_MAGIC;
+    header->capacity = static_cast<uint32_t>(capacity);
+
+    return std::unique_ptr<InputMessageRing>(
+            new InputMessageRing(name, std::move(memoryFd), std::move(eventFd), memory, memorySize,
+                                 capacity));
+}
+
+Result<std::unique_ptr<InputMessageRing>> InputMessageRing::open(const std::string& name,
+                                                                 unique_fd memoryFd,
+                                                                 unique_fd eventFd) {
+    if (!memoryFd.ok() || !eventFd.ok()) {
+        return Error(BAD_VALUE) << "Invalid file descriptors for '" << name << "'";
+    }
+    struct stat memoryStat;
+    if (fstat(memoryFd.get(), &memoryStat) == -1) {
+        return ErrnoError() << "fstat failed for '" << name << "'";
+    }
+    const size_t memorySize = static_cast<size_t>(memoryStat.st_size);
+    if (memorySize < getMemorySize(1)) {
+        return Error(BAD_VALUE) << "Ring memory for '" << name << "' is too small";
+    }
+
+    void* memory =
+            mmap(nullptr, memorySize, PROT_READ | PROT_WRITE, MAP_SHARED, memoryFd.get(), 0);
+    if (memory == MAP_FAILED) {
+        return ErrnoError() << "mmap failed for '" << name << "'";
+    }
+
+    const Header* header = static_cast<const Header*>(memory);
+    const size_t capacity = header->capacity;
+    if (header->magic != RING_MAGIC || capacity == 0 || capacity > MAX_RING_CAPACITY ||
+        getMemorySize(capacity) > memorySize) {
+        munmap(memory, memorySize);
+        return Error(BAD_VALUE) << "Ring memory for '" << name << "' is not a valid ring";
+    }
+
+    auto ring = std::unique_ptr<InputMessageRing>(
+            new InputMessageRing(name, std::move(memoryFd), std::move(eventFd), memory, memorySize,
+                                 capacity));
+    ring->mLocalIndex = ring->header().readIndex.load(std::memory_order_acquire);
+    return ring;
+}
+
+InputMessageRing::InputMessageRing(std::string name, unique_fd memoryFd, unique_fd eventFd,
+                                   void* memory, size_t memorySize, size_t capacity)
+      : mName(std::move(name)),
+        mMemoryFd(std::move(memoryFd)),
+        mEventFd(std::move(eventFd)),
+        mMemory(memory),
+        mMemorySize(memorySize),
+        mCapacity(capacity) {}
+
+InputMessageRing::~InputMessageRing() {
+    munmap(mMemory, mMemorySize);
+}
+
+unique_fd InputMessageRing::dupMemoryFd() const {
+    return unique_fd(fcntl(mMemoryFd.get(), F_DUPFD_CLOEXEC, 0));
+}
+
+unique_fd InputMessageRing::dupEventFd() const {
+    return unique_fd(fcntl(mEventFd.get(), F_DUPFD_CLOEXEC, 0));
+}
+
+InputMessageRing::Header& InputMessageRing::header() const {
+    return *static_cast<Header*>(mMemory);
+}
+
+InputMessageRing::Slot& InputMessageRing::slotAt(uint64_t index) const {
+    Slot* slots = reinterpret_cast<Slot*>(static_cast<uint8_t*>(mMemory) + getSlotsOffset());
+    return slots[index % mCapacity];
+}
+
+status_t InputMessageRing::sendMessage(const InputMessage& msg) {
+    Header& ringHeader = header();
+    const uint64_t readIndex = ringHeader.readIndex.load(std::memory_order_acquire);
+    if (readIndex > mLocalIndex || mLocalIndex - readIndex > mCapacity) {
+        LOG(ERROR) << "Ring '" << mName << "' was corrupted by the consumer";
+        return DEAD_OBJECT;
+    }
+    if (mLocalIndex - readIndex == mCapacity) {
+        return WOULD_BLOCK;
+    }
+
+    Slot& slot = slotAt(mLocalIndex);
+    msg.getSanitizedCopy(&slot.message);
+    slot.size.store(static_cast<uint32_t>(msg.size()), std::memory_order_relaxed);
+    mLocalIndex++;
+    ringHeader.writeIndex.store(mLocalIndex, std::memory_order_seq_cst);
+
+    // Pairs with the consumer setting consumerWaiting before checking writeIndex again, so that
+    // one of the two sides always observes the other.
+    if (ringHeader.consumerWaiting.exchange(0, std::memory_order_seq_cst) != 0) {
+        signalEventFd(mEventFd.get());
+    }
+    return OK;
+}
+
+Result<InputMessage> InputMessageRing::receiveMessage() {
+    Header& ringHeader = header();
+    uint64_t writeIndex = ringHeader.writeIndex.load(std::memory_order_acquire);
+    if (writeIndex == mLocalIndex) {
+        drainEventFd(mEventFd.get());
+        ringHeader.consumerWaiting.store(1, std::memory_order_seq_cst);
+        writeIndex = ringHeader.writeIndex.load(std::memory_order_seq_cst);
+        if (writeIndex == mLocalIndex) {
+            return Error(WOULD_BLOCK);
+        }
+    }
+    if (writeIndex < mLocalIndex || writeIndex - mLocalIndex > mCapacity) {
+        LOG(ERROR) << "Ring '" << mName << "' was corrupted by the producer";
+        return Error(DEAD_OBJECT);
+    }
+
+    // Copy the message out of shared memory before looking at it.
+    const Slot& slot = slotAt(mLocalIndex);
+    const size_t size = slot.size.load(std::memory_order_relaxed);
+    InputMessage msg;
+    memset(&msg, 0, sizeof(msg));
+    memcpy(&msg, &slot.message, std::min(size, sizeof(InputMessage)));
+    mLocalIndex++;
+    ringHeader.readIndex.store(mLocalIndex, std::memory_order_release);
+
+    if (size > sizeof(InputMessage) || !msg.isValid(size)) {
+        LOG(ERROR) << "Ring '" << mName << "' received invalid message of size " << size;
+        return Error(BAD_VALUE);
+    }
+    return msg;
+}
+
+} // namespace android
@@ -422,6 +422,69 @@ status_t InputChannel::sendMessage(const InputMessage* msg) {
     return OK;
 }
 
+status_t InputChannel::sendMessages(const InputMessage* msgs, size_t count,
+                                    size_t* outSentCount) {
+    *outSentCount = 0;
+    if (count == 1) {
+        const status_t status = sendMessage(msgs);
+        if (status == OK) {
+            *outSentCount = 1;
+        }
+        return status;
+    }
+    ATRACE_NAME_IF(ATRACE_ENABLED(),
+                   StringPrintf("sendMessages(inputChannel=%s, count=%zu)", name.c_str(), count));
+
+    std::vector<InputMessage> cleanMsgs(count);
+    std::vector<iovec> iovecs(count);
+    std::vector<mmsghdr> headers(count);
+    for (size_t i = 0; i < count; i++) {
+        msgs[i].getSanitizedCopy(&cleanMsgs[i]);
+        iovecs[i].iov_base = &cleanMsgs[i];
+        iovecs[i].iov_len = msgs[i].size();
+        headers[i] = {};
+        headers[i].msg_hdr.msg_iov = &iovecs[i];
+        headers[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    // sendmmsg stops early once the socket is full, so keep going until it reports the error.
+    while (*outSentCount < count) {
+        int nSent;
+        do {
+            nSent = ::sendmmsg(getFd(), headers.data() + *outSentCount, count - *outSentCount,
+                               MSG_DONTWAIT | MSG_NOSIGNAL);
+        } while (nSent == -1 && errno == EINTR);
+
+        if (nSent < 0) {
+            int error = errno;
+            ALOGD_IF(DEBUG_CHANNEL_MESSAGES,
+                     "channel '%s' ~ error sending message %zu of %zu, %s", name.c_str(),
+                     *outSentCount + 1, count, strerror(error));
+            if (error == EAGAIN || error == EWOULDBLOCK) {
+                return WOULD_BLOCK;
+            }
+            if (error == EPIPE || error == ENOTCONN || error == ECONNREFUSED ||
+                error == ECONNRESET) {
+                return DEAD_OBJECT;
+            }
+            return -error;
+        }
+
+        for (int i = 0; i < nSent; i++) {
+            if (headers[*outSentCount].msg_len != iovecs[*outSentCount].iov_len) {
+                ALOGD_IF(DEBUG_CHANNEL_MESSAGES,
+                         "channel '%s' ~ error sending message %zu of %zu, send was incomplete",
+                         name.c_str(), *outSentCount + 1, count);
+                return DEAD_OBJECT;
+            }
+            (*outSentCount)++;
+        }
+    }
+
+    ALOGD_IF(DEBUG_CHANNEL_MESSAGES, "channel '%s' ~ sent %zu messages", name.c_str(), count);
+    return OK;
+}
+
 android::base::Result<InputMessage> InputChannel::receiveMessage() {
     ssize_t nRead;
     InputMessage msg;
@@ -567,7 +630,7 @@ status_t InputPublisher::publishKeyEvent(uint32_t seq, int32_t eventId, int32_t
     msg.body.key.repeatCount = repeatCount;
     msg.body.key.downTime = downTime;
     msg.body.key.eventTime = eventTime;
-    return mChannel->sendMessage(&msg);
+    return sendOrQueueMessage(msg);
 }
 
 status_t InputPublisher::publishMotionEvent(
@@ -658,7 +721,7 @@ status_t InputPublisher::publishMotionEvent(
         msg.body.motion.pointers[i].coords = pointerCoords[i];
     }
 
-    return mChannel->sendMessage(&msg);
+    return sendOrQueueMessage(msg);
 }
 
 status_t InputPublisher::publishFocusEvent(uint32_t seq, int32_t eventId, bool hasFocus) {
@@ -673,7 +736,7 @@ status_t InputPublisher::publishFocusEvent(uint32_t seq, int32_t eventId, bool h
     msg.header.seq = seq;
     msg.body.focus.eventId = eventId;
     msg.body.focus.hasFocus = hasFocus;
-    return mChannel->sendMessage(&msg);
+    return sendOrQueueMessage(msg);
 }
 
 status_t InputPublisher::publishCaptureEvent(uint32_t seq, int32_t eventId,
@@ -690,7 +753,7 @@ status_t InputPublisher::publishCaptureEvent(uint32_t seq, int32_t eventId,
     msg.header.seq = seq;
     msg.body.capture.eventId = eventId;
     msg.body.capture.pointerCaptureEnabled = pointerCaptureEnabled;
-    return mChannel->sendMessage(&msg);
+    return sendOrQueueMessage(msg);
 }
 
 status_t InputPublisher::publishDragEvent(uint32_t seq, int32_t eventId, float x, float y,
@@ -709,7 +772,7 @@ status_t InputPublisher::publishDragEvent(uint32_t seq, int32_t eventId, float x
     msg.body.drag.isExiting = isExiting;
     msg.body.drag.x = x;
     msg.body.drag.y = y;
-    return mChannel->sendMessage(&msg);
+    return sendOrQueueMessage(msg);
 }
 
 status_t InputPublisher::publishTouchModeEvent(uint32_t seq, int32_t eventId, bool isInTouchMode) {
@@ -725,6 +788,33 @@ status_t InputPublisher::publishTouchModeEvent(uint32_t seq, int32_t eventId, bo
     msg.header.seq = seq;
     msg.body.touchMode.eventId = eventId;
     msg.body.touchMode.isInTouchMode = isInTouchMode;
+    return sendOrQueueMessage(msg);
+}
+
+void InputPublisher::beginBatch() {
+    LOG_IF(FATAL, mBatching) << "channel '" << mChannel->getName()
+                             << "' publisher ~ beginBatch called while a batch is open";
+    mBatching = true;
+}
+
+status_t InputPublisher::endBatch(size_t* outPublishedCount) {
+    LOG_IF(FATAL, !mBatching) << "channel '" << mChannel->getName()
+                              << "' publisher ~ endBatch called without beginBatch";
+    mBatching = false;
+    *outPublishedCount = 0;
+    if (mBatch.empty()) {
+        return OK;
+    }
+    const status_t status = mChannel->sendMessages(mBatch.data(), mBatch.size(), outPublishedCount);
+    mBatch.clear();
+    return status;
+}
+
+status_t InputPublisher::sendOrQueueMessage(const InputMessage& msg) {
+    if (mBatching) {
+        mBatch.push_back(msg);
+        return OK;
+    }
     return mChannel->sendMessage(&msg);
 }
 
@@ -16,9 +16,15 @@
 
 #define LOG_TAG "KeyCharacterMap"
 
+#include <errno.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include <mutex>
+#include <unordered_map>
+
+#include <android-base/file.h>
+#include <android-base/thread_annotations.h>
 #include <android/keycodes.h>
 #include <attestation/HmacKeyManager.h>
 #include <binder/Parcel.h>
@@ -79,6 +85,54 @@ static String8 toString(const char16_t* chars, size_t numChars) {
 }
 #endif
 
+namespace {
+
+/**
+ * The key character maps parsed from files, by file name, so that devices that share a key
+ * character map file don't parse it again, and so that changing the keyboard layout of a device
+ * doesn't parse its base map again. A map is only reused while the contents of its file are the
+ * same as when it was parsed.
+ *
+ * KeyCharacterMap can be modified by applying a layout overlay, so the cached maps are never
+ * handed out, only copied.
+ */
+class KeyCharacterMapCache {
+public:
+    std::shared_ptr<const KeyCharacterMap> find(const std::string& filename,
+                                                const std::string& contents,
+                                                KeyCharacterMap::Format format) {
+        std::scoped_lock lock(mLock);
+        const auto it = mMaps.find(filename);
+        if (it == mMaps.end() || it->second.format != format ||
+            it->second.contents != contents) {
+            return nullptr;
+        }
+        return it->second.map;
+    }
+
+    void insert(const std::string& filename, std::string contents, KeyCharacterMap::Format format,
+                std::shared_ptr<const KeyCharacterMap> map) {
+        std::scoped_lock lock(mLock);
+        mMaps.insert_or_assign(filename, Entry{std::move(contents), format, std::move(map)});
+    }
+
+private:
+    struct Entry {
+        std::string contents;
+        KeyCharacterMap::Format format;
+        std::shared_ptr<const KeyCharacterMap> map;
+    };
+
+    std::mutex mLock;
+    std::unordered_map<std::string, Entry> mMaps GUARDED_BY(mLock);
+};
+
+KeyCharacterMapCache& getKeyCharacterMapCache() {
+    static KeyCharacterMapCache* cache = new KeyCharacterMapCache();
+    return *cache;
+}
+
+} // namespace
 
 // --- KeyCharacterMap ---
 
@@ -86,23 +140,32 @@ KeyCharacterMap::KeyCharacterMap(const std::string& filename) : mLoadFileName(fi
 
 base::Result<std::shared_ptr<KeyCharacterMap>> KeyCharacterMap::load(const std::string& filename,
                                                                      Format format) {
-    Tokenizer* tokenizer;
-    status_t status = Tokenizer::open(String8(filename.c_str()), &tokenizer);
-    if (status) {
-        return Errorf("Error {} opening key character map file {}.", status, filename.c_str());
+    base::Result<std::shared_ptr<const KeyCharacterMap>> parsedMap = loadParsed(filename, format);
+    if (!parsedMap.ok()) {
+        return parsedMap.error();
     }
-    std::shared_ptr<KeyCharacterMap> map =
-            std::shared_ptr<KeyCharacterMap>(new KeyCharacterMap(filename));
-    if (!map.get()) {
-        ALOGE("Error allocating key character map.");
-        return Errorf("Error allocating key character map.");
+    return std::make_shared<KeyCharacterMap>(**parsedMap);
+}
+
+base::Result<std::shared_ptr<const KeyCharacterMap>> KeyCharacterMap::loadParsed(
+        const std::string& filename, Format format) {
+    std::string contents;
+    if (!base::ReadFileToString(filename, &contents)) {
+        const status_t status = -errno;
+        return Errorf("Error {} opening key character map file {}.", status, filename.c_str());
     }
-    std::unique_ptr<Tokenizer> t(tokenizer);
-    status = map->load(t.get(), format);
-    if (status == OK) {
+    KeyCharacterMapCache& cache = getKeyCharacterMapCache();
+    if (std::shared_ptr<const KeyCharacterMap> map = cache.find(filename, contents, format); map) {
         return map;
     }
-    return Errorf("Load KeyCharacterMap failed {}.", status);
+    base::Result<std::shared_ptr<KeyCharacterMap>> map =
+            loadContents(filename, contents.c_str(), format);
+    if (!map.ok()) {
+        return map.error();
+    }
+    std::shared_ptr<const KeyCharacterMap> parsedMap = std::move(*map);
+    cache.insert(filename, std::move(contents), format, parsedMap);
+    return parsedMap;
 }
 
 base::Result<std::shared_ptr<KeyCharacterMap>> KeyCharacterMap::loadContents(
@@ -155,15 +218,18 @@ void KeyCharacterMap::clear() {
 
 status_t KeyCharacterMap::reloadBaseFromFile() {
     clear();
-    Tokenizer* tokenizer;
-    status_t status = Tokenizer::open(String8(mLoadFileName.c_str()), &tokenizer);
-    if (status) {
-        ALOGE("Error %s opening key character map file %s.", statusToString(status).c_str(),
-              mLoadFileName.c_str());
-        return status;
+    base::Result<std::shared_ptr<const KeyCharacterMap>> baseMap =
+            loadParsed(mLoadFileName, KeyCharacterMap::Format::BASE);
+    if (!baseMap.ok()) {
+        ALOGE("Error reloading key character map file %s: %s", mLoadFileName.c_str(),
+              baseMap.error().message().c_str());
+        return BAD_VALUE;
     }
-    std::unique_ptr<Tokenizer> t(tokenizer);
-    return load(t.get(), KeyCharacterMap::Format::BASE);
+    mKeys = (*baseMap)->mKeys;
+    mType = (*baseMap)->mType;
+    mKeysByScanCode = (*baseMap)->mKeysByScanCode;
+    mKeysByUsageCode = (*baseMap)->mKeysByUsageCode;
+    return OK;
 }
 
 void KeyCharacterMap::combine(const KeyCharacterMap& overlay) {
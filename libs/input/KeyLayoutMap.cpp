@@ -16,7 +16,9 @@
 
 #define LOG_TAG "KeyLayoutMap"
 
+#include <android-base/file.h>
 #include <android-base/logging.h>
+#include <android-base/thread_annotations.h>
 #include <android/keycodes.h>
 #include <ftl/enum.h>
 #include <input/InputEventLabels.h>
@@ -30,7 +32,9 @@
 #include <vintf/KernelConfigs.h>
 #endif
 
+#include <cerrno>
 #include <cstdlib>
+#include <mutex>
 #include <string_view>
 #include <unordered_map>
 
@@ -125,6 +129,43 @@ bool kernelConfigsArePresent(const std::set<std::string>& configs) {
 #endif
 }
 
+/**
+ * The key layout maps parsed from files, by file name, so that devices that share a key layout
+ * file don't parse it again when they are connected. A map is only reused while the contents of
+ * its file are the same as when it was parsed.
+ */
+class KeyLayoutMapCache {
+public:
+    std::shared_ptr<KeyLayoutMap> find(const std::string& filename, const std::string& contents) {
+        std::scoped_lock lock(mLock);
+        const auto it = mMaps.find(filename);
+        if (it == mMaps.end() || it->second.contents != contents) {
+            return nullptr;
+        }
+        return it->second.map;
+    }
+
+    void insert(const std::string& filename, std::string contents,
+                std::shared_ptr<KeyLayoutMap> map) {
+        std::scoped_lock lock(mLock);
+        mMaps.insert_or_assign(filename, Entry{std::move(contents), std::move(map)});
+    }
+
+private:
+    struct Entry {
+        std::string contents;
+        std::shared_ptr<KeyLayoutMap> map;
+    };
+
+    std::mutex mLock;
+    std::unordered_map<std::string, Entry> mMaps GUARDED_BY(mLock);
+};
+
+KeyLayoutMapCache& getKeyLayoutMapCache() {
+    static KeyLayoutMapCache* cache = new KeyLayoutMapCache();
+    return *cache;
+}
+
 } // namespace
 
 KeyLayoutMap::KeyLayoutMap() = default;
@@ -137,13 +178,27 @@ base::Result<std::shared_ptr<KeyLayoutMap>> KeyLayoutMap::loadContents(const std
 
 base::Result<std::shared_ptr<KeyLayoutMap>> KeyLayoutMap::load(const std::string& filename,
                                                                const char* contents) {
-    Tokenizer* tokenizer;
-    status_t status;
     if (contents == nullptr) {
-        status = Tokenizer::open(String8(filename.c_str()), &tokenizer);
-    } else {
-        status = Tokenizer::fromContents(String8(filename.c_str()), contents, &tokenizer);
+        // KeyLayoutMap is immutable, so a map parsed from the same contents can be shared.
+        std::string fileContents;
+        if (!base::ReadFileToString(filename, &fileContents)) {
+            const status_t status = -errno;
+            ALOGE("Error %d opening key layout map file %s.", status, filename.c_str());
+            return Errorf("Error {} opening key layout map file {}.", status, filename.c_str());
+        }
+        KeyLayoutMapCache& cache = getKeyLayoutMapCache();
+        if (std::shared_ptr<KeyLayoutMap> map = cache.find(filename, fileContents); map) {
+            return map;
+        }
+        auto ret = load(filename, fileContents.c_str());
+        if (ret.ok()) {
+            cache.insert(filename, std::move(fileContents), *ret);
+        }
+        return ret;
     }
+
+    Tokenizer* tokenizer;
+    status_t status = Tokenizer::fromContents(String8(filename.c_str()), contents, &tokenizer);
     if (status) {
         ALOGE("Error %d opening key layout map file %s.", status, filename.c_str());
         return Errorf("Error {} opening key layout map file {}.", status, filename.c_str());
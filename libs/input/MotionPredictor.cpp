@@ -253,7 +253,10 @@ std::unique_ptr<MotionEvent> MotionPredictor::predict(nsecs_t timestamp) {
 
     LOG_ALWAYS_FATAL_IF(!mModel);
     mBuffers->copyTo(*mModel);
+    const nsecs_t inferenceStart = systemTime(SYSTEM_TIME_MONOTONIC);
     LOG_ALWAYS_FATAL_IF(!mModel->invoke());
+    LOG_ALWAYS_FATAL_IF(!mMetricsManager);
+    mMetricsManager->onInference(systemTime(SYSTEM_TIME_MONOTONIC) - inferenceStart);
 
     // Read out the predictions.
     const std::span<const float> predictedR = mModel->outputR();
@@ -33,6 +33,7 @@ namespace {
 
 inline constexpr int NANOS_PER_SECOND = 1'000'000'000; // nanoseconds per second
 inline constexpr int NANOS_PER_MILLIS = 1'000'000;     // nanoseconds per millisecond
+inline constexpr int NANOS_PER_MICROS = 1'000;         // nanoseconds per microsecond
 
 // Velocity threshold at which we report "high-velocity" metrics, in pixels per second.
 // This value was selected from manual experimentation, as a threshold that separates "fast"
@@ -48,6 +49,8 @@ inline constexpr float PATH_LENGTH_EPSILON = 0.001;
 void MotionPredictorMetricsManager::defaultReportAtomFunction(
         const MotionPredictorMetricsManager::AtomFields& atomFields) {
 #ifdef __ANDROID__
+    // The inference latency fields are not part of the atom yet, and are only available to custom
+    // report functions.
     android::libinput::stats_write(android::libinput::STYLUS_PREDICTION_METRICS_REPORTED,
                                    /*stylus_vendor_id=*/0,
                                    /*stylus_product_id=*/0,
@@ -133,11 +136,20 @@ void MotionPredictorMetricsManager::onPredict(const MotionEvent& predictionEvent
     std::sort(mRecentPredictions.begin(), mRecentPredictions.end());
 }
 
+void MotionPredictorMetricsManager::onInference(nsecs_t inferenceLatency) {
+    mInferenceLatencySum += inferenceLatency;
+    mInferenceLatencyMax = std::max(mInferenceLatencyMax, inferenceLatency);
+    ++mInferenceCount;
+}
+
 void MotionPredictorMetricsManager::clearStrokeData() {
     mRecentGroundTruthPoints.clear();
     mRecentPredictions.clear();
     std::fill(mAggregatedMetrics.begin(), mAggregatedMetrics.end(), AggregatedStrokeMetrics{});
     std::fill(mAtomFields.begin(), mAtomFields.end(), AtomFields{});
+    mInferenceLatencySum = 0;
+    mInferenceLatencyMax = 0;
+    mInferenceCount = 0;
 }
 
 void MotionPredictorMetricsManager::incorporateNewGroundTruth(
@@ -369,6 +381,17 @@ void MotionPredictorMetricsManager::computeAtomFields() {
                     static_cast<int>(averageOffTrajectoryRmse * 1000);
         }
     }
+
+    // Inference latency: reported for every time bucket.
+    if (mInferenceCount > 0) {
+        const int meanMicros =
+                static_cast<int>(mInferenceLatencySum / mInferenceCount / NANOS_PER_MICROS);
+        const int maxMicros = static_cast<int>(mInferenceLatencyMax / NANOS_PER_MICROS);
+        for (AtomFields& atomFields : mAtomFields) {
+            atomFields.inferenceLatencyMeanMicros = meanMicros;
+            atomFields.inferenceLatencyMaxMicros = maxMicros;
+        }
+    }
 }
 
 void MotionPredictorMetricsManager::reportMetrics() {
@@ -263,4 +263,227 @@ void LegacyResampler::resampleMotionEvent(nanoseconds frameTime, MotionEvent& mo
         addSampleToMotionEvent(*sample, motionEvent);
     }
 }
+
+namespace {
+
+constexpr std::chrono::nanoseconds LEAST_SQUARES_RESAMPLE_LATENCY{0};
+
+bool pointersResampleable(const std::vector<PointerProperties>& target,
+                          const std::vector<PointerProperties>& auxiliary) {
+    if (target.size() > auxiliary.size()) {
+        LOG_IF(INFO, debugResampling())
+                << "Not resampled. Auxiliary sample has fewer pointers than target sample.";
+        return false;
+    }
+    for (size_t i = 0; i < target.size(); ++i) {
+        if (target[i].id != auxiliary[i].id || target[i].toolType != auxiliary[i].toolType) {
+            LOG_IF(INFO, debugResampling()) << "Not resampled. Pointer properties mismatch.";
+            return false;
+        }
+        if (!canResampleTool(target[i].toolType)) {
+            LOG_IF(INFO, debugResampling()) << "Not resampled. Cannot resample "
+                                            << ftl::enum_string(target[i].toolType)
+                                            << " ToolType.";
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Fits value = c + b * time + a * time^2 to the samples with least squares, where the times are in
+ * milliseconds relative to the latest sample, and returns the displacement from the latest value
+ * that the fit predicts `prediction` milliseconds after the latest sample. The displacement is
+ * bounded between zero and the displacement at the fitted velocity b, and is zero if b goes against
+ * the direction of the two latest samples.
+ */
+double predictDisplacement(const std::vector<double>& times, const std::vector<double>& values,
+                           double prediction) {
+    const size_t count = times.size();
+    const double latestVelocity =
+            (values[count - 1] - values[count - 2]) / (times[count - 1] - times[count - 2]);
+    // Same as a linear extrapolation from the two latest samples, if there is no better fit.
+    double velocity = latestVelocity;
+    double curvature = 0;
+    if (count >= 3) {
+        double sx = 0, sx2 = 0, sx3 = 0, sx4 = 0, sy = 0, sxy = 0, sx2y = 0;
+        for (size_t i = 0; i < count; ++i) {
+            const double x = times[i];
+            const double y = values[i];
+            sx += x;
+            sx2 += x * x;
+            sx3 += x * x * x;
+            sx4 += x * x * x * x;
+            sy += y;
+            sxy += x * y;
+            sx2y += x * x * y;
+        }
+        const double Sxx = sx2 - sx * sx / count;
+        const double Sxy = sxy - sx * sy / count;
+        const double Sxx2 = sx3 - sx * sx2 / count;
+        const double Sx2y = sx2y - sx2 * sy / count;
+        const double Sx2x2 = sx4 - sx2 * sx2 / count;
+        const double denominator = Sxx * Sx2x2 - Sxx2 * Sxx2;
+        if (denominator != 0) {
+            velocity = (Sxy * Sx2x2 - Sx2y * Sxx2) / denominator;
+            curvature = (Sx2y * Sxx - Sxy * Sxx2) / denominator;
+        }
+    }
+
+    if (velocity * latestVelocity <= 0) {
+        return 0;
+    }
+    const double linear = velocity * prediction;
+    const double fitted = linear + curvature * prediction * prediction;
+    return (linear >= 0) ? std::clamp(fitted, 0.0, linear) : std::clamp(fitted, linear, 0.0);
+}
+
+} // namespace
+
+void LeastSquaresResampler::updateLatestSamples(const MotionEvent& motionEvent) {
+    const size_t numSamples = motionEvent.getHistorySize() + 1;
+    const size_t numPointers = motionEvent.getPointerCount();
+    const size_t firstSampleIndex =
+            numSamples > mLatestSamples.capacity() ? numSamples - mLatestSamples.capacity() : 0;
+    std::vector<PointerProperties> properties;
+    for (size_t pointerIndex = 0; pointerIndex < numPointers; ++pointerIndex) {
+        properties.push_back(*motionEvent.getPointerProperties(pointerIndex));
+    }
+    for (size_t sampleIndex = firstSampleIndex; sampleIndex < numSamples; ++sampleIndex) {
+        const PointerCoords* sampleCoords =
+                &motionEvent.getSamplePointerCoords()[sampleIndex * numPointers];
+        mLatestSamples.pushBack(
+                Sample{nanoseconds{motionEvent.getHistoricalEventTime(sampleIndex)}, properties,
+                       std::vector<PointerCoords>(sampleCoords, sampleCoords + numPointers)});
+    }
+}
+
+size_t LeastSquaresResampler::countFittableSamples() const {
+    if (mLatestSamples.empty()) {
+        return 0;
+    }
+    const Sample& latestSample = mLatestSamples.back();
+    if (!pointersResampleable(latestSample.properties, latestSample.properties)) {
+        return 0;
+    }
+    size_t count = 1;
+    for (size_t i = mLatestSamples.size() - 1; i > 0; --i) {
+        const Sample& olderSample = mLatestSamples[i - 1];
+        const nanoseconds delta = mLatestSamples[i].eventTime - olderSample.eventTime;
+        if (delta < RESAMPLE_MIN_DELTA || delta > RESAMPLE_MAX_DELTA ||
+            !pointersResampleable(latestSample.properties, olderSample.properties)) {
+            break;
+        }
+        ++count;
+    }
+    return count;
+}
+
+std::optional<LeastSquaresResampler::Sample> LeastSquaresResampler::attemptInterpolation(
+        nanoseconds resampleTime, const InputMessage& futureSample) const {
+    if (mLatestSamples.empty()) {
+        return std::nullopt;
+    }
+    const Sample& pastSample = mLatestSamples.back();
+
+    std::vector<PointerProperties> futureProperties;
+    for (uint32_t i = 0; i < futureSample.body.motion.pointerCount; ++i) {
+        futureProperties.push_back(futureSample.body.motion.pointers[i].properties);
+    }
+    if (!pointersResampleable(pastSample.properties, futureProperties)) {
+        return std::nullopt;
+    }
+
+    const nanoseconds futureTime{futureSample.body.motion.eventTime};
+    const nanoseconds delta = futureTime - pastSample.eventTime;
+    if (delta < RESAMPLE_MIN_DELTA) {
+        LOG_IF(INFO, debugResampling()) << "Not resampled. Delta is too small: " << delta << "ns.";
+        return std::nullopt;
+    }
+    if (resampleTime <= pastSample.eventTime || resampleTime >= futureTime) {
+        return std::nullopt;
+    }
+
+    const float alpha =
+            std::chrono::duration<float, std::milli>(resampleTime - pastSample.eventTime) / delta;
+    Sample resampledSample{resampleTime, pastSample.properties, {}};
+    for (size_t i = 0; i < pastSample.coords.size(); ++i) {
+        resampledSample.coords.push_back(
+                calculateResampledCoords(pastSample.coords[i],
+                                         futureSample.body.motion.pointers[i].coords, alpha));
+    }
+    return resampledSample;
+}
+
+std::optional<LeastSquaresResampler::Sample> LeastSquaresResampler::attemptExtrapolation(
+        nanoseconds resampleTime) const {
+    const size_t count = countFittableSamples();
+    if (count < 2) {
+        LOG_IF(INFO, debugResampling()) << "Not resampled. Not enough data.";
+        return std::nullopt;
+    }
+    const size_t size = mLatestSamples.size();
+    const Sample& latestSample = mLatestSamples[size - 1];
+    const nanoseconds delta = latestSample.eventTime - mLatestSamples[size - 2].eventTime;
+
+    // Predict at most one sample interval ahead, since the fit says nothing about what comes after.
+    const nanoseconds farthestPrediction =
+            latestSample.eventTime + std::min<nanoseconds>(delta, RESAMPLE_MAX_PREDICTION);
+    const nanoseconds newResampleTime = std::min(resampleTime, farthestPrediction);
+    if (newResampleTime <= latestSample.eventTime) {
+        return std::nullopt;
+    }
+    const double prediction =
+            std::chrono::duration<double, std::milli>(newResampleTime - latestSample.eventTime)
+                    .count();
+
+    std::vector<double> times;
+    for (size_t i = size - count; i < size; ++i) {
+        times.push_back(std::chrono::duration<double, std::milli>(mLatestSamples[i].eventTime -
+                                                                  latestSample.eventTime)
+                                .count());
+    }
+
+    Sample resampledSample{newResampleTime, latestSample.properties, latestSample.coords};
+    std::vector<double> xs(count);
+    std::vector<double> ys(count);
+    for (size_t pointerIndex = 0; pointerIndex < latestSample.coords.size(); ++pointerIndex) {
+        for (size_t i = 0; i < count; ++i) {
+            const PointerCoords& coords = mLatestSamples[size - count + i].coords[pointerIndex];
+            xs[i] = coords.getX();
+            ys[i] = coords.getY();
+        }
+        PointerCoords& resampledCoords = resampledSample.coords[pointerIndex];
+        resampledCoords.isResampled = true;
+        resampledCoords.setAxisValue(AMOTION_EVENT_AXIS_X,
+                                     xs.back() + predictDisplacement(times, xs, prediction));
+        resampledCoords.setAxisValue(AMOTION_EVENT_AXIS_Y,
+                                     ys.back() + predictDisplacement(times, ys, prediction));
+    }
+    return resampledSample;
+}
+
+nanoseconds LeastSquaresResampler::getResampleLatency() const {
+    return LEAST_SQUARES_RESAMPLE_LATENCY;
+}
+
+void LeastSquaresResampler::resampleMotionEvent(nanoseconds frameTime, MotionEvent& motionEvent,
+                                                const InputMessage* futureSample) {
+    if (mPreviousDeviceId && *mPreviousDeviceId != motionEvent.getDeviceId()) {
+        mLatestSamples.clear();
+    }
+    mPreviousDeviceId = motionEvent.getDeviceId();
+
+    const nanoseconds resampleTime = frameTime - LEAST_SQUARES_RESAMPLE_LATENCY;
+
+    updateLatestSamples(motionEvent);
+
+    const std::optional<Sample> sample = (futureSample != nullptr)
+            ? (attemptInterpolation(resampleTime, *futureSample))
+            : (attemptExtrapolation(resampleTime));
+    if (sample.has_value()) {
+        motionEvent.addSample(sample->eventTime.count(), sample->coords.data(),
+                              motionEvent.getId());
+    }
+}
 } // namespace android
@@ -303,6 +303,11 @@ TfLiteMotionPredictorModel::TfLiteMotionPredictorModel(
 
     auto resolver = createOpResolver();
     tflite::InterpreterBuilder builder(*mModel, *resolver);
+    // Predictions are made on the app's UI thread, and the model is too small for the gains of
+    // spreading an inference across threads to outweigh the cost of waking them up.
+    if (builder.SetNumThreads(1) != kTfLiteOk) {
+        LOG_ALWAYS_FATAL("Failed to set the number of interpreter threads");
+    }
 
     if (builder(&mInterpreter) != kTfLiteOk || !mInterpreter) {
         LOG_ALWAYS_FATAL("Failed to build interpreter");
@@ -17,6 +17,7 @@
 #define LOG_TAG "VelocityTracker"
 
 #include <android-base/logging.h>
+#include <com_android_input_flags.h>
 #include <ftl/enum.h>
 #include <inttypes.h>
 #include <limits.h>
@@ -31,6 +32,8 @@
 
 using std::literals::chrono_literals::operator""ms;
 
+namespace input_flags = com::android::input::flags;
+
 namespace android {
 
 /**
@@ -176,6 +179,9 @@ std::unique_ptr<VelocityTrackerStrategy> VelocityTracker::createStrategy(
 
         case VelocityTracker::Strategy::LSQ2:
             ALOGI_IF(DEBUG_STRATEGY && !DEBUG_IMPULSE, "Initializing lsq2 strategy");
+            if (input_flags::incremental_lsq2_velocity_tracker()) {
+                return std::make_unique<IncrementalLeastSquaresVelocityTrackerStrategy>();
+            }
             return std::make_unique<LeastSquaresVelocityTrackerStrategy>(2);
 
         case VelocityTracker::Strategy::LSQ3:
@@ -756,6 +762,126 @@ float LeastSquaresVelocityTrackerStrategy::chooseWeight(int32_t pointerId, uint3
     }
 }
 
+// --- IncrementalLeastSquaresVelocityTrackerStrategy ---
+
+IncrementalLeastSquaresVelocityTrackerStrategy::IncrementalLeastSquaresVelocityTrackerStrategy() {}
+
+IncrementalLeastSquaresVelocityTrackerStrategy::~IncrementalLeastSquaresVelocityTrackerStrategy() {}
+
+void IncrementalLeastSquaresVelocityTrackerStrategy::clearPointer(int32_t pointerId) {
+    mPointerStates.erase(pointerId);
+}
+
+void IncrementalLeastSquaresVelocityTrackerStrategy::accumulate(PointerState& state,
+                                                                const Movement& movement,
+                                                                double sign) {
+    const double x = (movement.eventTime - state.originTime) * 1E-9;
+    const double y = movement.position;
+    const double x2 = x * x;
+
+    Sums& sums = state.sums;
+    sums.sx += sign * x;
+    sums.sx2 += sign * x2;
+    sums.sx3 += sign * x2 * x;
+    sums.sx4 += sign * x2 * x2;
+    sums.sy += sign * y;
+    sums.sxy += sign * x * y;
+    sums.sx2y += sign * x2 * y;
+}
+
+void IncrementalLeastSquaresVelocityTrackerStrategy::rebase(PointerState& state) {
+    state.originTime = state.movements.back().eventTime;
+    state.sums = {};
+    for (const Movement& movement : state.movements) {
+        accumulate(state, movement, 1);
+    }
+}
+
+void IncrementalLeastSquaresVelocityTrackerStrategy::addMovement(nsecs_t eventTime,
+                                                                 int32_t pointerId,
+                                                                 float position) {
+    PointerState& state = mPointerStates[pointerId];
+    RingBuffer<Movement>& movements = state.movements;
+
+    // Same handling of movements with identical event times as in
+    // AccumulatingVelocityTrackerStrategy::addMovement.
+    if (!movements.empty() && movements.back().eventTime == eventTime) {
+        accumulate(state, movements.back(), -1);
+        movements.popBack();
+    }
+    if (movements.empty()) {
+        state.originTime = eventTime;
+        state.sums = {};
+    } else if (movements.size() == movements.capacity()) {
+        // The oldest movement is about to be overwritten.
+        accumulate(state, movements.front(), -1);
+    }
+
+    movements.pushBack({eventTime, position});
+    accumulate(state, movements.back(), 1);
+
+    while (eventTime - movements.front().eventTime > HORIZON) {
+        accumulate(state, movements.front(), -1);
+        movements.popFront();
+    }
+
+    if (eventTime - state.originTime > HORIZON) {
+        rebase(state);
+    }
+}
+
+std::optional<float> IncrementalLeastSquaresVelocityTrackerStrategy::getVelocity(
+        int32_t pointerId) const {
+    const auto stateIt = mPointerStates.find(pointerId);
+    if (stateIt == mPointerStates.end()) {
+        return std::nullopt; // no data
+    }
+    const PointerState& state = stateIt->second;
+    const size_t size = state.movements.size();
+    if (size < 2) {
+        return std::nullopt; // not enough data for a fit of degree 1
+    }
+
+    // Move the origin of the sums to the latest movement, which is where the velocity is
+    // evaluated. Solving y = a*x^2 + b*x + c around that origin gives the velocity as b.
+    const double n = size;
+    const double d = (state.movements.back().eventTime - state.originTime) * 1E-9;
+    const double d2 = d * d;
+    const Sums& sums = state.sums;
+    const double sxi = sums.sx - n * d;
+    const double sxi2 = sums.sx2 - 2 * d * sums.sx + n * d2;
+    const double sxi3 = sums.sx3 - 3 * d * sums.sx2 + 3 * d2 * sums.sx - n * d2 * d;
+    const double sxi4 = sums.sx4 - 4 * d * sums.sx3 + 6 * d2 * sums.sx2 - 4 * d2 * d * sums.sx +
+            n * d2 * d2;
+    const double syi = sums.sy;
+    const double sxiyi = sums.sxy - d * sums.sy;
+    const double sxi2yi = sums.sx2y - 2 * d * sums.sxy + d2 * sums.sy;
+
+    const double Sxx = sxi2 - sxi * sxi / n;
+    const double Sxy = sxiyi - sxi * syi / n;
+
+    if (size == 2) {
+        // LeastSquaresVelocityTrackerStrategy falls back to a fit of degree 1, whose QR
+        // decomposition has no solution when the times of the movements are too close.
+        if (Sxx <= 0 || sqrt(Sxx) < 0.000001) {
+            return std::nullopt;
+        }
+        return Sxy / Sxx;
+    }
+
+    const double Sxx2 = sxi3 - sxi * sxi2 / n;
+    const double Sx2y = sxi2yi - sxi2 * syi / n;
+    const double Sx2x2 = sxi4 - sxi2 * sxi2 / n;
+
+    const double denominator = Sxx * Sx2x2 - Sxx2 * Sxx2;
+    if (denominator == 0) {
+        ALOGW("division by 0 when computing velocity, Sxx=%f, Sx2x2=%f, Sxx2=%f", Sxx, Sx2x2, Sxx2);
+        return std::nullopt;
+    }
+
+    return (Sxy * Sx2x2 - Sx2y * Sxx2) / denominator;
+}
+
 // --- IntegratingVelocityTrackerStrategy ---
 
 IntegratingVelocityTrackerStrategy::IntegratingVelocityTrackerStrategy(uint32_t degree) :
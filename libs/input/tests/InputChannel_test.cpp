@@ -193,6 +193,54 @@ TEST_F(InputChannelTest, SendSignal_WhenPeerClosed_ReturnsAnError) {
             << "sendMessage should have returned DEAD_OBJECT";
 }
 
+TEST_F(InputChannelTest, SendMessages_DeliversEachMessageInOrder) {
+    std::unique_ptr<InputChannel> serverChannel, clientChannel;
+    status_t result = InputChannel::openInputChannelPair("channel name",
+            serverChannel, clientChannel);
+    ASSERT_EQ(OK, result)
+            << "should have successfully opened a channel pair";
+
+    std::array<InputMessage, 3> serverMsgs = {};
+    for (size_t i = 0; i < serverMsgs.size(); i++) {
+        serverMsgs[i].header.type = InputMessage::Type::FOCUS;
+        serverMsgs[i].header.seq = i + 1;
+        serverMsgs[i].body.focus.hasFocus = i % 2 == 0;
+    }
+
+    size_t sentCount = 0;
+    EXPECT_EQ(OK, serverChannel->sendMessages(serverMsgs.data(), serverMsgs.size(), &sentCount));
+    EXPECT_EQ(serverMsgs.size(), sentCount);
+
+    for (const InputMessage& serverMsg : serverMsgs) {
+        android::base::Result<InputMessage> clientMsgResult = clientChannel->receiveMessage();
+        ASSERT_TRUE(clientMsgResult.ok())
+                << "client channel should receive every message sent by the server channel";
+        EXPECT_EQ(serverMsg.header.type, clientMsgResult->header.type);
+        EXPECT_EQ(serverMsg.header.seq, clientMsgResult->header.seq);
+        EXPECT_EQ(serverMsg.body.focus.hasFocus, clientMsgResult->body.focus.hasFocus);
+    }
+    EXPECT_FALSE(clientChannel->receiveMessage().ok())
+            << "messages should not have been coalesced or duplicated";
+}
+
+TEST_F(InputChannelTest, SendMessages_WhenPeerClosed_ReturnsAnError) {
+    std::unique_ptr<InputChannel> serverChannel, clientChannel;
+    status_t result = InputChannel::openInputChannelPair("channel name",
+            serverChannel, clientChannel);
+    ASSERT_EQ(OK, result)
+            << "should have successfully opened a channel pair";
+
+    clientChannel.reset(); // close client channel
+
+    std::array<InputMessage, 2> msgs = {};
+    msgs[0].header.type = InputMessage::Type::FOCUS;
+    msgs[1].header.type = InputMessage::Type::FOCUS;
+    size_t sentCount = 1;
+    EXPECT_EQ(DEAD_OBJECT, serverChannel->sendMessages(msgs.data(), msgs.size(), &sentCount))
+            << "sendMessages should have returned DEAD_OBJECT";
+    EXPECT_EQ(0u, sentCount);
+}
+
 TEST_F(InputChannelTest, SendAndReceive_MotionClassification) {
     std::unique_ptr<InputChannel> serverChannel, clientChannel;
     status_t result = InputChannel::openInputChannelPair("channel name",
@@ -224,4 +224,68 @@ TEST(InputDeviceKeyLayoutTest, LoadsWhenRequiredKernelConfigIsPresent) {
     ASSERT_NE(nullptr, map) << "Map should be valid because CONFIG_UHID should always be present";
 }
 
+TEST(InputDeviceKeyLayoutTest, LoadingAnUnchangedFileReusesTheParsedMap) {
+    base::TemporaryFile klFile;
+    ASSERT_TRUE(base::WriteStringToFile("key 1 ESCAPE\n", klFile.path));
+
+    base::Result<std::shared_ptr<KeyLayoutMap>> first = KeyLayoutMap::load(klFile.path);
+    ASSERT_TRUE(first.ok()) << first.error().message();
+    base::Result<std::shared_ptr<KeyLayoutMap>> second = KeyLayoutMap::load(klFile.path);
+    ASSERT_TRUE(second.ok()) << second.error().message();
+    ASSERT_EQ(*first, *second);
+}
+
+TEST(InputDeviceKeyLayoutTest, LoadingAChangedFileParsesItAgain) {
+    base::TemporaryFile klFile;
+    ASSERT_TRUE(base::WriteStringToFile("key 1 ESCAPE\n", klFile.path));
+    base::Result<std::shared_ptr<KeyLayoutMap>> ret = KeyLayoutMap::load(klFile.path);
+    ASSERT_TRUE(ret.ok()) << ret.error().message();
+
+    ASSERT_TRUE(base::WriteStringToFile("key 1 BACK\n", klFile.path));
+    ret = KeyLayoutMap::load(klFile.path);
+    ASSERT_TRUE(ret.ok()) << ret.error().message();
+
+    int32_t keyCode;
+    uint32_t flags;
+    ASSERT_EQ(OK, (*ret)->mapKey(/*scanCode=*/1, /*usageCode=*/0, &keyCode, &flags));
+    ASSERT_EQ(AKEYCODE_BACK, keyCode);
+}
+
+TEST(InputDeviceKeyCharacterMapTest, MapsLoadedFromTheSameFileAreIndependent) {
+    base::TemporaryFile kcmFile;
+    ASSERT_TRUE(base::WriteStringToFile("type FULL\n"
+                                        "key A {\n"
+                                        "    label: 'A'\n"
+                                        "    base: 'a'\n"
+                                        "}\n",
+                                        kcmFile.path));
+    base::TemporaryFile overlayFile;
+    ASSERT_TRUE(base::WriteStringToFile("type OVERLAY\n"
+                                        "key A {\n"
+                                        "    label: 'Q'\n"
+                                        "    base: 'q'\n"
+                                        "}\n",
+                                        overlayFile.path));
+
+    base::Result<std::shared_ptr<KeyCharacterMap>> first =
+            KeyCharacterMap::load(kcmFile.path, KeyCharacterMap::Format::BASE);
+    ASSERT_TRUE(first.ok()) << first.error().message();
+    base::Result<std::shared_ptr<KeyCharacterMap>> overlay =
+            KeyCharacterMap::load(overlayFile.path, KeyCharacterMap::Format::OVERLAY);
+    ASSERT_TRUE(overlay.ok()) << overlay.error().message();
+    (*first)->combine(**overlay);
+    ASSERT_EQ(u'Q', (*first)->getDisplayLabel(AKEYCODE_A));
+
+    base::Result<std::shared_ptr<KeyCharacterMap>> second =
+            KeyCharacterMap::load(kcmFile.path, KeyCharacterMap::Format::BASE);
+    ASSERT_TRUE(second.ok()) << second.error().message();
+    ASSERT_NE(*first, *second);
+    ASSERT_EQ(u'A', (*second)->getDisplayLabel(AKEYCODE_A));
+
+    // Removing the overlay restores the base map from the file.
+    (*first)->clearLayoutOverlay();
+    ASSERT_EQ(u'A', (*first)->getDisplayLabel(AKEYCODE_A));
+    ASSERT_EQ(**first, **second);
+}
+
 } // namespace android
@@ -0,0 +1,136 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <poll.h>
+
+#include <gtest/gtest.h>
+#include <input/InputMessageRing.h>
+
+namespace android {
+
+namespace {
+
+InputMessage createFocusMessage(uint32_t seq) {
+    InputMessage msg = {};
+    msg.header.type = InputMessage::Type::FOCUS;
+    msg.header.seq = seq;
+    msg.body.focus.eventId = static_cast<int32_t>(seq);
+    msg.body.focus.hasFocus = true;
+    return msg;
+}
+
+bool isReadable(int fd) {
+    struct pollfd pfd = {.fd = fd, .events = POLLIN};
+    return poll(&pfd, 1, /*timeout=*/0) == 1;
+}
+
+} // namespace
+
+class InputMessageRingTest : public testing::Test {
+protected:
+    static constexpr size_t CAPACITY = 4;
+
+    void SetUp() override {
+        auto producer = InputMessageRing::create("ring name", CAPACITY);
+        ASSERT_TRUE(producer.ok()) << producer.error();
+        mProducer = std::move(*producer);
+
+        auto consumer = InputMessageRing::open("ring name", mProducer->dupMemoryFd(),
+                                               mProducer->dupEventFd());
+        ASSERT_TRUE(consumer.ok()) << consumer.error();
+        mConsumer = std::move(*consumer);
+    }
+
+    std::unique_ptr<InputMessageRing> mProducer;
+    std::unique_ptr<InputMessageRing> mConsumer;
+};
+
+TEST_F(InputMessageRingTest, ConsumerReceivesMessagesInOrder) {
+    ASSERT_EQ(CAPACITY, mConsumer->getCapacity());
+    for (uint32_t seq = 1; seq <= 3; seq++) {
+        ASSERT_EQ(OK, mProducer->sendMessage(createFocusMessage(seq)));
+    }
+
+    for (uint32_t seq = 1; seq <= 3; seq++) {
+        auto msg = mConsumer->receiveMessage();
+        ASSERT_TRUE(msg.ok()) << msg.error();
+        EXPECT_EQ(InputMessage::Type::FOCUS, msg->header.type);
+        EXPECT_EQ(seq, msg->header.seq);
+        EXPECT_TRUE(msg->body.focus.hasFocus);
+    }
+
+    auto msg = mConsumer->receiveMessage();
+    ASSERT_FALSE(msg.ok());
+    EXPECT_EQ(WOULD_BLOCK, msg.error().code());
+}
+
+TEST_F(InputMessageRingTest, SendMessage_WhenRingIsFull_ReturnsWouldBlock) {
+    for (uint32_t seq = 1; seq <= CAPACITY; seq++) {
+        ASSERT_EQ(OK, mProducer->sendMessage(createFocusMessage(seq)));
+    }
+    EXPECT_EQ(WOULD_BLOCK, mProducer->sendMessage(createFocusMessage(CAPACITY + 1)));
+
+    // Consuming a message makes room for another one, and the ring wraps around.
+    ASSERT_TRUE(mConsumer->receiveMessage().ok());
+    EXPECT_EQ(OK, mProducer->sendMessage(createFocusMessage(CAPACITY + 1)));
+    for (uint32_t seq = 2; seq <= CAPACITY + 1; seq++) {
+        auto msg = mConsumer->receiveMessage();
+        ASSERT_TRUE(msg.ok()) << msg.error();
+        EXPECT_EQ(seq, msg->header.seq);
+    }
+}
+
+TEST_F(InputMessageRingTest, EventFdIsOnlySignaledAfterConsumerFoundTheRingEmpty) {
+    ASSERT_EQ(OK, mProducer->sendMessage(createFocusMessage(1)));
+    EXPECT_FALSE(isReadable(mConsumer->getEventFd()))
+            << "the consumer has not waited on the ring yet";
+
+    ASSERT_TRUE(mConsumer->receiveMessage().ok());
+    ASSERT_FALSE(mConsumer->receiveMessage().ok());
+
+    ASSERT_EQ(OK, mProducer->sendMessage(createFocusMessage(2)));
+    EXPECT_TRUE(isReadable(mConsumer->getEventFd()));
+    ASSERT_EQ(OK, mProducer->sendMessage(createFocusMessage(3)));
+
+    ASSERT_TRUE(mConsumer->receiveMessage().ok());
+    ASSERT_TRUE(mConsumer->receiveMessage().ok());
+    ASSERT_FALSE(mConsumer->receiveMessage().ok());
+    EXPECT_FALSE(isReadable(mConsumer->getEventFd()))
+            << "the eventfd should be drained once the ring is empty";
+}
+
+TEST_F(InputMessageRingTest, ReceiveMessage_WhenMessageIsInvalid_ReturnsBadValue) {
+    InputMessage msg = {};
+    msg.header.type = InputMessage::Type::MOTION;
+    msg.header.seq = 1;
+    msg.body.motion.pointerCount = 0;
+    ASSERT_EQ(OK, mProducer->sendMessage(msg));
+
+    auto result = mConsumer->receiveMessage();
+    ASSERT_FALSE(result.ok());
+    EXPECT_EQ(BAD_VALUE, result.error().code());
+}
+
+TEST_F(InputMessageRingTest, Create_WithInvalidCapacity_Fails) {
+    EXPECT_FALSE(InputMessageRing::create("ring name", 0).ok());
+    EXPECT_FALSE(InputMessageRing::create("ring name", 1 << 20).ok());
+}
+
+TEST_F(InputMessageRingTest, Open_WithInvalidFds_Fails) {
+    EXPECT_FALSE(InputMessageRing::open("ring name", base::unique_fd(), base::unique_fd()).ok());
+}
+
+} // namespace android
@@ -698,4 +698,42 @@ TEST_F(InputPublisherAndConsumerTest, PublishMultipleEvents_EndToEnd) {
     ASSERT_NO_FATAL_FAILURE(publishAndConsumeTouchModeEvent());
 }
 
+TEST_F(InputPublisherAndConsumerTest, PublishBatch_WritesEventsOnEndBatch) {
+    mPublisher->beginBatch();
+    ASSERT_EQ(OK, mPublisher->publishFocusEvent(/*seq=*/1, InputEvent::nextId(), /*hasFocus=*/true));
+    ASSERT_EQ(OK, mPublisher->publishTouchModeEvent(/*seq=*/2, InputEvent::nextId(),
+                                                    /*isInTouchMode=*/true));
+    ASSERT_EQ(OK,
+              mPublisher->publishFocusEvent(/*seq=*/3, InputEvent::nextId(), /*hasFocus=*/false));
+    ASSERT_FALSE(mConsumer->probablyHasInput())
+            << "events should not be written before the batch ends";
+
+    size_t publishedCount = 0;
+    ASSERT_EQ(OK, mPublisher->endBatch(&publishedCount));
+    ASSERT_EQ(3u, publishedCount);
+
+    for (uint32_t expectedSeq = 1; expectedSeq <= 3; expectedSeq++) {
+        uint32_t consumeSeq;
+        InputEvent* event;
+        ASSERT_EQ(OK,
+                  mConsumer->consume(&mEventFactory, /*consumeBatches=*/true, -1, &consumeSeq,
+                                     &event));
+        EXPECT_EQ(expectedSeq, consumeSeq);
+    }
+}
+
+TEST_F(InputPublisherAndConsumerTest, PublishBatch_WhenSequenceNumberIsZero_ReturnsError) {
+    mPublisher->beginBatch();
+    EXPECT_EQ(BAD_VALUE,
+              mPublisher->publishKeyEvent(/*seq=*/0, InputEvent::nextId(), /*deviceId=*/1,
+                                          AINPUT_SOURCE_KEYBOARD, ui::LogicalDisplayId::DEFAULT,
+                                          INVALID_HMAC, AKEY_EVENT_ACTION_DOWN, /*flags=*/0,
+                                          AKEYCODE_ENTER, /*scanCode=*/13, AMETA_NONE,
+                                          /*repeatCount=*/0, /*downTime=*/0, /*eventTime=*/0));
+
+    size_t publishedCount = 1;
+    EXPECT_EQ(OK, mPublisher->endBatch(&publishedCount));
+    EXPECT_EQ(0u, publishedCount);
+}
+
 } // namespace android
@@ -1005,5 +1005,33 @@ TEST(MotionPredictorMetricsManagerTest, MismatchedInputAndPredictionInterval) {
     runMetricsManager(groundTruthPoints, predictionPoints, reportedAtomFields);
 }
 
+TEST(MotionPredictorMetricsManagerTest, InferenceLatencyIsReportedForEveryTimeBucket) {
+    const GroundTruthPoint groundTruthPoint{{.position = Eigen::Vector2f(10.0f, 20.0f),
+                                             .pressure = 0.5f},
+                                            .timestamp = TEST_INITIAL_TIMESTAMP};
+    const std::vector<GroundTruthPoint> groundTruthPoints =
+            generateConstantGroundTruthPoints(groundTruthPoint, /*numPoints=*/3);
+    const std::vector<nsecs_t> inferenceLatencies = {1'000'000, 2'000'000, 6'000'000};
+
+    std::vector<AtomFields> reportedAtomFields;
+    MotionPredictorMetricsManager metricsManager(TEST_PREDICTION_INTERVAL_NANOS,
+                                                 TEST_MAX_NUM_PREDICTIONS,
+                                                 createMockReportAtomFunction(reportedAtomFields));
+    for (size_t i = 0; i < groundTruthPoints.size(); ++i) {
+        metricsManager.onRecord(makeMotionEvent(groundTruthPoints[i]));
+        metricsManager.onInference(inferenceLatencies[i]);
+        metricsManager.onPredict(
+                makeMotionEvent(generateConstantPredictions(groundTruthPoints[i])));
+    }
+    metricsManager.onRecord(makeLiftMotionEvent());
+
+    ASSERT_EQ(TEST_MAX_NUM_PREDICTIONS, reportedAtomFields.size());
+    for (size_t i = 0; i < reportedAtomFields.size(); ++i) {
+        SCOPED_TRACE(testing::Message() << "i = " << i);
+        EXPECT_EQ(3000, reportedAtomFields[i].inferenceLatencyMeanMicros);
+        EXPECT_EQ(6000, reportedAtomFields[i].inferenceLatencyMaxMicros);
+    }
+}
+
 } // namespace
 } // namespace android
@@ -0,0 +1,154 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <memory>
+
+#include <benchmark/benchmark.h>
+#include <input/Input.h>
+#include <input/InputEventBuilders.h>
+#include <input/InputTransport.h>
+#include <input/Resampler.h>
+
+namespace android {
+
+namespace {
+
+using namespace std::literals::chrono_literals;
+using std::chrono::nanoseconds;
+
+// A 240 Hz touchscreen, drawn on a 120 Hz display.
+constexpr nanoseconds SAMPLE_INTERVAL{4166667};
+constexpr nanoseconds FRAME_INTERVAL{8333333};
+constexpr nanoseconds TRACE_DURATION{1s};
+
+struct Position {
+    float x;
+    float y;
+};
+
+// The position of the finger at the given time, in milliseconds.
+using Trace = std::function<Position(double)>;
+
+Position fling(double time) {
+    return {3.0f * static_cast<float>(time), 1.0f * static_cast<float>(time)};
+}
+
+// A flick that slows down exponentially, and comes to a stop after a few hundred milliseconds.
+Position deceleratingStop(double time) {
+    constexpr double initialVelocity = 4;
+    constexpr double timeConstant = 80;
+    return {static_cast<float>(initialVelocity * timeConstant *
+                               (1 - std::exp(-time / timeConstant))),
+            0.0f};
+}
+
+Position circle(double time) {
+    constexpr double radius = 300;
+    constexpr double period = 500;
+    const double angle = 2 * M_PI * time / period;
+    return {static_cast<float>(radius * std::cos(angle)),
+            static_cast<float>(radius * std::sin(angle))};
+}
+
+double toMillis(nanoseconds time) {
+    return std::chrono::duration<double, std::milli>(time).count();
+}
+
+PointerBuilder pointerAt(const Position& position) {
+    return PointerBuilder(/*id=*/0, ToolType::FINGER).x(position.x).y(position.y);
+}
+
+/**
+ * Replays the trace the way InputConsumerNoResampling consumes it: on every frame, the samples up
+ * to the resample time are batched into one MotionEvent, and the first sample after them, if it
+ * arrived by the frame time, is passed as the future sample. Reports how far the latest sample of
+ * every resampled MotionEvent is from the position of the finger at the frame time.
+ */
+void replay(benchmark::State& state, const std::function<std::unique_ptr<Resampler>()>& factory,
+            const Trace& trace) {
+    double errorSum = 0;
+    double maxError = 0;
+    int64_t frameCount = 0;
+    for (auto _ : state) {
+        std::unique_ptr<Resampler> resampler = factory();
+        nanoseconds nextSampleTime{0};
+        for (nanoseconds frameTime = FRAME_INTERVAL; frameTime <= TRACE_DURATION;
+             frameTime += FRAME_INTERVAL) {
+            const nanoseconds resampleTime = frameTime - resampler->getResampleLatency();
+            if (nextSampleTime > resampleTime) {
+                continue;
+            }
+            MotionEvent motionEvent =
+                    MotionEventBuilder(AMOTION_EVENT_ACTION_MOVE, AINPUT_SOURCE_TOUCHSCREEN)
+                            .downTime(0)
+                            .eventTime(nextSampleTime.count())
+                            .pointer(pointerAt(trace(toMillis(nextSampleTime))))
+                            .build();
+            for (nextSampleTime += SAMPLE_INTERVAL; nextSampleTime <= resampleTime;
+                 nextSampleTime += SAMPLE_INTERVAL) {
+                const PointerCoords coords =
+                        pointerAt(trace(toMillis(nextSampleTime))).buildCoords();
+                motionEvent.addSample(nextSampleTime.count(), &coords, motionEvent.getId());
+            }
+
+            if (nextSampleTime <= frameTime) {
+                const InputMessage futureSample =
+                        InputMessageBuilder{InputMessage::Type::MOTION, /*seq=*/0}
+                                .eventTime(nextSampleTime.count())
+                                .source(AINPUT_SOURCE_TOUCHSCREEN)
+                                .downTime(0)
+                                .pointer(pointerAt(trace(toMillis(nextSampleTime))))
+                                .build();
+                resampler->resampleMotionEvent(frameTime, motionEvent, &futureSample);
+            } else {
+                resampler->resampleMotionEvent(frameTime, motionEvent, /*futureSample=*/nullptr);
+            }
+
+            const Position expected = trace(toMillis(frameTime));
+            const double error = std::hypot(motionEvent.getX(0) - expected.x,
+                                            motionEvent.getY(0) - expected.y);
+            errorSum += error;
+            maxError = std::max(maxError, error);
+            frameCount++;
+        }
+    }
+    state.counters["meanErrorPx"] = frameCount > 0 ? errorSum / frameCount : 0;
+    state.counters["maxErrorPx"] = maxError;
+}
+
+std::unique_ptr<Resampler> makeLegacyResampler() {
+    return std::make_unique<LegacyResampler>();
+}
+
+std::unique_ptr<Resampler> makeLeastSquaresResampler() {
+    return std::make_unique<LeastSquaresResampler>();
+}
+
+} // namespace
+
+BENCHMARK_CAPTURE(replay, legacyFling, makeLegacyResampler, fling);
+BENCHMARK_CAPTURE(replay, leastSquaresFling, makeLeastSquaresResampler, fling);
+BENCHMARK_CAPTURE(replay, legacyDeceleratingStop, makeLegacyResampler, deceleratingStop);
+BENCHMARK_CAPTURE(replay, leastSquaresDeceleratingStop, makeLeastSquaresResampler,
+                  deceleratingStop);
+BENCHMARK_CAPTURE(replay, legacyCircle, makeLegacyResampler, circle);
+BENCHMARK_CAPTURE(replay, leastSquaresCircle, makeLeastSquaresResampler, circle);
+
+} // namespace android
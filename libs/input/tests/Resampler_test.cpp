@@ -870,4 +870,148 @@ TEST_F(ResamplerTest, MultiplePointerShouldNotResampleToolTypeExtrapolation) {
 
     assertMotionEventIsNotResampled(originalMotionEvent, motionEvent);
 }
+
+class LeastSquaresResamplerTest : public ResamplerTest {
+protected:
+    LeastSquaresResamplerTest() { mResampler = std::make_unique<LeastSquaresResampler>(); }
+};
+
+TEST_F(LeastSquaresResamplerTest, LinearMotionIsExtrapolatedToFrameTime) {
+    MotionEvent motionEvent =
+            InputStream{{InputSample{5ms, {{.id = 0, .x = 5.0f, .y = 10.0f, .isResampled = false}}},
+                         InputSample{10ms,
+                                     {{.id = 0, .x = 10.0f, .y = 20.0f, .isResampled = false}}},
+                         InputSample{15ms,
+                                     {{.id = 0, .x = 15.0f, .y = 30.0f, .isResampled = false}}}},
+                        AMOTION_EVENT_ACTION_MOVE};
+
+    const MotionEvent originalMotionEvent = motionEvent;
+
+    mResampler->resampleMotionEvent(18ms, motionEvent, /*futureSample=*/nullptr);
+
+    assertMotionEventIsResampledAndCoordsNear(originalMotionEvent, motionEvent,
+                                              {Pointer{.id = 0,
+                                                       .x = 18.0f,
+                                                       .y = 36.0f,
+                                                       .isResampled = true}});
+    EXPECT_EQ(std::chrono::nanoseconds{18ms}.count(), motionEvent.getEventTime());
+}
+
+TEST_F(LeastSquaresResamplerTest, PredictionIsLimitedToOneSampleInterval) {
+    MotionEvent motionEvent =
+            InputStream{{InputSample{5ms, {{.id = 0, .x = 5.0f, .y = 10.0f, .isResampled = false}}},
+                         InputSample{10ms,
+                                     {{.id = 0, .x = 10.0f, .y = 20.0f, .isResampled = false}}},
+                         InputSample{15ms,
+                                     {{.id = 0, .x = 15.0f, .y = 30.0f, .isResampled = false}}}},
+                        AMOTION_EVENT_ACTION_MOVE};
+
+    const MotionEvent originalMotionEvent = motionEvent;
+
+    mResampler->resampleMotionEvent(30ms, motionEvent, /*futureSample=*/nullptr);
+
+    assertMotionEventIsResampledAndCoordsNear(originalMotionEvent, motionEvent,
+                                              {Pointer{.id = 0,
+                                                       .x = 20.0f,
+                                                       .y = 40.0f,
+                                                       .isResampled = true}});
+    EXPECT_EQ(std::chrono::nanoseconds{20ms}.count(), motionEvent.getEventTime());
+}
+
+TEST_F(LeastSquaresResamplerTest, DeceleratingMotionDoesNotOvershoot) {
+    // A linear extrapolation of the two latest samples would predict x = 38.
+    MotionEvent motionEvent =
+            InputStream{{InputSample{0ms, {{.id = 0, .x = 0.0f, .y = 1.0f, .isResampled = false}}},
+                         InputSample{5ms, {{.id = 0, .x = 20.0f, .y = 1.0f, .isResampled = false}}},
+                         InputSample{10ms,
+                                     {{.id = 0, .x = 30.0f, .y = 1.0f, .isResampled = false}}},
+                         InputSample{15ms,
+                                     {{.id = 0, .x = 34.0f, .y = 1.0f, .isResampled = false}}}},
+                        AMOTION_EVENT_ACTION_MOVE};
+
+    const MotionEvent originalMotionEvent = motionEvent;
+
+    mResampler->resampleMotionEvent(20ms, motionEvent, /*futureSample=*/nullptr);
+
+    assertMotionEventIsResampledAndCoordsNear(originalMotionEvent, motionEvent,
+                                              {Pointer{.id = 0,
+                                                       .x = 34.0f,
+                                                       .y = 1.0f,
+                                                       .isResampled = true}});
+}
+
+TEST_F(LeastSquaresResamplerTest, AcceleratingMotionIsPredictedAtMostAtTheFittedVelocity) {
+    // The samples lie on x = t^2 / 10 + t / 2, whose velocity at 15ms is 3.5 px/ms.
+    MotionEvent motionEvent =
+            InputStream{{InputSample{0ms, {{.id = 0, .x = 0.0f, .y = 1.0f, .isResampled = false}}},
+                         InputSample{5ms, {{.id = 0, .x = 5.0f, .y = 1.0f, .isResampled = false}}},
+                         InputSample{10ms,
+                                     {{.id = 0, .x = 15.0f, .y = 1.0f, .isResampled = false}}},
+                         InputSample{15ms,
+                                     {{.id = 0, .x = 30.0f, .y = 1.0f, .isResampled = false}}}},
+                        AMOTION_EVENT_ACTION_MOVE};
+
+    const MotionEvent originalMotionEvent = motionEvent;
+
+    mResampler->resampleMotionEvent(20ms, motionEvent, /*futureSample=*/nullptr);
+
+    assertMotionEventIsResampledAndCoordsNear(originalMotionEvent, motionEvent,
+                                              {Pointer{.id = 0,
+                                                       .x = 47.5f,
+                                                       .y = 1.0f,
+                                                       .isResampled = true}});
+}
+
+TEST_F(LeastSquaresResamplerTest, SingleSampleIsNotExtrapolated) {
+    MotionEvent motionEvent =
+            InputStream{{InputSample{5ms, {{.id = 0, .x = 1.0f, .y = 1.0f, .isResampled = false}}}},
+                        AMOTION_EVENT_ACTION_MOVE};
+
+    const MotionEvent originalMotionEvent = motionEvent;
+
+    mResampler->resampleMotionEvent(16ms, motionEvent, /*futureSample=*/nullptr);
+
+    assertMotionEventIsNotResampled(originalMotionEvent, motionEvent);
+}
+
+TEST_F(LeastSquaresResamplerTest, SamplesOfAnotherDeviceAreNotFit) {
+    MotionEvent motionFromFirstDevice =
+            InputStream{{InputSample{4ms, {{.id = 0, .x = 1.0f, .y = 1.0f, .isResampled = false}}},
+                         InputSample{8ms, {{.id = 0, .x = 2.0f, .y = 2.0f, .isResampled = false}}}},
+                        AMOTION_EVENT_ACTION_MOVE,
+                        .deviceId = 0};
+
+    mResampler->resampleMotionEvent(10ms, motionFromFirstDevice, /*futureSample=*/nullptr);
+
+    MotionEvent motionFromSecondDevice =
+            InputStream{{InputSample{11ms,
+                                     {{.id = 0, .x = 3.0f, .y = 3.0f, .isResampled = false}}}},
+                        AMOTION_EVENT_ACTION_MOVE,
+                        .deviceId = 1};
+    const MotionEvent originalMotionEvent = motionFromSecondDevice;
+
+    mResampler->resampleMotionEvent(12ms, motionFromSecondDevice, /*futureSample=*/nullptr);
+
+    assertMotionEventIsNotResampled(originalMotionEvent, motionFromSecondDevice);
+}
+
+TEST_F(LeastSquaresResamplerTest, FutureSampleIsInterpolatedLinearly) {
+    MotionEvent motionEvent =
+            InputStream{{InputSample{5ms, {{.id = 0, .x = 5.0f, .y = 5.0f, .isResampled = false}}},
+                         InputSample{10ms,
+                                     {{.id = 0, .x = 10.0f, .y = 10.0f, .isResampled = false}}}},
+                        AMOTION_EVENT_ACTION_MOVE};
+    const InputMessage futureSample =
+            InputSample{20ms, {{.id = 0, .x = 20.0f, .y = 30.0f, .isResampled = false}}};
+
+    const MotionEvent originalMotionEvent = motionEvent;
+
+    mResampler->resampleMotionEvent(15ms, motionEvent, &futureSample);
+
+    assertMotionEventIsResampledAndCoordsNear(originalMotionEvent, motionEvent,
+                                              {Pointer{.id = 0,
+                                                       .x = 15.0f,
+                                                       .y = 20.0f,
+                                                       .isResampled = true}});
+}
 } // namespace android
@@ -0,0 +1,62 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+#include <input/VelocityTracker.h>
+
+namespace android {
+
+namespace {
+
+constexpr int32_t POINTER_ID = 0;
+
+// A 240 Hz stylus stroke.
+constexpr nsecs_t SAMPLE_INTERVAL = 4166666;
+
+// Adds one movement at a time to the strategy, and gets the velocity the given number of times
+// after each movement, like an app that computes the velocity on every frame of a fling.
+void addMovementsAndGetVelocity(benchmark::State& state, VelocityTrackerStrategy& strategy) {
+    const int64_t velocitiesPerMovement = state.range(0);
+    nsecs_t eventTime = 0;
+    float position = 0;
+    for (auto _ : state) {
+        eventTime += SAMPLE_INTERVAL;
+        position += 3.5f;
+        strategy.addMovement(eventTime, POINTER_ID, position);
+        for (int64_t i = 0; i < velocitiesPerMovement; i++) {
+            benchmark::DoNotOptimize(strategy.getVelocity(POINTER_ID));
+        }
+    }
+}
+
+static void benchmarkLsq2(benchmark::State& state) {
+    LeastSquaresVelocityTrackerStrategy strategy(/*degree=*/2);
+    addMovementsAndGetVelocity(state, strategy);
+}
+
+static void benchmarkIncrementalLsq2(benchmark::State& state) {
+    IncrementalLeastSquaresVelocityTrackerStrategy strategy;
+    addMovementsAndGetVelocity(state, strategy);
+}
+
+} // namespace
+
+BENCHMARK(benchmarkLsq2)->Arg(0)->Arg(1)->Arg(4);
+BENCHMARK(benchmarkIncrementalLsq2)->Arg(0)->Arg(1)->Arg(4);
+
+} // namespace android
+
+BENCHMARK_MAIN();
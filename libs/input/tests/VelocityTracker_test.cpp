@@ -1445,4 +1445,61 @@ TEST_F(VelocityTrackerTest, AxisScrollVelocity_NoData) {
     computeAndCheckAxisScrollVelocity(VelocityTracker::Strategy::IMPULSE, motions, std::nullopt);
 }
 
+// --- IncrementalLeastSquaresVelocityTrackerStrategy ---
+
+// The incremental strategy keeps its sums in double precision, while the strategy that it replaces
+// sums up all of its movements in single precision.
+constexpr float INCREMENTAL_LSQ2_TOLERANCE = 0.005;
+
+TEST_F(VelocityTrackerTest, IncrementalLsq2MatchesLsq2) {
+    LeastSquaresVelocityTrackerStrategy lsq2(/*degree=*/2);
+    IncrementalLeastSquaresVelocityTrackerStrategy incremental;
+
+    // Two seconds of a 120 Hz gesture, starting long after boot, with a pause every 50 samples so
+    // that the movements are also evicted by the horizon, and not only by the history size.
+    nsecs_t eventTime = 1000 * 1000000000LL;
+    for (int i = 0; i < 240; i++) {
+        eventTime += (i % 50 == 49) ? 150000000 : 8333333 + (i % 3) * 1000;
+        const float position = 500 + 1.5f * i + 0.01f * i * i + ((i % 4) - 1.5f) * 0.5f;
+        lsq2.addMovement(eventTime, DEFAULT_POINTER_ID, position);
+        incremental.addMovement(eventTime, DEFAULT_POINTER_ID, position);
+        if (i % 37 == 5) {
+            // A second movement with the same event time replaces the first one.
+            lsq2.addMovement(eventTime, DEFAULT_POINTER_ID, position + 3);
+            incremental.addMovement(eventTime, DEFAULT_POINTER_ID, position + 3);
+        }
+
+        const std::optional<float> expected = lsq2.getVelocity(DEFAULT_POINTER_ID);
+        const std::optional<float> actual = incremental.getVelocity(DEFAULT_POINTER_ID);
+        ASSERT_EQ(expected.has_value(), actual.has_value()) << "at movement " << i;
+        if (expected) {
+            EXPECT_NEAR_BY_FRACTION(*actual, *expected, INCREMENTAL_LSQ2_TOLERANCE);
+        }
+    }
+}
+
+TEST_F(VelocityTrackerTest, IncrementalLsq2WithTwoMovementsIsLinear) {
+    IncrementalLeastSquaresVelocityTrackerStrategy strategy;
+
+    strategy.addMovement(10000000, DEFAULT_POINTER_ID, 100);
+    EXPECT_EQ(std::nullopt, strategy.getVelocity(DEFAULT_POINTER_ID));
+
+    strategy.addMovement(20000000, DEFAULT_POINTER_ID, 110);
+    std::optional<float> velocity = strategy.getVelocity(DEFAULT_POINTER_ID);
+    ASSERT_TRUE(velocity.has_value());
+    EXPECT_NEAR_BY_FRACTION(*velocity, 1000, QUADRATIC_VELOCITY_TOLERANCE);
+}
+
+TEST_F(VelocityTrackerTest, IncrementalLsq2ClearPointer) {
+    IncrementalLeastSquaresVelocityTrackerStrategy strategy;
+    strategy.addMovement(10000000, DEFAULT_POINTER_ID, 100);
+    strategy.addMovement(20000000, DEFAULT_POINTER_ID, 110);
+    strategy.addMovement(30000000, DEFAULT_POINTER_ID, 130);
+    ASSERT_TRUE(strategy.getVelocity(DEFAULT_POINTER_ID).has_value());
+
+    strategy.clearPointer(DEFAULT_POINTER_ID);
+
+    EXPECT_EQ(std::nullopt, strategy.getVelocity(DEFAULT_POINTER_ID));
+}
+
 } // namespace android
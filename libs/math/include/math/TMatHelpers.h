@@ -26,6 +26,7 @@
 #include <stdexcept>
 
 #include <math/quat.h>
+#include <math/TMatSimd.h>
 #include <math/TVecHelpers.h>
 
 #include  <utils/String8.h>
@@ -230,12 +231,21 @@ CONSTEXPR MATRIX PURE fastInverse3(const MATRIX& x) {
  * undefined if it is not. It is the responsibility of the caller to
  * make sure the matrix is not singular.
  */
+template <typename MATRIX>
+MATRIX PURE fastInverse4(const MATRIX& src) {
+    MATRIX inverted(MATRIX::NO_INIT);
+    if (simdInverse(inverted, src)) {
+        return inverted;
+    }
+    return gaussJordanInverse<MATRIX>(src);
+}
+
 template <typename MATRIX>
 inline constexpr MATRIX PURE inverse(const MATRIX& matrix) {
     static_assert(MATRIX::NUM_ROWS == MATRIX::NUM_COLS, "only square matrices can be inverted");
     return (MATRIX::NUM_ROWS == 2) ? fastInverse2<MATRIX>(matrix) :
           ((MATRIX::NUM_ROWS == 3) ? fastInverse3<MATRIX>(matrix) :
-                    gaussJordanInverse<MATRIX>(matrix));
+                    fastInverse4<MATRIX>(matrix));
 }
 
 template<typename MATRIX_R, typename MATRIX_A, typename MATRIX_B>
@@ -253,6 +263,9 @@ CONSTEXPR MATRIX_R PURE multiply(const MATRIX_A& lhs, const MATRIX_B& rhs) {
             "invalid dimension of matrix multiply result.");
 
     MATRIX_R res(MATRIX_R::NO_INIT);
+    if (!isConstantEvaluated() && simdMultiply(res, lhs, rhs)) {
+        return res;
+    }
     for (size_t col = 0; col < MATRIX_R::NUM_COLS; ++col) {
         res[col] = lhs * rhs[col];
     }
@@ -0,0 +1,223 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#if defined(__aarch64__) && defined(__clang__)
+#include <arm_neon.h>
+#define MATH_SIMD_NEON 1
+#elif defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define MATH_SIMD_SSE 1
+#endif
+
+namespace android {
+namespace details {
+// -------------------------------------------------------------------------------------
+
+/*
+ * No user serviceable parts here.
+ *
+ * Don't use this file directly, instead include math/mat*.h
+ */
+
+// Returns whether the caller is being evaluated as a constant expression, in which case the SIMD
+// paths must not be taken. Compilers without the builtin never take them.
+inline constexpr bool isConstantEvaluated() {
+#if defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 9)
+    return __builtin_is_constant_evaluated();
+#else
+    return true;
+#endif
+}
+
+/*
+ * Hooks for the generic matrix code. The matrix headers overload these for the types that have a
+ * SIMD implementation, and the generic code falls back to its loops when they return false.
+ */
+template <typename MATRIX_R, typename MATRIX_A, typename MATRIX_B>
+inline bool simdMultiply(MATRIX_R&, const MATRIX_A&, const MATRIX_B&) {
+    return false;
+}
+
+template <typename MATRIX>
+inline bool simdInverse(MATRIX&, const MATRIX&) {
+    return false;
+}
+
+namespace simd {
+
+#if defined(MATH_SIMD_NEON) || defined(MATH_SIMD_SSE)
+#define MATH_SIMD 1
+
+#if defined(MATH_SIMD_NEON)
+typedef float32x4_t float4;
+
+inline float4 load(const float* p) { return vld1q_f32(p); }
+inline void store(float* p, float4 v) { vst1q_f32(p, v); }
+inline float4 set(float x, float y, float z, float w) { return float4{ x, y, z, w }; }
+inline float4 splat(float v) { return vdupq_n_f32(v); }
+
+inline float4 add(float4 a, float4 b) { return vaddq_f32(a, b); }
+inline float4 sub(float4 a, float4 b) { return vsubq_f32(a, b); }
+inline float4 mul(float4 a, float4 b) { return vmulq_f32(a, b); }
+inline float4 div(float4 a, float4 b) { return vdivq_f32(a, b); }
+
+// Returns { a[X], a[Y], b[Z], b[W] }.
+template <int X, int Y, int Z, int W>
+inline float4 shuffle(float4 a, float4 b) {
+    return __builtin_shufflevector(a, b, X, Y, Z + 4, W + 4);
+}
+#else
+typedef __m128 float4;
+
+inline float4 load(const float* p) { return _mm_loadu_ps(p); }
+inline void store(float* p, float4 v) { _mm_storeu_ps(p, v); }
+inline float4 set(float x, float y, float z, float w) { return _mm_setr_ps(x, y, z, w); }
+inline float4 splat(float v) { return _mm_set1_ps(v); }
+
+inline float4 add(float4 a, float4 b) { return _mm_add_ps(a, b); }
+inline float4 sub(float4 a, float4 b) { return _mm_sub_ps(a, b); }
+inline float4 mul(float4 a, float4 b) { return _mm_mul_ps(a, b); }
+inline float4 div(float4 a, float4 b) { return _mm_div_ps(a, b); }
+
+// Returns { a[X], a[Y], b[Z], b[W] }.
+template <int X, int Y, int Z, int W>
+inline float4 shuffle(float4 a, float4 b) {
+    return _mm_shuffle_ps(a, b, _MM_SHUFFLE(W, Z, Y, X));
+}
+#endif
+
+template <int X, int Y, int Z, int W>
+inline float4 swizzle(float4 v) {
+    return shuffle<X, Y, Z, W>(v, v);
+}
+
+/*
+ * 4x4 float matrices are 16 floats in column-major order. Sums are accumulated in the same order
+ * as the generic code, and multiply-adds are not fused, so products match the generic code except
+ * for the sign of zeros.
+ */
+
+// out = m * v
+inline void multiplyMat4Vec4(const float* m, const float* v, float* out) {
+    float4 r = mul(load(m), splat(v[0]));
+    r = add(r, mul(load(m + 4), splat(v[1])));
+    r = add(r, mul(load(m + 8), splat(v[2])));
+    r = add(r, mul(load(m + 12), splat(v[3])));
+    store(out, r);
+}
+
+// out = lhs * rhs. out must not alias rhs.
+inline void multiplyMat4(const float* lhs, const float* rhs, float* out) {
+    const float4 c0 = load(lhs);
+    const float4 c1 = load(lhs + 4);
+    const float4 c2 = load(lhs + 8);
+    const float4 c3 = load(lhs + 12);
+    for (int col = 0; col < 4; ++col) {
+        const float* v = rhs + 4 * col;
+        float4 r = mul(c0, splat(v[0]));
+        r = add(r, mul(c1, splat(v[1])));
+        r = add(r, mul(c2, splat(v[2])));
+        r = add(r, mul(c3, splat(v[3])));
+        store(out + 4 * col, r);
+    }
+}
+
+// 2x2 blocks are stored as { m00, m01, m10, m11 }.
+
+// a * b
+inline float4 mat2Mul(float4 a, float4 b) {
+    return add(mul(a, swizzle<0, 3, 0, 3>(b)),
+               mul(swizzle<1, 0, 3, 2>(a), swizzle<2, 1, 2, 1>(b)));
+}
+
+// adj(a) * b
+inline float4 mat2AdjMul(float4 a, float4 b) {
+    return sub(mul(swizzle<3, 3, 0, 0>(a), b),
+               mul(swizzle<1, 1, 2, 2>(a), swizzle<2, 3, 0, 1>(b)));
+}
+
+// a * adj(b)
+inline float4 mat2MulAdj(float4 a, float4 b) {
+    return sub(mul(a, swizzle<3, 0, 3, 0>(b)),
+               mul(swizzle<1, 0, 3, 2>(a), swizzle<2, 1, 2, 1>(b)));
+}
+
+/*
+ * out = inverse(m), using the block-wise adjugate of
+ *
+ *     | A B |
+ *     | C D |
+ *
+ * rather than Gauss-Jordan elimination, which does not vectorize. Since the inverse of the
+ * transpose is the transpose of the inverse, this works on either storage order.
+ */
+inline void inverseMat4(const float* m, float* out) {
+    const float4 c0 = load(m);
+    const float4 c1 = load(m + 4);
+    const float4 c2 = load(m + 8);
+    const float4 c3 = load(m + 12);
+
+    const float4 A = shuffle<0, 1, 0, 1>(c0, c1);
+    const float4 B = shuffle<2, 3, 2, 3>(c0, c1);
+    const float4 C = shuffle<0, 1, 0, 1>(c2, c3);
+    const float4 D = shuffle<2, 3, 2, 3>(c2, c3);
+
+    // { |A|, |B|, |C|, |D| }
+    const float4 detSub = sub(
+            mul(shuffle<0, 2, 0, 2>(c0, c2), shuffle<1, 3, 1, 3>(c1, c3)),
+            mul(shuffle<1, 3, 1, 3>(c0, c2), shuffle<0, 2, 0, 2>(c1, c3)));
+    const float4 detA = swizzle<0, 0, 0, 0>(detSub);
+    const float4 detB = swizzle<1, 1, 1, 1>(detSub);
+    const float4 detC = swizzle<2, 2, 2, 2>(detSub);
+    const float4 detD = swizzle<3, 3, 3, 3>(detSub);
+
+    const float4 D_C = mat2AdjMul(D, C);
+    const float4 A_B = mat2AdjMul(A, B);
+
+    // The adjugate blocks of the inverse.
+    float4 X = sub(mul(detD, A), mat2Mul(B, D_C));
+    float4 W = sub(mul(detA, D), mat2Mul(C, A_B));
+    float4 Y = sub(mul(detB, C), mat2MulAdj(D, A_B));
+    float4 Z = sub(mul(detC, B), mat2MulAdj(A, D_C));
+
+    // |M| = |A||D| + |B||C| - tr(adj(A) B adj(D) C)
+    float4 trace = mul(A_B, swizzle<0, 2, 1, 3>(D_C));
+    trace = add(trace, swizzle<2, 3, 0, 1>(trace));
+    trace = add(trace, swizzle<1, 0, 3, 2>(trace));
+    const float4 det = sub(add(mul(detA, detD), mul(detB, detC)), trace);
+
+    const float4 rcpDet = div(set(1.0f, -1.0f, -1.0f, 1.0f), det);
+    X = mul(X, rcpDet);
+    Y = mul(Y, rcpDet);
+    Z = mul(Z, rcpDet);
+    W = mul(W, rcpDet);
+
+    // Undo the adjugate and block layout.
+    store(out, shuffle<3, 1, 3, 1>(X, Y));
+    store(out + 4, shuffle<2, 0, 2, 0>(X, Y));
+    store(out + 8, shuffle<3, 1, 3, 1>(Z, W));
+    store(out + 12, shuffle<2, 0, 2, 0>(Z, W));
+}
+
+#endif  // MATH_SIMD_NEON || MATH_SIMD_SSE
+
+}  // namespace simd
+
+// -------------------------------------------------------------------------------------
+}  // namespace details
+}  // namespace android
@@ -527,11 +527,45 @@ CONSTEXPR TMat44<T> TMat44<T>::lookAt(const TVec3<A>& eye, const TVec3<B>& cente
  * it determines the output type (only relevant when T != U).
  */
 
+// SIMD specializations for float, picked over the generic hooks in TMatSimd.h.
+inline bool simdMultiply(TVec4<float>& result, const TMat44<float>& lhs, const TVec4<float>& rhs) {
+#if defined(MATH_SIMD)
+    simd::multiplyMat4Vec4(&lhs[0][0], &rhs[0], &result[0]);
+    return true;
+#else
+    (void)result; (void)lhs; (void)rhs;
+    return false;
+#endif
+}
+
+inline bool simdMultiply(TMat44<float>& result, const TMat44<float>& lhs, const TMat44<float>& rhs) {
+#if defined(MATH_SIMD)
+    simd::multiplyMat4(&lhs[0][0], &rhs[0][0], &result[0][0]);
+    return true;
+#else
+    (void)result; (void)lhs; (void)rhs;
+    return false;
+#endif
+}
+
+inline bool simdInverse(TMat44<float>& result, const TMat44<float>& matrix) {
+#if defined(MATH_SIMD)
+    simd::inverseMat4(&matrix[0][0], &result[0][0]);
+    return true;
+#else
+    (void)result; (void)matrix;
+    return false;
+#endif
+}
+
 // matrix * column-vector, result is a vector of the same type than the input vector
 template <typename T, typename U>
 CONSTEXPR typename TMat44<T>::col_type PURE operator *(const TMat44<T>& lhs, const TVec4<U>& rhs) {
     // Result is initialized to zero.
     typename TMat44<T>::col_type result;
+    if (!isConstantEvaluated() && simdMultiply(result, lhs, rhs)) {
+        return result;
+    }
     for (size_t col = 0; col < TMat44<T>::NUM_COLS; ++col) {
         result += lhs[col] * rhs[col];
     }
@@ -0,0 +1,110 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <math/mat4.h>
+
+namespace android {
+namespace {
+
+// A color matrix as RenderEngine builds them, i.e. not a pure affine transform.
+const mat4 kMatrix(0.8f, 0.1f, 0.05f, 0.0f,
+                   0.15f, 0.85f, 0.1f, 0.0f,
+                   0.05f, 0.05f, 0.9f, 0.0f,
+                   0.01f, 0.02f, 0.03f, 1.0f);
+
+// The generic loops that mat4 used before its SIMD specializations, as a baseline.
+vec4 scalarMultiply(const mat4& lhs, const vec4& rhs) {
+    vec4 result;
+    for (size_t col = 0; col < 4; ++col) {
+        for (size_t row = 0; row < 4; ++row) {
+            result[row] += lhs[col][row] * rhs[col];
+        }
+    }
+    return result;
+}
+
+mat4 scalarMultiply(const mat4& lhs, const mat4& rhs) {
+    mat4 result(mat4::NO_INIT);
+    for (size_t col = 0; col < 4; ++col) {
+        result[col] = scalarMultiply(lhs, rhs[col]);
+    }
+    return result;
+}
+
+void BM_Mat4Vec4(benchmark::State& state) {
+    mat4 m = kMatrix;
+    vec4 v(0.5f, 0.25f, 0.125f, 1.0f);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(m);
+        benchmark::DoNotOptimize(m * v);
+    }
+}
+BENCHMARK(BM_Mat4Vec4);
+
+void BM_Mat4Vec4Scalar(benchmark::State& state) {
+    mat4 m = kMatrix;
+    vec4 v(0.5f, 0.25f, 0.125f, 1.0f);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(m);
+        benchmark::DoNotOptimize(scalarMultiply(m, v));
+    }
+}
+BENCHMARK(BM_Mat4Vec4Scalar);
+
+void BM_Mat4Mat4(benchmark::State& state) {
+    mat4 a = kMatrix;
+    mat4 b = transpose(kMatrix);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(a);
+        benchmark::DoNotOptimize(a * b);
+    }
+}
+BENCHMARK(BM_Mat4Mat4);
+
+void BM_Mat4Mat4Scalar(benchmark::State& state) {
+    mat4 a = kMatrix;
+    mat4 b = transpose(kMatrix);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(a);
+        benchmark::DoNotOptimize(scalarMultiply(a, b));
+    }
+}
+BENCHMARK(BM_Mat4Mat4Scalar);
+
+void BM_Mat4Inverse(benchmark::State& state) {
+    mat4 m = kMatrix;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(m);
+        benchmark::DoNotOptimize(inverse(m));
+    }
+}
+BENCHMARK(BM_Mat4Inverse);
+
+void BM_Mat4InverseGaussJordan(benchmark::State& state) {
+    mat4 m = kMatrix;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(m);
+        benchmark::DoNotOptimize(details::matrix::gaussJordanInverse(m));
+    }
+}
+BENCHMARK(BM_Mat4InverseGaussJordan);
+
+} // namespace
+} // namespace android
+
+BENCHMARK_MAIN();
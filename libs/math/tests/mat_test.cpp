@@ -421,6 +421,59 @@ TYPED_TEST(MatTestT, Inverse4) {
     TEST_MATRIX_INVERSE(m5, 20.0 * std::numeric_limits<TypeParam>::epsilon());
 }
 
+// mat4 products and inverse take a SIMD path on NEON and SSE targets. Compare them against the
+// generic code, which is what mat4d runs.
+TEST_F(MatTest, SimdMatchesGeneric) {
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<float> distribution(-10.0f, 10.0f);
+    auto random = [&]() { return distribution(generator); };
+
+    for (int i = 0; i < 100; ++i) {
+        mat4 a(random(), random(), random(), random(), random(), random(), random(), random(),
+               random(), random(), random(), random(), random(), random(), random(), random());
+        mat4 b(random(), random(), random(), random(), random(), random(), random(), random(),
+               random(), random(), random(), random(), random(), random(), random(), random());
+        vec4 v(random(), random(), random(), random());
+
+        const mat4d ad(a);
+        const mat4d bd(b);
+        const double4 vd(v);
+
+        const mat4 ab = a * b;
+        const mat4d abd = ad * bd;
+        const vec4 av = a * v;
+        const double4 avd = ad * vd;
+        for (size_t c = 0; c < 4; ++c) {
+            EXPECT_NEAR(avd[c], av[c], 1e-4 * std::max(1.0, std::abs(avd[c])));
+            for (size_t r = 0; r < 4; ++r) {
+                EXPECT_NEAR(abd[c][r], ab[c][r], 1e-4 * std::max(1.0, std::abs(abd[c][r])));
+            }
+        }
+
+        // Products accumulate in the same order as the generic code.
+        mat4 generic(mat4::NO_INIT);
+        for (size_t c = 0; c < 4; ++c) {
+            vec4 column;
+            for (size_t k = 0; k < 4; ++k) {
+                column += a[k] * b[c][k];
+            }
+            generic[c] = column;
+        }
+        EXPECT_EQ(generic, ab);
+
+        const mat4 inv = inverse(a);
+        const mat4 gaussJordan = details::matrix::gaussJordanInverse(a);
+        const mat4 identity = a * inv;
+        for (size_t c = 0; c < 4; ++c) {
+            for (size_t r = 0; r < 4; ++r) {
+                EXPECT_NEAR(gaussJordan[c][r], inv[c][r],
+                            1e-3 * std::max(1.0f, std::abs(gaussJordan[c][r])));
+                EXPECT_NEAR(c == r ? 1.0f : 0.0f, identity[c][r], 1e-3);
+            }
+        }
+    }
+}
+
 //------------------------------------------------------------------------------
 TYPED_TEST(MatTestT, Inverse3) {
     typedef ::android::details::TMat33<TypeParam> M33T;
@@ -24,6 +24,7 @@
 #include <errno.h>
 #include <sys/socket.h>
 #include <memory>
+#include <vector>
 
 #include <cutils/native_handle.h>
 #include <log/log.h>
@@ -638,6 +639,49 @@ enum AHardwareBufferStatus AHardwareBuffer_allocateWithOptions(
     return AHARDWAREBUFFER_STATUS_OK;
 }
 
+enum AHardwareBufferStatus AHardwareBuffer_allocateMultiple(const AHardwareBuffer_Desc* desc,
+                                                            uint32_t count,
+                                                            AHardwareBuffer** outBuffers) {
+    if (!outBuffers || !desc) return AHARDWAREBUFFER_STATUS_BAD_VALUE;
+    if (!AHardwareBuffer_isValidDescription(desc, /*log=*/true)) {
+        return AHARDWAREBUFFER_STATUS_BAD_VALUE;
+    }
+    if (count == 0) return AHARDWAREBUFFER_STATUS_OK;
+
+    std::vector<sp<GraphicBuffer>> gbuffers;
+    status_t err = GraphicBuffer::allocateMultiple(
+            GraphicBufferAllocator::AllocationRequest{
+                    .importBuffer = true,
+                    .width = desc->width,
+                    .height = desc->height,
+                    .format = AHardwareBuffer_convertToPixelFormat(desc->format),
+                    .layerCount = desc->layers,
+                    .usage = AHardwareBuffer_convertToGrallocUsageBits(desc->usage),
+                    .requestorName =
+                            std::string("AHardwareBuffer pid [") + std::to_string(getpid()) + "]",
+            },
+            count, &gbuffers);
+    if (err != 0) {
+        if (err == NO_MEMORY) {
+            GraphicBuffer::dumpAllocationsToSystemLog();
+        }
+        ALOGE("GraphicBuffer(w=%u, h=%u, lc=%u, count=%u) failed (%s)", desc->width, desc->height,
+              desc->layers, count, strerror(-err));
+        return filterStatus(err);
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        outBuffers[i] = AHardwareBuffer_from_GraphicBuffer(gbuffers[i].get());
+        // Ensure the buffer doesn't get destroyed when the sp<> goes away.
+        AHardwareBuffer_acquire(outBuffers[i]);
+    }
+    return AHARDWAREBUFFER_STATUS_OK;
+}
+
+void AHardwareBuffer_setRecyclingBudget(size_t budgetBytes) {
+    GraphicBufferAllocator::get().setRecyclingBudget(budgetBytes);
+}
+
 // ----------------------------------------------------------------------------
 // Helpers implementation
 // ----------------------------------------------------------------------------
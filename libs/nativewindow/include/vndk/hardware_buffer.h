@@ -155,6 +155,44 @@ enum AHardwareBufferStatus AHardwareBuffer_allocateWithOptions(
         const AHardwareBufferLongOptions* _Nullable additionalOptions, size_t additionalOptionsSize,
         AHardwareBuffer* _Nullable* _Nonnull outBuffer) __INTRODUCED_IN(__ANDROID_API_V__);
 
+/**
+ * Allocates count buffers that match the passed AHardwareBuffer_Desc.
+ *
+ * This is the same as calling AHardwareBuffer_allocate count times, but the buffers are
+ * requested from the allocator in a single call where the device supports it, which is faster
+ * when allocating a set of identical buffers, e.g. for a buffer ring. Either all buffers are
+ * allocated, or none is.
+ *
+ * @param desc The AHardwareBuffer_Desc that describes the allocations to request. Note that
+ *             `stride` is ignored.
+ * @param count The number of buffers to allocate.
+ * @param outBuffers An array of at least `count` elements which receives the buffers. Each
+ *                   returned buffer has a reference count of 1.
+ * @return AHARDWAREBUFFER_STATUS_OK on success
+ *         AHARDWAREBUFFER_STATUS_NO_MEMORY if there's insufficient resources for the allocations
+ *         AHARDWAREBUFFER_STATUS_BAD_VALUE if the provided description is not supported by the
+ *         device
+ *         AHARDWAREBUFFER_STATUS_UNKNOWN_ERROR for any other error
+ */
+enum AHardwareBufferStatus AHardwareBuffer_allocateMultiple(
+        const AHardwareBuffer_Desc* _Nonnull desc, uint32_t count,
+        AHardwareBuffer* _Nullable* _Nonnull outBuffers) __INTRODUCED_IN(36);
+
+/**
+ * Opts the calling process into recycling released buffers.
+ *
+ * When the last reference to a buffer allocated by this process is released, up to
+ * `budgetBytes` of such buffers are kept, and handed back by a later allocation with the same
+ * width, height, format, layer count and usage instead of allocating a new buffer. Recycled
+ * buffers keep their previous contents. Buffers which are not reused within a few seconds are
+ * freed. This lowers the cost of reallocating the same buffers, e.g. when a pipeline is
+ * reconfigured.
+ *
+ * @param budgetBytes The most memory to keep for recycling. 0, the default, disables recycling
+ *                    and frees the kept buffers.
+ */
+void AHardwareBuffer_setRecyclingBudget(size_t budgetBytes) __INTRODUCED_IN(36);
+
 /**
  * Queries the dataspace of the given AHardwareBuffer.
  *
@@ -23,8 +23,11 @@
 #include <renderengine/LayerSettings.h>
 #include <renderengine/RenderEngine.h>
 #include <renderengine/impl/ExternalTexture.h>
+#include <utils/Timers.h>
 
+#include <algorithm>
 #include <mutex>
+#include <vector>
 
 using namespace android;
 using namespace android::renderengine;
@@ -76,7 +79,8 @@ std::pair<uint32_t, uint32_t> getDisplaySize() {
 
 static std::unique_ptr<RenderEngine> createRenderEngine(
         RenderEngine::Threaded threaded, RenderEngine::GraphicsApi graphicsApi,
-        RenderEngine::BlurAlgorithm blurAlgorithm = RenderEngine::BlurAlgorithm::KAWASE) {
+        RenderEngine::BlurAlgorithm blurAlgorithm = RenderEngine::BlurAlgorithm::KAWASE,
+        RenderEngine::SkiaBackend skiaBackend = RenderEngine::SkiaBackend::GANESH) {
     auto args = RenderEngineCreationArgs::Builder()
                         .setPixelFormat(static_cast<int>(ui::PixelFormat::RGBA_8888))
                         .setImageCacheSize(1)
@@ -86,6 +90,7 @@ static std::unique_ptr<RenderEngine> createRenderEngine(
                         .setContextPriority(RenderEngine::ContextPriority::REALTIME)
                         .setThreaded(threaded)
                         .setGraphicsApi(graphicsApi)
+                        .setSkiaBackend(skiaBackend)
                         .build();
     return RenderEngine::create(args);
 }
@@ -142,6 +147,24 @@ static std::shared_ptr<ExternalTexture> copyBuffer(RenderEngine& re,
     return texture;
 }
 
+/**
+ * Reports the 50th and 99th percentile of the given per-iteration times as
+ * <name>P50Ms and <name>P99Ms counters.
+ */
+static void reportPercentiles(benchmark::State& benchState, const std::string& name,
+                              std::vector<nsecs_t> times) {
+    if (times.empty()) {
+        return;
+    }
+    std::sort(times.begin(), times.end());
+    const auto percentileMs = [&times](double percentile) {
+        const size_t index = static_cast<size_t>(percentile * static_cast<double>(times.size() - 1));
+        return static_cast<double>(times[index]) / 1e6;
+    };
+    benchState.counters[name + "P50Ms"] = percentileMs(0.5);
+    benchState.counters[name + "P99Ms"] = percentileMs(0.99);
+}
+
 /**
  * Helper for timing calls to drawLayers.
  *
@@ -150,7 +173,8 @@ static std::shared_ptr<ExternalTexture> copyBuffer(RenderEngine& re,
  * drawLayers, and saving (if --save is used).
  *
  * This times both the CPU and GPU work initiated by drawLayers. All work done
- * outside of the for loop is excluded from the timing measurements.
+ * outside of the for loop is excluded from the timing measurements. Percentiles
+ * of the CPU and fence wait times are reported as counters.
  */
 static void benchDrawLayers(RenderEngine& re, const std::vector<LayerSettings>& layers,
                             benchmark::State& benchState, const char* saveFileName) {
@@ -164,13 +188,29 @@ static void benchDrawLayers(RenderEngine& re, const std::vector<LayerSettings>&
             .maxLuminance = 500,
     };
 
+    // The time until drawLayers returns its fence, and the time from then until the fence
+    // signals, which approximates the GPU work that did not overlap with the CPU work.
+    std::vector<nsecs_t> cpuTimes;
+    std::vector<nsecs_t> fenceTimes;
+
     // This loop starts and stops the timer.
     for (auto _ : benchState) {
+        const nsecs_t start = systemTime();
         sp<Fence> waitFence =
                 re.drawLayers(display, layers, outputBuffer, base::unique_fd()).get().value();
+        const nsecs_t cpuEnd = systemTime();
         waitFence->waitForever(LOG_TAG);
+
+        cpuTimes.push_back(cpuEnd - start);
+        const nsecs_t signalTime = waitFence->getSignalTime();
+        if (signalTime != Fence::SIGNAL_TIME_INVALID && signalTime != Fence::SIGNAL_TIME_PENDING) {
+            fenceTimes.push_back(std::max(signalTime - cpuEnd, nsecs_t(0)));
+        }
     }
 
+    reportPercentiles(benchState, "cpu", std::move(cpuTimes));
+    reportPercentiles(benchState, "fence", std::move(fenceTimes));
+
     if (renderenginebench::save() && saveFileName) {
         // Copy to a CPU-accessible buffer so we can encode it.
         outputBuffer = copyBuffer(re, outputBuffer, GRALLOC_USAGE_SW_READ_OFTEN, "to_encode");
@@ -240,7 +280,8 @@ template <class... Args>
 void BM_homescreen_blur(benchmark::State& benchState, Args&&... args) {
     auto args_tuple = std::make_tuple(std::move(args)...);
     auto re = createRenderEngine(static_cast<RenderEngine::Threaded>(std::get<0>(args_tuple)),
-                                 static_cast<RenderEngine::GraphicsApi>(std::get<1>(args_tuple)));
+                                 static_cast<RenderEngine::GraphicsApi>(std::get<1>(args_tuple)),
+                                 static_cast<RenderEngine::BlurAlgorithm>(std::get<2>(args_tuple)));
 
     auto [width, height] = getDisplaySize();
     auto srcBuffer = createTexture(*re, kHomescreenPath);
@@ -309,6 +350,67 @@ void BM_homescreen_edgeExtension(benchmark::State& benchState, Args&&... args) {
     benchDrawLayers(*re, layers, benchState, "homescreen_edge_extension");
 }
 
+/**
+ * A notification shade pulled down over the homescreen: the wallpaper and
+ * launcher, a blurred scrim, a few notifications with rounded corners and
+ * shadows, and the status bar.
+ */
+template <class... Args>
+void BM_notificationShade(benchmark::State& benchState, Args&&... args) {
+    auto args_tuple = std::make_tuple(std::move(args)...);
+    auto re = createRenderEngine(static_cast<RenderEngine::Threaded>(std::get<0>(args_tuple)),
+                                 static_cast<RenderEngine::GraphicsApi>(std::get<1>(args_tuple)),
+                                 RenderEngine::BlurAlgorithm::KAWASE_DUAL_FILTER,
+                                 static_cast<RenderEngine::SkiaBackend>(std::get<2>(args_tuple)));
+
+    auto [width, height] = getDisplaySize();
+    auto srcBuffer = createTexture(*re, kHomescreenPath);
+    const float w = static_cast<float>(width);
+    const float h = static_cast<float>(height);
+
+    std::vector<LayerSettings> layers;
+    layers.push_back(LayerSettings{
+            .geometry = Geometry{.boundaries = FloatRect(0, 0, w, h)},
+            .source = PixelSource{.buffer = Buffer{.buffer = srcBuffer}},
+            .alpha = half(1.0f),
+    });
+    layers.push_back(LayerSettings{
+            .geometry = Geometry{.boundaries = FloatRect(0, 0, w, h)},
+            .source = PixelSource{.solidColor = half3(0.1f, 0.1f, 0.1f)},
+            .alpha = half(0.6f),
+            .backgroundBlurRadius = 60,
+    });
+
+    const float margin = w * 0.04f;
+    const float notificationHeight = h * 0.1f;
+    const vec2 cornerRadius(margin, margin);
+    for (int i = 0; i < 4; i++) {
+        const float top = h * 0.15f + static_cast<float>(i) * (notificationHeight + margin);
+        const FloatRect bounds(margin, top, w - margin, top + notificationHeight);
+        layers.push_back(LayerSettings{
+                .geometry = Geometry{.boundaries = bounds,
+                                     .roundedCornersRadius = cornerRadius,
+                                     .roundedCornersCrop = bounds},
+                .source = PixelSource{.solidColor = half3(0.9f, 0.9f, 0.9f)},
+                .alpha = half(1.0f),
+                .shadow = ShadowSettings{.boundaries = bounds,
+                                         .ambientColor = vec4(0.f, 0.f, 0.f, 0.05f),
+                                         .spotColor = vec4(0.f, 0.f, 0.f, 0.2f),
+                                         .lightPos = vec3(w / 2.f, 0.f, 1500.f),
+                                         .lightRadius = 800.f,
+                                         .length = 20.f},
+        });
+    }
+
+    layers.push_back(LayerSettings{
+            .geometry = Geometry{.boundaries = FloatRect(0, 0, w, h * 0.04f)},
+            .source = PixelSource{.solidColor = half3(0.f, 0.f, 0.f)},
+            .alpha = half(0.3f),
+    });
+
+    benchDrawLayers(*re, layers, benchState, "notification_shade");
+}
+
 BENCHMARK_CAPTURE(BM_homescreen_blur, gaussian, RenderEngine::Threaded::YES,
                   RenderEngine::GraphicsApi::GL, RenderEngine::BlurAlgorithm::GAUSSIAN);
 
@@ -323,3 +425,12 @@ BENCHMARK_CAPTURE(BM_homescreen, SkiaGLThreaded, RenderEngine::Threaded::YES,
 
 BENCHMARK_CAPTURE(BM_homescreen_edgeExtension, SkiaGLThreaded, RenderEngine::Threaded::YES,
                   RenderEngine::GraphicsApi::GL);
+
+BENCHMARK_CAPTURE(BM_notificationShade, SkiaGLThreaded, RenderEngine::Threaded::YES,
+                  RenderEngine::GraphicsApi::GL, RenderEngine::SkiaBackend::GANESH);
+
+BENCHMARK_CAPTURE(BM_notificationShade, GaneshVkThreaded, RenderEngine::Threaded::YES,
+                  RenderEngine::GraphicsApi::VK, RenderEngine::SkiaBackend::GANESH);
+
+BENCHMARK_CAPTURE(BM_notificationShade, GraphiteVkThreaded, RenderEngine::Threaded::YES,
+                  RenderEngine::GraphicsApi::VK, RenderEngine::SkiaBackend::GRAPHITE);
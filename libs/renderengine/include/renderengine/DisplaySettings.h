@@ -105,6 +105,19 @@ struct DisplaySettings {
 
     // For now, meaningful primarily when the TonemappingStrategy is Local
     float targetHdrSdrRatio = 1.f;
+
+    // How urgently the result of this draw is needed. This does not affect the output, but allows
+    // a threaded RenderEngine to run a queued draw for the next frame ahead of queued draws that
+    // are not on the critical path.
+    enum class Priority {
+        // Client composition of a display, which is needed for the next present.
+        Composition,
+        // Rendering of a CachedSet by the planner, which is done opportunistically.
+        CachedSet,
+        // Screenshots and region sampling.
+        Screenshot,
+    };
+    Priority priority = Priority::Composition;
 };
 
 static inline bool operator==(const DisplaySettings& lhs, const DisplaySettings& rhs) {
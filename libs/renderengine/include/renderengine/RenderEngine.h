@@ -54,6 +54,42 @@
  */
 #define PROPERTY_DEBUG_RENDERENGINE_BLUR_ALGORITHM "debug.renderengine.blur_algorithm"
 
+/**
+ * Limits the size, in megabytes, of the buffers that RenderEngine keeps imported as textures
+ * between draws. Least recently used textures are released once the limit is exceeded. Zero, the
+ * default, does not limit the cache.
+ */
+#define PROPERTY_DEBUG_RENDERENGINE_TEXTURE_CACHE_BUDGET_MB \
+    "debug.renderengine.texture_cache_budget_mb"
+
+/**
+ * Limits the size, in kilobytes, of the compiled shaders that RenderEngine keeps in memory and
+ * shares between its GPU contexts, so that a context does not compile a shader that another one
+ * already compiled. Defaults to 4096. Zero disables the cache.
+ */
+#define PROPERTY_DEBUG_RENDERENGINE_SHADER_CACHE_BUDGET_KB \
+    "debug.renderengine.shader_cache_budget_kb"
+
+/**
+ * Makes HDR tone mapping sample the tone curve from a small lookup table, which is rebuilt when
+ * the display or content luminance changes, instead of evaluating the curve for each pixel.
+ */
+#define PROPERTY_DEBUG_RENDERENGINE_TONEMAP_LUT "debug.renderengine.tonemap_lut"
+
+/**
+ * Number of images of an HDR layer that reuse the local luminance map of local tone mapping before
+ * it is recomputed. Larger values save GPU time during HDR video playback, at the cost of the tone
+ * mapping lagging behind scene changes. Defaults to 1, which recomputes it for every new image.
+ */
+#define PROPERTY_DEBUG_RENDERENGINE_LOCAL_TONEMAP_REFRESH_INTERVAL \
+    "debug.renderengine.local_tonemap_refresh_interval"
+
+/**
+ * Makes the Graphite backend compile the pipelines of the layers that the shader cache is primed
+ * for with Graphite's precompile API, on a background thread, instead of drawing those layers.
+ */
+#define PROPERTY_DEBUG_RENDERENGINE_GRAPHITE_PRECOMPILE "debug.renderengine.graphite_precompile"
+
 /**
  * Allows recording of Skia drawing commands with systrace.
  */
@@ -0,0 +1,101 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "BlurCache.h"
+
+#include <android-base/stringprintf.h>
+
+#include <algorithm>
+
+namespace android {
+namespace renderengine {
+namespace skia {
+
+namespace {
+
+bool isSameBuffer(const std::weak_ptr<ExternalTexture>& lhs,
+                  const std::weak_ptr<ExternalTexture>& rhs) {
+    return !lhs.owner_before(rhs) && !rhs.owner_before(lhs);
+}
+
+} // namespace
+
+BlurCache::Key::Key(const DisplaySettings& display, const SkImageInfo& outputInfo,
+                    bool isProtected, float maxLayerWhitePoint,
+                    const LayerSettings* layersBeneathBegin, const LayerSettings* layersBeneathEnd,
+                    uint32_t blurRadius, const SkRect& blurRect)
+      : mDisplay(display),
+        mOutputInfo(outputInfo),
+        mIsProtected(isProtected),
+        mMaxLayerWhitePoint(maxLayerWhitePoint),
+        mLayersBeneath(layersBeneathBegin, layersBeneathEnd),
+        mBlurRadius(blurRadius),
+        mBlurRect(blurRect) {
+    mBuffersBeneath.reserve(mLayersBeneath.size());
+    for (auto& layer : mLayersBeneath) {
+        mBuffersBeneath.push_back(std::move(layer.source.buffer.buffer));
+        layer.source.buffer.buffer = nullptr;
+    }
+}
+
+bool BlurCache::Key::operator==(const Key& other) const {
+    // DisplaySettings' operator== does not compare these, but they affect how layers are drawn.
+    if (mDisplay.tonemapStrategy != other.mDisplay.tonemapStrategy ||
+        mDisplay.targetHdrSdrRatio != other.mDisplay.targetHdrSdrRatio) {
+        return false;
+    }
+
+    return mDisplay == other.mDisplay && mOutputInfo == other.mOutputInfo &&
+            mIsProtected == other.mIsProtected &&
+            mMaxLayerWhitePoint == other.mMaxLayerWhitePoint &&
+            mBlurRadius == other.mBlurRadius && mBlurRect == other.mBlurRect &&
+            mLayersBeneath == other.mLayersBeneath &&
+            std::equal(mBuffersBeneath.begin(), mBuffersBeneath.end(),
+                       other.mBuffersBeneath.begin(), other.mBuffersBeneath.end(), isSameBuffer);
+}
+
+sk_sp<SkImage> BlurCache::get(const Key& key) {
+    const auto it = std::find_if(mEntries.begin(), mEntries.end(),
+                                 [&key](const Entry& entry) { return entry.key == key; });
+    if (it == mEntries.end()) {
+        mMissCount++;
+        return nullptr;
+    }
+
+    mHitCount++;
+    std::rotate(mEntries.begin(), it, std::next(it));
+    return mEntries.front().blurredImage;
+}
+
+void BlurCache::put(Key&& key, sk_sp<SkImage> blurredImage) {
+    mEntries.push_front({std::move(key), std::move(blurredImage)});
+    if (mEntries.size() > kMaxEntries) {
+        mEntries.pop_back();
+    }
+}
+
+void BlurCache::clear() {
+    mEntries.clear();
+}
+
+void BlurCache::dump(std::string& result) const {
+    base::StringAppendF(&result, "Blur cache: %zu entries, %zu hits, %zu misses\n",
+                        mEntries.size(), mHitCount, mMissCount);
+}
+
+} // namespace skia
+} // namespace renderengine
+} // namespace android
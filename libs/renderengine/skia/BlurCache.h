@@ -0,0 +1,89 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <SkImage.h>
+#include <SkImageInfo.h>
+#include <SkRect.h>
+#include <renderengine/DisplaySettings.h>
+#include <renderengine/ExternalTexture.h>
+#include <renderengine/LayerSettings.h>
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace android {
+namespace renderengine {
+namespace skia {
+
+// Keeps the output of BlurFilter::generate for the most recent blurs, so that a blur can be reused
+// by a later draw when everything that was drawn beneath it is unchanged, e.g. a static wallpaper
+// under the notification shade. Like the client composition cache in CompositionEngine, layers are
+// considered unchanged when their LayerSettings, including buffer and fence, compare equal.
+class BlurCache {
+public:
+    // Everything that determines the output of a blur.
+    class Key {
+    public:
+        Key(const DisplaySettings& display, const SkImageInfo& outputInfo, bool isProtected,
+            float maxLayerWhitePoint, const LayerSettings* layersBeneathBegin,
+            const LayerSettings* layersBeneathEnd, uint32_t blurRadius, const SkRect& blurRect);
+
+        bool operator==(const Key& other) const;
+
+    private:
+        DisplaySettings mDisplay;
+        SkImageInfo mOutputInfo;
+        bool mIsProtected;
+        // Affects the dimming of the layers beneath the blur.
+        float mMaxLayerWhitePoint;
+        // The layers beneath the blur, with their buffers held in mBuffersBeneath instead so that
+        // the cache does not keep them alive.
+        std::vector<LayerSettings> mLayersBeneath;
+        std::vector<std::weak_ptr<ExternalTexture>> mBuffersBeneath;
+        uint32_t mBlurRadius;
+        SkRect mBlurRect;
+    };
+
+    // Returns the blurred image generated for an equal key, or nullptr.
+    sk_sp<SkImage> get(const Key& key);
+    void put(Key&& key, sk_sp<SkImage> blurredImage);
+    void clear();
+
+    void dump(std::string& result) const;
+
+private:
+    // The blurred images are downscaled by BlurFilter::kInputScale, so a handful of them is cheap
+    // compared to the passes they save.
+    static constexpr size_t kMaxEntries = 4;
+
+    struct Entry {
+        Key key;
+        sk_sp<SkImage> blurredImage;
+    };
+    // Most recently used first.
+    std::deque<Entry> mEntries;
+
+    size_t mHitCount = 0;
+    size_t mMissCount = 0;
+};
+
+} // namespace skia
+} // namespace renderengine
+} // namespace android
@@ -0,0 +1,156 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "GraphitePrecompiler.h"
+
+#undef LOG_TAG
+#define LOG_TAG "RenderEngine"
+
+#include <SkBlendMode.h>
+#include <SkColorSpace.h>
+#include <android-base/stringprintf.h>
+#include <common/trace.h>
+#include <include/gpu/graphite/precompile/PaintOptions.h>
+#include <include/gpu/graphite/precompile/Precompile.h>
+#include <include/gpu/graphite/precompile/PrecompileColorFilter.h>
+#include <include/gpu/graphite/precompile/PrecompileImageFilter.h>
+#include <include/gpu/graphite/precompile/PrecompileRuntimeEffect.h>
+#include <include/gpu/graphite/precompile/PrecompileShader.h>
+#include <log/log_main.h>
+#include <pthread.h>
+
+#include <cinttypes>
+
+namespace android::renderengine::skia {
+
+using namespace skgpu::graphite;
+
+namespace {
+
+// Layers are drawn as rects, and as rrects when they have rounded corners or are clipped.
+constexpr DrawTypeFlags kLayerDrawTypes =
+        static_cast<DrawTypeFlags>(DrawTypeFlags::kSimpleShape | DrawTypeFlags::kNonSimpleShape);
+
+constexpr SkBlendMode kLayerBlendModes[] = {SkBlendMode::kSrcOver, SkBlendMode::kSrc};
+
+std::vector<RenderPassProperties> getRenderPasses() {
+    const sk_sp<SkColorSpace> srgb = SkColorSpace::MakeSRGB();
+    const sk_sp<SkColorSpace> displayP3 =
+            SkColorSpace::MakeRGB(SkNamedTransferFn::kSRGB, SkNamedGamut::kDisplayP3);
+    return {
+            {.fDstCT = kRGBA_8888_SkColorType, .fDstCS = srgb},
+            {.fDstCT = kRGBA_8888_SkColorType, .fDstCS = displayP3},
+            {.fDstCT = kRGBA_1010102_SkColorType, .fDstCS = displayP3},
+    };
+}
+
+// Returns a shader for the effect, whose children are all images.
+sk_sp<PrecompileShader> makeRuntimeEffectShader(const sk_sp<SkRuntimeEffect>& effect) {
+    const sk_sp<PrecompileShader> image = PrecompileShaders::Image();
+    const PrecompileChildPtr imageChild(image);
+    const std::vector<PrecompileChildOptions> children(effect->children().size(),
+                                                       PrecompileChildOptions(&imageChild, 1));
+    return PrecompileRuntimeEffects::MakePrecompileShader(effect, children);
+}
+
+PaintOptions makePaintOptions(sk_sp<PrecompileShader> shader, bool dimmed) {
+    PaintOptions options;
+    options.setShaders({&shader, 1});
+    if (dimmed) {
+        const sk_sp<PrecompileColorFilter> dimming = PrecompileColorFilters::Matrix();
+        options.setColorFilters({&dimming, 1});
+    }
+    options.setBlendModes(kLayerBlendModes);
+    return options;
+}
+
+std::vector<PaintOptions> getPaintOptions(const PrimeCacheConfig& config,
+                                          const GraphitePrecompiler::RuntimeEffects& effects) {
+    std::vector<PaintOptions> paintOptions;
+    if (config.cacheSolidLayers || config.cacheHolePunchLayer) {
+        paintOptions.push_back(makePaintOptions(PrecompileShaders::Color(), false));
+    }
+    if (config.cacheSolidDimmedLayers) {
+        paintOptions.push_back(makePaintOptions(PrecompileShaders::Color(), true));
+    }
+    if (config.cacheImageLayers || config.cachePIPImageLayers) {
+        paintOptions.push_back(makePaintOptions(PrecompileShaders::Image(), false));
+    }
+    if (config.cacheImageDimmedLayers || config.cacheTransparentImageDimmedLayers ||
+        config.cacheClippedDimmedImageLayers) {
+        paintOptions.push_back(makePaintOptions(PrecompileShaders::Image(), true));
+    }
+    if (!effects.blur.empty()) {
+        PaintOptions blur;
+        const sk_sp<PrecompileShader> image = PrecompileShaders::Image();
+        blur.setShaders({&image, 1});
+        const sk_sp<PrecompileImageFilter> blurFilter = PrecompileImageFilters::Blur(nullptr);
+        blur.setImageFilters({&blurFilter, 1});
+        paintOptions.push_back(std::move(blur));
+        for (const auto& effect : effects.blur) {
+            paintOptions.push_back(makePaintOptions(makeRuntimeEffectShader(effect), false));
+        }
+    }
+    if (config.cacheEdgeExtension && effects.edgeExtension != nullptr) {
+        paintOptions.push_back(
+                makePaintOptions(makeRuntimeEffectShader(effects.edgeExtension), false));
+    }
+    for (const auto& effect : effects.linear) {
+        paintOptions.push_back(makePaintOptions(makeRuntimeEffectShader(effect), true));
+    }
+    return paintOptions;
+}
+
+} // namespace
+
+GraphitePrecompiler::GraphitePrecompiler(std::unique_ptr<PrecompileContext> precompileContext,
+                                         const PrimeCacheConfig& config, RuntimeEffects effects)
+      : mPrecompileContext(std::move(precompileContext)),
+        mThread(&GraphitePrecompiler::run, this, config, std::move(effects)) {}
+
+GraphitePrecompiler::~GraphitePrecompiler() {
+    mStopping = true;
+    mThread.join();
+}
+
+void GraphitePrecompiler::run(PrimeCacheConfig config, RuntimeEffects effects) {
+    pthread_setname_np(pthread_self(), "RE-Precompile");
+    SFTRACE_NAME("GraphitePrecompiler");
+    const nsecs_t start = systemTime();
+    const std::vector<RenderPassProperties> renderPasses = getRenderPasses();
+    for (const PaintOptions& options : getPaintOptions(config, effects)) {
+        if (mStopping) {
+            break;
+        }
+        Precompile(mPrecompileContext.get(), options, kLayerDrawTypes, renderPasses);
+        mPaintOptionsPrecompiled++;
+        mDuration = systemTime() - start;
+    }
+    mDuration = systemTime() - start;
+    mDone = true;
+    ALOGD("Precompiled %d Graphite paint options in %" PRId64 " ms",
+          mPaintOptionsPrecompiled.load(), ns2ms(mDuration.load()));
+}
+
+void GraphitePrecompiler::dump(std::string& result) const {
+    base::StringAppendF(&result, "\n Graphite precompilation: %s\n",
+                        mDone ? "done" : (mStopping ? "stopped" : "running"));
+    base::StringAppendF(&result, "  Paint options precompiled: %d\n",
+                        mPaintOptionsPrecompiled.load());
+    base::StringAppendF(&result, "  Time spent: %" PRId64 " ms\n", ns2ms(mDuration.load()));
+}
+
+} // namespace android::renderengine::skia
@@ -0,0 +1,68 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <SkRuntimeEffect.h>
+#include <include/gpu/graphite/PrecompileContext.h>
+#include <renderengine/RenderEngine.h>
+#include <utils/Timers.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace android::renderengine::skia {
+
+/**
+ * Compiles the Graphite pipelines that RenderEngine draws with on a background thread, using
+ * Graphite's precompile API. Cache::primeShaderCache compiles pipelines by drawing each kind of
+ * layer, which is tuned for Ganesh and blocks RenderEngine while it runs; this instead enumerates
+ * the paint options of those layers (images, solid colors, blurs, dimming, edge extension and HDR)
+ * and compiles them without drawing.
+ */
+class GraphitePrecompiler {
+public:
+    // The runtime effects that RenderEngine draws with, which Graphite cannot enumerate itself.
+    struct RuntimeEffects {
+        std::vector<sk_sp<SkRuntimeEffect>> blur;
+        sk_sp<SkRuntimeEffect> edgeExtension;
+        std::vector<sk_sp<SkRuntimeEffect>> linear;
+    };
+
+    // Starts compiling the pipelines of the layers that the config enables.
+    GraphitePrecompiler(std::unique_ptr<skgpu::graphite::PrecompileContext> precompileContext,
+                        const PrimeCacheConfig& config, RuntimeEffects effects);
+    // Waits for the paint options being compiled, and skips the others.
+    ~GraphitePrecompiler();
+
+    void dump(std::string& result) const;
+
+private:
+    void run(PrimeCacheConfig config, RuntimeEffects effects);
+
+    const std::unique_ptr<skgpu::graphite::PrecompileContext> mPrecompileContext;
+    std::atomic<bool> mStopping = false;
+    std::atomic<bool> mDone = false;
+    // Number of paint options, each of which covers several pipelines, compiled so far.
+    std::atomic<int> mPaintOptionsPrecompiled = 0;
+    std::atomic<nsecs_t> mDuration = 0;
+    std::thread mThread;
+};
+
+} // namespace android::renderengine::skia
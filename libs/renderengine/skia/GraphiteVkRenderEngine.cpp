@@ -22,9 +22,11 @@
 #include <include/gpu/GpuTypes.h>
 #include <include/gpu/graphite/BackendSemaphore.h>
 #include <include/gpu/graphite/Context.h>
+#include <include/gpu/graphite/PrecompileContext.h>
 #include <include/gpu/graphite/Recording.h>
 #include <include/gpu/graphite/vk/VulkanGraphiteTypes.h>
 
+#include <android-base/properties.h>
 #include <log/log_main.h>
 #include <sync/sync.h>
 
@@ -139,4 +141,32 @@ base::unique_fd GraphiteVkRenderEngine::flushAndSubmit(SkiaGpuContext* context,
     return drawFenceFd;
 }
 
+bool GraphiteVkRenderEngine::precompilePipelines(const PrimeCacheConfig& config) {
+    if (!base::GetBoolProperty(PROPERTY_DEBUG_RENDERENGINE_GRAPHITE_PRECOMPILE, false)) {
+        return false;
+    }
+    std::unique_ptr<graphite::PrecompileContext> precompileContext =
+            getActiveContext()->graphiteContext()->makePrecompileContext();
+    if (precompileContext == nullptr) {
+        ALOGW("GraphiteVkRenderEngine::%s: could not create a precompile context", __func__);
+        return false;
+    }
+    mPrecompiler =
+            std::make_unique<GraphitePrecompiler>(std::move(precompileContext), config,
+                                                  GraphitePrecompiler::RuntimeEffects{
+                                                          .blur = getBlurRuntimeEffects(),
+                                                          .edgeExtension =
+                                                                  getEdgeExtensionRuntimeEffect(),
+                                                          .linear = getHdrRuntimeEffects(),
+                                                  });
+    return true;
+}
+
+void GraphiteVkRenderEngine::appendBackendSpecificInfoToDump(std::string& result) {
+    SkiaVkRenderEngine::appendBackendSpecificInfoToDump(result);
+    if (mPrecompiler != nullptr) {
+        mPrecompiler->dump(result);
+    }
+}
+
 } // namespace android::renderengine::skia
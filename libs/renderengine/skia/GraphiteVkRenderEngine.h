@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include "GraphitePrecompiler.h"
 #include "SkiaVkRenderEngine.h"
 
 #include <include/gpu/graphite/BackendSemaphore.h>
@@ -30,11 +31,15 @@ protected:
     std::unique_ptr<SkiaGpuContext> createContext(VulkanInterface& vulkanInterface) override;
     void waitFence(SkiaGpuContext* context, base::borrowed_fd fenceFd) override;
     base::unique_fd flushAndSubmit(SkiaGpuContext* context, sk_sp<SkSurface> dstSurface) override;
+    bool precompilePipelines(const PrimeCacheConfig& config) override;
+    void appendBackendSpecificInfoToDump(std::string& result) override;
 
 private:
     GraphiteVkRenderEngine(const RenderEngineCreationArgs& args) : SkiaVkRenderEngine(args) {}
 
     std::vector<graphite::BackendSemaphore> mStagedWaitSemaphores;
+    // Set once primeCache starts precompiling, see PROPERTY_DEBUG_RENDERENGINE_GRAPHITE_PRECOMPILE.
+    std::unique_ptr<GraphitePrecompiler> mPrecompiler;
 };
 
 } // namespace android::renderengine::skia
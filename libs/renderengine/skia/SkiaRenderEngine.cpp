@@ -49,6 +49,7 @@
 #include <SkString.h>
 #include <SkSurface.h>
 #include <SkTileMode.h>
+#include <android-base/properties.h>
 #include <android-base/stringprintf.h>
 #include <common/FlagManager.h>
 #include <common/trace.h>
@@ -64,7 +65,10 @@
 #include <ui/DebugUtils.h>
 #include <ui/GraphicBuffer.h>
 #include <ui/HdrRenderTypeUtils.h>
+#include <ui/PixelFormat.h>
+#include <utils/Timers.h>
 
+#include <algorithm>
 #include <cmath>
 #include <cstdint>
 #include <deque>
@@ -258,25 +262,136 @@ void trace(sp<Fence> fence) {
 using base::StringAppendF;
 
 std::future<void> SkiaRenderEngine::primeCache(PrimeCacheConfig config) {
-    Cache::primeShaderCache(this, config);
+    const nsecs_t timeBefore = systemTime();
+    const int shadersBefore = mSkSLCacheMonitor.totalShadersCompiled();
+    if (!precompilePipelines(config)) {
+        Cache::primeShaderCache(this, config);
+    }
+    mPrimeCacheDuration = systemTime() - timeBefore;
+    mShadersCompiledByPrimeCache = mSkSLCacheMonitor.totalShadersCompiled() - shadersBefore;
+    mSkSLCacheMonitor.onPrimeCacheComplete();
     return {};
 }
 
+std::vector<sk_sp<SkRuntimeEffect>> SkiaRenderEngine::getBlurRuntimeEffects() const {
+    return mBlurFilter != nullptr ? mBlurFilter->getRuntimeEffects()
+                                  : std::vector<sk_sp<SkRuntimeEffect>>();
+}
+
+sk_sp<SkRuntimeEffect> SkiaRenderEngine::getEdgeExtensionRuntimeEffect() const {
+    return mEdgeExtensionShaderFactory.getRuntimeEffect();
+}
+
+std::vector<sk_sp<SkRuntimeEffect>> SkiaRenderEngine::getHdrRuntimeEffects() const {
+    std::vector<sk_sp<SkRuntimeEffect>> effects;
+    for (const auto inputDataspace :
+         {ui::Dataspace::BT2020_ITU_PQ, ui::Dataspace::BT2020_ITU_HLG}) {
+        for (const auto outputDataspace :
+             {ui::Dataspace::DISPLAY_P3, ui::Dataspace::DISPLAY_BT2020}) {
+            for (const bool undoPremultipliedAlpha : {false, true}) {
+                effects.push_back(buildRuntimeEffect(
+                        shaders::LinearEffect{.inputDataspace = inputDataspace,
+                                              .outputDataspace = outputDataspace,
+                                              .undoPremultipliedAlpha = undoPremultipliedAlpha,
+                                              .useTonemapGainLut = mUseTonemapGainLut}));
+            }
+        }
+    }
+    return effects;
+}
+
+namespace {
+
+// Compiled shaders, shared by every SkSLCacheMonitor in the process. Once the budget is used up,
+// new shaders are no longer stored, which keeps those compiled by primeCache.
+class ShaderStore {
+public:
+    static ShaderStore& getInstance() {
+        static ShaderStore sInstance;
+        return sInstance;
+    }
+
+    sk_sp<SkData> load(const SkData& key) {
+        std::lock_guard lock(mMutex);
+        const auto it = mShaders.find(toString(key));
+        return it != mShaders.end() ? it->second : nullptr;
+    }
+
+    void store(const SkData& key, const SkData& data) {
+        std::lock_guard lock(mMutex);
+        const size_t bytes = key.size() + data.size();
+        if (mBytes + bytes > mBudgetBytes) {
+            return;
+        }
+        if (mShaders.try_emplace(toString(key), SkData::MakeWithCopy(data.data(), data.size()))
+                    .second) {
+            mBytes += bytes;
+        }
+    }
+
+    void dump(std::string& result) {
+        std::lock_guard lock(mMutex);
+        StringAppendF(&result, "RenderEngine process-wide shader cache: %zu shaders, %zu/%zu KB\n",
+                      mShaders.size(), mBytes / 1024, mBudgetBytes / 1024);
+    }
+
+private:
+    ShaderStore()
+          : mBudgetBytes(
+                    base::GetUintProperty<size_t>(PROPERTY_DEBUG_RENDERENGINE_SHADER_CACHE_BUDGET_KB,
+                                                  4096) *
+                    1024) {}
+
+    static std::string toString(const SkData& data) {
+        return std::string(static_cast<const char*>(data.data()), data.size());
+    }
+
+    std::mutex mMutex;
+    const size_t mBudgetBytes;
+    size_t mBytes GUARDED_BY(mMutex) = 0;
+    std::unordered_map<std::string, sk_sp<SkData>> mShaders GUARDED_BY(mMutex);
+};
+
+} // namespace
+
 sk_sp<SkData> SkiaRenderEngine::SkSLCacheMonitor::load(const SkData& key) {
-    // This "cache" does not actually cache anything. It just allows us to
-    // monitor Skia's internal cache. So this method always returns null.
-    return nullptr;
+    sk_sp<SkData> data = ShaderStore::getInstance().load(key);
+    if (data) {
+        mTotalShadersLoaded++;
+    }
+    return data;
 }
 
 void SkiaRenderEngine::SkSLCacheMonitor::store(const SkData& key, const SkData& data,
                                                const SkString& description) {
+    ShaderStore::getInstance().store(key, data);
     mShadersCachedSinceLastCall++;
     mTotalShadersCompiled++;
     SFTRACE_FORMAT("SF cache: %i shaders", mTotalShadersCompiled);
+
+    if (mPrimeCacheComplete) {
+        mShadersCompiledAfterPrimeCache++;
+        std::string shaderDescription(description.c_str(), description.size());
+        if (const auto it = mShadersCompiledAfterPrimeCacheByDescription.find(shaderDescription);
+            it != mShadersCompiledAfterPrimeCacheByDescription.end()) {
+            it->second++;
+        } else if (mShadersCompiledAfterPrimeCacheByDescription.size() < kMaxRecordedShaders) {
+            mShadersCompiledAfterPrimeCacheByDescription.emplace(std::move(shaderDescription), 1);
+        }
+    }
+}
+
+void SkiaRenderEngine::SkSLCacheMonitor::dumpShadersCompiledAfterPrimeCache(
+        std::string& result) const {
+    StringAppendF(&result, "RenderEngine shaders compiled after primeCache: %d\n",
+                  mShadersCompiledAfterPrimeCache);
+    for (const auto& [shaderDescription, count] : mShadersCompiledAfterPrimeCacheByDescription) {
+        StringAppendF(&result, "    %d x %s\n", count, shaderDescription.c_str());
+    }
 }
 
 int SkiaRenderEngine::reportShadersCompiled() {
-    return mSkSLCacheMonitor.totalShadersCompiled();
+    return mSkSLCacheMonitor.totalShadersCompiled() + mSkSLCacheMonitor.totalShadersLoaded();
 }
 
 void SkiaRenderEngine::setEnableTracing(bool tracingEnabled) {
@@ -285,7 +400,15 @@ void SkiaRenderEngine::setEnableTracing(bool tracingEnabled) {
 
 SkiaRenderEngine::SkiaRenderEngine(Threaded threaded, PixelFormat pixelFormat,
                                    BlurAlgorithm blurAlgorithm)
-      : RenderEngine(threaded), mDefaultPixelFormat(pixelFormat) {
+      : RenderEngine(threaded),
+        mDefaultPixelFormat(pixelFormat),
+        mTextureCacheBudgetBytes(
+                base::GetUintProperty<size_t>(PROPERTY_DEBUG_RENDERENGINE_TEXTURE_CACHE_BUDGET_MB,
+                                              0) *
+                1024 * 1024),
+        mUseTonemapGainLut(base::GetBoolProperty(PROPERTY_DEBUG_RENDERENGINE_TONEMAP_LUT, false)),
+        mLocalTonemapRefreshInterval(base::GetUintProperty<uint32_t>(
+                PROPERTY_DEBUG_RENDERENGINE_LOCAL_TONEMAP_REFRESH_INTERVAL, 1)) {
     switch (blurAlgorithm) {
         case BlurAlgorithm::GAUSSIAN: {
             ALOGD("Background Blurs Enabled (Gaussian algorithm)");
@@ -321,6 +444,7 @@ void SkiaRenderEngine::finishRenderingAndAbandonContexts() {
     if (mBlurFilter) {
         delete mBlurFilter;
     }
+    mBlurCache.clear();
 
     // Leftover textures may hold refs to backend-specific Skia contexts, which must be released
     // before ~SkiaGpuContext is called.
@@ -452,7 +576,44 @@ void SkiaRenderEngine::mapExternalTextureBuffer(const sp<GraphicBuffer>& buffer,
         auto imageTextureRef =
                 std::make_shared<AutoBackendTexture::LocalRef>(std::move(backendTexture),
                                                                mTextureCleanupMgr);
-        cache.insert({buffer->getId(), imageTextureRef});
+        insertIntoTextureCache(buffer, std::move(imageTextureRef));
+    }
+}
+
+static size_t estimateBufferBytes(const sp<GraphicBuffer>& buffer) {
+    const size_t pixels = static_cast<size_t>(buffer->getStride()) * buffer->getHeight();
+    const ssize_t pixelBytes = bytesPerPixel(buffer->getPixelFormat());
+    // bytesPerPixel does not know about YUV formats, which are mostly 4:2:0.
+    return pixelBytes > 0 ? pixels * static_cast<size_t>(pixelBytes) : pixels * 3 / 2;
+}
+
+void SkiaRenderEngine::insertIntoTextureCache(
+        const sp<GraphicBuffer>& buffer, std::shared_ptr<AutoBackendTexture::LocalRef> texture) {
+    const size_t bytes = estimateBufferBytes(buffer);
+    mTextureCache.insert_or_assign(buffer->getId(),
+                                   CachedTexture{.texture = std::move(texture),
+                                                 .bytes = bytes,
+                                                 .lastUse = ++mTextureCacheUseCount});
+    mTextureCacheBytes += bytes;
+
+    if (mTextureCacheBudgetBytes == 0) {
+        return;
+    }
+    while (mTextureCacheBytes > mTextureCacheBudgetBytes && mTextureCache.size() > 1) {
+        const auto lru = std::min_element(mTextureCache.begin(), mTextureCache.end(),
+                                          [](const auto& lhs, const auto& rhs) {
+                                              return lhs.second.lastUse < rhs.second.lastUse;
+                                          });
+        SFTRACE_FORMAT("Evicting texture for buffer 0x%" PRIx64, lru->first);
+        mTextureCacheEvictionCount++;
+        eraseFromTextureCache(lru->first);
+    }
+}
+
+void SkiaRenderEngine::eraseFromTextureCache(GraphicBufferId id) {
+    if (const auto it = mTextureCache.find(id); it != mTextureCache.end()) {
+        mTextureCacheBytes -= it->second.bytes;
+        mTextureCache.erase(it);
     }
 }
 
@@ -482,7 +643,7 @@ void SkiaRenderEngine::unmapExternalTextureBuffer(sp<GraphicBuffer>&& buffer) {
         useProtectedContext(buffer->getUsage() & GRALLOC_USAGE_PROTECTED);
 
         if (iter->second == 0) {
-            mTextureCache.erase(buffer->getId());
+            eraseFromTextureCache(buffer->getId());
             mGraphicBufferExternalRefs.erase(buffer->getId());
         }
 
@@ -499,13 +660,22 @@ std::shared_ptr<AutoBackendTexture::LocalRef> SkiaRenderEngine::getOrCreateBacke
     // Do not lookup the buffer in the cache for protected contexts
     if (!isProtected()) {
         if (const auto& it = mTextureCache.find(buffer->getId()); it != mTextureCache.end()) {
-            return it->second;
+            it->second.lastUse = ++mTextureCacheUseCount;
+            return it->second.texture;
         }
     }
     std::unique_ptr<SkiaBackendTexture> backendTexture =
             getActiveContext()->makeBackendTexture(buffer->toAHardwareBuffer(), isOutputBuffer);
-    return std::make_shared<AutoBackendTexture::LocalRef>(std::move(backendTexture),
-                                                          mTextureCleanupMgr);
+    auto texture = std::make_shared<AutoBackendTexture::LocalRef>(std::move(backendTexture),
+                                                                  mTextureCleanupMgr);
+
+    // A buffer that is still mapped but missing from the cache was evicted to stay within budget,
+    // so cache it again now that it is being drawn.
+    if (!isProtected() && mGraphicBufferExternalRefs.contains(buffer->getId())) {
+        mTextureCacheReimportCount++;
+        insertIntoTextureCache(buffer, texture);
+    }
+    return texture;
 }
 
 bool SkiaRenderEngine::canSkipPostRenderCleanup() const {
@@ -561,9 +731,14 @@ sk_sp<SkShader> SkiaRenderEngine::createRuntimeEffectShader(
         if (usingLocalTonemap) {
             const float inputRatio =
                     hdrType == HdrRenderType::GENERIC_HDR ? 1.0f : parameters.layerDimmingRatio;
-            static MouriMap kMapper;
+            static MouriMap kMapper(mLocalTonemapRefreshInterval);
+            // Layers are identified by name across frames, so that their luminance map can be
+            // reused for their next buffers.
+            const uint64_t sourceKey = parameters.layer.name.empty()
+                    ? 0
+                    : std::hash<std::string>{}(parameters.layer.name);
             shader = kMapper.mouriMap(getActiveContext(), shader, inputRatio,
-                                      parameters.display.targetHdrSdrRatio);
+                                      parameters.display.targetHdrSdrRatio, sourceKey);
         }
 
         // disable tonemapping if we already locally tonemapped
@@ -573,7 +748,20 @@ sk_sp<SkShader> SkiaRenderEngine::createRuntimeEffectShader(
                 shaders::LinearEffect{.inputDataspace = inputDataspace,
                                       .outputDataspace = parameters.outputDataSpace,
                                       .undoPremultipliedAlpha = parameters.undoPremultipliedAlpha,
-                                      .fakeOutputDataspace = parameters.fakeOutputDataspace};
+                                      .fakeOutputDataspace = parameters.fakeOutputDataspace,
+                                      .useTonemapGainLut = mUseTonemapGainLut};
+
+        const auto hardwareBuffer = graphicBuffer ? graphicBuffer->toAHardwareBuffer() : nullptr;
+        sk_sp<SkImage> tonemapGainLut;
+        if (effect.useTonemapGainLut) {
+            tonemapGainLut = getTonemapGainLut(effect, parameters.display.maxLuminance,
+                                               parameters.display.currentLuminanceNits,
+                                               parameters.layer.source.buffer.maxLuminanceNits,
+                                               hardwareBuffer, parameters.display.renderIntent);
+            // Without a table, e.g. because the tone curve is trivial, share the runtime effect
+            // that evaluates the curve.
+            effect.useTonemapGainLut = tonemapGainLut != nullptr;
+        }
 
         auto effectIter = mRuntimeEffects.find(effect);
         sk_sp<SkRuntimeEffect> runtimeEffect = nullptr;
@@ -592,16 +780,54 @@ sk_sp<SkShader> SkiaRenderEngine::createRuntimeEffectShader(
                                      parameters.layerDimmingRatio, 1.f));
         }
 
-        const auto hardwareBuffer = graphicBuffer ? graphicBuffer->toAHardwareBuffer() : nullptr;
         return createLinearEffectShader(shader, effect, runtimeEffect, std::move(colorTransform),
                                         parameters.display.maxLuminance,
                                         parameters.display.currentLuminanceNits,
                                         parameters.layer.source.buffer.maxLuminanceNits,
-                                        hardwareBuffer, parameters.display.renderIntent);
+                                        hardwareBuffer, parameters.display.renderIntent,
+                                        std::move(tonemapGainLut));
     }
     return shader;
 }
 
+sk_sp<SkImage> SkiaRenderEngine::getTonemapGainLut(
+        const shaders::LinearEffect& effect, float maxDisplayLuminance,
+        float currentDisplayLuminanceNits, float maxLuminance, AHardwareBuffer* buffer,
+        aidl::android::hardware::graphics::composer3::RenderIntent renderIntent) {
+    const auto it = std::find_if(mTonemapGainLuts.begin(), mTonemapGainLuts.end(),
+                                 [&](const TonemapGainLut& lut) {
+                                     return lut.inputDataspace == effect.inputDataspace &&
+                                             lut.outputDataspace == effect.outputDataspace &&
+                                             lut.maxDisplayLuminance == maxDisplayLuminance &&
+                                             lut.currentDisplayLuminanceNits ==
+                                             currentDisplayLuminanceNits &&
+                                             lut.maxLuminance == maxLuminance &&
+                                             lut.renderIntent == renderIntent;
+                                 });
+    if (it != mTonemapGainLuts.end()) {
+        TonemapGainLut lut = std::move(*it);
+        mTonemapGainLuts.erase(it);
+        mTonemapGainLuts.push_front(std::move(lut));
+        return mTonemapGainLuts.front().image;
+    }
+
+    sk_sp<SkImage> image = buildTonemapGainLutImage(
+            shaders::buildLinearEffectTonemapGainLut(effect, maxDisplayLuminance,
+                                                     currentDisplayLuminanceNits, maxLuminance,
+                                                     buffer, renderIntent));
+    mTonemapGainLuts.push_front({.inputDataspace = effect.inputDataspace,
+                                 .outputDataspace = effect.outputDataspace,
+                                 .maxDisplayLuminance = maxDisplayLuminance,
+                                 .currentDisplayLuminanceNits = currentDisplayLuminanceNits,
+                                 .maxLuminance = maxLuminance,
+                                 .renderIntent = renderIntent,
+                                 .image = image});
+    if (mTonemapGainLuts.size() > kMaxTonemapGainLuts) {
+        mTonemapGainLuts.pop_back();
+    }
+    return image;
+}
+
 void SkiaRenderEngine::initCanvas(SkCanvas* canvas, const DisplaySettings& display) {
     if (CC_UNLIKELY(mCapture->isCaptureRunning())) {
         // Record display settings when capture is running.
@@ -797,6 +1023,10 @@ void SkiaRenderEngine::drawLayersInternal(
         }
     }
 
+    // Captures should record every blur pass, so do not reuse blurs while one is running.
+    const bool cacheBlurs = mBlurFilter && FlagManager::getInstance().cache_background_blur() &&
+            !mCapture->isCaptureRunning();
+
     AutoSaveRestore surfaceAutoSaveRestore(canvas);
     // Clear the entire canvas with a transparent black to prevent ghost images.
     canvas->clear(SK_ColorTRANSPARENT);
@@ -897,12 +1127,26 @@ void SkiaRenderEngine::drawLayersInternal(
                 canvas->clipRRect(roundRectClip, true);
             }
 
+            const auto generateBlur = [&](uint32_t blurRadius) REQUIRES(mRenderingMutex) {
+                if (!cacheBlurs) {
+                    return mBlurFilter->generate(context, blurRadius, blurInput, blurRect);
+                }
+                BlurCache::Key key(display, dstSurface->imageInfo(), mInProtectedContext,
+                                   maxLayerWhitePoint, layers.data(), &layer, blurRadius,
+                                   blurRect);
+                if (auto blurredImage = mBlurCache.get(key)) {
+                    return blurredImage;
+                }
+                auto blurredImage = mBlurFilter->generate(context, blurRadius, blurInput, blurRect);
+                mBlurCache.put(std::move(key), blurredImage);
+                return blurredImage;
+            };
+
             // TODO(b/182216890): Filter out empty layers earlier
             if (blurRect.width() > 0 && blurRect.height() > 0) {
                 if (layer.backgroundBlurRadius > 0) {
                     SFTRACE_NAME("BackgroundBlur");
-                    auto blurredImage = mBlurFilter->generate(context, layer.backgroundBlurRadius,
-                                                              blurInput, blurRect);
+                    auto blurredImage = generateBlur(layer.backgroundBlurRadius);
 
                     cachedBlurs[layer.backgroundBlurRadius] = blurredImage;
 
@@ -914,9 +1158,7 @@ void SkiaRenderEngine::drawLayersInternal(
                 for (auto region : layer.blurRegions) {
                     if (cachedBlurs[region.blurRadius] == nullptr) {
                         SFTRACE_NAME("BlurRegion");
-                        cachedBlurs[region.blurRadius] =
-                                mBlurFilter->generate(context, region.blurRadius, blurInput,
-                                                      blurRect);
+                        cachedBlurs[region.blurRadius] = generateBlur(region.blurRadius);
                     }
 
                     mBlurFilter->drawBlurRegion(canvas, getBlurRRect(region), region.blurRadius,
@@ -1298,6 +1540,14 @@ void SkiaRenderEngine::dump(std::string& result) {
     StringAppendF(&result, "RenderEngine is in protected context: %d\n", mInProtectedContext);
     StringAppendF(&result, "RenderEngine shaders cached since last dump/primeCache: %d\n",
                   mSkSLCacheMonitor.shadersCachedSinceLastCall());
+    StringAppendF(&result, "RenderEngine primeCache compiled %d shaders in %.2f ms\n",
+                  mShadersCompiledByPrimeCache, static_cast<float>(mPrimeCacheDuration) / 1e6f);
+    mSkSLCacheMonitor.dumpShadersCompiledAfterPrimeCache(result);
+    StringAppendF(&result, "RenderEngine shaders loaded from the process-wide cache: %d\n",
+                  mSkSLCacheMonitor.totalShadersLoaded());
+    ShaderStore::getInstance().dump(result);
+    StringAppendF(&result, "RenderEngine process-wide runtime effects: %zu\n",
+                  getCachedRuntimeEffectCount());
 
     std::vector<ResourcePair> cpuResourceMap = {
             {"skia/sk_resource_cache/bitmap_", "Bitmaps"},
@@ -1337,12 +1587,18 @@ void SkiaRenderEngine::dump(std::string& result) {
         }
         StringAppendF(&result, "RenderEngine AHB/BackendTexture cache size: %zu\n",
                       mTextureCache.size());
+        StringAppendF(&result,
+                      "RenderEngine AHB/BackendTexture cache bytes: %zu (budget %zu), evictions: "
+                      "%zu, re-imports: %zu\n",
+                      mTextureCacheBytes, mTextureCacheBudgetBytes, mTextureCacheEvictionCount,
+                      mTextureCacheReimportCount);
         StringAppendF(&result, "Dumping buffer ids...\n");
         // TODO(178539829): It would be nice to know which layer these are coming from and what
         // the texture sizes are.
         for (const auto& [id, unused] : mTextureCache) {
             StringAppendF(&result, "- 0x%" PRIx64 "\n", id);
         }
+        mBlurCache.dump(result);
         StringAppendF(&result, "\n");
 
         SkiaMemoryReporter gpuProtectedReporter(gpuResourceMap, true);
@@ -1368,7 +1624,11 @@ void SkiaRenderEngine::dump(std::string& result) {
                                   .c_str());
             StringAppendF(&result, "undoPremultipliedAlpha: %s\n",
                           linearEffect.undoPremultipliedAlpha ? "true" : "false");
+            StringAppendF(&result, "useTonemapGainLut: %s\n",
+                          linearEffect.useTonemapGainLut ? "true" : "false");
         }
+        StringAppendF(&result, "RenderEngine tone mapping lookup tables: %zu\n",
+                      mTonemapGainLuts.size());
     }
     StringAppendF(&result, "\n");
 }
@@ -28,11 +28,15 @@
 #include <renderengine/RenderEngine.h>
 #include <sys/types.h>
 
+#include <deque>
+#include <map>
 #include <memory>
 #include <mutex>
+#include <string>
 #include <unordered_map>
 
 #include "AutoBackendTexture.h"
+#include "BlurCache.h"
 #include "android-base/macros.h"
 #include "compat/SkiaGpuContext.h"
 #include "debug/SkiaCapture.h"
@@ -68,6 +72,8 @@ public:
         return mBlurFilter != nullptr;
     }
     void onActiveDisplaySizeChanged(ui::Size size) override final;
+    // Includes the shaders loaded from the process-wide shader cache, which this context would
+    // otherwise have compiled.
     int reportShadersCompiled();
 
     virtual void setEnableTracing(bool tracingEnabled) override final;
@@ -92,6 +98,15 @@ protected:
     virtual base::unique_fd flushAndSubmit(SkiaGpuContext* context,
                                            sk_sp<SkSurface> dstSurface) = 0;
     virtual void appendBackendSpecificInfoToDump(std::string& result) = 0;
+    // Starts compiling the pipelines that the config enables, which primeCache then does not draw.
+    // Returns false if the backend does not support it.
+    virtual bool precompilePipelines(const PrimeCacheConfig&) { return false; }
+
+    // The runtime effects that layers are drawn with, for backends that precompile them.
+    std::vector<sk_sp<SkRuntimeEffect>> getBlurRuntimeEffects() const;
+    sk_sp<SkRuntimeEffect> getEdgeExtensionRuntimeEffect() const;
+    // Returns the effects of tone mapping common HDR content to wide color displays.
+    std::vector<sk_sp<SkRuntimeEffect>> getHdrRuntimeEffects() const;
 
     size_t getMaxTextureSize() const override final;
     size_t getMaxViewportDims() const override final;
@@ -101,7 +116,9 @@ protected:
     bool isProtected() const { return mInProtectedContext; }
 
     // Implements PersistentCache as a way to monitor what SkSL shaders Skia has
-    // cached.
+    // cached. The compiled shaders are also kept in memory, up to
+    // PROPERTY_DEBUG_RENDERENGINE_SHADER_CACHE_BUDGET_KB, and shared by every context in the
+    // process, so that a context created later, e.g. a protected one, does not compile them again.
     class SkSLCacheMonitor : public GrContextOptions::PersistentCache {
     public:
         SkSLCacheMonitor() = default;
@@ -118,14 +135,33 @@ protected:
         }
 
         int totalShadersCompiled() const { return mTotalShadersCompiled; }
+        int totalShadersLoaded() const { return mTotalShadersLoaded; }
+
+        // Called once primeCache has finished. Any shader compiled afterwards is one that
+        // primeCache did not cover, so its description is recorded for the dump.
+        void onPrimeCacheComplete() { mPrimeCacheComplete = true; }
+
+        void dumpShadersCompiledAfterPrimeCache(std::string& result) const;
 
     private:
+        // Bounds the memory used to record shaders missed by primeCache.
+        static constexpr size_t kMaxRecordedShaders = 32;
+
         int mShadersCachedSinceLastCall = 0;
         int mTotalShadersCompiled = 0;
+        int mTotalShadersLoaded = 0;
+        bool mPrimeCacheComplete = false;
+        int mShadersCompiledAfterPrimeCache = 0;
+        // Shader description to the number of times it was compiled after primeCache.
+        std::map<std::string, int> mShadersCompiledAfterPrimeCacheByDescription;
     };
 
     SkSLCacheMonitor mSkSLCacheMonitor;
 
+    // How long primeCache took, and how many shaders it compiled.
+    nsecs_t mPrimeCacheDuration = 0;
+    int mShadersCompiledByPrimeCache = 0;
+
 private:
     void mapExternalTextureBuffer(const sp<GraphicBuffer>& buffer,
                                   bool isRenderable) override final;
@@ -176,10 +212,57 @@ private:
     // Number of external holders of ExternalTexture references, per GraphicBuffer ID.
     std::unordered_map<GraphicBufferId, int32_t> mGraphicBufferExternalRefs
             GUARDED_BY(mRenderingMutex);
-    std::unordered_map<GraphicBufferId, std::shared_ptr<AutoBackendTexture::LocalRef>> mTextureCache
-            GUARDED_BY(mRenderingMutex);
+    struct CachedTexture {
+        std::shared_ptr<AutoBackendTexture::LocalRef> texture;
+        size_t bytes = 0;
+        // Value of mTextureCacheUseCount when the texture was last used.
+        uint64_t lastUse = 0;
+    };
+    std::unordered_map<GraphicBufferId, CachedTexture> mTextureCache GUARDED_BY(mRenderingMutex);
+
+    // Adds a texture to mTextureCache, then evicts the least recently used textures other than
+    // this one while the cache exceeds mTextureCacheBudgetBytes.
+    void insertIntoTextureCache(const sp<GraphicBuffer>& buffer,
+                                std::shared_ptr<AutoBackendTexture::LocalRef> texture)
+            REQUIRES(mRenderingMutex);
+    void eraseFromTextureCache(GraphicBufferId id) REQUIRES(mRenderingMutex);
+
+    // Zero if the cache is unbounded.
+    const size_t mTextureCacheBudgetBytes;
+    size_t mTextureCacheBytes GUARDED_BY(mRenderingMutex) = 0;
+    uint64_t mTextureCacheUseCount GUARDED_BY(mRenderingMutex) = 0;
+    // Textures evicted while their buffer was still mapped, and how many of those were imported
+    // again because they were drawn.
+    size_t mTextureCacheEvictionCount GUARDED_BY(mRenderingMutex) = 0;
+    size_t mTextureCacheReimportCount GUARDED_BY(mRenderingMutex) = 0;
     std::unordered_map<shaders::LinearEffect, sk_sp<SkRuntimeEffect>, shaders::LinearEffectHasher>
             mRuntimeEffects;
+
+    // Whether LinearEffects sample the tone curve from a lookup table, see
+    // PROPERTY_DEBUG_RENDERENGINE_TONEMAP_LUT.
+    const bool mUseTonemapGainLut;
+    const uint32_t mLocalTonemapRefreshInterval;
+    // A tone mapping lookup table, and the inputs it was built for.
+    struct TonemapGainLut {
+        ui::Dataspace inputDataspace;
+        ui::Dataspace outputDataspace;
+        float maxDisplayLuminance;
+        float currentDisplayLuminanceNits;
+        float maxLuminance;
+        aidl::android::hardware::graphics::composer3::RenderIntent renderIntent;
+        // nullptr if the tone mapper has no table for the dataspaces.
+        sk_sp<SkImage> image;
+    };
+    // Most recently used first. The tables only change with the display brightness and the HDR
+    // content on screen, so a few of them cover every frame.
+    static constexpr size_t kMaxTonemapGainLuts = 8;
+    std::deque<TonemapGainLut> mTonemapGainLuts;
+    // Returns the lookup table for the effect, building it if it isn't cached, or nullptr if the
+    // tone mapper has none for the effect's dataspaces.
+    sk_sp<SkImage> getTonemapGainLut(
+            const shaders::LinearEffect& effect, float maxDisplayLuminance,
+            float currentDisplayLuminanceNits, float maxLuminance, AHardwareBuffer* buffer,
+            aidl::android::hardware::graphics::composer3::RenderIntent renderIntent);
     AutoBackendTexture::CleanupManager mTextureCleanupMgr GUARDED_BY(mRenderingMutex);
 
     StretchShaderFactory mStretchShaderFactory;
@@ -187,6 +270,8 @@ private:
 
     sp<Fence> mLastDrawFence;
     BlurFilter* mBlurFilter = nullptr;
+    // Only used with FlagManager::cache_background_blur.
+    BlurCache mBlurCache GUARDED_BY(mRenderingMutex);
 
     // Object to capture commands send to Skia.
     std::unique_ptr<SkiaCapture> mCapture;
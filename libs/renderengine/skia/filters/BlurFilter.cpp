@@ -75,6 +75,13 @@ float BlurFilter::getMaxCrossFadeRadius() const {
     return mMaxCrossFadeRadius;
 }
 
+std::vector<sk_sp<SkRuntimeEffect>> BlurFilter::getRuntimeEffects() const {
+    if (mMixEffect == nullptr) {
+        return {};
+    }
+    return {mMixEffect};
+}
+
 void BlurFilter::drawBlurRegion(SkCanvas* canvas, const SkRRect& effectRegion,
                                 const uint32_t blurRadius, const float blurAlpha,
                                 const SkRect& blurRect, sk_sp<SkImage> blurredImage,
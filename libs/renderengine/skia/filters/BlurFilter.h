@@ -21,6 +21,8 @@
 #include <SkRuntimeEffect.h>
 #include <SkSurface.h>
 
+#include <vector>
+
 #include "../compat/SkiaGpuContext.h"
 
 using namespace std;
@@ -61,6 +63,9 @@ public:
 
     float getMaxCrossFadeRadius() const;
 
+    // Returns the runtime effects that the filter draws with, for precompiling them.
+    virtual std::vector<sk_sp<SkRuntimeEffect>> getRuntimeEffects() const;
+
 private:
     // To avoid downscaling artifacts, we interpolate the blurred fbo with the full composited
     // image, up to this radius.
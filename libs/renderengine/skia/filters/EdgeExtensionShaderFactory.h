@@ -38,6 +38,9 @@ public:
     sk_sp<SkShader> createSkShader(const sk_sp<SkShader>& inputShader, const LayerSettings& layer,
                                    const SkRect& imageBounds) const;
 
+    // Returns the runtime effect that the shaders are made from, for precompiling it.
+    sk_sp<SkRuntimeEffect> getRuntimeEffect() const { return mResult->effect; }
+
 private:
     std::unique_ptr<const SkRuntimeEffect::Result> mResult;
 };
@@ -168,6 +168,12 @@ sk_sp<SkImage> KawaseBlurDualFilter::generate(SkiaGpuContext* context, const uin
     return surfaces[0]->makeImageSnapshot();
 }
 
+std::vector<sk_sp<SkRuntimeEffect>> KawaseBlurDualFilter::getRuntimeEffects() const {
+    auto effects = BlurFilter::getRuntimeEffects();
+    effects.push_back(mBlurEffect);
+    return effects;
+}
+
 } // namespace skia
 } // namespace renderengine
 } // namespace android
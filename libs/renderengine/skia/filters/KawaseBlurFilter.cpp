@@ -134,6 +134,12 @@ sk_sp<SkImage> KawaseBlurFilter::generate(SkiaGpuContext* context, const uint32_
     return tmpBlur;
 }
 
+std::vector<sk_sp<SkRuntimeEffect>> KawaseBlurFilter::getRuntimeEffects() const {
+    auto effects = BlurFilter::getRuntimeEffects();
+    effects.push_back(mBlurEffect);
+    return effects;
+}
+
 } // namespace skia
 } // namespace renderengine
 } // namespace android
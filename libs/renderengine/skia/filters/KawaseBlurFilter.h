@@ -45,6 +45,8 @@ public:
     sk_sp<SkImage> generate(SkiaGpuContext* context, const uint32_t radius,
                             const sk_sp<SkImage> blurInput, const SkRect& blurRect) const override;
 
+    std::vector<sk_sp<SkRuntimeEffect>> getRuntimeEffects() const override;
+
 private:
     sk_sp<SkRuntimeEffect> mBlurEffect;
 };
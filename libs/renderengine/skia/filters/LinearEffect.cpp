@@ -18,38 +18,78 @@
 
 #define ATRACE_TAG ATRACE_TAG_GRAPHICS
 
+#include <SkBitmap.h>
+#include <SkImage.h>
+#include <SkPixmap.h>
+#include <SkSamplingOptions.h>
 #include <SkString.h>
+#include <SkTileMode.h>
+#include <android-base/thread_annotations.h>
 #include <common/trace.h>
 #include <log/log.h>
 #include <shaders/shaders.h>
 
 #include <math/mat4.h>
 
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
 namespace android {
 namespace renderengine {
 namespace skia {
 
+namespace {
+
+// SkRuntimeEffects do not depend on a GPU context, so they are shared by every RenderEngine in the
+// process, whatever its backend, and outlive them. They are keyed by their source, which several
+// LinearEffects may share.
+std::mutex sRuntimeEffectsMutex;
+std::unordered_map<std::string, sk_sp<SkRuntimeEffect>> sRuntimeEffects
+        GUARDED_BY(sRuntimeEffectsMutex);
+
+} // namespace
+
 sk_sp<SkRuntimeEffect> buildRuntimeEffect(const shaders::LinearEffect& linearEffect) {
     SFTRACE_CALL();
-    SkString shaderString = SkString(shaders::buildLinearEffectSkSL(linearEffect));
+    std::string shaderString = shaders::buildLinearEffectSkSL(linearEffect);
 
-    auto [shader, error] = SkRuntimeEffect::MakeForShader(shaderString);
+    std::lock_guard lock(sRuntimeEffectsMutex);
+    if (const auto it = sRuntimeEffects.find(shaderString); it != sRuntimeEffects.end()) {
+        return it->second;
+    }
+
+    auto [shader, error] = SkRuntimeEffect::MakeForShader(SkString(shaderString));
     if (!shader) {
         LOG_ALWAYS_FATAL("LinearColorFilter construction error: %s", error.c_str());
     }
+    sRuntimeEffects.emplace(std::move(shaderString), shader);
     return shader;
 }
 
+size_t getCachedRuntimeEffectCount() {
+    std::lock_guard lock(sRuntimeEffectsMutex);
+    return sRuntimeEffects.size();
+}
+
 sk_sp<SkShader> createLinearEffectShader(
         sk_sp<SkShader> shader, const shaders::LinearEffect& linearEffect,
         sk_sp<SkRuntimeEffect> runtimeEffect, const mat4& colorTransform, float maxDisplayLuminance,
         float currentDisplayLuminanceNits, float maxLuminance, AHardwareBuffer* buffer,
-        aidl::android::hardware::graphics::composer3::RenderIntent renderIntent) {
+        aidl::android::hardware::graphics::composer3::RenderIntent renderIntent,
+        sk_sp<SkImage> tonemapGainLut) {
     SFTRACE_CALL();
     SkRuntimeShaderBuilder effectBuilder(runtimeEffect);
 
     effectBuilder.child("child") = shader;
 
+    if (runtimeEffect->findChild(tonemap::ToneMapper::kGainLutChildName)) {
+        LOG_ALWAYS_FATAL_IF(!tonemapGainLut, "Missing tone mapping lookup table");
+        effectBuilder.child(tonemap::ToneMapper::kGainLutChildName) =
+                tonemapGainLut->makeRawShader(SkTileMode::kClamp, SkTileMode::kClamp,
+                                              SkSamplingOptions(SkFilterMode::kLinear));
+    }
+
     const auto uniforms =
             shaders::buildLinearEffectUniforms(linearEffect, colorTransform, maxDisplayLuminance,
                                                currentDisplayLuminanceNits, maxLuminance, buffer,
@@ -62,6 +102,34 @@ sk_sp<SkShader> createLinearEffectShader(
     return effectBuilder.makeShader();
 }
 
+sk_sp<SkImage> buildTonemapGainLutImage(const std::vector<float>& gains) {
+    SFTRACE_CALL();
+    if (gains.empty()) {
+        return nullptr;
+    }
+
+    std::vector<float> pixels;
+    pixels.reserve(gains.size() * 4);
+    for (const float gain : gains) {
+        pixels.insert(pixels.end(), {gain, gain, gain, 1.f});
+    }
+
+    // Half floats are precise enough for gains, and can be sampled with linear filtering on any
+    // GPU, unlike full floats.
+    const int width = static_cast<int>(gains.size());
+    const SkImageInfo srcInfo =
+            SkImageInfo::Make(width, 1, kRGBA_F32_SkColorType, kUnpremul_SkAlphaType);
+    SkBitmap bitmap;
+    if (!bitmap.tryAllocPixels(
+                SkImageInfo::Make(width, 1, kRGBA_F16_SkColorType, kUnpremul_SkAlphaType)) ||
+        !bitmap.writePixels(SkPixmap(srcInfo, pixels.data(), srcInfo.minRowBytes()))) {
+        ALOGE("Failed to allocate tone mapping lookup table");
+        return nullptr;
+    }
+    bitmap.setImmutable();
+    return SkImages::RasterFromBitmap(bitmap);
+}
+
 } // namespace skia
 } // namespace renderengine
 } // namespace android
@@ -19,8 +19,10 @@
 #include <math/mat4.h>
 
 #include <optional>
+#include <vector>
 
 #include <shaders/shaders.h>
+#include "SkImage.h"
 #include "SkRuntimeEffect.h"
 #include "SkShader.h"
 #include "ui/GraphicTypes.h"
@@ -29,8 +31,13 @@ namespace android {
 namespace renderengine {
 namespace skia {
 
+// Returns the runtime effect for a LinearEffect. Runtime effects are cached process-wide, so the
+// SkSL of each shader is only compiled once per process.
 sk_sp<SkRuntimeEffect> buildRuntimeEffect(const shaders::LinearEffect& linearEffect);
 
+// Returns how many runtime effects buildRuntimeEffect has cached.
+size_t getCachedRuntimeEffectCount();
+
 // Generates a shader resulting from applying the a linear effect created from
 // LinearEffectArgs::buildEffect to an inputShader.
 // Optionally, a color transform may also be provided, which combines with the
@@ -44,11 +51,17 @@ sk_sp<SkRuntimeEffect> buildRuntimeEffect(const shaders::LinearEffect& linearEff
 // communicating any HDR metadata.
 // * A RenderIntent that communicates the downstream renderintent for a physical display, for image
 // quality compensation.
+// * The tone mapping lookup table built by buildTonemapGainLutImage, if the effect samples one.
 sk_sp<SkShader> createLinearEffectShader(
         sk_sp<SkShader> inputShader, const shaders::LinearEffect& linearEffect,
         sk_sp<SkRuntimeEffect> runtimeEffect, const mat4& colorTransform, float maxDisplayLuminance,
         float currentDisplayLuminanceNits, float maxLuminance, AHardwareBuffer* buffer,
-        aidl::android::hardware::graphics::composer3::RenderIntent renderIntent);
+        aidl::android::hardware::graphics::composer3::RenderIntent renderIntent,
+        sk_sp<SkImage> tonemapGainLut = nullptr);
+
+// Uploads a table returned by shaders::buildLinearEffectTonemapGainLut into an image. Returns
+// nullptr if the table is empty or could not be allocated.
+sk_sp<SkImage> buildTonemapGainLutImage(const std::vector<float>& gains);
 } // namespace skia
 } // namespace renderengine
 } // namespace android
@@ -19,6 +19,8 @@
 #include <SkPaint.h>
 #include <SkTileMode.h>
 
+#include <algorithm>
+
 namespace android {
 namespace renderengine {
 namespace skia {
@@ -109,17 +111,59 @@ sk_sp<SkImage> makeImage(SkSurface* surface, const SkRuntimeShaderBuilder& build
 
 } // namespace
 
-MouriMap::MouriMap()
+MouriMap::MouriMap(uint32_t refreshInterval)
       : mCrosstalkAndChunk16x16(makeEffect(kCrosstalkAndChunk16x16)),
         mChunk8x8(makeEffect(kChunk8x8)),
         mBlur(makeEffect(kBlur)),
-        mTonemap(makeEffect(kTonemap)) {}
+        mTonemap(makeEffect(kTonemap)),
+        mRefreshInterval(std::max(1u, refreshInterval)) {}
 
 sk_sp<SkShader> MouriMap::mouriMap(SkiaGpuContext* context, sk_sp<SkShader> input,
-                                   float hdrSdrRatio, float targetHdrSdrRatio) {
+                                   float hdrSdrRatio, float targetHdrSdrRatio,
+                                   uint64_t sourceKey) {
+    auto localLux = getLocalLux(context, input, hdrSdrRatio, sourceKey);
+    return tonemap(input, localLux.get(), hdrSdrRatio, targetHdrSdrRatio);
+}
+
+sk_sp<SkImage> MouriMap::getLocalLux(SkiaGpuContext* context, sk_sp<SkShader> input,
+                                     float hdrSdrRatio, uint64_t sourceKey) {
+    SkMatrix matrix;
+    SkImage* image = input->isAImage(&matrix, (SkTileMode*)nullptr);
+    // Buffers are recycled with new contents, so the map cannot be kept for an image, only for a
+    // number of images of the same source.
+    const auto it = std::find_if(mLocalLux.begin(), mLocalLux.end(), [&](const LocalLux& lux) {
+        return sourceKey != 0 && lux.context == context && lux.sourceKey == sourceKey &&
+                lux.imageSize == image->dimensions() && lux.matrix == matrix &&
+                lux.hdrSdrRatio == hdrSdrRatio && lux.reuseCount + 1 < mRefreshInterval;
+    });
+    if (it != mLocalLux.end()) {
+        LocalLux lux = std::move(*it);
+        mLocalLux.erase(it);
+        lux.reuseCount++;
+        mLocalLux.push_front(std::move(lux));
+        return mLocalLux.front().image;
+    }
+
     auto downchunked = downchunk(context, input, hdrSdrRatio);
     auto localLux = blur(context, downchunked.get());
-    return tonemap(input, localLux.get(), hdrSdrRatio, targetHdrSdrRatio);
+    if (sourceKey == 0 || mRefreshInterval == 1) {
+        return localLux;
+    }
+    // Replace the stale map of the same source rather than evicting another source's.
+    std::erase_if(mLocalLux, [&](const LocalLux& lux) {
+        return lux.context == context && lux.sourceKey == sourceKey;
+    });
+    if (mLocalLux.size() >= kMaxLocalLux) {
+        mLocalLux.pop_back();
+    }
+    mLocalLux.push_front({.context = context,
+                          .sourceKey = sourceKey,
+                          .imageSize = image->dimensions(),
+                          .matrix = matrix,
+                          .hdrSdrRatio = hdrSdrRatio,
+                          .reuseCount = 0,
+                          .image = localLux});
+    return localLux;
 }
 
 sk_sp<SkImage> MouriMap::downchunk(SkiaGpuContext* context, sk_sp<SkShader> input,
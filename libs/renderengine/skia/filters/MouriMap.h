@@ -15,8 +15,10 @@
  */
 #pragma once
 #include <SkImage.h>
+#include <SkMatrix.h>
 #include <SkRuntimeEffect.h>
 #include <SkShader.h>
+#include <deque>
 #include "../compat/SkiaGpuContext.h"
 namespace android {
 namespace renderengine {
@@ -57,16 +59,22 @@ namespace skia {
  * typically not suitable to be ran "frequently", at high refresh rates (e.g., 120hz). However,
  * MouriMap is sufficiently fast enough for infrequent composition where preserving SDR detail is
  * most important, such as for screenshots.
+ *
+ * To reduce that cost for HDR video, a refresh interval larger than 1 keeps the blurred luminance
+ * map from (2) for each source, and reuses it for the next images of the same source, recomputing
+ * it only once every that many images. This trades accuracy on fast-changing content for GPU time.
  */
 class MouriMap {
 public:
-    MouriMap();
+    explicit MouriMap(uint32_t refreshInterval = 1);
     // Apply the MouriMap tonemmaping operator to the input.
     // The HDR/SDR ratio describes the luminace range of the input. 1.0 means SDR. Anything larger
     // then 1.0 means that there is headroom above the SDR region.
     // Similarly, the target HDR/SDR ratio describes the luminance range of the output.
+    // The source key identifies the sequence of images that the input comes from, such as a layer,
+    // for reusing its luminance map across images. Zero never reuses it.
     sk_sp<SkShader> mouriMap(SkiaGpuContext* context, sk_sp<SkShader> input, float inputHdrSdrRatio,
-                             float targetHdrSdrRatio);
+                             float targetHdrSdrRatio, uint64_t sourceKey = 0);
 
 private:
     sk_sp<SkImage> downchunk(SkiaGpuContext* context, sk_sp<SkShader> input,
@@ -78,6 +86,24 @@ private:
     const sk_sp<SkRuntimeEffect> mChunk8x8;
     const sk_sp<SkRuntimeEffect> mBlur;
     const sk_sp<SkRuntimeEffect> mTonemap;
+
+    struct LocalLux {
+        SkiaGpuContext* context;
+        uint64_t sourceKey;
+        SkISize imageSize;
+        SkMatrix matrix;
+        float hdrSdrRatio;
+        // Number of images that reused the luminance map since it was computed.
+        uint32_t reuseCount;
+        sk_sp<SkImage> image;
+    };
+    // Returns the blurred luminance map for the input, reusing a cached one if possible.
+    sk_sp<SkImage> getLocalLux(SkiaGpuContext* context, sk_sp<SkShader> input, float hdrSdrRatio,
+                               uint64_t sourceKey);
+    const uint32_t mRefreshInterval;
+    // Most recently used first.
+    static constexpr size_t kMaxLocalLux = 4;
+    std::deque<LocalLux> mLocalLux;
 };
 } // namespace skia
 } // namespace renderengine
@@ -246,4 +246,49 @@ TEST_F(RenderEngineThreadedTest, drawLayers_protectedOutputBuffer) {
     ASSERT_TRUE(result.ok());
 }
 
+TEST_F(RenderEngineThreadedTest, drawLayers_queuesCompositionAheadOfScreenshots) {
+    using Priority = renderengine::DisplaySettings::Priority;
+    std::vector<renderengine::LayerSettings> layers;
+    std::shared_ptr<renderengine::ExternalTexture> buffer = std::make_shared<
+            renderengine::impl::
+                    ExternalTexture>(sp<GraphicBuffer>::make(), *mRenderEngine,
+                                     renderengine::impl::ExternalTexture::Usage::READABLE |
+                                             renderengine::impl::ExternalTexture::Usage::WRITEABLE);
+
+    // The first draw blocks the RenderEngine thread until the other draws have been queued.
+    std::promise<void> unblock;
+    std::shared_future<void> unblocked = unblock.get_future().share();
+    std::vector<Priority> drawOrder;
+
+    EXPECT_CALL(*mRenderEngine, useProtectedContext(false)).Times(testing::AnyNumber());
+    EXPECT_CALL(*mRenderEngine, drawLayersInternal)
+            .Times(3)
+            .WillRepeatedly([&](const std::shared_ptr<std::promise<FenceResult>>&& resultPromise,
+                                const renderengine::DisplaySettings& display,
+                                const std::vector<renderengine::LayerSettings>&,
+                                const std::shared_ptr<renderengine::ExternalTexture>&,
+                                base::unique_fd&&) {
+                unblocked.wait();
+                drawOrder.push_back(display.priority);
+                resultPromise->set_value(Fence::NO_FENCE);
+            });
+
+    renderengine::DisplaySettings blocking{.priority = Priority::Composition};
+    renderengine::DisplaySettings screenshot{.priority = Priority::Screenshot};
+    renderengine::DisplaySettings composition{.priority = Priority::Composition};
+
+    auto blockingFuture = mThreadedRE->drawLayers(blocking, layers, buffer, base::unique_fd());
+    auto screenshotFuture = mThreadedRE->drawLayers(screenshot, layers, buffer, base::unique_fd());
+    auto compositionFuture =
+            mThreadedRE->drawLayers(composition, layers, buffer, base::unique_fd());
+    unblock.set_value();
+
+    ASSERT_TRUE(blockingFuture.get().ok());
+    ASSERT_TRUE(compositionFuture.get().ok());
+    ASSERT_TRUE(screenshotFuture.get().ok());
+    EXPECT_THAT(drawOrder,
+                testing::ElementsAre(Priority::Composition, Priority::Composition,
+                                     Priority::Screenshot));
+}
+
 } // namespace android
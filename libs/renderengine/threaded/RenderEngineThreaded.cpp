@@ -100,9 +100,9 @@ void RenderEngineThreaded::threadMain(CreateInstanceFactory factory) NO_THREAD_S
         const auto getNextTask = [this]() -> std::optional<Work> {
             std::scoped_lock lock(mThreadMutex);
             if (!mFunctionCalls.empty()) {
-                Work task = mFunctionCalls.front();
-                mFunctionCalls.pop();
-                return std::make_optional<Work>(task);
+                Work task = std::move(mFunctionCalls.front().work);
+                mFunctionCalls.pop_front();
+                return std::make_optional<Work>(std::move(task));
             }
             return std::nullopt;
         };
@@ -123,6 +123,21 @@ void RenderEngineThreaded::threadMain(CreateInstanceFactory factory) NO_THREAD_S
     mRenderEngine.reset();
 }
 
+void RenderEngineThreaded::queueTask(Work work) {
+    mFunctionCalls.push_back({std::move(work)});
+}
+
+void RenderEngineThreaded::queueDrawTask(Priority priority, Work work) {
+    auto it = mFunctionCalls.end();
+    while (it != mFunctionCalls.begin() && std::prev(it)->priority > priority) {
+        it--;
+    }
+    if (it != mFunctionCalls.end()) {
+        mReorderedDrawCount++;
+    }
+    mFunctionCalls.insert(it, {std::move(work), priority});
+}
+
 void RenderEngineThreaded::waitUntilInitialized() const {
     if (!mIsInitialized) {
         std::unique_lock<std::mutex> lock(mInitializedMutex);
@@ -138,7 +153,7 @@ std::future<void> RenderEngineThreaded::primeCache(PrimeCacheConfig config) {
     // for the futures.
     {
         std::lock_guard lock(mThreadMutex);
-        mFunctionCalls.push([resultPromise, config](renderengine::RenderEngine& instance) {
+        queueTask([resultPromise, config](renderengine::RenderEngine& instance) {
             SFTRACE_NAME("REThreaded::primeCache");
             if (setSchedFifo(false) != NO_ERROR) {
                 ALOGW("Couldn't set SCHED_OTHER for primeCache");
@@ -162,10 +177,17 @@ void RenderEngineThreaded::dump(std::string& result) {
     std::future<std::string> resultFuture = resultPromise.get_future();
     {
         std::lock_guard lock(mThreadMutex);
-        mFunctionCalls.push([&resultPromise, &result](renderengine::RenderEngine& instance) {
+        queueTask([this, &resultPromise, &result](renderengine::RenderEngine& instance) {
             SFTRACE_NAME("REThreaded::dump");
             std::string localResult = result;
             instance.dump(localResult);
+            {
+                std::lock_guard lock(mThreadMutex);
+                base::StringAppendF(&localResult,
+                                    "RenderEngineThreaded draws queued ahead of lower priority "
+                                    "draws: %zu\n",
+                                    mReorderedDrawCount);
+            }
             resultPromise.set_value(std::move(localResult));
         });
     }
@@ -181,7 +203,7 @@ void RenderEngineThreaded::mapExternalTextureBuffer(const sp<GraphicBuffer>& buf
     // for the futures.
     {
         std::lock_guard lock(mThreadMutex);
-        mFunctionCalls.push([=](renderengine::RenderEngine& instance) {
+        queueTask([=](renderengine::RenderEngine& instance) {
             SFTRACE_NAME("REThreaded::mapExternalTextureBuffer");
             instance.mapExternalTextureBuffer(buffer, isRenderable);
         });
@@ -195,7 +217,7 @@ void RenderEngineThreaded::unmapExternalTextureBuffer(sp<GraphicBuffer>&& buffer
     // for the futures.
     {
         std::lock_guard lock(mThreadMutex);
-        mFunctionCalls.push(
+        queueTask(
                 [=, buffer = std::move(buffer)](renderengine::RenderEngine& instance) mutable {
                     SFTRACE_NAME("REThreaded::unmapExternalTextureBuffer");
                     instance.unmapExternalTextureBuffer(std::move(buffer));
@@ -228,7 +250,7 @@ void RenderEngineThreaded::cleanupPostRender() {
     // for the futures.
     {
         std::lock_guard lock(mThreadMutex);
-        mFunctionCalls.push([=](renderengine::RenderEngine& instance) {
+        queueTask([=](renderengine::RenderEngine& instance) {
             SFTRACE_NAME("REThreaded::cleanupPostRender");
             instance.cleanupPostRender();
         });
@@ -269,7 +291,8 @@ ftl::Future<FenceResult> RenderEngineThreaded::drawLayers(
     {
         std::lock_guard lock(mThreadMutex);
         mNeedsPostRenderCleanup = true;
-        mFunctionCalls.push(
+        queueDrawTask(
+                display.priority,
                 [resultPromise, display, layers, buffer, fd](renderengine::RenderEngine& instance) {
                     SFTRACE_NAME("REThreaded::drawLayers");
                     instance.updateProtectedContext(layers, {buffer.get()});
@@ -292,7 +315,7 @@ ftl::Future<FenceResult> RenderEngineThreaded::drawGainmap(
     {
         std::lock_guard lock(mThreadMutex);
         mNeedsPostRenderCleanup = true;
-        mFunctionCalls.push([resultPromise, sdr, sdrFence = std::move(sdrFence), hdr,
+        queueTask([resultPromise, sdr, sdrFence = std::move(sdrFence), hdr,
                              hdrFence = std::move(hdrFence), hdrSdrRatio, dataspace,
                              gainmap](renderengine::RenderEngine& instance) mutable {
             SFTRACE_NAME("REThreaded::drawGainmap");
@@ -310,7 +333,7 @@ int RenderEngineThreaded::getContextPriority() {
     std::future<int> resultFuture = resultPromise.get_future();
     {
         std::lock_guard lock(mThreadMutex);
-        mFunctionCalls.push([&resultPromise](renderengine::RenderEngine& instance) {
+        queueTask([&resultPromise](renderengine::RenderEngine& instance) {
             SFTRACE_NAME("REThreaded::getContextPriority");
             int priority = instance.getContextPriority();
             resultPromise.set_value(priority);
@@ -330,7 +353,7 @@ void RenderEngineThreaded::onActiveDisplaySizeChanged(ui::Size size) {
     // for the futures.
     {
         std::lock_guard lock(mThreadMutex);
-        mFunctionCalls.push([size](renderengine::RenderEngine& instance) {
+        queueTask([size](renderengine::RenderEngine& instance) {
             SFTRACE_NAME("REThreaded::onActiveDisplaySizeChanged");
             instance.onActiveDisplaySizeChanged(size);
         });
@@ -343,7 +366,7 @@ std::optional<pid_t> RenderEngineThreaded::getRenderEngineTid() const {
     std::future<pid_t> tidFuture = tidPromise.get_future();
     {
         std::lock_guard lock(mThreadMutex);
-        mFunctionCalls.push([&tidPromise](renderengine::RenderEngine& instance) {
+        queueTask([&tidPromise](renderengine::RenderEngine& instance) {
             tidPromise.set_value(gettid());
         });
     }
@@ -357,7 +380,7 @@ void RenderEngineThreaded::setEnableTracing(bool tracingEnabled) {
     // for the futures.
     {
         std::lock_guard lock(mThreadMutex);
-        mFunctionCalls.push([tracingEnabled](renderengine::RenderEngine& instance) {
+        queueTask([tracingEnabled](renderengine::RenderEngine& instance) {
             SFTRACE_NAME("REThreaded::setEnableTracing");
             instance.setEnableTracing(tracingEnabled);
         });
@@ -18,8 +18,8 @@
 
 #include <android-base/thread_annotations.h>
 #include <condition_variable>
+#include <deque>
 #include <mutex>
-#include <queue>
 #include <thread>
 
 #include "renderengine/RenderEngine.h"
@@ -33,7 +33,8 @@ using CreateInstanceFactory = std::function<std::unique_ptr<renderengine::Render
 /**
  * This class extends a basic RenderEngine class. It contains a thread. Each time a function of
  * this class is called, we create a lambda function that is put on a queue. The main thread then
- * executes the functions in order.
+ * executes the functions in order, except that a draw may be queued ahead of pending draws with a
+ * lower DisplaySettings::priority.
  */
 class RenderEngineThreaded : public RenderEngine {
 public:
@@ -104,7 +105,19 @@ private:
     std::atomic<bool> mNeedsPostRenderCleanup = false;
 
     using Work = std::function<void(renderengine::RenderEngine&)>;
-    mutable std::queue<Work> mFunctionCalls GUARDED_BY(mThreadMutex);
+    using Priority = DisplaySettings::Priority;
+    struct Task {
+        Work work;
+        // Only draws are queued with a lower priority. Everything else is queued with the highest
+        // priority, so that no draw is ever moved ahead of it.
+        Priority priority = Priority::Composition;
+    };
+    void queueTask(Work work) REQUIRES(mThreadMutex);
+    // Queues a draw ahead of any draws with a lower priority at the back of the queue.
+    void queueDrawTask(Priority priority, Work work) REQUIRES(mThreadMutex);
+    mutable std::deque<Task> mFunctionCalls GUARDED_BY(mThreadMutex);
+    // The number of draws that were queued ahead of lower priority draws.
+    size_t mReorderedDrawCount GUARDED_BY(mThreadMutex) = 0;
     mutable std::condition_variable mCondition;
 
     // Used to allow select thread safe methods to be accessed without requiring the
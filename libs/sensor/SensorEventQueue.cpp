@@ -74,17 +74,30 @@ ssize_t SensorEventQueue::write(const sp<BitTube>& tube,
 }
 
 ssize_t SensorEventQueue::read(ASensorEvent* events, size_t numEvents) {
-    if (mAvailable == 0) {
-        ssize_t err =
-                BitTube::recvObjects(mSensorChannel, mRecBuffer, MAX_RECEIVE_BUFFER_EVENT_COUNT);
+    size_t count;
+    if (mAvailable == 0 && numEvents >= MAX_RECEIVE_BUFFER_EVENT_COUNT) {
+        // The largest batch that the service sends fits into the caller's buffer, so the events
+        // can be received in place, without going through mRecBuffer.
+        ssize_t err = BitTube::recvObjects(mSensorChannel, events, MAX_RECEIVE_BUFFER_EVENT_COUNT);
         if (err < 0) {
             return err;
         }
-        mAvailable = static_cast<size_t>(err);
-        mConsumed = 0;
+        count = static_cast<size_t>(err);
+    } else {
+        if (mAvailable == 0) {
+            ssize_t err = BitTube::recvObjects(mSensorChannel, mRecBuffer,
+                                               MAX_RECEIVE_BUFFER_EVENT_COUNT);
+            if (err < 0) {
+                return err;
+            }
+            mAvailable = static_cast<size_t>(err);
+            mConsumed = 0;
+        }
+        count = min(numEvents, mAvailable);
+        memcpy(events, mRecBuffer + mConsumed, count * sizeof(ASensorEvent));
+        mAvailable -= count;
+        mConsumed += count;
     }
-    size_t count = min(numEvents, mAvailable);
-    memcpy(events, mRecBuffer + mConsumed, count * sizeof(ASensorEvent));
 
     if (CC_UNLIKELY(ATRACE_ENABLED()) &&
         libsensor_flags::sensor_event_queue_report_sensor_usage_in_tracing()) {
@@ -102,8 +115,6 @@ ssize_t SensorEventQueue::read(ASensorEvent* events, size_t numEvents) {
             }
         }
     }
-    mAvailable -= count;
-    mConsumed += count;
     return static_cast<ssize_t>(count);
 }
 
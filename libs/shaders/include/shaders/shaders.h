@@ -66,6 +66,12 @@ struct LinearEffect {
     // working space.
     ui::Dataspace fakeOutputDataspace = ui::Dataspace::UNKNOWN;
 
+    // Whether tone mapping samples the tone curve from a lookup table, when the tone mapper has
+    // one for these dataspaces, rather than evaluating it for each pixel. The table is returned by
+    // buildLinearEffectTonemapGainLut(), and must be bound to the child shader named
+    // tonemap::ToneMapper::kGainLutChildName if the effect has one.
+    bool useTonemapGainLut = false;
+
     enum SkSLType { Shader, ColorFilter };
     SkSLType type = Shader;
 };
@@ -73,7 +79,8 @@ struct LinearEffect {
 static inline bool operator==(const LinearEffect& lhs, const LinearEffect& rhs) {
     return lhs.inputDataspace == rhs.inputDataspace && lhs.outputDataspace == rhs.outputDataspace &&
             lhs.undoPremultipliedAlpha == rhs.undoPremultipliedAlpha &&
-            lhs.fakeOutputDataspace == rhs.fakeOutputDataspace;
+            lhs.fakeOutputDataspace == rhs.fakeOutputDataspace &&
+            lhs.useTonemapGainLut == rhs.useTonemapGainLut;
 }
 
 struct LinearEffectHasher {
@@ -86,7 +93,8 @@ struct LinearEffectHasher {
         size_t result = std::hash<ui::Dataspace>{}(le.inputDataspace);
         result = HashCombine(result, std::hash<ui::Dataspace>{}(le.outputDataspace));
         result = HashCombine(result, std::hash<bool>{}(le.undoPremultipliedAlpha));
-        return HashCombine(result, std::hash<ui::Dataspace>{}(le.fakeOutputDataspace));
+        result = HashCombine(result, std::hash<ui::Dataspace>{}(le.fakeOutputDataspace));
+        return HashCombine(result, std::hash<bool>{}(le.useTonemapGainLut));
     }
 };
 
@@ -103,4 +111,13 @@ std::vector<tonemap::ShaderUniform> buildLinearEffectUniforms(
         aidl::android::hardware::graphics::composer3::RenderIntent renderIntent =
                 aidl::android::hardware::graphics::composer3::RenderIntent::TONE_MAP_COLORIMETRIC);
 
+// Generates the tone mapping lookup table for a LinearEffect shader with useTonemapGainLut set, for
+// the same arguments as buildLinearEffectUniforms(). Returns an empty table if the shader does not
+// sample one.
+std::vector<float> buildLinearEffectTonemapGainLut(
+        const LinearEffect& linearEffect, float maxDisplayLuminance,
+        float currentDisplayLuminanceNits, float maxLuminance, AHardwareBuffer* buffer = nullptr,
+        aidl::android::hardware::graphics::composer3::RenderIntent renderIntent =
+                aidl::android::hardware::graphics::composer3::RenderIntent::TONE_MAP_COLORIMETRIC);
+
 } // namespace android::shaders
@@ -142,11 +142,20 @@ static void generateLuminanceNormalizationForOOTF(ui::Dataspace inputDataspace,
 }
 
 void generateOOTF(ui::Dataspace inputDataspace, ui::Dataspace outputDataspace,
-                  std::string& shader) {
-    shader.append(tonemap::getToneMapper()
-                          ->generateTonemapGainShaderSkSL(toAidlDataspace(inputDataspace),
-                                                          toAidlDataspace(outputDataspace))
-                          .c_str());
+                  bool useTonemapGainLut, std::string& shader) {
+    std::string tonemapShader;
+    if (useTonemapGainLut) {
+        tonemapShader = tonemap::getToneMapper()
+                                ->generateTonemapGainLutShaderSkSL(toAidlDataspace(inputDataspace),
+                                                                   toAidlDataspace(
+                                                                           outputDataspace));
+    }
+    if (tonemapShader.empty()) {
+        tonemapShader = tonemap::getToneMapper()
+                                ->generateTonemapGainShaderSkSL(toAidlDataspace(inputDataspace),
+                                                                toAidlDataspace(outputDataspace));
+    }
+    shader.append(tonemapShader);
 
     generateLuminanceScalesForOOTF(inputDataspace, shader);
     generateLuminanceNormalizationForOOTF(inputDataspace, outputDataspace, shader);
@@ -228,12 +237,29 @@ std::vector<uint8_t> buildUniformValue(T value) {
     return result;
 }
 
+tonemap::Metadata buildTonemapMetadata(
+        float maxDisplayLuminance, float currentDisplayLuminanceNits, float maxLuminance,
+        AHardwareBuffer* buffer,
+        aidl::android::hardware::graphics::composer3::RenderIntent renderIntent) {
+    return {.displayMaxLuminance = maxDisplayLuminance,
+            // If the input luminance is unknown, use display luminance (aka,
+            // no-op any luminance changes).
+            // This is expected to only be meaningful for PQ content
+            .contentMaxLuminance = maxLuminance > 0 ? maxLuminance : maxDisplayLuminance,
+            .currentDisplayLuminance = currentDisplayLuminanceNits > 0
+                    ? currentDisplayLuminanceNits
+                    : maxDisplayLuminance,
+            .buffer = buffer,
+            .renderIntent = renderIntent};
+}
+
 } // namespace
 
 std::string buildLinearEffectSkSL(const LinearEffect& linearEffect) {
     std::string shaderString;
     generateXYZTransforms(shaderString);
-    generateOOTF(linearEffect.inputDataspace, linearEffect.outputDataspace, shaderString);
+    generateOOTF(linearEffect.inputDataspace, linearEffect.outputDataspace,
+                 linearEffect.useTonemapGainLut, shaderString);
 
     const bool needsCustomOETF = (linearEffect.fakeOutputDataspace & HAL_DATASPACE_TRANSFER_MASK) ==
             HAL_DATASPACE_TRANSFER_GAMMA2_2;
@@ -297,18 +323,9 @@ std::vector<tonemap::ShaderUniform> buildLinearEffectUniforms(
                                 mat4(outputColorSpace.getRGBtoXYZ()) * colorTransform *
                                 mat4(outputColorSpace.getXYZtoRGB()))});
 
-    tonemap::Metadata metadata{.displayMaxLuminance = maxDisplayLuminance,
-                               // If the input luminance is unknown, use display luminance (aka,
-                               // no-op any luminance changes).
-                               // This is expected to only be meaningful for PQ content
-                               .contentMaxLuminance =
-                                       maxLuminance > 0 ? maxLuminance : maxDisplayLuminance,
-                               .currentDisplayLuminance = currentDisplayLuminanceNits > 0
-                                       ? currentDisplayLuminanceNits
-                                       : maxDisplayLuminance,
-                               .buffer = buffer,
-                               .renderIntent = renderIntent};
-
+    const tonemap::Metadata metadata =
+            buildTonemapMetadata(maxDisplayLuminance, currentDisplayLuminanceNits, maxLuminance,
+                                 buffer, renderIntent);
     for (const auto uniform : tonemap::getToneMapper()->generateShaderSkSLUniforms(metadata)) {
         uniforms.push_back(uniform);
     }
@@ -316,4 +333,19 @@ std::vector<tonemap::ShaderUniform> buildLinearEffectUniforms(
     return uniforms;
 }
 
+std::vector<float> buildLinearEffectTonemapGainLut(
+        const LinearEffect& linearEffect, float maxDisplayLuminance,
+        float currentDisplayLuminanceNits, float maxLuminance, AHardwareBuffer* buffer,
+        aidl::android::hardware::graphics::composer3::RenderIntent renderIntent) {
+    if (!linearEffect.useTonemapGainLut) {
+        return {};
+    }
+    return tonemap::getToneMapper()
+            ->generateTonemapGainLut(toAidlDataspace(linearEffect.inputDataspace),
+                                     toAidlDataspace(linearEffect.outputDataspace),
+                                     buildTonemapMetadata(maxDisplayLuminance,
+                                                          currentDisplayLuminanceNits,
+                                                          maxLuminance, buffer, renderIntent));
+}
+
 } // namespace android::shaders
@@ -93,4 +93,29 @@ TEST_F(ShadersTest, buildLinearEffectUniforms_selectsGamutTransformMatrices) {
     EXPECT_THAT(uniforms, Contains(UniformNameEq("in_colorTransform")));
 }
 
+TEST_F(ShadersTest, buildLinearEffectSkSL_samplesTonemapGainLut) {
+    shaders::LinearEffect effect =
+            shaders::LinearEffect{.inputDataspace = ui::Dataspace::BT2020_ITU_PQ,
+                                  .outputDataspace = ui::Dataspace::DISPLAY_P3,
+                                  .fakeOutputDataspace = ui::Dataspace::UNKNOWN,
+                                  .useTonemapGainLut = true};
+
+    EXPECT_THAT(shaders::buildLinearEffectSkSL(effect),
+                HasSubstr(tonemap::ToneMapper::kGainLutChildName));
+    EXPECT_EQ(tonemap::ToneMapper::kGainLutSize,
+              shaders::buildLinearEffectTonemapGainLut(effect, 500.f, 500.f, 1000.f).size());
+}
+
+TEST_F(ShadersTest, buildLinearEffectSkSL_evaluatesTrivialToneCurve) {
+    shaders::LinearEffect effect =
+            shaders::LinearEffect{.inputDataspace = ui::Dataspace::V0_SRGB,
+                                  .outputDataspace = ui::Dataspace::DISPLAY_P3,
+                                  .fakeOutputDataspace = ui::Dataspace::UNKNOWN,
+                                  .useTonemapGainLut = true};
+
+    EXPECT_THAT(shaders::buildLinearEffectSkSL(effect),
+                testing::Not(HasSubstr(tonemap::ToneMapper::kGainLutChildName)));
+    EXPECT_TRUE(shaders::buildLinearEffectTonemapGainLut(effect, 500.f, 500.f, 1000.f).empty());
+}
+
 } // namespace android
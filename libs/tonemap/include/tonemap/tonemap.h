@@ -148,6 +148,46 @@ public:
             aidl::android::hardware::graphics::common::Dataspace sourceDataspace,
             aidl::android::hardware::graphics::common::Dataspace destinationDataspace,
             const std::vector<Color>& colors, const Metadata& metadata) = 0;
+
+    // Like generateTonemapGainShaderSkSL(), except that the returned libtonemap_LookupTonemapGain()
+    // samples the gain from a lookup table instead of evaluating the tone curve for each pixel,
+    // which is cheaper on GPUs that are short on ALU throughput.
+    //
+    // The shader declares the same uniforms as generateTonemapGainShaderSkSL(), so
+    // generateShaderSkSLUniforms() applies to it as well, and additionally a child shader named
+    // kGainLutChildName, which must be bound to the table returned by generateTonemapGainLut() for
+    // the same dataspaces and metadata. See generateTonemapGainLut() for how the table is sampled.
+    //
+    // Returns an empty string if the tone mapper has no lookup table for these dataspaces, e.g.
+    // because the tone curve is trivial, in which case generateTonemapGainShaderSkSL() should be
+    // used instead.
+    virtual std::string generateTonemapGainLutShaderSkSL(
+            aidl::android::hardware::graphics::common::Dataspace /*sourceDataspace*/,
+            aidl::android::hardware::graphics::common::Dataspace /*destinationDataspace*/) {
+        return {};
+    }
+
+    // Computes the lookup table for the shader returned by generateTonemapGainLutShaderSkSL(),
+    // using lookupTonemapGain(). The table depends on the metadata, so it must be recomputed when
+    // the uniforms returned by generateShaderSkSLUniforms() change.
+    //
+    // The table has kGainLutSize entries. Entry i holds the gain for a maximum RGB channel of
+    // kGainLutMaxNits * (i / (kGainLutSize - 1))^4 nits, which spends most of the entries on the
+    // dark end of the range, where the eye is most sensitive. The shader samples the table as an
+    // image of kGainLutSize x 1 pixels with linear filtering and no color conversion, i.e. as a
+    // raw image shader, at x = i + 0.5 for entry i.
+    //
+    // Returns an empty table if generateTonemapGainLutShaderSkSL() returns an empty string.
+    virtual std::vector<float> generateTonemapGainLut(
+            aidl::android::hardware::graphics::common::Dataspace /*sourceDataspace*/,
+            aidl::android::hardware::graphics::common::Dataspace /*destinationDataspace*/,
+            const Metadata& /*metadata*/) {
+        return {};
+    }
+
+    static constexpr size_t kGainLutSize = 256;
+    static constexpr float kGainLutMaxNits = 10000.f;
+    static constexpr const char* kGainLutChildName = "in_libtonemap_gainLut";
 };
 
 // Retrieves a tonemapper instance.
@@ -17,7 +17,10 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include <tonemap/tonemap.h>
+#include <algorithm>
 #include <cmath>
+#include <string>
+#include <utility>
 
 namespace android {
 
@@ -85,4 +88,72 @@ TEST_F(TonemapTest, generateTonemapGainShaderSkSL_containsEntryPointForHLG) {
     EXPECT_THAT(shader, HasSubstr("float libtonemap_LookupTonemapGain(vec3 linearRGB, vec3 xyz)"));
 }
 
+TEST_F(TonemapTest, generateTonemapGainLutShaderSkSL_containsEntryPointAndLut) {
+    const auto shader =
+            tonemap::getToneMapper()
+                    ->generateTonemapGainLutShaderSkSL(aidl::android::hardware::graphics::common::
+                                                               Dataspace::BT2020_ITU_PQ,
+                                                       aidl::android::hardware::graphics::common::
+                                                               Dataspace::DISPLAY_P3);
+
+    EXPECT_THAT(shader, HasSubstr("float libtonemap_LookupTonemapGain(vec3 linearRGB, vec3 xyz)"));
+    EXPECT_THAT(shader,
+                HasSubstr(std::string("uniform shader ") + tonemap::ToneMapper::kGainLutChildName));
+}
+
+TEST_F(TonemapTest, generateTonemapGainLutShaderSkSL_isEmptyWithoutToneCurve) {
+    const auto shader =
+            tonemap::getToneMapper()
+                    ->generateTonemapGainLutShaderSkSL(aidl::android::hardware::graphics::common::
+                                                               Dataspace::BT2020_ITU_PQ,
+                                                       aidl::android::hardware::graphics::common::
+                                                               Dataspace::BT2020_ITU_PQ);
+    EXPECT_TRUE(shader.empty());
+
+    tonemap::Metadata metadata{.displayMaxLuminance = 500.f, .currentDisplayLuminance = 500.f};
+    const auto lut =
+            tonemap::getToneMapper()
+                    ->generateTonemapGainLut(aidl::android::hardware::graphics::common::Dataspace::
+                                                     BT2020_ITU_PQ,
+                                             aidl::android::hardware::graphics::common::Dataspace::
+                                                     BT2020_ITU_PQ,
+                                             metadata);
+    EXPECT_TRUE(lut.empty());
+}
+
+TEST_F(TonemapTest, generateTonemapGainLut_matchesLookupTonemapGain) {
+    using aidl::android::hardware::graphics::common::Dataspace;
+    using tonemap::ToneMapper;
+
+    tonemap::Metadata metadata{.displayMaxLuminance = 500.f, .currentDisplayLuminance = 500.f};
+    for (const auto [source, destination] :
+         {std::pair(Dataspace::BT2020_ITU_PQ, Dataspace::DISPLAY_P3),
+          std::pair(Dataspace::BT2020_ITU_PQ, Dataspace::BT2020_ITU_HLG),
+          std::pair(Dataspace::BT2020_ITU_HLG, Dataspace::DISPLAY_P3),
+          std::pair(Dataspace::BT2020_ITU_HLG, Dataspace::BT2020_ITU_PQ)}) {
+        const auto lut = tonemap::getToneMapper()->generateTonemapGainLut(source, destination,
+                                                                          metadata);
+        ASSERT_EQ(ToneMapper::kGainLutSize, lut.size());
+
+        for (const float nits : {0.1f, 1.f, 50.f, 203.f, 400.f, 1000.f}) {
+            // Sample the table as the shader does.
+            const float index = std::sqrt(std::sqrt(nits / ToneMapper::kGainLutMaxNits)) *
+                    (ToneMapper::kGainLutSize - 1);
+            const size_t i = std::min(static_cast<size_t>(index), ToneMapper::kGainLutSize - 2);
+            const float t = index - i;
+            const float lutGain = lut[i] * (1.f - t) + lut[i + 1] * t;
+
+            const auto gains =
+                    tonemap::getToneMapper()->lookupTonemapGain(source, destination,
+                                                                {tonemap::Color{
+                                                                        .linearRGB = vec3(nits)}},
+                                                                metadata);
+            ASSERT_EQ(1u, gains.size());
+            EXPECT_NEAR(gains[0], lutGain, gains[0] * 0.01)
+                    << "source: " << toString(source) << " destination: " << toString(destination)
+                    << " nits: " << nits;
+        }
+    }
+}
+
 } // namespace android
@@ -19,6 +19,7 @@
 #include <algorithm>
 #include <cstdint>
 #include <mutex>
+#include <string>
 #include <type_traits>
 
 namespace android::tonemap {
@@ -457,6 +458,17 @@ private:
         return nits <= 1.0 / 12.0 ? std::sqrt(3.0 * nits) : a * std::log(12.0 * nits - b) + c;
     }
 
+    // Whether the gain is not always 1.0, in which case it's worth a lookup table.
+    static bool hasToneCurve(aidl::android::hardware::graphics::common::Dataspace sourceDataspace,
+                             aidl::android::hardware::graphics::common::Dataspace
+                                     destinationDataspace) {
+        const int32_t sourceTransfer = static_cast<int32_t>(sourceDataspace) & kTransferMask;
+        const int32_t destinationTransfer =
+                static_cast<int32_t>(destinationDataspace) & kTransferMask;
+        return (sourceTransfer == kTransferST2084 || sourceTransfer == kTransferHLG) &&
+                sourceTransfer != destinationTransfer;
+    }
+
 public:
     std::string generateTonemapGainShaderSkSL(
             aidl::android::hardware::graphics::common::Dataspace sourceDataspace,
@@ -726,6 +738,60 @@ public:
         }
         return gains;
     }
+
+    std::string generateTonemapGainLutShaderSkSL(
+            aidl::android::hardware::graphics::common::Dataspace sourceDataspace,
+            aidl::android::hardware::graphics::common::Dataspace destinationDataspace) override {
+        if (!hasToneCurve(sourceDataspace, destinationDataspace)) {
+            return {};
+        }
+
+        std::string program;
+        // The same uniforms as generateTonemapGainShaderSkSL(), even though the curve is baked
+        // into the lookup table, so that callers bind them in the same way.
+        program.append(R"(
+                uniform float in_libtonemap_displayMaxLuminance;
+                uniform float in_libtonemap_inputMaxLuminance;
+                uniform float in_libtonemap_hlgGamma;
+            )");
+        program.append("uniform shader ").append(kGainLutChildName).append(";\n");
+        program.append("const float libtonemap_gainLutMaxNits = ")
+                .append(std::to_string(kGainLutMaxNits))
+                .append(";\n");
+        program.append("const float libtonemap_gainLutLastIndex = ")
+                .append(std::to_string(kGainLutSize - 1))
+                .append(".0;\n");
+        program.append(R"(
+            float libtonemap_LookupTonemapGain(vec3 linearRGB, vec3 xyz) {
+                float maxRGB = max(linearRGB.r, max(linearRGB.g, linearRGB.b));
+                if (maxRGB <= 0.0) {
+                    return 1.0;
+                }
+                float index = sqrt(sqrt(clamp(maxRGB / libtonemap_gainLutMaxNits, 0.0, 1.0)))
+                        * libtonemap_gainLutLastIndex;
+                return in_libtonemap_gainLut.eval(float2(index + 0.5, 0.5)).r;
+            }
+        )");
+        return program;
+    }
+
+    std::vector<float> generateTonemapGainLut(
+            aidl::android::hardware::graphics::common::Dataspace sourceDataspace,
+            aidl::android::hardware::graphics::common::Dataspace destinationDataspace,
+            const Metadata& metadata) override {
+        if (!hasToneCurve(sourceDataspace, destinationDataspace)) {
+            return {};
+        }
+
+        std::vector<Color> colors(kGainLutSize);
+        for (size_t i = 0; i < kGainLutSize; i++) {
+            const double t = static_cast<double>(i) / (kGainLutSize - 1);
+            colors[i].linearRGB = vec3(kGainLutMaxNits * t * t * t * t);
+        }
+        const auto gains =
+                lookupTonemapGain(sourceDataspace, destinationDataspace, colors, metadata);
+        return std::vector<float>(gains.begin(), gains.end());
+    }
 };
 
 } // namespace
@@ -16,6 +16,14 @@
 
 #include <ui/ColorSpace.h>
 
+#include <algorithm>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE4_1__)
+#include <smmintrin.h>
+#endif
+
 using namespace std::placeholders;
 
 namespace android {
@@ -364,12 +372,14 @@ std::unique_ptr<float3[]> ColorSpace::createLUT(uint32_t size, const ColorSpace&
     for (uint32_t z = 0; z < size; z++) {
         for (int32_t y = int32_t(size - 1); y >= 0; y--) {
             for (uint32_t x = 0; x < size; x++) {
-                *data++ = connector.transform({
+                data[x] = {
                     static_cast<float>(x) * m,
                     static_cast<float>(y) * m,
                     static_cast<float>(z) * m,
-                });
+                };
             }
+            connector.transform(data, data, size);
+            data += size;
         }
     }
 
@@ -417,4 +427,99 @@ ColorSpaceConnector::ColorSpaceConnector(
     }
 }
 
+// Number of pixels staged per channel by the bulk conversions. Small enough for
+// the three planes to stay in L1 while the transfer functions run over them.
+static constexpr size_t BULK_CHUNK_SIZE = 256;
+
+// Multiplies the planar RGB values in r, g and b by m in place. Matches the
+// order of operations of mat3 * float3 so results are bit identical.
+static void multiplyPlanar(const mat3& m, float* r, float* g, float* b, size_t count) {
+    size_t i = 0;
+#if defined(__ARM_NEON)
+    for (; i + 4 <= count; i += 4) {
+        const float32x4_t vr = vld1q_f32(r + i);
+        const float32x4_t vg = vld1q_f32(g + i);
+        const float32x4_t vb = vld1q_f32(b + i);
+        float* planes[3] = {r, g, b};
+        for (size_t row = 0; row < 3; row++) {
+            float32x4_t acc = vmulq_n_f32(vr, m[0][row]);
+            acc = vaddq_f32(acc, vmulq_n_f32(vg, m[1][row]));
+            acc = vaddq_f32(acc, vmulq_n_f32(vb, m[2][row]));
+            vst1q_f32(planes[row] + i, acc);
+        }
+    }
+#elif defined(__SSE4_1__)
+    for (; i + 4 <= count; i += 4) {
+        const __m128 vr = _mm_loadu_ps(r + i);
+        const __m128 vg = _mm_loadu_ps(g + i);
+        const __m128 vb = _mm_loadu_ps(b + i);
+        float* planes[3] = {r, g, b};
+        for (size_t row = 0; row < 3; row++) {
+            __m128 acc = _mm_mul_ps(vr, _mm_set1_ps(m[0][row]));
+            acc = _mm_add_ps(acc, _mm_mul_ps(vg, _mm_set1_ps(m[1][row])));
+            acc = _mm_add_ps(acc, _mm_mul_ps(vb, _mm_set1_ps(m[2][row])));
+            _mm_storeu_ps(planes[row] + i, acc);
+        }
+    }
+#endif
+    for (; i < count; i++) {
+        const float3 v = m * float3{r[i], g[i], b[i]};
+        r[i] = v.r;
+        g[i] = v.g;
+        b[i] = v.b;
+    }
+}
+
+template <bool kLinear>
+void ColorSpaceConnector::transformBulk(const float3* src, float3* dst,
+                                        size_t count) const noexcept {
+    const ColorSpace::clamping_function& srcClamper = mSource.getClamper();
+    const ColorSpace::clamping_function& dstClamper = mDestination.getClamper();
+    const ColorSpace::transfer_function& eotf = mSource.getEOTF();
+    const ColorSpace::transfer_function& oetf = mDestination.getOETF();
+
+    float planes[3][BULK_CHUNK_SIZE];
+    while (count > 0) {
+        const size_t n = std::min(count, BULK_CHUNK_SIZE);
+        for (size_t c = 0; c < 3; c++) {
+            float* plane = planes[c];
+            for (size_t i = 0; i < n; i++) {
+                plane[i] = srcClamper(src[i][c]);
+            }
+            if (!kLinear) {
+                for (size_t i = 0; i < n; i++) {
+                    plane[i] = eotf(plane[i]);
+                }
+            }
+        }
+
+        multiplyPlanar(mTransform, planes[0], planes[1], planes[2], n);
+
+        for (size_t c = 0; c < 3; c++) {
+            float* plane = planes[c];
+            if (!kLinear) {
+                for (size_t i = 0; i < n; i++) {
+                    plane[i] = oetf(plane[i]);
+                }
+            }
+            for (size_t i = 0; i < n; i++) {
+                dst[i][c] = dstClamper(plane[i]);
+            }
+        }
+
+        src += n;
+        dst += n;
+        count -= n;
+    }
+}
+
+void ColorSpaceConnector::transform(const float3* src, float3* dst, size_t count) const noexcept {
+    transformBulk<false>(src, dst, count);
+}
+
+void ColorSpaceConnector::transformLinear(const float3* src, float3* dst,
+                                          size_t count) const noexcept {
+    transformBulk<true>(src, dst, count);
+}
+
 }; // namespace android
@@ -127,6 +127,13 @@ nsecs_t Fence::getSignalTime() const {
         return SIGNAL_TIME_INVALID;
     }
 
+    // Fences are mostly polled while they are still pending. A zero timeout wait answers that
+    // with a single poll, where sync_file_info needs two ioctls and an allocation. Errors fall
+    // through to sync_file_info, which reports them.
+    if (sync_wait(mFenceFd, 0) < 0 && errno == ETIME) {
+        return SIGNAL_TIME_PENDING;
+    }
+
     struct sync_file_info* finfo = sync_file_info(mFenceFd);
     if (finfo == nullptr) {
         ALOGE("sync_file_info returned NULL for fd %d", mFenceFd.get());
@@ -29,6 +29,8 @@
 #include <ui/FatVector.h>
 #include <vndksupport/linker.h>
 
+#include <limits>
+
 using namespace aidl::android::hardware::graphics::allocator;
 using namespace aidl::android::hardware::graphics::common;
 using namespace ::android::hardware::graphics::mapper;
@@ -242,10 +244,22 @@ status_t Gralloc5Allocator::allocate(std::string requestorName, uint32_t width,
 
 GraphicBufferAllocator::AllocationResult Gralloc5Allocator::allocate(
         const GraphicBufferAllocator::AllocationRequest& request) const {
+    GraphicBufferAllocator::AllocationResult ret{OK};
+    ret.status = allocateMultiple(request, 1, &ret.stride, &ret.handle);
+    if (ret.status != OK) {
+        return GraphicBufferAllocator::AllocationResult{ret.status};
+    }
+    return ret;
+}
+
+status_t Gralloc5Allocator::allocateMultiple(
+        const GraphicBufferAllocator::AllocationRequest& request, uint32_t bufferCount,
+        uint32_t* outStride, buffer_handle_t* outBufferHandles) const {
     auto descriptorInfo = makeDescriptor(request.requestorName, request.width, request.height,
                                          request.format, request.layerCount, request.usage);
-    if (!descriptorInfo) {
-        return GraphicBufferAllocator::AllocationResult{BAD_VALUE};
+    if (!descriptorInfo || bufferCount == 0 ||
+        bufferCount > static_cast<uint32_t>(std::numeric_limits<int32_t>::max())) {
+        return BAD_VALUE;
     }
 
     descriptorInfo->additionalOptions.reserve(request.extras.size());
@@ -257,7 +271,8 @@ GraphicBufferAllocator::AllocationResult Gralloc5Allocator::allocate(
     }
 
     AllocationResult result;
-    auto status = mAllocator->allocate2(*descriptorInfo, 1, &result);
+    auto status =
+            mAllocator->allocate2(*descriptorInfo, static_cast<int32_t>(bufferCount), &result);
     if (!status.isOk()) {
         auto error = status.getExceptionCode();
         if (error == EX_SERVICE_SPECIFIC) {
@@ -273,25 +288,44 @@ GraphicBufferAllocator::AllocationResult Gralloc5Allocator::allocate(
                     break;
             }
         }
-        return GraphicBufferAllocator::AllocationResult{error};
+        return error;
+    }
+    if (result.buffers.size() != bufferCount) {
+        ALOGE("Allocator returned %zu buffers, expected %u", result.buffers.size(), bufferCount);
+        return UNKNOWN_ERROR;
     }
 
-    GraphicBufferAllocator::AllocationResult ret{OK};
-    if (request.importBuffer) {
-        auto handle = makeFromAidl(result.buffers[0]);
-        auto error = mMapper.importBuffer(handle, &ret.handle);
-        native_handle_delete(handle);
+    status_t error = NO_ERROR;
+    uint32_t i = 0;
+    for (; i < bufferCount; i++) {
+        if (request.importBuffer) {
+            auto handle = makeFromAidl(result.buffers[i]);
+            error = mMapper.importBuffer(handle, &outBufferHandles[i]);
+            native_handle_delete(handle);
+        } else {
+            outBufferHandles[i] = dupFromAidl(result.buffers[i]);
+            error = outBufferHandles[i] ? NO_ERROR : NO_MEMORY;
+        }
         if (error != NO_ERROR) {
-            return GraphicBufferAllocator::AllocationResult{error};
+            break;
         }
-    } else {
-        ret.handle = dupFromAidl(result.buffers[0]);
-        if (!ret.handle) {
-            return GraphicBufferAllocator::AllocationResult{NO_MEMORY};
+    }
+    if (error != NO_ERROR) {
+        // Release the buffers which did make it, so that none is returned.
+        for (uint32_t j = 0; j < i; j++) {
+            if (request.importBuffer) {
+                mMapper.freeBuffer(outBufferHandles[j]);
+            } else {
+                auto buffer = const_cast<native_handle_t*>(outBufferHandles[j]);
+                native_handle_close(buffer);
+                native_handle_delete(buffer);
+            }
+            outBufferHandles[j] = nullptr;
         }
+        return error;
     }
 
-    ret.stride = result.stride;
+    *outStride = result.stride;
 
     // Release all the resources held by AllocationResult (specifically any remaining FDs)
     result = {};
@@ -300,7 +334,7 @@ GraphicBufferAllocator::AllocationResult Gralloc5Allocator::allocate(
     // is marked apex_available (b/214400477) and libbinder isn't (which of course is correct)
     // IPCThreadState::self()->flushCommands();
 
-    return ret;
+    return NO_ERROR;
 }
 
 void Gralloc5Mapper::preload() {
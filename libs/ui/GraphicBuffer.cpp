@@ -144,18 +144,41 @@ GraphicBuffer::GraphicBuffer(const GraphicBufferAllocator::AllocationRequest& re
     auto result = allocator.allocate(request);
     mInitCheck = result.status;
     if (result.status == NO_ERROR) {
-        handle = result.handle;
-        stride = result.stride;
-
-        mBufferMapper.getTransportSize(handle, &mTransportNumFds, &mTransportNumInts);
+        initWithAllocationResult(request, result);
+    }
+}
 
-        width = static_cast<int>(request.width);
-        height = static_cast<int>(request.height);
-        format = request.format;
-        layerCount = request.layerCount;
-        usage = request.usage;
-        usage_deprecated = int(usage);
+status_t GraphicBuffer::allocateMultiple(const GraphicBufferAllocator::AllocationRequest& request,
+                                         uint32_t count, std::vector<sp<GraphicBuffer>>* outBuffers) {
+    outBuffers->clear();
+    std::vector<GraphicBufferAllocator::AllocationResult> results;
+    status_t err = GraphicBufferAllocator::get().allocateMultiple(request, count, &results);
+    if (err != NO_ERROR) {
+        return err;
+    }
+    outBuffers->reserve(results.size());
+    for (const auto& result : results) {
+        sp<GraphicBuffer> buffer(new GraphicBuffer());
+        buffer->initWithAllocationResult(request, result);
+        outBuffers->push_back(std::move(buffer));
     }
+    return NO_ERROR;
+}
+
+void GraphicBuffer::initWithAllocationResult(
+        const GraphicBufferAllocator::AllocationRequest& request,
+        const GraphicBufferAllocator::AllocationResult& result) {
+    handle = result.handle;
+    stride = result.stride;
+
+    mBufferMapper.getTransportSize(handle, &mTransportNumFds, &mTransportNumInts);
+
+    width = static_cast<int>(request.width);
+    height = static_cast<int>(request.height);
+    format = request.format;
+    layerCount = request.layerCount;
+    usage = request.usage;
+    usage_deprecated = int(usage);
 }
 
 GraphicBuffer::~GraphicBuffer()
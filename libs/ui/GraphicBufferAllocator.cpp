@@ -42,11 +42,17 @@ namespace android {
 
 using base::StringAppendF;
 
+// How long a freed buffer is kept for recycling when it isn't reused.
+static constexpr nsecs_t kRecycleIdleTimeout = s2ns(3);
+
 ANDROID_SINGLETON_STATIC_INSTANCE( GraphicBufferAllocator )
 
 Mutex GraphicBufferAllocator::sLock;
 KeyedVector<buffer_handle_t,
     GraphicBufferAllocator::alloc_rec_t> GraphicBufferAllocator::sAllocList;
+std::deque<GraphicBufferAllocator::recycled_rec_t> GraphicBufferAllocator::sRecyclePool;
+size_t GraphicBufferAllocator::sRecyclePoolSize = 0;
+size_t GraphicBufferAllocator::sRecycleBudget = 0;
 
 GraphicBufferAllocator::GraphicBufferAllocator() : mMapper(GraphicBufferMapper::getInstance()) {
     switch (mMapper.getMapperVersion()) {
@@ -80,7 +86,7 @@ uint64_t GraphicBufferAllocator::getTotalSize() const {
     for (size_t i = 0; i < sAllocList.size(); ++i) {
         total += sAllocList.valueAt(i).size;
     }
-    return total;
+    return total + sRecyclePoolSize;
 }
 
 void GraphicBufferAllocator::dump(std::string& result, bool less) const {
@@ -103,7 +109,13 @@ void GraphicBufferAllocator::dump(std::string& result, bool less) const {
     }
     StringAppendF(&result, "Total allocated by GraphicBufferAllocator (estimate): %.2f KB\n",
                   static_cast<double>(total) / 1024.0);
+    if (sRecycleBudget || !sRecyclePool.empty()) {
+        StringAppendF(&result, "Kept for recycling: %zu buffers, %.2f KB (budget %.2f KB)\n",
+                      sRecyclePool.size(), static_cast<double>(sRecyclePoolSize) / 1024.0,
+                      static_cast<double>(sRecycleBudget) / 1024.0);
+    }
 
+    mMapper.dumpMetadataCache(result);
     result.append(mAllocator->dumpDebugInfo(less));
 }
 
@@ -115,23 +127,17 @@ void GraphicBufferAllocator::dumpToSystemLog(bool less) {
 
 auto GraphicBufferAllocator::allocate(const AllocationRequest& request) -> AllocationResult {
     ATRACE_CALL();
-    if (!request.width || !request.height) {
-        return AllocationResult(BAD_VALUE);
-    }
-
-    const auto width = request.width;
-    const auto height = request.height;
-
-    const uint32_t bpp = bytesPerPixel(request.format);
-    if (std::numeric_limits<size_t>::max() / width / height < static_cast<size_t>(bpp)) {
-        ALOGE("Failed to allocate (%u x %u) layerCount %u format %d "
-              "usage %" PRIx64 ": Requesting too large a buffer size",
-              request.width, request.height, request.layerCount, request.format, request.usage);
-        return AllocationResult(BAD_VALUE);
+    if (status_t err = checkRequest(request); err != NO_ERROR) {
+        return AllocationResult(err);
     }
 
-    if (request.layerCount < 1) {
-        return AllocationResult(BAD_VALUE);
+    if (request.importBuffer && request.extras.empty()) {
+        buffer_handle_t handle;
+        uint32_t stride;
+        if (takeRecycledBuffer(request.width, request.height, request.format, request.layerCount,
+                               request.usage, request.requestorName, &handle, &stride)) {
+            return AllocationResult(handle, stride);
+        }
     }
 
     auto result = mAllocator->allocate(request);
@@ -159,31 +165,121 @@ auto GraphicBufferAllocator::allocate(const AllocationRequest& request) -> Alloc
     if (!request.importBuffer) {
         return result;
     }
+
+    addAllocRec(result.handle, request, result.stride);
+    return result;
+}
+
+status_t GraphicBufferAllocator::allocateMultiple(const AllocationRequest& request, uint32_t count,
+                                                  std::vector<AllocationResult>* outResults) {
+    ATRACE_CALL();
+    outResults->clear();
+    if (!request.importBuffer) {
+        return BAD_VALUE;
+    }
+    if (status_t err = checkRequest(request); err != NO_ERROR) {
+        return err;
+    }
+    outResults->reserve(count);
+
+    const auto freeResults = [&] {
+        for (const AllocationResult& result : *outResults) {
+            free(result.handle);
+        }
+        outResults->clear();
+    };
+
+    // Hand out the recycled buffers first, as allocate() would.
+    if (request.extras.empty()) {
+        buffer_handle_t handle;
+        uint32_t stride;
+        while (outResults->size() < count &&
+               takeRecycledBuffer(request.width, request.height, request.format,
+                                  request.layerCount, request.usage, request.requestorName,
+                                  &handle, &stride)) {
+            outResults->emplace_back(handle, stride);
+        }
+    }
+
+    uint32_t remaining = count - static_cast<uint32_t>(outResults->size());
+    if (remaining > 1) {
+        std::vector<buffer_handle_t> handles(remaining);
+        uint32_t stride = 0;
+        status_t err = mAllocator->allocateMultiple(request, remaining, &stride, handles.data());
+        if (err == NO_ERROR) {
+            for (buffer_handle_t handle : handles) {
+                addAllocRec(handle, request, stride);
+                outResults->emplace_back(handle, stride);
+            }
+            remaining = 0;
+        } else if (err != UNKNOWN_TRANSACTION) {
+            ALOGE("Failed to allocate %u x (%u x %u) layerCount %u format %d "
+                  "usage %" PRIx64 ": %d",
+                  remaining, request.width, request.height, request.layerCount, request.format,
+                  request.usage, err);
+            freeResults();
+            return err;
+        }
+    }
+
+    // The allocator can't allocate several buffers at once, so fall back to one at a time.
+    for (; remaining > 0; remaining--) {
+        auto result = allocate(request);
+        if (result.status != NO_ERROR) {
+            freeResults();
+            return result.status;
+        }
+        outResults->push_back(result);
+    }
+    return NO_ERROR;
+}
+
+status_t GraphicBufferAllocator::checkRequest(const AllocationRequest& request) {
+    if (!request.width || !request.height) {
+        return BAD_VALUE;
+    }
+
+    const uint32_t bpp = bytesPerPixel(request.format);
+    if (std::numeric_limits<size_t>::max() / request.width / request.height <
+        static_cast<size_t>(bpp)) {
+        ALOGE("Failed to allocate (%u x %u) layerCount %u format %d "
+              "usage %" PRIx64 ": Requesting too large a buffer size",
+              request.width, request.height, request.layerCount, request.format, request.usage);
+        return BAD_VALUE;
+    }
+
+    if (request.layerCount < 1) {
+        return BAD_VALUE;
+    }
+    return NO_ERROR;
+}
+
+void GraphicBufferAllocator::addAllocRec(buffer_handle_t handle, const AllocationRequest& request,
+                                         uint32_t stride) {
+    const uint32_t bpp = bytesPerPixel(request.format);
     size_t bufSize;
 
     // if stride has no meaning or is too large,
     // approximate size with the input width instead
-    if ((result.stride) != 0 &&
-        std::numeric_limits<size_t>::max() / height / (result.stride) < static_cast<size_t>(bpp)) {
-        bufSize = static_cast<size_t>(width) * height * bpp;
+    if (stride != 0 &&
+        std::numeric_limits<size_t>::max() / request.height / stride < static_cast<size_t>(bpp)) {
+        bufSize = static_cast<size_t>(request.width) * request.height * bpp;
     } else {
-        bufSize = static_cast<size_t>((result.stride)) * height * bpp;
+        bufSize = static_cast<size_t>(stride) * request.height * bpp;
     }
 
     Mutex::Autolock _l(sLock);
     KeyedVector<buffer_handle_t, alloc_rec_t>& list(sAllocList);
     alloc_rec_t rec;
-    rec.width = width;
-    rec.height = height;
-    rec.stride = result.stride;
+    rec.width = request.width;
+    rec.height = request.height;
+    rec.stride = stride;
     rec.format = request.format;
     rec.layerCount = request.layerCount;
     rec.usage = request.usage;
     rec.size = bufSize;
     rec.requestorName = request.requestorName;
-    list.add(result.handle, rec);
-
-    return result;
+    list.add(handle, rec);
 }
 
 status_t GraphicBufferAllocator::allocateHelper(uint32_t width, uint32_t height, PixelFormat format,
@@ -213,6 +309,12 @@ status_t GraphicBufferAllocator::allocateHelper(uint32_t width, uint32_t height,
     // TODO(b/72323293, b/72703005): Remove these invalid bits from callers
     usage &= ~static_cast<uint64_t>((1 << 10) | (1 << 13));
 
+    if (importBuffer &&
+        takeRecycledBuffer(width, height, format, layerCount, usage, requestorName, handle,
+                           stride)) {
+        return NO_ERROR;
+    }
+
     status_t error = mAllocator->allocate(requestorName, width, height, format, layerCount, usage,
                                           stride, handle, importBuffer);
     if (error != NO_ERROR) {
@@ -280,17 +382,96 @@ status_t GraphicBufferAllocator::free(buffer_handle_t handle)
 {
     ATRACE_CALL();
 
+    bool recycled = false;
+    std::vector<buffer_handle_t> expired;
+    {
+        Mutex::Autolock _l(sLock);
+        KeyedVector<buffer_handle_t, alloc_rec_t>& list(sAllocList);
+        const ssize_t index = list.indexOfKey(handle);
+        if (index >= 0) {
+            const alloc_rec_t& rec = list.valueAt(index);
+            if (rec.size && rec.size <= sRecycleBudget) {
+                const nsecs_t now = systemTime();
+                sRecyclePool.push_back({handle, rec, now});
+                sRecyclePoolSize += rec.size;
+                recycled = true;
+                trimRecyclePoolLocked(now, &expired);
+            }
+            list.removeItemsAt(index);
+        }
+    }
+
     // We allocated a buffer from the allocator and imported it into the
     // mapper to get the handle.  We just need to free the handle now.
-    mMapper.freeBuffer(handle);
-
-    Mutex::Autolock _l(sLock);
-    KeyedVector<buffer_handle_t, alloc_rec_t>& list(sAllocList);
-    list.removeItem(handle);
+    if (!recycled) {
+        mMapper.freeBuffer(handle);
+    }
+    for (buffer_handle_t expiredHandle : expired) {
+        mMapper.freeBuffer(expiredHandle);
+    }
 
     return NO_ERROR;
 }
 
+void GraphicBufferAllocator::setRecyclingBudget(size_t budgetBytes) {
+    std::vector<buffer_handle_t> expired;
+    {
+        Mutex::Autolock _l(sLock);
+        sRecycleBudget = budgetBytes;
+        trimRecyclePoolLocked(systemTime(), &expired);
+    }
+    for (buffer_handle_t handle : expired) {
+        mMapper.freeBuffer(handle);
+    }
+}
+
+bool GraphicBufferAllocator::takeRecycledBuffer(uint32_t width, uint32_t height,
+                                                PixelFormat format, uint32_t layerCount,
+                                                uint64_t usage, const std::string& requestorName,
+                                                buffer_handle_t* handle, uint32_t* stride) {
+    std::vector<buffer_handle_t> expired;
+    bool found = false;
+    {
+        Mutex::Autolock _l(sLock);
+        if (sRecyclePool.empty()) {
+            return false;
+        }
+        trimRecyclePoolLocked(systemTime(), &expired);
+
+        // Prefer the most recently freed buffer, whose memory is the most likely to be resident.
+        for (auto it = sRecyclePool.rbegin(); it != sRecyclePool.rend(); ++it) {
+            alloc_rec_t& rec = it->rec;
+            if (rec.width == width && rec.height == height && rec.format == format &&
+                rec.layerCount == layerCount && rec.usage == usage) {
+                ATRACE_NAME("recycled");
+                *handle = it->handle;
+                *stride = rec.stride;
+                sRecyclePoolSize -= rec.size;
+                rec.requestorName = requestorName;
+                sAllocList.add(*handle, rec);
+                sRecyclePool.erase(std::next(it).base());
+                found = true;
+                break;
+            }
+        }
+    }
+    for (buffer_handle_t expiredHandle : expired) {
+        mMapper.freeBuffer(expiredHandle);
+    }
+    return found;
+}
+
+void GraphicBufferAllocator::trimRecyclePoolLocked(nsecs_t now,
+                                                   std::vector<buffer_handle_t>* expired) {
+    while (!sRecyclePool.empty() &&
+           (sRecyclePoolSize > sRecycleBudget ||
+            now - sRecyclePool.front().freeTime > kRecycleIdleTimeout)) {
+        expired->push_back(sRecyclePool.front().handle);
+        sRecyclePoolSize -= sRecyclePool.front().rec.size;
+        sRecyclePool.pop_front();
+    }
+}
+
 bool GraphicBufferAllocator::supportsAdditionalOptions() const {
     return mAllocator->supportsAdditionalOptions();
 }
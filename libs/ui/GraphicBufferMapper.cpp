@@ -20,6 +20,8 @@
 
 #include <ui/GraphicBufferMapper.h>
 
+#include <inttypes.h>
+
 #include <grallocusage/GrallocUsageConversion.h>
 
 // We would eliminate the non-conforming zero-length array, but we can't since
@@ -29,6 +31,7 @@
 #include <sync/sync.h>
 #pragma clang diagnostic pop
 
+#include <android-base/stringprintf.h>
 #include <utils/Log.h>
 #include <utils/Trace.h>
 
@@ -93,6 +96,45 @@ void GraphicBufferMapper::dumpBufferToSystemLog(buffer_handle_t bufferHandle, bo
     ALOGD("%s", s.c_str());
 }
 
+void GraphicBufferMapper::dumpMetadataCache(std::string& result) const {
+    std::lock_guard<std::mutex> lock(mMetadataCacheMutex);
+    base::StringAppendF(&result,
+                        "GraphicBufferMapper metadata cache: %zu buffers, %" PRIu64
+                        " hits, %" PRIu64 " misses\n",
+                        mMetadataCache.size(), mMetadataCacheHits, mMetadataCacheMisses);
+}
+
+template <typename T, typename Getter>
+status_t GraphicBufferMapper::getImmutableMetadata(buffer_handle_t bufferHandle,
+                                                   std::optional<T> ImmutableMetadata::*field,
+                                                   T* outValue, Getter&& getter) {
+    {
+        std::lock_guard<std::mutex> lock(mMetadataCacheMutex);
+        auto it = mMetadataCache.find(bufferHandle);
+        if (it != mMetadataCache.end() && it->second.*field) {
+            mMetadataCacheHits++;
+            *outValue = *(it->second.*field);
+            return OK;
+        }
+        mMetadataCacheMisses++;
+    }
+
+    T value;
+    status_t status = getter(&value);
+    if (status != OK) {
+        return status;
+    }
+
+    // Only handles that the HAL accepted, and which are therefore imported, are cached. Those
+    // are released through freeBuffer, which drops their entry.
+    {
+        std::lock_guard<std::mutex> lock(mMetadataCacheMutex);
+        mMetadataCache[bufferHandle].*field = value;
+    }
+    *outValue = std::move(value);
+    return OK;
+}
+
 status_t GraphicBufferMapper::importBuffer(const native_handle_t* rawHandle, uint32_t width,
                                            uint32_t height, uint32_t layerCount, PixelFormat format,
                                            uint64_t usage, uint32_t stride,
@@ -134,6 +176,10 @@ status_t GraphicBufferMapper::freeBuffer(buffer_handle_t handle)
 {
     ATRACE_CALL();
 
+    {
+        std::lock_guard<std::mutex> lock(mMetadataCacheMutex);
+        mMetadataCache.erase(handle);
+    }
     mMapper->freeBuffer(handle);
 
     return NO_ERROR;
@@ -256,26 +302,44 @@ status_t GraphicBufferMapper::getPixelFormatRequested(buffer_handle_t bufferHand
 
 status_t GraphicBufferMapper::getPixelFormatFourCC(buffer_handle_t bufferHandle,
                                                    uint32_t* outPixelFormatFourCC) {
-    return mMapper->getPixelFormatFourCC(bufferHandle, outPixelFormatFourCC);
+    return getImmutableMetadata(bufferHandle, &ImmutableMetadata::pixelFormatFourCC,
+                                outPixelFormatFourCC,
+                                [&](uint32_t* value) {
+                                    return mMapper->getPixelFormatFourCC(bufferHandle, value);
+                                });
 }
 
 status_t GraphicBufferMapper::getPixelFormatModifier(buffer_handle_t bufferHandle,
                                                      uint64_t* outPixelFormatModifier) {
-    return mMapper->getPixelFormatModifier(bufferHandle, outPixelFormatModifier);
+    return getImmutableMetadata(bufferHandle, &ImmutableMetadata::pixelFormatModifier,
+                                outPixelFormatModifier,
+                                [&](uint64_t* value) {
+                                    return mMapper->getPixelFormatModifier(bufferHandle, value);
+                                });
 }
 
 status_t GraphicBufferMapper::getUsage(buffer_handle_t bufferHandle, uint64_t* outUsage) {
-    return mMapper->getUsage(bufferHandle, outUsage);
+    return getImmutableMetadata(bufferHandle, &ImmutableMetadata::usage, outUsage,
+                                [&](uint64_t* value) {
+                                    return mMapper->getUsage(bufferHandle, value);
+                                });
 }
 
 status_t GraphicBufferMapper::getAllocationSize(buffer_handle_t bufferHandle,
                                                 uint64_t* outAllocationSize) {
-    return mMapper->getAllocationSize(bufferHandle, outAllocationSize);
+    return getImmutableMetadata(bufferHandle, &ImmutableMetadata::allocationSize, outAllocationSize,
+                                [&](uint64_t* value) {
+                                    return mMapper->getAllocationSize(bufferHandle, value);
+                                });
 }
 
 status_t GraphicBufferMapper::getProtectedContent(buffer_handle_t bufferHandle,
                                                   uint64_t* outProtectedContent) {
-    return mMapper->getProtectedContent(bufferHandle, outProtectedContent);
+    return getImmutableMetadata(bufferHandle, &ImmutableMetadata::protectedContent,
+                                outProtectedContent,
+                                [&](uint64_t* value) {
+                                    return mMapper->getProtectedContent(bufferHandle, value);
+                                });
 }
 
 status_t GraphicBufferMapper::getCompression(
@@ -313,13 +377,16 @@ status_t GraphicBufferMapper::getChromaSiting(buffer_handle_t bufferHandle,
 
 status_t GraphicBufferMapper::getPlaneLayouts(buffer_handle_t bufferHandle,
                                               std::vector<ui::PlaneLayout>* outPlaneLayouts) {
-    return mMapper->getPlaneLayouts(bufferHandle, outPlaneLayouts);
+    return getImmutableMetadata(bufferHandle, &ImmutableMetadata::planeLayouts, outPlaneLayouts,
+                                [&](std::vector<ui::PlaneLayout>* value) {
+                                    return mMapper->getPlaneLayouts(bufferHandle, value);
+                                });
 }
 
 ui::Result<std::vector<ui::PlaneLayout>> GraphicBufferMapper::getPlaneLayouts(
         buffer_handle_t bufferHandle) {
     std::vector<ui::PlaneLayout> temp;
-    status_t status = mMapper->getPlaneLayouts(bufferHandle, &temp);
+    status_t status = getPlaneLayouts(bufferHandle, &temp);
     if (status == OK) {
         return std::move(temp);
     } else {
@@ -19,6 +19,15 @@
 #include <inttypes.h>
 #include <limits.h>
 
+#include <algorithm>
+#include <atomic>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE4_1__)
+#include <smmintrin.h>
+#endif
+
 #include <android-base/stringprintf.h>
 
 #include <utils/Log.h>
@@ -66,6 +75,174 @@ const Region Region::INVALID_REGION(Rect::INVALID_RECT);
 
 // ----------------------------------------------------------------------------
 
+namespace {
+
+std::atomic<bool> sFastPathsEnabled = true;
+
+static_assert(sizeof(Rect) == 4 * sizeof(int32_t), "Rect must be 4 packed int32_t");
+
+// Returns the intersection of a and b, which may be an empty (or inverted) rect.
+// {left, top, right, bottom} is loaded as a single vector: the result is
+// {max(l), max(t), min(r), min(b)}.
+inline Rect intersectRects(const Rect& a, const Rect& b) {
+    Rect result;
+#if defined(__ARM_NEON)
+    const int32x4_t va = vld1q_s32(&a.left);
+    const int32x4_t vb = vld1q_s32(&b.left);
+    vst1q_s32(&result.left,
+              vcombine_s32(vget_low_s32(vmaxq_s32(va, vb)), vget_high_s32(vminq_s32(va, vb))));
+#elif defined(__SSE4_1__)
+    const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&a.left));
+    const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&b.left));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&result.left),
+                     _mm_blend_epi16(_mm_max_epi32(va, vb), _mm_min_epi32(va, vb), 0xF0));
+#else
+    result.left = std::max(a.left, b.left);
+    result.top = std::max(a.top, b.top);
+    result.right = std::min(a.right, b.right);
+    result.bottom = std::min(a.bottom, b.bottom);
+#endif
+    return result;
+}
+
+inline bool rectContains(const Rect& outer, const Rect& inner) {
+    return intersectRects(outer, inner) == inner;
+}
+
+} // namespace
+
+void Region::setFastPathsEnabled(bool enabled) {
+    sFastPathsEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+// Handles the cases that can be resolved from the bounds of lhs and rhs alone,
+// which covers most of the rect-vs-region operations done when computing
+// visible and covered regions. Returns false if the full rasterizer is needed.
+bool Region::tryFastBooleanOperation(uint32_t op, Region& dst, const Region& lhs,
+                                     const Rect& rhs) {
+    if (!sFastPathsEnabled.load(std::memory_order_relaxed)) {
+        return false;
+    }
+
+    const auto assignLhs = [&dst, &lhs] {
+        if (&dst != &lhs) dst = lhs;
+        return true;
+    };
+    const auto assignRect = [&dst](const Rect& rect) {
+        dst.set(rect);
+        return true;
+    };
+    const auto assignEmpty = [&dst] {
+        dst.clear();
+        return true;
+    };
+
+    // Empty operands may still have non-zero bounds, while the rasterizer always
+    // produces the canonical empty region.
+    if (lhs.isEmpty()) {
+        return (op == op_and || op == op_nand || rhs.isEmpty()) ? assignEmpty()
+                                                                : assignRect(rhs);
+    }
+    if (rhs.isEmpty()) {
+        return op == op_and ? assignEmpty() : assignLhs();
+    }
+
+    const Rect bounds = lhs.getBounds();
+    const Rect intersection = intersectRects(bounds, rhs);
+    if (intersection.isEmpty()) {
+        switch (op) {
+            case op_and:
+                return assignEmpty();
+            case op_nand:
+                return assignLhs();
+            default:
+                return false;
+        }
+    }
+
+    if (intersection == bounds) {
+        // rhs covers all of lhs.
+        switch (op) {
+            case op_and:
+                return assignLhs();
+            case op_nand:
+                return assignEmpty();
+            case op_or:
+                return assignRect(rhs);
+            default:
+                return false;
+        }
+    }
+
+    if (!lhs.isRect()) {
+        return false;
+    }
+
+    switch (op) {
+        case op_and:
+            return assignRect(intersection);
+        case op_or:
+            return rectContains(bounds, rhs) ? assignLhs() : false;
+        default:
+            return false;
+    }
+}
+
+// Like tryFastBooleanOperation, but for a complex rhs of which only the bounds
+// are known. Only operations whose result doesn't depend on the shape of rhs
+// are resolved.
+bool Region::tryFastDisjointBooleanOperation(uint32_t op, Region& dst, const Region& lhs,
+                                             const Rect& rhsBounds) {
+    if (!sFastPathsEnabled.load(std::memory_order_relaxed) ||
+        (op != op_and && op != op_nand)) {
+        return false;
+    }
+
+    if (lhs.isEmpty() || (op == op_and && intersectRects(lhs.getBounds(), rhsBounds).isEmpty())) {
+        dst.clear();
+        return true;
+    }
+    if (op == op_nand && intersectRects(lhs.getBounds(), rhsBounds).isEmpty()) {
+        if (&dst != &lhs) dst = lhs;
+        return true;
+    }
+    return false;
+}
+
+// Runs the fast paths in place, so that operationSelf() only needs to copy
+// *this when the rasterizer is actually used. rhs may alias mStorage, so it is
+// copied (or reduced to its bounds) before dst is modified.
+bool Region::tryFastOperationSelf(uint32_t op, const Rect& rhs) {
+#if !VALIDATE_WITH_CORECG && !defined(VALIDATE_REGIONS)
+    if (!rhs.isValid() && rhs != Rect::INVALID_RECT) {
+        return false;
+    }
+    const Rect rect = rhs;
+    return tryFastBooleanOperation(op, *this, *this, rect);
+#else
+    (void)op;
+    (void)rhs;
+    return false;
+#endif
+}
+
+bool Region::tryFastOperationSelf(uint32_t op, const Region& rhs, int dx, int dy) {
+#if !VALIDATE_WITH_CORECG && !defined(VALIDATE_REGIONS)
+    Rect rhsBounds = rhs.getBounds();
+    rhsBounds.offsetBy(dx, dy);
+    return rhs.isRect() ? tryFastBooleanOperation(op, *this, *this, rhsBounds)
+                        : tryFastDisjointBooleanOperation(op, *this, *this, rhsBounds);
+#else
+    (void)op;
+    (void)rhs;
+    (void)dx;
+    (void)dy;
+    return false;
+#endif
+}
+
+// ----------------------------------------------------------------------------
+
 Region::Region() {
     mStorage.push_back(Rect(0, 0));
 }
@@ -101,7 +278,8 @@ Region::~Region()
  * final, correctly ordered region buffer. Each rectangle will be compared with the span directly
  * above it, and subdivided to resolve any remaining T-junctions.
  */
-static void reverseRectsResolvingJunctions(const Rect* begin, const Rect* end, FatVector<Rect>& dst,
+template <typename Storage>
+static void reverseRectsResolvingJunctions(const Rect* begin, const Rect* end, Storage& dst,
                                            int spanDirection) {
     dst.clear();
 
@@ -202,7 +380,7 @@ Region Region::createTJunctionFreeRegion(const Region& r) {
     if (r.isEmpty()) return r;
     if (r.isRect()) return r;
 
-    FatVector<Rect> reversed;
+    FatVector<Rect, kInlineRectCount> reversed;
     reverseRectsResolvingJunctions(r.begin(), r.end(), reversed, direction_RTL);
 
     Region outputRegion;
@@ -329,6 +507,9 @@ Region& Region::subtractSelf(const Rect& r) {
     return operationSelf(r, op_nand);
 }
 Region& Region::operationSelf(const Rect& r, uint32_t op) {
+    if (tryFastOperationSelf(op, r)) {
+        return *this;
+    }
     Region lhs(*this);
     boolean_operation(op, *this, lhs, r);
     return *this;
@@ -353,6 +534,9 @@ Region& Region::subtractSelf(const Region& rhs) {
     return operationSelf(rhs, op_nand);
 }
 Region& Region::operationSelf(const Region& rhs, uint32_t op) {
+    if (tryFastOperationSelf(op, rhs, 0, 0)) {
+        return *this;
+    }
     Region lhs(*this);
     boolean_operation(op, *this, lhs, rhs);
     return *this;
@@ -438,6 +622,9 @@ Region& Region::subtractSelf(const Region& rhs, int dx, int dy) {
     return operationSelf(rhs, dx, dy, op_nand);
 }
 Region& Region::operationSelf(const Region& rhs, int dx, int dy, uint32_t op) {
+    if (tryFastOperationSelf(op, rhs, dx, dy)) {
+        return *this;
+    }
     Region lhs(*this);
     boolean_operation(op, *this, lhs, rhs, dx, dy);
     return *this;
@@ -470,7 +657,7 @@ const Region Region::operation(const Region& rhs, int dx, int dy, uint32_t op) c
 class Region::rasterizer : public region_operator<Rect>::region_rasterizer
 {
     Rect bounds;
-    FatVector<Rect>& storage;
+    FatVector<Rect, kInlineRectCount>& storage;
     Rect* head;
     Rect* tail;
     FatVector<Rect> span;
@@ -653,6 +840,15 @@ void Region::boolean_operation(uint32_t op, Region& dst,
     validate(dst, "boolean_operation (before): dst");
 #endif
 
+#if !VALIDATE_WITH_CORECG && !defined(VALIDATE_REGIONS)
+    Rect rhsBounds = rhs.getBounds();
+    rhsBounds.offsetBy(dx, dy);
+    if (rhs.isRect() ? tryFastBooleanOperation(op, dst, lhs, rhsBounds)
+                     : tryFastDisjointBooleanOperation(op, dst, lhs, rhsBounds)) {
+        return;
+    }
+#endif
+
     size_t lhs_count;
     Rect const * const lhs_rects = lhs.getArray(&lhs_count);
 
@@ -767,6 +963,12 @@ void Region::boolean_operation(uint32_t op, Region& dst,
 #if VALIDATE_WITH_CORECG || defined(VALIDATE_REGIONS)
     boolean_operation(op, dst, lhs, Region(rhs), dx, dy);
 #else
+    Rect translatedRhs = rhs;
+    translatedRhs.offsetBy(dx, dy);
+    if (tryFastBooleanOperation(op, dst, lhs, translatedRhs)) {
+        return;
+    }
+
     size_t lhs_count;
     Rect const * const lhs_rects = lhs.getArray(&lhs_count);
 
@@ -19,6 +19,9 @@
 
 #include <math.h>
 
+#include <algorithm>
+#include <utility>
+
 #include <android-base/stringprintf.h>
 #include <cutils/compiler.h>
 #include <ui/Region.h>
@@ -253,53 +256,56 @@ vec2 Transform::transform(float x, float y) const {
     return transform(vec2(x, y));
 }
 
+// Returns the top-left and bottom-right corners of the bounds of the transformed rect.
+static std::pair<vec2, vec2> transformBounds(const Transform& t, float left, float top,
+                                             float right, float bottom) {
+    const vec2 lt = t.transform(vec2(left, top));
+    const vec2 rb = t.transform(vec2(right, bottom));
+    if (CC_LIKELY(t.preserveRects())) {
+        // The result is axis aligned and the images of two opposite corners are opposite
+        // corners of it, so the two other corners don't need to be transformed.
+        return {vec2(std::min(lt[0], rb[0]), std::min(lt[1], rb[1])),
+                vec2(std::max(lt[0], rb[0]), std::max(lt[1], rb[1]))};
+    }
+    const vec2 rt = t.transform(vec2(right, top));
+    const vec2 lb = t.transform(vec2(left, bottom));
+    return {vec2(std::min({lt[0], rt[0], lb[0], rb[0]}), std::min({lt[1], rt[1], lb[1], rb[1]})),
+            vec2(std::max({lt[0], rt[0], lb[0], rb[0]}), std::max({lt[1], rt[1], lb[1], rb[1]}))};
+}
+
 Rect Transform::makeBounds(int w, int h) const {
     return transform( Rect(w, h) );
 }
 
 Rect Transform::transform(const Rect& bounds, bool roundOutwards) const {
     Rect r;
-    vec2 lt( bounds.left,  bounds.top    );
-    vec2 rt( bounds.right, bounds.top    );
-    vec2 lb( bounds.left,  bounds.bottom );
-    vec2 rb( bounds.right, bounds.bottom );
-
-    lt = transform(lt);
-    rt = transform(rt);
-    lb = transform(lb);
-    rb = transform(rb);
+    const auto [topLeft, bottomRight] =
+            transformBounds(*this, bounds.left, bounds.top, bounds.right, bounds.bottom);
 
     if (roundOutwards) {
-        r.left   = static_cast<int32_t>(floorf(std::min({lt[0], rt[0], lb[0], rb[0]})));
-        r.top    = static_cast<int32_t>(floorf(std::min({lt[1], rt[1], lb[1], rb[1]})));
-        r.right  = static_cast<int32_t>(ceilf(std::max({lt[0], rt[0], lb[0], rb[0]})));
-        r.bottom = static_cast<int32_t>(ceilf(std::max({lt[1], rt[1], lb[1], rb[1]})));
+        r.left   = static_cast<int32_t>(floorf(topLeft[0]));
+        r.top    = static_cast<int32_t>(floorf(topLeft[1]));
+        r.right  = static_cast<int32_t>(ceilf(bottomRight[0]));
+        r.bottom = static_cast<int32_t>(ceilf(bottomRight[1]));
     } else {
-        r.left   = static_cast<int32_t>(floorf(std::min({lt[0], rt[0], lb[0], rb[0]}) + 0.5f));
-        r.top    = static_cast<int32_t>(floorf(std::min({lt[1], rt[1], lb[1], rb[1]}) + 0.5f));
-        r.right  = static_cast<int32_t>(floorf(std::max({lt[0], rt[0], lb[0], rb[0]}) + 0.5f));
-        r.bottom = static_cast<int32_t>(floorf(std::max({lt[1], rt[1], lb[1], rb[1]}) + 0.5f));
+        r.left   = static_cast<int32_t>(floorf(topLeft[0] + 0.5f));
+        r.top    = static_cast<int32_t>(floorf(topLeft[1] + 0.5f));
+        r.right  = static_cast<int32_t>(floorf(bottomRight[0] + 0.5f));
+        r.bottom = static_cast<int32_t>(floorf(bottomRight[1] + 0.5f));
     }
 
     return r;
 }
 
 FloatRect Transform::transform(const FloatRect& bounds) const {
-    vec2 lt(bounds.left, bounds.top);
-    vec2 rt(bounds.right, bounds.top);
-    vec2 lb(bounds.left, bounds.bottom);
-    vec2 rb(bounds.right, bounds.bottom);
-
-    lt = transform(lt);
-    rt = transform(rt);
-    lb = transform(lb);
-    rb = transform(rb);
+    const auto [topLeft, bottomRight] =
+            transformBounds(*this, bounds.left, bounds.top, bounds.right, bounds.bottom);
 
     FloatRect r;
-    r.left = std::min({lt[0], rt[0], lb[0], rb[0]});
-    r.top = std::min({lt[1], rt[1], lb[1], rb[1]});
-    r.right = std::max({lt[0], rt[0], lb[0], rb[0]});
-    r.bottom = std::max({lt[1], rt[1], lb[1], rb[1]});
+    r.left = topLeft[0];
+    r.top = topLeft[1];
+    r.right = bottomRight[0];
+    r.bottom = bottomRight[1];
 
     return r;
 }
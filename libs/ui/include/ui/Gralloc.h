@@ -227,6 +227,19 @@ public:
         return GraphicBufferAllocator::AllocationResult(UNKNOWN_TRANSACTION);
     }
 
+    /*
+     * Allocates bufferCount buffers matching the request in a single allocator call.
+     * outBufferHandles must point to a space that can contain at least "bufferCount"
+     * buffer_handle_t, all of which share outStride. Either all buffers are returned or none.
+     * Returns UNKNOWN_TRANSACTION if the allocator does not support it, in which case the caller
+     * should allocate the buffers one at a time.
+     */
+    virtual status_t allocateMultiple(const GraphicBufferAllocator::AllocationRequest&,
+                                      uint32_t /*bufferCount*/, uint32_t* /*outStride*/,
+                                      buffer_handle_t* /*outBufferHandles*/) const {
+        return UNKNOWN_TRANSACTION;
+    }
+
     virtual bool supportsAdditionalOptions() const { return false; }
 };
 
@@ -178,6 +178,10 @@ public:
     [[nodiscard]] GraphicBufferAllocator::AllocationResult allocate(
             const GraphicBufferAllocator::AllocationRequest&) const override;
 
+    [[nodiscard]] status_t allocateMultiple(const GraphicBufferAllocator::AllocationRequest&,
+                                            uint32_t bufferCount, uint32_t* outStride,
+                                            buffer_handle_t* outBufferHandles) const override;
+
     bool supportsAdditionalOptions() const override { return true; }
 
 private:
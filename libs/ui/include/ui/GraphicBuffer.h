@@ -106,6 +106,11 @@ public:
 
     GraphicBuffer(const GraphicBufferAllocator::AllocationRequest&);
 
+    // Create count GraphicBuffers matching the request, with
+    // GraphicBufferAllocator::allocateMultiple. On error, no buffer is returned.
+    static status_t allocateMultiple(const GraphicBufferAllocator::AllocationRequest& request,
+                                     uint32_t count, std::vector<sp<GraphicBuffer>>* outBuffers);
+
     // Create a GraphicBuffer from an existing handle.
     enum HandleWrapMethod : uint8_t {
         // Wrap and use the handle directly.  It assumes the handle has been
@@ -263,6 +268,10 @@ private:
                             uint32_t inWidth, uint32_t inHeight, PixelFormat inFormat,
                             uint32_t inLayerCount, uint64_t inUsage, uint32_t inStride);
 
+    // Takes ownership of a buffer allocated by GraphicBufferAllocator for the request.
+    void initWithAllocationResult(const GraphicBufferAllocator::AllocationRequest& request,
+                                  const GraphicBufferAllocator::AllocationResult& result);
+
     void free_handle();
 
     GraphicBufferMapper& mBufferMapper;
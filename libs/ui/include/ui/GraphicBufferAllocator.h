@@ -20,6 +20,7 @@
 
 #include <stdint.h>
 
+#include <deque>
 #include <memory>
 #include <string>
 #include <vector>
@@ -32,6 +33,7 @@
 #include <utils/KeyedVector.h>
 #include <utils/Mutex.h>
 #include <utils/Singleton.h>
+#include <utils/Timers.h>
 
 namespace android {
 
@@ -72,6 +74,16 @@ public:
 
     AllocationResult allocate(const AllocationRequest&);
 
+    /**
+     * Allocates and imports count buffers matching the request, in a single allocator call when
+     * the allocator supports it and one call per buffer otherwise. Recycled buffers are used
+     * first. Either all buffers are returned in outResults or, on error, none is.
+     *
+     * Each handle must be freed with GraphicBufferAllocator::free() when no longer needed.
+     */
+    status_t allocateMultiple(const AllocationRequest&, uint32_t count,
+                              std::vector<AllocationResult>* outResults);
+
     /**
      * Allocates and imports a gralloc buffer.
      *
@@ -102,6 +114,17 @@ public:
 
     status_t free(buffer_handle_t handle);
 
+    /**
+     * Opts the process into recycling imported buffers. Up to budgetBytes of freed buffers are
+     * kept, and handed back by a later allocation with the same width, height, format, layer
+     * count and usage instead of going through the allocator HAL. Recycled buffers keep their
+     * previous contents. Buffers that stay unused for a few seconds are released on a later
+     * allocate() or free(). A budget of 0, the default, disables recycling and releases every
+     * kept buffer.
+     */
+    void setRecyclingBudget(size_t budgetBytes);
+
+    // Includes the buffers kept for recycling.
     uint64_t getTotalSize() const;
 
     void dump(std::string& res, bool less = true) const;
@@ -121,12 +144,33 @@ protected:
         std::string requestorName;
     };
 
+    static status_t checkRequest(const AllocationRequest&);
+    // Registers an imported buffer in sAllocList.
+    void addAllocRec(buffer_handle_t handle, const AllocationRequest&, uint32_t stride);
+
     status_t allocateHelper(uint32_t w, uint32_t h, PixelFormat format, uint32_t layerCount,
                             uint64_t usage, buffer_handle_t* handle, uint32_t* stride,
                             std::string requestorName, bool importBuffer);
 
+    struct recycled_rec_t {
+        buffer_handle_t handle;
+        alloc_rec_t rec;
+        nsecs_t freeTime;
+    };
+
+    // Returns true and registers a recycled buffer in sAllocList if one matches.
+    bool takeRecycledBuffer(uint32_t width, uint32_t height, PixelFormat format,
+                            uint32_t layerCount, uint64_t usage, const std::string& requestorName,
+                            buffer_handle_t* handle, uint32_t* stride);
+    // Moves the buffers that are idle or over budget from sRecyclePool to expired.
+    static void trimRecyclePoolLocked(nsecs_t now, std::vector<buffer_handle_t>* expired);
+
     static Mutex sLock;
     static KeyedVector<buffer_handle_t, alloc_rec_t> sAllocList;
+    // Ordered from the least to the most recently freed buffer.
+    static std::deque<recycled_rec_t> sRecyclePool;
+    static size_t sRecyclePoolSize;
+    static size_t sRecycleBudget;
 
     friend class Singleton<GraphicBufferAllocator>;
     GraphicBufferAllocator();
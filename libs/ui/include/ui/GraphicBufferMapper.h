@@ -21,6 +21,10 @@
 #include <sys/types.h>
 
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
 
 #include <android-base/unique_fd.h>
 #include <ui/GraphicTypes.h>
@@ -61,6 +65,9 @@ public:
     void dumpBuffer(buffer_handle_t bufferHandle, std::string& result, bool less = true) const;
     static void dumpBufferToSystemLog(buffer_handle_t bufferHandle, bool less = true);
 
+    // Appends the number of buffers and the hit rate of the immutable metadata cache.
+    void dumpMetadataCache(std::string& result) const;
+
     // The imported outHandle must be freed with freeBuffer when no longer
     // needed. rawHandle is owned by the caller.
     status_t importBuffer(const native_handle_t* rawHandle, uint32_t width, uint32_t height,
@@ -181,8 +188,30 @@ private:
 
     GraphicBufferMapper();
 
+    // Metadata that the gralloc HAL never changes after allocation, remembered per imported
+    // handle until freeBuffer. Mutable metadata, such as the dataspace, may be changed by other
+    // processes sharing the buffer, so it always comes from the HAL.
+    struct ImmutableMetadata {
+        std::optional<uint32_t> pixelFormatFourCC;
+        std::optional<uint64_t> pixelFormatModifier;
+        std::optional<uint64_t> usage;
+        std::optional<uint64_t> allocationSize;
+        std::optional<uint64_t> protectedContent;
+        std::optional<std::vector<ui::PlaneLayout>> planeLayouts;
+    };
+
+    template <typename T, typename Getter>
+    status_t getImmutableMetadata(buffer_handle_t bufferHandle,
+                                  std::optional<T> ImmutableMetadata::*field, T* outValue,
+                                  Getter&& getter);
+
     std::unique_ptr<const GrallocMapper> mMapper;
 
+    mutable std::mutex mMetadataCacheMutex;
+    std::unordered_map<buffer_handle_t, ImmutableMetadata> mMetadataCache;
+    uint64_t mMetadataCacheHits = 0;
+    uint64_t mMetadataCacheMisses = 0;
+
     Version mMapperVersion;
 };
 
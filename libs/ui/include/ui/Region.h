@@ -142,6 +142,11 @@ public:
             // be sorted in Y and X and must not make the region invalid.
             void        addRectUnchecked(int l, int t, int r, int b);
 
+            // enables or disables the fast paths that resolve common
+            // rect-vs-region operations from bounds without rasterizing.
+            // Enabled by default; intended for benchmarking and testing.
+    static  void        setFastPathsEnabled(bool enabled);
+
     inline  bool        isFixedSize() const { return false; }
             size_t      getFlattenedSize() const;
             status_t    flatten(void* buffer, size_t size) const;
@@ -154,6 +159,11 @@ private:
     class rasterizer;
     friend class rasterizer;
 
+    // Number of Rects (including the trailing bounds) stored inline before
+    // mStorage spills to the heap. This covers a rect with a hole punched in
+    // it (4 rects + bounds) as well as most L-shaped visible regions.
+    static constexpr size_t kInlineRectCount = 8;
+
     Region& operationSelf(const Rect& r, uint32_t op);
     Region& operationSelf(const Region& r, uint32_t op);
     Region& operationSelf(const Region& r, int dx, int dy, uint32_t op);
@@ -171,6 +181,13 @@ private:
     static void boolean_operation(uint32_t op, Region& dst,
             const Region& lhs, const Rect& rhs);
 
+    static bool tryFastBooleanOperation(uint32_t op, Region& dst,
+            const Region& lhs, const Rect& rhs);
+    static bool tryFastDisjointBooleanOperation(uint32_t op, Region& dst,
+            const Region& lhs, const Rect& rhsBounds);
+    bool tryFastOperationSelf(uint32_t op, const Rect& rhs);
+    bool tryFastOperationSelf(uint32_t op, const Region& rhs, int dx, int dy);
+
     static void translate(Region& reg, int dx, int dy);
     static void translate(Region& dst, const Region& reg, int dx, int dy);
 
@@ -181,7 +198,7 @@ private:
     // with an extra Rect as the last element which is set to the
     // bounds of the region. However, if the region is
     // a simple Rect then mStorage contains only that rect.
-    FatVector<Rect> mStorage;
+    FatVector<Rect, kInlineRectCount> mStorage;
 };
 
 
@@ -294,7 +294,18 @@ public:
         return apply(mTransform * linear, mDestination.getClamper());
     }
 
+    // Bulk variants of transform() and transformLinear(), converting count
+    // values from src into dst. The results are identical to calling the
+    // single value variants in a loop, but the matrix multiply is vectorized
+    // and the transfer and clamping functions are applied one channel at a
+    // time over short runs of pixels. src and dst may be the same buffer.
+    void transform(const float3* src, float3* dst, size_t count) const noexcept;
+    void transformLinear(const float3* src, float3* dst, size_t count) const noexcept;
+
 private:
+    template <bool kLinear>
+    void transformBulk(const float3* src, float3* dst, size_t count) const noexcept;
+
     ColorSpace mSource;
     ColorSpace mDestination;
     mat3 mTransform;
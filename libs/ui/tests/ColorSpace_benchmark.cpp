@@ -0,0 +1,85 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <ui/ColorSpace.h>
+
+#include <vector>
+
+namespace android {
+namespace {
+
+constexpr size_t kPixelCount = 1920 * 1080;
+
+std::vector<float3> makePixels() {
+    std::vector<float3> pixels(kPixelCount);
+    for (size_t i = 0; i < kPixelCount; i++) {
+        pixels[i] = {float(i % 255) / 254.0f, float(i % 127) / 126.0f, float(i % 63) / 62.0f};
+    }
+    return pixels;
+}
+
+void BM_ConnectorTransformSingle(benchmark::State& state) {
+    const ColorSpaceConnector connector(ColorSpace::DisplayP3(), ColorSpace::sRGB());
+    const std::vector<float3> src = makePixels();
+    std::vector<float3> dst(kPixelCount);
+    for (auto _ : state) {
+        for (size_t i = 0; i < kPixelCount; i++) {
+            dst[i] = connector.transform(src[i]);
+        }
+        benchmark::DoNotOptimize(dst.data());
+    }
+}
+BENCHMARK(BM_ConnectorTransformSingle)->Unit(benchmark::kMillisecond);
+
+void BM_ConnectorTransformBulk(benchmark::State& state) {
+    const ColorSpaceConnector connector(ColorSpace::DisplayP3(), ColorSpace::sRGB());
+    const std::vector<float3> src = makePixels();
+    std::vector<float3> dst(kPixelCount);
+    for (auto _ : state) {
+        connector.transform(src.data(), dst.data(), kPixelCount);
+        benchmark::DoNotOptimize(dst.data());
+    }
+}
+BENCHMARK(BM_ConnectorTransformBulk)->Unit(benchmark::kMillisecond);
+
+void BM_ConnectorTransformLinearSingle(benchmark::State& state) {
+    const ColorSpaceConnector connector(ColorSpace::linearExtendedSRGB(), ColorSpace::BT2020());
+    const std::vector<float3> src = makePixels();
+    std::vector<float3> dst(kPixelCount);
+    for (auto _ : state) {
+        for (size_t i = 0; i < kPixelCount; i++) {
+            dst[i] = connector.transformLinear(src[i]);
+        }
+        benchmark::DoNotOptimize(dst.data());
+    }
+}
+BENCHMARK(BM_ConnectorTransformLinearSingle)->Unit(benchmark::kMillisecond);
+
+void BM_ConnectorTransformLinearBulk(benchmark::State& state) {
+    const ColorSpaceConnector connector(ColorSpace::linearExtendedSRGB(), ColorSpace::BT2020());
+    const std::vector<float3> src = makePixels();
+    std::vector<float3> dst(kPixelCount);
+    for (auto _ : state) {
+        connector.transformLinear(src.data(), dst.data(), kPixelCount);
+        benchmark::DoNotOptimize(dst.data());
+    }
+}
+BENCHMARK(BM_ConnectorTransformLinearBulk)->Unit(benchmark::kMillisecond);
+
+} // namespace
+} // namespace android
@@ -53,6 +53,11 @@ public:
                     allocate)
                 .WillOnce(DoAll(SetArgPointee<6>(stride), Return(err)));
     }
+    void setUpAllocateExpectations(status_t err, uint32_t stride, buffer_handle_t handle) {
+        EXPECT_CALL(*(reinterpret_cast<const mock::MockGrallocAllocator*>(mAllocator.get())),
+                    allocate)
+                .WillOnce(DoAll(SetArgPointee<6>(stride), SetArgPointee<7>(handle), Return(err)));
+    }
     std::unique_ptr<const GrallocAllocator>& getAllocator() { return mAllocator; }
 };
 
@@ -113,4 +118,89 @@ TEST_F(GraphicBufferAllocatorTest, AllocateLargeStride) {
     ASSERT_EQ(NO_ERROR, err);
     ASSERT_EQ(expectedStride, stride);
 }
+
+TEST_F(GraphicBufferAllocatorTest, FreedBufferIsRecycled) {
+    android::PixelFormat format = PIXEL_FORMAT_RGBA_8888;
+    native_handle_t* fakeHandle = native_handle_create(0, 0);
+    mAllocator.setRecyclingBudget(kTestWidth * kTestHeight * 4);
+
+    // Only the first allocation goes through the allocator.
+    mAllocator.setUpAllocateExpectations(NO_ERROR, kTestWidth, fakeHandle);
+    uint32_t stride = 0;
+    buffer_handle_t handle = nullptr;
+    ASSERT_EQ(NO_ERROR,
+              mAllocator.allocate(kTestWidth, kTestHeight, format, kTestLayerCount, kTestUsage,
+                                  &handle, &stride, "GraphicBufferAllocatorTest"));
+    ASSERT_EQ(fakeHandle, handle);
+    ASSERT_EQ(NO_ERROR, mAllocator.free(handle));
+
+    stride = 0;
+    handle = nullptr;
+    ASSERT_EQ(NO_ERROR,
+              mAllocator.allocate(kTestWidth, kTestHeight, format, kTestLayerCount, kTestUsage,
+                                  &handle, &stride, "GraphicBufferAllocatorTest"));
+    EXPECT_EQ(fakeHandle, handle);
+    EXPECT_EQ(kTestWidth, stride);
+
+    mAllocator.setRecyclingBudget(0);
+    native_handle_delete(fakeHandle);
+}
+
+TEST_F(GraphicBufferAllocatorTest, AllocateMultipleUsesRecycledBuffersFirst) {
+    android::PixelFormat format = PIXEL_FORMAT_RGBA_8888;
+    native_handle_t* recycledHandle = native_handle_create(0, 0);
+    native_handle_t* newHandle = native_handle_create(0, 0);
+    mAllocator.setRecyclingBudget(kTestWidth * kTestHeight * 4);
+
+    mAllocator.setUpAllocateExpectations(NO_ERROR, kTestWidth, recycledHandle);
+    uint32_t stride = 0;
+    buffer_handle_t handle = nullptr;
+    ASSERT_EQ(NO_ERROR,
+              mAllocator.allocate(kTestWidth, kTestHeight, format, kTestLayerCount, kTestUsage,
+                                  &handle, &stride, "GraphicBufferAllocatorTest"));
+    ASSERT_EQ(NO_ERROR, mAllocator.free(handle));
+
+    // The mock allocator can't allocate several buffers at once, so the buffer which isn't
+    // recycled is allocated on its own.
+    mAllocator.setUpAllocateExpectations(NO_ERROR, kTestWidth, newHandle);
+    std::vector<GraphicBufferAllocator::AllocationResult> results;
+    ASSERT_EQ(NO_ERROR,
+              mAllocator.allocateMultiple(
+                      GraphicBufferAllocator::AllocationRequest{
+                              .importBuffer = true,
+                              .width = kTestWidth,
+                              .height = kTestHeight,
+                              .format = format,
+                              .layerCount = kTestLayerCount,
+                              .usage = kTestUsage,
+                              .requestorName = "GraphicBufferAllocatorTest",
+                      },
+                      2, &results));
+    ASSERT_EQ(2u, results.size());
+    EXPECT_EQ(recycledHandle, results[0].handle);
+    EXPECT_EQ(newHandle, results[1].handle);
+    EXPECT_EQ(kTestWidth, results[0].stride);
+    EXPECT_EQ(kTestWidth, results[1].stride);
+
+    mAllocator.setRecyclingBudget(0);
+    native_handle_delete(recycledHandle);
+    native_handle_delete(newHandle);
+}
+
+TEST_F(GraphicBufferAllocatorTest, AllocateMultipleRejectsRawHandles) {
+    std::vector<GraphicBufferAllocator::AllocationResult> results;
+    EXPECT_EQ(BAD_VALUE,
+              mAllocator.allocateMultiple(
+                      GraphicBufferAllocator::AllocationRequest{
+                              .importBuffer = false,
+                              .width = kTestWidth,
+                              .height = kTestHeight,
+                              .format = PIXEL_FORMAT_RGBA_8888,
+                              .layerCount = kTestLayerCount,
+                              .usage = kTestUsage,
+                              .requestorName = "GraphicBufferAllocatorTest",
+                      },
+                      2, &results));
+    EXPECT_TRUE(results.empty());
+}
 } // namespace android
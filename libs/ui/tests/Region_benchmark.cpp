@@ -0,0 +1,159 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <ui/Rect.h>
+#include <ui/Region.h>
+
+namespace android {
+namespace {
+
+// Each benchmark takes a single argument which enables (1) or disables (0) the
+// Region fast paths, so that both backends can be compared in a single run.
+void setFastPaths(const benchmark::State& state) {
+    Region::setFastPathsEnabled(state.range(0) != 0);
+}
+
+// Region keeps a small number of rects inline and only allocates for complex
+// regions. A result whose rects live outside of the Region object itself has
+// spilled to the heap, so counting those gives the allocations per iteration.
+bool isHeapBacked(const Region& region) {
+    const auto* begin = reinterpret_cast<const char*>(&region);
+    const auto* rects = reinterpret_cast<const char*>(region.begin());
+    return rects < begin || rects >= begin + sizeof(Region);
+}
+
+void reportHeapAllocations(benchmark::State& state, int64_t heapBackedResults) {
+    state.counters["heapAllocs"] =
+            benchmark::Counter(static_cast<double>(heapBackedResults),
+                               benchmark::Counter::kAvgIterations);
+}
+
+// A region made of numBands horizontal bands with two rects each, similar to
+// the visible region of a window partially covered by a few other windows.
+Region makeBandedRegion(int numBands) {
+    Region region;
+    for (int i = 0; i < numBands; i++) {
+        region.orSelf(Rect(0, i * 100, 400, i * 100 + 50));
+        region.orSelf(Rect(600, i * 100, 1000, i * 100 + 50));
+    }
+    return region;
+}
+
+void BM_RectIntersectRect(benchmark::State& state) {
+    setFastPaths(state);
+    const Region lhs(Rect(0, 0, 1080, 2400));
+    const Rect rhs(100, 100, 500, 900);
+    int64_t heapBackedResults = 0;
+    for (auto _ : state) {
+        const Region& result = lhs.intersect(rhs);
+        benchmark::DoNotOptimize(result);
+        heapBackedResults += isHeapBacked(result);
+    }
+    reportHeapAllocations(state, heapBackedResults);
+}
+BENCHMARK(BM_RectIntersectRect)->Arg(0)->Arg(1);
+
+void BM_RectSubtractCoveringRect(benchmark::State& state) {
+    setFastPaths(state);
+    const Region lhs(Rect(100, 100, 500, 900));
+    const Rect rhs(0, 0, 1080, 2400);
+    int64_t heapBackedResults = 0;
+    for (auto _ : state) {
+        const Region& result = lhs.subtract(rhs);
+        benchmark::DoNotOptimize(result);
+        heapBackedResults += isHeapBacked(result);
+    }
+    reportHeapAllocations(state, heapBackedResults);
+}
+BENCHMARK(BM_RectSubtractCoveringRect)->Arg(0)->Arg(1);
+
+void BM_RectSubtractPartialRect(benchmark::State& state) {
+    setFastPaths(state);
+    const Region lhs(Rect(0, 0, 1080, 2400));
+    const Rect rhs(100, 100, 500, 900);
+    int64_t heapBackedResults = 0;
+    for (auto _ : state) {
+        const Region& result = lhs.subtract(rhs);
+        benchmark::DoNotOptimize(result);
+        heapBackedResults += isHeapBacked(result);
+    }
+    reportHeapAllocations(state, heapBackedResults);
+}
+BENCHMARK(BM_RectSubtractPartialRect)->Arg(0)->Arg(1);
+
+void BM_RegionOrContainedRect(benchmark::State& state) {
+    setFastPaths(state);
+    const Region lhs(Rect(0, 0, 1080, 2400));
+    const Rect rhs(100, 100, 500, 900);
+    int64_t heapBackedResults = 0;
+    for (auto _ : state) {
+        Region region(lhs);
+        const Region& result = region.orSelf(rhs);
+        benchmark::DoNotOptimize(result);
+        heapBackedResults += isHeapBacked(result);
+    }
+    reportHeapAllocations(state, heapBackedResults);
+}
+BENCHMARK(BM_RegionOrContainedRect)->Arg(0)->Arg(1);
+
+void BM_BandedRegionIntersectDisjointRect(benchmark::State& state) {
+    setFastPaths(state);
+    const Region lhs = makeBandedRegion(8);
+    const Rect rhs(0, 2000, 1080, 2400);
+    int64_t heapBackedResults = 0;
+    for (auto _ : state) {
+        const Region& result = lhs.intersect(rhs);
+        benchmark::DoNotOptimize(result);
+        heapBackedResults += isHeapBacked(result);
+    }
+    reportHeapAllocations(state, heapBackedResults);
+}
+BENCHMARK(BM_BandedRegionIntersectDisjointRect)->Arg(0)->Arg(1);
+
+void BM_BandedRegionSubtractRegion(benchmark::State& state) {
+    setFastPaths(state);
+    const Region lhs = makeBandedRegion(8);
+    const Region rhs = makeBandedRegion(4);
+    int64_t heapBackedResults = 0;
+    for (auto _ : state) {
+        const Region& result = lhs.subtract(rhs);
+        benchmark::DoNotOptimize(result);
+        heapBackedResults += isHeapBacked(result);
+    }
+    reportHeapAllocations(state, heapBackedResults);
+}
+BENCHMARK(BM_BandedRegionSubtractRegion)->Arg(0)->Arg(1);
+
+void BM_BandedRegionMergeRegion(benchmark::State& state) {
+    setFastPaths(state);
+    const Region lhs = makeBandedRegion(8);
+    const Region rhs = makeBandedRegion(4).translate(200, 25);
+    int64_t heapBackedResults = 0;
+    for (auto _ : state) {
+        const Region& result = lhs.merge(rhs);
+        benchmark::DoNotOptimize(result);
+        heapBackedResults += isHeapBacked(result);
+    }
+    reportHeapAllocations(state, heapBackedResults);
+}
+BENCHMARK(BM_BandedRegionMergeRegion)->Arg(0)->Arg(1);
+
+} // namespace
+} // namespace android
+
+BENCHMARK_MAIN();
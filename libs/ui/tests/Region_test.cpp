@@ -17,6 +17,7 @@
 #define LOG_TAG "RegionTest"
 
 #include <stdlib.h>
+#include <vector>
 #include <ui/Region.h>
 #include <ui/Rect.h>
 #include <gtest/gtest.h>
@@ -179,5 +180,63 @@ TEST_F(RegionTest, RegionHash) {
     EXPECT_NE(std::hash<Region>{}(region1), std::hash<Region>{}(region2));
 }
 
+TEST_F(RegionTest, FastPathsMatchRasterizer) {
+    const Rect rects[] = {
+            Rect(0, 0, 0, 0),       Rect(0, 0, 100, 100),   Rect(10, 10, 50, 50),
+            Rect(-50, -50, 200, 200), Rect(100, 0, 200, 100), Rect(50, 50, 150, 150),
+            Rect(0, 50, 100, 60),   Rect(300, 300, 400, 400),
+    };
+    Region complex;
+    complex.orSelf(Rect(0, 0, 40, 40));
+    complex.orSelf(Rect(60, 60, 100, 100));
+
+    std::vector<Region> regions;
+    for (const Rect& rect : rects) {
+        regions.emplace_back(rect);
+    }
+    regions.push_back(complex);
+
+    for (const Region& lhs : regions) {
+        for (const Region& rhs : regions) {
+            Region::setFastPathsEnabled(false);
+            const Region expectedOr = lhs.merge(rhs);
+            const Region expectedXor = lhs.mergeExclusive(rhs);
+            const Region expectedAnd = lhs.intersect(rhs);
+            const Region expectedNand = lhs.subtract(rhs);
+            const Region expectedAndRect = lhs.intersect(rhs.getBounds());
+            const Region expectedNandRect = lhs.subtract(rhs.getBounds());
+
+            Region::setFastPathsEnabled(true);
+            EXPECT_TRUE(lhs.merge(rhs).hasSameRects(expectedOr));
+            EXPECT_TRUE(lhs.mergeExclusive(rhs).hasSameRects(expectedXor));
+            EXPECT_TRUE(lhs.intersect(rhs).hasSameRects(expectedAnd));
+            EXPECT_TRUE(lhs.subtract(rhs).hasSameRects(expectedNand));
+            EXPECT_TRUE(lhs.intersect(rhs.getBounds()).hasSameRects(expectedAndRect));
+            EXPECT_TRUE(lhs.subtract(rhs.getBounds()).hasSameRects(expectedNandRect));
+            EXPECT_EQ(lhs.subtract(rhs).getBounds(), expectedNand.getBounds());
+        }
+    }
+}
+
+TEST_F(RegionTest, OperationSelfWithAliasedOperand) {
+    Region region;
+    region.orSelf(Rect(0, 0, 100, 100));
+    region.subtractSelf(Rect(40, 40, 60, 60));
+    const Region expected(region);
+
+    region.andSelf(region);
+    EXPECT_TRUE(region.hasSameRects(expected));
+
+    region.andSelf(region.getBounds());
+    EXPECT_TRUE(region.hasSameRects(expected));
+
+    region.orSelf(region.getBounds());
+    EXPECT_TRUE(region.isRect());
+    EXPECT_EQ(Rect(0, 0, 100, 100), region.getBounds());
+
+    region.subtractSelf(region);
+    EXPECT_TRUE(region.isEmpty());
+}
+
 }; // namespace android
 
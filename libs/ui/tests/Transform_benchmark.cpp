@@ -0,0 +1,82 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <ui/FloatRect.h>
+#include <ui/Rect.h>
+#include <ui/Region.h>
+#include <ui/Transform.h>
+
+namespace android {
+namespace {
+
+// Each benchmark takes a single argument that selects the kind of transform, so that the axis
+// aligned ones can be compared with the generic case in a single run.
+ui::Transform makeTransform(const benchmark::State& state) {
+    ui::Transform t;
+    switch (state.range(0)) {
+        case 0: // translate
+            t.set(100.f, 200.f);
+            break;
+        case 1: // scale and translate
+            t.set(2.f, 0.f, 0.f, 1.5f);
+            t.set(100.f, 200.f);
+            break;
+        case 2: // 90 degree rotation of a 1080x2400 display
+            t.set(ui::Transform::ROT_90, 1080, 2400);
+            break;
+        default: // 45 degree rotation
+            t.set(0.7071f, 0.7071f, -0.7071f, 0.7071f);
+            break;
+    }
+    return t;
+}
+
+void BM_TransformRect(benchmark::State& state) {
+    const ui::Transform t = makeTransform(state);
+    const Rect bounds(10, 20, 500, 900);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(t.transform(bounds));
+    }
+}
+BENCHMARK(BM_TransformRect)->DenseRange(0, 3);
+
+void BM_TransformFloatRect(benchmark::State& state) {
+    const ui::Transform t = makeTransform(state);
+    const FloatRect bounds(10.5f, 20.5f, 500.5f, 900.5f);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(t.transform(bounds));
+    }
+}
+BENCHMARK(BM_TransformFloatRect)->DenseRange(0, 3);
+
+void BM_TransformRegion(benchmark::State& state) {
+    const ui::Transform t = makeTransform(state);
+    Region region;
+    for (int i = 0; i < 8; i++) {
+        region.orSelf(Rect(0, i * 100, 400, i * 100 + 50));
+    }
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(t.transform(region));
+    }
+}
+BENCHMARK(BM_TransformRegion)->DenseRange(0, 3);
+
+} // namespace
+} // namespace android
+
+BENCHMARK_MAIN();
@@ -46,4 +46,23 @@ TEST(TransformTest, inverseRotation_hasCorrectType) {
     testRotationFlagsForInverse(Transform::FLIP_V, Transform::FLIP_V, false);
 }
 
+TEST(TransformTest, transformRect_boundsAllCorners) {
+    const Rect bounds(10, 20, 110, 60);
+
+    // A 90 degree rotation of a 1000x2000 display maps (x, y) to (1000 - y, x).
+    const Transform rotation(Transform::ROT_90, 1000, 2000);
+    EXPECT_EQ(Rect(940, 10, 980, 110), rotation.transform(bounds));
+    EXPECT_EQ(FloatRect(940, 10, 980, 110), rotation.transform(bounds.toFloatRect()));
+
+    Transform flip;
+    flip.set(-1.f, 0.f, 0.f, 2.f);
+    EXPECT_EQ(Rect(-110, 40, -10, 120), flip.transform(bounds));
+
+    // Not axis aligned, so the bounds depend on all four corners.
+    Transform skew;
+    skew.set(1.f, -1.f, 0.f, 1.f);
+    EXPECT_FALSE(skew.preserveRects());
+    EXPECT_EQ(Rect(-50, 20, 90, 60), skew.transform(bounds));
+}
+
 } // namespace android::ui
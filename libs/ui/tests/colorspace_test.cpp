@@ -19,6 +19,8 @@
 #include <math.h>
 #include <stdlib.h>
 
+#include <vector>
+
 #include <ui/ColorSpace.h>
 
 #include <gtest/gtest.h>
@@ -165,6 +167,37 @@ TEST_F(ColorSpaceTest, Connect) {
     EXPECT_TRUE(all(lessThan(abs(r - float3{0.70226f, 0.2757f, 0.1036f}), float3{1e-4f})));
 }
 
+TEST_F(ColorSpaceTest, BulkConnectMatchesSingle) {
+    // Covers several chunks plus a partial one, and widths that are not a
+    // multiple of the vector size
+    constexpr size_t count = 1031;
+    std::vector<float3> input(count);
+    for (size_t i = 0; i < count; i++) {
+        input[i] = {float(i % 17) / 16.0f, float(i % 29) / 28.0f, float(i % 7) / 6.0f - 0.1f};
+    }
+
+    const ColorSpaceConnector connectors[] = {
+            {ColorSpace::sRGB(), ColorSpace::AdobeRGB()},
+            {ColorSpace::sRGB(), ColorSpace::ProPhotoRGB()},
+            {ColorSpace::DisplayP3(), ColorSpace::linearExtendedSRGB()},
+    };
+    for (const auto& connector : connectors) {
+        std::vector<float3> output(count);
+        connector.transform(input.data(), output.data(), count);
+        std::vector<float3> linear(count);
+        connector.transformLinear(input.data(), linear.data(), count);
+        for (size_t i = 0; i < count; i++) {
+            EXPECT_EQ(connector.transform(input[i]), output[i]) << "pixel " << i;
+            EXPECT_EQ(connector.transformLinear(input[i]), linear[i]) << "pixel " << i;
+        }
+
+        // In place
+        std::vector<float3> inPlace(input);
+        connector.transform(inPlace.data(), inPlace.data(), count);
+        EXPECT_EQ(output, inPlace);
+    }
+}
+
 TEST_F(ColorSpaceTest, LUT) {
     auto lut = ColorSpace::createLUT(17, ColorSpace::sRGB(), ColorSpace::AdobeRGB());
     EXPECT_TRUE(lut != nullptr);
@@ -23,10 +23,9 @@
 #include <errno.h>
 #include <inttypes.h>
 #include <log/log.h>
+#include <string.h>
 #include <utils/Trace.h>
 
-#include <chrono>
-
 namespace android {
 
 // BlobCache::Header::mMagicNumber value
@@ -38,24 +37,24 @@ static const uint32_t blobCacheVersion = 3;
 // BlobCache::Header::mDeviceVersion value
 static const uint32_t blobCacheDeviceVersion = 1;
 
+// Returns the key of mCacheIndex for the given key data.
+static inline std::string_view indexKey(const void* key, size_t keySize) {
+    return std::string_view(static_cast<const char*>(key), keySize);
+}
+
 BlobCache::BlobCache(size_t maxKeySize, size_t maxValueSize, size_t maxTotalSize)
       : mMaxTotalSize(maxTotalSize),
         mMaxKeySize(maxKeySize),
         mMaxValueSize(maxValueSize),
-        mTotalSize(0) {
-    int64_t now = std::chrono::steady_clock::now().time_since_epoch().count();
-#ifdef _WIN32
-    srand(now);
-#else
-    mRandState[0] = (now >> 0) & 0xFFFF;
-    mRandState[1] = (now >> 16) & 0xFFFF;
-    mRandState[2] = (now >> 32) & 0xFFFF;
-#endif
-    ALOGV("initializing random seed using %lld", (unsigned long long)now);
-}
+        mTotalSize(0) {}
 
 BlobCache::InsertResult BlobCache::set(const void* key, size_t keySize, const void* value,
                                        size_t valueSize) {
+    return insert(key, keySize, value, valueSize, /*copyData=*/true);
+}
+
+BlobCache::InsertResult BlobCache::insert(const void* key, size_t keySize, const void* value,
+                                          size_t valueSize, bool copyData) {
     if (mMaxKeySize < keySize) {
         ALOGV("set: not caching because the key is too large: %zu (limit: %zu)", keySize,
               mMaxKeySize);
@@ -81,16 +80,11 @@ BlobCache::InsertResult BlobCache::set(const void* key, size_t keySize, const vo
         return InsertResult::kInvalidValueSize;
     }
 
-    std::shared_ptr<Blob> cacheKey(new Blob(key, keySize, false));
-    CacheEntry cacheEntry(cacheKey, nullptr);
-
     bool didClean = false;
     while (true) {
-        auto index = std::lower_bound(mCacheEntries.begin(), mCacheEntries.end(), cacheEntry);
-        if (index == mCacheEntries.end() || cacheEntry < *index) {
+        auto index = mCacheIndex.find(indexKey(key, keySize));
+        if (index == mCacheIndex.end()) {
             // Create a new cache entry.
-            std::shared_ptr<Blob> keyBlob(new Blob(key, keySize, true));
-            std::shared_ptr<Blob> valueBlob(new Blob(value, valueSize, true));
             size_t newTotalSize = mTotalSize + keySize + valueSize;
             if (mMaxTotalSize < newTotalSize) {
                 if (isCleanable()) {
@@ -106,14 +100,17 @@ BlobCache::InsertResult BlobCache::set(const void* key, size_t keySize, const vo
                     return InsertResult::kNotEnoughSpace;
                 }
             }
-            mCacheEntries.insert(index, CacheEntry(keyBlob, valueBlob));
+            std::shared_ptr<Blob> keyBlob(new Blob(key, keySize, copyData));
+            std::shared_ptr<Blob> valueBlob(new Blob(value, valueSize, copyData));
+            mCacheEntries.emplace_front(keyBlob, valueBlob);
+            mCacheIndex.emplace(indexKey(keyBlob->getData(), keySize), mCacheEntries.begin());
             mTotalSize = newTotalSize;
             ALOGV("set: created new cache entry with %zu byte key and %zu byte value", keySize,
                   valueSize);
         } else {
             // Update the existing cache entry.
-            std::shared_ptr<Blob> valueBlob(new Blob(value, valueSize, true));
-            std::shared_ptr<Blob> oldValueBlob(index->getValue());
+            auto entry = index->second;
+            std::shared_ptr<Blob> oldValueBlob(entry->getValue());
             size_t newTotalSize = mTotalSize + valueSize - oldValueBlob->getSize();
             if (mMaxTotalSize < newTotalSize) {
                 if (isCleanable()) {
@@ -128,7 +125,9 @@ BlobCache::InsertResult BlobCache::set(const void* key, size_t keySize, const vo
                     return InsertResult::kNotEnoughSpace;
                 }
             }
-            index->setValue(valueBlob);
+            std::shared_ptr<Blob> valueBlob(new Blob(value, valueSize, copyData));
+            entry->setValue(valueBlob);
+            mCacheEntries.splice(mCacheEntries.begin(), mCacheEntries, entry);
             mTotalSize = newTotalSize;
             ALOGV("set: updated existing cache entry with %zu byte key and %zu byte "
                   "value",
@@ -144,17 +143,17 @@ size_t BlobCache::get(const void* key, size_t keySize, void* value, size_t value
               mMaxKeySize);
         return 0;
     }
-    std::shared_ptr<Blob> cacheKey(new Blob(key, keySize, false));
-    CacheEntry cacheEntry(cacheKey, nullptr);
-    auto index = std::lower_bound(mCacheEntries.begin(), mCacheEntries.end(), cacheEntry);
-    if (index == mCacheEntries.end() || cacheEntry < *index) {
+    auto index = mCacheIndex.find(indexKey(key, keySize));
+    if (index == mCacheIndex.end()) {
         ALOGV("get: no cache entry found for key of size %zu", keySize);
         return 0;
     }
 
-    // The key was found. Return the value if the caller's buffer is large
-    // enough.
-    std::shared_ptr<Blob> valueBlob(index->getValue());
+    // The key was found. Mark it as the most recently used entry, and return
+    // the value if the caller's buffer is large enough.
+    auto entry = index->second;
+    mCacheEntries.splice(mCacheEntries.begin(), mCacheEntries, entry);
+    std::shared_ptr<Blob> valueBlob(entry->getValue());
     size_t valueBlobSize = valueBlob->getSize();
     if (valueBlobSize <= valueSize) {
         ALOGV("get: copying %zu bytes to caller's buffer", valueBlobSize);
@@ -196,10 +195,12 @@ int BlobCache::flatten(void* buffer, size_t size) const {
     header->mBuildIdLength = buildId.size();
     memcpy(header->mBuildId, buildId.c_str(), header->mBuildIdLength);
 
-    // Write cache entries
+    // Write cache entries, from the least recently used to the most recently
+    // used one, so that unflatten restores their order.
     uint8_t* byteBuffer = reinterpret_cast<uint8_t*>(buffer);
     off_t byteOffset = align4(sizeof(Header) + header->mBuildIdLength);
-    for (const CacheEntry& e : mCacheEntries) {
+    for (auto it = mCacheEntries.rbegin(); it != mCacheEntries.rend(); ++it) {
+        const CacheEntry& e = *it;
         std::shared_ptr<Blob> const& keyBlob = e.getKey();
         std::shared_ptr<Blob> const& valueBlob = e.getValue();
         size_t keySize = keyBlob->getSize();
@@ -232,6 +233,10 @@ int BlobCache::flatten(void* buffer, size_t size) const {
 }
 
 int BlobCache::unflatten(void const* buffer, size_t size) {
+    return unflatten(buffer, size, /*copyData=*/true);
+}
+
+int BlobCache::unflatten(void const* buffer, size_t size, bool copyData) {
     ATRACE_NAME("BlobCache::unflatten");
 
     // All errors should result in the BlobCache being in an empty state.
@@ -280,7 +285,7 @@ int BlobCache::unflatten(void const* buffer, size_t size) {
         }
 
         const uint8_t* data = eheader->mData;
-        set(data, keySize, data + keySize, valueSize);
+        insert(data, keySize, data + keySize, valueSize, copyData);
 
         byteOffset += totalSize;
     }
@@ -288,24 +293,17 @@ int BlobCache::unflatten(void const* buffer, size_t size) {
     return 0;
 }
 
-long int BlobCache::blob_random() {
-#ifdef _WIN32
-    return rand();
-#else
-    return nrand48(mRandState);
-#endif
-}
-
 void BlobCache::clean() {
     ATRACE_NAME("BlobCache::clean");
 
-    // Remove a random cache entry until the total cache size gets below half
-    // the maximum total cache size.
-    while (mTotalSize > mMaxTotalSize / 2) {
-        size_t i = size_t(blob_random() % (mCacheEntries.size()));
-        const CacheEntry& entry(mCacheEntries[i]);
-        mTotalSize -= entry.getKey()->getSize() + entry.getValue()->getSize();
-        mCacheEntries.erase(mCacheEntries.begin() + i);
+    // Remove the least recently used cache entry until the total cache size
+    // gets below half the maximum total cache size.
+    while (mTotalSize > mMaxTotalSize / 2 && !mCacheEntries.empty()) {
+        const CacheEntry& entry(mCacheEntries.back());
+        std::shared_ptr<Blob> const& keyBlob = entry.getKey();
+        mTotalSize -= keyBlob->getSize() + entry.getValue()->getSize();
+        mCacheIndex.erase(indexKey(keyBlob->getData(), keyBlob->getSize()));
+        mCacheEntries.pop_back();
     }
 }
 
@@ -326,14 +324,6 @@ BlobCache::Blob::~Blob() {
     }
 }
 
-bool BlobCache::Blob::operator<(const Blob& rhs) const {
-    if (mSize == rhs.mSize) {
-        return memcmp(mData, rhs.mData, mSize) < 0;
-    } else {
-        return mSize < rhs.mSize;
-    }
-}
-
 const void* BlobCache::Blob::getData() const {
     return mData;
 }
@@ -350,10 +340,6 @@ BlobCache::CacheEntry::CacheEntry(const std::shared_ptr<Blob>& key,
 
 BlobCache::CacheEntry::CacheEntry(const CacheEntry& ce) : mKey(ce.mKey), mValue(ce.mValue) {}
 
-bool BlobCache::CacheEntry::operator<(const CacheEntry& rhs) const {
-    return *mKey < *rhs.mKey;
-}
-
 const BlobCache::CacheEntry& BlobCache::CacheEntry::operator=(const CacheEntry& rhs) {
     mKey = rhs.mKey;
     mValue = rhs.mValue;
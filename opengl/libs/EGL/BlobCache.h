@@ -19,8 +19,10 @@
 
 #include <stddef.h>
 
+#include <list>
 #include <memory>
-#include <vector>
+#include <string_view>
+#include <unordered_map>
 
 namespace android {
 
@@ -118,11 +120,18 @@ public:
     // clear flushes out all contents of the cache then the BlobCache, leaving
     // it in an empty state.
     void clear() {
+        mCacheIndex.clear();
         mCacheEntries.clear();
         mTotalSize = 0;
     }
 
 protected:
+    // This unflatten works like the public one, but if copyData is false, the
+    // cache entries point to the key and value data in 'buffer' rather than to
+    // copies of it. 'buffer' must then remain valid and unmodified for as long
+    // as those entries are in the cache.
+    int unflatten(void const* buffer, size_t size, bool copyData);
+
     // mMaxTotalSize is the maximum size that all cache entries can occupy. This
     // includes space for both keys and values. When a call to BlobCache::set
     // would otherwise cause this limit to be exceeded, either the key/value
@@ -135,10 +144,12 @@ private:
     BlobCache(const BlobCache&);
     void operator=(const BlobCache&);
 
-    // A random function helper to get around MinGW not having nrand48()
-    long int blob_random();
+    // insert implements set. If copyData is false, the new cache entry points
+    // to the key and value data instead of copying them.
+    InsertResult insert(const void* key, size_t keySize, const void* value, size_t valueSize,
+                        bool copyData);
 
-    // clean evicts a randomly chosen set of entries from the cache such that
+    // clean evicts the least recently used entries from the cache such that
     // the total size of all remaining entries is less than mMaxTotalSize/2.
     void clean();
 
@@ -152,8 +163,6 @@ private:
         Blob(const void* data, size_t size, bool copyData);
         ~Blob();
 
-        bool operator<(const Blob& rhs) const;
-
         const void* getData() const;
         size_t getSize() const;
 
@@ -180,7 +189,6 @@ private:
         CacheEntry(const std::shared_ptr<Blob>& key, const std::shared_ptr<Blob>& value);
         CacheEntry(const CacheEntry& ce);
 
-        bool operator<(const CacheEntry& rhs) const;
         const CacheEntry& operator=(const CacheEntry&);
 
         std::shared_ptr<Blob> getKey() const;
@@ -256,13 +264,15 @@ private:
     // the cache.
     size_t mTotalSize;
 
-    // mRandState is the pseudo-random number generator state. It is passed to
-    // nrand48 to generate random numbers when needed.
-    unsigned short mRandState[3];
+    // mCacheEntries stores all the cache entries that are resident in memory,
+    // from the most recently used to the least recently used one. Cache entries
+    // are added to it by the 'set' method, and moved to its front whenever they
+    // are accessed by 'get' or 'set'.
+    std::list<CacheEntry> mCacheEntries;
 
-    // mCacheEntries stores all the cache entries that are resident in memory.
-    // Cache entries are added to it by the 'set' method.
-    std::vector<CacheEntry> mCacheEntries;
+    // mCacheIndex maps the key of each entry in mCacheEntries to that entry.
+    // The keys point to the data of the entries' own key blobs.
+    std::unordered_map<std::string_view, std::list<CacheEntry>::iterator> mCacheIndex;
 };
 
 } // namespace android
@@ -294,6 +294,32 @@ TEST_F(BlobCacheTest, ExceedingTotalLimitHalvesCacheSize) {
     ASSERT_EQ(maxEntries / 2 + 1, numCached);
 }
 
+TEST_F(BlobCacheTest, ExceedingTotalLimitEvictsLeastRecentlyUsedEntries) {
+    // Fill up the entire cache with 1 char key/value pairs.
+    const int maxEntries = MAX_TOTAL_SIZE / 2;
+    for (int i = 0; i < maxEntries; i++) {
+        uint8_t k = i;
+        ASSERT_EQ(BlobCache::InsertResult::kInserted, mBC->set(&k, 1, "x", 1));
+    }
+    // Use the first entry again, so that it's the most recently used one.
+    {
+        uint8_t k = 0;
+        ASSERT_EQ(size_t(1), mBC->get(&k, 1, nullptr, 0));
+    }
+    // Insert one more entry, causing a cache overflow.
+    {
+        uint8_t k = maxEntries;
+        ASSERT_EQ(BlobCache::InsertResult::kDidClean, mBC->set(&k, 1, "x", 1));
+    }
+    // Only the new entry, the first entry and the most recently inserted ones remain.
+    for (int i = 0; i < maxEntries + 1; i++) {
+        SCOPED_TRACE(i);
+        uint8_t k = i;
+        bool cached = i == 0 || i > maxEntries - maxEntries / 2;
+        ASSERT_EQ(cached ? size_t(1) : size_t(0), mBC->get(&k, 1, nullptr, 0));
+    }
+}
+
 TEST_F(BlobCacheTest, InvalidKeySize) {
     ASSERT_EQ(BlobCache::InsertResult::kInvalidKeySize, mBC->set("", 0, "efgh", 4));
 }
@@ -355,6 +381,34 @@ TEST_F(BlobCacheFlattenTest, FlattenFullCache) {
     }
 }
 
+TEST_F(BlobCacheFlattenTest, UnflattenKeepsLeastRecentlyUsedOrder) {
+    // Fill up the entire cache with 1 char key/value pairs.
+    const int maxEntries = MAX_TOTAL_SIZE / 2;
+    for (int i = 0; i < maxEntries; i++) {
+        uint8_t k = i;
+        mBC->set(&k, 1, &k, 1);
+    }
+    // Use the first entry again, so that it's the most recently used one.
+    {
+        uint8_t k = 0;
+        ASSERT_EQ(size_t(1), mBC->get(&k, 1, nullptr, 0));
+    }
+
+    roundTrip();
+
+    // Overflow the deserialized cache, which must evict the same entries as the original one.
+    {
+        uint8_t k = maxEntries;
+        ASSERT_EQ(BlobCache::InsertResult::kDidClean, mBC2->set(&k, 1, &k, 1));
+    }
+    for (int i = 0; i < maxEntries + 1; i++) {
+        SCOPED_TRACE(i);
+        uint8_t k = i;
+        bool cached = i == 0 || i > maxEntries - maxEntries / 2;
+        ASSERT_EQ(cached ? size_t(1) : size_t(0), mBC2->get(&k, 1, nullptr, 0));
+    }
+}
+
 TEST_F(BlobCacheFlattenTest, FlattenDoesntChangeCache) {
     // Fill up the entire cache with 1 char key/value pairs.
     const int maxEntries = MAX_TOTAL_SIZE / 2;
@@ -97,17 +97,21 @@ FileBlobCache::FileBlobCache(size_t maxKeySize, size_t maxValueSize, size_t maxT
         size_t cacheSize = fileSize - headerSize;
         if (memcmp(buf, cacheFileMagic, 4) != 0) {
             ALOGE("cache file has bad mojo");
+            munmap(buf, fileSize);
             close(fd);
             return;
         }
         uint32_t* crc = reinterpret_cast<uint32_t*>(buf + 4);
         if (crc32c(buf + headerSize, cacheSize) != *crc) {
             ALOGE("cache file failed CRC check");
+            munmap(buf, fileSize);
             close(fd);
             return;
         }
 
-        int err = unflatten(buf + headerSize, cacheSize);
+        // The entries point into the mapping rather than being copied to the heap, so the
+        // file is only paged in as the entries are read, and that memory stays reclaimable.
+        int err = unflatten(buf + headerSize, cacheSize, /*copyData=*/false);
         if (err < 0) {
             ALOGE("error reading cache contents: %s (%d)", strerror(-err),
                     -err);
@@ -116,11 +120,22 @@ FileBlobCache::FileBlobCache(size_t maxKeySize, size_t maxValueSize, size_t maxT
             return;
         }
 
-        munmap(buf, fileSize);
+        // writeToFile replaces the file by unlinking it rather than by writing to it, so the
+        // mapping remains valid until it's unmapped.
+        mMappedFile = buf;
+        mMappedFileSize = fileSize;
         close(fd);
     }
 }
 
+FileBlobCache::~FileBlobCache() {
+    if (mMappedFile != nullptr) {
+        // Drop the entries that point into the mapping first.
+        clear();
+        munmap(mMappedFile, mMappedFileSize);
+    }
+}
+
 void FileBlobCache::writeToFile() {
     ATRACE_CALL();
 
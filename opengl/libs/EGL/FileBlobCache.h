@@ -30,6 +30,7 @@ public:
     // BlobCache.
     FileBlobCache(size_t maxKeySize, size_t maxValueSize, size_t maxTotalSize,
             const std::string& filename);
+    ~FileBlobCache();
 
     // writeToFile attempts to save the current contents of BlobCache to
     // disk.
@@ -41,6 +42,12 @@ public:
 private:
     // mFilename is the name of the file for storing cache contents.
     std::string mFilename;
+
+    // mMappedFile is the mapping of the cache file that was loaded by the
+    // constructor, which the entries loaded from it point into. mMappedFileSize
+    // is the size of that mapping.
+    uint8_t* mMappedFile = nullptr;
+    size_t mMappedFileSize = 0;
 };
 
 } // namespace android
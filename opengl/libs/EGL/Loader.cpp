@@ -450,6 +450,24 @@ void Loader::init_api(void* dso,
     }
 }
 
+// Fills curr, which is laid out like ref_curr and ref_api, the same way init_api(dso, api, ref_api,
+// curr) would, from the entry points that ref_curr already holds for the same library.
+static void copy_api(char const* const* api, char const* const* ref_api,
+                     const __eglMustCastToProperFunctionPointerType* ref_curr,
+                     __eglMustCastToProperFunctionPointerType* curr) {
+    while (*api) {
+        if (std::strcmp(*api, *ref_api) == 0) {
+            *curr = *ref_curr;
+            api++;
+        } else {
+            *curr = nullptr;
+        }
+        curr++;
+        ref_curr++;
+        ref_api++;
+    }
+}
+
 static std::string findLibrary(const std::string libraryName, const std::string searchPath,
                                const bool exact) {
     if (exact) {
@@ -723,18 +741,27 @@ void Loader::initialize_api(void* dso, egl_connection_t* cnx, uint32_t mask) {
         }
     }
 
-    if (mask & GLESv1_CM) {
-        init_api(dso, gl_names_1, gl_names,
+    __eglMustCastToProperFunctionPointerType* gles1 =
             (__eglMustCastToProperFunctionPointerType*)
-                &cnx->hooks[egl_connection_t::GLESv1_INDEX]->gl,
-            getProcAddress);
+                    &cnx->hooks[egl_connection_t::GLESv1_INDEX]->gl;
+    __eglMustCastToProperFunctionPointerType* gles2 =
+            (__eglMustCastToProperFunctionPointerType*)
+                    &cnx->hooks[egl_connection_t::GLESv2_INDEX]->gl;
+
+    if ((mask & GLESv1_CM) && (mask & GLESv2)) {
+        // Both tables come from the same library, so the GLESv1 entry points, which are all
+        // GLESv2 ones too, are copied rather than looked up again.
+        init_api(dso, gl_names, nullptr, gles2, getProcAddress);
+        copy_api(gl_names_1, gl_names, gles2, gles1);
+        return;
+    }
+
+    if (mask & GLESv1_CM) {
+        init_api(dso, gl_names_1, gl_names, gles1, getProcAddress);
     }
 
     if (mask & GLESv2) {
-        init_api(dso, gl_names, nullptr,
-            (__eglMustCastToProperFunctionPointerType*)
-                &cnx->hooks[egl_connection_t::GLESv2_INDEX]->gl,
-            getProcAddress);
+        init_api(dso, gl_names, nullptr, gles2, getProcAddress);
     }
 }
 
@@ -23,6 +23,7 @@
 #include <fcntl.h>
 #include <inttypes.h>
 #include <log/log.h>
+#include <lz4.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <sys/mman.h>
@@ -33,8 +34,12 @@
 
 #include <algorithm>
 #include <chrono>
+#include <functional>
 #include <limits>
 #include <locale>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include <utils/JenkinsHash.h>
 
@@ -58,6 +63,28 @@ void freeHotCacheEntry(android::MultifileHotCache& entry) {
     }
 }
 
+// Returns a copy of the entry with its value compressed, to be freed with delete[], or nullptr if
+// compression would not make the entry smaller.
+uint8_t* encodeEntry(const uint8_t* entry, size_t entrySize, size_t valueOffset,
+                     size_t* encodedSize) {
+    const int valueSize = static_cast<int>(entrySize - valueOffset);
+    const int bound = LZ4_compressBound(valueSize);
+    uint8_t* encoded = new uint8_t[valueOffset + bound];
+    int result = LZ4_compress_default(reinterpret_cast<const char*>(entry + valueOffset),
+                                      reinterpret_cast<char*>(encoded + valueOffset), valueSize,
+                                      bound);
+    if (result <= 0 || valueOffset + result >= entrySize) {
+        delete[] encoded;
+        return nullptr;
+    }
+
+    memcpy(encoded, entry, valueOffset);
+    reinterpret_cast<android::MultifileHeader*>(encoded)->encoding =
+            android::MultifileEncoding::LZ4;
+    *encodedSize = valueOffset + result;
+    return encoded;
+}
+
 } // namespace
 
 namespace android {
@@ -66,6 +93,7 @@ MultifileBlobCache::MultifileBlobCache(size_t maxKeySize, size_t maxValueSize, s
                                        size_t maxTotalEntries, const std::string& baseDir)
       : mInitialized(false),
         mCacheVersion(0),
+        mCompressionEnabled(false),
         mMaxKeySize(maxKeySize),
         mMaxValueSize(maxValueSize),
         mMaxTotalSize(maxTotalSize),
@@ -100,6 +128,12 @@ MultifileBlobCache::MultifileBlobCache(size_t maxKeySize, size_t maxValueSize, s
         mBuildId = debugBuildId;
     }
 
+    // Decide whether to compress new entries, override if debug value set. Compressed entries
+    // are read back either way, so this doesn't invalidate the cache.
+    mCompressionEnabled = base::GetBoolProperty("ro.egl.blobcache.multifile_compression", false);
+    mCompressionEnabled =
+            base::GetBoolProperty("debug.egl.blobcache.multifile_compression", mCompressionEnabled);
+
     // Establish the name of our multifile directory
     mMultifileDirName = baseDir + ".multifile";
 
@@ -198,9 +232,58 @@ MultifileBlobCache::MultifileBlobCache(size_t maxKeySize, size_t maxValueSize, s
                     continue;
                 }
 
+                // If the cache entry is damaged or no good, remove it
+                if (header.keySize <= 0 || header.valueSize <= 0 ||
+                    (header.encoding != MultifileEncoding::None &&
+                     header.encoding != MultifileEncoding::LZ4)) {
+                    ALOGV("INIT: Entry %u has a bad header keySize (%lu), valueSize (%lu) or "
+                          "encoding (%u), removing.",
+                          entryHash, header.keySize, header.valueSize,
+                          static_cast<uint32_t>(header.encoding));
+                    if (remove(fullPath.c_str()) != 0) {
+                        ALOGE("INIT: Error removing %s: %s", fullPath.c_str(),
+                              std::strerror(errno));
+                    }
+                    close(fd);
+                    continue;
+                }
+                close(fd);
+
                 // Note: Converting from off_t (signed) to size_t (unsigned)
                 size_t fileSize = static_cast<size_t>(st.st_size);
 
+                ALOGV("INIT: Entry %u is good, tracking it now.", entryHash);
+
+                // Track details for rapid lookup later. The CRC of the entry is only checked
+                // when it's loaded, so that initialization doesn't read the whole cache.
+                trackEntry(entryHash, header.valueSize, fileSize, st.st_atime);
+
+                // Track the total size
+                increaseTotalCacheSize(fileSize);
+            }
+            closedir(dir);
+
+            // Preload the most recently used entries for fast retrieval
+            std::vector<std::pair<time_t, uint32_t>> entriesByAccessTime;
+            entriesByAccessTime.reserve(mEntryStats.size());
+            for (const auto& [entryHash, entryStats] : mEntryStats) {
+                entriesByAccessTime.emplace_back(entryStats.accessTime, entryHash);
+            }
+            std::sort(entriesByAccessTime.begin(), entriesByAccessTime.end(), std::greater<>());
+            for (const auto& [accessTime, entryHash] : entriesByAccessTime) {
+                size_t fileSize = mEntryStats[entryHash].fileSize;
+                if ((mHotCacheSize + fileSize) >= mHotCacheLimit) {
+                    continue;
+                }
+
+                std::string fullPath = mMultifileDirName + "/" + std::to_string(entryHash);
+                int fd = open(fullPath.c_str(), O_RDONLY);
+                if (fd == -1) {
+                    ALOGE("Cache error - failed to open fullPath: %s, error: %s", fullPath.c_str(),
+                          std::strerror(errno));
+                    return;
+                }
+
                 // Memory map the file
                 uint8_t* mappedEntry = reinterpret_cast<uint8_t*>(
                         mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0));
@@ -214,54 +297,32 @@ MultifileBlobCache::MultifileBlobCache(size_t maxKeySize, size_t maxValueSize, s
                 }
 
                 // Ensure we have a good CRC
-                if (header.crc !=
-                    crc32c(mappedEntry + sizeof(MultifileHeader),
-                           fileSize - sizeof(MultifileHeader))) {
+                if (!checkEntryCrc(mappedEntry, fileSize)) {
                     ALOGV("INIT: Entry %u failed CRC check! Removing.", entryHash);
-                    if (remove(fullPath.c_str()) != 0) {
-                        ALOGE("Error removing %s: %s", fullPath.c_str(), std::strerror(errno));
-                    }
+                    munmap(mappedEntry, fileSize);
+                    removeEntry(entryHash);
                     continue;
                 }
 
-                // If the cache entry is damaged or no good, remove it
-                if (header.keySize <= 0 || header.valueSize <= 0) {
-                    ALOGV("INIT: Entry %u has a bad header keySize (%lu) or valueSize (%lu), "
-                          "removing.",
-                          entryHash, header.keySize, header.valueSize);
-                    if (remove(fullPath.c_str()) != 0) {
-                        ALOGE("INIT: Error removing %s: %s", fullPath.c_str(),
-                              std::strerror(errno));
-                    }
+                // Decompress the value, so that hits only need to copy it
+                if (!decodeMappedEntry(&mappedEntry, &fileSize, &fd)) {
+                    ALOGV("INIT: Entry %u failed to decompress! Removing.", entryHash);
+                    removeEntry(entryHash);
                     continue;
                 }
 
-                ALOGV("INIT: Entry %u is good, tracking it now.", entryHash);
-
-                // Track details for rapid lookup later
-                trackEntry(entryHash, header.valueSize, fileSize, st.st_atime);
-
-                // Track the total size
-                increaseTotalCacheSize(fileSize);
+                ALOGV("INIT: Populating hot cache with fd = %i, cacheEntry = %p for "
+                      "entryHash %u",
+                      fd, mappedEntry, entryHash);
 
-                // Preload the entry for fast retrieval
-                if ((mHotCacheSize + fileSize) < mHotCacheLimit) {
-                    ALOGV("INIT: Populating hot cache with fd = %i, cacheEntry = %p for "
-                          "entryHash %u",
-                          fd, mappedEntry, entryHash);
-
-                    // Track the details of the preload so they can be retrieved later
-                    if (!addToHotCache(entryHash, fd, mappedEntry, fileSize)) {
-                        ALOGE("INIT Failed to add %u to hot cache", entryHash);
-                        munmap(mappedEntry, fileSize);
-                        return;
-                    }
-                } else {
-                    // If we're not keeping it in hot cache, unmap it now
-                    munmap(mappedEntry, fileSize);
+                // Track the details of the preload so they can be retrieved later
+                if (!addToHotCache(entryHash, fd, mappedEntry, fileSize)) {
+                    ALOGE("INIT Failed to add %u to hot cache", entryHash);
+                    MultifileHotCache entry = {fd, mappedEntry, fileSize};
+                    freeHotCacheEntry(entry);
+                    return;
                 }
             }
-            closedir(dir);
         } else {
             ALOGE("Unable to open filename: %s", mMultifileDirName.c_str());
         }
@@ -318,20 +379,15 @@ void MultifileBlobCache::set(const void* key, EGLsizeiANDROID keySize, const voi
     // Generate a hash of the key and use it to track this entry
     uint32_t entryHash = android::JenkinsHashMixBytes(0, static_cast<const uint8_t*>(key), keySize);
 
-    size_t fileSize = sizeof(MultifileHeader) + keySize + valueSize;
-
-    // If we're going to be over the cache limit, kick off a trim to clear space
-    if (getTotalSize() + fileSize > mMaxTotalSize || getTotalEntries() + 1 > mMaxTotalEntries) {
-        ALOGV("SET: Cache is full, calling trimCache to clear space");
-        trimCache();
-    }
+    size_t entrySize = sizeof(MultifileHeader) + keySize + valueSize;
 
     ALOGV("SET: Add %u to cache", entryHash);
 
-    uint8_t* buffer = new uint8_t[fileSize];
+    uint8_t* buffer = new uint8_t[entrySize];
 
     // Write placeholders for magic and CRC until deferred thread completes the write
-    android::MultifileHeader header = {kMultifileMagic, kCrcPlaceholder, keySize, valueSize};
+    android::MultifileHeader header = {kMultifileMagic, kCrcPlaceholder, keySize, valueSize,
+                                       MultifileEncoding::None};
     memcpy(static_cast<void*>(buffer), static_cast<const void*>(&header),
            sizeof(android::MultifileHeader));
     // Write the key and value after the header
@@ -340,6 +396,25 @@ void MultifileBlobCache::set(const void* key, EGLsizeiANDROID keySize, const voi
     memcpy(static_cast<void*>(buffer + sizeof(MultifileHeader) + keySize),
            static_cast<const void*>(value), valueSize);
 
+    // Compress the value written to disk if that makes it smaller. The hot cache keeps the
+    // uncompressed entry, so hits don't need to decompress it.
+    uint8_t* fileBuffer = buffer;
+    size_t fileSize = entrySize;
+    if (mCompressionEnabled) {
+        uint8_t* encodedBuffer = encodeEntry(buffer, entrySize, sizeof(MultifileHeader) + keySize,
+                                             &fileSize);
+        if (encodedBuffer != nullptr) {
+            ALOGV("SET: Compressed %u from %zu to %zu bytes", entryHash, entrySize, fileSize);
+            fileBuffer = encodedBuffer;
+        }
+    }
+
+    // If we're going to be over the cache limit, kick off a trim to clear space
+    if (getTotalSize() + fileSize > mMaxTotalSize || getTotalEntries() + 1 > mMaxTotalEntries) {
+        ALOGV("SET: Cache is full, calling trimCache to clear space");
+        trimCache();
+    }
+
     std::string fullPath = mMultifileDirName + "/" + std::to_string(entryHash);
 
     // Track the size and access time for quick recall
@@ -352,8 +427,11 @@ void MultifileBlobCache::set(const void* key, EGLsizeiANDROID keySize, const voi
     ALOGV("SET: Adding %u to hot cache.", entryHash);
 
     // Sending -1 as the fd indicates we don't have an fd for this
-    if (!addToHotCache(entryHash, -1, buffer, fileSize)) {
+    if (!addToHotCache(entryHash, -1, buffer, entrySize)) {
         ALOGE("SET: Failed to add %u to hot cache", entryHash);
+        if (fileBuffer != buffer) {
+            delete[] fileBuffer;
+        }
         delete[] buffer;
         return;
     }
@@ -363,13 +441,13 @@ void MultifileBlobCache::set(const void* key, EGLsizeiANDROID keySize, const voi
     {
         // Synchronize access to deferred write status
         std::lock_guard<std::mutex> lock(mDeferredWriteStatusMutex);
-        mDeferredWrites.insert(std::make_pair(entryHash, buffer));
+        mDeferredWrites.insert(std::make_pair(entryHash, fileBuffer));
     }
 
     // Create deferred task to write to storage
     ALOGV("SET: Adding task to queue.");
     DeferredTask task(TaskCommand::WriteToDisk);
-    task.initWriteToDisk(entryHash, fullPath, buffer, fileSize);
+    task.initWriteToDisk(entryHash, fullPath, fileBuffer, fileSize, fileBuffer != buffer);
     queueTask(std::move(task));
 }
 
@@ -464,6 +542,21 @@ EGLsizeiANDROID MultifileBlobCache::get(const void* key, EGLsizeiANDROID keySize
             return 0;
         }
 
+        // Entries that weren't preloaded haven't had their CRC checked yet
+        if (!checkEntryCrc(cacheEntry, fileSize)) {
+            ALOGW("GET: Entry %u failed CRC check! Removing.", entryHash);
+            munmap(cacheEntry, fileSize);
+            removeEntry(entryHash);
+            return 0;
+        }
+
+        // Decompress the value, so that later hits only need to copy it
+        if (!decodeMappedEntry(&cacheEntry, &fileSize, &fd)) {
+            ALOGW("GET: Entry %u failed to decompress! Removing.", entryHash);
+            removeEntry(entryHash);
+            return 0;
+        }
+
         ALOGV("GET: Adding %u to hot cache", entryHash);
         if (!addToHotCache(entryHash, fd, cacheEntry, fileSize)) {
             ALOGE("GET: Failed to add %u to hot cache", entryHash);
@@ -636,6 +729,77 @@ bool MultifileBlobCache::contains(uint32_t hashEntry) const {
     return mEntries.find(hashEntry) != mEntries.end();
 }
 
+bool MultifileBlobCache::removeEntry(uint32_t entryHash) {
+    auto entryStatsIter = mEntryStats.find(entryHash);
+    if (entryStatsIter == mEntryStats.end()) {
+        return false;
+    }
+
+    // Track the overall size
+    decreaseTotalCacheSize(entryStatsIter->second.fileSize);
+
+    // Remove it from hot cache if present
+    removeFromHotCache(entryHash);
+
+    // Remove it from the system
+    std::string entryPath = mMultifileDirName + "/" + std::to_string(entryHash);
+    if (remove(entryPath.c_str()) != 0) {
+        ALOGE("REMOVE: Error removing %s: %s", entryPath.c_str(), std::strerror(errno));
+    }
+
+    // Delete the entry from our tracking
+    mEntryStats.erase(entryStatsIter);
+    mEntries.erase(entryHash);
+    return true;
+}
+
+bool MultifileBlobCache::checkEntryCrc(const uint8_t* entry, size_t entrySize) const {
+    if (entrySize < sizeof(MultifileHeader)) {
+        return false;
+    }
+    const MultifileHeader* header = reinterpret_cast<const MultifileHeader*>(entry);
+    return header->crc ==
+            crc32c(entry + sizeof(MultifileHeader), entrySize - sizeof(MultifileHeader));
+}
+
+// Replaces a mapped entry whose value is compressed with a decompressed copy, which is tracked in
+// the hot cache without an fd. If that fails the mapping is released and false is returned.
+bool MultifileBlobCache::decodeMappedEntry(uint8_t** entryBuffer, size_t* entrySize,
+                                           int* fd) const {
+    const MultifileHeader* header = reinterpret_cast<const MultifileHeader*>(*entryBuffer);
+    if (header->encoding == MultifileEncoding::None) {
+        return true;
+    }
+
+    size_t valueOffset = sizeof(MultifileHeader) + header->keySize;
+    uint8_t* decoded = nullptr;
+    size_t decodedSize = valueOffset + header->valueSize;
+    if (header->encoding == MultifileEncoding::LZ4 && header->keySize > 0 &&
+        header->keySize <= mMaxKeySize && header->valueSize > 0 &&
+        header->valueSize <= mMaxValueSize && valueOffset < *entrySize) {
+        decoded = new uint8_t[decodedSize];
+        int result = LZ4_decompress_safe(reinterpret_cast<const char*>(*entryBuffer + valueOffset),
+                                         reinterpret_cast<char*>(decoded + valueOffset),
+                                         *entrySize - valueOffset, header->valueSize);
+        if (result == header->valueSize) {
+            memcpy(decoded, *entryBuffer, valueOffset);
+            reinterpret_cast<MultifileHeader*>(decoded)->encoding = MultifileEncoding::None;
+        } else {
+            delete[] decoded;
+            decoded = nullptr;
+        }
+    }
+
+    munmap(*entryBuffer, *entrySize);
+    if (decoded == nullptr) {
+        return false;
+    }
+    *entryBuffer = decoded;
+    *entrySize = decodedSize;
+    *fd = -1;
+    return true;
+}
+
 MultifileEntryStats MultifileBlobCache::getEntryStats(uint32_t entryHash) {
     return mEntryStats[entryHash];
 }
@@ -823,53 +987,8 @@ void MultifileBlobCache::processTask(DeferredTask& task) {
             return;
         }
         case TaskCommand::WriteToDisk: {
-            uint32_t entryHash = task.getEntryHash();
-            std::string& fullPath = task.getFullPath();
-            uint8_t* buffer = task.getBuffer();
-            size_t bufferSize = task.getBufferSize();
-
-            // Create the file or reset it if already present, read+write for user only
-            int fd = open(fullPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
-            if (fd == -1) {
-                ALOGE("Cache error in SET - failed to open fullPath: %s, error: %s",
-                      fullPath.c_str(), std::strerror(errno));
-                return;
-            }
-
-            ALOGV("DEFERRED: Opened fd %i from %s", fd, fullPath.c_str());
-
-            // Add CRC check to the header (always do this last!)
-            MultifileHeader* header = reinterpret_cast<MultifileHeader*>(buffer);
-            header->crc =
-                    crc32c(buffer + sizeof(MultifileHeader), bufferSize - sizeof(MultifileHeader));
-
-            ssize_t result = write(fd, buffer, bufferSize);
-            if (result != bufferSize) {
-                ALOGE("Error writing fileSize to cache entry (%s): %s", fullPath.c_str(),
-                      std::strerror(errno));
-                return;
-            }
-
-            ALOGV("DEFERRED: Completed write for: %s", fullPath.c_str());
-            close(fd);
-
-            // Erase the entry from mDeferredWrites
-            // Since there could be multiple outstanding writes for an entry, find the matching one
-            {
-                // Synchronize access to deferred write status
-                std::lock_guard<std::mutex> lock(mDeferredWriteStatusMutex);
-                typedef std::multimap<uint32_t, uint8_t*>::iterator entryIter;
-                std::pair<entryIter, entryIter> iterPair = mDeferredWrites.equal_range(entryHash);
-                for (entryIter it = iterPair.first; it != iterPair.second; ++it) {
-                    if (it->second == buffer) {
-                        ALOGV("DEFERRED: Marking write complete for %u at %p", it->first,
-                              it->second);
-                        mDeferredWrites.erase(it);
-                        break;
-                    }
-                }
-            }
-
+            writeToDisk(task);
+            completeWriteToDisk(task);
             return;
         }
         default: {
@@ -879,7 +998,86 @@ void MultifileBlobCache::processTask(DeferredTask& task) {
     }
 }
 
+// Performs a batch of tasks queued together. Only the last write for each entry is performed,
+// since it replaces the file that earlier writes would have produced.
+void MultifileBlobCache::processTaskBatch(std::vector<DeferredTask>& tasks) {
+    std::unordered_map<uint32_t, size_t> lastWrites;
+    for (size_t i = 0; i < tasks.size(); i++) {
+        if (tasks[i].getTaskCommand() == TaskCommand::WriteToDisk) {
+            lastWrites[tasks[i].getEntryHash()] = i;
+        }
+    }
+
+    for (size_t i = 0; i < tasks.size(); i++) {
+        DeferredTask& task = tasks[i];
+        if (task.getTaskCommand() == TaskCommand::WriteToDisk &&
+            lastWrites[task.getEntryHash()] != i) {
+            ALOGV("DEFERRED: Skipping superseded write for %u", task.getEntryHash());
+            completeWriteToDisk(task);
+            continue;
+        }
+        processTask(task);
+    }
+}
+
+void MultifileBlobCache::writeToDisk(DeferredTask& task) {
+    std::string& fullPath = task.getFullPath();
+    uint8_t* buffer = task.getBuffer();
+    size_t bufferSize = task.getBufferSize();
+
+    // Create the file or reset it if already present, read+write for user only
+    int fd = open(fullPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+    if (fd == -1) {
+        ALOGE("Cache error in SET - failed to open fullPath: %s, error: %s", fullPath.c_str(),
+              std::strerror(errno));
+        return;
+    }
+
+    ALOGV("DEFERRED: Opened fd %i from %s", fd, fullPath.c_str());
+
+    // Add CRC check to the header (always do this last!)
+    MultifileHeader* header = reinterpret_cast<MultifileHeader*>(buffer);
+    header->crc = crc32c(buffer + sizeof(MultifileHeader), bufferSize - sizeof(MultifileHeader));
+
+    ssize_t result = write(fd, buffer, bufferSize);
+    close(fd);
+    if (result != bufferSize) {
+        ALOGE("Error writing fileSize to cache entry (%s): %s", fullPath.c_str(),
+              std::strerror(errno));
+        return;
+    }
+
+    ALOGV("DEFERRED: Completed write for: %s", fullPath.c_str());
+}
+
+void MultifileBlobCache::completeWriteToDisk(DeferredTask& task) {
+    uint32_t entryHash = task.getEntryHash();
+    uint8_t* buffer = task.getBuffer();
+
+    // Erase the entry from mDeferredWrites
+    // Since there could be multiple outstanding writes for an entry, find the matching one
+    {
+        // Synchronize access to deferred write status
+        std::lock_guard<std::mutex> lock(mDeferredWriteStatusMutex);
+        typedef std::multimap<uint32_t, uint8_t*>::iterator entryIter;
+        std::pair<entryIter, entryIter> iterPair = mDeferredWrites.equal_range(entryHash);
+        for (entryIter it = iterPair.first; it != iterPair.second; ++it) {
+            if (it->second == buffer) {
+                ALOGV("DEFERRED: Marking write complete for %u at %p", it->first, it->second);
+                mDeferredWrites.erase(it);
+                break;
+            }
+        }
+    }
+
+    // Compressed copies only exist for the write
+    if (task.ownsBuffer()) {
+        delete[] buffer;
+    }
+}
+
 // This function will wait until tasks arrive, then execute them
+// Tasks queued while the worker is busy are taken and executed together
 // If the exit command is submitted, the loop will terminate
 void MultifileBlobCache::processTasksImpl(bool* exitThread) {
     while (true) {
@@ -892,21 +1090,27 @@ void MultifileBlobCache::processTasksImpl(bool* exitThread) {
             mWorkAvailableCondition.wait(lock, [this] { return !mTasks.empty(); });
         }
 
-        ALOGV("WORKER: Task available, waking up.");
+        ALOGV("WORKER: %zu tasks available, waking up.", mTasks.size());
         mWorkerThreadIdle = false;
-        DeferredTask task = std::move(mTasks.front());
-        mTasks.pop();
+        std::vector<DeferredTask> tasks;
+        bool exit = false;
+        while (!mTasks.empty() && !exit) {
+            exit = mTasks.front().getTaskCommand() == TaskCommand::Exit;
+            tasks.push_back(std::move(mTasks.front()));
+            mTasks.pop();
+        }
 
-        if (task.getTaskCommand() == TaskCommand::Exit) {
+        lock.unlock();
+        processTaskBatch(tasks);
+
+        if (exit) {
             ALOGV("WORKER: Exiting work loop.");
+            lock.lock();
             *exitThread = true;
             mWorkerThreadIdle = true;
             mWorkerIdleCondition.notify_one();
             return;
         }
-
-        lock.unlock();
-        processTask(task);
     }
 }
 
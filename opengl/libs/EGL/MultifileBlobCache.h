@@ -29,19 +29,28 @@
 #include <thread>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "FileBlobCache.h"
 
 namespace android {
 
-constexpr uint32_t kMultifileBlobCacheVersion = 1;
+constexpr uint32_t kMultifileBlobCacheVersion = 2;
 constexpr char kMultifileBlobCacheStatusFile[] = "cache.status";
 
+// How the value of an entry is stored on disk. Entries are always decoded before they are
+// added to the hot cache.
+enum class MultifileEncoding : uint32_t {
+    None = 0,
+    LZ4 = 1,
+};
+
 struct MultifileHeader {
     uint32_t magic;
     uint32_t crc;
     EGLsizeiANDROID keySize;
     EGLsizeiANDROID valueSize;
+    MultifileEncoding encoding;
 };
 
 struct MultifileEntryStats {
@@ -72,23 +81,31 @@ enum class TaskCommand {
 class DeferredTask {
 public:
     DeferredTask(TaskCommand command)
-          : mCommand(command), mEntryHash(0), mBuffer(nullptr), mBufferSize(0) {}
+          : mCommand(command),
+            mEntryHash(0),
+            mBuffer(nullptr),
+            mBufferSize(0),
+            mOwnsBuffer(false) {}
 
     TaskCommand getTaskCommand() { return mCommand; }
 
+    // The buffer is freed once written if ownsBuffer is set, and otherwise belongs to the hot
+    // cache.
     void initWriteToDisk(uint32_t entryHash, std::string fullPath, uint8_t* buffer,
-                         size_t bufferSize) {
+                         size_t bufferSize, bool ownsBuffer) {
         mCommand = TaskCommand::WriteToDisk;
         mEntryHash = entryHash;
         mFullPath = std::move(fullPath);
         mBuffer = buffer;
         mBufferSize = bufferSize;
+        mOwnsBuffer = ownsBuffer;
     }
 
     uint32_t getEntryHash() { return mEntryHash; }
     std::string& getFullPath() { return mFullPath; }
     uint8_t* getBuffer() { return mBuffer; }
     size_t getBufferSize() { return mBufferSize; };
+    bool ownsBuffer() { return mOwnsBuffer; }
 
 private:
     TaskCommand mCommand;
@@ -98,6 +115,7 @@ private:
     std::string mFullPath;
     uint8_t* mBuffer;
     size_t mBufferSize;
+    bool mOwnsBuffer;
 };
 
 class MultifileBlobCache {
@@ -127,6 +145,8 @@ private:
                     time_t accessTime);
     bool contains(uint32_t entryHash) const;
     bool removeEntry(uint32_t entryHash);
+    bool checkEntryCrc(const uint8_t* entry, size_t entrySize) const;
+    bool decodeMappedEntry(uint8_t** entryBuffer, size_t* entrySize, int* fd) const;
     MultifileEntryStats getEntryStats(uint32_t entryHash);
 
     bool createStatus(const std::string& baseDir);
@@ -151,6 +171,9 @@ private:
     std::string mBuildId;
     uint32_t mCacheVersion;
 
+    // Whether values are compressed with LZ4 before they are written to disk
+    bool mCompressionEnabled;
+
     std::unordered_set<uint32_t> mEntries;
     std::unordered_map<uint32_t, MultifileEntryStats> mEntryStats;
     std::unordered_map<uint32_t, MultifileHotCache> mHotCache;
@@ -175,6 +198,9 @@ private:
     void processTasks();
     void processTasksImpl(bool* exitThread);
     void processTask(DeferredTask& task);
+    void processTaskBatch(std::vector<DeferredTask>& tasks);
+    void writeToDisk(DeferredTask& task);
+    void completeWriteToDisk(DeferredTask& task);
 
     // Used by main thread to create work for the worker thread
     void queueTask(DeferredTask&& task);
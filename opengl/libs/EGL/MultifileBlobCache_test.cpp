@@ -21,9 +21,11 @@
 #include <fcntl.h>
 #include <gtest/gtest.h>
 #include <stdio.h>
+#include <unistd.h>
 
 #include <fstream>
 #include <memory>
+#include <vector>
 
 using namespace std::literals;
 
@@ -67,6 +69,9 @@ void MultifileBlobCacheTest::clearProperties() {
 
     base::SetProperty("debug.egl.blobcache.build_id", "");
     base::WaitForProperty("debug.egl.blobcache.build_id", "");
+
+    base::SetProperty("debug.egl.blobcache.multifile_compression", "");
+    base::WaitForProperty("debug.egl.blobcache.multifile_compression", "");
 }
 
 TEST_F(MultifileBlobCacheTest, CacheSingleValueSucceeds) {
@@ -503,4 +508,92 @@ TEST_F(MultifileBlobCacheTest, MismatchedBuildIdClears) {
     ASSERT_EQ(getCacheEntries().size(), 0);
 }
 
+
+// Verify corrupted entries are removed, whether or not they are preloaded into the hot cache
+TEST_F(MultifileBlobCacheTest, CorruptedEntriesAreRemoved) {
+    // Set two entries, which are too large to be preloaded together
+    std::vector<uint8_t> value(kMaxValueSize, 0x12);
+    mMBC->set("abcd", 4, value.data(), value.size());
+    mMBC->set("efgh", 4, value.data(), value.size());
+
+    // Close the cache so everything writes out
+    mMBC->finish();
+    mMBC.reset();
+
+    // Flip the last byte of each entry
+    std::vector<std::string> cacheEntries = getCacheEntries();
+    ASSERT_EQ(cacheEntries.size(), 2);
+    for (const std::string& cacheEntry : cacheEntries) {
+        int fd = open(cacheEntry.c_str(), O_WRONLY);
+        ASSERT_NE(fd, -1);
+        uint8_t corrupted = 0x34;
+        ASSERT_EQ(pwrite(fd, &corrupted, 1, lseek(fd, 0, SEEK_END) - 1), 1);
+        close(fd);
+    }
+
+    // Open the cache again and ensure no cache hits
+    mMBC.reset(new MultifileBlobCache(kMaxKeySize, kMaxValueSize, kMaxTotalSize, kMaxTotalEntries,
+                                      &mTempFile->path[0]));
+    ASSERT_EQ(size_t(0), mMBC->get("abcd", 4, value.data(), value.size()));
+    ASSERT_EQ(size_t(0), mMBC->get("efgh", 4, value.data(), value.size()));
+
+    // Ensure we have no entries
+    ASSERT_EQ(getCacheEntries().size(), 0);
+    ASSERT_EQ(mMBC->getTotalEntries(), 0);
+}
+
+// Verify compressed entries take less space, and read back the same from hot cache and disk
+TEST_F(MultifileBlobCacheTest, CompressedEntriesRoundTrip) {
+    ASSERT_TRUE(base::SetProperty("debug.egl.blobcache.multifile_compression", "true"));
+    ASSERT_TRUE(base::WaitForProperty("debug.egl.blobcache.multifile_compression", "true"));
+    mMBC.reset(new MultifileBlobCache(kMaxKeySize, kMaxValueSize, kMaxTotalSize, kMaxTotalEntries,
+                                      &mTempFile->path[0]));
+
+    std::vector<uint8_t> value(kMaxValueSize);
+    for (size_t i = 0; i < value.size(); i++) {
+        value[i] = static_cast<uint8_t>(i / 64);
+    }
+    mMBC->set("abcd", 4, value.data(), value.size());
+    ASSERT_LT(mMBC->getTotalSize(), sizeof(MultifileHeader) + 4 + value.size());
+
+    std::vector<uint8_t> buf(kMaxValueSize, 0xee);
+    ASSERT_EQ(value.size(), mMBC->get("abcd", 4, buf.data(), buf.size()));
+    ASSERT_EQ(value, buf);
+
+    // Close the cache so everything writes out
+    mMBC->finish();
+    mMBC.reset();
+
+    // Reading entries back doesn't depend on compression being enabled
+    clearProperties();
+    mMBC.reset(new MultifileBlobCache(kMaxKeySize, kMaxValueSize, kMaxTotalSize, kMaxTotalEntries,
+                                      &mTempFile->path[0]));
+    ASSERT_EQ(mMBC->getTotalEntries(), 1);
+    ASSERT_LT(mMBC->getTotalSize(), sizeof(MultifileHeader) + 4 + value.size());
+
+    std::fill(buf.begin(), buf.end(), 0xee);
+    ASSERT_EQ(value.size(), mMBC->get("abcd", 4, buf.data(), buf.size()));
+    ASSERT_EQ(value, buf);
+}
+
+// Verify that rewriting an entry many times leaves the last value on disk
+TEST_F(MultifileBlobCacheTest, RepeatedSetsKeepLastValue) {
+    unsigned char buf[4] = {0xee, 0xee, 0xee, 0xee};
+    for (char c = 'a'; c <= 'z'; c++) {
+        char value[4] = {c, c, c, c};
+        mMBC->set("abcd", 4, value, 4);
+    }
+
+    // Close the cache so everything writes out
+    mMBC->finish();
+    mMBC.reset();
+
+    mMBC.reset(new MultifileBlobCache(kMaxKeySize, kMaxValueSize, kMaxTotalSize, kMaxTotalEntries,
+                                      &mTempFile->path[0]));
+    ASSERT_EQ(getCacheEntries().size(), 1);
+    ASSERT_EQ(size_t(4), mMBC->get("abcd", 4, buf, 4));
+    ASSERT_EQ('z', buf[0]);
+    ASSERT_EQ('z', buf[3]);
+}
+
 } // namespace android
@@ -43,6 +43,9 @@ constexpr uint32_t kMaxMultifileValueSize = 8 * 1024 * 1024;
 constexpr uint32_t kMaxMultifileTotalSize = 32 * 1024 * 1024;
 constexpr uint32_t kMaxMultifileTotalEntries = 4 * 1024;
 
+// The property naming the shared, read-only cache file, if the device provides one.
+static const char* kSharedCacheFileProperty = "ro.egl.blobcache.shared_file";
+
 namespace android {
 
 #define BC_EXT_STR "EGL_ANDROID_blob_cache"
@@ -69,7 +72,10 @@ static EGLsizeiANDROID getBlob(const void* key, EGLsizeiANDROID keySize, void* v
 // egl_cache_t definition
 //
 egl_cache_t::egl_cache_t()
-      : mInitialized(false), mMultifileMode(false), mCacheByteLimit(kMaxMonolithicTotalSize) {}
+      : mInitialized(false),
+        mSharedBlobCacheLoaded(false),
+        mMultifileMode(false),
+        mCacheByteLimit(kMaxMonolithicTotalSize) {}
 
 egl_cache_t::~egl_cache_t() {}
 
@@ -125,6 +131,8 @@ void egl_cache_t::terminate() {
         mMultifileBlobCache->finish();
     }
     mMultifileBlobCache = nullptr;
+    mSharedBlobCache = nullptr;
+    mSharedBlobCacheLoaded = false;
     mInitialized = false;
 }
 
@@ -175,6 +183,15 @@ EGLsizeiANDROID egl_cache_t::getBlob(const void* key, EGLsizeiANDROID keySize, v
     updateMode();
 
     if (mInitialized) {
+        // The shared cache is consulted first, so that the shaders it contains aren't compiled
+        // again by every process.
+        if (FileBlobCache* sharedCache = getSharedBlobCacheLocked()) {
+            size_t sharedValueSize = sharedCache->get(key, keySize, value, valueSize);
+            if (sharedValueSize > 0) {
+                return sharedValueSize;
+            }
+        }
+
         if (mMultifileMode) {
             MultifileBlobCache* mbc = getMultifileBlobCacheLocked();
             return mbc->get(key, keySize, value, valueSize);
@@ -274,6 +291,19 @@ BlobCache* egl_cache_t::getBlobCacheLocked() {
     return mBlobCache.get();
 }
 
+FileBlobCache* egl_cache_t::getSharedBlobCacheLocked() {
+    if (!mSharedBlobCacheLoaded) {
+        mSharedBlobCacheLoaded = true;
+        std::string sharedFilename = base::GetProperty(kSharedCacheFileProperty, "");
+        if (!sharedFilename.empty() && access(sharedFilename.c_str(), R_OK) == 0) {
+            ALOGV("Using shared EGL blobcache %s", sharedFilename.c_str());
+            mSharedBlobCache.reset(new FileBlobCache(kMaxMultifileKeySize, kMaxMultifileValueSize,
+                                                     kMaxMultifileTotalSize, sharedFilename));
+        }
+    }
+    return mSharedBlobCache.get();
+}
+
 MultifileBlobCache* egl_cache_t::getMultifileBlobCacheLocked() {
     if (mMultifileBlobCache == nullptr) {
         mMultifileBlobCache.reset(new MultifileBlobCache(kMaxMultifileKeySize,
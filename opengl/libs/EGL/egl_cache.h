@@ -100,6 +100,11 @@ private:
     // Get or create the multifile blobcache
     MultifileBlobCache* getMultifileBlobCacheLocked();
 
+    // getSharedBlobCacheLocked returns the shared, read-only cache named by the
+    // ro.egl.blobcache.shared_file property, loading it the first time it's
+    // needed. It returns nullptr if the device doesn't provide one.
+    FileBlobCache* getSharedBlobCacheLocked();
+
     // mInitialized indicates whether the egl_cache_t is in the initialized
     // state.  It is initialized to false at construction time, and gets set to
     // true when initialize is called.  It is set back to false when terminate
@@ -116,6 +121,15 @@ private:
     // The multifile version of blobcache allowing larger contents to be stored
     std::unique_ptr<MultifileBlobCache> mMultifileBlobCache;
 
+    // mSharedBlobCache holds the entries that a system component has compiled
+    // ahead of time for all processes. It uses the same format as the monolithic
+    // cache, stays mapped from its file instead of being copied, and is never
+    // written to; new entries still go to the process's own cache.
+    // mSharedBlobCacheLoaded tells whether getSharedBlobCacheLocked has already
+    // tried to load it.
+    std::unique_ptr<FileBlobCache> mSharedBlobCache;
+    bool mSharedBlobCacheLoaded;
+
     // mFilename is the name of the file for storing cache contents in between
     // program invocations.  It is initialized to an empty string at
     // construction time, and can be set with the setCacheFilename method.  An
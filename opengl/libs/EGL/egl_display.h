@@ -116,6 +116,9 @@ private:
     uint32_t refs;
     bool eglIsInitialized;
     mutable std::mutex lock;
+    // Guards objects only, so that validating a handle never waits behind a
+    // driver call made with lock held, such as eglMakeCurrent on another thread.
+    mutable std::mutex objectsLock;
     mutable std::mutex refLock;
     mutable std::condition_variable refCond;
     std::unordered_set<egl_object_t*> objects;
@@ -342,8 +342,13 @@ void LayerLoader::InitLayers(egl_connection_t* cnx) {
 void LayerLoader::LoadLayers() {
     std::string debug_layers = GetDebugLayers();
 
-    // If no layers are specified, we're done
-    if (debug_layers.empty()) return;
+    // If no layers are specified, we're done. Remember that, so that later lookups through
+    // getInstance(), such as every eglGetProcAddress, don't query the settings again. The GLES
+    // hooks installed by InitLayers are then the driver's own entry points.
+    if (debug_layers.empty()) {
+        layers_loaded_ = true;
+        return;
+    }
 
     // Only enable the system search path for non-user builds
     std::string system_path;
@@ -23,12 +23,16 @@
 #include <android-base/stringprintf.h>
 #include <libbpf.h>
 #include <bpf/WaitForProgsLoaded.h>
+#include <linux/bpf.h>
 #include <log/log.h>
+#include <sys/syscall.h>
 #include <unistd.h>
 #include <utils/Timers.h>
 #include <utils/Trace.h>
 
-#include <unordered_map>
+#include <algorithm>
+#include <atomic>
+#include <optional>
 #include <vector>
 
 namespace android {
@@ -91,67 +95,150 @@ void GpuMem::dump(const Vector<String16>& /* args */, std::string* result) {
         return;
     }
 
-    auto res = mGpuMemTotalMap.getFirstKey();
-    if (!res.ok()) {
+    GpuMemSnapshot snapshot;
+    if (!readGpuMemTotals(&snapshot) || snapshot.totals.empty()) {
         result->append("GPU memory total usage map is empty\n");
         return;
     }
-    uint64_t key = res.value();
-    // unordered_map<gpu_id, vector<pair<pid, size>>>
-    std::unordered_map<uint32_t, std::vector<std::pair<uint32_t, uint64_t>>> dumpMap;
-    while (true) {
-        uint32_t gpu_id = key >> 32;
-        uint32_t pid = key;
-
-        res = mGpuMemTotalMap.readValue(key);
-        if (!res.ok()) break;
-        uint64_t size = res.value();
-
-        dumpMap[gpu_id].emplace_back(pid, size);
-
-        res = mGpuMemTotalMap.getNextKey(key);
-        if (!res.ok()) break;
-        key = res.value();
-    }
-
-    for (auto& gpu : dumpMap) {
-        if (gpu.second.empty()) continue;
-        StringAppendF(result, "Memory snapshot for GPU %u:\n", gpu.first);
 
-        std::sort(gpu.second.begin(), gpu.second.end(),
-                  [](auto& l, auto& r) { return l.first < r.first; });
+    // The totals are sorted by gpu, and the global total of a gpu comes first.
+    for (auto gpu = snapshot.totals.begin(); gpu != snapshot.totals.end();) {
+        auto gpuEnd = std::find_if(gpu, snapshot.totals.end(),
+                                   [gpu](const auto& total) { return total.gpuId != gpu->gpuId; });
+        StringAppendF(result, "Memory snapshot for GPU %u:\n", gpu->gpuId);
 
-        int i = 0;
-        if (gpu.second[0].first != 0) {
+        auto proc = gpu;
+        if (proc->pid != 0) {
             StringAppendF(result, "Global total: N/A\n");
         } else {
-            StringAppendF(result, "Global total: %" PRIu64 "\n", gpu.second[0].second);
-            i++;
+            StringAppendF(result, "Global total: %" PRIu64 "\n", proc->size);
+            proc++;
         }
-        for (; i < gpu.second.size(); i++) {
-            StringAppendF(result, "Proc %u total: %" PRIu64 "\n", gpu.second[i].first,
-                          gpu.second[i].second);
+        for (; proc != gpuEnd; proc++) {
+            StringAppendF(result, "Proc %u total: %" PRIu64 "\n", proc->pid, proc->size);
         }
+        gpu = gpuEnd;
     }
 }
 
 void GpuMem::traverseGpuMemTotals(const std::function<void(int64_t ts, uint32_t gpuId, uint32_t pid,
                                                            uint64_t size)>& callback) {
-    auto res = mGpuMemTotalMap.getFirstKey();
-    if (!res.ok()) return;
-    uint64_t key = res.value();
+    GpuMemSnapshot snapshot;
+    readGpuMemTotals(&snapshot);
+    for (const auto& total : snapshot.totals) {
+        callback(snapshot.timestamp, total.gpuId, total.pid, total.size);
+    }
+}
+
+// Number of entries read per BPF_MAP_LOOKUP_BATCH call.
+static constexpr uint32_t kBatchSize = 256;
+static std::atomic<bool> sBatchLookupSupported = true;
+
+// Append every entry of the map to totals with BPF_MAP_LOOKUP_BATCH, which reads many entries per
+// syscall rather than two syscalls per entry. Returns no value if the kernel does not support
+// batch lookups, and false if the map could not be read.
+static std::optional<bool> readGpuMemTotalsBatched(int mapFd, std::vector<GpuMemTotal>* totals) {
+    if (!sBatchLookupSupported.load(std::memory_order_relaxed)) return std::nullopt;
+
+    thread_local std::vector<uint64_t> keys;
+    thread_local std::vector<uint64_t> values;
+    uint32_t batchSize = kBatchSize;
+    // Opaque position in the map, at most as large as a key.
+    uint64_t batch = 0;
+    bool first = true;
     while (true) {
-        uint32_t gpu_id = key >> 32;
-        uint32_t pid = key;
+        if (keys.size() < batchSize) {
+            keys.resize(batchSize);
+            values.resize(batchSize);
+        }
+        union bpf_attr attr = {};
+        attr.batch.in_batch = first ? 0 : reinterpret_cast<uintptr_t>(&batch);
+        attr.batch.out_batch = reinterpret_cast<uintptr_t>(&batch);
+        attr.batch.keys = reinterpret_cast<uintptr_t>(keys.data());
+        attr.batch.values = reinterpret_cast<uintptr_t>(values.data());
+        attr.batch.count = batchSize;
+        attr.batch.map_fd = mapFd;
+        const int ret = syscall(__NR_bpf, BPF_MAP_LOOKUP_BATCH, &attr, sizeof(attr));
+        const int err = errno;
+        if (ret && err != ENOENT) {
+            if (err == ENOSPC) {
+                // A hash bucket holds more entries than fit in the buffers.
+                batchSize *= 2;
+                continue;
+            }
+            if (first && (err == EINVAL || err == ENOTSUP || err == 524 /* ENOTSUPP */)) {
+                sBatchLookupSupported.store(false, std::memory_order_relaxed);
+                return std::nullopt;
+            }
+            ALOGE("Failed to read gpu memory total map [%d(%s)]", err, strerror(err));
+            return false;
+        }
+        // On ENOENT, count holds the last entries of the map.
+        for (uint32_t i = 0; i < attr.batch.count; i++) {
+            totals->push_back({static_cast<uint32_t>(keys[i] >> 32),
+                               static_cast<uint32_t>(keys[i]), values[i]});
+        }
+        if (ret) break;
+        first = false;
+    }
+    return true;
+}
+
+bool GpuMem::readGpuMemTotals(GpuMemSnapshot* snapshot) {
+    ATRACE_CALL();
+
+    snapshot->totals.clear();
+    if (!mInitialized.load() || !mGpuMemTotalMap.isValid()) return false;
+
+    snapshot->timestamp = systemTime();
+    auto batched = readGpuMemTotalsBatched(mGpuMemTotalMap.getMap().get(), &snapshot->totals);
+    if (batched.has_value()) {
+        if (!*batched) {
+            snapshot->totals.clear();
+            return false;
+        }
+    } else {
+        auto res = mGpuMemTotalMap.getFirstKey();
+        while (res.ok()) {
+            const uint64_t key = res.value();
+            res = mGpuMemTotalMap.readValue(key);
+            if (!res.ok()) break;
+            snapshot->totals.push_back(
+                    {static_cast<uint32_t>(key >> 32), static_cast<uint32_t>(key), res.value()});
+            res = mGpuMemTotalMap.getNextKey(key);
+        }
+    }
 
-        res = mGpuMemTotalMap.readValue(key);
-        if (!res.ok()) break;
-        uint64_t size = res.value();
+    std::sort(snapshot->totals.begin(), snapshot->totals.end(), [](const auto& l, const auto& r) {
+        return l.gpuId != r.gpuId ? l.gpuId < r.gpuId : l.pid < r.pid;
+    });
+    return true;
+}
 
-        callback(systemTime(), gpu_id, pid, size);
-        res = mGpuMemTotalMap.getNextKey(key);
-        if (!res.ok()) break;
-        key = res.value();
+void GpuMem::computeGpuMemDeltas(const GpuMemSnapshot& previous, const GpuMemSnapshot& current,
+                                 std::vector<GpuMemDelta>* deltas) {
+    deltas->clear();
+    auto before = [](const GpuMemTotal& l, const GpuMemTotal& r) {
+        return l.gpuId != r.gpuId ? l.gpuId < r.gpuId : l.pid < r.pid;
+    };
+    auto prev = previous.totals.begin();
+    auto cur = current.totals.begin();
+    while (prev != previous.totals.end() || cur != current.totals.end()) {
+        if (cur == current.totals.end() ||
+            (prev != previous.totals.end() && before(*prev, *cur))) {
+            deltas->push_back({prev->gpuId, prev->pid, -static_cast<int64_t>(prev->size)});
+            prev++;
+        } else if (prev == previous.totals.end() || before(*cur, *prev)) {
+            deltas->push_back({cur->gpuId, cur->pid, static_cast<int64_t>(cur->size)});
+            cur++;
+        } else {
+            if (cur->size != prev->size) {
+                deltas->push_back({cur->gpuId, cur->pid,
+                                   static_cast<int64_t>(cur->size - prev->size)});
+            }
+            prev++;
+            cur++;
+        }
     }
 }
 
@@ -21,9 +21,32 @@
 #include <utils/Vector.h>
 
 #include <functional>
+#include <vector>
 
 namespace android {
 
+// Gpu memory total of a process on a gpu. A pid of 0 holds the global total of the gpu.
+struct GpuMemTotal {
+    uint32_t gpuId;
+    uint32_t pid;
+    uint64_t size;
+};
+
+// Copy of the gpu memory total map at one point in time.
+struct GpuMemSnapshot {
+    int64_t timestamp = 0;
+    // Sorted by gpu id, then by pid.
+    std::vector<GpuMemTotal> totals;
+};
+
+// Change of a gpu memory total between two snapshots. Entries which disappeared have a delta of
+// minus their previous size.
+struct GpuMemDelta {
+    uint32_t gpuId;
+    uint32_t pid;
+    int64_t delta;
+};
+
 class GpuMem {
 public:
     GpuMem() = default;
@@ -40,6 +63,14 @@ public:
     void traverseGpuMemTotals(const std::function<void(int64_t ts, uint32_t gpuId, uint32_t pid,
                                                        uint64_t size)>& callback);
 
+    // Copy the gpu memory total map into snapshot, reusing its storage. The map is read with
+    // batched lookups where the kernel supports them. Returns false if the map could not be read.
+    bool readGpuMemTotals(GpuMemSnapshot* snapshot);
+
+    // Compute the changes from previous to current, skipping totals which did not change.
+    static void computeGpuMemDeltas(const GpuMemSnapshot& previous, const GpuMemSnapshot& current,
+                                    std::vector<GpuMemDelta>* deltas);
+
 private:
     // Friend class for testing.
     friend class TestableGpuMem;
@@ -26,6 +26,7 @@
 #include <statslog.h>
 #include <utils/Trace.h>
 
+#include <algorithm>
 #include <unordered_set>
 
 namespace android {
@@ -84,36 +85,54 @@ static void addLoadingTime(GpuStatsInfo::Driver driver, int64_t driverLoadingTim
     }
 }
 
+size_t GpuStats::AppStatsKeyHash::operator()(const AppStatsKeyView& key) const {
+    const size_t hash = std::hash<std::string_view>{}(key.appPackageName);
+    return hash ^ (std::hash<uint64_t>{}(key.driverVersionCode) + 0x9e3779b9 + (hash << 6) +
+                   (hash >> 2));
+}
+
+GpuStats::AppStatsShard& GpuStats::appStatsShard(std::string_view appPackageName) {
+    return mAppStatsShards[std::hash<std::string_view>{}(appPackageName) % NUM_APP_STATS_SHARDS];
+}
+
 void GpuStats::purgeOldDriverStats() {
-    ALOG_ASSERT(mAppStats.size() == MAX_NUM_APP_RECORDS);
+    std::array<std::unique_lock<std::mutex>, NUM_APP_STATS_SHARDS> locks;
+    for (size_t i = 0; i < NUM_APP_STATS_SHARDS; ++i) {
+        locks[i] = std::unique_lock<std::mutex>(mAppStatsShards[i].lock);
+    }
+
+    // Another app launch may have purged the stats while we waited for the locks.
+    if (mNumAppStats.load() < MAX_NUM_APP_RECORDS) {
+        return;
+    }
 
     struct GpuStatsApp {
-        // Key is <app package name>+<driver version code>.
-        const std::string *appStatsKey = nullptr;
-        const std::chrono::time_point<std::chrono::system_clock> *lastAccessTime = nullptr;
+        AppStatsMap* appStats = nullptr;
+        AppStatsMap::iterator appStatsIt;
     };
-    std::vector<GpuStatsApp> gpuStatsApps(MAX_NUM_APP_RECORDS);
+    std::vector<GpuStatsApp> gpuStatsApps;
+    gpuStatsApps.reserve(mNumAppStats.load());
 
-    // Create a list of pointers to package names and their last access times.
-    int index = 0;
-    for (const auto & [appStatsKey, gpuStatsAppInfo] : mAppStats) {
-        GpuStatsApp &gpuStatsApp = gpuStatsApps[index];
-        gpuStatsApp.appStatsKey = &appStatsKey;
-        gpuStatsApp.lastAccessTime = &gpuStatsAppInfo.lastAccessTime;
-        ++index;
+    // Create a list of all the app stats, which refer to their last access times.
+    for (auto& shard : mAppStatsShards) {
+        for (auto it = shard.stats.begin(); it != shard.stats.end(); ++it) {
+            gpuStatsApps.push_back({&shard.stats, it});
+        }
     }
 
-    // Sort the list with the oldest access times at the front.
-    std::sort(gpuStatsApps.begin(), gpuStatsApps.end(), [](GpuStatsApp a, GpuStatsApp b) -> bool {
-        return *a.lastAccessTime < *b.lastAccessTime;
-    });
-
-    // Remove the oldest packages from mAppStats to make room for new apps.
-    for (int i = 0; i < APP_RECORD_HEADROOM; ++i) {
-        mAppStats.erase(*gpuStatsApps[i].appStatsKey);
-        gpuStatsApps[i].appStatsKey = nullptr;
-        gpuStatsApps[i].lastAccessTime = nullptr;
+    // Move the oldest access times to the front of the list.
+    const size_t numPurged = std::min(APP_RECORD_HEADROOM, gpuStatsApps.size());
+    std::partial_sort(gpuStatsApps.begin(), gpuStatsApps.begin() + numPurged, gpuStatsApps.end(),
+                      [](const GpuStatsApp& a, const GpuStatsApp& b) -> bool {
+                          return a.appStatsIt->second.lastAccessTime <
+                                  b.appStatsIt->second.lastAccessTime;
+                      });
+
+    // Remove the oldest packages from the app stats to make room for new apps.
+    for (size_t i = 0; i < numPurged; ++i) {
+        gpuStatsApps[i].appStats->erase(gpuStatsApps[i].appStatsIt);
     }
+    mNumAppStats -= numPurged;
 }
 
 void GpuStats::insertDriverStats(const std::string& driverPackageName,
@@ -123,7 +142,6 @@ void GpuStats::insertDriverStats(const std::string& driverPackageName,
                                  bool isDriverLoaded, int64_t driverLoadingTime) {
     ATRACE_CALL();
 
-    std::lock_guard<std::mutex> lock(mLock);
     registerStatsdCallbacksIfNeeded();
     ALOGV("Received:\n"
           "\tdriverPackageName[%s]\n"
@@ -139,39 +157,50 @@ void GpuStats::insertDriverStats(const std::string& driverPackageName,
           appPackageName.c_str(), vulkanVersion, static_cast<int32_t>(driver), isDriverLoaded,
           driverLoadingTime);
 
-    if (!mGlobalStats.count(driverVersionCode)) {
-        GpuStatsGlobalInfo globalInfo;
-        addLoadingCount(driver, isDriverLoaded, &globalInfo);
-        globalInfo.driverPackageName = driverPackageName;
-        globalInfo.driverVersionName = driverVersionName;
-        globalInfo.driverVersionCode = driverVersionCode;
-        globalInfo.driverBuildTime = driverBuildTime;
-        globalInfo.vulkanVersion = vulkanVersion;
-        mGlobalStats.insert({driverVersionCode, globalInfo});
-    } else {
-        addLoadingCount(driver, isDriverLoaded, &mGlobalStats[driverVersionCode]);
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+        if (!mGlobalStats.count(driverVersionCode)) {
+            GpuStatsGlobalInfo globalInfo;
+            addLoadingCount(driver, isDriverLoaded, &globalInfo);
+            globalInfo.driverPackageName = driverPackageName;
+            globalInfo.driverVersionName = driverVersionName;
+            globalInfo.driverVersionCode = driverVersionCode;
+            globalInfo.driverBuildTime = driverBuildTime;
+            globalInfo.vulkanVersion = vulkanVersion;
+            mGlobalStats.insert({driverVersionCode, globalInfo});
+        } else {
+            addLoadingCount(driver, isDriverLoaded, &mGlobalStats[driverVersionCode]);
+        }
     }
 
-    const std::string appStatsKey = appPackageName + std::to_string(driverVersionCode);
-    if (!mAppStats.count(appStatsKey)) {
-        if (mAppStats.size() >= MAX_NUM_APP_RECORDS) {
-            ALOGV("GpuStatsAppInfo has reached maximum size. Removing old stats to make room.");
-            purgeOldDriverStats();
-        }
+    const bool angleInUse = driver == GpuStatsInfo::Driver::ANGLE || driverPackageName == "angle";
+    const AppStatsKeyView appStatsKey{appPackageName, driverVersionCode};
+    AppStatsShard& shard = appStatsShard(appPackageName);
+    std::unique_lock<std::mutex> lock(shard.lock);
+
+    auto foundApp = shard.stats.find(appStatsKey);
+    if (foundApp == shard.stats.end() && mNumAppStats.load() >= MAX_NUM_APP_RECORDS) {
+        ALOGV("GpuStatsAppInfo has reached maximum size. Removing old stats to make room.");
+        lock.unlock();
+        purgeOldDriverStats();
+        lock.lock();
+        foundApp = shard.stats.find(appStatsKey);
+    }
 
+    if (foundApp == shard.stats.end()) {
         GpuStatsAppInfo appInfo;
         addLoadingTime(driver, driverLoadingTime, &appInfo);
         appInfo.appPackageName = appPackageName;
         appInfo.driverVersionCode = driverVersionCode;
-        appInfo.angleInUse =
-                driver == GpuStatsInfo::Driver::ANGLE || driverPackageName == "angle";
+        appInfo.angleInUse = angleInUse;
         appInfo.lastAccessTime = std::chrono::system_clock::now();
-        mAppStats.insert({appStatsKey, appInfo});
+        shard.stats.emplace(AppStatsKey{appPackageName, driverVersionCode}, std::move(appInfo));
+        mNumAppStats++;
     } else {
-        mAppStats[appStatsKey].angleInUse =
-                driver == GpuStatsInfo::Driver::ANGLE || driverPackageName == "angle";
-        addLoadingTime(driver, driverLoadingTime, &mAppStats[appStatsKey]);
-        mAppStats[appStatsKey].lastAccessTime = std::chrono::system_clock::now();
+        GpuStatsAppInfo& appInfo = foundApp->second;
+        appInfo.angleInUse = angleInUse;
+        addLoadingTime(driver, driverLoadingTime, &appInfo);
+        appInfo.lastAccessTime = std::chrono::system_clock::now();
     }
 }
 
@@ -186,16 +215,17 @@ void GpuStats::addVulkanEngineName(const std::string& appPackageName,
                                    const char* engineNameCStr) {
     ATRACE_CALL();
 
-    const std::string appStatsKey = appPackageName + std::to_string(driverVersionCode);
     const size_t engineNameLen = std::min(strlen(engineNameCStr),
                                           GpuStatsAppInfo::MAX_VULKAN_ENGINE_NAME_LENGTH);
     const std::string engineName{engineNameCStr, engineNameLen};
 
-    std::lock_guard<std::mutex> lock(mLock);
     registerStatsdCallbacksIfNeeded();
 
-    const auto foundApp = mAppStats.find(appStatsKey);
-    if (foundApp == mAppStats.end()) {
+    AppStatsShard& shard = appStatsShard(appPackageName);
+    std::lock_guard<std::mutex> lock(shard.lock);
+
+    const auto foundApp = shard.stats.find(AppStatsKeyView{appPackageName, driverVersionCode});
+    if (foundApp == shard.stats.end()) {
         return;
     }
 
@@ -213,13 +243,13 @@ void GpuStats::insertTargetStatsArray(const std::string& appPackageName,
                                  const uint64_t* values, const uint32_t valueCount) {
     ATRACE_CALL();
 
-    const std::string appStatsKey = appPackageName + std::to_string(driverVersionCode);
-
-    std::lock_guard<std::mutex> lock(mLock);
     registerStatsdCallbacksIfNeeded();
 
-    const auto foundApp = mAppStats.find(appStatsKey);
-    if (foundApp == mAppStats.end()) {
+    AppStatsShard& shard = appStatsShard(appPackageName);
+    std::lock_guard<std::mutex> lock(shard.lock);
+
+    const auto foundApp = shard.stats.find(AppStatsKeyView{appPackageName, driverVersionCode});
+    if (foundApp == shard.stats.end()) {
         return;
     }
 
@@ -295,12 +325,17 @@ void GpuStats::interceptSystemDriverStatsLocked() {
 }
 
 void GpuStats::registerStatsdCallbacksIfNeeded() {
-    if (!mStatsdRegistered) {
+    if (mStatsdRegistered.load(std::memory_order_acquire)) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mLock);
+    if (!mStatsdRegistered.load(std::memory_order_relaxed)) {
         AStatsManager_setPullAtomCallback(android::util::GPU_STATS_GLOBAL_INFO, nullptr,
                                          GpuStats::pullAtomCallback, this);
         AStatsManager_setPullAtomCallback(android::util::GPU_STATS_APP_INFO, nullptr,
                                          GpuStats::pullAtomCallback, this);
-        mStatsdRegistered = true;
+        mStatsdRegistered.store(true, std::memory_order_release);
     }
 }
 
@@ -328,13 +363,13 @@ void GpuStats::dump(const Vector<String16>& args, std::string* result) {
 
     const bool dumpApp = argsSet.count("--app") != 0;
     if (dumpApp) {
-        dumpAppLocked(result);
+        dumpAppStats(result);
         dumpAll = false;
     }
 
     if (dumpAll) {
         dumpGlobalLocked(result);
-        dumpAppLocked(result);
+        dumpAppStats(result);
     }
 
     if (argsSet.count("--clear")) {
@@ -346,13 +381,13 @@ void GpuStats::dump(const Vector<String16>& args, std::string* result) {
         }
 
         if (dumpApp) {
-            mAppStats.clear();
+            clearAppStats();
             clearAll = false;
         }
 
         if (clearAll) {
             mGlobalStats.clear();
-            mAppStats.clear();
+            clearAppStats();
         }
     }
 }
@@ -366,10 +401,21 @@ void GpuStats::dumpGlobalLocked(std::string* result) {
     }
 }
 
-void GpuStats::dumpAppLocked(std::string* result) {
-    for (const auto& ele : mAppStats) {
-        result->append(ele.second.toString());
-        result->append("\n");
+void GpuStats::dumpAppStats(std::string* result) {
+    for (auto& shard : mAppStatsShards) {
+        std::lock_guard<std::mutex> lock(shard.lock);
+        for (const auto& ele : shard.stats) {
+            result->append(ele.second.toString());
+            result->append("\n");
+        }
+    }
+}
+
+void GpuStats::clearAppStats() {
+    for (auto& shard : mAppStatsShards) {
+        std::lock_guard<std::mutex> lock(shard.lock);
+        mNumAppStats -= shard.stats.size();
+        shard.stats.clear();
     }
 }
 
@@ -405,10 +451,21 @@ static std::string int64VectorToProtoByteString(const std::vector<int64_t>& valu
 AStatsManager_PullAtomCallbackReturn GpuStats::pullAppInfoAtom(AStatsEventList* data) {
     ATRACE_CALL();
 
-    std::lock_guard<std::mutex> lock(mLock);
+    // Take the stats of one shard at a time, so that app launches are not
+    // blocked while the atoms are written.
+    for (auto& shard : mAppStatsShards) {
+        AppStatsMap appStats;
+        {
+            std::lock_guard<std::mutex> lock(shard.lock);
+            appStats.swap(shard.stats);
+            mNumAppStats -= appStats.size();
+        }
 
-    if (data) {
-        for (const auto& ele : mAppStats) {
+        if (!data) {
+            continue;
+        }
+
+        for (const auto& ele : appStats) {
             std::string glDriverBytes = int64VectorToProtoByteString(
                 ele.second.glDriverLoadingTime);
             std::string vkDriverBytes = int64VectorToProtoByteString(
@@ -447,8 +504,6 @@ AStatsManager_PullAtomCallbackReturn GpuStats::pullAppInfoAtom(AStatsEventList*
         }
     }
 
-    mAppStats.clear();
-
     return AStatsManager_PULL_SUCCESS;
 }
 
@@ -22,7 +22,11 @@
 #include <utils/String16.h>
 #include <utils/Vector.h>
 
+#include <array>
+#include <atomic>
 #include <mutex>
+#include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
@@ -57,6 +61,9 @@ public:
     static const size_t MAX_NUM_APP_RECORDS = 100;
     // The number of apps to remove when mAppStats fills up.
     static const size_t APP_RECORD_HEADROOM = 10;
+    // The number of independently locked shards of the app stats, so that
+    // concurrent app launches don't serialize on a single lock.
+    static const size_t NUM_APP_STATS_SHARDS = 8;
 
 private:
     // Friend class for testing.
@@ -67,7 +74,46 @@ private:
                                                                  AStatsEventList* data,
                                                                  void* cookie);
 
-    // Remove old packages from mAppStats.
+    // Key of the app stats. Lookups use AppStatsKeyView, so that they don't
+    // allocate a string per insert.
+    struct AppStatsKey {
+        std::string appPackageName;
+        uint64_t driverVersionCode;
+    };
+    struct AppStatsKeyView {
+        std::string_view appPackageName;
+        uint64_t driverVersionCode;
+    };
+    struct AppStatsKeyHash {
+        using is_transparent = void;
+        size_t operator()(const AppStatsKeyView& key) const;
+        size_t operator()(const AppStatsKey& key) const {
+            return (*this)(AppStatsKeyView{key.appPackageName, key.driverVersionCode});
+        }
+    };
+    struct AppStatsKeyEqual {
+        using is_transparent = void;
+        template <typename L, typename R>
+        bool operator()(const L& l, const R& r) const {
+            return l.driverVersionCode == r.driverVersionCode &&
+                    std::string_view(l.appPackageName) == std::string_view(r.appPackageName);
+        }
+    };
+    using AppStatsMap =
+            std::unordered_map<AppStatsKey, GpuStatsAppInfo, AppStatsKeyHash, AppStatsKeyEqual>;
+
+    // A shard of the app stats. All versions of a package are in the same
+    // shard.
+    struct AppStatsShard {
+        std::mutex lock;
+        AppStatsMap stats;
+    };
+
+    // Returns the shard of the stats of appPackageName.
+    AppStatsShard& appStatsShard(std::string_view appPackageName);
+
+    // Remove old packages from the app stats, if they are still full.
+    // Takes every shard lock, so it must be called without holding any.
     void purgeOldDriverStats();
 
     // Pull global into into global atom.
@@ -77,20 +123,25 @@ private:
     // Dump global stats
     void dumpGlobalLocked(std::string* result);
     // Dump app stats
-    void dumpAppLocked(std::string* result);
+    void dumpAppStats(std::string* result);
+    // Clear app stats
+    void clearAppStats();
     // Append cpuVulkanVersion and glesVersion to system driver stats
     void interceptSystemDriverStatsLocked();
     // Registers statsd callbacks if they have not already been registered
     void registerStatsdCallbacksIfNeeded();
 
-    // GpuStats access should be guarded by mLock.
+    // Guards mGlobalStats and the registration of statsd callbacks. App stats
+    // are guarded by the lock of their shard.
     std::mutex mLock;
     // True if statsd callbacks have been registered.
-    bool mStatsdRegistered = false;
+    std::atomic<bool> mStatsdRegistered = false;
     // Key is driver version code.
     std::unordered_map<uint64_t, GpuStatsGlobalInfo> mGlobalStats;
-    // Key is <app package name>+<driver version code>.
-    std::unordered_map<std::string, GpuStatsAppInfo> mAppStats;
+    // App stats, sharded by the hash of the app package name.
+    std::array<AppStatsShard, NUM_APP_STATS_SHARDS> mAppStatsShards;
+    // The number of app stats across all shards.
+    std::atomic<size_t> mNumAppStats = 0;
 };
 
 } // namespace android
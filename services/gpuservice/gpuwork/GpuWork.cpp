@@ -32,14 +32,14 @@
 #include <utils/Timers.h>
 #include <utils/Trace.h>
 
+#include <algorithm>
+#include <array>
 #include <bit>
 #include <chrono>
 #include <cstdint>
 #include <limits>
 #include <map>
 #include <mutex>
-#include <unordered_map>
-#include <unordered_set>
 #include <vector>
 
 #include "gpuwork/gpuWork.h"
@@ -55,14 +55,30 @@ bool lessThanGpuIdUid(const android::gpuwork::GpuIdUid& l, const android::gpuwor
     return std::tie(l.gpu_id, l.uid) < std::tie(r.gpu_id, r.uid);
 }
 
-size_t hashGpuIdUid(const android::gpuwork::GpuIdUid& gpuIdUid) {
-    return static_cast<size_t>((gpuIdUid.gpu_id << 5U) + gpuIdUid.uid);
+bool lessThanUidGpuId(const android::gpuwork::GpuIdUid& l, const android::gpuwork::GpuIdUid& r) {
+    return std::tie(l.uid, l.gpu_id) < std::tie(r.uid, r.gpu_id);
 }
 
 bool equalGpuIdUid(const android::gpuwork::GpuIdUid& l, const android::gpuwork::GpuIdUid& r) {
     return std::tie(l.gpu_id, l.uid) == std::tie(r.gpu_id, r.uid);
 }
 
+// Deletes every entry of |map|, which the BPF program is not adding to.
+void clearBpfMap(bpf::BpfMap<GpuIdUid, UidTrackingInfo>& map) {
+    // Get the next key before deleting the previous one, as |getNextKey| of a
+    // deleted key restarts from the first key. We also limit the number of
+    // deletions we try, just in case.
+    base::Result<GpuIdUid> key = map.getFirstKey();
+    for (size_t i = 0; i < kMaxTrackedGpuIdUids; ++i) {
+        if (!key.ok()) {
+            break;
+        }
+        base::Result<GpuIdUid> previousKey = key;
+        key = map.getNextKey(previousKey.value());
+        map.deleteValue(previousKey.value());
+    }
+}
+
 // Gets a BPF map from |mapPath|.
 template <class Key, class Value>
 bool getBpfMap(const char* mapPath, bpf::BpfMap<Key, Value>* out) {
@@ -131,7 +147,11 @@ void GpuWork::initialize() {
     {
         std::lock_guard<std::mutex> lock(mMutex);
 
-        if (!getBpfMap("/sys/fs/bpf/map_gpuWork_gpu_work_map", &mGpuWorkMap)) {
+        if (!getBpfMap("/sys/fs/bpf/map_gpuWork_gpu_work_map", &mGpuWorkMaps[0])) {
+            return;
+        }
+
+        if (!getBpfMap("/sys/fs/bpf/map_gpuWork_gpu_work_map_1", &mGpuWorkMaps[1])) {
             return;
         }
 
@@ -139,6 +159,15 @@ void GpuWork::initialize() {
             return;
         }
 
+        // The maps outlive gpuservice, so pick up the active map from a
+        // previous instance, and clear the standby map in case that instance
+        // stopped while draining it.
+        base::Result<GlobalData> globalData = mGpuWorkGlobalDataMap.readValue(0);
+        if (globalData.ok()) {
+            mActiveMap = globalData.value().active_map % kNumGpuWorkMaps;
+        }
+        clearBpfMap(mGpuWorkMaps[(mActiveMap + 1) % kNumGpuWorkMaps]);
+
         mPreviousMapClearTimePoint = std::chrono::steady_clock::now();
     }
 
@@ -177,7 +206,8 @@ void GpuWork::dump(const Vector<String16>& /* args */, std::string* result) {
     {
         std::lock_guard<std::mutex> lock(mMutex);
 
-        if (!mGpuWorkMap.isValid()) {
+        const auto& gpuWorkMap = mGpuWorkMaps[mActiveMap];
+        if (!gpuWorkMap.isValid()) {
             result->append("GPU work map is not available.\n");
             return;
         }
@@ -194,7 +224,7 @@ void GpuWork::dump(const Vector<String16>& /* args */, std::string* result) {
         // thus the returned value is not being concurrently accessed by the BPF
         // program (no atomic reads needed below).
 
-        mGpuWorkMap.iterateWithValue(
+        gpuWorkMap.iterateWithValue(
                 [&dumpMap](const GpuIdUid& key, const UidTrackingInfo& value,
                            const android::bpf::BpfMap<GpuIdUid, UidTrackingInfo>&)
                         -> base::Result<void> {
@@ -274,60 +304,64 @@ AStatsManager_PullAtomCallbackReturn GpuWork::pullWorkAtoms(AStatsEventList* dat
         return AStatsManager_PULL_SKIP;
     }
 
-    std::lock_guard<std::mutex> lock(mMutex);
+    // The entries of the map drained by this pull. A map holds at most
+    // |kMaxTrackedGpuIdUids| entries, so this is bounded.
+    std::vector<WorkEntry> entries;
+    entries.reserve(kMaxTrackedGpuIdUids);
+    int32_t duration;
+    {
+        // Only hold the lock while swapping the maps, which also drains the
+        // previously active map; the BPF program keeps adding to the other map
+        // meanwhile, so no periods are lost.
+        std::lock_guard<std::mutex> lock(mMutex);
 
-    if (!mGpuWorkMap.isValid()) {
-        return AStatsManager_PULL_SKIP;
+        auto now = std::chrono::steady_clock::now();
+        duration = static_cast<int32_t>(
+                std::chrono::duration_cast<std::chrono::seconds>(now - mPreviousMapClearTimePoint)
+                        .count());
+        if (!swapMaps(&entries)) {
+            return AStatsManager_PULL_SKIP;
+        }
     }
 
-    std::unordered_map<GpuIdUid, UidTrackingInfo, decltype(hashGpuIdUid)*, decltype(equalGpuIdUid)*>
-            workMap(32, &hashGpuIdUid, &equalGpuIdUid);
-
-    // Iteration of BPF hash maps can be unreliable (no data races, but elements
-    // may be repeated), as the map is typically being modified by other
-    // threads. The buckets are all preallocated. Our eBPF program only updates
-    // entries (in-place) or adds entries. |GpuWork| only iterates or clears the
-    // map while holding |mMutex|. Given this, we should be able to iterate over
-    // all elements reliably. Nevertheless, we copy into a map to avoid
-    // duplicates.
-
-    // Note that userspace reads of BPF maps make a copy of the value, and thus
-    // the returned value is not being concurrently accessed by the BPF program
-    // (no atomic reads needed below).
+    if (duration < 0) {
+        // This is essentially impossible. If it does somehow happen, give up;
+        // the map has still been cleared.
+        return AStatsManager_PULL_SKIP;
+    }
 
-    mGpuWorkMap.iterateWithValue([&workMap](const GpuIdUid& key, const UidTrackingInfo& value,
-                                            const android::bpf::BpfMap<GpuIdUid, UidTrackingInfo>&)
-                                         -> base::Result<void> {
-        workMap[key] = value;
-        return {};
-    });
+    // Sort the entries by UID so that the entries of a UID are adjacent. The
+    // drained map was not being modified while it was iterated, but iteration
+    // of BPF hash maps may still repeat elements, so we also remove duplicates.
+    std::sort(entries.begin(), entries.end(),
+              [](const WorkEntry& l, const WorkEntry& r) {
+                  return lessThanUidGpuId(l.first, r.first);
+              });
+    entries.erase(std::unique(entries.begin(), entries.end(),
+                              [](const WorkEntry& l, const WorkEntry& r) {
+                                  return equalGpuIdUid(l.first, r.first);
+                              }),
+                  entries.end());
 
-    // Get a list of just the UIDs; the order does not matter.
-    std::vector<Uid> uids;
     // Get a list of the GPU IDs, in order.
-    std::set<uint32_t> gpuIds;
-    {
-        // To avoid adding duplicate UIDs.
-        std::unordered_set<Uid> addedUids;
-
-        for (const auto& workInfo : workMap) {
-            if (addedUids.insert(workInfo.first.uid).second) {
-                // Insertion was successful.
-                uids.push_back(workInfo.first.uid);
-            }
-            gpuIds.insert(workInfo.first.gpu_id);
+    std::vector<uint32_t> gpuIds;
+    for (const auto& entry : entries) {
+        auto it = std::lower_bound(gpuIds.begin(), gpuIds.end(), entry.first.gpu_id);
+        if (it != gpuIds.end() && *it == entry.first.gpu_id) {
+            continue;
         }
+        if (gpuIds.size() == kNumGpusHardLimit) {
+            // If we observe a very high number of GPUs then something has
+            // probably gone wrong, so don't log any atoms.
+            ALOGI("pullWorkAtoms: gpuIds.size() > %zu", kNumGpusHardLimit);
+            return AStatsManager_PULL_SKIP;
+        }
+        gpuIds.insert(it, entry.first.gpu_id);
     }
 
-    ALOGI("pullWorkAtoms: uids.size() == %zu", uids.size());
+    ALOGI("pullWorkAtoms: entries.size() == %zu", entries.size());
     ALOGI("pullWorkAtoms: gpuIds.size() == %zu", gpuIds.size());
 
-    if (gpuIds.size() > kNumGpusHardLimit) {
-        // If we observe a very high number of GPUs then something has probably
-        // gone wrong, so don't log any atoms.
-        return AStatsManager_PULL_SKIP;
-    }
-
     size_t numSampledUids = kNumSampledUids;
 
     if (gpuIds.size() > kNumGpusSoftLimit) {
@@ -335,74 +369,60 @@ AStatsManager_PullAtomCallbackReturn GpuWork::pullWorkAtoms(AStatsEventList* dat
         numSampledUids = 1;
     }
 
-    // Remove all UIDs that do not have at least |kMinGpuTimeNanoseconds| on at
-    // least one GPU.
-    {
-        auto uidIt = uids.begin();
-        while (uidIt != uids.end()) {
-            bool hasEnoughGpuTime = false;
-            for (uint32_t gpuId : gpuIds) {
-                auto infoIt = workMap.find(GpuIdUid{gpuId, *uidIt});
-                if (infoIt == workMap.end()) {
-                    continue;
-                }
-                if (infoIt->second.total_active_duration_ns +
-                            infoIt->second.total_inactive_duration_ns >=
-                    kMinGpuTimeNanoseconds) {
-                    hasEnoughGpuTime = true;
-                    break;
-                }
-            }
-            if (hasEnoughGpuTime) {
-                ++uidIt;
-            } else {
-                uidIt = uids.erase(uidIt);
-            }
-        }
-    }
-
-    ALOGI("pullWorkAtoms: after removing uids with very low GPU time: uids.size() == %zu",
-          uids.size());
-
     std::random_device device;
     std::default_random_engine random_engine(device());
 
-    // If we have more than |numSampledUids| UIDs, choose |numSampledUids|
-    // random UIDs. We swap them to the front of the list. Given the list
-    // indices 0..i..n-1, we have the following inclusive-inclusive ranges:
-    // - [0, i-1] == the randomly chosen elements.
-    // - [i, n-1] == the remaining unchosen elements.
-    if (uids.size() > numSampledUids) {
-        for (size_t i = 0; i < numSampledUids; ++i) {
-            std::uniform_int_distribution<size_t> uniform_dist(i, uids.size() - 1);
-            size_t random_index = uniform_dist(random_engine);
-            std::swap(uids[i], uids[random_index]);
+    // Choose |numSampledUids| random UIDs among those that have at least
+    // |kMinGpuTimeNanoseconds| on at least one GPU, in a single pass over the
+    // entries using reservoir sampling. Each sample is the range [first, second)
+    // of the entries of a UID.
+    std::array<std::pair<size_t, size_t>, kNumSampledUids> samples;
+    size_t numEligibleUids = 0;
+    for (size_t begin = 0; begin < entries.size();) {
+        const Uid uid = entries[begin].first.uid;
+        bool hasEnoughGpuTime = false;
+        size_t end = begin;
+        for (; end < entries.size() && entries[end].first.uid == uid; ++end) {
+            const UidTrackingInfo& info = entries[end].second;
+            if (info.total_active_duration_ns + info.total_inactive_duration_ns >=
+                kMinGpuTimeNanoseconds) {
+                hasEnoughGpuTime = true;
+            }
         }
-        // Only keep the front |numSampledUids| elements.
-        uids.resize(numSampledUids);
-    }
 
-    ALOGI("pullWorkAtoms: after random selection: uids.size() == %zu", uids.size());
-
-    auto now = std::chrono::steady_clock::now();
-    int32_t duration =
-            static_cast<int32_t>(
-                std::chrono::duration_cast<std::chrono::seconds>(now - mPreviousMapClearTimePoint)
-                    .count());
-    if (duration < 0) {
-        // This is essentially impossible. If it does somehow happen, give up,
-        // but still clear the map.
-        clearMap();
-        return AStatsManager_PULL_SKIP;
+        if (hasEnoughGpuTime) {
+            if (numEligibleUids < numSampledUids) {
+                samples[numEligibleUids] = {begin, end};
+            } else {
+                // Replace a sample with probability
+                // |numSampledUids| / (|numEligibleUids| + 1).
+                std::uniform_int_distribution<size_t> uniform_dist(0, numEligibleUids);
+                size_t random_index = uniform_dist(random_engine);
+                if (random_index < numSampledUids) {
+                    samples[random_index] = {begin, end};
+                }
+            }
+            ++numEligibleUids;
+        }
+        begin = end;
     }
+    const size_t numSamples = std::min(numEligibleUids, numSampledUids);
+
+    ALOGI("pullWorkAtoms: uids with enough GPU time == %zu; sampled uids == %zu",
+          numEligibleUids, numSamples);
 
     // Log an atom for each (gpu id, uid) pair for which we have data.
     for (uint32_t gpuId : gpuIds) {
-        for (Uid uid : uids) {
-            auto it = workMap.find(GpuIdUid{gpuId, uid});
-            if (it == workMap.end()) {
+        for (size_t i = 0; i < numSamples; ++i) {
+            auto it = std::find_if(entries.begin() + samples[i].first,
+                                   entries.begin() + samples[i].second,
+                                   [gpuId](const WorkEntry& entry) {
+                                       return entry.first.gpu_id == gpuId;
+                                   });
+            if (it == entries.begin() + samples[i].second) {
                 continue;
             }
+            const Uid uid = it->first.uid;
             const UidTrackingInfo& info = it->second;
 
             int32_t total_active_duration_ms =
@@ -430,7 +450,6 @@ AStatsManager_PullAtomCallbackReturn GpuWork::pullWorkAtoms(AStatsEventList* dat
                                           total_inactive_duration_ms);
         }
     }
-    clearMap();
     return AStatsManager_PULL_SUCCESS;
 }
 
@@ -461,7 +480,7 @@ void GpuWork::periodicallyClearMap() {
 }
 
 void GpuWork::clearMapIfNeeded() {
-    if (!mInitialized.load() || !mGpuWorkMap.isValid() || !mGpuWorkGlobalDataMap.isValid()) {
+    if (!mInitialized.load() || !mGpuWorkGlobalDataMap.isValid()) {
         ALOGW("Map clearing could not occur because we are not initialized properly");
         return;
     }
@@ -483,51 +502,56 @@ void GpuWork::clearMapIfNeeded() {
         return;
     }
 
-    clearMap();
+    swapMaps(nullptr);
 }
 
-void GpuWork::clearMap() {
-    if (!mInitialized.load() || !mGpuWorkMap.isValid() || !mGpuWorkGlobalDataMap.isValid()) {
-        ALOGW("Map clearing could not occur because we are not initialized properly");
-        return;
+bool GpuWork::swapMaps(std::vector<WorkEntry>* entries) {
+    if (!mInitialized.load() || !mGpuWorkMaps[0].isValid() || !mGpuWorkMaps[1].isValid() ||
+        !mGpuWorkGlobalDataMap.isValid()) {
+        ALOGW("Map swapping could not occur because we are not initialized properly");
+        return false;
     }
 
     base::Result<GlobalData> globalData = mGpuWorkGlobalDataMap.readValue(0);
     if (!globalData.ok()) {
         ALOGW("Could not read BPF global data map entry");
-        return;
-    }
-
-    // Iterating BPF maps to delete keys is tricky. If we just repeatedly call
-    // |getFirstKey()| and delete that, we may loop forever (or for a long time)
-    // because our BPF program might be repeatedly re-adding keys. Also, even if
-    // we limit the number of elements we try to delete, we might only delete
-    // new entries, leaving old entries in the map. If we delete a key A and
-    // then call |getNextKey(A)|, the first key in the map is returned, so we
-    // have the same issue.
-    //
-    // Thus, we instead get the next key and then delete the previous key. We
-    // also limit the number of deletions we try, just in case.
-
-    base::Result<GpuIdUid> key = mGpuWorkMap.getFirstKey();
-
-    for (size_t i = 0; i < kMaxTrackedGpuIdUids; ++i) {
-        if (!key.ok()) {
-            break;
-        }
-        base::Result<GpuIdUid> previousKey = key;
-        key = mGpuWorkMap.getNextKey(previousKey.value());
-        mGpuWorkMap.deleteValue(previousKey.value());
+        return false;
     }
 
-    // Reset our counter; |globalData| is a copy of the data, so we have to use
+    // Point the BPF program at the standby map, which is empty, and reset our
+    // counter; |globalData| is a copy of the data, so we have to use
     // |writeValue|.
+    const uint32_t previousActiveMap = mActiveMap;
+    globalData.value().active_map = (previousActiveMap + 1) % kNumGpuWorkMaps;
     globalData.value().num_map_entries = 0;
-    mGpuWorkGlobalDataMap.writeValue(0, globalData.value(), BPF_ANY);
+    if (!mGpuWorkGlobalDataMap.writeValue(0, globalData.value(), BPF_ANY).ok()) {
+        ALOGW("Could not write BPF global data map entry");
+        return false;
+    }
+    mActiveMap = globalData.value().active_map;
 
     // Update |mPreviousMapClearTimePoint| so we know when we started collecting
     // the stats.
     mPreviousMapClearTimePoint = std::chrono::steady_clock::now();
+
+    // The BPF program no longer adds to the previously active map, except for
+    // runs which were already in progress during the swap, so it can be
+    // iterated and cleared reliably.
+    auto& previousMap = mGpuWorkMaps[previousActiveMap];
+    if (entries) {
+        // Note that userspace reads of BPF maps make a copy of the value, and
+        // thus the returned value is not being concurrently accessed by the BPF
+        // program.
+        previousMap.iterateWithValue(
+                [entries](const GpuIdUid& key, const UidTrackingInfo& value,
+                          const android::bpf::BpfMap<GpuIdUid, UidTrackingInfo>&)
+                        -> base::Result<void> {
+                    entries->emplace_back(key, value);
+                    return {};
+                });
+    }
+    clearBpfMap(previousMap);
+    return true;
 }
 
 void GpuWork::waitForPermissions() {
@@ -29,9 +29,13 @@
 #define S_IN_NS (1000000000)
 #define SMALL_TIME_GAP_LIMIT_NS (S_IN_NS)
 
-// A map from GpuIdUid (GPU ID and application UID) to |UidTrackingInfo|.
+// Two maps from GpuIdUid (GPU ID and application UID) to |UidTrackingInfo|.
+// The program only adds to the map selected by |GlobalData::active_map|, so
+// that userspace can drain and clear the other map without losing periods.
 DEFINE_BPF_MAP_GRW(gpu_work_map, HASH, GpuIdUid, UidTrackingInfo, kMaxTrackedGpuIdUids,
                    AID_GRAPHICS);
+DEFINE_BPF_MAP_GRW(gpu_work_map_1, HASH, GpuIdUid, UidTrackingInfo, kMaxTrackedGpuIdUids,
+                   AID_GRAPHICS);
 
 // A map containing a single entry of |GlobalData|.
 DEFINE_BPF_MAP_GRW(gpu_work_global_data, ARRAY, uint32_t, GlobalData, 1, AID_GRAPHICS);
@@ -178,6 +182,17 @@ _Static_assert(offsetof(GpuWorkPeriodEvent, gpu_id) == 8 &&
                "must match the tracepoint field offsets found via adb shell cat "
                "/sys/kernel/tracing/events/power/gpu_work_period/format");
 
+static inline __always_inline UidTrackingInfo* lookup_uid_tracking_info(uint32_t active_map,
+                                                                        GpuIdUid* key) {
+    return active_map ? bpf_gpu_work_map_1_lookup_elem(key) : bpf_gpu_work_map_lookup_elem(key);
+}
+
+static inline __always_inline int add_uid_tracking_info(uint32_t active_map, GpuIdUid* key,
+                                                        UidTrackingInfo* value) {
+    return active_map ? bpf_gpu_work_map_1_update_elem(key, value, BPF_NOEXIST)
+                      : bpf_gpu_work_map_update_elem(key, value, BPF_NOEXIST);
+}
+
 DEFINE_BPF_PROG("tracepoint/power/gpu_work_period", AID_ROOT, AID_GRAPHICS, tp_gpu_work_period)
 (GpuWorkPeriodEvent* const period) {
     // Note: In eBPF programs, |__sync_fetch_and_add| is translated to an atomic
@@ -191,25 +206,28 @@ DEFINE_BPF_PROG("tracepoint/power/gpu_work_period", AID_ROOT, AID_GRAPHICS, tp_g
     gpu_id_and_uid.gpu_id = period->gpu_id;
     gpu_id_and_uid.uid = period->uid;
 
+    // Get the |GlobalData|.
+    const uint32_t zero = 0;
+    GlobalData* global_data = bpf_gpu_work_global_data_lookup_elem(&zero);
+    // Getting the global data never fails because it is an |ARRAY| map, but we
+    // need to keep the verifier happy.
+    if (!global_data) {
+        return ALLOW;
+    }
+    const uint32_t active_map = global_data->active_map;
+
     // Get |UidTrackingInfo|.
-    UidTrackingInfo* uid_tracking_info = bpf_gpu_work_map_lookup_elem(&gpu_id_and_uid);
+    UidTrackingInfo* uid_tracking_info = lookup_uid_tracking_info(active_map, &gpu_id_and_uid);
     if (!uid_tracking_info) {
         // There was no existing entry, so we add a new one.
         UidTrackingInfo initial_info;
         __builtin_memset(&initial_info, 0, sizeof(initial_info));
-        if (0 == bpf_gpu_work_map_update_elem(&gpu_id_and_uid, &initial_info, BPF_NOEXIST)) {
+        if (0 == add_uid_tracking_info(active_map, &gpu_id_and_uid, &initial_info)) {
             // We added an entry to the map, so we increment our entry counter in
             // |GlobalData|.
-            const uint32_t zero = 0;
-            // Get the |GlobalData|.
-            GlobalData* global_data = bpf_gpu_work_global_data_lookup_elem(&zero);
-            // Getting the global data never fails because it is an |ARRAY| map,
-            // but we need to keep the verifier happy.
-            if (global_data) {
-                __sync_fetch_and_add(&global_data->num_map_entries, 1);
-            }
+            __sync_fetch_and_add(&global_data->num_map_entries, 1);
         }
-        uid_tracking_info = bpf_gpu_work_map_lookup_elem(&gpu_id_and_uid);
+        uid_tracking_info = lookup_uid_tracking_info(active_map, &gpu_id_and_uid);
         if (!uid_tracking_info) {
             // This should never happen, unless entries are getting deleted at
             // this moment. If so, we just give up.
@@ -54,15 +54,25 @@ typedef struct {
 } UidTrackingInfo;
 
 typedef struct {
-    // We cannot query the number of entries in BPF map |gpu_work_map|. We track
-    // the number of entries (approximately) using a counter so we can check if
-    // the map is nearly full.
+    // We cannot query the number of entries in the active BPF map. We track the
+    // number of entries (approximately) using a counter so we can check if the
+    // map is nearly full.
     uint64_t num_map_entries;
+
+    // Which of |gpu_work_map| (0) and |gpu_work_map_1| (1) the BPF program adds
+    // to. Only written by userspace.
+    uint32_t active_map;
+
+    // Needed to make 32-bit arch struct size match 64-bit BPF arch struct size.
+    uint32_t padding0;
 } GlobalData;
 
-// The maximum number of tracked GPU ID and UID pairs (|GpuIdUid|).
+// The maximum number of tracked GPU ID and UID pairs (|GpuIdUid|) per map.
 static const uint32_t kMaxTrackedGpuIdUids = 512;
 
+// The number of GPU work maps, which are swapped rather than cleared in place.
+static const uint32_t kNumGpuWorkMaps = 2;
+
 #ifdef __cplusplus
 } // namespace gpuwork
 } // namespace android
@@ -22,10 +22,13 @@
 #include <utils/String16.h>
 #include <utils/Vector.h>
 
+#include <array>
 #include <condition_variable>
 #include <cstdint>
 #include <functional>
 #include <thread>
+#include <utility>
+#include <vector>
 
 #include "gpuwork/gpuWork.h"
 
@@ -46,6 +49,8 @@ public:
     void dump(const Vector<String16>& args, std::string* result);
 
 private:
+    using WorkEntry = std::pair<GpuIdUid, UidTrackingInfo>;
+
     // Attaches tracepoint |tracepoint_group|/|tracepoint_name| to BPF program at path
     // |program_path|. The tracepoint is also enabled.
     bool attachTracepoint(const char* program_path, const char* tracepoint_group,
@@ -58,7 +63,7 @@ private:
 
     AStatsManager_PullAtomCallbackReturn pullWorkAtoms(AStatsEventList* data);
 
-    // Periodically calls |clearMapIfNeeded| to clear the |mGpuWorkMap| map, if
+    // Periodically calls |clearMapIfNeeded| to clear the active map, if
     // needed.
     //
     // Thread safety analysis is skipped because we need to use
@@ -66,12 +71,15 @@ private:
     // analysis.
     void periodicallyClearMap() NO_THREAD_SAFETY_ANALYSIS;
 
-    // Checks whether the |mGpuWorkMap| map is nearly full and, if so, clears
-    // it.
+    // Checks whether the active map is nearly full and, if so, swaps it out
+    // and discards its entries.
     void clearMapIfNeeded() REQUIRES(mMutex);
 
-    // Clears the |mGpuWorkMap| map.
-    void clearMap() REQUIRES(mMutex);
+    // Makes the standby map active, so that the BPF program starts a new
+    // collection period in an empty map, then appends the entries of the
+    // previously active map to |entries| (if not null) and clears it. Returns
+    // false if the maps could not be swapped.
+    bool swapMaps(std::vector<WorkEntry>* entries) REQUIRES(mMutex);
 
     // Waits for required permissions to become set. This seems to be needed
     // because platform service permissions might not be set when a service
@@ -84,15 +92,20 @@ private:
     // Indicates whether eBPF initialization should be stopped.
     std::atomic<bool> mStop = false;
 
-    // A thread that periodically checks whether |mGpuWorkMap| is nearly full
+    // A thread that periodically checks whether the active map is nearly full
     // and, if so, clears it.
     std::thread mMapClearerThread;
 
-    // Mutex for |mGpuWorkMap| and a few other fields.
+    // Mutex for |mGpuWorkMaps| and a few other fields.
     std::mutex mMutex;
 
-    // BPF map for per-UID GPU work.
-    bpf::BpfMap<GpuIdUid, UidTrackingInfo> mGpuWorkMap GUARDED_BY(mMutex);
+    // BPF maps for per-UID GPU work. The BPF program adds to the active one.
+    std::array<bpf::BpfMap<GpuIdUid, UidTrackingInfo>, kNumGpuWorkMaps> mGpuWorkMaps
+            GUARDED_BY(mMutex);
+
+    // The index of the active map in |mGpuWorkMaps|, as also stored in
+    // |GlobalData::active_map|.
+    uint32_t mActiveMap GUARDED_BY(mMutex) = 0;
 
     // BPF map containing a single element for global data.
     bpf::BpfMap<uint32_t, GlobalData> mGpuWorkGlobalDataMap GUARDED_BY(mMutex);
@@ -127,7 +140,7 @@ private:
     // The minimum GPU time needed to actually log stats for a UID.
     static constexpr uint64_t kMinGpuTimeNanoseconds = 10LLU * 1000000000LLU; // 10 seconds.
 
-    // The previous time point at which |mGpuWorkMap| was cleared.
+    // The previous time point at which the maps were swapped.
     std::chrono::steady_clock::time_point mPreviousMapClearTimePoint GUARDED_BY(mMutex);
 
     // Permission to register a statsd puller.
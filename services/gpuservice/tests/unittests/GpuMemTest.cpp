@@ -166,5 +166,65 @@ TEST_F(GpuMemTest, traverseGpuMemTotals) {
     EXPECT_EQ(sCount, TEST_KEY_COUNT);
 }
 
+TEST_F(GpuMemTest, readGpuMemTotals) {
+    ASSERT_RESULT_OK(mTestMap.writeValue(TEST_PROC_KEY_2, TEST_PROC_VAL_2, BPF_ANY));
+    ASSERT_RESULT_OK(mTestMap.writeValue(TEST_PROC_KEY_1, TEST_PROC_VAL_1, BPF_ANY));
+    ASSERT_RESULT_OK(mTestMap.writeValue(TEST_GLOBAL_KEY, TEST_GLOBAL_VAL, BPF_ANY));
+    mTestableGpuMem.setGpuMemTotalMap(mTestMap);
+
+    GpuMemSnapshot snapshot;
+    ASSERT_TRUE(mGpuMem->readGpuMemTotals(&snapshot));
+    EXPECT_GT(snapshot.timestamp, 0);
+    ASSERT_EQ(snapshot.totals.size(), TEST_KEY_COUNT);
+
+    // Sorted by gpu id, then pid.
+    EXPECT_EQ(snapshot.totals[0].gpuId, (uint32_t)(TEST_GLOBAL_KEY >> 32));
+    EXPECT_EQ(snapshot.totals[0].pid, (uint32_t)TEST_GLOBAL_KEY);
+    EXPECT_EQ(snapshot.totals[0].size, TEST_GLOBAL_VAL);
+    EXPECT_EQ(snapshot.totals[1].gpuId, (uint32_t)(TEST_PROC_KEY_1 >> 32));
+    EXPECT_EQ(snapshot.totals[1].pid, (uint32_t)TEST_PROC_KEY_1);
+    EXPECT_EQ(snapshot.totals[1].size, TEST_PROC_VAL_1);
+    EXPECT_EQ(snapshot.totals[2].gpuId, (uint32_t)(TEST_PROC_KEY_2 >> 32));
+    EXPECT_EQ(snapshot.totals[2].pid, (uint32_t)TEST_PROC_KEY_2);
+    EXPECT_EQ(snapshot.totals[2].size, TEST_PROC_VAL_2);
+}
+
+TEST_F(GpuMemTest, readGpuMemTotalsMapEmpty) {
+    mTestableGpuMem.setGpuMemTotalMap(mTestMap);
+
+    GpuMemSnapshot snapshot;
+    ASSERT_TRUE(mGpuMem->readGpuMemTotals(&snapshot));
+    EXPECT_TRUE(snapshot.totals.empty());
+}
+
+TEST_F(GpuMemTest, computeGpuMemDeltas) {
+    GpuMemSnapshot previous;
+    previous.totals = {{0, 0, 100}, {0, 1, 20}, {0, 2, 30}, {1, 2, 40}};
+    GpuMemSnapshot current;
+    current.totals = {{0, 0, 150}, {0, 2, 30}, {0, 3, 5}, {1, 2, 10}, {2, 0, 7}};
+
+    std::vector<GpuMemDelta> deltas;
+    GpuMem::computeGpuMemDeltas(previous, current, &deltas);
+
+    ASSERT_EQ(deltas.size(), 5u);
+    EXPECT_EQ(deltas[0].gpuId, 0u);
+    EXPECT_EQ(deltas[0].pid, 0u);
+    EXPECT_EQ(deltas[0].delta, 50);
+    // The process has exited.
+    EXPECT_EQ(deltas[1].pid, 1u);
+    EXPECT_EQ(deltas[1].delta, -20);
+    // Unchanged totals are skipped.
+    EXPECT_EQ(deltas[2].pid, 3u);
+    EXPECT_EQ(deltas[2].delta, 5);
+    EXPECT_EQ(deltas[3].gpuId, 1u);
+    EXPECT_EQ(deltas[3].pid, 2u);
+    EXPECT_EQ(deltas[3].delta, -30);
+    EXPECT_EQ(deltas[4].gpuId, 2u);
+    EXPECT_EQ(deltas[4].delta, 7);
+
+    GpuMem::computeGpuMemDeltas(current, current, &deltas);
+    EXPECT_TRUE(deltas.empty());
+}
+
 } // namespace
 } // namespace android
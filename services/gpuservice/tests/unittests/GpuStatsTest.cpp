@@ -29,6 +29,9 @@
 #include <utils/String16.h>
 #include <utils/Vector.h>
 
+#include <thread>
+#include <vector>
+
 #include "TestableGpuStats.h"
 
 namespace android {
@@ -462,6 +465,50 @@ TEST_F(GpuStatsTest, canInsertMoreThanMaxNumAppRecords) {
     }
 }
 
+TEST_F(GpuStatsTest, canInsertStatsConcurrently) {
+    constexpr int kNumThreads = 4;
+    constexpr int kNumAppsPerThread = 20;
+    static_assert(kNumThreads * kNumAppsPerThread <= GpuStats::MAX_NUM_APP_RECORDS);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kNumThreads; ++t) {
+        threads.emplace_back([this, t] {
+            for (int i = 0; i < kNumAppsPerThread; ++i) {
+                const std::string pkgName =
+                        "testapp_" + std::to_string(t) + "_" + std::to_string(i);
+                mGpuStats->insertDriverStats(BUILTIN_DRIVER_PKG_NAME, BUILTIN_DRIVER_VER_NAME,
+                                             BUILTIN_DRIVER_VER_CODE, BUILTIN_DRIVER_BUILD_TIME,
+                                             pkgName, VULKAN_VERSION, GpuStatsInfo::Driver::GL,
+                                             true, DRIVER_LOADING_TIME_1);
+                mGpuStats->insertTargetStats(pkgName, BUILTIN_DRIVER_VER_CODE,
+                                             GpuStatsInfo::Stats::CPU_VULKAN_IN_USE, 0);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    const std::string dump = inputCommand(InputCommand::DUMP_GLOBAL);
+    EXPECT_THAT(dump, HasSubstr("glLoadingCount = " +
+                                std::to_string(kNumThreads * kNumAppsPerThread)));
+
+    const std::string appDump = inputCommand(InputCommand::DUMP_APP);
+    for (int t = 0; t < kNumThreads; ++t) {
+        for (int i = 0; i < kNumAppsPerThread; ++i) {
+            // Add a newline to search for the exact package name.
+            EXPECT_THAT(appDump,
+                        HasSubstr("testapp_" + std::to_string(t) + "_" + std::to_string(i) +
+                                  "\n"));
+        }
+    }
+
+    TestableGpuStats testableGpuStats(mGpuStats.get());
+    EXPECT_TRUE(testableGpuStats.makePullAtomCallback(android::util::GPU_STATS_APP_INFO) ==
+                AStatsManager_PULL_SUCCESS);
+    EXPECT_TRUE(inputCommand(InputCommand::DUMP_APP).empty());
+}
+
 TEST_F(GpuStatsTest, canDumpAllBeforeClearAll) {
     mGpuStats->insertDriverStats(BUILTIN_DRIVER_PKG_NAME, BUILTIN_DRIVER_VER_NAME,
                                  BUILTIN_DRIVER_VER_CODE, BUILTIN_DRIVER_BUILD_TIME, APP_PKG_NAME_1,
@@ -121,7 +121,8 @@ InputDeviceMetricsCollector::InputDeviceMetricsCollector(InputListenerInterface&
       : mNextListener(listener),
         mLogger(logger),
         mUsageSessionTimeout(usageSessionTimeout),
-        mInteractionsQueue(INTERACTIONS_QUEUE_CAPACITY) {}
+        mInteractionsQueue(INTERACTIONS_QUEUE_CAPACITY),
+        mNextExpiryCheckTime(nanoseconds::max()) {}
 
 void InputDeviceMetricsCollector::notifyInputDevicesChanged(
         const NotifyInputDevicesChangedArgs& args) {
@@ -202,7 +203,6 @@ void InputDeviceMetricsCollector::notifyDeviceInteraction(int32_t deviceId, nsec
     if (isIgnoredInputDeviceId(deviceId)) {
         return;
     }
-    std::scoped_lock lock(mLock);
     mInteractionsQueue.push(DeviceId{deviceId}, timestamp, uids);
 }
 
@@ -277,6 +277,7 @@ void InputDeviceMetricsCollector::onInputDeviceUsage(DeviceId deviceId, nanoseco
     for (InputDeviceUsageSource source : getSources(infoIt->second)) {
         sessionIt->second.recordUsage(eventTime, source);
     }
+    mNextExpiryCheckTime = std::min(mNextExpiryCheckTime, eventTime + mUsageSessionTimeout);
 }
 
 void InputDeviceMetricsCollector::onInputDeviceInteraction(const Interaction& interaction) {
@@ -286,6 +287,8 @@ void InputDeviceMetricsCollector::onInputDeviceInteraction(const Interaction& in
     }
 
     activeSessionIt->second.recordInteraction(interaction);
+    mNextExpiryCheckTime = std::min(mNextExpiryCheckTime,
+                                    std::get<nanoseconds>(interaction) + mUsageSessionTimeout);
 }
 
 void InputDeviceMetricsCollector::reportCompletedSessions() {
@@ -296,12 +299,20 @@ void InputDeviceMetricsCollector::reportCompletedSessions() {
     }
 
     const auto currentTime = mLogger.getCurrentTime();
+    if (currentTime < mNextExpiryCheckTime) {
+        // Nothing can have expired yet.
+        return;
+    }
     std::vector<DeviceId> completedUsageSessions;
 
     // Process usages for all active session to determine if any sessions have expired.
+    mNextExpiryCheckTime = nanoseconds::max();
     for (auto& [deviceId, activeSession] : mActiveUsageSessions) {
         if (activeSession.checkIfCompletedAt(currentTime)) {
             completedUsageSessions.emplace_back(deviceId);
+        } else {
+            mNextExpiryCheckTime =
+                    std::min(mNextExpiryCheckTime, activeSession.getNextExpiryTime());
         }
     }
 
@@ -385,6 +396,18 @@ bool InputDeviceMetricsCollector::ActiveSession::checkIfCompletedAt(nanoseconds
     return mActiveSessionsBySource.empty();
 }
 
+nanoseconds InputDeviceMetricsCollector::ActiveSession::getNextExpiryTime() const {
+    nanoseconds lastUsageTime = nanoseconds::max();
+    for (const auto& [_, session] : mActiveSessionsBySource) {
+        lastUsageTime = std::min(lastUsageTime, session.end);
+    }
+    for (const auto& [_, session] : mActiveSessionsByUid) {
+        lastUsageTime = std::min(lastUsageTime, session.end);
+    }
+    return lastUsageTime == nanoseconds::max() ? lastUsageTime
+                                               : lastUsageTime + mUsageSessionTimeout;
+}
+
 InputDeviceMetricsLogger::DeviceUsageReport
 InputDeviceMetricsCollector::ActiveSession::finishSession() {
     const auto deviceUsageDuration = mDeviceSession.end - mDeviceSession.start;
@@ -142,7 +142,8 @@ private:
     std::map<DeviceId, MetricsDeviceInfo> mLoggedDeviceInfos GUARDED_BY(mLock);
 
     using Interaction = std::tuple<DeviceId, std::chrono::nanoseconds, std::set<Uid>>;
-    SyncQueue<Interaction> mInteractionsQueue GUARDED_BY(mLock);
+    // Synchronizes itself, so that the dispatcher never waits for mLock to report interactions.
+    SyncQueue<Interaction> mInteractionsQueue;
 
     class ActiveSession {
     public:
@@ -151,6 +152,8 @@ private:
         void recordUsage(std::chrono::nanoseconds eventTime, InputDeviceUsageSource source);
         void recordInteraction(const Interaction&);
         bool checkIfCompletedAt(std::chrono::nanoseconds timestamp);
+        // The earliest time at which checkIfCompletedAt can complete a source or uid session.
+        std::chrono::nanoseconds getNextExpiryTime() const;
         InputDeviceMetricsLogger::DeviceUsageReport finishSession();
 
     private:
@@ -171,6 +174,8 @@ private:
 
     // The input devices that currently have active usage sessions.
     std::map<DeviceId, ActiveSession> mActiveUsageSessions GUARDED_BY(mLock);
+    // No active session can expire before this time, so that most events don't need to check them.
+    std::chrono::nanoseconds mNextExpiryCheckTime GUARDED_BY(mLock);
 
     void onInputDevicesChanged(const std::vector<InputDeviceInfo>& infos) REQUIRES(mLock);
     void onInputDeviceRemoved(DeviceId deviceId, const MetricsDeviceInfo& info) REQUIRES(mLock);
@@ -33,6 +33,11 @@ namespace android {
 
 namespace {
 
+// Mouse and touchpad events can arrive at 1 kHz, while the pointer is only drawn once per display
+// frame. Once the mouse pointer was unfaded by an event, it isn't unfaded again by the events that
+// follow within this interval, unless PointerChoreographer faded it in the meantime.
+constexpr nsecs_t MOUSE_UNFADE_INTERVAL = ms2ns(16);
+
 bool isFromMouse(const NotifyMotionArgs& args) {
     return isFromSource(args.source, AINPUT_SOURCE_MOUSE) &&
             args.pointerProperties[0].toolType == ToolType::MOUSE;
@@ -200,6 +205,7 @@ void PointerChoreographer::fadeMouseCursorOnKeyPress(const android::NotifyKeyArg
     if (it != mMousePointersByDisplay.end()) {
         mPolicy.notifyMouseCursorFadedOnTyping();
         it->second->fade(PointerControllerInterface::Transition::GRADUAL);
+        mLastMouseUnfadeTimes.erase(targetDisplay);
     }
 }
 
@@ -251,9 +257,7 @@ NotifyMotionArgs PointerChoreographer::processMouseEventLocked(const NotifyMotio
         newArgs.xCursorPosition = x;
         newArgs.yCursorPosition = y;
     }
-    if (canUnfadeOnDisplay(displayId)) {
-        pc.unfade(PointerControllerInterface::Transition::IMMEDIATE);
-    }
+    unfadeMousePointerLocked(displayId, pc, args.eventTime);
     return newArgs;
 }
 
@@ -268,9 +272,7 @@ NotifyMotionArgs PointerChoreographer::processTouchpadEventLocked(const NotifyMo
         const float deltaX = args.pointerCoords[0].getAxisValue(AMOTION_EVENT_AXIS_RELATIVE_X);
         const float deltaY = args.pointerCoords[0].getAxisValue(AMOTION_EVENT_AXIS_RELATIVE_Y);
         pc.move(deltaX, deltaY);
-        if (canUnfadeOnDisplay(displayId)) {
-            pc.unfade(PointerControllerInterface::Transition::IMMEDIATE);
-        }
+        unfadeMousePointerLocked(displayId, pc, args.eventTime);
 
         const auto [x, y] = pc.getPosition();
         newArgs.pointerCoords[0].setAxisValue(AMOTION_EVENT_AXIS_X, x);
@@ -279,9 +281,7 @@ NotifyMotionArgs PointerChoreographer::processTouchpadEventLocked(const NotifyMo
         newArgs.yCursorPosition = y;
     } else {
         // This is a trackpad gesture with fake finger(s) that should not move the mouse pointer.
-        if (canUnfadeOnDisplay(displayId)) {
-            pc.unfade(PointerControllerInterface::Transition::IMMEDIATE);
-        }
+        unfadeMousePointerLocked(displayId, pc, args.eventTime);
 
         const auto [x, y] = pc.getPosition();
         for (uint32_t i = 0; i < newArgs.getPointerCount(); i++) {
@@ -498,6 +498,7 @@ void PointerChoreographer::notifyPointerCaptureChanged(
         for (const auto& [_, mousePointerController] : mMousePointersByDisplay) {
             mousePointerController->fade(PointerControllerInterface::Transition::IMMEDIATE);
         }
+        mLastMouseUnfadeTimes.clear();
     }
     mNextListener.notify(args);
 }
@@ -563,6 +564,7 @@ PointerChoreographer::ensureMouseControllerLocked(ui::LogicalDisplayId associate
     if (it == mMousePointersByDisplay.end()) {
         it = mMousePointersByDisplay.emplace(displayId, getMouseControllerConstructor(displayId))
                      .first;
+        mLastMouseUnfadeTimes.erase(displayId);
         onControllerAddedOrRemovedLocked();
     }
 
@@ -579,6 +581,22 @@ bool PointerChoreographer::canUnfadeOnDisplay(ui::LogicalDisplayId displayId) {
     return mDisplaysWithPointersHidden.find(displayId) == mDisplaysWithPointersHidden.end();
 }
 
+void PointerChoreographer::unfadeMousePointerLocked(ui::LogicalDisplayId displayId,
+                                                    PointerControllerInterface& pc,
+                                                    nsecs_t eventTime) {
+    if (!canUnfadeOnDisplay(displayId)) {
+        return;
+    }
+    auto [it, inserted] = mLastMouseUnfadeTimes.try_emplace(displayId, eventTime);
+    if (!inserted) {
+        if (eventTime >= it->second && eventTime - it->second < MOUSE_UNFADE_INTERVAL) {
+            return;
+        }
+        it->second = eventTime;
+    }
+    pc.unfade(PointerControllerInterface::Transition::IMMEDIATE);
+}
+
 PointerChoreographer::PointerDisplayChange PointerChoreographer::updatePointerControllersLocked() {
     std::set<ui::LogicalDisplayId /*displayId*/> mouseDisplaysToKeep;
     std::set<DeviceId> touchDevicesToKeep;
@@ -606,6 +624,7 @@ PointerChoreographer::PointerDisplayChange PointerChoreographer::updatePointerCo
                     mMousePointersByDisplay.try_emplace(displayId,
                                                         getMouseControllerConstructor(displayId));
             if (isNewMousePointer) {
+                mLastMouseUnfadeTimes.erase(displayId);
                 onControllerAddedOrRemovedLocked();
             }
 
@@ -834,6 +853,7 @@ void PointerChoreographer::setPointerIconVisibility(ui::LogicalDisplayId display
     if (auto it = mMousePointersByDisplay.find(displayId); it != mMousePointersByDisplay.end()) {
         const auto& [_, controller] = *it;
         controller->fade(PointerControllerInterface::Transition::IMMEDIATE);
+        mLastMouseUnfadeTimes.erase(displayId);
     }
     for (const auto& [_, controller] : mStylusPointersByDevice) {
         if (controller->getDisplayId() == displayId) {
@@ -128,6 +128,8 @@ private:
     ensureMouseControllerLocked(ui::LogicalDisplayId associatedDisplayId) REQUIRES(mLock);
     InputDeviceInfo* findInputDeviceLocked(DeviceId deviceId) REQUIRES(mLock);
     bool canUnfadeOnDisplay(ui::LogicalDisplayId displayId) REQUIRES(mLock);
+    void unfadeMousePointerLocked(ui::LogicalDisplayId displayId, PointerControllerInterface& pc,
+                                  nsecs_t eventTime) REQUIRES(mLock);
 
     void fadeMouseCursorOnKeyPress(const NotifyKeyArgs& args);
     NotifyMotionArgs processMotion(const NotifyMotionArgs& args);
@@ -194,6 +196,9 @@ private:
     ui::LogicalDisplayId mNotifiedPointerDisplayId GUARDED_BY(mLock);
     std::vector<InputDeviceInfo> mInputDeviceInfos GUARDED_BY(mLock);
     std::set<DeviceId> mMouseDevices GUARDED_BY(mLock);
+    // The time of the latest event that unfaded the mouse pointer of each display, since the
+    // pointer was faded by PointerChoreographer or its controller was added.
+    std::map<ui::LogicalDisplayId, nsecs_t> mLastMouseUnfadeTimes GUARDED_BY(mLock);
     std::vector<DisplayViewport> mViewports GUARDED_BY(mLock);
     bool mShowTouchesEnabled GUARDED_BY(mLock);
     bool mStylusPointerIconEnabled GUARDED_BY(mLock);
@@ -161,8 +161,19 @@ static int32_t resolveActionForPointer(uint8_t pointerIndex, int32_t action) {
     return AMOTION_EVENT_ACTION_MOVE;
 }
 
+static std::string dumpPointerIds(const std::bitset<MAX_POINTER_ID + 1>& pointerIds) {
+    std::string out;
+    for (size_t id = 0; id < pointerIds.size(); id++) {
+        if (pointerIds.test(id)) {
+            out += out.empty() ? "{" : ", ";
+            out += std::to_string(id);
+        }
+    }
+    return out.empty() ? "{}" : (out + "}");
+}
+
 NotifyMotionArgs removePointerIds(const NotifyMotionArgs& args,
-                                  const std::set<int32_t>& pointerIds) {
+                                  const std::bitset<MAX_POINTER_ID + 1>& pointerIds) {
     const uint8_t actionIndex = MotionEvent::getActionIndex(args.action);
     const int32_t actionMasked = MotionEvent::getActionMasked(args.action);
     const bool isPointerUpOrDownAction = actionMasked == AMOTION_EVENT_ACTION_POINTER_DOWN ||
@@ -174,7 +185,7 @@ NotifyMotionArgs removePointerIds(const NotifyMotionArgs& args,
     int32_t newActionIndex = 0;
     for (uint32_t i = 0; i < args.getPointerCount(); i++) {
         const int32_t pointerId = args.pointerProperties[i].id;
-        if (pointerIds.find(pointerId) != pointerIds.end()) {
+        if (pointerIds.test(pointerId)) {
             // skip this pointer
             if (isPointerUpOrDownAction && i == actionIndex) {
                 // The active pointer is being removed, so the action is no longer valid.
@@ -206,19 +217,24 @@ NotifyMotionArgs removePointerIds(const NotifyMotionArgs& args,
     return newArgs;
 }
 
+static std::bitset<MAX_POINTER_ID + 1> getStylusPointerIds(const NotifyMotionArgs& args) {
+    std::bitset<MAX_POINTER_ID + 1> stylusPointerIds;
+    for (uint32_t i = 0; i < args.getPointerCount(); i++) {
+        if (isStylusToolType(args.pointerProperties[i].toolType)) {
+            stylusPointerIds.set(args.pointerProperties[i].id);
+        }
+    }
+    return stylusPointerIds;
+}
+
 /**
- * Remove stylus pointers from the provided NotifyMotionArgs.
+ * Remove the provided stylus pointers from the NotifyMotionArgs.
  *
  * Return NotifyMotionArgs where the stylus pointers have been removed.
  * If this results in removal of the active pointer, then return nullopt.
  */
-static std::optional<NotifyMotionArgs> removeStylusPointerIds(const NotifyMotionArgs& args) {
-    std::set<int32_t> stylusPointerIds;
-    for (uint32_t i = 0; i < args.getPointerCount(); i++) {
-        if (isStylusToolType(args.pointerProperties[i].toolType)) {
-            stylusPointerIds.insert(args.pointerProperties[i].id);
-        }
-    }
+static std::optional<NotifyMotionArgs> removeStylusPointerIds(
+        const NotifyMotionArgs& args, const std::bitset<MAX_POINTER_ID + 1>& stylusPointerIds) {
     NotifyMotionArgs withoutStylusPointers = removePointerIds(args, stylusPointerIds);
     if (withoutStylusPointers.getPointerCount() == 0 ||
         withoutStylusPointers.action == ACTION_UNKNOWN) {
@@ -227,6 +243,12 @@ static std::optional<NotifyMotionArgs> removeStylusPointerIds(const NotifyMotion
     return withoutStylusPointers;
 }
 
+static std::bitset<MAX_POINTER_ID + 1> pointerIdBit(int32_t pointerId) {
+    std::bitset<MAX_POINTER_ID + 1> pointerIds;
+    pointerIds.set(pointerId);
+    return pointerIds;
+}
+
 std::optional<AndroidPalmFilterDeviceInfo> createPalmFilterDeviceInfo(
         const InputDeviceInfo& deviceInfo) {
     if (!isFromTouchscreen(deviceInfo.getSources())) {
@@ -284,10 +306,16 @@ std::optional<AndroidPalmFilterDeviceInfo> createPalmFilterDeviceInfo(
  * The pointers can never be "unsuppressed": once a pointer is canceled, it will never become valid.
  */
 std::vector<NotifyMotionArgs> cancelSuppressedPointers(
-        const NotifyMotionArgs& args, const std::set<int32_t>& oldSuppressedPointerIds,
-        const std::set<int32_t>& newSuppressedPointerIds) {
+        const NotifyMotionArgs& args,
+        const std::bitset<MAX_POINTER_ID + 1>& oldSuppressedPointerIds,
+        const std::bitset<MAX_POINTER_ID + 1>& newSuppressedPointerIds) {
     LOG_ALWAYS_FATAL_IF(args.getPointerCount() == 0, "0 pointers in %s", args.dump().c_str());
 
+    if (oldSuppressedPointerIds.none() && newSuppressedPointerIds.none()) {
+        // This is the case for almost every event. There's nothing to remove.
+        return {args};
+    }
+
     // First, let's remove the old suppressed pointers. They've already been canceled previously.
     NotifyMotionArgs oldArgs = removePointerIds(args, oldSuppressedPointerIds);
 
@@ -300,13 +328,13 @@ std::vector<NotifyMotionArgs> cancelSuppressedPointers(
     NotifyMotionArgs removedArgs{oldArgs};
     for (uint32_t i = 0; i < oldArgs.getPointerCount(); i++) {
         const int32_t pointerId = oldArgs.pointerProperties[i].id;
-        if (newSuppressedPointerIds.find(pointerId) == newSuppressedPointerIds.end()) {
+        if (!newSuppressedPointerIds.test(pointerId)) {
             // This is a pointer that should not be canceled. Move on.
             continue;
         }
         if (pointerId == activePointerId && actionMasked == AMOTION_EVENT_ACTION_POINTER_DOWN) {
             // Remove this pointer, but don't cancel it. We'll just not send the POINTER_DOWN event
-            removedArgs = removePointerIds(removedArgs, {pointerId});
+            removedArgs = removePointerIds(removedArgs, pointerIdBit(pointerId));
             continue;
         }
 
@@ -324,7 +352,7 @@ std::vector<NotifyMotionArgs> cancelSuppressedPointers(
         out.back().action = getActionUpForPointerId(out.back(), pointerId);
 
         // Remove the newly canceled pointer from the args
-        removedArgs = removePointerIds(removedArgs, {pointerId});
+        removedArgs = removePointerIds(removedArgs, pointerIdBit(pointerId));
     }
 
     // Now 'removedArgs' contains only pointers that are valid.
@@ -484,6 +512,11 @@ void UnwantedInteractionBlocker::monitor() {
 
 UnwantedInteractionBlocker::~UnwantedInteractionBlocker() {}
 
+SlotState::SlotState() {
+    mSlotsByPointerId.fill(-1);
+    mPointerIdsBySlot.fill(-1);
+}
+
 void SlotState::update(const NotifyMotionArgs& args) {
     for (size_t i = 0; i < args.getPointerCount(); i++) {
         const int32_t pointerId = args.pointerProperties[i].id;
@@ -493,18 +526,17 @@ void SlotState::update(const NotifyMotionArgs& args) {
 }
 
 size_t SlotState::findUnusedSlot() const {
-    size_t unusedSlot = 0;
-    // Since the collection is ordered, we can rely on the in-order traversal
-    for (const auto& [slot, trackingId] : mPointerIdsBySlot) {
-        if (unusedSlot != slot) {
-            break;
+    for (size_t slot = 0; slot < mPointerIdsBySlot.size(); slot++) {
+        if (mPointerIdsBySlot[slot] == -1) {
+            return slot;
         }
-        unusedSlot++;
     }
-    return unusedSlot;
+    LOG_ALWAYS_FATAL("All %zu slots are in use", mPointerIdsBySlot.size());
 }
 
 void SlotState::processPointerId(int pointerId, int32_t actionMasked) {
+    LOG_ALWAYS_FATAL_IF(pointerId < 0 || pointerId > MAX_POINTER_ID, "Invalid pointer id %d",
+                        pointerId);
     switch (MotionEvent::getActionMasked(actionMasked)) {
         case AMOTION_EVENT_ACTION_DOWN:
         case AMOTION_EVENT_ACTION_POINTER_DOWN:
@@ -512,7 +544,7 @@ void SlotState::processPointerId(int pointerId, int32_t actionMasked) {
             // New pointer going down
             size_t newSlot = findUnusedSlot();
             mPointerIdsBySlot[newSlot] = pointerId;
-            mSlotsByPointerId[pointerId] = newSlot;
+            mSlotsByPointerId[pointerId] = static_cast<int32_t>(newSlot);
             return;
         }
         case AMOTION_EVENT_ACTION_MOVE:
@@ -523,12 +555,11 @@ void SlotState::processPointerId(int pointerId, int32_t actionMasked) {
         case AMOTION_EVENT_ACTION_POINTER_UP:
         case AMOTION_EVENT_ACTION_UP:
         case AMOTION_EVENT_ACTION_HOVER_EXIT: {
-            auto it = mSlotsByPointerId.find(pointerId);
-            LOG_ALWAYS_FATAL_IF(it == mSlotsByPointerId.end());
-            size_t slot = it->second;
+            const int32_t slot = mSlotsByPointerId[pointerId];
+            LOG_ALWAYS_FATAL_IF(slot == -1);
             // Erase this pointer from both collections
-            mPointerIdsBySlot.erase(slot);
-            mSlotsByPointerId.erase(pointerId);
+            mPointerIdsBySlot[slot] = -1;
+            mSlotsByPointerId[pointerId] = -1;
             return;
         }
     }
@@ -537,18 +568,31 @@ void SlotState::processPointerId(int pointerId, int32_t actionMasked) {
 }
 
 std::optional<size_t> SlotState::getSlotForPointerId(int32_t pointerId) const {
-    auto it = mSlotsByPointerId.find(pointerId);
-    if (it == mSlotsByPointerId.end()) {
+    if (pointerId < 0 || pointerId > MAX_POINTER_ID || mSlotsByPointerId[pointerId] == -1) {
         return std::nullopt;
     }
-    return it->second;
+    return mSlotsByPointerId[pointerId];
 }
 
 std::string SlotState::dump() const {
+    std::string slotsByPointerId;
+    for (size_t pointerId = 0; pointerId < mSlotsByPointerId.size(); pointerId++) {
+        if (mSlotsByPointerId[pointerId] != -1) {
+            slotsByPointerId += StringPrintf("%s%zu:%" PRId32, slotsByPointerId.empty() ? "" : "\n",
+                                             pointerId, mSlotsByPointerId[pointerId]);
+        }
+    }
+    std::string pointerIdsBySlot;
+    for (size_t slot = 0; slot < mPointerIdsBySlot.size(); slot++) {
+        if (mPointerIdsBySlot[slot] != -1) {
+            pointerIdsBySlot += StringPrintf("%s%zu:%" PRId32, pointerIdsBySlot.empty() ? "" : "\n",
+                                             slot, mPointerIdsBySlot[slot]);
+        }
+    }
     std::string out = "mSlotsByPointerId:\n";
-    out += addLinePrefix(dumpMap(mSlotsByPointerId), "  ") + "\n";
+    out += addLinePrefix(slotsByPointerId, "  ") + "\n";
     out += "mPointerIdsBySlot:\n";
-    out += addLinePrefix(dumpMap(mPointerIdsBySlot), "  ") + "\n";
+    out += addLinePrefix(pointerIdsBySlot, "  ") + "\n";
     return out;
 }
 
@@ -566,6 +610,7 @@ PalmRejector::PalmRejector(const AndroidPalmFilterDeviceInfo& info,
       : mSharedPalmState(std::make_unique<::ui::SharedPalmDetectionFilterState>()),
         mDeviceInfo(info),
         mPalmDetectionFilter(std::move(filter)) {
+    mTouches.reserve(MAX_POINTERS);
     if (mPalmDetectionFilter != nullptr) {
         // This path is used for testing. Non-testing invocations should let this constructor
         // create a real PalmDetectionFilter
@@ -577,11 +622,10 @@ PalmRejector::PalmRejector(const AndroidPalmFilterDeviceInfo& info,
                                                                       mSharedPalmState.get());
 }
 
-std::vector<::ui::InProgressTouchEvdev> getTouches(const NotifyMotionArgs& args,
-                                                   const AndroidPalmFilterDeviceInfo& deviceInfo,
-                                                   const SlotState& oldSlotState,
-                                                   const SlotState& newSlotState) {
-    std::vector<::ui::InProgressTouchEvdev> touches;
+void getTouches(const NotifyMotionArgs& args, const AndroidPalmFilterDeviceInfo& deviceInfo,
+                const SlotState& oldSlotState, const SlotState& newSlotState,
+                std::vector<::ui::InProgressTouchEvdev>& touches) {
+    touches.clear();
 
     for (size_t i = 0; i < args.getPointerCount(); i++) {
         const int32_t pointerId = args.pointerProperties[i].id;
@@ -641,10 +685,9 @@ std::vector<::ui::InProgressTouchEvdev> getTouches(const NotifyMotionArgs& args,
         // The field 'reported_tool_type' is not used for palm rejection
         touches.back().stylus_button = false;
     }
-    return touches;
 }
 
-std::set<int32_t> PalmRejector::detectPalmPointers(const NotifyMotionArgs& args) {
+std::bitset<MAX_POINTER_ID + 1> PalmRejector::detectPalmPointers(const NotifyMotionArgs& args) {
     std::bitset<::ui::kNumTouchEvdevSlots> slotsToHold;
     std::bitset<::ui::kNumTouchEvdevSlots> slotsToSuppress;
 
@@ -653,25 +696,24 @@ std::set<int32_t> PalmRejector::detectPalmPointers(const NotifyMotionArgs& args)
     SlotState oldSlotState = mSlotState;
     mSlotState.update(args);
 
-    std::vector<::ui::InProgressTouchEvdev> touches =
-            getTouches(args, mDeviceInfo, oldSlotState, mSlotState);
+    getTouches(args, mDeviceInfo, oldSlotState, mSlotState, mTouches);
     ::base::TimeTicks chromeTimestamp = toChromeTimestamp(args.eventTime);
 
     if (DEBUG_MODEL) {
         std::stringstream touchesStream;
-        for (const ::ui::InProgressTouchEvdev& touch : touches) {
+        for (const ::ui::InProgressTouchEvdev& touch : mTouches) {
             touchesStream << touch.tracking_id << " : " << touch << "\n";
         }
         ALOGD("Filter: touches = %s", touchesStream.str().c_str());
     }
 
-    mPalmDetectionFilter->Filter(touches, chromeTimestamp, &slotsToHold, &slotsToSuppress);
+    mPalmDetectionFilter->Filter(mTouches, chromeTimestamp, &slotsToHold, &slotsToSuppress);
 
     ALOGD_IF(DEBUG_MODEL, "Response: slotsToHold = %s, slotsToSuppress = %s",
              slotsToHold.to_string().c_str(), slotsToSuppress.to_string().c_str());
 
     // Now that we know which slots should be suppressed, let's convert those to pointer id's.
-    std::set<int32_t> newSuppressedIds;
+    std::bitset<MAX_POINTER_ID + 1> newSuppressedIds;
     for (size_t i = 0; i < args.getPointerCount(); i++) {
         const int32_t pointerId = args.pointerProperties[i].id;
         std::optional<size_t> slot = oldSlotState.getSlotForPointerId(pointerId);
@@ -680,7 +722,7 @@ std::set<int32_t> PalmRejector::detectPalmPointers(const NotifyMotionArgs& args)
             LOG_ALWAYS_FATAL_IF(!slot, "Could not find slot for pointer id %" PRId32, pointerId);
         }
         if (slotsToSuppress.test(*slot)) {
-            newSuppressedIds.insert(pointerId);
+            newSuppressedIds.set(pointerId);
         }
     }
     return newSuppressedIds;
@@ -701,20 +743,22 @@ std::vector<NotifyMotionArgs> PalmRejector::processMotion(const NotifyMotionArgs
         return {args};
     }
     if (args.action == AMOTION_EVENT_ACTION_DOWN) {
-        mSuppressedPointerIds.clear();
+        mSuppressedPointerIds.reset();
     }
 
-    std::set<int32_t> oldSuppressedIds;
-    std::swap(oldSuppressedIds, mSuppressedPointerIds);
+    const std::bitset<MAX_POINTER_ID + 1> oldSuppressedIds = mSuppressedPointerIds;
 
-    std::optional<NotifyMotionArgs> touchOnlyArgs = removeStylusPointerIds(args);
-    if (touchOnlyArgs) {
+    const std::bitset<MAX_POINTER_ID + 1> stylusPointerIds = getStylusPointerIds(args);
+    if (stylusPointerIds.none()) {
+        // Avoid copying the args when there's no stylus pointer to remove.
+        mSuppressedPointerIds = detectPalmPointers(args);
+    } else if (std::optional<NotifyMotionArgs> touchOnlyArgs =
+                       removeStylusPointerIds(args, stylusPointerIds);
+               touchOnlyArgs) {
         mSuppressedPointerIds = detectPalmPointers(*touchOnlyArgs);
-    } else {
-        // This is a stylus-only event.
-        // We can skip this event and just keep the suppressed pointer ids the same as before.
-        mSuppressedPointerIds = oldSuppressedIds;
     }
+    // Otherwise, this is a stylus-only event.
+    // We can skip this event and just keep the suppressed pointer ids the same as before.
 
     std::vector<NotifyMotionArgs> argsWithoutUnwantedPointers =
             cancelSuppressedPointers(args, oldSuppressedIds, mSuppressedPointerIds);
@@ -724,10 +768,9 @@ std::vector<NotifyMotionArgs> PalmRejector::processMotion(const NotifyMotionArgs
 
     // Only log if new pointers are getting rejected. That means mSuppressedPointerIds is not a
     // subset of oldSuppressedIds.
-    if (!std::includes(oldSuppressedIds.begin(), oldSuppressedIds.end(),
-                       mSuppressedPointerIds.begin(), mSuppressedPointerIds.end())) {
+    if ((mSuppressedPointerIds & ~oldSuppressedIds).any()) {
         ALOGI("Palm detected, removing pointer ids %s after %" PRId64 "ms from %s",
-              dumpSet(mSuppressedPointerIds).c_str(), ns2ms(args.eventTime - args.downTime),
+              dumpPointerIds(mSuppressedPointerIds).c_str(), ns2ms(args.eventTime - args.downTime),
               args.dump().c_str());
     }
 
@@ -748,7 +791,7 @@ std::string PalmRejector::dump() const {
     out += "mSlotState:\n";
     out += addLinePrefix(mSlotState.dump(), "  ");
     out += "mSuppressedPointerIds: ";
-    out += dumpSet(mSuppressedPointerIds) + "\n";
+    out += dumpPointerIds(mSuppressedPointerIds) + "\n";
     std::stringstream state;
     state << *mSharedPalmState;
     out += "mSharedPalmState: " + state.str() + "\n";
@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include <array>
+#include <bitset>
 #include <map>
 #include <set>
 
@@ -63,11 +65,12 @@ static constexpr int32_t ACTION_UNKNOWN = -1;
  * @param pointerIds the pointer ids of the pointers that should be removed
  */
 NotifyMotionArgs removePointerIds(const NotifyMotionArgs& args,
-                                  const std::set<int32_t>& pointerIds);
+                                  const std::bitset<MAX_POINTER_ID + 1>& pointerIds);
 
 std::vector<NotifyMotionArgs> cancelSuppressedPointers(
-        const NotifyMotionArgs& args, const std::set<int32_t>& oldSuppressedPointerIds,
-        const std::set<int32_t>& newSuppressedPointerIds);
+        const NotifyMotionArgs& args,
+        const std::bitset<MAX_POINTER_ID + 1>& oldSuppressedPointerIds,
+        const std::bitset<MAX_POINTER_ID + 1>& newSuppressedPointerIds);
 
 std::string toString(const ::ui::InProgressTouchEvdev& touch);
 
@@ -128,6 +131,7 @@ private:
 
 class SlotState {
 public:
+    SlotState();
     /**
      * Update the state using the new information provided in the NotifyMotionArgs
      */
@@ -141,12 +145,11 @@ private:
     // The map from tracking id to slot state. Since the PalmRejectionFilter works close to the
     // evdev level, the only way to tell it about UP or CANCEL events is by sending tracking id = -1
     // to the appropriate touch slot. So we need to reconstruct the original slot.
-    // The two collections below must always be in-sync.
-    // Use std::map instead of std::unordered_map because we rely on these collections being
-    // ordered. It also has better space efficiency than unordered_map because we only have a few
-    // pointers most of the time.
-    std::map<int32_t /*pointerId*/, size_t /*slot*/> mSlotsByPointerId;
-    std::map<size_t /*slot*/, int32_t /*pointerId */> mPointerIdsBySlot;
+    // The two collections below must always be in-sync. Unused entries are set to -1.
+    // They are fixed-size arrays rather than maps, because the state is copied for every event
+    // that goes through the palm rejector, and that copy shouldn't allocate.
+    std::array<int32_t /*slot*/, MAX_POINTER_ID + 1> mSlotsByPointerId;
+    std::array<int32_t /*pointerId*/, ::ui::kNumTouchEvdevSlots> mPointerIdsBySlot;
 
     size_t findUnusedSlot() const;
 };
@@ -154,11 +157,12 @@ private:
 /**
  * Convert an Android event to a linux-like 'InProgressTouchEvdev'. The provided SlotState's
  * are used to figure out which slot does each pointer belong to.
+ * The touches are written to 'outTouches', replacing its contents. The vector is only cleared, so
+ * that a caller that reuses it for every event doesn't reallocate it.
  */
-std::vector<::ui::InProgressTouchEvdev> getTouches(const NotifyMotionArgs& args,
-                                                   const AndroidPalmFilterDeviceInfo& deviceInfo,
-                                                   const SlotState& oldSlotState,
-                                                   const SlotState& newSlotState);
+void getTouches(const NotifyMotionArgs& args, const AndroidPalmFilterDeviceInfo& deviceInfo,
+                const SlotState& oldSlotState, const SlotState& newSlotState,
+                std::vector<::ui::InProgressTouchEvdev>& outTouches);
 
 class PalmRejector {
 public:
@@ -181,14 +185,16 @@ private:
      * This function is not const because it has side-effects. It will update the slot state using
      * the incoming args! Also, it will call Filter(..), which has side-effects.
      */
-    std::set<int32_t> detectPalmPointers(const NotifyMotionArgs& args);
+    std::bitset<MAX_POINTER_ID + 1> detectPalmPointers(const NotifyMotionArgs& args);
     std::unique_ptr<::ui::SharedPalmDetectionFilterState> mSharedPalmState;
     AndroidPalmFilterDeviceInfo mDeviceInfo;
     std::unique_ptr<::ui::PalmDetectionFilter> mPalmDetectionFilter;
-    std::set<int32_t> mSuppressedPointerIds;
+    std::bitset<MAX_POINTER_ID + 1> mSuppressedPointerIds;
 
     // Used to help convert an Android touch stream to Linux input stream.
     SlotState mSlotState;
+    // The touches that are sent to the model. Kept here so that it's only allocated once.
+    std::vector<::ui::InProgressTouchEvdev> mTouches;
 };
 
 } // namespace android
@@ -14,8 +14,15 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
 #include <benchmark/benchmark.h>
 
+#include <NotifyArgsBuilders.h>
 #include <android/os/IInputConstants.h>
 #include <binder/Binder.h>
 #include "../dispatcher/InputDispatcher.h"
@@ -29,6 +36,27 @@ using android::os::IInputConstants;
 using android::os::InputEventInjectionResult;
 using android::os::InputEventInjectionSync;
 
+// Counts every heap allocation made by the process, so that benchmarks can report how many
+// allocations the dispatcher makes per event. This includes the allocations of the dispatcher
+// thread as well as those of the benchmark thread that consumes the events.
+static std::atomic<size_t> sAllocationCount{0};
+
+void* operator new(size_t size) {
+    sAllocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
 namespace android::inputdispatcher {
 
 namespace {
@@ -45,6 +73,30 @@ static nsecs_t now() {
     return systemTime(SYSTEM_TIME_MONOTONIC);
 }
 
+// Reports the 50th, 90th and 99th percentiles of the given latencies, in microseconds.
+static void reportLatencyPercentiles(benchmark::State& state, std::vector<nsecs_t>& latencies) {
+    if (latencies.empty()) {
+        return;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    const auto percentile = [&latencies](size_t p) {
+        const size_t index = std::min(latencies.size() - 1, latencies.size() * p / 100);
+        return benchmark::Counter(static_cast<double>(latencies[index]) / 1000.0);
+    };
+    state.counters["p50LatencyUs"] = percentile(50);
+    state.counters["p90LatencyUs"] = percentile(90);
+    state.counters["p99LatencyUs"] = percentile(99);
+}
+
+// Sends the event and returns how long it took until the window received it.
+static nsecs_t notifyMotionAndConsume(InputDispatcher& dispatcher, const NotifyMotionArgs& args,
+                                      FakeWindowHandle& window) {
+    const nsecs_t start = now();
+    dispatcher.notifyMotion(args);
+    window.consumeMotionEvent();
+    return now() - start;
+}
+
 static MotionEvent generateMotionEvent() {
     PointerProperties pointerProperties[1];
     PointerCoords pointerCoords[1];
@@ -135,6 +187,80 @@ static void benchmarkNotifyMotion(benchmark::State& state) {
     dispatcher->stop();
 }
 
+// A two finger gesture where each finger lands on a different window, so that every event after
+// the first is split across both windows. Reports the number of heap allocations per gesture.
+static void benchmarkNotifySplitMotionAllocations(benchmark::State& state) {
+    // Create dispatcher
+    FakeInputDispatcherPolicy fakePolicy;
+    auto dispatcher = std::make_unique<InputDispatcher>(fakePolicy);
+    dispatcher->setInputDispatchMode(/*enabled*/ true, /*frozen*/ false);
+    dispatcher->start();
+
+    // Create two side by side windows that allow touches to be split between them
+    std::shared_ptr<FakeApplicationHandle> application = std::make_shared<FakeApplicationHandle>();
+    sp<FakeWindowHandle> leftWindow =
+            sp<FakeWindowHandle>::make(application, dispatcher, "Left Window", DISPLAY_ID);
+    leftWindow->setFrame(Rect(0, 0, 200, 200));
+    sp<FakeWindowHandle> rightWindow =
+            sp<FakeWindowHandle>::make(application, dispatcher, "Right Window", DISPLAY_ID);
+    rightWindow->setFrame(Rect(200, 0, 400, 200));
+
+    dispatcher->onWindowInfosChanged({{*leftWindow->getInfo(), *rightWindow->getInfo()}, {}, 0, 0});
+
+    PointerProperties pointerProperties[2];
+    PointerCoords pointerCoords[2];
+    for (int32_t i = 0; i < 2; i++) {
+        pointerProperties[i].clear();
+        pointerProperties[i].id = i;
+        pointerProperties[i].toolType = ToolType::FINGER;
+
+        pointerCoords[i].clear();
+        pointerCoords[i].setAxisValue(AMOTION_EVENT_AXIS_X, 100 + 200 * i);
+        pointerCoords[i].setAxisValue(AMOTION_EVENT_AXIS_Y, 100);
+    }
+
+    const auto notifyMotion = [&](int32_t action, uint32_t pointerCount, nsecs_t downTime) {
+        const nsecs_t eventTime = action == AMOTION_EVENT_ACTION_DOWN ? downTime : now();
+        dispatcher->notifyMotion(
+                NotifyMotionArgs(IInputConstants::INVALID_INPUT_EVENT_ID, eventTime, eventTime,
+                                 DEVICE_ID, AINPUT_SOURCE_TOUCHSCREEN, DISPLAY_ID,
+                                 POLICY_FLAG_PASS_TO_USER, action, /* actionButton */ 0,
+                                 /* flags */ 0, AMETA_NONE, /* buttonState */ 0,
+                                 MotionClassification::NONE, AMOTION_EVENT_EDGE_FLAG_NONE,
+                                 pointerCount, pointerProperties, pointerCoords,
+                                 /* xPrecision */ 0, /* yPrecision */ 0,
+                                 AMOTION_EVENT_INVALID_CURSOR_POSITION,
+                                 AMOTION_EVENT_INVALID_CURSOR_POSITION, downTime,
+                                 /* videoFrames */ {}));
+    };
+    constexpr int32_t kSecondPointerIndex = 1 << AMOTION_EVENT_ACTION_POINTER_INDEX_SHIFT;
+
+    const size_t allocationsBefore = sAllocationCount.load(std::memory_order_relaxed);
+    for (auto _ : state) {
+        const nsecs_t downTime = now();
+        notifyMotion(AMOTION_EVENT_ACTION_DOWN, 1, downTime);
+        notifyMotion(AMOTION_EVENT_ACTION_POINTER_DOWN | kSecondPointerIndex, 2, downTime);
+        notifyMotion(AMOTION_EVENT_ACTION_MOVE, 2, downTime);
+        notifyMotion(AMOTION_EVENT_ACTION_POINTER_UP | kSecondPointerIndex, 2, downTime);
+        notifyMotion(AMOTION_EVENT_ACTION_UP, 1, downTime);
+
+        // DOWN, MOVE, MOVE, MOVE, UP
+        for (int i = 0; i < 5; i++) {
+            leftWindow->consumeMotionEvent();
+        }
+        // DOWN, MOVE, UP
+        for (int i = 0; i < 3; i++) {
+            rightWindow->consumeMotionEvent();
+        }
+    }
+    const size_t allocations = sAllocationCount.load(std::memory_order_relaxed) - allocationsBefore;
+    state.counters["allocationsPerGesture"] =
+            benchmark::Counter(static_cast<double>(allocations),
+                               benchmark::Counter::kAvgIterations);
+
+    dispatcher->stop();
+}
+
 static void benchmarkInjectMotion(benchmark::State& state) {
     // Create dispatcher
     FakeInputDispatcherPolicy fakePolicy;
@@ -195,9 +321,291 @@ static void benchmarkOnWindowInfosChanged(benchmark::State& state) {
     dispatcher->stop();
 }
 
+// A touch that lands on the bottom-most of state.range(0) windows, below state.range(1) spy windows
+// that cover the whole display. Reports the latency of each event on the touched window.
+static void benchmarkNotifyMotionManyWindows(benchmark::State& state) {
+    const auto windowCount = static_cast<size_t>(state.range(0));
+    const auto spyCount = static_cast<size_t>(state.range(1));
+
+    // Create dispatcher
+    FakeInputDispatcherPolicy fakePolicy;
+    auto dispatcher = std::make_unique<InputDispatcher>(fakePolicy);
+    dispatcher->setInputDispatchMode(/*enabled*/ true, /*frozen*/ false);
+    dispatcher->start();
+
+    std::shared_ptr<FakeApplicationHandle> application = std::make_shared<FakeApplicationHandle>();
+    std::vector<sp<FakeWindowHandle>> spies;
+    std::vector<gui::WindowInfo> windowInfos;
+    for (size_t i = 0; i < spyCount; i++) {
+        sp<FakeWindowHandle> spy =
+                sp<FakeWindowHandle>::make(application, dispatcher, "Spy Window", DISPLAY_ID);
+        spy->setFrame(Rect(0, 0, 1000, 1000));
+        spy->setSpy(true);
+        spy->setTrustedOverlay(true);
+        windowInfos.push_back(*spy->getInfo());
+        spies.push_back(std::move(spy));
+    }
+    // Windows that are above the touched window, but don't contain the touch
+    for (size_t i = 0; i + 1 < windowCount; i++) {
+        sp<FakeWindowHandle> window =
+                sp<FakeWindowHandle>::make(application, dispatcher, "Other Window", DISPLAY_ID);
+        const int32_t left = 100 + static_cast<int32_t>(i % 16) * 50;
+        const int32_t top = 100 + static_cast<int32_t>(i / 16) * 50;
+        window->setFrame(Rect(left, top, left + 50, top + 50));
+        windowInfos.push_back(*window->getInfo());
+    }
+    sp<FakeWindowHandle> window =
+            sp<FakeWindowHandle>::make(application, dispatcher, "Touched Window", DISPLAY_ID);
+    window->setFrame(Rect(0, 0, 100, 100));
+    windowInfos.push_back(*window->getInfo());
+
+    dispatcher->onWindowInfosChanged({windowInfos, {}, 0, 0});
+
+    std::vector<nsecs_t> latencies;
+    for (auto _ : state) {
+        const nsecs_t downTime = now();
+        for (int32_t action : {AMOTION_EVENT_ACTION_DOWN, AMOTION_EVENT_ACTION_MOVE,
+                               AMOTION_EVENT_ACTION_UP}) {
+            const NotifyMotionArgs args =
+                    MotionArgsBuilder(action, AINPUT_SOURCE_TOUCHSCREEN)
+                            .deviceId(DEVICE_ID)
+                            .downTime(downTime)
+                            .eventTime(action == AMOTION_EVENT_ACTION_DOWN ? downTime : now())
+                            .pointer(PointerBuilder(/*id=*/0, ToolType::FINGER).x(50).y(50))
+                            .build();
+            latencies.push_back(notifyMotionAndConsume(*dispatcher, args, *window));
+            for (const sp<FakeWindowHandle>& spy : spies) {
+                spy->consumeMotionEvent();
+            }
+        }
+    }
+    reportLatencyPercentiles(state, latencies);
+
+    dispatcher->stop();
+}
+
+// Alternates touches between state.range(0) displays, with one window on each display.
+static void benchmarkNotifyMotionMultiDisplay(benchmark::State& state) {
+    const auto displayCount = static_cast<int32_t>(state.range(0));
+
+    // Create dispatcher
+    FakeInputDispatcherPolicy fakePolicy;
+    auto dispatcher = std::make_unique<InputDispatcher>(fakePolicy);
+    dispatcher->setInputDispatchMode(/*enabled*/ true, /*frozen*/ false);
+    dispatcher->start();
+
+    std::shared_ptr<FakeApplicationHandle> application = std::make_shared<FakeApplicationHandle>();
+    std::vector<sp<FakeWindowHandle>> windows;
+    std::vector<gui::WindowInfo> windowInfos;
+    std::vector<gui::DisplayInfo> displayInfos;
+    for (int32_t i = 0; i < displayCount; i++) {
+        const ui::LogicalDisplayId displayId{i};
+        sp<FakeWindowHandle> window =
+                sp<FakeWindowHandle>::make(application, dispatcher, "Fake Window", displayId);
+        window->setFrame(Rect(0, 0, 1000, 1000));
+        windowInfos.push_back(*window->getInfo());
+        windows.push_back(std::move(window));
+
+        gui::DisplayInfo info;
+        info.displayId = displayId;
+        info.logicalWidth = 1000;
+        info.logicalHeight = 1000;
+        displayInfos.push_back(info);
+    }
+
+    dispatcher->onWindowInfosChanged({windowInfos, displayInfos, 0, 0});
+
+    std::vector<nsecs_t> latencies;
+    for (auto _ : state) {
+        for (int32_t i = 0; i < displayCount; i++) {
+            const nsecs_t downTime = now();
+            for (int32_t action : {AMOTION_EVENT_ACTION_DOWN, AMOTION_EVENT_ACTION_UP}) {
+                const NotifyMotionArgs args =
+                        MotionArgsBuilder(action, AINPUT_SOURCE_TOUCHSCREEN)
+                                .deviceId(DEVICE_ID)
+                                .displayId(ui::LogicalDisplayId{i})
+                                .downTime(downTime)
+                                .eventTime(action == AMOTION_EVENT_ACTION_DOWN ? downTime : now())
+                                .pointer(PointerBuilder(/*id=*/0, ToolType::FINGER).x(100).y(100))
+                                .build();
+                latencies.push_back(notifyMotionAndConsume(*dispatcher, args, *windows[i]));
+            }
+        }
+    }
+    reportLatencyPercentiles(state, latencies);
+
+    dispatcher->stop();
+}
+
+// Moves focus to the next of state.range(0) windows and types a key into it. Reports the latency
+// of each key event, which includes waiting for the focus change to be delivered.
+static void benchmarkNotifyKeyWithFocusChanges(benchmark::State& state) {
+    const auto windowCount = static_cast<size_t>(state.range(0));
+
+    // Create dispatcher
+    FakeInputDispatcherPolicy fakePolicy;
+    auto dispatcher = std::make_unique<InputDispatcher>(fakePolicy);
+    dispatcher->setInputDispatchMode(/*enabled*/ true, /*frozen*/ false);
+    dispatcher->start();
+
+    std::shared_ptr<FakeApplicationHandle> application = std::make_shared<FakeApplicationHandle>();
+    dispatcher->setFocusedApplication(DISPLAY_ID, application);
+    std::vector<sp<FakeWindowHandle>> windows;
+    std::vector<gui::WindowInfo> windowInfos;
+    for (size_t i = 0; i < windowCount; i++) {
+        sp<FakeWindowHandle> window =
+                sp<FakeWindowHandle>::make(application, dispatcher, "Fake Window", DISPLAY_ID);
+        window->setFocusable(true);
+        windowInfos.push_back(*window->getInfo());
+        windows.push_back(std::move(window));
+    }
+    dispatcher->onWindowInfosChanged({windowInfos, {}, 0, 0});
+
+    const auto requestFocus = [&dispatcher](const sp<FakeWindowHandle>& window) {
+        gui::FocusRequest request;
+        request.token = window->getToken();
+        request.windowName = window->getName();
+        request.timestamp = now();
+        request.displayId = window->getInfo()->displayId.val();
+        dispatcher->setFocusedWindow(request);
+    };
+    requestFocus(windows[0]);
+    windows[0]->consumeFocusEvent(/*hasFocus=*/true);
+
+    size_t focusedIndex = 0;
+    std::vector<nsecs_t> latencies;
+    for (auto _ : state) {
+        const size_t nextIndex = (focusedIndex + 1) % windowCount;
+        if (nextIndex != focusedIndex) {
+            requestFocus(windows[nextIndex]);
+            windows[focusedIndex]->consumeFocusEvent(/*hasFocus=*/false);
+            windows[nextIndex]->consumeFocusEvent(/*hasFocus=*/true);
+            focusedIndex = nextIndex;
+        }
+
+        const nsecs_t downTime = now();
+        for (int32_t action : {AKEY_EVENT_ACTION_DOWN, AKEY_EVENT_ACTION_UP}) {
+            const NotifyKeyArgs args = KeyArgsBuilder(action, AINPUT_SOURCE_KEYBOARD)
+                                               .deviceId(DEVICE_ID)
+                                               .downTime(downTime)
+                                               .keyCode(AKEYCODE_A)
+                                               .build();
+            const nsecs_t start = now();
+            dispatcher->notifyKey(args);
+            windows[focusedIndex]->consumeKey();
+            latencies.push_back(now() - start);
+        }
+    }
+    reportLatencyPercentiles(state, latencies);
+
+    dispatcher->stop();
+}
+
+// Sends state.range(0) taps to a window before it reads any of them, so that the dispatcher keeps
+// a long wait queue and many pending ANR timeouts for the connection.
+static void benchmarkNotifyMotionSlowConsumer(benchmark::State& state) {
+    const auto tapCount = static_cast<size_t>(state.range(0));
+
+    // Create dispatcher
+    FakeInputDispatcherPolicy fakePolicy;
+    auto dispatcher = std::make_unique<InputDispatcher>(fakePolicy);
+    dispatcher->setInputDispatchMode(/*enabled*/ true, /*frozen*/ false);
+    dispatcher->start();
+
+    // Create a window that will receive motion events
+    std::shared_ptr<FakeApplicationHandle> application = std::make_shared<FakeApplicationHandle>();
+    sp<FakeWindowHandle> window =
+            sp<FakeWindowHandle>::make(application, dispatcher, "Fake Window", DISPLAY_ID);
+
+    dispatcher->onWindowInfosChanged({{*window->getInfo()}, {}, 0, 0});
+
+    NotifyMotionArgs motionArgs = generateMotionArgs();
+
+    for (auto _ : state) {
+        // Taps are used rather than moves, so that the consumer can't batch them together
+        for (size_t i = 0; i < tapCount; i++) {
+            motionArgs.action = AMOTION_EVENT_ACTION_DOWN;
+            motionArgs.downTime = now();
+            motionArgs.eventTime = motionArgs.downTime;
+            dispatcher->notifyMotion(motionArgs);
+
+            motionArgs.action = AMOTION_EVENT_ACTION_UP;
+            motionArgs.eventTime = now();
+            dispatcher->notifyMotion(motionArgs);
+        }
+
+        for (size_t i = 0; i < tapCount * 2; i++) {
+            window->consumeMotionEvent();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(tapCount) * 2);
+
+    dispatcher->stop();
+}
+
+// A stylus stroke of state.range(0) moves, sent at the rate of a 240 Hz digitizer, where each
+// event carries pressure, tilt and orientation. Reports the latency of each event.
+static void benchmarkNotifyStylusMotion(benchmark::State& state) {
+    const auto moveCount = static_cast<size_t>(state.range(0));
+    constexpr nsecs_t kSamplePeriod = 1'000'000'000LL / 240;
+
+    // Create dispatcher
+    FakeInputDispatcherPolicy fakePolicy;
+    auto dispatcher = std::make_unique<InputDispatcher>(fakePolicy);
+    dispatcher->setInputDispatchMode(/*enabled*/ true, /*frozen*/ false);
+    dispatcher->start();
+
+    // Create a window that will receive motion events
+    std::shared_ptr<FakeApplicationHandle> application = std::make_shared<FakeApplicationHandle>();
+    sp<FakeWindowHandle> window =
+            sp<FakeWindowHandle>::make(application, dispatcher, "Fake Window", DISPLAY_ID);
+    window->setFrame(Rect(0, 0, 1000, 1000));
+
+    dispatcher->onWindowInfosChanged({{*window->getInfo()}, {}, 0, 0});
+
+    const auto stylusPointer = [](size_t sample) {
+        return PointerBuilder(/*id=*/0, ToolType::STYLUS)
+                .x(100 + static_cast<float>(sample))
+                .y(100 + static_cast<float>(sample))
+                .axis(AMOTION_EVENT_AXIS_PRESSURE, 0.5f)
+                .axis(AMOTION_EVENT_AXIS_TILT, 0.3f)
+                .axis(AMOTION_EVENT_AXIS_ORIENTATION, 0.1f);
+    };
+
+    std::vector<nsecs_t> latencies;
+    for (auto _ : state) {
+        const nsecs_t downTime = now();
+        for (size_t i = 0; i <= moveCount + 1; i++) {
+            int32_t action = AMOTION_EVENT_ACTION_MOVE;
+            if (i == 0) {
+                action = AMOTION_EVENT_ACTION_DOWN;
+            } else if (i == moveCount + 1) {
+                action = AMOTION_EVENT_ACTION_UP;
+            }
+            const NotifyMotionArgs args =
+                    MotionArgsBuilder(action, AINPUT_SOURCE_TOUCHSCREEN | AINPUT_SOURCE_STYLUS)
+                            .deviceId(DEVICE_ID)
+                            .downTime(downTime)
+                            .eventTime(downTime + static_cast<nsecs_t>(i) * kSamplePeriod)
+                            .pointer(stylusPointer(i))
+                            .build();
+            latencies.push_back(notifyMotionAndConsume(*dispatcher, args, *window));
+        }
+    }
+    reportLatencyPercentiles(state, latencies);
+
+    dispatcher->stop();
+}
+
 } // namespace
 
 BENCHMARK(benchmarkNotifyMotion);
+BENCHMARK(benchmarkNotifySplitMotionAllocations);
+BENCHMARK(benchmarkNotifyMotionManyWindows)->Args({1, 0})->Args({50, 0})->Args({50, 4});
+BENCHMARK(benchmarkNotifyMotionMultiDisplay)->Arg(1)->Arg(4);
+BENCHMARK(benchmarkNotifyKeyWithFocusChanges)->Arg(2)->Arg(20);
+BENCHMARK(benchmarkNotifyMotionSlowConsumer)->Arg(10)->Arg(50);
+BENCHMARK(benchmarkNotifyStylusMotion)->Arg(60);
 BENCHMARK(benchmarkInjectMotion);
 BENCHMARK(benchmarkOnWindowInfosChanged);
 
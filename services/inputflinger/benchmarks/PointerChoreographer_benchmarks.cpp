@@ -0,0 +1,162 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <memory>
+
+#include <benchmark/benchmark.h>
+
+#include <NotifyArgsBuilders.h>
+#include "../PointerChoreographer.h"
+
+namespace android {
+
+namespace {
+
+constexpr DeviceId DEVICE_ID = 1;
+constexpr ui::LogicalDisplayId DISPLAY_ID = ui::LogicalDisplayId::DEFAULT;
+
+// A gaming mouse reports at 1 kHz.
+constexpr nsecs_t MOUSE_REPORT_INTERVAL = ms2ns(1);
+
+// A PointerController that only keeps track of its position, and counts the calls that would
+// update the pointer sprite in the real implementation.
+class CountingPointerController : public PointerControllerInterface {
+public:
+    std::string dump() override { return ""; }
+    void move(float deltaX, float deltaY) override {
+        mX += deltaX;
+        mY += deltaY;
+    }
+    void setPosition(float x, float y) override {
+        mX = x;
+        mY = y;
+    }
+    FloatPoint getPosition() const override { return {mX, mY}; }
+    void fade(Transition) override {}
+    void unfade(Transition) override { unfadeCount++; }
+    void setPresentation(Presentation) override {}
+    void setSpots(const PointerCoords*, const uint32_t*, BitSet32, ui::LogicalDisplayId) override {}
+    void clearSpots() override {}
+    ui::LogicalDisplayId getDisplayId() const override { return mDisplayId; }
+    void setDisplayViewport(const DisplayViewport& viewport) override {
+        mDisplayId = viewport.displayId;
+    }
+    void updatePointerIcon(PointerIconStyle) override {}
+    void setCustomPointerIcon(const SpriteIcon&) override {}
+    void setSkipScreenshotFlagForDisplay(ui::LogicalDisplayId) override {}
+    void clearSkipScreenshotFlags() override {}
+
+    int64_t unfadeCount = 0;
+
+private:
+    float mX = 0;
+    float mY = 0;
+    ui::LogicalDisplayId mDisplayId = ui::LogicalDisplayId::INVALID;
+};
+
+class FakePolicy : public PointerChoreographerPolicyInterface {
+public:
+    std::shared_ptr<PointerControllerInterface> createPointerController(
+            PointerControllerInterface::ControllerType) override {
+        controller = std::make_shared<CountingPointerController>();
+        return controller;
+    }
+    void notifyPointerDisplayIdChanged(ui::LogicalDisplayId, const FloatPoint&) override {}
+    bool isInputMethodConnectionActive() override { return false; }
+    void notifyMouseCursorFadedOnTyping() override {}
+
+    std::shared_ptr<CountingPointerController> controller;
+};
+
+class DiscardingListener : public InputListenerInterface {
+public:
+    void notifyInputDevicesChanged(const NotifyInputDevicesChangedArgs&) override {}
+    void notifyKey(const NotifyKeyArgs&) override {}
+    void notifyMotion(const NotifyMotionArgs& args) override { benchmark::DoNotOptimize(args); }
+    void notifySwitch(const NotifySwitchArgs&) override {}
+    void notifySensor(const NotifySensorArgs&) override {}
+    void notifyVibratorState(const NotifyVibratorStateArgs&) override {}
+    void notifyDeviceReset(const NotifyDeviceResetArgs&) override {}
+    void notifyPointerCaptureChanged(const NotifyPointerCaptureChangedArgs&) override {}
+};
+
+// Doesn't register with SurfaceFlinger for window infos.
+class BenchmarkPointerChoreographer : public PointerChoreographer {
+public:
+    BenchmarkPointerChoreographer(InputListenerInterface& listener,
+                                  PointerChoreographerPolicyInterface& policy)
+          : PointerChoreographer(
+                    listener, policy,
+                    [](const sp<gui::WindowInfosListener>&) {
+                        return std::vector<gui::WindowInfo>{};
+                    },
+                    [](const sp<gui::WindowInfosListener>&) {}) {}
+};
+
+DisplayViewport createViewport() {
+    DisplayViewport viewport;
+    viewport.displayId = DISPLAY_ID;
+    viewport.logicalRight = 1920;
+    viewport.logicalBottom = 1080;
+    viewport.deviceWidth = 1920;
+    viewport.deviceHeight = 1080;
+    return viewport;
+}
+
+// Sends the relative movements of a 1 kHz mouse through PointerChoreographer, and reports how
+// many times the pointer was unfaded per event.
+static void benchmarkNotifyMouseMotion(benchmark::State& state) {
+    DiscardingListener listener;
+    FakePolicy policy;
+    BenchmarkPointerChoreographer choreographer(listener, policy);
+    choreographer.setDisplayViewports({createViewport()});
+    choreographer.setDefaultMouseDisplayId(DISPLAY_ID);
+
+    InputDeviceInfo mouseInfo;
+    mouseInfo.initialize(DEVICE_ID, /*generation=*/1, /*controllerNumber=*/1, /*identifier=*/{},
+                         "mouse", /*isExternal=*/true, /*hasMic=*/false,
+                         ui::LogicalDisplayId::INVALID);
+    mouseInfo.addSource(AINPUT_SOURCE_MOUSE);
+    choreographer.notifyInputDevicesChanged({/*id=*/1, {mouseInfo}});
+
+    nsecs_t eventTime = 0;
+    int64_t eventCount = 0;
+    for (auto _ : state) {
+        eventTime += MOUSE_REPORT_INTERVAL;
+        // Move back and forth, so that the pointer isn't stopped at the edge of the display.
+        const float delta = (eventCount++ % 200 < 100) ? 1 : -1;
+        choreographer.notifyMotion(
+                MotionArgsBuilder(AMOTION_EVENT_ACTION_HOVER_MOVE, AINPUT_SOURCE_MOUSE)
+                        .pointer(PointerBuilder(/*id=*/0, ToolType::MOUSE)
+                                         .axis(AMOTION_EVENT_AXIS_RELATIVE_X, delta)
+                                         .axis(AMOTION_EVENT_AXIS_RELATIVE_Y, delta))
+                        .deviceId(DEVICE_ID)
+                        .displayId(ui::LogicalDisplayId::INVALID)
+                        .eventTime(eventTime)
+                        .build());
+    }
+    state.SetItemsProcessed(eventCount);
+    if (policy.controller != nullptr && eventCount > 0) {
+        state.counters["unfadesPerEvent"] =
+                static_cast<double>(policy.controller->unfadeCount) / eventCount;
+    }
+}
+
+} // namespace
+
+BENCHMARK(benchmarkNotifyMouseMotion);
+
+} // namespace android
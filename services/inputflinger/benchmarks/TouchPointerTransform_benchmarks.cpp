@@ -0,0 +1,83 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <array>
+
+#include <benchmark/benchmark.h>
+
+#include "../reader/mapper/TouchPointerTransform.h"
+
+namespace android {
+
+namespace {
+
+// A touchscreen that is calibrated, and mounted rotated by 90 degrees on a 1080x2400 display.
+const TouchAffineTransformation kCalibration(1.02f, 0.01f, -3.5f, -0.01f, 0.98f, 4.25f);
+
+ui::Transform makeRawToDisplay() {
+    ui::Transform scale;
+    scale.set(0.5f, 0, 0, 0.5f);
+    return ui::Transform(ui::Transform::ROT_90, 1080, 2400) * scale;
+}
+
+// Fills the raw coordinates of a frame, changing them with every frame so that the results can't
+// be reused.
+void fillRawCoordinates(size_t pointerCount, size_t frame, PointerCoordinateBatch& batch) {
+    for (size_t i = 0; i < pointerCount; i++) {
+        batch.x[i] = static_cast<float>(100 * i + frame % 100);
+        batch.y[i] = static_cast<float>(200 * i + frame % 50);
+    }
+}
+
+// The transform that TouchInputMapper::cookPointerData used to apply to every pointer.
+static void benchmarkTransformPointersOneByOne(benchmark::State& state) {
+    const size_t pointerCount = static_cast<size_t>(state.range(0));
+    const ui::Transform rawToDisplay = makeRawToDisplay();
+    PointerCoordinateBatch batch;
+    size_t frame = 0;
+    for (auto _ : state) {
+        fillRawCoordinates(pointerCount, frame++, batch);
+        for (size_t i = 0; i < pointerCount; i++) {
+            vec2 transformed = {batch.x[i], batch.y[i]};
+            kCalibration.applyTo(transformed.x /*byRef*/, transformed.y /*byRef*/);
+            transformed = rawToDisplay.transform(transformed);
+            batch.x[i] = transformed.x;
+            batch.y[i] = transformed.y;
+        }
+        benchmark::DoNotOptimize(batch);
+    }
+    state.SetItemsProcessed(state.iterations() * pointerCount);
+}
+
+static void benchmarkTransformPointersBatched(benchmark::State& state) {
+    const size_t pointerCount = static_cast<size_t>(state.range(0));
+    const ui::Transform rawToDisplay = makeRawToDisplay();
+    PointerCoordinateBatch batch;
+    size_t frame = 0;
+    for (auto _ : state) {
+        fillRawCoordinates(pointerCount, frame++, batch);
+        transformPointerCoordinates(kCalibration, rawToDisplay, batch);
+        benchmark::DoNotOptimize(batch);
+    }
+    state.SetItemsProcessed(state.iterations() * pointerCount);
+}
+
+} // namespace
+
+BENCHMARK(benchmarkTransformPointersOneByOne)->Arg(1)->Arg(2)->Arg(10);
+BENCHMARK(benchmarkTransformPointersBatched)->Arg(1)->Arg(2)->Arg(10);
+
+} // namespace android
@@ -0,0 +1,139 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <NotifyArgsBuilders.h>
+#include "../UnwantedInteractionBlocker.h"
+
+namespace android {
+
+namespace {
+
+constexpr DeviceId DEVICE_ID = 1;
+
+// A 120 Hz touchscreen.
+constexpr nsecs_t TOUCH_REPORT_INTERVAL = 8333333;
+
+// The number of MOVE events in every gesture.
+constexpr size_t MOVES_PER_GESTURE = 60;
+
+class DiscardingListener : public InputListenerInterface {
+public:
+    void notifyInputDevicesChanged(const NotifyInputDevicesChangedArgs&) override {}
+    void notifyKey(const NotifyKeyArgs&) override {}
+    void notifyMotion(const NotifyMotionArgs& args) override { benchmark::DoNotOptimize(args); }
+    void notifySwitch(const NotifySwitchArgs&) override {}
+    void notifySensor(const NotifySensorArgs&) override {}
+    void notifyVibratorState(const NotifyVibratorStateArgs&) override {}
+    void notifyDeviceReset(const NotifyDeviceResetArgs&) override {}
+    void notifyPointerCaptureChanged(const NotifyPointerCaptureChangedArgs&) override {}
+};
+
+InputDeviceInfo createTouchscreenInfo() {
+    InputDeviceInfo info;
+    info.initialize(DEVICE_ID, /*generation=*/1, /*controllerNumber=*/1, /*identifier=*/{},
+                    "touchscreen", /*isExternal=*/false, /*hasMic=*/false,
+                    ui::LogicalDisplayId::INVALID);
+    info.addSource(AINPUT_SOURCE_TOUCHSCREEN);
+    info.addMotionRange(AMOTION_EVENT_AXIS_X, AINPUT_SOURCE_TOUCHSCREEN, 0, 1599, /*flat=*/0,
+                        /*fuzz=*/0, /*resolution=*/11);
+    info.addMotionRange(AMOTION_EVENT_AXIS_Y, AINPUT_SOURCE_TOUCHSCREEN, 0, 2559, /*flat=*/0,
+                        /*fuzz=*/0, /*resolution=*/11);
+    info.addMotionRange(AMOTION_EVENT_AXIS_TOUCH_MAJOR, AINPUT_SOURCE_TOUCHSCREEN, 0, 255,
+                        /*flat=*/0, /*fuzz=*/0, /*resolution=*/1);
+    return info;
+}
+
+PointerBuilder finger(int32_t id, float x, float y) {
+    return PointerBuilder(id, ToolType::FINGER)
+            .x(x)
+            .y(y)
+            .axis(AMOTION_EVENT_AXIS_TOUCH_MAJOR, 10);
+}
+
+// A two-finger gesture, in which both fingers move together. The times are filled in later.
+std::vector<NotifyMotionArgs> createTwoFingerGesture() {
+    std::vector<NotifyMotionArgs> gesture;
+    gesture.push_back(MotionArgsBuilder(AMOTION_EVENT_ACTION_DOWN, AINPUT_SOURCE_TOUCHSCREEN)
+                              .deviceId(DEVICE_ID)
+                              .pointer(finger(0, 100, 100))
+                              .build());
+    gesture.push_back(
+            MotionArgsBuilder(AMOTION_EVENT_ACTION_POINTER_DOWN |
+                                      (1 << AMOTION_EVENT_ACTION_POINTER_INDEX_SHIFT),
+                              AINPUT_SOURCE_TOUCHSCREEN)
+                    .deviceId(DEVICE_ID)
+                    .pointer(finger(0, 100, 100))
+                    .pointer(finger(1, 300, 100))
+                    .build());
+    for (size_t i = 1; i <= MOVES_PER_GESTURE; i++) {
+        const float y = 100 + 10 * static_cast<float>(i);
+        gesture.push_back(MotionArgsBuilder(AMOTION_EVENT_ACTION_MOVE, AINPUT_SOURCE_TOUCHSCREEN)
+                                  .deviceId(DEVICE_ID)
+                                  .pointer(finger(0, 100, y))
+                                  .pointer(finger(1, 300, y))
+                                  .build());
+    }
+    const float lastY = 100 + 10 * static_cast<float>(MOVES_PER_GESTURE);
+    gesture.push_back(
+            MotionArgsBuilder(AMOTION_EVENT_ACTION_POINTER_UP |
+                                      (1 << AMOTION_EVENT_ACTION_POINTER_INDEX_SHIFT),
+                              AINPUT_SOURCE_TOUCHSCREEN)
+                    .deviceId(DEVICE_ID)
+                    .pointer(finger(0, 100, lastY))
+                    .pointer(finger(1, 300, lastY))
+                    .build());
+    gesture.push_back(MotionArgsBuilder(AMOTION_EVENT_ACTION_UP, AINPUT_SOURCE_TOUCHSCREEN)
+                              .deviceId(DEVICE_ID)
+                              .pointer(finger(0, 100, lastY))
+                              .build());
+    return gesture;
+}
+
+// Sends two-finger touch gestures through UnwantedInteractionBlocker. The difference between the
+// runs with and without palm rejection is the latency that palm rejection adds to every event.
+static void benchmarkNotifyTouchMotion(benchmark::State& state) {
+    const bool enablePalmRejection = state.range(0) != 0;
+    DiscardingListener listener;
+    UnwantedInteractionBlocker blocker(listener, enablePalmRejection);
+    blocker.notifyInputDevicesChanged({/*id=*/1, {createTouchscreenInfo()}});
+
+    std::vector<NotifyMotionArgs> gesture = createTwoFingerGesture();
+    nsecs_t eventTime = 0;
+    nsecs_t downTime = 0;
+    size_t index = 0;
+    for (auto _ : state) {
+        NotifyMotionArgs& args = gesture[index];
+        eventTime += TOUCH_REPORT_INTERVAL;
+        if (index == 0) {
+            downTime = eventTime;
+        }
+        args.downTime = downTime;
+        args.eventTime = eventTime;
+        blocker.notifyMotion(args);
+        index = (index + 1) % gesture.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+} // namespace
+
+BENCHMARK(benchmarkNotifyTouchMotion)->ArgName("palmRejection")->Arg(0)->Arg(1);
+
+} // namespace android
@@ -88,6 +88,22 @@ bool isInputTracingEnabled() {
     return input_flags::enable_input_event_tracing() && isUserdebugOrEng;
 }
 
+bool isSameDisplayInfo(
+        const std::unordered_map<ui::LogicalDisplayId, gui::DisplayInfo>& oldDisplayInfos,
+        const std::unordered_map<ui::LogicalDisplayId, gui::DisplayInfo>& newDisplayInfos,
+        ui::LogicalDisplayId displayId) {
+    const auto oldIt = oldDisplayInfos.find(displayId);
+    const auto newIt = newDisplayInfos.find(displayId);
+    if (oldIt == oldDisplayInfos.end() || newIt == newDisplayInfos.end()) {
+        return oldIt == oldDisplayInfos.end() && newIt == newDisplayInfos.end();
+    }
+    const gui::DisplayInfo& oldInfo = oldIt->second;
+    const gui::DisplayInfo& newInfo = newIt->second;
+    return oldInfo.logicalWidth == newInfo.logicalWidth &&
+            oldInfo.logicalHeight == newInfo.logicalHeight &&
+            oldInfo.transform == newInfo.transform;
+}
+
 // Create the input tracing backend that writes to perfetto from a single thread.
 std::unique_ptr<trace::InputTracingBackendInterface> createInputTracingBackendIfEnabled() {
     if (!isInputTracingEnabled()) {
@@ -153,7 +169,9 @@ constexpr nsecs_t SLOW_EVENT_PROCESSING_WARNING_TIMEOUT = 2000 * 1000000LL; // 2
 constexpr std::chrono::milliseconds SLOW_INTERCEPTION_THRESHOLD = 50ms;
 
 // Number of recent events to keep for debugging purposes.
-constexpr size_t RECENT_QUEUE_MAX_SIZE = 10;
+
+// The maximum number of events written to a connection with a single system call.
+constexpr size_t MAX_DISPATCH_CYCLE_BATCH_SIZE = 16;
 
 // Event log tags. See EventLogTags.logtags for reference.
 constexpr int LOGTAG_INPUT_INTERACTION = 62000;
@@ -465,7 +483,7 @@ std::unique_ptr<DispatchEntry> createDispatchEntry(const IdGenerator& idGenerato
                                           motionEntry.xPrecision, motionEntry.yPrecision,
                                           motionEntry.xCursorPosition, motionEntry.yCursorPosition,
                                           motionEntry.downTime, motionEntry.pointerProperties,
-                                          pointerCoords);
+                                          std::move(pointerCoords));
     if (tracer) {
         combinedMotionEntry->traceTracker =
                 tracer->traceDerivedEvent(*combinedMotionEntry, *motionEntry.traceTracker);
@@ -1419,14 +1437,8 @@ bool InputDispatcher::enqueueInboundEventLocked(std::unique_ptr<EventEntry> newE
     return needWake;
 }
 
-void InputDispatcher::addRecentEventLocked(std::shared_ptr<const EventEntry> entry) {
-    // Do not store sensor event in recent queue to avoid flooding the queue.
-    if (entry->type != EventEntry::Type::SENSOR) {
-        mRecentQueue.push_back(entry);
-    }
-    if (mRecentQueue.size() > RECENT_QUEUE_MAX_SIZE) {
-        mRecentQueue.pop_front();
-    }
+void InputDispatcher::addRecentEventLocked(const EventEntry& entry) {
+    mRecentEvents.add(entry);
 }
 
 sp<WindowInfoHandle> InputDispatcher::findTouchedWindowAtLocked(ui::LogicalDisplayId displayId,
@@ -1434,7 +1446,10 @@ sp<WindowInfoHandle> InputDispatcher::findTouchedWindowAtLocked(ui::LogicalDispl
                                                                 bool ignoreDragWindow) const {
     // Traverse windows from front to back to find touched window.
     const auto& windowHandles = getWindowHandlesLocked(displayId);
-    for (const sp<WindowInfoHandle>& windowHandle : windowHandles) {
+    const auto candidates = getTouchCandidatesLocked(displayId, x, y);
+    const size_t count = candidates ? candidates->size() : windowHandles.size();
+    for (size_t i = 0; i < count; i++) {
+        const sp<WindowInfoHandle>& windowHandle = windowHandles[candidates ? (*candidates)[i] : i];
         if (ignoreDragWindow && haveSameToken(windowHandle, mDragState->dragWindow)) {
             continue;
         }
@@ -1481,7 +1496,10 @@ std::vector<sp<WindowInfoHandle>> InputDispatcher::findTouchedSpyWindowsAtLocked
     // Traverse windows from front to back and gather the touched spy windows.
     std::vector<sp<WindowInfoHandle>> spyWindows;
     const auto& windowHandles = getWindowHandlesLocked(displayId);
-    for (const sp<WindowInfoHandle>& windowHandle : windowHandles) {
+    const auto candidates = getTouchCandidatesLocked(displayId, x, y);
+    const size_t count = candidates ? candidates->size() : windowHandles.size();
+    for (size_t i = 0; i < count; i++) {
+        const sp<WindowInfoHandle>& windowHandle = windowHandles[candidates ? (*candidates)[i] : i];
         const WindowInfo& info = *windowHandle->getInfo();
         if (!windowAcceptsTouchAt(info, displayId, x, y, isStylus, getTransformLocked(displayId))) {
             // Generally, we would skip any pointer that's outside of the window. However, if the
@@ -1636,7 +1654,7 @@ void InputDispatcher::releaseInboundEventLocked(std::shared_ptr<const EventEntry
     if (entry == mNextUnblockedEvent) {
         mNextUnblockedEvent = nullptr;
     }
-    addRecentEventLocked(entry);
+    addRecentEventLocked(*entry);
 }
 
 void InputDispatcher::resetKeyRepeatLocked() {
@@ -2246,7 +2264,7 @@ ui::LogicalDisplayId InputDispatcher::getTargetDisplayId(const EventEntry& entry
 }
 
 bool InputDispatcher::shouldWaitToSendKeyLocked(nsecs_t currentTime,
-                                                const char* focusedWindowName) {
+                                                const WindowInfoHandle& focusedWindow) {
     if (mAnrTracker.empty()) {
         // already processed all events that we waited for
         mKeyIsWaitingForEventsTimeout = std::nullopt;
@@ -2271,7 +2289,7 @@ bool InputDispatcher::shouldWaitToSendKeyLocked(nsecs_t currentTime,
     // Waited too long, and some connection still hasn't processed all motions
     // Just send the key to the focused window
     ALOGW("Dispatching key to %s even though there are other unprocessed events",
-          focusedWindowName);
+          focusedWindow.getName().c_str());
     mKeyIsWaitingForEventsTimeout = std::nullopt;
     return false;
 }
@@ -2354,7 +2372,7 @@ InputDispatcher::findFocusedWindowTargetLocked(nsecs_t currentTime, const EventE
     // To obtain this behavior, we must serialize key events with respect to all
     // prior input events.
     if (entry.type == EventEntry::Type::KEY) {
-        if (shouldWaitToSendKeyLocked(currentTime, focusedWindowHandle->getName().c_str())) {
+        if (shouldWaitToSendKeyLocked(currentTime, *focusedWindowHandle)) {
             nextWakeupTime = std::min(nextWakeupTime, *mKeyIsWaitingForEventsTimeout);
             return injectionError(InputEventInjectionResult::PENDING);
         }
@@ -3146,7 +3164,10 @@ InputDispatcher::TouchOcclusionInfo InputDispatcher::computeTouchOcclusionInfoLo
     info.obscuringOpacity = 0;
     info.obscuringUid = gui::Uid::INVALID;
     std::map<gui::Uid, float> opacityByUid;
-    for (const sp<WindowInfoHandle>& otherHandle : windowHandles) {
+    const auto candidates = getOcclusionCandidatesLocked(windowHandle, x, y);
+    const size_t count = candidates ? candidates->size() : windowHandles.size();
+    for (size_t i = 0; i < count; i++) {
+        const sp<WindowInfoHandle>& otherHandle = windowHandles[candidates ? (*candidates)[i] : i];
         if (windowHandle == otherHandle) {
             break; // All future windows are below us. Exit early.
         }
@@ -3225,7 +3246,10 @@ bool InputDispatcher::isWindowObscuredAtPointLocked(const sp<WindowInfoHandle>&
                                                     float x, float y) const {
     ui::LogicalDisplayId displayId = windowHandle->getInfo()->displayId;
     const std::vector<sp<WindowInfoHandle>>& windowHandles = getWindowHandlesLocked(displayId);
-    for (const sp<WindowInfoHandle>& otherHandle : windowHandles) {
+    const auto candidates = getOcclusionCandidatesLocked(windowHandle, x, y);
+    const size_t count = candidates ? candidates->size() : windowHandles.size();
+    for (size_t i = 0; i < count; i++) {
+        const sp<WindowInfoHandle>& otherHandle = windowHandles[candidates ? (*candidates)[i] : i];
         if (windowHandle == otherHandle) {
             break; // All future windows are below us. Exit early.
         }
@@ -3791,100 +3815,135 @@ void InputDispatcher::startDispatchCycleLocked(nsecs_t currentTime,
     }
 
     while (connection->status == Connection::Status::NORMAL && !connection->outboundQueue.empty()) {
-        std::unique_ptr<DispatchEntry>& dispatchEntry = connection->outboundQueue.front();
-        dispatchEntry->deliveryTime = currentTime;
-        const std::chrono::nanoseconds timeout = getDispatchingTimeoutLocked(connection);
-        dispatchEntry->timeoutTime = currentTime + timeout.count();
-
-        // Publish the event.
-        status_t status;
-        const EventEntry& eventEntry = *(dispatchEntry->eventEntry);
-        switch (eventEntry.type) {
-            case EventEntry::Type::KEY: {
-                const KeyEntry& keyEntry = static_cast<const KeyEntry&>(eventEntry);
-                std::array<uint8_t, 32> hmac = getSignature(keyEntry, *dispatchEntry);
-                if (DEBUG_OUTBOUND_EVENT_DETAILS) {
-                    LOG(INFO) << "Publishing " << *dispatchEntry << " to "
-                              << connection->getInputChannelName();
-                }
+        // Write several queued events with a single system call when the app has fallen behind.
+        const size_t batchSize = input_flags::batch_dispatch_cycle_writes()
+                ? std::min(connection->outboundQueue.size(), MAX_DISPATCH_CYCLE_BATCH_SIZE)
+                : 1;
+        if (batchSize > 1) {
+            connection->inputPublisher.beginBatch();
+        }
 
-                // Publish the key event.
-                status = connection->inputPublisher
-                                 .publishKeyEvent(dispatchEntry->seq, keyEntry.id,
-                                                  keyEntry.deviceId, keyEntry.source,
-                                                  keyEntry.displayId, std::move(hmac),
-                                                  keyEntry.action, dispatchEntry->resolvedFlags,
-                                                  keyEntry.keyCode, keyEntry.scanCode,
-                                                  keyEntry.metaState, keyEntry.repeatCount,
-                                                  keyEntry.downTime, keyEntry.eventTime);
-                if (mTracer) {
-                    ensureEventTraced(keyEntry);
-                    mTracer->traceEventDispatch(*dispatchEntry, *keyEntry.traceTracker);
+        status_t status = OK;
+        size_t publishedCount = 0;
+        for (; publishedCount < batchSize; publishedCount++) {
+            std::unique_ptr<DispatchEntry>& dispatchEntry =
+                    connection->outboundQueue[publishedCount];
+            dispatchEntry->deliveryTime = currentTime;
+            const std::chrono::nanoseconds timeout = getDispatchingTimeoutLocked(connection);
+            dispatchEntry->timeoutTime = currentTime + timeout.count();
+
+            // Publish the event.
+            const EventEntry& eventEntry = *(dispatchEntry->eventEntry);
+            switch (eventEntry.type) {
+                case EventEntry::Type::KEY: {
+                    const KeyEntry& keyEntry = static_cast<const KeyEntry&>(eventEntry);
+                    std::array<uint8_t, 32> hmac = getSignature(keyEntry, *dispatchEntry);
+                    if (DEBUG_OUTBOUND_EVENT_DETAILS) {
+                        LOG(INFO) << "Publishing " << *dispatchEntry << " to "
+                                  << connection->getInputChannelName();
+                    }
+
+                    // Publish the key event.
+                    status = connection->inputPublisher
+                                     .publishKeyEvent(dispatchEntry->seq, keyEntry.id,
+                                                      keyEntry.deviceId, keyEntry.source,
+                                                      keyEntry.displayId, std::move(hmac),
+                                                      keyEntry.action, dispatchEntry->resolvedFlags,
+                                                      keyEntry.keyCode, keyEntry.scanCode,
+                                                      keyEntry.metaState, keyEntry.repeatCount,
+                                                      keyEntry.downTime, keyEntry.eventTime);
+                    if (mTracer) {
+                        ensureEventTraced(keyEntry);
+                        mTracer->traceEventDispatch(*dispatchEntry, *keyEntry.traceTracker);
+                    }
+                    break;
                 }
-                break;
-            }
 
-            case EventEntry::Type::MOTION: {
-                if (DEBUG_OUTBOUND_EVENT_DETAILS) {
-                    LOG(INFO) << "Publishing " << *dispatchEntry << " to "
-                              << connection->getInputChannelName();
+                case EventEntry::Type::MOTION: {
+                    if (DEBUG_OUTBOUND_EVENT_DETAILS) {
+                        LOG(INFO) << "Publishing " << *dispatchEntry << " to "
+                                  << connection->getInputChannelName();
+                    }
+                    const MotionEntry& motionEntry = static_cast<const MotionEntry&>(eventEntry);
+                    status = publishMotionEvent(*connection, *dispatchEntry);
+                    if (status == BAD_VALUE) {
+                        logDispatchStateLocked();
+                        LOG(FATAL) << "Publisher failed for " << motionEntry;
+                    }
+                    if (mTracer) {
+                        ensureEventTraced(motionEntry);
+                        mTracer->traceEventDispatch(*dispatchEntry, *motionEntry.traceTracker);
+                    }
+                    break;
                 }
-                const MotionEntry& motionEntry = static_cast<const MotionEntry&>(eventEntry);
-                status = publishMotionEvent(*connection, *dispatchEntry);
-                if (status == BAD_VALUE) {
-                    logDispatchStateLocked();
-                    LOG(FATAL) << "Publisher failed for " << motionEntry;
+
+                case EventEntry::Type::FOCUS: {
+                    const FocusEntry& focusEntry = static_cast<const FocusEntry&>(eventEntry);
+                    status = connection->inputPublisher.publishFocusEvent(dispatchEntry->seq,
+                                                                          focusEntry.id,
+                                                                          focusEntry.hasFocus);
+                    break;
                 }
-                if (mTracer) {
-                    ensureEventTraced(motionEntry);
-                    mTracer->traceEventDispatch(*dispatchEntry, *motionEntry.traceTracker);
+
+                case EventEntry::Type::TOUCH_MODE_CHANGED: {
+                    const TouchModeEntry& touchModeEntry =
+                            static_cast<const TouchModeEntry&>(eventEntry);
+                    status = connection->inputPublisher
+                                     .publishTouchModeEvent(dispatchEntry->seq, touchModeEntry.id,
+                                                            touchModeEntry.inTouchMode);
+
+                    break;
                 }
-                break;
-            }
 
-            case EventEntry::Type::FOCUS: {
-                const FocusEntry& focusEntry = static_cast<const FocusEntry&>(eventEntry);
-                status = connection->inputPublisher.publishFocusEvent(dispatchEntry->seq,
-                                                                      focusEntry.id,
-                                                                      focusEntry.hasFocus);
-                break;
-            }
+                case EventEntry::Type::POINTER_CAPTURE_CHANGED: {
+                    const auto& captureEntry =
+                            static_cast<const PointerCaptureChangedEntry&>(eventEntry);
+                    status =
+                            connection->inputPublisher
+                                    .publishCaptureEvent(dispatchEntry->seq, captureEntry.id,
+                                                         captureEntry.pointerCaptureRequest.isEnable());
+                    break;
+                }
 
-            case EventEntry::Type::TOUCH_MODE_CHANGED: {
-                const TouchModeEntry& touchModeEntry =
-                        static_cast<const TouchModeEntry&>(eventEntry);
-                status = connection->inputPublisher
-                                 .publishTouchModeEvent(dispatchEntry->seq, touchModeEntry.id,
-                                                        touchModeEntry.inTouchMode);
+                case EventEntry::Type::DRAG: {
+                    const DragEntry& dragEntry = static_cast<const DragEntry&>(eventEntry);
+                    status = connection->inputPublisher.publishDragEvent(dispatchEntry->seq,
+                                                                         dragEntry.id, dragEntry.x,
+                                                                         dragEntry.y,
+                                                                         dragEntry.isExiting);
+                    break;
+                }
 
-                break;
+                case EventEntry::Type::DEVICE_RESET:
+                case EventEntry::Type::SENSOR: {
+                    LOG_ALWAYS_FATAL("Should never start dispatch cycles for %s events",
+                                     ftl::enum_string(eventEntry.type).c_str());
+                    return;
+                }
             }
-
-            case EventEntry::Type::POINTER_CAPTURE_CHANGED: {
-                const auto& captureEntry =
-                        static_cast<const PointerCaptureChangedEntry&>(eventEntry);
-                status =
-                        connection->inputPublisher
-                                .publishCaptureEvent(dispatchEntry->seq, captureEntry.id,
-                                                     captureEntry.pointerCaptureRequest.isEnable());
+            if (status) {
                 break;
             }
-
-            case EventEntry::Type::DRAG: {
-                const DragEntry& dragEntry = static_cast<const DragEntry&>(eventEntry);
-                status = connection->inputPublisher.publishDragEvent(dispatchEntry->seq,
-                                                                     dragEntry.id, dragEntry.x,
-                                                                     dragEntry.y,
-                                                                     dragEntry.isExiting);
-                break;
+        }
+        if (batchSize > 1) {
+            // Only the events that were written can move on, the rest are published again later.
+            const status_t writeStatus = connection->inputPublisher.endBatch(&publishedCount);
+            if (writeStatus) {
+                status = writeStatus;
             }
+        }
 
-            case EventEntry::Type::DEVICE_RESET:
-            case EventEntry::Type::SENSOR: {
-                LOG_ALWAYS_FATAL("Should never start dispatch cycles for %s events",
-                                 ftl::enum_string(eventEntry.type).c_str());
-                return;
+        // Re-enqueue the published events on the wait queue.
+        for (size_t i = 0; i < publishedCount; i++) {
+            std::unique_ptr<DispatchEntry>& dispatchEntry = connection->outboundQueue.front();
+            const nsecs_t timeoutTime = dispatchEntry->timeoutTime;
+            connection->waitQueue.emplace_back(std::move(dispatchEntry));
+            connection->outboundQueue.erase(connection->outboundQueue.begin());
+            traceOutboundQueueLength(*connection);
+            if (connection->responsive) {
+                mAnrTracker.insert(timeoutTime, connection->getToken());
             }
+            traceWaitQueueLength(*connection);
         }
 
         // Check the result.
@@ -3916,16 +3975,6 @@ void InputDispatcher::startDispatchCycleLocked(nsecs_t currentTime,
             }
             return;
         }
-
-        // Re-enqueue the event on the wait queue.
-        const nsecs_t timeoutTime = dispatchEntry->timeoutTime;
-        connection->waitQueue.emplace_back(std::move(dispatchEntry));
-        connection->outboundQueue.erase(connection->outboundQueue.begin());
-        traceOutboundQueueLength(*connection);
-        if (connection->responsive) {
-            mAnrTracker.insert(timeoutTime, connection->getToken());
-        }
-        traceWaitQueueLength(*connection);
     }
 }
 
@@ -4382,7 +4431,7 @@ void InputDispatcher::synthesizePointerDownEventsForConnectionLocked(
 std::unique_ptr<MotionEntry> InputDispatcher::splitMotionEvent(
         const MotionEntry& originalMotionEntry, std::bitset<MAX_POINTER_ID + 1> pointerIds,
         nsecs_t splitDownTime) {
-    const auto& [action, pointerProperties, pointerCoords] =
+    auto [action, pointerProperties, pointerCoords] =
             MotionEvent::split(originalMotionEntry.action, originalMotionEntry.flags,
                                /*historySize=*/0, originalMotionEntry.pointerProperties,
                                originalMotionEntry.pointerCoords, pointerIds);
@@ -4430,7 +4479,7 @@ std::unique_ptr<MotionEntry> InputDispatcher::splitMotionEvent(
                                           originalMotionEntry.yPrecision,
                                           originalMotionEntry.xCursorPosition,
                                           originalMotionEntry.yCursorPosition, splitDownTime,
-                                          pointerProperties, pointerCoords);
+                                          std::move(pointerProperties), std::move(pointerCoords));
     if (mTracer) {
         splitMotionEntry->traceTracker =
                 mTracer->traceDerivedEvent(*splitMotionEntry, *originalMotionEntry.traceTracker);
@@ -5198,8 +5247,14 @@ sp<WindowInfoHandle> InputDispatcher::getWindowHandleLocked(
 
 sp<WindowInfoHandle> InputDispatcher::getFocusedWindowHandleLocked(
         ui::LogicalDisplayId displayId) const {
+    if (const auto it = mFocusedWindowHandleCache.find(displayId);
+        it != mFocusedWindowHandleCache.end()) {
+        return it->second;
+    }
     sp<IBinder> focusedToken = mFocusResolver.getFocusedWindowToken(displayId);
-    return getWindowHandleLocked(focusedToken, displayId);
+    sp<WindowInfoHandle> focusedWindowHandle = getWindowHandleLocked(focusedToken, displayId);
+    mFocusedWindowHandleCache.emplace(displayId, focusedWindowHandle);
+    return focusedWindowHandle;
 }
 
 ui::Transform InputDispatcher::getTransformLocked(ui::LogicalDisplayId displayId) const {
@@ -5208,6 +5263,30 @@ ui::Transform InputDispatcher::getTransformLocked(ui::LogicalDisplayId displayId
                                                 : kIdentityTransform;
 }
 
+std::optional<std::vector<size_t>> InputDispatcher::getTouchCandidatesLocked(
+        ui::LogicalDisplayId displayId, float x, float y) const {
+    const auto it = mWindowHitIndexByDisplay.find(displayId);
+    if (it == mWindowHitIndexByDisplay.end()) {
+        return std::nullopt;
+    }
+    return it->second.getTouchCandidatesAt(x, y);
+}
+
+std::optional<std::vector<size_t>> InputDispatcher::getOcclusionCandidatesLocked(
+        const sp<WindowInfoHandle>& windowHandle, float x, float y) const {
+    const auto it = mWindowHitIndexByDisplay.find(windowHandle->getInfo()->displayId);
+    if (it == mWindowHitIndexByDisplay.end()) {
+        return std::nullopt;
+    }
+    std::vector<size_t> candidates = it->second.getOcclusionCandidatesAt(x, y);
+    // Windows are ordered front to back, so only those before this window can occlude it.
+    if (const auto index = it->second.indexOf(windowHandle)) {
+        candidates.erase(std::lower_bound(candidates.begin(), candidates.end(), *index),
+                         candidates.end());
+    }
+    return candidates;
+}
+
 bool InputDispatcher::canWindowReceiveMotionLocked(const sp<WindowInfoHandle>& window,
                                                    const MotionEntry& motionEntry) const {
     const WindowInfo& info = *window->getInfo();
@@ -5270,12 +5349,28 @@ bool InputDispatcher::canWindowReceiveMotionLocked(const sp<WindowInfoHandle>& w
     return true;
 }
 
+bool InputDispatcher::hasSameInputWindowsLocked(
+        const std::vector<sp<WindowInfoHandle>>& windowInfoHandles,
+        ui::LogicalDisplayId displayId) const {
+    const std::vector<sp<WindowInfoHandle>>& oldHandles = getWindowHandlesLocked(displayId);
+    return std::equal(oldHandles.begin(), oldHandles.end(), windowInfoHandles.begin(),
+                      windowInfoHandles.end(),
+                      [this](const sp<WindowInfoHandle>& oldHandle,
+                             const sp<WindowInfoHandle>& newHandle) REQUIRES(mLock) {
+                          // A window whose channel was removed would now be dropped.
+                          return *oldHandle->getInfo() == *newHandle->getInfo() &&
+                                  (oldHandle->getToken() == nullptr ||
+                                   getConnectionLocked(oldHandle->getToken()) != nullptr);
+                      });
+}
+
 void InputDispatcher::updateWindowHandlesForDisplayLocked(
         const std::vector<sp<WindowInfoHandle>>& windowInfoHandles,
         ui::LogicalDisplayId displayId) {
     if (windowInfoHandles.empty()) {
         // Remove all handles on a display if there are no windows left.
         mWindowHandlesByDisplay.erase(displayId);
+        mWindowHitIndexByDisplay.erase(displayId);
         return;
     }
 
@@ -5322,6 +5417,19 @@ void InputDispatcher::updateWindowHandlesForDisplayLocked(
 
     // Insert or replace
     mWindowHandlesByDisplay[displayId] = newHandles;
+
+    if (input_flags::dispatcher_window_hit_index()) {
+        Rect displayBounds = Rect::EMPTY_RECT;
+        if (const auto it = mDisplayInfos.find(displayId); it != mDisplayInfos.end()) {
+            displayBounds = Rect(it->second.logicalWidth, it->second.logicalHeight);
+        }
+        mWindowHitIndexByDisplay.insert_or_assign(displayId,
+                                                  WindowHitIndex(newHandles,
+                                                                 getTransformLocked(displayId),
+                                                                 displayBounds));
+    } else {
+        mWindowHitIndexByDisplay.erase(displayId);
+    }
 }
 
 /**
@@ -5380,6 +5488,7 @@ void InputDispatcher::setInputWindowsLocked(
 
     std::optional<FocusResolver::FocusChanges> changes =
             mFocusResolver.setInputWindows(displayId, windowHandles);
+    mFocusedWindowHandleCache.erase(displayId);
     if (changes) {
         onFocusChangedLocked(*changes, traceContext.getTracker(), removedFocusedWindowHandle);
     }
@@ -6003,13 +6112,9 @@ void InputDispatcher::dumpDispatchStateLocked(std::string& dump) const {
     const nsecs_t currentTime = now();
 
     // Dump recently dispatched or dropped events from oldest to newest.
-    if (!mRecentQueue.empty()) {
-        dump += StringPrintf(INDENT "RecentQueue: length=%zu\n", mRecentQueue.size());
-        for (const std::shared_ptr<const EventEntry>& entry : mRecentQueue) {
-            dump += INDENT2;
-            dump += entry->getDescription();
-            dump += StringPrintf(", age=%" PRId64 "ms\n", ns2ms(currentTime - entry->eventTime));
-        }
+    if (!mRecentEvents.empty()) {
+        dump += StringPrintf(INDENT "RecentQueue: length=%zu\n", mRecentEvents.size());
+        dump += mRecentEvents.dump(INDENT2, currentTime);
     } else {
         dump += INDENT "RecentQueue: <empty>\n";
     }
@@ -6936,6 +7041,7 @@ void InputDispatcher::setFocusedWindow(const FocusRequest& request) {
                 mFocusResolver.setFocusedWindow(request,
                                                 getWindowHandlesLocked(
                                                         ui::LogicalDisplayId{request.displayId}));
+        mFocusedWindowHandleCache.erase(ui::LogicalDisplayId{request.displayId});
         ScopedSyntheticEventTracer traceContext(mTracer);
         if (changes) {
             onFocusChangedLocked(*changes, traceContext.getTracker());
@@ -7028,6 +7134,7 @@ void InputDispatcher::displayRemoved(ui::LogicalDisplayId displayId) {
         // Call focus resolver to clean up stale requests. This must be called after input windows
         // have been removed for the removed display.
         mFocusResolver.displayRemoved(displayId);
+        mFocusedWindowHandleCache.erase(displayId);
         // Reset pointer capture eligibility, regardless of previous state.
         std::erase(mIneligibleDisplaysForPointerCapture, displayId);
         // Remove the associated touch mode state.
@@ -7074,12 +7181,20 @@ void InputDispatcher::onWindowInfosChanged(const gui::WindowInfosUpdate& update)
             handlesPerDisplay[displayId];
         }
 
+        const std::unordered_map<ui::LogicalDisplayId, gui::DisplayInfo> oldDisplayInfos =
+                std::move(mDisplayInfos);
         mDisplayInfos.clear();
         for (const auto& displayInfo : update.displayInfos) {
             mDisplayInfos.emplace(displayInfo.displayId, displayInfo);
         }
 
         for (const auto& [displayId, handles] : handlesPerDisplay) {
+            // Most updates only change the windows of one display. Leave the other displays alone,
+            // so that the time spent holding the lock doesn't grow with the number of displays.
+            if (isSameDisplayInfo(oldDisplayInfos, mDisplayInfos, displayId) &&
+                hasSameInputWindowsLocked(handles, displayId)) {
+                continue;
+            }
             setInputWindowsLocked(handles, displayId);
         }
 
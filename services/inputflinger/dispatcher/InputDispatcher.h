@@ -30,8 +30,10 @@
 #include "LatencyAggregator.h"
 #include "LatencyTracker.h"
 #include "Monitor.h"
+#include "RecentEventHistory.h"
 #include "TouchState.h"
 #include "TouchedWindow.h"
+#include "WindowHitIndex.h"
 #include "trace/InputTracerInterface.h"
 #include "trace/InputTracingBackendInterface.h"
 
@@ -188,7 +190,7 @@ private:
 
     std::shared_ptr<const EventEntry> mPendingEvent GUARDED_BY(mLock);
     std::deque<std::shared_ptr<const EventEntry>> mInboundQueue GUARDED_BY(mLock);
-    std::deque<std::shared_ptr<const EventEntry>> mRecentQueue GUARDED_BY(mLock);
+    RecentEventHistory mRecentEvents GUARDED_BY(mLock);
 
     // A command entry captures state and behavior for an action to be performed in the
     // dispatch loop after the initial processing has taken place.  It is essentially
@@ -243,7 +245,7 @@ private:
             REQUIRES(mLock);
 
     // Adds an event to a queue of recent events for debugging purposes.
-    void addRecentEventLocked(std::shared_ptr<const EventEntry> entry) REQUIRES(mLock);
+    void addRecentEventLocked(const EventEntry& entry) REQUIRES(mLock);
 
     // Blocked event latency optimization.  Drops old events when the user intends
     // to transfer focus to a new application.
@@ -365,13 +367,30 @@ private:
             mWindowHandlesByDisplay GUARDED_BY(mLock);
     std::unordered_map<ui::LogicalDisplayId /*displayId*/, android::gui::DisplayInfo> mDisplayInfos
             GUARDED_BY(mLock);
+    // Rebuilt together with mWindowHandlesByDisplay, so that indices match its window handles.
+    std::unordered_map<ui::LogicalDisplayId /*displayId*/, WindowHitIndex> mWindowHitIndexByDisplay
+            GUARDED_BY(mLock);
     void setInputWindowsLocked(
             const std::vector<sp<android::gui::WindowInfoHandle>>& inputWindowHandles,
             ui::LogicalDisplayId displayId) REQUIRES(mLock);
+    // Whether the windows of a display would be left as they are by setInputWindowsLocked.
+    bool hasSameInputWindowsLocked(
+            const std::vector<sp<android::gui::WindowInfoHandle>>& inputWindowHandles,
+            ui::LogicalDisplayId displayId) const REQUIRES(mLock);
     // Get a reference to window handles by display, return an empty vector if not found.
     const std::vector<sp<android::gui::WindowInfoHandle>>& getWindowHandlesLocked(
             ui::LogicalDisplayId displayId) const REQUIRES(mLock);
     ui::Transform getTransformLocked(ui::LogicalDisplayId displayId) const REQUIRES(mLock);
+    // Indices of the window handles on the display that may accept a touch at the given location.
+    // Returns std::nullopt if every window must be checked.
+    std::optional<std::vector<size_t>> getTouchCandidatesLocked(ui::LogicalDisplayId displayId,
+                                                                float x, float y) const
+            REQUIRES(mLock);
+    // Indices of the window handles above the given window whose frame may occlude a touch at the
+    // given location. Returns std::nullopt if every window must be checked.
+    std::optional<std::vector<size_t>> getOcclusionCandidatesLocked(
+            const sp<android::gui::WindowInfoHandle>& windowHandle, float x, float y) const
+            REQUIRES(mLock);
 
     sp<android::gui::WindowInfoHandle> getWindowHandleLocked(
             const sp<IBinder>& windowHandleToken,
@@ -412,6 +431,11 @@ private:
 
     // Keeps track of the focused window per display and determines focus changes.
     FocusResolver mFocusResolver GUARDED_BY(mLock);
+    // The handles found by getFocusedWindowHandleLocked, so that a burst of key events doesn't
+    // search the windows of the display for every key. An entry must be erased whenever the focus
+    // or the windows of its display change.
+    mutable std::unordered_map<ui::LogicalDisplayId, sp<android::gui::WindowInfoHandle>>
+            mFocusedWindowHandleCache GUARDED_BY(mLock);
 
     // The enabled state of this request is true iff the focused window on the focused display has
     // requested Pointer Capture. This request also contains the sequence number associated with the
@@ -488,7 +512,8 @@ private:
      * without waiting on other events to be processed first.
      */
     std::optional<nsecs_t> mKeyIsWaitingForEventsTimeout GUARDED_BY(mLock);
-    bool shouldWaitToSendKeyLocked(nsecs_t currentTime, const char* focusedWindowName)
+    bool shouldWaitToSendKeyLocked(nsecs_t currentTime,
+                                   const android::gui::WindowInfoHandle& focusedWindow)
             REQUIRES(mLock);
 
     /**
@@ -18,8 +18,6 @@
 #include "LatencyTracker.h"
 #include "../InputDeviceMetricsSource.h"
 
-#include <inttypes.h>
-
 #include <android-base/properties.h>
 #include <android-base/stringprintf.h>
 #include <android/os/IInputConstants.h>
@@ -47,23 +45,14 @@ static bool isMatureEvent(nsecs_t eventTime, nsecs_t now) {
     return age > ANR_TIMEOUT;
 }
 
-/**
- * A multimap allows to have several entries with the same key. This function just erases a specific
- * key-value pair. Equivalent to the imaginary std api std::multimap::erase(key, value).
- */
-template <typename K, typename V>
-static void eraseByValue(std::multimap<K, V>& map, const V& value) {
-    for (auto it = map.begin(); it != map.end();) {
-        if (it->second == value) {
-            it = map.erase(it);
-        } else {
-            it++;
-        }
-    }
+static size_t homePosition(int32_t inputEventId, size_t indexSize) {
+    return static_cast<uint32_t>(inputEventId) & (indexSize - 1);
 }
 
 LatencyTracker::LatencyTracker(InputEventTimelineProcessor* processor)
-      : mTimelineProcessor(processor) {
+      : mTimelines(MAX_TRACKED_EVENTS),
+        mIndex(INDEX_SIZE, IndexEntry{.inputEventId = 0, .slot = EMPTY_SLOT}),
+        mTimelineProcessor(processor) {
     LOG_ALWAYS_FATAL_IF(processor == nullptr);
 }
 
@@ -72,14 +61,15 @@ void LatencyTracker::trackListener(int32_t inputEventId, nsecs_t eventTime, nsec
                                    const std::set<InputDeviceUsageSource>& sources,
                                    int32_t inputEventAction, InputEventType inputEventType) {
     reportAndPruneMatureRecords(eventTime);
-    const auto it = mTimelines.find(inputEventId);
-    if (it != mTimelines.end()) {
+    const size_t indexPosition = findIndexPosition(inputEventId);
+    if (mIndex[indexPosition].slot != EMPTY_SLOT) {
         // Input event ids are randomly generated, so it's possible that two events have the same
         // event id. Drop this event, and also drop the existing event because the apps would
         // confuse us by reporting the rest of the timeline for one of them. This should happen
         // rarely, so we won't lose much data
-        mTimelines.erase(it);
-        eraseByValue(mEventTimes, inputEventId);
+        mTimelines[mIndex[indexPosition].slot].timeline.reset();
+        mTrackedEventCount--;
+        eraseIndexEntry(indexPosition);
         return;
     }
 
@@ -134,30 +124,37 @@ void LatencyTracker::trackListener(int32_t inputEventId, nsecs_t eventTime, nsec
         }
     }();
 
-    mTimelines.emplace(inputEventId,
-                       InputEventTimeline(eventTime, readTime, identifier->vendor,
-                                          identifier->product, sources, inputEventActionType));
-    mEventTimes.emplace(eventTime, inputEventId);
+    if (mUsedSlotCount == MAX_TRACKED_EVENTS) {
+        reportAndPopOldestSlot();
+    }
+    const size_t slot = (mOldestSlot + mUsedSlotCount) % MAX_TRACKED_EVENTS;
+    mTimelines[slot].inputEventId = inputEventId;
+    mTimelines[slot].timeline.emplace(eventTime, readTime, identifier->vendor, identifier->product,
+                                      sources, inputEventActionType);
+    mUsedSlotCount++;
+    mTrackedEventCount++;
+    // Popping the oldest slot may have moved the entries of the index around.
+    mIndex[findIndexPosition(inputEventId)] = {.inputEventId = inputEventId,
+                                               .slot = static_cast<int32_t>(slot)};
 }
 
 void LatencyTracker::trackFinishedEvent(int32_t inputEventId, const sp<IBinder>& connectionToken,
                                         nsecs_t deliveryTime, nsecs_t consumeTime,
                                         nsecs_t finishTime) {
-    const auto it = mTimelines.find(inputEventId);
-    if (it == mTimelines.end()) {
+    InputEventTimeline* timeline = findTimeline(inputEventId);
+    if (timeline == nullptr) {
         // This could happen if we erased this event when duplicate events were detected. It's
         // also possible that an app sent a bad (or late) 'Finish' signal, since it's free to do
         // anything in its process. Just drop the report and move on.
         return;
     }
 
-    InputEventTimeline& timeline = it->second;
-    const auto connectionIt = timeline.connectionTimelines.find(connectionToken);
-    if (connectionIt == timeline.connectionTimelines.end()) {
+    const auto connectionIt = timeline->connectionTimelines.find(connectionToken);
+    if (connectionIt == timeline->connectionTimelines.end()) {
         // Most likely case: app calls 'finishInputEvent' before it reports the graphics timeline
-        timeline.connectionTimelines.emplace(connectionToken,
-                                             ConnectionTimeline{deliveryTime, consumeTime,
-                                                                finishTime});
+        timeline->connectionTimelines.emplace(connectionToken,
+                                              ConnectionTimeline{deliveryTime, consumeTime,
+                                                                 finishTime});
     } else {
         // Already have a record for this connectionToken
         ConnectionTimeline& connectionTimeline = connectionIt->second;
@@ -166,7 +163,7 @@ void LatencyTracker::trackFinishedEvent(int32_t inputEventId, const sp<IBinder>&
         if (!success) {
             // We are receiving unreliable data from the app. Just delete the entire connection
             // timeline for this event
-            timeline.connectionTimelines.erase(connectionIt);
+            timeline->connectionTimelines.erase(connectionIt);
         }
     }
 }
@@ -174,18 +171,17 @@ void LatencyTracker::trackFinishedEvent(int32_t inputEventId, const sp<IBinder>&
 void LatencyTracker::trackGraphicsLatency(
         int32_t inputEventId, const sp<IBinder>& connectionToken,
         std::array<nsecs_t, GraphicsTimeline::SIZE> graphicsTimeline) {
-    const auto it = mTimelines.find(inputEventId);
-    if (it == mTimelines.end()) {
+    InputEventTimeline* timeline = findTimeline(inputEventId);
+    if (timeline == nullptr) {
         // This could happen if we erased this event when duplicate events were detected. It's
         // also possible that an app sent a bad (or late) 'Timeline' signal, since it's free to do
         // anything in its process. Just drop the report and move on.
         return;
     }
 
-    InputEventTimeline& timeline = it->second;
-    const auto connectionIt = timeline.connectionTimelines.find(connectionToken);
-    if (connectionIt == timeline.connectionTimelines.end()) {
-        timeline.connectionTimelines.emplace(connectionToken, std::move(graphicsTimeline));
+    const auto connectionIt = timeline->connectionTimelines.find(connectionToken);
+    if (connectionIt == timeline->connectionTimelines.end()) {
+        timeline->connectionTimelines.emplace(connectionToken, std::move(graphicsTimeline));
     } else {
         // Most likely case
         ConnectionTimeline& connectionTimeline = connectionIt->second;
@@ -193,7 +189,7 @@ void LatencyTracker::trackGraphicsLatency(
         if (!success) {
             // We are receiving unreliable data from the app. Just delete the entire connection
             // timeline for this event
-            timeline.connectionTimelines.erase(connectionIt);
+            timeline->connectionTimelines.erase(connectionIt);
         }
     }
 }
@@ -204,29 +200,67 @@ void LatencyTracker::trackGraphicsLatency(
  * 'trackListener' should happen soon after the event occurs.
  */
 void LatencyTracker::reportAndPruneMatureRecords(nsecs_t newEventTime) {
-    while (!mEventTimes.empty()) {
-        const auto& [oldestEventTime, oldestInputEventId] = *mEventTimes.begin();
-        if (isMatureEvent(oldestEventTime, /*now=*/newEventTime)) {
-            // Report and drop this event
-            const auto it = mTimelines.find(oldestInputEventId);
-            LOG_ALWAYS_FATAL_IF(it == mTimelines.end(),
-                                "Event %" PRId32 " is in mEventTimes, but not in mTimelines",
-                                oldestInputEventId);
-            const InputEventTimeline& timeline = it->second;
-            mTimelineProcessor->processTimeline(timeline);
-            mTimelines.erase(it);
-            mEventTimes.erase(mEventTimes.begin());
-        } else {
+    while (mUsedSlotCount != 0) {
+        const std::optional<InputEventTimeline>& oldest = mTimelines[mOldestSlot].timeline;
+        if (oldest && !isMatureEvent(oldest->eventTime, /*now=*/newEventTime)) {
             // If the oldest event does not need to be pruned, no events should be pruned.
             return;
         }
+        reportAndPopOldestSlot();
+    }
+}
+
+void LatencyTracker::reportAndPopOldestSlot() {
+    Slot& oldest = mTimelines[mOldestSlot];
+    if (oldest.timeline) {
+        const size_t indexPosition = findIndexPosition(oldest.inputEventId);
+        mTimelineProcessor->processTimeline(*oldest.timeline);
+        oldest.timeline.reset();
+        mTrackedEventCount--;
+        eraseIndexEntry(indexPosition);
+    }
+    mOldestSlot = (mOldestSlot + 1) % MAX_TRACKED_EVENTS;
+    mUsedSlotCount--;
+}
+
+InputEventTimeline* LatencyTracker::findTimeline(int32_t inputEventId) {
+    const int32_t slot = mIndex[findIndexPosition(inputEventId)].slot;
+    return slot == EMPTY_SLOT ? nullptr : &*mTimelines[slot].timeline;
+}
+
+size_t LatencyTracker::findIndexPosition(int32_t inputEventId) const {
+    size_t position = homePosition(inputEventId, INDEX_SIZE);
+    while (mIndex[position].slot != EMPTY_SLOT && mIndex[position].inputEventId != inputEventId) {
+        position = (position + 1) & (INDEX_SIZE - 1);
+    }
+    return position;
+}
+
+/**
+ * Removes an entry without leaving a marker behind, by moving the following entries of the probe
+ * sequence back into the hole whenever that keeps them reachable from their home positions.
+ */
+void LatencyTracker::eraseIndexEntry(size_t position) {
+    size_t hole = position;
+    size_t next = (hole + 1) & (INDEX_SIZE - 1);
+    while (mIndex[next].slot != EMPTY_SLOT) {
+        const size_t home = homePosition(mIndex[next].inputEventId, INDEX_SIZE);
+        const size_t distanceFromHome = (next + INDEX_SIZE - home) & (INDEX_SIZE - 1);
+        const size_t distanceFromHole = (next + INDEX_SIZE - hole) & (INDEX_SIZE - 1);
+        if (distanceFromHome >= distanceFromHole) {
+            mIndex[hole] = mIndex[next];
+            hole = next;
+        }
+        next = (next + 1) & (INDEX_SIZE - 1);
     }
+    mIndex[hole].slot = EMPTY_SLOT;
 }
 
 std::string LatencyTracker::dump(const char* prefix) const {
     return StringPrintf("%sLatencyTracker:\n", prefix) +
-            StringPrintf("%s  mTimelines.size() = %zu\n", prefix, mTimelines.size()) +
-            StringPrintf("%s  mEventTimes.size() = %zu\n", prefix, mEventTimes.size());
+            StringPrintf("%s  Tracked events: %zu\n", prefix, mTrackedEventCount) +
+            StringPrintf("%s  Used slots: %zu / %zu\n", prefix, mUsedSlotCount,
+                         MAX_TRACKED_EVENTS);
 }
 
 void LatencyTracker::setInputDevices(const std::vector<InputDeviceInfo>& inputDevices) {
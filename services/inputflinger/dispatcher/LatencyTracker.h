@@ -18,8 +18,8 @@
 
 #include "../InputDeviceMetricsSource.h"
 
-#include <map>
-#include <unordered_map>
+#include <optional>
+#include <vector>
 
 #include <binder/IBinder.h>
 #include <input/Input.h>
@@ -38,6 +38,13 @@ namespace android::inputdispatcher {
  */
 class LatencyTracker {
 public:
+    /**
+     * The maximum number of events that are tracked at the same time. If more events than this are
+     * waiting to mature, the oldest ones are reported early. By then, they are so old compared to
+     * the latest event that the apps have already reported everything about them.
+     */
+    static constexpr size_t MAX_TRACKED_EVENTS = 1024;
+
     /**
      * Create a LatencyTracker.
      * param reportingFunction: the function that will be called in order to report full latency.
@@ -64,26 +71,54 @@ public:
     void setInputDevices(const std::vector<InputDeviceInfo>& inputDevices);
 
 private:
+    // Twice the number of tracked events, so that the probe sequences stay short.
+    static constexpr size_t INDEX_SIZE = 2 * MAX_TRACKED_EVENTS;
+    static_assert((INDEX_SIZE & (INDEX_SIZE - 1)) == 0, "INDEX_SIZE must be a power of 2");
+
     /**
-     * A collection of InputEventTimelines keyed by inputEventId. An InputEventTimeline is first
-     * created when 'trackListener' is called.
+     * A ring of InputEventTimelines, in the order in which 'trackListener' was called for them. An
+     * InputEventTimeline is first created when 'trackListener' is called.
      * When either 'trackFinishedEvent' or 'trackGraphicsLatency' is called for this input event,
      * the corresponding InputEventTimeline will be updated for that token.
+     * The slots of events that were dropped are left empty until they reach the front of the ring.
+     * Since events arrive roughly in the order of their eventTimes, the events at the front of the
+     * ring are the first ones to mature.
      */
-    std::unordered_map<int32_t /*inputEventId*/, InputEventTimeline> mTimelines;
+    struct Slot {
+        int32_t inputEventId;
+        std::optional<InputEventTimeline> timeline;
+    };
+    std::vector<Slot> mTimelines;
+    // The slot of mTimelines that holds the oldest event.
+    size_t mOldestSlot = 0;
+    // The number of slots in use, including the empty slots of dropped events.
+    size_t mUsedSlotCount = 0;
+    // The number of slots that hold a timeline.
+    size_t mTrackedEventCount = 0;
+
     /**
-     * The collection of eventTimes will help us quickly find the events that we should prune
-     * from the 'mTimelines'. Since 'mTimelines' is keyed by inputEventId, it would be inefficient
-     * to walk through it directly to find the oldest input events to get rid of.
-     * There is a 1:1 mapping between 'mTimelines' and 'mEventTimes'.
-     * We are using 'multimap' instead of 'map' because there could be more than 1 event with the
-     * same eventTime.
+     * An open addressing hash table that maps inputEventIds to their slots in mTimelines, with
+     * linear probing. Input event ids are randomly generated, so their low bits are used as the
+     * hash.
      */
-    std::multimap<nsecs_t /*eventTime*/, int32_t /*inputEventId*/> mEventTimes;
+    struct IndexEntry {
+        int32_t inputEventId;
+        int32_t slot; // EMPTY_SLOT if the entry is unused
+    };
+    static constexpr int32_t EMPTY_SLOT = -1;
+    std::vector<IndexEntry> mIndex;
 
     InputEventTimelineProcessor* mTimelineProcessor;
     std::vector<InputDeviceInfo> mInputDevices;
     void reportAndPruneMatureRecords(nsecs_t newEventTime);
+
+    InputEventTimeline* findTimeline(int32_t inputEventId);
+    // Returns the position of the inputEventId in mIndex, or of the unused entry that ends its
+    // probe sequence.
+    size_t findIndexPosition(int32_t inputEventId) const;
+    void eraseIndexEntry(size_t position);
+    // Reports the oldest event, if it was not dropped, and removes its slot from the ring.
+    void reportAndPopOldestSlot();
 };
 
 } // namespace android::inputdispatcher
@@ -0,0 +1,170 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "InputDispatcher"
+
+#include "RecentEventHistory.h"
+
+#include "DebugConfig.h"
+
+#include <android-base/stringprintf.h>
+#include <ftl/enum.h>
+#include <input/Input.h>
+#include <input/PrintTools.h>
+#include <inttypes.h>
+
+using android::base::StringPrintf;
+
+namespace android::inputdispatcher {
+
+void RecentEventHistory::add(const EventEntry& entry) {
+    if (entry.type == EventEntry::Type::SENSOR) {
+        return;
+    }
+    Record record{};
+    record.type = entry.type;
+    record.id = entry.id;
+    record.eventTime = entry.eventTime;
+    record.policyFlags = entry.policyFlags;
+    switch (entry.type) {
+        case EventEntry::Type::DEVICE_RESET: {
+            record.deviceId = static_cast<const DeviceResetEntry&>(entry).deviceId;
+            break;
+        }
+        case EventEntry::Type::FOCUS: {
+            record.state = static_cast<const FocusEntry&>(entry).hasFocus;
+            break;
+        }
+        case EventEntry::Type::POINTER_CAPTURE_CHANGED: {
+            const auto& captureEntry = static_cast<const PointerCaptureChangedEntry&>(entry);
+            record.state = captureEntry.pointerCaptureRequest.isEnable();
+            break;
+        }
+        case EventEntry::Type::DRAG: {
+            const auto& dragEntry = static_cast<const DragEntry&>(entry);
+            record.state = dragEntry.isExiting;
+            record.x = dragEntry.x;
+            record.y = dragEntry.y;
+            break;
+        }
+        case EventEntry::Type::TOUCH_MODE_CHANGED: {
+            const auto& touchModeEntry = static_cast<const TouchModeEntry&>(entry);
+            record.state = touchModeEntry.inTouchMode;
+            record.displayId = touchModeEntry.displayId;
+            break;
+        }
+        case EventEntry::Type::KEY: {
+            const auto& keyEntry = static_cast<const KeyEntry&>(entry);
+            record.deviceId = keyEntry.deviceId;
+            record.source = keyEntry.source;
+            record.displayId = keyEntry.displayId;
+            record.action = keyEntry.action;
+            record.flags = keyEntry.flags;
+            record.code = keyEntry.keyCode;
+            record.count = keyEntry.repeatCount;
+            break;
+        }
+        case EventEntry::Type::MOTION: {
+            const auto& motionEntry = static_cast<const MotionEntry&>(entry);
+            record.deviceId = motionEntry.deviceId;
+            record.source = motionEntry.source;
+            record.displayId = motionEntry.displayId;
+            record.action = motionEntry.action;
+            record.flags = motionEntry.flags;
+            record.code = motionEntry.buttonState;
+            record.count = static_cast<int32_t>(motionEntry.getPointerCount());
+            if (!motionEntry.pointerCoords.empty()) {
+                record.x = motionEntry.pointerCoords[0].getX();
+                record.y = motionEntry.pointerCoords[0].getY();
+            }
+            break;
+        }
+        case EventEntry::Type::SENSOR: {
+            LOG_ALWAYS_FATAL("Sensor events are not recorded");
+        }
+    }
+
+    mRecords[mNextIndex] = record;
+    mNextIndex = (mNextIndex + 1) % CAPACITY;
+    if (mSize < CAPACITY) {
+        mSize++;
+    }
+}
+
+std::string RecentEventHistory::dump(const char* prefix, nsecs_t currentTime) const {
+    std::string dump;
+    // When the ring isn't full yet, the oldest event is in the first slot.
+    const size_t oldestIndex = (mNextIndex + CAPACITY - mSize) % CAPACITY;
+    for (size_t i = 0; i < mSize; i++) {
+        const Record& record = mRecords[(oldestIndex + i) % CAPACITY];
+        dump += prefix;
+        dump += record.getDescription();
+        dump += StringPrintf(", age=%" PRId64 "ms\n", ns2ms(currentTime - record.eventTime));
+    }
+    return dump;
+}
+
+std::string RecentEventHistory::Record::getDescription() const {
+    switch (type) {
+        case EventEntry::Type::DEVICE_RESET: {
+            return StringPrintf("DeviceResetEvent(deviceId=%d), policyFlags=0x%08x", deviceId,
+                                policyFlags);
+        }
+        case EventEntry::Type::FOCUS: {
+            return StringPrintf("FocusEvent(hasFocus=%s)", toString(state));
+        }
+        case EventEntry::Type::POINTER_CAPTURE_CHANGED: {
+            return StringPrintf("PointerCaptureChangedEvent(pointerCaptureEnabled=%s)",
+                                toString(state));
+        }
+        case EventEntry::Type::DRAG: {
+            return StringPrintf("DragEntry(isExiting=%s, x=%f, y=%f)", toString(state), x, y);
+        }
+        case EventEntry::Type::TOUCH_MODE_CHANGED: {
+            return StringPrintf("TouchModeEvent(inTouchMode=%s)", toString(state));
+        }
+        case EventEntry::Type::KEY: {
+            if (!IS_DEBUGGABLE_BUILD) {
+                return "KeyEvent";
+            }
+            return StringPrintf("KeyEvent(id=0x%" PRIx32 ", deviceId=%d, eventTime=%" PRIu64
+                                ", source=%s, displayId=%s, action=%s, flags=0x%08x, "
+                                "keyCode=%s(%d), repeatCount=%d), policyFlags=0x%08x",
+                                id, deviceId, eventTime, inputEventSourceToString(source).c_str(),
+                                displayId.toString().c_str(), KeyEvent::actionToString(action),
+                                flags, KeyEvent::getLabel(code), code, count, policyFlags);
+        }
+        case EventEntry::Type::MOTION: {
+            if (!IS_DEBUGGABLE_BUILD) {
+                return "MotionEvent";
+            }
+            return StringPrintf("MotionEvent(id=0x%" PRIx32 ", deviceId=%d, eventTime=%" PRIu64
+                                ", source=%s, displayId=%s, action=%s, flags=0x%08x, "
+                                "buttonState=0x%08x, pointerCount=%d, firstPointer=(%.1f, %.1f)), "
+                                "policyFlags=0x%08x",
+                                id, deviceId, eventTime, inputEventSourceToString(source).c_str(),
+                                displayId.toString().c_str(),
+                                MotionEvent::actionToString(action).c_str(), flags, code, count, x,
+                                y, policyFlags);
+        }
+        case EventEntry::Type::SENSOR: {
+            break;
+        }
+    }
+    return ftl::enum_string(type);
+}
+
+} // namespace android::inputdispatcher
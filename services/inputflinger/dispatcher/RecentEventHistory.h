@@ -0,0 +1,77 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "Entry.h"
+
+#include <ui/LogicalDisplayId.h>
+#include <utils/Timers.h>
+#include <array>
+#include <string>
+
+namespace android::inputdispatcher {
+
+/**
+ * Remembers the most recent events that were processed by the dispatcher, for dumpsys.
+ * Only a few fields of every event are copied into a preallocated ring, so that the history
+ * doesn't keep the entries themselves, and their pointers, alive.
+ * Once the ring is full, the oldest event is overwritten by the newest one.
+ */
+class RecentEventHistory {
+public:
+    static constexpr size_t CAPACITY = 64;
+
+    // Sensor events are not recorded, to avoid flooding the history.
+    void add(const EventEntry& entry);
+
+    size_t size() const { return mSize; }
+    bool empty() const { return mSize == 0; }
+
+    // One line per event, from the oldest to the newest.
+    std::string dump(const char* prefix, nsecs_t currentTime) const;
+
+private:
+    struct Record {
+        EventEntry::Type type;
+        int32_t id;
+        nsecs_t eventTime;
+        uint32_t policyFlags;
+        int32_t deviceId;
+        uint32_t source;
+        ui::LogicalDisplayId displayId = ui::LogicalDisplayId::INVALID;
+        int32_t action;
+        int32_t flags;
+        // The key code of a key, or the button state of a motion.
+        int32_t code;
+        // The repeat count of a key, or the pointer count of a motion.
+        int32_t count;
+        // The position of the first pointer of a motion, or of a drag.
+        float x;
+        float y;
+        // hasFocus, inTouchMode, isExiting or the pointer capture state, depending on the type.
+        bool state;
+
+        std::string getDescription() const;
+    };
+
+    std::array<Record, CAPACITY> mRecords;
+    // The index of the slot that the next event is written to.
+    size_t mNextIndex = 0;
+    size_t mSize = 0;
+};
+
+} // namespace android::inputdispatcher
@@ -0,0 +1,151 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "WindowHitIndex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+using android::gui::WindowInfo;
+using android::gui::WindowInfoHandle;
+
+namespace android::inputdispatcher {
+
+namespace {
+
+// Matches the hit test in the dispatcher, which treats the right and bottom edges as outside.
+bool containsPoint(const Rect& bounds, const vec2& point) {
+    return point.x >= bounds.left && point.x < bounds.right && point.y >= bounds.top &&
+            point.y < bounds.bottom;
+}
+
+int32_t divideRoundingUp(int32_t value, int32_t divisor) {
+    return (value + divisor - 1) / divisor;
+}
+
+} // namespace
+
+WindowHitIndex::WindowHitIndex(const std::vector<sp<WindowInfoHandle>>& windowHandles,
+                               const ui::Transform& displayTransform, const Rect& displayBounds)
+      : mDisplayTransform(displayTransform), mGridBounds(displayBounds) {
+    mTouchableBounds.reserve(windowHandles.size());
+    mFrames.reserve(windowHandles.size());
+    for (size_t i = 0; i < windowHandles.size(); i++) {
+        const WindowInfo& info = *windowHandles[i]->getInfo();
+        mTouchableBounds.push_back(displayTransform.transform(info.touchableRegion).getBounds());
+        mFrames.push_back(displayTransform.transform(info.frame));
+        mIndexByHandle.emplace(windowHandles[i].get(), i);
+        if (!info.supportsSplitTouch()) {
+            mNonSplittingWindows.push_back(i);
+        }
+    }
+    if (mGridBounds.isEmpty()) {
+        return;
+    }
+
+    constexpr auto kCellsPerSide = static_cast<int32_t>(kGridSize);
+    mCellWidth = std::max(1, divideRoundingUp(mGridBounds.width(), kCellsPerSide));
+    mCellHeight = std::max(1, divideRoundingUp(mGridBounds.height(), kCellsPerSide));
+    mCells.resize(kGridSize * kGridSize);
+
+    // Windows are inserted front to back, which keeps every cell sorted in z-order.
+    for (size_t i = 0; i < windowHandles.size(); i++) {
+        insert(i, mTouchableBounds[i], &Cell::touchable);
+        insert(i, mFrames[i], &Cell::occluding);
+    }
+}
+
+std::optional<size_t> WindowHitIndex::cellIndexAt(const vec2& point) const {
+    if (mCells.empty() || !containsPoint(mGridBounds, point)) {
+        return std::nullopt;
+    }
+    const auto column = std::min(static_cast<size_t>((point.x - mGridBounds.left) / mCellWidth),
+                                 kGridSize - 1);
+    const auto row = std::min(static_cast<size_t>((point.y - mGridBounds.top) / mCellHeight),
+                              kGridSize - 1);
+    return row * kGridSize + column;
+}
+
+void WindowHitIndex::insert(size_t window, const Rect& bounds, std::vector<size_t> Cell::*list) {
+    Rect clipped;
+    if (!bounds.intersect(mGridBounds, &clipped)) {
+        return;
+    }
+    const auto firstColumn = static_cast<size_t>((clipped.left - mGridBounds.left) / mCellWidth);
+    const auto lastColumn = std::min(static_cast<size_t>((clipped.right - 1 - mGridBounds.left) /
+                                                         mCellWidth),
+                                     kGridSize - 1);
+    const auto firstRow = static_cast<size_t>((clipped.top - mGridBounds.top) / mCellHeight);
+    const auto lastRow = std::min(static_cast<size_t>((clipped.bottom - 1 - mGridBounds.top) /
+                                                      mCellHeight),
+                                  kGridSize - 1);
+    for (size_t row = firstRow; row <= lastRow; row++) {
+        for (size_t column = firstColumn; column <= lastColumn; column++) {
+            (mCells[row * kGridSize + column].*list).push_back(window);
+        }
+    }
+}
+
+std::vector<size_t> WindowHitIndex::getCandidatesAt(const vec2& point,
+                                                    const std::vector<Rect>& bounds,
+                                                    std::vector<size_t> Cell::*list) const {
+    std::vector<size_t> candidates;
+    const auto cell = cellIndexAt(point);
+    if (!cell) {
+        // Points outside of the display are rare, so there is no index for them.
+        for (size_t window = 0; window < bounds.size(); window++) {
+            if (containsPoint(bounds[window], point)) {
+                candidates.push_back(window);
+            }
+        }
+        return candidates;
+    }
+    for (size_t window : mCells[*cell].*list) {
+        if (containsPoint(bounds[window], point)) {
+            candidates.push_back(window);
+        }
+    }
+    return candidates;
+}
+
+std::vector<size_t> WindowHitIndex::getTouchCandidatesAt(float x, float y) const {
+    const vec2 point = floor(mDisplayTransform.transform(x, y));
+    std::vector<size_t> candidates = getCandidatesAt(point, mTouchableBounds, &Cell::touchable);
+    if (mNonSplittingWindows.empty()) {
+        return candidates;
+    }
+
+    std::vector<size_t> merged;
+    merged.reserve(candidates.size() + mNonSplittingWindows.size());
+    std::set_union(candidates.begin(), candidates.end(), mNonSplittingWindows.begin(),
+                   mNonSplittingWindows.end(), std::back_inserter(merged));
+    return merged;
+}
+
+std::vector<size_t> WindowHitIndex::getOcclusionCandidatesAt(float x, float y) const {
+    const vec2 point = floor(mDisplayTransform.transform(x, y));
+    return getCandidatesAt(point, mFrames, &Cell::occluding);
+}
+
+std::optional<size_t> WindowHitIndex::indexOf(const sp<WindowInfoHandle>& windowHandle) const {
+    if (const auto it = mIndexByHandle.find(windowHandle.get()); it != mIndexByHandle.end()) {
+        return it->second;
+    }
+    return std::nullopt;
+}
+
+} // namespace android::inputdispatcher
@@ -0,0 +1,82 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include <gui/WindowInfo.h>
+#include <ui/Rect.h>
+#include <ui/Transform.h>
+
+namespace android::inputdispatcher {
+
+// A uniform grid over the logical bounds of a single display, used to narrow touch hit-testing and
+// occlusion queries down to the windows whose bounds may contain a point.
+//
+// The index is conservative: it only rejects windows whose bounds, in logical display space,
+// cannot contain the point. Callers still perform the exact containment checks on the returned
+// candidates. Candidates are returned as indices into the window handles the index was built from,
+// in the same front to back order.
+//
+// The index must be rebuilt whenever the window handles or the display transform change.
+class WindowHitIndex {
+public:
+    static constexpr size_t kGridSize = 16;
+
+    WindowHitIndex() = default;
+    WindowHitIndex(const std::vector<sp<gui::WindowInfoHandle>>& windowHandles,
+                   const ui::Transform& displayTransform, const Rect& displayBounds);
+
+    // Windows whose touchable region may contain the point. Windows that prevent splitting are
+    // always included, since they can keep receiving pointers outside of their touchable region.
+    std::vector<size_t> getTouchCandidatesAt(float x, float y) const;
+
+    // Windows whose frame may contain the point.
+    std::vector<size_t> getOcclusionCandidatesAt(float x, float y) const;
+
+    // The position of the window in the window handles, if it is indexed.
+    std::optional<size_t> indexOf(const sp<gui::WindowInfoHandle>& windowHandle) const;
+
+    size_t size() const { return mTouchableBounds.size(); }
+
+private:
+    struct Cell {
+        std::vector<size_t> touchable;
+        std::vector<size_t> occluding;
+    };
+
+    std::optional<size_t> cellIndexAt(const vec2& point) const;
+    std::vector<size_t> getCandidatesAt(const vec2& point, const std::vector<Rect>& bounds,
+                                        std::vector<size_t> Cell::*list) const;
+    void insert(size_t window, const Rect& bounds, std::vector<size_t> Cell::*list);
+
+    ui::Transform mDisplayTransform;
+    Rect mGridBounds = Rect::EMPTY_RECT;
+    int32_t mCellWidth = 1;
+    int32_t mCellHeight = 1;
+    std::vector<Cell> mCells;
+
+    std::vector<Rect> mTouchableBounds;
+    std::vector<Rect> mFrames;
+    std::vector<size_t> mNonSplittingWindows;
+    std::unordered_map<const gui::WindowInfoHandle*, size_t> mIndexByHandle;
+};
+
+} // namespace android::inputdispatcher
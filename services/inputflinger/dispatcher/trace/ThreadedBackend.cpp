@@ -26,11 +26,9 @@ namespace android::inputdispatcher::trace::impl {
 
 namespace {
 
-// Helper to std::visit with lambdas.
-template <typename... V>
-struct Visitor : V... {
-    using V::operator()...;
-};
+// The number of events that can be waiting to be traced. A single tap produces a few inbound and
+// dispatched events, so this leaves plenty of room for the tracing thread to be descheduled.
+constexpr size_t TRACE_QUEUE_CAPACITY = 512;
 
 } // namespace
 
@@ -39,6 +37,8 @@ struct Visitor : V... {
 template <typename Backend>
 ThreadedBackend<Backend>::ThreadedBackend(Backend&& innerBackend)
       : mBackend(std::move(innerBackend)),
+        mEntries(TRACE_QUEUE_CAPACITY),
+        mIdleWaiter(std::make_shared<IdleWaiter>()),
         mTracerThread(
                 "InputTracer", [this]() { threadLoop(); },
                 [this]() { mThreadWakeCondition.notify_all(); }) {}
@@ -55,74 +55,129 @@ ThreadedBackend<Backend>::~ThreadedBackend() {
 template <typename Backend>
 void ThreadedBackend<Backend>::traceMotionEvent(const TracedMotionEvent& event,
                                                 const TracedEventMetadata& metadata) {
-    std::scoped_lock lock(mLock);
-    mQueue.emplace_back(event, metadata);
-    setIdleStatus(false);
-    mThreadWakeCondition.notify_all();
+    TraceEntry* entry = beginWrite();
+    if (entry == nullptr) {
+        return;
+    }
+    entry->type = TraceEntry::Type::MOTION;
+    entry->motionEvent = event;
+    entry->metadata = metadata;
+    endWrite();
 }
 
 template <typename Backend>
 void ThreadedBackend<Backend>::traceKeyEvent(const TracedKeyEvent& event,
                                              const TracedEventMetadata& metadata) {
-    std::scoped_lock lock(mLock);
-    mQueue.emplace_back(event, metadata);
-    setIdleStatus(false);
-    mThreadWakeCondition.notify_all();
+    TraceEntry* entry = beginWrite();
+    if (entry == nullptr) {
+        return;
+    }
+    entry->type = TraceEntry::Type::KEY;
+    entry->keyEvent = event;
+    entry->metadata = metadata;
+    endWrite();
 }
 
 template <typename Backend>
 void ThreadedBackend<Backend>::traceWindowDispatch(const WindowDispatchArgs& dispatchArgs,
                                                    const TracedEventMetadata& metadata) {
-    std::scoped_lock lock(mLock);
-    mQueue.emplace_back(dispatchArgs, metadata);
-    setIdleStatus(false);
-    mThreadWakeCondition.notify_all();
+    TraceEntry* entry = beginWrite();
+    if (entry == nullptr) {
+        return;
+    }
+    entry->type = TraceEntry::Type::WINDOW_DISPATCH;
+    entry->dispatchArgs = dispatchArgs;
+    entry->metadata = metadata;
+    endWrite();
 }
 
 template <typename Backend>
-void ThreadedBackend<Backend>::threadLoop() {
-    std::vector<TraceEntry> entries;
+typename ThreadedBackend<Backend>::TraceEntry* ThreadedBackend<Backend>::beginWrite() {
+    const uint64_t writeIndex = mWriteIndex.load(std::memory_order_relaxed);
+    if (writeIndex - mReadIndex.load(std::memory_order_acquire) == mEntries.size()) {
+        mDroppedEventCount.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    return &mEntries[writeIndex % mEntries.size()];
+}
 
-    { // acquire lock
-        std::unique_lock lock(mLock);
-        base::ScopedLockAssertion assumeLocked(mLock);
+template <typename Backend>
+void ThreadedBackend<Backend>::endWrite() {
+    if (mIsIdleWaiterRequested.load(std::memory_order_relaxed)) {
+        // Publish the entry under the idle lock, so that the tracing thread can't be reported as
+        // idle between the two.
+        std::scoped_lock idleLock(mIdleWaiter->idleLock);
+        mIdleWaiter->isIdle = false;
+        mWriteIndex.fetch_add(1, std::memory_order_seq_cst);
+    } else {
+        mWriteIndex.fetch_add(1, std::memory_order_seq_cst);
+    }
+    // Pairs with the tracing thread setting mThreadWaiting before it checks mWriteIndex again, so
+    // that either it sees the new entry, or we see that it needs to be woken up.
+    if (mThreadWaiting.exchange(false, std::memory_order_seq_cst)) {
+        std::scoped_lock lock(mLock);
+        mThreadWakeCondition.notify_all();
+    }
+}
 
-        if (mQueue.empty()) {
-            setIdleStatus(true);
+template <typename Backend>
+void ThreadedBackend<Backend>::traceEntry(const TraceEntry& entry) {
+    switch (entry.type) {
+        case TraceEntry::Type::KEY: {
+            mBackend.traceKeyEvent(entry.keyEvent, entry.metadata);
+            return;
+        }
+        case TraceEntry::Type::MOTION: {
+            mBackend.traceMotionEvent(entry.motionEvent, entry.metadata);
+            return;
         }
+        case TraceEntry::Type::WINDOW_DISPATCH: {
+            mBackend.traceWindowDispatch(entry.dispatchArgs, entry.metadata);
+            return;
+        }
+    }
+}
+
+template <typename Backend>
+void ThreadedBackend<Backend>::threadLoop() {
+    uint64_t readIndex = mReadIndex.load(std::memory_order_relaxed);
+    uint64_t writeIndex = mWriteIndex.load(std::memory_order_acquire);
+
+    if (writeIndex == readIndex) {
+        setIdleIfEmpty(readIndex);
 
+        std::unique_lock lock(mLock);
+        base::ScopedLockAssertion assumeLocked(mLock);
+        mThreadWaiting.store(true, std::memory_order_seq_cst);
         // Wait until we need to process more events or exit.
-        mThreadWakeCondition.wait(lock,
-                                  [&]() REQUIRES(mLock) { return mThreadExit || !mQueue.empty(); });
+        mThreadWakeCondition.wait(lock, [&]() REQUIRES(mLock) {
+            return mThreadExit || mWriteIndex.load(std::memory_order_seq_cst) != readIndex;
+        });
+        mThreadWaiting.store(false, std::memory_order_relaxed);
         if (mThreadExit) {
             setIdleStatus(true);
             return;
         }
-
-        mQueue.swap(entries);
+        writeIndex = mWriteIndex.load(std::memory_order_acquire);
     } // release lock
 
-    // Trace the events into the backend without holding the lock to reduce the amount of
-    // work performed in the critical section.
-    for (const auto& [entry, traceArgs] : entries) {
-        std::visit(Visitor{[&](const TracedMotionEvent& e) {
-                               mBackend.traceMotionEvent(e, traceArgs);
-                           },
-                           [&](const TracedKeyEvent& e) { mBackend.traceKeyEvent(e, traceArgs); },
-                           [&](const WindowDispatchArgs& args) {
-                               mBackend.traceWindowDispatch(args, traceArgs);
-                           }},
-                   entry);
+    // Trace the events straight from the ring. An entry is only handed back to the writer once
+    // it has been traced.
+    for (; readIndex != writeIndex; readIndex++) {
+        traceEntry(mEntries[readIndex % mEntries.size()]);
+        mReadIndex.store(readIndex + 1, std::memory_order_release);
+    }
+
+    const uint64_t droppedEventCount = mDroppedEventCount.exchange(0, std::memory_order_relaxed);
+    if (droppedEventCount != 0) {
+        LOG(WARNING) << "Dropped " << droppedEventCount
+                     << " input trace events because the tracing thread fell behind";
     }
-    entries.clear();
 }
 
 template <typename Backend>
 std::function<void()> ThreadedBackend<Backend>::getIdleWaiterForTesting() {
-    std::scoped_lock lock(mLock);
-    if (!mIdleWaiter) {
-        mIdleWaiter = std::make_shared<IdleWaiter>();
-    }
+    mIsIdleWaiterRequested.store(true, std::memory_order_relaxed);
 
     // Return a lambda that holds a strong reference to the idle waiter, whose lifetime can extend
     // beyond this threaded backend object.
@@ -137,7 +192,7 @@ std::function<void()> ThreadedBackend<Backend>::getIdleWaiterForTesting() {
 
 template <typename Backend>
 void ThreadedBackend<Backend>::setIdleStatus(bool isIdle) {
-    if (!mIdleWaiter) {
+    if (!mIsIdleWaiterRequested.load(std::memory_order_relaxed)) {
         return;
     }
     std::scoped_lock idleLock(mIdleWaiter->idleLock);
@@ -147,6 +202,18 @@ void ThreadedBackend<Backend>::setIdleStatus(bool isIdle) {
     }
 }
 
+template <typename Backend>
+void ThreadedBackend<Backend>::setIdleIfEmpty(uint64_t readIndex) {
+    if (!mIsIdleWaiterRequested.load(std::memory_order_relaxed)) {
+        return;
+    }
+    std::scoped_lock idleLock(mIdleWaiter->idleLock);
+    if (mWriteIndex.load(std::memory_order_seq_cst) == readIndex) {
+        mIdleWaiter->isIdle = true;
+        mIdleWaiter->threadIdleCondition.notify_all();
+    }
+}
+
 // Explicit template instantiation for the PerfettoBackend.
 template class ThreadedBackend<PerfettoBackend>;
 
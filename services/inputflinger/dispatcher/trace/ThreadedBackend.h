@@ -20,8 +20,8 @@
 #include "InputTracingPerfettoBackend.h"
 
 #include <android-base/thread_annotations.h>
+#include <atomic>
 #include <mutex>
-#include <variant>
 #include <vector>
 
 namespace android::inputdispatcher::trace::impl {
@@ -29,8 +29,16 @@ namespace android::inputdispatcher::trace::impl {
 /**
  * A wrapper around an InputTracingBackend implementation that writes to the inner tracing backend
  * from a single new thread that it creates. The new tracing thread is started when the
- * ThreadedBackend is created, and is stopped when it is destroyed. The ThreadedBackend is
- * thread-safe.
+ * ThreadedBackend is created, and is stopped when it is destroyed.
+ *
+ * The traced events are passed to the tracing thread through a fixed-capacity ring of entries that
+ * are allocated up front, so that tracing an event doesn't take a lock or allocate on the calling
+ * thread. The entries are reused, so copying an event into the ring reuses the memory of the
+ * event that was previously stored in it. If the tracing thread falls behind and the ring is
+ * full, the event is dropped rather than blocking the caller.
+ *
+ * There can only be one writer at a time: the calls to trace events must be serialized by the
+ * caller, which InputTracer already requires.
  */
 template <typename Backend>
 class ThreadedBackend : public InputTracingBackendInterface {
@@ -46,30 +54,55 @@ public:
     std::function<void()> getIdleWaiterForTesting();
 
 private:
+    // Only used by the tracing thread to sleep while the ring is empty.
     std::mutex mLock;
     bool mThreadExit GUARDED_BY(mLock){false};
     std::condition_variable mThreadWakeCondition;
     Backend mBackend;
-    using TraceEntry =
-            std::pair<std::variant<TracedKeyEvent, TracedMotionEvent, WindowDispatchArgs>,
-                      TracedEventMetadata>;
-    std::vector<TraceEntry> mQueue GUARDED_BY(mLock);
+
+    // Every type of event has its own field, so that an entry keeps the memory of each type of
+    // event when it is reused.
+    struct TraceEntry {
+        enum class Type { KEY, MOTION, WINDOW_DISPATCH };
+        Type type;
+        TracedKeyEvent keyEvent;
+        TracedMotionEvent motionEvent;
+        WindowDispatchArgs dispatchArgs;
+        TracedEventMetadata metadata;
+    };
+    std::vector<TraceEntry> mEntries;
+    // The index of the next entry to be written. Only written by the caller.
+    alignas(64) std::atomic<uint64_t> mWriteIndex{0};
+    // The index of the next entry to be traced. Only written by the tracing thread.
+    alignas(64) std::atomic<uint64_t> mReadIndex{0};
+    // Set by the tracing thread before it sleeps, and cleared by the caller when it wakes it up.
+    std::atomic<bool> mThreadWaiting{false};
+    // The number of events that were dropped because the ring was full.
+    std::atomic<uint64_t> mDroppedEventCount{0};
 
     struct IdleWaiter {
         std::mutex idleLock;
         std::condition_variable threadIdleCondition;
         bool isIdle GUARDED_BY(idleLock){false};
     };
-    // The lazy-initialized object used to wait for the tracing thread to idle.
-    std::shared_ptr<IdleWaiter> mIdleWaiter GUARDED_BY(mLock);
+    // The object used to wait for the tracing thread to idle. The idle status is only kept up to
+    // date once a test has asked for it, so that tracing doesn't take the idle lock otherwise.
+    const std::shared_ptr<IdleWaiter> mIdleWaiter;
+    std::atomic<bool> mIsIdleWaiterRequested{false};
 
     // InputThread stops when its destructor is called. Initialize it last so that it is the
     // first thing to be destructed. This will guarantee the thread will not access other
     // members that have already been destructed.
     InputThread mTracerThread;
 
+    // Returns the entry that the next event should be written to, or nullptr if the ring is full.
+    TraceEntry* beginWrite();
+    void endWrite();
+    void traceEntry(const TraceEntry& entry);
     void threadLoop();
-    void setIdleStatus(bool isIdle) REQUIRES(mLock);
+    void setIdleStatus(bool isIdle);
+    // Reports the tracing thread as idle if no entries were written after the given read index.
+    void setIdleIfEmpty(uint64_t readIndex);
 };
 
 } // namespace android::inputdispatcher::trace::impl
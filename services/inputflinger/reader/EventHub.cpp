@@ -53,6 +53,7 @@
 #include <utils/Log.h>
 #include <utils/Timers.h>
 
+#include <algorithm>
 #include <filesystem>
 #include <optional>
 #include <regex>
@@ -1848,7 +1849,9 @@ std::vector<RawEvent> EventHub::getEvents(int timeoutMillis) {
 
     std::array<input_event, EVENT_BUFFER_SIZE> readBuffer;
 
-    std::vector<RawEvent> events;
+    std::vector<RawEvent> events = std::move(mRecycledEvents);
+    events.clear();
+    events.reserve(EVENT_BUFFER_SIZE);
     bool awoken = false;
     for (;;) {
         nsecs_t now = systemTime(SYSTEM_TIME_MONOTONIC);
@@ -1976,14 +1979,24 @@ std::vector<RawEvent> EventHub::getEvents(int timeoutMillis) {
             }
             // This must be an input event
             if (eventItem.events & EPOLLIN) {
+                if (events.size() >= EVENT_BUFFER_SIZE) {
+                    // The result buffer is already full of device changes. Read the device on
+                    // the next iteration.
+                    mPendingEventIndex -= 1;
+                    break;
+                }
+                // Don't read more than fits into the result, so that it never grows past the
+                // reserved capacity. The remaining events stay queued in the kernel.
+                const size_t readCapacity = std::min(readBuffer.size(),
+                                                     EVENT_BUFFER_SIZE - events.size());
                 int32_t readSize =
                         read(device->fd, readBuffer.data(),
-                             sizeof(decltype(readBuffer)::value_type) * readBuffer.size());
+                             sizeof(decltype(readBuffer)::value_type) * readCapacity);
                 if (readSize == 0 || (readSize < 0 && errno == ENODEV)) {
                     // Device was removed before INotify noticed.
                     ALOGW("could not get event, removed? (fd: %d size: %" PRId32
                           " capacity: %zu errno: %d)\n",
-                          device->fd, readSize, readBuffer.size(), errno);
+                          device->fd, readSize, readCapacity, errno);
                     deviceChanged = true;
                     closeDeviceLocked(*device);
                 } else if (readSize < 0) {
@@ -1996,12 +2009,14 @@ std::vector<RawEvent> EventHub::getEvents(int timeoutMillis) {
                     const int32_t deviceId = device->id == mBuiltInKeyboardId ? 0 : device->id;
 
                     const size_t count = size_t(readSize) / sizeof(struct input_event);
+                    // All of the events were read at once.
+                    const nsecs_t readTime = systemTime(SYSTEM_TIME_MONOTONIC);
                     for (size_t i = 0; i < count; i++) {
                         struct input_event& iev = readBuffer[i];
                         device->trackInputEvent(iev);
                         events.push_back({
                                 .when = processEventTimestamp(iev),
-                                .readTime = systemTime(SYSTEM_TIME_MONOTONIC),
+                                .readTime = readTime,
                                 .deviceId = deviceId,
                                 .type = iev.type,
                                 .code = iev.code,
@@ -2093,6 +2108,11 @@ std::vector<RawEvent> EventHub::getEvents(int timeoutMillis) {
     return events;
 }
 
+void EventHub::recycleEvents(std::vector<RawEvent>&& events) {
+    std::scoped_lock _l(mLock);
+    mRecycledEvents = std::move(events);
+}
+
 std::vector<TouchVideoFrame> EventHub::getVideoFrames(int32_t deviceId) {
     std::scoped_lock _l(mLock);
 
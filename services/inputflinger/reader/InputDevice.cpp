@@ -39,6 +39,13 @@
 
 namespace android {
 
+namespace {
+
+// Processing a batch for longer than a 60 Hz frame noticeably delays the events of other devices.
+constexpr nsecs_t SLOW_PROCESSING_WARNING_THRESHOLD = 16 * 1000000LL; // 16ms
+
+} // namespace
+
 InputDevice::InputDevice(InputReaderContext* context, int32_t id, int32_t generation,
                          const InputDeviceIdentifier& identifier)
       : mContext(context),
@@ -141,6 +148,13 @@ void InputDevice::dump(std::string& dump, const std::string& eventHubDevStr) {
                          inputEventSourceToString(deviceInfo.getSources()).c_str());
     dump += StringPrintf(INDENT2 "KeyboardType: %d\n", deviceInfo.getKeyboardType());
     dump += StringPrintf(INDENT2 "ControllerNum: %d\n", deviceInfo.getControllerNumber());
+    if (mProcessingStats.batchCount > 0) {
+        dump += StringPrintf(INDENT2 "ProcessingTime: batches=%zu, average=%.3fms, max=%.3fms\n",
+                             mProcessingStats.batchCount,
+                             mProcessingStats.totalTime * 0.000001f /
+                                     mProcessingStats.batchCount,
+                             mProcessingStats.maxTime * 0.000001f);
+    }
 
     const std::vector<InputDeviceInfo::MotionRange>& ranges = deviceInfo.getMotionRanges();
     if (!ranges.empty()) {
@@ -397,6 +411,8 @@ std::list<NotifyArgs> InputDevice::process(const RawEvent* rawEvents, size_t cou
     // have side-effects that must be interleaved.  For example, joystick movement events and
     // gamepad button presses are handled by different mappers but they should be dispatched
     // in the order received.
+    const nsecs_t startTime = systemTime(SYSTEM_TIME_MONOTONIC);
+    const size_t eventCount = count;
     std::list<NotifyArgs> out;
     for (const RawEvent* rawEvent = rawEvents; count != 0; rawEvent++) {
         if (debugRawEvents()) {
@@ -427,9 +443,25 @@ std::list<NotifyArgs> InputDevice::process(const RawEvent* rawEvents, size_t cou
         --count;
     }
     postProcess(out);
+    recordProcessingTime(systemTime(SYSTEM_TIME_MONOTONIC) - startTime, eventCount);
     return out;
 }
 
+void InputDevice::recordProcessingTime(nsecs_t duration, size_t eventCount) {
+    mProcessingStats.batchCount++;
+    mProcessingStats.totalTime += duration;
+    if (duration <= mProcessingStats.maxTime) {
+        return;
+    }
+    mProcessingStats.maxTime = duration;
+    // Only log new maximums, so that a device that is always slow doesn't flood the log.
+    if (duration >= SLOW_PROCESSING_WARNING_THRESHOLD) {
+        ALOGW("Device %s took %.3fms to process %zu events, delaying the events of all other "
+              "devices.",
+              getName().c_str(), duration * 0.000001f, eventCount);
+    }
+}
+
 void InputDevice::postProcess(std::list<NotifyArgs>& args) const {
     if (mIsWaking) {
         // Update policy flags to request wake for the `NotifyArgs` that come from waking devices.
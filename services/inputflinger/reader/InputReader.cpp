@@ -168,6 +168,7 @@ void InputReader::loopOnce() {
         if (!events.empty()) {
             mPendingArgs += processEventsLocked(events.data(), events.size());
         }
+        mEventHub->recycleEvents(std::move(events));
 
         if (mNextTimeout != LLONG_MAX) {
             nsecs_t now = systemTime(SYSTEM_TIME_MONOTONIC);
@@ -307,6 +307,11 @@ public:
      * Returns the number of events obtained, or 0 if the timeout expired.
      */
     virtual std::vector<RawEvent> getEvents(int timeoutMillis) = 0;
+    /*
+     * Hands back the events returned by getEvents() once the caller is done with them, so that
+     * their storage can be reused by the next call instead of being allocated again.
+     */
+    virtual void recycleEvents(std::vector<RawEvent>&& /*events*/) {}
     virtual std::vector<TouchVideoFrame> getVideoFrames(int32_t deviceId) = 0;
     virtual base::Result<std::pair<InputDeviceSensorType, int32_t>> mapSensor(
             int32_t deviceId, int32_t absCode) const = 0;
@@ -561,6 +566,7 @@ public:
                                uint8_t* outFlags) const override final;
 
     std::vector<RawEvent> getEvents(int timeoutMillis) override final;
+    void recycleEvents(std::vector<RawEvent>&& events) override final;
     std::vector<TouchVideoFrame> getVideoFrames(int32_t deviceId) override final;
 
     bool hasScanCode(int32_t deviceId, int32_t scanCode) const override final;
@@ -806,6 +812,9 @@ private:
     size_t mPendingEventCount;
     size_t mPendingEventIndex;
     bool mPendingINotify;
+
+    // The storage of the last events returned by getEvents(), once the caller handed it back.
+    std::vector<RawEvent> mRecycledEvents;
 };
 
 } // namespace android
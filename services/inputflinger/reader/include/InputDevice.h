@@ -93,6 +93,15 @@ public:
                                                   ConfigurationChanges changes);
     [[nodiscard]] std::list<NotifyArgs> reset(nsecs_t when);
     [[nodiscard]] std::list<NotifyArgs> process(const RawEvent* rawEvents, size_t count);
+
+    // How long process() took for this device. All devices are processed on the reader thread,
+    // so a device that is slow to process delays the events of every other device.
+    struct ProcessingStats {
+        size_t batchCount = 0;
+        nsecs_t totalTime = 0;
+        nsecs_t maxTime = 0;
+    };
+    inline const ProcessingStats& getProcessingStats() const { return mProcessingStats; }
     [[nodiscard]] std::list<NotifyArgs> timeoutExpired(nsecs_t when);
     [[nodiscard]] std::list<NotifyArgs> updateExternalStylusState(const StylusState& state);
 
@@ -209,6 +218,7 @@ private:
     bool mHasMic;
     bool mDropUntilNextSync;
     std::optional<bool> mShouldSmoothScroll;
+    ProcessingStats mProcessingStats;
 
     typedef int32_t (InputMapper::*GetStateFunc)(uint32_t sourceMask, int32_t code);
     int32_t getState(uint32_t sourceMask, int32_t code, GetStateFunc getStateFunc);
@@ -229,6 +239,8 @@ private:
     // per the properties of the InputDevice.
     void postProcess(std::list<NotifyArgs>& args) const;
 
+    void recordProcessingTime(nsecs_t duration, size_t eventCount);
+
     // helpers to interate over the devices collection
     // run a function against every mapper on every subdevice
     inline void for_each_mapper(std::function<void(InputMapper&)> f) {
@@ -43,6 +43,7 @@
 #include "CursorScrollAccumulator.h"
 #include "TouchButtonAccumulator.h"
 #include "TouchCursorInputMapperCommon.h"
+#include "TouchPointerTransform.h"
 #include "ui/Rotation.h"
 
 namespace android {
@@ -2246,8 +2247,17 @@ void TouchInputMapper::cookPointerData() {
         mCurrentCookedState.buttonState = mCurrentRawState.buttonState;
     }
 
-    // Walk through the the active pointers and map device coordinates onto
-    // display coordinates and adjust for display orientation.
+    // Map the device coordinates of all of the active pointers onto display coordinates at once.
+    PointerCoordinateBatch coordinates;
+    for (uint32_t i = 0; i < currentPointerCount; i++) {
+        coordinates.x[i] = mCurrentRawState.rawPointerData.pointers[i].x;
+        coordinates.y[i] = mCurrentRawState.rawPointerData.pointers[i].y;
+    }
+    transformPointerCoordinates(mAffineTransform, mRawToDisplay, coordinates);
+
+    const uint32_t touchingCount = mCurrentRawState.rawPointerData.touchingIdBits.count();
+
+    // Walk through the the active pointers and cook the remaining axes.
     for (uint32_t i = 0; i < currentPointerCount; i++) {
         const RawPointerData::Pointer& in = mCurrentRawState.rawPointerData.pointers[i];
 
@@ -2289,7 +2299,6 @@ void TouchInputMapper::cookPointerData() {
                 }
 
                 if (mCalibration.sizeIsSummed && *mCalibration.sizeIsSummed) {
-                    uint32_t touchingCount = mCurrentRawState.rawPointerData.touchingIdBits.count();
                     if (touchingCount > 1) {
                         touchMajor /= touchingCount;
                         touchMinor /= touchingCount;
@@ -2393,12 +2402,10 @@ void TouchInputMapper::cookPointerData() {
                 distance = 0;
         }
 
-        // Adjust X,Y coords for device calibration and convert to the natural display coordinates.
-        vec2 transformed = {in.x, in.y};
-        mAffineTransform.applyTo(transformed.x /*byRef*/, transformed.y /*byRef*/);
-        transformed = mRawToDisplay.transform(transformed);
+        const vec2 transformed = {coordinates.x[i], coordinates.y[i]};
 
-        // Write output coords.
+        // Write output coords. The axes are written in increasing order, so that each of them is
+        // appended to the coords instead of being inserted in the middle.
         PointerCoords& out = mCurrentCookedState.cookedPointerData.pointerCoords[i];
         out.clear();
         out.setAxisValue(AMOTION_EVENT_AXIS_X, transformed.x);
@@ -2407,11 +2414,11 @@ void TouchInputMapper::cookPointerData() {
         out.setAxisValue(AMOTION_EVENT_AXIS_SIZE, size);
         out.setAxisValue(AMOTION_EVENT_AXIS_TOUCH_MAJOR, touchMajor);
         out.setAxisValue(AMOTION_EVENT_AXIS_TOUCH_MINOR, touchMinor);
-        out.setAxisValue(AMOTION_EVENT_AXIS_ORIENTATION, orientation);
-        out.setAxisValue(AMOTION_EVENT_AXIS_TILT, tilt);
-        out.setAxisValue(AMOTION_EVENT_AXIS_DISTANCE, distance);
         out.setAxisValue(AMOTION_EVENT_AXIS_TOOL_MAJOR, toolMajor);
         out.setAxisValue(AMOTION_EVENT_AXIS_TOOL_MINOR, toolMinor);
+        out.setAxisValue(AMOTION_EVENT_AXIS_ORIENTATION, orientation);
+        out.setAxisValue(AMOTION_EVENT_AXIS_DISTANCE, distance);
+        out.setAxisValue(AMOTION_EVENT_AXIS_TILT, tilt);
 
         // Write output relative fields if applicable.
         uint32_t id = in.id;
@@ -0,0 +1,72 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+
+#include <input/Input.h>
+#include <ui/Transform.h>
+
+#include "InputReaderBase.h"
+
+namespace android {
+
+/**
+ * The coordinates of all of the pointers of a touch frame, stored as separate arrays so that they
+ * can be transformed together.
+ */
+struct PointerCoordinateBatch {
+    std::array<float, MAX_POINTERS> x{};
+    std::array<float, MAX_POINTERS> y{};
+};
+
+/**
+ * Applies the touch calibration, followed by the raw to display transform, to every slot of the
+ * batch. The result is the same as calling TouchAffineTransformation::applyTo and then
+ * ui::Transform::transform on each pointer.
+ *
+ * All MAX_POINTERS slots are transformed, including the unused ones. The fixed trip count keeps
+ * the loop free of branches, so that the compiler can vectorize it.
+ */
+inline void transformPointerCoordinates(const TouchAffineTransformation& calibration,
+                                        const ui::Transform& rawToDisplay,
+                                        PointerCoordinateBatch& batch) {
+    const float xScale = calibration.x_scale;
+    const float xYMix = calibration.x_ymix;
+    const float xOffset = calibration.x_offset;
+    const float yXMix = calibration.y_xmix;
+    const float yScale = calibration.y_scale;
+    const float yOffset = calibration.y_offset;
+
+    const float dsdx = rawToDisplay.dsdx();
+    const float dtdx = rawToDisplay.dtdx();
+    const float tx = rawToDisplay.tx();
+    const float dtdy = rawToDisplay.dtdy();
+    const float dsdy = rawToDisplay.dsdy();
+    const float ty = rawToDisplay.ty();
+
+    for (size_t i = 0; i < MAX_POINTERS; i++) {
+        const float rawX = batch.x[i];
+        const float rawY = batch.y[i];
+        const float calibratedX = rawX * xScale + rawY * xYMix + xOffset;
+        const float calibratedY = rawX * yXMix + rawY * yScale + yOffset;
+        batch.x[i] = dsdx * calibratedX + dtdx * calibratedY + tx;
+        batch.y[i] = dtdy * calibratedX + dsdy * calibratedY + ty;
+    }
+}
+
+} // namespace android
@@ -18,6 +18,7 @@
 
 #include <algorithm>
 #include <chrono>
+#include <cinttypes>
 #include <iterator>
 #include <limits>
 #include <map>
@@ -306,6 +307,9 @@ void TouchpadInputMapper::dump(std::string& dump) {
     dump += addLinePrefix(mCapturedEventConverter.dump(), INDENT4);
     dump += StringPrintf(INDENT3 "DisplayId: %s\n",
                          toString(mDisplayId, streamableToString).c_str());
+    dump += INDENT3 "Gestures library CPU time:\n";
+    dump += INDENT4 "Hardware states: " + mHardwareStateCost.dump() + "\n";
+    dump += INDENT4 "Timer callbacks: " + mTimerCallbackCost.dump() + "\n";
 }
 
 std::list<NotifyArgs> TouchpadInputMapper::reconfigure(nsecs_t when,
@@ -463,12 +467,16 @@ void TouchpadInputMapper::updatePalmDetectionMetrics() {
 std::list<NotifyArgs> TouchpadInputMapper::sendHardwareState(nsecs_t when, nsecs_t readTime,
                                                              SelfContainedHardwareState schs) {
     ALOGD_IF(DEBUG_TOUCHPAD_GESTURES, "New hardware state: %s", schs.state.String().c_str());
+    const nsecs_t startCpuTime = systemTime(SYSTEM_TIME_THREAD);
     mGestureInterpreter->PushHardwareState(&schs.state);
+    mHardwareStateCost.record(systemTime(SYSTEM_TIME_THREAD) - startCpuTime);
     return processGestures(when, readTime);
 }
 
 std::list<NotifyArgs> TouchpadInputMapper::timeoutExpired(nsecs_t when) {
+    const nsecs_t startCpuTime = systemTime(SYSTEM_TIME_THREAD);
     mTimerProvider.triggerCallbacks(when);
+    mTimerCallbackCost.record(systemTime(SYSTEM_TIME_THREAD) - startCpuTime);
     return processGestures(when, when);
 }
 
@@ -498,6 +506,21 @@ std::list<NotifyArgs> TouchpadInputMapper::processGestures(nsecs_t when, nsecs_t
     return out;
 }
 
+void TouchpadInputMapper::GestureLibraryCost::record(nsecs_t cpuTime) {
+    callCount++;
+    totalCpuTime += cpuTime;
+    maxCpuTime = std::max(maxCpuTime, cpuTime);
+}
+
+std::string TouchpadInputMapper::GestureLibraryCost::dump() const {
+    if (callCount == 0) {
+        return "<none>";
+    }
+    return StringPrintf("calls=%" PRId64 ", mean=%.1fus, max=%.1fus", callCount,
+                        static_cast<double>(totalCpuTime) / callCount / 1000,
+                        static_cast<double>(maxCpuTime) / 1000);
+}
+
 std::optional<ui::LogicalDisplayId> TouchpadInputMapper::getAssociatedDisplayId() {
     return mDisplayId;
 }
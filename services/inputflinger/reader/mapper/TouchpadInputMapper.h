@@ -116,6 +116,21 @@ private:
 
     nsecs_t mGestureStartTime{0};
 
+    // The CPU time that the gestures library spent on the calls made by this mapper, so that the
+    // cost of a touchpad on the reader thread shows up in dumpsys.
+    struct GestureLibraryCost {
+        int64_t callCount = 0;
+        nsecs_t totalCpuTime = 0;
+        nsecs_t maxCpuTime = 0;
+
+        void record(nsecs_t cpuTime);
+        std::string dump() const;
+    };
+    // Spent on hardware states, which are pushed for every evdev frame.
+    GestureLibraryCost mHardwareStateCost;
+    // Spent on the timer callbacks of the library.
+    GestureLibraryCost mTimerCallbackCost;
+
     // True if hardware state update notifications is available for usage based on its feature flag
     // and settings value.
     bool mTouchpadHardwareStateNotificationsEnabled = false;
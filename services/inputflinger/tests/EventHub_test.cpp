@@ -115,6 +115,7 @@ std::vector<RawEvent> EventHubTest::getEvents(std::optional<size_t> expectedEven
             break;
         }
         events.insert(events.end(), newEvents.begin(), newEvents.end());
+        mEventHub->recycleEvents(std::move(newEvents));
         if (expectedEvents && events.size() >= *expectedEvents) {
             break;
         }
@@ -2799,6 +2799,25 @@ TEST_F(InputDeviceTest, WakeDevice_AddsWakeFlagToProcessNotifyArgs) {
     }
 }
 
+TEST_F(InputDeviceTest, Process_RecordsProcessingTime) {
+    mDevice->addMapper<FakeInputMapper>(EVENTHUB_ID, mFakePolicy->getReaderConfiguration(),
+                                        AINPUT_SOURCE_KEYBOARD);
+    InputReaderConfiguration config;
+    std::list<NotifyArgs> unused = mDevice->configure(ARBITRARY_TIME, config, /*changes=*/{});
+    ASSERT_EQ(0u, mDevice->getProcessingStats().batchCount);
+
+    RawEvent events[2] = {};
+    events[0].deviceId = EVENTHUB_ID;
+    events[1].deviceId = EVENTHUB_ID;
+    unused += mDevice->process(events, 2);
+    unused += mDevice->process(events, 1);
+
+    const InputDevice::ProcessingStats& stats = mDevice->getProcessingStats();
+    ASSERT_EQ(2u, stats.batchCount);
+    ASSERT_LE(stats.maxTime, stats.totalTime);
+    ASSERT_GE(stats.maxTime, 0);
+}
+
 TEST_F(InputDeviceTest, NotWakeDevice_DoesNotAddWakeFlagToProcessNotifyArgs) {
     mFakeEventHub->addConfigurationProperty(EVENTHUB_ID, "device.wake", "0");
     FakeInputMapper& mapper =
@@ -447,4 +447,61 @@ TEST_F(LatencyTrackerTest, TrackListenerCheck_InputEventActionTypeFieldInputEven
     assertReceivedTimelines(expectedTimelines);
 }
 
+/**
+ * When more events are waiting to mature than LatencyTracker can track, the oldest event is
+ * reported early, to make space for the new one.
+ */
+TEST_F(LatencyTrackerTest, WhenTooManyEventsAreTracked_OldestEventIsReportedEarly) {
+    const InputEventTimeline timeline = getTestTimeline();
+    for (size_t i = 0; i < LatencyTracker::MAX_TRACKED_EVENTS; i++) {
+        mTracker->trackListener(/*inputEventId=*/100 + i, timeline.eventTime, timeline.readTime,
+                                DEVICE_ID, {InputDeviceUsageSource::UNKNOWN},
+                                AMOTION_EVENT_ACTION_CANCEL, InputEventType::MOTION);
+    }
+    assertReceivedTimelines({});
+
+    mTracker->trackListener(/*inputEventId=*/99, timeline.eventTime, timeline.readTime, DEVICE_ID,
+                            {InputDeviceUsageSource::UNKNOWN}, AMOTION_EVENT_ACTION_CANCEL,
+                            InputEventType::MOTION);
+    assertReceivedTimeline(InputEventTimeline{timeline.eventTime, timeline.readTime,
+                                              timeline.vendorId, timeline.productId,
+                                              timeline.sources, timeline.inputEventActionType});
+}
+
+/**
+ * Events whose ids only differ in their high bits share the same position in the index of
+ * LatencyTracker. Dropping one of them must not lose track of the others.
+ */
+TEST_F(LatencyTrackerTest, EventsWithCollidingIds_AreTrackedSeparately) {
+    constexpr int32_t inputEventId1 = 5;
+    constexpr int32_t inputEventId2 = 5 + (1 << 16);
+    constexpr int32_t inputEventId3 = 5 + (1 << 17);
+    const InputEventTimeline timeline = getTestTimeline();
+    const ConnectionTimeline& expectedCT = timeline.connectionTimelines.begin()->second;
+    const sp<IBinder>& token = timeline.connectionTimelines.begin()->first;
+
+    for (int32_t inputEventId : {inputEventId1, inputEventId2, inputEventId3}) {
+        mTracker->trackListener(inputEventId, timeline.eventTime, timeline.readTime, DEVICE_ID,
+                                {InputDeviceUsageSource::UNKNOWN}, AMOTION_EVENT_ACTION_CANCEL,
+                                InputEventType::MOTION);
+    }
+    // A duplicate of the first event drops it.
+    mTracker->trackListener(inputEventId1, timeline.eventTime, timeline.readTime, DEVICE_ID,
+                            {InputDeviceUsageSource::UNKNOWN}, AMOTION_EVENT_ACTION_CANCEL,
+                            InputEventType::MOTION);
+    mTracker->trackFinishedEvent(inputEventId3, token, expectedCT.deliveryTime,
+                                 expectedCT.consumeTime, expectedCT.finishTime);
+    mTracker->trackGraphicsLatency(inputEventId3, token, expectedCT.graphicsTimeline);
+
+    triggerEventReporting(timeline.eventTime);
+    InputEventTimeline expectedTimeline2{timeline.eventTime, timeline.readTime,
+                                         timeline.vendorId,  timeline.productId,
+                                         timeline.sources,   timeline.inputEventActionType};
+    InputEventTimeline expectedTimeline3{timeline.eventTime, timeline.readTime,
+                                         timeline.vendorId,  timeline.productId,
+                                         timeline.sources,   timeline.inputEventActionType};
+    expectedTimeline3.connectionTimelines.emplace(token, std::move(expectedCT));
+    assertReceivedTimelines({expectedTimeline2, expectedTimeline3});
+}
+
 } // namespace android::inputdispatcher
@@ -419,6 +419,76 @@ TEST_F(PointerChoreographerTest, MouseMovesPointerAndReturnsNewArgs) {
             AllOf(WithCoords(110, 220), WithDisplayId(DISPLAY_ID), WithCursorPosition(110, 220)));
 }
 
+TEST_F(PointerChoreographerTest, MouseUnfadesPointerAtMostOncePerFrameInterval) {
+    mChoreographer.setDisplayViewports(createViewports({DISPLAY_ID}));
+    mChoreographer.setDefaultMouseDisplayId(DISPLAY_ID);
+    mChoreographer.notifyInputDevicesChanged(
+            {/*id=*/0,
+             {generateTestDeviceInfo(DEVICE_ID, AINPUT_SOURCE_MOUSE,
+                                     ui::LogicalDisplayId::INVALID)}});
+    auto pc = assertPointerControllerCreated(ControllerType::MOUSE);
+    const auto notifyMouseMove = [&](nsecs_t eventTime) {
+        mChoreographer.notifyMotion(
+                MotionArgsBuilder(AMOTION_EVENT_ACTION_HOVER_MOVE, AINPUT_SOURCE_MOUSE)
+                        .pointer(MOUSE_POINTER)
+                        .deviceId(DEVICE_ID)
+                        .displayId(ui::LogicalDisplayId::INVALID)
+                        .eventTime(eventTime)
+                        .build());
+    };
+
+    notifyMouseMove(ms2ns(100));
+    ASSERT_TRUE(pc->isPointerShown());
+
+    // The pointer is faded by something other than PointerChoreographer. The mouse events of the
+    // same frame interval don't unfade it again, but the first one after the interval does.
+    pc->fade(PointerControllerInterface::Transition::IMMEDIATE);
+    notifyMouseMove(ms2ns(101));
+    notifyMouseMove(ms2ns(110));
+    ASSERT_FALSE(pc->isPointerShown());
+    notifyMouseMove(ms2ns(120));
+    ASSERT_TRUE(pc->isPointerShown());
+
+    // Every event is still forwarded.
+    for (int i = 0; i < 4; i++) {
+        mTestListener.assertNotifyMotionWasCalled(WithDisplayId(DISPLAY_ID));
+    }
+}
+
+TEST_F(PointerChoreographerTest, MouseUnfadesPointerRightAfterPointerCaptureIsDisabled) {
+    mChoreographer.setDisplayViewports(createViewports({DISPLAY_ID}));
+    mChoreographer.setDefaultMouseDisplayId(DISPLAY_ID);
+    mChoreographer.notifyInputDevicesChanged(
+            {/*id=*/0,
+             {generateTestDeviceInfo(DEVICE_ID, AINPUT_SOURCE_MOUSE,
+                                     ui::LogicalDisplayId::INVALID)}});
+    auto pc = assertPointerControllerCreated(ControllerType::MOUSE);
+    const auto notifyMouseMove = [&](nsecs_t eventTime) {
+        mChoreographer.notifyMotion(
+                MotionArgsBuilder(AMOTION_EVENT_ACTION_HOVER_MOVE, AINPUT_SOURCE_MOUSE)
+                        .pointer(MOUSE_POINTER)
+                        .deviceId(DEVICE_ID)
+                        .displayId(ui::LogicalDisplayId::INVALID)
+                        .eventTime(eventTime)
+                        .build());
+    };
+
+    notifyMouseMove(ms2ns(100));
+    ASSERT_TRUE(pc->isPointerShown());
+
+    mChoreographer.notifyPointerCaptureChanged(
+            NotifyPointerCaptureChangedArgs(/*id=*/1, ms2ns(101),
+                                            PointerCaptureRequest(/*window=*/sp<BBinder>::make(),
+                                                                  /*seq=*/0)));
+    ASSERT_FALSE(pc->isPointerShown());
+    mChoreographer.notifyPointerCaptureChanged(
+            NotifyPointerCaptureChangedArgs(/*id=*/2, ms2ns(102), PointerCaptureRequest()));
+
+    // The pointer was faded by PointerChoreographer, so the next event unfades it right away.
+    notifyMouseMove(ms2ns(103));
+    ASSERT_TRUE(pc->isPointerShown());
+}
+
 TEST_F(PointerChoreographerTest, AbsoluteMouseMovesPointerAndReturnsNewArgs) {
     mChoreographer.setDisplayViewports(createViewports({DISPLAY_ID}));
     mChoreographer.setDefaultMouseDisplayId(DISPLAY_ID);
@@ -0,0 +1,76 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "../dispatcher/RecentEventHistory.h"
+
+#include <android-base/strings.h>
+#include <gtest/gtest.h>
+
+namespace android::inputdispatcher {
+
+namespace {
+
+KeyEntry createKeyEntry(int32_t id, nsecs_t eventTime) {
+    return KeyEntry(id, /*injectionState=*/nullptr, eventTime, /*deviceId=*/1,
+                    AINPUT_SOURCE_KEYBOARD, ui::LogicalDisplayId::DEFAULT, /*policyFlags=*/0,
+                    AKEY_EVENT_ACTION_DOWN, /*flags=*/0, AKEYCODE_A, /*scanCode=*/0,
+                    /*metaState=*/0, /*repeatCount=*/0, /*downTime=*/eventTime);
+}
+
+} // namespace
+
+// --- RecentEventHistoryTest ---
+
+TEST(RecentEventHistoryTest, Empty) {
+    RecentEventHistory history;
+
+    ASSERT_TRUE(history.empty());
+    ASSERT_EQ("", history.dump("", /*currentTime=*/0));
+}
+
+TEST(RecentEventHistoryTest, SensorEventsAreNotRecorded) {
+    RecentEventHistory history;
+
+    history.add(SensorEntry(/*id=*/1, /*eventTime=*/0, /*deviceId=*/1, AINPUT_SOURCE_SENSOR,
+                            /*policyFlags=*/0, /*hwTimestamp=*/0,
+                            InputDeviceSensorType::ACCELEROMETER,
+                            InputDeviceSensorAccuracy::HIGH, /*accuracyChanged=*/false,
+                            /*values=*/{}));
+
+    ASSERT_TRUE(history.empty());
+}
+
+TEST(RecentEventHistoryTest, OldestEventsAreOverwritten) {
+    RecentEventHistory history;
+
+    const size_t eventCount = RecentEventHistory::CAPACITY + 3;
+    for (int32_t i = 0; i < static_cast<int32_t>(eventCount); i++) {
+        history.add(createKeyEntry(/*id=*/i, /*eventTime=*/ms2ns(i)));
+    }
+
+    ASSERT_EQ(RecentEventHistory::CAPACITY, history.size());
+    const std::vector<std::string> lines =
+            base::Split(history.dump("", /*currentTime=*/ms2ns(eventCount)), "\n");
+    // The last line is empty, because the dump ends with a newline.
+    ASSERT_EQ(RecentEventHistory::CAPACITY + 1, lines.size());
+    // The events are dumped from the oldest to the newest one.
+    EXPECT_TRUE(base::EndsWith(lines.front(), ", age=" + std::to_string(eventCount - 3) + "ms"))
+            << lines.front();
+    EXPECT_TRUE(base::EndsWith(lines[RecentEventHistory::CAPACITY - 1], ", age=1ms"))
+            << lines[RecentEventHistory::CAPACITY - 1];
+}
+
+} // namespace android::inputdispatcher
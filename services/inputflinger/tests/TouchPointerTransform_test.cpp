@@ -0,0 +1,60 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "../reader/mapper/TouchPointerTransform.h"
+
+#include <gtest/gtest.h>
+
+namespace android {
+
+// --- TouchPointerTransformTest ---
+
+TEST(TouchPointerTransformTest, MatchesTransformingEachPointer) {
+    const TouchAffineTransformation calibration(1.02f, 0.01f, -3.5f, -0.01f, 0.98f, 4.25f);
+    ui::Transform scale;
+    scale.set(0.5f, 0, 0, 0.5f);
+    const ui::Transform rawToDisplay = ui::Transform(ui::Transform::ROT_90, 1080, 2400) * scale;
+
+    PointerCoordinateBatch batch;
+    for (size_t i = 0; i < MAX_POINTERS; i++) {
+        batch.x[i] = 37.f * i;
+        batch.y[i] = 2000.f - 113.f * i;
+    }
+    const PointerCoordinateBatch raw = batch;
+
+    transformPointerCoordinates(calibration, rawToDisplay, batch);
+
+    for (size_t i = 0; i < MAX_POINTERS; i++) {
+        vec2 expected = {raw.x[i], raw.y[i]};
+        calibration.applyTo(expected.x, expected.y);
+        expected = rawToDisplay.transform(expected);
+        EXPECT_FLOAT_EQ(expected.x, batch.x[i]) << "pointer " << i;
+        EXPECT_FLOAT_EQ(expected.y, batch.y[i]) << "pointer " << i;
+    }
+}
+
+TEST(TouchPointerTransformTest, IdentityLeavesCoordinatesUnchanged) {
+    PointerCoordinateBatch batch;
+    batch.x[0] = 12.5f;
+    batch.y[0] = -3.f;
+
+    transformPointerCoordinates(TouchAffineTransformation(), ui::Transform(), batch);
+
+    EXPECT_EQ(12.5f, batch.x[0]);
+    EXPECT_EQ(-3.f, batch.y[0]);
+}
+
+} // namespace android
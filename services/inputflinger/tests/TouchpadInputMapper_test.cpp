@@ -190,4 +190,21 @@ TEST_F(TouchpadInputMapperTest, TouchpadHardwareState) {
     mFakePolicy->assertTouchpadHardwareStateNotified();
 }
 
+TEST_F(TouchpadInputMapperTest, GesturesLibraryCpuTimeIsDumped) {
+    std::list<NotifyArgs> args;
+    args += process(EV_ABS, ABS_MT_TRACKING_ID, 1);
+    args += process(EV_KEY, BTN_TOUCH, 1);
+    setScanCodeState(KeyState::DOWN, {BTN_TOOL_FINGER});
+    args += process(EV_KEY, BTN_TOOL_FINGER, 1);
+    args += process(EV_ABS, ABS_MT_POSITION_X, 50);
+    args += process(EV_ABS, ABS_MT_POSITION_Y, 50);
+    args += process(EV_ABS, ABS_MT_PRESSURE, 1);
+    args += process(EV_SYN, SYN_REPORT, 0);
+
+    std::string dump;
+    mMapper->dump(dump);
+    EXPECT_THAT(dump, testing::HasSubstr("Hardware states: calls=1,"));
+    EXPECT_THAT(dump, testing::HasSubstr("Timer callbacks: <none>"));
+}
+
 } // namespace android
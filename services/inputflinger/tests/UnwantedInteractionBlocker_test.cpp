@@ -65,6 +65,14 @@ struct PointerData {
     float major;
 };
 
+static std::bitset<MAX_POINTER_ID + 1> pointerIds(std::initializer_list<int32_t> ids) {
+    std::bitset<MAX_POINTER_ID + 1> bits;
+    for (int32_t id : ids) {
+        bits.set(id);
+    }
+    return bits;
+}
+
 static NotifyMotionArgs generateMotionArgs(nsecs_t downTime, nsecs_t eventTime, int32_t action,
                                            const std::vector<PointerData>& points) {
     size_t pointerCount = points.size();
@@ -154,10 +162,10 @@ TEST(RemovePointerIdsTest, RemoveOnePointer) {
     NotifyMotionArgs args = generateMotionArgs(/*downTime=*/0, /*eventTime=*/0,
                                                AMOTION_EVENT_ACTION_MOVE, {{1, 2, 3}, {4, 5, 6}});
 
-    NotifyMotionArgs pointer1Only = removePointerIds(args, {0});
+    NotifyMotionArgs pointer1Only = removePointerIds(args, pointerIds({0}));
     assertArgs(pointer1Only, AMOTION_EVENT_ACTION_MOVE, {{1, {4, 5, 6}}});
 
-    NotifyMotionArgs pointer0Only = removePointerIds(args, {1});
+    NotifyMotionArgs pointer0Only = removePointerIds(args, pointerIds({1}));
     assertArgs(pointer0Only, AMOTION_EVENT_ACTION_MOVE, {{0, {1, 2, 3}}});
 }
 
@@ -169,7 +177,7 @@ TEST(RemovePointerIdsTest, RemoveTwoPointers) {
             generateMotionArgs(/*downTime=*/0, /*eventTime=*/0, AMOTION_EVENT_ACTION_MOVE,
                                {{1, 2, 3}, {4, 5, 6}, {7, 8, 9}});
 
-    NotifyMotionArgs pointer1Only = removePointerIds(args, {0, 2});
+    NotifyMotionArgs pointer1Only = removePointerIds(args, pointerIds({0, 2}));
     assertArgs(pointer1Only, AMOTION_EVENT_ACTION_MOVE, {{1, {4, 5, 6}}});
 }
 
@@ -181,10 +189,10 @@ TEST(RemovePointerIdsTest, ActionPointerDown) {
     NotifyMotionArgs args = generateMotionArgs(/*downTime=*/0, /*eventTime=*/0, POINTER_1_DOWN,
                                                {{1, 2, 3}, {4, 5, 6}, {7, 8, 9}});
 
-    NotifyMotionArgs pointers0And2 = removePointerIds(args, {1});
+    NotifyMotionArgs pointers0And2 = removePointerIds(args, pointerIds({1}));
     assertArgs(pointers0And2, ACTION_UNKNOWN, {{0, {1, 2, 3}}, {2, {7, 8, 9}}});
 
-    NotifyMotionArgs pointers1And2 = removePointerIds(args, {0});
+    NotifyMotionArgs pointers1And2 = removePointerIds(args, pointerIds({0}));
     assertArgs(pointers1And2, POINTER_0_DOWN, {{1, {4, 5, 6}}, {2, {7, 8, 9}}});
 }
 
@@ -195,7 +203,7 @@ TEST(RemovePointerIdsTest, RemoveAllPointersDuringMove) {
     NotifyMotionArgs args = generateMotionArgs(/*downTime=*/0, /*eventTime=*/0,
                                                AMOTION_EVENT_ACTION_MOVE, {{1, 2, 3}, {4, 5, 6}});
 
-    NotifyMotionArgs noPointers = removePointerIds(args, {0, 1});
+    NotifyMotionArgs noPointers = removePointerIds(args, pointerIds({0, 1}));
     ASSERT_EQ(0u, noPointers.getPointerCount());
 }
 
@@ -207,11 +215,11 @@ TEST(RemovePointerIdsTest, PointerDownBecomesDown) {
     NotifyMotionArgs args = generateMotionArgs(/*downTime=*/0, /*eventTime=*/0, POINTER_1_DOWN,
                                                {{1, 2, 3}, {4, 5, 6}, {7, 8, 9}});
 
-    NotifyMotionArgs pointer1 = removePointerIds(args, {0, 2});
+    NotifyMotionArgs pointer1 = removePointerIds(args, pointerIds({0, 2}));
     assertArgs(pointer1, DOWN, {{1, {4, 5, 6}}});
 
     args.action = POINTER_1_UP;
-    pointer1 = removePointerIds(args, {0, 2});
+    pointer1 = removePointerIds(args, pointerIds({0, 2}));
     assertArgs(pointer1, UP, {{1, {4, 5, 6}}});
 }
 
@@ -222,8 +230,8 @@ TEST(CancelSuppressedPointersTest, CanceledPointerDownIsDropped) {
     NotifyMotionArgs args = generateMotionArgs(/*downTime=*/0, /*eventTime=*/0, POINTER_1_DOWN,
                                                {{1, 2, 3}, {4, 5, 6}, {7, 8, 9}});
     std::vector<NotifyMotionArgs> result =
-            cancelSuppressedPointers(args, /*oldSuppressedPointerIds=*/{},
-                                     /*newSuppressedPointerIds=*/{1});
+            cancelSuppressedPointers(args, /*oldSuppressedPointerIds=*/pointerIds({}),
+                                     /*newSuppressedPointerIds=*/pointerIds({1}));
     ASSERT_TRUE(result.empty());
 }
 
@@ -234,8 +242,8 @@ TEST(CancelSuppressedPointersTest, SuppressedPointerUpIsDropped) {
     NotifyMotionArgs args = generateMotionArgs(/*downTime=*/0, /*eventTime=*/0, POINTER_1_UP,
                                                {{1, 2, 3}, {4, 5, 6}, {7, 8, 9}});
     std::vector<NotifyMotionArgs> result =
-            cancelSuppressedPointers(args, /*oldSuppressedPointerIds=*/{1},
-                                     /*newSuppressedPointerIds=*/{1});
+            cancelSuppressedPointers(args, /*oldSuppressedPointerIds=*/pointerIds({1}),
+                                     /*newSuppressedPointerIds=*/pointerIds({1}));
     ASSERT_TRUE(result.empty());
 }
 
@@ -246,8 +254,8 @@ TEST(CancelSuppressedPointersTest, SuppressedPointerIsRemovedDuringMove) {
     NotifyMotionArgs args = generateMotionArgs(/*downTime=*/0, /*eventTime=*/0, MOVE,
                                                {{1, 2, 3}, {4, 5, 6}, {7, 8, 9}});
     std::vector<NotifyMotionArgs> result =
-            cancelSuppressedPointers(args, /*oldSuppressedPointerIds=*/{1},
-                                     /*newSuppressedPointerIds=*/{1});
+            cancelSuppressedPointers(args, /*oldSuppressedPointerIds=*/pointerIds({1}),
+                                     /*newSuppressedPointerIds=*/pointerIds({1}));
     ASSERT_EQ(1u, result.size());
     assertArgs(result[0], MOVE, {{0, {1, 2, 3}}, {2, {7, 8, 9}}});
 }
@@ -261,8 +269,8 @@ TEST(CancelSuppressedPointersTest, NewlySuppressedPointerIsCanceled) {
     NotifyMotionArgs args = generateMotionArgs(/*downTime=*/0, /*eventTime=*/0, MOVE,
                                                {{1, 2, 3}, {4, 5, 6}, {7, 8, 9}});
     std::vector<NotifyMotionArgs> result =
-            cancelSuppressedPointers(args, /*oldSuppressedPointerIds=*/{},
-                                     /*newSuppressedPointerIds=*/{1});
+            cancelSuppressedPointers(args, /*oldSuppressedPointerIds=*/pointerIds({}),
+                                     /*newSuppressedPointerIds=*/pointerIds({1}));
     ASSERT_EQ(2u, result.size());
     assertArgs(result[0], POINTER_1_UP, {{0, {1, 2, 3}}, {1, {4, 5, 6}}, {2, {7, 8, 9}}});
     ASSERT_EQ(FLAG_CANCELED, result[0].flags);
@@ -276,8 +284,8 @@ TEST(CancelSuppressedPointersTest, NewlySuppressedPointerIsCanceled) {
 TEST(CancelSuppressedPointersTest, SingleSuppressedPointerIsCanceled) {
     NotifyMotionArgs args = generateMotionArgs(/*downTime=*/0, /*eventTime=*/0, MOVE, {{1, 2, 3}});
     std::vector<NotifyMotionArgs> result =
-            cancelSuppressedPointers(args, /*oldSuppressedPointerIds=*/{},
-                                     /*newSuppressedPointerIds=*/{0});
+            cancelSuppressedPointers(args, /*oldSuppressedPointerIds=*/pointerIds({}),
+                                     /*newSuppressedPointerIds=*/pointerIds({0}));
     ASSERT_EQ(1u, result.size());
     assertArgs(result[0], CANCEL, {{0, {1, 2, 3}}});
     ASSERT_EQ(FLAG_CANCELED, result[0].flags);
@@ -291,8 +299,8 @@ TEST(CancelSuppressedPointersTest, SuppressedPointer1GoingUpIsCanceled) {
     NotifyMotionArgs args = generateMotionArgs(/*downTime=*/0, /*eventTime=*/0, POINTER_1_UP,
                                                {{1, 2, 3}, {4, 5, 6}, {7, 8, 9}});
     std::vector<NotifyMotionArgs> result =
-            cancelSuppressedPointers(args, /*oldSuppressedPointerIds=*/{},
-                                     /*newSuppressedPointerIds=*/{1});
+            cancelSuppressedPointers(args, /*oldSuppressedPointerIds=*/pointerIds({}),
+                                     /*newSuppressedPointerIds=*/pointerIds({1}));
     ASSERT_EQ(1u, result.size());
     assertArgs(result[0], POINTER_1_UP, {{0, {1, 2, 3}}, {1, {4, 5, 6}}, {2, {7, 8, 9}}});
     ASSERT_EQ(FLAG_CANCELED, result[0].flags);
@@ -306,8 +314,8 @@ TEST(CancelSuppressedPointersTest, SuppressedPointer0GoingUpIsCanceled) {
     NotifyMotionArgs args = generateMotionArgs(/*downTime=*/0, /*eventTime=*/0, POINTER_0_UP,
                                                {{1, 2, 3}, {4, 5, 6}});
     std::vector<NotifyMotionArgs> result =
-            cancelSuppressedPointers(args, /*oldSuppressedPointerIds=*/{},
-                                     /*newSuppressedPointerIds=*/{0});
+            cancelSuppressedPointers(args, /*oldSuppressedPointerIds=*/pointerIds({}),
+                                     /*newSuppressedPointerIds=*/pointerIds({0}));
     ASSERT_EQ(1u, result.size());
     assertArgs(result[0], POINTER_0_UP, {{0, {1, 2, 3}}, {1, {4, 5, 6}}});
     ASSERT_EQ(FLAG_CANCELED, result[0].flags);
@@ -321,8 +329,8 @@ TEST(CancelSuppressedPointersTest, TwoNewlySuppressedPointersAreBothCanceled) {
     NotifyMotionArgs args =
             generateMotionArgs(/*downTime=*/0, /*eventTime=*/0, MOVE, {{1, 2, 3}, {4, 5, 6}});
     std::vector<NotifyMotionArgs> result =
-            cancelSuppressedPointers(args, /*oldSuppressedPointerIds=*/{},
-                                     /*newSuppressedPointerIds=*/{0, 1});
+            cancelSuppressedPointers(args, /*oldSuppressedPointerIds=*/pointerIds({}),
+                                     /*newSuppressedPointerIds=*/pointerIds({0, 1}));
     ASSERT_EQ(1u, result.size());
     assertArgs(result[0], CANCEL, {{0, {1, 2, 3}}, {1, {4, 5, 6}}});
     ASSERT_EQ(FLAG_CANCELED, result[0].flags);
@@ -337,8 +345,8 @@ TEST(CancelSuppressedPointersTest, TwoPointersAreCanceledDuringPointerUp) {
     NotifyMotionArgs args = generateMotionArgs(/*downTime=*/0, /*eventTime=*/0, POINTER_1_UP,
                                                {{1, 2, 3}, {4, 5, 6}});
     std::vector<NotifyMotionArgs> result =
-            cancelSuppressedPointers(args, /*oldSuppressedPointerIds=*/{1},
-                                     /*newSuppressedPointerIds=*/{0, 1});
+            cancelSuppressedPointers(args, /*oldSuppressedPointerIds=*/pointerIds({1}),
+                                     /*newSuppressedPointerIds=*/pointerIds({0, 1}));
     ASSERT_EQ(1u, result.size());
     assertArgs(result[0], CANCEL, {{0, {1, 2, 3}}});
     ASSERT_EQ(FLAG_CANCELED, result[0].flags);
@@ -352,8 +360,8 @@ TEST(CancelSuppressedPointersTest, NewPointerDownBecomesDown) {
     NotifyMotionArgs args = generateMotionArgs(/*downTime=*/0, /*eventTime=*/0, POINTER_2_DOWN,
                                                {{1, 2, 3}, {4, 5, 6}, {7, 8, 9}});
     std::vector<NotifyMotionArgs> result =
-            cancelSuppressedPointers(args, /*oldSuppressedPointerIds=*/{0, 1},
-                                     /*newSuppressedPointerIds=*/{0, 1});
+            cancelSuppressedPointers(args, /*oldSuppressedPointerIds=*/pointerIds({0, 1}),
+                                     /*newSuppressedPointerIds=*/pointerIds({0, 1}));
     ASSERT_EQ(1u, result.size());
     assertArgs(result[0], DOWN, {{2, {7, 8, 9}}});
     ASSERT_EQ(0, result[0].flags);
@@ -369,8 +377,8 @@ TEST(GetTouchesTest, ConvertDownEvent) {
     SlotState slotState;
     SlotState oldSlotState = slotState;
     slotState.update(args);
-    std::vector<::ui::InProgressTouchEvdev> touches =
-            getTouches(args, deviceInfo, oldSlotState, slotState);
+    std::vector<::ui::InProgressTouchEvdev> touches;
+    getTouches(args, deviceInfo, oldSlotState, slotState, touches);
     ASSERT_EQ(1u, touches.size());
     ::ui::InProgressTouchEvdev expected;
 
@@ -400,6 +408,34 @@ TEST(GetTouchesTest, ConvertDownEvent) {
     ASSERT_EQ(expected, touches[0]) << touches[0];
 }
 
+/**
+ * When a pointer goes up, its slot should be given to the next pointer that goes down, even if the
+ * pointers that were added after it are still down.
+ */
+TEST(SlotStateTest, SlotOfLiftedPointerIsReused) {
+    SlotState slotState;
+    slotState.update(generateMotionArgs(/*downTime=*/0, /*eventTime=*/0, DOWN, {{1, 2, 3}}));
+    slotState.update(generateMotionArgs(/*downTime=*/0, /*eventTime=*/1, POINTER_1_DOWN,
+                                        {{1, 2, 3}, {4, 5, 6}}));
+    ASSERT_EQ(0u, slotState.getSlotForPointerId(0));
+    ASSERT_EQ(1u, slotState.getSlotForPointerId(1));
+
+    NotifyMotionArgs pointer0Up = generateMotionArgs(/*downTime=*/0, /*eventTime=*/2, POINTER_0_UP,
+                                                     {{1, 2, 3}, {4, 5, 6}});
+    slotState.update(pointer0Up);
+    ASSERT_EQ(std::nullopt, slotState.getSlotForPointerId(0));
+    ASSERT_EQ(1u, slotState.getSlotForPointerId(1));
+
+    // Pointer 1 is now the first pointer, and pointer 2 goes down after it.
+    NotifyMotionArgs pointer2Down = generateMotionArgs(/*downTime=*/0, /*eventTime=*/3,
+                                                       POINTER_1_DOWN, {{4, 5, 6}, {7, 8, 9}});
+    pointer2Down.pointerProperties[0].id = 1;
+    pointer2Down.pointerProperties[1].id = 2;
+    slotState.update(pointer2Down);
+    ASSERT_EQ(1u, slotState.getSlotForPointerId(1));
+    ASSERT_EQ(0u, slotState.getSlotForPointerId(2));
+}
+
 // --- UnwantedInteractionBlockerTest ---
 
 class UnwantedInteractionBlockerTest : public testing::Test {
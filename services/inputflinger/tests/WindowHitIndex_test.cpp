@@ -0,0 +1,122 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "../WindowHitIndex.h"
+
+// atest inputflinger_tests:WindowHitIndexTest
+
+using android::gui::WindowInfo;
+using android::gui::WindowInfoHandle;
+using testing::ElementsAre;
+using testing::IsEmpty;
+
+namespace android::inputdispatcher {
+
+namespace {
+
+const Rect kDisplayBounds(1000, 1000);
+
+sp<WindowInfoHandle> makeWindow(const Rect& frame,
+                                std::optional<Region> touchableRegion = std::nullopt) {
+    WindowInfo info;
+    info.frame = frame;
+    info.touchableRegion = touchableRegion.value_or(Region(frame));
+    return sp<WindowInfoHandle>::make(info);
+}
+
+} // namespace
+
+TEST(WindowHitIndexTest, TouchCandidatesAreFrontToBack) {
+    const std::vector<sp<WindowInfoHandle>> windows = {
+            makeWindow(Rect(0, 0, 100, 100)),
+            makeWindow(Rect(500, 500, 600, 600)),
+            makeWindow(Rect(0, 0, 1000, 1000)),
+    };
+    const WindowHitIndex index(windows, ui::Transform(), kDisplayBounds);
+
+    EXPECT_THAT(index.getTouchCandidatesAt(50, 50), ElementsAre(0u, 2u));
+    EXPECT_THAT(index.getTouchCandidatesAt(550, 550), ElementsAre(1u, 2u));
+    EXPECT_THAT(index.getTouchCandidatesAt(900, 100), ElementsAre(2u));
+}
+
+TEST(WindowHitIndexTest, RightAndBottomEdgesAreOutside) {
+    const std::vector<sp<WindowInfoHandle>> windows = {makeWindow(Rect(0, 0, 100, 100))};
+    const WindowHitIndex index(windows, ui::Transform(), kDisplayBounds);
+
+    EXPECT_THAT(index.getTouchCandidatesAt(99.9f, 99.9f), ElementsAre(0u));
+    EXPECT_THAT(index.getTouchCandidatesAt(100, 50), IsEmpty());
+    EXPECT_THAT(index.getTouchCandidatesAt(50, 100), IsEmpty());
+}
+
+TEST(WindowHitIndexTest, TouchableRegionAndFrameAreIndexedSeparately) {
+    const std::vector<sp<WindowInfoHandle>> windows = {
+            makeWindow(Rect(0, 0, 200, 200), Region(Rect(0, 0, 50, 50))),
+    };
+    const WindowHitIndex index(windows, ui::Transform(), kDisplayBounds);
+
+    EXPECT_THAT(index.getTouchCandidatesAt(150, 150), IsEmpty());
+    EXPECT_THAT(index.getOcclusionCandidatesAt(150, 150), ElementsAre(0u));
+    EXPECT_THAT(index.getTouchCandidatesAt(25, 25), ElementsAre(0u));
+}
+
+TEST(WindowHitIndexTest, NonSplittingWindowsAreAlwaysTouchCandidates) {
+    const std::vector<sp<WindowInfoHandle>> windows = {
+            makeWindow(Rect(0, 0, 100, 100)),
+            makeWindow(Rect(500, 500, 600, 600)),
+    };
+    windows[0]->editInfo()->setInputConfig(WindowInfo::InputConfig::PREVENT_SPLITTING, true);
+    const WindowHitIndex index(windows, ui::Transform(), kDisplayBounds);
+
+    EXPECT_THAT(index.getTouchCandidatesAt(550, 550), ElementsAre(0u, 1u));
+}
+
+TEST(WindowHitIndexTest, PointsOutsideOfTheDisplayAreFound) {
+    const std::vector<sp<WindowInfoHandle>> windows = {
+            makeWindow(Rect(-500, -500, 2000, 2000)),
+    };
+    const WindowHitIndex index(windows, ui::Transform(), kDisplayBounds);
+
+    EXPECT_THAT(index.getTouchCandidatesAt(-100, 1500), ElementsAre(0u));
+    EXPECT_THAT(index.getOcclusionCandidatesAt(-100, 1500), ElementsAre(0u));
+    EXPECT_THAT(index.getTouchCandidatesAt(500, 500), ElementsAre(0u));
+}
+
+TEST(WindowHitIndexTest, WindowsAndPointsAreTransformedIntoLogicalDisplaySpace) {
+    // Rotated by 90 degrees into a 1000x1000 logical display.
+    const ui::Transform transform(ui::Transform::ROT_90, 1000, 1000);
+    const std::vector<sp<WindowInfoHandle>> windows = {makeWindow(Rect(0, 0, 100, 200))};
+    const WindowHitIndex index(windows, transform, kDisplayBounds);
+
+    EXPECT_THAT(index.getTouchCandidatesAt(50, 150), ElementsAre(0u));
+    EXPECT_THAT(index.getOcclusionCandidatesAt(50, 150), ElementsAre(0u));
+    EXPECT_THAT(index.getTouchCandidatesAt(150, 50), IsEmpty());
+}
+
+TEST(WindowHitIndexTest, IndexOf) {
+    const std::vector<sp<WindowInfoHandle>> windows = {
+            makeWindow(Rect(0, 0, 100, 100)),
+            makeWindow(Rect(0, 0, 100, 100)),
+    };
+    const WindowHitIndex index(windows, ui::Transform(), kDisplayBounds);
+
+    EXPECT_EQ(1u, index.indexOf(windows[1]));
+    EXPECT_EQ(std::nullopt, index.indexOf(makeWindow(Rect(0, 0, 100, 100))));
+}
+
+} // namespace android::inputdispatcher
@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *            http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "PowerHintSessionChannel"
+
+#include <powermanager/PowerHintSessionChannel.h>
+#include <utils/Log.h>
+#include <utils/Timers.h>
+
+using namespace aidl::android::hardware::power;
+
+using ChannelMessageContents = ChannelMessage::ChannelMessageContents;
+
+namespace android::power {
+
+std::unique_ptr<PowerHintSessionChannel> PowerHintSessionChannel::create(ChannelConfig&& config) {
+    if (config.writeFlagBitmask <= 0) {
+        ALOGE("Invalid write flag bit mask in channel config: %d", config.writeFlagBitmask);
+        return nullptr;
+    }
+    if (!config.eventFlagDescriptor.has_value()) {
+        // The default no-op FMQ implementation of Power HAL v5 returns a channel
+        // config without a shared event flag, so it is not usable.
+        ALOGE("No event flag descriptor found in channel config");
+        return nullptr;
+    }
+
+    std::unique_ptr<PowerHintSessionChannel> channel(new PowerHintSessionChannel());
+    channel->mMsgQueue = std::make_unique<MsgQueue>(std::move(config.channelDescriptor), true);
+    if (!channel->mMsgQueue->isValid()) {
+        ALOGE("Failed to set up hint session msg queue");
+        return nullptr;
+    }
+    channel->mFlagQueue = std::make_unique<FlagQueue>(std::move(*config.eventFlagDescriptor), true);
+    if (!channel->mFlagQueue->isValid()) {
+        ALOGE("Failed to set up hint session flag queue");
+        return nullptr;
+    }
+    if (hardware::EventFlag::createEventFlag(channel->mFlagQueue->getEventFlagWord(),
+                                             &channel->mEventFlag) != OK) {
+        ALOGE("Failed to set up hint session event flag");
+        return nullptr;
+    }
+    channel->mWriteMask = static_cast<uint32_t>(config.writeFlagBitmask);
+    return channel;
+}
+
+PowerHintSessionChannel::~PowerHintSessionChannel() {
+    if (mEventFlag != nullptr) {
+        hardware::EventFlag::deleteEventFlag(&mEventFlag);
+    }
+}
+
+bool PowerHintSessionChannel::reportActualWorkDuration(int32_t sessionId,
+                                                       const WorkDuration* durations,
+                                                       size_t count) {
+    return write<ChannelMessageContents::Tag::workDuration>(sessionId, durations, count);
+}
+
+bool PowerHintSessionChannel::updateTargetWorkDuration(int32_t sessionId,
+                                                       int64_t targetDurationNanos) {
+    return write<ChannelMessageContents::Tag::targetDuration>(sessionId, &targetDurationNanos, 1);
+}
+
+bool PowerHintSessionChannel::sendHint(int32_t sessionId, SessionHint hint) {
+    return write<ChannelMessageContents::Tag::hint>(sessionId, &hint, 1);
+}
+
+template <ChannelMessageContents::Tag T, class In>
+bool PowerHintSessionChannel::write(int32_t sessionId, const In* contents, size_t count) {
+    if (count == 0) {
+        return true;
+    }
+    if (mWriting.test_and_set(std::memory_order_acquire)) {
+        ALOGV("Hint session channel is busy, skip writing message with tag %hhd", T);
+        return false;
+    }
+
+    bool written = false;
+    MsgQueue::MemTransaction tx;
+    if (mMsgQueue->availableToWrite() < count) {
+        ALOGV("Not enough space in hint session channel for message with tag %hhd", T);
+    } else if (!mMsgQueue->beginWrite(count, &tx)) {
+        ALOGW("Failed to begin writing message with tag %hhd", T);
+    } else {
+        const int64_t now = uptimeNanos();
+        for (size_t i = 0; i < count; ++i) {
+            if constexpr (T == ChannelMessageContents::Tag::workDuration) {
+                const WorkDuration& duration = contents[i];
+                new (tx.getSlot(i)) ChannelMessage{
+                        .sessionID = sessionId,
+                        .timeStampNanos = (i == count - 1) ? now : duration.timeStampNanos,
+                        .data = ChannelMessageContents::make<ChannelMessageContents::Tag::
+                                                                     workDuration,
+                                                             WorkDurationFixedV1>({
+                                .durationNanos = duration.durationNanos,
+                                .workPeriodStartTimestampNanos =
+                                        duration.workPeriodStartTimestampNanos,
+                                .cpuDurationNanos = duration.cpuDurationNanos,
+                                .gpuDurationNanos = duration.gpuDurationNanos,
+                        }),
+                };
+            } else {
+                new (tx.getSlot(i)) ChannelMessage{
+                        .sessionID = sessionId,
+                        .timeStampNanos = now,
+                        .data = ChannelMessageContents::make<T, In>(In(contents[i])),
+                };
+            }
+        }
+        written = mMsgQueue->commitWrite(count);
+        if (!written) {
+            ALOGW("Failed to commit message with tag %hhd", T);
+        }
+    }
+    mWriting.clear(std::memory_order_release);
+
+    if (written) {
+        mEventFlag->wake(mWriteMask);
+    }
+    return written;
+}
+
+} // namespace android::power
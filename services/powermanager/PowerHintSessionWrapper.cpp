@@ -48,6 +48,17 @@ namespace android::power {
         return CACHE_SUPPORT(version, HalResult<void>::fromStatus(mSession->name untypedArgs)); \
     }
 
+// FWD_CHANNEL_CALL tries the FMQ channel first, and forwards the call to the
+// session object like FWD_CALL if the channel is not set up, busy or full.
+#define FWD_CHANNEL_CALL(version, name, args, untypedArgs, channelArgs)                         \
+    HalResult<void> PowerHintSessionWrapper::name args {                                        \
+        CHECK_SESSION(void)                                                                     \
+        if (mChannel != nullptr && mChannel->name channelArgs) {                                \
+            return HalResult<void>::ok();                                                       \
+        }                                                                                       \
+        return CACHE_SUPPORT(version, HalResult<void>::fromStatus(mSession->name untypedArgs)); \
+    }
+
 PowerHintSessionWrapper::PowerHintSessionWrapper(std::shared_ptr<IPowerHintSession>&& session)
       : mSession(session) {
     if (mSession != nullptr) {
@@ -59,13 +70,14 @@ PowerHintSessionWrapper::PowerHintSessionWrapper(std::shared_ptr<IPowerHintSessi
 // is no way to check for it, so in the future if a way to check that is added,
 // this will need to be updated.
 
-FWD_CALL(2, updateTargetWorkDuration, (int64_t in_targetDurationNanos), (in_targetDurationNanos));
-FWD_CALL(2, reportActualWorkDuration, (const std::vector<WorkDuration>& in_durations),
-         (in_durations));
+FWD_CHANNEL_CALL(2, updateTargetWorkDuration, (int64_t in_targetDurationNanos),
+                 (in_targetDurationNanos), (mSessionId, in_targetDurationNanos));
+FWD_CHANNEL_CALL(2, reportActualWorkDuration, (const std::vector<WorkDuration>& in_durations),
+                 (in_durations), (mSessionId, in_durations.data(), in_durations.size()));
 FWD_CALL(2, pause, (), ());
 FWD_CALL(2, resume, (), ());
 FWD_CALL(2, close, (), ());
-FWD_CALL(4, sendHint, (SessionHint in_hint), (in_hint));
+FWD_CHANNEL_CALL(4, sendHint, (SessionHint in_hint), (in_hint), (mSessionId, in_hint));
 FWD_CALL(4, setThreads, (const std::vector<int32_t>& in_threadIds), (in_threadIds));
 FWD_CALL(5, setMode, (SessionMode in_type, bool in_enabled), (in_type, in_enabled));
 
@@ -77,4 +89,10 @@ HalResult<SessionConfig> PowerHintSessionWrapper::getSessionConfig() {
                                                               std::move(config)));
 }
 
+void PowerHintSessionWrapper::setChannel(std::shared_ptr<PowerHintSessionChannel> channel,
+                                         int32_t sessionId) {
+    mChannel = std::move(channel);
+    mSessionId = sessionId;
+}
+
 } // namespace android::power
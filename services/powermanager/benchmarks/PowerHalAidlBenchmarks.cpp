@@ -24,16 +24,24 @@
 #include <benchmark/benchmark.h>
 #include <binder/IServiceManager.h>
 #include <binder/Status.h>
+#include <fmq/AidlMessageQueue.h>
 #include <powermanager/PowerHalLoader.h>
+#include <powermanager/PowerHintSessionChannel.h>
+#include <powermanager/PowerHintSessionWrapper.h>
 #include <testUtil.h>
 #include <chrono>
 
+using aidl::android::hardware::common::fmq::SynchronizedReadWrite;
 using aidl::android::hardware::power::Boost;
+using aidl::android::hardware::power::ChannelConfig;
+using aidl::android::hardware::power::ChannelMessage;
 using aidl::android::hardware::power::IPower;
 using aidl::android::hardware::power::IPowerHintSession;
 using aidl::android::hardware::power::Mode;
 using aidl::android::hardware::power::WorkDuration;
 using android::power::PowerHalLoader;
+using android::power::PowerHintSessionChannel;
+using android::power::PowerHintSessionWrapper;
 using std::chrono::microseconds;
 
 using namespace android;
@@ -203,6 +211,67 @@ static void BM_PowerHalAidlBenchmarks_reportActualWorkDuration(benchmark::State&
     runSessionBenchmark(state, &IPowerHintSession::reportActualWorkDuration, DURATIONS);
 }
 
+// Measures the cost of a single report through the session wrapper, which
+// makes a binder call to the HAL.
+static void BM_PowerHalAidlBenchmarks_wrapperReportActualWorkDuration(benchmark::State& state) {
+    std::shared_ptr<IPower> hal = PowerHalLoader::loadAidl();
+    if (hal == nullptr) {
+        ALOGV("Power HAL not available, skipping test...");
+        state.SkipWithMessage("Power HAL unavailable");
+        return;
+    }
+
+    std::vector<int32_t> threadIds{1};
+    std::shared_ptr<IPowerHintSession> session;
+    hal->createHintSession(1, 0, threadIds, 16666666L, &session);
+    if (session == nullptr) {
+        ALOGV("Power HAL doesn't support session, skipping test...");
+        state.SkipWithMessage("operation unsupported");
+        return;
+    }
+    PowerHintSessionWrapper wrapper(std::move(session));
+    const std::vector<WorkDuration> durations(DURATIONS.begin(),
+                                              DURATIONS.begin() + state.range(0));
+
+    while (state.KeepRunning()) {
+        auto ret = wrapper.reportActualWorkDuration(durations);
+        state.PauseTiming();
+        if (!ret.isOk()) state.SkipWithError(ret.errorMessage());
+        testDelaySpin(
+                std::chrono::duration_cast<std::chrono::duration<float>>(ONEWAY_API_DELAY).count());
+        state.ResumeTiming();
+    }
+    wrapper.close();
+}
+
+// Measures the cost of a single report through the FMQ channel, with a local
+// queue standing in for the HAL end, so this does not need a HAL.
+static void BM_PowerHalAidlBenchmarks_channelReportActualWorkDuration(benchmark::State& state) {
+    AidlMessageQueue<ChannelMessage, SynchronizedReadWrite> backendQueue(DURATIONS.size(), false);
+    AidlMessageQueue<int8_t, SynchronizedReadWrite> backendFlagQueue(1, true);
+    ChannelConfig config;
+    config.channelDescriptor = backendQueue.dupeDesc();
+    config.eventFlagDescriptor = backendFlagQueue.dupeDesc();
+    config.readFlagBitmask = 1;
+    config.writeFlagBitmask = 2;
+    std::unique_ptr<PowerHintSessionChannel> channel =
+            PowerHintSessionChannel::create(std::move(config));
+    if (channel == nullptr) {
+        state.SkipWithError("Failed to create channel");
+        return;
+    }
+
+    const size_t count = state.range(0);
+    std::vector<ChannelMessage> messages(DURATIONS.size());
+    while (state.KeepRunning()) {
+        bool written = channel->reportActualWorkDuration(1, DURATIONS.data(), count);
+        state.PauseTiming();
+        if (!written) state.SkipWithError("Channel write failed");
+        backendQueue.read(messages.data(), count);
+        state.ResumeTiming();
+    }
+}
+
 BENCHMARK(BM_PowerHalAidlBenchmarks_isBoostSupported)->DenseRange(FIRST_BOOST, LAST_BOOST, 1);
 BENCHMARK(BM_PowerHalAidlBenchmarks_isModeSupported)->DenseRange(FIRST_MODE, LAST_MODE, 1);
 BENCHMARK(BM_PowerHalAidlBenchmarks_setBoost)->DenseRange(FIRST_BOOST, LAST_BOOST, 1);
@@ -211,3 +280,5 @@ BENCHMARK(BM_PowerHalAidlBenchmarks_createHintSession)->Arg(1);
 BENCHMARK(BM_PowerHalAidlBenchmarks_getHintSessionPreferredRate);
 BENCHMARK(BM_PowerHalAidlBenchmarks_updateTargetWorkDuration);
 BENCHMARK(BM_PowerHalAidlBenchmarks_reportActualWorkDuration);
+BENCHMARK(BM_PowerHalAidlBenchmarks_wrapperReportActualWorkDuration)->Arg(1)->Arg(4);
+BENCHMARK(BM_PowerHalAidlBenchmarks_channelReportActualWorkDuration)->Arg(1)->Arg(4);
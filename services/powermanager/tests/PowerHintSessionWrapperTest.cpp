@@ -15,12 +15,21 @@
  */
 
 #include <aidl/android/hardware/power/IPowerHintSession.h>
+#include <fmq/AidlMessageQueue.h>
+#include <fmq/EventFlag.h>
+#include <powermanager/PowerHintSessionChannel.h>
 #include <powermanager/PowerHintSessionWrapper.h>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+using aidl::android::hardware::common::fmq::SynchronizedReadWrite;
+using aidl::android::hardware::power::ChannelConfig;
+using aidl::android::hardware::power::ChannelMessage;
 using aidl::android::hardware::power::IPowerHintSession;
+using aidl::android::hardware::power::WorkDuration;
+using android::AidlMessageQueue;
+using android::power::PowerHintSessionChannel;
 using android::power::PowerHintSessionWrapper;
 
 using namespace android;
@@ -138,3 +147,88 @@ TEST_F(PowerHintSessionWrapperTest, getSessionConfig) {
     auto status = mSession->getSessionConfig();
     ASSERT_TRUE(status.isOk());
 }
+
+class PowerHintSessionWrapperChannelTest : public PowerHintSessionWrapperTest {
+public:
+    void SetUp() override;
+
+protected:
+    static constexpr size_t kQueueSize = 4;
+    static constexpr int32_t kSessionId = 123;
+
+    ChannelConfig makeChannelConfig();
+
+    std::unique_ptr<AidlMessageQueue<ChannelMessage, SynchronizedReadWrite>> mBackendFmq;
+    std::unique_ptr<AidlMessageQueue<int8_t, SynchronizedReadWrite>> mBackendFlagQueue;
+};
+
+void PowerHintSessionWrapperChannelTest::SetUp() {
+    PowerHintSessionWrapperTest::SetUp();
+    mBackendFmq =
+            std::make_unique<AidlMessageQueue<ChannelMessage, SynchronizedReadWrite>>(kQueueSize,
+                                                                                      false);
+    mBackendFlagQueue = std::make_unique<AidlMessageQueue<int8_t, SynchronizedReadWrite>>(1, true);
+    auto channel = PowerHintSessionChannel::create(makeChannelConfig());
+    ASSERT_NE(nullptr, channel);
+    mSession->setChannel(std::move(channel), kSessionId);
+}
+
+ChannelConfig PowerHintSessionWrapperChannelTest::makeChannelConfig() {
+    ChannelConfig config;
+    config.channelDescriptor = mBackendFmq->dupeDesc();
+    config.eventFlagDescriptor = mBackendFlagQueue->dupeDesc();
+    config.readFlagBitmask = 1;
+    config.writeFlagBitmask = 2;
+    return config;
+}
+
+TEST_F(PowerHintSessionWrapperChannelTest, reportActualWorkDurationUsesChannel) {
+    EXPECT_CALL(*mMockSession.get(), reportActualWorkDuration(_)).Times(0);
+    std::vector<WorkDuration> durations(2);
+    durations[0].durationNanos = 1000;
+    durations[1].durationNanos = 2000;
+    auto status = mSession->reportActualWorkDuration(durations);
+    ASSERT_TRUE(status.isOk());
+
+    // Both durations are written in one transaction.
+    ASSERT_EQ(2u, mBackendFmq->availableToRead());
+    ChannelMessage messages[2];
+    ASSERT_TRUE(mBackendFmq->read(messages, 2));
+    for (size_t i = 0; i < 2; ++i) {
+        EXPECT_EQ(kSessionId, messages[i].sessionID);
+        ASSERT_EQ(ChannelMessage::ChannelMessageContents::Tag::workDuration,
+                  messages[i].data.getTag());
+        EXPECT_EQ(durations[i].durationNanos,
+                  messages[i]
+                          .data.get<ChannelMessage::ChannelMessageContents::Tag::workDuration>()
+                          .durationNanos);
+    }
+}
+
+TEST_F(PowerHintSessionWrapperChannelTest, updateTargetWorkDurationUsesChannel) {
+    EXPECT_CALL(*mMockSession.get(), updateTargetWorkDuration(_)).Times(0);
+    auto status = mSession->updateTargetWorkDuration(1000000000);
+    ASSERT_TRUE(status.isOk());
+
+    ChannelMessage message;
+    ASSERT_TRUE(mBackendFmq->read(&message, 1));
+    EXPECT_EQ(1000000000,
+              message.data.get<ChannelMessage::ChannelMessageContents::Tag::targetDuration>());
+}
+
+TEST_F(PowerHintSessionWrapperChannelTest, fallsBackToBinderWhenChannelIsFull) {
+    EXPECT_CALL(*mMockSession.get(), reportActualWorkDuration(_))
+            .WillOnce(Return(ndk::ScopedAStatus::ok()));
+    std::vector<WorkDuration> durations(kQueueSize + 1);
+    auto status = mSession->reportActualWorkDuration(durations);
+    ASSERT_TRUE(status.isOk());
+
+    // Nothing is written to the channel when the durations do not all fit.
+    EXPECT_EQ(0u, mBackendFmq->availableToRead());
+}
+
+TEST_F(PowerHintSessionWrapperChannelTest, createFailsWithoutEventFlag) {
+    ChannelConfig config = makeChannelConfig();
+    config.eventFlagDescriptor = std::nullopt;
+    EXPECT_EQ(nullptr, PowerHintSessionChannel::create(std::move(config)));
+}
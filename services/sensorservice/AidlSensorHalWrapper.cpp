@@ -186,18 +186,24 @@ ssize_t AidlSensorHalWrapper::pollFmq(sensors_event_t *buffer, size_t maxNumEven
         }
     }
 
-    size_t eventsToRead = std::min({availableEvents, maxNumEventsToRead, mEventBuffer.size()});
+    size_t eventsToRead =
+            std::min({availableEvents, maxNumEventsToRead,
+                      static_cast<size_t>(SensorEventQueue::MAX_RECEIVE_BUFFER_EVENT_COUNT)});
     if (eventsToRead > 0) {
-        if (mEventQueue->read(mEventBuffer.data(), eventsToRead)) {
+        // Convert the events in place in the FMQ, rather than copying them out of it first. The
+        // Sensors HAL can't write over them until the read is committed.
+        AidlMessageQueue<Event, SynchronizedReadWrite>::MemTransaction tx;
+        if (mEventQueue->beginRead(eventsToRead, &tx)) {
+            for (size_t i = 0; i < eventsToRead; i++) {
+                convertToSensorEvent(*tx.getSlot(i), &buffer[i]);
+            }
+            mEventQueue->commitRead(eventsToRead);
+
             // Notify the Sensors HAL that sensor events have been read. This is required to support
             // the use of writeBlocking by the Sensors HAL.
             if (mEventQueueFlag != nullptr) {
                 mEventQueueFlag->wake(asBaseType(ISensors::EVENT_QUEUE_FLAG_BITS_EVENTS_READ));
             }
-
-            for (size_t i = 0; i < eventsToRead; i++) {
-                convertToSensorEvent(mEventBuffer[i], &buffer[i]);
-            }
             eventsRead = eventsToRead;
         } else {
             ALOGW("Failed to read %zu events, currently %zu events available", eventsToRead,
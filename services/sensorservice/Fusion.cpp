@@ -465,9 +465,10 @@ void Fusion::predict(const vec3_t& w, float dT) {
     const mat33_t I33dT(dT);
     const mat33_t wx(crossMatrix(we, 0));
     const mat33_t wx2(wx*wx);
-    const float lwedT = length(we)*dT;
+    const float lwe = length(we);
+    const float lwedT = lwe*dT;
     const float hlwedT = 0.5f*lwedT;
-    const float ilwe = 1.f/length(we);
+    const float ilwe = 1.f/lwe;
     const float k0 = (1-cosf(lwedT))*(ilwe*ilwe);
     const float k1 = sinf(lwedT);
     const float k2 = cosf(hlwedT);
@@ -487,7 +488,25 @@ void Fusion::predict(const vec3_t& w, float dT) {
     if (x0.w < 0)
         x0 = -x0;
 
-    P = Phi*P*transpose(Phi) + GQGt;
+    // P = Phi*P*transpose(Phi) + GQGt
+    //
+    // The bottom row of Phi is | 0 I33 |, so instead of multiplying the 6x6 matrices, only the
+    // blocks that aren't multiplied by 0 or I33 are computed:
+    //
+    // Phi*P = | Phi00*P00 + Phi10*P01   Phi00*P10 + Phi10*P11 | = | M00 M10 |
+    //         |          P01                     P11          |   | P01 P11 |
+    //
+    // Phi*P*transpose(Phi) = | M00*Phi00t + M10*Phi10t      M10 |
+    //                        | P01*Phi00t + P11*Phi10t      P11 |
+    const mat33_t Phi00t(transpose(Phi[0][0]));
+    const mat33_t Phi10t(transpose(Phi[1][0]));
+    const mat33_t M00(Phi[0][0]*P[0][0] + Phi[1][0]*P[0][1]);
+    const mat33_t M10(Phi[0][0]*P[1][0] + Phi[1][0]*P[1][1]);
+    const mat33_t P01(P[0][1]*Phi00t + P[1][1]*Phi10t);
+    P[0][0] = M00*Phi00t + M10*Phi10t + GQGt[0][0];
+    P[1][0] = M10 + GQGt[1][0];
+    P[0][1] = P01 + GQGt[0][1];
+    P[1][1] += GQGt[1][1];
 
     checkState();
 }
@@ -21,6 +21,7 @@
 #include <frameworks/base/core/proto/android/service/sensor_service.proto.h>
 #include <utils/Timers.h>
 
+#include <algorithm>
 #include <inttypes.h>
 
 namespace android {
@@ -33,37 +34,76 @@ namespace {
 }// unnamed namespace
 
 RecentEventLogger::RecentEventLogger(int sensorType) :
+        RecentEventLogger(sensorType, logSizeBySensorType(sensorType)) {
+    // blank
+}
+
+RecentEventLogger::RecentEventLogger(int sensorType, size_t logSize) :
         mSensorType(sensorType), mEventSize(eventSizeBySensorType(mSensorType)),
-        mRecentEvents(logSizeBySensorType(sensorType)), mMaskData(false),
+        mLogSize(logSize), mSlots(new Slot[logSize]), mEventCount(0), mMaskData(false),
         mIsLastEventCurrent(false) {
     // blank
 }
 
 void RecentEventLogger::addEvent(const sensors_event_t& event) {
-    std::lock_guard<std::mutex> lk(mLock);
-    mRecentEvents.emplace(event);
-    mIsLastEventCurrent = true;
+    const uint64_t eventIndex = mEventCount.load(std::memory_order_relaxed);
+    Slot& slot = mSlots[eventIndex % mLogSize];
+    const uint64_t sequence = slot.mSequence.load(std::memory_order_relaxed);
+    slot.mSequence.store(sequence + 1, std::memory_order_relaxed);
+    // Keep the log from being written before the readers can see that the slot is being written.
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.mLog = SensorEventLog(event);
+    slot.mSequence.store(sequence + 2, std::memory_order_release);
+    mEventCount.store(eventIndex + 1, std::memory_order_release);
+    mIsLastEventCurrent.store(true, std::memory_order_relaxed);
 }
 
 bool RecentEventLogger::isEmpty() const {
-    return mRecentEvents.size() == 0;
+    return mEventCount.load(std::memory_order_relaxed) == 0;
 }
 
 void RecentEventLogger::setLastEventStale() {
-    std::lock_guard<std::mutex> lk(mLock);
-    mIsLastEventCurrent = false;
+    mIsLastEventCurrent.store(false, std::memory_order_relaxed);
+}
+
+bool RecentEventLogger::readEventLog(uint64_t eventIndex, SensorEventLog* outLog) const {
+    const Slot& slot = mSlots[eventIndex % mLogSize];
+    const uint64_t expectedSequence = 2 * (eventIndex / mLogSize + 1);
+    if (slot.mSequence.load(std::memory_order_acquire) != expectedSequence) {
+        return false;
+    }
+    *outLog = slot.mLog;
+    // Keep the log from being read after the sequence number is checked again.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot.mSequence.load(std::memory_order_relaxed) == expectedSequence;
+}
+
+std::vector<RecentEventLogger::SensorEventLog> RecentEventLogger::getRecentEvents() const {
+    const uint64_t eventCount = mEventCount.load(std::memory_order_acquire);
+    const uint64_t logCount = std::min<uint64_t>(eventCount, mLogSize);
+    std::vector<SensorEventLog> logs;
+    logs.reserve(logCount);
+    SensorEventLog log;
+    for (uint64_t i = 1; i <= logCount; ++i) {
+        // The oldest events may have been overwritten since eventCount was read.
+        if (!readEventLog(eventCount - i, &log)) {
+            break;
+        }
+        logs.push_back(log);
+    }
+    return logs;
 }
 
 std::string RecentEventLogger::dump() const {
-    std::lock_guard<std::mutex> lk(mLock);
+    const std::vector<SensorEventLog> recentEvents = getRecentEvents();
 
     //TODO: replace String8 with std::string completely in this function
     String8 buffer;
 
-    buffer.appendFormat("last %zu events\n", mRecentEvents.size());
+    buffer.appendFormat("last %zu events\n", recentEvents.size());
     int j = 0;
-    for (int i = mRecentEvents.size() - 1; i >= 0; --i) {
-        const auto& ev = mRecentEvents[i];
+    for (int i = recentEvents.size() - 1; i >= 0; --i) {
+        const auto& ev = recentEvents[i];
         struct tm * timeinfo = localtime(&(ev.mWallTime.tv_sec));
         buffer.appendFormat("\t%2d (ts=%.9f, wall=%02d:%02d:%02d.%03d) ",
                 ++j, ev.mEvent.timestamp/1e9, timeinfo->tm_hour, timeinfo->tm_min, timeinfo->tm_sec,
@@ -95,11 +135,11 @@ std::string RecentEventLogger::dump() const {
  */
 void RecentEventLogger::dump(util::ProtoOutputStream* proto) const {
     using namespace service::SensorEventsProto;
-    std::lock_guard<std::mutex> lk(mLock);
+    const std::vector<SensorEventLog> recentEvents = getRecentEvents();
 
-    proto->write(RecentEventsLog::RECENT_EVENTS_COUNT, int(mRecentEvents.size()));
-    for (int i = mRecentEvents.size() - 1; i >= 0; --i) {
-        const auto& ev = mRecentEvents[i];
+    proto->write(RecentEventsLog::RECENT_EVENTS_COUNT, int(recentEvents.size()));
+    for (int i = recentEvents.size() - 1; i >= 0; --i) {
+        const auto& ev = recentEvents[i];
         const uint64_t token = proto->start(RecentEventsLog::EVENTS);
         proto->write(Event::TIMESTAMP_SEC, float(ev.mEvent.timestamp) / 1e9f);
         proto->write(Event::WALL_TIMESTAMP_MS, ev.mWallTime.tv_sec * 1000LL
@@ -129,11 +169,11 @@ void RecentEventLogger::setFormat(std::string format) {
 }
 
 bool RecentEventLogger::populateLastEventIfCurrent(sensors_event_t *event) const {
-    std::lock_guard<std::mutex> lk(mLock);
-
-    if (mIsLastEventCurrent && mRecentEvents.size()) {
-        // Index 0 contains the latest event emplace()'ed
-        *event = mRecentEvents[0].mEvent;
+    const uint64_t eventCount = mEventCount.load(std::memory_order_acquire);
+    SensorEventLog log;
+    if (mIsLastEventCurrent.load(std::memory_order_relaxed) && eventCount > 0 &&
+            readEventLog(eventCount - 1, &log)) {
+        *event = log.mEvent;
         return true;
     } else {
         return false;
@@ -17,13 +17,14 @@
 #ifndef ANDROID_SENSOR_SERVICE_UTIL_RECENT_EVENT_LOGGER_H
 #define ANDROID_SENSOR_SERVICE_UTIL_RECENT_EVENT_LOGGER_H
 
-#include "RingBuffer.h"
 #include "SensorServiceUtils.h"
 
 #include <hardware/sensors.h>
 #include <utils/String8.h>
 
-#include <mutex>
+#include <atomic>
+#include <memory>
+#include <vector>
 
 namespace android {
 namespace SensorServiceUtil {
@@ -33,9 +34,15 @@ namespace SensorServiceUtil {
 // generated from the sensor are stored in this buffer.  The buffer is NOT cleared when the sensor
 // unregisters and as a result very old data in the dumpsys output can be seen, which is an intended
 // behavior.
+//
+// addEvent doesn't take a lock, so that recording the events doesn't slow down the poll loop. The
+// events must only be added by one thread at a time. Every slot of the buffer is guarded by a
+// sequence number, and readers skip the slots that are being written to while they read them.
 class RecentEventLogger : public Dumpable {
 public:
     explicit RecentEventLogger(int sensorType);
+    // Records the last logSize events of the sensor, instead of the default for its type.
+    RecentEventLogger(int sensorType, size_t logSize);
     void addEvent(const sensors_event_t& event);
 
     // Populate event with the last recorded sensor event if it is not stale. An event is
@@ -53,22 +60,40 @@ public:
 
 protected:
     struct SensorEventLog {
+        SensorEventLog() = default;
         explicit SensorEventLog(const sensors_event_t& e);
         timespec mWallTime;
         sensors_event_t mEvent;
     };
 
+    struct Slot {
+        // Odd while the log is being written. Once the n-th event that is written to this slot
+        // has been written, this is 2 * n.
+        std::atomic<uint64_t> mSequence{0};
+        SensorEventLog mLog;
+    };
+
+    // The recorded events, from the most recent to the oldest one.
+    std::vector<SensorEventLog> getRecentEvents() const;
+
     const int mSensorType;
     const size_t mEventSize;
+    const size_t mLogSize;
 
-    mutable std::mutex mLock;
-    RingBuffer<SensorEventLog> mRecentEvents;
+    std::unique_ptr<Slot[]> mSlots;
+    // The number of events that were ever added. The n-th event is written to the slot
+    // n % mLogSize.
+    std::atomic<uint64_t> mEventCount;
 
     bool mMaskData;
-    bool mIsLastEventCurrent;
+    std::atomic<bool> mIsLastEventCurrent;
 
 private:
     static size_t logSizeBySensorType(int sensorType);
+
+    // Copies the log of the event with the given index, unless that event has been overwritten
+    // or is being overwritten.
+    bool readEventLog(uint64_t eventIndex, SensorEventLog* outLog) const;
 };
 
 } // namespace SensorServiceUtil
@@ -36,6 +36,12 @@ namespace android {
 class SensorService;
 class BitTube;
 
+// A direct channel is one client provided buffer, into which the sensor device writes the events of
+// every sensor configured on the channel. The events of several sensors are therefore already
+// multiplexed in the buffer, and the client tells them apart by the report token of each event.
+// Only sensors that support direct report, and so not the virtual ones that are computed in
+// SensorService, can be configured: the device owns the write position of the buffer, which
+// SensorService cannot share without racing with it.
 class SensorService::SensorDirectConnection: public BnSensorEventConnection {
 public:
     SensorDirectConnection(const sp<SensorService>& service, uid_t uid, pid_t pid,
@@ -187,6 +187,15 @@ std::vector<int32_t> SensorService::SensorEventConnection::getActiveSensorHandle
     return list;
 }
 
+void SensorService::SensorEventConnection::getActiveSensorHandles(
+        std::vector<int32_t>* outHandles) const {
+    Mutex::Autolock _l(mConnectionLock);
+    outHandles->clear();
+    for (auto& it : mSensorInfo) {
+        outHandles->push_back(it.first);
+    }
+}
+
 bool SensorService::SensorEventConnection::hasSensor(int32_t handle) const {
     Mutex::Autolock _l(mConnectionLock);
     return mSensorInfo.count(handle) > 0;
@@ -222,6 +231,29 @@ void SensorService::SensorEventConnection::setFirstFlushPending(int32_t handle,
     }
 }
 
+void SensorService::SensorEventConnection::setDecimationPeriod(int32_t handle,
+                                                              nsecs_t samplingPeriodNs) {
+    Mutex::Autolock _l(mConnectionLock);
+    auto it = mSensorInfo.find(handle);
+    if (it != mSensorInfo.end()) {
+        it->second.mDecimationPeriodNs = samplingPeriodNs;
+    }
+}
+
+bool SensorService::SensorEventConnection::FlushInfo::shouldSendDecimated(
+        const sensors_event_t& event) {
+    if (mDecimationPeriodNs > 0) {
+        // Leave some room for the jitter of the timestamps, so that the events aren't sent at a
+        // lower rate than the one that was asked for.
+        const nsecs_t minInterval = mDecimationPeriodNs - mDecimationPeriodNs / 10;
+        if (mLastSentTimestamp != 0 && event.timestamp - mLastSentTimestamp < minInterval) {
+            return false;
+        }
+    }
+    mLastSentTimestamp = event.timestamp;
+    return true;
+}
+
 void SensorService::SensorEventConnection::updateLooperRegistration(const sp<Looper>& looper) {
     Mutex::Autolock _l(mConnectionLock);
     updateLooperRegistrationLocked(looper);
@@ -371,6 +403,46 @@ status_t SensorService::SensorEventConnection::sendEvents(
         }
     }
 
+    return sendFilteredEventsLocked(scratch, count);
+}
+
+status_t SensorService::SensorEventConnection::sendEvents(
+        sensors_event_t const* buffer, const std::vector<size_t>& eventIndices,
+        sensors_event_t* scratch,
+        wp<const SensorEventConnection> const * mapFlushEventsToConnections) {
+    int count = 0;
+    Mutex::Autolock _l(mConnectionLock);
+    for (size_t i : eventIndices) {
+        const bool isFlushCompleteEvent = buffer[i].type == SENSOR_TYPE_META_DATA;
+        const int32_t sensor_handle =
+                isFlushCompleteEvent ? buffer[i].meta_data.sensor : buffer[i].sensor;
+        // The connection may have unregistered for this sensor since the events were routed.
+        auto it = mSensorInfo.find(sensor_handle);
+        if (it == mSensorInfo.end()) {
+            continue;
+        }
+
+        FlushInfo& flushInfo = it->second;
+        if (isFlushCompleteEvent) {
+            if (mapFlushEventsToConnections[i] != this) {
+                continue;
+            }
+            if (flushInfo.mFirstFlushPending) {
+                flushInfo.mFirstFlushPending = false;
+                ALOGD_IF(DEBUG_CONNECTIONS, "First flush event for sensor==%d ", sensor_handle);
+                continue;
+            }
+            scratch[count++] = buffer[i];
+        } else if (!flushInfo.mFirstFlushPending && flushInfo.shouldSendDecimated(buffer[i]) &&
+                   hasSensorAccess() && noteOpIfRequired(buffer[i])) {
+            scratch[count++] = buffer[i];
+        }
+    }
+    return sendFilteredEventsLocked(scratch, count);
+}
+
+status_t SensorService::SensorEventConnection::sendFilteredEventsLocked(sensors_event_t* scratch,
+                                                                       int count) {
     sendPendingFlushEventsLocked();
     // Early return if there are no events for this connection.
     if (count == 0) {
@@ -750,6 +822,9 @@ status_t SensorService::SensorEventConnection::setEventRate(int handle, nsecs_t
         }
     }
     status_t ret = mService->setEventRate(this, handle, samplingPeriodNs, mOpPackageName);
+    if (ret == OK) {
+        setDecimationPeriod(handle, mService->getDecimationPeriod(handle, samplingPeriodNs));
+    }
     if (ret == OK && isSensorCapped) {
         if ((requestedSamplingPeriodNs >= SENSOR_SERVICE_CAPPED_SAMPLING_PERIOD_NS) ||
             !isRateCappedBasedOnPermission()) {
@@ -56,13 +56,23 @@ public:
 
     status_t sendEvents(sensors_event_t const* buffer, size_t count, sensors_event_t* scratch,
                         wp<const SensorEventConnection> const * mapFlushEventsToConnections = nullptr);
+    // Sends the events at the given indices of the buffer, which the caller has already routed to
+    // this connection because they are for the sensors that it registered for.
+    status_t sendEvents(sensors_event_t const* buffer, const std::vector<size_t>& eventIndices,
+                        sensors_event_t* scratch,
+                        wp<const SensorEventConnection> const * mapFlushEventsToConnections);
     bool hasSensor(int32_t handle) const;
     bool hasAnySensor() const;
     bool hasOneShotSensors() const;
     bool addSensor(int32_t handle);
     bool removeSensor(int32_t handle);
     std::vector<int32_t> getActiveSensorHandles() const;
+    // Same as above, but reuses the storage of outHandles.
+    void getActiveSensorHandles(std::vector<int32_t>* outHandles) const;
     void setFirstFlushPending(int32_t handle, bool value);
+    // Decimate the events of a continuous sensor to the sampling period this connection asked
+    // for. A period of zero sends all of the events.
+    void setDecimationPeriod(int32_t handle, nsecs_t samplingPeriodNs);
     void dump(String8& result);
     void dump(util::ProtoOutputStream* proto) const;
     bool needsWakeLock();
@@ -101,6 +111,10 @@ private:
     // emulates the behavior of flush().
     void sendPendingFlushEventsLocked();
 
+    // Writes the events that sendEvents has copied into scratch for this connection to the
+    // channel, or to the cache if the channel is full. mConnectionLock must be held.
+    status_t sendFilteredEventsLocked(sensors_event_t* scratch, int count);
+
     // Writes events from mEventCache to the socket.
     void writeToSocketFromCache();
 
@@ -174,7 +188,23 @@ private:
         // the events for the sensor are sent on that *connection*.
         bool mFirstFlushPending;
 
-        FlushInfo() : mPendingFlushEventsToSend(0), mFirstFlushPending(false) {}
+        // When another connection runs the sensor faster than this one asked for, only the events
+        // that are about this far apart are sent on this connection. Zero if the events aren't
+        // decimated.
+        nsecs_t mDecimationPeriodNs;
+
+        // The timestamp of the last event of this sensor that was sent on this connection.
+        int64_t mLastSentTimestamp;
+
+        FlushInfo()
+              : mPendingFlushEventsToSend(0),
+                mFirstFlushPending(false),
+                mDecimationPeriodNs(0),
+                mLastSentTimestamp(0) {}
+
+        // Whether the event should be sent, or dropped because it arrived too soon after the last
+        // event that was sent.
+        bool shouldSendDecimated(const sensors_event_t& event);
     };
     // protected by SensorService::mLock. Key for this map is the sensor handle.
     std::unordered_map<int32_t, FlushInfo> mSensorInfo;
@@ -30,6 +30,19 @@ const sensor_t DUMMY_SENSOR = {
         .name = "", .vendor = "", .stringType = "", .requiredPermission = ""};
 } //unnamed namespace
 
+size_t SensorInterface::processEvents(sensors_event_t* outEvents, size_t maxOutEvents,
+                                      const sensors_event_t* events, size_t count) {
+    size_t outCount = 0;
+    for (size_t i = 0; i < count && outCount < maxOutEvents; i++) {
+        if (process(&outEvents[outCount], events[i])) {
+            outCount++;
+        }
+    }
+    return outCount;
+}
+
+// ---------------------------------------------------------------------------
+
 BaseSensor::BaseSensor(const sensor_t& sensor) :
         mSensorDevice(SensorDevice::getInstance()),
         mSensor(&sensor, mSensorDevice.getHalDeviceVersion()) {
@@ -34,6 +34,11 @@ public:
 
     virtual bool process(sensors_event_t* outEvent, const sensors_event_t& event) = 0;
 
+    // Processes a span of events, and writes the events that they produce to outEvents. Stops
+    // once maxOutEvents events were written. Returns the number of events that were written.
+    virtual size_t processEvents(sensors_event_t* outEvents, size_t maxOutEvents,
+                                 const sensors_event_t* events, size_t count);
+
     virtual status_t activate(void* ident, bool enabled) = 0;
     virtual status_t setDelay(void* ident, int handle, int64_t ns) = 0;
     virtual status_t batch(void* ident, int handle, int /*flags*/, int64_t samplingPeriodNs,
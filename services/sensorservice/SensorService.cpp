@@ -162,7 +162,8 @@ static bool isAutomotive() {
 
 SensorService::SensorService()
     : mInitCheck(NO_INIT), mSocketBufferSize(SOCKET_BUFFER_SIZE_NON_BATCHED),
-      mWakeLockAcquired(false), mLastReportedProxIsActive(false) {
+      mWakeLockAcquired(false), mWakeLockHoldBudgetNs(0), mLastWakeUpEventsTimeNs(0),
+      mWakeUpEventsIntervalNs(0), mWakeLockReleaseTimeNs(0), mLastReportedProxIsActive(false) {
     mUidPolicy = new UidPolicy(this);
     mSensorPrivacyPolicy = new SensorPrivacyPolicy(this);
     mMicSensorPrivacyPolicy = new MicrophonePrivacyPolicy(this);
@@ -226,6 +227,8 @@ status_t SensorService::unregisterRuntimeSensor(int handle) {
     for (const sp<SensorEventConnection>& connection : connLock.getActiveConnections()) {
         connection->removeSensor(handle);
     }
+    // None of the connections have the sensor anymore.
+    removeSensorRecordLocked(handle);
 
     // If this was the last sensor for this device, remove its callback.
     bool deviceHasSensors = false;
@@ -472,6 +475,10 @@ void SensorService::onFirstRef() {
             }
 
             mWakeLockAcquired = false;
+            if (sensorservice_flags::sensor_service_hold_wake_lock_between_wake_up_events()) {
+                mWakeLockHoldBudgetNs = ms2ns(property_get_int32(
+                        "sensors.wake_lock_hold_budget_ms", DEFAULT_WAKE_LOCK_HOLD_BUDGET_MS));
+            }
             mLooper = new Looper(false);
             const size_t minBufferSize = SensorEventQueue::MAX_RECEIVE_BUFFER_EVENT_COUNT;
             mSensorEventBuffer = new sensors_event_t[minBufferSize];
@@ -655,6 +662,9 @@ status_t SensorService::dump(int fd, const Vector<String16>& args) {
                                 mSocketBufferSize/sizeof(sensors_event_t));
             result.appendFormat("WakeLock Status: %s \n", mWakeLockAcquired ? "acquired" :
                     "not held");
+            result.appendFormat("WakeLock hold budget = %" PRId64 " ms, wake up events interval = "
+                                "%" PRId64 " ms\n", ns2ms(mWakeLockHoldBudgetNs),
+                                ns2ms(mWakeUpEventsIntervalNs));
             result.appendFormat("Mode :");
             switch(mCurrentOperatingMode) {
                case NORMAL:
@@ -1066,9 +1076,11 @@ void SensorService::sendEventsToAllClients(
    // Send our events to clients. Check the state of wake lock for each client
    // and release the lock if none of the clients need it.
    bool needsWakeLock = false;
-   for (const sp<SensorEventConnection>& connection : activeConnections) {
-       connection->sendEvents(mSensorEventBuffer, count, mSensorEventScratch,
-                              mMapFlushEventsToConnections);
+   routeEventsToConnectionsLocked(activeConnections, count);
+   for (size_t i = 0; i < activeConnections.size(); i++) {
+       const sp<SensorEventConnection>& connection = activeConnections[i];
+       connection->sendEvents(mSensorEventBuffer, mEventIndicesByConnection[i],
+                              mSensorEventScratch, mMapFlushEventsToConnections);
        needsWakeLock |= connection->needsWakeLock();
        // If the connection has one-shot sensors, it may be cleaned up after
        // first trigger. Early check for one-shot sensors.
@@ -1082,6 +1094,38 @@ void SensorService::sendEventsToAllClients(
    }
 }
 
+void SensorService::routeEventsToConnectionsLocked(
+        const std::vector<sp<SensorEventConnection>>& activeConnections, ssize_t count) {
+    // Keep the storage of the table from one poll to the next.
+    for (auto& [handle, connectionIndices] : mConnectionsBySensorHandle) {
+        connectionIndices.clear();
+    }
+    for (size_t i = 0; i < activeConnections.size(); i++) {
+        activeConnections[i]->getActiveSensorHandles(&mSensorHandlesScratch);
+        for (int32_t handle : mSensorHandlesScratch) {
+            mConnectionsBySensorHandle[handle].push_back(i);
+        }
+    }
+
+    mEventIndicesByConnection.resize(activeConnections.size());
+    for (std::vector<size_t>& eventIndices : mEventIndicesByConnection) {
+        eventIndices.clear();
+    }
+    for (ssize_t i = 0; i < count; i++) {
+        const sensors_event_t& event = mSensorEventBuffer[i];
+        // The sensor of a flush_complete_event is in its meta_data, and event.sensor is zero.
+        const int32_t handle =
+                event.type == SENSOR_TYPE_META_DATA ? event.meta_data.sensor : event.sensor;
+        const auto it = mConnectionsBySensorHandle.find(handle);
+        if (it == mConnectionsBySensorHandle.end()) {
+            continue;
+        }
+        for (size_t connectionIndex : it->second) {
+            mEventIndicesByConnection[connectionIndex].push_back(static_cast<size_t>(i));
+        }
+    }
+}
+
 void SensorService::disconnectDynamicSensor(
     int handle,
     const std::vector<sp<SensorEventConnection>>& activeConnections) {
@@ -1094,6 +1138,8 @@ void SensorService::disconnectDynamicSensor(
    for (const sp<SensorEventConnection>& connection : activeConnections) {
         connection->removeSensor(handle);
    }
+   // None of the connections have the sensor anymore.
+   removeSensorRecordLocked(handle);
 }
 
 void SensorService::handleDeviceReconnection(SensorDevice& device) {
@@ -1166,9 +1212,12 @@ bool SensorService::threadLoop() {
         }
 
         if (wakeEvents > 0) {
+            noteWakeUpEventsLocked(systemTime());
             if (!mWakeLockAcquired) {
                 setWakeLockAcquiredLocked(true);
             }
+            // The wakelock may have been held since the previous wake up events.
+            mWakeLockReleaseTimeNs = 0;
             device.writeWakeLockHandled(wakeEvents);
         }
         recordLastValueLocked(mSensorEventBuffer, count);
@@ -1184,26 +1233,22 @@ bool SensorService::threadLoop() {
                         fusion.process(event[i]);
                     }
                 }
-                for (size_t i=0 ; i<size_t(count) && k<minBufferSize ; i++) {
-                    for (int handle : mActiveVirtualSensors) {
-                        if (count + k >= minBufferSize) {
-                            ALOGE("buffer too small to hold all events: "
-                                    "count=%zd, k=%zu, size=%zu",
-                                    count, k, minBufferSize);
-                            break;
-                        }
-                        sensors_event_t out;
-                        std::shared_ptr<SensorInterface> si = getSensorInterfaceFromHandle(handle);
-                        if (si == nullptr) {
-                            ALOGE("handle %d is not an valid virtual sensor", handle);
-                            continue;
-                        }
-
-                        if (si->process(&out, event[i])) {
-                            mSensorEventBuffer[count + k] = out;
-                            k++;
-                        }
+                // The fusion has already seen all of the events, so each virtual sensor can
+                // process the whole buffer at once.
+                for (int handle : mActiveVirtualSensors) {
+                    if (count + k >= minBufferSize) {
+                        ALOGE("buffer too small to hold all events: "
+                                "count=%zd, k=%zu, size=%zu",
+                                count, k, minBufferSize);
+                        break;
+                    }
+                    std::shared_ptr<SensorInterface> si = getSensorInterfaceFromHandle(handle);
+                    if (si == nullptr) {
+                        ALOGE("handle %d is not an valid virtual sensor", handle);
+                        continue;
                     }
+                    k += si->processEvents(&mSensorEventBuffer[count + k],
+                                           minBufferSize - count - k, event, size_t(count));
                 }
                 if (k) {
                     // record the last synthesized values
@@ -1344,6 +1389,7 @@ void SensorService::resetAllWakeLockRefCounts() {
 }
 
 void SensorService::setWakeLockAcquiredLocked(bool acquire) {
+    mWakeLockReleaseTimeNs = 0;
     if (acquire) {
         if (!mWakeLockAcquired) {
             acquire_wake_lock(PARTIAL_WAKE_LOCK, WAKE_LOCK_NAME);
@@ -1358,21 +1404,58 @@ void SensorService::setWakeLockAcquiredLocked(bool acquire) {
     }
 }
 
-bool SensorService::isWakeLockAcquired() {
+int SensorService::getWakeLockPollTimeoutMs() {
     Mutex::Autolock _l(mLock);
-    return mWakeLockAcquired;
+    if (!mWakeLockAcquired) {
+        return -1;
+    }
+    if (mWakeLockReleaseTimeNs != 0) {
+        return toMillisecondTimeoutDelay(systemTime(), mWakeLockReleaseTimeNs);
+    }
+    return 5000;
+}
+
+void SensorService::onWakeLockPollTimeout() {
+    {
+        Mutex::Autolock _l(mLock);
+        if (mWakeLockReleaseTimeNs != 0) {
+            // No connection needs the wakelock while it is held.
+            if (systemTime() >= mWakeLockReleaseTimeNs) {
+                setWakeLockAcquiredLocked(false);
+            }
+            return;
+        }
+    }
+    resetAllWakeLockRefCounts();
+}
+
+void SensorService::noteWakeUpEventsLocked(nsecs_t now) {
+    if (mLastWakeUpEventsTimeNs != 0) {
+        const nsecs_t interval = now - mLastWakeUpEventsTimeNs;
+        // An exponential moving average, so that a single late batch doesn't reset the estimate.
+        mWakeUpEventsIntervalNs = mWakeUpEventsIntervalNs == 0
+                ? interval
+                : (mWakeUpEventsIntervalNs * 3 + interval) / 4;
+    }
+    mLastWakeUpEventsTimeNs = now;
+}
+
+bool SensorService::shouldHoldWakeLockLocked(nsecs_t now) const {
+    if (mWakeLockHoldBudgetNs == 0 || mWakeUpEventsIntervalNs == 0) {
+        return false;
+    }
+    const nsecs_t nextWakeUpEventsTime = mLastWakeUpEventsTimeNs + mWakeUpEventsIntervalNs;
+    // If the next wake up events are already late, they may not come at all.
+    return now < nextWakeUpEventsTime && nextWakeUpEventsTime - now <= mWakeLockHoldBudgetNs;
 }
 
 bool SensorService::SensorEventAckReceiver::threadLoop() {
     ALOGD("new thread SensorEventAckReceiver");
     sp<Looper> looper = mService->getLooper();
     do {
-        bool wakeLockAcquired = mService->isWakeLockAcquired();
-        int timeout = -1;
-        if (wakeLockAcquired) timeout = 5000;
-        int ret = looper->pollOnce(timeout);
+        int ret = looper->pollOnce(mService->getWakeLockPollTimeoutMs());
         if (ret == ALOOPER_POLL_TIMEOUT) {
-           mService->resetAllWakeLockRefCounts();
+           mService->onWakeLockPollTimeout();
         }
     } while(!Thread::exitPending());
     return false;
@@ -1889,36 +1972,26 @@ status_t SensorService::resetToNormalModeLocked() {
 void SensorService::cleanupConnection(SensorEventConnection* c) {
     ConnectionSafeAutolock connLock = mConnectionHolder.lock(mLock);
     const wp<SensorEventConnection> connection(c);
-    size_t size = mActiveSensors.size();
-    ALOGD_IF(DEBUG_CONNECTIONS, "%zu active sensors", size);
-    for (size_t i=0 ; i<size ; ) {
-        int handle = mActiveSensors.keyAt(i);
-        if (c->hasSensor(handle)) {
-            ALOGD_IF(DEBUG_CONNECTIONS, "%zu: disabling handle=0x%08x", i, handle);
-            std::shared_ptr<SensorInterface> sensor = getSensorInterfaceFromHandle(handle);
-            if (sensor != nullptr) {
-                sensor->activate(c, false);
-            } else {
-                ALOGE("sensor interface of handle=0x%08x is null!", handle);
-            }
-            if (c->removeSensor(handle)) {
-                BatteryService::disableSensor(c->getUid(), handle);
-            }
+    // Only look at the sensors of this connection, rather than at all of the active sensors. The
+    // SensorRecords of the other sensors don't have this connection.
+    for (int handle : c->getActiveSensorHandles()) {
+        ALOGD_IF(DEBUG_CONNECTIONS, "disabling handle=0x%08x", handle);
+        std::shared_ptr<SensorInterface> sensor = getSensorInterfaceFromHandle(handle);
+        if (sensor != nullptr) {
+            sensor->activate(c, false);
+        } else {
+            ALOGE("sensor interface of handle=0x%08x is null!", handle);
+        }
+        if (c->removeSensor(handle)) {
+            BatteryService::disableSensor(c->getUid(), handle);
         }
-        SensorRecord* rec = mActiveSensors.valueAt(i);
-        ALOGE_IF(!rec, "mActiveSensors[%zu] is null (handle=0x%08x)!", i, handle);
-        ALOGD_IF(DEBUG_CONNECTIONS,
-                "removing connection %p for sensor[%zu].handle=0x%08x",
-                c, i, handle);
+        SensorRecord* rec = mActiveSensors.valueFor(handle);
+        ALOGE_IF(!rec, "mActiveSensors has no record for handle=0x%08x!", handle);
+        ALOGD_IF(DEBUG_CONNECTIONS, "removing connection %p for sensor handle=0x%08x", c, handle);
 
         if (rec && rec->removeConnection(connection)) {
             ALOGD_IF(DEBUG_CONNECTIONS, "... and it was the last connection");
-            mActiveSensors.removeItemsAt(i, 1);
-            mActiveVirtualSensors.erase(handle);
-            delete rec;
-            size--;
-        } else {
-            i++;
+            removeSensorRecordLocked(handle);
         }
     }
     c->updateLooperRegistration(mLooper);
@@ -2156,6 +2229,7 @@ status_t SensorService::enable(const sp<SensorEventConnection>& connection,
     }
 
     if (err == NO_ERROR) {
+        connection->setDecimationPeriod(handle, getDecimationPeriod(handle, samplingPeriodNs));
         ALOGD_IF(DEBUG_CONNECTIONS, "Calling activate on %d", handle);
         err = sensor->activate(connection.get(), true);
     }
@@ -2217,15 +2291,22 @@ status_t SensorService::cleanupWithoutDisableLocked(
         }
         // see if this sensor becomes inactive
         if (rec->removeConnection(connection)) {
-            mActiveSensors.removeItem(handle);
-            mActiveVirtualSensors.erase(handle);
-            delete rec;
+            removeSensorRecordLocked(handle);
         }
         return NO_ERROR;
     }
     return BAD_VALUE;
 }
 
+void SensorService::removeSensorRecordLocked(int handle) {
+    SensorRecord* rec = mActiveSensors.valueFor(handle);
+    if (rec != nullptr) {
+        mActiveSensors.removeItem(handle);
+        mActiveVirtualSensors.erase(handle);
+        delete rec;
+    }
+}
+
 status_t SensorService::setEventRate(const sp<SensorEventConnection>& connection,
         int handle, nsecs_t ns, const String16& opPackageName) {
     if (mInitCheck != NO_ERROR)
@@ -2248,6 +2329,19 @@ status_t SensorService::setEventRate(const sp<SensorEventConnection>& connection
     return sensor->setDelay(connection.get(), handle, ns);
 }
 
+nsecs_t SensorService::getDecimationPeriod(int handle, nsecs_t samplingPeriodNs) {
+    if (!sensorservice_flags::sensor_event_connection_decimate_events()) {
+        return 0;
+    }
+    // Only continuous sensors are decimated. Dropping the events of the other sensors would lose
+    // changes of their values, or triggers.
+    std::shared_ptr<SensorInterface> sensor = getSensorInterfaceFromHandle(handle);
+    if (sensor == nullptr || sensor->getSensor().getReportingMode() != AREPORTING_MODE_CONTINUOUS) {
+        return 0;
+    }
+    return samplingPeriodNs;
+}
+
 status_t SensorService::flushSensor(const sp<SensorEventConnection>& connection,
         const String16& opPackageName) {
     if (mInitCheck != NO_ERROR) return mInitCheck;
@@ -2559,7 +2653,16 @@ void SensorService::checkWakeLockStateLocked(ConnectionSafeAutolock* connLock) {
             break;
         }
     }
-    if (releaseLock) {
+    if (!releaseLock || mWakeLockReleaseTimeNs != 0) {
+        return;
+    }
+    const nsecs_t now = systemTime();
+    if (shouldHoldWakeLockLocked(now)) {
+        // Keep the wakelock until the next wake up events are expected, instead of releasing and
+        // acquiring it again. The looper is woken up to pick the release time as its timeout.
+        mWakeLockReleaseTimeNs = now + mWakeLockHoldBudgetNs;
+        mLooper->wake();
+    } else {
         setWakeLockAcquiredLocked(false);
     }
 }
@@ -64,6 +64,10 @@
 
 #define SENSOR_REGISTRATIONS_BUF_SIZE 500
 
+// The default longest time for which the wakelock is kept waiting for the next wake up events,
+// instead of being released and acquired again. Overridden by sensors.wake_lock_hold_budget_ms.
+#define DEFAULT_WAKE_LOCK_HOLD_BUDGET_MS 50
+
 // Apps that targets S+ and do not have HIGH_SAMPLING_RATE_SENSORS permission will be capped
 // at 200 Hz. The cap also applies to all requests when the mic toggle is flipped to on, regardless
 // of their target SDKs and permission.
@@ -186,6 +190,10 @@ public:
     status_t setEventRate(const sp<SensorEventConnection>& connection, int handle, nsecs_t ns,
                           const String16& opPackageName);
 
+    // The period to decimate the events of a sensor to, for a connection that asked for the given
+    // sampling period. Zero if the events of the sensor aren't decimated.
+    nsecs_t getDecimationPeriod(int handle, nsecs_t samplingPeriodNs);
+
     status_t flushSensor(const sp<SensorEventConnection>& connection,
                          const String16& opPackageName);
 
@@ -424,6 +432,8 @@ private:
     bool unregisterDynamicSensorLocked(int handle);
     status_t cleanupWithoutDisable(const sp<SensorEventConnection>& connection, int handle);
     status_t cleanupWithoutDisableLocked(const sp<SensorEventConnection>& connection, int handle);
+    // Deletes the SensorRecord of the sensor, if it is active. mLock must be held.
+    void removeSensorRecordLocked(int handle);
     void cleanupAutoDisabledSensorLocked(const sp<SensorEventConnection>& connection,
             sensors_event_t const* buffer, const int count);
     bool canAccessSensor(const Sensor& sensor, const char* operation,
@@ -441,7 +451,17 @@ private:
     // corresponding applications, if yes the wakelock is released.
     void checkWakeLockState();
     void checkWakeLockStateLocked(ConnectionSafeAutolock* connLock);
-    bool isWakeLockAcquired();
+    // Updates the estimate of the interval between the polls that returned wake up events.
+    void noteWakeUpEventsLocked(nsecs_t now);
+    // Whether the wakelock should be kept after all the wake up events have been acknowledged,
+    // because the next ones are expected within the hold budget.
+    bool shouldHoldWakeLockLocked(nsecs_t now) const;
+    // The timeout of the SensorEventAckReceiver looper: -1 when the wakelock isn't held, the time
+    // left before a held wakelock is released, or 5 seconds while acknowledgements are awaited.
+    int getWakeLockPollTimeoutMs();
+    // Called by SensorEventAckReceiver when its looper timed out. Releases a held wakelock whose
+    // hold has expired, or resets the wakelock ref counts if acknowledgements were not received.
+    void onWakeLockPollTimeout();
     bool isWakeUpSensorEvent(const sensors_event_t& event) const;
 
     sp<Looper> getLooper() const;
@@ -452,7 +472,7 @@ private:
     void resetAllWakeLockRefCounts();
 
     // Acquire or release wake_lock. If wake_lock is acquired, set the timeout in the looper to 5
-    // seconds and wake the looper.
+    // seconds and wake the looper. Either way, a hold of the wakelock is cancelled.
     void setWakeLockAcquiredLocked(bool acquire);
 
     // Send events from the event cache for this particular connection.
@@ -463,6 +483,11 @@ private:
         const std::vector<sp<SensorEventConnection>>& activeConnections,
         ssize_t count);
 
+    // Fill mEventIndicesByConnection with the events in the buffer that each of the active
+    // connections registered for.
+    void routeEventsToConnectionsLocked(
+            const std::vector<sp<SensorEventConnection>>& activeConnections, ssize_t count);
+
     // If SensorService is operating in RESTRICTED mode, only select whitelisted packages are
     // allowed to register for or call flush on sensors. Typically only cts test packages are
     // allowed.
@@ -563,10 +588,27 @@ private:
     std::unordered_set<int> mActiveVirtualSensors;
     SensorConnectionHolder mConnectionHolder;
     bool mWakeLockAcquired;
+    // The longest time for which the wakelock is kept after all the wake up events have been
+    // acknowledged, waiting for the next ones. 0 disables the hold.
+    nsecs_t mWakeLockHoldBudgetNs;
+    // The time of the last poll that returned wake up events, and the estimated interval between
+    // such polls. When the HAL batches wake up sensors, the interval grows with the batch latency,
+    // and the wakelock is no longer held between the batches.
+    nsecs_t mLastWakeUpEventsTimeNs;
+    nsecs_t mWakeUpEventsIntervalNs;
+    // The time at which a held wakelock is released, or 0 when the wakelock isn't being held.
+    nsecs_t mWakeLockReleaseTimeNs;
     sensors_event_t *mSensorEventBuffer, *mSensorEventScratch, *mRuntimeSensorEventBuffer;
     // WARNING: these SensorEventConnection instances must not be promoted to sp, except via
     // modification to add support for them in ConnectionSafeAutolock
     wp<const SensorEventConnection> * mMapFlushEventsToConnections;
+    // Routes the events of every poll only to the connections that registered for their sensors.
+    // Rebuilt by sendEventsToAllClients, and only used by it. The keys are sensor handles, and the
+    // values are indices into the active connections.
+    std::unordered_map<int32_t, std::vector<size_t>> mConnectionsBySensorHandle;
+    // The indices into mSensorEventBuffer of the events for each of the active connections.
+    std::vector<std::vector<size_t>> mEventIndicesByConnection;
+    std::vector<int32_t> mSensorHandlesScratch;
     std::unordered_map<int, SensorServiceUtil::RecentEventLogger*> mRecentEvent;
     Mode mCurrentOperatingMode;
     std::queue<sensors_event_t> mRuntimeSensorEventQueue;
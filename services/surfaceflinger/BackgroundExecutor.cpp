@@ -19,10 +19,13 @@
 #define LOG_TAG "BackgroundExecutor"
 #define ATRACE_TAG ATRACE_TAG_GRAPHICS
 
+#include <android-base/stringprintf.h>
+#include <common/FlagManager.h>
 #include <processgroup/sched_policy.h>
 #include <pthread.h>
 #include <sched.h>
 #include <utils/Log.h>
+#include <cinttypes>
 #include <mutex>
 
 #include "BackgroundExecutor.h"
@@ -38,9 +41,17 @@ void set_thread_priority(bool highPriority) {
     sched_setscheduler(gettid(), highPriority ? SCHED_FIFO : SCHED_NORMAL, &param);
 }
 
+template <typename T>
+void updateMax(std::atomic<T>& max, T value) {
+    T current = max.load(std::memory_order_relaxed);
+    while (value > current &&
+           !max.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
 } // anonymous namespace
 
-BackgroundExecutor::BackgroundExecutor(bool highPriority) {
+BackgroundExecutor::BackgroundExecutor(bool highPriority, const char* name) : mName(name) {
     // mSemaphore must be initialized before any calls to
     // BackgroundExecutor::sendCallbacks. For this reason, we initialize it
     // within the constructor instead of within mThread.
@@ -49,20 +60,21 @@ BackgroundExecutor::BackgroundExecutor(bool highPriority) {
         set_thread_priority(highPriority);
         while (!mDone) {
             LOG_ALWAYS_FATAL_IF(sem_wait(&mSemaphore), "sem_wait failed (%d)", errno);
-            auto callbacks = mCallbacksQueue.pop();
-            if (!callbacks) {
+            auto queued = mCallbacksQueue.pop();
+            if (!queued) {
                 continue;
             }
-            for (auto& callback : *callbacks) {
+            mQueueDepth.fetch_sub(1, std::memory_order_relaxed);
+            const nsecs_t latency = systemTime() - queued->queueTime;
+            mTotalQueueLatency.fetch_add(latency, std::memory_order_relaxed);
+            updateMax(mMaxQueueLatency, latency);
+            for (auto& callback : queued->callbacks) {
                 callback();
             }
+            mExecutedCount.fetch_add(1, std::memory_order_relaxed);
         }
     });
-    if (highPriority) {
-        pthread_setname_np(mThread.native_handle(), "BckgrndExec HP");
-    } else {
-        pthread_setname_np(mThread.native_handle(), "BckgrndExec LP");
-    }
+    pthread_setname_np(mThread.native_handle(), mName);
 }
 
 BackgroundExecutor::~BackgroundExecutor() {
@@ -75,7 +87,9 @@ BackgroundExecutor::~BackgroundExecutor() {
 }
 
 void BackgroundExecutor::sendCallbacks(Callbacks&& tasks) {
-    mCallbacksQueue.push(std::move(tasks));
+    const uint32_t depth = mQueueDepth.fetch_add(1, std::memory_order_relaxed) + 1;
+    updateMax(mMaxQueueDepth, depth);
+    mCallbacksQueue.push({std::move(tasks), systemTime()});
     LOG_ALWAYS_FATAL_IF(sem_post(&mSemaphore), "sem_post failed");
 }
 
@@ -92,4 +106,24 @@ void BackgroundExecutor::flushQueue() {
     cv.wait(lock, [&]() { return flushComplete; });
 }
 
+void BackgroundExecutor::dump(std::string& result) const {
+    const uint64_t executed = mExecutedCount.load();
+    const nsecs_t meanLatency =
+            executed ? mTotalQueueLatency.load() / static_cast<nsecs_t>(executed) : 0;
+    base::StringAppendF(&result,
+                        "  %s: queued=%u maxQueued=%u executed=%" PRIu64
+                        " meanQueueLatency=%.3fms maxQueueLatency=%.3fms\n",
+                        mName, mQueueDepth.load(), mMaxQueueDepth.load(), executed,
+                        static_cast<double>(meanLatency) / 1e6,
+                        static_cast<double>(mMaxQueueLatency.load()) / 1e6);
+}
+
+void BackgroundExecutor::dumpAll(std::string& result) {
+    getInstance().dump(result);
+    getLowPriorityInstance().dump(result);
+    if (FlagManager::getInstance().background_executor_callback_lane()) {
+        getCallbackInstance().dump(result);
+    }
+}
+
 } // namespace android
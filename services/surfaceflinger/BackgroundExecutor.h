@@ -18,41 +18,70 @@
 
 #include <ftl/small_vector.h>
 #include <semaphore.h>
+#include <utils/Timers.h>
+#include <atomic>
+#include <string>
 #include <thread>
 
 #include "LocklessQueue.h"
 
 namespace android {
 
-// Executes tasks off the main thread.
+// Executes tasks off the main thread. Each instance is a lane with its own queue and thread, so
+// that work sent to one lane never waits behind work sent to another.
 class BackgroundExecutor {
 public:
     ~BackgroundExecutor();
 
     static BackgroundExecutor& getInstance() {
-        static BackgroundExecutor instance(true);
+        static BackgroundExecutor instance(true, "BckgrndExec HP");
         return instance;
     }
 
     static BackgroundExecutor& getLowPriorityInstance() {
-        static BackgroundExecutor instance(false);
+        static BackgroundExecutor instance(false, "BckgrndExec LP");
         return instance;
     }
 
+    // High priority lane reserved for transaction completed callbacks, which clients wait on to
+    // start their next frame.
+    static BackgroundExecutor& getCallbackInstance() {
+        static BackgroundExecutor instance(true, "BckgrndExec CB");
+        return instance;
+    }
+
+    // Dumps the queue metrics of every lane in use.
+    static void dumpAll(std::string& result);
+
     using Callbacks = ftl::SmallVector<std::function<void()>, 10>;
     // Queues callbacks onto a work queue to be executed by a background thread.
     // This is safe to call from multiple threads.
     void sendCallbacks(Callbacks&& tasks);
     void flushQueue();
 
+    void dump(std::string& result) const;
+
 private:
-    BackgroundExecutor(bool highPriority);
+    BackgroundExecutor(bool highPriority, const char* name);
+
+    struct QueuedCallbacks {
+        Callbacks callbacks;
+        nsecs_t queueTime;
+    };
 
+    const char* const mName;
     sem_t mSemaphore;
     std::atomic_bool mDone = false;
 
-    LocklessQueue<Callbacks> mCallbacksQueue;
+    LocklessQueue<QueuedCallbacks> mCallbacksQueue;
     std::thread mThread;
+
+    // Queue metrics, updated without a lock by producers and the worker thread.
+    std::atomic<uint32_t> mQueueDepth = 0;
+    std::atomic<uint32_t> mMaxQueueDepth = 0;
+    std::atomic<uint64_t> mExecutedCount = 0;
+    std::atomic<nsecs_t> mTotalQueueLatency = 0;
+    std::atomic<nsecs_t> mMaxQueueLatency = 0;
 };
 
 } // namespace android
@@ -33,15 +33,37 @@ ANDROID_SINGLETON_STATIC_INSTANCE(ClientCache);
 
 ClientCache::ClientCache() : mDeathRecipient(sp<CacheDeathRecipient>::make()) {}
 
-bool ClientCache::getBuffer(const client_cache_t& cacheId,
+void ClientCache::Shard::lock() {
+    if (!mutex.try_lock()) {
+        contendedLockCount++;
+        mutex.lock();
+    }
+    lockCount++;
+}
+
+void ClientCache::Shard::lockShared() {
+    if (!mutex.try_lock_shared()) {
+        contendedLockCount++;
+        mutex.lock_shared();
+    }
+    lockCount++;
+}
+
+ClientCache::Shard& ClientCache::getShard(const wp<IBinder>& processToken) {
+    // Binder objects are heap allocated, so the low bits of their address carry no information.
+    const auto address = reinterpret_cast<uintptr_t>(processToken.unsafe_get());
+    return mShards[(address >> 4) % kShardCount];
+}
+
+bool ClientCache::getBuffer(Shard& shard, const client_cache_t& cacheId,
                             ClientCacheBuffer** outClientCacheBuffer) {
     auto& [processToken, id] = cacheId;
     if (processToken == nullptr) {
         ALOGE_AND_TRACE("ClientCache::getBuffer - invalid (nullptr) process token");
         return false;
     }
-    auto it = mBuffers.find(processToken);
-    if (it == mBuffers.end()) {
+    auto it = shard.buffers.find(processToken);
+    if (it == shard.buffers.end()) {
         ALOGE_AND_TRACE("ClientCache::getBuffer - invalid process token");
         return false;
     }
@@ -72,13 +94,14 @@ ClientCache::add(const client_cache_t& cacheId, const sp<GraphicBuffer>& buffer)
         return base::unexpected(AddError::Unspecified);
     }
 
-    std::lock_guard lock(mMutex);
+    Shard& shard = getShard(processToken);
+    ExclusiveLock lock(shard);
     sp<IBinder> token;
 
     // If this is a new process token, set a death recipient. If the client process dies, we will
     // get a callback through binderDied.
-    auto it = mBuffers.find(processToken);
-    if (it == mBuffers.end()) {
+    auto it = shard.buffers.find(processToken);
+    if (it == shard.buffers.end()) {
         token = processToken.promote();
         if (!token) {
             ALOGE_AND_TRACE("ClientCache::add - invalid token");
@@ -94,7 +117,7 @@ ClientCache::add(const client_cache_t& cacheId, const sp<GraphicBuffer>& buffer)
             }
         }
         auto [itr, success] =
-                mBuffers.emplace(processToken,
+                shard.buffers.emplace(processToken,
                                  std::make_pair(token,
                                                 std::unordered_map<uint64_t, ClientCacheBuffer>()));
         LOG_ALWAYS_FATAL_IF(!success, "failed to insert new process into client cache");
@@ -123,9 +146,10 @@ sp<GraphicBuffer> ClientCache::erase(const client_cache_t& cacheId) {
     auto& [processToken, id] = cacheId;
     std::vector<sp<ErasedRecipient>> pendingErase;
     {
-        std::lock_guard lock(mMutex);
+        Shard& shard = getShard(processToken);
+        ExclusiveLock lock(shard);
         ClientCacheBuffer* buf = nullptr;
-        if (!getBuffer(cacheId, &buf)) {
+        if (!getBuffer(shard, cacheId, &buf)) {
             ALOGE("failed to erase buffer, could not retrieve buffer");
             return nullptr;
         }
@@ -139,7 +163,7 @@ sp<GraphicBuffer> ClientCache::erase(const client_cache_t& cacheId) {
             }
         }
 
-        mBuffers[processToken].second.erase(id);
+        shard.buffers[processToken].second.erase(id);
     }
 
     for (auto& recipient : pendingErase) {
@@ -149,10 +173,11 @@ sp<GraphicBuffer> ClientCache::erase(const client_cache_t& cacheId) {
 }
 
 std::shared_ptr<renderengine::ExternalTexture> ClientCache::get(const client_cache_t& cacheId) {
-    std::lock_guard lock(mMutex);
+    Shard& shard = getShard(cacheId.token);
+    SharedLock lock(shard);
 
     ClientCacheBuffer* buf = nullptr;
-    if (!getBuffer(cacheId, &buf)) {
+    if (!getBuffer(shard, cacheId, &buf)) {
         ALOGE("failed to get buffer, could not retrieve buffer");
         return nullptr;
     }
@@ -162,10 +187,11 @@ std::shared_ptr<renderengine::ExternalTexture> ClientCache::get(const client_cac
 
 bool ClientCache::registerErasedRecipient(const client_cache_t& cacheId,
                                           const wp<ErasedRecipient>& recipient) {
-    std::lock_guard lock(mMutex);
+    Shard& shard = getShard(cacheId.token);
+    ExclusiveLock lock(shard);
 
     ClientCacheBuffer* buf = nullptr;
-    if (!getBuffer(cacheId, &buf)) {
+    if (!getBuffer(shard, cacheId, &buf)) {
         ALOGV("failed to register erased recipient, could not retrieve buffer");
         return false;
     }
@@ -175,10 +201,11 @@ bool ClientCache::registerErasedRecipient(const client_cache_t& cacheId,
 
 void ClientCache::unregisterErasedRecipient(const client_cache_t& cacheId,
                                             const wp<ErasedRecipient>& recipient) {
-    std::lock_guard lock(mMutex);
+    Shard& shard = getShard(cacheId.token);
+    ExclusiveLock lock(shard);
 
     ClientCacheBuffer* buf = nullptr;
-    if (!getBuffer(cacheId, &buf)) {
+    if (!getBuffer(shard, cacheId, &buf)) {
         ALOGE("failed to unregister erased recipient");
         return;
     }
@@ -193,9 +220,10 @@ void ClientCache::removeProcess(const wp<IBinder>& processToken) {
             ALOGE("failed to remove process, invalid (nullptr) process token");
             return;
         }
-        std::lock_guard lock(mMutex);
-        auto itr = mBuffers.find(processToken);
-        if (itr == mBuffers.end()) {
+        Shard& shard = getShard(processToken);
+        ExclusiveLock lock(shard);
+        auto itr = shard.buffers.find(processToken);
+        if (itr == shard.buffers.end()) {
             ALOGE("failed to remove process, could not find process");
             return;
         }
@@ -209,7 +237,7 @@ void ClientCache::removeProcess(const wp<IBinder>& processToken) {
                 }
             }
         }
-        mBuffers.erase(itr);
+        shard.buffers.erase(itr);
     }
 
     for (auto& [recipient, cacheId] : pendingErase) {
@@ -222,16 +250,32 @@ void ClientCache::CacheDeathRecipient::binderDied(const wp<IBinder>& who) {
 }
 
 void ClientCache::dump(std::string& result) {
-    std::lock_guard lock(mMutex);
-    for (const auto& [_, cache] : mBuffers) {
-        base::StringAppendF(&result, " Cache owner: %p\n", cache.first.get());
-
-        for (const auto& [id, entry] : cache.second) {
-            const auto& buffer = entry.buffer->getBuffer();
-            base::StringAppendF(&result, "\tID: %" PRIu64 ", size: %ux%u\n", id, buffer->getWidth(),
-                                buffer->getHeight());
+    for (size_t i = 0; i < kShardCount; i++) {
+        Shard& shard = mShards[i];
+        SharedLock lock(shard);
+        for (const auto& [_, cache] : shard.buffers) {
+            base::StringAppendF(&result, " Cache owner: %p\n", cache.first.get());
+
+            for (const auto& [id, entry] : cache.second) {
+                const auto& buffer = entry.buffer->getBuffer();
+                base::StringAppendF(&result, "\tID: %" PRIu64 ", size: %ux%u\n", id,
+                                    buffer->getWidth(), buffer->getHeight());
+            }
         }
     }
+
+    result.append(" Lock contention:\n");
+    for (size_t i = 0; i < kShardCount; i++) {
+        const Shard& shard = mShards[i];
+        const uint64_t lockCount = shard.lockCount;
+        const uint64_t contendedLockCount = shard.contendedLockCount;
+        if (lockCount == 0) continue;
+        base::StringAppendF(&result,
+                            "\tshard %zu: %" PRIu64 "/%" PRIu64 " acquisitions contended (%.2f%%)\n",
+                            i, contendedLockCount, lockCount,
+                            100.f * static_cast<float>(contendedLockCount) /
+                                    static_cast<float>(lockCount));
+    }
 }
 
 } // namespace android
@@ -18,14 +18,16 @@
 
 #include <android-base/thread_annotations.h>
 #include <binder/IBinder.h>
+#include <ftl/shared_mutex.h>
 #include <gui/LayerState.h>
 #include <renderengine/RenderEngine.h>
 #include <ui/GraphicBuffer.h>
 #include <utils/RefBase.h>
 #include <utils/Singleton.h>
 
+#include <array>
+#include <atomic>
 #include <map>
-#include <mutex>
 #include <set>
 #include <unordered_map>
 
@@ -46,6 +48,10 @@ namespace android {
 // both the SurfaceFlinger side of this other cache, as well as Composer HAL's
 // side of the cache.
 //
+// The cache is split into shards keyed by the caching process, each with its own lock, so that
+// binder threads serving different processes do not serialize on one another. Lookups only take
+// the shard lock for reading.
+//
 class ClientCache : public Singleton<ClientCache> {
 public:
     ClientCache();
@@ -78,16 +84,56 @@ public:
     void dump(std::string& result);
 
 private:
-    std::mutex mMutex;
+    static constexpr size_t kShardCount = 16;
 
     struct ClientCacheBuffer {
         std::shared_ptr<renderengine::ExternalTexture> buffer;
         std::set<wp<ErasedRecipient>> recipients;
     };
-    std::map<wp<IBinder> /*caching process*/,
-             std::pair<sp<IBinder> /*strong ref to caching process*/,
-                       std::unordered_map<uint64_t /*cache id*/, ClientCacheBuffer>>>
-            mBuffers GUARDED_BY(mMutex);
+
+    struct Shard {
+        ftl::SharedMutex mutex;
+        std::map<wp<IBinder> /*caching process*/,
+                 std::pair<sp<IBinder> /*strong ref to caching process*/,
+                           std::unordered_map<uint64_t /*cache id*/, ClientCacheBuffer>>>
+                buffers GUARDED_BY(mutex);
+
+        // Number of times the lock was taken, and how many of those had to wait for another
+        // thread to release it.
+        std::atomic<uint64_t> lockCount = 0;
+        std::atomic<uint64_t> contendedLockCount = 0;
+
+        void lock() ACQUIRE(mutex);
+        void unlock() RELEASE(mutex) { mutex.unlock(); }
+        void lockShared() ACQUIRE_SHARED(mutex);
+        void unlockShared() RELEASE_SHARED(mutex) { mutex.unlock_shared(); }
+    };
+
+    class SCOPED_CAPABILITY ExclusiveLock {
+    public:
+        explicit ExclusiveLock(Shard& shard) ACQUIRE(shard.mutex) : mShard(shard) {
+            shard.lock();
+        }
+        ~ExclusiveLock() RELEASE() { mShard.unlock(); }
+
+    private:
+        Shard& mShard;
+    };
+
+    class SCOPED_CAPABILITY SharedLock {
+    public:
+        explicit SharedLock(Shard& shard) ACQUIRE_SHARED(shard.mutex) : mShard(shard) {
+            shard.lockShared();
+        }
+        ~SharedLock() RELEASE() { mShard.unlockShared(); }
+
+    private:
+        Shard& mShard;
+    };
+
+    Shard& getShard(const wp<IBinder>& processToken);
+
+    std::array<Shard, kShardCount> mShards;
 
     class CacheDeathRecipient : public IBinder::DeathRecipient {
     public:
@@ -97,8 +143,8 @@ private:
     sp<CacheDeathRecipient> mDeathRecipient;
     renderengine::RenderEngine* mRenderEngine = nullptr;
 
-    bool getBuffer(const client_cache_t& cacheId, ClientCacheBuffer** outClientCacheBuffer)
-            REQUIRES(mMutex);
+    bool getBuffer(Shard& shard, const client_cache_t& cacheId,
+                   ClientCacheBuffer** outClientCacheBuffer) REQUIRES_SHARED(shard.mutex);
 };
 
 }; // namespace android
@@ -26,7 +26,9 @@
 #include <compositionengine/OutputColorSetting.h>
 #include <math/mat4.h>
 #include <scheduler/interface/ICompositor.h>
+#include <ui/DisplayId.h>
 #include <ui/FenceTime.h>
+#include <ui/LayerStack.h>
 #include <ui/Transform.h>
 
 namespace android::compositionengine {
@@ -87,6 +89,13 @@ struct CompositionRefreshArgs {
 
     scheduler::FrameTargets frameTargets;
 
+    // The display whose present fence drives FrameTimeline and the frame targeters.
+    std::optional<PhysicalDisplayId> pacesetterDisplayId;
+
+    // The layer stacks that have at least one layer with changes this frame. If unset, every layer
+    // stack is treated as changed.
+    std::optional<std::vector<ui::LayerStack>> changedLayerStacks;
+
     // The frameInterval for the next present
     // TODO (b/315371484): Calculate per display and store on `FrameTarget`.
     Fps frameInterval;
@@ -27,6 +27,7 @@
 
 #include <compositionengine/LayerFE.h>
 #include <ftl/future.h>
+#include <ftl/small_vector.h>
 #include <renderengine/LayerSettings.h>
 #include <ui/Fence.h>
 #include <ui/FenceTime.h>
@@ -157,6 +158,12 @@ public:
         // only has a value if there's something needing it, like when a TrustedPresentationListener
         // is set
         std::optional<Region> aboveCoveredLayersExcludingOverlays;
+
+        // The largest opaque rectangles accumulated into aboveOpaqueLayers. Layers whose bounds
+        // fall entirely within one of them are occluded, which can be decided without any
+        // Region arithmetic.
+        static constexpr size_t kMaxOpaqueRects = 4;
+        ftl::SmallVector<Rect, kMaxOpaqueRects> opaqueRects;
     };
 
     virtual ~Output();
@@ -274,6 +281,11 @@ public:
     // Make the next call to `present` run asynchronously.
     virtual void offloadPresentNextFrame() = 0;
 
+    // Starts updating and writing the composition state for the next call to
+    // `present` on another thread. `present` waits for this to complete before
+    // choosing the composition strategy.
+    virtual void updateCompositionStateAsync(const CompositionRefreshArgs&) = 0;
+
     // Enables predicting composition strategy to run client composition earlier
     virtual void setPredictCompositionStrategy(bool) = 0;
 
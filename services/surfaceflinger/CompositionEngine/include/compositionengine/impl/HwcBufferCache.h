@@ -92,6 +92,14 @@ public:
     //
     uint32_t uncache(uint64_t graphicBufferId);
 
+    // Counts of buffer handles sent to HWC and of sends avoided by reusing a cached slot.
+    struct Stats {
+        uint64_t bufferTransfers = 0;
+        uint64_t avoidedBufferTransfers = 0;
+        uint64_t evictions = 0;
+    };
+    const Stats& getStats() const { return mStats; }
+
 private:
     uint32_t cache(const sp<GraphicBuffer>& buffer);
     uint32_t getLeastRecentlyUsedSlot();
@@ -107,7 +115,8 @@ private:
     std::unordered_map<uint64_t, Cache> mCacheByBufferId;
     sp<GraphicBuffer> mLastOverrideBuffer;
     std::stack<uint32_t> mFreeSlots;
-    uint64_t mLeastRecentlyUsedCounter;
+    uint64_t mLeastRecentlyUsedCounter = 0;
+    Stats mStats;
 };
 
 } // namespace compositionengine::impl
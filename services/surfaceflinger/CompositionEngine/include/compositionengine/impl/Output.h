@@ -83,6 +83,7 @@ public:
     ftl::Future<std::monostate> present(const CompositionRefreshArgs&) override;
     bool supportsOffloadPresent() const override { return false; }
     void offloadPresentNextFrame() override;
+    void updateCompositionStateAsync(const CompositionRefreshArgs&) override;
 
     void uncacheBuffers(const std::vector<uint64_t>& bufferIdsToUncache) override;
     void rebuildLayerStacks(const CompositionRefreshArgs&, LayerFESet&) override;
@@ -125,6 +126,10 @@ public:
     virtual void resetCompositionStrategy();
     virtual ftl::Future<std::monostate> presentFrameAndReleaseLayersAsync(
             bool flushEvenWhenDisabled);
+    // Returns true if nothing sent to HWC for this output can have changed since the last
+    // present, so that validating and presenting again would be redundant.
+    virtual bool isNoOpFrame(const compositionengine::CompositionRefreshArgs&) const;
+    virtual void releaseLayersForNoOpFrame();
 
 protected:
     std::unique_ptr<compositionengine::OutputLayer> createOutputLayer(const sp<LayerFE>&) const;
@@ -173,6 +178,7 @@ private:
     compositionengine::Output::ColorProfile pickColorProfile(
             const compositionengine::CompositionRefreshArgs&) const;
     void updateHwcAsyncWorker();
+    void updateAndWriteCompositionState(const compositionengine::CompositionRefreshArgs&);
     float getHdrSdrRatio(const std::shared_ptr<renderengine::ExternalTexture>& buffer) const;
 
     std::string mName;
@@ -189,9 +195,17 @@ private:
 
     bool mPredictCompositionStrategy = false;
     bool mOffloadPresent = false;
+    bool mOffloadCompositionState = false;
+
+    // Valid while the composition state for the next call to `present` is being
+    // updated on mHwComposerAsyncWorker.
+    std::future<bool> mCompositionStateFuture;
 
     // Whether the content must be recomposed this frame.
     bool mMustRecompose = false;
+
+    // Whether a frame has been presented since this output was created.
+    bool mHasPresentedFrame = false;
 };
 
 // This template factory function standardizes the implementation details of the
@@ -75,6 +75,11 @@ protected:
 
 private:
     Rect calculateInitialCrop() const;
+    // Returns true if the geometry last written to HWC for this layer is still current, and
+    // otherwise records the geometry that is about to be written.
+    bool isWrittenGeometryCurrent(const LayerFECompositionState&,
+                                  aidl::android::hardware::graphics::composer3::Composition,
+                                  uint32_t z, bool isOverridden, bool skipLayer);
     void writeOutputDependentGeometryStateToHWC(
             HWC2::Layer*, aidl::android::hardware::graphics::composer3::Composition, uint32_t z);
     void writeOutputIndependentGeometryStateToHWC(HWC2::Layer*, const LayerFECompositionState&,
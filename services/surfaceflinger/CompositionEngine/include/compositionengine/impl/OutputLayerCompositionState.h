@@ -151,6 +151,25 @@ struct OutputLayerCompositionState {
 
         // True when this layer was skipped as part of SF-side layer caching.
         bool layerSkipped = false;
+
+        // The geometry most recently written for this layer while it was neither overridden nor
+        // skipped. Geometry is written for every layer whenever the output geometry changes, so
+        // this lets layers whose own geometry is unchanged skip the HWC calls.
+        struct Geometry {
+            Rect displayFrame;
+            FloatRect sourceCrop;
+            Hwc2::Transform bufferTransform;
+            uint32_t z;
+            aidl::android::hardware::graphics::composer3::Composition compositionType;
+            hardware::graphics::composer::hal::BlendMode blendMode;
+            float alpha;
+
+            bool operator==(const Geometry&) const = default;
+        };
+        std::optional<Geometry> writtenGeometry;
+
+        // Number of frames the geometry write was skipped because writtenGeometry was current.
+        uint64_t skippedGeometryWriteCount = 0;
     };
 
     // The HWC state is optional, and is only set up if there is any potential
@@ -254,6 +254,10 @@ private:
     size_t mCachedSetCreationCount = 0;
     size_t mCachedSetCreationCost = 0;
     std::unordered_map<size_t, size_t> mInvalidatedCachedSetAges;
+    size_t mCachedSetRenderCount = 0;
+    size_t mCachedSetRenderUseCount = 0;
+    size_t mCachedSetRenderDiscardCount = 0;
+    size_t mCachedSetRenderDeferCount = 0;
 };
 
 } // namespace compositionengine::impl::planner
@@ -32,7 +32,8 @@ namespace android::compositionengine::impl::planner {
 // memory, it is a simpler implementation to only manage screen-sized textures. The texture pool is
 // unbounded - there are a minimum number of textures preallocated. Under heavy system load, new
 // textures may be allocated, but only a maximum number of retained once those textures are no
-// longer necessary.
+// longer necessary. The number of retained textures is further limited by a byte budget, so that
+// large displays do not hold on to as many full-screen buffers as small ones.
 class TexturePool {
 public:
     // RAII class helping with managing textures from the texture pool
@@ -89,6 +90,11 @@ protected:
     // Proteted visibility so that they can be used for testing
     const static constexpr size_t kMinPoolSize = 3;
     const static constexpr size_t kMaxPoolSize = 4;
+    const static constexpr size_t kMaxPoolBytes = 80 * 1024 * 1024;
+
+    // The maximum number of textures retained for the current size, which is kMaxPoolSize unless
+    // that exceeds kMaxPoolBytes. At least one texture is always retained.
+    size_t getMaxPoolSizeForDisplaySize() const;
 
     struct Entry {
         std::shared_ptr<renderengine::ExternalTexture> texture;
@@ -103,9 +109,14 @@ private:
     void returnTexture(std::shared_ptr<renderengine::ExternalTexture>&& texture,
                        const sp<Fence>& fence);
     void allocatePool();
+    size_t getTextureBytes() const;
     renderengine::RenderEngine& mRenderEngine;
     ui::Size mSize;
     bool mEnabled;
+
+    // Statistics
+    size_t mBorrowedFromPoolCount = 0;
+    size_t mAllocatedOnBorrowCount = 0;
 };
 
 } // namespace android::compositionengine::impl::planner
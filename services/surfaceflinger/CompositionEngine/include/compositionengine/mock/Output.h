@@ -84,6 +84,7 @@ public:
                  ftl::Future<std::monostate>(const compositionengine::CompositionRefreshArgs&));
     MOCK_CONST_METHOD0(supportsOffloadPresent, bool());
     MOCK_METHOD(void, offloadPresentNextFrame, ());
+    MOCK_METHOD(void, updateCompositionStateAsync, (const CompositionRefreshArgs&));
 
     MOCK_METHOD1(uncacheBuffers, void(const std::vector<uint64_t>&));
     MOCK_METHOD2(rebuildLayerStacks,
@@ -90,12 +90,12 @@ nsecs_t CompositionEngine::getLastFrameRefreshTimestamp() const {
 }
 
 namespace {
-void offloadOutputs(Outputs& outputs) {
-    if (!FlagManager::getInstance().multithreaded_present() || outputs.size() < 2) {
-        return;
-    }
+using OutputsToOffload = ui::PhysicalDisplayVector<compositionengine::Output*>;
 
-    ui::PhysicalDisplayVector<compositionengine::Output*> outputsToOffload;
+// Returns the outputs whose work can be offloaded to another thread, or an empty
+// list if work for this frame should stay on the main thread.
+OutputsToOffload getOutputsToOffload(const Outputs& outputs) {
+    OutputsToOffload outputsToOffload;
     for (const auto& output : outputs) {
         if (!ftl::Optional(output->getDisplayId()).and_then(HalDisplayId::tryCast)) {
             // Not HWC-enabled, so it is always client-composited. No need to offload.
@@ -108,23 +108,41 @@ void offloadOutputs(Outputs& outputs) {
         // Only run present in multiple threads if all HWC-enabled displays
         // being refreshed support it.
         if (!output->supportsOffloadPresent()) {
-            return;
+            return {};
         }
         outputsToOffload.push_back(output.get());
     }
 
     if (outputsToOffload.size() < 2) {
-        return;
+        return {};
     }
 
     // Leave the last eligible display on the main thread, which will
     // allow it to run concurrently without an extra thread hop.
     outputsToOffload.pop_back();
+    return outputsToOffload;
+}
+
+void offloadOutputs(Outputs& outputs) {
+    if (!FlagManager::getInstance().multithreaded_present() || outputs.size() < 2) {
+        return;
+    }
 
-    for (compositionengine::Output* output : outputsToOffload) {
+    for (compositionengine::Output* output : getOutputsToOffload(outputs)) {
         output->offloadPresentNextFrame();
     }
 }
+
+void offloadCompositionState(const CompositionRefreshArgs& args) {
+    if (!FlagManager::getInstance().multithreaded_composition_state() ||
+        args.outputs.size() < 2) {
+        return;
+    }
+
+    for (compositionengine::Output* output : getOutputsToOffload(args.outputs)) {
+        output->updateCompositionStateAsync(args);
+    }
+}
 } // namespace
 
 void CompositionEngine::present(CompositionRefreshArgs& args) {
@@ -149,6 +167,11 @@ void CompositionEngine::present(CompositionRefreshArgs& args) {
     // be slow.
     offloadOutputs(args.outputs);
 
+    // Each offloaded output updates and writes its composition state on its own
+    // HwcAsyncWorker while the outputs ahead of it are presented. `present` waits
+    // for this to complete before validating with HWC.
+    offloadCompositionState(args);
+
     ui::DisplayVector<ftl::Future<std::monostate>> presentFutures;
     for (const auto& output : args.outputs) {
         presentFutures.push_back(output->present(args));
@@ -32,15 +32,19 @@ HwcSlotAndBuffer HwcBufferCache::getHwcSlotAndBuffer(const sp<GraphicBuffer>& bu
         Cache& cache = i->second;
         // mark this cache slot as more recently used so it won't get evicted anytime soon
         cache.lruCounter = mLeastRecentlyUsedCounter++;
+        mStats.avoidedBufferTransfers++;
         return {cache.slot, nullptr};
     }
+    mStats.bufferTransfers++;
     return {cache(buffer), buffer};
 }
 
 HwcSlotAndBuffer HwcBufferCache::getOverrideHwcSlotAndBuffer(const sp<GraphicBuffer>& buffer) {
     if (buffer == mLastOverrideBuffer) {
+        mStats.avoidedBufferTransfers++;
         return {kOverrideBufferSlot, nullptr};
     }
+    mStats.bufferTransfers++;
     mLastOverrideBuffer = buffer;
     return {kOverrideBufferSlot, buffer};
 }
@@ -81,6 +85,7 @@ uint32_t HwcBufferCache::getLeastRecentlyUsedSlot() {
         uint32_t slot = cacheToErase->second.slot;
         mCacheByBufferId.erase(cacheToErase);
         mFreeSlots.push(slot);
+        mStats.evictions++;
     }
     uint32_t slot = mFreeSlots.top();
     mFreeSlots.pop();
@@ -36,6 +36,7 @@
 #include <scheduler/FrameTargeter.h>
 #include <scheduler/Time.h>
 
+#include <algorithm>
 #include <optional>
 #include <thread>
 
@@ -98,6 +99,42 @@ ScaleVector getScale(const Rect& from, const Rect& to) {
             .y = static_cast<float>(to.height()) / from.height()};
 }
 
+bool contains(const Rect& outer, const Rect& inner) {
+    return outer.left <= inner.left && outer.top <= inner.top && outer.right >= inner.right &&
+            outer.bottom >= inner.bottom;
+}
+
+bool isOccludedByOpaqueRect(const Output::CoverageState& coverage, const Rect& bounds) {
+    return std::any_of(coverage.opaqueRects.begin(), coverage.opaqueRects.end(),
+                       [&](const Rect& opaque) { return contains(opaque, bounds); });
+}
+
+// Keeps the largest opaque rectangles seen so far, dropping any that the new one contains.
+void addOpaqueRect(Output::CoverageState& coverage, const Rect& rect) {
+    if (rect.isEmpty() || isOccludedByOpaqueRect(coverage, rect)) {
+        return;
+    }
+
+    auto& rects = coverage.opaqueRects;
+    rects.erase(std::remove_if(rects.begin(), rects.end(),
+                               [&](const Rect& opaque) { return contains(rect, opaque); }),
+                rects.end());
+
+    if (rects.size() < Output::CoverageState::kMaxOpaqueRects) {
+        rects.push_back(rect);
+        return;
+    }
+
+    const auto area = [](const Rect& r) { return int64_t{r.width()} * r.height(); };
+    const auto smallest = std::min_element(rects.begin(), rects.end(),
+                                           [&](const Rect& lhs, const Rect& rhs) {
+                                               return area(lhs) < area(rhs);
+                                           });
+    if (area(*smallest) < area(rect)) {
+        *smallest = rect;
+    }
+}
+
 } // namespace
 
 std::shared_ptr<Output> createOutput(
@@ -457,11 +494,23 @@ ftl::Future<std::monostate> Output::present(
                    stringifyExpectedPresentTime().c_str());
     ALOGV(__FUNCTION__);
 
-    updateColorProfile(refreshArgs);
-    updateCompositionState(refreshArgs);
-    planComposition();
-    writeCompositionState(refreshArgs);
+    if (mCompositionStateFuture.valid()) {
+        SFTRACE_NAME("Waiting on composition state");
+        mCompositionStateFuture.get();
+        // Only offload for this frame, leaving the HwcAsyncWorker in place for
+        // the same reasons as offloading present.
+        mOffloadCompositionState = false;
+    } else {
+        updateAndWriteCompositionState(refreshArgs);
+    }
     setColorTransform(refreshArgs);
+
+    if (FlagManager::getInstance().skip_noop_frame_present() && isNoOpFrame(refreshArgs)) {
+        SFTRACE_NAME("Skipping no-op frame");
+        releaseLayersForNoOpFrame();
+        return ftl::yield<std::monostate>({});
+    }
+
     beginFrame();
 
     if (isPowerHintSessionEnabled()) {
@@ -496,11 +545,78 @@ ftl::Future<std::monostate> Output::present(
     return future;
 }
 
+bool Output::isNoOpFrame(const compositionengine::CompositionRefreshArgs& refreshArgs) const {
+    const auto& outputState = getState();
+    const auto displayId = ftl::Optional(getDisplayId()).and_then(PhysicalDisplayId::tryCast);
+    if (!displayId || !outputState.isEnabled || !mHasPresentedFrame) {
+        return false;
+    }
+
+    // The pacesetter's present fence is consumed by FrameTimeline and the frame targeters every
+    // frame, so it must always be presented.
+    if (refreshArgs.pacesetterDisplayId == displayId) {
+        return false;
+    }
+
+    if (!refreshArgs.changedLayerStacks ||
+        std::find(refreshArgs.changedLayerStacks->begin(), refreshArgs.changedLayerStacks->end(),
+                  outputState.layerFilter.layerStack) != refreshArgs.changedLayerStacks->end()) {
+        return false;
+    }
+
+    if (refreshArgs.updatingOutputGeometryThisFrame || refreshArgs.updatingGeometryThisFrame ||
+        refreshArgs.colorTransformMatrix || refreshArgs.devOptForceClientComposition ||
+        refreshArgs.devOptFlashDirtyRegionsDelay || !refreshArgs.bufferIdsToUncache.empty()) {
+        return false;
+    }
+
+    if (outputState.displayBrightness || !getDirtyRegion().isEmpty() || !mReleasedLayers.empty()) {
+        return false;
+    }
+
+    return std::none_of(refreshArgs.layersWithQueuedFrames.begin(),
+                        refreshArgs.layersWithQueuedFrames.end(), [this](const auto& layerFE) {
+                            return getOutputLayerForLayer(layerFE) != nullptr;
+                        });
+}
+
+void Output::releaseLayersForNoOpFrame() {
+    // No buffer changed on this output, so HWC would not have returned a release fence for any
+    // of its layers.
+    const auto layerStack = getState().layerFilter.layerStack;
+    for (auto* layer : getOutputLayersOrderedByZ()) {
+        if (FlagManager::getInstance().ce_fence_promise()) {
+            layer->getLayerFE().setReleaseFence(Fence::NO_FENCE);
+        } else {
+            layer->getLayerFE().onLayerDisplayed(ftl::yield<FenceResult>(Fence::NO_FENCE).share(),
+                                                 layerStack);
+        }
+    }
+}
+
 void Output::offloadPresentNextFrame() {
     mOffloadPresent = true;
     updateHwcAsyncWorker();
 }
 
+void Output::updateCompositionStateAsync(
+        const compositionengine::CompositionRefreshArgs& refreshArgs) {
+    mOffloadCompositionState = true;
+    updateHwcAsyncWorker();
+    mCompositionStateFuture = mHwComposerAsyncWorker->send([this, &refreshArgs]() {
+        updateAndWriteCompositionState(refreshArgs);
+        return true;
+    });
+}
+
+void Output::updateAndWriteCompositionState(
+        const compositionengine::CompositionRefreshArgs& refreshArgs) {
+    updateColorProfile(refreshArgs);
+    updateCompositionState(refreshArgs);
+    planComposition();
+    writeCompositionState(refreshArgs);
+}
+
 void Output::uncacheBuffers(std::vector<uint64_t> const& bufferIdsToUncache) {
     if (bufferIdsToUncache.empty()) {
         return;
@@ -651,6 +767,14 @@ void Output::ensureOutputLayerIfVisible(sp<compositionengine::LayerFE>& layerFE,
         return;
     }
 
+    // A layer entirely behind an opaque rectangle above it contributes nothing to the coverage
+    // state, so skip the Region arithmetic below that would come to the same conclusion.
+    if (FlagManager::getInstance().output_occlusion_fast_path() &&
+        !computeAboveCoveredExcludingOverlays &&
+        isOccludedByOpaqueRect(coverage, visibleRegion.getBounds())) {
+        return;
+    }
+
     // Remove the transparent area from the visible region
     if (!layerFEState->isOpaque) {
         if (tr.preserveRects()) {
@@ -760,6 +884,9 @@ void Output::ensureOutputLayerIfVisible(sp<compositionengine::LayerFE>& layerFE,
 
     // Update accumAboveOpaqueLayers for next (lower) layer
     coverage.aboveOpaqueLayers.orSelf(opaqueRegion);
+    if (!opaqueRegion.isEmpty()) {
+        addOpaqueRect(coverage, visibleRect);
+    }
 
     // Compute the visible non-transparent region
     Region visibleNonTransparentRegion = visibleRegion.subtract(transparentRegion);
@@ -1600,6 +1727,7 @@ void Output::presentFrameAndReleaseLayers(bool flushEvenWhenDisabled) {
     outputState.dirtyRegion.clear();
 
     auto frame = presentFrame();
+    mHasPresentedFrame = true;
 
     mRenderSurface->onPresentDisplayCompleted();
 
@@ -1691,7 +1819,7 @@ void Output::setPredictCompositionStrategy(bool predict) {
 }
 
 void Output::updateHwcAsyncWorker() {
-    if (mPredictCompositionStrategy || mOffloadPresent) {
+    if (mPredictCompositionStrategy || mOffloadPresent || mOffloadCompositionState) {
         if (!mHwComposerAsyncWorker) {
             mHwComposerAsyncWorker = std::make_unique<HwcAsyncWorker>();
         }
@@ -15,6 +15,7 @@
  */
 #include <DisplayHardware/Hal.h>
 #include <android-base/stringprintf.h>
+#include <common/FlagManager.h>
 #include <compositionengine/DisplayColorProfile.h>
 #include <compositionengine/LayerFECompositionState.h>
 #include <compositionengine/Output.h>
@@ -404,9 +405,14 @@ void OutputLayer::writeStateToHWC(bool includeGeometry, bool skipLayer, uint32_t
             state.overrideInfo.buffer != nullptr || isPeekingThrough || zIsOverridden;
     const bool prevOverridden = state.hwc->stateOverridden;
     if (isOverridden || prevOverridden || skipLayer || includeGeometry) {
-        writeOutputDependentGeometryStateToHWC(hwcLayer.get(), requestedCompositionType, z);
-        writeOutputIndependentGeometryStateToHWC(hwcLayer.get(), *outputIndependentState,
-                                                 skipLayer);
+        if (isWrittenGeometryCurrent(*outputIndependentState, requestedCompositionType, z, isOverridden,
+                              skipLayer)) {
+            editState().hwc->skippedGeometryWriteCount++;
+        } else {
+            writeOutputDependentGeometryStateToHWC(hwcLayer.get(), requestedCompositionType, z);
+            writeOutputIndependentGeometryStateToHWC(hwcLayer.get(), *outputIndependentState,
+                                                     skipLayer);
+        }
     }
 
     writeOutputDependentPerFrameStateToHWC(hwcLayer.get());
@@ -424,6 +430,38 @@ void OutputLayer::writeStateToHWC(bool includeGeometry, bool skipLayer, uint32_t
     editState().hwc->layerSkipped = skipLayer;
 }
 
+bool OutputLayer::isWrittenGeometryCurrent(const LayerFECompositionState& outputIndependentState,
+                                    Composition requestedCompositionType, uint32_t z,
+                                    bool isOverridden, bool skipLayer) {
+    auto& hwcState = *editState().hwc;
+    const bool prevOverridden = hwcState.stateOverridden;
+    const bool prevSkipped = hwcState.layerSkipped;
+
+    // Overridden and skipped layers write values that do not come from the layer, and generic
+    // metadata is not worth comparing, so always write those.
+    if (!FlagManager::getInstance().output_layer_geometry_cache() || isOverridden ||
+        prevOverridden || skipLayer || prevSkipped || !outputIndependentState.metadata.empty()) {
+        hwcState.writtenGeometry.reset();
+        return false;
+    }
+
+    const auto& state = getState();
+    const OutputLayerCompositionState::Hwc::Geometry geometry{
+            .displayFrame = state.displayFrame,
+            .sourceCrop = state.sourceCrop,
+            .bufferTransform = state.bufferTransform,
+            .z = z,
+            .compositionType = requestedCompositionType,
+            .blendMode = outputIndependentState.blendMode,
+            .alpha = outputIndependentState.alpha,
+    };
+    if (hwcState.writtenGeometry == geometry) {
+        return true;
+    }
+    hwcState.writtenGeometry = geometry;
+    return false;
+}
+
 void OutputLayer::writeOutputDependentGeometryStateToHWC(HWC2::Layer* hwcLayer,
                                                          Composition requestedCompositionType,
                                                          uint32_t z) {
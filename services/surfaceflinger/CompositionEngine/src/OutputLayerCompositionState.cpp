@@ -40,6 +40,12 @@ void dumpHwc(const OutputLayerCompositionState::Hwc& hwc, std::string& out) {
     }
 
     dumpVal(out, "composition", toString(hwc.hwcCompositionType), hwc.hwcCompositionType);
+    dumpVal(out, "skippedGeometryWrites", hwc.skippedGeometryWriteCount);
+
+    const auto& bufferStats = hwc.hwcBufferCache.getStats();
+    dumpVal(out, "bufferTransfers", bufferStats.bufferTransfers);
+    dumpVal(out, "avoidedBufferTransfers", bufferStats.avoidedBufferTransfers);
+    dumpVal(out, "bufferEvictions", bufferStats.evictions);
 }
 
 } // namespace
@@ -177,6 +177,7 @@ void CachedSet::render(renderengine::RenderEngine& renderEngine, TexturePool& te
             .deviceHandlesColorTransform = deviceHandlesColorTransform,
             .orientation = orientation,
             .targetLuminanceNits = outputState.displayBrightnessNits,
+            .priority = renderengine::DisplaySettings::Priority::CachedSet,
     };
 
     LayerFE::ClientCompositionTargetSettings
@@ -19,6 +19,8 @@
 // #define LOG_NDEBUG 0
 #define ATRACE_TAG ATRACE_TAG_GRAPHICS
 
+#include <map>
+
 #include <android-base/properties.h>
 #include <common/FlagManager.h>
 #include <common/trace.h>
@@ -137,6 +139,7 @@ void Flattener::renderCachedSets(
 
             if (mNewCachedSet->getSkipCount() <=
                 mTunables.mRenderScheduling->maxDeferRenderAttempts) {
+                ++mCachedSetRenderDeferCount;
                 SFTRACE_FORMAT("DeadlinePassed: exceeded deadline by: %d us",
                                std::chrono::duration_cast<std::chrono::microseconds>(
                                        estimatedRenderFinish - *renderDeadline)
@@ -149,6 +152,7 @@ void Flattener::renderCachedSets(
     }
 
     mNewCachedSet->render(mRenderEngine, mTexturePool, outputState, deviceHandlesColorTransform);
+    ++mCachedSetRenderCount;
 }
 
 void Flattener::dumpLayers(std::string& result) const {
@@ -200,6 +204,22 @@ void Flattener::dump(std::string& result) const {
     base::StringAppendF(&result, "    Cost: %.2f\n",
                         static_cast<float>(mCachedSetCreationCost) / displayArea);
 
+    // A rendered cached set that is discarded before it is used cost GPU time for nothing, so the
+    // ratio of used to rendered sets tells how well the planner predicts stable layers.
+    base::StringAppendF(&result, "\n    Cached sets rendered: %zd\n", mCachedSetRenderCount);
+    base::StringAppendF(&result, "      Used: %zd\n", mCachedSetRenderUseCount);
+    base::StringAppendF(&result, "      Discarded before use: %zd\n",
+                        mCachedSetRenderDiscardCount);
+    base::StringAppendF(&result, "      Renders deferred past deadline: %zd\n",
+                        mCachedSetRenderDeferCount);
+
+    std::map<size_t, size_t> invalidatedAges(mInvalidatedCachedSetAges.cbegin(),
+                                             mInvalidatedCachedSetAges.cend());
+    result.append("\n    Invalidated cached set ages (in frames):\n");
+    for (const auto& [age, count] : invalidatedAges) {
+        base::StringAppendF(&result, "      % 4zd: %zd\n", age, count);
+    }
+
     const auto lastUpdate =
             std::chrono::duration_cast<std::chrono::milliseconds>(now - mLastGeometryUpdate);
     base::StringAppendF(&result, "\n  Current hash %016zx, last update %sago\n\n", mCurrentGeometry,
@@ -254,6 +274,9 @@ void Flattener::resetActivities(NonBufferHash hash, time_point now) {
 
     if (mNewCachedSet) {
         ++mInvalidatedCachedSetAges[mNewCachedSet->getAge()];
+        if (mNewCachedSet->hasRenderedBuffer()) {
+            ++mCachedSetRenderDiscardCount;
+        }
         mNewCachedSet = std::nullopt;
     }
 }
@@ -313,6 +336,9 @@ bool Flattener::mergeWithCachedSets(const std::vector<const LayerState*>& layers
             if (mNewCachedSet->hasBufferUpdate()) {
                 ALOGV("[%s] Dropping new cached set", __func__);
                 ++mInvalidatedCachedSetAges[0];
+                if (mNewCachedSet->hasRenderedBuffer()) {
+                    ++mCachedSetRenderDiscardCount;
+                }
                 mNewCachedSet = std::nullopt;
             } else if (mNewCachedSet->hasReadyBuffer()) {
                 ALOGV("[%s] Found ready buffer", __func__);
@@ -347,6 +373,7 @@ bool Flattener::mergeWithCachedSets(const std::vector<const LayerState*>& layers
                     skipCount -= layerCount;
                 }
                 priorBlurLayer = mNewCachedSet->getBlurLayer();
+                ++mCachedSetRenderUseCount;
                 merged.emplace_back(std::move(*mNewCachedSet));
                 mNewCachedSet = std::nullopt;
                 continue;
@@ -23,15 +23,30 @@
 #include <renderengine/impl/ExternalTexture.h>
 #include <utils/Log.h>
 
+#include <algorithm>
+
 namespace android::compositionengine::impl::planner {
 
+size_t TexturePool::getTextureBytes() const {
+    constexpr size_t kBytesPerPixel = 4; // RGBA_8888
+    return static_cast<size_t>(mSize.getWidth()) * static_cast<size_t>(mSize.getHeight()) *
+            kBytesPerPixel;
+}
+
+size_t TexturePool::getMaxPoolSizeForDisplaySize() const {
+    const size_t textureBytes = getTextureBytes();
+    if (textureBytes == 0) {
+        return kMaxPoolSize;
+    }
+    return std::clamp(kMaxPoolBytes / textureBytes, size_t(1), kMaxPoolSize);
+}
+
 void TexturePool::allocatePool() {
     mPool.clear();
     if (mEnabled && mSize.isValid()) {
-        mPool.resize(kMinPoolSize);
-        std::generate_n(mPool.begin(), kMinPoolSize, [&]() {
-            return Entry{genTexture(), nullptr};
-        });
+        const size_t poolSize = std::min(kMinPoolSize, getMaxPoolSizeForDisplaySize());
+        mPool.resize(poolSize);
+        std::generate_n(mPool.begin(), poolSize, [&]() { return Entry{genTexture(), nullptr}; });
     }
 }
 
@@ -45,9 +60,11 @@ void TexturePool::setDisplaySize(ui::Size size) {
 
 std::shared_ptr<TexturePool::AutoTexture> TexturePool::borrowTexture() {
     if (mPool.empty()) {
+        mAllocatedOnBorrowCount++;
         return std::make_shared<AutoTexture>(*this, genTexture(), nullptr);
     }
 
+    mBorrowedFromPoolCount++;
     const auto entry = mPool.front();
     mPool.pop_front();
     return std::make_shared<AutoTexture>(*this, entry.texture, entry.fence);
@@ -71,9 +88,9 @@ void TexturePool::returnTexture(std::shared_ptr<renderengine::ExternalTexture>&&
     }
 
     // Also ensure the pool does not grow beyond a maximum size.
-    if (mPool.size() == kMaxPoolSize) {
+    if (const size_t maxPoolSize = getMaxPoolSizeForDisplaySize(); mPool.size() >= maxPoolSize) {
         ALOGD("Deallocating texture from Planner's pool - max size [%" PRIu64 "] reached",
-              static_cast<uint64_t>(kMaxPoolSize));
+              static_cast<uint64_t>(maxPoolSize));
         return;
     }
 
@@ -107,6 +124,15 @@ void TexturePool::dump(std::string& out) const {
     base::StringAppendF(&out,
                         "TexturePool (%s) has %zu buffers of size [%" PRId32 ", %" PRId32 "]\n",
                         mEnabled ? "enabled" : "disabled", mPool.size(), mSize.width, mSize.height);
+    base::StringAppendF(&out, "    Resident: %.2f MiB, retaining at most %zu buffers\n",
+                        static_cast<float>(mPool.size() * getTextureBytes()) / (1024 * 1024),
+                        getMaxPoolSizeForDisplaySize());
+    const size_t borrows = mBorrowedFromPoolCount + mAllocatedOnBorrowCount;
+    base::StringAppendF(&out, "    Borrowed from pool: %zu/%zu (%.1f%%)\n",
+                        mBorrowedFromPoolCount, borrows,
+                        borrows == 0 ? 0.f
+                                     : 100.f * static_cast<float>(mBorrowedFromPoolCount) /
+                                        static_cast<float>(borrows));
 }
 
 } // namespace android::compositionengine::impl::planner
\ No newline at end of file
@@ -341,6 +341,48 @@ TEST_F(CompositionEngineOffloadTest, basic) {
     mEngine.present(mRefreshArgs);
 }
 
+TEST_F(CompositionEngineOffloadTest, compositionState) {
+    EXPECT_CALL(*mDisplay1, supportsOffloadPresent).WillOnce(Return(true));
+    EXPECT_CALL(*mDisplay2, supportsOffloadPresent).WillOnce(Return(true));
+
+    EXPECT_CALL(*mDisplay1, updateCompositionStateAsync(Ref(mRefreshArgs))).Times(1);
+    EXPECT_CALL(*mDisplay2, updateCompositionStateAsync(_)).Times(0);
+
+    SET_FLAG_FOR_TEST(flags::multithreaded_present, false);
+    SET_FLAG_FOR_TEST(flags::multithreaded_composition_state, true);
+    setOutputs({mDisplay1, mDisplay2});
+
+    mEngine.present(mRefreshArgs);
+}
+
+TEST_F(CompositionEngineOffloadTest, compositionStateDependsOnFlag) {
+    EXPECT_CALL(*mDisplay1, supportsOffloadPresent).Times(0);
+    EXPECT_CALL(*mDisplay2, supportsOffloadPresent).Times(0);
+
+    EXPECT_CALL(*mDisplay1, updateCompositionStateAsync(_)).Times(0);
+    EXPECT_CALL(*mDisplay2, updateCompositionStateAsync(_)).Times(0);
+
+    SET_FLAG_FOR_TEST(flags::multithreaded_present, false);
+    SET_FLAG_FOR_TEST(flags::multithreaded_composition_state, false);
+    setOutputs({mDisplay1, mDisplay2});
+
+    mEngine.present(mRefreshArgs);
+}
+
+TEST_F(CompositionEngineOffloadTest, compositionStateDependsOnSupport) {
+    EXPECT_CALL(*mDisplay1, supportsOffloadPresent).WillOnce(Return(true));
+    EXPECT_CALL(*mDisplay2, supportsOffloadPresent).WillOnce(Return(false));
+
+    EXPECT_CALL(*mDisplay1, updateCompositionStateAsync(_)).Times(0);
+    EXPECT_CALL(*mDisplay2, updateCompositionStateAsync(_)).Times(0);
+
+    SET_FLAG_FOR_TEST(flags::multithreaded_present, false);
+    SET_FLAG_FOR_TEST(flags::multithreaded_composition_state, true);
+    setOutputs({mDisplay1, mDisplay2});
+
+    mEngine.present(mRefreshArgs);
+}
+
 TEST_F(CompositionEngineOffloadTest, dependsOnSupport) {
     EXPECT_CALL(*mDisplay1, supportsOffloadPresent).WillOnce(Return(false));
     EXPECT_CALL(*mDisplay2, supportsOffloadPresent).Times(0);
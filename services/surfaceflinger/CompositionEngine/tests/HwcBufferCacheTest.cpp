@@ -190,5 +190,25 @@ TEST_F(HwcBufferCacheTest, uncache_whenOverrideUncached_returnsInvalidSlotNumber
     EXPECT_EQ(cache.uncache(mBuffer2->getId()), UINT32_MAX);
 }
 
+TEST_F(HwcBufferCacheTest, getStats_countsTransfersAvoidedAndEvictions) {
+    HwcBufferCache cache;
+
+    cache.getHwcSlotAndBuffer(mBuffer1);
+    cache.getHwcSlotAndBuffer(mBuffer1);
+    cache.getHwcSlotAndBuffer(mBuffer2);
+    cache.getOverrideHwcSlotAndBuffer(mBuffer1);
+    cache.getOverrideHwcSlotAndBuffer(mBuffer1);
+
+    EXPECT_EQ(3u, cache.getStats().bufferTransfers);
+    EXPECT_EQ(2u, cache.getStats().avoidedBufferTransfers);
+    EXPECT_EQ(0u, cache.getStats().evictions);
+
+    for (size_t i = 0; i < BufferQueue::NUM_BUFFER_SLOTS; ++i) {
+        cache.getHwcSlotAndBuffer(
+                sp<GraphicBuffer>::make(1u, 1u, HAL_PIXEL_FORMAT_RGBA_8888, 1u, 0u));
+    }
+    EXPECT_EQ(2u, cache.getStats().evictions);
+}
+
 } // namespace
 } // namespace android::compositionengine
@@ -14,6 +14,8 @@
  * limitations under the License.
  */
 
+#include <com_android_graphics_surfaceflinger_flags.h>
+#include <common/test/FlagUtils.h>
 #include <compositionengine/impl/HwcBufferCache.h>
 #include <compositionengine/impl/OutputLayer.h>
 #include <compositionengine/impl/OutputLayerCompositionState.h>
@@ -38,6 +40,8 @@ using aidl::android::hardware::graphics::composer3::Composition;
 namespace android::compositionengine {
 namespace {
 
+using namespace com::android::graphics::surfaceflinger;
+
 namespace hal = android::hardware::graphics::composer::hal;
 
 using testing::_;
@@ -1011,6 +1015,35 @@ TEST_F(OutputLayerWriteStateToHWCTest, canSetAllState) {
                                  /*zIsOverridden*/ false, /*isPeekingThrough*/ false);
 }
 
+TEST_F(OutputLayerWriteStateToHWCTest, unchangedGeometryIsNotRewritten) {
+    SET_FLAG_FOR_TEST(flags::output_layer_geometry_cache, true);
+    EXPECT_CALL(mLayerFE, hasRoundedCorners()).WillRepeatedly(Return(false));
+
+    expectGeometryCommonCalls();
+    expectPerFrameCommonCalls();
+    expectNoSetCompositionTypeCall();
+    mOutputLayer.writeStateToHWC(/*includeGeometry*/ true, /*skipLayer*/ false, 0,
+                                 /*zIsOverridden*/ false, /*isPeekingThrough*/ false);
+    Mock::VerifyAndClearExpectations(mHwcLayer.get());
+
+    // Another layer on the output changed its geometry, this one did not.
+    expectPerFrameCommonCalls();
+    expectNoSetCompositionTypeCall();
+    mOutputLayer.writeStateToHWC(/*includeGeometry*/ true, /*skipLayer*/ false, 0,
+                                 /*zIsOverridden*/ false, /*isPeekingThrough*/ false);
+    Mock::VerifyAndClearExpectations(mHwcLayer.get());
+    EXPECT_EQ(1u, mOutputLayer.getState().hwc->skippedGeometryWriteCount);
+
+    const Rect displayFrame{1, 2, 3, 4};
+    mOutputLayer.editState().displayFrame = displayFrame;
+    expectGeometryCommonCalls(displayFrame);
+    expectPerFrameCommonCalls();
+    expectNoSetCompositionTypeCall();
+    mOutputLayer.writeStateToHWC(/*includeGeometry*/ true, /*skipLayer*/ false, 0,
+                                 /*zIsOverridden*/ false, /*isPeekingThrough*/ false);
+    EXPECT_EQ(1u, mOutputLayer.getState().hwc->skippedGeometryWriteCount);
+}
+
 TEST_F(OutputLayerTest, displayInstallOrientationBufferTransformSetTo90) {
     mLayerFEState.geomBufferUsesDisplayInverseTransform = false;
     mLayerFEState.geomLayerTransform = ui::Transform{TR_IDENT};
@@ -1995,6 +1995,41 @@ TEST_F(OutputEnsureOutputLayerIfVisibleTest, transparentRegionClipsWhenOutsideBo
                 RegionEq(kTransparentRegionHint));
 }
 
+TEST_F(OutputEnsureOutputLayerIfVisibleTest, recordsOpaqueRectOfVisibleLayer) {
+    SET_FLAG_FOR_TEST(flags::output_occlusion_fast_path, true);
+
+    EXPECT_CALL(mOutput, ensureOutputLayer(Eq(0u), Eq(mLayer.layerFE)))
+            .WillOnce(Return(&mLayer.outputLayer));
+    ensureOutputLayerIfVisible();
+
+    ASSERT_EQ(1u, mCoverageState.opaqueRects.size());
+    EXPECT_EQ(Rect(0, 0, 100, 200), mCoverageState.opaqueRects.front());
+}
+
+TEST_F(OutputEnsureOutputLayerIfVisibleTest, takesEarlyOutIfLayerIsBehindOpaqueRect) {
+    SET_FLAG_FOR_TEST(flags::output_occlusion_fast_path, true);
+
+    // A fullscreen opaque layer above, with many smaller layers stacked beneath it.
+    const Rect kFullscreen(0, 0, 200, 300);
+    mCoverageState.aboveCoveredLayers = Region(kFullscreen);
+    mCoverageState.aboveOpaqueLayers = Region(kFullscreen);
+    mCoverageState.opaqueRects.push_back(kFullscreen);
+    mCoverageState.dirtyRegion = Region(Rect(0, 0, 10, 10));
+
+    for (int i = 0; i < 128; i++) {
+        mLayer.layerFEState.isOpaque = i % 2 == 0;
+        mLayer.layerFEState.geomLayerBounds =
+                FloatRect{static_cast<float>(i % 100), 0, 100, static_cast<float>(100 + i)};
+        ensureOutputLayerIfVisible();
+    }
+
+    EXPECT_THAT(mCoverageState.dirtyRegion, RegionEq(Region(Rect(0, 0, 10, 10))));
+    EXPECT_THAT(mCoverageState.aboveCoveredLayers, RegionEq(Region(kFullscreen)));
+    EXPECT_THAT(mCoverageState.aboveOpaqueLayers, RegionEq(Region(kFullscreen)));
+    ASSERT_EQ(1u, mCoverageState.opaqueRects.size());
+    EXPECT_EQ(kFullscreen, mCoverageState.opaqueRects.front());
+}
+
 /*
  * Output::present()
  */
@@ -2021,6 +2056,8 @@ struct OutputPresentTest : public testing::Test {
                     (override));
         MOCK_METHOD(bool, isPowerHintSessionEnabled, (), (override));
         MOCK_METHOD(bool, isPowerHintSessionGpuReportingEnabled, (), (override));
+        MOCK_METHOD(bool, isNoOpFrame, (const CompositionRefreshArgs&), (const, override));
+        MOCK_METHOD(void, releaseLayersForNoOpFrame, (), (override));
     };
 
     OutputPresentTest() {
@@ -2073,6 +2110,71 @@ TEST_F(OutputPresentTest, predictingCompositionStrategyInvokesPrepareFrameAsync)
     mOutput.present(args);
 }
 
+TEST_F(OutputPresentTest, noOpFrameSkipsPrepareAndPresent) {
+    SET_FLAG_FOR_TEST(flags::skip_noop_frame_present, true);
+    CompositionRefreshArgs args;
+
+    InSequence seq;
+    EXPECT_CALL(mOutput, updateColorProfile(Ref(args)));
+    EXPECT_CALL(mOutput, updateCompositionState(Ref(args)));
+    EXPECT_CALL(mOutput, planComposition());
+    EXPECT_CALL(mOutput, writeCompositionState(Ref(args)));
+    EXPECT_CALL(mOutput, setColorTransform(Ref(args)));
+    EXPECT_CALL(mOutput, isNoOpFrame(Ref(args))).WillOnce(Return(true));
+    EXPECT_CALL(mOutput, releaseLayersForNoOpFrame());
+
+    mOutput.present(args);
+}
+
+TEST_F(OutputPresentTest, changedFrameIsPresentedWhenSkippingNoOpFrames) {
+    SET_FLAG_FOR_TEST(flags::skip_noop_frame_present, true);
+    CompositionRefreshArgs args;
+
+    InSequence seq;
+    EXPECT_CALL(mOutput, updateColorProfile(Ref(args)));
+    EXPECT_CALL(mOutput, updateCompositionState(Ref(args)));
+    EXPECT_CALL(mOutput, planComposition());
+    EXPECT_CALL(mOutput, writeCompositionState(Ref(args)));
+    EXPECT_CALL(mOutput, setColorTransform(Ref(args)));
+    EXPECT_CALL(mOutput, isNoOpFrame(Ref(args))).WillOnce(Return(false));
+    EXPECT_CALL(mOutput, beginFrame());
+    EXPECT_CALL(mOutput, setHintSessionRequiresRenderEngine(false));
+    EXPECT_CALL(mOutput, canPredictCompositionStrategy(Ref(args))).WillOnce(Return(false));
+    EXPECT_CALL(mOutput, prepareFrame());
+    EXPECT_CALL(mOutput, devOptRepaintFlash(Ref(args)));
+    EXPECT_CALL(mOutput, finishFrame(_));
+    EXPECT_CALL(mOutput, presentFrameAndReleaseLayers(false));
+    EXPECT_CALL(mOutput, renderCachedSets(Ref(args)));
+
+    mOutput.present(args);
+}
+
+TEST_F(OutputPresentTest, offloadedCompositionStateIsNotUpdatedAgain) {
+    CompositionRefreshArgs args;
+
+    {
+        InSequence seq;
+        EXPECT_CALL(mOutput, updateColorProfile(Ref(args)));
+        EXPECT_CALL(mOutput, updateCompositionState(Ref(args)));
+        EXPECT_CALL(mOutput, planComposition());
+        EXPECT_CALL(mOutput, writeCompositionState(Ref(args)));
+    }
+    mOutput.updateCompositionStateAsync(args);
+
+    InSequence seq;
+    EXPECT_CALL(mOutput, setColorTransform(Ref(args)));
+    EXPECT_CALL(mOutput, beginFrame());
+    EXPECT_CALL(mOutput, setHintSessionRequiresRenderEngine(false));
+    EXPECT_CALL(mOutput, canPredictCompositionStrategy(Ref(args))).WillOnce(Return(false));
+    EXPECT_CALL(mOutput, prepareFrame());
+    EXPECT_CALL(mOutput, devOptRepaintFlash(Ref(args)));
+    EXPECT_CALL(mOutput, finishFrame(_));
+    EXPECT_CALL(mOutput, presentFrameAndReleaseLayers(false));
+    EXPECT_CALL(mOutput, renderCachedSets(Ref(args)));
+
+    mOutput.present(args);
+}
+
 /*
  * Output::updateColorProfile()
  */
@@ -27,6 +27,7 @@ namespace {
 
 const ui::Size kDisplaySize(1, 1);
 const ui::Size kDisplaySizeTwo(2, 2);
+const ui::Size kDisplaySize4k(3840, 2160);
 
 class TestableTexturePool : public TexturePool {
 public:
@@ -35,6 +36,7 @@ public:
     size_t getMinPoolSize() const { return kMinPoolSize; }
     size_t getMaxPoolSize() const { return kMaxPoolSize; }
     size_t getPoolSize() const { return mPool.size(); }
+    size_t getMaxPoolSizeForCurrentDisplaySize() const { return getMaxPoolSizeForDisplaySize(); }
 };
 
 struct TexturePoolTest : public testing::Test {
@@ -170,5 +172,32 @@ TEST_F(TexturePoolTest, reallocatesWhenReEnabled) {
     EXPECT_EQ(mTexturePool.getPoolSize(), mTexturePool.getMinPoolSize());
 }
 
+TEST_F(TexturePoolTest, limitsRetainedBuffersForLargeDisplays) {
+    EXPECT_EQ(mTexturePool.getMaxPoolSize(), mTexturePool.getMaxPoolSizeForCurrentDisplaySize());
+
+    mTexturePool.setDisplaySize(kDisplaySize4k);
+    const size_t maxPoolSize = mTexturePool.getMaxPoolSizeForCurrentDisplaySize();
+    EXPECT_LT(maxPoolSize, mTexturePool.getMinPoolSize());
+    EXPECT_EQ(maxPoolSize, mTexturePool.getPoolSize());
+
+    std::vector<std::shared_ptr<TexturePool::AutoTexture>> textures;
+    for (size_t i = 0; i < mTexturePool.getMaxPoolSize(); i++) {
+        textures.emplace_back(mTexturePool.borrowTexture());
+    }
+    textures.clear();
+    EXPECT_EQ(maxPoolSize, mTexturePool.getPoolSize());
+}
+
+TEST_F(TexturePoolTest, dumpsBorrowStatistics) {
+    std::vector<std::shared_ptr<TexturePool::AutoTexture>> textures;
+    for (size_t i = 0; i < mTexturePool.getMinPoolSize() + 1; i++) {
+        textures.emplace_back(mTexturePool.borrowTexture());
+    }
+
+    std::string dump;
+    mTexturePool.dump(dump);
+    EXPECT_NE(std::string::npos, dump.find("Borrowed from pool: 3/4"));
+}
+
 } // namespace
 } // namespace android::compositionengine::impl::planner
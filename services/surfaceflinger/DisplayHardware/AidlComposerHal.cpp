@@ -22,6 +22,7 @@
 
 #include <SurfaceFlingerProperties.h>
 #include <android-base/file.h>
+#include <android-base/stringprintf.h>
 #include <android/binder_ibinder_platform.h>
 #include <android/binder_manager.h>
 #include <common/FlagManager.h>
@@ -340,8 +341,24 @@ std::string AidlComposer::dumpDebugInfo() {
 
     std::string hash;
     mAidlComposer->getInterfaceHash(&hash);
-    return std::string(mAidlComposer->descriptor) +
-            " version:" + std::to_string(mComposerInterfaceVersion) + " hash:" + hash + str;
+    std::string result = std::string(mAidlComposer->descriptor) + " version:" +
+            std::to_string(mComposerInterfaceVersion) + " hash:" + hash + str;
+
+    const uint64_t executeCommandsCount = mExecuteCommandsCount;
+    const uint64_t presentCount = mPresentCount;
+    base::StringAppendF(&result,
+                        "\nexecuteCommands calls: %" PRIu64 " (%.2f per present, %.2f layer "
+                        "commands per call), presents: %" PRIu64 "\n",
+                        executeCommandsCount,
+                        presentCount ? static_cast<float>(executeCommandsCount) /
+                                        static_cast<float>(presentCount)
+                                     : 0.f,
+                        executeCommandsCount
+                                ? static_cast<float>(mExecutedLayerCommandCount) /
+                                        static_cast<float>(executeCommandsCount)
+                                : 0.f,
+                        presentCount);
+    return result;
 }
 
 void AidlComposer::registerCallback(HWC2::ComposerCallback& callback) {
@@ -704,6 +721,7 @@ Error AidlComposer::presentDisplay(Display display, int* outPresentFence) {
 
     auto fence = reader->get().takePresentFence(displayId);
     mMutex.unlock_shared();
+    mPresentCount++;
     // take ownership
     *outPresentFence = fence.get();
     *fence.getR() = -1;
@@ -877,6 +895,7 @@ Error AidlComposer::presentOrValidateDisplay(Display display, nsecs_t expectedPr
     *state = translate<uint32_t>(*result);
 
     if (*result == PresentOrValidate::Result::Presented) {
+        mPresentCount++;
         auto fence = reader->get().takePresentFence(displayId);
         // take ownership
         *outPresentFence = fence.get();
@@ -1140,6 +1159,11 @@ Error AidlComposer::execute(Display display) {
         return Error::NONE;
     }
 
+    mExecuteCommandsCount++;
+    for (const auto& command : commands) {
+        mExecutedLayerCommandCount += command.layers.size();
+    }
+
     { // scope for results
         std::vector<CommandResultPayload> results;
         auto status = mAidlComposerClient->executeCommands(commands, &results);
@@ -21,6 +21,7 @@
 #include <ftl/shared_mutex.h>
 #include <ui/DisplayMap.h>
 
+#include <atomic>
 #include <functional>
 #include <optional>
 #include <string>
@@ -303,6 +304,11 @@ private:
     bool mEnableLayerCommandBatchingFlag = false;
     std::atomic<int64_t> mLayerID = 1;
 
+    // Statistics on the HAL round trips made to present frames, reported in dumpDebugInfo.
+    std::atomic<uint64_t> mExecuteCommandsCount = 0;
+    std::atomic<uint64_t> mExecutedLayerCommandCount = 0;
+    std::atomic<uint64_t> mPresentCount = 0;
+
     // Buffer slots for layers are cleared by setting the slot buffer to this buffer.
     sp<GraphicBuffer> mClearSlotBuffer;
 
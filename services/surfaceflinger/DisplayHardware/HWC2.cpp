@@ -33,6 +33,7 @@
 #include <ui/GraphicBuffer.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cinttypes>
 #include <iterator>
 #include <set>
@@ -697,6 +698,23 @@ std::vector<Hwc2::IComposerClient::Rect> convertRegionToHwcRects(const Region& r
     }
     return hwcRects;
 }
+
+// Number of layer commands not sent because they would not have changed the layer's state.
+std::atomic<uint64_t> sSuppressedCommandCount = 0;
+
+void countSuppressedCommand() {
+    sSuppressedCommandCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Returns whether value was the last one sent, in which case the command is counted as suppressed.
+template <typename T>
+bool isUnchanged(const std::optional<T>& lastSent, const T& value) {
+    if (!lastSent.has_value() || !(*lastSent == value)) {
+        return false;
+    }
+    countSuppressedCommand();
+    return true;
+}
 } // namespace
 
 Layer::~Layer() = default;
@@ -762,6 +780,7 @@ Error Layer::setBuffer(uint32_t slot, const sp<GraphicBuffer>& buffer,
     }
 
     if (buffer == nullptr && mBufferSlot == slot) {
+        countSuppressedCommand();
         return Error::NONE;
     }
     mBufferSlot = slot;
@@ -789,6 +808,7 @@ Error Layer::setSurfaceDamage(const Region& damage)
 
     if (damage.isRect() && mDamageRegion.isRect() &&
         (damage.getBounds() == mDamageRegion.getBounds())) {
+        countSuppressedCommand();
         return Error::NONE;
     }
     mDamageRegion = damage;
@@ -813,8 +833,15 @@ Error Layer::setBlendMode(BlendMode mode)
         return Error::BAD_DISPLAY;
     }
 
+    if (isUnchanged(mBlendMode, mode)) {
+        return Error::NONE;
+    }
     auto intError = mComposer.setLayerBlendMode(mDisplay->getId(), mId, mode);
-    return static_cast<Error>(intError);
+    Error error = static_cast<Error>(intError);
+    if (error == Error::NONE) {
+        mBlendMode = mode;
+    }
+    return error;
 }
 
 Error Layer::setColor(Color color) {
@@ -822,8 +849,15 @@ Error Layer::setColor(Color color) {
         return Error::BAD_DISPLAY;
     }
 
+    if (isUnchanged(mColor, color)) {
+        return Error::NONE;
+    }
     auto intError = mComposer.setLayerColor(mDisplay->getId(), mId, color);
-    return static_cast<Error>(intError);
+    Error error = static_cast<Error>(intError);
+    if (error == Error::NONE) {
+        mColor = color;
+    }
+    return error;
 }
 
 Error Layer::setCompositionType(Composition type)
@@ -843,6 +877,7 @@ Error Layer::setDataspace(Dataspace dataspace)
     }
 
     if (dataspace == mDataSpace) {
+        countSuppressedCommand();
         return Error::NONE;
     }
     mDataSpace = dataspace;
@@ -858,6 +893,7 @@ Error Layer::setPerFrameMetadata(const int32_t supportedPerFrameMetadata,
     }
 
     if (metadata == mHdrMetadata) {
+        countSuppressedCommand();
         return Error::NONE;
     }
 
@@ -922,10 +958,17 @@ Error Layer::setDisplayFrame(const Rect& frame)
         return Error::BAD_DISPLAY;
     }
 
+    if (isUnchanged(mDisplayFrame, frame)) {
+        return Error::NONE;
+    }
     Hwc2::IComposerClient::Rect hwcRect{frame.left, frame.top,
         frame.right, frame.bottom};
     auto intError = mComposer.setLayerDisplayFrame(mDisplay->getId(), mId, hwcRect);
-    return static_cast<Error>(intError);
+    Error error = static_cast<Error>(intError);
+    if (error == Error::NONE) {
+        mDisplayFrame = frame;
+    }
+    return error;
 }
 
 Error Layer::setPlaneAlpha(float alpha)
@@ -934,8 +977,15 @@ Error Layer::setPlaneAlpha(float alpha)
         return Error::BAD_DISPLAY;
     }
 
+    if (isUnchanged(mPlaneAlpha, alpha)) {
+        return Error::NONE;
+    }
     auto intError = mComposer.setLayerPlaneAlpha(mDisplay->getId(), mId, alpha);
-    return static_cast<Error>(intError);
+    Error error = static_cast<Error>(intError);
+    if (error == Error::NONE) {
+        mPlaneAlpha = alpha;
+    }
+    return error;
 }
 
 Error Layer::setSidebandStream(const native_handle_t* stream)
@@ -959,10 +1009,17 @@ Error Layer::setSourceCrop(const FloatRect& crop)
         return Error::BAD_DISPLAY;
     }
 
+    if (isUnchanged(mSourceCrop, crop)) {
+        return Error::NONE;
+    }
     Hwc2::IComposerClient::FRect hwcRect{
         crop.left, crop.top, crop.right, crop.bottom};
     auto intError = mComposer.setLayerSourceCrop(mDisplay->getId(), mId, hwcRect);
-    return static_cast<Error>(intError);
+    Error error = static_cast<Error>(intError);
+    if (error == Error::NONE) {
+        mSourceCrop = crop;
+    }
+    return error;
 }
 
 Error Layer::setTransform(Transform transform)
@@ -971,9 +1028,16 @@ Error Layer::setTransform(Transform transform)
         return Error::BAD_DISPLAY;
     }
 
+    if (isUnchanged(mTransform, transform)) {
+        return Error::NONE;
+    }
     auto intTransform = static_cast<Hwc2::Transform>(transform);
     auto intError = mComposer.setLayerTransform(mDisplay->getId(), mId, intTransform);
-    return static_cast<Error>(intError);
+    Error error = static_cast<Error>(intError);
+    if (error == Error::NONE) {
+        mTransform = transform;
+    }
+    return error;
 }
 
 Error Layer::setVisibleRegion(const Region& region)
@@ -984,6 +1048,7 @@ Error Layer::setVisibleRegion(const Region& region)
 
     if (region.isRect() && mVisibleRegion.isRect() &&
         (region.getBounds() == mVisibleRegion.getBounds())) {
+        countSuppressedCommand();
         return Error::NONE;
     }
     mVisibleRegion = region;
@@ -998,8 +1063,15 @@ Error Layer::setZOrder(uint32_t z)
         return Error::BAD_DISPLAY;
     }
 
+    if (isUnchanged(mZOrder, z)) {
+        return Error::NONE;
+    }
     auto intError = mComposer.setLayerZOrder(mDisplay->getId(), mId, z);
-    return static_cast<Error>(intError);
+    Error error = static_cast<Error>(intError);
+    if (error == Error::NONE) {
+        mZOrder = z;
+    }
+    return error;
 }
 
 // Composer HAL 2.3
@@ -1009,6 +1081,7 @@ Error Layer::setColorTransform(const android::mat4& matrix) {
     }
 
     if (matrix == mColorMatrix) {
+        countSuppressedCommand();
         return Error::NONE;
     }
     auto intError = mComposer.setLayerColorTransform(mDisplay->getId(), mId, matrix.asArray());
@@ -1038,8 +1111,15 @@ Error Layer::setBrightness(float brightness) {
         return Error::BAD_DISPLAY;
     }
 
+    if (isUnchanged(mBrightness, brightness)) {
+        return Error::NONE;
+    }
     auto intError = mComposer.setLayerBrightness(mDisplay->getId(), mId, brightness);
-    return static_cast<Error>(intError);
+    Error error = static_cast<Error>(intError);
+    if (error == Error::NONE) {
+        mBrightness = brightness;
+    }
+    return error;
 }
 
 Error Layer::setBlockingRegion(const Region& region) {
@@ -1049,6 +1129,7 @@ Error Layer::setBlockingRegion(const Region& region) {
 
     if (region.isRect() && mBlockingRegion.isRect() &&
         (region.getBounds() == mBlockingRegion.getBounds())) {
+        countSuppressedCommand();
         return Error::NONE;
     }
     mBlockingRegion = region;
@@ -1065,6 +1146,10 @@ Error Layer::setLuts(std::vector<Lut>& luts) {
     return static_cast<Error>(intError);
 }
 
+uint64_t Layer::getSuppressedCommandCount() {
+    return sSuppressedCommandCount.load(std::memory_order_relaxed);
+}
+
 } // namespace impl
 } // namespace HWC2
 } // namespace android
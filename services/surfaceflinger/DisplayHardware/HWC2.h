@@ -22,6 +22,7 @@
 #include <ftl/future.h>
 #include <gui/HdrMetadata.h>
 #include <math/mat4.h>
+#include <ui/FloatRect.h>
 #include <ui/HdrCapabilities.h>
 #include <ui/Region.h>
 #include <ui/StaticDisplayInfo.h>
@@ -30,6 +31,7 @@
 #include <utils/Timers.h>
 
 #include <functional>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -423,6 +425,10 @@ public:
     hal::Error setLuts(
             std::vector<aidl::android::hardware::graphics::composer3::Lut>& luts) override;
 
+    // Returns the number of commands that layers skipped because the HWC
+    // already had the state they would have set.
+    static uint64_t getSuppressedCommandCount();
+
 private:
     // These are references to data owned by HWComposer, which will outlive
     // this HWC2::Layer, so these references are guaranteed to be valid for
@@ -443,6 +449,17 @@ private:
     android::HdrMetadata mHdrMetadata;
     android::mat4 mColorMatrix;
     uint32_t mBufferSlot;
+    // Layer state persists in the HWC across frames, so these are only sent
+    // when they change. The composition type is not cached, since the HWC
+    // may change it during validation.
+    std::optional<hal::BlendMode> mBlendMode;
+    std::optional<aidl::android::hardware::graphics::composer3::Color> mColor;
+    std::optional<android::Rect> mDisplayFrame;
+    std::optional<float> mPlaneAlpha;
+    std::optional<android::FloatRect> mSourceCrop;
+    std::optional<hal::Transform> mTransform;
+    std::optional<uint32_t> mZOrder;
+    std::optional<float> mBrightness;
 };
 
 } // namespace impl
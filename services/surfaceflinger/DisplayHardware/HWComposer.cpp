@@ -1075,6 +1075,8 @@ void HWComposer::dumpOverlayProperties(std::string& result) const {
 void HWComposer::dump(std::string& result) const {
     result.append(mComposer->dumpDebugInfo());
     dumpOverlayProperties(result);
+    base::StringAppendF(&result, "Suppressed unchanged layer commands: %" PRIu64 "\n",
+                        HWC2::impl::Layer::getSuppressedCommandCount());
 }
 
 std::optional<PhysicalDisplayId> HWComposer::toPhysicalDisplayId(
@@ -299,6 +299,9 @@ void PowerAdvisor::updateTargetWorkDuration(Duration targetDuration) {
     {
         mTargetDuration = targetDuration;
         if (sTraceHintSessionData) SFTRACE_INT64("Time target", targetDuration.ns());
+        if (FlagManager::getInstance().power_advisor_predictive_load_up()) {
+            sendPredictiveLoadHint(targetDuration);
+        }
         if (targetDuration == mLastTargetDurationSent) return;
         std::scoped_lock lock(mHintSessionMutex);
         if (!ensurePowerHintSessionRunning()) {
@@ -319,6 +322,21 @@ void PowerAdvisor::updateTargetWorkDuration(Duration targetDuration) {
     }
 }
 
+void PowerAdvisor::sendPredictiveLoadHint(Duration targetDuration) {
+    if (!mStageDurationModel.valid) return;
+    const Duration predictedDuration = mStageDurationModel.predictedDuration();
+    const bool predictedOverTarget = predictedDuration + sTargetSafetyMargin > targetDuration;
+    if (sTraceHintSessionData) SFTRACE_INT64("Predicted duration", predictedDuration.ns());
+    // The session already boosts when reported durations run over the target, so only hint
+    // when the prediction starts exceeding it, e.g. when the target shrinks on a mode switch.
+    if (predictedOverTarget && !mPredictedOverTarget) {
+        ALOGV("Predicted duration %" PRId64 "ns exceeds target %" PRId64 "ns, sending load up",
+              predictedDuration.ns(), targetDuration.ns());
+        sendHintSessionHint(SessionHint::CPU_LOAD_UP);
+    }
+    mPredictedOverTarget = predictedOverTarget;
+}
+
 void PowerAdvisor::reportActualWorkDuration() {
     if (!mBootFinished || !sUseReportActualDuration || !usePowerHintSession()) {
         ALOGV("Actual work duration power hint cannot be sent, skipping");
@@ -595,6 +613,10 @@ std::optional<WorkDuration> PowerAdvisor::estimateWorkDuration() {
     DisplayTimeline displayTiming;
     std::optional<GpuTimeline> firstGpuTimeline;
 
+    // Time spent in hwc validate and present calls across displays this frame
+    Duration hwcValidateDuration = 0ns;
+    Duration hwcPresentDuration = 0ns;
+
     // Iterate over the displays that use hwc in the same order they are presented
     for (DisplayId displayId : displayIds) {
         if (mDisplayTimingData.count(displayId) == 0) {
@@ -605,6 +627,14 @@ std::optional<WorkDuration> PowerAdvisor::estimateWorkDuration() {
 
         displayTiming = displayData.calculateDisplayTimeline(mLastPresentFenceTime);
 
+        if (displayData.hwcValidateStartTime && displayData.hwcValidateEndTime) {
+            hwcValidateDuration +=
+                    *displayData.hwcValidateEndTime - *displayData.hwcValidateStartTime;
+        }
+        if (displayData.hwcPresentStartTime && displayData.hwcPresentEndTime) {
+            hwcPresentDuration += *displayData.hwcPresentEndTime - *displayData.hwcPresentStartTime;
+        }
+
         // Update predicted present finish time with this display's present time
         estimatedHwcEndTime = displayTiming.hwcPresentEndTime;
 
@@ -656,6 +686,9 @@ std::optional<WorkDuration> PowerAdvisor::estimateWorkDuration() {
     Duration combinedDuration = combineTimingEstimates(totalDuration, flingerDuration);
     Duration cpuDuration = combineTimingEstimates(totalDurationWithoutGpu, flingerDuration);
 
+    mStageDurationModel.update(cpuDuration, hwcValidateDuration, hwcPresentDuration,
+                               estimatedGpuDuration);
+
     WorkDuration duration{
             .timeStampNanos = TimePoint::now().ns(),
             .durationNanos = combinedDuration.ns(),
@@ -667,10 +700,28 @@ std::optional<WorkDuration> PowerAdvisor::estimateWorkDuration() {
         SFTRACE_INT64("Idle duration", idleDuration.ns());
         SFTRACE_INT64("Total duration", totalDuration.ns());
         SFTRACE_INT64("Flinger duration", flingerDuration.ns());
+        SFTRACE_INT64("Average cpu duration", mStageDurationModel.cpu.ns());
+        SFTRACE_INT64("Average hwc validate duration", mStageDurationModel.hwcValidate.ns());
+        SFTRACE_INT64("Average hwc present duration", mStageDurationModel.hwcPresent.ns());
+        SFTRACE_INT64("Average gpu duration", mStageDurationModel.gpu.ns());
     }
     return std::make_optional(duration);
 }
 
+void PowerAdvisor::StageDurationModel::update(Duration cpuDuration, Duration hwcValidateDuration,
+                                              Duration hwcPresentDuration, Duration gpuDuration) {
+    // Each new frame contributes a quarter of the average, so a change in load is mostly
+    // reflected within a few frames while one-off spikes are damped.
+    const auto average = [this](Duration current, Duration sample) {
+        return valid ? Duration::fromNs(current.ns() + (sample.ns() - current.ns()) / 4) : sample;
+    };
+    cpu = average(cpu, cpuDuration);
+    hwcValidate = average(hwcValidate, hwcValidateDuration);
+    hwcPresent = average(hwcPresent, hwcPresentDuration);
+    gpu = average(gpu, gpuDuration);
+    valid = true;
+}
+
 Duration PowerAdvisor::combineTimingEstimates(Duration totalDuration, Duration flingerDuration) {
     Duration targetDuration{0ns};
     targetDuration = mTargetDuration;
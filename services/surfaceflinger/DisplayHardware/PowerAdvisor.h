@@ -226,6 +226,26 @@ private:
         }
     };
 
+    // Rolling averages of how long each stage of recent frames took, used to predict whether the
+    // next frame will fit in its target before it starts.
+    struct StageDurationModel {
+        // From commit start until SurfaceFlinger finishes the frame, without idle waits
+        Duration cpu{0ns};
+        Duration hwcValidate{0ns};
+        Duration hwcPresent{0ns};
+        Duration gpu{0ns};
+        bool valid = false;
+
+        void update(Duration cpuDuration, Duration hwcValidateDuration,
+                    Duration hwcPresentDuration, Duration gpuDuration);
+        // The frame is done when both the cpu and gpu work are done
+        Duration predictedDuration() const { return std::max(cpu, gpu); }
+    };
+
+    // Sends CPU_LOAD_UP when the stage model predicts the upcoming frame will not fit in the
+    // given target and the previous frame's prediction did
+    void sendPredictiveLoadHint(Duration targetDuration);
+
     // Filter and sort the display ids by a given property
     std::vector<DisplayId> getOrderedDisplayIds(
             std::optional<TimePoint> DisplayTimingData::*sortBy);
@@ -256,6 +276,10 @@ private:
     std::optional<Duration> mTotalFrameTargetDuration;
     // Updated list of display IDs
     std::vector<DisplayId> mDisplayIds;
+    // Per-stage timing model of recent frames
+    StageDurationModel mStageDurationModel;
+    // Whether the most recent prediction exceeded the target
+    bool mPredictedOverTarget = false;
 
     // Ensure powerhal connection is initialized
     power::PowerHalController& getPowerHal();
@@ -70,6 +70,13 @@ class IProducerListener;
  * buffer for HWC, and a separate buffer is dequeued from the sink and used as
  * the HWC output buffer. When HWC composition is complete, the scratch buffer
  * is released and the output buffer is queued to the sink.
+ *
+ * Frames that show exactly one buffer layer are still composed into a sink
+ * buffer rather than queueing the layer's buffer to the sink. The sink may
+ * hold a buffer for an unbounded time, whereas the layer's buffer returns to
+ * its producer once the next buffer is latched, with a release fence that
+ * must be known at that point. Such frames avoid the GPU only when HWC
+ * composes the virtual display.
  */
 class VirtualDisplaySurface : public compositionengine::DisplaySurface,
                               public BnGraphicBufferProducer,
@@ -25,6 +25,7 @@
 #include <common/trace.h>
 #include <utils/Log.h>
 
+#include <algorithm>
 #include <chrono>
 #include <cinttypes>
 #include <numeric>
@@ -35,6 +36,7 @@
 namespace android::frametimeline {
 
 using base::StringAppendF;
+using base::StringPrintf;
 using FrameTimelineEvent = perfetto::protos::pbzero::FrameTimelineEvent;
 using FrameTimelineDataSource = impl::FrameTimeline::FrameTimelineDataSource;
 
@@ -335,6 +337,39 @@ int64_t TraceCookieCounter::getCookieForTracing() {
     return ++mTraceCookie;
 }
 
+void LatencyHistogram::insert(nsecs_t delta) {
+    const auto it =
+            std::upper_bound(kBucketUpperBoundsMs.begin(), kBucketUpperBoundsMs.end(), ns2ms(delta));
+    mBuckets[static_cast<size_t>(it - kBucketUpperBoundsMs.begin())]++;
+    mCount++;
+}
+
+std::optional<int32_t> LatencyHistogram::percentileUpperBoundMs(uint32_t percent) const {
+    const uint64_t target = (static_cast<uint64_t>(mCount) * percent + 99) / 100;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBucketUpperBoundsMs.size(); i++) {
+        seen += mBuckets[i];
+        if (seen >= target) {
+            return kBucketUpperBoundsMs[i];
+        }
+    }
+    return std::nullopt;
+}
+
+void LatencyHistogram::dump(std::string& result) const {
+    const auto percentileToString = [this](uint32_t percent) {
+        const auto bound = percentileUpperBoundMs(percent);
+        return bound ? StringPrintf("<%dms", *bound)
+                     : StringPrintf(">=%dms", kBucketUpperBoundsMs.back());
+    };
+    StringAppendF(&result, "count=%u p50%s p90%s p99%s [", mCount, percentileToString(50).c_str(),
+                  percentileToString(90).c_str(), percentileToString(99).c_str());
+    for (size_t i = 0; i < mBuckets.size(); i++) {
+        StringAppendF(&result, "%s%u", i == 0 ? "" : " ", mBuckets[i]);
+    }
+    StringAppendF(&result, "]\n");
+}
+
 SurfaceFrame::SurfaceFrame(const FrameTimelineInfo& frameTimelineInfo, pid_t ownerPid,
                            uid_t ownerUid, int32_t layerId, std::string layerName,
                            std::string debugName, PredictionState predictionState,
@@ -1001,15 +1036,29 @@ void FrameTimeline::onCommitNotComposited() {
     SFTRACE_CALL();
     std::scoped_lock lock(mMutex);
     mCurrentDisplayFrame->onCommitNotComposited();
-    mCurrentDisplayFrame.reset();
-    mCurrentDisplayFrame = std::make_shared<DisplayFrame>(mTimeStats, mJankClassificationThresholds,
-                                                          &mTraceCookieCounter);
+    mCurrentDisplayFrame = makeDisplayFrame(std::move(mCurrentDisplayFrame));
 }
 
 void FrameTimeline::DisplayFrame::addSurfaceFrame(std::shared_ptr<SurfaceFrame> surfaceFrame) {
     mSurfaceFrames.push_back(surfaceFrame);
 }
 
+void FrameTimeline::DisplayFrame::recycle() {
+    mToken = FrameTimelineInfo::INVALID_VSYNC_ID;
+    mSurfaceFlingerPredictions = TimelineItem();
+    mSurfaceFlingerActuals = TimelineItem();
+    mSurfaceFrames.clear();
+    mPredictionState = PredictionState::None;
+    mJankType = JankType::None;
+    mJankSeverityType = JankSeverityType::None;
+    mGpuFence = FenceTime::NO_FENCE;
+    mFramePresentMetadata = FramePresentMetadata::UnknownPresent;
+    mFrameReadyMetadata = FrameReadyMetadata::UnknownFinish;
+    mFrameStartMetadata = FrameStartMetadata::UnknownStart;
+    mRefreshRate = Fps();
+    mRenderRate = Fps();
+}
+
 void FrameTimeline::DisplayFrame::onSfWakeUp(int64_t token, Fps refreshRate, Fps renderRate,
                                              std::optional<TimelineItem> predictions,
                                              nsecs_t wakeUpTime) {
@@ -1486,6 +1535,7 @@ void FrameTimeline::flushPendingPresentFences() {
         const nsecs_t signalTime = Fence::SIGNAL_TIME_INVALID;
         auto& displayFrame = pendingPresentFence.second;
         displayFrame->onPresent(signalTime, mPreviousActualPresentTime);
+        recordLatencyHistograms(*displayFrame);
         mPreviousPredictionPresentTime =
                 displayFrame->trace(mSurfaceFlingerPid, monoBootOffset,
                                     mPreviousPredictionPresentTime, mFilterFramesBeforeTraceStarts);
@@ -1504,6 +1554,7 @@ void FrameTimeline::flushPendingPresentFences() {
 
         auto& displayFrame = pendingPresentFence.second;
         displayFrame->onPresent(signalTime, mPreviousActualPresentTime);
+        recordLatencyHistograms(*displayFrame);
         mPreviousPredictionPresentTime =
                 displayFrame->trace(mSurfaceFlingerPid, monoBootOffset,
                                     mPreviousPredictionPresentTime, mFilterFramesBeforeTraceStarts);
@@ -1514,15 +1565,59 @@ void FrameTimeline::flushPendingPresentFences() {
     }
 }
 
+void FrameTimeline::recordLatencyHistograms(const DisplayFrame& displayFrame) {
+    nsecs_t gpuCompositionTime = -1;
+    const auto& gpuFence = displayFrame.getGpuFence();
+    if (gpuFence->isValid()) {
+        const nsecs_t gpuSignalTime = gpuFence->getSignalTime();
+        if (gpuSignalTime != Fence::SIGNAL_TIME_PENDING &&
+            gpuSignalTime != Fence::SIGNAL_TIME_INVALID) {
+            gpuCompositionTime = gpuSignalTime - displayFrame.getActuals().startTime;
+        }
+    }
+
+    for (const auto& surfaceFrame : displayFrame.getSurfaceFrames()) {
+        if (surfaceFrame->getPresentState() != SurfaceFrame::PresentState::Presented ||
+            surfaceFrame->getPredictionState() != PredictionState::Valid) {
+            continue;
+        }
+        const TimelineItem predictions = surfaceFrame->getPredictions();
+        const TimelineItem actuals = surfaceFrame->getActuals();
+        if (actuals.presentTime <= 0) {
+            continue;
+        }
+
+        auto& histograms = mAppLatencyHistograms[surfaceFrame->getOwnerUid()];
+        histograms.deadlineDelta.insert(actuals.endTime - predictions.endTime);
+        histograms.presentDelta.insert(actuals.presentTime - predictions.presentTime);
+        if (gpuCompositionTime >= 0) {
+            histograms.gpuComposition.insert(gpuCompositionTime);
+        }
+    }
+}
+
 void FrameTimeline::finalizeCurrentDisplayFrame() {
+    std::shared_ptr<DisplayFrame> evicted;
     while (mDisplayFrames.size() >= mMaxDisplayFrames) {
         // We maintain only a fixed number of frames' data. Pop older frames
+        evicted = std::move(mDisplayFrames.front());
         mDisplayFrames.pop_front();
     }
-    mDisplayFrames.push_back(mCurrentDisplayFrame);
-    mCurrentDisplayFrame.reset();
-    mCurrentDisplayFrame = std::make_shared<DisplayFrame>(mTimeStats, mJankClassificationThresholds,
-                                                          &mTraceCookieCounter);
+    mDisplayFrames.push_back(std::move(mCurrentDisplayFrame));
+    mCurrentDisplayFrame = makeDisplayFrame(std::move(evicted));
+}
+
+std::shared_ptr<FrameTimeline::DisplayFrame> FrameTimeline::makeDisplayFrame(
+        std::shared_ptr<DisplayFrame> recycled) {
+    // Once the sliding window is full, a DisplayFrame is evicted for every one that is finalized,
+    // so reusing it avoids an allocation per frame. A frame still waiting on its present fence is
+    // also referenced by mPendingPresentFences and cannot be reused yet.
+    if (recycled && recycled.use_count() == 1) {
+        recycled->recycle();
+        return recycled;
+    }
+    return std::make_shared<DisplayFrame>(mTimeStats, mJankClassificationThresholds,
+                                          &mTraceCookieCounter);
 }
 
 nsecs_t FrameTimeline::DisplayFrame::getBaseTime() const {
@@ -1610,6 +1705,27 @@ void FrameTimeline::dumpJank(std::string& result) {
     }
 }
 
+void FrameTimeline::dumpHistograms(std::string& result) {
+    std::scoped_lock lock(mMutex);
+    StringAppendF(&result, "Latency histogram buckets (ms): <%d",
+                  LatencyHistogram::kBucketUpperBoundsMs[0]);
+    for (size_t i = 1; i < LatencyHistogram::kBucketUpperBoundsMs.size(); i++) {
+        StringAppendF(&result, " <%d", LatencyHistogram::kBucketUpperBoundsMs[i]);
+    }
+    StringAppendF(&result, " >=%d\n", LatencyHistogram::kBucketUpperBoundsMs.back());
+    for (const auto& [uid, histograms] : mAppLatencyHistograms) {
+        StringAppendF(&result, "uid %d\n", uid);
+        StringAppendF(&result, "    Deadline delta: ");
+        histograms.deadlineDelta.dump(result);
+        StringAppendF(&result, "    Present delta: ");
+        histograms.presentDelta.dump(result);
+        if (histograms.gpuComposition.count() > 0) {
+            StringAppendF(&result, "    GPU composition: ");
+            histograms.gpuComposition.dump(result);
+        }
+    }
+}
+
 void FrameTimeline::parseArgs(const Vector<String16>& args, std::string& result) {
     SFTRACE_CALL();
     std::unordered_map<std::string, bool> argsMap;
@@ -1622,6 +1738,9 @@ void FrameTimeline::parseArgs(const Vector<String16>& args, std::string& result)
     if (argsMap.count("-all")) {
         dumpAll(result);
     }
+    if (argsMap.count("-histogram")) {
+        dumpHistograms(result);
+    }
 }
 
 void FrameTimeline::setMaxDisplayFrames(uint32_t size) {
@@ -1635,6 +1754,8 @@ void FrameTimeline::setMaxDisplayFrames(uint32_t size) {
 
 void FrameTimeline::reset() {
     setMaxDisplayFrames(kDefaultMaxDisplayFrames);
+    std::scoped_lock lock(mMutex);
+    mAppLatencyHistograms.clear();
 }
 
 } // namespace impl
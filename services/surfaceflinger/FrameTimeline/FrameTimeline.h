@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <deque>
@@ -23,6 +24,7 @@
 #include <mutex>
 #include <optional>
 #include <string>
+#include <unordered_map>
 
 #include <gui/ISurfaceComposer.h>
 #include <gui/JankInfo.h>
@@ -131,6 +133,28 @@ enum class PredictionState {
     None,    // Predictions are either not present or didn't come from TokenManager
 };
 
+/*
+ * Fixed bucket histogram of frame timing deltas, in milliseconds. Deltas can be negative when a
+ * frame was early. Used to keep a cheap aggregate of the latency distribution without a trace.
+ */
+class LatencyHistogram {
+public:
+    // Upper bounds, exclusive, of all buckets but the last one, which collects the rest.
+    static constexpr std::array<int32_t, 13> kBucketUpperBoundsMs = {-8, -4, -2, 0,  2,  4,  8,
+                                                                     12, 16, 24, 33, 50, 100};
+
+    void insert(nsecs_t delta);
+    uint32_t count() const { return mCount; }
+    // Returns the upper bound of the bucket that contains the given percentile, or std::nullopt
+    // when that is the last bucket, which has no upper bound.
+    std::optional<int32_t> percentileUpperBoundMs(uint32_t percent) const;
+    void dump(std::string& result) const;
+
+private:
+    std::array<uint32_t, kBucketUpperBoundsMs.size() + 1> mBuckets = {};
+    uint32_t mCount = 0;
+};
+
 /*
  * Trace cookie is used to send start and end timestamps of <Surface/Display>Frames separately
  * without needing to resend all the other information. We send all info to perfetto, along with a
@@ -220,6 +244,7 @@ public:
     // Getter functions used only by FrameTimelineTests and SurfaceFrame internally
     TimelineItem getActuals() const;
     pid_t getOwnerPid() const { return mOwnerPid; };
+    uid_t getOwnerUid() const { return mOwnerUid; };
     int32_t getLayerId() const { return mLayerId; };
     PredictionState getPredictionState() const;
     PresentState getPresentState() const;
@@ -331,6 +356,7 @@ public:
     // -jank : Dumps only the Display Frames that are either janky themselves
     //         or contain janky Surface Frames.
     // -all : Dumps the entire list of DisplayFrames and the SurfaceFrames contained within
+    // -histogram : Dumps the per app latency histograms of presented frames
     virtual void parseArgs(const Vector<String16>& args, std::string& result) = 0;
 
     // Sets the max number of display frames that can be stored. Called by SF backdoor.
@@ -410,6 +436,9 @@ public:
         void onCommitNotComposited();
         // Adds the provided SurfaceFrame to the current display frame.
         void addSurfaceFrame(std::shared_ptr<SurfaceFrame> surfaceFrame);
+        // Returns the DisplayFrame to its just constructed state so that it can be reused for a
+        // new frame. The capacity of the SurfaceFrame vector is kept.
+        void recycle();
 
         void setPredictions(PredictionState predictionState, TimelineItem predictions);
         void setActualStartTime(nsecs_t actualStartTime);
@@ -420,8 +449,10 @@ public:
         // Used for dumping all timestamps relative to the oldest, making it easy to read.
         nsecs_t getBaseTime() const;
 
-        // Functions to be used only in testing.
+        const std::shared_ptr<FenceTime>& getGpuFence() const { return mGpuFence; }
         TimelineItem getActuals() const { return mSurfaceFlingerActuals; };
+
+        // Functions to be used only in testing.
         TimelineItem getPredictions() const { return mSurfaceFlingerPredictions; };
         FrameStartMetadata getFrameStartMetadata() const { return mFrameStartMetadata; };
         FramePresentMetadata getFramePresentMetadata() const { return mFramePresentMetadata; };
@@ -518,14 +549,32 @@ private:
     void flushPendingPresentFences() REQUIRES(mMutex);
     std::optional<size_t> getFirstSignalFenceIndex() const REQUIRES(mMutex);
     void finalizeCurrentDisplayFrame() REQUIRES(mMutex);
+    // Returns a DisplayFrame to track the next frame, reusing the given one if nothing else holds
+    // a reference to it.
+    std::shared_ptr<DisplayFrame> makeDisplayFrame(std::shared_ptr<DisplayFrame> recycled)
+            REQUIRES(mMutex);
     void dumpAll(std::string& result);
     void dumpJank(std::string& result);
+    void dumpHistograms(std::string& result);
+    // Adds the SurfaceFrames of a presented DisplayFrame to the per app latency histograms.
+    void recordLatencyHistograms(const DisplayFrame& displayFrame) REQUIRES(mMutex);
+
+    struct AppLatencyHistograms {
+        // App frame end compared to its predicted deadline.
+        LatencyHistogram deadlineDelta;
+        // Actual present compared to the predicted present time.
+        LatencyHistogram presentDelta;
+        // From SurfaceFlinger wake up to the GPU composition finishing, for frames that SF
+        // composited with the GPU.
+        LatencyHistogram gpuComposition;
+    };
 
     // Sliding window of display frames. TODO(b/168072834): compare perf with fixed size array
     std::deque<std::shared_ptr<DisplayFrame>> mDisplayFrames GUARDED_BY(mMutex);
     std::vector<std::pair<std::shared_ptr<FenceTime>, std::shared_ptr<DisplayFrame>>>
             mPendingPresentFences GUARDED_BY(mMutex);
     std::shared_ptr<DisplayFrame> mCurrentDisplayFrame GUARDED_BY(mMutex);
+    std::unordered_map<uid_t, AppLatencyHistograms> mAppLatencyHistograms GUARDED_BY(mMutex);
     TokenManager mTokenManager;
     TraceCookieCounter mTraceCookieCounter;
     mutable std::mutex mMutex;
@@ -101,6 +101,92 @@ void LayerHierarchy::traverseInZOrder(const Visitor& visitor,
     }
 }
 
+void LayerHierarchy::traverseFlattened(const Visitor& visitor,
+                                       const std::vector<FlattenedNode>& nodes) {
+    size_t i = 0;
+    while (i < nodes.size()) {
+        const FlattenedNode& node = nodes[i];
+        bool traverseChildren = visitor(*node.hierarchy, node.traversalPath);
+        i = traverseChildren ? i + 1 : node.subtreeEnd;
+    }
+}
+
+void LayerHierarchy::flatten() {
+    // Keep the capacity from the previous build so steady state updates do not allocate.
+    mFlattenedTraversal.clear();
+    mFlattenedZOrderTraversal.clear();
+
+    TraversalPath root = TraversalPath::ROOT;
+    if (mLayer) {
+        root.id = mLayer->id;
+    }
+    flatten(mFlattenedTraversal, root, /*depth=*/0);
+    flattenInZOrder(mFlattenedZOrderTraversal, root);
+    mFlattened = true;
+}
+
+void LayerHierarchy::clearFlattened() {
+    mFlattened = false;
+    mFlattenedTraversal.clear();
+    mFlattenedZOrderTraversal.clear();
+}
+
+// Mirrors traverse, recording each visit instead of calling a visitor.
+void LayerHierarchy::flatten(std::vector<FlattenedNode>& out,
+                             LayerHierarchy::TraversalPath& traversalPath, uint32_t depth) const {
+    LLOG_ALWAYS_FATAL_WITH_TRACE_IF(depth > 50,
+                                    "Cycle detected in LayerHierarchy::flatten. See "
+                                    "traverse_stack_overflow_transactions.winscope");
+
+    const size_t index = out.size();
+    if (mLayer) {
+        out.push_back({this, traversalPath, /*subtreeEnd=*/0});
+    }
+
+    LLOG_ALWAYS_FATAL_WITH_TRACE_IF(traversalPath.hasRelZLoop(), "Found relative z loop layerId:%d",
+                                    traversalPath.invalidRelativeRootId);
+    for (auto& [child, childVariant] : mChildren) {
+        ScopedAddToTraversalPath addChildToTraversalPath(traversalPath, child->mLayer->id,
+                                                         childVariant);
+        child->flatten(out, traversalPath, depth + 1);
+    }
+
+    if (mLayer) {
+        out[index].subtreeEnd = static_cast<uint32_t>(out.size());
+    }
+}
+
+// Mirrors traverseInZOrder. A layer is recorded before its first child with a non-negative z, so
+// its subtree only spans the children that the recursive traversal would skip if the visitor
+// returns false.
+void LayerHierarchy::flattenInZOrder(std::vector<FlattenedNode>& out,
+                                     LayerHierarchy::TraversalPath& traversalPath) const {
+    bool traverseThisLayer = (mLayer != nullptr);
+    size_t index = 0;
+    for (auto it = mChildren.begin(); it < mChildren.end(); it++) {
+        auto& [child, childVariant] = *it;
+        if (traverseThisLayer && child->getLayer()->z >= 0) {
+            traverseThisLayer = false;
+            index = out.size();
+            out.push_back({this, traversalPath, /*subtreeEnd=*/0});
+        }
+        if (childVariant == LayerHierarchy::Variant::Detached) {
+            continue;
+        }
+        ScopedAddToTraversalPath addChildToTraversalPath(traversalPath, child->mLayer->id,
+                                                         childVariant);
+        child->flattenInZOrder(out, traversalPath);
+    }
+
+    if (traverseThisLayer) {
+        index = out.size();
+        out.push_back({this, traversalPath, /*subtreeEnd=*/0});
+    }
+    if (mLayer) {
+        out[index].subtreeEnd = static_cast<uint32_t>(out.size());
+    }
+}
+
 void LayerHierarchy::addChild(LayerHierarchy* child, LayerHierarchy::Variant variant) {
     insertSorted(mChildren, {child, variant});
 }
@@ -185,14 +271,21 @@ void LayerHierarchy::dump(std::ostream& out, const std::string& prefix,
 
 bool LayerHierarchy::hasRelZLoop(uint32_t& outInvalidRelativeRoot) const {
     outInvalidRelativeRoot = UNASSIGNED_LAYER_ID;
-    traverse([&outInvalidRelativeRoot](const LayerHierarchy&,
-                                       const LayerHierarchy::TraversalPath& traversalPath) -> bool {
-        if (traversalPath.hasRelZLoop()) {
-            outInvalidRelativeRoot = traversalPath.invalidRelativeRootId;
-            return false;
-        }
-        return true;
-    });
+    // Always walk the graph, the flattened view is only rebuilt once loops have been fixed.
+    TraversalPath root = TraversalPath::ROOT;
+    if (mLayer) {
+        root.id = mLayer->id;
+    }
+    traverse(
+            [&outInvalidRelativeRoot](const LayerHierarchy&,
+                                      const LayerHierarchy::TraversalPath& traversalPath) -> bool {
+                if (traversalPath.hasRelZLoop()) {
+                    outInvalidRelativeRoot = traversalPath.invalidRelativeRootId;
+                    return false;
+                }
+                return true;
+            },
+            root);
     return outInvalidRelativeRoot != UNASSIGNED_LAYER_ID;
 }
 
@@ -367,6 +460,9 @@ void LayerHierarchyBuilder::updateMirrorLayer(RequestedLayerState* layer) {
 void LayerHierarchyBuilder::doUpdate(
         const std::vector<std::unique_ptr<RequestedLayerState>>& layers,
         const std::vector<std::unique_ptr<RequestedLayerState>>& destroyedLayers) {
+    mRoot.clearFlattened();
+    mOffscreenRoot.clearFlattened();
+
     // rebuild map
     for (auto& layer : layers) {
         if (layer->changes.test(RequestedLayerState::Changes::Created)) {
@@ -437,6 +533,16 @@ void LayerHierarchyBuilder::update(LayerLifecycleManager& layerLifecycleManager)
         // check if we have any remaining loops
         hasRelZLoop = mRoot.hasRelZLoop(invalidRelativeRoot);
     }
+    flattenRoots();
+}
+
+void LayerHierarchyBuilder::flattenRoots() {
+    if (!FlagManager::getInstance().flattened_layer_hierarchy()) {
+        return;
+    }
+    SFTRACE_NAME("LayerHierarchyBuilder:flatten");
+    mRoot.flatten();
+    mOffscreenRoot.flatten();
 }
 
 const LayerHierarchy& LayerHierarchyBuilder::getHierarchy() const {
@@ -112,9 +112,11 @@ public:
 
     struct TraversalPathHash {
         std::size_t operator()(const LayerHierarchy::TraversalPath& key) const {
-            uint32_t hashCode = key.id * 31;
+            // Mix in the mirror roots in order so nested mirrors of the same layer, which differ
+            // only in the order of their roots, do not collide.
+            uint32_t hashCode = key.id;
             for (uint32_t mirrorRootId : key.mirrorRootIds) {
-                hashCode += mirrorRootId * 31;
+                hashCode = hashCode * 31 + mirrorRootId;
             }
             return std::hash<size_t>{}(hashCode);
         }
@@ -141,8 +143,21 @@ public:
                                const LayerHierarchy::TraversalPath& traversalPath)>
             Visitor;
 
+    // A node in a flattened view of the hierarchy. Nodes are stored in visit order and
+    // subtreeEnd is the index one past the last node visited under this one, so a visitor that
+    // stops traversing down can skip ahead without recursing.
+    struct FlattenedNode {
+        const LayerHierarchy* hierarchy;
+        TraversalPath traversalPath;
+        uint32_t subtreeEnd;
+    };
+
     // Traverse the hierarchy and visit all child variants.
     void traverse(const Visitor& visitor) const {
+        if (mFlattened) {
+            traverseFlattened(visitor, mFlattenedTraversal);
+            return;
+        }
         TraversalPath root = TraversalPath::ROOT;
         if (mLayer) {
             root.id = mLayer->id;
@@ -152,6 +167,10 @@ public:
 
     // Traverse the hierarchy in z-order, skipping children that have relative parents.
     void traverseInZOrder(const Visitor& visitor) const {
+        if (mFlattened) {
+            traverseFlattened(visitor, mFlattenedZOrderTraversal);
+            return;
+        }
         TraversalPath root = TraversalPath::ROOT;
         if (mLayer) {
             root.id = mLayer->id;
@@ -192,12 +211,26 @@ private:
     void traverseInZOrder(const Visitor& visitor, LayerHierarchy::TraversalPath& parent) const;
     void traverse(const Visitor& visitor, LayerHierarchy::TraversalPath& parent,
                   uint32_t depth = 0) const;
+    static void traverseFlattened(const Visitor& visitor, const std::vector<FlattenedNode>& nodes);
+    // Rebuilds the flattened views used by traverse and traverseInZOrder. Must be called again
+    // after any change to the hierarchy below this node, or cleared with clearFlattened.
+    void flatten();
+    void clearFlattened();
+    void flatten(std::vector<FlattenedNode>& out, LayerHierarchy::TraversalPath& traversalPath,
+                 uint32_t depth) const;
+    void flattenInZOrder(std::vector<FlattenedNode>& out,
+                         LayerHierarchy::TraversalPath& traversalPath) const;
     void dump(std::ostream& out, const std::string& prefix, LayerHierarchy::Variant variant,
               bool isLastChild, bool includeMirroredHierarchy) const;
 
     const RequestedLayerState* mLayer;
     LayerHierarchy* mParent = nullptr;
     LayerHierarchy* mRelativeParent = nullptr;
+
+    // Only set on the roots owned by LayerHierarchyBuilder.
+    bool mFlattened = false;
+    std::vector<FlattenedNode> mFlattenedTraversal;
+    std::vector<FlattenedNode> mFlattenedZOrderTraversal;
 };
 
 // Given a list of RequestedLayerState, this class will build a root hierarchy and an
@@ -230,6 +263,7 @@ private:
     void onLayerDestroyed(RequestedLayerState* layer);
     void updateMirrorLayer(RequestedLayerState* layer);
     LayerHierarchy* getHierarchyFromId(uint32_t layerId, bool crashOnFailure = true);
+    void flattenRoots();
 
     std::unordered_map<uint32_t, LayerHierarchy*> mLayerIdToHierarchy;
     std::vector<std::unique_ptr<LayerHierarchy>> mHierarchies;
@@ -151,11 +151,11 @@ void LayerLifecycleManager::onHandlesDestroyed(
                 linkedLayer->relativeParentId = UNASSIGNED_LAYER_ID;
             }
             if (swapErase(linkedLayer->mirrorIds, layer.id)) {
-                linkedLayer->changes |= RequestedLayerState::Changes::Mirror;
+                addChanges(*linkedLayer, RequestedLayerState::Changes::Mirror);
             }
             if (linkedLayer->layerIdToMirror == layer.id) {
                 linkedLayer->layerIdToMirror = UNASSIGNED_LAYER_ID;
-                linkedLayer->changes |= RequestedLayerState::Changes::Mirror;
+                addChanges(*linkedLayer, RequestedLayerState::Changes::Mirror);
             }
             if (linkedLayer->touchCropId == layer.id) {
                 linkedLayer->touchCropId = UNASSIGNED_LAYER_ID;
@@ -290,8 +290,15 @@ void LayerLifecycleManager::commitChanges() {
     }
     mAddedLayers.clear();
 
-    for (auto& layer : mLayers) {
-        layer->clearChanges();
+    // Only layers that picked up changes since the last commit need to be cleared, which avoids
+    // touching every layer on each commit. Destroyed layers keep their changes for the
+    // onLayerDestroyed callbacks below.
+    for (auto* changedLayers : {&mChangedLayers, &mOtherLayersWithChanges}) {
+        for (RequestedLayerState* layer : *changedLayers) {
+            if (!layer->changes.test(RequestedLayerState::Changes::Destroyed)) {
+                layer->clearChanges();
+            }
+        }
     }
 
     for (auto& destroyedLayer : mDestroyedLayers) {
@@ -301,6 +308,7 @@ void LayerLifecycleManager::commitChanges() {
     }
     mDestroyedLayers.clear();
     mChangedLayers.clear();
+    mOtherLayersWithChanges.clear();
     mGlobalChanges.clear();
 }
 
@@ -410,11 +418,20 @@ void LayerLifecycleManager::fixRelativeZLoop(uint32_t relativeRootId) {
     }
     RequestedLayerState& layer = it->second.owner;
     layer.relativeParentId = unlinkLayer(layer.relativeParentId, layer.id);
-    layer.changes |=
-            RequestedLayerState::Changes::Hierarchy | RequestedLayerState::Changes::RelativeParent;
+    addChanges(layer,
+               RequestedLayerState::Changes::Hierarchy |
+                       RequestedLayerState::Changes::RelativeParent);
     mGlobalChanges |= RequestedLayerState::Changes::Hierarchy;
 }
 
+void LayerLifecycleManager::addChanges(RequestedLayerState& layer,
+                                       ftl::Flags<RequestedLayerState::Changes> changes) {
+    if (layer.changes.get() == 0) {
+        mOtherLayersWithChanges.push_back(&layer);
+    }
+    layer.changes |= changes;
+}
+
 // Some layers mirror the entire display stack. Since we don't have a single root layer per display
 // we have to track all these layers and update what they mirror when the list of root layers
 // on a display changes. This function walks through the list of display mirroring layers
@@ -431,11 +448,11 @@ void LayerLifecycleManager::updateDisplayMirrorLayers(RequestedLayerState& rootL
         if (canBeMirrored && !currentlyMirrored) {
             mirrorLayer->mirrorIds.emplace_back(rootLayer.id);
             linkLayer(rootLayer.id, mirrorLayer->id);
-            mirrorLayer->changes |= RequestedLayerState::Changes::Mirror;
+            addChanges(*mirrorLayer, RequestedLayerState::Changes::Mirror);
         } else if (!canBeMirrored && currentlyMirrored) {
             swapErase(mirrorLayer->mirrorIds, rootLayer.id);
             unlinkLayer(rootLayer.id, mirrorLayer->id);
-            mirrorLayer->changes |= RequestedLayerState::Changes::Mirror;
+            addChanges(*mirrorLayer, RequestedLayerState::Changes::Mirror);
         }
     }
 }
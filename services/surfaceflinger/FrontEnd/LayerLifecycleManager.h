@@ -94,6 +94,9 @@ private:
     std::vector<uint32_t> unlinkLayers(const std::vector<uint32_t>& layerIds, uint32_t linkedLayer);
 
     void updateDisplayMirrorLayers(RequestedLayerState& rootLayer);
+    // Sets changes on a layer that is not otherwise added to mChangedLayers, keeping track of it
+    // so that commitChanges can clear it.
+    void addChanges(RequestedLayerState& layer, ftl::Flags<RequestedLayerState::Changes> changes);
 
     struct References {
         // Lifetime tied to mLayers
@@ -117,6 +120,9 @@ private:
     std::vector<RequestedLayerState*> mAddedLayers;
     // Keeps track of new and layers with states changes since last commit.
     std::vector<RequestedLayerState*> mChangedLayers;
+    // Layers whose changes were set outside of applyTransactions without being added to
+    // mChangedLayers, such as mirror updates. May contain duplicates.
+    std::vector<RequestedLayerState*> mOtherLayersWithChanges;
 };
 
 } // namespace android::surfaceflinger::frontend
@@ -42,6 +42,19 @@ using namespace ftl::flag_operators;
 
 namespace {
 
+// Snapshot changes that are propagated from a parent snapshot to its children.
+constexpr ftl::Flags<RequestedLayerState::Changes> kChangesInheritedByChildren =
+        RequestedLayerState::Changes::Hierarchy | RequestedLayerState::Changes::Geometry |
+        RequestedLayerState::Changes::Visibility | RequestedLayerState::Changes::Metadata |
+        RequestedLayerState::Changes::AffectsChildren | RequestedLayerState::Changes::Input |
+        RequestedLayerState::Changes::FrameRate | RequestedLayerState::Changes::GameMode;
+
+// Global changes that may change which snapshots are reachable and require a full walk.
+constexpr ftl::Flags<RequestedLayerState::Changes> kChangesRequiringFullWalk =
+        RequestedLayerState::Changes::Created | RequestedLayerState::Changes::Destroyed |
+        RequestedLayerState::Changes::Hierarchy | RequestedLayerState::Changes::Mirror |
+        RequestedLayerState::Changes::Parent | RequestedLayerState::Changes::RelativeParent;
+
 FloatRect getMaxDisplayBounds(const DisplayInfos& displays) {
     const ui::Size maxSize = [&displays] {
         if (displays.empty()) return ui::Size{5000, 5000};
@@ -415,8 +428,43 @@ bool LayerSnapshotBuilder::tryFastUpdate(const Args& args) {
     return true;
 }
 
+bool LayerSnapshotBuilder::canUpdateDirtySubtreesOnly(const Args& args) {
+    return args.updateDirtySubtreesOnly && args.forceUpdate == ForceUpdateFlags::NONE &&
+            !args.displayChanges && !args.parentCrop &&
+            !args.layerLifecycleManager.getGlobalChanges().any(kChangesRequiringFullWalk) &&
+            args.layerLifecycleManager.getDestroyedLayers().empty();
+}
+
+void LayerSnapshotBuilder::collectDirtySubtrees(const Args& args) {
+    mDirtySubtreeLayerIds.clear();
+    for (const RequestedLayerState* requested : args.layerLifecycleManager.getChangedLayers()) {
+        // Walk up the parent chain and stop as soon as we reach a layer that has already been
+        // marked since its ancestors are already marked as well.
+        const RequestedLayerState* layer = requested;
+        while (layer && mDirtySubtreeLayerIds.insert(layer->id).second) {
+            layer = args.layerLifecycleManager.getLayerFromId(layer->parentId);
+        }
+    }
+}
+
+LayerSnapshot* LayerSnapshotBuilder::getCleanSubtreeSnapshot(
+        const LayerSnapshot& parentSnapshot,
+        const LayerHierarchy::TraversalPath& traversalPath) const {
+    if (!mUpdateDirtySubtreesOnly || parentSnapshot.changes.any(kChangesInheritedByChildren) ||
+        (parentSnapshot.clientChanges & layer_state_t::AFFECTS_CHILDREN) ||
+        mDirtySubtreeLayerIds.find(traversalPath.id) != mDirtySubtreeLayerIds.end()) {
+        return nullptr;
+    }
+    return getSnapshot(traversalPath);
+}
+
 void LayerSnapshotBuilder::updateSnapshots(const Args& args) {
     SFTRACE_NAME("UpdateSnapshots");
+    mUpdateDirtySubtreesOnly = canUpdateDirtySubtreesOnly(args);
+    if (mUpdateDirtySubtreesOnly) {
+        SFTRACE_NAME("DirtySubtreesOnly");
+        collectDirtySubtrees(args);
+    }
     LayerSnapshot rootSnapshot = args.rootSnapshot;
     if (args.parentCrop) {
         rootSnapshot.geomLayerBounds = *args.parentCrop;
@@ -433,9 +481,13 @@ void LayerSnapshotBuilder::updateSnapshots(const Args& args) {
         rootSnapshot.clientChanges |= layer_state_t::eReparent;
     }
 
-    for (auto& snapshot : mSnapshots) {
-        if (snapshot->reachablilty == LayerSnapshot::Reachablilty::Reachable) {
-            snapshot->reachablilty = LayerSnapshot::Reachablilty::Unreachable;
+    // Reachability can only change with hierarchy changes. When walking dirty subtrees only,
+    // snapshots in clean subtrees are not visited and keep their current reachability.
+    if (!mUpdateDirtySubtreesOnly) {
+        for (auto& snapshot : mSnapshots) {
+            if (snapshot->reachablilty == LayerSnapshot::Reachablilty::Reachable) {
+                snapshot->reachablilty = LayerSnapshot::Reachablilty::Unreachable;
+            }
         }
     }
 
@@ -445,15 +497,21 @@ void LayerSnapshotBuilder::updateSnapshots(const Args& args) {
         // multiple children.
         LayerHierarchy::ScopedAddToTraversalPath addChildToPath(root, args.root.getLayer()->id,
                                                                 LayerHierarchy::Variant::Attached);
-        updateSnapshotsInHierarchy(args, args.root, root, rootSnapshot, /*depth=*/0);
+        if (!getCleanSubtreeSnapshot(rootSnapshot, root)) {
+            updateSnapshotsInHierarchy(args, args.root, root, rootSnapshot, /*depth=*/0);
+        }
     } else {
         for (auto& [childHierarchy, variant] : args.root.mChildren) {
             LayerHierarchy::ScopedAddToTraversalPath addChildToPath(root,
                                                                     childHierarchy->getLayer()->id,
                                                                     variant);
+            if (getCleanSubtreeSnapshot(rootSnapshot, root)) {
+                continue;
+            }
             updateSnapshotsInHierarchy(args, *childHierarchy, root, rootSnapshot, /*depth=*/0);
         }
     }
+    mUpdateDirtySubtreesOnly = false;
 
     // Update touchable region crops outside the main update pass. This is because a layer could be
     // cropped by any other layer and it requires both snapshots to be updated.
@@ -488,7 +546,11 @@ void LayerSnapshotBuilder::updateSnapshots(const Args& args) {
             continue;
         }
 
-        mPathToSnapshot.erase(traversalPath);
+        if (isClone) {
+            mClonePathToSnapshot.erase(traversalPath);
+        } else {
+            mLayerIdToSnapshot.erase(traversalPath.id);
+        }
 
         auto range = mIdToSnapshots.equal_range(traversalPath.id);
         auto matchingSnapshot =
@@ -548,9 +610,11 @@ const LayerSnapshot& LayerSnapshotBuilder::updateSnapshotsInHierarchy(
         LayerHierarchy::ScopedAddToTraversalPath addChildToPath(traversalPath,
                                                                 childHierarchy->getLayer()->id,
                                                                 variant);
-        const LayerSnapshot& childSnapshot =
-                updateSnapshotsInHierarchy(args, *childHierarchy, traversalPath, *snapshot,
-                                           depth + 1);
+        const LayerSnapshot* cleanChildSnapshot = getCleanSubtreeSnapshot(*snapshot, traversalPath);
+        const LayerSnapshot& childSnapshot = cleanChildSnapshot
+                ? *cleanChildSnapshot
+                : updateSnapshotsInHierarchy(args, *childHierarchy, traversalPath, *snapshot,
+                                             depth + 1);
         updateFrameRateFromChildSnapshot(*snapshot, childSnapshot, *childHierarchy->getLayer(),
                                          args, &childHasValidFrameRate);
     }
@@ -562,13 +626,16 @@ LayerSnapshot* LayerSnapshotBuilder::getSnapshot(uint32_t layerId) const {
     if (layerId == UNASSIGNED_LAYER_ID) {
         return nullptr;
     }
-    LayerHierarchy::TraversalPath path{.id = layerId};
-    return getSnapshot(path);
+    auto it = mLayerIdToSnapshot.find(layerId);
+    return it == mLayerIdToSnapshot.end() ? nullptr : it->second;
 }
 
 LayerSnapshot* LayerSnapshotBuilder::getSnapshot(const LayerHierarchy::TraversalPath& id) const {
-    auto it = mPathToSnapshot.find(id);
-    return it == mPathToSnapshot.end() ? nullptr : it->second;
+    if (!id.isClone()) {
+        return getSnapshot(id.id);
+    }
+    auto it = mClonePathToSnapshot.find(id);
+    return it == mClonePathToSnapshot.end() ? nullptr : it->second;
 }
 
 LayerSnapshot* LayerSnapshotBuilder::createSnapshot(const LayerHierarchy::TraversalPath& path,
@@ -582,7 +649,11 @@ LayerSnapshot* LayerSnapshotBuilder::createSnapshot(const LayerHierarchy::Traver
     }
     snapshot->ignoreLocalTransform =
             path.isClone() && path.variant == LayerHierarchy::Variant::Detached_Mirror;
-    mPathToSnapshot[path] = snapshot;
+    if (path.isClone()) {
+        mClonePathToSnapshot[path] = snapshot;
+    } else {
+        mLayerIdToSnapshot[path.id] = snapshot;
+    }
 
     mIdToSnapshots.emplace(path.id, snapshot);
     return snapshot;
@@ -715,11 +786,8 @@ void LayerSnapshotBuilder::updateSnapshot(LayerSnapshot& snapshot, const Args& a
                                           const LayerSnapshot& parentSnapshot,
                                           const LayerHierarchy::TraversalPath& path) {
     // Always update flags and visibility
-    ftl::Flags<RequestedLayerState::Changes> parentChanges = parentSnapshot.changes &
-            (RequestedLayerState::Changes::Hierarchy | RequestedLayerState::Changes::Geometry |
-             RequestedLayerState::Changes::Visibility | RequestedLayerState::Changes::Metadata |
-             RequestedLayerState::Changes::AffectsChildren | RequestedLayerState::Changes::Input |
-             RequestedLayerState::Changes::FrameRate | RequestedLayerState::Changes::GameMode);
+    ftl::Flags<RequestedLayerState::Changes> parentChanges =
+            parentSnapshot.changes & kChangesInheritedByChildren;
     snapshot.changes |= parentChanges;
     if (args.displayChanges) snapshot.changes |= RequestedLayerState::Changes::Geometry;
     snapshot.reachablilty = LayerSnapshot::Reachablilty::Reachable;
@@ -58,6 +58,10 @@ public:
         const std::unordered_map<std::string, bool>& supportedLayerGenericMetadata;
         const std::unordered_map<std::string, uint32_t>& genericLayerMetadataKeyMap;
         bool skipRoundCornersWhenProtected = false;
+        // If set, updates that do not change the shape of the hierarchy will only walk
+        // subtrees containing a changed layer, or subtrees whose parent snapshot has changes
+        // that are inherited by its children. Clean subtrees keep their existing snapshots.
+        bool updateDirtySubtreesOnly = false;
         LayerSnapshot rootSnapshot = getRootSnapshot();
     };
     LayerSnapshotBuilder();
@@ -106,6 +110,15 @@ private:
 
     void updateSnapshots(const Args& args);
 
+    // Returns true if the update can skip subtrees that do not contain any changed layers.
+    static bool canUpdateDirtySubtreesOnly(const Args& args);
+    // Collects the ids of all changed layers and their ancestors.
+    void collectDirtySubtrees(const Args& args);
+    // Returns the existing snapshot for the child at traversalPath if its subtree does not
+    // need to be walked, otherwise returns nullptr.
+    LayerSnapshot* getCleanSubtreeSnapshot(const LayerSnapshot& parentSnapshot,
+                                           const LayerHierarchy::TraversalPath&) const;
+
     const LayerSnapshot& updateSnapshotsInHierarchy(const Args&, const LayerHierarchy& hierarchy,
                                                     LayerHierarchy::TraversalPath& traversalPath,
                                                     const LayerSnapshot& parentSnapshot, int depth);
@@ -138,9 +151,14 @@ private:
                                           const Args& args, bool* outChildHasValidFrameRate);
     void updateTouchableRegionCrop(const Args& args);
 
+    // Most snapshots are reached without going through a mirror, and their traversal path is
+    // uniquely identified by the layer id. Keep those in an integer keyed map so the common
+    // lookup does not hash or compare mirror root ids. Only cloned snapshots are keyed by their
+    // full traversal path.
+    std::unordered_map<uint32_t, LayerSnapshot*> mLayerIdToSnapshot;
     std::unordered_map<LayerHierarchy::TraversalPath, LayerSnapshot*,
                        LayerHierarchy::TraversalPathHash>
-            mPathToSnapshot;
+            mClonePathToSnapshot;
     std::multimap<uint32_t, LayerSnapshot*> mIdToSnapshots;
 
     // Track snapshots that needs touchable region crop from other snapshots
@@ -149,6 +167,12 @@ private:
     std::vector<std::unique_ptr<LayerSnapshot>> mSnapshots;
     bool mResortSnapshots = false;
     int mNumInterestingSnapshots = 0;
+
+    // Set for the duration of updateSnapshots if only dirty subtrees are walked.
+    bool mUpdateDirtySubtreesOnly = false;
+    // Ids of changed layers and their ancestors. Any traversal path ending in one of these
+    // layers, including mirrored and relative paths, needs to be walked.
+    std::unordered_set<uint32_t> mDirtySubtreeLayerIds;
 };
 
 } // namespace android::surfaceflinger::frontend
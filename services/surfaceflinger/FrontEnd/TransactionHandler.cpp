@@ -40,7 +40,7 @@ void TransactionHandler::collectTransactions() {
         if (!maybeTransaction.has_value()) {
             break;
         }
-        auto transaction = maybeTransaction.value();
+        auto& transaction = *maybeTransaction;
         mPendingTransactionQueues[transaction.applyToken].emplace(std::move(transaction));
     }
 }
@@ -60,13 +60,20 @@ std::vector<TransactionState> TransactionHandler::flushTransactions() {
     // loop through flushPendingTransactionQueues until we perform an iteration
     // where the number of transactionsPendingBarrier doesn't change. This way
     // we can continue to resolve dependency chains of barriers as far as possible.
+    //
+    // Only the queues blocked on a barrier are revisited after the first iteration. Applying
+    // more transactions can only satisfy barriers; it cannot make another queue's timeline,
+    // back pressure or unsignaled fence checks pass, so re-running the filters on those queues
+    // would only repeat work with the same result.
+    std::vector<sp<IBinder>> queuesPendingBarrier;
     int lastTransactionsPendingBarrier = 0;
-    int transactionsPendingBarrier = 0;
-    do {
+    int transactionsPendingBarrier = flushPendingTransactionQueues(transactions, flushState,
+                                                                   queuesPendingBarrier);
+    while (lastTransactionsPendingBarrier != transactionsPendingBarrier) {
         lastTransactionsPendingBarrier = transactionsPendingBarrier;
-        // Collect transactions that are ready to be applied.
-        transactionsPendingBarrier = flushPendingTransactionQueues(transactions, flushState);
-    } while (lastTransactionsPendingBarrier != transactionsPendingBarrier);
+        transactionsPendingBarrier =
+                flushBarrierTransactionQueues(transactions, flushState, queuesPendingBarrier);
+    }
 
     applyUnsignaledBufferTransaction(transactions, flushState);
 
@@ -146,29 +153,36 @@ TransactionHandler::TransactionReadiness TransactionHandler::applyFilters(
     return ready;
 }
 
-int TransactionHandler::flushPendingTransactionQueues(std::vector<TransactionState>& transactions,
-                                                      TransactionFlushState& flushState) {
-    int transactionsPendingBarrier = 0;
+TransactionHandler::TransactionReadiness TransactionHandler::flushPendingTransactionQueue(
+        std::vector<TransactionState>& transactions, TransactionFlushState& flushState,
+        const sp<IBinder>& applyToken, std::queue<TransactionState>& queue) {
+    while (!queue.empty()) {
+        auto& transaction = queue.front();
+        flushState.transaction = &transaction;
+        auto ready = applyFilters(flushState);
+        if (ready == TransactionReadiness::NotReadyUnsignaled) {
+            // We maybe able to latch this transaction if it's the only transaction
+            // ready to be applied.
+            flushState.queueWithUnsignaledBuffer = applyToken;
+        }
+        if (ready != TransactionReadiness::Ready) {
+            return ready;
+        }
+        popTransactionFromPending(transactions, flushState, queue);
+    }
+    return TransactionReadiness::Ready;
+}
+
+int TransactionHandler::flushPendingTransactionQueues(
+        std::vector<TransactionState>& transactions, TransactionFlushState& flushState,
+        std::vector<sp<IBinder>>& outQueuesPendingBarrier) {
+    outQueuesPendingBarrier.clear();
     auto it = mPendingTransactionQueues.begin();
     while (it != mPendingTransactionQueues.end()) {
         auto& [applyToken, queue] = *it;
-        while (!queue.empty()) {
-            auto& transaction = queue.front();
-            flushState.transaction = &transaction;
-            auto ready = applyFilters(flushState);
-            if (ready == TransactionReadiness::NotReadyBarrier) {
-                transactionsPendingBarrier++;
-                break;
-            } else if (ready == TransactionReadiness::NotReady) {
-                break;
-            } else if (ready == TransactionReadiness::NotReadyUnsignaled) {
-                // We maybe able to latch this transaction if it's the only transaction
-                // ready to be applied.
-                flushState.queueWithUnsignaledBuffer = applyToken;
-                break;
-            }
-            // ready == TransactionReadiness::Ready
-            popTransactionFromPending(transactions, flushState, queue);
+        if (flushPendingTransactionQueue(transactions, flushState, applyToken, queue) ==
+            TransactionReadiness::NotReadyBarrier) {
+            outQueuesPendingBarrier.push_back(applyToken);
         }
 
         if (queue.empty()) {
@@ -177,7 +191,30 @@ int TransactionHandler::flushPendingTransactionQueues(std::vector<TransactionSta
             it = std::next(it, 1);
         }
     }
-    return transactionsPendingBarrier;
+    return static_cast<int>(outQueuesPendingBarrier.size());
+}
+
+int TransactionHandler::flushBarrierTransactionQueues(
+        std::vector<TransactionState>& transactions, TransactionFlushState& flushState,
+        std::vector<sp<IBinder>>& queuesPendingBarrier) {
+    // Keep the relative order of the previous iteration so the result stays deterministic.
+    auto stillPending = queuesPendingBarrier.begin();
+    for (const sp<IBinder>& applyToken : queuesPendingBarrier) {
+        auto it = mPendingTransactionQueues.find(applyToken);
+        if (it == mPendingTransactionQueues.end()) {
+            continue;
+        }
+        auto& queue = it->second;
+        const auto ready = flushPendingTransactionQueue(transactions, flushState, applyToken, queue);
+        if (queue.empty()) {
+            mPendingTransactionQueues.erase(it);
+        }
+        if (ready == TransactionReadiness::NotReadyBarrier) {
+            *stillPending++ = applyToken;
+        }
+    }
+    queuesPendingBarrier.erase(stillPending, queuesPendingBarrier.end());
+    return static_cast<int>(queuesPendingBarrier.size());
 }
 
 void TransactionHandler::addTransactionReadyFilter(TransactionFilter&& filter) {
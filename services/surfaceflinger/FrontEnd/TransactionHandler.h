@@ -81,7 +81,18 @@ private:
     // For unit tests
     friend class ::android::TestableSurfaceFlinger;
 
-    int flushPendingTransactionQueues(std::vector<TransactionState>&, TransactionFlushState&);
+    // Walks every pending queue, applying transactions until each queue's head is not ready.
+    // Returns the number of queues blocked on a barrier and lists them in the last argument.
+    int flushPendingTransactionQueues(std::vector<TransactionState>&, TransactionFlushState&,
+                                      std::vector<sp<IBinder>>& outQueuesPendingBarrier);
+    // Like flushPendingTransactionQueues, but only revisits the queues that were blocked on a
+    // barrier, removing the ones that no longer are.
+    int flushBarrierTransactionQueues(std::vector<TransactionState>&, TransactionFlushState&,
+                                      std::vector<sp<IBinder>>& queuesPendingBarrier);
+    TransactionReadiness flushPendingTransactionQueue(std::vector<TransactionState>&,
+                                                      TransactionFlushState&,
+                                                      const sp<IBinder>& applyToken,
+                                                      std::queue<TransactionState>&);
     void applyUnsignaledBufferTransaction(std::vector<TransactionState>&, TransactionFlushState&);
     void popTransactionFromPending(std::vector<TransactionState>&, TransactionFlushState&,
                                    std::queue<TransactionState>&);
@@ -125,6 +125,9 @@ bool HdrSdrRatioOverlay::initCheck() const {
 }
 
 void HdrSdrRatioOverlay::changeHdrSdrRatio(float currentHdrSdrRatio) {
+    // Brightness updates repeat the same ratio while the HDR content is static, which does not
+    // need redrawing.
+    if (mDrawnHdrSdrRatio == currentHdrSdrRatio) return;
     mCurrentHdrSdrRatio = currentHdrSdrRatio;
     animate();
 }
@@ -197,6 +200,7 @@ void HdrSdrRatioOverlay::animate() {
     createTransaction()
             .setBuffer(mSurfaceControl->get(), getOrCreateBuffers(mCurrentHdrSdrRatio))
             .apply();
+    mDrawnHdrSdrRatio = mCurrentHdrSdrRatio;
 }
 
 SurfaceComposerClient::Transaction HdrSdrRatioOverlay::createTransaction() const {
@@ -21,6 +21,8 @@
 #include <ui/Size.h>
 #include <utils/StrongPointer.h>
 
+#include <optional>
+
 class SkCanvas;
 
 namespace android {
@@ -49,6 +51,7 @@ private:
     const sp<GraphicBuffer> getOrCreateBuffers(float currentHdrSdrRatio);
 
     float mCurrentHdrSdrRatio = 1.f;
+    std::optional<float> mDrawnHdrSdrRatio;
     const std::unique_ptr<SurfaceControlHolder> mSurfaceControl;
 
     size_t mIndex = 0;
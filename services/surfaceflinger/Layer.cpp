@@ -670,7 +670,7 @@ Region Layer::getVisibleRegion(const DisplayDevice* display) const {
 
 void Layer::callReleaseBufferCallback(const sp<ITransactionCompletedListener>& listener,
                                       const sp<GraphicBuffer>& buffer, uint64_t framenumber,
-                                      const sp<Fence>& releaseFence) {
+                                      const sp<Fence>& releaseFence, bool batchWithCallbacks) {
     if (!listener && !mBufferReleaseChannel) {
         return;
     }
@@ -682,12 +682,26 @@ void Layer::callReleaseBufferCallback(const sp<ITransactionCompletedListener>& l
     uint32_t currentMaxAcquiredBufferCount =
             mFlinger->getMaxAcquiredBufferCountForCurrentRefreshRate(mOwnerUid);
 
+    const bool batch =
+            batchWithCallbacks && FlagManager::getInstance().transaction_callback_batched_releases();
     if (listener) {
-        listener->onReleaseBuffer(callbackId, fence, currentMaxAcquiredBufferCount);
+        if (batch) {
+            mFlinger->mTransactionCallbackInvoker.addReleasedBuffer(listener, callbackId, fence,
+                                                                    currentMaxAcquiredBufferCount);
+        } else {
+            listener->onReleaseBuffer(callbackId, fence, currentMaxAcquiredBufferCount);
+        }
     }
 
     if (mBufferReleaseChannel) {
-        mBufferReleaseChannel->writeReleaseFence(callbackId, fence, currentMaxAcquiredBufferCount);
+        if (batch) {
+            mFlinger->mTransactionCallbackInvoker.addBufferRelease(mBufferReleaseChannel,
+                                                                   callbackId, fence,
+                                                                   currentMaxAcquiredBufferCount);
+        } else {
+            mBufferReleaseChannel->writeReleaseFence(callbackId, fence,
+                                                     currentMaxAcquiredBufferCount);
+        }
     }
 }
 
@@ -852,7 +866,7 @@ void Layer::releasePreviousBuffer() {
         // call any release buffer callbacks if set.
         callReleaseBufferCallback(mDrawingState.releaseBufferListener,
                                   mDrawingState.buffer->getBuffer(), mDrawingState.frameNumber,
-                                  mDrawingState.acquireFence);
+                                  mDrawingState.acquireFence, /*batchWithCallbacks=*/true);
         const int32_t layerId = getSequence();
         mFlinger->mTimeStats->removeTimeRecord(layerId, mDrawingState.frameNumber);
         decrementPendingBufferCount();
@@ -864,7 +878,7 @@ void Layer::releasePreviousBuffer() {
     } else if (EARLY_RELEASE_ENABLED && mLastClientCompositionFence != nullptr) {
         callReleaseBufferCallback(mDrawingState.releaseBufferListener,
                                   mDrawingState.buffer->getBuffer(), mDrawingState.frameNumber,
-                                  mLastClientCompositionFence);
+                                  mLastClientCompositionFence, /*batchWithCallbacks=*/true);
         mLastClientCompositionFence = nullptr;
     }
 }
@@ -1609,9 +1623,51 @@ void Layer::setIsSmallDirty(frontend::LayerSnapshot* snapshot) {
 
     // If the damage region is a small dirty, this could give the hint for the layer history that
     // it could suppress the heuristic rate when calculating.
-    snapshot->isSmallDirty =
-            mFlinger->mScheduler->isSmallDirtyArea(mOwnerAppId,
-                                                   bounds.getWidth() * bounds.getHeight());
+    const uint32_t dirtyArea = bounds.getWidth() * bounds.getHeight();
+    snapshot->isSmallDirty = mFlinger->mScheduler->isSmallDirtyArea(mOwnerAppId, dirtyArea);
+    if (snapshot->isSmallDirty || !mFlinger->mScheduler->supportSmallDirtyContentDiff()) {
+        return;
+    }
+
+    // Some apps report full surface damage for tiny updates, so measure what actually changed.
+    if (const auto changedFraction = sampleChangedFraction(*snapshot)) {
+        snapshot->isSmallDirty =
+                mFlinger->mScheduler->isSmallDirtyArea(mOwnerAppId,
+                                                       static_cast<uint32_t>(dirtyArea *
+                                                                             *changedFraction));
+    }
+}
+
+std::optional<float> Layer::sampleChangedFraction(const frontend::LayerSnapshot& snapshot) {
+    const auto& externalTexture = snapshot.externalTexture;
+    if (!externalTexture || (externalTexture->getUsage() & GRALLOC_USAGE_SW_READ_MASK) == 0) {
+        mContentDiffSampler.reset();
+        return std::nullopt;
+    }
+    // Reading the buffer must not wait for the producer.
+    if (snapshot.acquireFence &&
+        snapshot.acquireFence->getStatus() != Fence::Status::Signaled) {
+        return std::nullopt;
+    }
+
+    const sp<GraphicBuffer>& buffer = externalTexture->getBuffer();
+    const uint32_t bytesPerPixel = android::bytesPerPixel(buffer->getPixelFormat());
+    if (bytesPerPixel == 0) {
+        mContentDiffSampler.reset();
+        return std::nullopt;
+    }
+    void* pixels = nullptr;
+    if (buffer->lock(GRALLOC_USAGE_SW_READ_OFTEN, &pixels) != OK || pixels == nullptr) {
+        return std::nullopt;
+    }
+    const auto changedFraction =
+            mContentDiffSampler.sample(static_cast<const uint8_t*>(pixels),
+                                       static_cast<int32_t>(buffer->getWidth()),
+                                       static_cast<int32_t>(buffer->getHeight()),
+                                       static_cast<int32_t>(buffer->getStride()),
+                                       static_cast<int32_t>(bytesPerPixel));
+    buffer->unlock();
+    return changedFraction;
 }
 
 } // namespace android
@@ -52,6 +52,7 @@
 #include "FrameTracker.h"
 #include "LayerFE.h"
 #include "LayerVector.h"
+#include "Scheduler/ContentDiffSampler.h"
 #include "Scheduler/LayerInfo.h"
 #include "SurfaceFlinger.h"
 #include "TransactionCallbackInvoker.h"
@@ -371,9 +372,11 @@ public:
     void decrementPendingBufferCount();
     std::atomic<int32_t>* getPendingBufferCounter() { return &mPendingBufferTransactions; }
     std::string getPendingBufferCounterName() { return mBlastTransactionName; }
+    // When batchWithCallbacks is set, the release is sent to the listener together with the next
+    // transaction callbacks of this frame. Only set it on the main thread during commit.
     void callReleaseBufferCallback(const sp<ITransactionCompletedListener>& listener,
                                    const sp<GraphicBuffer>& buffer, uint64_t framenumber,
-                                   const sp<Fence>& releaseFence);
+                                   const sp<Fence>& releaseFence, bool batchWithCallbacks = false);
     bool setFrameRateForLayerTree(FrameRate, const scheduler::LayerProps&, nsecs_t now);
     void recordLayerHistoryBufferUpdate(const scheduler::LayerProps&, nsecs_t now);
     void recordLayerHistoryAnimationTx(const scheduler::LayerProps&, nsecs_t now);
@@ -417,6 +420,9 @@ public:
 
     // Check if the damage region is a small dirty.
     void setIsSmallDirty(frontend::LayerSnapshot* snapshot);
+    // Returns the fraction of the buffer whose content changed since the previous buffer, if it
+    // can be read by the CPU.
+    std::optional<float> sampleChangedFraction(const frontend::LayerSnapshot& snapshot);
 
 protected:
     // For unit tests
@@ -475,6 +481,8 @@ protected:
 
     int32_t mOwnerAppId;
 
+    scheduler::ContentDiffSampler mContentDiffSampler;
+
     // Keeps track of the time SF latched the last buffer from this layer.
     // Used in buffer stuffing analysis in FrameTimeline.
     nsecs_t mLastLatchTime = 0;
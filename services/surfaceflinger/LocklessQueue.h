@@ -17,6 +17,7 @@
 #pragma once
 
 #include <atomic>
+#include <cstddef>
 #include <optional>
 
 // Single consumer multi producer queue. We can understand the two operations independently to see
@@ -36,13 +37,31 @@
 // then store the list and pop one element.
 //
 // If we already had something in the pop list we just pop directly.
+//
+// Entries are recycled instead of being freed after each pop, so that steady state traffic does
+// not allocate. The consumer pushes spent entries onto mFree, and a producer takes the whole free
+// list at once with an exchange, keeping it in a per-thread cache it allocates from. Producers never
+// pop single entries off a shared list, so there is no ABA hazard. At most kMaxFreeEntries spent
+// entries are kept per queue; beyond that they are deleted.
 template <typename T>
 class LocklessQueue {
 public:
+    static constexpr size_t kMaxFreeEntries = 64;
+
+    LocklessQueue() = default;
+    LocklessQueue(const LocklessQueue&) = delete;
+    LocklessQueue& operator=(const LocklessQueue&) = delete;
+
+    ~LocklessQueue() {
+        deleteList(mPush.load());
+        deleteList(mPop.load());
+        deleteList(mFree.load());
+    }
+
     bool isEmpty() { return (mPush.load() == nullptr) && (mPop.load() == nullptr); }
 
     void push(T value) {
-        Entry* entry = new Entry(std::move(value));
+        Entry* entry = obtainEntry(std::move(value));
         Entry* previousHead = mPush.load(/*std::memory_order_relaxed*/);
         do {
             entry->mNext = previousHead;
@@ -55,7 +74,7 @@ public:
             // Single consumer so this is fine
             mPop.store(popped->mNext /* , std::memory_order_release */);
             auto value = std::move(popped->mValue);
-            delete popped;
+            recycleEntry(popped);
             return value;
         } else {
             Entry* grabbedList = mPush.exchange(nullptr /* , std::memory_order_acquire */);
@@ -69,7 +88,7 @@ public:
             }
             mPop.store(popped /* , std::memory_order_release */);
             auto value = std::move(grabbedList->mValue);
-            delete grabbedList;
+            recycleEntry(grabbedList);
             return value;
         }
     }
@@ -79,8 +98,60 @@ private:
     public:
         T mValue;
         std::atomic<Entry*> mNext;
-        Entry(T value) : mValue(value) {}
+        Entry(T&& value) : mValue(std::move(value)) {}
     };
+
+    // Spare entries owned by the calling producer thread. Entries have the same type in every
+    // LocklessQueue<T>, so the cache can hand out entries that another queue of T recycled.
+    struct EntryCache {
+        Entry* head = nullptr;
+        ~EntryCache() { deleteList(head); }
+    };
+
+    static EntryCache& threadEntryCache() {
+        static thread_local EntryCache cache;
+        return cache;
+    }
+
+    static void deleteList(Entry* entry) {
+        while (entry) {
+            Entry* next = entry->mNext;
+            delete entry;
+            entry = next;
+        }
+    }
+
+    Entry* obtainEntry(T&& value) {
+        EntryCache& cache = threadEntryCache();
+        if (!cache.head) {
+            cache.head = mFree.exchange(nullptr /* , std::memory_order_acquire */);
+            mFreeCount.store(0, std::memory_order_relaxed);
+        }
+        Entry* entry = cache.head;
+        if (!entry) {
+            return new Entry(std::move(value));
+        }
+        cache.head = entry->mNext;
+        entry->mValue = std::move(value);
+        return entry;
+    }
+
+    // Only called by the consumer.
+    void recycleEntry(Entry* entry) {
+        if (mFreeCount.load(std::memory_order_relaxed) >= kMaxFreeEntries) {
+            delete entry;
+            return;
+        }
+        mFreeCount.fetch_add(1, std::memory_order_relaxed);
+        Entry* previousHead = mFree.load(/*std::memory_order_relaxed*/);
+        do {
+            entry->mNext = previousHead;
+        } while (!mFree.compare_exchange_weak(previousHead, entry)); /*std::memory_order_release*/
+    }
+
     std::atomic<Entry*> mPush = nullptr;
     std::atomic<Entry*> mPop = nullptr;
+    std::atomic<Entry*> mFree = nullptr;
+    // Approximate length of mFree, only used to bound it.
+    std::atomic<size_t> mFreeCount = 0;
 };
@@ -36,6 +36,9 @@
 #include <renderengine/impl/ExternalTexture.h>
 #include <ui/DisplayStatInfo.h>
 
+#include <algorithm>
+#include <cmath>
+
 #include <string>
 
 #include "DisplayDevice.h"
@@ -225,8 +228,28 @@ float sampleArea(const uint32_t* data, int32_t width, int32_t height, int32_t st
     return accumulatedLuma / (255.0f * pixelCount);
 }
 
+Rect scaleSampleArea(const Rect& area, const Rect& sampledBounds, ui::Size sampleSize) {
+    if (!sampledBounds.isValid() || sampledBounds.isEmpty()) {
+        return Rect::EMPTY_RECT;
+    }
+    const float scaleX = static_cast<float>(sampleSize.width) / sampledBounds.getWidth();
+    const float scaleY = static_cast<float>(sampleSize.height) / sampledBounds.getHeight();
+    const Rect relative = area - sampledBounds.leftTop();
+
+    const auto scale = [](int32_t begin, int32_t end, float factor, int32_t size) {
+        int32_t scaledBegin = static_cast<int32_t>(std::floor(begin * factor));
+        int32_t scaledEnd = static_cast<int32_t>(std::ceil(end * factor));
+        scaledBegin = std::clamp(scaledBegin, 0, std::max(size - 1, 0));
+        scaledEnd = std::clamp(scaledEnd, scaledBegin + 1, std::max(size, 1));
+        return std::make_pair(scaledBegin, scaledEnd);
+    };
+    const auto [left, right] = scale(relative.left, relative.right, scaleX, sampleSize.width);
+    const auto [top, bottom] = scale(relative.top, relative.bottom, scaleY, sampleSize.height);
+    return Rect(left, top, right, bottom);
+}
+
 std::vector<float> RegionSamplingThread::sampleBuffer(
-        const sp<GraphicBuffer>& buffer, const Point& leftTop,
+        const sp<GraphicBuffer>& buffer, const Rect& sampledBounds,
         const std::vector<RegionSamplingThread::Descriptor>& descriptors, uint32_t orientation) {
     void* data_raw = nullptr;
     buffer->lock(GRALLOC_USAGE_SW_READ_OFTEN, &data_raw);
@@ -241,7 +264,8 @@ std::vector<float> RegionSamplingThread::sampleBuffer(
     std::transform(descriptors.begin(), descriptors.end(), lumas.begin(),
                    [&](auto const& descriptor) {
                        return sampleArea(data.get(), width, height, stride, orientation,
-                                         descriptor.area - leftTop);
+                                         scaleSampleArea(descriptor.area, sampledBounds,
+                                                         ui::Size(width, height)));
                    });
     return lumas;
 }
@@ -324,15 +348,25 @@ void RegionSamplingThread::captureSample() {
     auto getLayerSnapshotsFn =
             mFlinger.getLayerSnapshotsForScreenshots(layerStack, CaptureArgs::UNSET_UID, filterFn);
 
+    // Luma is averaged over each area, so the GPU can filter the capture down to a fraction of the
+    // pixels without changing the result much, which saves most of the CPU read-back.
+    ui::Size sampleSize = sampledBounds.getSize();
+    if (FlagManager::getInstance().region_sampling_downscale()) {
+        constexpr int32_t kDownscaleFactor = 4;
+        sampleSize.width = std::max(sampleSize.width / kDownscaleFactor, 1);
+        sampleSize.height = std::max(sampleSize.height / kDownscaleFactor, 1);
+    }
+
     std::shared_ptr<renderengine::ExternalTexture> buffer = nullptr;
-    if (mCachedBuffer && mCachedBuffer->getBuffer()->getWidth() == sampledBounds.getWidth() &&
-        mCachedBuffer->getBuffer()->getHeight() == sampledBounds.getHeight()) {
+    if (mCachedBuffer &&
+        mCachedBuffer->getBuffer()->getWidth() == static_cast<uint32_t>(sampleSize.width) &&
+        mCachedBuffer->getBuffer()->getHeight() == static_cast<uint32_t>(sampleSize.height)) {
         buffer = mCachedBuffer;
     } else {
         const uint32_t usage =
                 GRALLOC_USAGE_SW_READ_OFTEN | GRALLOC_USAGE_HW_RENDER | GRALLOC_USAGE_HW_TEXTURE;
         sp<GraphicBuffer> graphicBuffer =
-                sp<GraphicBuffer>::make(sampledBounds.getWidth(), sampledBounds.getHeight(),
+                sp<GraphicBuffer>::make(sampleSize.width, sampleSize.height,
                                         PIXEL_FORMAT_RGBA_8888, 1, usage, "RegionSamplingThread");
         const status_t bufferStatus = graphicBuffer->initCheck();
         LOG_ALWAYS_FATAL_IF(bufferStatus != OK, "captureSample: Buffer failed to allocate: %d",
@@ -350,7 +384,7 @@ void RegionSamplingThread::captureSample() {
 
     SurfaceFlinger::RenderAreaBuilderVariant
             renderAreaBuilder(std::in_place_type<DisplayRenderAreaBuilder>, sampledBounds,
-                              sampledBounds.getSize(), ui::Dataspace::V0_SRGB, displayWeak,
+                              sampleSize, ui::Dataspace::V0_SRGB, displayWeak,
                               RenderArea::Options::CAPTURE_SECURE_LAYERS);
 
     FenceResult fenceResult;
@@ -381,8 +415,8 @@ void RegionSamplingThread::captureSample() {
     }
 
     ALOGV("Sampling %zu descriptors", activeDescriptors.size());
-    std::vector<float> lumas = sampleBuffer(buffer->getBuffer(), sampledBounds.leftTop(),
-                                            activeDescriptors, orientation);
+    std::vector<float> lumas =
+            sampleBuffer(buffer->getBuffer(), sampledBounds, activeDescriptors, orientation);
     if (lumas.size() != activeDescriptors.size()) {
         ALOGW("collected %zu median luma values for %zu descriptors", lumas.size(),
               activeDescriptors.size());
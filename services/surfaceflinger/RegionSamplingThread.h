@@ -22,6 +22,7 @@
 #include <renderengine/ExternalTexture.h>
 #include <ui/GraphicBuffer.h>
 #include <ui/Rect.h>
+#include <ui/Size.h>
 #include <utils/StrongPointer.h>
 
 #include <chrono>
@@ -45,6 +46,10 @@ using gui::IRegionSamplingListener;
 float sampleArea(const uint32_t* data, int32_t width, int32_t height, int32_t stride,
                  uint32_t orientation, const Rect& area);
 
+// Maps an area in display space to the pixels of a sample buffer of the given size that holds
+// sampledBounds, rounding outwards so that the result is never empty.
+Rect scaleSampleArea(const Rect& area, const Rect& sampledBounds, ui::Size sampleSize);
+
 class RegionSamplingThread : public IBinder::DeathRecipient {
 public:
     struct TimingTunables {
@@ -92,7 +97,7 @@ private:
     };
 
     std::vector<float> sampleBuffer(
-            const sp<GraphicBuffer>& buffer, const Point& leftTop,
+            const sp<GraphicBuffer>& buffer, const Rect& sampledBounds,
             const std::vector<RegionSamplingThread::Descriptor>& descriptors, uint32_t orientation);
 
     void doSample(std::optional<std::chrono::steady_clock::time_point> samplingDeadline);
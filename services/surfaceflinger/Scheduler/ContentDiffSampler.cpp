@@ -0,0 +1,102 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ContentDiffSampler.h"
+
+#include <common/trace.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace android::scheduler {
+
+namespace {
+
+constexpr uint64_t kHashPrime = 0x100000001b3;
+
+uint64_t hashBytes(uint64_t hash, const uint8_t* bytes, size_t size) {
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, bytes + i, sizeof(word));
+        hash = (hash ^ word) * kHashPrime;
+    }
+    for (; i < size; i++) {
+        hash = (hash ^ bytes[i]) * kHashPrime;
+    }
+    return hash;
+}
+
+} // namespace
+
+std::optional<float> ContentDiffSampler::sample(const uint8_t* pixels, int32_t width,
+                                                int32_t height, int32_t stride,
+                                                int32_t bytesPerPixel) {
+    SFTRACE_CALL();
+    if (width <= 0 || height <= 0 || stride < width || bytesPerPixel <= 0) {
+        reset();
+        return std::nullopt;
+    }
+
+    const int32_t tileWidth = (width + kTilesPerSide - 1) / kTilesPerSide;
+    const int32_t tileHeight = (height + kTilesPerSide - 1) / kTilesPerSide;
+    const size_t rowBytes = static_cast<size_t>(stride) * bytesPerPixel;
+
+    std::vector<uint64_t> hashes(kTilesPerSide * kTilesPerSide, 0);
+    for (int32_t y = 0; y < height; y += kRowStep) {
+        const uint8_t* row = pixels + y * rowBytes;
+        uint64_t* tileHashes = &hashes[(y / tileHeight) * kTilesPerSide];
+        for (int32_t x = 0, tile = 0; x < width; x += tileWidth, tile++) {
+            const int32_t tileRowWidth = std::min(tileWidth, width - x);
+            tileHashes[tile] = hashBytes(tileHashes[tile], row + x * bytesPerPixel,
+                                         static_cast<size_t>(tileRowWidth) * bytesPerPixel);
+        }
+    }
+
+    const bool comparable = width == mWidth && height == mHeight;
+    int64_t changedArea = 0;
+    if (comparable) {
+        for (int32_t tileY = 0; tileY < kTilesPerSide; tileY++) {
+            const int32_t top = tileY * tileHeight;
+            if (top >= height) break;
+            for (int32_t tileX = 0; tileX < kTilesPerSide; tileX++) {
+                const int32_t left = tileX * tileWidth;
+                if (left >= width) break;
+                const size_t index = tileY * kTilesPerSide + tileX;
+                if (hashes[index] != mTileHashes[index]) {
+                    changedArea += static_cast<int64_t>(std::min(tileWidth, width - left)) *
+                            std::min(tileHeight, height - top);
+                }
+            }
+        }
+    }
+
+    mWidth = width;
+    mHeight = height;
+    mTileHashes = std::move(hashes);
+    if (!comparable) {
+        return std::nullopt;
+    }
+    return static_cast<float>(changedArea) / (static_cast<int64_t>(width) * height);
+}
+
+void ContentDiffSampler::reset() {
+    mWidth = 0;
+    mHeight = 0;
+    mTileHashes.clear();
+}
+
+} // namespace android::scheduler
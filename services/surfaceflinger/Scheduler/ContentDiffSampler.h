@@ -0,0 +1,48 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace android::scheduler {
+
+// Measures how much of a layer's content changed between consecutive buffers, for apps which
+// report full surface damage for tiny updates such as a blinking cursor. The buffer is split in
+// a grid of tiles, and each tile is hashed over a sample of its rows.
+class ContentDiffSampler {
+public:
+    static constexpr int32_t kTilesPerSide = 16;
+    // Only every kRowStep-th row of a tile is hashed.
+    static constexpr int32_t kRowStep = 4;
+
+    // Returns the fraction of the buffer covered by the tiles whose content changed since the
+    // previous buffer, or nullopt if there is no previous buffer of the same size. |stride| is in
+    // pixels.
+    std::optional<float> sample(const uint8_t* pixels, int32_t width, int32_t height,
+                                int32_t stride, int32_t bytesPerPixel);
+
+    void reset();
+
+private:
+    int32_t mWidth = 0;
+    int32_t mHeight = 0;
+    std::vector<uint64_t> mTileHashes;
+};
+
+} // namespace android::scheduler
@@ -24,11 +24,13 @@
 #include <sched.h>
 #include <sys/types.h>
 
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
 #include <optional>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 #include <android-base/stringprintf.h>
 
@@ -516,8 +518,21 @@ void EventThread::threadMain(std::unique_lock<std::mutex>& lock) {
         }
 
         if (!consumers.empty()) {
-            dispatchEvent(*event, consumers);
+            dispatchEvent(*event, consumers, lock);
             consumers.clear();
+
+            // mMutex was released while dispatching, so the destructor may have asked to quit, and
+            // connections may have requested vsync since they were scanned above.
+            if (mState == State::Quit) {
+                break;
+            }
+            vsyncRequested = std::any_of(mDisplayEventConnections.begin(),
+                                         mDisplayEventConnections.end(), [](const auto& weak) {
+                                             const auto connection = weak.promote();
+                                             return connection &&
+                                                     connection->vsyncRequest !=
+                                                     VSyncRequest::None;
+                                         });
         }
 
         if (mVSyncState && vsyncRequested) {
@@ -700,9 +715,12 @@ void EventThread::generateFrameTimeline(VsyncEventData& outVsyncEventData, nsecs
 }
 
 void EventThread::dispatchEvent(const DisplayEventReceiver::Event& event,
-                                const DisplayEventConsumers& consumers) {
+                                const DisplayEventConsumers& consumers,
+                                std::unique_lock<std::mutex>& lock) {
+    std::vector<DisplayEventReceiver::Event> events;
+    events.reserve(consumers.size());
     for (const auto& consumer : consumers) {
-        DisplayEventReceiver::Event copy = event;
+        DisplayEventReceiver::Event& copy = events.emplace_back(event);
         if (event.header.type == DisplayEventReceiver::DISPLAY_EVENT_VSYNC) {
             const Period frameInterval = mCallback.getVsyncPeriod(consumer->mOwnerUid);
             copy.vsync.vsyncData.frameInterval = frameInterval.ns();
@@ -710,19 +728,35 @@ void EventThread::dispatchEvent(const DisplayEventReceiver::Event& event,
                                   event.vsync.vsyncData.preferredExpectedPresentationTime(),
                                   event.vsync.vsyncData.preferredDeadlineTimestamp());
         }
-        switch (consumer->postEvent(copy)) {
+    }
+
+    // Write to the connections without holding mMutex, so that clients requesting vsync or
+    // registering connections are not blocked behind one syscall per consumer. Connections are
+    // only written from this thread, and the consumers are kept alive by the strong references.
+    std::vector<status_t> results(consumers.size());
+    lock.unlock();
+    {
+        SFTRACE_NAME("postEvents");
+        for (size_t i = 0; i < consumers.size(); i++) {
+            results[i] = consumers[i]->postEvent(events[i]);
+        }
+    }
+    lock.lock();
+
+    for (size_t i = 0; i < consumers.size(); i++) {
+        switch (results[i]) {
             case NO_ERROR:
                 break;
 
             case -EAGAIN:
                 // TODO: Try again if pipe is full.
                 ALOGW("Failed dispatching %s for %s", toString(event).c_str(),
-                      toString(*consumer).c_str());
+                      toString(*consumers[i]).c_str());
                 break;
 
             default:
                 // Treat EPIPE and other errors as fatal.
-                removeDisplayEventConnectionLocked(consumer);
+                removeDisplayEventConnectionLocked(consumers[i]);
         }
     }
     if (event.header.type == DisplayEventReceiver::DISPLAY_EVENT_VSYNC &&
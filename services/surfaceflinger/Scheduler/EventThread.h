@@ -193,8 +193,10 @@ private:
 
     bool shouldConsumeEvent(const DisplayEventReceiver::Event& event,
                             const sp<EventThreadConnection>& connection) const REQUIRES(mMutex);
+    // Temporarily releases the lock while writing events to the consumers.
     void dispatchEvent(const DisplayEventReceiver::Event& event,
-                       const DisplayEventConsumers& consumers) REQUIRES(mMutex);
+                       const DisplayEventConsumers& consumers, std::unique_lock<std::mutex>& lock)
+            REQUIRES(mMutex);
 
     void removeDisplayEventConnectionLocked(const wp<EventThreadConnection>& connection)
             REQUIRES(mMutex);
@@ -76,6 +76,7 @@ void LayerInfo::setLastPresentTime(nsecs_t lastPresentTime, nsecs_t now, LayerUp
             if (mFrameTimes.size() > HISTORY_SIZE) {
                 mFrameTimes.pop_front();
             }
+            mAverageFrameTimeCache.reset();
             break;
     }
 }
@@ -265,6 +266,13 @@ std::optional<nsecs_t> LayerInfo::calculateAverageFrameTime() const {
     return static_cast<nsecs_t>(averageFrameTime);
 }
 
+std::optional<nsecs_t> LayerInfo::getAverageFrameTime() {
+    if (!mAverageFrameTimeCache) {
+        mAverageFrameTimeCache = calculateAverageFrameTime();
+    }
+    return *mAverageFrameTimeCache;
+}
+
 std::optional<Fps> LayerInfo::calculateRefreshRateIfPossible(const RefreshRateSelector& selector,
                                                              nsecs_t now) {
     SFTRACE_CALL();
@@ -274,7 +282,7 @@ std::optional<Fps> LayerInfo::calculateRefreshRateIfPossible(const RefreshRateSe
         return std::nullopt;
     }
 
-    if (const auto averageFrameTime = calculateAverageFrameTime()) {
+    if (const auto averageFrameTime = getAverageFrameTime()) {
         const auto refreshRate = Fps::fromPeriodNsecs(*averageFrameTime);
         const auto closestKnownRefreshRate = mRefreshRateHistory.add(refreshRate, now, selector);
         if (closestKnownRefreshRate.isValid()) {
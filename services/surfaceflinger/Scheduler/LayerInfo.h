@@ -236,6 +236,7 @@ public:
     void clearHistory(nsecs_t now) {
         onLayerInactive(now);
         mFrameTimes.clear();
+        mAverageFrameTimeCache.reset();
     }
 
 private:
@@ -319,6 +320,7 @@ private:
     bool hasEnoughDataForHeuristic() const;
     std::optional<Fps> calculateRefreshRateIfPossible(const RefreshRateSelector&, nsecs_t now);
     std::optional<nsecs_t> calculateAverageFrameTime() const;
+    std::optional<nsecs_t> getAverageFrameTime();
     bool isFrameTimeValid(const FrameTimeData&) const;
 
     const std::string mName;
@@ -347,6 +349,10 @@ private:
     RefreshRateHeuristicData mLastRefreshRate;
 
     std::deque<FrameTimeData> mFrameTimes;
+    // The result of calculateAverageFrameTime, which walks the whole of mFrameTimes. Reset
+    // whenever mFrameTimes changes, so that layers which did not present since the last summary
+    // do not recompute it.
+    std::optional<std::optional<nsecs_t>> mAverageFrameTimeCache;
     std::chrono::time_point<std::chrono::steady_clock> mFrameTimeValidSince =
             std::chrono::steady_clock::now();
     static constexpr size_t HISTORY_SIZE = RefreshRateHistory::HISTORY_SIZE;
@@ -46,6 +46,24 @@ void MessageQueue::Handler::handleMessage(const Message&) {
     mQueue.onFrameSignal(mQueue.mCompositor, mVsyncId, mExpectedVsyncTime);
 }
 
+void MessageQueue::EarlyWakeupHandler::scheduleAt(TimePoint wakeupTime) {
+    // Only the first request per frame is kept, later ones target the same frame callback.
+    if (!mWakeupPending.exchange(true)) {
+        mQueue.mLooper->sendMessageAtTime(wakeupTime.ns(),
+                                          sp<MessageHandler>::fromExisting(this), Message());
+    }
+}
+
+void MessageQueue::EarlyWakeupHandler::handleMessage(const Message&) {
+    mWakeupPending.store(false);
+
+    // The frame is already due, so there is no idle time left to use.
+    if (mQueue.mHandler->isFramePending()) return;
+
+    SFTRACE_NAME("EarlyWakeup");
+    mQueue.mCompositor.prepareCommit();
+}
+
 MessageQueue::MessageQueue(ICompositor& compositor)
       : MessageQueue(compositor, sp<Handler>::make(*this)) {}
 
@@ -54,7 +72,8 @@ constexpr bool kAllowNonCallbacks = true;
 MessageQueue::MessageQueue(ICompositor& compositor, sp<Handler> handler)
       : mCompositor(compositor),
         mLooper(sp<Looper>::make(kAllowNonCallbacks)),
-        mHandler(std::move(handler)) {}
+        mHandler(std::move(handler)),
+        mEarlyWakeupHandler(sp<EarlyWakeupHandler>::make(*this)) {}
 
 void MessageQueue::vsyncCallback(nsecs_t vsyncTime, nsecs_t targetWakeupTime, nsecs_t readyTime) {
     SFTRACE_CALL();
@@ -145,6 +164,11 @@ void MessageQueue::setDuration(std::chrono::nanoseconds workDuration) {
                                          .lastVsync = mVsync.lastCallbackTime.ns()});
 }
 
+void MessageQueue::setEarlyWakeupDuration(std::chrono::nanoseconds duration) {
+    std::lock_guard lock(mVsync.mutex);
+    mVsync.earlyWakeupDuration = duration;
+}
+
 void MessageQueue::waitMessage() {
     do {
         IPCThreadState::self()->flushCommands();
@@ -197,6 +221,11 @@ void MessageQueue::scheduleFrame(Duration workDurationSlack) {
             mVsync.registration->schedule({.workDuration = workDuration.ns(),
                                            .readyDuration = 0,
                                            .lastVsync = mVsync.lastCallbackTime.ns()});
+
+    if (mVsync.earlyWakeupDuration > std::chrono::nanoseconds(0) && mVsync.scheduledFrameTimeOpt) {
+        mEarlyWakeupHandler->scheduleAt(mVsync.scheduledFrameTimeOpt->callbackTime -
+                                        Duration(mVsync.earlyWakeupDuration));
+    }
 }
 
 std::optional<scheduler::ScheduleResult> MessageQueue::getScheduledFrameResult() const {
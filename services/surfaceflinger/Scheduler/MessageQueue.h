@@ -70,6 +70,9 @@ public:
                                    std::chrono::nanoseconds workDuration) = 0;
     virtual void destroyVsync() = 0;
     virtual void setDuration(std::chrono::nanoseconds workDuration) = 0;
+    // Sets how long before the frame callback ICompositor::prepareCommit is called, or 0 to
+    // disable the early wakeup.
+    virtual void setEarlyWakeupDuration(std::chrono::nanoseconds) = 0;
     virtual void waitMessage() = 0;
     virtual void postMessage(sp<MessageHandler>&&) = 0;
     virtual void postMessageDelayed(sp<MessageHandler>&&, nsecs_t uptimeDelay) = 0;
@@ -103,6 +106,19 @@ protected:
 
     friend class Handler;
 
+    class EarlyWakeupHandler : public MessageHandler {
+        MessageQueue& mQueue;
+        std::atomic_bool mWakeupPending = false;
+
+    public:
+        explicit EarlyWakeupHandler(MessageQueue& queue) : mQueue(queue) {}
+        void handleMessage(const Message& message) override;
+
+        void scheduleAt(TimePoint wakeupTime);
+    };
+
+    friend class EarlyWakeupHandler;
+
     // For tests.
     MessageQueue(ICompositor&, sp<Handler>);
 
@@ -116,6 +132,7 @@ private:
     ICompositor& mCompositor;
     const sp<Looper> mLooper;
     const sp<Handler> mHandler;
+    const sp<EarlyWakeupHandler> mEarlyWakeupHandler;
 
     struct Vsync {
         frametimeline::TokenManager* tokenManager = nullptr;
@@ -126,6 +143,8 @@ private:
                 GUARDED_BY(mutex) = {"VsyncWorkDuration-sf", std::chrono::nanoseconds(0)};
         TimePoint lastCallbackTime GUARDED_BY(mutex);
         std::optional<scheduler::ScheduleResult> scheduledFrameTimeOpt GUARDED_BY(mutex);
+        std::chrono::nanoseconds earlyWakeupDuration GUARDED_BY(mutex) =
+                std::chrono::nanoseconds(0);
         TracedOrdinal<int> value = {"VSYNC-sf", 0};
     };
 
@@ -143,6 +162,7 @@ public:
                            std::chrono::nanoseconds workDuration) override;
     void destroyVsync() override;
     void setDuration(std::chrono::nanoseconds workDuration) override;
+    void setEarlyWakeupDuration(std::chrono::nanoseconds) override;
 
     void waitMessage() override;
     void postMessage(sp<MessageHandler>&&) override;
@@ -21,6 +21,7 @@
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wextra"
 
+#include <algorithm>
 #include <chrono>
 #include <cmath>
 #include <deque>
@@ -481,13 +482,25 @@ auto RefreshRateSelector::getRankedFrameRates(const std::vector<LayerRequirement
 
     std::lock_guard lock(mLock);
 
-    if (mGetRankedFrameRatesCache && mGetRankedFrameRatesCache->matches(cache)) {
-        return mGetRankedFrameRatesCache->result;
+    const auto it = std::find_if(mGetRankedFrameRatesCache.begin(), mGetRankedFrameRatesCache.end(),
+                                 [&cache](const auto& entry) { return entry.matches(cache); });
+    if (it != mGetRankedFrameRatesCache.end()) {
+        mGetRankedFrameRatesCacheHits++;
+        std::rotate(mGetRankedFrameRatesCache.begin(), it, it + 1);
+        return mGetRankedFrameRatesCache.front().result;
     }
 
+    mGetRankedFrameRatesCacheMisses++;
     cache.result = getRankedFrameRatesLocked(layers, signals, pacesetterFps);
-    mGetRankedFrameRatesCache = std::move(cache);
-    return mGetRankedFrameRatesCache->result;
+    if (mGetRankedFrameRatesCache.size() == kGetRankedFrameRatesCacheSize) {
+        mGetRankedFrameRatesCache.pop_back();
+    }
+    mGetRankedFrameRatesCache.insert(mGetRankedFrameRatesCache.begin(), std::move(cache));
+    return mGetRankedFrameRatesCache.front().result;
+}
+
+void RefreshRateSelector::clearGetRankedFrameRatesCacheLocked() {
+    mGetRankedFrameRatesCache.clear();
 }
 
 auto RefreshRateSelector::getRankedFrameRatesLocked(const std::vector<LayerRequirement>& layers,
@@ -1305,7 +1318,7 @@ void RefreshRateSelector::setActiveMode(DisplayModeId modeId, Fps renderFrameRat
 
     // Invalidate the cached invocation to getRankedFrameRates. This forces
     // the refresh rate to be recomputed on the next call to getRankedFrameRates.
-    mGetRankedFrameRatesCache.reset();
+    clearGetRankedFrameRatesCacheLocked();
 
     const auto activeModeOpt = mDisplayModes.get(modeId);
     LOG_ALWAYS_FATAL_IF(!activeModeOpt);
@@ -1346,7 +1359,7 @@ void RefreshRateSelector::updateDisplayModes(DisplayModes modes, DisplayModeId a
 
     // Invalidate the cached invocation to getRankedFrameRates. This forces
     // the refresh rate to be recomputed on the next call to getRankedFrameRates.
-    mGetRankedFrameRatesCache.reset();
+    clearGetRankedFrameRatesCacheLocked();
 
     mDisplayModes = std::move(modes);
     const auto activeModeOpt = mDisplayModes.get(activeModeId);
@@ -1446,7 +1459,7 @@ auto RefreshRateSelector::setPolicy(const PolicyVariant& policy) -> SetPolicyRes
             return SetPolicyResult::Invalid;
         }
 
-        mGetRankedFrameRatesCache.reset();
+        clearGetRankedFrameRatesCacheLocked();
 
         const auto& idleScreenConfigOpt = getCurrentPolicyLocked()->idleScreenConfigOpt;
         if (idleScreenConfigOpt != oldPolicy.idleScreenConfigOpt) {
@@ -1679,6 +1692,14 @@ void RefreshRateSelector::dump(utils::Dumper& dumper) const {
 
     dumper.dump("frameRateOverrideConfig"sv, *ftl::enum_name(mFrameRateOverrideConfig));
 
+    dumper.dump("rankedFrameRatesCache"sv);
+    {
+        utils::Dumper::Indent indent(dumper);
+        dumper.dump("entries"sv, mGetRankedFrameRatesCache.size());
+        dumper.dump("hits"sv, mGetRankedFrameRatesCacheHits);
+        dumper.dump("misses"sv, mGetRankedFrameRatesCacheMisses);
+    }
+
     dumper.dump("idleTimer"sv);
     {
         utils::Dumper::Indent indent(dumper);
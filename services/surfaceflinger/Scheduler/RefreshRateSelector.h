@@ -582,7 +582,17 @@ private:
                     isApproxEqual(pacesetterFps, other.pacesetterFps);
         }
     };
-    mutable std::optional<GetRankedFrameRatesCache> mGetRankedFrameRatesCache GUARDED_BY(mLock);
+
+    // Recent invocations of getRankedFrameRates, most recently used first. Layer summaries tend
+    // to alternate between a few states (e.g. with and without touch boost), so a handful of
+    // entries keeps steady-state content from being re-ranked each frame. Invalidated whenever
+    // the display modes or the policy change.
+    static constexpr size_t kGetRankedFrameRatesCacheSize = 4;
+    mutable std::vector<GetRankedFrameRatesCache> mGetRankedFrameRatesCache GUARDED_BY(mLock);
+    void clearGetRankedFrameRatesCacheLocked() REQUIRES(mLock);
+
+    mutable size_t mGetRankedFrameRatesCacheHits GUARDED_BY(mLock) = 0;
+    mutable size_t mGetRankedFrameRatesCacheMisses GUARDED_BY(mLock) = 0;
 
     // Declare mIdleTimer last to ensure its thread joins before the mutex/callbacks are destroyed.
     std::mutex mIdleTimerCallbacksMutex;
@@ -254,7 +254,16 @@ void Scheduler::onFrameSignal(ICompositor& compositor, VsyncId vsyncId,
     for (auto& [id, display] : mDisplays) {
         if (id == pacesetterPtr->displayId) continue;
 
+        // Commits are shared, but a follower with a lower refresh rate than the pacesetter only
+        // needs to be composited once per VSYNC of its own.
+        if (FlagManager::getInstance().follower_display_own_vsync_composite() &&
+            hasCompositedFollowerVsync(display)) {
+            SFTRACE_FORMAT_INSTANT("Skipping composite for follower %s", to_string(id).c_str());
+            continue;
+        }
+
         FrameTargeter& targeter = *display.targeterPtr;
+        display.lastCompositedPresentTime = targeter.target().expectedPresentTime();
         targeters.try_emplace(id, &targeter);
     }
 
@@ -282,6 +291,14 @@ void Scheduler::onFrameSignal(ICompositor& compositor, VsyncId vsyncId,
     }
 }
 
+bool Scheduler::hasCompositedFollowerVsync(const Display& display) {
+    const TimePoint expectedPresentTime = display.targeterPtr->target().expectedPresentTime();
+
+    // Predictions for the same VSYNC may drift slightly as the model is updated between frames.
+    const Period period = display.schedulePtr->period();
+    return expectedPresentTime - display.lastCompositedPresentTime < period / 2;
+}
+
 std::optional<Fps> Scheduler::getFrameRateOverride(uid_t uid) const {
     const bool supportsFrameRateOverrideByContent =
             pacesetterSelectorPtr()->supportsAppFrameRateOverrideByContent();
@@ -508,6 +525,17 @@ void Scheduler::setVsyncConfig(const VsyncConfig& config, Period vsyncPeriod) {
                 /* workDuration */ vsyncPeriod,
                 /* readyDuration */ config.sfWorkDuration);
     setDuration(config.sfWorkDuration);
+
+    // When running on the late offsets, the slot up to the early offsets is typically idle, so
+    // start gathering work for the next commit in it.
+    std::chrono::nanoseconds earlyWakeupDuration(0);
+    if (FlagManager::getInstance().early_commit_preparation()) {
+        const auto earlySfWorkDuration =
+                mVsyncConfiguration->getCurrentConfigs().early.sfWorkDuration;
+        earlyWakeupDuration =
+                std::max(earlySfWorkDuration - config.sfWorkDuration, std::chrono::nanoseconds(0));
+    }
+    setEarlyWakeupDuration(earlyWakeupDuration);
 }
 
 void Scheduler::enableHardwareVsync(PhysicalDisplayId id) {
@@ -327,6 +327,12 @@ public:
                 mSmallAreaDetectionAllowMappings.getThresholdForAppId(appId).has_value();
     }
 
+    // Returns true if layers of apps with small dirty detection may measure their changed area
+    // from their content, rather than trust their surface damage.
+    bool supportSmallDirtyContentDiff() const {
+        return mFeatures.test(Feature::kSmallDirtyContentDiff);
+    }
+
     // Injects a delay that is a fraction of the predicted frame duration for the next frame.
     void injectPacesetterDelay(float frameDurationFraction) REQUIRES(kMainThreadContext) {
         mPacesetterFrameDurationFractionToSkip = frameDurationFraction;
@@ -519,8 +525,14 @@ private:
         FrameTargeterPtr targeterPtr;
 
         hal::PowerMode powerMode = hal::PowerMode::OFF;
+
+        // Expected present time of the last frame composited for this display.
+        TimePoint lastCompositedPresentTime;
     };
 
+    // Whether the follower already composited a frame for the VSYNC its current frame targets.
+    static bool hasCompositedFollowerVsync(const Display&);
+
     using DisplayRef = std::reference_wrapper<Display>;
     using ConstDisplayRef = std::reference_wrapper<const Display>;
 
@@ -16,6 +16,7 @@
 
 #define ATRACE_TAG ATRACE_TAG_GRAPHICS
 
+#include <algorithm>
 #include <vector>
 
 #include <android-base/stringprintf.h>
@@ -379,6 +380,7 @@ void VSyncDispatchTimerQueue::timerCallback() {
             auto const readyTime = callback->readyTime();
             auto const lagAllowance = std::max(now - mIntendedWakeupTime, static_cast<nsecs_t>(0));
             if (*wakeupTime < mIntendedWakeupTime + mTimerSlack + lagAllowance) {
+                mWakeupErrors.record(now - *wakeupTime);
                 callback->executing();
                 invocations.emplace_back(Invocation{callback, *callback->lastExecutedVsyncTarget(),
                                                     *wakeupTime, *readyTime});
@@ -504,12 +506,32 @@ void VSyncDispatchTimerQueue::dump(std::string& result) const {
     StringAppendF(&result, "\tmLastTimerCallback: %.2fms ago mLastTimerSchedule: %.2fms ago\n",
                   (mTimeKeeper->now() - mLastTimerCallback) / 1e6f,
                   (mTimeKeeper->now() - mLastTimerSchedule) / 1e6f);
+    mWakeupErrors.dump(result);
     StringAppendF(&result, "\tCallbacks:\n");
     for (const auto& [token, entry] : mCallbacks) {
         entry->dump(result);
     }
 }
 
+void VSyncDispatchTimerQueue::WakeupErrorHistogram::record(nsecs_t error) {
+    if (error < 0) {
+        mEarly++;
+        return;
+    }
+    const auto errorUs = ns2us(error);
+    const auto it = std::upper_bound(kBucketLimitsUs.begin(), kBucketLimitsUs.end(), errorUs);
+    mBuckets[static_cast<size_t>(std::distance(kBucketLimitsUs.begin(), it))]++;
+}
+
+void VSyncDispatchTimerQueue::WakeupErrorHistogram::dump(std::string& result) const {
+    StringAppendF(&result, "\tWakeup error: early=%" PRIu64, mEarly);
+    for (size_t i = 0; i < kBucketLimitsUs.size(); i++) {
+        StringAppendF(&result, " <%" PRId64 "us=%" PRIu64, kBucketLimitsUs[i], mBuckets[i]);
+    }
+    StringAppendF(&result, " >=%" PRId64 "us=%" PRIu64 "\n", kBucketLimitsUs.back(),
+                  mBuckets.back());
+}
+
 VSyncCallbackRegistration::VSyncCallbackRegistration(std::shared_ptr<VSyncDispatch> dispatch,
                                                      VSyncDispatch::Callback callback,
                                                      std::string callbackName)
@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <array>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -170,6 +171,21 @@ private:
     // For debugging purposes
     nsecs_t mLastTimerCallback GUARDED_BY(mMutex) = kInvalidTime;
     nsecs_t mLastTimerSchedule GUARDED_BY(mMutex) = kInvalidTime;
+
+    // Histogram of how late callbacks are dispatched relative to their wakeup time. Callbacks
+    // grouped into an earlier wakeup by mTimerSlack are counted as early.
+    class WakeupErrorHistogram {
+    public:
+        void record(nsecs_t error);
+        void dump(std::string&) const;
+
+    private:
+        static constexpr std::array<nsecs_t, 6> kBucketLimitsUs = {100,  250,  500,
+                                                                   1000, 2000, 4000};
+        uint64_t mEarly = 0;
+        std::array<uint64_t, kBucketLimitsUs.size() + 1> mBuckets{};
+    };
+    WakeupErrorHistogram mWakeupErrors GUARDED_BY(mMutex);
 };
 
 } // namespace android::scheduler
@@ -52,6 +52,100 @@ int numVsyncsPerFrame(const ftl::NonNull<DisplayModePtr>& displayModePtr) {
     return static_cast<int>(std::round(static_cast<float>(idealPeakRefreshPeriod) /
                                        static_cast<float>(idealRefreshPeriod)));
 }
+
+// The mean of the ordinals must be precise for the intercept calculation, so scale them up for
+// fixed-point arithmetic.
+constexpr int64_t kScalingFactor = 1000;
+
+// This is a 'simple linear regression' calculation of Y over X, with Y being the
+// vsync timestamps, and X being the ordinal of vsync count.
+// The calculated slope is the vsync period.
+// Formula for reference:
+// Sigma_i: means sum over all timestamps.
+// mean(variable): statistical mean of variable.
+// X: snapped ordinal of the timestamp, scaled by kScalingFactor
+// Y: vsync timestamp
+//
+//         Sigma_i( (X_i - mean(X)) * (Y_i - mean(Y) )
+// slope = -------------------------------------------
+//         Sigma_i ( X_i - mean(X) ) ^ 2
+//
+// intercept = mean(Y) - slope * mean(X)
+//
+std::optional<VSyncPredictor::Model> fitLinearRegression(std::vector<nsecs_t> vsyncTS,
+                                                         std::vector<nsecs_t> ordinals) {
+    const size_t numSamples = vsyncTS.size();
+
+    nsecs_t meanTS = 0;
+    nsecs_t meanOrdinal = 0;
+    for (size_t i = 0; i < numSamples; i++) {
+        meanTS += vsyncTS[i];
+        meanOrdinal += ordinals[i];
+    }
+
+    meanTS /= numSamples;
+    meanOrdinal /= numSamples;
+
+    for (size_t i = 0; i < numSamples; i++) {
+        vsyncTS[i] -= meanTS;
+        ordinals[i] -= meanOrdinal;
+    }
+
+    nsecs_t top = 0;
+    nsecs_t bottom = 0;
+    for (size_t i = 0; i < numSamples; i++) {
+        top += vsyncTS[i] * ordinals[i];
+        bottom += ordinals[i] * ordinals[i];
+    }
+
+    if (CC_UNLIKELY(bottom == 0)) {
+        return {};
+    }
+
+    nsecs_t const anticipatedPeriod = top * kScalingFactor / bottom;
+    nsecs_t const intercept = meanTS - (anticipatedPeriod * meanOrdinal / kScalingFactor);
+    return VSyncPredictor::Model{anticipatedPeriod, intercept};
+}
+
+// Discards samples whose residual against `fit` is larger than a few median absolute deviations
+// (and at least `minResidual`), and refits the model on the remaining samples. A single noisy
+// timestamp otherwise pulls the least squares line for the whole history.
+VSyncPredictor::Model refitWithoutOutliers(const std::vector<nsecs_t>& vsyncTS,
+                                           const std::vector<nsecs_t>& ordinals,
+                                           VSyncPredictor::Model fit, size_t minimumSamples,
+                                           nsecs_t minResidual) {
+    const size_t numSamples = vsyncTS.size();
+    std::vector<nsecs_t> residuals(numSamples);
+    for (size_t i = 0; i < numSamples; i++) {
+        residuals[i] =
+                std::abs(vsyncTS[i] - (fit.slope * ordinals[i] / kScalingFactor + fit.intercept));
+    }
+
+    std::vector<nsecs_t> sortedResiduals = residuals;
+    const auto median = sortedResiduals.begin() + numSamples / 2;
+    std::nth_element(sortedResiduals.begin(), median, sortedResiduals.end());
+
+    // A median absolute deviation of 1 corresponds to a standard deviation of ~1.48 for normally
+    // distributed noise, so this rejects samples beyond roughly 3 sigma.
+    constexpr nsecs_t kMaxMedianDeviations = 4;
+    const nsecs_t maxResidual = std::max(minResidual, *median * kMaxMedianDeviations);
+
+    std::vector<nsecs_t> inlierTS;
+    std::vector<nsecs_t> inlierOrdinals;
+    for (size_t i = 0; i < numSamples; i++) {
+        if (residuals[i] <= maxResidual) {
+            inlierTS.push_back(vsyncTS[i]);
+            inlierOrdinals.push_back(ordinals[i]);
+        }
+    }
+
+    if (inlierTS.size() == numSamples || inlierTS.size() < minimumSamples) {
+        return fit;
+    }
+
+    SFTRACE_FORMAT_INSTANT("discarded %zu outlying timestamps", numSamples - inlierTS.size());
+    return fitLinearRegression(std::move(inlierTS), std::move(inlierOrdinals)).value_or(fit);
+}
 } // namespace
 
 VSyncPredictor::~VSyncPredictor() = default;
@@ -185,21 +279,6 @@ bool VSyncPredictor::addVsyncTimestamp(nsecs_t timestamp) {
         return true;
     }
 
-    // This is a 'simple linear regression' calculation of Y over X, with Y being the
-    // vsync timestamps, and X being the ordinal of vsync count.
-    // The calculated slope is the vsync period.
-    // Formula for reference:
-    // Sigma_i: means sum over all timestamps.
-    // mean(variable): statistical mean of variable.
-    // X: snapped ordinal of the timestamp
-    // Y: vsync timestamp
-    //
-    //         Sigma_i( (X_i - mean(X)) * (Y_i - mean(Y) )
-    // slope = -------------------------------------------
-    //         Sigma_i ( X_i - mean(X) ) ^ 2
-    //
-    // intercept = mean(Y) - slope * mean(X)
-    //
     std::vector<nsecs_t> vsyncTS(numSamples);
     std::vector<nsecs_t> ordinals(numSamples);
 
@@ -208,48 +287,27 @@ bool VSyncPredictor::addVsyncTimestamp(nsecs_t timestamp) {
     auto it = mRateMap.find(idealPeriod());
     auto const currentPeriod = it->second.slope;
 
-    // The mean of the ordinals must be precise for the intercept calculation, so scale them up for
-    // fixed-point arithmetic.
-    constexpr int64_t kScalingFactor = 1000;
-
-    nsecs_t meanTS = 0;
-    nsecs_t meanOrdinal = 0;
-
     for (size_t i = 0; i < numSamples; i++) {
-        const auto timestamp = mTimestamps[i] - oldestTS;
-        vsyncTS[i] = timestamp;
-        meanTS += timestamp;
-
-        const auto ordinal = currentPeriod == 0
+        vsyncTS[i] = mTimestamps[i] - oldestTS;
+        ordinals[i] = currentPeriod == 0
                 ? 0
                 : (vsyncTS[i] + currentPeriod / 2) / currentPeriod * kScalingFactor;
-        ordinals[i] = ordinal;
-        meanOrdinal += ordinal;
-    }
-
-    meanTS /= numSamples;
-    meanOrdinal /= numSamples;
-
-    for (size_t i = 0; i < numSamples; i++) {
-        vsyncTS[i] -= meanTS;
-        ordinals[i] -= meanOrdinal;
-    }
-
-    nsecs_t top = 0;
-    nsecs_t bottom = 0;
-    for (size_t i = 0; i < numSamples; i++) {
-        top += vsyncTS[i] * ordinals[i];
-        bottom += ordinals[i] * ordinals[i];
     }
 
-    if (CC_UNLIKELY(bottom == 0)) {
+    auto fit = fitLinearRegression(vsyncTS, ordinals);
+    if (CC_UNLIKELY(!fit)) {
         it->second = {idealPeriod(), 0};
         clearTimestamps(/* clearTimelines */ true);
         return false;
     }
 
-    nsecs_t const anticipatedPeriod = top * kScalingFactor / bottom;
-    nsecs_t const intercept = meanTS - (anticipatedPeriod * meanOrdinal / kScalingFactor);
+    if (FlagManager::getInstance().vsync_predictor_outlier_rejection()) {
+        constexpr nsecs_t kMinOutlierResidualPercent = 1;
+        fit = refitWithoutOutliers(vsyncTS, ordinals, *fit, kMinimumSamplesForPrediction,
+                                   idealPeriod() * kMinOutlierResidualPercent / kMaxPercent);
+    }
+
+    auto const [anticipatedPeriod, intercept] = *fit;
 
     auto const percent = std::abs(anticipatedPeriod - idealPeriod()) * kMaxPercent / idealPeriod();
     if (percent >= kOutlierTolerancePercent) {
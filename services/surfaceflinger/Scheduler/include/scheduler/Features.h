@@ -22,7 +22,7 @@
 
 namespace android::scheduler {
 
-enum class Feature : std::uint8_t {
+enum class Feature : std::uint16_t {
     kPresentFences = 1 << 0,
     kKernelIdleTimer = 1 << 1,
     kContentDetection = 1 << 2,
@@ -31,6 +31,7 @@ enum class Feature : std::uint8_t {
     kSmallDirtyContentDetection = 1 << 5,
     kExpectedPresentTime = 1 << 6,
     kPropagateBackpressure = 1 << 7,
+    kSmallDirtyContentDiff = 1 << 8,
 };
 
 using FeatureFlags = ftl::Flags<Feature>;
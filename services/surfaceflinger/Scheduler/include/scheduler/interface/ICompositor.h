@@ -42,6 +42,10 @@ struct ICompositor {
     // i.e. whether a frame should be composited for each display.
     virtual bool commit(PhysicalDisplayId pacesetterId, const scheduler::FrameTargets&) = 0;
 
+    // Performs work for the upcoming commit that does not depend on the state being committed,
+    // e.g. collecting queued transactions. Called ahead of the frame while the main thread is idle.
+    virtual void prepareCommit() = 0;
+
     // Composites a frame for each display. CompositionEngine performs GPU and/or HAL composition
     // via RenderEngine and the Composer HAL, respectively.
     virtual CompositeResultsPerDisplay composite(PhysicalDisplayId pacesetterId,
@@ -496,6 +496,9 @@ SurfaceFlinger::SurfaceFlinger(Factory& factory) : SurfaceFlinger(factory, SkipI
     mSupportsBlur = supportsBlurs;
     ALOGI_IF(!mSupportsBlur, "Disabling blur effects, they are not supported.");
 
+    mUpdateDirtySnapshotSubtreesOnly =
+            base::GetBoolProperty("debug.sf.update_dirty_snapshot_subtrees_only"s, false);
+
     property_get("debug.sf.luma_sampling", value, "1");
     mLumaSampling = atoi(value);
 
@@ -875,6 +878,17 @@ void SurfaceFlinger::init() FTL_FAKE_GUARD(kMainThreadContext) {
     addTransactionReadyFilters();
     Mutex::Autolock lock(mStateLock);
 
+    // Connecting to the Composer HAL does not depend on RenderEngine, so connect on another thread
+    // while RenderEngine is created and primes its shader cache. With a threaded RenderEngine, both
+    // of those run on the RenderEngine thread, which the main thread only waits for once it needs
+    // RenderEngine's limits to commit the primary display.
+    const nsecs_t initStart = systemTime();
+    auto hwComposerFuture = std::async(std::launch::async, [this] {
+        SFTRACE_NAME("createHWComposer");
+        auto hwComposer = getFactory().createHWComposer(mHwcServiceName);
+        return std::make_pair(std::move(hwComposer), systemTime());
+    });
+
     // Get a RenderEngine for the given display / config (can't fail)
     // TODO(b/77156734): We need to stop casting and use HAL types when possible.
     // Sending maxFrameBufferAcquiredBuffers as the cache size is tightly tuned to single-display.
@@ -891,17 +905,62 @@ void SurfaceFlinger::init() FTL_FAKE_GUARD(kMainThreadContext) {
     chooseRenderEngineType(builder);
     mRenderEngine = renderengine::RenderEngine::create(builder.build());
     mCompositionEngine->setRenderEngine(mRenderEngine.get());
-    mMaxRenderTargetSize =
-            std::min(getRenderEngine().getMaxTextureSize(), getRenderEngine().getMaxViewportDims());
+    const nsecs_t renderEngineCreated = systemTime();
 
     // Set SF main policy after initializing RenderEngine which has its own policy.
     if (!SetTaskProfiles(0, {"SFMainPolicy"})) {
         ALOGW("Failed to set main task profile");
     }
 
+    if (base::GetBoolProperty("service.sf.prime_shader_cache"s, true)) {
+        if (setSchedFifo(false) != NO_ERROR) {
+            ALOGW("Can't set SCHED_OTHER for primeCache");
+        }
+
+        mRenderEnginePrimeCacheFuture.callOnce([this] {
+            renderengine::PrimeCacheConfig config;
+            config.cacheHolePunchLayer =
+                    base::GetBoolProperty("debug.sf.prime_shader_cache.hole_punch"s, true);
+            config.cacheSolidLayers =
+                    base::GetBoolProperty("debug.sf.prime_shader_cache.solid_layers"s, true);
+            config.cacheSolidDimmedLayers =
+                    base::GetBoolProperty("debug.sf.prime_shader_cache.solid_dimmed_layers"s, true);
+            config.cacheImageLayers =
+                    base::GetBoolProperty("debug.sf.prime_shader_cache.image_layers"s, true);
+            config.cacheImageDimmedLayers =
+                    base::GetBoolProperty("debug.sf.prime_shader_cache.image_dimmed_layers"s, true);
+            config.cacheClippedLayers =
+                    base::GetBoolProperty("debug.sf.prime_shader_cache.clipped_layers"s, true);
+            config.cacheShadowLayers =
+                    base::GetBoolProperty("debug.sf.prime_shader_cache.shadow_layers"s, true);
+            config.cachePIPImageLayers =
+                    base::GetBoolProperty("debug.sf.prime_shader_cache.pip_image_layers"s, true);
+            config.cacheTransparentImageDimmedLayers = base::
+                    GetBoolProperty("debug.sf.prime_shader_cache.transparent_image_dimmed_layers"s,
+                                    true);
+            config.cacheClippedDimmedImageLayers = base::
+                    GetBoolProperty("debug.sf.prime_shader_cache.clipped_dimmed_image_layers"s,
+                                    true);
+            // ro.surface_flinger.prime_chader_cache.ultrahdr exists as a previous ro property
+            // which we maintain for backwards compatibility.
+            config.cacheUltraHDR =
+                    base::GetBoolProperty("ro.surface_flinger.prime_shader_cache.ultrahdr"s, false);
+            config.cacheEdgeExtension =
+                    base::GetBoolProperty("debug.sf.edge_extension_shader"s, true);
+            return getRenderEngine().primeCache(config);
+        });
+
+        if (setSchedFifo(true) != NO_ERROR) {
+            ALOGW("Can't set SCHED_FIFO after primeCache");
+        }
+    }
+
+    const nsecs_t primeCacheStarted = systemTime();
+
     mCompositionEngine->setTimeStats(mTimeStats);
 
-    mCompositionEngine->setHwComposer(getFactory().createHWComposer(mHwcServiceName));
+    auto [hwComposer, hwComposerConnected] = hwComposerFuture.get();
+    mCompositionEngine->setHwComposer(std::move(hwComposer));
     auto& composer = mCompositionEngine->getHwComposer();
     composer.setCallback(*this);
     mDisplayModeController.setHwComposer(&composer);
@@ -920,6 +979,12 @@ void SurfaceFlinger::init() FTL_FAKE_GUARD(kMainThreadContext) {
     // Process hotplug for displays connected at boot.
     LOG_ALWAYS_FATAL_IF(!configureLocked(),
                         "Initial display configuration failed: HWC did not hotplug");
+    const nsecs_t displaysConfigured = systemTime();
+
+    // Committing the primary display depends on RenderEngine being initialized.
+    mMaxRenderTargetSize =
+            std::min(getRenderEngine().getMaxTextureSize(), getRenderEngine().getMaxViewportDims());
+    const nsecs_t renderEngineInitialized = systemTime();
 
     mActiveDisplayId = getPrimaryDisplayIdLocked();
 
@@ -984,56 +1049,23 @@ void SurfaceFlinger::init() FTL_FAKE_GUARD(kMainThreadContext) {
 
     mPowerAdvisor->init();
 
-    if (base::GetBoolProperty("service.sf.prime_shader_cache"s, true)) {
-        if (setSchedFifo(false) != NO_ERROR) {
-            ALOGW("Can't set SCHED_OTHER for primeCache");
-        }
-
-        mRenderEnginePrimeCacheFuture.callOnce([this] {
-            renderengine::PrimeCacheConfig config;
-            config.cacheHolePunchLayer =
-                    base::GetBoolProperty("debug.sf.prime_shader_cache.hole_punch"s, true);
-            config.cacheSolidLayers =
-                    base::GetBoolProperty("debug.sf.prime_shader_cache.solid_layers"s, true);
-            config.cacheSolidDimmedLayers =
-                    base::GetBoolProperty("debug.sf.prime_shader_cache.solid_dimmed_layers"s, true);
-            config.cacheImageLayers =
-                    base::GetBoolProperty("debug.sf.prime_shader_cache.image_layers"s, true);
-            config.cacheImageDimmedLayers =
-                    base::GetBoolProperty("debug.sf.prime_shader_cache.image_dimmed_layers"s, true);
-            config.cacheClippedLayers =
-                    base::GetBoolProperty("debug.sf.prime_shader_cache.clipped_layers"s, true);
-            config.cacheShadowLayers =
-                    base::GetBoolProperty("debug.sf.prime_shader_cache.shadow_layers"s, true);
-            config.cachePIPImageLayers =
-                    base::GetBoolProperty("debug.sf.prime_shader_cache.pip_image_layers"s, true);
-            config.cacheTransparentImageDimmedLayers = base::
-                    GetBoolProperty("debug.sf.prime_shader_cache.transparent_image_dimmed_layers"s,
-                                    true);
-            config.cacheClippedDimmedImageLayers = base::
-                    GetBoolProperty("debug.sf.prime_shader_cache.clipped_dimmed_image_layers"s,
-                                    true);
-            // ro.surface_flinger.prime_chader_cache.ultrahdr exists as a previous ro property
-            // which we maintain for backwards compatibility.
-            config.cacheUltraHDR =
-                    base::GetBoolProperty("ro.surface_flinger.prime_shader_cache.ultrahdr"s, false);
-            config.cacheEdgeExtension =
-                    base::GetBoolProperty("debug.sf.edge_extension_shader"s, true);
-            return getRenderEngine().primeCache(config);
-        });
-
-        if (setSchedFifo(true) != NO_ERROR) {
-            ALOGW("Can't set SCHED_FIFO after primeCache");
-        }
-    }
-
     // Avoid blocking the main thread on `init` to set properties.
     mInitBootPropsFuture.callOnce([this] {
         return std::async(std::launch::async, &SurfaceFlinger::initBootProperties, this);
     });
 
     initTransactionTraceWriter();
-    ALOGV("Done initializing");
+
+    const nsecs_t initEnd = systemTime();
+    ALOGI("Initialized in %" PRId64 " ms: RenderEngine created in %" PRId64 " ms, shader cache "
+          "priming started in %" PRId64 " ms, HWC connected in %" PRId64 " ms concurrently, "
+          "displays configured in %" PRId64 " ms, waited %" PRId64 " ms for RenderEngine, "
+          "displays committed in %" PRId64 " ms",
+          ns2ms(initEnd - initStart), ns2ms(renderEngineCreated - initStart),
+          ns2ms(primeCacheStarted - renderEngineCreated), ns2ms(hwComposerConnected - initStart),
+          ns2ms(displaysConfigured - primeCacheStarted),
+          ns2ms(renderEngineInitialized - displaysConfigured),
+          ns2ms(initEnd - renderEngineInitialized));
 }
 
 // During boot, offload `initBootProperties` to another thread. `property_set` depends on
@@ -2438,7 +2470,8 @@ bool SurfaceFlinger::updateLayerSnapshots(VsyncId vsyncId, nsecs_t frameTimeNs,
                              getHwComposer().getSupportedLayerGenericMetadata(),
                      .genericLayerMetadataKeyMap = getGenericLayerMetadataKeyMap(),
                      .skipRoundCornersWhenProtected =
-                             !getRenderEngine().supportsProtectedContent()};
+                             !getRenderEngine().supportsProtectedContent(),
+                     .updateDirtySubtreesOnly = mUpdateDirtySnapshotSubtreesOnly};
         mLayerSnapshotBuilder.update(args);
     }
 
@@ -2450,6 +2483,21 @@ bool SurfaceFlinger::updateLayerSnapshots(VsyncId vsyncId, nsecs_t frameTimeNs,
                                                       Changes::Visibility | Changes::Geometry)) {
         mVisibleRegionsDirty = true;
     }
+    if (!mHdrLayerInfoListeners.empty() && !mHdrLayerInfoChanged) {
+        // Changes to visible regions are picked up after composition, so only look for the
+        // changes which make a layer HDR or change its desired ratio.
+        static constexpr uint64_t kHdrLayerInfoChanges = layer_state_t::eDataspaceChanged |
+                layer_state_t::eHdrMetadataChanged | layer_state_t::eDimmingEnabledChanged |
+                layer_state_t::eExtendedRangeBrightnessChanged |
+                layer_state_t::eDesiredHdrHeadroomChanged;
+        for (const auto* layer : mLayerLifecycleManager.getChangedLayers()) {
+            if ((layer->what & kHdrLayerInfoChanges) ||
+                layer->changes.test(Changes::BufferUsageFlags)) {
+                mHdrLayerInfoChanged = true;
+                break;
+            }
+        }
+    }
     if (mLayerLifecycleManager.getGlobalChanges().any(Changes::Hierarchy | Changes::FrameRate)) {
         // The frame rate of attached choreographers can only change as a result of a
         // FrameRate change (including when Hierarchy changes).
@@ -2706,6 +2754,13 @@ bool SurfaceFlinger::commit(PhysicalDisplayId pacesetterId,
     return mustComposite && CC_LIKELY(mBootStage != BootStage::BOOTLOADER);
 }
 
+void SurfaceFlinger::prepareCommit() {
+    // Moving queued transactions into their per token queues does not depend on the frame being
+    // committed. Readiness is still evaluated by the flush on commit.
+    SFTRACE_CALL();
+    mTransactionHandler.collectTransactions();
+}
+
 CompositeResultsPerDisplay SurfaceFlinger::composite(
         PhysicalDisplayId pacesetterId, const scheduler::FrameTargeters& frameTargeters) {
     const scheduler::FrameTarget& pacesetterTarget =
@@ -2716,6 +2771,7 @@ CompositeResultsPerDisplay SurfaceFlinger::composite(
 
     compositionengine::CompositionRefreshArgs refreshArgs;
     refreshArgs.powerCallback = this;
+    refreshArgs.pacesetterDisplayId = pacesetterId;
     const auto& displays = FTL_FAKE_GUARD(mStateLock, mDisplays);
     refreshArgs.outputs.reserve(displays.size());
 
@@ -3167,54 +3223,52 @@ void SurfaceFlinger::onCompositionPresented(PhysicalDisplayId pacesetterId,
         mAddingHDRLayerInfoListener = false;
     }
 
-    if (haveNewListeners || mHdrLayerInfoChanged) {
-        for (auto& [compositionDisplay, listener] : hdrInfoListeners) {
-            HdrLayerInfoReporter::HdrLayerInfo info;
-            int32_t maxArea = 0;
-
-            auto updateInfoFn =
-                    [&](const std::shared_ptr<compositionengine::Display>& compositionDisplay,
-                        const frontend::LayerSnapshot& snapshot, const sp<LayerFE>& layerFe) {
-                        if (snapshot.isVisible &&
-                            compositionDisplay->includesLayer(snapshot.outputFilter)) {
-                            if (isHdrLayer(snapshot)) {
+    if (!hdrInfoListeners.empty() && (haveNewListeners || mHdrLayerInfoChanged)) {
+        // Compute the info of all displays in a single pass over the visible snapshots.
+        std::vector<HdrLayerInfoReporter::HdrLayerInfo> infos(hdrInfoListeners.size());
+        std::vector<int32_t> maxAreas(hdrInfoListeners.size(), 0);
+        mLayerSnapshotBuilder.forEachVisibleSnapshot(
+                [&](std::unique_ptr<frontend::LayerSnapshot>& snapshot)
+                        FTL_FAKE_GUARD(kMainThreadContext) {
+                            // Most layers are SDR, so rule them out before looking up their
+                            // LayerFE.
+                            if (!snapshot->isVisible || !isHdrLayer(*snapshot)) return;
+                            sp<LayerFE> layerFe;
+                            for (size_t i = 0; i < hdrInfoListeners.size(); i++) {
+                                const auto& compositionDisplay = hdrInfoListeners[i].first;
+                                if (!compositionDisplay->includesLayer(snapshot->outputFilter)) {
+                                    continue;
+                                }
+                                if (!layerFe) {
+                                    auto it = mLegacyLayers.find(snapshot->sequence);
+                                    LLOG_ALWAYS_FATAL_WITH_TRACE_IF(
+                                            it == mLegacyLayers.end(),
+                                            "Couldnt find layer object for %s",
+                                            snapshot->getDebugString().c_str());
+                                    layerFe = it->second->getCompositionEngineLayerFE(
+                                            snapshot->path);
+                                }
                                 const auto* outputLayer =
                                         compositionDisplay->getOutputLayerForLayer(layerFe);
-                                if (outputLayer) {
-                                    const float desiredHdrSdrRatio =
-                                            snapshot.desiredHdrSdrRatio < 1.f
-                                            ? std::numeric_limits<float>::infinity()
-                                            : snapshot.desiredHdrSdrRatio;
-                                    info.mergeDesiredRatio(desiredHdrSdrRatio);
-                                    info.numberOfHdrLayers++;
-                                    const auto displayFrame = outputLayer->getState().displayFrame;
-                                    const int32_t area =
-                                            displayFrame.width() * displayFrame.height();
-                                    if (area > maxArea) {
-                                        maxArea = area;
-                                        info.maxW = displayFrame.width();
-                                        info.maxH = displayFrame.height();
-                                    }
+                                if (!outputLayer) continue;
+
+                                HdrLayerInfoReporter::HdrLayerInfo& info = infos[i];
+                                const float desiredHdrSdrRatio = snapshot->desiredHdrSdrRatio < 1.f
+                                        ? std::numeric_limits<float>::infinity()
+                                        : snapshot->desiredHdrSdrRatio;
+                                info.mergeDesiredRatio(desiredHdrSdrRatio);
+                                info.numberOfHdrLayers++;
+                                const auto displayFrame = outputLayer->getState().displayFrame;
+                                const int32_t area = displayFrame.width() * displayFrame.height();
+                                if (area > maxAreas[i]) {
+                                    maxAreas[i] = area;
+                                    info.maxW = displayFrame.width();
+                                    info.maxH = displayFrame.height();
                                 }
                             }
-                        }
-                    };
-
-            mLayerSnapshotBuilder.forEachVisibleSnapshot(
-                    [&, compositionDisplay = compositionDisplay](
-                            std::unique_ptr<frontend::LayerSnapshot>& snapshot)
-                            FTL_FAKE_GUARD(kMainThreadContext) {
-                                auto it = mLegacyLayers.find(snapshot->sequence);
-                                LLOG_ALWAYS_FATAL_WITH_TRACE_IF(it == mLegacyLayers.end(),
-                                                                "Couldnt find layer object for %s",
-                                                                snapshot->getDebugString().c_str());
-                                auto& legacyLayer = it->second;
-                                sp<LayerFE> layerFe =
-                                        legacyLayer->getCompositionEngineLayerFE(snapshot->path);
-
-                                updateInfoFn(compositionDisplay, *snapshot, layerFe);
-                            });
-            listener->dispatchHdrLayerInfo(info);
+                        });
+        for (size_t i = 0; i < hdrInfoListeners.size(); i++) {
+            hdrInfoListeners[i].second->dispatchHdrLayerInfo(infos[i]);
         }
     }
 
@@ -4314,6 +4368,9 @@ void SurfaceFlinger::initScheduler(const sp<const DisplayDevice>& display) {
         features |= Feature::kContentDetection;
         if (FlagManager::getInstance().enable_small_area_detection()) {
             features |= Feature::kSmallDirtyContentDetection;
+            if (base::GetBoolProperty("debug.sf.small_area_content_diff"s, false)) {
+                features |= Feature::kSmallDirtyContentDiff;
+            }
         }
     }
     if (base::GetBoolProperty("debug.sf.show_predicted_vsync"s, false)) {
@@ -4521,14 +4578,24 @@ TransactionHandler::TransactionReadiness SurfaceFlinger::transactionReadyBufferC
                                             layer->ownerUid.val());
                             SFTRACE_FORMAT_INSTANT("callReleaseBufferCallback %s - %" PRIu64,
                                                    layer->name.c_str(), s.bufferData->frameNumber);
-                            s.bufferData->releaseBufferListener
-                                    ->onReleaseBuffer({resolvedState.externalTexture->getBuffer()
-                                                               ->getId(),
-                                                       s.bufferData->frameNumber},
-                                                      s.bufferData->acquireFence
-                                                              ? s.bufferData->acquireFence
-                                                              : Fence::NO_FENCE,
-                                                      currentMaxAcquiredBufferCount);
+                            const ReleaseCallbackId callbackId{resolvedState.externalTexture
+                                                                       ->getBuffer()
+                                                                       ->getId(),
+                                                               s.bufferData->frameNumber};
+                            const sp<Fence>& releaseFence = s.bufferData->acquireFence
+                                    ? s.bufferData->acquireFence
+                                    : Fence::NO_FENCE;
+                            if (FlagManager::getInstance()
+                                        .transaction_callback_batched_releases()) {
+                                mTransactionCallbackInvoker
+                                        .addReleasedBuffer(s.bufferData->releaseBufferListener,
+                                                           callbackId, releaseFence,
+                                                           currentMaxAcquiredBufferCount);
+                            } else {
+                                s.bufferData->releaseBufferListener
+                                        ->onReleaseBuffer(callbackId, releaseFence,
+                                                          currentMaxAcquiredBufferCount);
+                            }
                         }
 
                         // Delete the entire state at this point and not just release the buffer
@@ -5562,6 +5629,8 @@ status_t SurfaceFlinger::doDump(int fd, const DumpArgs& args, bool asProto) {
                   windowInfosDebug.maxSendDelayDuration);
     StringAppendF(&compositionLayers, "  unsent messages: %zu\n",
                   windowInfosDebug.pendingMessageCount);
+    StringAppendF(&compositionLayers, "  skipped unchanged updates: %zu\n",
+                  windowInfosDebug.skippedUnchangedUpdateCount);
     compositionLayers.append("\n");
     dumpAll(args, compositionLayers, result);
     write(fd, result.c_str(), result.size());
@@ -6005,6 +6074,9 @@ void SurfaceFlinger::dumpAll(const DumpArgs& args, const std::string& compositio
     ClientCache::getInstance().dump(result);
     DebugEGLImageTracker::getInstance()->dump(result);
 
+    result.append("BackgroundExecutor state:\n");
+    BackgroundExecutor::dumpAll(result);
+
     if (const auto display = getDefaultDisplayDeviceLocked()) {
         display->getCompositionDisplay()->getState().undefinedRegion.dump(result,
                                                                           "undefinedRegion");
@@ -6932,6 +7004,10 @@ static void invokeScreenCaptureError(const status_t status,
     captureListener->onScreenCaptureCompleted(captureResults);
 }
 
+static sp<GraphicBuffer> getScreenshotOutputBuffer(const CaptureArgs& captureArgs) {
+    return captureArgs.outputBuffer ? captureArgs.outputBuffer->buffer : nullptr;
+}
+
 void SurfaceFlinger::captureDisplay(const DisplayCaptureArgs& args,
                                     const sp<IScreenCaptureListener>& captureListener) {
     SFTRACE_CALL();
@@ -7004,7 +7080,8 @@ void SurfaceFlinger::captureDisplay(const DisplayCaptureArgs& args,
                         getLayerSnapshotsFn, reqSize,
                         static_cast<ui::PixelFormat>(captureArgs.pixelFormat),
                         captureArgs.allowProtected, captureArgs.grayscale,
-                        captureArgs.attachGainmap, captureListener);
+                        captureArgs.attachGainmap, getScreenshotOutputBuffer(captureArgs),
+                        captureListener);
 }
 
 void SurfaceFlinger::captureDisplay(DisplayId displayId, const CaptureArgs& args,
@@ -7061,7 +7138,8 @@ void SurfaceFlinger::captureDisplay(DisplayId displayId, const CaptureArgs& args
                                                  static_cast<ui::Dataspace>(args.dataspace),
                                                  displayWeak, options),
                         getLayerSnapshotsFn, size, static_cast<ui::PixelFormat>(args.pixelFormat),
-                        kAllowProtected, kGrayscale, args.attachGainmap, captureListener);
+                        kAllowProtected, kGrayscale, args.attachGainmap,
+                        getScreenshotOutputBuffer(args), captureListener);
 }
 
 ScreenCaptureResults SurfaceFlinger::captureLayersSync(const LayerCaptureArgs& args) {
@@ -7074,13 +7152,126 @@ void SurfaceFlinger::captureLayers(const LayerCaptureArgs& args,
                                    const sp<IScreenCaptureListener>& captureListener) {
     SFTRACE_CALL();
 
+    auto request = buildLayerCaptureRequest(args, captureListener);
+    if (!request) return;
+
+    captureScreenCommon(std::move(request->renderAreaBuilder),
+                        std::move(request->getLayerSnapshotsFn), request->bufferSize,
+                        request->pixelFormat, request->allowProtected, request->grayscale,
+                        request->attachGainmap, request->outputBuffer, request->captureListener);
+}
+
+void SurfaceFlinger::captureLayersBatch(
+        const std::vector<LayerCaptureArgs>& args,
+        const std::vector<sp<IScreenCaptureListener>>& captureListeners) {
+    SFTRACE_CALL();
+
+    if (args.size() != captureListeners.size()) {
+        ALOGD("captureLayersBatch called with %zu requests but %zu listeners", args.size(),
+              captureListeners.size());
+        for (const auto& captureListener : captureListeners) {
+            invokeScreenCaptureError(BAD_VALUE, captureListener);
+        }
+        return;
+    }
+
+    if (!FlagManager::getInstance().single_hop_screenshot() ||
+        !FlagManager::getInstance().ce_fence_promise() || !mRenderEngine->isThreaded()) {
+        for (size_t i = 0; i < args.size(); i++) {
+            captureLayers(args[i], captureListeners[i]);
+        }
+        return;
+    }
+
+    std::vector<LayerCaptureRequest> requests;
+    requests.reserve(args.size());
+    for (size_t i = 0; i < args.size(); i++) {
+        if (auto request = buildLayerCaptureRequest(args[i], captureListeners[i])) {
+            if (exceedsMaxRenderTargetSize(request->bufferSize.getWidth(),
+                                           request->bufferSize.getHeight())) {
+                ALOGE("Attempted to capture layers with size (%" PRId32 ", %" PRId32
+                      ") that exceeds render target size limit.",
+                      request->bufferSize.getWidth(), request->bufferSize.getHeight());
+                invokeScreenCaptureError(BAD_VALUE, request->captureListener);
+                continue;
+            }
+            requests.push_back(std::move(*request));
+        }
+    }
+    if (requests.empty()) return;
+
+    // Collect the snapshots of every request in a single hop to the main thread.
+    std::vector<std::vector<sp<LayerFE>>> layerFEs(requests.size());
+    auto displayStatesFuture =
+            mScheduler->schedule([&]() REQUIRES(kMainThreadContext) {
+                SFTRACE_NAME("getSnapshotsFromMainThread");
+                std::vector<std::optional<OutputCompositionState>> displayStates;
+                displayStates.reserve(requests.size());
+                for (size_t i = 0; i < requests.size(); i++) {
+                    displayStates.push_back(
+                            getSnapshotsOnMainThread(requests[i].renderAreaBuilder,
+                                                     requests[i].getLayerSnapshotsFn,
+                                                     layerFEs[i]));
+                }
+                return displayStates;
+            });
+
+    const bool supportsProtected = getRenderEngine().supportsProtectedContent();
+    const auto mayCaptureProtected = [supportsProtected](const LayerCaptureRequest& request) {
+        return request.allowProtected && supportsProtected && !request.outputBuffer;
+    };
+
+    // As in captureScreenCommon, allocate the buffers that cannot depend on the layers while the
+    // main thread is busy.
+    std::vector<std::optional<
+            base::expected<std::shared_ptr<renderengine::ExternalTexture>, status_t>>>
+            textures(requests.size());
+    for (size_t i = 0; i < requests.size(); i++) {
+        if (!mayCaptureProtected(requests[i])) {
+            textures[i] = getScreenshotTexture(requests[i].outputBuffer, requests[i].bufferSize,
+                                               requests[i].pixelFormat, false /* isProtected */);
+        }
+    }
+
+    auto displayStates = displayStatesFuture.get();
+
+    std::vector<ftl::SharedFuture<FenceResult>> renderFutures;
+    renderFutures.reserve(requests.size());
+    for (size_t i = 0; i < requests.size(); i++) {
+        auto& request = requests[i];
+        const bool isProtected =
+                mayCaptureProtected(request) && layersHasProtectedLayer(layerFEs[i]);
+        if (!textures[i]) {
+            textures[i] =
+                    allocateScreenshotTexture(request.bufferSize, request.pixelFormat, isProtected);
+        }
+        if (!textures[i]->has_value()) {
+            invokeScreenCaptureError(textures[i]->error(), request.captureListener);
+            continue;
+        }
+
+        renderFutures.push_back(captureScreenshot(request.renderAreaBuilder, textures[i]->value(),
+                                                  false /* regionSampling */, request.grayscale,
+                                                  isProtected, request.attachGainmap,
+                                                  request.captureListener, displayStates[i],
+                                                  layerFEs[i]));
+    }
+
+    // All of the captures are queued to RenderEngine before waiting on any of them.
+    for (auto& renderFuture : renderFutures) {
+        renderFuture.get();
+    }
+}
+
+std::optional<SurfaceFlinger::LayerCaptureRequest> SurfaceFlinger::buildLayerCaptureRequest(
+        const LayerCaptureArgs& args, const sp<IScreenCaptureListener>& captureListener) {
     const auto& captureArgs = args.captureArgs;
 
     status_t validate = validateScreenshotPermissions(captureArgs);
     if (validate != OK) {
         ALOGD("Permission denied to captureLayers");
         invokeScreenCaptureError(validate, captureListener);
-        return;
+        return std::nullopt;
     }
 
     auto crop = gui::aidl_utils::fromARect(captureArgs.sourceCrop);
@@ -7093,7 +7284,7 @@ void SurfaceFlinger::captureLayers(const LayerCaptureArgs& args,
     if (captureArgs.captureSecureLayers && !hasCaptureBlackoutContentPermission()) {
         ALOGD("Attempting to capture secure layers without CAPTURE_BLACKOUT_CONTENT");
         invokeScreenCaptureError(PERMISSION_DENIED, captureListener);
-        return;
+        return std::nullopt;
     }
 
     {
@@ -7103,7 +7294,7 @@ void SurfaceFlinger::captureLayers(const LayerCaptureArgs& args,
         if (parent == nullptr) {
             ALOGD("captureLayers called with an invalid or removed parent");
             invokeScreenCaptureError(NAME_NOT_FOUND, captureListener);
-            return;
+            return std::nullopt;
         }
 
         Rect parentSourceBounds = parent->getCroppedBufferSize(parent->getDrawingState());
@@ -7122,7 +7313,7 @@ void SurfaceFlinger::captureLayers(const LayerCaptureArgs& args,
             // crop was not specified, or an invalid frame scale was provided.
             ALOGD("Boundless layer, unspecified crop, or invalid frame scale to captureLayers");
             invokeScreenCaptureError(BAD_VALUE, captureListener);
-            return;
+            return std::nullopt;
         }
         reqSize = ui::Size(crop.width() * captureArgs.frameScaleX,
                            crop.height() * captureArgs.frameScaleY);
@@ -7134,7 +7325,7 @@ void SurfaceFlinger::captureLayers(const LayerCaptureArgs& args,
             } else {
                 ALOGD("Invalid layer handle passed as excludeLayer to captureLayers");
                 invokeScreenCaptureError(NAME_NOT_FOUND, captureListener);
-                return;
+                return std::nullopt;
             }
         }
     } // mStateLock
@@ -7143,7 +7334,7 @@ void SurfaceFlinger::captureLayers(const LayerCaptureArgs& args,
     if (reqSize.width <= 0 || reqSize.height <= 0) {
         ALOGD("Failed to captureLayers: crop or scale too small");
         invokeScreenCaptureError(BAD_VALUE, captureListener);
-        return;
+        return std::nullopt;
     }
 
     std::optional<FloatRect> parentCrop = std::nullopt;
@@ -7160,20 +7351,27 @@ void SurfaceFlinger::captureLayers(const LayerCaptureArgs& args,
     if (captureListener == nullptr) {
         ALOGD("capture screen must provide a capture listener callback");
         invokeScreenCaptureError(BAD_VALUE, captureListener);
-        return;
+        return std::nullopt;
     }
 
     ftl::Flags<RenderArea::Options> options;
     if (captureArgs.captureSecureLayers) options |= RenderArea::Options::CAPTURE_SECURE_LAYERS;
     if (captureArgs.hintForSeamlessTransition)
         options |= RenderArea::Options::HINT_FOR_SEAMLESS_TRANSITION;
-    captureScreenCommon(RenderAreaBuilderVariant(std::in_place_type<LayerRenderAreaBuilder>, crop,
-                                                 reqSize, dataspace, parent, args.childrenOnly,
-                                                 options),
-                        getLayerSnapshotsFn, reqSize,
-                        static_cast<ui::PixelFormat>(captureArgs.pixelFormat),
-                        captureArgs.allowProtected, captureArgs.grayscale,
-                        captureArgs.attachGainmap, captureListener);
+    return LayerCaptureRequest{
+            .renderAreaBuilder =
+                    RenderAreaBuilderVariant(std::in_place_type<LayerRenderAreaBuilder>, crop,
+                                             reqSize, dataspace, parent, args.childrenOnly,
+                                             options),
+            .getLayerSnapshotsFn = std::move(getLayerSnapshotsFn),
+            .bufferSize = reqSize,
+            .pixelFormat = static_cast<ui::PixelFormat>(captureArgs.pixelFormat),
+            .allowProtected = captureArgs.allowProtected,
+            .grayscale = captureArgs.grayscale,
+            .attachGainmap = captureArgs.attachGainmap,
+            .outputBuffer = getScreenshotOutputBuffer(captureArgs),
+            .captureListener = captureListener,
+    };
 }
 
 // Creates a Future release fence for a layer and keeps track of it in a list to
@@ -7208,23 +7406,94 @@ bool SurfaceFlinger::layersHasProtectedLayer(const std::vector<sp<LayerFE>>& lay
 std::optional<SurfaceFlinger::OutputCompositionState> SurfaceFlinger::getSnapshotsFromMainThread(
         RenderAreaBuilderVariant& renderAreaBuilder, GetLayerSnapshotsFunction getLayerSnapshotsFn,
         std::vector<sp<LayerFE>>& layerFEs) {
-    return mScheduler
-            ->schedule([=, this, &renderAreaBuilder, &layerFEs]() REQUIRES(kMainThreadContext) {
-                SFTRACE_NAME("getSnapshotsFromMainThread");
-                auto layers = getLayerSnapshotsFn();
-                for (auto& [layer, layerFE] : layers) {
-                    attachReleaseFenceFutureToLayer(layer, layerFE.get(), ui::INVALID_LAYER_STACK);
-                }
-                layerFEs = extractLayerFEs(layers);
-                return getDisplayStateFromRenderAreaBuilder(renderAreaBuilder);
-            })
+    return scheduleSnapshotsFromMainThread(renderAreaBuilder, std::move(getLayerSnapshotsFn),
+                                           layerFEs)
             .get();
 }
 
+std::future<std::optional<SurfaceFlinger::OutputCompositionState>>
+SurfaceFlinger::scheduleSnapshotsFromMainThread(RenderAreaBuilderVariant& renderAreaBuilder,
+                                                GetLayerSnapshotsFunction getLayerSnapshotsFn,
+                                                std::vector<sp<LayerFE>>& layerFEs) {
+    return mScheduler->schedule([=, this, &renderAreaBuilder,
+                                 &layerFEs]() REQUIRES(kMainThreadContext) {
+        SFTRACE_NAME("getSnapshotsFromMainThread");
+        return getSnapshotsOnMainThread(renderAreaBuilder, getLayerSnapshotsFn, layerFEs);
+    });
+}
+
+std::optional<SurfaceFlinger::OutputCompositionState> SurfaceFlinger::getSnapshotsOnMainThread(
+        RenderAreaBuilderVariant& renderAreaBuilder,
+        const GetLayerSnapshotsFunction& getLayerSnapshotsFn, std::vector<sp<LayerFE>>& layerFEs) {
+    auto layers = getLayerSnapshotsFn();
+    for (auto& [layer, layerFE] : layers) {
+        attachReleaseFenceFutureToLayer(layer, layerFE.get(), ui::INVALID_LAYER_STACK);
+    }
+    layerFEs = extractLayerFEs(layers);
+    return getDisplayStateFromRenderAreaBuilder(renderAreaBuilder);
+}
+
+base::expected<std::shared_ptr<renderengine::ExternalTexture>, status_t>
+SurfaceFlinger::allocateScreenshotTexture(ui::Size bufferSize, ui::PixelFormat reqPixelFormat,
+                                          bool isProtected) {
+    SFTRACE_CALL();
+    const uint32_t usage = GRALLOC_USAGE_HW_COMPOSER | GRALLOC_USAGE_HW_RENDER |
+            GRALLOC_USAGE_HW_TEXTURE |
+            (isProtected ? GRALLOC_USAGE_PROTECTED
+                         : GRALLOC_USAGE_SW_READ_OFTEN | GRALLOC_USAGE_SW_WRITE_OFTEN);
+    sp<GraphicBuffer> buffer =
+            getFactory().createGraphicBuffer(bufferSize.getWidth(), bufferSize.getHeight(),
+                                             static_cast<android_pixel_format>(reqPixelFormat),
+                                             1 /* layerCount */, usage, "screenshot");
+
+    const status_t bufferStatus = buffer->initCheck();
+    if (bufferStatus != OK) {
+        // Animations may end up being really janky, but don't crash here.
+        // Otherwise an irreponsible process may cause an SF crash by allocating
+        // too much.
+        ALOGE("%s: Buffer failed to allocate: %d", __func__, bufferStatus);
+        return base::unexpected(bufferStatus);
+    }
+    return std::make_shared<
+            renderengine::impl::ExternalTexture>(buffer, getRenderEngine(),
+                                                 renderengine::impl::ExternalTexture::Usage::
+                                                         WRITEABLE);
+}
+
+base::expected<std::shared_ptr<renderengine::ExternalTexture>, status_t>
+SurfaceFlinger::getScreenshotTexture(const sp<GraphicBuffer>& outputBuffer, ui::Size bufferSize,
+                                     ui::PixelFormat reqPixelFormat, bool isProtected) {
+    if (!outputBuffer) {
+        return allocateScreenshotTexture(bufferSize, reqPixelFormat, isProtected);
+    }
+
+    if (outputBuffer->initCheck() != OK ||
+        static_cast<int32_t>(outputBuffer->getWidth()) != bufferSize.getWidth() ||
+        static_cast<int32_t>(outputBuffer->getHeight()) != bufferSize.getHeight() ||
+        outputBuffer->getPixelFormat() != reqPixelFormat) {
+        ALOGD("%s: Output buffer %" PRIu32 "x%" PRIu32 " format %d does not match the requested "
+              "%" PRId32 "x%" PRId32 " format %d",
+              __func__, outputBuffer->getWidth(), outputBuffer->getHeight(),
+              outputBuffer->getPixelFormat(), bufferSize.getWidth(), bufferSize.getHeight(),
+              reqPixelFormat);
+        return base::unexpected(BAD_VALUE);
+    }
+    const uint64_t usage = outputBuffer->getUsage();
+    if (!(usage & GRALLOC_USAGE_HW_RENDER) || (usage & GRALLOC_USAGE_PROTECTED)) {
+        ALOGD("%s: Output buffer usage %" PRIx64 " cannot be rendered into", __func__, usage);
+        return base::unexpected(BAD_VALUE);
+    }
+    return std::make_shared<
+            renderengine::impl::ExternalTexture>(outputBuffer, getRenderEngine(),
+                                                 renderengine::impl::ExternalTexture::Usage::
+                                                         WRITEABLE);
+}
+
 void SurfaceFlinger::captureScreenCommon(RenderAreaBuilderVariant renderAreaBuilder,
                                          GetLayerSnapshotsFunction getLayerSnapshotsFn,
                                          ui::Size bufferSize, ui::PixelFormat reqPixelFormat,
                                          bool allowProtected, bool grayscale, bool attachGainmap,
+                                         const sp<GraphicBuffer>& outputBuffer,
                                          const sp<IScreenCaptureListener>& captureListener) {
     SFTRACE_CALL();
 
@@ -7236,78 +7505,59 @@ void SurfaceFlinger::captureScreenCommon(RenderAreaBuilderVariant renderAreaBuil
         return;
     }
 
+    const bool supportsProtected = getRenderEngine().supportsProtectedContent();
+    // The caller's output buffer is never protected, so protected content is not captured into it.
+    const bool mayCaptureProtected = allowProtected && supportsProtected && !outputBuffer;
+
     if (FlagManager::getInstance().single_hop_screenshot() &&
         FlagManager::getInstance().ce_fence_promise() && mRenderEngine->isThreaded()) {
         std::vector<sp<LayerFE>> layerFEs;
-        auto displayState =
-                getSnapshotsFromMainThread(renderAreaBuilder, getLayerSnapshotsFn, layerFEs);
+        auto displayStateFuture =
+                scheduleSnapshotsFromMainThread(renderAreaBuilder, getLayerSnapshotsFn, layerFEs);
 
-        const bool supportsProtected = getRenderEngine().supportsProtectedContent();
-        bool hasProtectedLayer = false;
-        if (allowProtected && supportsProtected) {
-            hasProtectedLayer = layersHasProtectedLayer(layerFEs);
-        }
-        const bool isProtected = hasProtectedLayer && allowProtected && supportsProtected;
-        const uint32_t usage = GRALLOC_USAGE_HW_COMPOSER | GRALLOC_USAGE_HW_RENDER |
-                GRALLOC_USAGE_HW_TEXTURE |
-                (isProtected ? GRALLOC_USAGE_PROTECTED
-                             : GRALLOC_USAGE_SW_READ_OFTEN | GRALLOC_USAGE_SW_WRITE_OFTEN);
-        sp<GraphicBuffer> buffer =
-                getFactory().createGraphicBuffer(bufferSize.getWidth(), bufferSize.getHeight(),
-                                                 static_cast<android_pixel_format>(reqPixelFormat),
-                                                 1 /* layerCount */, usage, "screenshot");
-
-        const status_t bufferStatus = buffer->initCheck();
-        if (bufferStatus != OK) {
-            // Animations may end up being really janky, but don't crash here.
-            // Otherwise an irreponsible process may cause an SF crash by allocating
-            // too much.
-            ALOGE("%s: Buffer failed to allocate: %d", __func__, bufferStatus);
-            invokeScreenCaptureError(bufferStatus, captureListener);
+        // Unless protected content may be captured, the buffer does not depend on the layers, so
+        // allocate it while the main thread is collecting their snapshots.
+        std::optional<base::expected<std::shared_ptr<renderengine::ExternalTexture>, status_t>>
+                texture;
+        if (!mayCaptureProtected) {
+            texture = getScreenshotTexture(outputBuffer, bufferSize, reqPixelFormat,
+                                           false /* isProtected */);
+        }
+
+        auto displayState = displayStateFuture.get();
+
+        const bool isProtected = mayCaptureProtected && layersHasProtectedLayer(layerFEs);
+        if (!texture) {
+            texture = getScreenshotTexture(outputBuffer, bufferSize, reqPixelFormat, isProtected);
+        }
+        if (!texture->has_value()) {
+            invokeScreenCaptureError(texture->error(), captureListener);
             return;
         }
-        const std::shared_ptr<renderengine::ExternalTexture> texture = std::make_shared<
-                renderengine::impl::ExternalTexture>(buffer, getRenderEngine(),
-                                                     renderengine::impl::ExternalTexture::Usage::
-                                                             WRITEABLE);
-        auto futureFence = captureScreenshot(renderAreaBuilder, texture, false /* regionSampling */,
-                                             grayscale, isProtected, attachGainmap, captureListener,
-                                             displayState, layerFEs);
+
+        auto futureFence = captureScreenshot(renderAreaBuilder, texture->value(),
+                                             false /* regionSampling */, grayscale, isProtected,
+                                             attachGainmap, captureListener, displayState,
+                                             layerFEs);
         futureFence.get();
 
     } else {
-        const bool supportsProtected = getRenderEngine().supportsProtectedContent();
         bool hasProtectedLayer = false;
-        if (allowProtected && supportsProtected) {
+        if (mayCaptureProtected) {
             auto layers = mScheduler->schedule([=]() { return getLayerSnapshotsFn(); }).get();
             hasProtectedLayer = layersHasProtectedLayer(extractLayerFEs(layers));
         }
-        const bool isProtected = hasProtectedLayer && allowProtected && supportsProtected;
-        const uint32_t usage = GRALLOC_USAGE_HW_COMPOSER | GRALLOC_USAGE_HW_RENDER |
-                GRALLOC_USAGE_HW_TEXTURE |
-                (isProtected ? GRALLOC_USAGE_PROTECTED
-                             : GRALLOC_USAGE_SW_READ_OFTEN | GRALLOC_USAGE_SW_WRITE_OFTEN);
-        sp<GraphicBuffer> buffer =
-                getFactory().createGraphicBuffer(bufferSize.getWidth(), bufferSize.getHeight(),
-                                                 static_cast<android_pixel_format>(reqPixelFormat),
-                                                 1 /* layerCount */, usage, "screenshot");
-
-        const status_t bufferStatus = buffer->initCheck();
-        if (bufferStatus != OK) {
-            // Animations may end up being really janky, but don't crash here.
-            // Otherwise an irreponsible process may cause an SF crash by allocating
-            // too much.
-            ALOGE("%s: Buffer failed to allocate: %d", __func__, bufferStatus);
-            invokeScreenCaptureError(bufferStatus, captureListener);
+        const bool isProtected = hasProtectedLayer && mayCaptureProtected;
+        const auto texture =
+                getScreenshotTexture(outputBuffer, bufferSize, reqPixelFormat, isProtected);
+        if (!texture.has_value()) {
+            invokeScreenCaptureError(texture.error(), captureListener);
             return;
         }
-        const std::shared_ptr<renderengine::ExternalTexture> texture = std::make_shared<
-                renderengine::impl::ExternalTexture>(buffer, getRenderEngine(),
-                                                     renderengine::impl::ExternalTexture::Usage::
-                                                             WRITEABLE);
-        auto futureFence = captureScreenshotLegacy(renderAreaBuilder, getLayerSnapshotsFn, texture,
-                                                   false /* regionSampling */, grayscale,
-                                                   isProtected, attachGainmap, captureListener);
+        auto futureFence = captureScreenshotLegacy(renderAreaBuilder, getLayerSnapshotsFn,
+                                                   texture.value(), false /* regionSampling */,
+                                                   grayscale, isProtected, attachGainmap,
+                                                   captureListener);
         futureFence.get();
     }
 }
@@ -8256,6 +8506,11 @@ std::vector<std::pair<Layer*, LayerFE*>> SurfaceFlinger::moveSnapshotsToComposit
     nsecs_t currentTime = systemTime();
     const bool needsMetadata = mCompositionEngine->getFeatureFlags().test(
             compositionengine::Feature::kSnapshotLayerMetadata);
+    const bool trackChangedLayerStacks =
+            !cursorOnly && FlagManager::getInstance().skip_noop_frame_present();
+    if (trackChangedLayerStacks) {
+        refreshArgs.changedLayerStacks.emplace();
+    }
     mLayerSnapshotBuilder.forEachSnapshot(
             [&](std::unique_ptr<frontend::LayerSnapshot>& snapshot) FTL_FAKE_GUARD(
                     kMainThreadContext) {
@@ -8269,6 +8524,16 @@ std::vector<std::pair<Layer*, LayerFE*>> SurfaceFlinger::moveSnapshotsToComposit
                     return;
                 }
 
+                if (trackChangedLayerStacks &&
+                    (snapshot->changes.any() || snapshot->clientChanges != 0)) {
+                    auto& changedLayerStacks = *refreshArgs.changedLayerStacks;
+                    const ui::LayerStack layerStack = snapshot->outputFilter.layerStack;
+                    if (std::find(changedLayerStacks.begin(), changedLayerStacks.end(),
+                                  layerStack) == changedLayerStacks.end()) {
+                        changedLayerStacks.push_back(layerStack);
+                    }
+                }
+
                 auto it = mLegacyLayers.find(snapshot->sequence);
                 LLOG_ALWAYS_FATAL_WITH_TRACE_IF(it == mLegacyLayers.end(),
                                                 "Couldnt find layer object for %s",
@@ -8875,6 +9140,13 @@ binder::Status SurfaceComposerAIDL::captureLayers(
     return binderStatusFromStatusT(NO_ERROR);
 }
 
+binder::Status SurfaceComposerAIDL::captureLayersBatch(
+        const std::vector<LayerCaptureArgs>& args,
+        const std::vector<sp<IScreenCaptureListener>>& captureListeners) {
+    mFlinger->captureLayersBatch(args, captureListeners);
+    return binderStatusFromStatusT(NO_ERROR);
+}
+
 binder::Status SurfaceComposerAIDL::overrideHdrTypes(const sp<IBinder>& display,
                                                      const std::vector<int32_t>& hdrTypes) {
     // overrideHdrTypes is used by CTS tests, which acquire the necessary
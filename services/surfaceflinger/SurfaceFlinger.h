@@ -95,6 +95,7 @@
 #include <atomic>
 #include <cstdint>
 #include <functional>
+#include <future>
 #include <map>
 #include <memory>
 #include <mutex>
@@ -566,6 +567,8 @@ private:
     void captureDisplay(DisplayId, const CaptureArgs&, const sp<IScreenCaptureListener>&);
     ScreenCaptureResults captureLayersSync(const LayerCaptureArgs&);
     void captureLayers(const LayerCaptureArgs&, const sp<IScreenCaptureListener>&);
+    void captureLayersBatch(const std::vector<LayerCaptureArgs>&,
+                            const std::vector<sp<IScreenCaptureListener>>&);
 
     status_t getDisplayStats(const sp<IBinder>& displayToken, DisplayStatInfo* stats);
     status_t getDisplayState(const sp<IBinder>& displayToken, ui::DisplayState*)
@@ -678,6 +681,7 @@ private:
     void configure() override REQUIRES(kMainThreadContext);
     bool commit(PhysicalDisplayId pacesetterId, const scheduler::FrameTargets&) override
             REQUIRES(kMainThreadContext);
+    void prepareCommit() override REQUIRES(kMainThreadContext);
     CompositeResultsPerDisplay composite(PhysicalDisplayId pacesetterId,
                                          const scheduler::FrameTargeters&) override
             REQUIRES(kMainThreadContext);
@@ -859,9 +863,50 @@ private:
             RenderAreaBuilderVariant& renderAreaBuilder,
             GetLayerSnapshotsFunction getLayerSnapshotsFn, std::vector<sp<LayerFE>>& layerFEs);
 
+    std::optional<OutputCompositionState> getSnapshotsOnMainThread(
+            RenderAreaBuilderVariant& renderAreaBuilder,
+            const GetLayerSnapshotsFunction& getLayerSnapshotsFn,
+            std::vector<sp<LayerFE>>& layerFEs) REQUIRES(kMainThreadContext);
+
+    // Like getSnapshotsFromMainThread, but returns without waiting for the main thread. The future
+    // must be waited on before renderAreaBuilder and layerFEs go out of scope.
+    std::future<std::optional<OutputCompositionState>> scheduleSnapshotsFromMainThread(
+            RenderAreaBuilderVariant& renderAreaBuilder,
+            GetLayerSnapshotsFunction getLayerSnapshotsFn, std::vector<sp<LayerFE>>& layerFEs);
+
+    // Allocates the buffer a screenshot is rendered into and handed to the client with.
+    base::expected<std::shared_ptr<renderengine::ExternalTexture>, status_t>
+    allocateScreenshotTexture(ui::Size bufferSize, ui::PixelFormat, bool isProtected);
+
+    // Returns the caller's output buffer if there is one, after checking that it can be rendered
+    // into with the requested size and format, and allocates a buffer otherwise.
+    base::expected<std::shared_ptr<renderengine::ExternalTexture>, status_t> getScreenshotTexture(
+            const sp<GraphicBuffer>& outputBuffer, ui::Size bufferSize, ui::PixelFormat,
+            bool isProtected);
+
     void captureScreenCommon(RenderAreaBuilderVariant, GetLayerSnapshotsFunction,
                              ui::Size bufferSize, ui::PixelFormat, bool allowProtected,
-                             bool grayscale, bool attachGainmap, const sp<IScreenCaptureListener>&);
+                             bool grayscale, bool attachGainmap,
+                             const sp<GraphicBuffer>& outputBuffer,
+                             const sp<IScreenCaptureListener>&);
+
+    // A validated captureLayers request, ready to be passed to captureScreenCommon.
+    struct LayerCaptureRequest {
+        RenderAreaBuilderVariant renderAreaBuilder;
+        GetLayerSnapshotsFunction getLayerSnapshotsFn;
+        ui::Size bufferSize;
+        ui::PixelFormat pixelFormat;
+        bool allowProtected;
+        bool grayscale;
+        bool attachGainmap;
+        sp<GraphicBuffer> outputBuffer;
+        sp<IScreenCaptureListener> captureListener;
+    };
+
+    // Validates a captureLayers request. On failure, the error is reported to the listener and
+    // std::nullopt is returned.
+    std::optional<LayerCaptureRequest> buildLayerCaptureRequest(
+            const LayerCaptureArgs&, const sp<IScreenCaptureListener>&);
 
     std::optional<OutputCompositionState> getDisplayStateFromRenderAreaBuilder(
             RenderAreaBuilderVariant& renderAreaBuilder) REQUIRES(kMainThreadContext);
@@ -1308,6 +1353,9 @@ private:
     // If blurs should be enabled on this device.
     bool mSupportsBlur = false;
 
+    // If LayerSnapshotBuilder should only walk dirty subtrees when the hierarchy is unchanged.
+    bool mUpdateDirtySnapshotSubtreesOnly = false;
+
     TransactionCallbackInvoker mTransactionCallbackInvoker;
 
     std::atomic<size_t> mNumLayers = 0;
@@ -1534,6 +1582,8 @@ public:
     binder::Status captureLayers(const LayerCaptureArgs&,
                                  const sp<IScreenCaptureListener>&) override;
     binder::Status captureLayersSync(const LayerCaptureArgs&, ScreenCaptureResults* results);
+    binder::Status captureLayersBatch(const std::vector<LayerCaptureArgs>&,
+                                      const std::vector<sp<IScreenCaptureListener>>&) override;
 
     // TODO(b/239076119): Remove deprecated AIDL.
     [[deprecated]] binder::Status clearAnimationFrameStats() override {
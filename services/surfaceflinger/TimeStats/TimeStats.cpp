@@ -576,14 +576,17 @@ void TimeStats::setPostTime(int32_t layerId, uint64_t frameNumber, const std::st
     if (!canAddNewAggregatedStats(uid, layerName, gameMode)) {
         return;
     }
-    if (!mTimeStatsTracker.count(layerId) && mTimeStatsTracker.size() < MAX_NUM_LAYER_RECORDS &&
-        layerNameIsValid(layerName)) {
-        mTimeStatsTracker[layerId].uid = uid;
-        mTimeStatsTracker[layerId].layerName = layerName;
-        mTimeStatsTracker[layerId].gameMode = gameMode;
+    auto it = mTimeStatsTracker.find(layerId);
+    if (it == mTimeStatsTracker.end()) {
+        if (mTimeStatsTracker.size() >= MAX_NUM_LAYER_RECORDS || !layerNameIsValid(layerName)) {
+            return;
+        }
+        it = mTimeStatsTracker.try_emplace(layerId).first;
+        it->second.uid = uid;
+        it->second.layerName = layerName;
+        it->second.gameMode = gameMode;
     }
-    if (!mTimeStatsTracker.count(layerId)) return;
-    LayerRecord& layerRecord = mTimeStatsTracker[layerId];
+    LayerRecord& layerRecord = it->second;
     if (layerRecord.timeRecords.size() == MAX_NUM_TIME_RECORDS) {
         ALOGE("[%d]-[%s]-timeRecords is at its maximum size[%zu]. Ignore this when unittesting.",
               layerId, layerRecord.layerName.c_str(), MAX_NUM_TIME_RECORDS);
@@ -609,6 +612,18 @@ void TimeStats::setPostTime(int32_t layerId, uint64_t frameNumber, const std::st
         layerRecord.waitData = layerRecord.timeRecords.size() - 1;
 }
 
+TimeStats::TimeRecord* TimeStats::getPendingTimeRecordLocked(int32_t layerId,
+                                                             uint64_t frameNumber) {
+    const auto it = mTimeStatsTracker.find(layerId);
+    if (it == mTimeStatsTracker.end()) return nullptr;
+    LayerRecord& layerRecord = it->second;
+    if (layerRecord.waitData < 0 ||
+        layerRecord.waitData >= static_cast<int32_t>(layerRecord.timeRecords.size()))
+        return nullptr;
+    TimeRecord& timeRecord = layerRecord.timeRecords[layerRecord.waitData];
+    return timeRecord.frameTime.frameNumber == frameNumber ? &timeRecord : nullptr;
+}
+
 void TimeStats::setLatchTime(int32_t layerId, uint64_t frameNumber, nsecs_t latchTime) {
     if (!mEnabled.load()) return;
 
@@ -616,14 +631,8 @@ void TimeStats::setLatchTime(int32_t layerId, uint64_t frameNumber, nsecs_t latc
     ALOGV("[%d]-[%" PRIu64 "]-LatchTime[%" PRId64 "]", layerId, frameNumber, latchTime);
 
     std::lock_guard<std::mutex> lock(mMutex);
-    if (!mTimeStatsTracker.count(layerId)) return;
-    LayerRecord& layerRecord = mTimeStatsTracker[layerId];
-    if (layerRecord.waitData < 0 ||
-        layerRecord.waitData >= static_cast<int32_t>(layerRecord.timeRecords.size()))
-        return;
-    TimeRecord& timeRecord = layerRecord.timeRecords[layerRecord.waitData];
-    if (timeRecord.frameTime.frameNumber == frameNumber) {
-        timeRecord.frameTime.latchTime = latchTime;
+    if (TimeRecord* timeRecord = getPendingTimeRecordLocked(layerId, frameNumber)) {
+        timeRecord->frameTime.latchTime = latchTime;
     }
 }
 
@@ -635,8 +644,9 @@ void TimeStats::incrementLatchSkipped(int32_t layerId, LatchSkipReason reason) {
           static_cast<std::underlying_type<LatchSkipReason>::type>(reason));
 
     std::lock_guard<std::mutex> lock(mMutex);
-    if (!mTimeStatsTracker.count(layerId)) return;
-    LayerRecord& layerRecord = mTimeStatsTracker[layerId];
+    const auto it = mTimeStatsTracker.find(layerId);
+    if (it == mTimeStatsTracker.end()) return;
+    LayerRecord& layerRecord = it->second;
 
     switch (reason) {
         case LatchSkipReason::LateAcquire:
@@ -652,8 +662,9 @@ void TimeStats::incrementBadDesiredPresent(int32_t layerId) {
     ALOGV("[%d]-BadDesiredPresent", layerId);
 
     std::lock_guard<std::mutex> lock(mMutex);
-    if (!mTimeStatsTracker.count(layerId)) return;
-    LayerRecord& layerRecord = mTimeStatsTracker[layerId];
+    const auto it = mTimeStatsTracker.find(layerId);
+    if (it == mTimeStatsTracker.end()) return;
+    LayerRecord& layerRecord = it->second;
     layerRecord.badDesiredPresentFrames++;
 }
 
@@ -664,14 +675,8 @@ void TimeStats::setDesiredTime(int32_t layerId, uint64_t frameNumber, nsecs_t de
     ALOGV("[%d]-[%" PRIu64 "]-DesiredTime[%" PRId64 "]", layerId, frameNumber, desiredTime);
 
     std::lock_guard<std::mutex> lock(mMutex);
-    if (!mTimeStatsTracker.count(layerId)) return;
-    LayerRecord& layerRecord = mTimeStatsTracker[layerId];
-    if (layerRecord.waitData < 0 ||
-        layerRecord.waitData >= static_cast<int32_t>(layerRecord.timeRecords.size()))
-        return;
-    TimeRecord& timeRecord = layerRecord.timeRecords[layerRecord.waitData];
-    if (timeRecord.frameTime.frameNumber == frameNumber) {
-        timeRecord.frameTime.desiredTime = desiredTime;
+    if (TimeRecord* timeRecord = getPendingTimeRecordLocked(layerId, frameNumber)) {
+        timeRecord->frameTime.desiredTime = desiredTime;
     }
 }
 
@@ -682,14 +687,8 @@ void TimeStats::setAcquireTime(int32_t layerId, uint64_t frameNumber, nsecs_t ac
     ALOGV("[%d]-[%" PRIu64 "]-AcquireTime[%" PRId64 "]", layerId, frameNumber, acquireTime);
 
     std::lock_guard<std::mutex> lock(mMutex);
-    if (!mTimeStatsTracker.count(layerId)) return;
-    LayerRecord& layerRecord = mTimeStatsTracker[layerId];
-    if (layerRecord.waitData < 0 ||
-        layerRecord.waitData >= static_cast<int32_t>(layerRecord.timeRecords.size()))
-        return;
-    TimeRecord& timeRecord = layerRecord.timeRecords[layerRecord.waitData];
-    if (timeRecord.frameTime.frameNumber == frameNumber) {
-        timeRecord.frameTime.acquireTime = acquireTime;
+    if (TimeRecord* timeRecord = getPendingTimeRecordLocked(layerId, frameNumber)) {
+        timeRecord->frameTime.acquireTime = acquireTime;
     }
 }
 
@@ -702,14 +701,8 @@ void TimeStats::setAcquireFence(int32_t layerId, uint64_t frameNumber,
           acquireFence->getSignalTime());
 
     std::lock_guard<std::mutex> lock(mMutex);
-    if (!mTimeStatsTracker.count(layerId)) return;
-    LayerRecord& layerRecord = mTimeStatsTracker[layerId];
-    if (layerRecord.waitData < 0 ||
-        layerRecord.waitData >= static_cast<int32_t>(layerRecord.timeRecords.size()))
-        return;
-    TimeRecord& timeRecord = layerRecord.timeRecords[layerRecord.waitData];
-    if (timeRecord.frameTime.frameNumber == frameNumber) {
-        timeRecord.acquireFence = acquireFence;
+    if (TimeRecord* timeRecord = getPendingTimeRecordLocked(layerId, frameNumber)) {
+        timeRecord->acquireFence = acquireFence;
     }
 }
 
@@ -722,8 +715,9 @@ void TimeStats::setPresentTime(int32_t layerId, uint64_t frameNumber, nsecs_t pr
     ALOGV("[%d]-[%" PRIu64 "]-PresentTime[%" PRId64 "]", layerId, frameNumber, presentTime);
 
     std::lock_guard<std::mutex> lock(mMutex);
-    if (!mTimeStatsTracker.count(layerId)) return;
-    LayerRecord& layerRecord = mTimeStatsTracker[layerId];
+    const auto it = mTimeStatsTracker.find(layerId);
+    if (it == mTimeStatsTracker.end()) return;
+    LayerRecord& layerRecord = it->second;
     if (layerRecord.waitData < 0 ||
         layerRecord.waitData >= static_cast<int32_t>(layerRecord.timeRecords.size()))
         return;
@@ -749,8 +743,9 @@ void TimeStats::setPresentFence(int32_t layerId, uint64_t frameNumber,
           presentFence->getSignalTime());
 
     std::lock_guard<std::mutex> lock(mMutex);
-    if (!mTimeStatsTracker.count(layerId)) return;
-    LayerRecord& layerRecord = mTimeStatsTracker[layerId];
+    const auto it = mTimeStatsTracker.find(layerId);
+    if (it == mTimeStatsTracker.end()) return;
+    LayerRecord& layerRecord = it->second;
     if (layerRecord.waitData < 0 ||
         layerRecord.waitData >= static_cast<int32_t>(layerRecord.timeRecords.size()))
         return;
@@ -829,25 +824,30 @@ void TimeStats::incrementJankyFrames(const JankyFramesInfo& info) {
                                  RENDER_RATE_BUCKET_WIDTH);
     const TimeStatsHelper::TimelineStatsKey timelineKey = {refreshRateBucket, renderRateBucket};
 
-    if (!mTimeStats.stats.count(timelineKey)) {
-        mTimeStats.stats[timelineKey].key = timelineKey;
+    const auto [timelineIt, newTimeline] = mTimeStats.stats.try_emplace(timelineKey);
+    TimeStatsHelper::TimelineStats& timelineStats = timelineIt->second;
+    if (newTimeline) {
+        timelineStats.key = timelineKey;
     }
 
-    TimeStatsHelper::TimelineStats& timelineStats = mTimeStats.stats[timelineKey];
-
     updateJankPayload<TimeStatsHelper::TimelineStats>(timelineStats, info.reasons);
 
-    TimeStatsHelper::LayerStatsKey layerKey = {info.uid, info.layerName, info.gameMode};
-    if (!timelineStats.stats.count(layerKey)) {
-        layerKey = {info.uid, kDefaultLayerName, kDefaultGameMode};
-        timelineStats.stats[layerKey].displayRefreshRateBucket = refreshRateBucket;
-        timelineStats.stats[layerKey].renderRateBucket = renderRateBucket;
-        timelineStats.stats[layerKey].uid = info.uid;
-        timelineStats.stats[layerKey].layerName = kDefaultLayerName;
-        timelineStats.stats[layerKey].gameMode = kDefaultGameMode;
+    auto layerIt = timelineStats.stats.find(
+            TimeStatsHelper::LayerStatsKey{info.uid, info.layerName, info.gameMode});
+    if (layerIt == timelineStats.stats.end()) {
+        const auto [defaultLayerIt, newLayer] = timelineStats.stats.try_emplace(
+                TimeStatsHelper::LayerStatsKey{info.uid, kDefaultLayerName, kDefaultGameMode});
+        layerIt = defaultLayerIt;
+        if (newLayer) {
+            layerIt->second.displayRefreshRateBucket = refreshRateBucket;
+            layerIt->second.renderRateBucket = renderRateBucket;
+            layerIt->second.uid = info.uid;
+            layerIt->second.layerName = kDefaultLayerName;
+            layerIt->second.gameMode = kDefaultGameMode;
+        }
     }
 
-    TimeStatsHelper::TimeStatsLayer& timeStatsLayer = timelineStats.stats[layerKey];
+    TimeStatsHelper::TimeStatsLayer& timeStatsLayer = layerIt->second;
     updateJankPayload<TimeStatsHelper::TimeStatsLayer>(timeStatsLayer, info.reasons);
 
     if (info.reasons & kValidJankyReason) {
@@ -874,8 +874,9 @@ void TimeStats::removeTimeRecord(int32_t layerId, uint64_t frameNumber) {
     ALOGV("[%d]-[%" PRIu64 "]-removeTimeRecord", layerId, frameNumber);
 
     std::lock_guard<std::mutex> lock(mMutex);
-    if (!mTimeStatsTracker.count(layerId)) return;
-    LayerRecord& layerRecord = mTimeStatsTracker[layerId];
+    const auto it = mTimeStatsTracker.find(layerId);
+    if (it == mTimeStatsTracker.end()) return;
+    LayerRecord& layerRecord = it->second;
     size_t removeAt = 0;
     for (const TimeRecord& record : layerRecord.timeRecords) {
         if (record.frameTime.frameNumber == frameNumber) break;
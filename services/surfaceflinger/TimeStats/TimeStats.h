@@ -292,6 +292,8 @@ private:
     bool populateGlobalAtom(std::vector<uint8_t>* pulledData);
     bool populateLayerAtom(std::vector<uint8_t>* pulledData);
     bool recordReadyLocked(int32_t layerId, TimeRecord* timeRecord);
+    // Returns the record waiting for the next present of the layer, if it is for frameNumber.
+    TimeRecord* getPendingTimeRecordLocked(int32_t layerId, uint64_t frameNumber);
     void flushAvailableRecordsToStatsLocked(int32_t layerId, Fps displayRefreshRate,
                                             std::optional<Fps> renderRate, SetFrameRateVote,
                                             GameMode);
@@ -20,10 +20,12 @@
 
 #include "LayerTracing.h"
 
+#include "BackgroundExecutor.h"
 #include "LayerDataSource.h"
 #include "Tracing/tools/LayerTraceGenerator.h"
 #include "TransactionTracing.h"
 
+#include <common/FlagManager.h>
 #include <common/trace.h>
 #include <log/log.h>
 #include <perfetto/tracing.h>
@@ -42,6 +44,10 @@ LayerTracing::LayerTracing(std::ostream& outStream) : LayerTracing() {
 
 LayerTracing::~LayerTracing() {
     LayerDataSource::UnregisterLayerTracing();
+    // Pending background writes refer to this object.
+    if (mHasBackgroundWrites) {
+        BackgroundExecutor::getLowPriorityInstance().flushQueue();
+    }
 }
 
 void LayerTracing::setTakeLayersSnapshotProtoFunction(
@@ -56,6 +62,11 @@ void LayerTracing::setTransactionTracing(TransactionTracing& transactionTracing)
 void LayerTracing::onStart(Mode mode, uint32_t flags) {
     switch (mode) {
         case Mode::MODE_ACTIVE: {
+            {
+                // The initial snapshot of a new session must always be written.
+                std::lock_guard lock(mLastActiveSnapshotMutex);
+                mLastActiveSnapshotState.clear();
+            }
             mActiveTracingFlags.store(flags);
             mIsActiveTracingStarted.store(true);
             ALOGV("Starting active tracing (waiting for initial snapshot)");
@@ -137,8 +148,21 @@ void LayerTracing::addProtoSnapshotToOstream(perfetto::protos::LayersSnapshotPro
     SFTRACE_CALL();
     if (mOutStream) {
         writeSnapshotToStream(std::move(snapshot));
+    } else if (mode == Mode::MODE_ACTIVE &&
+               FlagManager::getInstance().layer_tracing_background_serialization()) {
+        // Active tracing takes a snapshot on the main thread every frame. Serializing it can take
+        // longer than taking it, so do that on a background thread. The executor runs tasks in
+        // order, so snapshots are still written in vsync order.
+        mHasBackgroundWrites = true;
+        auto sharedSnapshot =
+                std::make_shared<perfetto::protos::LayersSnapshotProto>(std::move(snapshot));
+        BackgroundExecutor::getLowPriorityInstance().sendCallbacks(
+                {[this, sharedSnapshot = std::move(sharedSnapshot), mode]() {
+                    SFTRACE_NAME("LayerTracing::writeSnapshotToPerfetto");
+                    writeSnapshotToPerfetto(std::move(*sharedSnapshot), mode);
+                }});
     } else {
-        writeSnapshotToPerfetto(snapshot, mode);
+        writeSnapshotToPerfetto(std::move(snapshot), mode);
     }
 }
 
@@ -172,9 +196,39 @@ void LayerTracing::writeSnapshotToStream(perfetto::protos::LayersSnapshotProto&&
     mOutStream->get() << fileProto.SerializeAsString();
 }
 
-void LayerTracing::writeSnapshotToPerfetto(const perfetto::protos::LayersSnapshotProto& snapshot,
+void LayerTracing::writeSnapshotToPerfetto(perfetto::protos::LayersSnapshotProto&& snapshot,
                                            Mode srcMode) {
-    const auto snapshotBytes = snapshot.SerializeAsString();
+    const int64_t vsyncId = snapshot.vsync_id();
+    const int64_t timestamp = snapshot.elapsed_realtime_nanos();
+
+    std::string snapshotBytes;
+    if (srcMode == Mode::MODE_ACTIVE &&
+        FlagManager::getInstance().layer_tracing_skip_unchanged_snapshots()) {
+        // Serialize the fields that change every frame apart from the layers state, so that a
+        // snapshot whose state matches the previous one can be dropped. A trace viewer shows the
+        // previous snapshot until the next one, so dropping it loses nothing. Serializations of
+        // the same message type concatenate into one merged message, so what is written is still
+        // a complete snapshot.
+        perfetto::protos::LayersSnapshotProto header;
+        header.set_elapsed_realtime_nanos(timestamp);
+        header.set_vsync_id(vsyncId);
+        header.set_where(snapshot.where());
+        snapshot.clear_elapsed_realtime_nanos();
+        snapshot.clear_vsync_id();
+        snapshot.clear_where();
+
+        std::string stateBytes = snapshot.SerializeAsString();
+        {
+            std::lock_guard lock(mLastActiveSnapshotMutex);
+            if (stateBytes == mLastActiveSnapshotState) {
+                return;
+            }
+            mLastActiveSnapshotState = stateBytes;
+        }
+        snapshotBytes = header.SerializeAsString() + stateBytes;
+    } else {
+        snapshotBytes = snapshot.SerializeAsString();
+    }
 
     LayerDataSource::Trace([&](LayerDataSource::TraceContext context) {
         auto dstMode = context.GetCustomTlsState()->mMode;
@@ -189,12 +243,12 @@ void LayerTracing::writeSnapshotToPerfetto(const perfetto::protos::LayersSnapsho
             return;
         }
 
-        if (!checkAndUpdateLastVsyncIdWrittenToPerfetto(srcMode, snapshot.vsync_id())) {
+        if (!checkAndUpdateLastVsyncIdWrittenToPerfetto(srcMode, vsyncId)) {
             return;
         }
         {
             auto packet = context.NewTracePacket();
-            packet->set_timestamp(static_cast<uint64_t>(snapshot.elapsed_realtime_nanos()));
+            packet->set_timestamp(static_cast<uint64_t>(timestamp));
             packet->set_timestamp_clock_id(perfetto::protos::pbzero::BUILTIN_CLOCK_MONOTONIC);
             auto* snapshotProto = packet->set_surfaceflinger_layers_snapshot();
             snapshotProto->AppendRawProtoBytes(snapshotBytes.data(), snapshotBytes.size());
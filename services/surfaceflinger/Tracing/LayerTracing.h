@@ -18,10 +18,14 @@
 
 #include <layerproto/LayerProtoHeader.h>
 
+#include <android-base/thread_annotations.h>
+
 #include <atomic>
 #include <functional>
+#include <mutex>
 #include <optional>
 #include <ostream>
+#include <string>
 
 namespace android {
 
@@ -120,7 +124,7 @@ public:
 
 private:
     void writeSnapshotToStream(perfetto::protos::LayersSnapshotProto&& snapshot) const;
-    void writeSnapshotToPerfetto(const perfetto::protos::LayersSnapshotProto& snapshot, Mode mode);
+    void writeSnapshotToPerfetto(perfetto::protos::LayersSnapshotProto&& snapshot, Mode mode);
     bool checkAndUpdateLastVsyncIdWrittenToPerfetto(Mode mode, std::int64_t vsyncId);
 
     std::function<perfetto::protos::LayersSnapshotProto(uint32_t)> mTakeLayersSnapshotProto;
@@ -129,6 +133,12 @@ private:
     std::atomic<bool> mIsActiveTracingStarted{false};
     std::atomic<uint32_t> mActiveTracingFlags{0};
     std::atomic<std::int64_t> mLastVsyncIdWrittenToPerfetto{-1};
+    // Whether snapshots were ever handed to BackgroundExecutor for writing.
+    std::atomic<bool> mHasBackgroundWrites{false};
+
+    // The last active mode snapshot written, without its per-frame fields.
+    std::mutex mLastActiveSnapshotMutex;
+    std::string mLastActiveSnapshotState GUARDED_BY(mLastActiveSnapshotMutex);
     std::optional<std::reference_wrapper<std::ostream>> mOutStream;
 };
 
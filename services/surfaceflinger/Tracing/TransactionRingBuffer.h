@@ -23,35 +23,66 @@
 #include <log/log.h>
 #include <utils/Errors.h>
 #include <utils/Timers.h>
+#include <algorithm>
 #include <chrono>
+#include <deque>
 #include <fstream>
+#include <functional>
+#include <memory>
+#include <string_view>
 
 namespace android {
 
 class SurfaceFlinger;
 
+// Holds the most recent serialized entries that fit in a fixed number of bytes. The entries are
+// stored back to back in a single buffer that is allocated when the size is set, so adding an
+// entry does not allocate. An entry never wraps around the end of the buffer; if it does not fit
+// before the end it is written at the start instead.
 template <typename FileProto, typename EntryProto>
 class TransactionRingBuffer {
 public:
+    // Called with each entry that is removed to make room, oldest first. The data is only valid
+    // for the duration of the call.
+    using EvictedCallback = std::function<void(std::string_view)>;
+
     size_t size() const { return mSizeInBytes; }
     size_t used() const { return mUsedInBytes; }
-    size_t frameCount() const { return mStorage.size(); }
-    void setSize(size_t newSize) { mSizeInBytes = newSize; }
-    const std::string& front() const { return mStorage.front(); }
-    const std::string& back() const { return mStorage.back(); }
+    size_t frameCount() const { return mEntries.size(); }
+    std::string_view front() const { return view(mEntries.front()); }
+    std::string_view back() const { return view(mEntries.back()); }
+
+    // Entries that no longer fit are evicted, oldest first.
+    void setSize(size_t newSize, const EvictedCallback& onEvicted = {}) {
+        while (!mEntries.empty() && mUsedInBytes > newSize) {
+            evictFront(onEvicted);
+        }
+
+        auto bytes = std::unique_ptr<char[]>(new char[newSize]);
+        size_t tail = 0;
+        for (Entry& entry : mEntries) {
+            std::copy_n(mBytes.get() + entry.offset, entry.size, bytes.get() + tail);
+            entry.offset = tail;
+            tail += entry.size;
+        }
+        mBytes = std::move(bytes);
+        mSizeInBytes = newSize;
+        mTail = tail;
+    }
 
     void reset() {
         // use the swap trick to make sure memory is released
-        std::deque<std::string>().swap(mStorage);
+        std::deque<Entry>().swap(mEntries);
         mUsedInBytes = 0U;
+        mTail = 0U;
     }
 
     void writeToProto(FileProto& fileProto) const {
-        fileProto.mutable_entry()->Reserve(static_cast<int>(mStorage.size()) +
+        fileProto.mutable_entry()->Reserve(static_cast<int>(mEntries.size()) +
                                            fileProto.entry().size());
-        for (const std::string& entry : mStorage) {
+        for (const Entry& entry : mEntries) {
             EntryProto* entryProto = fileProto.add_entry();
-            entryProto->ParseFromString(entry);
+            entryProto->ParseFromArray(mBytes.get() + entry.offset, static_cast<int>(entry.size));
         }
     }
 
@@ -68,33 +99,45 @@ public:
         return NO_ERROR;
     }
 
-    std::vector<std::string> emplace(std::string&& serializedProto) {
-        std::vector<std::string> replacedEntries;
-        size_t protoSize = static_cast<size_t>(serializedProto.size());
-        while (mUsedInBytes + protoSize > mSizeInBytes) {
-            if (mStorage.empty()) {
-                return {};
+    void emplace(std::string_view serializedProto, const EvictedCallback& onEvicted = {}) {
+        const size_t protoSize = serializedProto.size();
+        if (protoSize > mSizeInBytes) {
+            ALOGW("Dropping entry of %zu bytes, larger than the %zu byte buffer", protoSize,
+                  mSizeInBytes);
+            return;
+        }
+
+        size_t offset = mTail;
+        if (offset + protoSize > mSizeInBytes) {
+            // The entries between the tail and the end of the buffer are the oldest ones.
+            while (!mEntries.empty() && mEntries.front().offset >= mTail) {
+                evictFront(onEvicted);
             }
-            mUsedInBytes -= static_cast<size_t>(mStorage.front().size());
-            replacedEntries.emplace_back(mStorage.front());
-            mStorage.pop_front();
+            offset = 0;
+        }
+        while (!mEntries.empty() && mEntries.front().offset < offset + protoSize &&
+               mEntries.front().offset + mEntries.front().size > offset) {
+            evictFront(onEvicted);
         }
+
+        std::copy_n(serializedProto.data(), protoSize, mBytes.get() + offset);
+        mEntries.push_back({offset, protoSize});
         mUsedInBytes += protoSize;
-        mStorage.emplace_back(serializedProto);
-        return replacedEntries;
+        mTail = offset + protoSize;
     }
 
-    std::vector<std::string> emplace(EntryProto&& proto) {
+    void emplace(EntryProto&& proto, const EvictedCallback& onEvicted = {}) {
         std::string serializedProto;
         proto.SerializeToString(&serializedProto);
-        return emplace(std::move(serializedProto));
+        emplace(serializedProto, onEvicted);
     }
 
     void dump(std::string& result) const {
         std::chrono::milliseconds duration(0);
         if (frameCount() > 0) {
             EntryProto entry;
-            entry.ParseFromString(mStorage.front());
+            const std::string_view oldest = front();
+            entry.ParseFromArray(oldest.data(), static_cast<int>(oldest.size()));
             duration = std::chrono::duration_cast<std::chrono::milliseconds>(
                     std::chrono::nanoseconds(systemTime() - entry.elapsed_realtime_nanos()));
         }
@@ -106,9 +149,33 @@ public:
     }
 
 private:
+    struct Entry {
+        size_t offset;
+        size_t size;
+    };
+
+    std::string_view view(const Entry& entry) const {
+        return std::string_view(mBytes.get() + entry.offset, entry.size);
+    }
+
+    void evictFront(const EvictedCallback& onEvicted) {
+        const Entry& entry = mEntries.front();
+        if (onEvicted) {
+            onEvicted(view(entry));
+        }
+        mUsedInBytes -= entry.size;
+        mEntries.pop_front();
+        if (mEntries.empty()) {
+            mTail = 0U;
+        }
+    }
+
     size_t mUsedInBytes = 0U;
     size_t mSizeInBytes = 0U;
-    std::deque<std::string> mStorage;
+    // Where the next entry is written, just past the newest entry.
+    size_t mTail = 0U;
+    std::unique_ptr<char[]> mBytes;
+    std::deque<Entry> mEntries;
 };
 
 } // namespace android
@@ -144,7 +144,13 @@ perfetto::protos::TransactionTraceFile TransactionTracing::writeToProto() {
 
 void TransactionTracing::setBufferSize(size_t bufferSizeInBytes) {
     std::scoped_lock lock(mTraceLock);
-    mBuffer.setSize(bufferSizeInBytes);
+    perfetto::protos::TransactionTraceEntry removedEntryProto;
+    mBuffer.setSize(bufferSizeInBytes, [&](std::string_view removedEntry) REQUIRES(mTraceLock) {
+        removedEntryProto.ParseFromArray(removedEntry.data(),
+                                         static_cast<int>(removedEntry.size()));
+        updateStartingStateLocked(removedEntryProto);
+        removedEntryProto.Clear();
+    });
 }
 
 perfetto::protos::TransactionTraceFile TransactionTracing::createTraceFileProto() const {
@@ -229,8 +235,14 @@ void TransactionTracing::loop() {
 void TransactionTracing::addEntry(const std::vector<CommittedUpdates>& committedUpdates,
                                   const std::vector<uint32_t>& destroyedLayers) {
     std::scoped_lock lock(mTraceLock);
-    std::vector<std::string> removedEntries;
     perfetto::protos::TransactionTraceEntry entryProto;
+    perfetto::protos::TransactionTraceEntry removedEntryProto;
+    const auto onEvicted = [&](std::string_view removedEntry) REQUIRES(mTraceLock) {
+        removedEntryProto.ParseFromArray(removedEntry.data(),
+                                         static_cast<int>(removedEntry.size()));
+        updateStartingStateLocked(removedEntryProto);
+        removedEntryProto.Clear();
+    };
 
     while (auto incomingTransaction = mTransactionQueue.pop()) {
         auto transaction = *incomingTransaction;
@@ -304,20 +316,10 @@ void TransactionTracing::addEntry(const std::vector<CommittedUpdates>& committed
             }
         });
 
-        std::vector<std::string> entries = mBuffer.emplace(std::move(serializedProto));
-        removedEntries.reserve(removedEntries.size() + entries.size());
-        removedEntries.insert(removedEntries.end(), std::make_move_iterator(entries.begin()),
-                              std::make_move_iterator(entries.end()));
+        mBuffer.emplace(serializedProto, onEvicted);
 
         entryProto.Clear();
     }
-
-    perfetto::protos::TransactionTraceEntry removedEntryProto;
-    for (const std::string& removedEntry : removedEntries) {
-        removedEntryProto.ParseFromString(removedEntry);
-        updateStartingStateLocked(removedEntryProto);
-        removedEntryProto.Clear();
-    }
     mTransactionsAddedToBufferCv.notify_one();
 }
 
@@ -339,7 +341,10 @@ void TransactionTracing::flush() {
                                           [&]() REQUIRES(mTraceLock) {
                                               perfetto::protos::TransactionTraceEntry entry;
                                               if (mBuffer.used() > 0) {
-                                                  entry.ParseFromString(mBuffer.back());
+                                                  const std::string_view newest = mBuffer.back();
+                                                  entry.ParseFromArray(newest.data(),
+                                                                       static_cast<int>(
+                                                                               newest.size()));
                                               }
                                               return mBuffer.used() > 0 &&
                                                       entry.vsync_id() >= mLastUpdatedVsyncId;
@@ -0,0 +1,287 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#undef LOG_TAG
+#define LOG_TAG "FrontEndReplay"
+
+#include <time.h>
+
+#include <algorithm>
+#include <array>
+#include <cinttypes>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <Tracing/TransactionProtoParser.h>
+#include <Tracing/TransactionTracing.h>
+#include <binder/Binder.h>
+#include <cutils/properties.h>
+#include <gui/LayerState.h>
+
+#include "FrontEnd/LayerCreationArgs.h"
+#include "FrontEnd/LayerHierarchy.h"
+#include "FrontEnd/LayerLifecycleManager.h"
+#include "FrontEnd/LayerSnapshotBuilder.h"
+#include "FrontEnd/RequestedLayerState.h"
+#include "FrontEnd/TransactionHandler.h"
+#include "TransactionState.h"
+
+using namespace android;
+using namespace android::surfaceflinger;
+
+namespace {
+
+// The stages of the front end that each entry of the trace, i.e. each committed frame, goes
+// through.
+enum Stage : size_t {
+    kParse,
+    kTransactionHandler,
+    kLifecycleManager,
+    kHierarchyBuilder,
+    kSnapshotBuilder,
+    kStageCount,
+};
+
+constexpr std::array<const char*, kStageCount> kStageNames = {
+        "parse", "transactionHandler", "lifecycleManager", "hierarchyBuilder", "snapshotBuilder",
+};
+
+using FrameTimes = std::array<nsecs_t, kStageCount>;
+
+nsecs_t threadCpuTime() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1'000'000'000LL + ts.tv_nsec;
+}
+
+class ScopedStageTimer {
+public:
+    ScopedStageTimer(FrameTimes& times, Stage stage)
+          : mTime(times[stage]), mStart(threadCpuTime()) {}
+    ~ScopedStageTimer() { mTime += threadCpuTime() - mStart; }
+
+private:
+    nsecs_t& mTime;
+    const nsecs_t mStart;
+};
+
+class ScopedTraceDisabler {
+public:
+    ScopedTraceDisabler() { TransactionTraceWriter::getInstance().disable(); }
+    ~ScopedTraceDisabler() { TransactionTraceWriter::getInstance().enable(); }
+};
+
+// Replays the trace through the front end, as SurfaceFlinger::commit does, and returns the CPU
+// time that each entry spent in each stage.
+std::vector<FrameTimes> replay(const perfetto::protos::TransactionTraceFile& traceFile) {
+    TransactionProtoParser parser(std::make_unique<TransactionProtoParser::FlingerDataMapper>());
+
+    frontend::TransactionHandler transactionHandler;
+    // The trace only records the transactions that were applied.
+    transactionHandler.addTransactionReadyFilter(
+            [](const frontend::TransactionHandler::TransactionFlushState&) {
+                return frontend::TransactionHandler::TransactionReadiness::Ready;
+            });
+    frontend::LayerLifecycleManager lifecycleManager;
+    frontend::LayerHierarchyBuilder hierarchyBuilder;
+    frontend::LayerSnapshotBuilder snapshotBuilder;
+    frontend::DisplayInfos displayInfos;
+
+    ShadowSettings globalShadowSettings{.ambientColor = {1, 1, 1, 1}};
+    char value[PROPERTY_VALUE_MAX];
+    property_get("ro.surface_flinger.supports_background_blur", value, "0");
+    const bool supportsBlur = atoi(value);
+
+    std::vector<FrameTimes> frames;
+    frames.reserve(static_cast<size_t>(traceFile.entry_size()));
+    for (const auto& entry : traceFile.entry()) {
+        FrameTimes& times = frames.emplace_back();
+        times.fill(0);
+
+        std::vector<std::unique_ptr<frontend::RequestedLayerState>> addedLayers;
+        std::vector<std::pair<uint32_t, std::string>> destroyedHandles;
+        bool displayChanged = false;
+        {
+            ScopedStageTimer timer(times, kParse);
+            addedLayers.reserve(static_cast<size_t>(entry.added_layers_size()));
+            for (const auto& addedLayer : entry.added_layers()) {
+                LayerCreationArgs args;
+                parser.fromProto(addedLayer, args);
+                addedLayers.emplace_back(std::make_unique<frontend::RequestedLayerState>(args));
+            }
+            for (const auto& transactionProto : entry.transactions()) {
+                TransactionState transaction = parser.fromProto(transactionProto);
+                for (auto& resolvedComposerState : transaction.states) {
+                    if ((resolvedComposerState.state.what & layer_state_t::eInputInfoChanged) &&
+                        !resolvedComposerState.state.windowInfoHandle->getInfo()
+                                 ->inputConfig.test(
+                                         gui::WindowInfo::InputConfig::NO_INPUT_CHANNEL)) {
+                        // create a fake token since the FE expects a valid token
+                        resolvedComposerState.state.windowInfoHandle->editInfo()->token =
+                                sp<BBinder>::make();
+                    }
+                }
+                transactionHandler.queueTransaction(std::move(transaction));
+            }
+            destroyedHandles.reserve(static_cast<size_t>(entry.destroyed_layer_handles_size()));
+            for (const auto handle : entry.destroyed_layer_handles()) {
+                destroyedHandles.push_back({handle, ""});
+            }
+            displayChanged = entry.displays_changed();
+            if (displayChanged) {
+                parser.fromProto(entry.displays(), displayInfos);
+            }
+        }
+
+        std::vector<TransactionState> transactions;
+        {
+            ScopedStageTimer timer(times, kTransactionHandler);
+            transactionHandler.collectTransactions();
+            transactions = transactionHandler.flushTransactions();
+        }
+        {
+            ScopedStageTimer timer(times, kLifecycleManager);
+            lifecycleManager.addLayers(std::move(addedLayers));
+            lifecycleManager.applyTransactions(transactions, /*ignoreUnknownHandles=*/true);
+            lifecycleManager.onHandlesDestroyed(destroyedHandles, /*ignoreUnknownHandles=*/true);
+        }
+        {
+            ScopedStageTimer timer(times, kHierarchyBuilder);
+            hierarchyBuilder.update(lifecycleManager);
+        }
+        {
+            ScopedStageTimer timer(times, kSnapshotBuilder);
+            frontend::LayerSnapshotBuilder::Args args{.root = hierarchyBuilder.getHierarchy(),
+                                                      .layerLifecycleManager = lifecycleManager,
+                                                      .displays = displayInfos,
+                                                      .displayChanges = displayChanged,
+                                                      .globalShadowSettings = globalShadowSettings,
+                                                      .supportsBlur = supportsBlur,
+                                                      .forceFullDamage = false,
+                                                      .supportedLayerGenericMetadata = {},
+                                                      .genericLayerMetadataKeyMap = {}};
+            snapshotBuilder.update(args);
+        }
+        lifecycleManager.commitChanges();
+    }
+    return frames;
+}
+
+nsecs_t percentile(std::vector<nsecs_t>& times, size_t percent) {
+    const size_t index = std::min(times.size() - 1, times.size() * percent / 100);
+    std::nth_element(times.begin(), times.begin() + static_cast<ssize_t>(index), times.end());
+    return times[index];
+}
+
+void printSummary(const std::vector<FrameTimes>& frames) {
+    std::printf("%-20s %10s %10s %10s %10s %10s\n", "stage (us)", "mean", "p50", "p90", "p99",
+                "max");
+    for (size_t stage = 0; stage < kStageCount; stage++) {
+        std::vector<nsecs_t> times;
+        times.reserve(frames.size());
+        nsecs_t total = 0;
+        for (const auto& frame : frames) {
+            times.push_back(frame[stage]);
+            total += frame[stage];
+        }
+        const nsecs_t max = *std::max_element(times.begin(), times.end());
+        std::printf("%-20s %10.1f %10.1f %10.1f %10.1f %10.1f\n", kStageNames[stage],
+                    static_cast<double>(total) / static_cast<double>(frames.size()) / 1000.0,
+                    static_cast<double>(percentile(times, 50)) / 1000.0,
+                    static_cast<double>(percentile(times, 90)) / 1000.0,
+                    static_cast<double>(percentile(times, 99)) / 1000.0,
+                    static_cast<double>(max) / 1000.0);
+    }
+}
+
+bool writeCsv(const char* path, const std::vector<FrameTimes>& frames) {
+    std::ofstream out(path);
+    if (!out) return false;
+    out << "frame";
+    for (const char* name : kStageNames) {
+        out << "," << name << "_ns";
+    }
+    out << "\n";
+    for (size_t i = 0; i < frames.size(); i++) {
+        out << i;
+        for (const nsecs_t time : frames[i]) {
+            out << "," << time;
+        }
+        out << "\n";
+    }
+    return static_cast<bool>(out);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const char* transactionTracePath = "/data/misc/wmtrace/transactions_trace.winscope";
+    const char* csvPath = nullptr;
+    int iterations = 1;
+    for (int i = 1; i < argc; i++) {
+        const std::string_view arg = argv[i];
+        if (arg == "--csv" && i + 1 < argc) {
+            csvPath = argv[++i];
+        } else if (arg == "--iterations" && i + 1 < argc) {
+            iterations = std::max(1, atoi(argv[++i]));
+        } else if (!arg.starts_with("--")) {
+            transactionTracePath = argv[i];
+        } else {
+            std::cout << "Usage: " << argv[0]
+                      << " [transaction-trace-path] [--iterations N] [--csv output-path]\n";
+            return -1;
+        }
+    }
+
+    std::cout << "Parsing " << transactionTracePath << "\n";
+    std::fstream input(transactionTracePath, std::ios::in | std::ios::binary);
+    if (!input) {
+        std::cout << "Error: Could not open " << transactionTracePath << "\n";
+        return -1;
+    }
+    perfetto::protos::TransactionTraceFile transactionTraceFile;
+    if (!transactionTraceFile.ParseFromIstream(&input)) {
+        std::cout << "Error: Failed to parse " << transactionTracePath << "\n";
+        return -1;
+    }
+    if (transactionTraceFile.entry_size() == 0) {
+        std::cout << "Error: Trace file is empty\n";
+        return -1;
+    }
+
+    // Unexpected states in the trace would otherwise write another transaction trace.
+    ScopedTraceDisabler fatalErrorTraceDisabler;
+
+    std::vector<FrameTimes> frames;
+    for (int i = 0; i < iterations; i++) {
+        std::vector<FrameTimes> iterationFrames = replay(transactionTraceFile);
+        frames.insert(frames.end(), iterationFrames.begin(), iterationFrames.end());
+    }
+
+    std::cout << "Replayed " << transactionTraceFile.entry_size() << " entries " << iterations
+              << " time(s)\n";
+    printSummary(frames);
+
+    if (csvPath && !writeCsv(csvPath, frames)) {
+        std::cout << "Error: Failed to write " << csvPath << "\n";
+        return -1;
+    }
+    return 0;
+}
@@ -27,6 +27,8 @@
 #include "BackgroundExecutor.h"
 #include "Utils/FenceUtils.h"
 
+#include <algorithm>
+
 #include <binder/IInterface.h>
 #include <common/FlagManager.h>
 #include <common/trace.h>
@@ -164,12 +166,46 @@ void TransactionCallbackInvoker::addPresentFence(sp<Fence> presentFence) {
     mPresentFence = std::move(presentFence);
 }
 
-void TransactionCallbackInvoker::sendCallbacks(bool onCommitOnly) {
-    for (const auto& bufferRelease : mBufferReleases) {
-        bufferRelease.channel->writeReleaseFence(bufferRelease.callbackId, bufferRelease.fence,
-                                                 bufferRelease.currentMaxAcquiredBufferCount);
+void TransactionCallbackInvoker::addReleasedBuffer(const sp<ITransactionCompletedListener>& listener,
+                                                   ReleaseCallbackId callbackId,
+                                                   const sp<Fence>& releaseFence,
+                                                   uint32_t currentMaxAcquiredBufferCount) {
+    mReleasedBuffers[IInterface::asBinder(listener)].emplace_back(callbackId, releaseFence,
+                                                                  currentMaxAcquiredBufferCount);
+}
+
+void TransactionCallbackInvoker::addBufferRelease(
+        std::shared_ptr<gui::BufferReleaseChannel::ProducerEndpoint> channel,
+        ReleaseCallbackId callbackId, const sp<Fence>& releaseFence,
+        uint32_t currentMaxAcquiredBufferCount) {
+    mBufferReleases.emplace_back(std::move(channel), callbackId,
+                                 releaseFence ? releaseFence : Fence::NO_FENCE,
+                                 currentMaxAcquiredBufferCount);
+}
+
+void TransactionCallbackInvoker::sendBufferReleases() {
+    // Group the releases by channel, keeping their order, to write each channel's releases in as
+    // few socket messages as possible.
+    std::stable_sort(mBufferReleases.begin(), mBufferReleases.end(),
+                     [](const BufferRelease& lhs, const BufferRelease& rhs) {
+                         return lhs.channel.get() < rhs.channel.get();
+                     });
+
+    std::vector<gui::BufferReleaseChannel::Message> messages;
+    for (auto it = mBufferReleases.begin(); it != mBufferReleases.end();) {
+        const auto& channel = it->channel;
+        messages.clear();
+        for (; it != mBufferReleases.end() && it->channel == channel; ++it) {
+            messages.emplace_back(it->callbackId, it->fence ? it->fence : Fence::NO_FENCE,
+                                  it->currentMaxAcquiredBufferCount);
+        }
+        channel->writeReleaseFences(messages);
     }
     mBufferReleases.clear();
+}
+
+void TransactionCallbackInvoker::sendCallbacks(bool onCommitOnly) {
+    sendBufferReleases();
 
     // For each listener
     auto completedTransactionsItr = mCompletedTransactions.begin();
@@ -198,8 +234,14 @@ void TransactionCallbackInvoker::sendCallbacks(bool onCommitOnly) {
             listenerStats.transactionStats.push_back(std::move(transactionStats));
             transactionStatsItr = transactionStatsDeque.erase(transactionStatsItr);
         }
-        // If the listener has completed transactions
-        if (!listenerStats.transactionStats.empty()) {
+        // Released buffers are delivered with any callback, whether on commit or on present
+        if (const auto releasedBuffersItr = mReleasedBuffers.find(listener);
+            releasedBuffersItr != mReleasedBuffers.end()) {
+            listenerStats.releasedBuffers = std::move(releasedBuffersItr->second);
+            mReleasedBuffers.erase(releasedBuffersItr);
+        }
+        // If the listener has completed transactions or released buffers
+        if (!listenerStats.transactionStats.empty() || !listenerStats.releasedBuffers.empty()) {
             // If the listener is still alive
             if (listener->isBinderAlive()) {
                 // Send callback.  The listener stored in listenerStats
@@ -214,11 +256,26 @@ void TransactionCallbackInvoker::sendCallbacks(bool onCommitOnly) {
         completedTransactionsItr++;
     }
 
+    // Listeners that only have released buffers this frame
+    for (auto& [listener, releasedBuffers] : mReleasedBuffers) {
+        if (!listener->isBinderAlive()) {
+            continue;
+        }
+        ListenerStats listenerStats;
+        listenerStats.listener = listener;
+        listenerStats.releasedBuffers = std::move(releasedBuffers);
+        listenerStatsToSend.emplace_back(std::move(listenerStats));
+    }
+    mReleasedBuffers.clear();
+
     if (mPresentFence) {
         mPresentFence.clear();
     }
 
-    BackgroundExecutor::getInstance().sendCallbacks(
+    auto& executor = FlagManager::getInstance().background_executor_callback_lane()
+            ? BackgroundExecutor::getCallbackInstance()
+            : BackgroundExecutor::getInstance();
+    executor.sendCallbacks(
             {[listenerStatsToSend = std::move(listenerStatsToSend)]() {
                 SFTRACE_NAME("TransactionCallbackInvoker::sendCallbacks");
                 for (auto& stats : listenerStatsToSend) {
@@ -68,6 +68,18 @@ public:
 
     void addPresentFence(sp<Fence>);
 
+    // Queues the release of a buffer that was never presented, so that it is delivered to the
+    // listener with its next transaction callback instead of through a separate binder call.
+    void addReleasedBuffer(const sp<ITransactionCompletedListener>& listener,
+                           ReleaseCallbackId callbackId, const sp<Fence>& releaseFence,
+                           uint32_t currentMaxAcquiredBufferCount);
+
+    // Queues the release of a buffer to be written to its release channel along with the other
+    // releases to that channel, in a single socket message.
+    void addBufferRelease(std::shared_ptr<gui::BufferReleaseChannel::ProducerEndpoint> channel,
+                          ReleaseCallbackId callbackId, const sp<Fence>& releaseFence,
+                          uint32_t currentMaxAcquiredBufferCount);
+
     void sendCallbacks(bool onCommitOnly);
     void clearCompletedTransactions() {
         mCompletedTransactions.clear();
@@ -76,6 +88,8 @@ public:
     status_t addCallbackHandle(const sp<CallbackHandle>& handle);
 
 private:
+    void sendBufferReleases();
+
     status_t findOrCreateTransactionStats(const sp<IBinder>& listener,
                                           const std::vector<CallbackId>& callbackIds,
                                           TransactionStats** outTransactionStats);
@@ -91,6 +105,9 @@ private:
     };
     std::vector<BufferRelease> mBufferReleases;
 
+    std::unordered_map<sp<IBinder>, std::vector<ReleasedBufferStats>, IListenerHash>
+            mReleasedBuffers;
+
     sp<Fence> mPresentFence;
 };
 
@@ -17,6 +17,7 @@
 #include <android/gui/BnWindowInfosPublisher.h>
 #include <android/gui/IWindowInfosPublisher.h>
 #include <android/gui/WindowInfosListenerInfo.h>
+#include <common/FlagManager.h>
 #include <common/trace.h>
 #include <gui/ISurfaceComposer.h>
 #include <gui/WindowInfosUpdate.h>
@@ -34,6 +35,22 @@ using gui::DisplayInfo;
 using gui::IWindowInfosListener;
 using gui::WindowInfo;
 
+namespace {
+
+// WindowInfo::operator== does not compare every field that is sent to listeners.
+bool isSameWindowInfo(const WindowInfo& lhs, const WindowInfo& rhs) {
+    return lhs == rhs && lhs.windowToken == rhs.windowToken && lhs.alpha == rhs.alpha &&
+            lhs.touchableRegionCropHandle == rhs.touchableRegionCropHandle &&
+            lhs.focusTransferTarget == rhs.focusTransferTarget;
+}
+
+bool isSameDisplayInfo(const DisplayInfo& lhs, const DisplayInfo& rhs) {
+    return lhs.displayId == rhs.displayId && lhs.logicalWidth == rhs.logicalWidth &&
+            lhs.logicalHeight == rhs.logicalHeight && lhs.transform == rhs.transform;
+}
+
+} // namespace
+
 void WindowInfosListenerInvoker::addWindowInfosListener(sp<IWindowInfosListener> listener,
                                                         gui::WindowInfosListenerInfo* outInfo) {
     int64_t listenerId = mNextListenerId++;
@@ -47,6 +64,7 @@ void WindowInfosListenerInvoker::addWindowInfosListener(sp<IWindowInfosListener>
                 asBinder->linkToDeath(sp<DeathRecipient>::fromExisting(this));
                 mWindowInfosListeners.try_emplace(asBinder,
                                                   std::make_pair(listenerId, std::move(listener)));
+                mLastSentUpdate.reset();
             }});
 }
 
@@ -85,9 +103,49 @@ void WindowInfosListenerInvoker::eraseListenerAndAckMessages(const wp<IBinder>&
     }
 }
 
+bool WindowInfosListenerInvoker::skipUnchangedUpdate(
+        const gui::WindowInfosUpdate& update, WindowInfosReportedListenerSet& reportedListeners) {
+    if (!FlagManager::getInstance().skip_unchanged_window_infos() || !mLastSentUpdate ||
+        !std::equal(update.windowInfos.begin(), update.windowInfos.end(),
+                    mLastSentUpdate->windowInfos.begin(), mLastSentUpdate->windowInfos.end(),
+                    isSameWindowInfo) ||
+        !std::equal(update.displayInfos.begin(), update.displayInfos.end(),
+                    mLastSentUpdate->displayInfos.begin(), mLastSentUpdate->displayInfos.end(),
+                    isSameDisplayInfo)) {
+        return false;
+    }
+
+    SFTRACE_NAME("WindowInfosListenerInvoker::skipUnchangedUpdate");
+    mDebugInfo.skippedUnchangedUpdateCount++;
+
+    // Listeners already have, or are about to receive, the latest window infos, so an update that
+    // was delayed until they ack the last one is stale.
+    mDelayedUpdate.reset();
+    mDelayInfo.reset();
+    reportedListeners.merge(mReportedListeners);
+    mReportedListeners.clear();
+
+    if (const auto it = mUnackedState.find(mLastSentUpdate->vsyncId);
+        it != mUnackedState.end()) {
+        it->second.reportedListeners.merge(reportedListeners);
+        return true;
+    }
+
+    for (const auto& reportedListener : reportedListeners) {
+        if (IInterface::asBinder(reportedListener)->isBinderAlive()) {
+            reportedListener->onWindowInfosReported();
+        }
+    }
+    return true;
+}
+
 void WindowInfosListenerInvoker::windowInfosChanged(
         gui::WindowInfosUpdate update, WindowInfosReportedListenerSet reportedListeners,
         bool forceImmediateCall) {
+    if (skipUnchangedUpdate(update, reportedListeners)) {
+        return;
+    }
+
     if (!mDelayInfo) {
         mDelayInfo = DelayInfo{
                 .vsyncId = update.vsyncId,
@@ -141,6 +199,10 @@ void WindowInfosListenerInvoker::windowInfosChanged(
             ackWindowInfosReceived(update.vsyncId, listenerId);
         }
     }
+
+    if (FlagManager::getInstance().skip_unchanged_window_infos()) {
+        mLastSentUpdate = std::move(update);
+    }
 }
 
 WindowInfosListenerInvoker::DebugInfo WindowInfosListenerInvoker::getDebugInfo() {
@@ -52,6 +52,7 @@ public:
         VsyncId maxSendDelayVsyncId;
         nsecs_t maxSendDelayDuration;
         size_t pendingMessageCount;
+        size_t skippedUnchangedUpdateCount;
     };
     DebugInfo getDebugInfo();
 
@@ -69,13 +70,21 @@ private:
     WindowInfosReportedListenerSet mReportedListeners;
     void eraseListenerAndAckMessages(const wp<IBinder>&);
 
+    // The update most recently sent to all listeners, used to skip sending identical updates
+    // with FlagManager::skip_unchanged_window_infos. Reset when a listener is added, since the new
+    // listener has not received it.
+    std::optional<gui::WindowInfosUpdate> mLastSentUpdate;
+    // Returns true if the update was identical to mLastSentUpdate, in which case its reported
+    // listeners are called once the listeners have acked mLastSentUpdate.
+    bool skipUnchangedUpdate(const gui::WindowInfosUpdate&, WindowInfosReportedListenerSet&);
+
     struct UnackedState {
         ftl::SmallVector<int64_t, kStaticCapacity> unackedListenerIds;
         WindowInfosReportedListenerSet reportedListeners;
     };
     ftl::SmallMap<int64_t /* vsyncId */, UnackedState, 5> mUnackedState;
 
-    DebugInfo mDebugInfo;
+    DebugInfo mDebugInfo{};
     struct DelayInfo {
         int64_t vsyncId;
         nsecs_t frameTime;
@@ -157,6 +157,22 @@ void FlagManager::dump(std::string& result) const {
     DUMP_READ_ONLY_FLAG(single_hop_screenshot);
     DUMP_READ_ONLY_FLAG(trace_frame_rate_override);
     DUMP_READ_ONLY_FLAG(true_hdr_screenshots);
+    DUMP_READ_ONLY_FLAG(multithreaded_composition_state);
+    DUMP_READ_ONLY_FLAG(vsync_predictor_outlier_rejection);
+    DUMP_READ_ONLY_FLAG(cache_background_blur);
+    DUMP_READ_ONLY_FLAG(region_sampling_downscale);
+    DUMP_READ_ONLY_FLAG(skip_unchanged_window_infos);
+    DUMP_READ_ONLY_FLAG(layer_tracing_background_serialization);
+    DUMP_READ_ONLY_FLAG(layer_tracing_skip_unchanged_snapshots);
+    DUMP_READ_ONLY_FLAG(background_executor_callback_lane);
+    DUMP_READ_ONLY_FLAG(power_advisor_predictive_load_up);
+    DUMP_READ_ONLY_FLAG(transaction_callback_batched_releases);
+    DUMP_READ_ONLY_FLAG(flattened_layer_hierarchy);
+    DUMP_READ_ONLY_FLAG(follower_display_own_vsync_composite);
+    DUMP_READ_ONLY_FLAG(early_commit_preparation);
+    DUMP_READ_ONLY_FLAG(output_layer_geometry_cache);
+    DUMP_READ_ONLY_FLAG(output_occlusion_fast_path);
+    DUMP_READ_ONLY_FLAG(skip_noop_frame_present);
 
 #undef DUMP_READ_ONLY_FLAG
 #undef DUMP_SERVER_FLAG
@@ -262,6 +278,30 @@ FLAG_MANAGER_READ_ONLY_FLAG(flush_buffer_slots_to_uncache, "");
 FLAG_MANAGER_READ_ONLY_FLAG(force_compile_graphite_renderengine, "");
 FLAG_MANAGER_READ_ONLY_FLAG(single_hop_screenshot, "");
 FLAG_MANAGER_READ_ONLY_FLAG(true_hdr_screenshots, "debug.sf.true_hdr_screenshots");
+FLAG_MANAGER_READ_ONLY_FLAG(multithreaded_composition_state,
+                            "debug.sf.multithreaded_composition_state");
+FLAG_MANAGER_READ_ONLY_FLAG(vsync_predictor_outlier_rejection,
+                            "debug.sf.vsync_predictor_outlier_rejection");
+FLAG_MANAGER_READ_ONLY_FLAG(cache_background_blur, "debug.renderengine.cache_background_blur");
+FLAG_MANAGER_READ_ONLY_FLAG(region_sampling_downscale, "debug.sf.region_sampling_downscale");
+FLAG_MANAGER_READ_ONLY_FLAG(skip_unchanged_window_infos, "debug.sf.skip_unchanged_window_infos");
+FLAG_MANAGER_READ_ONLY_FLAG(layer_tracing_background_serialization,
+                            "debug.sf.layer_tracing_background_serialization");
+FLAG_MANAGER_READ_ONLY_FLAG(layer_tracing_skip_unchanged_snapshots,
+                            "debug.sf.layer_tracing_skip_unchanged_snapshots");
+FLAG_MANAGER_READ_ONLY_FLAG(background_executor_callback_lane,
+                            "debug.sf.background_executor_callback_lane");
+FLAG_MANAGER_READ_ONLY_FLAG(power_advisor_predictive_load_up,
+                            "debug.sf.power_advisor_predictive_load_up");
+FLAG_MANAGER_READ_ONLY_FLAG(transaction_callback_batched_releases,
+                            "debug.sf.transaction_callback_batched_releases");
+FLAG_MANAGER_READ_ONLY_FLAG(flattened_layer_hierarchy, "debug.sf.flattened_layer_hierarchy");
+FLAG_MANAGER_READ_ONLY_FLAG(follower_display_own_vsync_composite,
+                            "debug.sf.follower_display_own_vsync_composite");
+FLAG_MANAGER_READ_ONLY_FLAG(early_commit_preparation, "debug.sf.early_commit_preparation");
+FLAG_MANAGER_READ_ONLY_FLAG(output_layer_geometry_cache, "debug.sf.output_layer_geometry_cache");
+FLAG_MANAGER_READ_ONLY_FLAG(output_occlusion_fast_path, "debug.sf.output_occlusion_fast_path");
+FLAG_MANAGER_READ_ONLY_FLAG(skip_noop_frame_present, "debug.sf.skip_noop_frame_present");
 
 /// Trunk stable server flags ///
 FLAG_MANAGER_SERVER_FLAG(refresh_rate_overlay_on_external_display, "")
@@ -95,6 +95,22 @@ public:
     bool single_hop_screenshot() const;
     bool trace_frame_rate_override() const;
     bool true_hdr_screenshots() const;
+    bool skip_noop_frame_present() const;
+    bool output_occlusion_fast_path() const;
+    bool output_layer_geometry_cache() const;
+    bool early_commit_preparation() const;
+    bool follower_display_own_vsync_composite() const;
+    bool flattened_layer_hierarchy() const;
+    bool transaction_callback_batched_releases() const;
+    bool power_advisor_predictive_load_up() const;
+    bool background_executor_callback_lane() const;
+    bool layer_tracing_skip_unchanged_snapshots() const;
+    bool layer_tracing_background_serialization() const;
+    bool skip_unchanged_window_infos() const;
+    bool region_sampling_downscale() const;
+    bool cache_background_blur() const;
+    bool vsync_predictor_outlier_rejection() const;
+    bool multithreaded_composition_state() const;
 
 protected:
     // overridden for unit tests
@@ -308,6 +308,33 @@ TEST_F(ScreenCaptureTest, CaptureSingleLayer) {
     mCapture->expectBGColor(64, 64);
 }
 
+TEST_F(ScreenCaptureTest, CaptureLayersBatch) {
+    std::vector<LayerCaptureArgs> captureArgs(2);
+    captureArgs[0].layerHandle = mBGSurfaceControl->getHandle();
+    captureArgs[1].layerHandle = mFGSurfaceControl->getHandle();
+    const auto bgListener = sp<SyncScreenCaptureListener>::make();
+    const auto fgListener = sp<SyncScreenCaptureListener>::make();
+    const std::vector<sp<IScreenCaptureListener>> captureListeners = {bgListener, fgListener};
+    for (auto& args : captureArgs) {
+        args.captureArgs.dataspace = static_cast<int32_t>(ui::Dataspace::V0_SRGB);
+    }
+
+    SurfaceComposerClient::Transaction().apply(true);
+    ASSERT_EQ(NO_ERROR, ScreenshotClient::captureLayersBatch(captureArgs, captureListeners));
+
+    const auto bgResults = bgListener->waitForResults();
+    ASSERT_EQ(NO_ERROR, fenceStatus(bgResults.fenceResult));
+    ScreenCapture bgCapture(bgResults.buffer, bgResults.capturedHdrLayers);
+    bgCapture.expectBGColor(0, 0);
+    // Doesn't capture FG layer which is at 64, 64
+    bgCapture.expectBGColor(64, 64);
+
+    const auto fgResults = fgListener->waitForResults();
+    ASSERT_EQ(NO_ERROR, fenceStatus(fgResults.fenceResult));
+    ScreenCapture fgCapture(fgResults.buffer, fgResults.capturedHdrLayers);
+    fgCapture.expectFGColor(10, 10);
+}
+
 TEST_F(ScreenCaptureTest, CaptureLayerWithChild) {
     sp<SurfaceControl> child = createSurface(mClient, "Child surface", 10, 10,
                                              PIXEL_FORMAT_RGBA_8888, 0, mFGSurfaceControl.get());
@@ -673,6 +700,55 @@ TEST_F(ScreenCaptureTest, CaptureSize) {
     mCapture->checkPixel(30, 30, 0, 0, 0);
 }
 
+TEST_F(ScreenCaptureTest, CaptureIntoOutputBuffer) {
+    sp<SurfaceControl> redLayer =
+            createLayer(String8("Red surface"), 60, 60,
+                        ISurfaceComposerClient::eFXSurfaceBufferState);
+    ASSERT_NO_FATAL_FAILURE(fillBufferLayerColor(redLayer, Color::RED, 60, 60));
+    Transaction().show(redLayer).setLayer(redLayer, INT32_MAX - 1).apply(true);
+
+    // A downscaled buffer which the CPU reads from.
+    const sp<GraphicBuffer> outputBuffer =
+            sp<GraphicBuffer>::make(30, 30, PIXEL_FORMAT_RGBA_8888, 1,
+                                    GRALLOC_USAGE_HW_RENDER | GRALLOC_USAGE_SW_READ_OFTEN,
+                                    "CaptureIntoOutputBuffer");
+    ASSERT_EQ(NO_ERROR, outputBuffer->initCheck());
+
+    LayerCaptureArgs captureArgs;
+    captureArgs.layerHandle = redLayer->getHandle();
+    captureArgs.captureArgs.frameScaleX = 0.5f;
+    captureArgs.captureArgs.frameScaleY = 0.5f;
+    captureArgs.captureArgs.outputBuffer = gui::ScreenCaptureBuffer(outputBuffer);
+
+    ScreenCaptureResults captureResults;
+    ASSERT_EQ(NO_ERROR, ScreenCapture::captureLayers(captureArgs, captureResults));
+    ASSERT_NE(nullptr, captureResults.buffer);
+    EXPECT_EQ(outputBuffer->getId(), captureResults.buffer->getId());
+
+    ScreenCapture capture(outputBuffer, captureResults.capturedHdrLayers);
+    capture.expectColor(Rect(0, 0, 29, 29), Color::RED);
+}
+
+TEST_F(ScreenCaptureTest, CaptureIntoMismatchedOutputBufferFails) {
+    sp<SurfaceControl> redLayer = createLayer(String8("Red surface"), 60, 60);
+    ASSERT_NO_FATAL_FAILURE(fillBufferQueueLayerColor(redLayer, Color::RED, 60, 60));
+    Transaction().show(redLayer).setLayer(redLayer, INT32_MAX - 1).apply(true);
+
+    const sp<GraphicBuffer> outputBuffer =
+            sp<GraphicBuffer>::make(30, 30, PIXEL_FORMAT_RGBA_8888, 1,
+                                    GRALLOC_USAGE_HW_RENDER | GRALLOC_USAGE_SW_READ_OFTEN,
+                                    "CaptureIntoMismatchedOutputBufferFails");
+    ASSERT_EQ(NO_ERROR, outputBuffer->initCheck());
+
+    // The capture is 60x60, which does not fit the buffer.
+    LayerCaptureArgs captureArgs;
+    captureArgs.layerHandle = redLayer->getHandle();
+    captureArgs.captureArgs.outputBuffer = gui::ScreenCaptureBuffer(outputBuffer);
+
+    ScreenCaptureResults captureResults;
+    ASSERT_EQ(BAD_VALUE, ScreenCapture::captureLayers(captureArgs, captureResults));
+}
+
 TEST_F(ScreenCaptureTest, CaptureInvalidLayer) {
     LayerCaptureArgs args;
     args.layerHandle = sp<BBinder>::make();
@@ -0,0 +1,69 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <memory>
+
+#include <benchmark/benchmark.h>
+#include <gmock/gmock.h>
+
+#include <scheduler/Fps.h>
+#include <ui/FenceTime.h>
+
+#include "FrameTimeline/FrameTimeline.h"
+#include "mock/MockTimeStats.h"
+
+namespace android::frametimeline {
+
+namespace {
+
+// Simulates state.range(0) layers presenting a buffer on every frame of a 120 Hz display, once
+// the sliding window of DisplayFrames is full.
+static void presentFrames(benchmark::State& state) {
+    const auto layerCount = static_cast<int32_t>(state.range(0));
+    constexpr nsecs_t kPeriod = (120_Hz).getPeriodNsecs();
+
+    auto timeStats = std::make_shared<testing::NiceMock<mock::TimeStats>>();
+    impl::FrameTimeline frameTimeline(timeStats, /*surfaceFlingerPid=*/0);
+    auto* tokenManager = frameTimeline.getTokenManager();
+    FenceToFenceTimeMap fenceFactory;
+
+    nsecs_t now = 0;
+    for (auto _ : state) {
+        now += kPeriod;
+        const int64_t sfToken =
+                tokenManager->generateTokenForPredictions({now, now + kPeriod / 2, now + kPeriod});
+        frameTimeline.setSfWakeUp(sfToken, now, 120_Hz, 120_Hz);
+        for (int32_t layerId = 0; layerId < layerCount; layerId++) {
+            FrameTimelineInfo ftInfo;
+            ftInfo.vsyncId = sfToken;
+            auto surfaceFrame =
+                    frameTimeline.createSurfaceFrameForToken(ftInfo, /*ownerPid=*/0,
+                                                             /*ownerUid=*/0, layerId, "Layer",
+                                                             "Layer", /*isBuffer=*/true,
+                                                             GameMode::Unsupported);
+            surfaceFrame->setActualQueueTime(now - kPeriod);
+            surfaceFrame->setPresentState(SurfaceFrame::PresentState::Presented);
+            frameTimeline.addSurfaceFrame(std::move(surfaceFrame));
+        }
+        auto presentFence = fenceFactory.createFenceTimeForTest(Fence::NO_FENCE);
+        frameTimeline.setSfPresent(now + kPeriod / 2, presentFence);
+        presentFence->signalForTest(now + kPeriod);
+    }
+}
+BENCHMARK(presentFrames)->Arg(1)->Arg(10)->Arg(50);
+
+} // namespace
+} // namespace android::frametimeline
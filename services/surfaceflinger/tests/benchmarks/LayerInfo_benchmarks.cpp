@@ -0,0 +1,70 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <memory>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <scheduler/Fps.h>
+
+#include "Scheduler/LayerInfo.h"
+#include "Scheduler/RefreshRateSelector.h"
+#include "mock/DisplayHardware/MockDisplayMode.h"
+
+namespace android::scheduler {
+
+namespace {
+
+using android::mock::createDisplayMode;
+
+// Simulates state.range(0) layers posting 30 fps content to a display whose LayerHistory is
+// summarized at 120 Hz, so that most summaries see no new frame for a given layer.
+static void getRefreshRateVote(benchmark::State& state) {
+    const auto layerCount = static_cast<size_t>(state.range(0));
+    const RefreshRateSelector selector(makeModes(createDisplayMode(DisplayModeId(0), 60_Hz),
+                                                 createDisplayMode(DisplayModeId(1), 120_Hz)),
+                                       DisplayModeId(1));
+
+    std::vector<std::unique_ptr<LayerInfo>> layers;
+    for (size_t i = 0; i < layerCount; i++) {
+        layers.push_back(std::make_unique<LayerInfo>("Layer", /*ownerUid=*/0,
+                                                     LayerHistory::LayerVoteType::Heuristic));
+    }
+
+    constexpr nsecs_t kSummaryPeriod = (120_Hz).getPeriodNsecs();
+    constexpr int kSummariesPerFrame = 4;
+    const LayerProps props{.visible = true};
+
+    nsecs_t now = systemTime();
+    int summary = 0;
+    for (auto _ : state) {
+        now += kSummaryPeriod;
+        if (summary++ % kSummariesPerFrame == 0) {
+            for (auto& layer : layers) {
+                layer->setLastPresentTime(now, now, LayerHistory::LayerUpdateType::Buffer,
+                                          /*pendingModeChange=*/false, props);
+            }
+        }
+        for (auto& layer : layers) {
+            benchmark::DoNotOptimize(layer->getRefreshRateVote(selector, now));
+        }
+    }
+}
+BENCHMARK(getRefreshRateVote)->Arg(10)->Arg(100)->Arg(500);
+
+} // namespace
+} // namespace android::scheduler
@@ -90,5 +90,33 @@ static void updateClientStatesNoChanges(benchmark::State& state) {
 }
 BENCHMARK(updateClientStatesNoChanges);
 
+// Updates a single layer in a hierarchy of state.range(0) layers, where commitChanges should
+// only need to visit the layer that changed.
+static void updateClientStatesManyLayers(benchmark::State& state) {
+    const auto layerCount = static_cast<uint32_t>(state.range(0));
+    LayerLifecycleManager lifecycleManager;
+    std::vector<std::unique_ptr<RequestedLayerState>> layers;
+    for (uint32_t id = 1; id <= layerCount; id++) {
+        layers.emplace_back(LayerLifecycleManagerHelper::rootLayer(id));
+    }
+    lifecycleManager.addLayers(std::move(layers));
+    lifecycleManager.commitChanges();
+    std::vector<TransactionState> transactions;
+    transactions.emplace_back();
+    transactions.back().states.push_back({});
+    auto& transactionState = transactions.back().states.front();
+    transactionState.state.what = layer_state_t::eColorChanged;
+    transactionState.state.color.rgb = {0.f, 0.f, 0.f};
+    transactionState.layerId = 1;
+    int i = 0;
+    for (auto _ : state) {
+        if (i++ % 100 == 0) i = 0;
+        transactionState.state.color.b = static_cast<float>(i / 100.f);
+        lifecycleManager.applyTransactions(transactions);
+        lifecycleManager.commitChanges();
+    }
+}
+BENCHMARK(updateClientStatesManyLayers)->Arg(10)->Arg(500)->Arg(1000);
+
 } // namespace
 } // namespace android::surfaceflinger
@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <memory>
+
+#include <benchmark/benchmark.h>
+
+#include <FrontEnd/LayerHierarchy.h>
+#include <FrontEnd/LayerLifecycleManager.h>
+#include <FrontEnd/LayerSnapshotBuilder.h>
+#include <LayerLifecycleManagerHelper.h>
+
+namespace android::surfaceflinger {
+
+namespace {
+
+using namespace android::surfaceflinger::frontend;
+
+// Builds a scene with state.range(0) root windows, each with a chain of state.range(1) children,
+// and repeatedly moves the deepest child of the first window.
+static void updateDeepChildGeometry(benchmark::State& state, bool updateDirtySubtreesOnly) {
+    LayerLifecycleManager lifecycleManager;
+    LayerLifecycleManagerHelper helper(lifecycleManager);
+    LayerHierarchyBuilder hierarchyBuilder;
+    DisplayInfos displayInfos;
+    ShadowSettings globalShadowSettings;
+
+    const uint32_t numWindows = static_cast<uint32_t>(state.range(0));
+    const uint32_t depth = static_cast<uint32_t>(state.range(1));
+    uint32_t id = 1;
+    uint32_t deepestChildId = UNASSIGNED_LAYER_ID;
+    for (uint32_t window = 0; window < numWindows; window++) {
+        uint32_t parentId = id++;
+        helper.createRootLayer(parentId);
+        helper.setColor(parentId);
+        for (uint32_t i = 0; i < depth; i++) {
+            uint32_t childId = id++;
+            helper.createLayer(childId, parentId);
+            helper.setColor(childId);
+            parentId = childId;
+        }
+        if (deepestChildId == UNASSIGNED_LAYER_ID) deepestChildId = parentId;
+    }
+    hierarchyBuilder.update(lifecycleManager);
+
+    LayerSnapshotBuilder::Args args{.root = hierarchyBuilder.getHierarchy(),
+                                    .layerLifecycleManager = lifecycleManager,
+                                    .includeMetadata = false,
+                                    .displays = displayInfos,
+                                    .globalShadowSettings = globalShadowSettings,
+                                    .supportsBlur = true,
+                                    .supportedLayerGenericMetadata = {},
+                                    .genericLayerMetadataKeyMap = {},
+                                    .updateDirtySubtreesOnly = updateDirtySubtreesOnly};
+    LayerSnapshotBuilder snapshotBuilder(args);
+    lifecycleManager.commitChanges();
+
+    float position = 0.f;
+    for (auto _ : state) {
+        position = position > 100.f ? 0.f : position + 1.f;
+        helper.setPosition(deepestChildId, position, position);
+        snapshotBuilder.update(args);
+        lifecycleManager.commitChanges();
+    }
+}
+
+static void updateDeepChildGeometryFullWalk(benchmark::State& state) {
+    updateDeepChildGeometry(state, /*updateDirtySubtreesOnly=*/false);
+}
+BENCHMARK(updateDeepChildGeometryFullWalk)->Args({10, 10})->Args({50, 10})->Args({100, 5});
+
+static void updateDeepChildGeometryDirtySubtreesOnly(benchmark::State& state) {
+    updateDeepChildGeometry(state, /*updateDirtySubtreesOnly=*/true);
+}
+BENCHMARK(updateDeepChildGeometryDirtySubtreesOnly)->Args({10, 10})->Args({50, 10})->Args({100, 5});
+
+} // namespace
+} // namespace android::surfaceflinger
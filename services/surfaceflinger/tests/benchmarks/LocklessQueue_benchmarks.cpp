@@ -16,6 +16,8 @@
 
 #include <memory>
 #include <optional>
+#include <thread>
+#include <vector>
 
 #include <benchmark/benchmark.h>
 
@@ -34,5 +36,37 @@ static void pushPop(benchmark::State& state) {
 }
 BENCHMARK(pushPop);
 
+// state.range(0) producer threads each push kItemsPerProducer items while the benchmark thread
+// drains the queue, the way binder threads feed TransactionHandler.
+static void multiProducerPushPop(benchmark::State& state) {
+    constexpr size_t kItemsPerProducer = 1000;
+    const auto producers = static_cast<size_t>(state.range(0));
+    LocklessQueue<std::vector<uint32_t>> queue;
+    for (auto _ : state) {
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < producers; i++) {
+            threads.emplace_back([&queue] {
+                for (size_t j = 0; j < kItemsPerProducer; j++) {
+                    queue.push({10, 5});
+                }
+            });
+        }
+        size_t popped = 0;
+        while (popped < producers * kItemsPerProducer) {
+            std::optional<std::vector<uint32_t>> value = queue.pop();
+            if (value) {
+                benchmark::DoNotOptimize(*value);
+                popped++;
+            }
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * producers *
+                                                 kItemsPerProducer));
+}
+BENCHMARK(multiProducerPushPop)->RangeMultiplier(2)->Range(1, 32)->UseRealTime();
+
 } // namespace
 } // namespace android::surfaceflinger
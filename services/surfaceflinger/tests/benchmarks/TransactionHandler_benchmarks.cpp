@@ -0,0 +1,85 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <binder/Binder.h>
+#include <FrontEnd/TransactionHandler.h>
+
+namespace android::surfaceflinger {
+
+namespace {
+
+using namespace android::surfaceflinger::frontend;
+using TransactionReadiness = TransactionHandler::TransactionReadiness;
+
+// Synthetic transaction ids encode how the filter below treats them.
+constexpr uint64_t kNotReadyIdBase = 1ull << 40;
+constexpr uint64_t kBarrierId = 1ull << 41;
+
+TransactionState makeTransaction(const sp<IBinder>& applyToken, uint64_t id) {
+    TransactionState transaction;
+    transaction.applyToken = applyToken;
+    transaction.id = id;
+    return transaction;
+}
+
+// Simulates a frame's worth of BLAST traffic: state.range(0) apps post a ready transaction
+// each, while state.range(1) other apps stay blocked on a fence, and one app waits on a
+// barrier that is never satisfied.
+static void flushTransactions(benchmark::State& state) {
+    const auto readyQueues = static_cast<size_t>(state.range(0));
+    const auto blockedQueues = static_cast<size_t>(state.range(1));
+
+    TransactionHandler handler;
+    size_t filterCalls = 0;
+    handler.addTransactionReadyFilter([&](const TransactionHandler::TransactionFlushState& flush) {
+        filterCalls++;
+        const uint64_t id = flush.transaction->id;
+        if (id == kBarrierId) return TransactionReadiness::NotReadyBarrier;
+        if (id >= kNotReadyIdBase) return TransactionReadiness::NotReady;
+        return TransactionReadiness::Ready;
+    });
+
+    for (size_t i = 0; i < blockedQueues; i++) {
+        handler.queueTransaction(makeTransaction(sp<BBinder>::make(), kNotReadyIdBase + i));
+    }
+    handler.queueTransaction(makeTransaction(sp<BBinder>::make(), kBarrierId));
+
+    std::vector<sp<IBinder>> readyTokens;
+    for (size_t i = 0; i < readyQueues; i++) {
+        readyTokens.push_back(sp<BBinder>::make());
+    }
+
+    uint64_t nextId = 0;
+    for (auto _ : state) {
+        for (const auto& token : readyTokens) {
+            handler.queueTransaction(makeTransaction(token, nextId++));
+        }
+        handler.collectTransactions();
+        std::vector<TransactionState> transactions = handler.flushTransactions();
+        benchmark::DoNotOptimize(transactions);
+    }
+    state.counters["filterCallsPerFlush"] =
+            benchmark::Counter(static_cast<double>(filterCalls) /
+                               static_cast<double>(state.iterations()));
+}
+BENCHMARK(flushTransactions)->ArgsProduct({{1, 8, 32}, {0, 8, 32}});
+
+} // namespace
+} // namespace android::surfaceflinger
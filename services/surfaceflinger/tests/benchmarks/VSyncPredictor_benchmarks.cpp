@@ -0,0 +1,97 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <scheduler/Fps.h>
+#include <scheduler/TimeKeeper.h>
+
+#include "Scheduler/VSyncPredictor.h"
+#include "mock/DisplayHardware/MockDisplayMode.h"
+
+namespace android::scheduler {
+
+namespace {
+
+using android::mock::createDisplayMode;
+
+class ReplayClock : public Clock {
+public:
+    nsecs_t now() const override { return mNow; }
+    void setNow(nsecs_t now) { mNow = now; }
+
+private:
+    nsecs_t mNow = 0;
+};
+
+// Matches the configuration used by VsyncSchedule.
+constexpr size_t kHistorySize = 20;
+constexpr size_t kMinSamplesForPrediction = 6;
+constexpr uint32_t kDiscardOutlierPercent = 20;
+
+// A 60 Hz HWC vsync trace with Gaussian jitter, where one timestamp in state.range(0) is late by a
+// sizable fraction of the period, as observed on some panels around mode switches.
+std::vector<nsecs_t> makeVsyncTrace(size_t count, nsecs_t period, int64_t outlierInterval) {
+    std::mt19937 generator(42);
+    std::normal_distribution<double> jitter(0.0, 50'000.0);
+    std::vector<nsecs_t> trace(count);
+    for (size_t i = 0; i < count; i++) {
+        trace[i] = static_cast<nsecs_t>(i) * period + static_cast<nsecs_t>(jitter(generator));
+        if (outlierInterval > 0 && i % static_cast<size_t>(outlierInterval) == 0) {
+            trace[i] += period / 6;
+        }
+    }
+    return trace;
+}
+
+// Replays a vsync trace through VSyncPredictor and reports how far each prediction of the next
+// vsync was from the timestamp HWC reported. Run with debug.sf.vsync_predictor_outlier_rejection
+// set to compare against the outlier rejecting fit.
+static void replayVsyncTrace(benchmark::State& state) {
+    constexpr nsecs_t kPeriod = (60_Hz).getPeriodNsecs();
+    const auto trace = makeVsyncTrace(600, kPeriod, state.range(0));
+
+    double totalErrorUs = 0;
+    size_t predictions = 0;
+    for (auto _ : state) {
+        auto clock = std::make_unique<ReplayClock>();
+        ReplayClock& clockRef = *clock;
+        VSyncPredictor predictor(std::move(clock),
+                                 ftl::as_non_null(createDisplayMode(DisplayModeId(0), 60_Hz)),
+                                 kHistorySize, kMinSamplesForPrediction, kDiscardOutlierPercent);
+
+        for (size_t i = 0; i + 1 < trace.size(); i++) {
+            clockRef.setNow(trace[i]);
+            predictor.addVsyncTimestamp(trace[i]);
+            if (i < kHistorySize) continue;
+
+            const nsecs_t prediction = predictor.nextAnticipatedVSyncTimeFrom(trace[i] + 1);
+            totalErrorUs += static_cast<double>(std::abs(prediction - trace[i + 1])) / 1000.0;
+            predictions++;
+        }
+    }
+    state.counters["meanPredictionErrorUs"] =
+            benchmark::Counter(totalErrorUs / static_cast<double>(predictions));
+}
+BENCHMARK(replayVsyncTrace)->Arg(0)->Arg(30)->Arg(10);
+
+} // namespace
+} // namespace android::scheduler
@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include <condition_variable>
+#include <future>
 
 #include "BackgroundExecutor.h"
 
@@ -52,6 +53,33 @@ TEST_F(BackgroundExecutorTest, multipleProducers) {
     ASSERT_EQ(backgroundTaskCount, backgroundTaskCompleteCount);
 }
 
+TEST_F(BackgroundExecutorTest, callbackLaneDoesNotWaitOnOtherLanes) {
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    BackgroundExecutor::getInstance().sendCallbacks({[released]() { released.wait(); }});
+
+    std::promise<void> callbackRan;
+    BackgroundExecutor::getCallbackInstance().sendCallbacks(
+            {[&callbackRan]() { callbackRan.set_value(); }});
+    EXPECT_EQ(std::future_status::ready,
+              callbackRan.get_future().wait_for(std::chrono::seconds(5)));
+
+    release.set_value();
+    BackgroundExecutor::getInstance().flushQueue();
+}
+
+TEST_F(BackgroundExecutorTest, dumpReportsExecutedBatches) {
+    auto& executor = BackgroundExecutor::getLowPriorityInstance();
+    executor.sendCallbacks({[]() {}, []() {}});
+    executor.flushQueue();
+
+    std::string result;
+    executor.dump(result);
+    EXPECT_NE(result.find("BckgrndExec LP: queued=0 "), std::string::npos) << result;
+    EXPECT_NE(result.find(" executed="), std::string::npos) << result;
+    EXPECT_EQ(result.find(" executed=0 "), std::string::npos) << result;
+}
+
 } // namespace
 
 } // namespace android
@@ -0,0 +1,113 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <binder/Binder.h>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <renderengine/mock/RenderEngine.h>
+
+#include <thread>
+#include <vector>
+
+#include "ClientCache.h"
+
+namespace android {
+
+using testing::HasSubstr;
+using testing::NiceMock;
+
+class ClientCacheTest : public testing::Test {
+protected:
+    ClientCacheTest() {
+        // The cache is a process-wide singleton and its textures keep a reference to the
+        // RenderEngine, so the mock must outlive every test.
+        static auto* renderEngine = new NiceMock<renderengine::mock::RenderEngine>();
+        ClientCache::getInstance().setRenderEngine(renderEngine);
+    }
+
+    ~ClientCacheTest() override {
+        for (const auto& token : mTokens) {
+            ClientCache::getInstance().removeProcess(token);
+        }
+    }
+
+    sp<IBinder> makeProcessToken() { return mTokens.emplace_back(sp<BBinder>::make()); }
+
+    std::vector<sp<IBinder>> mTokens;
+};
+
+TEST_F(ClientCacheTest, keepsBuffersOfProcessesApart) {
+    const auto token1 = makeProcessToken();
+    const auto token2 = makeProcessToken();
+    const auto buffer1 = sp<GraphicBuffer>::make();
+    const auto buffer2 = sp<GraphicBuffer>::make();
+
+    ClientCache& cache = ClientCache::getInstance();
+    ASSERT_TRUE(cache.add({token1, 1}, buffer1).has_value());
+    ASSERT_TRUE(cache.add({token2, 1}, buffer2).has_value());
+
+    ASSERT_NE(cache.get({token1, 1}), nullptr);
+    EXPECT_EQ(cache.get({token1, 1})->getBuffer(), buffer1);
+    ASSERT_NE(cache.get({token2, 1}), nullptr);
+    EXPECT_EQ(cache.get({token2, 1})->getBuffer(), buffer2);
+
+    EXPECT_EQ(cache.erase({token1, 1}), buffer1);
+    EXPECT_EQ(cache.get({token1, 1}), nullptr);
+    EXPECT_NE(cache.get({token2, 1}), nullptr);
+
+    cache.removeProcess(token2);
+    EXPECT_EQ(cache.get({token2, 1}), nullptr);
+}
+
+TEST_F(ClientCacheTest, concurrentAccessFromManyProcesses) {
+    constexpr size_t kThreadCount = 8;
+    constexpr uint64_t kBufferCount = 64;
+
+    std::vector<sp<IBinder>> tokens;
+    for (size_t i = 0; i < kThreadCount; i++) {
+        tokens.push_back(makeProcessToken());
+    }
+
+    ClientCache& cache = ClientCache::getInstance();
+    std::vector<std::thread> threads;
+    for (const auto& token : tokens) {
+        threads.emplace_back([&cache, token] {
+            for (uint64_t id = 0; id < kBufferCount; id++) {
+                const auto buffer = sp<GraphicBuffer>::make();
+                ASSERT_TRUE(cache.add({token, id}, buffer).has_value());
+                ASSERT_NE(cache.get({token, id}), nullptr);
+                if (id % 2 == 0) {
+                    EXPECT_EQ(cache.erase({token, id}), buffer);
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (const auto& token : tokens) {
+        for (uint64_t id = 0; id < kBufferCount; id++) {
+            EXPECT_EQ(cache.get({token, id}) != nullptr, id % 2 == 1);
+        }
+    }
+
+    std::string dump;
+    cache.dump(dump);
+    EXPECT_THAT(dump, HasSubstr("Lock contention:"));
+}
+
+} // namespace android
@@ -0,0 +1,72 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#undef LOG_TAG
+#define LOG_TAG "ContentDiffSamplerTest"
+
+#include <gtest/gtest.h>
+
+#include "Scheduler/ContentDiffSampler.h"
+
+namespace android::scheduler {
+
+class ContentDiffSamplerTest : public testing::Test {
+protected:
+    static constexpr int32_t kWidth = 160;
+    static constexpr int32_t kHeight = 320;
+    static constexpr int32_t kStride = 192;
+    static constexpr int32_t kBytesPerPixel = 4;
+
+    std::optional<float> sample() {
+        return mSampler.sample(mPixels.data(), kWidth, kHeight, kStride, kBytesPerPixel);
+    }
+
+    ContentDiffSampler mSampler;
+    std::vector<uint8_t> mPixels = std::vector<uint8_t>(kStride * kHeight * kBytesPerPixel, 0);
+};
+
+namespace {
+TEST_F(ContentDiffSamplerTest, firstBufferIsNotComparable) {
+    EXPECT_EQ(sample(), std::nullopt);
+}
+
+TEST_F(ContentDiffSamplerTest, unchangedContent) {
+    sample();
+    EXPECT_EQ(sample(), 0.f);
+}
+
+TEST_F(ContentDiffSamplerTest, smallChange) {
+    sample();
+    // Change one pixel of a sampled row, which is in a single 10x20 tile.
+    mPixels[(4 * kStride + 15) * kBytesPerPixel] = 0xff;
+    EXPECT_FLOAT_EQ(sample().value(), 1.f / (ContentDiffSampler::kTilesPerSide *
+                                             ContentDiffSampler::kTilesPerSide));
+}
+
+TEST_F(ContentDiffSamplerTest, fullChange) {
+    sample();
+    std::fill(mPixels.begin(), mPixels.end(), 0xff);
+    EXPECT_FLOAT_EQ(sample().value(), 1.f);
+}
+
+TEST_F(ContentDiffSamplerTest, sizeChangeIsNotComparable) {
+    sample();
+    EXPECT_EQ(mSampler.sample(mPixels.data(), kWidth / 2, kHeight, kStride, kBytesPerPixel),
+              std::nullopt);
+}
+
+} // namespace
+} // namespace android::scheduler
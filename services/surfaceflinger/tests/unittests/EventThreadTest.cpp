@@ -692,6 +692,38 @@ TEST_F(EventThreadTest, eventsDroppedIfNonfatalEventDeliveryError) {
     expectVSyncCallbackScheduleReceived(true);
 }
 
+TEST_F(EventThreadTest, connectionCanRequestVsyncWhileEventIsPosted) {
+    setupEventThread();
+
+    ConnectionEventRecorder reentrantConnectionEventRecorder{0};
+    sp<MockEventThreadConnection> reentrantConnection =
+            createConnection(reentrantConnectionEventRecorder);
+    const wp<EventThreadConnection> weakConnection = reentrantConnection;
+    EXPECT_CALL(*reentrantConnection, postEvent(_))
+            .WillRepeatedly([&, weakConnection](const DisplayEventReceiver::Event& event) {
+                // Events are posted without holding the EventThread lock, so the connection may
+                // call back into the EventThread.
+                if (const auto connection = weakConnection.promote()) {
+                    mThread->requestNextVsync(connection);
+                }
+                return reentrantConnectionEventRecorder.getInvocable()(event);
+            });
+    mThread->requestNextVsync(reentrantConnection);
+
+    expectVSyncCallbackScheduleReceived(true);
+
+    onVSyncEvent(123, 456, 789);
+    expectVsyncEventReceivedByConnection("reentrantConnection", reentrantConnectionEventRecorder,
+                                         123, 1u);
+
+    // The request made while posting keeps vsync callbacks enabled.
+    expectVSyncCallbackScheduleReceived(true);
+
+    onVSyncEvent(456, 123, 0);
+    expectVsyncEventReceivedByConnection("reentrantConnection", reentrantConnectionEventRecorder,
+                                         456, 2u);
+}
+
 TEST_F(EventThreadTest, setPhaseOffsetForwardsToVSyncSource) {
     setupEventThread();
 
@@ -161,6 +161,11 @@ public:
         return mFrameTimeline->mDisplayFrames[idx];
     }
 
+    impl::FrameTimeline::DisplayFrame* getCurrentDisplayFrame() {
+        std::lock_guard<std::mutex> lock(mFrameTimeline->mMutex);
+        return mFrameTimeline->mCurrentDisplayFrame.get();
+    }
+
     static bool compareTimelineItems(const TimelineItem& a, const TimelineItem& b) {
         return a.startTime == b.startTime && a.endTime == b.endTime &&
                 a.presentTime == b.presentTime;
@@ -471,6 +476,90 @@ TEST_F(FrameTimelineTest, displayFramesSlidingWindowMovesAfterLimit) {
     EXPECT_EQ(getLayerOneJankData().size(), *maxDisplayFrames);
 }
 
+TEST_F(FrameTimelineTest, evictedDisplayFrameIsRecycled) {
+    *maxDisplayFrames = 2;
+
+    int frameTimeFactor = 0;
+    const auto presentFrame = [&] {
+        auto presentFence = fenceFactory.createFenceTimeForTest(Fence::NO_FENCE);
+        int64_t sfToken = mTokenManager->generateTokenForPredictions(
+                {22 + frameTimeFactor, 26 + frameTimeFactor, 30 + frameTimeFactor});
+        mFrameTimeline->setSfWakeUp(sfToken, 22 + frameTimeFactor, RR_11, RR_11);
+        auto surfaceFrame =
+                mFrameTimeline->createSurfaceFrameForToken({}, sPidOne, sUidOne, sLayerIdOne,
+                                                           sLayerNameOne, sLayerNameOne,
+                                                           /*isBuffer*/ true, sGameMode);
+        surfaceFrame->setPresentState(SurfaceFrame::PresentState::Presented);
+        mFrameTimeline->addSurfaceFrame(surfaceFrame);
+        mFrameTimeline->setSfPresent(27 + frameTimeFactor, presentFence);
+        presentFence->signalForTest(32 + frameTimeFactor);
+        frameTimeFactor += 30;
+    };
+
+    presentFrame();
+    presentFrame();
+    const impl::FrameTimeline::DisplayFrame* const oldestFrame = getDisplayFrame(0).get();
+
+    // The oldest frame is evicted when the third frame is finalized, and becomes the frame that
+    // tracks the next vsync.
+    presentFrame();
+    EXPECT_EQ(getNumberOfDisplayFrames(), 2u);
+    auto* currentFrame = getCurrentDisplayFrame();
+    EXPECT_EQ(currentFrame, oldestFrame);
+    EXPECT_TRUE(currentFrame->getSurfaceFrames().empty());
+    EXPECT_TRUE(compareTimelineItems(currentFrame->getActuals(), TimelineItem()));
+    EXPECT_TRUE(compareTimelineItems(currentFrame->getPredictions(), TimelineItem()));
+    EXPECT_EQ(currentFrame->getJankType(), JankType::None);
+    EXPECT_EQ(currentFrame->getFramePresentMetadata(), FramePresentMetadata::UnknownPresent);
+}
+
+TEST_F(FrameTimelineTest, latencyHistogramPercentiles) {
+    LatencyHistogram histogram;
+    for (int i = 0; i < 98; i++) {
+        histogram.insert(std::chrono::nanoseconds(3ms).count());
+    }
+    histogram.insert(std::chrono::nanoseconds(-5ms).count());
+    histogram.insert(std::chrono::nanoseconds(200ms).count());
+
+    EXPECT_EQ(histogram.count(), 100u);
+    EXPECT_EQ(histogram.percentileUpperBoundMs(1), -4);
+    EXPECT_EQ(histogram.percentileUpperBoundMs(50), 4);
+    EXPECT_EQ(histogram.percentileUpperBoundMs(99), 4);
+    EXPECT_EQ(histogram.percentileUpperBoundMs(100), std::nullopt);
+}
+
+TEST_F(FrameTimelineTest, presentedFramesAreAddedToAppLatencyHistograms) {
+    auto presentFence = fenceFactory.createFenceTimeForTest(Fence::NO_FENCE);
+    int64_t surfaceFrameToken = mTokenManager->generateTokenForPredictions({10, 20, 30});
+    int64_t sfToken = mTokenManager->generateTokenForPredictions({22, 26, 30});
+    FrameTimelineInfo ftInfo;
+    ftInfo.vsyncId = surfaceFrameToken;
+    ftInfo.inputEventId = sInputEventId;
+    auto surfaceFrame =
+            mFrameTimeline->createSurfaceFrameForToken(ftInfo, sPidOne, sUidOne, sLayerIdOne,
+                                                       sLayerNameOne, sLayerNameOne,
+                                                       /*isBuffer*/ true, sGameMode);
+    mFrameTimeline->setSfWakeUp(sfToken, 22, RR_11, RR_11);
+    surfaceFrame->setPresentState(SurfaceFrame::PresentState::Presented);
+    mFrameTimeline->addSurfaceFrame(surfaceFrame);
+    mFrameTimeline->setSfPresent(27, presentFence);
+    presentFence->signalForTest(30);
+    addEmptyDisplayFrame();
+
+    Vector<String16> args;
+    args.add(String16("-histogram"));
+    std::string result;
+    mFrameTimeline->parseArgs(args, result);
+    EXPECT_NE(result.find("uid " + std::to_string(sUidOne) + "\n"), std::string::npos) << result;
+    EXPECT_NE(result.find("Present delta: count=1 "), std::string::npos) << result;
+    EXPECT_EQ(result.find("GPU composition"), std::string::npos) << result;
+
+    mFrameTimeline->reset();
+    result.clear();
+    mFrameTimeline->parseArgs(args, result);
+    EXPECT_EQ(result.find("uid "), std::string::npos) << result;
+}
+
 TEST_F(FrameTimelineTest, surfaceFrameEndTimeAcquireFenceAfterQueue) {
     auto surfaceFrame = mFrameTimeline->createSurfaceFrameForToken({}, sPidOne, 0, sLayerIdOne,
                                                                    "acquireFenceAfterQueue",
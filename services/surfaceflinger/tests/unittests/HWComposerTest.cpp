@@ -598,4 +598,36 @@ TEST_F(HWComposerLayerGenericMetadataTest, forwardsSupportedMetadata) {
     EXPECT_EQ(hal::Error::UNSUPPORTED, result);
 }
 
+struct HWComposerLayerStateTest : public HWComposerLayerTest {
+    HWComposerLayerStateTest() : HWComposerLayerTest({}) {}
+};
+
+TEST_F(HWComposerLayerStateTest, suppressesUnchangedState) {
+    const uint64_t suppressedCount = HWC2::impl::Layer::getSuppressedCommandCount();
+
+    EXPECT_CALL(*mHal, setLayerZOrder(kDisplayId, kLayerId, 1u))
+            .WillOnce(Return(V2_4::Error::NONE));
+    EXPECT_CALL(*mHal, setLayerPlaneAlpha(kDisplayId, kLayerId, 0.5f))
+            .WillOnce(Return(V2_4::Error::NONE));
+    EXPECT_EQ(hal::Error::NONE, mLayer.setZOrder(1u));
+    EXPECT_EQ(hal::Error::NONE, mLayer.setPlaneAlpha(0.5f));
+
+    // Unchanged values are not sent again.
+    EXPECT_EQ(hal::Error::NONE, mLayer.setZOrder(1u));
+    EXPECT_EQ(hal::Error::NONE, mLayer.setPlaneAlpha(0.5f));
+    EXPECT_EQ(suppressedCount + 2, HWC2::impl::Layer::getSuppressedCommandCount());
+
+    EXPECT_CALL(*mHal, setLayerZOrder(kDisplayId, kLayerId, 2u))
+            .WillOnce(Return(V2_4::Error::NONE));
+    EXPECT_EQ(hal::Error::NONE, mLayer.setZOrder(2u));
+}
+
+TEST_F(HWComposerLayerStateTest, resendsStateAfterError) {
+    EXPECT_CALL(*mHal, setLayerZOrder(kDisplayId, kLayerId, 1u))
+            .WillOnce(Return(V2_4::Error::BAD_LAYER))
+            .WillOnce(Return(V2_4::Error::NONE));
+    EXPECT_EQ(hal::Error::BAD_LAYER, mLayer.setZOrder(1u));
+    EXPECT_EQ(hal::Error::NONE, mLayer.setZOrder(1u));
+}
+
 } // namespace android
@@ -17,10 +17,14 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <common/test/FlagUtils.h>
+
 #include "FrontEnd/LayerHierarchy.h"
 #include "FrontEnd/LayerLifecycleManager.h"
 #include "LayerHierarchyTest.h"
 
+#include <com_android_graphics_surfaceflinger_flags.h>
+
 #define UPDATE_AND_VERIFY(HIERARCHY)  \
     ({                                \
         SCOPED_TRACE("");             \
@@ -29,6 +33,8 @@
 
 namespace android::surfaceflinger::frontend {
 
+using namespace com::android::graphics::surfaceflinger;
+
 // To run test:
 /**
  mp :libsurfaceflinger_unittest && adb sync; adb shell \
@@ -608,6 +614,16 @@ TEST_F(LayerHierarchyTest, traversalPathId) {
     hierarchyBuilder.getHierarchy().traverseInZOrder(checkTraversalPathIdVisitor);
 }
 
+TEST_F(LayerHierarchyTest, traversalPathHashDependsOnMirrorRootOrder) {
+    LayerHierarchy::TraversalPathHash hash;
+    LayerHierarchy::TraversalPath path{.id = 111, .mirrorRootIds = {3u, 14u}};
+    LayerHierarchy::TraversalPath reversed{.id = 111, .mirrorRootIds = {14u, 3u}};
+    LayerHierarchy::TraversalPath swapped{.id = 3, .mirrorRootIds = {111u}};
+    LayerHierarchy::TraversalPath original{.id = 111, .mirrorRootIds = {3u}};
+    EXPECT_NE(hash(path), hash(reversed));
+    EXPECT_NE(hash(swapped), hash(original));
+}
+
 TEST_F(LayerHierarchyTest, zorderRespectsLayerSequenceId) {
     // remove default hierarchy
     mLifecycleManager = LayerLifecycleManager();
@@ -801,4 +817,84 @@ TEST_F(LayerHierarchyTest, cleanUpDanglingMirrorLayer) {
     EXPECT_EQ(getTraversalPath(hierarchyBuilder.getOffscreenHierarchy()), expectedTraversalPath);
 }
 
+TEST_F(LayerHierarchyTest, flattenedTraversalMatchesRecursiveTraversal) {
+    SET_FLAG_FOR_TEST(flags::flattened_layer_hierarchy, true);
+    LayerHierarchyBuilder hierarchyBuilder;
+    hierarchyBuilder.update(mLifecycleManager);
+
+    auto getTraversalPaths = [](const LayerHierarchy& hierarchy, bool zOrder) {
+        std::vector<LayerHierarchy::TraversalPath> paths;
+        auto visitor = [&paths](const LayerHierarchy&,
+                                const LayerHierarchy::TraversalPath& traversalPath) -> bool {
+            paths.emplace_back(traversalPath);
+            return true;
+        };
+        if (zOrder) {
+            hierarchy.traverseInZOrder(visitor);
+        } else {
+            hierarchy.traverse(visitor);
+        }
+        return paths;
+    };
+    // A partial hierarchy is never flattened, so it walks the graph recursively.
+    auto expectMatchesRecursiveTraversal = [&]() {
+        LayerHierarchy recursive =
+                hierarchyBuilder.getPartialHierarchy(1, /*childrenOnly=*/false);
+        for (bool zOrder : {false, true}) {
+            std::vector<LayerHierarchy::TraversalPath> flattened =
+                    getTraversalPaths(hierarchyBuilder.getHierarchy(), zOrder);
+            std::vector<LayerHierarchy::TraversalPath> expected =
+                    getTraversalPaths(recursive, zOrder);
+            // Layer 1 is the first root in z, so its traversal is a prefix of the full one.
+            ASSERT_GE(flattened.size(), expected.size());
+            for (size_t i = 0; i < expected.size(); i++) {
+                EXPECT_EQ(flattened[i], expected[i]) << expected[i].toString();
+                EXPECT_EQ(flattened[i].variant, expected[i].variant);
+                EXPECT_EQ(flattened[i].relativeRootIds, expected[i].relativeRootIds);
+                EXPECT_EQ(flattened[i].isAttached(), expected[i].isAttached());
+            }
+        }
+    };
+    expectMatchesRecursiveTraversal();
+
+    setZ(121, -1);
+    reparentRelativeLayer(13, 11);
+    mirrorLayer(/*layer*/ 14, /*parent*/ 1, /*layerToMirror*/ 12);
+    UPDATE_AND_VERIFY(hierarchyBuilder);
+    expectMatchesRecursiveTraversal();
+
+    reparentLayer(122, 11);
+    destroyLayerHandle(111);
+    UPDATE_AND_VERIFY(hierarchyBuilder);
+    expectMatchesRecursiveTraversal();
+}
+
+TEST_F(LayerHierarchyTest, flattenedTraversalSkipsSubtree) {
+    SET_FLAG_FOR_TEST(flags::flattened_layer_hierarchy, true);
+    setZ(121, -1);
+    LayerHierarchyBuilder hierarchyBuilder;
+    hierarchyBuilder.update(mLifecycleManager);
+
+    auto visitUntil = [](uint32_t skipId) {
+        return [skipId](std::vector<uint32_t>& layerIds) {
+            return [skipId, &layerIds](const LayerHierarchy& hierarchy,
+                                       const LayerHierarchy::TraversalPath&) -> bool {
+                layerIds.emplace_back(hierarchy.getLayer()->id);
+                return hierarchy.getLayer()->id != skipId;
+            };
+        };
+    };
+
+    std::vector<uint32_t> layerIds;
+    hierarchyBuilder.getHierarchy().traverse(visitUntil(12)(layerIds));
+    std::vector<uint32_t> expectedTraversalPath = {1, 11, 111, 12, 13, 2};
+    EXPECT_EQ(layerIds, expectedTraversalPath);
+
+    // In z-order, children below the layer have already been visited.
+    layerIds.clear();
+    hierarchyBuilder.getHierarchy().traverseInZOrder(visitUntil(12)(layerIds));
+    expectedTraversalPath = {1, 11, 111, 121, 12, 13, 2};
+    EXPECT_EQ(layerIds, expectedTraversalPath);
+}
+
 } // namespace android::surfaceflinger::frontend
@@ -46,6 +46,7 @@ protected:
 
     void setFrameTimes(const std::deque<FrameTimeData>& frameTimes) {
         layerInfo.mFrameTimes = frameTimes;
+        layerInfo.mAverageFrameTimeCache.reset();
     }
 
     void setLastRefreshRate(Fps fps) {
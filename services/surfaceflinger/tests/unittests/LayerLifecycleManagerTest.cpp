@@ -629,4 +629,17 @@ TEST_F(LayerLifecycleManagerTest, testInputInfoOfRequestedLayerState) {
     EXPECT_TRUE(getRequestedLayerState(mLifecycleManager, 111)->needsInputInfo());
 }
 
+TEST_F(LayerLifecycleManagerTest, commitClearsMirrorChangesFromDestroyedLayer) {
+    mirrorLayer(/*id=*/1000, /*parentId=*/1, /*layerIdToMirror=*/2);
+    mLifecycleManager.commitChanges();
+    EXPECT_EQ(getRequestedLayerState(mLifecycleManager, 1000)->changes.get(), 0u);
+
+    destroyLayerHandle(2);
+    EXPECT_TRUE(getRequestedLayerState(mLifecycleManager, 1000)
+                        ->changes.test(RequestedLayerState::Changes::Mirror));
+    mLifecycleManager.commitChanges();
+    EXPECT_EQ(getRequestedLayerState(mLifecycleManager, 1000)->changes.get(), 0u);
+    EXPECT_EQ(getRequestedLayerState(mLifecycleManager, 1000)->what, 0u);
+}
+
 } // namespace android::surfaceflinger::frontend
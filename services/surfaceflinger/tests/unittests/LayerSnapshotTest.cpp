@@ -1935,4 +1935,64 @@ TEST_F(LayerSnapshotTest, shouldUpdateInputWhenNoInputInfo) {
     EXPECT_FALSE(getSnapshot(2)->hasInputInfo());
 }
 
+TEST_F(LayerSnapshotTest, updateDirtySubtreesOnlySkipsCleanSubtrees) {
+    LayerSnapshotBuilder::Args args{.root = mHierarchyBuilder.getHierarchy(),
+                                    .layerLifecycleManager = mLifecycleManager,
+                                    .includeMetadata = false,
+                                    .displays = mFrontEndDisplayInfos,
+                                    .globalShadowSettings = globalShadowSettings,
+                                    .supportsBlur = true,
+                                    .supportedLayerGenericMetadata = {},
+                                    .genericLayerMetadataKeyMap = {},
+                                    .updateDirtySubtreesOnly = true};
+    setPosition(1221, 10, 20);
+    update(mSnapshotBuilder, args);
+    EXPECT_EQ(getSnapshot(1221)->geomLayerTransform.tx(), 10);
+    EXPECT_EQ(getSnapshot(1221)->geomLayerTransform.ty(), 20);
+    EXPECT_TRUE(getSnapshot(1221)->changes.test(RequestedLayerState::Changes::Geometry));
+    // Siblings of the dirty ancestors are not walked.
+    EXPECT_FALSE(getSnapshot(11)->changes.any());
+    EXPECT_FALSE(getSnapshot(121)->changes.any());
+    EXPECT_FALSE(getSnapshot(2)->changes.any());
+
+    // The resulting snapshots should match a full rebuild.
+    LayerSnapshotBuilder expectedBuilder(args);
+    mLifecycleManager.commitChanges();
+    expectedBuilder.forEachSnapshot([&](const LayerSnapshot& expected) {
+        const LayerSnapshot* actual = getSnapshot(expected.path);
+        ASSERT_NE(actual, nullptr);
+        EXPECT_EQ(actual->geomLayerTransform, expected.geomLayerTransform);
+        EXPECT_EQ(actual->globalZ, expected.globalZ);
+        EXPECT_EQ(actual->getIsVisible(), expected.getIsVisible());
+    });
+}
+
+TEST_F(LayerSnapshotTest, updateDirtySubtreesOnlyUpdatesInheritingChildren) {
+    LayerSnapshotBuilder::Args args{.root = mHierarchyBuilder.getHierarchy(),
+                                    .layerLifecycleManager = mLifecycleManager,
+                                    .includeMetadata = false,
+                                    .displays = mFrontEndDisplayInfos,
+                                    .globalShadowSettings = globalShadowSettings,
+                                    .supportsBlur = true,
+                                    .supportedLayerGenericMetadata = {},
+                                    .genericLayerMetadataKeyMap = {},
+                                    .updateDirtySubtreesOnly = true};
+    setPosition(12, 5, 5);
+    update(mSnapshotBuilder, args);
+    mLifecycleManager.commitChanges();
+    EXPECT_EQ(getSnapshot(12)->geomLayerTransform.tx(), 5);
+    EXPECT_EQ(getSnapshot(1221)->geomLayerTransform.tx(), 5);
+    EXPECT_FALSE(getSnapshot(111)->changes.any());
+
+    hideLayer(12);
+    update(mSnapshotBuilder, args);
+    mLifecycleManager.commitChanges();
+    EXPECT_FALSE(getSnapshot(1221)->getIsVisible());
+    EXPECT_TRUE(getSnapshot(111)->getIsVisible());
+
+    // Hierarchy changes fall back to a full walk.
+    reparentLayer(1221, 11);
+    UPDATE_AND_VERIFY(mSnapshotBuilder, {1, 11, 111, 1221, 13, 2});
+}
+
 } // namespace android::surfaceflinger::frontend
@@ -354,6 +354,52 @@ TEST_F(PowerAdvisorTest, hintSessionUseHwcDisplay) {
     mPowerAdvisor->reportActualWorkDuration();
 }
 
+TEST_F(PowerAdvisorTest, hintSessionSendsLoadUpWhenPredictionExceedsTarget) {
+    SET_FLAG_FOR_TEST(com::android::graphics::surfaceflinger::flags::
+                              power_advisor_predictive_load_up,
+                      true);
+    mPowerAdvisor->onBootFinished();
+    startPowerHintSession();
+
+    std::vector<DisplayId> displayIds{PhysicalDisplayId::fromPort(42u)};
+
+    // 60hz
+    const Duration vsyncPeriod{std::chrono::nanoseconds(1s) / 60};
+    const Duration presentDuration = 5ms;
+    const Duration postCompDuration = 1ms;
+
+    TimePoint startTime{100ns};
+
+    // advisor only starts on frame 2 so do an initial no-op frame
+    fakeBasicFrameTiming(startTime, vsyncPeriod);
+    setExpectedTiming(vsyncPeriod, startTime + vsyncPeriod);
+    mPowerAdvisor->setDisplays(displayIds);
+    mPowerAdvisor->setSfPresentTiming(startTime, startTime + presentDuration);
+    mPowerAdvisor->setCompositeEnd(startTime + presentDuration + postCompDuration);
+
+    // increment the frame
+    startTime += vsyncPeriod;
+
+    ON_CALL(*mMockPowerHintSession, reportActualWorkDuration)
+            .WillByDefault(Return(testing::ByMove(HalResult<void>::ok())));
+    fakeBasicFrameTiming(startTime, vsyncPeriod);
+    setExpectedTiming(vsyncPeriod, startTime + vsyncPeriod);
+    mPowerAdvisor->setDisplays(displayIds);
+    mPowerAdvisor->setSfPresentTiming(startTime, startTime + presentDuration);
+    mPowerAdvisor->reportActualWorkDuration();
+
+    // The 6ms frames fit at 60hz, but not in the 4ms target of a 240hz mode. Only the first frame
+    // with the smaller target sends the hint.
+    EXPECT_CALL(*mMockPowerHintSession, sendHint(SessionHint::CPU_LOAD_UP))
+            .Times(1)
+            .WillOnce(Return(testing::ByMove(HalResult<void>::ok())));
+    const Duration shortVsyncPeriod{std::chrono::nanoseconds(1s) / 240};
+    startTime += vsyncPeriod;
+    fakeBasicFrameTiming(startTime, shortVsyncPeriod);
+    startTime += shortVsyncPeriod;
+    fakeBasicFrameTiming(startTime, shortVsyncPeriod);
+}
+
 TEST_F(PowerAdvisorTest, hintSessionSubtractsHwcFenceTime) {
     mPowerAdvisor->onBootFinished();
     startPowerHintSession();
@@ -3256,19 +3256,19 @@ TEST_P(RefreshRateSelectorTest, getBestFrameRateMode_ReadsCache) {
                                                                   {90_Hz, kMode90}}},
                                                           GlobalSignals{.touch = true}};
 
-    selector.mutableGetRankedRefreshRatesCache() = {.layers = std::vector<LayerRequirement>{},
-                                                    .signals = GlobalSignals{.touch = true,
-                                                                             .idle = true},
-                                                    .result = result};
+    selector.mutableGetRankedRefreshRatesCache() = {{.layers = std::vector<LayerRequirement>{},
+                                                     .signals = GlobalSignals{.touch = true,
+                                                                              .idle = true},
+                                                     .result = result}};
 
-    const auto& cache = *selector.mutableGetRankedRefreshRatesCache();
+    const auto& cache = selector.mutableGetRankedRefreshRatesCache().front();
     EXPECT_EQ(result, selector.getRankedFrameRates(cache.layers, cache.signals));
 }
 
 TEST_P(RefreshRateSelectorTest, getBestFrameRateMode_WritesCache) {
     auto selector = createSelector(kModes_30_60_72_90_120, kModeId60);
 
-    EXPECT_FALSE(selector.mutableGetRankedRefreshRatesCache());
+    EXPECT_TRUE(selector.mutableGetRankedRefreshRatesCache().empty());
 
     const std::vector<LayerRequirement> layers = {{.weight = 1.f}, {.weight = 0.5f}};
     const RefreshRateSelector::GlobalSignals globalSignals{.touch = true, .idle = true};
@@ -3276,13 +3276,39 @@ TEST_P(RefreshRateSelectorTest, getBestFrameRateMode_WritesCache) {
 
     const auto result = selector.getRankedFrameRates(layers, globalSignals, pacesetterFps);
 
-    const auto& cache = selector.mutableGetRankedRefreshRatesCache();
-    ASSERT_TRUE(cache);
+    const auto& caches = selector.mutableGetRankedRefreshRatesCache();
+    ASSERT_EQ(1u, caches.size());
 
-    EXPECT_EQ(cache->layers, layers);
-    EXPECT_EQ(cache->signals, globalSignals);
-    EXPECT_EQ(cache->pacesetterFps, pacesetterFps);
-    EXPECT_EQ(cache->result, result);
+    const auto& cache = caches.front();
+    EXPECT_EQ(cache.layers, layers);
+    EXPECT_EQ(cache.signals, globalSignals);
+    EXPECT_EQ(cache.pacesetterFps, pacesetterFps);
+    EXPECT_EQ(cache.result, result);
+}
+
+TEST_P(RefreshRateSelectorTest, getBestFrameRateMode_CacheKeepsRecentInvocations) {
+    auto selector = createSelector(kModes_30_60_72_90_120, kModeId60);
+
+    const std::vector<LayerRequirement> layers = {{.weight = 1.f}};
+    const RefreshRateSelector::GlobalSignals touch{.touch = true};
+    const RefreshRateSelector::GlobalSignals idle{.idle = true};
+
+    const auto touchResult = selector.getRankedFrameRates(layers, touch);
+    const auto idleResult = selector.getRankedFrameRates(layers, idle);
+
+    // Alternating between signals hits the cache instead of evicting the other entry.
+    EXPECT_EQ(touchResult, selector.getRankedFrameRates(layers, touch));
+    EXPECT_EQ(idleResult, selector.getRankedFrameRates(layers, idle));
+
+    const auto& caches = selector.mutableGetRankedRefreshRatesCache();
+    ASSERT_EQ(2u, caches.size());
+    EXPECT_EQ(caches.front().signals, idle);
+    EXPECT_EQ(caches.back().signals, touch);
+
+    // Changing the policy invalidates all entries.
+    EXPECT_EQ(SetPolicyResult::Changed,
+              selector.setDisplayManagerPolicy({kModeId90, {30_Hz, 90_Hz}}));
+    EXPECT_TRUE(selector.mutableGetRankedRefreshRatesCache().empty());
 }
 
 TEST_P(RefreshRateSelectorTest, getBestFrameRateMode_ExplicitExactTouchBoost) {
@@ -106,6 +106,24 @@ TEST_F(RegionSamplingTest, bounds_checking) {
                 testing::Eq(0.0));
 }
 
+TEST_F(RegionSamplingTest, scaleSampleArea_identity) {
+    const Rect sampledBounds{100, 200, 100 + kWidth, 200 + kHeight};
+    EXPECT_EQ(whole_area, scaleSampleArea(sampledBounds, sampledBounds, ui::Size(kWidth, kHeight)));
+    EXPECT_EQ(Rect(10, 5, 20, 15),
+              scaleSampleArea(Rect{110, 205, 120, 215}, sampledBounds, ui::Size(kWidth, kHeight)));
+}
+
+TEST_F(RegionSamplingTest, scaleSampleArea_downscaled) {
+    const Rect sampledBounds{0, 0, 400, 100};
+    const ui::Size sampleSize(100, 25);
+    EXPECT_EQ(Rect(0, 0, 100, 25), scaleSampleArea(sampledBounds, sampledBounds, sampleSize));
+    // Rounds outwards.
+    EXPECT_EQ(Rect(2, 1, 5, 4), scaleSampleArea(Rect{10, 6, 18, 14}, sampledBounds, sampleSize));
+    // Never empty, and never outside of the sample buffer.
+    EXPECT_EQ(Rect(99, 24, 100, 25),
+              scaleSampleArea(Rect{399, 99, 400, 100}, sampledBounds, sampleSize));
+}
+
 } // namespace android
 
 // TODO(b/129481165): remove the #pragma below and fix conversion issues
@@ -582,6 +582,7 @@ TEST_F(SchedulerTest, onFrameSignalMultipleDisplays) {
             return results;
         }
 
+        void prepareCommit() override {}
         void sample() override {}
         void sendNotifyExpectedPresentHint(PhysicalDisplayId) override {}
     } compositor(*mScheduler);
@@ -621,6 +622,81 @@ TEST_F(SchedulerTest, onFrameSignalMultipleDisplays) {
     EXPECT_EQ(makeVsyncIds(VsyncId(44), true), compositor.vsyncIds.composite);
 }
 
+TEST_F(SchedulerTest, followerIsCompositedOnItsOwnVsync) {
+    SET_FLAG_FOR_TEST(flags::follower_display_own_vsync_composite, true);
+
+    constexpr PhysicalDisplayId kActiveDisplayId = kDisplayId1;
+    constexpr Period kFollowerPeriod = (60_Hz).getPeriod();
+    TimePoint followerVsync = TimePoint::now() + Duration::fromNs(ms2ns(1000));
+
+    auto followerTracker = std::make_shared<mock::VSyncTracker>();
+    ON_CALL(*followerTracker, nextAnticipatedVSyncTimeFrom(_, _))
+            .WillByDefault([&followerVsync](nsecs_t, std::optional<nsecs_t>) {
+                return followerVsync.ns();
+            });
+    ON_CALL(*followerTracker, currentPeriod()).WillByDefault(Return(kFollowerPeriod.ns()));
+
+    mScheduler->registerDisplay(kDisplayId1,
+                                std::make_shared<RefreshRateSelector>(kDisplay1Modes,
+                                                                      kDisplay1Mode60->getId()),
+                                kActiveDisplayId);
+    mScheduler->registerDisplay(kDisplayId2,
+                                std::make_shared<RefreshRateSelector>(kDisplay2Modes,
+                                                                      kDisplay2Mode60->getId()),
+                                kActiveDisplayId, followerTracker);
+
+    using DisplayIds = std::vector<PhysicalDisplayId>;
+
+    struct Compositor final : ICompositor {
+        DisplayIds committed;
+        DisplayIds composited;
+
+        void configure() override {}
+
+        bool commit(PhysicalDisplayId, const scheduler::FrameTargets& targets) override {
+            committed.clear();
+            composited.clear();
+            for (const auto& [id, _] : targets) {
+                committed.push_back(id);
+            }
+            return true;
+        }
+
+        CompositeResultsPerDisplay composite(PhysicalDisplayId,
+                                             const scheduler::FrameTargeters& targeters) override {
+            CompositeResultsPerDisplay results;
+            for (const auto& [id, _] : targeters) {
+                composited.push_back(id);
+                results.try_emplace(id,
+                                    CompositeResult{.compositionCoverage =
+                                                            CompositionCoverage::Hwc});
+            }
+            return results;
+        }
+
+        void prepareCommit() override {}
+        void sample() override {}
+        void sendNotifyExpectedPresentHint(PhysicalDisplayId) override {}
+    } compositor;
+
+    const DisplayIds kBothDisplays = {kDisplayId1, kDisplayId2};
+    const DisplayIds kPacesetterOnly = {kDisplayId1};
+
+    mScheduler->doFrameSignal(compositor, VsyncId(42));
+    EXPECT_EQ(kBothDisplays, compositor.committed);
+    EXPECT_EQ(kBothDisplays, compositor.composited);
+
+    // The follower already has a frame for its next VSYNC, so only the commit is shared.
+    mScheduler->doFrameSignal(compositor, VsyncId(43));
+    EXPECT_EQ(kBothDisplays, compositor.committed);
+    EXPECT_EQ(kPacesetterOnly, compositor.composited);
+
+    followerVsync += kFollowerPeriod;
+    mScheduler->doFrameSignal(compositor, VsyncId(44));
+    EXPECT_EQ(kBothDisplays, compositor.committed);
+    EXPECT_EQ(kBothDisplays, compositor.composited);
+}
+
 TEST_F(SchedulerTest, nextFrameIntervalTest) {
     SET_FLAG_FOR_TEST(flags::vrr_config, true);
 
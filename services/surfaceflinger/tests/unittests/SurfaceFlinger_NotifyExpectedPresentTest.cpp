@@ -96,6 +96,7 @@ protected:
             return results;
         }
 
+        void prepareCommit() override {}
         void sample() override {}
         void configure() override {}
 
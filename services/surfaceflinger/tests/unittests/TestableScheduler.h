@@ -218,6 +218,7 @@ private:
                                          const scheduler::FrameTargeters&) override {
         return {};
     }
+    void prepareCommit() override {}
     void sample() override {}
     void sendNotifyExpectedPresentHint(PhysicalDisplayId) override {}
 };
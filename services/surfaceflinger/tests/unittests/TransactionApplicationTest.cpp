@@ -966,6 +966,41 @@ TEST(TransactionHandlerTest, QueueTransaction) {
     EXPECT_EQ(transactionsReadyToBeApplied.front().id, 42u);
 }
 
+TEST(TransactionHandlerTest, OnlyQueuesPendingBarrierAreRevisited) {
+    using TransactionReadiness = TransactionHandler::TransactionReadiness;
+    constexpr uint64_t kNotReadyId = 1;
+    constexpr uint64_t kBarrierId = 2;
+    constexpr uint64_t kReadyId = 3;
+
+    TransactionHandler handler;
+    std::unordered_map<uint64_t, int> filterCalls;
+    bool barrierSatisfied = false;
+    handler.addTransactionReadyFilter([&](const TransactionHandler::TransactionFlushState& flush) {
+        const uint64_t id = flush.transaction->id;
+        filterCalls[id]++;
+        if (id == kNotReadyId) return TransactionReadiness::NotReady;
+        if (id == kBarrierId && !barrierSatisfied) return TransactionReadiness::NotReadyBarrier;
+        if (id == kReadyId) barrierSatisfied = true;
+        return TransactionReadiness::Ready;
+    });
+
+    for (uint64_t id : {kNotReadyId, kBarrierId, kReadyId}) {
+        TransactionState transaction;
+        transaction.applyToken = sp<BBinder>::make();
+        transaction.id = id;
+        handler.queueTransaction(std::move(transaction));
+    }
+    handler.collectTransactions();
+    std::vector<TransactionState> transactions = handler.flushTransactions();
+
+    // The barrier is satisfied by a transaction on another queue within the same flush.
+    ASSERT_EQ(transactions.size(), 2u);
+    EXPECT_EQ(transactions.back().id, kBarrierId);
+    EXPECT_EQ(filterCalls[kNotReadyId], 1);
+    EXPECT_EQ(filterCalls[kReadyId], 1);
+    EXPECT_LE(filterCalls[kBarrierId], 2);
+}
+
 TEST(TransactionHandlerTest, TransactionsKeepTrackOfDirectMerges) {
     SurfaceComposerClient::Transaction transaction1, transaction2, transaction3, transaction4;
 
@@ -43,7 +43,8 @@ protected:
     perfetto::protos::TransactionTraceEntry bufferFront() {
         std::scoped_lock<std::mutex> lock(mTracing.mTraceLock);
         perfetto::protos::TransactionTraceEntry entry;
-        entry.ParseFromString(mTracing.mBuffer.front());
+        const std::string_view oldest = mTracing.mBuffer.front();
+        entry.ParseFromArray(oldest.data(), static_cast<int>(oldest.size()));
         return entry;
     }
 
@@ -338,4 +339,45 @@ TEST(LayerTraceTest, canStreamLayersTrace) {
     // magic?
     EXPECT_EQ(outProto.entry().size(), 3);
 }
+
+TEST(TransactionRingBufferTest, evictsOldestEntriesWhenWrapping) {
+    TransactionRingBuffer<perfetto::protos::TransactionTraceFile,
+                          perfetto::protos::TransactionTraceEntry>
+            buffer;
+    buffer.setSize(10);
+
+    std::vector<std::string> evicted;
+    const auto onEvicted = [&](std::string_view entry) { evicted.emplace_back(entry); };
+
+    buffer.emplace(std::string_view("aaaa"), onEvicted);
+    buffer.emplace(std::string_view("bbbb"), onEvicted);
+    EXPECT_EQ(buffer.frameCount(), 2u);
+    EXPECT_EQ(buffer.used(), 8u);
+    EXPECT_TRUE(evicted.empty());
+
+    // Does not fit before the end of the buffer, so it is written at the start in place of the
+    // oldest entry.
+    buffer.emplace(std::string_view("ccc"), onEvicted);
+    EXPECT_EQ(evicted, std::vector<std::string>{"aaaa"});
+    EXPECT_EQ(buffer.front(), "bbbb");
+    EXPECT_EQ(buffer.back(), "ccc");
+
+    buffer.emplace(std::string_view("dd"), onEvicted);
+    EXPECT_EQ(evicted, (std::vector<std::string>{"aaaa", "bbbb"}));
+    EXPECT_EQ(buffer.front(), "ccc");
+    EXPECT_EQ(buffer.back(), "dd");
+    EXPECT_EQ(buffer.used(), 5u);
+
+    // Shrinking keeps the newest entries.
+    buffer.setSize(4, onEvicted);
+    EXPECT_EQ(evicted, (std::vector<std::string>{"aaaa", "bbbb", "ccc"}));
+    EXPECT_EQ(buffer.frameCount(), 1u);
+    EXPECT_EQ(buffer.front(), "dd");
+
+    // Entries larger than the buffer are dropped.
+    buffer.emplace(std::string_view("eeeee"), onEvicted);
+    EXPECT_EQ(buffer.frameCount(), 1u);
+    EXPECT_EQ(buffer.back(), "dd");
+}
+
 } // namespace android
@@ -270,6 +270,24 @@ TEST_F(VSyncDispatchTimerQueueTest, basicAlarmSettingFuture) {
     EXPECT_THAT(cb.mCalls[0], Eq(mPeriod));
 }
 
+TEST_F(VSyncDispatchTimerQueueTest, dumpsWakeupErrorHistogram) {
+    CountingCallback early(mDispatch);
+    CountingCallback late(mDispatch);
+    mDispatch->schedule(early,
+                        {.workDuration = 100, .readyDuration = 0, .lastVsync = mPeriod - 230});
+    mDispatch->schedule(late,
+                        {.workDuration = 100, .readyDuration = 0, .lastVsync = 2 * mPeriod - 230});
+
+    advanceToNextCallback();
+    mMockClock.advanceBy(us2ns(300));
+    ASSERT_THAT(early.mCalls.size(), Eq(1));
+    ASSERT_THAT(late.mCalls.size(), Eq(1));
+
+    std::string dump;
+    mDispatch->dump(dump);
+    EXPECT_THAT(dump, HasSubstr("Wakeup error: early=0 <100us=1 <250us=0 <500us=1 "));
+}
+
 TEST_F(VSyncDispatchTimerQueueTest, updateAlarmSettingFuture) {
     auto intended = mPeriod - 230;
     Sequence seq;
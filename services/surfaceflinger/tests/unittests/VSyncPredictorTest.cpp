@@ -304,6 +304,33 @@ TEST_F(VSyncPredictorTest, againstOutliersDiscontinuous_500hzLowVariance) {
     EXPECT_THAT(intercept, IsCloseTo(expectedIntercept, mMaxRoundingError));
 }
 
+TEST_F(VSyncPredictorTest, refitsWithoutOutlyingResiduals) {
+    // The last timestamp is late by 20% of a period, which is within kOutlierTolerancePercent so it
+    // is accepted into the history, but it skews a plain least squares fit.
+    auto vsyncs = generateVsyncTimestamps(kHistorySize, mPeriod, 0);
+    vsyncs.back() += mPeriod / 5;
+
+    const auto addVsyncs = [&](VSyncPredictor& predictor) {
+        for (auto const& timestamp : vsyncs) {
+            predictor.addVsyncTimestamp(timestamp);
+        }
+        return predictor.getVSyncPredictionModel();
+    };
+
+    {
+        SET_FLAG_FOR_TEST(flags::vsync_predictor_outlier_rejection, false);
+        const auto [slope, intercept] = addVsyncs(tracker);
+        EXPECT_NE(slope, mPeriod);
+    }
+
+    SET_FLAG_FOR_TEST(flags::vsync_predictor_outlier_rejection, true);
+    VSyncPredictor robustTracker{std::make_unique<ClockWrapper>(mClock), mMode, kHistorySize,
+                                 kMinimumSamplesForPrediction, kOutlierTolerancePercent};
+    const auto [slope, intercept] = addVsyncs(robustTracker);
+    EXPECT_EQ(slope, mPeriod);
+    EXPECT_EQ(intercept, 0);
+}
+
 TEST_F(VSyncPredictorTest, handlesVsyncChange) {
     auto const fastPeriod = 100;
     auto const fastTimeBase = 100;
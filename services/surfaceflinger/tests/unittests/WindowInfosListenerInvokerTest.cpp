@@ -1,4 +1,6 @@
 #include <android/gui/BnWindowInfosListener.h>
+#include <com_android_graphics_surfaceflinger_flags.h>
+#include <common/test/FlagUtils.h>
 #include <gtest/gtest.h>
 #include <gui/SurfaceComposerClient.h>
 #include <gui/WindowInfosUpdate.h>
@@ -10,6 +12,8 @@
 
 namespace android {
 
+using namespace com::android::graphics::surfaceflinger;
+
 class WindowInfosListenerInvokerTest : public testing::Test {
 protected:
     WindowInfosListenerInvokerTest() : mInvoker(sp<WindowInfosListenerInvoker>::make()) {}
@@ -283,4 +287,38 @@ TEST_F(WindowInfosListenerInvokerTest, removeListenerAcks) {
     EXPECT_EQ(callCount, 2);
 }
 
+// Test that an update identical to the last one sent is not sent again, while a changed update is.
+TEST_F(WindowInfosListenerInvokerTest, skipsUnchangedUpdate) {
+    SET_FLAG_FOR_TEST(flags::skip_unchanged_window_infos, true);
+
+    int callCount = 0;
+    gui::WindowInfosListenerInfo listenerInfo;
+    mInvoker->addWindowInfosListener(sp<Listener>::make([&](const gui::WindowInfosUpdate& update) {
+                                         callCount++;
+                                         listenerInfo.windowInfosPublisher
+                                                 ->ackWindowInfosReceived(update.vsyncId,
+                                                                          listenerInfo.listenerId);
+                                     }),
+                                     &listenerInfo);
+
+    gui::WindowInfo windowInfo;
+    windowInfo.name = "Window";
+    const auto sendUpdate = [&](int64_t vsyncId) {
+        BackgroundExecutor::getInstance().sendCallbacks({[&, vsyncId]() {
+            mInvoker->windowInfosChanged(gui::WindowInfosUpdate{{windowInfo}, {}, vsyncId, 0}, {},
+                                         false);
+        }});
+        BackgroundExecutor::getInstance().flushQueue();
+    };
+
+    sendUpdate(0);
+    sendUpdate(1);
+    EXPECT_EQ(callCount, 1);
+
+    windowInfo.alpha = 0.5f;
+    sendUpdate(2);
+    EXPECT_EQ(callCount, 2);
+    EXPECT_EQ(mInvoker->getDebugInfo().skippedUnchangedUpdateCount, 1u);
+}
+
 } // namespace android
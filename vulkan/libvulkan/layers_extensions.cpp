@@ -341,6 +341,11 @@ void* LayerLibrary::GetGPA(const Layer& layer, const std::string_view gpa_name)
 std::vector<LayerLibrary> g_layer_libraries;
 std::vector<Layer> g_instance_layers;
 
+// Set by DiscoverLayers, and cleared once the layer search paths have been
+// scanned by EnsureLayersDiscovered.
+std::mutex g_layer_discovery_mutex;
+bool g_layer_discovery_pending = false;
+
 void AddLayerLibrary(const std::string& path, const std::string& filename) {
     LayerLibrary library(path + "/" + filename, filename);
     if (!library.Open())
@@ -474,10 +479,16 @@ void* GetLayerGetProcAddr(const Layer& layer,
     return library.GetGPA(layer, gpa_name);
 }
 
-}  // anonymous namespace
+// Enumerating the layers of a library requires loading it, so the search
+// paths are only scanned the first time a layer is looked up. Applications
+// that neither enable nor enumerate layers never load any layer library.
+void EnsureLayersDiscovered() {
+    std::lock_guard<std::mutex> lock(g_layer_discovery_mutex);
+    if (!g_layer_discovery_pending)
+        return;
+    g_layer_discovery_pending = false;
 
-void DiscoverLayers() {
-    ATRACE_CALL();
+    ATRACE_NAME("DiscoverLayers");
 
     if (android::GraphicsEnv::getInstance().isDebuggable()) {
         DiscoverLayersInPathList(kSystemLayerLibraryDir);
@@ -486,7 +497,15 @@ void DiscoverLayers() {
         DiscoverLayersInPathList(android::GraphicsEnv::getInstance().getLayerPaths());
 }
 
+}  // anonymous namespace
+
+void DiscoverLayers() {
+    std::lock_guard<std::mutex> lock(g_layer_discovery_mutex);
+    g_layer_discovery_pending = true;
+}
+
 uint32_t GetLayerCount() {
+    EnsureLayersDiscovered();
     return static_cast<uint32_t>(g_instance_layers.size());
 }
 
@@ -495,6 +514,7 @@ const Layer& GetLayer(uint32_t index) {
 }
 
 const Layer* FindLayer(const char* name) {
+    EnsureLayersDiscovered();
     auto layer =
         std::find_if(g_instance_layers.cbegin(), g_instance_layers.cend(),
                      [=](const Layer& entry) {
@@ -43,6 +43,8 @@ class LayerRef {
     const Layer* layer_;
 };
 
+// Schedules a scan of the layer search paths. The scan itself, which loads
+// every layer library found, happens on the first GetLayerCount or FindLayer.
 void DiscoverLayers();
 
 uint32_t GetLayerCount();
@@ -182,7 +182,8 @@ class TimingInfo {
    public:
     TimingInfo(const VkPresentTimeGOOGLE* qp, uint64_t nativeFrameId)
         : vals_{qp->presentID, qp->desiredPresentTime, 0, 0, 0},
-          native_frame_id_(nativeFrameId) {}
+          native_frame_id_(nativeFrameId),
+          queue_time_(systemTime(SYSTEM_TIME_MONOTONIC)) {}
     bool ready() const {
         return (timestamp_desired_present_time_ !=
                         NATIVE_WINDOW_TIMESTAMP_PENDING &&
@@ -239,6 +240,8 @@ class TimingInfo {
     VkPastPresentationTimingGOOGLE vals_ { 0, 0, 0, 0, 0 };
 
     uint64_t native_frame_id_ { 0 };
+    // When the frame was handed to vkQueuePresentKHR.
+    nsecs_t queue_time_ { 0 };
     int64_t timestamp_desired_present_time_{ NATIVE_WINDOW_TIMESTAMP_PENDING };
     int64_t timestamp_actual_present_time_ { NATIVE_WINDOW_TIMESTAMP_PENDING };
     int64_t timestamp_render_complete_time_ { NATIVE_WINDOW_TIMESTAMP_PENDING };
@@ -288,7 +291,8 @@ struct Swapchain {
           frame_timestamps_enabled(false),
           refresh_duration(refresh_duration_),
           acquire_next_image_timeout(-1),
-          shared(IsSharedPresentMode(present_mode)) {
+          shared(IsSharedPresentMode(present_mode)),
+          auto_refresh(present_mode == VK_PRESENT_MODE_SHARED_CONTINUOUS_REFRESH_KHR) {
     }
 
     VkResult get_refresh_duration(uint64_t& outRefreshDuration)
@@ -314,6 +318,9 @@ struct Swapchain {
     int64_t refresh_duration;
     nsecs_t acquire_next_image_timeout;
     bool shared;
+    // The auto refresh state last set on the window, so that presents which
+    // keep the same shared present mode don't repeat the binder call.
+    bool auto_refresh;
 
     struct Image {
         Image()
@@ -339,6 +346,9 @@ struct Swapchain {
     } images[android::BufferQueueDefs::NUM_BUFFER_SLOTS];
 
     std::vector<TimingInfo> timing;
+
+    // Reused across presents to avoid an allocation per incremental present.
+    std::vector<android_native_rect_t> damage_rects;
 };
 
 VkSwapchainKHR HandleFromSwapchain(Swapchain* swapchain) {
@@ -484,6 +494,15 @@ uint32_t get_num_ready_timings(Swapchain& swapchain) {
             // use those timestamps to calculate the info that should be
             // reported to the user:
             ti.calculate(swapchain.refresh_duration);
+            if (ATRACE_ENABLED() && ti.vals_.actualPresentTime) {
+                // Lets frame pacing be inspected in a trace without the app
+                // having to log its own past presentation timings.
+                ATRACE_INT64("VK present latency (ns)",
+                             static_cast<int64_t>(ti.vals_.actualPresentTime) -
+                                     ti.queue_time_);
+                ATRACE_INT64("VK present margin (ns)",
+                             static_cast<int64_t>(ti.vals_.presentMargin));
+            }
             num_ready++;
         }
     }
@@ -2384,8 +2403,10 @@ static VkResult WorstPresentResult(VkResult a, VkResult b) {
 }
 
 // KHR_incremental_present aspect of QueuePresentKHR
-static void SetSwapchainSurfaceDamage(ANativeWindow *window, const VkPresentRegionKHR *pRegion) {
-    std::vector<android_native_rect_t> rects(pRegion->rectangleCount);
+static void SetSwapchainSurfaceDamage(Swapchain &swapchain, const VkPresentRegionKHR *pRegion) {
+    ANativeWindow *window = swapchain.surface.window.get();
+    std::vector<android_native_rect_t>& rects = swapchain.damage_rects;
+    rects.resize(pRegion->rectangleCount);
     for (auto i = 0u; i < pRegion->rectangleCount; i++) {
         auto const& rect = pRegion->pRectangles[i];
         if (rect.layer > 0) {
@@ -2442,19 +2463,24 @@ static void SetSwapchainFrameTimestamp(Swapchain &swapchain, const VkPresentTime
 }
 
 // EXT_swapchain_maintenance1 present mode change
-static bool SetSwapchainPresentMode(ANativeWindow *window, VkPresentModeKHR mode) {
+static bool SetSwapchainPresentMode(Swapchain &swapchain, VkPresentModeKHR mode) {
     // There is no dynamic switching between non-shared present modes.
     // All we support is switching between demand and continuous refresh.
     if (!IsSharedPresentMode(mode))
         return true;
 
-    int err = native_window_set_auto_refresh(window,
-            mode == VK_PRESENT_MODE_SHARED_CONTINUOUS_REFRESH_KHR);
+    const bool auto_refresh = mode == VK_PRESENT_MODE_SHARED_CONTINUOUS_REFRESH_KHR;
+    if (auto_refresh == swapchain.auto_refresh)
+        return true;
+
+    ANativeWindow *window = swapchain.surface.window.get();
+    int err = native_window_set_auto_refresh(window, auto_refresh);
     if (err != android::OK) {
         ALOGE("native_window_set_auto_refresh() failed: %s (%d)",
               strerror(-err), err);
         return false;
     }
+    swapchain.auto_refresh = auto_refresh;
 
     return true;
 }
@@ -2514,13 +2540,13 @@ static VkResult PresentOneSwapchain(
             }
 
             if (pRegion) {
-                SetSwapchainSurfaceDamage(window, pRegion);
+                SetSwapchainSurfaceDamage(swapchain, pRegion);
             }
             if (pTime) {
                 SetSwapchainFrameTimestamp(swapchain, pTime);
             }
             if (pPresentMode) {
-                if (!SetSwapchainPresentMode(window, *pPresentMode))
+                if (!SetSwapchainPresentMode(swapchain, *pPresentMode))
                     swapchain_result = WorstPresentResult(swapchain_result,
                         VK_ERROR_SURFACE_LOST_KHR);
             }